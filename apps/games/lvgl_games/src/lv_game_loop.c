@@ -0,0 +1,404 @@
+/**
+ * @file lv_game_loop.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_game_loop.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+// a batch whose frame is not reported in this time is taken as drawn
+#define LV_GAME_FRAME_TIMEOUT 100
+
+#define LV_GAME_FPS_PERIOD 1000
+
+#define LV_GAME_MOVE_X 0x01
+#define LV_GAME_MOVE_Y 0x02
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    lv_obj_t *obj;
+    lv_coord_t x;
+    lv_coord_t y;
+    uint8_t flags;
+} lv_game_move_t;
+
+struct _lv_game_loop_t {
+    lv_timer_t *timer;
+    lv_game_update_cb_t update_cb;
+    void *user_data;
+    uint32_t step_ms;
+    uint32_t last_tick;
+    uint32_t acc_ms;
+
+    // the last batch, until the display draws a frame after it
+    bool wait_frame;
+    uint32_t wait_frame_cnt;
+    uint32_t commit_tick;
+
+    lv_game_move_t moves[LV_GAME_SPRITE_MAX];
+    uint16_t move_cnt;
+
+    lv_obj_t *fps_label;
+    uint32_t fps_tick;
+    uint32_t fps_frame_cnt;
+    uint32_t busy_ms;
+};
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+// frames drawn by the default display
+static bool sg_frame_hooked;
+static uint32_t sg_frame_cnt;
+static uint32_t sg_frame_tick;
+static uint32_t sg_frame_max_ms;
+
+#if LVGL_VERSION_MAJOR < 9
+static void (*sg_monitor_cb)(lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px);
+#endif
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+static void __frame_drawn(void)
+{
+    uint32_t elaps = lv_tick_elaps(sg_frame_tick);
+
+    if (sg_frame_cnt && elaps > sg_frame_max_ms) {
+        sg_frame_max_ms = elaps;
+    }
+    sg_frame_tick = lv_tick_get();
+    sg_frame_cnt++;
+}
+
+#if LVGL_VERSION_MAJOR >= 9
+static void __frame_event_cb(lv_event_t *e)
+{
+    __frame_drawn();
+}
+#else
+static void __frame_monitor_cb(lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px)
+{
+    __frame_drawn();
+
+    if (sg_monitor_cb) {
+        sg_monitor_cb(disp_drv, time, px);
+    }
+}
+#endif
+
+static void __frame_hook(void)
+{
+    lv_disp_t *disp = lv_disp_get_default();
+
+    if (sg_frame_hooked || NULL == disp) {
+        return;
+    }
+
+#if LVGL_VERSION_MAJOR >= 9
+    lv_display_add_event_cb(disp, __frame_event_cb, LV_EVENT_RENDER_READY, NULL);
+#else
+    sg_monitor_cb = disp->driver->monitor_cb;
+    disp->driver->monitor_cb = __frame_monitor_cb;
+#endif
+    sg_frame_hooked = true;
+}
+
+static void __inv_add(lv_area_t *inv, uint32_t *inv_cnt, const lv_area_t *area)
+{
+    uint32_t best = 0;
+    int32_t best_cost = INT32_MAX;
+    lv_area_t join;
+
+    for (uint32_t i = 0; i < *inv_cnt; i++) {
+        _lv_area_join(&join, &inv[i], area);
+        int32_t cost = (int32_t)lv_area_get_size(&join) - (int32_t)lv_area_get_size(&inv[i]) -
+                       (int32_t)lv_area_get_size(area);
+        if (cost <= 0) {
+            inv[i] = join;
+            return;
+        }
+        if (cost < best_cost) {
+            best_cost = cost;
+            best = i;
+        }
+    }
+
+    if (*inv_cnt < LV_GAME_INV_AREA_MAX) {
+        inv[(*inv_cnt)++] = *area;
+        return;
+    }
+
+    _lv_area_join(&inv[best], &inv[best], area);
+}
+
+static void __sprite_area(lv_obj_t *obj, lv_area_t *area)
+{
+    lv_coord_t ext = _lv_obj_get_ext_draw_size(obj);
+
+    lv_obj_get_coords(obj, area);
+    lv_area_increase(area, ext, ext);
+}
+
+static void __sprite_apply(const lv_game_move_t *move)
+{
+    if ((move->flags & (LV_GAME_MOVE_X | LV_GAME_MOVE_Y)) == (LV_GAME_MOVE_X | LV_GAME_MOVE_Y)) {
+        lv_obj_set_pos(move->obj, move->x, move->y);
+    } else if (move->flags & LV_GAME_MOVE_X) {
+        lv_obj_set_x(move->obj, move->x);
+    } else {
+        lv_obj_set_y(move->obj, move->y);
+    }
+}
+
+static void __loop_commit(lv_game_loop_t *loop)
+{
+    lv_area_t old[LV_GAME_SPRITE_MAX];
+    lv_area_t inv[LV_GAME_INV_AREA_MAX];
+    uint32_t inv_cnt = 0;
+    lv_obj_t *first = loop->moves[0].obj;
+    lv_disp_t *disp = lv_obj_get_disp(first);
+
+    // layout changes from outside the batch invalidate as usual
+    lv_obj_update_layout(first);
+
+    for (uint32_t i = 0; i < loop->move_cnt; i++) {
+        __sprite_area(loop->moves[i].obj, &old[i]);
+    }
+
+    // move without invalidating, the layout is updated here so it does not invalidate later
+    lv_disp_enable_invalidation(disp, false);
+    for (uint32_t i = 0; i < loop->move_cnt; i++) {
+        __sprite_apply(&loop->moves[i]);
+    }
+    lv_obj_update_layout(first);
+    lv_disp_enable_invalidation(disp, true);
+
+    for (uint32_t i = 0; i < loop->move_cnt; i++) {
+        lv_area_t area;
+        __sprite_area(loop->moves[i].obj, &area);
+        if (_lv_area_is_on(&old[i], &area)) {
+            _lv_area_join(&area, &old[i], &area);
+        } else {
+            __inv_add(inv, &inv_cnt, &old[i]);
+        }
+        __inv_add(inv, &inv_cnt, &area);
+    }
+
+    lv_obj_t *scr = lv_obj_get_screen(first);
+    for (uint32_t i = 0; i < inv_cnt; i++) {
+        lv_obj_invalidate_area(scr, &inv[i]);
+    }
+
+    loop->move_cnt = 0;
+}
+
+static void __loop_fps_update(lv_game_loop_t *loop, uint32_t now)
+{
+    uint32_t elaps = now - loop->fps_tick;
+
+    if (NULL == loop->fps_label || elaps < LV_GAME_FPS_PERIOD) {
+        return;
+    }
+
+    uint32_t frames = sg_frame_cnt - loop->fps_frame_cnt;
+    lv_label_set_text_fmt(loop->fps_label, "%d FPS  max %d ms  upd %d ms", (int)(frames * 1000 / elaps),
+                          (int)sg_frame_max_ms, (int)(frames ? loop->busy_ms / frames : loop->busy_ms));
+
+    loop->fps_tick = now;
+    loop->fps_frame_cnt = sg_frame_cnt;
+    loop->busy_ms = 0;
+    sg_frame_max_ms = 0;
+}
+
+static void __loop_timer_cb(lv_timer_t *t)
+{
+    lv_game_loop_t *loop = (lv_game_loop_t *)t->user_data;
+    uint32_t now = lv_tick_get();
+    uint32_t steps;
+
+    loop->acc_ms += now - loop->last_tick;
+    loop->last_tick = now;
+
+    steps = loop->acc_ms / loop->step_ms;
+    if (steps > LV_GAME_STEP_MAX) {
+        steps = LV_GAME_STEP_MAX;
+        loop->acc_ms = 0;
+    } else {
+        loop->acc_ms -= steps * loop->step_ms;
+    }
+
+    while (steps--) {
+        loop->update_cb(loop, loop->step_ms);
+    }
+
+    if (loop->wait_frame &&
+        (sg_frame_cnt != loop->wait_frame_cnt || lv_tick_elaps(loop->commit_tick) >= LV_GAME_FRAME_TIMEOUT)) {
+        loop->wait_frame = false;
+    }
+
+    if (!loop->wait_frame && loop->move_cnt) {
+        __loop_commit(loop);
+        loop->wait_frame = true;
+        loop->wait_frame_cnt = sg_frame_cnt;
+        loop->commit_tick = now;
+    }
+
+    loop->busy_ms += lv_tick_elaps(now);
+    __loop_fps_update(loop, now);
+}
+
+static lv_game_move_t *__sprite_move_get(lv_game_loop_t *loop, lv_obj_t *obj)
+{
+    for (uint32_t i = 0; i < loop->move_cnt; i++) {
+        if (loop->moves[i].obj == obj) {
+            return &loop->moves[i];
+        }
+    }
+
+    if (loop->move_cnt >= LV_GAME_SPRITE_MAX) {
+        return NULL;
+    }
+
+    lv_game_move_t *move = &loop->moves[loop->move_cnt++];
+    move->obj = obj;
+    move->flags = 0;
+
+    return move;
+}
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+lv_game_loop_t *lv_game_loop_create(uint32_t step_ms, lv_game_update_cb_t update_cb, void *user_data)
+{
+    lv_game_loop_t *loop = lv_mem_alloc(sizeof(lv_game_loop_t));
+
+    if (NULL == loop) {
+        return NULL;
+    }
+    lv_memset(loop, 0, sizeof(lv_game_loop_t));
+
+    __frame_hook();
+
+    loop->update_cb = update_cb;
+    loop->user_data = user_data;
+    loop->step_ms = step_ms ? step_ms : 1;
+    loop->last_tick = lv_tick_get();
+    loop->fps_tick = loop->last_tick;
+    loop->fps_frame_cnt = sg_frame_cnt;
+
+    loop->timer = lv_timer_create(__loop_timer_cb, loop->step_ms, loop);
+    if (NULL == loop->timer) {
+        lv_mem_free(loop);
+        return NULL;
+    }
+
+    lv_game_loop_show_fps(loop, LV_GAME_FPS_OVERLAY);
+
+    return loop;
+}
+
+void lv_game_loop_delete(lv_game_loop_t *loop)
+{
+    if (NULL == loop) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < loop->move_cnt; i++) {
+        __sprite_apply(&loop->moves[i]);
+    }
+
+    lv_game_loop_show_fps(loop, false);
+    lv_timer_del(loop->timer);
+    lv_mem_free(loop);
+}
+
+void *lv_game_loop_get_user_data(lv_game_loop_t *loop)
+{
+    return loop->user_data;
+}
+
+void lv_game_loop_show_fps(lv_game_loop_t *loop, bool en)
+{
+    if (!en) {
+        if (loop->fps_label) {
+            lv_obj_del(loop->fps_label);
+            loop->fps_label = NULL;
+        }
+        return;
+    }
+
+    if (loop->fps_label) {
+        return;
+    }
+
+    loop->fps_label = lv_label_create(lv_layer_top());
+    lv_obj_set_style_bg_color(loop->fps_label, lv_color_hex(0x000000), LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(loop->fps_label, LV_OPA_50, LV_PART_MAIN);
+    lv_obj_set_style_text_color(loop->fps_label, lv_color_hex(0xffffff), LV_PART_MAIN);
+    lv_obj_set_style_pad_all(loop->fps_label, 2, LV_PART_MAIN);
+    lv_obj_align(loop->fps_label, LV_ALIGN_BOTTOM_LEFT, 0, 0);
+    lv_label_set_text(loop->fps_label, "-- FPS");
+
+    loop->fps_tick = lv_tick_get();
+    loop->fps_frame_cnt = sg_frame_cnt;
+    loop->busy_ms = 0;
+}
+
+void lv_game_sprite_set_pos(lv_game_loop_t *loop, lv_obj_t *obj, lv_coord_t x, lv_coord_t y)
+{
+    lv_game_move_t *move = __sprite_move_get(loop, obj);
+
+    if (NULL == move) {
+        lv_obj_set_pos(obj, x, y);
+        return;
+    }
+
+    move->x = x;
+    move->y = y;
+    move->flags |= LV_GAME_MOVE_X | LV_GAME_MOVE_Y;
+}
+
+void lv_game_sprite_set_x(lv_game_loop_t *loop, lv_obj_t *obj, lv_coord_t x)
+{
+    lv_game_move_t *move = __sprite_move_get(loop, obj);
+
+    if (NULL == move) {
+        lv_obj_set_x(obj, x);
+        return;
+    }
+
+    move->x = x;
+    move->flags |= LV_GAME_MOVE_X;
+}
+
+void lv_game_sprite_set_y(lv_game_loop_t *loop, lv_obj_t *obj, lv_coord_t y)
+{
+    lv_game_move_t *move = __sprite_move_get(loop, obj);
+
+    if (NULL == move) {
+        lv_obj_set_y(obj, y);
+        return;
+    }
+
+    move->y = y;
+    move->flags |= LV_GAME_MOVE_Y;
+}
+
+void lv_game_sprite_remove(lv_game_loop_t *loop, lv_obj_t *obj)
+{
+    for (uint32_t i = 0; i < loop->move_cnt; i++) {
+        if (loop->moves[i].obj == obj) {
+            loop->moves[i] = loop->moves[--loop->move_cnt];
+            return;
+        }
+    }
+}
@@ -0,0 +1,133 @@
+/**
+ * @file lv_game_loop.h
+ *
+ * Game runtime shared by the games.
+ *
+ * A loop runs the game update with a fixed time step, so the game speed does
+ * not depend on how fast frames are drawn: a slow frame is followed by more
+ * update steps, not by slower sprites. Sprite moves done through the loop are
+ * staged and applied together once per displayed frame, with their old and new
+ * areas merged into a few invalidated areas instead of one per move. While the
+ * previous batch is not on the display yet new moves are only staged, so the
+ * updates never queue more drawing than the display can flush.
+ *
+ * Must be used from the LVGL thread.
+ */
+
+#ifndef LV_GAME_LOOP_H
+#define LV_GAME_LOOP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+// sprite moves that can be staged per frame, more are applied at once
+#ifndef LV_GAME_SPRITE_MAX
+#define LV_GAME_SPRITE_MAX 64
+#endif
+
+// areas the moves of one frame are merged into, LVGL keeps 32 before redrawing all
+#ifndef LV_GAME_INV_AREA_MAX
+#define LV_GAME_INV_AREA_MAX 16
+#endif
+
+// update steps run for one tick at most, longer stalls are dropped
+#ifndef LV_GAME_STEP_MAX
+#define LV_GAME_STEP_MAX 4
+#endif
+
+// show the FPS and frame time overlay on the loops
+#ifndef LV_GAME_FPS_OVERLAY
+#define LV_GAME_FPS_OVERLAY 0
+#endif
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct _lv_game_loop_t lv_game_loop_t;
+
+/**
+ * Game update
+ * @param loop      the loop
+ * @param step_ms   the time step, the same on every call
+ */
+typedef void (*lv_game_update_cb_t)(lv_game_loop_t *loop, uint32_t step_ms);
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Create a loop and start it
+ * @param step_ms   time step of the update in ms
+ * @param update_cb called for every step
+ * @param user_data passed back by lv_game_loop_get_user_data()
+ * @return          the loop, NULL if out of memory
+ */
+lv_game_loop_t *lv_game_loop_create(uint32_t step_ms, lv_game_update_cb_t update_cb, void *user_data);
+
+/**
+ * Stop a loop and apply its staged moves
+ * @param loop      the loop
+ */
+void lv_game_loop_delete(lv_game_loop_t *loop);
+
+/**
+ * Get the user data of a loop
+ * @param loop      the loop
+ * @return          user_data given to lv_game_loop_create()
+ */
+void *lv_game_loop_get_user_data(lv_game_loop_t *loop);
+
+/**
+ * Show or hide the FPS and frame time overlay
+ * @param loop      the loop
+ * @param en        true to show it
+ */
+void lv_game_loop_show_fps(lv_game_loop_t *loop, bool en);
+
+/**
+ * Stage a move of a sprite
+ * @param loop      the loop
+ * @param obj       the sprite, an object positioned with x and y
+ * @param x         the new x
+ * @param y         the new y
+ */
+void lv_game_sprite_set_pos(lv_game_loop_t *loop, lv_obj_t *obj, lv_coord_t x, lv_coord_t y);
+
+/**
+ * Stage a horizontal move of a sprite
+ * @param loop      the loop
+ * @param obj       the sprite
+ * @param x         the new x
+ */
+void lv_game_sprite_set_x(lv_game_loop_t *loop, lv_obj_t *obj, lv_coord_t x);
+
+/**
+ * Stage a vertical move of a sprite
+ * @param loop      the loop
+ * @param obj       the sprite
+ * @param y         the new y
+ */
+void lv_game_sprite_set_y(lv_game_loop_t *loop, lv_obj_t *obj, lv_coord_t y);
+
+/**
+ * Drop the staged moves of a sprite, must be called before deleting it
+ * @param loop      the loop
+ * @param obj       the sprite
+ */
+void lv_game_sprite_remove(lv_game_loop_t *loop, lv_obj_t *obj);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*LV_GAME_LOOP_H*/
@@ -1,5 +1,6 @@
 #include "lvgl.h"
 #include "stdlib.h"
+#include "lv_game_loop.h"
 
 #define max_zb_count             30   // ��ʬ�������
 #define max_quantity             15   // ÿ��ֲ���������
@@ -20,6 +21,7 @@
 #define jiguang_price            200
 #define dici_price               150
 #define start_money              1000
+#define game_step_ms             20   // update step of bullets and zombies, ms
 
 static int chanzi_btn_select;
 static lv_obj_t *jiguangdou_btn, *start_btn, *gameover_btn;
@@ -41,7 +43,7 @@ static lv_timer_t *timer_newshine;
 static lv_timer_t *timer_zidan_fly;
 static lv_timer_t *timer_hit_test;
 static lv_timer_t *timer_car_test;
-static lv_timer_t *timer_zidan_refr_pos;
+static lv_game_loop_t *game_loop;
 static lv_obj_t *mini_btn;
 static lv_obj_t *bar_btn;
 
@@ -142,6 +144,7 @@ typedef struct _zb_type {
     int blood;
     int x;
     int y;
+    unsigned int walk_ms;
 } zb_type;
 
 typedef struct {
@@ -248,11 +251,11 @@ static void nuclear_anim_cb(void *var, int32_t v);
 static void zb_dead_anim(zb_type *xzb);
 static void carzb_boom_anim_cb(void *var, int32_t v);
 static void anim_zb_dead_start_cb(lv_anim_t *a);
-static void timer_zidan_refr_pos_cb(lv_timer_t *t);
+static void game_update_cb(lv_game_loop_t *loop, uint32_t step_ms);
 static void jumpzb_jump_cb(void *var, int32_t v);
 static void btn_cliked_cb(lv_event_t *e);
 static void carzb_del_cb(zb_type *xzb);
-static void zb_left_move_cb(void *var, int32_t v);
+static void zb_left_move(zb_type *zb, uint32_t step_ms);
 static void Normalzb_start_anim_cb(zb_type *xzb);
 static void jumpzb_start_anim_cb(zb_type *xzb);
 static void carzb_start_anim_cb(zb_type *xzb);
@@ -420,7 +423,7 @@ static void game_start(lv_event_t *e)
 
     timer_newzb = lv_timer_create(zb_create_cb, zb_period, 0);
     timer_newshine = lv_timer_create(newshine_cb, shine_period, 0);
-    timer_zidan_refr_pos = lv_timer_create(timer_zidan_refr_pos_cb, 20, 0);
+    game_loop = lv_game_loop_create(game_step_ms, game_update_cb, 0);
     timer_car_test = lv_timer_create(timer_car_test_cb, 1000, 0);
     lv_timer_ready(timer_newshine);
 }
@@ -693,7 +696,7 @@ static void anim_zb_delect_cb(lv_anim_t *a)
     zb_type *user = (zb_type *)a->user_data;
     user->alive = 0;
     user->blood = 0;
-    lv_anim_del(user, zb_left_move_cb);
+    lv_game_sprite_remove(game_loop, user->zb);
     lv_obj_del(user->zb);
 }
 
@@ -738,20 +741,10 @@ static void zb_create_cb(lv_timer_t *t)
             lv_img_set_src(zb_matrix[j].zb, zb_matrix[j].zb_class->zb_img_src);
             zb_matrix[j].y = rand() % 5;
             zb_matrix[j].x = 480;
+            zb_matrix[j].walk_ms = 0;
             lv_obj_set_pos(zb_matrix[j].zb, 480, zb_matrix[j].y * 54 + 35);
             lv_img_set_pivot(zb_matrix[j].zb, 15, 59);
 
-            lv_anim_t a1;
-            lv_anim_init(&a1);
-            lv_anim_set_var(&a1, &zb_matrix[j]);
-            lv_anim_set_exec_cb(&a1, zb_left_move_cb);
-            lv_anim_set_time(&a1, zb_matrix[j].zb_class->move_time * 10);
-            lv_anim_set_values(&a1, 0, 10);
-            lv_anim_set_delay(&a1, zb_matrix[j].zb_class->move_time);
-            lv_anim_set_repeat_delay(&a1, zb_matrix[j].zb_class->move_time);
-            lv_anim_set_repeat_count(&a1, LV_ANIM_REPEAT_INFINITE);
-            lv_anim_start(&a1);
-
             zb_matrix[j].zb_class->zb_start_anim_cb(&zb_matrix[j]);
 
             return;
@@ -815,13 +808,17 @@ static void qiqiuzb_start_anim_cb(zb_type *xzb)
     lv_anim_start(&a);
 }
 
-static void zb_left_move_cb(void *var, int32_t v)
+// a zombie waits move_time, then walks 1 pixel per 10ms for 10 * move_time
+static void zb_left_move(zb_type *zb, uint32_t step_ms)
 {
-    zb_type *zb = (zb_type *)var;
+    unsigned int cycle = zb->zb_class->move_time * 11;
 
     if (zb->blood > 0) {
-        zb->x--;
-        lv_obj_set_x(zb->zb, zb->x);
+        zb->walk_ms = (zb->walk_ms + step_ms) % cycle;
+        if (zb->walk_ms >= zb->zb_class->move_time) {
+            zb->x -= step_ms / 10;
+            lv_game_sprite_set_x(game_loop, zb->zb, zb->x);
+        }
     }
 }
 
@@ -887,20 +884,27 @@ static void add_zidan_cb(lv_timer_t *t)
     }
 }
 
-static void timer_zidan_refr_pos_cb(lv_timer_t *t)
+static void game_update_cb(lv_game_loop_t *loop, uint32_t step_ms)
 {
     int i, j;
 
+    for (j = 0; j < max_zb_count; j++) {
+        if (zb_matrix[j].alive == 1) {
+            zb_left_move(&zb_matrix[j], step_ms);
+        }
+    }
+
     for (i = 0; i < max_quantity; i++) {
         if (zidan[i].alive == 1) {
             zidan[i].x += zidan_speed;
 
             if (zidan[i].x > 490) {
                 zidan[i].alive = 0;
+                lv_game_sprite_remove(loop, zidan[i].zidan);
                 lv_obj_del(zidan[i].zidan);
                 continue;
             } else {
-                lv_obj_set_x(zidan[i].zidan, zidan[i].x);
+                lv_game_sprite_set_x(loop, zidan[i].zidan, zidan[i].x);
             }
 
             for (j = 0; j < max_zb_count; j++) {
@@ -913,13 +917,13 @@ static void timer_zidan_refr_pos_cb(lv_timer_t *t)
 
                             lv_obj_t *zidan_split = lv_img_create(map1);
                             lv_img_set_src(zidan_split, &zidan_split_img);
-                            lv_obj_set_pos(zidan_split, lv_obj_get_x(zidan[i].zidan) - 8,
-                                           lv_obj_get_y(zidan[i].zidan) - 8);
+                            lv_obj_set_pos(zidan_split, zidan[i].x - 8, zidan[i].y * 54 + 46 - 8);
 #if LVGL_VERSION_MAJOR == 9
                             lv_obj_delete_delayed(zidan_split, 500);
 #else
                             lv_obj_del_delayed(zidan_split, 500);
 #endif
+                            lv_game_sprite_remove(loop, zidan[i].zidan);
                             lv_obj_del(zidan[i].zidan);
 
                             if (zb_matrix[j].blood == 0) {
@@ -1846,7 +1850,8 @@ static void exit_game_cb(lv_event_t *e)
     lv_anim_del_all();
     lv_timer_del(timer_newzb);
     lv_timer_del(timer_newshine);
-    lv_timer_del(timer_zidan_refr_pos);
+    lv_game_loop_delete(game_loop);
+    game_loop = NULL;
     lv_timer_del(timer_car_test);
     init_all();
     lv_obj_del(screen);
@@ -0,0 +1,146 @@
+/**
+ * @file ai_asset_pack.h
+ * @brief Images stored in a dedicated flash partition, loaded on use into a RAM cache.
+ *
+ * The pack is built on the host with tools/asset_pack.py from the LVGL image C
+ * files, GIFs and sprites of an app and flashed into its own partition, so the
+ * firmware no longer carries the pixel arrays and the images can be updated
+ * without the code, through an OTA of their own firmware type. An image is read
+ * and decompressed on first use and kept in an LRU cache, hot images are served
+ * from RAM. Images are shown by name: lv_image_set_src(img, AI_ASSET_PATH("name"))
+ * goes through the pack decoder, and ai_asset_pack_get() hands out the data for
+ * players that need it in memory, e.g. lv_port_anim for GIFs and sprites.
+ *
+ * Needs LVGL v9.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __AI_ASSET_PACK_H__
+#define __AI_ASSET_PACK_H__
+
+#include "tuya_cloud_types.h"
+#include "tuya_ota.h"
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+// partition holding the pack
+#ifndef AI_ASSET_PACK_FLASH_TYPE
+#define AI_ASSET_PACK_FLASH_TYPE TUYA_FLASH_TYPE_USER0
+#endif
+
+// ram for loaded images, images in use are kept beyond it
+#ifndef AI_ASSET_PACK_CACHE_SIZE
+#if defined(ENABLE_EXT_RAM) && (ENABLE_EXT_RAM == 1)
+#define AI_ASSET_PACK_CACHE_SIZE (512 * 1024)
+#else
+#define AI_ASSET_PACK_CACHE_SIZE (64 * 1024)
+#endif
+#endif
+
+// firmware type the asset pack is released as on the Tuya platform
+#ifndef AI_ASSET_PACK_OTA_CHANNEL
+#define AI_ASSET_PACK_OTA_CHANNEL 10
+#endif
+
+#define AI_ASSET_PACK_NAME_LEN 32
+
+// image source of an asset for lv_image_set_src()
+#define AI_ASSET_PATH_PREFIX "asset:"
+#define AI_ASSET_PATH(name)  AI_ASSET_PATH_PREFIX name
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    uint32_t hit;
+    uint32_t miss;
+    uint32_t flash_bytes; // bytes read from flash on misses
+    uint32_t cache_used;
+    uint16_t asset_num;
+} AI_ASSET_PACK_STATS_T;
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+/**
+ * @brief Loads the pack index from flash and registers the LVGL image decoder.
+ * @param None
+ * @note Call it after lv_init(). Without a pack the decoder is still registered,
+ *       a pack flashed by an update is used once it is complete.
+ * @return OPERATE_RET - OPRT_OK on success, OPRT_NOT_FOUND if no pack is flashed.
+ */
+OPERATE_RET ai_asset_pack_init(void);
+
+/**
+ * @brief Gets an asset, loading it if it is not cached.
+ * @param name The asset name, the lv_image_dsc_t symbol or file name the pack
+ *             was built from, e.g. "happy".
+ * @return The image, valid until ai_asset_pack_put(), or NULL if the pack does
+ *         not contain it.
+ */
+const lv_image_dsc_t *ai_asset_pack_get(const char *name);
+
+/**
+ * @brief Releases an asset got by ai_asset_pack_get(), it stays cached.
+ * @param img The image, NULL is ignored.
+ * @return None
+ */
+void ai_asset_pack_put(const lv_image_dsc_t *img);
+
+/**
+ * @brief Gets the counters of the cache.
+ * @param stats Filled with the counters.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_asset_pack_get_stats(AI_ASSET_PACK_STATS_T *stats);
+
+/**
+ * @brief Starts writing a new pack, the current one is closed.
+ * @param total_len Length of the pack file.
+ * @note Assets got before keep their data until they are put, new gets fail
+ *       until ai_asset_pack_update_end() succeeds.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_asset_pack_update_begin(uint32_t total_len);
+
+/**
+ * @brief Writes a part of the new pack.
+ * @param offset Offset of the data in the pack file.
+ * @param data The data.
+ * @param len Length of the data.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_asset_pack_update_write(uint32_t offset, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Checks the written pack and opens it.
+ * @param None
+ * @note The pack header is written last, a pack that was not completed or
+ *       fails its CRC is never opened.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_asset_pack_update_end(void);
+
+/**
+ * @brief OTA handler for tuya_iot_config_t.ota_handler, updates the pack
+ *        when the OTA is of AI_ASSET_PACK_OTA_CHANNEL.
+ * @param msg The OTA message.
+ * @param event The OTA event.
+ * @return None
+ */
+void ai_asset_pack_ota_handler(tuya_ota_msg_t *msg, tuya_ota_event_t *event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AI_ASSET_PACK_H__ */
@@ -0,0 +1,718 @@
+/**
+ * @file ai_asset_pack.c
+ * @brief Images stored in a dedicated flash partition, loaded on use into a RAM cache.
+ *
+ * Pack layout, little endian:
+ *   ASSET_PACK_HEAD_T
+ *   ASSET_PACK_ENTRY_T x asset_num, sorted by name
+ *   the asset data, each 4 byte aligned
+ *
+ * The data of an asset is what the data of its lv_image_dsc_t was, optionally
+ * run length coded as in the font pack. The entries stay in RAM, a miss costs
+ * one binary search there and one flash read. The header carries a CRC of the
+ * rest of the pack, an update writes the header last once the CRC matches.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#include <string.h>
+
+#include "tkl_memory.h"
+#include "tkl_flash.h"
+
+#include "tal_api.h"
+#include "crc32i.h"
+#include "tal_boot_mark.h"
+
+#include "ai_asset_pack.h"
+
+#if LVGL_VERSION_MAJOR < 9
+#error "ai_asset_pack needs LVGL v9"
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define ASSET_PACK_MAGIC   0x54534141 // "AAST"
+#define ASSET_PACK_VERSION 1
+
+#define ASSET_FLAG_RLE 0x01 // the data is run length coded
+
+#define ASSET_IDX_NONE     0xFFFF
+#define ASSET_SECTOR_SIZE  0x1000
+#define ASSET_CRC_READ_LEN 1024
+
+#if defined(ENABLE_EXT_RAM) && (ENABLE_EXT_RAM == 1)
+#define ASSET_PACK_MALLOC tkl_system_psram_malloc
+#define ASSET_PACK_FREE   tkl_system_psram_free
+#else
+#define ASSET_PACK_MALLOC tal_malloc
+#define ASSET_PACK_FREE   tal_free
+#endif
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t asset_num;
+    uint32_t total_len;
+    uint32_t crc32; // of the bytes after the header
+    uint32_t reserved;
+} ASSET_PACK_HEAD_T;
+
+typedef struct {
+    char name[AI_ASSET_PACK_NAME_LEN];
+    uint32_t offset;     // from the pack start
+    uint32_t stored_len; // length in flash
+    uint32_t data_len;   // length once decoded, data_size of the image
+    uint8_t cf;          // lv_color_format_t
+    uint8_t flags;
+    uint16_t w;
+    uint16_t h;
+    uint16_t stride; // 0 to compute it from w and cf
+} ASSET_PACK_ENTRY_T;
+
+typedef struct _asset_cache {
+    lv_image_dsc_t img; // first, the pointer handed out is the node
+    struct _asset_cache *next; // most recently used first
+    uint16_t idx;              // entry, ASSET_IDX_NONE once its pack was replaced
+    uint16_t ref;
+    uint32_t size;
+    uint8_t buf[];
+} ASSET_CACHE_T;
+
+typedef struct {
+    bool is_init;
+    bool is_open;
+    bool updating;
+    uint32_t base;
+    uint32_t part_size;
+    MUTEX_HANDLE mutex;
+
+    uint16_t asset_num;
+    ASSET_PACK_ENTRY_T *entry;
+
+    ASSET_CACHE_T *cache;
+    lv_image_decoder_t *decoder;
+
+    // header of the pack being written, written to flash last
+    ASSET_PACK_HEAD_T update_head;
+    uint32_t update_len;
+
+    AI_ASSET_PACK_STATS_T stats;
+} ASSET_PACK_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static ASSET_PACK_T sg_asset_pack = {0};
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static int32_t __asset_find(const char *name)
+{
+    int32_t low = 0, high = (int32_t)sg_asset_pack.asset_num - 1, mid = 0, cmp = 0;
+
+    while (low <= high) {
+        mid = (low + high) / 2;
+        cmp = strncmp(sg_asset_pack.entry[mid].name, name, AI_ASSET_PACK_NAME_LEN);
+        if (cmp == 0) {
+            return mid;
+        } else if (cmp < 0) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * control byte c < 0x80: c + 1 literal bytes follow
+ * control byte c >= 0x80: the next byte repeats c - 0x80 + 2 times
+ */
+static OPERATE_RET __rle_decode(const uint8_t *in, uint32_t in_len, uint8_t *out, uint32_t out_len)
+{
+    uint32_t i = 0, o = 0, n = 0;
+    uint8_t c = 0;
+
+    while (i < in_len && o < out_len) {
+        c = in[i++];
+        if (c < 0x80) {
+            n = c + 1;
+            if (i + n > in_len || o + n > out_len) {
+                return OPRT_COM_ERROR;
+            }
+            memcpy(&out[o], &in[i], n);
+            i += n;
+        } else {
+            n = c - 0x80 + 2;
+            if (i >= in_len || o + n > out_len) {
+                return OPRT_COM_ERROR;
+            }
+            memset(&out[o], in[i++], n);
+        }
+        o += n;
+    }
+
+    return (o == out_len) ? OPRT_OK : OPRT_COM_ERROR;
+}
+
+static void __cache_free(ASSET_CACHE_T *node)
+{
+    ASSET_CACHE_T **link = &sg_asset_pack.cache;
+
+    while (*link && *link != node) {
+        link = &(*link)->next;
+    }
+    if (*link) {
+        *link = node->next;
+    }
+
+    sg_asset_pack.stats.cache_used -= node->size;
+    ASSET_PACK_FREE(node);
+}
+
+// drops unused images from the least recently used until size more bytes fit
+static void __cache_reserve(uint32_t size)
+{
+    ASSET_CACHE_T *node = NULL, *victim = NULL;
+
+    while (sg_asset_pack.stats.cache_used + size > AI_ASSET_PACK_CACHE_SIZE) {
+        victim = NULL;
+        for (node = sg_asset_pack.cache; node; node = node->next) {
+            if (0 == node->ref) {
+                victim = node;
+            }
+        }
+        if (NULL == victim) {
+            return;
+        }
+        __cache_free(victim);
+    }
+}
+
+static ASSET_CACHE_T *__cache_load(uint16_t idx)
+{
+    const ASSET_PACK_ENTRY_T *entry = &sg_asset_pack.entry[idx];
+    ASSET_CACHE_T *node = NULL;
+    uint8_t *data = NULL, *tmp = NULL;
+    uint32_t addr = sg_asset_pack.base + entry->offset;
+    uint32_t size = sizeof(ASSET_CACHE_T) + entry->data_len + LV_DRAW_BUF_ALIGN;
+    OPERATE_RET rt = OPRT_OK;
+
+    __cache_reserve(size);
+
+    node = ASSET_PACK_MALLOC(size);
+    if (NULL == node) {
+        PR_ERR("asset %s: no memory for %d bytes", entry->name, size);
+        return NULL;
+    }
+    memset(node, 0, sizeof(ASSET_CACHE_T));
+    data = lv_draw_buf_align(node->buf, entry->cf);
+
+    if (entry->flags & ASSET_FLAG_RLE) {
+        tmp = ASSET_PACK_MALLOC(entry->stored_len);
+        if (NULL == tmp) {
+            ASSET_PACK_FREE(node);
+            return NULL;
+        }
+        rt = tkl_flash_read(addr, tmp, entry->stored_len);
+        if (OPRT_OK == rt) {
+            rt = __rle_decode(tmp, entry->stored_len, data, entry->data_len);
+        }
+        ASSET_PACK_FREE(tmp);
+    } else {
+        rt = tkl_flash_read(addr, data, MIN(entry->stored_len, entry->data_len));
+    }
+    if (OPRT_OK != rt) {
+        PR_ERR("asset %s load err:%d", entry->name, rt);
+        ASSET_PACK_FREE(node);
+        return NULL;
+    }
+    sg_asset_pack.stats.flash_bytes += entry->stored_len;
+
+    node->img.header.magic = LV_IMAGE_HEADER_MAGIC;
+    node->img.header.cf = entry->cf;
+    node->img.header.w = entry->w;
+    node->img.header.h = entry->h;
+    node->img.header.stride = entry->stride;
+    node->img.data_size = entry->data_len;
+    node->img.data = data;
+    node->idx = idx;
+    node->size = size;
+
+    node->next = sg_asset_pack.cache;
+    sg_asset_pack.cache = node;
+    sg_asset_pack.stats.cache_used += size;
+
+    return node;
+}
+
+static const lv_image_dsc_t *__asset_get(const char *name)
+{
+    ASSET_CACHE_T *node = NULL, **link = NULL;
+    int32_t idx = 0;
+
+    if (!sg_asset_pack.is_open || NULL == name) {
+        return NULL;
+    }
+
+    idx = __asset_find(name);
+    if (idx < 0) {
+        return NULL;
+    }
+
+    for (link = &sg_asset_pack.cache; *link; link = &(*link)->next) {
+        if ((*link)->idx == idx) {
+            break;
+        }
+    }
+
+    if (*link) {
+        sg_asset_pack.stats.hit++;
+        node = *link;
+        // move to the front
+        *link = node->next;
+        node->next = sg_asset_pack.cache;
+        sg_asset_pack.cache = node;
+    } else {
+        sg_asset_pack.stats.miss++;
+        node = __cache_load((uint16_t)idx);
+        if (NULL == node) {
+            return NULL;
+        }
+    }
+
+    node->ref++;
+
+    return &node->img;
+}
+
+/**
+ * @brief Gets an asset, loading it if it is not cached.
+ * @param name The asset name, the lv_image_dsc_t symbol or file name the pack
+ *             was built from, e.g. "happy".
+ * @return The image, valid until ai_asset_pack_put(), or NULL if the pack does
+ *         not contain it.
+ */
+const lv_image_dsc_t *ai_asset_pack_get(const char *name)
+{
+    const lv_image_dsc_t *img = NULL;
+
+    if (!sg_asset_pack.is_init) {
+        return NULL;
+    }
+
+    tal_mutex_lock(sg_asset_pack.mutex);
+    img = __asset_get(name);
+    tal_mutex_unlock(sg_asset_pack.mutex);
+
+    return img;
+}
+
+/**
+ * @brief Releases an asset got by ai_asset_pack_get(), it stays cached.
+ * @param img The image, NULL is ignored.
+ * @return None
+ */
+void ai_asset_pack_put(const lv_image_dsc_t *img)
+{
+    ASSET_CACHE_T *node = (ASSET_CACHE_T *)img;
+
+    if (NULL == img || !sg_asset_pack.is_init) {
+        return;
+    }
+
+    tal_mutex_lock(sg_asset_pack.mutex);
+    if (node->ref) {
+        node->ref--;
+    }
+    if (0 == node->ref && ASSET_IDX_NONE == node->idx) {
+        __cache_free(node);
+    }
+    tal_mutex_unlock(sg_asset_pack.mutex);
+}
+
+static bool __decoder_is_drawable(uint8_t cf)
+{
+    // raw data is played by other decoders, indexed images would need the palette split off
+    return cf != LV_COLOR_FORMAT_RAW && cf != LV_COLOR_FORMAT_RAW_ALPHA && !LV_COLOR_FORMAT_IS_INDEXED(cf);
+}
+
+static const char *__decoder_src_name(const void *src)
+{
+    if (lv_image_src_get_type(src) != LV_IMAGE_SRC_FILE) {
+        return NULL;
+    }
+    if (strncmp(src, AI_ASSET_PATH_PREFIX, sizeof(AI_ASSET_PATH_PREFIX) - 1)) {
+        return NULL;
+    }
+
+    return (const char *)src + sizeof(AI_ASSET_PATH_PREFIX) - 1;
+}
+
+static lv_result_t __decoder_info(lv_image_decoder_t *decoder, const void *src, lv_image_header_t *header)
+{
+    const char *name = __decoder_src_name(src);
+    const ASSET_PACK_ENTRY_T *entry = NULL;
+    lv_result_t res = LV_RESULT_INVALID;
+    int32_t idx = 0;
+
+    LV_UNUSED(decoder);
+
+    if (NULL == name) {
+        return LV_RESULT_INVALID;
+    }
+
+    tal_mutex_lock(sg_asset_pack.mutex);
+    idx = sg_asset_pack.is_open ? __asset_find(name) : -1;
+    if (idx >= 0 && __decoder_is_drawable(sg_asset_pack.entry[idx].cf)) {
+        entry = &sg_asset_pack.entry[idx];
+        header->magic = LV_IMAGE_HEADER_MAGIC;
+        header->cf = entry->cf;
+        header->w = entry->w;
+        header->h = entry->h;
+        header->stride = entry->stride;
+        res = LV_RESULT_OK;
+    }
+    tal_mutex_unlock(sg_asset_pack.mutex);
+
+    return res;
+}
+
+// the image is drawn from the cached data, the cache keeps it until close
+static lv_result_t __decoder_open(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+{
+    const lv_image_dsc_t *img = ai_asset_pack_get(__decoder_src_name(dsc->src));
+    lv_draw_buf_t *buf = NULL;
+
+    LV_UNUSED(decoder);
+
+    if (NULL == img) {
+        return LV_RESULT_INVALID;
+    }
+
+    buf = lv_malloc(sizeof(lv_draw_buf_t));
+    if (NULL == buf) {
+        ai_asset_pack_put(img);
+        return LV_RESULT_INVALID;
+    }
+
+    if (LV_RESULT_OK != lv_draw_buf_init(buf, img->header.w, img->header.h, img->header.cf, img->header.stride,
+                                         (void *)img->data, img->data_size)) {
+        lv_free(buf);
+        ai_asset_pack_put(img);
+        return LV_RESULT_INVALID;
+    }
+
+    dsc->decoded = buf;
+    dsc->user_data = (void *)img;
+
+    return LV_RESULT_OK;
+}
+
+static void __decoder_close(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+{
+    LV_UNUSED(decoder);
+
+    lv_free((void *)dsc->decoded);
+    dsc->decoded = NULL;
+    ai_asset_pack_put(dsc->user_data);
+}
+
+// loads the index of the pack in flash, called with the mutex
+static OPERATE_RET __pack_open(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    ASSET_PACK_HEAD_T head;
+    uint32_t size = 0;
+
+    TUYA_CALL_ERR_RETURN(tkl_flash_read(sg_asset_pack.base, (uint8_t *)&head, sizeof(ASSET_PACK_HEAD_T)));
+    size = head.asset_num * sizeof(ASSET_PACK_ENTRY_T);
+    if (head.magic != ASSET_PACK_MAGIC || head.version != ASSET_PACK_VERSION ||
+        head.total_len > sg_asset_pack.part_size || sizeof(ASSET_PACK_HEAD_T) + size > head.total_len) {
+        PR_NOTICE("no asset pack in flash");
+        return OPRT_NOT_FOUND;
+    }
+
+    sg_asset_pack.entry = ASSET_PACK_MALLOC(size);
+    TUYA_CHECK_NULL_RETURN(sg_asset_pack.entry, OPRT_MALLOC_FAILED);
+
+    rt = tkl_flash_read(sg_asset_pack.base + sizeof(ASSET_PACK_HEAD_T), (uint8_t *)sg_asset_pack.entry, size);
+    if (OPRT_OK != rt) {
+        ASSET_PACK_FREE(sg_asset_pack.entry);
+        sg_asset_pack.entry = NULL;
+        return rt;
+    }
+
+    sg_asset_pack.asset_num = head.asset_num;
+    sg_asset_pack.stats.asset_num = head.asset_num;
+    sg_asset_pack.is_open = true;
+
+    PR_NOTICE("asset pack loaded: %d assets, %d bytes", head.asset_num, head.total_len);
+
+    return OPRT_OK;
+}
+
+// called with the mutex, images in use keep their data until put
+static void __pack_close(void)
+{
+    ASSET_CACHE_T *node = sg_asset_pack.cache, *next = NULL;
+
+    while (node) {
+        next = node->next;
+        node->idx = ASSET_IDX_NONE;
+        if (0 == node->ref) {
+            __cache_free(node);
+        }
+        node = next;
+    }
+
+    if (sg_asset_pack.entry) {
+        ASSET_PACK_FREE(sg_asset_pack.entry);
+        sg_asset_pack.entry = NULL;
+    }
+    sg_asset_pack.asset_num = 0;
+    sg_asset_pack.stats.asset_num = 0;
+    sg_asset_pack.is_open = false;
+}
+
+/**
+ * @brief Loads the pack index from flash and registers the LVGL image decoder.
+ * @param None
+ * @note Call it after lv_init(). Without a pack the decoder is still registered,
+ *       a pack flashed by an update is used once it is complete.
+ * @return OPERATE_RET - OPRT_OK on success, OPRT_NOT_FOUND if no pack is flashed.
+ */
+OPERATE_RET ai_asset_pack_init(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    TUYA_FLASH_BASE_INFO_T flash_info;
+
+    if (sg_asset_pack.is_init) {
+        return sg_asset_pack.is_open ? OPRT_OK : OPRT_NOT_FOUND;
+    }
+
+    memset(&flash_info, 0, sizeof(TUYA_FLASH_BASE_INFO_T));
+    TUYA_CALL_ERR_RETURN(tkl_flash_get_one_type_info(AI_ASSET_PACK_FLASH_TYPE, &flash_info));
+    if (0 == flash_info.partition_num) {
+        return OPRT_NOT_FOUND;
+    }
+
+    sg_asset_pack.base = flash_info.partition[0].start_addr;
+    sg_asset_pack.part_size = flash_info.partition[0].size;
+
+    TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&sg_asset_pack.mutex));
+
+    sg_asset_pack.decoder = lv_image_decoder_create();
+    if (NULL == sg_asset_pack.decoder) {
+        tal_mutex_release(sg_asset_pack.mutex);
+        memset(&sg_asset_pack, 0, sizeof(ASSET_PACK_T));
+        return OPRT_MALLOC_FAILED;
+    }
+    lv_image_decoder_set_info_cb(sg_asset_pack.decoder, __decoder_info);
+    lv_image_decoder_set_open_cb(sg_asset_pack.decoder, __decoder_open);
+    lv_image_decoder_set_close_cb(sg_asset_pack.decoder, __decoder_close);
+
+    sg_asset_pack.is_init = true;
+
+    tal_mutex_lock(sg_asset_pack.mutex);
+    rt = __pack_open();
+    tal_mutex_unlock(sg_asset_pack.mutex);
+    tal_boot_mark("asset pack opened");
+
+    return rt;
+}
+
+/**
+ * @brief Gets the counters of the cache.
+ * @param stats Filled with the counters.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_asset_pack_get_stats(AI_ASSET_PACK_STATS_T *stats)
+{
+    if (NULL == stats) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (!sg_asset_pack.is_init) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    tal_mutex_lock(sg_asset_pack.mutex);
+    memcpy(stats, &sg_asset_pack.stats, sizeof(AI_ASSET_PACK_STATS_T));
+    tal_mutex_unlock(sg_asset_pack.mutex);
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Starts writing a new pack, the current one is closed.
+ * @param total_len Length of the pack file.
+ * @note Assets got before keep their data until they are put, new gets fail
+ *       until ai_asset_pack_update_end() succeeds.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_asset_pack_update_begin(uint32_t total_len)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint32_t erase_len = (total_len + ASSET_SECTOR_SIZE - 1) & ~(ASSET_SECTOR_SIZE - 1);
+
+    if (!sg_asset_pack.is_init) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+    if (total_len <= sizeof(ASSET_PACK_HEAD_T) || erase_len > sg_asset_pack.part_size) {
+        PR_ERR("asset pack of %d bytes does not fit the partition", total_len);
+        return OPRT_EXCEED_UPPER_LIMIT;
+    }
+
+    tal_mutex_lock(sg_asset_pack.mutex);
+    __pack_close();
+    sg_asset_pack.updating = true;
+    memset(&sg_asset_pack.update_head, 0, sizeof(ASSET_PACK_HEAD_T));
+    sg_asset_pack.update_len = total_len;
+    tal_mutex_unlock(sg_asset_pack.mutex);
+
+    // the header is erased first, an interrupted update leaves no pack
+    rt = tkl_flash_erase(sg_asset_pack.base, erase_len);
+    if (OPRT_OK != rt) {
+        PR_ERR("asset pack erase err:%d", rt);
+        sg_asset_pack.updating = false;
+    }
+
+    return rt;
+}
+
+/**
+ * @brief Writes a part of the new pack.
+ * @param offset Offset of the data in the pack file.
+ * @param data The data.
+ * @param len Length of the data.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_asset_pack_update_write(uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    uint32_t n = 0;
+
+    if (!sg_asset_pack.updating || NULL == data) {
+        return OPRT_INVALID_PARM;
+    }
+    if (offset + len > sg_asset_pack.update_len) {
+        return OPRT_EXCEED_UPPER_LIMIT;
+    }
+
+    if (offset < sizeof(ASSET_PACK_HEAD_T)) {
+        n = MIN(len, sizeof(ASSET_PACK_HEAD_T) - offset);
+        memcpy((uint8_t *)&sg_asset_pack.update_head + offset, data, n);
+        offset += n;
+        data += n;
+        len -= n;
+    }
+
+    if (0 == len) {
+        return OPRT_OK;
+    }
+
+    return tkl_flash_write(sg_asset_pack.base + offset, data, len);
+}
+
+/**
+ * @brief Checks the written pack and opens it.
+ * @param None
+ * @note The pack header is written last, a pack that was not completed or
+ *       fails its CRC is never opened.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_asset_pack_update_end(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    ASSET_PACK_HEAD_T *head = &sg_asset_pack.update_head;
+    uint8_t *buf = NULL;
+    uint32_t crc = 0, addr = 0, n = 0;
+
+    if (!sg_asset_pack.updating) {
+        return OPRT_INVALID_PARM;
+    }
+    sg_asset_pack.updating = false;
+
+    if (head->magic != ASSET_PACK_MAGIC || head->version != ASSET_PACK_VERSION ||
+        head->total_len != sg_asset_pack.update_len) {
+        PR_ERR("asset pack update is no pack");
+        return OPRT_COM_ERROR;
+    }
+
+    buf = tal_malloc(ASSET_CRC_READ_LEN);
+    TUYA_CHECK_NULL_RETURN(buf, OPRT_MALLOC_FAILED);
+
+    crc = hash_crc32i_init();
+    for (addr = sizeof(ASSET_PACK_HEAD_T); addr < head->total_len; addr += n) {
+        n = MIN(ASSET_CRC_READ_LEN, head->total_len - addr);
+        rt = tkl_flash_read(sg_asset_pack.base + addr, buf, n);
+        if (OPRT_OK != rt) {
+            break;
+        }
+        crc = hash_crc32i_update(crc, buf, n);
+    }
+    tal_free(buf);
+    TUYA_CALL_ERR_RETURN(rt);
+
+    if (hash_crc32i_finish(crc) != head->crc32) {
+        PR_ERR("asset pack update crc err");
+        return OPRT_COM_ERROR;
+    }
+
+    TUYA_CALL_ERR_RETURN(tkl_flash_write(sg_asset_pack.base, (const uint8_t *)head, sizeof(ASSET_PACK_HEAD_T)));
+
+    tal_mutex_lock(sg_asset_pack.mutex);
+    rt = __pack_open();
+    tal_mutex_unlock(sg_asset_pack.mutex);
+
+    return rt;
+}
+
+/**
+ * @brief OTA handler for tuya_iot_config_t.ota_handler, updates the pack
+ *        when the OTA is of AI_ASSET_PACK_OTA_CHANNEL.
+ * @param msg The OTA message.
+ * @param event The OTA event.
+ * @return None
+ */
+void ai_asset_pack_ota_handler(tuya_ota_msg_t *msg, tuya_ota_event_t *event)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    if (NULL == msg || NULL == event || msg->channel != AI_ASSET_PACK_OTA_CHANNEL) {
+        return;
+    }
+
+    switch (event->id) {
+    case TUYA_OTA_EVENT_START:
+        PR_NOTICE("asset pack update %s, %d bytes", msg->sw_ver, event->file_size);
+        rt = ai_asset_pack_update_begin(event->file_size);
+        break;
+    case TUYA_OTA_EVENT_ON_DATA:
+        rt = ai_asset_pack_update_write(event->offset, event->data, event->data_len);
+        break;
+    case TUYA_OTA_EVENT_FINISH:
+        rt = ai_asset_pack_update_end();
+        if (OPRT_OK == rt) {
+            PR_NOTICE("asset pack updated to %s", msg->sw_ver);
+        }
+        break;
+    case TUYA_OTA_EVENT_FAULT:
+        PR_ERR("asset pack update failed");
+        sg_asset_pack.updating = false;
+        break;
+    default:
+        break;
+    }
+
+    if (OPRT_OK != rt) {
+        PR_ERR("asset pack update event %d err:%d", event->id, rt);
+    }
+}
@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Build an asset pack for ai_asset_pack from LVGL v9 image C files and files.
+
+An LVGL image C file (LVGLImage.py, the online converter, gif2sprite.py)
+gives an asset named after its lv_image_dsc_t symbol, e.g. img_sun_120. Any
+other file, e.g. a GIF or a sprite written with gif2sprite.py --bin, gives a
+raw asset named after the file without its extension, for lv_port_anim.
+
+usage: asset_pack.py -o asset_pack.bin happy.c img_sun_120.c rainbow.gif
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import zlib
+
+PACK_MAGIC = 0x54534141  # "AAST"
+PACK_VERSION = 1
+FLAG_RLE = 0x01
+NAME_LEN = 32
+
+HEAD_FMT = "<IHHIII"
+ENTRY_FMT = "<%dsIIIBBHHH" % NAME_LEN
+
+# lv_color_format_t values of LVGL v9
+CF_RAW = 0x01
+COLOR_FORMATS = {
+    "RAW": 0x01, "RAW_ALPHA": 0x02, "L8": 0x06, "I1": 0x07, "I2": 0x08, "I4": 0x09, "I8": 0x0A,
+    "A1": 0x0B, "A2": 0x0C, "A4": 0x0D, "A8": 0x0E, "RGB888": 0x0F, "ARGB8888": 0x10,
+    "XRGB8888": 0x11, "RGB565": 0x12, "RGB565A8": 0x14,
+}
+
+
+def _field(src, name):
+    m = re.search(r"\." + re.escape(name) + r"\s*=\s*(\w+)", src)
+    return m.group(1) if m else None
+
+
+def parse_image(path):
+    with open(path, "r", encoding="utf-8", errors="ignore") as f:
+        src = f.read()
+
+    m = re.search(r"lv_image_dsc_t\s+(\w+)\s*=\s*\{(.*?)\};", src, re.S)
+    if m is None:
+        raise ValueError("%s: no lv_image_dsc_t found" % path)
+    name, dsc = m.group(1), m.group(2)
+
+    cf = _field(dsc, "header.cf")
+    if cf is None or not cf.startswith("LV_COLOR_FORMAT_") or cf[16:] not in COLOR_FORMATS:
+        raise ValueError("%s: color format %s not supported" % (path, cf))
+
+    data_name = _field(dsc, "data")
+    body = re.search(re.escape(data_name) + r"\s*\[\]\s*=\s*\{(.*?)\};", src, re.S)
+    if body is None:
+        raise ValueError("%s: data array %s not found" % (path, data_name))
+    text = re.sub(r"/\*.*?\*/|//[^\n]*", "", body.group(1), flags=re.S)
+    data = bytes(int(v, 0) for v in re.findall(r"0x[0-9a-fA-F]+|\d+", text))
+
+    size = _field(dsc, "data_size")
+    if size is not None and size.isdigit():
+        data = data[:int(size)]
+
+    stride = _field(dsc, "header.stride")
+    return {
+        "name": name,
+        "cf": COLOR_FORMATS[cf[16:]],
+        "w": int(_field(dsc, "header.w") or 0),
+        "h": int(_field(dsc, "header.h") or 0),
+        "stride": int(stride) if stride and stride.isdigit() else 0,
+        "data": data,
+    }
+
+
+def parse_raw(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    w = h = 0
+    if data[:6] in (b"GIF87a", b"GIF89a"):
+        w, h = struct.unpack_from("<HH", data, 6)
+    name = re.sub(r"\W", "_", os.path.splitext(os.path.basename(path))[0])
+    return {"name": name, "cf": CF_RAW, "w": w, "h": h, "stride": 0, "data": data}
+
+
+def rle_encode(data):
+    """Matches __rle_decode() in ai_asset_pack.c, the font pack coding."""
+    out = bytearray()
+    lit = bytearray()
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and data[i + run] == data[i] and run < 129:
+            run += 1
+        if run >= 3:
+            while lit:
+                out.append(min(len(lit), 128) - 1)
+                out += lit[:128]
+                lit = lit[128:]
+            out.append(0x80 + run - 2)
+            out.append(data[i])
+            i += run
+        else:
+            lit.append(data[i])
+            i += 1
+    while lit:
+        out.append(min(len(lit), 128) - 1)
+        out += lit[:128]
+        lit = lit[128:]
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="build an ai_asset_pack image")
+    parser.add_argument("assets", nargs="+", help="LVGL image C files, GIFs or other files")
+    parser.add_argument("-o", "--output", required=True, help="pack file to write")
+    parser.add_argument("--no-rle", action="store_true", help="store the data uncompressed")
+    args = parser.parse_args()
+
+    assets = [parse_image(p) if p.endswith(".c") else parse_raw(p) for p in args.assets]
+    # the device finds assets by binary search on the name
+    assets.sort(key=lambda a: a["name"].encode())
+    names = [a["name"] for a in assets]
+    for name in names:
+        if len(name.encode()) >= NAME_LEN:
+            raise ValueError("asset name %s too long" % name)
+        if names.count(name) > 1:
+            raise ValueError("asset %s given twice" % name)
+
+    head_len = struct.calcsize(HEAD_FMT) + struct.calcsize(ENTRY_FMT) * len(assets)
+    table = bytearray()
+    body = bytearray()
+    for a in assets:
+        stored, flags = a["data"], 0
+        if not args.no_rle:
+            rle = rle_encode(a["data"])
+            # GIFs and sprites are coded already and grow, keep those plain
+            if len(rle) < len(a["data"]):
+                stored, flags = rle, FLAG_RLE
+        table += struct.pack(ENTRY_FMT, a["name"].encode(), head_len + len(body), len(stored), len(a["data"]),
+                             a["cf"], flags, a["w"], a["h"], a["stride"])
+        body += stored
+        while len(body) % 4:
+            body.append(0)
+        print("%s: %dx%d cf 0x%02x, %d bytes (%d raw)" % (a["name"], a["w"], a["h"], a["cf"], len(stored),
+                                                         len(a["data"])))
+
+    total = head_len + len(body)
+    crc = zlib.crc32(bytes(table) + bytes(body)) & 0xFFFFFFFF
+    head = struct.pack(HEAD_FMT, PACK_MAGIC, PACK_VERSION, len(assets), total, crc, 0)
+    with open(args.output, "wb") as f:
+        f.write(head + table + body)
+    print("%s: %d bytes" % (args.output, total))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
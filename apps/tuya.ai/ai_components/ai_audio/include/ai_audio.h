@@ -9,10 +9,12 @@
 #include "ai_audio_cloud_asr.h"
 #include "ai_audio_player.h"
 #include "ai_audio_input.h"
+#include "ai_audio_prompt.h"
 /***********************************************************
 ************************macro define************************
 ***********************************************************/
 #define GET_MIN_LEN(a, b) ((a) < (b) ? (a) : (b))
+#define GET_MAX_LEN(a, b) ((a) > (b) ? (a) : (b))
 
 typedef uint8_t AI_AUDIO_WORK_MODE_E;
 #define AI_AUDIO_MODE_MANUAL_SINGLE_TALK     1
@@ -51,6 +53,16 @@ typedef void (*AI_AUDIO_STATE_INFORM_CB)(AI_AUDIO_STATE_E state);
 ***********************typedef define***********************
 ***********************************************************/
 
+// time to first sound: end of the user speech to the first reply sample at the speaker
+typedef struct {
+    uint32_t turn_cnt;
+    uint32_t ttfs_ms;      // last turn
+    uint32_t net_ms;       // last turn, end of speech to the first tts packet
+    uint32_t local_ms;     // last turn, first tts packet to the first sample played
+    uint32_t ttfs_avg_ms;
+    uint32_t ttfs_max_ms;
+} AI_AUDIO_TURN_STATS_T;
+
 typedef struct {
     AI_AUDIO_WORK_MODE_E work_mode;
     AI_AUDIO_EVT_INFORM_CB evt_inform_cb;
@@ -102,4 +114,11 @@ OPERATE_RET ai_audio_manual_stop_single_talk(void);
 
 OPERATE_RET ai_audio_set_wakeup(void);
 
-AI_AUDIO_STATE_E ai_audio_get_state(void);
\ No newline at end of file
+AI_AUDIO_STATE_E ai_audio_get_state(void);
+
+/**
+ * @brief Gets the time to first sound of the chat turns so far.
+ * @param stats Filled with the statistics.
+ * @return OPERATE_RET - OPRT_OK if the operation is successful, otherwise an error code.
+ */
+OPERATE_RET ai_audio_get_turn_stats(AI_AUDIO_TURN_STATS_T *stats);
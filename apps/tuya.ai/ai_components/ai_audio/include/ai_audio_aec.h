@@ -0,0 +1,75 @@
+/**
+ * @file ai_audio_aec.h
+ * @brief Portable fixed-point acoustic echo canceller for boards without hardware AEC.
+ *
+ * A time domain NLMS filter in Q15 removes the speaker signal from the mic signal,
+ * so VAD can keep running while the player is active and the user can barge in.
+ * The reference is tapped from tdl_audio_play, both sides are expected to be
+ * 16 bit mono pcm at the same sample rate. Dot product and update kernels use
+ * NEON or the ARM DSP extension when the compiler targets them.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#ifndef __AI_AUDIO_AEC_H__
+#define __AI_AUDIO_AEC_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+// enable the software echo canceller on boards without ENABLE_AUDIO_AEC
+#ifndef AI_AUDIO_SOFT_AEC_ENABLE
+#define AI_AUDIO_SOFT_AEC_ENABLE 0
+#endif
+
+// filter length in samples, 256 taps cover 16 ms of echo tail at 16 kHz
+#ifndef AI_AUDIO_AEC_TAPS
+#define AI_AUDIO_AEC_TAPS 256
+#endif
+
+// playback buffered in the driver before it reaches the speaker
+#ifndef AI_AUDIO_AEC_REF_DELAY_MS
+#define AI_AUDIO_AEC_REF_DELAY_MS 20
+#endif
+
+// adaptation step in Q15
+#ifndef AI_AUDIO_AEC_MU_Q15
+#define AI_AUDIO_AEC_MU_Q15 8192
+#endif
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+/**
+ * @brief Initializes the echo canceller and hooks the playback reference tap.
+ * @param audio_hdl The TDL audio device used for playback.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_audio_aec_init(void *audio_hdl);
+
+/**
+ * @brief Removes the echo from one mic frame in place, called from the mic callback.
+ * @param pcm 16 bit mono pcm.
+ * @param len Length in bytes.
+ * @return None
+ */
+void ai_audio_aec_process(uint8_t *pcm, uint32_t len);
+
+/**
+ * @brief Checks whether the speaker signal is being cancelled right now.
+ * @param None
+ * @return true while reference data is flowing.
+ */
+bool ai_audio_aec_is_active(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AI_AUDIO_AEC_H__ */
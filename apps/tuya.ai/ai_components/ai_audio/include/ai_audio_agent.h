@@ -15,6 +15,7 @@
 
 #include "tuya_cloud_types.h"
 #include "tuya_ai_protocol.h"
+#include "ai_audio_encoder.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -72,6 +73,13 @@ OPERATE_RET ai_audio_agent_init(AI_AGENT_CBS_T *cbs);
  */
 OPERATE_RET ai_audio_agent_upload_start(uint8_t enable_vad);
 
+/**
+ * @brief Sets the encoder used for the audio uplink, takes effect on the next upload start.
+ * @param encoder Encoder to use, such as ai_audio_encoder_adpcm(), NULL to upload raw pcm.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_audio_agent_set_encoder(const AI_AUDIO_ENCODER_T *encoder);
+
 /**
  * @brief Uploads audio data to the AI service.
  * @param data Pointer to the audio data buffer.
@@ -80,6 +88,19 @@ OPERATE_RET ai_audio_agent_upload_start(uint8_t enable_vad);
  */
 OPERATE_RET ai_audio_agent_upload_data(uint8_t *data, uint32_t len);
 
+/**
+ * @brief Uploads audio data to the AI service, stamped with its capture time.
+ *
+ * The pts of each packet is its capture time relative to the first packet of
+ * the upload, so buffered audio such as the vad pre-roll keeps its real position.
+ *
+ * @param data Pointer to the audio data buffer.
+ * @param len Length of the audio data in bytes.
+ * @param capture_ms Capture time of the first sample, on the tal_system_get_millisecond() clock.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_audio_agent_upload_pcm(uint8_t *data, uint32_t len, SYS_TIME_T capture_ms);
+
 /**
  * @brief Stops the AI audio upload process.
  * @param None
@@ -101,6 +122,16 @@ OPERATE_RET ai_audio_agent_chat_intrrupt(void);
  */
 OPERATE_RET ai_text_agent_upload(uint8_t *data, uint32_t len);
 
+/**
+ * @brief Uploads a JPEG image into the current chat turn.
+ * @param data JPEG data, sent in place.
+ * @param len Length of the data.
+ * @param width Image width.
+ * @param height Image height.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_image_agent_upload(uint8_t *data, uint32_t len, uint16_t width, uint16_t height);
+
 #ifdef __cplusplus
 }
 #endif
@@ -49,6 +49,13 @@ OPERATE_RET ai_audio_cloud_asr_init(void);
  */
 OPERATE_RET ai_audio_cloud_asr_start(void);
 
+/**
+ * @brief Opens the upload event ahead of the speech, so ai_audio_cloud_asr_start() does not wait for it.
+ * @param None
+ * @return OPERATE_RET - OPRT_OK if the request is queued, otherwise an error code.
+ */
+OPERATE_RET ai_audio_cloud_asr_prepare(void);
+
 /**
  * @brief Stops the audio cloud ASR process.
  * @param None
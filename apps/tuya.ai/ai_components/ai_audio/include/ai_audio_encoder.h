@@ -0,0 +1,60 @@
+/**
+ * @file ai_audio_encoder.h
+ * @brief Pluggable encoder stage for the AI audio uplink.
+ *
+ * The agent hands every captured PCM frame to the selected encoder before it
+ * is sent, the codec type of the encoder is reported to the cloud through
+ * AI_AUDIO_ATTR_T. A built-in IMA ADPCM encoder is provided for chips without
+ * the headroom for Opus, an Opus encoder can be plugged in by platforms that
+ * ship libopus.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#ifndef __AI_AUDIO_ENCODER_H__
+#define __AI_AUDIO_ENCODER_H__
+
+#include "tuya_cloud_types.h"
+#include "tuya_ai_protocol.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+// every ADPCM frame starts with predictor(int16 LE), step index(uint8) and a reserved byte
+#define AI_AUDIO_ADPCM_HEAD_LEN 4
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    /** codec reported in the audio attribute */
+    AI_AUDIO_CODEC_TYPE codec_type;
+    /** create encoder state for a new upload */
+    OPERATE_RET (*start)(void **handle, uint32_t sample_rate, uint16_t channels);
+    /** max encoded size for pcm_len bytes of 16 bit pcm */
+    uint32_t (*max_out_len)(uint32_t pcm_len);
+    /** encode one pcm frame */
+    OPERATE_RET (*encode)(void *handle, uint8_t *pcm, uint32_t pcm_len, uint8_t *out, uint32_t *out_len);
+    /** release encoder state */
+    void (*stop)(void *handle);
+} AI_AUDIO_ENCODER_T;
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+/**
+ * @brief Gets the built-in IMA ADPCM encoder, 4:1 against 16 bit pcm.
+ * @param None
+ * @return const AI_AUDIO_ENCODER_T* - the encoder.
+ */
+const AI_AUDIO_ENCODER_T *ai_audio_encoder_adpcm(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AI_AUDIO_ENCODER_H__ */
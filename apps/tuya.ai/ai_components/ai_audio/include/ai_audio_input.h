@@ -29,6 +29,16 @@ extern "C" {
 #define AI_AUDIO_VOICE_FRAME_LEN_GET(tm_ms)                                                                            \
     (((tm_ms > AI_AUDIO_PCM_FRAME_TM_MS) ? (tm_ms) : AI_AUDIO_PCM_FRAME_TM_MS) / AI_AUDIO_PCM_FRAME_TM_MS *            \
      AI_AUDIO_PCM_FRAME_SIZE)
+
+// speech needed before vad reports the start of an utterance
+#ifndef AI_AUDIO_VAD_SPEECH_MIN_MS
+#define AI_AUDIO_VAD_SPEECH_MIN_MS (300)
+#endif
+
+// audio kept ahead of the speech onset and uploaded in front of the utterance
+#ifndef AI_AUDIO_INPUT_PREROLL_MS
+#define AI_AUDIO_INPUT_PREROLL_MS (300)
+#endif
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
@@ -60,6 +70,14 @@ typedef struct {
     AI_AUDIO_INPUT_VALID_METHOD_E get_valid_data_method;
 } AI_AUDIO_INPUT_CFG_T;
 
+typedef struct {
+    uint32_t unit_size;  // bytes per recognizer unit
+    uint32_t frames;     // units recognized
+    uint32_t avg_us;     // recognizer time per unit
+    uint32_t max_us;
+    uint32_t drop_bytes; // mic data lost while the recognizer fell behind
+} AI_AUDIO_INPUT_KWS_STAT_T;
+
 typedef void (*AI_AUDIO_INOUT_INFORM_CB)(AI_AUDIO_INPUT_EVENT_E event, void *arg);
 
 /***********************************************************
@@ -81,12 +99,41 @@ OPERATE_RET ai_audio_input_stop_asr_awake(void);
 
 OPERATE_RET ai_audio_input_restart_asr_awake_timer(void);
 
+/**
+ * @brief Gets the wakeword recognizer statistics since init.
+ * @param stat Filled with the statistics.
+ * @return OPERATE_RET - OPRT_OK on success, OPRT_NOT_SUPPORTED when the method is not ASR.
+ */
+OPERATE_RET ai_audio_input_get_kws_stat(AI_AUDIO_INPUT_KWS_STAT_T *stat);
+
 uint32_t ai_audio_get_input_data(uint8_t *buff, uint32_t buff_len);
 
 uint32_t ai_audio_get_input_data_size(void);
 
+/**
+ * @brief Gets the contiguous buffered input data in place, without copying.
+ *        Must be called from the same task that reads the input data.
+ * @param data Set to the start of the readable region.
+ * @return Length of the region, release it with ai_audio_commit_input_data().
+ */
+uint32_t ai_audio_peek_input_data(uint8_t **data);
+
+/**
+ * @brief Releases input data obtained through ai_audio_peek_input_data().
+ * @param len Number of bytes consumed.
+ */
+void ai_audio_commit_input_data(uint32_t len);
+
 void ai_audio_discard_input_data(uint32_t discard_size);
 
+/**
+ * @brief Gets the capture time of the oldest buffered input data.
+ *        Must be called from the same task that reads the input data.
+ * @param None
+ * @return Capture time in ms, on the tal_system_get_millisecond() clock.
+ */
+SYS_TIME_T ai_audio_get_input_data_timestamp(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -36,6 +36,16 @@ typedef enum {
     AI_AUDIO_PLAYER_STAT_MAX,
 } AI_AUDIO_PLAYER_STATE_E;
 
+// jitter buffer statistics of the current (or last) stream
+typedef struct {
+    uint32_t underrun_cnt;     // playback ran dry before eof and had to rebuffer
+    uint32_t overflow_cnt;     // writes that found the stream buffer full
+    uint32_t jitter_ms;        // smoothed deviation of the chunk inter-arrival time
+    uint32_t target_ms;        // buffered audio required before decoding starts
+    uint32_t buffered_ms;      // audio waiting in the stream buffer
+    uint32_t start_latency_ms; // first chunk arrival to first decoded frame
+} AI_AUDIO_PLAYER_JB_STATS_T;
+
 /***********************************************************
 ********************function declaration********************
 ***********************************************************/
@@ -87,6 +97,10 @@ OPERATE_RET ai_audio_player_stop(void);
  */
 uint8_t ai_audio_player_is_playing(void);
 
+OPERATE_RET ai_audio_player_jb_stats_get(AI_AUDIO_PLAYER_JB_STATS_T *stats);
+
+SYS_TIME_T ai_audio_player_first_sound_ms_get(void);
+
 #ifdef __cplusplus
 }
 #endif
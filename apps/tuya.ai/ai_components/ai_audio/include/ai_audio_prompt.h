@@ -0,0 +1,104 @@
+/**
+ * @file ai_audio_prompt.h
+ * @brief Local prompt cache, plays pre-decoded pcm instead of running the mp3 player.
+ *
+ * Prompts are registered with their mp3 source and optionally with pcm that was
+ * converted at build time. Build-time pcm is played straight from flash. Prompts
+ * without it are decoded once in the background and stored as pcm in the file
+ * system, later plays stream that file without touching the decoder. Prompts
+ * marked preload (e.g. the wake chime) are kept in PSRAM and sound immediately.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __AI_AUDIO_PROMPT_H__
+#define __AI_AUDIO_PROMPT_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#ifndef AI_AUDIO_PROMPT_MAX
+#define AI_AUDIO_PROMPT_MAX 16
+#endif
+
+// directory of the decoded pcm files
+#ifndef AI_AUDIO_PROMPT_DIR
+#define AI_AUDIO_PROMPT_DIR "/prompt"
+#endif
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    uint32_t id;          // app defined, e.g. the alert type
+    const uint8_t *mp3;   // mp3 source, usually a const array
+    uint32_t mp3_len;
+    const uint8_t *pcm;   // optional 16 bit mono pcm converted at build time
+    uint32_t pcm_len;
+    bool preload;         // keep the pcm in ram for instant playback
+} AI_AUDIO_PROMPT_T;
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+/**
+ * @brief Initializes the prompt cache and its playback task.
+ * @param None
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_audio_prompt_init(void);
+
+/**
+ * @brief Registers a prompt, decoding into the cache happens in the background.
+ *
+ * Preload prompts are decoded before the others, so register the most urgent
+ * prompt first.
+ *
+ * @param prompt The prompt, the source buffers must stay valid.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_audio_prompt_register(const AI_AUDIO_PROMPT_T *prompt);
+
+/**
+ * @brief Plays a registered prompt, the ai audio player is stopped first.
+ *
+ * Prompts that are not cached yet fall back to the mp3 player.
+ *
+ * @param id The prompt id.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_audio_prompt_play(uint32_t id);
+
+/**
+ * @brief Stops the prompt being played.
+ * @param None
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_audio_prompt_stop(void);
+
+/**
+ * @brief Checks whether a prompt is being played.
+ * @param None
+ * @return true if a prompt is playing.
+ */
+bool ai_audio_prompt_is_playing(void);
+
+/**
+ * @brief Checks whether a prompt can be played without decoding.
+ * @param id The prompt id.
+ * @return true if the pcm is available.
+ */
+bool ai_audio_prompt_is_cached(uint32_t id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AI_AUDIO_PROMPT_H__ */
@@ -0,0 +1,277 @@
+/**
+ * @file ai_audio_aec.c
+ * @brief Portable fixed-point NLMS echo canceller used when the board has no hardware AEC.
+ *
+ * The playback tap pushes speaker pcm into a lock-free ring, the mic callback pulls the
+ * same amount of reference for every captured frame and subtracts the filtered echo.
+ * Adaptation is frozen while there is no reference and during double talk (Geigel
+ * detector), so the user's own voice does not train the filter away.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#include "tkl_memory.h"
+
+#include "tal_api.h"
+#include "spsc_ring.h"
+
+#include "tdl_audio_manage.h"
+
+#include "ai_audio.h"
+#include "ai_audio_aec.h"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__ARM_FEATURE_SIMD32) && (__ARM_FEATURE_SIMD32 == 1)
+#include <arm_acle.h>
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define AEC_REF_RING_MS    (200)
+#define AEC_REF_DELAY_LEN  AI_AUDIO_VOICE_FRAME_LEN_GET(AI_AUDIO_AEC_REF_DELAY_MS)
+#define AEC_REF_RING_LEN   (AI_AUDIO_VOICE_FRAME_LEN_GET(AEC_REF_RING_MS) + 2)
+#define AEC_REF_CHUNK      (64) // samples pulled from the ring per step
+
+#define AEC_POWER_EPS      ((int64_t)AI_AUDIO_AEC_TAPS * 16 * 16) // regularization, ~-66 dBFS
+#define AEC_POWER_MIN      ((int64_t)AI_AUDIO_AEC_TAPS * 64 * 64) // below this the reference is noise
+#define AEC_DT_HANGOVER    (240)                                  // samples adaptation stays frozen
+#define AEC_PEAK_DECAY_SFT (7)
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    bool is_init;
+    bool ref_primed;
+
+    SPSC_RING_T ref_ring;
+
+    int16_t *w;    // filter taps, Q15
+    int16_t *hist; // doubled reference history, hist[pos + k] = x(n - k)
+    uint32_t pos;
+    int64_t power; // sum of x^2 over the window
+    int32_t peak;  // decaying max |x| for double talk detection
+    uint32_t dt_hold;
+} AI_AUDIO_AEC_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static AI_AUDIO_AEC_T sg_aec;
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static inline int16_t __aec_sat16(int32_t v)
+{
+    if (v > 32767) {
+        return 32767;
+    }
+    if (v < -32768) {
+        return -32768;
+    }
+    return (int16_t)v;
+}
+
+static int64_t __aec_dot_q15(const int16_t *a, const int16_t *b, uint32_t n)
+{
+    int64_t acc = 0;
+    uint32_t i = 0;
+
+#if defined(__ARM_NEON)
+    int64x2_t acc64 = vdupq_n_s64(0);
+    for (; i + 4 <= n; i += 4) {
+        acc64 = vpadalq_s32(acc64, vmull_s16(vld1_s16(a + i), vld1_s16(b + i)));
+    }
+    acc = vgetq_lane_s64(acc64, 0) + vgetq_lane_s64(acc64, 1);
+#elif defined(__ARM_FEATURE_SIMD32) && (__ARM_FEATURE_SIMD32 == 1)
+    for (; i + 2 <= n; i += 2) {
+        int16x2_t va, vb;
+        memcpy(&va, a + i, sizeof(va));
+        memcpy(&vb, b + i, sizeof(vb));
+        acc = __smlald(va, vb, acc);
+    }
+#endif
+
+    for (; i < n; i++) {
+        acc += (int32_t)a[i] * b[i];
+    }
+
+    return acc;
+}
+
+static void __aec_update_q15(int16_t *w, const int16_t *x, int32_t g, uint32_t n)
+{
+    uint32_t i = 0;
+
+#if defined(__ARM_NEON)
+    // vqdmulh gives (2 * x * g) >> 16, the same as (x * g) >> 15
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t d = vqdmulhq_n_s16(vld1q_s16(x + i), (int16_t)g);
+        vst1q_s16(w + i, vqaddq_s16(vld1q_s16(w + i), d));
+    }
+#endif
+
+    for (; i < n; i++) {
+        w[i] = __aec_sat16(w[i] + ((g * x[i]) >> 15));
+    }
+}
+
+static int16_t __aec_sample(AI_AUDIO_AEC_T *aec, int16_t ref, int16_t mic)
+{
+    // nothing to cancel, the history is all zero
+    if (0 == ref && 0 == aec->power) {
+        return mic;
+    }
+
+    // the slot being replaced holds x(n - TAPS)
+    aec->pos = (0 == aec->pos) ? (AI_AUDIO_AEC_TAPS - 1) : (aec->pos - 1);
+    int16_t old = aec->hist[aec->pos];
+    aec->hist[aec->pos] = ref;
+    aec->hist[aec->pos + AI_AUDIO_AEC_TAPS] = ref;
+    aec->power += (int32_t)ref * ref - (int32_t)old * old;
+
+    int32_t abs_ref = (ref < 0) ? -(int32_t)ref : ref;
+    aec->peak -= aec->peak >> AEC_PEAK_DECAY_SFT;
+    if (abs_ref > aec->peak) {
+        aec->peak = abs_ref;
+    }
+
+    const int16_t *x = &aec->hist[aec->pos];
+    int32_t y = (int32_t)(__aec_dot_q15(aec->w, x, AI_AUDIO_AEC_TAPS) >> 15);
+    int32_t e = __aec_sat16((int32_t)mic - y);
+
+    // Geigel: near end speech is louder than half the far end peak
+    int32_t abs_mic = (mic < 0) ? -(int32_t)mic : mic;
+    if ((abs_mic << 1) > aec->peak) {
+        aec->dt_hold = AEC_DT_HANGOVER;
+    } else if (aec->dt_hold > 0) {
+        aec->dt_hold--;
+    }
+
+    if (aec->power >= AEC_POWER_MIN && 0 == aec->dt_hold) {
+        int64_t g = (((int64_t)AI_AUDIO_AEC_MU_Q15 * e) << 15) / (aec->power + AEC_POWER_EPS);
+        if (g > 32767) {
+            g = 32767;
+        } else if (g < -32767) {
+            g = -32767;
+        }
+        if (g) {
+            __aec_update_q15(aec->w, x, (int32_t)g, AI_AUDIO_AEC_TAPS);
+        }
+    }
+
+    return (int16_t)e;
+}
+
+static void __aec_play_tap(uint8_t *data, uint32_t len, void *arg)
+{
+    // player output task is the only producer
+    spsc_ring_write(&sg_aec.ref_ring, data, GET_MIN_LEN(len, spsc_ring_free(&sg_aec.ref_ring)) & ~1u);
+}
+
+/**
+ * @brief Initializes the echo canceller and hooks the playback reference tap.
+ * @param audio_hdl The TDL audio device used for playback.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_audio_aec_init(void *audio_hdl)
+{
+    if (sg_aec.is_init) {
+        return OPRT_OK;
+    }
+
+    uint8_t *ring_buf = tkl_system_psram_malloc(AEC_REF_RING_LEN);
+    sg_aec.w = tal_malloc(AI_AUDIO_AEC_TAPS * sizeof(int16_t));
+    sg_aec.hist = tal_malloc(AI_AUDIO_AEC_TAPS * 2 * sizeof(int16_t));
+    if (NULL == ring_buf || NULL == sg_aec.w || NULL == sg_aec.hist) {
+        PR_ERR("aec malloc failed");
+        goto __ERR;
+    }
+    memset(sg_aec.w, 0, AI_AUDIO_AEC_TAPS * sizeof(int16_t));
+    memset(sg_aec.hist, 0, AI_AUDIO_AEC_TAPS * 2 * sizeof(int16_t));
+    spsc_ring_init(&sg_aec.ref_ring, ring_buf, AEC_REF_RING_LEN);
+
+    if (OPRT_OK != tdl_audio_play_tap_set((TDL_AUDIO_HANDLE_T)audio_hdl, __aec_play_tap, NULL)) {
+        goto __ERR;
+    }
+
+    sg_aec.is_init = true;
+    PR_DEBUG("soft aec init, taps:%d delay:%dms", AI_AUDIO_AEC_TAPS, AI_AUDIO_AEC_REF_DELAY_MS);
+
+    return OPRT_OK;
+
+__ERR:
+    if (ring_buf) {
+        tkl_system_psram_free(ring_buf);
+    }
+    if (sg_aec.w) {
+        tal_free(sg_aec.w);
+        sg_aec.w = NULL;
+    }
+    if (sg_aec.hist) {
+        tal_free(sg_aec.hist);
+        sg_aec.hist = NULL;
+    }
+
+    return OPRT_COM_ERROR;
+}
+
+/**
+ * @brief Removes the echo from one mic frame in place, called from the mic callback.
+ * @param pcm 16 bit mono pcm.
+ * @param len Length in bytes.
+ * @return None
+ */
+void ai_audio_aec_process(uint8_t *pcm, uint32_t len)
+{
+    AI_AUDIO_AEC_T *aec = &sg_aec;
+    int16_t ref[AEC_REF_CHUNK];
+    int16_t mic = 0;
+    uint32_t samples = len / sizeof(int16_t);
+    uint32_t done = 0, i = 0;
+
+    if (false == aec->is_init || NULL == pcm) {
+        return;
+    }
+
+    // hold the reference back until the driver delay is covered
+    uint32_t ref_avail = spsc_ring_readable(&aec->ref_ring);
+    if (false == aec->ref_primed && ref_avail >= AEC_REF_DELAY_LEN + len) {
+        aec->ref_primed = true;
+    }
+
+    while (done < samples) {
+        uint32_t n = GET_MIN_LEN(samples - done, AEC_REF_CHUNK);
+        uint32_t got = 0;
+        if (aec->ref_primed) {
+            got = spsc_ring_read(&aec->ref_ring, ref, n * sizeof(int16_t)) / sizeof(int16_t);
+            if (got < n) {
+                // playback ended, wait for the next stream to prime again
+                aec->ref_primed = false;
+            }
+        }
+        for (i = got; i < n; i++) {
+            ref[i] = 0;
+        }
+
+        for (i = 0; i < n; i++) {
+            memcpy(&mic, pcm + (done + i) * sizeof(int16_t), sizeof(int16_t));
+            mic = __aec_sample(aec, ref[i], mic);
+            memcpy(pcm + (done + i) * sizeof(int16_t), &mic, sizeof(int16_t));
+        }
+        done += n;
+    }
+}
+
+/**
+ * @brief Checks whether the speaker signal is being cancelled right now.
+ * @param None
+ * @return true while reference data is flowing.
+ */
+bool ai_audio_aec_is_active(void)
+{
+    return sg_aec.is_init && (sg_aec.ref_primed || sg_aec.power > 0);
+}
@@ -53,6 +53,11 @@ typedef struct {
     AI_AGENT_CBS_T           cbs;
     AI_AGENT_CHAT_STREAM_E   stream_status;
     bool                     is_audio_upload_first_frame;
+    SYS_TIME_T               upload_first_ms;
+    const AI_AUDIO_ENCODER_T *encoder;
+    void                     *enc_handle;
+    uint8_t                  *enc_buf;
+    uint32_t                 enc_buf_len;
 } AI_AGENT_SESSION_T;
 // clang-format on
 /***********************************************************
@@ -139,6 +144,10 @@ static OPERATE_RET _parse_asr(cJSON *json)
     }
     ai_msg.type = AI_AGENT_MSG_TP_TEXT_ASR;
 
+#if defined(ENABLE_AI_MONITOR) && (ENABLE_AI_MONITOR == 1)
+    tuya_ai_monitor_stage_mark(AI_MONITOR_STAGE_ASR);
+#endif
+
     if (sg_ai.cbs.ai_agent_msg_cb) {
         sg_ai.cbs.ai_agent_msg_cb(&ai_msg);
     }
@@ -158,6 +167,10 @@ static OPERATE_RET _parse_nlg(cJSON *json, uint8_t eof)
     if (AI_AGENT_CHAT_STREAM_START == sg_ai.stream_status) {
         sg_ai.stream_status = AI_AGENT_CHAT_STREAM_DATA;
 
+#if defined(ENABLE_AI_MONITOR) && (ENABLE_AI_MONITOR == 1)
+        tuya_ai_monitor_stage_mark(AI_MONITOR_STAGE_NLG);
+#endif
+
         ai_msg.type = AI_AGENT_MSG_TP_TEXT_NLG_START;
         ai_msg.data_len = strlen(sg_ai.stream_event_id);
         ai_msg.data = (uint8_t *)sg_ai.stream_event_id;
@@ -486,6 +499,9 @@ OPERATE_RET ai_audio_agent_init(AI_AGENT_CBS_T *cbs)
     if (cbs) {
         memcpy(&sg_ai.cbs, cbs, sizeof(AI_AGENT_CBS_T));
     }
+#if defined(ENABLE_AI_AUDIO_UPLOAD_ADPCM) && (ENABLE_AI_AUDIO_UPLOAD_ADPCM == 1)
+    sg_ai.encoder = ai_audio_encoder_adpcm();
+#endif
 
     PR_DEBUG("ai session wait for mqtt connected...");
 
@@ -494,6 +510,59 @@ OPERATE_RET ai_audio_agent_init(AI_AGENT_CBS_T *cbs)
     return rt;
 }
 
+static void __ai_agent_encoder_stop(void)
+{
+    if (sg_ai.encoder && sg_ai.enc_handle) {
+        sg_ai.encoder->stop(sg_ai.enc_handle);
+    }
+    sg_ai.enc_handle = NULL;
+    if (sg_ai.enc_buf) {
+        tal_free(sg_ai.enc_buf);
+        sg_ai.enc_buf = NULL;
+    }
+    sg_ai.enc_buf_len = 0;
+}
+
+static OPERATE_RET __ai_agent_encode(uint8_t *data, uint32_t len, uint8_t **out, uint32_t *out_len)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint32_t need_len = sg_ai.encoder->max_out_len(len);
+
+    // frames have the same size during an upload, the buffer is only grown at the start
+    if (need_len > sg_ai.enc_buf_len) {
+        if (sg_ai.enc_buf) {
+            tal_free(sg_ai.enc_buf);
+        }
+        sg_ai.enc_buf_len = 0;
+        sg_ai.enc_buf = tal_malloc(need_len);
+        TUYA_CHECK_NULL_RETURN(sg_ai.enc_buf, OPRT_MALLOC_FAILED);
+        sg_ai.enc_buf_len = need_len;
+    }
+
+    rt = sg_ai.encoder->encode(sg_ai.enc_handle, data, len, sg_ai.enc_buf, out_len);
+    if (OPRT_OK != rt) {
+        PR_ERR("audio encode failed, rt:%d", rt);
+        return rt;
+    }
+    *out = sg_ai.enc_buf;
+    return rt;
+}
+
+/**
+ * @brief Sets the encoder used for the audio uplink.
+ * @param encoder Encoder to use, NULL to upload raw pcm.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_audio_agent_set_encoder(const AI_AUDIO_ENCODER_T *encoder)
+{
+    if (encoder && (!encoder->start || !encoder->max_out_len || !encoder->encode || !encoder->stop)) {
+        return OPRT_INVALID_PARM;
+    }
+    __ai_agent_encoder_stop();
+    sg_ai.encoder = encoder;
+    return OPRT_OK;
+}
+
 /**
  * @brief Starts the AI audio upload process.
  * @param enable_vad Flag to enable cloud vad.
@@ -536,6 +605,16 @@ OPERATE_RET ai_audio_agent_upload_start(uint8_t enable_vad)
         return rt;
     }
 
+    if (sg_ai.encoder) {
+        __ai_agent_encoder_stop();
+        rt = sg_ai.encoder->start(&sg_ai.enc_handle, 16000, AUDIO_CHANNELS_MONO);
+        if (OPRT_OK != rt) {
+            PR_ERR("audio encoder start failed, fall back to pcm, rt:%d", rt);
+            sg_ai.enc_handle = NULL;
+            rt = OPRT_OK;
+        }
+    }
+
     sg_ai.is_audio_upload_first_frame = true;
     PR_DEBUG("upload start event_id:%s", sg_ai.event_id);
 
@@ -549,16 +628,36 @@ OPERATE_RET ai_audio_agent_upload_start(uint8_t enable_vad)
  * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
  */
 OPERATE_RET ai_audio_agent_upload_data(uint8_t *data, uint32_t len)
+{
+    return ai_audio_agent_upload_pcm(data, len, tal_system_get_millisecond());
+}
+
+/**
+ * @brief Uploads audio data to the AI service, stamped with its capture time.
+ * @param data Pointer to the audio data buffer.
+ * @param len Length of the audio data in bytes.
+ * @param capture_ms Capture time of the first sample.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_audio_agent_upload_pcm(uint8_t *data, uint32_t len, SYS_TIME_T capture_ms)
 {
     OPERATE_RET rt = OPRT_OK;
 
-    // send data use tuya_ai_send_biz_pkt, pcm
+    // send data use tuya_ai_send_biz_pkt, pcm or the output of the encoder
+    AI_AUDIO_CODEC_TYPE codec_type = AUDIO_CODEC_PCM;
+    if (sg_ai.encoder && sg_ai.enc_handle) {
+        codec_type = sg_ai.encoder->codec_type;
+        if (data && len) {
+            TUYA_CALL_ERR_RETURN(__ai_agent_encode(data, len, &data, &len));
+        }
+    }
+
     AI_BIZ_ATTR_INFO_T attr = {
         .flag = AI_HAS_ATTR,
         .type = AI_PT_AUDIO,
         .value.audio =
             {
-                .base.codec_type = AUDIO_CODEC_PCM,
+                .base.codec_type = codec_type,
                 .base.sample_rate = 16000,
                 .base.channels = AUDIO_CHANNELS_MONO,
                 .base.bit_depth = 16,
@@ -567,11 +666,19 @@ OPERATE_RET ai_audio_agent_upload_data(uint8_t *data, uint32_t len)
                 .option.session_id_list = NULL,
             },
     };
+    if (sg_ai.is_audio_upload_first_frame) {
+        sg_ai.upload_first_ms = capture_ms;
+    }
+    // the end packet carries no audio, keep its pts monotonic
+    if (capture_ms < sg_ai.upload_first_ms) {
+        capture_ms = sg_ai.upload_first_ms;
+    }
+
     AI_BIZ_HEAD_INFO_T head = {
         .value.audio =
             {
-                .timestamp = tal_system_get_millisecond(),
-                .pts = 0,
+                .timestamp = capture_ms,
+                .pts = (uint64_t)(capture_ms - sg_ai.upload_first_ms) * 1000,
             },
         .len = len,
     };
@@ -605,6 +712,7 @@ OPERATE_RET ai_audio_agent_upload_stop(void)
     PR_DEBUG("tuya ai upload stop...");
 
     TUYA_CALL_ERR_RETURN(ai_audio_agent_upload_data(NULL, 0));
+    __ai_agent_encoder_stop();
 
     AI_ATTRIBUTE_T attr[] = {{
         .type = 1002,
@@ -708,4 +816,48 @@ OPERATE_RET ai_text_agent_upload(uint8_t *data, uint32_t len)
     ai_text_agent_upload_stop();
 
     return rt;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Uploads a JPEG image into the current chat turn.
+ *
+ * The data is sent in place, a camera snapshot can be passed without a copy
+ * and given back once this returns.
+ *
+ * @param data JPEG data.
+ * @param len Length of the data.
+ * @param width Image width.
+ * @param height Image height.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_image_agent_upload(uint8_t *data, uint32_t len, uint16_t width, uint16_t height)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    TUYA_CHECK_NULL_RETURN(data, OPRT_INVALID_PARM);
+    if (len == 0) {
+        PR_ERR("image data length is zero");
+        return OPRT_INVALID_PARM;
+    }
+
+    AI_BIZ_ATTR_INFO_T attr;
+    memset(&attr, 0, SIZEOF(attr));
+    attr.flag = AI_HAS_ATTR;
+    attr.type = AI_PT_IMAGE;
+    attr.value.image.base.format = IMAGE_FORMAT_JPEG;
+    attr.value.image.base.width = width;
+    attr.value.image.base.height = height;
+    attr.value.image.base.len = len;
+
+    AI_BIZ_HEAD_INFO_T head;
+    memset(&head, 0, SIZEOF(head));
+    head.stream_flag = AI_STREAM_ONE;
+    head.value.image.timestamp = tal_system_get_millisecond();
+    head.len = len;
+
+    PR_DEBUG("tuya ai upload image %dx%d, %d bytes", width, height, len);
+
+    TUYA_CALL_ERR_RETURN(tuya_ai_send_biz_pkt(TY_AI_CHAT_ID_DS_IMAGE, &attr, AI_PT_IMAGE, &head, (char *)data));
+
+    return rt;
+}
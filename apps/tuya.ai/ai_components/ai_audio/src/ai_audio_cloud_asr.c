@@ -18,13 +18,22 @@
 /***********************************************************
 ************************macro define************************
 ***********************************************************/
-#define AI_AUDIO_UPLOAD_VAD_TM_MS (300 + 300)
+// vad reports speech late by its minimum speech time, the pre-roll goes in front of that
+#define AI_AUDIO_UPLOAD_VAD_TM_MS (AI_AUDIO_VAD_SPEECH_MIN_MS + AI_AUDIO_INPUT_PREROLL_MS)
 
 #define AI_AUDIO_RB_TIME_MS          (10 * 1000)
 #define AI_AUDIO_UPLOAD_MIN_TIME_MS  (100)
 #define AI_AUDIO_UPLOAD_BUFF_TIME_MS (100)
 #define AI_AUDIO_WAIT_ASR_TM_MS      (10 * 1000)
 
+// queue wait while nothing is uploaded, only the pre-roll trim runs then
+#define AI_AUDIO_IDLE_POLL_MS (100)
+
+// an event opened on the wakeup word and not used by then is dropped
+#ifndef AI_AUDIO_PREPARE_TM_MS
+#define AI_AUDIO_PREPARE_TM_MS (5 * 1000)
+#endif
+
 #define AI_CLOUD_ASR_EVENT(event)                                                                                      \
     do {                                                                                                               \
         PR_DEBUG("ai cloud asr event: %d", event);                                                                     \
@@ -53,11 +62,13 @@ typedef enum {
     AI_CLOUD_ASR_EVT_START,
     AI_CLOUD_ASR_EVT_UPLOADING,
     AI_CLOUD_ASR_EVT_STOP,
+    AI_CLOUD_ASR_EVT_PREPARE,
 } AI_CLOUD_ASR_EVENT_E;
 
 typedef struct {
     AI_CLOUD_ASR_EVENT_E event;
     bool                 is_force_interrupt;
+    bool                 need_ack;
 }AI_CLOUD_ASR_MSG_T;
 
 typedef struct {
@@ -68,6 +79,14 @@ typedef struct {
     AI_CLOUD_ASR_STATE_E        state;
     TIMER_ID                    asr_timer_id;
 
+    // posted by the task once a message with need_ack is handled
+    SEM_HANDLE                  ack_sem;
+    OPERATE_RET                 ack_rt;
+
+    // upload event opened ahead of the speech
+    bool                        is_prepared;
+    SYS_TIME_T                  prepared_ms;
+
     AI_CLOUD_ASR_UPLOAD_STATE_E upload_state;
     TIMER_ID                    upload_timer_id;
     uint8_t                    *upload_buffer;
@@ -97,6 +116,7 @@ static void __ai_audio_wait_cloud_asr_tm_cb(TIMER_ID timer_id, void *arg)
 
     send_msg.event = AI_CLOUD_ASR_EVT_ENTER_IDLE;
     send_msg.is_force_interrupt = false;
+    send_msg.need_ack = false;
     tal_queue_post(sg_ai_cloud_asr.queue, &send_msg, 0);
 
     tal_mutex_unlock(sg_ai_cloud_asr.mutex);
@@ -104,6 +124,49 @@ static void __ai_audio_wait_cloud_asr_tm_cb(TIMER_ID timer_id, void *arg)
     return;
 }
 
+static void __ai_audio_cloud_asr_trim(void)
+{
+    uint32_t keep = AI_AUDIO_VOICE_FRAME_LEN_GET(AI_AUDIO_UPLOAD_VAD_TM_MS);
+    uint32_t used = ai_audio_get_input_data_size();
+
+    // Only retain the data within the time period of AI_AUDIO_UPLOAD_VAD_TM_MS as VAD data,
+    // and send it together with the speech data to the cloud for ASR.
+    if (used > keep) {
+        ai_audio_discard_input_data(used - keep);
+    }
+}
+
+static void __ai_audio_cloud_asr_drop_prepared(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    if (false == sg_ai_cloud_asr.is_prepared) {
+        return;
+    }
+
+    // the event never carried audio, breaking it keeps the cloud from answering it
+    sg_ai_cloud_asr.is_prepared = false;
+    TUYA_CALL_ERR_LOG(ai_audio_agent_chat_intrrupt());
+}
+
+static OPERATE_RET __ai_audio_cloud_asr_post(AI_CLOUD_ASR_EVENT_E event, bool is_force_interrupt, bool need_ack)
+{
+    OPERATE_RET rt = OPRT_OK;
+    AI_CLOUD_ASR_MSG_T send_msg;
+
+    send_msg.event = event;
+    send_msg.is_force_interrupt = is_force_interrupt;
+    send_msg.need_ack = need_ack;
+    TUYA_CALL_ERR_RETURN(tal_queue_post(sg_ai_cloud_asr.queue, &send_msg, 0));
+
+    if (need_ack) {
+        tal_semaphore_wait(sg_ai_cloud_asr.ack_sem, SEM_WAIT_FOREVER);
+        rt = sg_ai_cloud_asr.ack_rt;
+    }
+
+    return rt;
+}
+
 static void __ai_audio_cloud_asr_task(void *arg)
 {
     static AI_CLOUD_ASR_STATE_E last_state;
@@ -114,15 +177,15 @@ static void __ai_audio_cloud_asr_task(void *arg)
     sg_ai_cloud_asr.state = AI_CLOUD_ASR_STATE_IDLE;
 
     for (;;) {
-        rt = tal_queue_fetch(sg_ai_cloud_asr.queue, &msg, 20);
+        rt = tal_queue_fetch(sg_ai_cloud_asr.queue, &msg, sg_ai_cloud_asr.is_uploading ? 20 : AI_AUDIO_IDLE_POLL_MS);
         if (OPRT_OK != rt) {
             // wait event timeout
+            msg.is_force_interrupt = false;
+            msg.need_ack = false;
             if (true == sg_ai_cloud_asr.is_uploading) {
                 msg.event = AI_CLOUD_ASR_EVT_UPLOADING;
-                msg.is_force_interrupt = false;
             } else {
                 msg.event = AI_CLOUD_ASR_EVT_UPDATE_VAD;
-                msg.is_force_interrupt = false;
             }
         } else {
             AI_CLOUD_ASR_EVENT(msg.event);
@@ -130,7 +193,9 @@ static void __ai_audio_cloud_asr_task(void *arg)
 
         if (true == msg.is_force_interrupt) {
             ai_audio_agent_chat_intrrupt();
+            sg_ai_cloud_asr.is_prepared = false;
         }
+        sg_ai_cloud_asr.ack_rt = OPRT_OK;
 
         switch (msg.event) {
         case AI_CLOUD_ASR_EVT_ENTER_IDLE: {
@@ -139,20 +204,31 @@ static void __ai_audio_cloud_asr_task(void *arg)
                 tal_sw_timer_stop(sg_ai_cloud_asr.asr_timer_id);
             }
 
+            if (false == sg_ai_cloud_asr.is_uploading) {
+                __ai_audio_cloud_asr_drop_prepared();
+            }
+            sg_ai_cloud_asr.is_uploading = false;
             sg_ai_cloud_asr.state = AI_CLOUD_ASR_STATE_IDLE;
-
-            send_msg.event = AI_CLOUD_ASR_EVT_UPDATE_VAD;
-            send_msg.is_force_interrupt = false;
-            tal_queue_post(sg_ai_cloud_asr.queue, &send_msg, 0);
+            __ai_audio_cloud_asr_trim();
         } break;
         case AI_CLOUD_ASR_EVT_UPDATE_VAD: {
-            uint32_t discard_size = 0;
+            __ai_audio_cloud_asr_trim();
 
-            // Only retain the data within the time period of AI_AUDIO_VAD_ACITVE_TM_MS as VAD data,
-            // and send it together with the speech data to the cloud for ASR.
-            if (ai_audio_get_input_data_size() > AI_AUDIO_VOICE_FRAME_LEN_GET(AI_AUDIO_UPLOAD_VAD_TM_MS)) {
-                discard_size = ai_audio_get_input_data_size() - AI_AUDIO_VOICE_FRAME_LEN_GET(AI_AUDIO_UPLOAD_VAD_TM_MS);
-                ai_audio_discard_input_data(discard_size);
+            if (sg_ai_cloud_asr.is_prepared &&
+                tal_system_get_millisecond() - sg_ai_cloud_asr.prepared_ms > AI_AUDIO_PREPARE_TM_MS) {
+                PR_DEBUG("prepared upload not used, drop it");
+                __ai_audio_cloud_asr_drop_prepared();
+            }
+        } break;
+        case AI_CLOUD_ASR_EVT_PREPARE: {
+            if (sg_ai_cloud_asr.is_uploading || sg_ai_cloud_asr.is_prepared) {
+                break;
+            }
+
+            // the event start round trip runs while the speech and its pre-roll are still captured
+            if (OPRT_OK == ai_audio_agent_upload_start(true)) {
+                sg_ai_cloud_asr.is_prepared = true;
+                sg_ai_cloud_asr.prepared_ms = tal_system_get_millisecond();
             }
         } break;
         case AI_CLOUD_ASR_EVT_START: {
@@ -162,18 +238,29 @@ static void __ai_audio_cloud_asr_task(void *arg)
                 tal_sw_timer_stop(sg_ai_cloud_asr.asr_timer_id);
             }
 
-            rt = ai_audio_agent_upload_start(true);
+            // the pre-roll is trimmed at a coarse pace while idle, cut it to size now
+            __ai_audio_cloud_asr_trim();
+
+            if (sg_ai_cloud_asr.is_prepared) {
+                sg_ai_cloud_asr.is_prepared = false;
+                PR_DEBUG("upload on the prepared event");
+            } else {
+                rt = ai_audio_agent_upload_start(true);
+            }
+            sg_ai_cloud_asr.ack_rt = rt;
             if (OPRT_OK == rt) {
                 sg_ai_cloud_asr.is_uploading = true;
 
                 sg_ai_cloud_asr.state = AI_CLOUD_ASR_STATE_UPLOAD;
                 send_msg.event = AI_CLOUD_ASR_EVT_UPLOADING;
                 send_msg.is_force_interrupt = false;
+                send_msg.need_ack = false;
                 TUYA_CALL_ERR_LOG(tal_queue_post(sg_ai_cloud_asr.queue, &send_msg, 0));
             } else {
                 PR_NOTICE("upload start fail");
                 send_msg.event = AI_CLOUD_ASR_EVT_ENTER_IDLE;
                 send_msg.is_force_interrupt = false;
+                send_msg.need_ack = false;
                 TUYA_CALL_ERR_LOG(tal_queue_post(sg_ai_cloud_asr.queue, &send_msg, 0));
             }
         } break;
@@ -190,11 +277,18 @@ static void __ai_audio_cloud_asr_task(void *arg)
                 break;
             }
 
-            upload_len = ai_audio_get_input_data(sg_ai_cloud_asr.upload_buffer, sg_ai_cloud_asr.upload_buffer_len);
+            // upload straight from the input ring, no staging copy
+            uint8_t *upload_data = NULL;
+            SYS_TIME_T capture_ms = ai_audio_get_input_data_timestamp();
+            upload_len = ai_audio_peek_input_data(&upload_data);
             if (0 == upload_len) {
                 break;
             }
-            TUYA_CALL_ERR_LOG(ai_audio_agent_upload_data(sg_ai_cloud_asr.upload_buffer, upload_len));
+            if (upload_len > sg_ai_cloud_asr.upload_buffer_len) {
+                upload_len = sg_ai_cloud_asr.upload_buffer_len;
+            }
+            TUYA_CALL_ERR_LOG(ai_audio_agent_upload_pcm(upload_data, upload_len, capture_ms));
+            ai_audio_commit_input_data(upload_len);
         } break;
         case AI_CLOUD_ASR_EVT_STOP: {
             uint32_t upload_len = 0;
@@ -213,12 +307,13 @@ static void __ai_audio_cloud_asr_task(void *arg)
                     break;
                 }
 
+                SYS_TIME_T capture_ms = ai_audio_get_input_data_timestamp();
                 upload_len = ai_audio_get_input_data(sg_ai_cloud_asr.upload_buffer, sg_ai_cloud_asr.upload_buffer_len);
                 if (0 == upload_len) {
                     break;
                 }
 
-                TUYA_CALL_ERR_LOG(ai_audio_agent_upload_data(sg_ai_cloud_asr.upload_buffer, upload_len));
+                TUYA_CALL_ERR_LOG(ai_audio_agent_upload_pcm(sg_ai_cloud_asr.upload_buffer, upload_len, capture_ms));
                 if (input_data_size <= upload_len) {
                     break;
                 }
@@ -232,10 +327,13 @@ static void __ai_audio_cloud_asr_task(void *arg)
             sg_ai_cloud_asr.state = AI_CLOUD_ASR_STATE_WAIT_ASR;
             sg_ai_cloud_asr.is_uploading = false;
         } break;
+        }
 
-            AI_CLOUD_ASR_STAT_CHANGE(last_state, sg_ai_cloud_asr.state);
+        AI_CLOUD_ASR_STAT_CHANGE(last_state, sg_ai_cloud_asr.state);
+        last_state = sg_ai_cloud_asr.state;
 
-            last_state = sg_ai_cloud_asr.state;
+        if (msg.need_ack) {
+            tal_semaphore_post(sg_ai_cloud_asr.ack_sem);
         }
     }
 }
@@ -260,6 +358,7 @@ OPERATE_RET ai_audio_cloud_asr_init(void)
                        __ERR);
 
     TUYA_CALL_ERR_GOTO(tal_mutex_create_init(&sg_ai_cloud_asr.mutex), __ERR);
+    TUYA_CALL_ERR_GOTO(tal_semaphore_create_init(&sg_ai_cloud_asr.ack_sem, 0, 1), __ERR);
     TUYA_CALL_ERR_GOTO(tkl_thread_create_in_psram(&sg_ai_cloud_asr.thrd_hdl, "audio_cloud_asr", 1024 * 4, THREAD_PRIO_1,
                                                   __ai_audio_cloud_asr_task, NULL),
                        __ERR);
@@ -284,6 +383,11 @@ __ERR:
         sg_ai_cloud_asr.mutex = NULL;
     }
 
+    if (sg_ai_cloud_asr.ack_sem) {
+        tal_semaphore_release(sg_ai_cloud_asr.ack_sem);
+        sg_ai_cloud_asr.ack_sem = NULL;
+    }
+
     if (sg_ai_cloud_asr.queue) {
         tal_queue_free(sg_ai_cloud_asr.queue);
         sg_ai_cloud_asr.queue = NULL;
@@ -302,7 +406,6 @@ __ERR:
 OPERATE_RET ai_audio_cloud_asr_start(void)
 {
     OPERATE_RET rt = OPRT_OK;
-    AI_CLOUD_ASR_MSG_T send_msg;
 
     tal_mutex_lock(sg_ai_cloud_asr.mutex);
 
@@ -312,22 +415,37 @@ OPERATE_RET ai_audio_cloud_asr_start(void)
         return OPRT_COM_ERROR;
     }
 
-    send_msg.is_force_interrupt = false;
-    send_msg.event = AI_CLOUD_ASR_EVT_START;
-    TUYA_CALL_ERR_LOG(tal_queue_post(sg_ai_cloud_asr.queue, &send_msg, 0));
-
-    // wait is_uploading true
-    while (false == sg_ai_cloud_asr.is_uploading) {
-        tal_system_sleep(10);
-    }
+    rt = __ai_audio_cloud_asr_post(AI_CLOUD_ASR_EVT_START, false, true);
 
     tal_mutex_unlock(sg_ai_cloud_asr.mutex);
 
+    if (OPRT_OK != rt) {
+        PR_ERR("ai audio cloud asr start failed, rt:%d", rt);
+        return rt;
+    }
+
     PR_NOTICE("ai audio cloud asr start");
 
     return OPRT_OK;
 }
 
+/**
+ * @brief Opens the upload event ahead of the speech, so ai_audio_cloud_asr_start() does not wait for it.
+ *        Called on the wakeup word, the event is dropped if no speech follows in AI_AUDIO_PREPARE_TM_MS.
+ * @param None
+ * @return OPERATE_RET - OPRT_OK if the request is queued, otherwise an error code.
+ */
+OPERATE_RET ai_audio_cloud_asr_prepare(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    tal_mutex_lock(sg_ai_cloud_asr.mutex);
+    rt = __ai_audio_cloud_asr_post(AI_CLOUD_ASR_EVT_PREPARE, false, false);
+    tal_mutex_unlock(sg_ai_cloud_asr.mutex);
+
+    return rt;
+}
+
 /**
  * @brief Stops the audio cloud ASR process.
  * @param None
@@ -336,7 +454,6 @@ OPERATE_RET ai_audio_cloud_asr_start(void)
 OPERATE_RET ai_audio_cloud_asr_stop(void)
 {
     OPERATE_RET rt = OPRT_OK;
-    AI_CLOUD_ASR_MSG_T send_msg;
 
     tal_mutex_lock(sg_ai_cloud_asr.mutex);
 
@@ -346,14 +463,7 @@ OPERATE_RET ai_audio_cloud_asr_stop(void)
         return OPRT_COM_ERROR;
     }
 
-    send_msg.event = AI_CLOUD_ASR_EVT_STOP;
-    send_msg.is_force_interrupt = false;
-    TUYA_CALL_ERR_LOG(tal_queue_post(sg_ai_cloud_asr.queue, &send_msg, 0));
-
-    // wait is_uploading false
-    while (true == sg_ai_cloud_asr.is_uploading) {
-        tal_system_sleep(10);
-    }
+    TUYA_CALL_ERR_LOG(__ai_audio_cloud_asr_post(AI_CLOUD_ASR_EVT_STOP, false, true));
 
     tal_mutex_unlock(sg_ai_cloud_asr.mutex);
 
@@ -370,7 +480,6 @@ OPERATE_RET ai_audio_cloud_asr_stop(void)
 OPERATE_RET ai_audio_cloud_stop_wait_asr(void)
 {
     OPERATE_RET rt = OPRT_OK;
-    AI_CLOUD_ASR_MSG_T send_msg;
 
     tal_mutex_lock(sg_ai_cloud_asr.mutex);
 
@@ -380,9 +489,7 @@ OPERATE_RET ai_audio_cloud_stop_wait_asr(void)
         return OPRT_COM_ERROR;
     }
 
-    send_msg.event = AI_CLOUD_ASR_EVT_ENTER_IDLE;
-    send_msg.is_force_interrupt = false;
-    TUYA_CALL_ERR_LOG(tal_queue_post(sg_ai_cloud_asr.queue, &send_msg, 0));
+    TUYA_CALL_ERR_LOG(__ai_audio_cloud_asr_post(AI_CLOUD_ASR_EVT_ENTER_IDLE, false, false));
 
     tal_mutex_unlock(sg_ai_cloud_asr.mutex);
 
@@ -397,27 +504,16 @@ OPERATE_RET ai_audio_cloud_stop_wait_asr(void)
 OPERATE_RET ai_audio_cloud_asr_set_idle(bool is_force)
 {
     OPERATE_RET rt = OPRT_OK;
-    AI_CLOUD_ASR_MSG_T send_msg;
+    bool is_force_interrupt = false;
 
     tal_mutex_lock(sg_ai_cloud_asr.mutex);
 
     if (true == is_force || sg_ai_cloud_asr.state != AI_CLOUD_ASR_STATE_IDLE) {
-        send_msg.is_force_interrupt = true;
-    } else {
-        send_msg.is_force_interrupt = false;
+        is_force_interrupt = true;
     }
 
-    send_msg.event = AI_CLOUD_ASR_EVT_ENTER_IDLE;
-    TUYA_CALL_ERR_LOG(tal_queue_post(sg_ai_cloud_asr.queue, &send_msg, 0));
-
-    // wait state is idle
-    while (sg_ai_cloud_asr.state != AI_CLOUD_ASR_STATE_IDLE) {
-        tal_system_sleep(10);
-    }
-
-    if (sg_ai_cloud_asr.is_uploading) {
-        sg_ai_cloud_asr.is_uploading = false;
-    }
+    // returns once the task is idle
+    TUYA_CALL_ERR_LOG(__ai_audio_cloud_asr_post(AI_CLOUD_ASR_EVT_ENTER_IDLE, is_force_interrupt, true));
 
     tal_mutex_unlock(sg_ai_cloud_asr.mutex);
 
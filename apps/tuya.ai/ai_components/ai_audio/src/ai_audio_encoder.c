@@ -0,0 +1,149 @@
+/**
+ * @file ai_audio_encoder.c
+ * @brief Built-in encoders for the AI audio uplink.
+ *
+ * This file contains the IMA ADPCM encoder used when no Opus encoder is
+ * available. Each frame is self-contained, it carries the predictor state it
+ * starts from so a lost frame does not corrupt the following ones.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#include "tal_api.h"
+
+#include "ai_audio_encoder.h"
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    int32_t predictor;
+    int32_t index;
+} AI_AUDIO_ADPCM_STATE_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static const int16_t sg_adpcm_step_table[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,    19,    21,    23,    25,    28,
+    31,    34,    37,    41,    45,    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,   337,   371,   408,   449,   494,
+    544,   598,   658,   724,   796,   876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,  5894,  6484,  7132,  7845,  8630,
+    9493,  10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+
+static const int8_t sg_adpcm_index_table[16] = {-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static uint8_t __adpcm_encode_sample(AI_AUDIO_ADPCM_STATE_T *state, int16_t sample)
+{
+    int32_t step = sg_adpcm_step_table[state->index];
+    int32_t diff = sample - state->predictor;
+    int32_t delta = step >> 3;
+    uint8_t code = 0;
+
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+    if (diff >= step) {
+        code |= 4;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        code |= 2;
+        diff -= step;
+        delta += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        code |= 1;
+        delta += step;
+    }
+
+    state->predictor += (code & 8) ? -delta : delta;
+    if (state->predictor > 32767) {
+        state->predictor = 32767;
+    } else if (state->predictor < -32768) {
+        state->predictor = -32768;
+    }
+    state->index += sg_adpcm_index_table[code];
+    if (state->index < 0) {
+        state->index = 0;
+    } else if (state->index > 88) {
+        state->index = 88;
+    }
+    return code;
+}
+
+static OPERATE_RET __adpcm_start(void **handle, uint32_t sample_rate, uint16_t channels)
+{
+    if (channels != 1) {
+        PR_ERR("adpcm only supports mono, channels:%d", channels);
+        return OPRT_NOT_SUPPORTED;
+    }
+    AI_AUDIO_ADPCM_STATE_T *state = tal_malloc(sizeof(AI_AUDIO_ADPCM_STATE_T));
+    TUYA_CHECK_NULL_RETURN(state, OPRT_MALLOC_FAILED);
+    memset(state, 0, sizeof(AI_AUDIO_ADPCM_STATE_T));
+    *handle = state;
+    return OPRT_OK;
+}
+
+static uint32_t __adpcm_max_out_len(uint32_t pcm_len)
+{
+    return AI_AUDIO_ADPCM_HEAD_LEN + (pcm_len / 2 + 1) / 2;
+}
+
+static OPERATE_RET __adpcm_encode(void *handle, uint8_t *pcm, uint32_t pcm_len, uint8_t *out, uint32_t *out_len)
+{
+    AI_AUDIO_ADPCM_STATE_T *state = (AI_AUDIO_ADPCM_STATE_T *)handle;
+    uint32_t idx = 0, samples = pcm_len / 2;
+    uint8_t *code = out + AI_AUDIO_ADPCM_HEAD_LEN;
+
+    out[0] = (uint8_t)(state->predictor & 0xFF);
+    out[1] = (uint8_t)((state->predictor >> 8) & 0xFF);
+    out[2] = (uint8_t)state->index;
+    out[3] = 0;
+
+    // low nibble first, pcm is 16 bit little endian
+    for (idx = 0; idx < samples; idx++) {
+        int16_t sample = (int16_t)(pcm[2 * idx] | (pcm[2 * idx + 1] << 8));
+        uint8_t nibble = __adpcm_encode_sample(state, sample);
+        if (idx & 1) {
+            code[idx / 2] |= nibble << 4;
+        } else {
+            code[idx / 2] = nibble;
+        }
+    }
+    *out_len = AI_AUDIO_ADPCM_HEAD_LEN + (samples + 1) / 2;
+    return OPRT_OK;
+}
+
+static void __adpcm_stop(void *handle)
+{
+    if (handle) {
+        tal_free(handle);
+    }
+}
+
+static const AI_AUDIO_ENCODER_T sg_adpcm_encoder = {
+    .codec_type = AUDIO_CODEC_ADPCM,
+    .start = __adpcm_start,
+    .max_out_len = __adpcm_max_out_len,
+    .encode = __adpcm_encode,
+    .stop = __adpcm_stop,
+};
+
+/**
+ * @brief Gets the built-in IMA ADPCM encoder, 4:1 against 16 bit pcm.
+ * @param None
+ * @return const AI_AUDIO_ENCODER_T* - the encoder.
+ */
+const AI_AUDIO_ENCODER_T *ai_audio_encoder_adpcm(void)
+{
+    return &sg_adpcm_encoder;
+}
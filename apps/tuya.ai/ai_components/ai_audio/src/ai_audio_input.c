@@ -21,9 +21,14 @@
 #include "tdl_audio_manage.h"
 
 #include "tal_api.h"
-#include "tuya_ringbuf.h"
+#include "spsc_ring.h"
+#include "tal_trace.h"
 
 #include "ai_audio.h"
+#include "ai_audio_aec.h"
+#if defined(ENABLE_AI_MONITOR) && (ENABLE_AI_MONITOR == 1)
+#include "tuya_ai_monitor.h"
+#endif
 /***********************************************************
 ************************macro define************************
 ***********************************************************/
@@ -32,6 +37,28 @@
 
 #define ASR_PROCE_UNIT_NUM    30
 #define ASR_WAKEUP_TIMEOUT_MS (30000)
+
+// wakeword task, above the input task so recognition keeps pace with the mic
+#ifndef AI_AUDIO_KWS_STACK_SIZE
+#define AI_AUDIO_KWS_STACK_SIZE (1024 * 4)
+#endif
+
+#ifndef AI_AUDIO_KWS_PRIO
+#define AI_AUDIO_KWS_PRIO THREAD_PRIO_0
+#endif
+
+// alignment of the unit buffer handed to the recognizer
+#ifndef AI_AUDIO_KWS_ALIGN
+#define AI_AUDIO_KWS_ALIGN 16
+#endif
+
+// pcm frames collected by the mic callback before the input task is woken up
+#ifndef AI_AUDIO_INPUT_WAKE_FRAMES
+#define AI_AUDIO_INPUT_WAKE_FRAMES 1
+#endif
+
+// upper bound of one wait, so timer driven events are still reported when no frames arrive
+#define AI_AUDIO_INPUT_WAIT_MS (100)
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
@@ -40,9 +67,25 @@ typedef struct {
     bool                is_wakeup;
     bool                is_need_inform_wakeup_stop;
     TIMER_ID            wakeup_timer_id;
-    MUTEX_HANDLE        rb_mutex;
-    TUYA_RINGBUFF_T     feed_ringbuff;
-    uint32_t            buff_len;
+
+    // written by the mic callback, read by the kws task only
+    SPSC_RING_T         feed_ring;
+    uint32_t            pending_len;
+    SEM_HANDLE          kws_sem;
+    THREAD_HANDLE       kws_thrd;
+
+    // one recognizer unit, allocated once in internal ram
+    uint8_t            *unit_mem;
+    uint8_t            *unit_buf;
+    uint32_t            unit_size;
+
+    // set by the kws task, taken by the input task
+    volatile TKL_ASR_WAKEUP_WORD_E wakeup_word;
+
+    uint32_t            frames;
+    uint64_t            total_us;
+    uint32_t            max_us;
+    uint32_t            drop_bytes;
 }AI_AUDIO_INPUT_ASR_T;
 
 typedef struct {
@@ -53,8 +96,13 @@ typedef struct {
     AI_AUDIO_INPUT_STATE_E         state;
     AI_AUDIO_INPUT_VALID_METHOD_E  method;
 
-    TUYA_RINGBUFF_T                ringbuff_hdl;
-    MUTEX_HANDLE                   rb_mutex;
+    // written by the mic callback, read by the uploader, no lock on either side
+    SPSC_RING_T                    ring;
+
+    SEM_HANDLE                     frame_sem;
+    uint32_t                       pending_len;
+    // capture time of the newest frame in the ring
+    volatile SYS_TIME_T            last_frame_ms;
 
     AI_AUDIO_INPUT_ASR_T           asr;  
 
@@ -96,122 +144,156 @@ static void __ai_audio_asr_wakeup_timeout(TIMER_ID timer_id, void *arg)
     PR_NOTICE("asr wakeup timeout");
     sg_audio_input.asr.is_wakeup = false;
     sg_audio_input.asr.is_need_inform_wakeup_stop = true;
+    tal_semaphore_post(sg_audio_input.frame_sem);
 }
 
-static OPERATE_RET __ai_audio_asr_init(void)
+static void __ai_audio_kws_trim(void)
 {
-    OPERATE_RET rt = OPRT_OK;
+    uint32_t keep = AI_AUDIO_VOICE_FRAME_LEN_GET(AI_AUDIO_VAD_ACITVE_TM_MS);
+    uint32_t used = spsc_ring_readable(&sg_audio_input.asr.feed_ring);
 
-    TUYA_CALL_ERR_GOTO(tkl_asr_init(), __ASR_INIT_ERR);
-    TUYA_CALL_ERR_GOTO(
-        tkl_asr_wakeup_word_config((TKL_ASR_WAKEUP_WORD_E *)cWAKEUP_KEYWORD_LIST, CNTSOF(cWAKEUP_KEYWORD_LIST)),
-        __ASR_INIT_ERR);
-    TUYA_CALL_ERR_GOTO(tal_sw_timer_create(__ai_audio_asr_wakeup_timeout, NULL, &sg_audio_input.asr.wakeup_timer_id),
-                       __ASR_INIT_ERR);
+    // only the lead-in of a possible keyword is worth keeping while nobody talks
+    if (used > keep) {
+        spsc_ring_discard(&sg_audio_input.asr.feed_ring, used - keep);
+    }
+}
 
-    sg_audio_input.asr.buff_len = tkl_asr_get_process_uint_size() * ASR_PROCE_UNIT_NUM;
-    PR_DEBUG("sg_audio_input.asr.buff_len:%d", sg_audio_input.asr.buff_len);
-    TUYA_CALL_ERR_GOTO(tuya_ring_buff_create(sg_audio_input.asr.buff_len + tkl_asr_get_process_uint_size(),
-                                             OVERFLOW_PSRAM_STOP_TYPE, &sg_audio_input.asr.feed_ringbuff),
-                       __ASR_INIT_ERR);
-    TUYA_CALL_ERR_GOTO(tal_mutex_create_init(&sg_audio_input.asr.rb_mutex), __ASR_INIT_ERR);
+static void __ai_audio_kws_task(void *arg)
+{
+    AI_AUDIO_INPUT_ASR_T *asr = &sg_audio_input.asr;
+    TKL_ASR_WAKEUP_WORD_E wakeup_word = TKL_ASR_WAKEUP_WORD_UNKNOWN;
+    uint32_t trace_us = 0, cost_us = 0;
+    uint64_t start_us = 0;
 
-    return OPRT_OK;
+    while (1) {
+        // woken by the mic callback once a unit is buffered
+        tal_semaphore_wait(asr->kws_sem, SEM_WAIT_FOREVER);
 
-__ASR_INIT_ERR:
-    tkl_asr_deinit();
+        if (TKL_VAD_STATUS_NONE == tkl_vad_get_status()) {
+            __ai_audio_kws_trim();
+        }
 
-    if (sg_audio_input.asr.wakeup_timer_id) {
-        tal_sw_timer_delete(sg_audio_input.asr.wakeup_timer_id);
-        sg_audio_input.asr.wakeup_timer_id = NULL;
-    }
+#if !(defined(PLATFORM_ESP32) && (PLATFORM_ESP32 == 1))
+        // the recognizer only runs on speech, the buffered lead-in is caught up then
+        if (TKL_VAD_STATUS_SPEECH != tkl_vad_get_status()) {
+            continue;
+        }
+#endif
 
-    if (sg_audio_input.asr.feed_ringbuff) {
-        tuya_ring_buff_free(sg_audio_input.asr.feed_ringbuff);
-        sg_audio_input.asr.feed_ringbuff = NULL;
-    }
+        while (spsc_ring_readable(&asr->feed_ring) >= asr->unit_size) {
+            spsc_ring_read(&asr->feed_ring, asr->unit_buf, asr->unit_size);
 
-    if (sg_audio_input.asr.rb_mutex) {
-        tal_mutex_release(sg_audio_input.asr.rb_mutex);
-        sg_audio_input.asr.rb_mutex = NULL;
-    }
+            trace_us = tal_trace_now();
+            start_us = tal_time_get_mono_us();
+            wakeup_word = tkl_asr_recognize_wakeup_word(asr->unit_buf, asr->unit_size);
+            cost_us = (uint32_t)(tal_time_get_mono_us() - start_us);
+            tal_trace_span_end(TAL_TRACE_USER, "kws frame", trace_us);
 
-    return rt;
+            asr->frames++;
+            asr->total_us += cost_us;
+            if (cost_us > asr->max_us) {
+                asr->max_us = cost_us;
+            }
+
+            if (TKL_ASR_WAKEUP_WORD_UNKNOWN != wakeup_word) {
+                asr->wakeup_word = wakeup_word;
+                tal_semaphore_post(sg_audio_input.frame_sem);
+                break;
+            }
+        }
+    }
 }
 
-static __attribute__((unused)) OPERATE_RET __ai_audio_asr_deinit(void)
+static OPERATE_RET __ai_audio_asr_init(void)
 {
     OPERATE_RET rt = OPRT_OK;
+    AI_AUDIO_INPUT_ASR_T *asr = &sg_audio_input.asr;
+    uint8_t *ring_buf = NULL;
+    uint32_t ring_size = 0;
+
+    TUYA_CALL_ERR_GOTO(tkl_asr_init(), __ASR_INIT_ERR);
+    TUYA_CALL_ERR_GOTO(
+        tkl_asr_wakeup_word_config((TKL_ASR_WAKEUP_WORD_E *)cWAKEUP_KEYWORD_LIST, CNTSOF(cWAKEUP_KEYWORD_LIST)),
+        __ASR_INIT_ERR);
+    TUYA_CALL_ERR_GOTO(tal_sw_timer_create(__ai_audio_asr_wakeup_timeout, NULL, &asr->wakeup_timer_id),
+                       __ASR_INIT_ERR);
+
+    asr->unit_size = tkl_asr_get_process_uint_size();
+    asr->wakeup_word = TKL_ASR_WAKEUP_WORD_UNKNOWN;
 
-    TUYA_CALL_ERR_RETURN(tkl_asr_deinit());
+    // room for ASR_PROCE_UNIT_NUM units plus the one being written, one byte is reserved by the ring
+    ring_size = asr->unit_size * (ASR_PROCE_UNIT_NUM + 1) + 2;
+    PR_DEBUG("asr unit:%d ring:%d", asr->unit_size, ring_size);
+    ring_buf = tkl_system_psram_malloc(ring_size);
+    if (NULL == ring_buf) {
+        rt = OPRT_MALLOC_FAILED;
+        goto __ASR_INIT_ERR;
+    }
+    spsc_ring_init(&asr->feed_ring, ring_buf, ring_size);
 
-    TUYA_CALL_ERR_LOG(tal_sw_timer_delete(sg_audio_input.asr.wakeup_timer_id));
+    asr->unit_mem = tal_malloc(asr->unit_size + AI_AUDIO_KWS_ALIGN);
+    if (NULL == asr->unit_mem) {
+        rt = OPRT_MALLOC_FAILED;
+        goto __ASR_INIT_ERR;
+    }
+    asr->unit_buf =
+        (uint8_t *)(((uintptr_t)asr->unit_mem + AI_AUDIO_KWS_ALIGN - 1) & ~(uintptr_t)(AI_AUDIO_KWS_ALIGN - 1));
 
-    TUYA_CALL_ERR_LOG(tal_mutex_lock(sg_audio_input.asr.rb_mutex));
-    TUYA_CALL_ERR_LOG(tuya_ring_buff_free(sg_audio_input.asr.feed_ringbuff));
-    sg_audio_input.asr.feed_ringbuff = NULL;
-    TUYA_CALL_ERR_LOG(tal_mutex_unlock(sg_audio_input.asr.rb_mutex));
+    TUYA_CALL_ERR_GOTO(tal_semaphore_create_init(&asr->kws_sem, 0, 1), __ASR_INIT_ERR);
 
-    TUYA_CALL_ERR_LOG(tal_mutex_release(sg_audio_input.asr.rb_mutex));
-    sg_audio_input.asr.rb_mutex = NULL;
+    THREAD_CFG_T thrd_cfg = {
+        .stackDepth = AI_AUDIO_KWS_STACK_SIZE,
+        .priority = AI_AUDIO_KWS_PRIO,
+        .thrdname = "ai_kws",
+    };
+    TUYA_CALL_ERR_GOTO(tal_thread_create_and_start(&asr->kws_thrd, NULL, NULL, __ai_audio_kws_task, NULL, &thrd_cfg),
+                       __ASR_INIT_ERR);
 
     return OPRT_OK;
-}
 
-static void __ai_audio_asr_feed(void *data, uint32_t len)
-{
-    tal_mutex_lock(sg_audio_input.asr.rb_mutex);
+__ASR_INIT_ERR:
+    tkl_asr_deinit();
 
-    if (TKL_VAD_STATUS_NONE == tkl_vad_get_status()) {
-        uint32_t rb_used_size = tuya_ring_buff_used_size_get(sg_audio_input.asr.feed_ringbuff);
-        if (rb_used_size > AI_AUDIO_VOICE_FRAME_LEN_GET(AI_AUDIO_VAD_ACITVE_TM_MS)) {
-            uint32_t discard_size = rb_used_size - AI_AUDIO_VOICE_FRAME_LEN_GET(AI_AUDIO_VAD_ACITVE_TM_MS);
-            tuya_ring_buff_discard(sg_audio_input.asr.feed_ringbuff, discard_size);
-        }
+    if (asr->wakeup_timer_id) {
+        tal_sw_timer_delete(asr->wakeup_timer_id);
+        asr->wakeup_timer_id = NULL;
     }
 
-    tuya_ring_buff_write(sg_audio_input.asr.feed_ringbuff, data, len);
+    if (asr->kws_sem) {
+        tal_semaphore_release(asr->kws_sem);
+        asr->kws_sem = NULL;
+    }
 
-    tal_mutex_unlock(sg_audio_input.asr.rb_mutex);
+    if (asr->unit_mem) {
+        tal_free(asr->unit_mem);
+        asr->unit_mem = NULL;
+        asr->unit_buf = NULL;
+    }
 
-    return;
+    if (ring_buf) {
+        tkl_system_psram_free(ring_buf);
+    }
+    memset(&asr->feed_ring, 0, sizeof(asr->feed_ring));
+
+    return rt;
 }
 
-static TKL_ASR_WAKEUP_WORD_E __asr_recognize_wakeup_keyword(void)
+static void __ai_audio_asr_feed(void *data, uint32_t len)
 {
-    uint32_t i = 0, fc = 0;
-    TKL_ASR_WAKEUP_WORD_E wakeup_word = TKL_ASR_WAKEUP_WORD_UNKNOWN;
-    uint32_t uint_size = 0, feed_size = 0;
-
-    uint_size = tkl_asr_get_process_uint_size();
-    tal_mutex_lock(sg_audio_input.asr.rb_mutex);
-    feed_size = tuya_ring_buff_used_size_get(sg_audio_input.asr.feed_ringbuff);
-    tal_mutex_unlock(sg_audio_input.asr.rb_mutex);
-    if (feed_size < uint_size) {
-        return TKL_ASR_WAKEUP_WORD_UNKNOWN;
-    }
+    AI_AUDIO_INPUT_ASR_T *asr = &sg_audio_input.asr;
 
-    uint8_t *p_buf = tkl_system_psram_malloc(uint_size);
-    if (NULL == p_buf) {
-        PR_ERR("malloc fail");
-        return TKL_ASR_WAKEUP_WORD_UNKNOWN;
+    // whole frames only, the kws task trims or catches up on its side
+    if (spsc_ring_free(&asr->feed_ring) < len) {
+        asr->drop_bytes += len;
+    } else {
+        spsc_ring_write(&asr->feed_ring, data, len);
     }
 
-    fc = feed_size / uint_size;
-    for (i = 0; i < fc; i++) {
-        tal_mutex_lock(sg_audio_input.asr.rb_mutex);
-        tuya_ring_buff_read(sg_audio_input.asr.feed_ringbuff, p_buf, uint_size);
-        tal_mutex_unlock(sg_audio_input.asr.rb_mutex);
-
-        wakeup_word = tkl_asr_recognize_wakeup_word(p_buf, uint_size);
-        if (wakeup_word != TKL_ASR_WAKEUP_WORD_UNKNOWN) {
-            break;
-        }
+    asr->pending_len += len;
+    if (asr->pending_len >= asr->unit_size) {
+        asr->pending_len = 0;
+        tal_semaphore_post(asr->kws_sem);
     }
-
-    tkl_system_psram_free(p_buf);
-
-    return wakeup_word;
 }
 
 static void __ai_audio_asr_wakeup(void)
@@ -228,7 +310,7 @@ static OPERATE_RET __ai_audio_vad_init(void)
     TKL_VAD_CONFIG_T vad_config;
     vad_config.sample_rate = 16000;
     vad_config.channel_num = 1;
-    vad_config.speech_min_ms = 300;
+    vad_config.speech_min_ms = AI_AUDIO_VAD_SPEECH_MIN_MS;
     vad_config.noise_min_ms = 500;
     vad_config.scale = 1.0;
     vad_config.frame_duration_ms = 10;
@@ -260,11 +342,10 @@ static void __ai_audio_detect_valid_data_feed(AI_AUDIO_INPUT_VALID_METHOD_E meth
     }
 }
 
-static OPERATE_RET __ai_audio_input_rb_reset(void)
+static OPERATE_RET __ai_audio_input_rb_reset(uint32_t keep_ms)
 {
-    tal_mutex_lock(sg_audio_input.rb_mutex);
-    tuya_ring_buff_reset(sg_audio_input.ringbuff_hdl);
-    tal_mutex_unlock(sg_audio_input.rb_mutex);
+    // called outside the reader context, the reader drops the data on its next access
+    spsc_ring_flush_keep_request(&sg_audio_input.ring, keep_ms ? AI_AUDIO_VOICE_FRAME_LEN_GET(keep_ms) : 0);
 
     return OPRT_OK;
 }
@@ -286,42 +367,19 @@ AI_AUDIO_INPUT_STATE_E __ai_audio_input_get_new_state(AI_AUDIO_INPUT_VALID_METHO
         }
         break;
     case AI_AUDIO_INPUT_VALID_METHOD_ASR: {
-        TKL_ASR_WAKEUP_WORD_E wakeup_word;
+        // recognized by the kws task, only the result is picked up here
+        TKL_ASR_WAKEUP_WORD_E wakeup_word = sg_audio_input.asr.wakeup_word;
 
-#if defined(PLATFORM_ESP32) && (PLATFORM_ESP32 == 1)
-        wakeup_word = __asr_recognize_wakeup_keyword();
         if (TKL_ASR_WAKEUP_WORD_UNKNOWN != wakeup_word) {
+            sg_audio_input.asr.wakeup_word = TKL_ASR_WAKEUP_WORD_UNKNOWN;
             PR_NOTICE("asr wakeup key: %d", wakeup_word);
             state = AI_AUDIO_INPUT_STATE_ASR_WAKEUP_WORD;
             __ai_audio_asr_wakeup();
-        } else {
-            if (true == sg_audio_input.asr.is_wakeup) {
-                if (tkl_vad_get_status() == TKL_VAD_STATUS_SPEECH) {
-                    state = AI_AUDIO_INPUT_STATE_GET_VALID_DATA;
-                } else {
-                    state = AI_AUDIO_INPUT_STATE_DETECTING;
-                }
-            } else {
-                state = AI_AUDIO_INPUT_STATE_DETECTING;
-            }
-        }
-#else
-        if (TKL_VAD_STATUS_SPEECH == tkl_vad_get_status()) {
-            wakeup_word = __asr_recognize_wakeup_keyword();
-            if (wakeup_word != TKL_ASR_WAKEUP_WORD_UNKNOWN) {
-                state = AI_AUDIO_INPUT_STATE_ASR_WAKEUP_WORD;
-                __ai_audio_asr_wakeup();
-            } else {
-                if (true == sg_audio_input.asr.is_wakeup) {
-                    state = AI_AUDIO_INPUT_STATE_GET_VALID_DATA;
-                } else {
-                    state = AI_AUDIO_INPUT_STATE_DETECTING;
-                }
-            }
+        } else if (true == sg_audio_input.asr.is_wakeup && TKL_VAD_STATUS_SPEECH == tkl_vad_get_status()) {
+            state = AI_AUDIO_INPUT_STATE_GET_VALID_DATA;
         } else {
             state = AI_AUDIO_INPUT_STATE_DETECTING;
         }
-#endif
     } break;
     default:
         PR_ERR("get vaild voice method:%d not support", method);
@@ -364,13 +422,19 @@ AI_AUDIO_INPUT_EVENT_E __ai_audio_input_get_event(AI_AUDIO_INPUT_STATE_E curr_st
     return event;
 }
 
+TUYA_HOT_AUDIO
 static void __ai_audio_get_input_frame(TDL_AUDIO_FRAME_FORMAT_E type, TDL_AUDIO_STATUS_E status, uint8_t *data,
                                        uint32_t len)
 {
+    uint32_t trace_us = tal_trace_now();
+
 #if defined(ENABLE_AUDIO_AEC) && (ENABLE_AUDIO_AEC == 1)
 
+#elif (AI_AUDIO_SOFT_AEC_ENABLE == 1)
+    // echo is removed here, so vad keeps listening while the player talks
+    ai_audio_aec_process(data, len);
 #else
-    if (true == ai_audio_player_is_playing()) {
+    if (true == ai_audio_player_is_playing() || true == ai_audio_prompt_is_playing()) {
         tkl_vad_stop();
         return;
     } else {
@@ -382,10 +446,21 @@ static void __ai_audio_get_input_frame(TDL_AUDIO_FRAME_FORMAT_E type, TDL_AUDIO_
         __ai_audio_detect_valid_data_feed(sg_audio_input.method, (uint8_t *)data, len);
     }
 
-    tal_mutex_lock(sg_audio_input.rb_mutex);
-    tuya_ring_buff_write(sg_audio_input.ringbuff_hdl, data, len);
-    tal_mutex_unlock(sg_audio_input.rb_mutex);
+    // whole frames only, so peeked regions never split a sample
+    if (spsc_ring_free(&sg_audio_input.ring) >= len) {
+        spsc_ring_write(&sg_audio_input.ring, data, len);
+        sg_audio_input.last_frame_ms = tal_system_get_millisecond();
+    } else {
+        PR_TRACE("audio input ring full, drop frame");
+    }
+
+    sg_audio_input.pending_len += len;
+    if (sg_audio_input.pending_len >= AI_AUDIO_PCM_FRAME_SIZE * AI_AUDIO_INPUT_WAKE_FRAMES) {
+        sg_audio_input.pending_len = 0;
+        tal_semaphore_post(sg_audio_input.frame_sem);
+    }
 
+    tal_trace_span_end(TAL_TRACE_USER, "mic frame", trace_us);
     return;
 }
 
@@ -396,11 +471,17 @@ static void __ai_audio_handle_frame_task(void *arg)
     AI_AUDIO_INPUT_STATE_E last_state = AI_AUDIO_INPUT_STATE_IDLE;
 
     while (1) {
-        rb_used_sz = tuya_ring_buff_used_size_get(sg_audio_input.ringbuff_hdl);
-        if (0 == rb_used_sz) {
-            tal_system_sleep(10);
+        // woken by the mic callback once a batch of frames is buffered
+        if (OPRT_OK != tal_semaphore_wait(sg_audio_input.frame_sem, AI_AUDIO_INPUT_WAIT_MS) &&
+            false == sg_audio_input.asr.is_need_inform_wakeup_stop) {
+            continue;
+        }
+
+        rb_used_sz = spsc_ring_used(&sg_audio_input.ring);
+        if (0 == rb_used_sz && false == sg_audio_input.asr.is_need_inform_wakeup_stop) {
             continue;
         }
+        uint32_t trace_us = tal_trace_now();
 
         last_state = sg_audio_input.state;
         if (true == sg_audio_input.is_enable_get_valid_data) {
@@ -418,17 +499,24 @@ static void __ai_audio_handle_frame_task(void *arg)
         }
 
         if (AI_AUDIO_INPUT_EVT_ASR_WAKEUP_WORD == event) {
-            // restart vad detection
+            // restart vad detection, speech right after the wakeup word survives as pre-roll
             tkl_vad_stop();
-            __ai_audio_input_rb_reset();
+            __ai_audio_input_rb_reset(AI_AUDIO_INPUT_PREROLL_MS);
             tkl_vad_start();
         }
 
+#if defined(ENABLE_AI_MONITOR) && (ENABLE_AI_MONITOR == 1)
+        if (AI_AUDIO_INPUT_EVT_GET_VALID_VOICE_START == event) {
+            tuya_ai_monitor_stage_mark(AI_MONITOR_STAGE_VAD_START);
+        } else if (AI_AUDIO_INPUT_EVT_GET_VALID_VOICE_STOP == event) {
+            tuya_ai_monitor_stage_mark(AI_MONITOR_STAGE_VAD_STOP);
+        }
+#endif
+
         if ((event != AI_AUDIO_INPUT_EVT_NONE) && sg_audio_input_inform_cb) {
             sg_audio_input_inform_cb(event, NULL);
         }
-
-        tal_system_sleep(10);
+        tal_trace_span_end(TAL_TRACE_USER, "mic batch", trace_us);
     }
 }
 
@@ -441,6 +529,10 @@ static OPERATE_RET __ai_audio_input_open(void)
     TUYA_CALL_ERR_RETURN(tdl_audio_find(AUDIO_CODEC_NAME, &audio_hdl));
     TUYA_CALL_ERR_RETURN(tdl_audio_open(audio_hdl, __ai_audio_get_input_frame));
 
+#if !(defined(ENABLE_AUDIO_AEC) && (ENABLE_AUDIO_AEC == 1)) && (AI_AUDIO_SOFT_AEC_ENABLE == 1)
+    TUYA_CALL_ERR_LOG(ai_audio_aec_init(audio_hdl));
+#endif
+
     PR_DEBUG("__ai_audio_input_hardware_init success");
 
     return OPRT_OK;
@@ -487,9 +579,12 @@ OPERATE_RET ai_audio_input_init(AI_AUDIO_INPUT_CFG_T *cfg, AI_AUDIO_INOUT_INFORM
         return OPRT_OK;
     }
 
-    TUYA_CALL_ERR_RETURN(tuya_ring_buff_create(AI_AUDIO_VOICE_FRAME_LEN_GET(AI_AUDIO_INPUT_RB_TIME_MS) + 1,
-                                               OVERFLOW_PSRAM_STOP_TYPE, &sg_audio_input.ringbuff_hdl));
-    TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&sg_audio_input.rb_mutex));
+    // even size keeps the wrap point on a sample boundary, one byte is reserved by the ring
+    uint32_t ring_size = AI_AUDIO_VOICE_FRAME_LEN_GET(AI_AUDIO_INPUT_RB_TIME_MS) + 2;
+    uint8_t *ring_buf = tkl_system_psram_malloc(ring_size);
+    TUYA_CHECK_NULL_RETURN(ring_buf, OPRT_MALLOC_FAILED);
+    spsc_ring_init(&sg_audio_input.ring, ring_buf, ring_size);
+    TUYA_CALL_ERR_RETURN(tal_semaphore_create_init(&sg_audio_input.frame_sem, 0, 1));
 
     TUYA_CALL_ERR_RETURN(__ai_audio_input_set_method(cfg->get_valid_data_method));
 
@@ -520,7 +615,10 @@ OPERATE_RET ai_audio_input_enable_get_valid_data(bool is_enable)
             tkl_vad_start();
         } else {
             tkl_vad_stop();
-            __ai_audio_input_rb_reset();
+            __ai_audio_input_rb_reset(0);
+            if (AI_AUDIO_INPUT_VALID_METHOD_ASR == sg_audio_input.method) {
+                spsc_ring_flush_request(&sg_audio_input.asr.feed_ring);
+            }
         }
     }
 
@@ -571,6 +669,7 @@ OPERATE_RET ai_audio_input_stop_asr_awake(void)
 
     sg_audio_input.asr.is_wakeup = false;
     sg_audio_input.asr.is_need_inform_wakeup_stop = true;
+    tal_semaphore_post(sg_audio_input.frame_sem);
 
     PR_NOTICE("ai audio needs to be awakened again by the wake-up word");
 
@@ -596,35 +695,68 @@ OPERATE_RET ai_audio_input_restart_asr_awake_timer(void)
     return OPRT_OK;
 }
 
-uint32_t ai_audio_get_input_data(uint8_t *buff, uint32_t buff_len)
+/**
+ * @brief Gets the wakeword recognizer statistics since init.
+ * @param stat Filled with the statistics.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_audio_input_get_kws_stat(AI_AUDIO_INPUT_KWS_STAT_T *stat)
 {
-    uint32_t read_len = 0;
+    AI_AUDIO_INPUT_ASR_T *asr = &sg_audio_input.asr;
+
+    if (NULL == stat) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (AI_AUDIO_INPUT_VALID_METHOD_ASR != sg_audio_input.method) {
+        return OPRT_NOT_SUPPORTED;
+    }
+
+    stat->unit_size = asr->unit_size;
+    stat->frames = asr->frames;
+    stat->avg_us = asr->frames ? (uint32_t)(asr->total_us / asr->frames) : 0;
+    stat->max_us = asr->max_us;
+    stat->drop_bytes = asr->drop_bytes;
+
+    return OPRT_OK;
+}
 
+uint32_t ai_audio_get_input_data(uint8_t *buff, uint32_t buff_len)
+{
     if (NULL == buff || 0 == buff_len) {
         return 0;
     }
 
-    tal_mutex_lock(sg_audio_input.rb_mutex);
-    read_len = tuya_ring_buff_read(sg_audio_input.ringbuff_hdl, buff, buff_len);
-    tal_mutex_unlock(sg_audio_input.rb_mutex);
-
-    return read_len;
+    return spsc_ring_read(&sg_audio_input.ring, buff, buff_len);
 }
 
 uint32_t ai_audio_get_input_data_size(void)
 {
-    uint32_t rb_used_size = 0;
+    return spsc_ring_readable(&sg_audio_input.ring);
+}
+
+uint32_t ai_audio_peek_input_data(uint8_t **data)
+{
+    if (NULL == data) {
+        return 0;
+    }
 
-    tal_mutex_lock(sg_audio_input.rb_mutex);
-    rb_used_size = tuya_ring_buff_used_size_get(sg_audio_input.ringbuff_hdl);
-    tal_mutex_unlock(sg_audio_input.rb_mutex);
+    return spsc_ring_peek(&sg_audio_input.ring, data);
+}
 
-    return rb_used_size;
+void ai_audio_commit_input_data(uint32_t len)
+{
+    spsc_ring_commit(&sg_audio_input.ring, len);
 }
 
 void ai_audio_discard_input_data(uint32_t discard_size)
 {
-    tal_mutex_lock(sg_audio_input.rb_mutex);
-    tuya_ring_buff_discard(sg_audio_input.ringbuff_hdl, discard_size);
-    tal_mutex_unlock(sg_audio_input.rb_mutex);
-}
\ No newline at end of file
+    spsc_ring_discard(&sg_audio_input.ring, discard_size);
+}
+SYS_TIME_T ai_audio_get_input_data_timestamp(void)
+{
+    uint32_t used = spsc_ring_readable(&sg_audio_input.ring);
+
+    // every buffered byte stands for a fixed slice of time before the newest frame
+    return sg_audio_input.last_frame_ms - (SYS_TIME_T)used * AI_AUDIO_PCM_FRAME_TM_MS / AI_AUDIO_PCM_FRAME_SIZE;
+}
@@ -46,6 +46,12 @@ typedef struct {
     TIMER_ID state_tm;
     AI_AUDIO_EVT_INFORM_CB evt_inform_cb;
     AI_AUDIO_STATE_INFORM_CB state_inform_cb;
+
+    // current turn, 0 until reached
+    SYS_TIME_T speech_end_ms;
+    SYS_TIME_T first_packet_ms;
+    uint64_t ttfs_sum_ms;
+    AI_AUDIO_TURN_STATS_T turn;
 } AI_AUDIO_INFO_T;
 
 /***********************************************************
@@ -62,6 +68,37 @@ AI_AUDIO_INFO_T sg_ai_audio = {
 /***********************************************************
 ***********************function define**********************
 ***********************************************************/
+#if ENABLE_AUDIO_CHAT
+static void __ai_audio_turn_update(void)
+{
+    AI_AUDIO_TURN_STATS_T *turn = &sg_ai_audio.turn;
+
+    if (0 == sg_ai_audio.first_packet_ms) {
+        return;
+    }
+
+    SYS_TIME_T first_sound_ms = ai_audio_player_first_sound_ms_get();
+    if (first_sound_ms < sg_ai_audio.first_packet_ms) {
+        // the reply has not sounded yet
+        return;
+    }
+
+    turn->turn_cnt++;
+    turn->ttfs_ms = (uint32_t)(first_sound_ms - sg_ai_audio.speech_end_ms);
+    turn->net_ms = (uint32_t)(sg_ai_audio.first_packet_ms - sg_ai_audio.speech_end_ms);
+    turn->local_ms = (uint32_t)(first_sound_ms - sg_ai_audio.first_packet_ms);
+    turn->ttfs_max_ms = GET_MAX_LEN(turn->ttfs_max_ms, turn->ttfs_ms);
+    sg_ai_audio.ttfs_sum_ms += turn->ttfs_ms;
+    turn->ttfs_avg_ms = (uint32_t)(sg_ai_audio.ttfs_sum_ms / turn->turn_cnt);
+
+    PR_NOTICE("turn %d ttfs:%dms (net:%dms local:%dms) avg:%dms max:%dms", turn->turn_cnt, turn->ttfs_ms, turn->net_ms,
+              turn->local_ms, turn->ttfs_avg_ms, turn->ttfs_max_ms);
+
+    sg_ai_audio.speech_end_ms = 0;
+    sg_ai_audio.first_packet_ms = 0;
+}
+#endif
+
 static void __ai_audio_agent_event_cb(AI_EVENT_TYPE event, AI_EVENT_ID event_id)
 {
     PR_DEBUG("__ai_audio_agent_event_cb event: %d", event);
@@ -129,8 +166,17 @@ static void __ai_audio_agent_msg_cb(AI_AGENT_MSG_T *msg)
 
         snprintf(event_id, PLAYER_ID_LEN_MAX, "NLG_%u", tal_time_get_posix());
 
+        if (sg_ai_audio.speech_end_ms && 0 == sg_ai_audio.first_packet_ms) {
+            sg_ai_audio.first_packet_ms = tal_system_get_millisecond();
+        }
+
         ai_audio_player_start(event_id);
 
+        // the start packet may already carry audio
+        if (msg->data && msg->data_len > 0) {
+            ai_audio_player_data_write(event_id, msg->data, msg->data_len, 0);
+        }
+
         sg_ai_audio.state = AI_AUDIO_STATE_AI_SPEAK;
 #endif
     } break;
@@ -195,6 +241,10 @@ static void __ai_audio_input_inform_handle(AI_AUDIO_INPUT_EVENT_E event, void *a
     case AI_AUDIO_INPUT_EVT_GET_VALID_VOICE_STOP: {
         ai_audio_cloud_asr_stop();
 
+        // a new turn starts, one that never sounded is not counted
+        sg_ai_audio.speech_end_ms = tal_system_get_millisecond();
+        sg_ai_audio.first_packet_ms = 0;
+
         if (AI_AUDIO_WORK_ASR_WAKEUP_SINGLE_TALK == sg_ai_audio.work_mode) {
             ai_audio_input_stop_asr_awake();
         }
@@ -207,6 +257,9 @@ static void __ai_audio_input_inform_handle(AI_AUDIO_INPUT_EVENT_E event, void *a
 
         sg_ai_audio.state = AI_AUDIO_STATE_LISTEN;
 
+        // speech follows the wakeup word, open its upload while it is still captured
+        ai_audio_cloud_asr_prepare();
+
         if (sg_ai_audio.evt_inform_cb) {
             sg_ai_audio.evt_inform_cb(AI_AUDIO_EVT_ASR_WAKEUP, NULL, 0, NULL);
         }
@@ -225,6 +278,10 @@ static void __inform_state_tm_cb(TIMER_ID timer_id, void *arg)
 {
     static AI_AUDIO_STATE_E s_last_state = AI_AUDIO_STATE_MAX;
 
+#if ENABLE_AUDIO_CHAT
+    __ai_audio_turn_update();
+#endif
+
     if (AI_AUDIO_STATE_AI_SPEAK == sg_ai_audio.state) {
         if (false == ai_audio_player_is_playing()) {
             if (sg_ai_audio.work_mode == AI_AUDIO_WORK_VAD_FREE_TALK ||
@@ -294,6 +351,8 @@ OPERATE_RET ai_audio_init(AI_AUDIO_CONFIG_T *cfg)
     TUYA_CALL_ERR_RETURN(ai_audio_cloud_asr_init());
 
     TUYA_CALL_ERR_RETURN(ai_audio_player_init());
+
+    TUYA_CALL_ERR_RETURN(ai_audio_prompt_init());
 #endif
     agent_cbs.ai_agent_msg_cb = __ai_audio_agent_msg_cb;
     agent_cbs.ai_agent_event_cb = __ai_audio_agent_event_cb;
@@ -435,4 +494,17 @@ OPERATE_RET ai_audio_set_wakeup(void)
 AI_AUDIO_STATE_E ai_audio_get_state(void)
 {
     return sg_ai_audio.state;
-}
\ No newline at end of file
+}
+/**
+ * @brief Gets the time to first sound of the chat turns so far.
+ * @param stats Filled with the statistics.
+ * @return OPERATE_RET - OPRT_OK if the operation is successful, otherwise an error code.
+ */
+OPERATE_RET ai_audio_get_turn_stats(AI_AUDIO_TURN_STATS_T *stats)
+{
+    TUYA_CHECK_NULL_RETURN(stats, OPRT_INVALID_PARM);
+
+    memcpy(stats, &sg_ai_audio.turn, sizeof(AI_AUDIO_TURN_STATS_T));
+
+    return OPRT_OK;
+}
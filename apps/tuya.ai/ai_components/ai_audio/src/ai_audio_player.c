@@ -17,11 +17,16 @@
 
 #include "tal_api.h"
 #include "tuya_ringbuf.h"
+#include "tal_trace.h"
 
 #include "tdl_audio_manage.h"
 
 #include "minimp3_ex.h"
 #include "ai_audio.h"
+#if defined(ENABLE_AI_MONITOR) && (ENABLE_AI_MONITOR == 1)
+#include "tuya_ai_monitor.h"
+#include "tuya_health.h"
+#endif
 
 /***********************************************************
 ************************macro define************************
@@ -37,6 +42,45 @@
 #define MP3_PCM_SIZE_MAX           (MAX_NSAMP * MAX_NCHAN * MAX_NGRAN * 2)
 #define PLAYING_NO_DATA_TIMEOUT_MS (5 * 1000)
 
+// decoded pcm buffers shared by the decode task and the output task
+#ifndef AI_AUDIO_PLAYER_PCM_BUF_NUM
+#define AI_AUDIO_PLAYER_PCM_BUF_NUM 2
+#endif
+
+// decoded frames buffered before the first one is sent to the speaker
+#ifndef AI_AUDIO_PLAYER_PREFETCH_FRAMES
+#define AI_AUDIO_PLAYER_PREFETCH_FRAMES 1
+#endif
+
+#if (AI_AUDIO_PLAYER_PREFETCH_FRAMES < 1) || (AI_AUDIO_PLAYER_PREFETCH_FRAMES > AI_AUDIO_PLAYER_PCM_BUF_NUM)
+#error "AI_AUDIO_PLAYER_PREFETCH_FRAMES must be in [1, AI_AUDIO_PLAYER_PCM_BUF_NUM]"
+#endif
+
+// adaptive jitter buffer: decoding waits until target_ms of mp3 is buffered,
+// target_ms = MIN + 4 * inter-arrival deviation, raised by STEP on every underrun
+#ifndef AI_AUDIO_PLAYER_JB_MIN_MS
+#define AI_AUDIO_PLAYER_JB_MIN_MS 60
+#endif
+
+#ifndef AI_AUDIO_PLAYER_JB_MAX_MS
+#define AI_AUDIO_PLAYER_JB_MAX_MS 1000
+#endif
+
+#ifndef AI_AUDIO_PLAYER_JB_STEP_MS
+#define AI_AUDIO_PLAYER_JB_STEP_MS 100
+#endif
+
+// assumed until the first frame tells the real bitrate
+#ifndef AI_AUDIO_PLAYER_JB_DEFAULT_KBPS
+#define AI_AUDIO_PLAYER_JB_DEFAULT_KBPS 32
+#endif
+
+// pipeline mode: a stream starts decoding with its first packet instead of a full jitter buffer,
+// start() returns without waiting for the player task, the buffer only builds up after an underrun
+#ifndef AI_AUDIO_PLAYER_PIPELINE_ENABLE
+#define AI_AUDIO_PLAYER_PIPELINE_ENABLE 1
+#endif
+
 #define AI_AUDIO_PLAYER_STAT_CHANGE(last_stat, new_stat)                                                               \
     do {                                                                                                               \
         if (last_stat != new_stat) {                                                                                   \
@@ -68,8 +112,32 @@ typedef struct {
     uint8_t *mp3_raw;
     uint8_t *mp3_raw_head;
     uint32_t mp3_raw_used_len;
-    uint8_t *mp3_pcm; // mp3 decode to pcm buffer
 
+    // mp3 decode to pcm buffers, filled at pcm_wr and played at pcm_rd
+    THREAD_HANDLE out_thrd_hdl;
+    SEM_HANDLE pcm_ready_sem;
+    uint8_t *pcm_buf[AI_AUDIO_PLAYER_PCM_BUF_NUM];
+    uint32_t pcm_len[AI_AUDIO_PLAYER_PCM_BUF_NUM];
+    uint32_t pcm_gen[AI_AUDIO_PLAYER_PCM_BUF_NUM];
+    uint8_t pcm_wr;
+    uint8_t pcm_rd;
+    volatile uint8_t pcm_queued; // decoded and not played yet
+    uint8_t pcm_held;            // decoded, waiting for the prefetch watermark
+    bool pcm_started;
+    volatile uint32_t gen;       // bumped on stop, older buffers are dropped
+    volatile SYS_TIME_T first_sound_ms; // first pcm of the stream handed to the speaker
+
+    // jitter buffer, guarded by mutex
+    bool jb_buffering;
+    bool jb_fast_start;
+    bool jb_blocked;      // last write waited for room, its gap says nothing about the link
+    SYS_TIME_T jb_last_ms;
+    SYS_TIME_T jb_first_ms;
+    int32_t jb_mean_q4;   // smoothed inter-arrival gap, ms in Q4
+    int32_t jb_dev_q4;    // smoothed |gap - mean|, ms in Q4, kept across streams
+    uint32_t jb_floor_ms; // raised by underruns
+    uint32_t jb_kbps;
+    AI_AUDIO_PLAYER_JB_STATS_T jb_stats;
 } APP_PLAYER_T;
 
 /***********************************************************
@@ -84,6 +152,115 @@ static APP_PLAYER_T sg_player;
 /***********************************************************
 ***********************function define**********************
 ***********************************************************/
+static uint32_t __ai_audio_player_jb_buffered_ms(void)
+{
+    tal_mutex_lock(sg_player.spk_rb_mutex);
+    uint32_t bytes = tuya_ring_buff_used_size_get(sg_player.rb_hdl);
+    tal_mutex_unlock(sg_player.spk_rb_mutex);
+
+    bytes += sg_player.mp3_raw_used_len;
+
+    // kbps is bits per ms
+    return (uint32_t)((uint64_t)bytes * 8 / sg_player.jb_kbps);
+}
+
+static void __ai_audio_player_jb_target_update(void)
+{
+    APP_PLAYER_T *ctx = &sg_player;
+
+    uint32_t target = AI_AUDIO_PLAYER_JB_MIN_MS + ((uint32_t)ctx->jb_dev_q4 * 4 >> 4);
+    target = GET_MAX_LEN(target, ctx->jb_floor_ms);
+    target = GET_MIN_LEN(target, AI_AUDIO_PLAYER_JB_MAX_MS);
+    // the writer must never be blocked before the target can be reached
+    target = GET_MIN_LEN(target, (uint32_t)((uint64_t)MP3_STREAM_BUFF_MAX_LEN * 8 / ctx->jb_kbps * 3 / 4));
+
+    ctx->jb_stats.jitter_ms = (uint32_t)ctx->jb_dev_q4 >> 4;
+    ctx->jb_stats.target_ms = target;
+}
+
+static void __ai_audio_player_jb_reset(void)
+{
+    APP_PLAYER_T *ctx = &sg_player;
+
+    // the deviation describes the link, so the next stream starts from it
+    memset(&ctx->jb_stats, 0, sizeof(ctx->jb_stats));
+    ctx->jb_buffering = true;
+    ctx->jb_fast_start = (AI_AUDIO_PLAYER_PIPELINE_ENABLE == 1);
+    ctx->jb_blocked = false;
+    ctx->jb_last_ms = 0;
+    ctx->jb_first_ms = 0;
+    ctx->jb_mean_q4 = 0;
+    ctx->jb_floor_ms = 0;
+    if (0 == ctx->jb_kbps) {
+        ctx->jb_kbps = AI_AUDIO_PLAYER_JB_DEFAULT_KBPS;
+    }
+    __ai_audio_player_jb_target_update();
+}
+
+static void __ai_audio_player_jb_arrival(void)
+{
+    APP_PLAYER_T *ctx = &sg_player;
+    SYS_TIME_T now = tal_system_get_millisecond();
+
+    if (0 == ctx->jb_first_ms) {
+        ctx->jb_first_ms = now;
+    } else if (false == ctx->jb_blocked) {
+        int32_t gap_q4 = (int32_t)GET_MIN_LEN(now - ctx->jb_last_ms, 10 * 1000) << 4;
+        if (0 == ctx->jb_mean_q4) {
+            ctx->jb_mean_q4 = gap_q4;
+        }
+        int32_t diff = gap_q4 - ctx->jb_mean_q4;
+        ctx->jb_mean_q4 += diff >> 3;
+        ctx->jb_dev_q4 += (((diff < 0) ? -diff : diff) - ctx->jb_dev_q4) >> 3;
+        __ai_audio_player_jb_target_update();
+    }
+    ctx->jb_last_ms = now;
+    ctx->jb_blocked = false;
+}
+
+/**
+ * @brief check whether enough audio is buffered to (re)start decoding
+ */
+static bool __ai_audio_player_jb_ready(void)
+{
+    APP_PLAYER_T *ctx = &sg_player;
+
+    if (false == ctx->jb_buffering) {
+        return true;
+    }
+
+    ctx->jb_stats.buffered_ms = __ai_audio_player_jb_buffered_ms();
+    if (ctx->jb_fast_start && ctx->jb_stats.buffered_ms > 0) {
+        // first packet of the stream, play while the rest downloads
+        ctx->jb_fast_start = false;
+    } else if (ctx->jb_stats.buffered_ms < ctx->jb_stats.target_ms && !ctx->is_eof) {
+        return false;
+    }
+
+    ctx->jb_buffering = false;
+    if (0 == ctx->jb_stats.start_latency_ms && ctx->jb_first_ms) {
+        ctx->jb_stats.start_latency_ms = (uint32_t)(tal_system_get_millisecond() - ctx->jb_first_ms);
+    }
+    PR_DEBUG("jb start, buffered:%dms target:%dms jitter:%dms", ctx->jb_stats.buffered_ms, ctx->jb_stats.target_ms,
+             ctx->jb_stats.jitter_ms);
+
+    return true;
+}
+
+static void __ai_audio_player_jb_underrun(void)
+{
+    APP_PLAYER_T *ctx = &sg_player;
+
+    ctx->jb_stats.underrun_cnt++;
+    ctx->jb_fast_start = false;
+    ctx->jb_floor_ms = GET_MAX_LEN(ctx->jb_floor_ms, ctx->jb_stats.target_ms) + AI_AUDIO_PLAYER_JB_STEP_MS;
+    __ai_audio_player_jb_target_update();
+    ctx->jb_buffering = true;
+
+    PR_NOTICE("jb underrun:%d, target:%dms", ctx->jb_stats.underrun_cnt, ctx->jb_stats.target_ms);
+    tuya_health_metric_count(HEALTH_METRIC_AUDIO_UNDERRUN);
+}
+
 static OPERATE_RET __ai_audio_player_mp3_start(void)
 {
     OPERATE_RET rt = OPRT_OK;
@@ -98,9 +275,40 @@ static OPERATE_RET __ai_audio_player_mp3_start(void)
         mp3dec_init(sg_player.mp3_dec);
     }
 
+    return rt;
+}
+
+/**
+ * @brief reset the per stream state, called from start() before the player task sees the stream
+ */
+static void __ai_audio_player_stream_reset(void)
+{
     sg_player.mp3_raw_used_len = 0;
+    sg_player.pcm_started = false;
+    sg_player.first_sound_ms = 0;
+    __ai_audio_player_jb_reset();
+}
 
-    return rt;
+/**
+ * @brief data is accepted from start() on, before the player task has picked the stream up
+ */
+static bool __ai_audio_player_accepts_data(void)
+{
+    return sg_player.is_playing &&
+           (AI_AUDIO_PLAYER_STAT_IDLE == sg_player.stat || AI_AUDIO_PLAYER_STAT_START == sg_player.stat ||
+            AI_AUDIO_PLAYER_STAT_PLAY == sg_player.stat);
+}
+
+/**
+ * @brief hand the held pcm buffers to the output task
+ */
+static void __ai_audio_player_pcm_release(void)
+{
+    while (sg_player.pcm_held > 0) {
+        sg_player.pcm_held--;
+        tal_semaphore_post(sg_player.pcm_ready_sem);
+    }
+    sg_player.pcm_started = true;
 }
 
 static OPERATE_RET __ai_audio_player_mp3_playing(void)
@@ -122,6 +330,11 @@ static OPERATE_RET __ai_audio_player_mp3_playing(void)
         goto __EXIT;
     }
 
+    if (ctx->pcm_queued >= AI_AUDIO_PLAYER_PCM_BUF_NUM) {
+        // every buffer waits for the speaker, decode again once one is played
+        goto __EXIT;
+    }
+
     if (NULL != ctx->mp3_raw_head && ctx->mp3_raw_used_len > 0 && ctx->mp3_raw_head != ctx->mp3_raw) {
         // PR_DEBUG("move data, offset=%d, used_len=%d", ctx->mp3_raw_head - ctx->mp3_raw, ctx->mp3_raw_used_len);
         memmove(ctx->mp3_raw, ctx->mp3_raw_head, ctx->mp3_raw_used_len);
@@ -142,8 +355,11 @@ static OPERATE_RET __ai_audio_player_mp3_playing(void)
         ctx->mp3_raw_used_len += rt_len;
     }
 
+    uint8_t idx = ctx->pcm_wr;
+    uint32_t trace_us = tal_trace_now();
     int samples = mp3dec_decode_frame(ctx->mp3_dec, ctx->mp3_raw_head, ctx->mp3_raw_used_len,
-                                      (mp3d_sample_t *)ctx->mp3_pcm, &ctx->mp3_frame_info);
+                                      (mp3d_sample_t *)ctx->pcm_buf[idx], &ctx->mp3_frame_info);
+    tal_trace_span_end(TAL_TRACE_USER, "mp3 decode", trace_us);
     if (samples == 0) {
         ctx->mp3_raw_used_len = 0;
         ctx->mp3_raw_head = ctx->mp3_raw;
@@ -151,15 +367,61 @@ static OPERATE_RET __ai_audio_player_mp3_playing(void)
         goto __EXIT;
     }
 
+    if (ctx->mp3_frame_info.bitrate_kbps > 0) {
+        ctx->jb_kbps = ctx->mp3_frame_info.bitrate_kbps;
+    }
+
     ctx->mp3_raw_used_len -= ctx->mp3_frame_info.frame_bytes;
     ctx->mp3_raw_head += ctx->mp3_frame_info.frame_bytes;
 
-    tdl_audio_play(ctx->audio_hdl, ctx->mp3_pcm, samples * 2);
+    // output runs in its own task, so the next frame decodes while this one plays
+    ctx->pcm_len[idx] = samples * 2;
+    ctx->pcm_gen[idx] = ctx->gen;
+    ctx->pcm_wr = (idx + 1) % AI_AUDIO_PLAYER_PCM_BUF_NUM;
+    TAL_ENTER_CRITICAL();
+    ctx->pcm_queued++;
+    TAL_EXIT_CRITICAL();
+
+    ctx->pcm_held++;
+    if (ctx->pcm_started || ctx->pcm_held >= AI_AUDIO_PLAYER_PREFETCH_FRAMES) {
+        __ai_audio_player_pcm_release();
+    }
 
 __EXIT:
     return rt;
 }
 
+static void __ai_audio_player_out_task(void *arg)
+{
+    APP_PLAYER_T *ctx = &sg_player;
+
+    for (;;) {
+        if (OPRT_OK != tal_semaphore_wait(ctx->pcm_ready_sem, SEM_WAIT_FOREVER)) {
+            continue;
+        }
+
+        uint8_t idx = ctx->pcm_rd;
+        ctx->pcm_rd = (idx + 1) % AI_AUDIO_PLAYER_PCM_BUF_NUM;
+
+        // buffers decoded before the last stop are dropped
+        if (ctx->pcm_gen[idx] == ctx->gen) {
+            if (0 == ctx->first_sound_ms) {
+                ctx->first_sound_ms = tal_system_get_millisecond();
+            }
+            uint32_t trace_us = tal_trace_now();
+            tdl_audio_play(ctx->audio_hdl, ctx->pcm_buf[idx], ctx->pcm_len[idx]);
+            tal_trace_span_end(TAL_TRACE_USER, "audio play", trace_us);
+#if defined(ENABLE_AI_MONITOR) && (ENABLE_AI_MONITOR == 1)
+            tuya_ai_monitor_stage_mark(AI_MONITOR_STAGE_PLAY);
+#endif
+        }
+
+        TAL_ENTER_CRITICAL();
+        ctx->pcm_queued--;
+        TAL_EXIT_CRITICAL();
+    }
+}
+
 static OPERATE_RET __ai_audio_player_mp3_init(void)
 {
     OPERATE_RET rt = OPRT_OK;
@@ -169,15 +431,20 @@ static OPERATE_RET __ai_audio_player_mp3_init(void)
     sg_player.mp3_raw = (uint8_t *)tkl_system_psram_malloc(MAINBUF_SIZE);
     TUYA_CHECK_NULL_GOTO(sg_player.mp3_raw, __ERR);
 
-    sg_player.mp3_pcm = (uint8_t *)tkl_system_psram_malloc(MP3_PCM_SIZE_MAX);
-    TUYA_CHECK_NULL_GOTO(sg_player.mp3_pcm, __ERR);
+    uint32_t i = 0;
+    for (i = 0; i < AI_AUDIO_PLAYER_PCM_BUF_NUM; i++) {
+        sg_player.pcm_buf[i] = (uint8_t *)tkl_system_psram_malloc(MP3_PCM_SIZE_MAX);
+        TUYA_CHECK_NULL_GOTO(sg_player.pcm_buf[i], __ERR);
+    }
 
     return rt;
 
 __ERR:
-    if (sg_player.mp3_pcm) {
-        tkl_system_psram_free(sg_player.mp3_pcm);
-        sg_player.mp3_pcm = NULL;
+    for (i = 0; i < AI_AUDIO_PLAYER_PCM_BUF_NUM; i++) {
+        if (sg_player.pcm_buf[i]) {
+            tkl_system_psram_free(sg_player.pcm_buf[i]);
+            sg_player.pcm_buf[i] = NULL;
+        }
     }
 
     if (sg_player.mp3_raw) {
@@ -211,18 +478,29 @@ static void __ai_audio_player_task(void *arg)
             if (tal_sw_timer_is_running(ctx->tm_id)) {
                 tal_sw_timer_stop(ctx->tm_id);
             }
-            ctx->is_eof = 0;
+            // a started stream may already hold all of its data before START is fetched
+            if (false == ctx->is_playing) {
+                ctx->is_eof = 0;
+            }
         } break;
         case AI_AUDIO_PLAYER_STAT_START: {
             rt = __ai_audio_player_mp3_start();
             if (rt != OPRT_OK) {
+                ctx->is_playing = false;
                 ctx->stat = AI_AUDIO_PLAYER_STAT_IDLE;
             } else {
                 ctx->stat = AI_AUDIO_PLAYER_STAT_PLAY;
             }
         } break;
         case AI_AUDIO_PLAYER_STAT_PLAY: {
-            rt = __ai_audio_player_mp3_playing();
+            if (false == __ai_audio_player_jb_ready()) {
+                rt = (0 == ctx->jb_stats.buffered_ms) ? OPRT_RECV_DA_NOT_ENOUGH : OPRT_OK;
+            } else {
+                rt = __ai_audio_player_mp3_playing();
+                if (OPRT_RECV_DA_NOT_ENOUGH == rt && ctx->pcm_started && !ctx->is_eof) {
+                    __ai_audio_player_jb_underrun();
+                }
+            }
             if (OPRT_RECV_DA_NOT_ENOUGH == rt) {
                 tal_sw_timer_start(ctx->tm_id, PLAYING_NO_DATA_TIMEOUT_MS, TAL_TIMER_ONCE);
             } else if (OPRT_OK == rt) {
@@ -234,12 +512,21 @@ static void __ai_audio_player_task(void *arg)
             uint32_t rb_used_len = tuya_ring_buff_used_size_get(ctx->rb_hdl);
             tal_mutex_unlock(ctx->spk_rb_mutex);
             if (rb_used_len == 0 && 0 == ctx->mp3_raw_used_len && ctx->is_eof) {
-                PR_DEBUG("app player end");
-                ctx->stat = AI_AUDIO_PLAYER_STAT_FINISH;
+                // streams shorter than the prefetch watermark, then wait for the speaker to drain
+                __ai_audio_player_pcm_release();
+                if (0 == ctx->pcm_queued) {
+                    PR_DEBUG("app player end");
+                    ctx->stat = AI_AUDIO_PLAYER_STAT_FINISH;
+                }
             }
         } break;
         case AI_AUDIO_PLAYER_STAT_FINISH: {
             tal_sw_timer_stop(ctx->tm_id);
+            PR_DEBUG("jb stats, underrun:%d overflow:%d jitter:%dms target:%dms start latency:%dms",
+                     ctx->jb_stats.underrun_cnt, ctx->jb_stats.overflow_cnt, ctx->jb_stats.jitter_ms,
+                     ctx->jb_stats.target_ms, ctx->jb_stats.start_latency_ms);
+            __ai_audio_player_pcm_release();
+            ctx->pcm_started = false;
 
             ctx->is_playing = false;
             ctx->stat = AI_AUDIO_PLAYER_STAT_IDLE;
@@ -311,11 +598,16 @@ OPERATE_RET ai_audio_player_init(void)
                        __ERR);
     // ring buffer mutex init
     TUYA_CALL_ERR_GOTO(tal_mutex_create_init(&sg_player.spk_rb_mutex), __ERR);
+    tal_mutex_set_name(sg_player.spk_rb_mutex, "spk rb");
+    TUYA_CALL_ERR_GOTO(tal_semaphore_create_init(&sg_player.pcm_ready_sem, 0, AI_AUDIO_PLAYER_PCM_BUF_NUM), __ERR);
 
     // thread init
     TUYA_CALL_ERR_GOTO(
         tkl_thread_create(&sg_player.thrd_hdl, "ai_player", 1024 * 4, THREAD_PRIO_0, __ai_audio_player_task, NULL),
         __ERR);
+    TUYA_CALL_ERR_GOTO(tkl_thread_create(&sg_player.out_thrd_hdl, "ai_player_out", 1024 * 3, THREAD_PRIO_0,
+                                         __ai_audio_player_out_task, NULL),
+                       __ERR);
 
     PR_DEBUG("app player init success");
 
@@ -337,6 +629,11 @@ __ERR:
         sg_player.spk_rb_mutex = NULL;
     }
 
+    if (sg_player.pcm_ready_sem) {
+        tal_semaphore_release(sg_player.pcm_ready_sem);
+        sg_player.pcm_ready_sem = NULL;
+    }
+
     if (sg_player.rb_hdl) {
         tuya_ring_buff_free(sg_player.rb_hdl);
         sg_player.rb_hdl = NULL;
@@ -358,6 +655,9 @@ OPERATE_RET ai_audio_player_start(char *id)
 {
     OPERATE_RET rt = OPRT_OK;
 
+    // the reply replaces any local prompt still sounding
+    ai_audio_prompt_stop();
+
     tal_mutex_lock(sg_player.mutex);
 
     if (true == sg_player.is_playing) {
@@ -379,6 +679,7 @@ OPERATE_RET ai_audio_player_start(char *id)
         }
     }
 
+    __ai_audio_player_stream_reset();
     sg_player.is_playing = true;
 
     AI_AUDIO_PLAYER_STATE_E stat = AI_AUDIO_PLAYER_STAT_START;
@@ -386,6 +687,9 @@ OPERATE_RET ai_audio_player_start(char *id)
 
     tal_mutex_unlock(sg_player.mutex);
 
+#if (AI_AUDIO_PLAYER_PIPELINE_ENABLE == 1)
+    // data written meanwhile is buffered, the player task picks it up once started
+#else
     uint32_t wait_cnt = 0;
     while (sg_player.stat != AI_AUDIO_PLAYER_STAT_PLAY) {
         tal_system_sleep(10);
@@ -394,8 +698,10 @@ OPERATE_RET ai_audio_player_start(char *id)
             // maybe __ai_audio_player_mp3_start failed
             PR_ERR("wait player start timeout");
             rt = OPRT_COM_ERROR;
+            break;
         }
     }
+#endif
 
     PR_NOTICE("ai audio player start");
 
@@ -416,7 +722,7 @@ OPERATE_RET ai_audio_player_data_write(char *id, uint8_t *data, uint32_t len, ui
 {
     uint32_t write_len = 0, alreay_write_len = 0;
 
-    if (AI_AUDIO_PLAYER_STAT_PLAY != sg_player.stat && AI_AUDIO_PLAYER_STAT_START != sg_player.stat) {
+    if (false == __ai_audio_player_accepts_data()) {
         PR_DEBUG("player is not in playing state");
         return OPRT_COM_ERROR;
     }
@@ -432,14 +738,19 @@ OPERATE_RET ai_audio_player_data_write(char *id, uint8_t *data, uint32_t len, ui
     // PR_DEBUG("write data len:%d, is_eof:%d", len, is_eof);
 
     if (NULL != data && len > 0) {
-        while ((alreay_write_len < len) &&
-               (AI_AUDIO_PLAYER_STAT_PLAY == sg_player.stat || AI_AUDIO_PLAYER_STAT_START == sg_player.stat)) {
+        __ai_audio_player_jb_arrival();
+
+        while ((alreay_write_len < len) && __ai_audio_player_accepts_data()) {
 
             sg_player.is_writing = true;
             tal_mutex_lock(sg_player.spk_rb_mutex);
             uint32_t rb_free_len = tuya_ring_buff_free_size_get(sg_player.rb_hdl);
             tal_mutex_unlock(sg_player.spk_rb_mutex);
             if (0 == rb_free_len) {
+                if (false == sg_player.jb_blocked) {
+                    sg_player.jb_blocked = true;
+                    sg_player.jb_stats.overflow_cnt++;
+                }
                 // need unlock mutex before sleep
                 tal_mutex_unlock(sg_player.mutex);
                 tal_system_sleep(5);
@@ -502,6 +813,14 @@ OPERATE_RET ai_audio_player_stop(void)
     tuya_ring_buff_reset(sg_player.rb_hdl);
     tal_mutex_unlock(sg_player.spk_rb_mutex);
 
+    // decoded but unplayed buffers are skipped by the output task
+    sg_player.gen++;
+    __ai_audio_player_pcm_release();
+    sg_player.pcm_started = false;
+    while (sg_player.pcm_queued) {
+        tal_system_sleep(5);
+    }
+
     tdl_audio_play_stop(sg_player.audio_hdl);
 
     sg_player.is_playing = false;
@@ -530,3 +849,34 @@ uint8_t ai_audio_player_is_playing(void)
 {
     return sg_player.is_playing;
 }
+
+/**
+ * @brief Gets the jitter buffer statistics of the current or last stream.
+ *
+ * @param stats Filled with the statistics.
+ * @return OPERATE_RET - Returns OPRT_OK on success, otherwise returns an error code.
+ */
+OPERATE_RET ai_audio_player_jb_stats_get(AI_AUDIO_PLAYER_JB_STATS_T *stats)
+{
+    TUYA_CHECK_NULL_RETURN(stats, OPRT_INVALID_PARM);
+
+    tal_mutex_lock(sg_player.mutex);
+    if (sg_player.jb_kbps) {
+        sg_player.jb_stats.buffered_ms = __ai_audio_player_jb_buffered_ms();
+    }
+    memcpy(stats, &sg_player.jb_stats, sizeof(AI_AUDIO_PLAYER_JB_STATS_T));
+    tal_mutex_unlock(sg_player.mutex);
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Gets the time the current or last stream first reached the speaker.
+ *
+ * @param None
+ * @return SYS_TIME_T - tal_system_get_millisecond() time, 0 if nothing was played yet.
+ */
+SYS_TIME_T ai_audio_player_first_sound_ms_get(void)
+{
+    return sg_player.first_sound_ms;
+}
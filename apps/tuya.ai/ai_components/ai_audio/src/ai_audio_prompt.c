@@ -0,0 +1,672 @@
+/**
+ * @file ai_audio_prompt.c
+ * @brief Local prompt cache, plays pre-decoded pcm instead of running the mp3 player.
+ *
+ * Every prompt is decoded at most once per source version. The pcm goes to
+ * AI_AUDIO_PROMPT_DIR/p<id>.pcm behind a small header that records the size and
+ * hash of the mp3 it came from, so a firmware with new prompts rebuilds the
+ * cache by itself. The file is written under a temporary name and renamed when
+ * complete, a power cut during the first boot leaves no broken cache behind.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#include <stdio.h>
+
+#include "tkl_memory.h"
+
+#include "tal_api.h"
+#include "tal_fs.h"
+
+#include "tdl_audio_manage.h"
+
+#include "minimp3.h"
+#include "ai_audio.h"
+#include "ai_audio_prompt.h"
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define PROMPT_FILE_MAGIC   0x4D435041 // "APCM"
+#define PROMPT_FILE_VERSION 1
+
+// same size as one decoded mp3 frame handed out by the player
+#define PROMPT_CHUNK_LEN (1152 * 2)
+
+#define PROMPT_PATH_LEN          48
+#define PROMPT_QUEUE_WAIT_FOREVER 0xFFFFFFFF
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef uint8_t PROMPT_SRC_E;
+#define PROMPT_SRC_NONE  0 // not decoded yet, played through the mp3 player
+#define PROMPT_SRC_CONST 1 // build time pcm in flash
+#define PROMPT_SRC_RAM   2 // preloaded pcm in psram
+#define PROMPT_SRC_FILE  3 // decoded pcm in the file system
+
+typedef uint8_t PROMPT_MSG_E;
+#define PROMPT_MSG_BUILD 0
+#define PROMPT_MSG_PLAY  1
+
+typedef struct {
+    PROMPT_MSG_E type;
+    uint32_t id;
+    uint32_t seq;
+} PROMPT_MSG_T;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t src_len;
+    uint32_t src_hash;
+    uint32_t sample_rate;
+} PROMPT_FILE_HEAD_T;
+
+typedef struct {
+    AI_AUDIO_PROMPT_T cfg;
+    PROMPT_SRC_E src;
+    bool build_pending;
+    uint8_t *ram;
+    uint32_t pcm_len;
+} PROMPT_NODE_T;
+
+typedef struct {
+    PROMPT_FILE_HEAD_T head;
+    TUYA_FILE file;
+    bool head_written;
+} PROMPT_FILE_SINK_T;
+
+typedef struct {
+    uint8_t *buf;
+    uint32_t len;
+    uint32_t pos;
+} PROMPT_RAM_SINK_T;
+
+typedef OPERATE_RET (*PROMPT_SINK_CB)(void *arg, const int16_t *pcm, uint32_t samples, uint32_t hz);
+
+typedef struct {
+    bool is_init;
+    MUTEX_HANDLE mutex;
+    QUEUE_HANDLE queue;
+    THREAD_HANDLE thrd_hdl;
+    TDL_AUDIO_HANDLE_T audio_hdl;
+    uint8_t *chunk;
+
+    volatile bool is_playing;
+    volatile bool abort;
+    volatile uint32_t seq; // bumped by every play and stop, stale requests are dropped
+
+    uint32_t num;
+    PROMPT_NODE_T node[AI_AUDIO_PROMPT_MAX];
+} AI_AUDIO_PROMPT_MGR_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static AI_AUDIO_PROMPT_MGR_T sg_prompt;
+TAL_THREAD_DEFINE_STATIC(sg_prompt_thrd);
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static uint32_t __prompt_hash(const uint8_t *data, uint32_t len)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    uint32_t i = 0;
+
+    for (i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static void __prompt_path(uint32_t id, bool is_tmp, char *path)
+{
+    snprintf(path, PROMPT_PATH_LEN, "%s/p%u.%s", AI_AUDIO_PROMPT_DIR, (unsigned int)id, is_tmp ? "tmp" : "pcm");
+}
+
+static PROMPT_NODE_T *__prompt_find(uint32_t id)
+{
+    uint32_t i = 0;
+
+    for (i = 0; i < sg_prompt.num; i++) {
+        if (sg_prompt.node[i].cfg.id == id) {
+            return &sg_prompt.node[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief decodes the whole mp3 source, hands every frame as mono pcm to sink
+ */
+static OPERATE_RET __prompt_decode(const AI_AUDIO_PROMPT_T *cfg, PROMPT_SINK_CB sink, void *arg, uint32_t *pcm_len)
+{
+    OPERATE_RET rt = OPRT_OK;
+    mp3dec_frame_info_t info;
+    uint32_t offset = 0, total = 0;
+    int samples = 0, i = 0;
+
+    mp3dec_t *dec = (mp3dec_t *)tkl_system_psram_malloc(sizeof(mp3dec_t));
+    int16_t *pcm = (int16_t *)tkl_system_psram_malloc(MINIMP3_MAX_SAMPLES_PER_FRAME * sizeof(int16_t));
+    if (NULL == dec || NULL == pcm) {
+        rt = OPRT_MALLOC_FAILED;
+        goto __EXIT;
+    }
+    mp3dec_init(dec);
+
+    while (offset < cfg->mp3_len) {
+        memset(&info, 0, sizeof(info));
+        samples = mp3dec_decode_frame(dec, cfg->mp3 + offset, cfg->mp3_len - offset, (mp3d_sample_t *)pcm, &info);
+        if (0 == info.frame_bytes) {
+            break;
+        }
+        offset += info.frame_bytes;
+        if (0 == samples) {
+            continue;
+        }
+
+        if (2 == info.channels) {
+            for (i = 0; i < samples; i++) {
+                pcm[i] = (int16_t)(((int32_t)pcm[2 * i] + pcm[2 * i + 1]) >> 1);
+            }
+        }
+
+        if (sink) {
+            TUYA_CALL_ERR_GOTO(sink(arg, pcm, samples, info.hz), __EXIT);
+        }
+        total += samples * sizeof(int16_t);
+    }
+
+    if (0 == total) {
+        PR_ERR("prompt %d has no audio", cfg->id);
+        rt = OPRT_COM_ERROR;
+    }
+
+__EXIT:
+    if (pcm_len) {
+        *pcm_len = total;
+    }
+    if (dec) {
+        tkl_system_psram_free(dec);
+    }
+    if (pcm) {
+        tkl_system_psram_free(pcm);
+    }
+
+    return rt;
+}
+
+static OPERATE_RET __prompt_file_sink(void *arg, const int16_t *pcm, uint32_t samples, uint32_t hz)
+{
+    PROMPT_FILE_SINK_T *sink = (PROMPT_FILE_SINK_T *)arg;
+    int len = samples * sizeof(int16_t);
+
+    // the rate is only known after the first frame
+    if (false == sink->head_written) {
+        sink->head.sample_rate = hz;
+        if (sizeof(sink->head) != tal_fwrite(&sink->head, sizeof(sink->head), sink->file)) {
+            return OPRT_FILE_WRITE_FAILED;
+        }
+        sink->head_written = true;
+    }
+
+    if (len != tal_fwrite((void *)pcm, len, sink->file)) {
+        return OPRT_FILE_WRITE_FAILED;
+    }
+
+    return OPRT_OK;
+}
+
+static OPERATE_RET __prompt_ram_sink(void *arg, const int16_t *pcm, uint32_t samples, uint32_t hz)
+{
+    PROMPT_RAM_SINK_T *sink = (PROMPT_RAM_SINK_T *)arg;
+    uint32_t len = samples * sizeof(int16_t);
+
+    if (sink->pos + len > sink->len) {
+        return OPRT_BUFFER_NOT_ENOUGH;
+    }
+    memcpy(sink->buf + sink->pos, pcm, len);
+    sink->pos += len;
+
+    return OPRT_OK;
+}
+
+static bool __prompt_file_check(PROMPT_NODE_T *node, uint32_t hash)
+{
+    PROMPT_FILE_HEAD_T head;
+    char path[PROMPT_PATH_LEN];
+
+    __prompt_path(node->cfg.id, false, path);
+    int size = tal_fgetsize(path);
+    if (size <= (int)sizeof(head)) {
+        return false;
+    }
+
+    TUYA_FILE file = tal_fopen(path, "r");
+    if (NULL == file) {
+        return false;
+    }
+    int rd = tal_fread(&head, sizeof(head), file);
+    tal_fclose(file);
+
+    if (sizeof(head) != rd || PROMPT_FILE_MAGIC != head.magic || PROMPT_FILE_VERSION != head.version ||
+        node->cfg.mp3_len != head.src_len || hash != head.src_hash) {
+        return false;
+    }
+
+    node->pcm_len = size - sizeof(head);
+
+    return true;
+}
+
+static OPERATE_RET __prompt_file_build(PROMPT_NODE_T *node, uint32_t hash)
+{
+    OPERATE_RET rt = OPRT_OK;
+    PROMPT_FILE_SINK_T sink;
+    char path[PROMPT_PATH_LEN], tmp_path[PROMPT_PATH_LEN];
+    uint32_t pcm_len = 0;
+
+    __prompt_path(node->cfg.id, false, path);
+    __prompt_path(node->cfg.id, true, tmp_path);
+
+    memset(&sink, 0, sizeof(sink));
+    sink.head.magic = PROMPT_FILE_MAGIC;
+    sink.head.version = PROMPT_FILE_VERSION;
+    sink.head.src_len = node->cfg.mp3_len;
+    sink.head.src_hash = hash;
+
+    sink.file = tal_fopen(tmp_path, "w");
+    if (NULL == sink.file) {
+        return OPRT_FILE_OPEN_FAILED;
+    }
+    rt = __prompt_decode(&node->cfg, __prompt_file_sink, &sink, &pcm_len);
+    tal_fclose(sink.file);
+
+    if (OPRT_OK == rt) {
+        tal_fs_remove(path);
+        rt = (0 == tal_fs_rename(tmp_path, path)) ? OPRT_OK : OPRT_COM_ERROR;
+    }
+    if (OPRT_OK != rt) {
+        tal_fs_remove(tmp_path);
+        return rt;
+    }
+
+    node->pcm_len = pcm_len;
+
+    return OPRT_OK;
+}
+
+static OPERATE_RET __prompt_preload(PROMPT_NODE_T *node)
+{
+    OPERATE_RET rt = OPRT_OK;
+    PROMPT_RAM_SINK_T sink;
+
+    if (PROMPT_SRC_NONE == node->src) {
+        // no file system, find the size first
+        TUYA_CALL_ERR_RETURN(__prompt_decode(&node->cfg, NULL, NULL, &node->pcm_len));
+    }
+
+    uint8_t *ram = tkl_system_psram_malloc(node->pcm_len);
+    TUYA_CHECK_NULL_RETURN(ram, OPRT_MALLOC_FAILED);
+
+    if (PROMPT_SRC_FILE == node->src) {
+        char path[PROMPT_PATH_LEN];
+        __prompt_path(node->cfg.id, false, path);
+        TUYA_FILE file = tal_fopen(path, "r");
+        if (NULL == file) {
+            rt = OPRT_FILE_OPEN_FAILED;
+            goto __EXIT;
+        }
+        PROMPT_FILE_HEAD_T head;
+        int rd = tal_fread(&head, sizeof(head), file);
+        if (sizeof(head) == rd) {
+            rd = tal_fread(ram, node->pcm_len, file);
+        }
+        tal_fclose(file);
+        rt = ((int)node->pcm_len == rd) ? OPRT_OK : OPRT_FILE_READ_FAILED;
+    } else {
+        sink.buf = ram;
+        sink.len = node->pcm_len;
+        sink.pos = 0;
+        rt = __prompt_decode(&node->cfg, __prompt_ram_sink, &sink, NULL);
+    }
+
+__EXIT:
+    if (OPRT_OK != rt) {
+        tkl_system_psram_free(ram);
+        return rt;
+    }
+
+    node->ram = ram;
+    node->src = PROMPT_SRC_RAM;
+
+    return OPRT_OK;
+}
+
+static void __prompt_build(PROMPT_NODE_T *node)
+{
+    OPERATE_RET rt = OPRT_OK;
+    SYS_TIME_T start = tal_system_get_millisecond();
+
+    if (node->cfg.pcm) {
+        // build time pcm is memory mapped already, nothing to prepare
+        node->pcm_len = node->cfg.pcm_len;
+        node->src = PROMPT_SRC_CONST;
+        return;
+    }
+
+    uint32_t hash = __prompt_hash(node->cfg.mp3, node->cfg.mp3_len);
+    if (__prompt_file_check(node, hash)) {
+        node->src = PROMPT_SRC_FILE;
+    } else if (OPRT_OK == __prompt_file_build(node, hash)) {
+        node->src = PROMPT_SRC_FILE;
+        PR_DEBUG("prompt %d decoded to flash, %d bytes, %dms", node->cfg.id, node->pcm_len,
+                 (uint32_t)(tal_system_get_millisecond() - start));
+    }
+
+    // without a file system only preload prompts can skip the decoder
+    if (node->cfg.preload) {
+        TUYA_CALL_ERR_LOG(__prompt_preload(node));
+    }
+}
+
+static PROMPT_NODE_T *__prompt_build_next(void)
+{
+    PROMPT_NODE_T *next = NULL;
+    uint32_t i = 0;
+
+    tal_mutex_lock(sg_prompt.mutex);
+    for (i = 0; i < sg_prompt.num; i++) {
+        PROMPT_NODE_T *node = &sg_prompt.node[i];
+        if (false == node->build_pending) {
+            continue;
+        }
+        if (node->cfg.preload) {
+            next = node;
+            break;
+        }
+        if (NULL == next) {
+            next = node;
+        }
+    }
+    tal_mutex_unlock(sg_prompt.mutex);
+
+    return next;
+}
+
+static OPERATE_RET __prompt_play_mp3(PROMPT_NODE_T *node)
+{
+    OPERATE_RET rt = OPRT_OK;
+    char alert_id[32];
+
+    snprintf(alert_id, sizeof(alert_id), "prompt_%u", (unsigned int)node->cfg.id);
+    TUYA_CALL_ERR_RETURN(ai_audio_player_start(alert_id));
+
+    return ai_audio_player_data_write(alert_id, (uint8_t *)node->cfg.mp3, node->cfg.mp3_len, 1);
+}
+
+static void __prompt_play(PROMPT_NODE_T *node)
+{
+    OPERATE_RET rt = OPRT_OK;
+    const uint8_t *pcm = NULL;
+    TUYA_FILE file = NULL;
+    uint32_t pos = 0, len = 0;
+
+    ai_audio_player_stop();
+
+    if (PROMPT_SRC_NONE == node->src) {
+        TUYA_CALL_ERR_LOG(__prompt_play_mp3(node));
+        return;
+    }
+
+    if (PROMPT_SRC_FILE == node->src) {
+        char path[PROMPT_PATH_LEN];
+        __prompt_path(node->cfg.id, false, path);
+        file = tal_fopen(path, "r");
+        if (NULL == file || OPRT_OK != tal_fseek(file, sizeof(PROMPT_FILE_HEAD_T), SEEK_SET)) {
+            PR_ERR("prompt %d file lost", node->cfg.id);
+            if (file) {
+                tal_fclose(file);
+            }
+            node->src = PROMPT_SRC_NONE;
+            node->build_pending = true;
+            TUYA_CALL_ERR_LOG(__prompt_play_mp3(node));
+            return;
+        }
+    } else {
+        pcm = (PROMPT_SRC_CONST == node->src) ? node->cfg.pcm : node->ram;
+    }
+
+    sg_prompt.abort = false;
+    sg_prompt.is_playing = true;
+
+    while (pos < node->pcm_len && false == sg_prompt.abort) {
+        len = GET_MIN_LEN(node->pcm_len - pos, PROMPT_CHUNK_LEN);
+        if (file) {
+            int rd = tal_fread(sg_prompt.chunk, len, file);
+            if (rd <= 0) {
+                break;
+            }
+            len = rd;
+            tdl_audio_play(sg_prompt.audio_hdl, sg_prompt.chunk, len);
+        } else {
+            // straight from flash or psram, no copy
+            tdl_audio_play(sg_prompt.audio_hdl, (uint8_t *)pcm + pos, len);
+        }
+        pos += len;
+    }
+
+    if (file) {
+        tal_fclose(file);
+    }
+    if (sg_prompt.abort) {
+        tdl_audio_play_stop(sg_prompt.audio_hdl);
+    }
+
+    sg_prompt.is_playing = false;
+}
+
+static void __prompt_task(void *arg)
+{
+    PROMPT_MSG_T msg;
+
+    for (;;) {
+        PROMPT_NODE_T *node = __prompt_build_next();
+
+        // decode in the background only while nothing else is asked for
+        if (OPRT_OK != tal_queue_fetch(sg_prompt.queue, &msg, node ? 0 : PROMPT_QUEUE_WAIT_FOREVER)) {
+            if (node) {
+                __prompt_build(node);
+                node->build_pending = false;
+            }
+            continue;
+        }
+
+        if (PROMPT_MSG_PLAY != msg.type || msg.seq != sg_prompt.seq) {
+            continue;
+        }
+
+        tal_mutex_lock(sg_prompt.mutex);
+        node = __prompt_find(msg.id);
+        tal_mutex_unlock(sg_prompt.mutex);
+        if (NULL == node) {
+            PR_ERR("prompt %d not registered", msg.id);
+            continue;
+        }
+        __prompt_play(node);
+    }
+}
+
+/**
+ * @brief Initializes the prompt cache and its playback task.
+ * @param None
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_audio_prompt_init(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    BOOL_T is_exist = FALSE;
+
+    if (sg_prompt.is_init) {
+        return OPRT_OK;
+    }
+
+    memset(&sg_prompt, 0, sizeof(AI_AUDIO_PROMPT_MGR_T));
+
+    TUYA_CALL_ERR_GOTO(tdl_audio_find(AUDIO_CODEC_NAME, &sg_prompt.audio_hdl), __ERR);
+    TUYA_CALL_ERR_GOTO(tal_mutex_create_init(&sg_prompt.mutex), __ERR);
+    TUYA_CALL_ERR_GOTO(tal_queue_create_init(&sg_prompt.queue, sizeof(PROMPT_MSG_T), 8), __ERR);
+
+    sg_prompt.chunk = tkl_system_psram_malloc(PROMPT_CHUNK_LEN);
+    TUYA_CHECK_NULL_GOTO(sg_prompt.chunk, __ERR);
+
+    // no file system only means every prompt but the preloaded ones keeps using the decoder
+    tal_fs_is_exist(AI_AUDIO_PROMPT_DIR, &is_exist);
+    if (FALSE == is_exist && 0 != tal_fs_mkdir(AI_AUDIO_PROMPT_DIR)) {
+        PR_WARN("prompt dir %s not available", AI_AUDIO_PROMPT_DIR);
+    }
+
+    THREAD_CFG_T thrd_cfg = {1024 * 4, THREAD_PRIO_1, "ai_prompt"};
+    TUYA_CALL_ERR_GOTO(
+        tal_thread_create_static(&sg_prompt.thrd_hdl, &sg_prompt_thrd, NULL, NULL, __prompt_task, NULL, &thrd_cfg),
+        __ERR);
+
+    sg_prompt.is_init = true;
+
+    return OPRT_OK;
+
+__ERR:
+    if (sg_prompt.queue) {
+        tal_queue_free(sg_prompt.queue);
+        sg_prompt.queue = NULL;
+    }
+    if (sg_prompt.mutex) {
+        tal_mutex_release(sg_prompt.mutex);
+        sg_prompt.mutex = NULL;
+    }
+    if (sg_prompt.chunk) {
+        tkl_system_psram_free(sg_prompt.chunk);
+        sg_prompt.chunk = NULL;
+    }
+
+    return (OPRT_OK == rt) ? OPRT_MALLOC_FAILED : rt;
+}
+
+/**
+ * @brief Registers a prompt, decoding into the cache happens in the background.
+ * @param prompt The prompt, the source buffers must stay valid.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_audio_prompt_register(const AI_AUDIO_PROMPT_T *prompt)
+{
+    PROMPT_MSG_T msg = {.type = PROMPT_MSG_BUILD};
+
+    TUYA_CHECK_NULL_RETURN(prompt, OPRT_INVALID_PARM);
+    if ((NULL == prompt->mp3 || 0 == prompt->mp3_len) && NULL == prompt->pcm) {
+        return OPRT_INVALID_PARM;
+    }
+    if (false == sg_prompt.is_init) {
+        return OPRT_COM_ERROR;
+    }
+
+    tal_mutex_lock(sg_prompt.mutex);
+    if (__prompt_find(prompt->id)) {
+        tal_mutex_unlock(sg_prompt.mutex);
+        return OPRT_OK;
+    }
+    if (sg_prompt.num >= AI_AUDIO_PROMPT_MAX) {
+        tal_mutex_unlock(sg_prompt.mutex);
+        PR_ERR("prompt num over %d", AI_AUDIO_PROMPT_MAX);
+        return OPRT_EXCEED_UPPER_LIMIT;
+    }
+
+    PROMPT_NODE_T *node = &sg_prompt.node[sg_prompt.num];
+    memset(node, 0, sizeof(PROMPT_NODE_T));
+    memcpy(&node->cfg, prompt, sizeof(AI_AUDIO_PROMPT_T));
+    node->build_pending = true;
+    sg_prompt.num++;
+    tal_mutex_unlock(sg_prompt.mutex);
+
+    // wake the task up so it starts decoding
+    return tal_queue_post(sg_prompt.queue, &msg, 0);
+}
+
+/**
+ * @brief Plays a registered prompt, the ai audio player is stopped first.
+ * @param id The prompt id.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_audio_prompt_play(uint32_t id)
+{
+    PROMPT_MSG_T msg = {.type = PROMPT_MSG_PLAY, .id = id};
+
+    if (false == sg_prompt.is_init) {
+        return OPRT_COM_ERROR;
+    }
+
+    // a new prompt replaces the one being played
+    msg.seq = ++sg_prompt.seq;
+    sg_prompt.abort = true;
+
+    return tal_queue_post(sg_prompt.queue, &msg, 0);
+}
+
+/**
+ * @brief Stops the prompt being played.
+ * @param None
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_audio_prompt_stop(void)
+{
+    uint32_t wait_cnt = 0;
+
+    if (false == sg_prompt.is_init) {
+        return OPRT_OK;
+    }
+
+    // also cancels prompts still waiting in the queue
+    sg_prompt.seq++;
+    sg_prompt.abort = true;
+    while (sg_prompt.is_playing && wait_cnt++ < 200) {
+        tal_system_sleep(5);
+    }
+
+    return sg_prompt.is_playing ? OPRT_TIMEOUT : OPRT_OK;
+}
+
+/**
+ * @brief Checks whether a prompt is being played.
+ * @param None
+ * @return true if a prompt is playing.
+ */
+bool ai_audio_prompt_is_playing(void)
+{
+    return sg_prompt.is_playing;
+}
+
+/**
+ * @brief Checks whether a prompt can be played without decoding.
+ * @param id The prompt id.
+ * @return true if the pcm is available.
+ */
+bool ai_audio_prompt_is_cached(uint32_t id)
+{
+    bool is_cached = false;
+
+    if (false == sg_prompt.is_init) {
+        return false;
+    }
+
+    tal_mutex_lock(sg_prompt.mutex);
+    PROMPT_NODE_T *node = __prompt_find(id);
+    is_cached = (node && PROMPT_SRC_NONE != node->src);
+    tal_mutex_unlock(sg_prompt.mutex);
+
+    return is_cached;
+}
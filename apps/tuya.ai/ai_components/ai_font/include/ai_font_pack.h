@@ -0,0 +1,86 @@
+/**
+ * @file ai_font_pack.h
+ * @brief Fonts stored in a dedicated flash partition, rendered through a RAM glyph cache.
+ *
+ * The pack is built on the host with tools/font_pack.py from the lv_font_conv
+ * C files and flashed into its own partition, so the firmware no longer carries
+ * the glyph arrays. Each font in the pack is exposed as an lv_font_t. Glyphs are
+ * read and decompressed on first use and kept in an LRU cache, text that is
+ * streamed in repeatedly uses the same CJK glyphs and is served from RAM.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __AI_FONT_PACK_H__
+#define __AI_FONT_PACK_H__
+
+#include "tuya_cloud_types.h"
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+// partition holding the pack
+#ifndef AI_FONT_PACK_FLASH_TYPE
+#define AI_FONT_PACK_FLASH_TYPE TUYA_FLASH_TYPE_USER1
+#endif
+
+// fonts taken from one pack, extra fonts are ignored
+#ifndef AI_FONT_PACK_FONT_MAX
+#define AI_FONT_PACK_FONT_MAX 8
+#endif
+
+// ram for cached glyphs, shared by all fonts of the pack
+#ifndef AI_FONT_PACK_CACHE_SIZE
+#define AI_FONT_PACK_CACHE_SIZE (96 * 1024)
+#endif
+
+#define AI_FONT_PACK_NAME_LEN 24
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    uint32_t hit;
+    uint32_t miss;
+    uint32_t flash_bytes; // bytes read from flash on misses
+    uint16_t slot_num;
+    uint16_t slot_size;
+} AI_FONT_PACK_STATS_T;
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+/**
+ * @brief Loads the pack index from flash and sets up the glyph cache.
+ * @param None
+ * @return OPERATE_RET - OPRT_OK on success, OPRT_NOT_FOUND if no pack is flashed.
+ */
+OPERATE_RET ai_font_pack_init(void);
+
+/**
+ * @brief Gets a font of the pack.
+ * @param name The font name, the lv_font_t symbol the pack was built from,
+ *             e.g. "font_puhui_18_2".
+ * @return The font, or NULL if the pack does not contain it.
+ */
+const lv_font_t *ai_font_pack_get(const char *name);
+
+/**
+ * @brief Gets the counters of the glyph cache.
+ * @param stats Filled with the counters.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_font_pack_get_stats(AI_FONT_PACK_STATS_T *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AI_FONT_PACK_H__ */
@@ -0,0 +1,669 @@
+/**
+ * @file ai_font_pack.c
+ * @brief Fonts stored in a dedicated flash partition, rendered through a RAM glyph cache.
+ *
+ * Pack layout, little endian:
+ *   FONT_PACK_HEAD_T
+ *   FONT_PACK_FONT_T x font_num
+ *   per font: uint32_t unicode[glyph_num] (sorted), FONT_PACK_GLYPH_T[glyph_num],
+ *             then the glyph bitmaps
+ *
+ * Bitmaps use the lv_font_conv plain format (bpp packed, no row padding) and are
+ * optionally run length coded. The unicode tables stay in RAM, a glyph costs one
+ * binary search there plus two flash reads on a cache miss. Cache slots have the
+ * size of the largest glyph of the pack and keep the glyph metrics too, so both
+ * the layout (get_glyph_dsc) and the drawing of a cached glyph skip the flash.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#include <string.h>
+
+#include "tkl_memory.h"
+#include "tkl_flash.h"
+
+#include "tal_api.h"
+#include "tal_boot_mark.h"
+
+#include "ai_font_pack.h"
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define FONT_PACK_MAGIC   0x544E4641 // "AFNT"
+#define FONT_PACK_VERSION 1
+
+#define FONT_PACK_FLAG_RLE 0x01    // glyphs may be run length coded
+#define FONT_GLYPH_LEN_RLE 0x8000  // in bitmap_len, this glyph is coded
+
+#define FONT_CACHE_NONE      0xFFFF
+#define FONT_CACHE_SLOT_MIN  8
+#define FONT_CACHE_KEY(font_idx, unicode) (((uint32_t)(font_idx) << 24) | ((unicode) & 0xFFFFFF))
+
+#if defined(ENABLE_EXT_RAM) && (ENABLE_EXT_RAM == 1)
+#define FONT_PACK_MALLOC tkl_system_psram_malloc
+#define FONT_PACK_FREE   tkl_system_psram_free
+#else
+#define FONT_PACK_MALLOC tal_malloc
+#define FONT_PACK_FREE   tal_free
+#endif
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t font_num;
+    uint32_t total_len;
+    uint32_t reserved;
+} FONT_PACK_HEAD_T;
+
+typedef struct {
+    char name[AI_FONT_PACK_NAME_LEN];
+    uint32_t index_offset;  // from the pack start, unicode table then glyph table
+    uint32_t bitmap_offset; // from the pack start
+    uint32_t glyph_num;
+    int16_t line_height;
+    int16_t base_line;
+    int8_t underline_position;
+    uint8_t underline_thickness;
+    uint8_t bpp;
+    uint8_t flags;
+    uint16_t max_bitmap; // largest decoded glyph bitmap
+    uint16_t reserved;
+} FONT_PACK_FONT_T;
+
+typedef struct {
+    uint32_t bitmap_offset; // from bitmap_offset of the font
+    uint16_t bitmap_len;    // stored length, FONT_GLYPH_LEN_RLE if coded
+    uint16_t adv_w;         // in 1/16 px
+    uint8_t box_w;
+    uint8_t box_h;
+    int8_t ofs_x;
+    int8_t ofs_y;
+} FONT_PACK_GLYPH_T;
+
+typedef struct {
+    lv_font_t font;
+    FONT_PACK_FONT_T info;
+    uint32_t *unicode;
+    uint8_t idx;
+} FONT_PACK_NODE_T;
+
+typedef struct {
+    uint32_t key;
+    uint16_t prev;  // towards the most recently used
+    uint16_t next;  // towards the least recently used
+    uint16_t hnext; // hash chain
+    uint16_t adv_w;
+    uint8_t box_w;
+    uint8_t box_h;
+    int8_t ofs_x;
+    int8_t ofs_y;
+    bool valid;
+} FONT_CACHE_SLOT_T;
+
+typedef struct {
+    bool is_init;
+    uint32_t base;
+    MUTEX_HANDLE mutex;
+
+    uint8_t font_num;
+    FONT_PACK_NODE_T font[AI_FONT_PACK_FONT_MAX];
+
+    FONT_CACHE_SLOT_T *slot;
+    uint8_t *slot_data;
+    uint16_t *bucket;
+    uint16_t bucket_mask;
+    uint16_t head;
+    uint16_t tail;
+    uint8_t *read_buf;
+    uint32_t read_buf_len;
+
+    AI_FONT_PACK_STATS_T stats;
+} FONT_PACK_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static FONT_PACK_T sg_font_pack = {0};
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static uint32_t __glyph_bitmap_size(const FONT_CACHE_SLOT_T *slot, uint8_t bpp)
+{
+    return ((uint32_t)slot->box_w * slot->box_h * bpp + 7) / 8;
+}
+
+static uint16_t __cache_hash(uint32_t key)
+{
+    return (uint16_t)((key * 2654435761u) >> 16) & sg_font_pack.bucket_mask;
+}
+
+static void __cache_lru_unlink(uint16_t id)
+{
+    FONT_CACHE_SLOT_T *slot = &sg_font_pack.slot[id];
+
+    if (slot->prev != FONT_CACHE_NONE) {
+        sg_font_pack.slot[slot->prev].next = slot->next;
+    } else {
+        sg_font_pack.head = slot->next;
+    }
+
+    if (slot->next != FONT_CACHE_NONE) {
+        sg_font_pack.slot[slot->next].prev = slot->prev;
+    } else {
+        sg_font_pack.tail = slot->prev;
+    }
+}
+
+static void __cache_lru_push_front(uint16_t id)
+{
+    FONT_CACHE_SLOT_T *slot = &sg_font_pack.slot[id];
+
+    slot->prev = FONT_CACHE_NONE;
+    slot->next = sg_font_pack.head;
+    if (sg_font_pack.head != FONT_CACHE_NONE) {
+        sg_font_pack.slot[sg_font_pack.head].prev = id;
+    }
+    sg_font_pack.head = id;
+    if (sg_font_pack.tail == FONT_CACHE_NONE) {
+        sg_font_pack.tail = id;
+    }
+}
+
+static void __cache_hash_remove(uint16_t id)
+{
+    uint16_t *link = &sg_font_pack.bucket[__cache_hash(sg_font_pack.slot[id].key)];
+
+    while (*link != FONT_CACHE_NONE) {
+        if (*link == id) {
+            *link = sg_font_pack.slot[id].hnext;
+            return;
+        }
+        link = &sg_font_pack.slot[*link].hnext;
+    }
+}
+
+static uint16_t __cache_find(uint32_t key)
+{
+    uint16_t id = sg_font_pack.bucket[__cache_hash(key)];
+
+    while (id != FONT_CACHE_NONE) {
+        if (sg_font_pack.slot[id].key == key) {
+            return id;
+        }
+        id = sg_font_pack.slot[id].hnext;
+    }
+
+    return FONT_CACHE_NONE;
+}
+
+static int32_t __font_find_glyph(FONT_PACK_NODE_T *node, uint32_t unicode)
+{
+    int32_t low = 0, high = (int32_t)node->info.glyph_num - 1, mid = 0;
+
+    while (low <= high) {
+        mid = (low + high) / 2;
+        if (node->unicode[mid] == unicode) {
+            return mid;
+        } else if (node->unicode[mid] < unicode) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * control byte c < 0x80: c + 1 literal bytes follow
+ * control byte c >= 0x80: the next byte repeats c - 0x80 + 2 times
+ */
+static OPERATE_RET __rle_decode(const uint8_t *in, uint32_t in_len, uint8_t *out, uint32_t out_len)
+{
+    uint32_t i = 0, o = 0, n = 0;
+    uint8_t c = 0;
+
+    while (i < in_len && o < out_len) {
+        c = in[i++];
+        if (c < 0x80) {
+            n = c + 1;
+            if (i + n > in_len || o + n > out_len) {
+                return OPRT_COM_ERROR;
+            }
+            memcpy(&out[o], &in[i], n);
+            i += n;
+        } else {
+            n = c - 0x80 + 2;
+            if (i >= in_len || o + n > out_len) {
+                return OPRT_COM_ERROR;
+            }
+            memset(&out[o], in[i++], n);
+        }
+        o += n;
+    }
+
+    return (o == out_len) ? OPRT_OK : OPRT_COM_ERROR;
+}
+
+static OPERATE_RET __cache_load(FONT_PACK_NODE_T *node, int32_t glyph_idx, uint16_t id)
+{
+    OPERATE_RET rt = OPRT_OK;
+    FONT_PACK_GLYPH_T glyph;
+    FONT_CACHE_SLOT_T *slot = &sg_font_pack.slot[id];
+    uint8_t *data = &sg_font_pack.slot_data[(uint32_t)id * sg_font_pack.stats.slot_size];
+    uint32_t addr = 0, size = 0, len = 0;
+    bool is_rle = false;
+
+    addr = sg_font_pack.base + node->info.index_offset + node->info.glyph_num * sizeof(uint32_t) +
+           glyph_idx * sizeof(FONT_PACK_GLYPH_T);
+    TUYA_CALL_ERR_RETURN(tkl_flash_read(addr, (uint8_t *)&glyph, sizeof(FONT_PACK_GLYPH_T)));
+
+    slot->adv_w = glyph.adv_w;
+    slot->box_w = glyph.box_w;
+    slot->box_h = glyph.box_h;
+    slot->ofs_x = glyph.ofs_x;
+    slot->ofs_y = glyph.ofs_y;
+
+    is_rle = (node->info.flags & FONT_PACK_FLAG_RLE) && (glyph.bitmap_len & FONT_GLYPH_LEN_RLE);
+    len = glyph.bitmap_len & ~FONT_GLYPH_LEN_RLE;
+
+    size = __glyph_bitmap_size(slot, node->info.bpp);
+    if (size > sg_font_pack.stats.slot_size || len > sg_font_pack.read_buf_len) {
+        PR_ERR("font pack glyph too large: %d", len);
+        return OPRT_EXCEED_UPPER_LIMIT;
+    }
+
+    if (0 == len) {
+        return OPRT_OK;
+    }
+
+    addr = sg_font_pack.base + node->info.bitmap_offset + glyph.bitmap_offset;
+    if (is_rle) {
+        TUYA_CALL_ERR_RETURN(tkl_flash_read(addr, sg_font_pack.read_buf, len));
+        TUYA_CALL_ERR_RETURN(__rle_decode(sg_font_pack.read_buf, len, data, size));
+    } else {
+        TUYA_CALL_ERR_RETURN(tkl_flash_read(addr, data, MIN(len, size)));
+    }
+    sg_font_pack.stats.flash_bytes += sizeof(FONT_PACK_GLYPH_T) + len;
+
+    return OPRT_OK;
+}
+
+// returns the slot holding the glyph, loads it into the least recently used slot on a miss
+static FONT_CACHE_SLOT_T *__cache_get(FONT_PACK_NODE_T *node, uint32_t unicode, uint8_t **data)
+{
+    uint32_t key = FONT_CACHE_KEY(node->idx, unicode);
+    uint16_t id = FONT_CACHE_NONE, hash = 0;
+    int32_t glyph_idx = 0;
+
+    id = __cache_find(key);
+    if (id != FONT_CACHE_NONE) {
+        sg_font_pack.stats.hit++;
+    } else {
+        glyph_idx = __font_find_glyph(node, unicode);
+        if (glyph_idx < 0) {
+            return NULL;
+        }
+
+        sg_font_pack.stats.miss++;
+
+        id = sg_font_pack.tail;
+        if (sg_font_pack.slot[id].valid) {
+            __cache_hash_remove(id);
+            sg_font_pack.slot[id].valid = false;
+        }
+
+        if (OPRT_OK != __cache_load(node, glyph_idx, id)) {
+            return NULL;
+        }
+
+        sg_font_pack.slot[id].key = key;
+        sg_font_pack.slot[id].valid = true;
+        hash = __cache_hash(key);
+        sg_font_pack.slot[id].hnext = sg_font_pack.bucket[hash];
+        sg_font_pack.bucket[hash] = id;
+    }
+
+    if (sg_font_pack.head != id) {
+        __cache_lru_unlink(id);
+        __cache_lru_push_front(id);
+    }
+
+    if (data) {
+        *data = &sg_font_pack.slot_data[(uint32_t)id * sg_font_pack.stats.slot_size];
+    }
+
+    return &sg_font_pack.slot[id];
+}
+
+static bool __font_get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc_out, uint32_t letter,
+                                 uint32_t letter_next)
+{
+    FONT_PACK_NODE_T *node = (FONT_PACK_NODE_T *)font->dsc;
+    FONT_CACHE_SLOT_T *slot = NULL;
+    bool is_tab = false;
+
+    (void)letter_next;
+
+    if (letter == '\t') {
+        letter = ' ';
+        is_tab = true;
+    }
+
+    tal_mutex_lock(sg_font_pack.mutex);
+
+    slot = __cache_get(node, letter, NULL);
+    if (NULL == slot) {
+        tal_mutex_unlock(sg_font_pack.mutex);
+        return false;
+    }
+
+    dsc_out->adv_w = (slot->adv_w * (is_tab ? 2 : 1) + (1 << 3)) >> 4;
+    dsc_out->box_w = slot->box_w * (is_tab ? 2 : 1);
+    dsc_out->box_h = slot->box_h;
+    dsc_out->ofs_x = slot->ofs_x;
+    dsc_out->ofs_y = slot->ofs_y;
+#if LVGL_VERSION_MAJOR >= 9
+    dsc_out->format = node->info.bpp;
+#else
+    dsc_out->bpp = node->info.bpp;
+#endif
+    dsc_out->is_placeholder = false;
+
+    tal_mutex_unlock(sg_font_pack.mutex);
+
+    return true;
+}
+
+#if LVGL_VERSION_MAJOR >= 9
+// the draw buffer is A8, expand the packed bitmap into it
+static void __font_expand_a8(const uint8_t *in, uint8_t bpp, const FONT_CACHE_SLOT_T *slot, uint8_t *out,
+                             uint32_t stride)
+{
+    uint32_t bit = 0, x = 0, y = 0;
+    uint8_t mask = (1 << bpp) - 1, value = 0;
+
+    if (bpp == 8) {
+        for (y = 0; y < slot->box_h; y++) {
+            memcpy(out, &in[y * slot->box_w], slot->box_w);
+            out += stride;
+        }
+        return;
+    }
+
+    for (y = 0; y < slot->box_h; y++) {
+        for (x = 0; x < slot->box_w; x++, bit += bpp) {
+            value = (in[bit >> 3] >> (8 - bpp - (bit & 0x7))) & mask;
+            out[x] = (uint8_t)((value * 255) / mask);
+        }
+        out += stride;
+    }
+}
+
+static const void *__font_get_glyph_bitmap(lv_font_glyph_dsc_t *g_dsc, uint32_t letter, lv_draw_buf_t *draw_buf)
+{
+    const lv_font_t *font = g_dsc->resolved_font;
+    FONT_PACK_NODE_T *node = (FONT_PACK_NODE_T *)font->dsc;
+    FONT_CACHE_SLOT_T *slot = NULL;
+    uint8_t *data = NULL;
+
+    if (NULL == draw_buf) {
+        return NULL;
+    }
+
+    if (letter == '\t') {
+        letter = ' ';
+    }
+
+    tal_mutex_lock(sg_font_pack.mutex);
+
+    slot = __cache_get(node, letter, &data);
+    if (NULL == slot || 0 == slot->box_w * slot->box_h) {
+        tal_mutex_unlock(sg_font_pack.mutex);
+        return NULL;
+    }
+
+    __font_expand_a8(data, node->info.bpp, slot, draw_buf->data, draw_buf->header.stride);
+
+    tal_mutex_unlock(sg_font_pack.mutex);
+
+    return draw_buf->data;
+}
+#else
+// lvgl 8 draws the packed bitmap directly, it is used before the next glyph is fetched
+static const uint8_t *__font_get_glyph_bitmap(const lv_font_t *font, uint32_t letter)
+{
+    FONT_PACK_NODE_T *node = (FONT_PACK_NODE_T *)font->dsc;
+    FONT_CACHE_SLOT_T *slot = NULL;
+    uint8_t *data = NULL;
+
+    if (letter == '\t') {
+        letter = ' ';
+    }
+
+    tal_mutex_lock(sg_font_pack.mutex);
+    slot = __cache_get(node, letter, &data);
+    tal_mutex_unlock(sg_font_pack.mutex);
+
+    return slot ? data : NULL;
+}
+#endif
+
+static OPERATE_RET __font_pack_load_font(uint8_t idx)
+{
+    OPERATE_RET rt = OPRT_OK;
+    FONT_PACK_NODE_T *node = &sg_font_pack.font[idx];
+    uint32_t addr = sg_font_pack.base + sizeof(FONT_PACK_HEAD_T) + idx * sizeof(FONT_PACK_FONT_T);
+
+    TUYA_CALL_ERR_RETURN(tkl_flash_read(addr, (uint8_t *)&node->info, sizeof(FONT_PACK_FONT_T)));
+    node->info.name[AI_FONT_PACK_NAME_LEN - 1] = '\0';
+
+    if (node->info.bpp != 1 && node->info.bpp != 2 && node->info.bpp != 4 && node->info.bpp != 8) {
+        PR_ERR("font %s bpp %d not supported", node->info.name, node->info.bpp);
+        return OPRT_NOT_SUPPORTED;
+    }
+
+    node->unicode = FONT_PACK_MALLOC(node->info.glyph_num * sizeof(uint32_t));
+    TUYA_CHECK_NULL_RETURN(node->unicode, OPRT_MALLOC_FAILED);
+
+    TUYA_CALL_ERR_RETURN(tkl_flash_read(sg_font_pack.base + node->info.index_offset, (uint8_t *)node->unicode,
+                                        node->info.glyph_num * sizeof(uint32_t)));
+
+    node->idx = idx;
+
+    node->font.get_glyph_dsc = __font_get_glyph_dsc;
+    node->font.get_glyph_bitmap = __font_get_glyph_bitmap;
+    node->font.line_height = node->info.line_height;
+    node->font.base_line = node->info.base_line;
+    node->font.subpx = LV_FONT_SUBPX_NONE;
+    node->font.underline_position = node->info.underline_position;
+    node->font.underline_thickness = node->info.underline_thickness;
+    node->font.dsc = node;
+    node->font.fallback = NULL;
+
+    PR_DEBUG("font pack: %s, %d glyphs", node->info.name, node->info.glyph_num);
+
+    return OPRT_OK;
+}
+
+static OPERATE_RET __font_pack_cache_init(void)
+{
+    uint32_t slot_size = 0, slot_num = 0, bucket_num = 1, i = 0;
+
+    for (i = 0; i < sg_font_pack.font_num; i++) {
+        slot_size = MAX(slot_size, sg_font_pack.font[i].info.max_bitmap);
+    }
+    slot_size = (slot_size + 3) & ~0x3;
+    if (0 == slot_size) {
+        slot_size = 4;
+    }
+
+    slot_num = MIN(AI_FONT_PACK_CACHE_SIZE / slot_size, FONT_CACHE_NONE - 1);
+    slot_num = MAX(slot_num, FONT_CACHE_SLOT_MIN);
+    while (bucket_num < slot_num) {
+        bucket_num <<= 1;
+    }
+
+    // only glyphs that got smaller are coded
+    sg_font_pack.read_buf_len = slot_size;
+
+    sg_font_pack.slot = FONT_PACK_MALLOC(slot_num * sizeof(FONT_CACHE_SLOT_T));
+    sg_font_pack.slot_data = FONT_PACK_MALLOC(slot_num * slot_size);
+    sg_font_pack.bucket = FONT_PACK_MALLOC(bucket_num * sizeof(uint16_t));
+    sg_font_pack.read_buf = FONT_PACK_MALLOC(sg_font_pack.read_buf_len);
+    if (NULL == sg_font_pack.slot || NULL == sg_font_pack.slot_data || NULL == sg_font_pack.bucket ||
+        NULL == sg_font_pack.read_buf) {
+        return OPRT_MALLOC_FAILED;
+    }
+
+    memset(sg_font_pack.slot, 0, slot_num * sizeof(FONT_CACHE_SLOT_T));
+    memset(sg_font_pack.bucket, 0xFF, bucket_num * sizeof(uint16_t));
+    sg_font_pack.bucket_mask = bucket_num - 1;
+
+    // chain all slots, first use takes them from the tail
+    sg_font_pack.head = FONT_CACHE_NONE;
+    sg_font_pack.tail = FONT_CACHE_NONE;
+    for (i = 0; i < slot_num; i++) {
+        sg_font_pack.slot[i].hnext = FONT_CACHE_NONE;
+        __cache_lru_push_front(i);
+    }
+
+    sg_font_pack.stats.slot_num = slot_num;
+    sg_font_pack.stats.slot_size = slot_size;
+
+    PR_DEBUG("font pack cache: %d slots of %d bytes", slot_num, slot_size);
+
+    return OPRT_OK;
+}
+
+static void __font_pack_deinit(void)
+{
+    uint8_t i = 0;
+
+    for (i = 0; i < AI_FONT_PACK_FONT_MAX; i++) {
+        if (sg_font_pack.font[i].unicode) {
+            FONT_PACK_FREE(sg_font_pack.font[i].unicode);
+        }
+    }
+
+    if (sg_font_pack.slot) {
+        FONT_PACK_FREE(sg_font_pack.slot);
+    }
+    if (sg_font_pack.slot_data) {
+        FONT_PACK_FREE(sg_font_pack.slot_data);
+    }
+    if (sg_font_pack.bucket) {
+        FONT_PACK_FREE(sg_font_pack.bucket);
+    }
+    if (sg_font_pack.read_buf) {
+        FONT_PACK_FREE(sg_font_pack.read_buf);
+    }
+    if (sg_font_pack.mutex) {
+        tal_mutex_release(sg_font_pack.mutex);
+    }
+
+    memset(&sg_font_pack, 0, sizeof(FONT_PACK_T));
+}
+
+/**
+ * @brief Loads the pack index from flash and sets up the glyph cache.
+ * @param None
+ * @return OPERATE_RET - OPRT_OK on success, OPRT_NOT_FOUND if no pack is flashed.
+ */
+OPERATE_RET ai_font_pack_init(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    TUYA_FLASH_BASE_INFO_T flash_info;
+    FONT_PACK_HEAD_T head;
+    uint8_t i = 0;
+
+    if (sg_font_pack.is_init) {
+        return OPRT_OK;
+    }
+
+    memset(&flash_info, 0, sizeof(TUYA_FLASH_BASE_INFO_T));
+    TUYA_CALL_ERR_RETURN(tkl_flash_get_one_type_info(AI_FONT_PACK_FLASH_TYPE, &flash_info));
+    if (0 == flash_info.partition_num) {
+        return OPRT_NOT_FOUND;
+    }
+
+    sg_font_pack.base = flash_info.partition[0].start_addr;
+
+    TUYA_CALL_ERR_RETURN(tkl_flash_read(sg_font_pack.base, (uint8_t *)&head, sizeof(FONT_PACK_HEAD_T)));
+    if (head.magic != FONT_PACK_MAGIC || head.version != FONT_PACK_VERSION ||
+        head.total_len > flash_info.partition[0].size) {
+        PR_NOTICE("no font pack in flash");
+        return OPRT_NOT_FOUND;
+    }
+
+    TUYA_CALL_ERR_GOTO(tal_mutex_create_init(&sg_font_pack.mutex), __ERR);
+
+    sg_font_pack.font_num = MIN(head.font_num, AI_FONT_PACK_FONT_MAX);
+    for (i = 0; i < sg_font_pack.font_num; i++) {
+        TUYA_CALL_ERR_GOTO(__font_pack_load_font(i), __ERR);
+    }
+
+    TUYA_CALL_ERR_GOTO(__font_pack_cache_init(), __ERR);
+
+    sg_font_pack.is_init = true;
+    tal_boot_mark("font pack loaded");
+
+    PR_NOTICE("font pack loaded: %d fonts, %d bytes", sg_font_pack.font_num, head.total_len);
+
+    return OPRT_OK;
+
+__ERR:
+    __font_pack_deinit();
+
+    return rt;
+}
+
+/**
+ * @brief Gets a font of the pack.
+ * @param name The font name, the lv_font_t symbol the pack was built from,
+ *             e.g. "font_puhui_18_2".
+ * @return The font, or NULL if the pack does not contain it.
+ */
+const lv_font_t *ai_font_pack_get(const char *name)
+{
+    uint8_t i = 0;
+
+    if (!sg_font_pack.is_init || NULL == name) {
+        return NULL;
+    }
+
+    for (i = 0; i < sg_font_pack.font_num; i++) {
+        if (0 == strcmp(sg_font_pack.font[i].info.name, name)) {
+            return &sg_font_pack.font[i].font;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Gets the counters of the glyph cache.
+ * @param stats Filled with the counters.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_font_pack_get_stats(AI_FONT_PACK_STATS_T *stats)
+{
+    if (NULL == stats) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (!sg_font_pack.is_init) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    tal_mutex_lock(sg_font_pack.mutex);
+    memcpy(stats, &sg_font_pack.stats, sizeof(AI_FONT_PACK_STATS_T));
+    tal_mutex_unlock(sg_font_pack.mutex);
+
+    return OPRT_OK;
+}
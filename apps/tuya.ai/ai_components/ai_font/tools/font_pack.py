@@ -0,0 +1,211 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Build a font pack for ai_font_pack from lv_font_conv C files.
+
+The fonts must be converted with --no-compress (plain bitmaps). Each font is
+named after its lv_font_t symbol, e.g. font_puhui_18_2.
+
+usage: font_pack.py -o font_pack.bin font_puhui_18_2.c font_puhui_14_1.c
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+PACK_MAGIC = 0x544E4641  # "AFNT"
+PACK_VERSION = 1
+PACK_FLAG_RLE = 0x01
+GLYPH_LEN_RLE = 0x8000
+NAME_LEN = 24
+
+HEAD_FMT = "<IHHII"
+FONT_FMT = "<%dsIIIhhbBBBHH" % NAME_LEN
+GLYPH_FMT = "<IHHBBbb"
+
+
+def _array_body(src, decl):
+    m = re.search(decl + r"\s*\[\]\s*=\s*\{(.*?)\};", src, re.S)
+    if m is None:
+        return None
+    # drop comments, the bitmap array has one per glyph
+    return re.sub(r"/\*.*?\*/", "", m.group(1), flags=re.S)
+
+
+def _int_list(body):
+    return [int(v, 0) for v in re.findall(r"-?0x[0-9a-fA-F]+|-?\d+", body)]
+
+
+def _field(src, name):
+    m = re.search(r"\." + name + r"\s*=\s*(-?\d+)", src)
+    if m is None:
+        raise ValueError("field %s not found" % name)
+    return int(m.group(1))
+
+
+def parse_font(path):
+    with open(path, "r", encoding="utf-8", errors="ignore") as f:
+        src = f.read()
+
+    m = re.search(r"^\s*(?:const\s+)?lv_font_t\s+(\w+)\s*=", src, re.M)
+    if m is None:
+        raise ValueError("%s: no lv_font_t found" % path)
+    name = m.group(1)
+
+    if _field(src, "bitmap_format") != 0:
+        raise ValueError("%s: compressed font, convert it with --no-compress" % path)
+
+    bitmap = bytes(_int_list(_array_body(src, r"glyph_bitmap")))
+
+    glyph_dsc = []
+    body = _array_body(src, r"lv_font_fmt_txt_glyph_dsc_t\s+glyph_dsc")
+    for g in re.finditer(r"\{([^{}]*)\}", body):
+        fields = dict(re.findall(r"\.(\w+)\s*=\s*(-?\d+)", g.group(1)))
+        glyph_dsc.append({k: int(v) for k, v in fields.items()})
+
+    lists = {}
+    for lm in re.finditer(r"static const uint(?:8|16)_t (\w+)\[\]\s*=\s*\{(.*?)\};", src, re.S):
+        lists[lm.group(1)] = _int_list(lm.group(2))
+
+    # unicode -> glyph id
+    cmap = {}
+    body = _array_body(src, r"lv_font_fmt_txt_cmap_t\s+cmaps")
+    for c in re.finditer(r"\{([^{}]*)\}", body):
+        text = c.group(1)
+        start = int(re.search(r"\.range_start\s*=\s*(\d+)", text).group(1))
+        length = int(re.search(r"\.range_length\s*=\s*(\d+)", text).group(1))
+        gid_start = int(re.search(r"\.glyph_id_start\s*=\s*(\d+)", text).group(1))
+        ulist = re.search(r"\.unicode_list\s*=\s*(\w+)", text).group(1)
+        olist = re.search(r"\.glyph_id_ofs_list\s*=\s*(\w+)", text).group(1)
+        ctype = re.search(r"\.type\s*=\s*(\w+)", text).group(1)
+
+        if ctype.endswith("FORMAT0_TINY"):
+            for i in range(length):
+                cmap[start + i] = gid_start + i
+        elif ctype.endswith("FORMAT0_FULL"):
+            for i, ofs in enumerate(lists[olist][:length]):
+                cmap[start + i] = gid_start + ofs
+        elif ctype.endswith("SPARSE_TINY"):
+            for i, u in enumerate(lists[ulist]):
+                cmap[start + u] = gid_start + i
+        elif ctype.endswith("SPARSE_FULL"):
+            for u, ofs in zip(lists[ulist], lists[olist]):
+                cmap[start + u] = gid_start + ofs
+        else:
+            raise ValueError("%s: unknown cmap type %s" % (path, ctype))
+
+    return {
+        "name": name,
+        "bpp": _field(src, "bpp"),
+        "line_height": _field(src, "line_height"),
+        "base_line": _field(src, "base_line"),
+        "underline_position": _field(src, "underline_position"),
+        "underline_thickness": _field(src, "underline_thickness"),
+        "bitmap": bitmap,
+        "glyph_dsc": glyph_dsc,
+        "cmap": cmap,
+    }
+
+
+def rle_encode(data):
+    """Matches __rle_decode() in ai_font_pack.c."""
+    out = bytearray()
+    lit = bytearray()
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and data[i + run] == data[i] and run < 129:
+            run += 1
+        if run >= 3:
+            while lit:
+                out.append(min(len(lit), 128) - 1)
+                out += lit[:128]
+                lit = lit[128:]
+            out.append(0x80 + run - 2)
+            out.append(data[i])
+            i += run
+        else:
+            lit.append(data[i])
+            i += 1
+    while lit:
+        out.append(min(len(lit), 128) - 1)
+        out += lit[:128]
+        lit = lit[128:]
+    return bytes(out)
+
+
+def build_font(font, use_rle):
+    unicodes = sorted(font["cmap"].keys())
+    bpp = font["bpp"]
+    glyph_table = bytearray()
+    bitmaps = bytearray()
+    max_bitmap = 0
+    stored_at = {}
+
+    for u in unicodes:
+        gid = font["cmap"][u]
+        g = font["glyph_dsc"][gid]
+        size = (g["box_w"] * g["box_h"] * bpp + 7) // 8
+        raw = font["bitmap"][g["bitmap_index"]:g["bitmap_index"] + size]
+        max_bitmap = max(max_bitmap, size)
+        stored, stored_len = raw, len(raw)
+        if use_rle:
+            rle = rle_encode(raw)
+            # dense low bpp glyphs grow when coded, keep those plain
+            if len(rle) < len(raw):
+                stored, stored_len = rle, len(rle) | GLYPH_LEN_RLE
+        if len(stored) >= GLYPH_LEN_RLE or g["box_w"] > 0xFF or g["box_h"] > 0xFF:
+            raise ValueError("%s: glyph U+%04X too large" % (font["name"], u))
+        # code points sharing a glyph share its bitmap
+        if gid not in stored_at:
+            stored_at[gid] = len(bitmaps)
+            bitmaps += stored
+        glyph_table += struct.pack(GLYPH_FMT, stored_at[gid], stored_len, g["adv_w"],
+                                   g["box_w"], g["box_h"], g["ofs_x"], g["ofs_y"])
+
+    index = struct.pack("<%dI" % len(unicodes), *unicodes) + glyph_table
+    return unicodes, index, bytes(bitmaps), max_bitmap
+
+
+def main():
+    parser = argparse.ArgumentParser(description="build an ai_font_pack image")
+    parser.add_argument("fonts", nargs="+", help="lv_font_conv C files")
+    parser.add_argument("-o", "--output", required=True, help="pack file to write")
+    parser.add_argument("--no-rle", action="store_true", help="store bitmaps uncompressed")
+    args = parser.parse_args()
+
+    fonts = [parse_font(p) for p in args.fonts]
+
+    head_len = struct.calcsize(HEAD_FMT) + struct.calcsize(FONT_FMT) * len(fonts)
+    table = bytearray()
+    body = bytearray()
+    for font in fonts:
+        if len(font["name"]) >= NAME_LEN:
+            raise ValueError("font name %s too long" % font["name"])
+        unicodes, index, bitmaps, max_bitmap = build_font(font, not args.no_rle)
+        index_offset = head_len + len(body)
+        body += index
+        while len(body) % 4:
+            body.append(0)
+        bitmap_offset = head_len + len(body)
+        body += bitmaps
+        while len(body) % 4:
+            body.append(0)
+        table += struct.pack(FONT_FMT, font["name"].encode(), index_offset, bitmap_offset, len(unicodes),
+                             font["line_height"], font["base_line"], font["underline_position"],
+                             font["underline_thickness"], font["bpp"], 0 if args.no_rle else PACK_FLAG_RLE,
+                             max_bitmap, 0)
+        print("%s: %d glyphs, %d bitmap bytes (%d raw)" % (font["name"], len(unicodes), len(bitmaps),
+                                                          len(font["bitmap"])))
+
+    total = head_len + len(body)
+    head = struct.pack(HEAD_FMT, PACK_MAGIC, PACK_VERSION, len(fonts), total, 0)
+    with open(args.output, "wb") as f:
+        f.write(head + table + body)
+    print("%s: %d bytes" % (args.output, total))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,120 @@
+/**
+ * @file ai_msg_chan.h
+ * @brief Message channel between app threads and one consumer thread.
+ *
+ * Messages are records in one ring buffer. Small payloads are stored inline in
+ * the record, large ones in a PSRAM buffer the record owns, so posting a status
+ * or a text piece needs no allocation. The consumer reads a message in place
+ * and releases it after use. Types marked latest-only are superseded by a newer
+ * message of the same type, the consumer only gets the latest pending one.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __AI_MSG_CHAN_H__
+#define __AI_MSG_CHAN_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+// payloads up to this size are stored in the ring
+#ifndef AI_MSG_CHAN_INLINE_MAX
+#define AI_MSG_CHAN_INLINE_MAX 96
+#endif
+
+// only types below this can be latest-only
+#define AI_MSG_CHAN_TYPE_LATEST_MAX 32
+
+#define AI_MSG_CHAN_LATEST(type) (1UL << (type))
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef void *AI_MSG_CHAN_HANDLE;
+
+typedef struct {
+    uint32_t type;
+    uint32_t len;
+    char *data; // NUL terminated, NULL when len is 0
+
+    // used by the channel
+    uint32_t end;
+    char *owned;
+} AI_MSG_CHAN_MSG_T;
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+/**
+ * @brief Creates a channel.
+ * @param size Bytes of the ring, records take 16 bytes plus inline payloads.
+ * @param latest_only Types given with AI_MSG_CHAN_LATEST() whose older pending
+ *                    messages are dropped when a new one is posted.
+ * @param handle Returns the channel.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_msg_chan_create(uint32_t size, uint32_t latest_only, AI_MSG_CHAN_HANDLE *handle);
+
+/**
+ * @brief Posts a copy of the payload. It waits while the ring is full.
+ * @param handle The channel.
+ * @param type The message type.
+ * @param data The payload, may be NULL when len is 0.
+ * @param len Bytes of the payload.
+ * @param timeout Milliseconds to wait for space, 0xFFFFFFFF waits forever.
+ * @return OPERATE_RET - OPRT_OK on success, OPRT_TIMEOUT if the ring stayed full.
+ */
+OPERATE_RET ai_msg_chan_post(AI_MSG_CHAN_HANDLE handle, uint32_t type, const void *data, uint32_t len,
+                             uint32_t timeout);
+
+/**
+ * @brief Posts a payload without copying it, the channel takes the buffer.
+ * @param handle The channel.
+ * @param type The message type.
+ * @param buf Buffer from tkl_system_psram_malloc() holding len + 1 bytes, it
+ *            is freed by the channel, also when posting fails.
+ * @param len Bytes of the payload, the channel writes the terminator.
+ * @param timeout Milliseconds to wait for space, 0xFFFFFFFF waits forever.
+ * @return OPERATE_RET - OPRT_OK on success, OPRT_TIMEOUT if the ring stayed full.
+ */
+OPERATE_RET ai_msg_chan_post_take(AI_MSG_CHAN_HANDLE handle, uint32_t type, char *buf, uint32_t len,
+                                  uint32_t timeout);
+
+/**
+ * @brief Gets the next message. Messages are released in the order fetched.
+ * @param handle The channel.
+ * @param msg Filled with the message, its data stays valid until released.
+ * @param timeout Milliseconds to wait, 0xFFFFFFFF waits forever.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on timeout.
+ */
+OPERATE_RET ai_msg_chan_fetch(AI_MSG_CHAN_HANDLE handle, AI_MSG_CHAN_MSG_T *msg, uint32_t timeout);
+
+/**
+ * @brief Appends the payload of next to msg, only msg is released afterwards.
+ * @param handle The channel.
+ * @param msg A fetched message.
+ * @param next The message fetched after msg.
+ * @return OPERATE_RET - OPRT_OK on success, on failure both stay unchanged.
+ */
+OPERATE_RET ai_msg_chan_merge(AI_MSG_CHAN_HANDLE handle, AI_MSG_CHAN_MSG_T *msg, AI_MSG_CHAN_MSG_T *next);
+
+/**
+ * @brief Gives a fetched message back to the channel.
+ * @param handle The channel.
+ * @param msg The message.
+ * @return None
+ */
+void ai_msg_chan_release(AI_MSG_CHAN_HANDLE handle, AI_MSG_CHAN_MSG_T *msg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AI_MSG_CHAN_H__ */
@@ -0,0 +1,423 @@
+/**
+ * @file ai_msg_chan.c
+ * @brief Message channel between app threads and one consumer thread.
+ *
+ * The ring holds records back to back, each a MSG_CHAN_REC_T followed by the
+ * inline payload, padded to MSG_CHAN_ALIGN. A record that does not fit before
+ * the end of the ring goes to its start, a wrap marker is left behind when a
+ * header still fits there. The ring is never filled completely, so wr == tail
+ * means it is empty.
+ *
+ * Producers write at wr under the mutex. The consumer reads at rd, records
+ * between tail and rd are fetched but not released yet. A latest-only record
+ * keeps the generation of its type at posting, it is skipped when the type has
+ * moved on since.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#include <string.h>
+
+#include "tkl_memory.h"
+
+#include "tal_api.h"
+
+#include "ai_msg_chan.h"
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define MSG_CHAN_ALIGN       8
+#define MSG_CHAN_ALIGN_UP(x) (((x) + MSG_CHAN_ALIGN - 1) & ~(MSG_CHAN_ALIGN - 1))
+
+#define MSG_CHAN_TYPE_WRAP 0xFFFF
+#define MSG_CHAN_HDR_LEN   MSG_CHAN_ALIGN_UP(sizeof(MSG_CHAN_REC_T))
+
+#define MSG_CHAN_END_NONE 0xFFFFFFFF // message not backed by a record
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    uint16_t type;
+    uint16_t gen;
+    uint32_t len;
+    char *owned; // payload not stored inline
+} MSG_CHAN_REC_T;
+
+typedef struct {
+    MUTEX_HANDLE mutex;
+    SEM_HANDLE msg_sem;   // one count per posted record
+    SEM_HANDLE space_sem; // posted on release while producers wait
+
+    uint8_t *ring;
+    uint32_t size;
+    uint32_t wr;
+    uint32_t rd;
+    uint32_t tail;
+
+    uint32_t held; // fetched and not released
+    uint32_t space_wait;
+
+    uint32_t latest_only;
+    uint16_t gen[AI_MSG_CHAN_TYPE_LATEST_MAX];
+} MSG_CHAN_T;
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static bool __chan_is_latest_only(MSG_CHAN_T *chan, uint32_t type)
+{
+    return (type < AI_MSG_CHAN_TYPE_LATEST_MAX) && (chan->latest_only & AI_MSG_CHAN_LATEST(type));
+}
+
+// returns where a record of need bytes goes, or -1 if the ring is too full
+static int32_t __chan_reserve(MSG_CHAN_T *chan, uint32_t need)
+{
+    if (chan->wr >= chan->tail) {
+        uint32_t room = chan->size - chan->wr;
+
+        if (room > need || (room == need && chan->tail > 0)) {
+            return (int32_t)chan->wr;
+        }
+
+        if (chan->tail > need) {
+            if (room >= MSG_CHAN_HDR_LEN) {
+                ((MSG_CHAN_REC_T *)&chan->ring[chan->wr])->type = MSG_CHAN_TYPE_WRAP;
+            }
+            return 0;
+        }
+
+        return -1;
+    }
+
+    if (chan->tail - chan->wr > need) {
+        return (int32_t)chan->wr;
+    }
+
+    return -1;
+}
+
+static OPERATE_RET __chan_post(MSG_CHAN_T *chan, uint32_t type, const void *data, uint32_t len, char *owned,
+                               uint32_t timeout)
+{
+    SYS_TIME_T start = tal_system_get_millisecond();
+    bool is_inline = (NULL == owned && len <= AI_MSG_CHAN_INLINE_MAX);
+    uint32_t need = MSG_CHAN_HDR_LEN + (is_inline && len ? MSG_CHAN_ALIGN_UP(len + 1) : 0);
+    MSG_CHAN_REC_T *rec = NULL;
+    int32_t pos = -1;
+
+    if (NULL == owned && false == is_inline) {
+        owned = (char *)tkl_system_psram_malloc(len + 1);
+        if (NULL == owned) {
+            return OPRT_MALLOC_FAILED;
+        }
+        memcpy(owned, data, len);
+    }
+    if (owned) {
+        owned[len] = 0;
+    }
+
+    tal_mutex_lock(chan->mutex);
+    while ((pos = __chan_reserve(chan, need)) < 0) {
+        uint32_t wait = timeout;
+
+        if (0xFFFFFFFF != timeout) {
+            SYS_TIME_T elapsed = tal_system_get_millisecond() - start;
+            wait = (elapsed < timeout) ? (timeout - elapsed) : 0;
+        }
+        if (0 == wait) {
+            tal_mutex_unlock(chan->mutex);
+            if (owned) {
+                tkl_system_psram_free(owned);
+            }
+            return OPRT_TIMEOUT;
+        }
+
+        chan->space_wait++;
+        tal_mutex_unlock(chan->mutex);
+        tal_semaphore_wait(chan->space_sem, wait);
+        tal_mutex_lock(chan->mutex);
+        chan->space_wait--;
+    }
+
+    rec = (MSG_CHAN_REC_T *)&chan->ring[pos];
+    rec->type = (uint16_t)type;
+    rec->gen = __chan_is_latest_only(chan, type) ? ++chan->gen[type] : 0;
+    rec->len = len;
+    rec->owned = owned;
+    if (is_inline && len) {
+        memcpy(&chan->ring[pos + MSG_CHAN_HDR_LEN], data, len);
+        chan->ring[pos + MSG_CHAN_HDR_LEN + len] = 0;
+    }
+
+    chan->wr = pos + need;
+    if (chan->wr == chan->size) {
+        chan->wr = 0;
+    }
+    tal_mutex_unlock(chan->mutex);
+
+    tal_semaphore_post(chan->msg_sem);
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Creates a channel.
+ * @param size Bytes of the ring, records take 16 bytes plus inline payloads.
+ * @param latest_only Types given with AI_MSG_CHAN_LATEST() whose older pending
+ *                    messages are dropped when a new one is posted.
+ * @param handle Returns the channel.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET ai_msg_chan_create(uint32_t size, uint32_t latest_only, AI_MSG_CHAN_HANDLE *handle)
+{
+    OPERATE_RET rt = OPRT_OK;
+    MSG_CHAN_T *chan = NULL;
+
+    if (NULL == handle) {
+        return OPRT_INVALID_PARM;
+    }
+
+    size = MSG_CHAN_ALIGN_UP(size);
+    if (size < 2 * (MSG_CHAN_HDR_LEN + MSG_CHAN_ALIGN_UP(AI_MSG_CHAN_INLINE_MAX + 1))) {
+        return OPRT_INVALID_PARM;
+    }
+
+    chan = (MSG_CHAN_T *)tal_malloc(sizeof(MSG_CHAN_T));
+    if (NULL == chan) {
+        return OPRT_MALLOC_FAILED;
+    }
+    memset(chan, 0, sizeof(MSG_CHAN_T));
+
+    chan->ring = (uint8_t *)tal_malloc(size);
+    if (NULL == chan->ring) {
+        rt = OPRT_MALLOC_FAILED;
+        goto __ERR;
+    }
+    chan->size = size;
+    chan->latest_only = latest_only;
+
+    TUYA_CALL_ERR_GOTO(tal_mutex_create_init(&chan->mutex), __ERR);
+    TUYA_CALL_ERR_GOTO(tal_semaphore_create_init(&chan->msg_sem, 0, size / MSG_CHAN_HDR_LEN), __ERR);
+    TUYA_CALL_ERR_GOTO(tal_semaphore_create_init(&chan->space_sem, 0, size / MSG_CHAN_HDR_LEN), __ERR);
+
+    *handle = chan;
+
+    return OPRT_OK;
+
+__ERR:
+    if (chan->msg_sem) {
+        tal_semaphore_release(chan->msg_sem);
+    }
+    if (chan->mutex) {
+        tal_mutex_release(chan->mutex);
+    }
+    if (chan->ring) {
+        tal_free(chan->ring);
+    }
+    tal_free(chan);
+
+    return rt;
+}
+
+/**
+ * @brief Posts a copy of the payload. It waits while the ring is full.
+ * @param handle The channel.
+ * @param type The message type.
+ * @param data The payload, may be NULL when len is 0.
+ * @param len Bytes of the payload.
+ * @param timeout Milliseconds to wait for space, 0xFFFFFFFF waits forever.
+ * @return OPERATE_RET - OPRT_OK on success, OPRT_TIMEOUT if the ring stayed full.
+ */
+OPERATE_RET ai_msg_chan_post(AI_MSG_CHAN_HANDLE handle, uint32_t type, const void *data, uint32_t len,
+                             uint32_t timeout)
+{
+    if (NULL == handle || type >= MSG_CHAN_TYPE_WRAP) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (NULL == data) {
+        len = 0;
+    }
+
+    return __chan_post((MSG_CHAN_T *)handle, type, data, len, NULL, timeout);
+}
+
+/**
+ * @brief Posts a payload without copying it, the channel takes the buffer.
+ * @param handle The channel.
+ * @param type The message type.
+ * @param buf Buffer from tkl_system_psram_malloc() holding len + 1 bytes, it
+ *            is freed by the channel, also when posting fails.
+ * @param len Bytes of the payload, the channel writes the terminator.
+ * @param timeout Milliseconds to wait for space, 0xFFFFFFFF waits forever.
+ * @return OPERATE_RET - OPRT_OK on success, OPRT_TIMEOUT if the ring stayed full.
+ */
+OPERATE_RET ai_msg_chan_post_take(AI_MSG_CHAN_HANDLE handle, uint32_t type, char *buf, uint32_t len,
+                                  uint32_t timeout)
+{
+    if (NULL == handle || NULL == buf || type >= MSG_CHAN_TYPE_WRAP) {
+        if (buf) {
+            tkl_system_psram_free(buf);
+        }
+        return OPRT_INVALID_PARM;
+    }
+
+    return __chan_post((MSG_CHAN_T *)handle, type, NULL, len, buf, timeout);
+}
+
+/**
+ * @brief Gets the next message. Messages are released in the order fetched.
+ * @param handle The channel.
+ * @param msg Filled with the message, its data stays valid until released.
+ * @param timeout Milliseconds to wait, 0xFFFFFFFF waits forever.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on timeout.
+ */
+OPERATE_RET ai_msg_chan_fetch(AI_MSG_CHAN_HANDLE handle, AI_MSG_CHAN_MSG_T *msg, uint32_t timeout)
+{
+    OPERATE_RET rt = OPRT_OK;
+    MSG_CHAN_T *chan = (MSG_CHAN_T *)handle;
+    MSG_CHAN_REC_T *rec = NULL;
+    uint32_t start = 0;
+    char *stale = NULL;
+
+    if (NULL == chan || NULL == msg) {
+        return OPRT_INVALID_PARM;
+    }
+
+    for (;;) {
+        rt = tal_semaphore_wait(chan->msg_sem, timeout);
+        if (OPRT_OK != rt) {
+            return rt;
+        }
+
+        tal_mutex_lock(chan->mutex);
+        if (chan->size - chan->rd < MSG_CHAN_HDR_LEN ||
+            MSG_CHAN_TYPE_WRAP == ((MSG_CHAN_REC_T *)&chan->ring[chan->rd])->type) {
+            chan->rd = 0;
+        }
+        start = chan->rd;
+        rec = (MSG_CHAN_REC_T *)&chan->ring[start];
+
+        chan->rd = start + MSG_CHAN_HDR_LEN + ((NULL == rec->owned && rec->len) ? MSG_CHAN_ALIGN_UP(rec->len + 1) : 0);
+        if (chan->rd == chan->size) {
+            chan->rd = 0;
+        }
+
+        if (__chan_is_latest_only(chan, rec->type) && rec->gen != chan->gen[rec->type]) {
+            // superseded, it is released at once unless older messages are still held
+            stale = rec->owned;
+            if (0 == chan->held) {
+                chan->tail = chan->rd;
+            }
+            tal_mutex_unlock(chan->mutex);
+            if (stale) {
+                tkl_system_psram_free(stale);
+            }
+            continue;
+        }
+
+        msg->type = rec->type;
+        msg->len = rec->len;
+        msg->owned = rec->owned;
+        if (rec->owned) {
+            msg->data = rec->owned;
+        } else {
+            msg->data = rec->len ? (char *)&chan->ring[start + MSG_CHAN_HDR_LEN] : NULL;
+        }
+        msg->end = chan->rd;
+        chan->held++;
+        tal_mutex_unlock(chan->mutex);
+
+        return rt;
+    }
+}
+
+/**
+ * @brief Appends the payload of next to msg, only msg is released afterwards.
+ * @param handle The channel.
+ * @param msg A fetched message.
+ * @param next The message fetched after msg.
+ * @return OPERATE_RET - OPRT_OK on success, on failure both stay unchanged.
+ */
+OPERATE_RET ai_msg_chan_merge(AI_MSG_CHAN_HANDLE handle, AI_MSG_CHAN_MSG_T *msg, AI_MSG_CHAN_MSG_T *next)
+{
+    MSG_CHAN_T *chan = (MSG_CHAN_T *)handle;
+    char *data = NULL;
+
+    if (NULL == chan || NULL == msg || NULL == next) {
+        return OPRT_INVALID_PARM;
+    }
+
+    data = (char *)tkl_system_psram_malloc(msg->len + next->len + 1);
+    if (NULL == data) {
+        return OPRT_MALLOC_FAILED;
+    }
+
+    if (msg->len) {
+        memcpy(data, msg->data, msg->len);
+    }
+    if (next->len) {
+        memcpy(data + msg->len, next->data, next->len);
+    }
+    data[msg->len + next->len] = 0;
+
+    if (msg->owned) {
+        tkl_system_psram_free(msg->owned);
+    }
+    if (next->owned) {
+        tkl_system_psram_free(next->owned);
+    }
+
+    msg->data = data;
+    msg->owned = data;
+    msg->len += next->len;
+
+    tal_mutex_lock(chan->mutex);
+    if (MSG_CHAN_END_NONE != next->end) {
+        if (MSG_CHAN_END_NONE != msg->end) {
+            chan->held--;
+        }
+        msg->end = next->end;
+    }
+    tal_mutex_unlock(chan->mutex);
+
+    memset(next, 0, sizeof(AI_MSG_CHAN_MSG_T));
+    next->end = MSG_CHAN_END_NONE;
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Gives a fetched message back to the channel.
+ * @param handle The channel.
+ * @param msg The message.
+ * @return None
+ */
+void ai_msg_chan_release(AI_MSG_CHAN_HANDLE handle, AI_MSG_CHAN_MSG_T *msg)
+{
+    MSG_CHAN_T *chan = (MSG_CHAN_T *)handle;
+
+    if (NULL == chan || NULL == msg) {
+        return;
+    }
+
+    if (MSG_CHAN_END_NONE != msg->end) {
+        tal_mutex_lock(chan->mutex);
+        chan->held--;
+        // the last held message also releases the superseded records after it
+        chan->tail = (0 == chan->held) ? chan->rd : msg->end;
+        for (uint32_t i = 0; i < chan->space_wait; i++) {
+            tal_semaphore_post(chan->space_sem);
+        }
+        tal_mutex_unlock(chan->mutex);
+    }
+
+    if (msg->owned) {
+        tkl_system_psram_free(msg->owned);
+    }
+
+    memset(msg, 0, sizeof(AI_MSG_CHAN_MSG_T));
+    msg->end = MSG_CHAN_END_NONE;
+}
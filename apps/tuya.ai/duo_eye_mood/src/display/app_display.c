@@ -19,28 +19,31 @@
 #include "ui_display.h"
 
 #include "tal_log.h"
-#include "tal_queue.h"
 #include "tal_thread.h"
 
-#include "tkl_memory.h"
-
 #include "lvgl.h"
 
+#include "ai_msg_chan.h"
+
 /***********************************************************
 ************************macro define************************
 ***********************************************************/
+// bytes of the message ring, short text and status messages are stored in it
+#ifndef APP_DISPLAY_CHAN_SIZE
+#define APP_DISPLAY_CHAN_SIZE 4096
+#endif
+
+// messages only the latest pending one of is shown
+#define APP_DISPLAY_LATEST_ONLY                                                                                        \
+    (AI_MSG_CHAN_LATEST(TY_DISPLAY_TP_EMOTION) | AI_MSG_CHAN_LATEST(TY_DISPLAY_TP_STATUS) |                            \
+     AI_MSG_CHAN_LATEST(TY_DISPLAY_TP_NOTIFICATION) | AI_MSG_CHAN_LATEST(TY_DISPLAY_TP_NETWORK) |                      \
+     AI_MSG_CHAN_LATEST(TY_DISPLAY_TP_CHAT_MODE))
 
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
 typedef struct {
-    TY_DISPLAY_TYPE_E type;
-    int len;
-    char *data;
-} DISPLAY_MSG_T;
-
-typedef struct {
-    QUEUE_HANDLE queue_hdl;
+    AI_MSG_CHAN_HANDLE msg_chan;
     THREAD_HANDLE thrd_hdl;
 
     UI_FONT_T ui_font;
@@ -85,7 +88,7 @@ static TUYA_DISPLAY_T sg_display = {0};
 ***********************function define**********************
 ***********************************************************/
 
-static void __app_display_msg_handle(DISPLAY_MSG_T *msg_data)
+static void __app_display_msg_handle(AI_MSG_CHAN_MSG_T *msg_data)
 {
     if (msg_data == NULL) {
         return;
@@ -142,7 +145,7 @@ static void __app_display_msg_handle(DISPLAY_MSG_T *msg_data)
 static void __chat_bot_ui_task(void *args)
 {
     OPERATE_RET rt = OPRT_OK;
-    DISPLAY_MSG_T msg_data = {0};
+    AI_MSG_CHAN_MSG_T msg_data = {0};
 
     (void)args;
 
@@ -160,15 +163,13 @@ static void __chat_bot_ui_task(void *args)
     PR_DEBUG("ui init success");
 
     for (;;) {
-        memset(&msg_data, 0, sizeof(DISPLAY_MSG_T));
-        tal_queue_fetch(sg_display.queue_hdl, &msg_data, 0xFFFFFFFF);
+        if (OPRT_OK != ai_msg_chan_fetch(sg_display.msg_chan, &msg_data, 0xFFFFFFFF)) {
+            continue;
+        }
 
         __app_display_msg_handle(&msg_data);
 
-        if (msg_data.data) {
-            tkl_system_psram_free(msg_data.data);
-        }
-        msg_data.data = NULL;
+        ai_msg_chan_release(sg_display.msg_chan, &msg_data);
     }
 }
 
@@ -188,7 +189,7 @@ OPERATE_RET app_display_init(void)
     TUYA_CALL_ERR_RETURN(tuya_lvgl_init());
     PR_DEBUG("lvgl init success");
 
-    TUYA_CALL_ERR_RETURN(tal_queue_create_init(&sg_display.queue_hdl, sizeof(DISPLAY_MSG_T), 8));
+    TUYA_CALL_ERR_RETURN(ai_msg_chan_create(APP_DISPLAY_CHAN_SIZE, APP_DISPLAY_LATEST_ONLY, &sg_display.msg_chan));
     THREAD_CFG_T cfg = {
         .thrdname = "chat_ui",
         .priority = THREAD_PRIO_2,
@@ -210,22 +211,5 @@ OPERATE_RET app_display_init(void)
  */
 OPERATE_RET app_display_send_msg(TY_DISPLAY_TYPE_E tp, uint8_t *data, int len)
 {
-    DISPLAY_MSG_T msg_data;
-
-    msg_data.type = tp;
-    msg_data.len = len;
-    if (len && data != NULL) {
-        msg_data.data = (char *)tkl_system_psram_malloc(len + 1);
-        if (NULL == msg_data.data) {
-            return OPRT_MALLOC_FAILED;
-        }
-        memcpy(msg_data.data, data, len);
-        msg_data.data[len] = 0; //"\0"
-    } else {
-        msg_data.data = NULL;
-    }
-
-    tal_queue_post(sg_display.queue_hdl, &msg_data, 0xFFFFFFFF);
-
-    return OPRT_OK;
+    return ai_msg_chan_post(sg_display.msg_chan, tp, data, len, 0xFFFFFFFF);
 }
@@ -10,6 +10,7 @@
 #include "ui_display.h"
 
 #include "lvgl.h"
+#include "lv_port_anim.h"
 
 /***********************************************************
 ************************macro define************************
@@ -67,14 +68,14 @@ int ui_init(UI_FONT_T *ui_font)
 {
     lv_img_dsc_t *img = NULL;
 
-    sg_eyes_gif = lv_gif_create(lv_scr_act());
+    sg_eyes_gif = lv_port_anim_create(lv_scr_act());
     img = __ui_eyes_get_img(EMOJI_NEUTRAL);
     if (NULL == img) {
         PR_ERR("invalid emotion: %s", EMOJI_NEUTRAL);
         return OPRT_INVALID_PARM;
     }
 
-    lv_gif_set_src(sg_eyes_gif, img);
+    lv_port_anim_set_src(sg_eyes_gif, img);
     lv_obj_align(sg_eyes_gif, LV_ALIGN_CENTER, 0, 0);
 
     return OPRT_OK;
@@ -90,7 +91,7 @@ void ui_set_emotion(const char *emotion)
         return;
     }
 
-    lv_gif_set_src(sg_eyes_gif, img);
+    lv_port_anim_set_src(sg_eyes_gif, img);
 
     return;
 }
@@ -49,6 +49,7 @@ typedef uint8_t UI_WIFI_STATUS_E;
 typedef enum {
     TY_DISPLAY_TP_USER_MSG,
     TY_DISPLAY_TP_ASSISTANT_MSG,
+    TY_DISPLAY_TP_ASSISTANT_MSG_APPEND, // text continuing the last assistant message
     TY_DISPLAY_TP_ASSISTANT_MSG_STREAM_START,
     TY_DISPLAY_TP_ASSISTANT_MSG_STREAM_DATA,
     TY_DISPLAY_TP_ASSISTANT_MSG_STREAM_END,
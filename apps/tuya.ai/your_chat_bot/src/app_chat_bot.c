@@ -141,6 +141,7 @@ static void __app_ai_audio_evt_inform_cb(AI_AUDIO_EVENT_E event, uint8_t *data,
 #if !defined(ENABLE_GUI_STREAM_AI_TEXT) || (ENABLE_GUI_STREAM_AI_TEXT != 1)
     static uint8_t *p_ai_text = NULL;
     static uint32_t ai_text_len = 0;
+    static bool ai_text_shown = false;
 #endif
 #endif
 
@@ -166,6 +167,7 @@ static void __app_ai_audio_evt_inform_cb(AI_AUDIO_EVENT_E event, uint8_t *data,
         }
 
         ai_text_len = 0;
+        ai_text_shown = false;
 #endif
 #endif
     } break;
@@ -178,8 +180,11 @@ static void __app_ai_audio_evt_inform_cb(AI_AUDIO_EVENT_E event, uint8_t *data,
 
         ai_text_len += len;
         if (ai_text_len >= AI_AUDIO_TEXT_SHOW_LEN) {
-            app_display_send_msg(TY_DISPLAY_TP_ASSISTANT_MSG, p_ai_text, ai_text_len);
+            // later pieces of the reply are appended to the message the first one started
+            app_display_send_msg(ai_text_shown ? TY_DISPLAY_TP_ASSISTANT_MSG_APPEND : TY_DISPLAY_TP_ASSISTANT_MSG,
+                                 p_ai_text, ai_text_len);
             ai_text_len = 0;
+            ai_text_shown = true;
         }
 #endif
 #endif
@@ -189,8 +194,13 @@ static void __app_ai_audio_evt_inform_cb(AI_AUDIO_EVENT_E event, uint8_t *data,
 #if defined(ENABLE_GUI_STREAM_AI_TEXT) && (ENABLE_GUI_STREAM_AI_TEXT == 1)
         app_display_send_msg(TY_DISPLAY_TP_ASSISTANT_MSG_STREAM_END, data, len);
 #else
-        app_display_send_msg(TY_DISPLAY_TP_ASSISTANT_MSG, p_ai_text, ai_text_len);
+        if (false == ai_text_shown) {
+            app_display_send_msg(TY_DISPLAY_TP_ASSISTANT_MSG, p_ai_text, ai_text_len);
+        } else if (ai_text_len) {
+            app_display_send_msg(TY_DISPLAY_TP_ASSISTANT_MSG_APPEND, p_ai_text, ai_text_len);
+        }
         ai_text_len = 0;
+        ai_text_shown = false;
 #endif
 #endif
     } break;
@@ -382,6 +392,37 @@ static OPERATE_RET __app_open_button(void)
 }
 #endif
 
+#define APP_PROMPT(type, src, preload) {type, (const uint8_t *)src, sizeof(src), NULL, 0, preload}
+
+static OPERATE_RET __app_prompt_register(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint32_t i = 0;
+
+    // the wake chime goes first, it is decoded and kept in ram before the others
+    const AI_AUDIO_PROMPT_T prompts[] = {
+        APP_PROMPT(AI_AUDIO_ALERT_WAKEUP, media_src_ai_zh, true),
+        APP_PROMPT(AI_AUDIO_ALERT_POWER_ON, media_src_prologue_zh, false),
+        APP_PROMPT(AI_AUDIO_ALERT_NOT_ACTIVE, media_src_network_conn_zh, false),
+        APP_PROMPT(AI_AUDIO_ALERT_NETWORK_CFG, media_src_network_config_zh, false),
+        APP_PROMPT(AI_AUDIO_ALERT_NETWORK_CONNECTED, media_src_network_conn_success_zh, false),
+        APP_PROMPT(AI_AUDIO_ALERT_NETWORK_FAIL, media_src_network_conn_failed_zh, false),
+        APP_PROMPT(AI_AUDIO_ALERT_NETWORK_DISCONNECT, media_src_network_reconfigure_zh, false),
+        APP_PROMPT(AI_AUDIO_ALERT_BATTERY_LOW, media_src_low_battery_zh, false),
+        APP_PROMPT(AI_AUDIO_ALERT_PLEASE_AGAIN, media_src_please_again_zh, false),
+        APP_PROMPT(AI_AUDIO_ALERT_LONG_KEY_TALK, media_src_long_press_zh, false),
+        APP_PROMPT(AI_AUDIO_ALERT_KEY_TALK, media_src_press_talk_zh, false),
+        APP_PROMPT(AI_AUDIO_ALERT_WAKEUP_TALK, media_src_wakeup_chat_zh, false),
+        APP_PROMPT(AI_AUDIO_ALERT_FREE_TALK, media_src_free_chat_zh, false),
+    };
+
+    for (i = 0; i < CNTSOF(prompts); i++) {
+        TUYA_CALL_ERR_RETURN(ai_audio_prompt_register(&prompts[i]));
+    }
+
+    return OPRT_OK;
+}
+
 OPERATE_RET app_chat_bot_init(void)
 {
     OPERATE_RET rt = OPRT_OK;
@@ -397,6 +438,8 @@ OPERATE_RET app_chat_bot_init(void)
 
     TUYA_CALL_ERR_RETURN(ai_audio_init(&ai_audio_cfg));
 
+    TUYA_CALL_ERR_RETURN(__app_prompt_register());
+
 #if defined(ENABLE_BUTTON) && (ENABLE_BUTTON == 1)
     TUYA_CALL_ERR_RETURN(__app_open_button());
 #endif
@@ -425,62 +468,5 @@ OPERATE_RET app_chat_bot_init(void)
  */
 OPERATE_RET ai_audio_player_play_alert(AI_AUDIO_ALERT_TYPE_E type)
 {
-    OPERATE_RET rt = OPRT_OK;
-    char alert_id[64] = {0};
-
-    snprintf(alert_id, sizeof(alert_id), "alert_%d", type);
-
-    ai_audio_player_start(alert_id);
-
-    switch (type) {
-    case AI_AUDIO_ALERT_POWER_ON: {
-        rt = ai_audio_player_data_write(alert_id, (uint8_t *)media_src_prologue_zh, sizeof(media_src_prologue_zh), 1);
-    } break;
-    case AI_AUDIO_ALERT_NOT_ACTIVE: {
-        rt = ai_audio_player_data_write(alert_id, (uint8_t *)media_src_network_conn_zh, sizeof(media_src_network_conn_zh), 1);
-    } break;
-    case AI_AUDIO_ALERT_NETWORK_CFG: {
-        rt = ai_audio_player_data_write(alert_id, (uint8_t *)media_src_network_config_zh, sizeof(media_src_network_config_zh), 1);
-    } break;
-    case AI_AUDIO_ALERT_NETWORK_CONNECTED: {
-        rt = ai_audio_player_data_write(alert_id, (uint8_t *)media_src_network_conn_success_zh,
-                                        sizeof(media_src_network_conn_success_zh), 1);
-    } break;
-    case AI_AUDIO_ALERT_NETWORK_FAIL: {
-        rt = ai_audio_player_data_write(alert_id, (uint8_t *)media_src_network_conn_failed_zh, sizeof(media_src_network_conn_failed_zh), 1);
-    } break;
-    case AI_AUDIO_ALERT_NETWORK_DISCONNECT: {
-        rt = ai_audio_player_data_write(alert_id, (uint8_t *)media_src_network_reconfigure_zh,
-                                        sizeof(media_src_network_reconfigure_zh), 1);
-    } break;
-    case AI_AUDIO_ALERT_BATTERY_LOW: {
-        rt = ai_audio_player_data_write(alert_id, (uint8_t *)media_src_low_battery_zh, sizeof(media_src_low_battery_zh), 1);
-    } break;
-    case AI_AUDIO_ALERT_PLEASE_AGAIN: {
-        rt = ai_audio_player_data_write(alert_id, (uint8_t *)media_src_please_again_zh, sizeof(media_src_please_again_zh), 1);
-    } break;
-    case AI_AUDIO_ALERT_WAKEUP: {
-        rt = ai_audio_player_data_write(alert_id, (uint8_t *)media_src_ai_zh, sizeof(media_src_ai_zh), 1);
-    } break;
-    case AI_AUDIO_ALERT_LONG_KEY_TALK: {
-        rt = ai_audio_player_data_write(alert_id, (uint8_t *)media_src_long_press_zh,
-                                        sizeof(media_src_long_press_zh), 1);
-    } break;
-    case AI_AUDIO_ALERT_KEY_TALK: {
-        rt = ai_audio_player_data_write(alert_id, (uint8_t *)media_src_press_talk_zh, sizeof(media_src_press_talk_zh), 1);
-    } break;
-    case AI_AUDIO_ALERT_WAKEUP_TALK: {
-        rt = ai_audio_player_data_write(alert_id, (uint8_t *)media_src_wakeup_chat_zh, sizeof(media_src_wakeup_chat_zh),
-                                        1);
-    } break;
-    case AI_AUDIO_ALERT_FREE_TALK: {
-        rt = ai_audio_player_data_write(alert_id, (uint8_t *)media_src_free_chat_zh, sizeof(media_src_free_chat_zh),
-                                        1);
-    } break;
-
-    default:
-        break;
-    }
-
-    return rt;
+    return ai_audio_prompt_play(type);
 }
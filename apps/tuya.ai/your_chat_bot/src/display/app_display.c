@@ -21,28 +21,41 @@
 #include "ui_display.h"
 
 #include "tal_log.h"
-#include "tal_queue.h"
+#include "tal_system.h"
 #include "tal_thread.h"
 
-#include "tkl_memory.h"
-
 #include "lvgl.h"
 
+#include "ai_msg_chan.h"
+
+#if defined(ENABLE_FONT_PACK) && (ENABLE_FONT_PACK == 1)
+#include "ai_font_pack.h"
+#endif
+
 /***********************************************************
 ************************macro define************************
 ***********************************************************/
+// bytes of the message ring, short text and status messages are stored in it
+#ifndef APP_DISPLAY_CHAN_SIZE
+#define APP_DISPLAY_CHAN_SIZE 4096
+#endif
+
+// messages only the latest pending one of is shown
+#define APP_DISPLAY_LATEST_ONLY                                                                                        \
+    (AI_MSG_CHAN_LATEST(TY_DISPLAY_TP_EMOTION) | AI_MSG_CHAN_LATEST(TY_DISPLAY_TP_STATUS) |                            \
+     AI_MSG_CHAN_LATEST(TY_DISPLAY_TP_NOTIFICATION) | AI_MSG_CHAN_LATEST(TY_DISPLAY_TP_NETWORK) |                      \
+     AI_MSG_CHAN_LATEST(TY_DISPLAY_TP_CHAT_MODE))
+
+// text pieces arriving within this time are drawn together
+#ifndef APP_DISPLAY_FRAME_MS
+#define APP_DISPLAY_FRAME_MS 33
+#endif
 
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
 typedef struct {
-    TY_DISPLAY_TYPE_E type;
-    int len;
-    char *data;
-} DISPLAY_MSG_T;
-
-typedef struct {
-    QUEUE_HANDLE queue_hdl;
+    AI_MSG_CHAN_HANDLE msg_chan;
     THREAD_HANDLE thrd_hdl;
 
     UI_FONT_T ui_font;
@@ -51,10 +64,15 @@ typedef struct {
 /***********************************************************
 ********************function declaration********************
 ***********************************************************/
+#if defined(ENABLE_FONT_PACK) && (ENABLE_FONT_PACK == 1)
+#define UI_TEXT_FONT(name) __get_pack_font(#name)
+#else
 LV_FONT_DECLARE(font_puhui_14_1);
 LV_FONT_DECLARE(font_puhui_18_2);
 LV_FONT_DECLARE(font_puhui_20_4);
 LV_FONT_DECLARE(font_puhui_30_4);
+#define UI_TEXT_FONT(name) &name
+#endif
 LV_FONT_DECLARE(font_awesome_14_1);
 LV_FONT_DECLARE(font_awesome_16_4);
 LV_FONT_DECLARE(font_awesome_20_4);
@@ -87,6 +105,20 @@ static TUYA_DISPLAY_T sg_display = {0};
 ***********************function define**********************
 ***********************************************************/
 
+#if defined(ENABLE_FONT_PACK) && (ENABLE_FONT_PACK == 1)
+static const lv_font_t *__get_pack_font(const char *name)
+{
+    const lv_font_t *font = ai_font_pack_get(name);
+
+    if (NULL == font) {
+        PR_ERR("font %s not in font pack", name);
+        return LV_FONT_DEFAULT;
+    }
+
+    return font;
+}
+#endif
+
 static OPERATE_RET __get_ui_font(UI_FONT_T *ui_font)
 {
     OPERATE_RET rt = OPRT_OK;
@@ -95,33 +127,39 @@ static OPERATE_RET __get_ui_font(UI_FONT_T *ui_font)
         return OPRT_INVALID_PARM;
     }
 
+#if defined(ENABLE_FONT_PACK) && (ENABLE_FONT_PACK == 1)
+    if (OPRT_OK != ai_font_pack_init()) {
+        PR_ERR("font pack not loaded, text uses the default font");
+    }
+#endif
+
 #if (defined(BOARD_CHOICE_TUYA_T5AI_BOARD) || defined(BOARD_CHOICE_TUYA_T5AI_EVB) ||                                   \
      defined(BOARD_CHOICE_T5AI_MOJI_1_28) || defined(BOARD_CHOICE_TUYA_T5AI_CORE)|| defined(BOARD_CHOICE_T5AI_MINI) || defined(BOARD_CHOICE_T5AI_OTTO) || defined(BOARD_CHOICE_DNESP32S3_BOX) || \
      defined(BOARD_CHOICE_DNESP32S3_BOX2_WIFI)) ||                                                                     \
     defined(BOARD_CHOICE_WAVESHARE_T5AI_TOUCH_AMOLED_1_75)
 #if defined(ENABLE_GUI_WECHAT)
-    ui_font->text = (lv_font_t *)&font_puhui_18_2;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_18_2);
     ui_font->icon = (lv_font_t *)&font_awesome_16_4;
     ui_font->emoji = (lv_font_t *)font_emoji_32_init();
     ui_font->emoji_list = sg_emo_list;
 #elif defined(ENABLE_GUI_CHATBOT)
-    ui_font->text = (lv_font_t *)&font_puhui_18_2;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_18_2);
     ui_font->icon = (lv_font_t *)&font_awesome_16_4;
     ui_font->emoji = (lv_font_t *)font_emoji_64_init();
     ui_font->emoji_list = sg_emo_list;
 #endif
 #elif defined(BOARD_CHOICE_BREAD_COMPACT_WIFI)
-    ui_font->text = (lv_font_t *)&font_puhui_14_1;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_14_1);
     ui_font->icon = (lv_font_t *)&font_awesome_14_1;
     ui_font->emoji = (lv_font_t *)&font_awesome_30_1;
     ui_font->emoji_list = sg_awesome_emo_list;
 #elif defined(BOARD_CHOICE_XINGZHI_CUBE_0_96_OLED_WIFI)
-    ui_font->text = (lv_font_t *)&font_puhui_14_1;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_14_1);
     ui_font->icon = (lv_font_t *)&font_awesome_14_1;
     ui_font->emoji = (lv_font_t *)&font_awesome_30_1;
     ui_font->emoji_list = sg_awesome_emo_list;
 #elif defined(BOARD_CHOICE_WAVESHARE_ESP32_S3_TOUCH_AMOLED_1_8)
-    ui_font->text = (lv_font_t *)&font_puhui_30_4;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_30_4);
     ui_font->icon = (lv_font_t *)&font_awesome_30_4;
 #if defined(ENABLE_GUI_WECHAT)
     ui_font->emoji = font_emoji_32_init();
@@ -130,7 +168,7 @@ static OPERATE_RET __get_ui_font(UI_FONT_T *ui_font)
 #endif
     ui_font->emoji_list = sg_emo_list;
 #elif defined(BOARD_CHOICE_DNESP32S3)
-    ui_font->text = (lv_font_t *)&font_puhui_20_4;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_20_4);
     ui_font->icon = (lv_font_t *)&font_awesome_20_4;
 #if defined(ENABLE_GUI_WECHAT)
     ui_font->emoji = font_emoji_32_init();
@@ -170,7 +208,7 @@ static char *__ui_wifi_icon_get(UI_WIFI_STATUS_E status)
     return wifi_icon;
 }
 
-static void __app_display_msg_handle(DISPLAY_MSG_T *msg_data)
+static void __app_display_msg_handle(AI_MSG_CHAN_MSG_T *msg_data)
 {
     if (msg_data == NULL) {
         return;
@@ -185,6 +223,9 @@ static void __app_display_msg_handle(DISPLAY_MSG_T *msg_data)
     case TY_DISPLAY_TP_ASSISTANT_MSG: {
         ui_set_assistant_msg(msg_data->data);
     } break;
+    case TY_DISPLAY_TP_ASSISTANT_MSG_APPEND: {
+        ui_append_assistant_msg(msg_data->data);
+    } break;
 #if defined(ENABLE_GUI_STREAM_AI_TEXT) && (ENABLE_GUI_STREAM_AI_TEXT == 1)
     case TY_DISPLAY_TP_ASSISTANT_MSG_STREAM_START: {
         ui_set_assistant_msg_stream_start();
@@ -227,10 +268,50 @@ static void __app_display_msg_handle(DISPLAY_MSG_T *msg_data)
     tuya_lvgl_mutex_unlock();
 }
 
+static bool __app_display_msg_mergeable(AI_MSG_CHAN_MSG_T *msg_data)
+{
+    if (NULL == msg_data->data) {
+        return false;
+    }
+
+    return (TY_DISPLAY_TP_ASSISTANT_MSG_APPEND == msg_data->type ||
+            TY_DISPLAY_TP_ASSISTANT_MSG_STREAM_DATA == msg_data->type);
+}
+
+/**
+ * @brief Wait up to one frame for text continuing msg_data and join it in
+ *
+ * @param msg_data Text message, grows with the pieces joined in
+ * @param next Filled with the first message that could not be joined
+ * @return true if next holds a message to handle after msg_data
+ */
+static bool __app_display_msg_coalesce(AI_MSG_CHAN_MSG_T *msg_data, AI_MSG_CHAN_MSG_T *next)
+{
+    SYS_TIME_T start = tal_system_get_millisecond();
+    SYS_TIME_T elapsed = 0;
+
+    while (elapsed < APP_DISPLAY_FRAME_MS) {
+        if (OPRT_OK != ai_msg_chan_fetch(sg_display.msg_chan, next, APP_DISPLAY_FRAME_MS - elapsed)) {
+            return false;
+        }
+
+        if (next->type != msg_data->type || false == __app_display_msg_mergeable(next) ||
+            OPRT_OK != ai_msg_chan_merge(sg_display.msg_chan, msg_data, next)) {
+            return true;
+        }
+
+        elapsed = tal_system_get_millisecond() - start;
+    }
+
+    return false;
+}
+
 static void __chat_bot_ui_task(void *args)
 {
     OPERATE_RET rt = OPRT_OK;
-    DISPLAY_MSG_T msg_data = {0};
+    AI_MSG_CHAN_MSG_T msg_data = {0};
+    AI_MSG_CHAN_MSG_T next = {0};
+    bool has_next = false;
 
     (void)args;
 
@@ -248,15 +329,21 @@ static void __chat_bot_ui_task(void *args)
     PR_DEBUG("ui init success");
 
     for (;;) {
-        memset(&msg_data, 0, sizeof(DISPLAY_MSG_T));
-        tal_queue_fetch(sg_display.queue_hdl, &msg_data, 0xFFFFFFFF);
+        if (has_next) {
+            msg_data = next;
+            has_next = false;
+        } else if (OPRT_OK != ai_msg_chan_fetch(sg_display.msg_chan, &msg_data, 0xFFFFFFFF)) {
+            continue;
+        }
+
+        // pieces of one reply are drawn with a single layout pass
+        if (__app_display_msg_mergeable(&msg_data)) {
+            has_next = __app_display_msg_coalesce(&msg_data, &next);
+        }
 
         __app_display_msg_handle(&msg_data);
 
-        if (msg_data.data) {
-            tkl_system_psram_free(msg_data.data);
-        }
-        msg_data.data = NULL;
+        ai_msg_chan_release(sg_display.msg_chan, &msg_data);
     }
 }
 
@@ -276,7 +363,7 @@ OPERATE_RET app_display_init(void)
     TUYA_CALL_ERR_RETURN(tuya_lvgl_init());
     PR_DEBUG("lvgl init success");
 
-    TUYA_CALL_ERR_RETURN(tal_queue_create_init(&sg_display.queue_hdl, sizeof(DISPLAY_MSG_T), 8));
+    TUYA_CALL_ERR_RETURN(ai_msg_chan_create(APP_DISPLAY_CHAN_SIZE, APP_DISPLAY_LATEST_ONLY, &sg_display.msg_chan));
     THREAD_CFG_T cfg = {
         .thrdname = "chat_ui",
         .priority = THREAD_PRIO_2,
@@ -298,22 +385,5 @@ OPERATE_RET app_display_init(void)
  */
 OPERATE_RET app_display_send_msg(TY_DISPLAY_TYPE_E tp, uint8_t *data, int len)
 {
-    DISPLAY_MSG_T msg_data;
-
-    msg_data.type = tp;
-    msg_data.len = len;
-    if (len && data != NULL) {
-        msg_data.data = (char *)tkl_system_psram_malloc(len + 1);
-        if (NULL == msg_data.data) {
-            return OPRT_MALLOC_FAILED;
-        }
-        memcpy(msg_data.data, data, len);
-        msg_data.data[len] = 0; //"\0"
-    } else {
-        msg_data.data = NULL;
-    }
-
-    tal_queue_post(sg_display.queue_hdl, &msg_data, 0xFFFFFFFF);
-
-    return OPRT_OK;
+    return ai_msg_chan_post(sg_display.msg_chan, tp, data, len, 0xFFFFFFFF);
 }
\ No newline at end of file
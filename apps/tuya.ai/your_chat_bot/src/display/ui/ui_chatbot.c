@@ -244,6 +244,15 @@ void ui_set_assistant_msg(const char *text)
     lv_obj_set_style_text_color(sg_ui.ui.chat_message_label, sg_ui.theme.text, 0);
 }
 
+void ui_append_assistant_msg(const char *text)
+{
+    if (sg_ui.ui.chat_message_label == NULL || text == NULL) {
+        return;
+    }
+
+    lv_label_ins_text(sg_ui.ui.chat_message_label, LV_LABEL_POS_LAST, text);
+}
+
 void ui_set_system_msg(const char *text)
 {
     if (sg_ui.ui.chat_message_label == NULL) {
@@ -57,6 +57,8 @@ void ui_set_user_msg(const char *text);
 
 void ui_set_assistant_msg(const char *text);
 
+void ui_append_assistant_msg(const char *text);
+
 void ui_set_system_msg(const char *text);
 
 void ui_set_emotion(const char *emotion);
@@ -72,6 +72,22 @@ int __ui_font_init(UI_FONT_T *ui_font)
     return 0;
 }
 
+/*
+ * The same text is sent again on every streaming tick. Setting it again would
+ * restart the scroll animation and redraw the label, so it is skipped, the
+ * panel then has nothing to transfer.
+ */
+static void __ui_label_set_text(lv_obj_t *label, const char *text)
+{
+    const char *cur = lv_label_get_text(label);
+
+    if (NULL != text && NULL != cur && 0 == strcmp(cur, text)) {
+        return;
+    }
+
+    lv_label_set_text(label, text);
+}
+
 static void __ui_notification_timeout_cb(lv_timer_t *timer)
 {
     lv_timer_del(sg_ui.notification_tm);
@@ -266,7 +282,7 @@ void ui_set_user_msg(const char *text)
         return;
     }
 
-    lv_label_set_text(sg_ui.ui.chat_message_label, text);
+    __ui_label_set_text(sg_ui.ui.chat_message_label, text);
 }
 
 void ui_set_assistant_msg(const char *text)
@@ -275,7 +291,16 @@ void ui_set_assistant_msg(const char *text)
         return;
     }
 
-    lv_label_set_text(sg_ui.ui.chat_message_label, text);
+    __ui_label_set_text(sg_ui.ui.chat_message_label, text);
+}
+
+void ui_append_assistant_msg(const char *text)
+{
+    if (sg_ui.ui.chat_message_label == NULL || text == NULL) {
+        return;
+    }
+
+    lv_label_ins_text(sg_ui.ui.chat_message_label, LV_LABEL_POS_LAST, text);
 }
 
 void ui_set_system_msg(const char *text)
@@ -284,7 +309,7 @@ void ui_set_system_msg(const char *text)
         return;
     }
 
-    lv_label_set_text(sg_ui.ui.chat_message_label, text);
+    __ui_label_set_text(sg_ui.ui.chat_message_label, text);
 }
 
 void ui_set_emotion(const char *emotion)
@@ -302,7 +327,7 @@ void ui_set_emotion(const char *emotion)
     }
 
     lv_obj_set_style_text_font(sg_ui.ui.emotion_label, sg_ui.font.emoji, 0);
-    lv_label_set_text(sg_ui.ui.emotion_label, emo_icon);
+    __ui_label_set_text(sg_ui.ui.emotion_label, emo_icon);
 }
 
 void ui_set_status(const char *status)
@@ -311,7 +336,7 @@ void ui_set_status(const char *status)
         return;
     }
 
-    lv_label_set_text(sg_ui.ui.status_label, status);
+    __ui_label_set_text(sg_ui.ui.status_label, status);
     lv_obj_clear_flag(sg_ui.ui.status_label, LV_OBJ_FLAG_HIDDEN);
     lv_obj_add_flag(sg_ui.ui.notification_label, LV_OBJ_FLAG_HIDDEN);
 }
@@ -322,7 +347,7 @@ void ui_set_notification(const char *notification)
         return;
     }
 
-    lv_label_set_text(sg_ui.ui.notification_label, notification);
+    __ui_label_set_text(sg_ui.ui.notification_label, notification);
     lv_obj_clear_flag(sg_ui.ui.notification_label, LV_OBJ_FLAG_HIDDEN);
     lv_obj_add_flag(sg_ui.ui.status_label, LV_OBJ_FLAG_HIDDEN);
 
@@ -339,7 +364,7 @@ void ui_set_network(char *wifi_icon)
         return;
     }
 
-    lv_label_set_text(sg_ui.ui.network_label, wifi_icon);
+    __ui_label_set_text(sg_ui.ui.network_label, wifi_icon);
 }
 
 void ui_set_chat_mode(const char *chat_mode)
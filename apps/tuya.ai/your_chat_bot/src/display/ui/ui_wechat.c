@@ -32,6 +32,9 @@
 #define STREAM_TEXT_SHOW_WORD_NUM 5
 #define ONE_WORD_MAX_LEN          4
 
+// appended text goes to a new label past this many bytes, so only a short label is laid out again
+#define LABEL_TEXT_SPLIT_LEN 256
+
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
@@ -49,6 +52,11 @@ typedef struct {
     lv_obj_t *network_label;
     lv_obj_t *notification_label;
     lv_obj_t *mute_label;
+
+    // last assistant message, text is appended to it
+    lv_obj_t *ai_msg_cont;
+    lv_obj_t *ai_text_cont;
+    lv_obj_t *ai_label;
 } APP_UI_T;
 
 typedef struct {
@@ -58,6 +66,7 @@ typedef struct {
 
     lv_obj_t *msg_cont;
     lv_obj_t *bubble;
+    lv_obj_t *text_cont;
     lv_obj_t *label;
 
     lv_timer_t *timer;
@@ -123,6 +132,73 @@ static void __ui_styles_init(void)
     lv_style_set_shadow_color(&sg_ui.ui.style_user_bubble, lv_palette_darken(LV_PALETTE_GREEN, 2));
 }
 
+static bool __ui_text_at_break(const char *text, uint32_t len)
+{
+    static const char *cjk_breaks[] = {"\xE3\x80\x82", "\xEF\xBC\x8C", "\xEF\xBC\x81", "\xEF\xBC\x9F", "\xEF\xBC\x9B"};
+    char last = text[len - 1];
+
+    if (' ' == last || '\n' == last || '.' == last || ',' == last || '!' == last || '?' == last || ';' == last) {
+        return true;
+    }
+
+    if (len < 3) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < sizeof(cjk_breaks) / sizeof(cjk_breaks[0]); i++) {
+        if (0 == memcmp(&text[len - 3], cjk_breaks[i], 3)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static lv_obj_t *__ui_text_label_create(lv_obj_t *text_cont)
+{
+    lv_obj_t *label = lv_label_create(text_cont);
+    lv_label_set_text(label, "");
+    lv_obj_set_width(label, LV_PCT(100));
+    lv_label_set_long_mode(label, LV_LABEL_LONG_WRAP);
+
+    return label;
+}
+
+/**
+ * @brief Append text to a message, a full label is left as is and a new one
+ *        started after a sentence or word end, or at twice the split length
+ */
+static void __ui_text_append(lv_obj_t *text_cont, lv_obj_t **label, const char *text)
+{
+    const char *cur = lv_label_get_text(*label);
+    uint32_t cur_len = strlen(cur);
+
+    if (cur_len >= LABEL_TEXT_SPLIT_LEN &&
+        (cur_len >= 2 * LABEL_TEXT_SPLIT_LEN || __ui_text_at_break(cur, cur_len))) {
+        *label = __ui_text_label_create(text_cont);
+    }
+
+    lv_label_ins_text(*label, LV_LABEL_POS_LAST, text);
+}
+
+static void __ui_msg_scroll_to_end(lv_obj_t *msg_cont)
+{
+    lv_coord_t content_height = lv_obj_get_height(msg_cont);
+    lv_coord_t height = lv_obj_get_height(sg_ui.ui.content);
+
+    if (content_height > height) {
+        lv_coord_t offset = 0;
+        offset = lv_obj_get_scroll_bottom(sg_ui.ui.content);
+        if (offset > 0) {
+            lv_obj_scroll_by_bounded(sg_ui.ui.content, 0, -offset, LV_ANIM_OFF);
+        }
+    } else {
+        lv_obj_scroll_to_view_recursive(msg_cont, LV_ANIM_OFF);
+    }
+
+    lv_obj_update_layout(sg_ui.ui.content);
+}
+
 static void __ui_notification_timeout_cb(lv_timer_t *timer)
 {
     lv_timer_del(sg_ui.notification_tm);
@@ -225,6 +301,10 @@ void ui_set_user_msg(const char *text)
     lv_obj_set_style_pad_ver(msg_cont, 6, 0);
     lv_obj_set_style_pad_column(msg_cont, 10, 0);
 
+    sg_ui.ui.ai_msg_cont = NULL;
+    sg_ui.ui.ai_text_cont = NULL;
+    sg_ui.ui.ai_label = NULL;
+
     lv_obj_t *avatar = lv_obj_create(msg_cont);
     lv_obj_set_style_text_font(avatar, sg_ui.font.icon, 0);
     lv_obj_add_style(avatar, &sg_ui.ui.style_avatar, 0);
@@ -303,15 +383,30 @@ void ui_set_assistant_msg(const char *text)
     lv_obj_set_size(text_cont, LV_PCT(100), LV_SIZE_CONTENT);
     lv_obj_set_flex_flow(text_cont, LV_FLEX_FLOW_COLUMN);
 
-    lv_obj_t *label = lv_label_create(text_cont);
-    lv_label_set_text(label, text);
-    lv_obj_set_width(label, LV_PCT(100));
-    lv_label_set_long_mode(label, LV_LABEL_LONG_WRAP);
+    sg_ui.ui.ai_msg_cont = msg_cont;
+    sg_ui.ui.ai_text_cont = text_cont;
+    sg_ui.ui.ai_label = __ui_text_label_create(text_cont);
+    __ui_text_append(text_cont, &sg_ui.ui.ai_label, text ? text : "");
 
     lv_obj_scroll_to_view_recursive(msg_cont, LV_ANIM_ON);
     lv_obj_update_layout(sg_ui.ui.content);
 }
 
+void ui_append_assistant_msg(const char *text)
+{
+    if (sg_ui.ui.content == NULL || text == NULL) {
+        return;
+    }
+
+    if (NULL == sg_ui.ui.ai_label) {
+        ui_set_assistant_msg(text);
+        return;
+    }
+
+    __ui_text_append(sg_ui.ui.ai_text_cont, &sg_ui.ui.ai_label, text);
+    __ui_msg_scroll_to_end(sg_ui.ui.ai_msg_cont);
+}
+
 static uint8_t __get_one_word_from_stream_ringbuff(APP_UI_STREAM_T *stream, char *result)
 {
     uint32_t rb_used_size = 0, read_len = 0;
@@ -396,22 +491,8 @@ static void __stream_timer_cb(lv_timer_t *lv_timer)
         return;
     }
 
-    lv_label_ins_text(stream->label, LV_LABEL_POS_LAST, text);
-
-    lv_coord_t content_height = lv_obj_get_height(stream->msg_cont);
-    lv_coord_t height = lv_obj_get_height(sg_ui.ui.content);
-
-    if (content_height > height) {
-        lv_coord_t offset = 0;
-        offset = lv_obj_get_scroll_bottom(sg_ui.ui.content);
-        if (offset > 0) {
-            lv_obj_scroll_by_bounded(sg_ui.ui.content, 0, -offset, LV_ANIM_OFF);
-        }
-    } else {
-        lv_obj_scroll_to_view_recursive(stream->msg_cont, LV_ANIM_OFF);
-    }
-
-    lv_obj_update_layout(sg_ui.ui.content);
+    __ui_text_append(stream->text_cont, &stream->label, text);
+    __ui_msg_scroll_to_end(stream->msg_cont);
 }
 
 void ui_set_assistant_msg_stream_start(void)
@@ -440,6 +521,10 @@ void ui_set_assistant_msg_stream_start(void)
     lv_obj_set_style_pad_ver(sg_ui.stream.msg_cont, 6, 0);
     lv_obj_set_style_pad_column(sg_ui.stream.msg_cont, 10, 0);
 
+    sg_ui.ui.ai_msg_cont = NULL;
+    sg_ui.ui.ai_text_cont = NULL;
+    sg_ui.ui.ai_label = NULL;
+
     lv_obj_t *avatar = lv_obj_create(sg_ui.stream.msg_cont);
     lv_obj_set_style_text_font(avatar, sg_ui.font.icon, 0);
     lv_obj_add_style(avatar, &sg_ui.ui.style_avatar, 0);
@@ -459,15 +544,12 @@ void ui_set_assistant_msg_stream_start(void)
     lv_obj_set_scrollbar_mode(sg_ui.stream.bubble, LV_SCROLLBAR_MODE_OFF);
     lv_obj_set_scroll_dir(sg_ui.stream.bubble, LV_DIR_VER);
 
-    lv_obj_t *text_cont = lv_obj_create(sg_ui.stream.bubble);
-    lv_obj_remove_style_all(text_cont);
-    lv_obj_set_size(text_cont, LV_PCT(100), LV_SIZE_CONTENT);
-    lv_obj_set_flex_flow(text_cont, LV_FLEX_FLOW_COLUMN);
+    sg_ui.stream.text_cont = lv_obj_create(sg_ui.stream.bubble);
+    lv_obj_remove_style_all(sg_ui.stream.text_cont);
+    lv_obj_set_size(sg_ui.stream.text_cont, LV_PCT(100), LV_SIZE_CONTENT);
+    lv_obj_set_flex_flow(sg_ui.stream.text_cont, LV_FLEX_FLOW_COLUMN);
 
-    sg_ui.stream.label = lv_label_create(text_cont);
-    lv_label_set_text(sg_ui.stream.label, "");
-    lv_obj_set_width(sg_ui.stream.label, LV_PCT(100));
-    lv_label_set_long_mode(sg_ui.stream.label, LV_LABEL_LONG_WRAP);
+    sg_ui.stream.label = __ui_text_label_create(sg_ui.stream.text_cont);
 
     OPERATE_RET rt = OPRT_OK;
     if (NULL == sg_ui.stream.text_ringbuff) {
@@ -479,7 +561,7 @@ void ui_set_assistant_msg_stream_start(void)
 
     tuya_ring_buff_reset(sg_ui.stream.text_ringbuff);
 
-    if (sg_ui.stream.rb_mutex) {
+    if (NULL == sg_ui.stream.rb_mutex) {
         rt = tkl_mutex_create_init(&sg_ui.stream.rb_mutex);
         if (rt != OPRT_OK) {
             return;
@@ -22,28 +22,41 @@
 #include "ui_weather_clock.h"
 
 #include "tal_log.h"
-#include "tal_queue.h"
 #include "tal_thread.h"
 
-#include "tkl_memory.h"
-
 #include "lvgl.h"
 
+#include "ai_msg_chan.h"
+
+#if defined(ENABLE_FONT_PACK) && (ENABLE_FONT_PACK == 1)
+#include "ai_font_pack.h"
+#endif
+
+#if defined(ENABLE_ASSET_PACK) && (ENABLE_ASSET_PACK == 1)
+#include "ai_asset_pack.h"
+#endif
+
 /***********************************************************
 ************************macro define************************
 ***********************************************************/
+// bytes of the message ring, short text and status messages are stored in it
+#ifndef APP_DISPLAY_CHAN_SIZE
+#define APP_DISPLAY_CHAN_SIZE 4096
+#endif
+
+// messages only the latest pending one of is shown
+#define APP_DISPLAY_LATEST_ONLY                                                                                        \
+    (AI_MSG_CHAN_LATEST(TY_DISPLAY_TP_EMOTION) | AI_MSG_CHAN_LATEST(TY_DISPLAY_TP_STATUS) |                            \
+     AI_MSG_CHAN_LATEST(TY_DISPLAY_TP_NOTIFICATION) | AI_MSG_CHAN_LATEST(TY_DISPLAY_TP_NETWORK) |                      \
+     AI_MSG_CHAN_LATEST(TY_DISPLAY_TP_CHAT_MODE) |                                                                     \
+     AI_MSG_CHAN_LATEST(TY_DISPLAY_TP_WEATHER_CLOCK_UPDATE_WEATHER) |                                                  \
+     AI_MSG_CHAN_LATEST(TY_DISPLAY_TP_WEATHER_CLOCK_UPDATE_TIME))
 
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
 typedef struct {
-    TY_DISPLAY_TYPE_E type;
-    int len;
-    char *data;
-} DISPLAY_MSG_T;
-
-typedef struct {
-    QUEUE_HANDLE queue_hdl;
+    AI_MSG_CHAN_HANDLE msg_chan;
     THREAD_HANDLE thrd_hdl;
 
     UI_FONT_T ui_font;
@@ -52,10 +65,15 @@ typedef struct {
 /***********************************************************
 ********************function declaration********************
 ***********************************************************/
+#if defined(ENABLE_FONT_PACK) && (ENABLE_FONT_PACK == 1)
+#define UI_TEXT_FONT(name) __get_pack_font(#name)
+#else
 LV_FONT_DECLARE(font_puhui_14_1);
 LV_FONT_DECLARE(font_puhui_18_2);
 LV_FONT_DECLARE(font_puhui_20_4);
 LV_FONT_DECLARE(font_puhui_30_4);
+#define UI_TEXT_FONT(name) &name
+#endif
 LV_FONT_DECLARE(font_awesome_14_1);
 LV_FONT_DECLARE(font_awesome_16_4);
 LV_FONT_DECLARE(font_awesome_20_4);
@@ -88,6 +106,20 @@ static TUYA_DISPLAY_T sg_display = {0};
 ***********************function define**********************
 ***********************************************************/
 
+#if defined(ENABLE_FONT_PACK) && (ENABLE_FONT_PACK == 1)
+static const lv_font_t *__get_pack_font(const char *name)
+{
+    const lv_font_t *font = ai_font_pack_get(name);
+
+    if (NULL == font) {
+        PR_ERR("font %s not in font pack", name);
+        return LV_FONT_DEFAULT;
+    }
+
+    return font;
+}
+#endif
+
 static OPERATE_RET __get_ui_font(UI_FONT_T *ui_font)
 {
     OPERATE_RET rt = OPRT_OK;
@@ -96,38 +128,44 @@ static OPERATE_RET __get_ui_font(UI_FONT_T *ui_font)
         return OPRT_INVALID_PARM;
     }
 
+#if defined(ENABLE_FONT_PACK) && (ENABLE_FONT_PACK == 1)
+    if (OPRT_OK != ai_font_pack_init()) {
+        PR_ERR("font pack not loaded, text uses the default font");
+    }
+#endif
+
 #if (defined(BOARD_CHOICE_TUYA_T5AI_BOARD) || defined(BOARD_CHOICE_TUYA_T5AI_EVB)|| defined(BOARD_CHOICE_TUYA_T5AI_CORE) ||                                   \
      defined(BOARD_CHOICE_T5AI_MOJI_1_28) || defined(BOARD_CHOICE_T5AI_MINI) || defined(BOARD_CHOICE_DNESP32S3_BOX) || \
      defined(BOARD_CHOICE_DNESP32S3_BOX2_WIFI)) ||                                                                     \
     defined(BOARD_CHOICE_WAVESHARE_T5AI_TOUCH_AMOLED_1_75)
 #if defined(ENABLE_GUI_WECHAT)
-    ui_font->text = (lv_font_t *)&font_puhui_18_2;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_18_2);
     ui_font->icon = (lv_font_t *)&font_awesome_16_4;
     ui_font->emoji = (lv_font_t *)font_emoji_32_init();
     ui_font->emoji_list = sg_emo_list;
 #elif defined(ENABLE_GUI_CHATBOT)
-    ui_font->text = (lv_font_t *)&font_puhui_18_2;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_18_2);
     ui_font->icon = (lv_font_t *)&font_awesome_16_4;
     ui_font->emoji = (lv_font_t *)font_emoji_64_init();
     ui_font->emoji_list = sg_emo_list;
 #elif defined(ENABLE_GUI_EMOJI)
-    ui_font->text = (lv_font_t *)&font_puhui_18_2;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_18_2);
     ui_font->icon = (lv_font_t *)&font_awesome_16_4;
     ui_font->emoji = (lv_font_t *)font_emoji_64_init();
     ui_font->emoji_list = sg_emo_list;
 #endif
 #elif defined(BOARD_CHOICE_BREAD_COMPACT_WIFI)
-    ui_font->text = (lv_font_t *)&font_puhui_14_1;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_14_1);
     ui_font->icon = (lv_font_t *)&font_awesome_14_1;
     ui_font->emoji = (lv_font_t *)&font_awesome_30_1;
     ui_font->emoji_list = sg_awesome_emo_list;
 #elif defined(BOARD_CHOICE_XINGZHI_CUBE_0_96_OLED_WIFI)
-    ui_font->text = (lv_font_t *)&font_puhui_14_1;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_14_1);
     ui_font->icon = (lv_font_t *)&font_awesome_14_1;
     ui_font->emoji = (lv_font_t *)&font_awesome_30_1;
     ui_font->emoji_list = sg_awesome_emo_list;
 #elif defined(BOARD_CHOICE_WAVESHARE_ESP32_S3_TOUCH_AMOLED_1_8)
-    ui_font->text = (lv_font_t *)&font_puhui_30_4;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_30_4);
     ui_font->icon = (lv_font_t *)&font_awesome_30_4;
 #if defined(ENABLE_GUI_WECHAT)
     ui_font->emoji = font_emoji_32_init();
@@ -136,7 +174,7 @@ static OPERATE_RET __get_ui_font(UI_FONT_T *ui_font)
 #endif
     ui_font->emoji_list = sg_emo_list;
 #elif defined(BOARD_CHOICE_DNESP32S3)
-    ui_font->text = (lv_font_t *)&font_puhui_20_4;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_20_4);
     ui_font->icon = (lv_font_t *)&font_awesome_20_4;
 #if defined(ENABLE_GUI_WECHAT)
     ui_font->emoji = font_emoji_32_init();
@@ -176,7 +214,7 @@ static char *__ui_wifi_icon_get(UI_WIFI_STATUS_E status)
     return wifi_icon;
 }
 
-static void __app_display_msg_handle(DISPLAY_MSG_T *msg_data)
+static void __app_display_msg_handle(AI_MSG_CHAN_MSG_T *msg_data)
 {
     if (msg_data == NULL) {
         return;
@@ -302,11 +340,16 @@ static void __app_display_msg_handle(DISPLAY_MSG_T *msg_data)
 static void __chat_bot_ui_task(void *args)
 {
     OPERATE_RET rt = OPRT_OK;
-    DISPLAY_MSG_T msg_data = {0};
+    AI_MSG_CHAN_MSG_T msg_data = {0};
 
     (void)args;
 
     tuya_lvgl_mutex_lock();
+#if defined(ENABLE_ASSET_PACK) && (ENABLE_ASSET_PACK == 1)
+    if (OPRT_OK != ai_asset_pack_init()) {
+        PR_ERR("asset pack not loaded, emoji and weather icons are not shown");
+    }
+#endif
     // Initialize the display font
     TUYA_CALL_ERR_LOG(__get_ui_font(&sg_display.ui_font));
     // ui initialization
@@ -327,15 +370,13 @@ static void __chat_bot_ui_task(void *args)
     PR_DEBUG("ui init success");
 
     for (;;) {
-        memset(&msg_data, 0, sizeof(DISPLAY_MSG_T));
-        tal_queue_fetch(sg_display.queue_hdl, &msg_data, 0xFFFFFFFF);
+        if (OPRT_OK != ai_msg_chan_fetch(sg_display.msg_chan, &msg_data, 0xFFFFFFFF)) {
+            continue;
+        }
 
         __app_display_msg_handle(&msg_data);
 
-        if (msg_data.data) {
-            tkl_system_psram_free(msg_data.data);
-        }
-        msg_data.data = NULL;
+        ai_msg_chan_release(sg_display.msg_chan, &msg_data);
     }
 }
 
@@ -355,7 +396,7 @@ OPERATE_RET app_display_init(void)
     TUYA_CALL_ERR_RETURN(tuya_lvgl_init());
     PR_DEBUG("lvgl init success");
 
-    TUYA_CALL_ERR_RETURN(tal_queue_create_init(&sg_display.queue_hdl, sizeof(DISPLAY_MSG_T), 8));
+    TUYA_CALL_ERR_RETURN(ai_msg_chan_create(APP_DISPLAY_CHAN_SIZE, APP_DISPLAY_LATEST_ONLY, &sg_display.msg_chan));
     THREAD_CFG_T cfg = {
         .thrdname = "chat_ui",
         .priority = THREAD_PRIO_2,
@@ -377,22 +418,5 @@ OPERATE_RET app_display_init(void)
  */
 OPERATE_RET app_display_send_msg(TY_DISPLAY_TYPE_E tp, uint8_t *data, int len)
 {
-    DISPLAY_MSG_T msg_data;
-
-    msg_data.type = tp;
-    msg_data.len = len;
-    if (len && data != NULL) {
-        msg_data.data = (char *)tkl_system_psram_malloc(len + 1);
-        if (NULL == msg_data.data) {
-            return OPRT_MALLOC_FAILED;
-        }
-        memcpy(msg_data.data, data, len);
-        msg_data.data[len] = 0; //"\0"
-    } else {
-        msg_data.data = NULL;
-    }
-
-    tal_queue_post(sg_display.queue_hdl, &msg_data, 0xFFFFFFFF);
-
-    return OPRT_OK;
+    return ai_msg_chan_post(sg_display.msg_chan, tp, data, len, 0xFFFFFFFF);
 }
\ No newline at end of file
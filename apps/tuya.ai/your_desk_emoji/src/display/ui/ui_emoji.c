@@ -4,8 +4,13 @@
 
 #include "ui_display.h"
 #include "lvgl.h"
+#include "lv_port_anim.h"
 #include "tal_log.h"
 
+#if defined(ENABLE_ASSET_PACK) && (ENABLE_ASSET_PACK == 1)
+#include "ai_asset_pack.h"
+#endif
+
 typedef struct {
     const void  *data;
     const char  *text;
@@ -18,11 +23,20 @@ static uint8_t s_current_index = 0; // Current expression index
 static bool s_auto_cycle = true; // Auto cycle through expressions
 static uint8_t s_rotation_count = 0; // Count of rotations completed
 static uint8_t s_total_emotions = 0; // Total number of emotions
+#if defined(ENABLE_ASSET_PACK) && (ENABLE_ASSET_PACK == 1)
+static const lv_image_dsc_t *s_gif_asset = NULL; // Asset shown, held until the next one is set
+#endif
 
 #define EMMO_GIF_W           160
 #define EMMO_GIF_H           80
 #define EMMO_CHANGE_INTERVAL (5*1000) // Expression switching interval (5 seconds)
 
+#if defined(ENABLE_ASSET_PACK) && (ENABLE_ASSET_PACK == 1)
+// Animations are loaded from the asset pack by name
+#define EMOTION_SRC(name) NULL
+#else
+#define EMOTION_SRC(name) (&name)
+
 // Declare all emoji GIF animations (optimized, faster animations + fun expressions)
 LV_IMG_DECLARE(happy);
 LV_IMG_DECLARE(sad);
@@ -39,6 +53,7 @@ LV_IMG_DECLARE(heart_eyes);
 LV_IMG_DECLARE(rolling);
 LV_IMG_DECLARE(zigzag);
 LV_IMG_DECLARE(rainbow);
+#endif
 
 /* Desk-Emoji inspired expressions converted to LVGL GIF animations
    Based on geometric eye system with various emotional states
@@ -46,21 +61,21 @@ LV_IMG_DECLARE(rainbow);
    Includes 5 fun new expressions for enhanced interactivity */
 static const gif_emotion_t gif_emotion[] = {
     // Basic emotions
-    {&happy,    "happy" },
-    {&sad,      "sad" },
-    {&anger,    "anger" },
-    {&surprise, "surprise" },
-    {&sleep,    "sleep" },
-    {&wakeup,   "wakeup" },
-    {&left,     "left" },
-    {&right,    "right" },
-    {&center,   "center" },
+    {EMOTION_SRC(happy),    "happy" },
+    {EMOTION_SRC(sad),      "sad" },
+    {EMOTION_SRC(anger),    "anger" },
+    {EMOTION_SRC(surprise), "surprise" },
+    {EMOTION_SRC(sleep),    "sleep" },
+    {EMOTION_SRC(wakeup),   "wakeup" },
+    {EMOTION_SRC(left),     "left" },
+    {EMOTION_SRC(right),    "right" },
+    {EMOTION_SRC(center),   "center" },
     // Fun expressions
-    {&wink,     "wink" },
-    {&heart_eyes, "heart_eyes" },
-    {&rolling,  "rolling" },
-    {&zigzag,   "zigzag" },
-    {&rainbow,  "rainbow" },
+    {EMOTION_SRC(wink),     "wink" },
+    {EMOTION_SRC(heart_eyes), "heart_eyes" },
+    {EMOTION_SRC(rolling),  "rolling" },
+    {EMOTION_SRC(zigzag),   "zigzag" },
+    {EMOTION_SRC(rainbow),  "rainbow" },
 };
 
 // Cloud emotion to local emotion mapping
@@ -124,6 +139,23 @@ static uint8_t __emotion_get(char *emotion)
     return which;
 }
 
+static void __emotion_show(uint8_t index)
+{
+#if defined(ENABLE_ASSET_PACK) && (ENABLE_ASSET_PACK == 1)
+    const lv_image_dsc_t *img = ai_asset_pack_get(gif_emotion[index].text);
+    if (NULL == img) {
+        PR_ERR("emotion '%s' not in asset pack", gif_emotion[index].text);
+        return;
+    }
+
+    lv_port_anim_set_src(s_gif, img);
+    ai_asset_pack_put(s_gif_asset);
+    s_gif_asset = img;
+#else
+    lv_port_anim_set_src(s_gif, gif_emotion[index].data);
+#endif
+}
+
 static void __emotion_flush(char *emotion)
 {
     uint8_t index = 0;
@@ -142,7 +174,7 @@ static void __emotion_flush(char *emotion)
     PR_DEBUG("Set s_current_index to %d, s_auto_cycle to true, s_rotation_count to 0", s_current_index);
     
     if (s_gif != NULL) {
-        lv_gif_set_src(s_gif, gif_emotion[index].data);
+        __emotion_show(index);
         PR_DEBUG("Set GIF source to emotion data at index %d", index);
     } else {
         PR_ERR("s_gif is NULL, cannot set emotion!");
@@ -186,7 +218,7 @@ static void __emotion_timer_cb(lv_timer_t *timer)
         
         // Switch to next expression
         s_current_index = (s_current_index + 1) % s_total_emotions;
-        lv_gif_set_src(s_gif, gif_emotion[s_current_index].data);
+        __emotion_show(s_current_index);
         PR_DEBUG("Emoji rotated to index %d: %s", s_current_index, gif_emotion[s_current_index].text);
     }
 }
@@ -206,7 +238,7 @@ int ui_init(UI_FONT_T *ui_font)
     lv_obj_set_style_border_width(s_container, 0, 0);
     PR_DEBUG("Created emoji container object: %p", s_container);
 
-    s_gif = lv_gif_create(s_container);
+    s_gif = lv_port_anim_create(s_container);
     lv_obj_set_size(s_gif, EMMO_GIF_W, EMMO_GIF_H);
     PR_DEBUG("Created GIF object: %p", s_gif);
 
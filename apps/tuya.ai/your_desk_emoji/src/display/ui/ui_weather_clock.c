@@ -26,6 +26,12 @@
 #include <stdio.h>
 #include <stdint.h>
 
+#if defined(ENABLE_ASSET_PACK) && (ENABLE_ASSET_PACK == 1)
+#include "ai_asset_pack.h"
+
+/* Weather icons are drawn from the asset pack by name */
+#define WEATHER_ICON(name) AI_ASSET_PATH(#name)
+#else
 /* Include weather icon data */
 #include "weather_icon/sun_120.c"
 #include "weather_icon/cloudy_129.c"
@@ -36,6 +42,9 @@
 #include "weather_icon/thundershower_143.c"
 #include "weather_icon/windy_114.c"
 
+#define WEATHER_ICON(name) (&name)
+#endif
+
 /***********************************************************
 ***********************macro / helpers**********************
 ***********************************************************/
@@ -69,11 +78,11 @@ static WEATHER_CLOCK_T sg_weather_clock = {0};
 ***********************************************************/
 
 /**
- * @brief Get weather icon descriptor based on weather icon string
+ * @brief Get weather icon image source based on weather icon string
  * @param weather_icon Weather icon string (e.g., "120", "112", etc.)
- * @return Pointer to lv_image_dsc_t or NULL if not found
+ * @return Image source for lv_image_set_src or NULL if not found
  */
-static const lv_image_dsc_t* __get_weather_icon_descriptor(const char *weather_icon)
+static const void* __get_weather_icon_descriptor(const char *weather_icon)
 {
     if (weather_icon == NULL) {
         return NULL;
@@ -82,26 +91,26 @@ static const lv_image_dsc_t* __get_weather_icon_descriptor(const char *weather_i
     // Map weather icon strings to their corresponding descriptors
     // Note: Generated C files use img_[name] format for descriptors
     if (strcmp(weather_icon, "120" ) == 0 || strcmp(weather_icon, "119") == 0) {//sun_120
-        return &img_sun_120;
+        return WEATHER_ICON(img_sun_120);
     } else if (strcmp(weather_icon, "129") == 0 || strcmp(weather_icon, "142") == 0 || strcmp(weather_icon, "132") == 0) { //cloudy_129
-        return &img_cloudy_129;
+        return WEATHER_ICON(img_cloudy_129);
     } else if (strcmp(weather_icon, "112") == 0 || strcmp(weather_icon, "101") == 0 || strcmp(weather_icon, "107") == 0 || strcmp(weather_icon, "108") == 0) {
-        return &img_rain_112;
+        return WEATHER_ICON(img_rain_112);
     } else if (strcmp(weather_icon, "139") == 0 ) {//small_rain_139
-        return &img_small_rain_139;
+        return WEATHER_ICON(img_small_rain_139);
     } else if (strcmp(weather_icon, "105") == 0 || strcmp(weather_icon, "104") == 0 || strcmp(weather_icon, "115") == 0 || strcmp(weather_icon, "124") == 0 || strcmp(weather_icon, "126") == 0) {//snow_105
-        return &img_snow_105;
+        return WEATHER_ICON(img_snow_105);
     } else if (strcmp(weather_icon, "110") == 0 || strcmp(weather_icon, "138") == 0) {//thunder_110
-        return &img_thunder_110;
+        return WEATHER_ICON(img_thunder_110);
     } else if (strcmp(weather_icon, "143") == 0 || strcmp(weather_icon, "102") == 0) {//thundershower_143
-        return &img_thundershower_143;
+        return WEATHER_ICON(img_thundershower_143);
     } else if (strcmp(weather_icon, "114") == 0 ) {//windy_114
-        return &img_windy_114;
+        return WEATHER_ICON(img_windy_114);
     }
     
     // Default to sun icon if no match found
     PR_DEBUG("Unknown weather icon '%s', using default sun icon", weather_icon);
-    return &img_sun_120;
+    return WEATHER_ICON(img_sun_120);
 }
 
 
@@ -634,7 +643,7 @@ void ui_weather_clock_update_weather_icon_display(const char *weather_icon)
     if (weather_icon != NULL && strlen(weather_icon) > 0) {
         // Get the appropriate icon descriptor based on weather_icon string
         PR_DEBUG("Weather icon displayed: %s", weather_icon);
-        const lv_image_dsc_t *icon_dsc = __get_weather_icon_descriptor(weather_icon);
+        const void *icon_dsc = __get_weather_icon_descriptor(weather_icon);
         
         if (icon_dsc != NULL) {
             // Apply the icon descriptor to the image widget
@@ -41,6 +41,10 @@
 #include "app_weather.h"
 #endif
 
+#if defined(ENABLE_ASSET_PACK) && (ENABLE_ASSET_PACK == 1)
+#include "ai_asset_pack.h"
+#endif
+
 #include "board_com_api.h"
 
 #include "app_chat_bot.h"
@@ -455,6 +459,9 @@ void user_main(void)
                                         // .firmware_key      = TUYA_DEVICE_FIRMWAREKEY,
                                         .event_handler = user_event_handler_on,
                                         .network_check = user_network_check,
+#if defined(ENABLE_ASSET_PACK) && (ENABLE_ASSET_PACK == 1)
+                                        .ota_handler = ai_asset_pack_ota_handler,
+#endif
                                     });
     assert(ret == OPRT_OK);
 
@@ -28,6 +28,10 @@
 
 #include "lvgl.h"
 
+#if defined(ENABLE_FONT_PACK) && (ENABLE_FONT_PACK == 1)
+#include "ai_font_pack.h"
+#endif
+
 /***********************************************************
 ************************macro define************************
 ***********************************************************/
@@ -51,10 +55,15 @@ typedef struct {
 /***********************************************************
 ********************function declaration********************
 ***********************************************************/
+#if defined(ENABLE_FONT_PACK) && (ENABLE_FONT_PACK == 1)
+#define UI_TEXT_FONT(name) __get_pack_font(#name)
+#else
 LV_FONT_DECLARE(font_puhui_14_1);
 LV_FONT_DECLARE(font_puhui_18_2);
 LV_FONT_DECLARE(font_puhui_20_4);
 LV_FONT_DECLARE(font_puhui_30_4);
+#define UI_TEXT_FONT(name) &name
+#endif
 LV_FONT_DECLARE(font_awesome_14_1);
 LV_FONT_DECLARE(font_awesome_16_4);
 LV_FONT_DECLARE(font_awesome_20_4);
@@ -87,6 +96,20 @@ static TUYA_DISPLAY_T sg_display = {0};
 ***********************function define**********************
 ***********************************************************/
 
+#if defined(ENABLE_FONT_PACK) && (ENABLE_FONT_PACK == 1)
+static const lv_font_t *__get_pack_font(const char *name)
+{
+    const lv_font_t *font = ai_font_pack_get(name);
+
+    if (NULL == font) {
+        PR_ERR("font %s not in font pack", name);
+        return LV_FONT_DEFAULT;
+    }
+
+    return font;
+}
+#endif
+
 static OPERATE_RET __get_ui_font(UI_FONT_T *ui_font)
 {
     OPERATE_RET rt = OPRT_OK;
@@ -95,37 +118,43 @@ static OPERATE_RET __get_ui_font(UI_FONT_T *ui_font)
         return OPRT_INVALID_PARM;
     }
 
+#if defined(ENABLE_FONT_PACK) && (ENABLE_FONT_PACK == 1)
+    if (OPRT_OK != ai_font_pack_init()) {
+        PR_ERR("font pack not loaded, text uses the default font");
+    }
+#endif
+
 #if (defined(BOARD_CHOICE_TUYA_T5AI_BOARD) || defined(BOARD_CHOICE_TUYA_T5AI_EVB) ||                                   \
      defined(BOARD_CHOICE_T5AI_MOJI_1_28) || defined(BOARD_CHOICE_T5AI_MINI) || defined(BOARD_CHOICE_DNESP32S3_BOX) || \
      defined(BOARD_CHOICE_DNESP32S3_BOX2_WIFI))
 #if defined(ENABLE_GUI_WECHAT)
-    ui_font->text = (lv_font_t *)&font_puhui_18_2;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_18_2);
     ui_font->icon = (lv_font_t *)&font_awesome_16_4;
     ui_font->emoji = (lv_font_t *)font_emoji_32_init();
     ui_font->emoji_list = sg_emo_list;
 #elif defined(ENABLE_GUI_CHATBOT)
-    ui_font->text = (lv_font_t *)&font_puhui_18_2;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_18_2);
     ui_font->icon = (lv_font_t *)&font_awesome_16_4;
     ui_font->emoji = (lv_font_t *)font_emoji_64_init();
     ui_font->emoji_list = sg_emo_list;
 #elif defined(ENABLE_GUI_LANDSCAPE)
-    ui_font->text = (lv_font_t *)&font_puhui_18_2;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_18_2);
     ui_font->icon = (lv_font_t *)&font_awesome_16_4;
     ui_font->emoji = (lv_font_t *)font_emoji_32_init();
     ui_font->emoji_list = sg_emo_list;
 #endif
 #elif defined(BOARD_CHOICE_BREAD_COMPACT_WIFI)
-    ui_font->text = (lv_font_t *)&font_puhui_14_1;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_14_1);
     ui_font->icon = (lv_font_t *)&font_awesome_14_1;
     ui_font->emoji = (lv_font_t *)&font_awesome_30_1;
     ui_font->emoji_list = sg_awesome_emo_list;
 #elif defined(BOARD_CHOICE_XINGZHI_CUBE_0_96_OLED_WIFI)
-    ui_font->text = (lv_font_t *)&font_puhui_14_1;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_14_1);
     ui_font->icon = (lv_font_t *)&font_awesome_14_1;
     ui_font->emoji = (lv_font_t *)&font_awesome_30_1;
     ui_font->emoji_list = sg_awesome_emo_list;
 #elif defined(BOARD_CHOICE_WAVESHARE_ESP32_S3_TOUCH_AMOLED_1_8)
-    ui_font->text = (lv_font_t *)&font_puhui_30_4;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_30_4);
     ui_font->icon = (lv_font_t *)&font_awesome_30_4;
 #if defined(ENABLE_GUI_WECHAT)
     ui_font->emoji = font_emoji_32_init();
@@ -134,7 +163,7 @@ static OPERATE_RET __get_ui_font(UI_FONT_T *ui_font)
 #endif
     ui_font->emoji_list = sg_emo_list;
 #elif defined(BOARD_CHOICE_DNESP32S3)
-    ui_font->text = (lv_font_t *)&font_puhui_20_4;
+    ui_font->text = (lv_font_t *)UI_TEXT_FONT(font_puhui_20_4);
     ui_font->icon = (lv_font_t *)&font_awesome_20_4;
 #if defined(ENABLE_GUI_WECHAT)
     ui_font->emoji = font_emoji_32_init();
@@ -130,6 +130,7 @@ void oscillator_detach(int idx)
 
     tkl_pwm_stop(osc->pwm_channel);
     osc->is_attached = false;
+    osc->is_running = false;
 }
 
 void oscillator_set_t(int idx, unsigned int T)
@@ -250,15 +251,15 @@ void oscillator_refresh(int idx)
     }
 }
 
-void oscillator_write(int idx, int position)
+uint32_t oscillator_update(int idx, int position)
 {
     if (idx < 0 || idx >= g_oscillator_count)
-        return;
+        return 0;
 
     Oscillator_t *osc = &g_oscillators[idx];
 
     if (!osc->is_attached)
-        return;
+        return 0;
 
     unsigned long currentMillis = millis();
     if (osc->diff_limit > 0) {
@@ -277,16 +278,23 @@ void oscillator_write(int idx, int position)
 
     angle = MIN(MAX(angle, 0), 180);
 
-    // 计算占空比
-    uint32_t duty = (uint32_t)((0.5 + angle / 180.0 * 2.0) * 10000 / 20);
-    
-    // 计算占空比百分比 (duty/10000 * 100)
-    //float duty_percent = (float)duty / 100.0f;
-    
-    // 合并的占空比打印信息 - 显示百分比
-   // PR_DEBUG("oscillator_write: idx=%d, pin=%d, pwm_channel=%d, pos=%d->angle=%d(trim:%d), duty=%d, duty_percent=%.1f%%", 
-     //         idx, osc->pin, osc->pwm_channel, position, angle, osc->trim, duty, duty_percent);
-
-    tkl_pwm_duty_set(osc->pwm_channel, duty);
-    tkl_pwm_start(osc->pwm_channel);
-}
\ No newline at end of file
+    // 0.5ms..2.5ms of the 20ms period, in 1/10000
+    return (uint32_t)((500 + angle * 2000 / 180) / 2);
+}
+
+void oscillator_write(int idx, int position)
+{
+    if (idx < 0 || idx >= g_oscillator_count)
+        return;
+
+    Oscillator_t *osc = &g_oscillators[idx];
+
+    if (!osc->is_attached)
+        return;
+
+    tkl_pwm_duty_set(osc->pwm_channel, oscillator_update(idx, position));
+    if (!osc->is_running) {
+        tkl_pwm_start(osc->pwm_channel);
+        osc->is_running = true;
+    }
+}
@@ -75,6 +75,7 @@ typedef struct {
     unsigned long previous_servo_command_millis; /**< Previous servo command time */
 
     TUYA_PWM_NUM_E pwm_channel;     /**< PWM channel for servo control */
+    bool is_running;                /**< PWM output started since attach */
 } Oscillator_t;
 
 // Oscillator function declarations
@@ -220,4 +221,12 @@ bool oscillator_next_sample(int idx);
  */
 void oscillator_write(int idx, int position);
 
+/**
+ * @brief Move the servo state towards a position without driving the PWM
+ * @param idx Oscillator index
+ * @param position Position in degrees
+ * @return PWM duty for the new position, 0 if not attached
+ */
+uint32_t oscillator_update(int idx, int position);
+
 #endif  // __OSCILLATOR_H__ 
\ No newline at end of file
@@ -0,0 +1,349 @@
+/**
+ * @file otto_motion.c
+ * @brief Periodic motion engine driving all Otto servos
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include "tuya_cloud_types.h"
+#include "tal_api.h"
+#include "tkl_pwm.h"
+#include "oscillator.h"
+#include "otto_movements.h"
+#include "otto_motion.h"
+#include <math.h>
+#include <string.h>
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+// a keyframe keeps writing its target this long for the speed limiter to reach it
+#define OTTO_MOTION_SETTLE_MS 100
+
+// sine table over one turn, the last entry repeats the first for interpolation
+#define OTTO_MOTION_SIN_BITS 8
+#define OTTO_MOTION_SIN_SIZE (1 << OTTO_MOTION_SIN_BITS)
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef enum {
+    OTTO_MOTION_CMD_MOVE,
+    OTTO_MOTION_CMD_OSCILLATE,
+    OTTO_MOTION_CMD_HOLD,
+} OTTO_MOTION_CMD_TYPE_E;
+
+typedef struct {
+    uint8_t type;
+    uint32_t time; // ms
+    union {
+        int16_t target[SERVO_COUNT];
+        struct {
+            int16_t amplitude[SERVO_COUNT];
+            int16_t offset[SERVO_COUNT];
+            uint32_t phase0[SERVO_COUNT]; // fraction of a turn in 1/2^32
+            uint32_t period;
+        } osc;
+    } u;
+} OTTO_MOTION_CMD_T;
+
+typedef struct {
+    QUEUE_HANDLE queue;
+    MUTEX_HANDLE mutex;
+    THREAD_HANDLE thread;
+
+    // commands queued and played, idle when equal
+    volatile uint32_t queued;
+    volatile uint32_t done;
+
+    int plan[SERVO_COUNT];
+} OTTO_MOTION_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+extern Otto_t g_otto;
+extern Oscillator_t g_oscillators[MAX_OSCILLATORS];
+
+static OTTO_MOTION_T sg_motion;
+static int16_t sg_sin_q15[OTTO_MOTION_SIN_SIZE + 1];
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static uint32_t __motion_millis(void)
+{
+    return (uint32_t)tal_system_get_millisecond();
+}
+
+static int32_t __motion_sin_q15(uint32_t phase)
+{
+    uint32_t i = phase >> (32 - OTTO_MOTION_SIN_BITS);
+    int32_t frac = (int32_t)((phase >> (16 - OTTO_MOTION_SIN_BITS)) & 0xFFFF);
+    int32_t a = sg_sin_q15[i];
+    int32_t b = sg_sin_q15[i + 1];
+
+    return a + (((b - a) * frac) >> 16);
+}
+
+static uint32_t __motion_phase_from_rad(double rad)
+{
+    double turns = rad / (2 * M_PI);
+
+    turns -= floor(turns);
+    return (uint32_t)(turns * 4294967295.0);
+}
+
+static int __motion_osc_position(const OTTO_MOTION_CMD_T *cmd, int servo, uint32_t t)
+{
+    uint32_t phase = cmd->u.osc.phase0[servo] + (uint32_t)(((uint64_t)t << 32) / cmd->u.osc.period);
+    int pos = ((cmd->u.osc.amplitude[servo] * __motion_sin_q15(phase) + (1 << 14)) >> 15) + cmd->u.osc.offset[servo];
+    int idx = g_otto.oscillator_indices[servo];
+
+    if (idx != -1 && g_oscillators[idx].rev) {
+        pos = -pos;
+    }
+
+    return pos + 90;
+}
+
+static void __motion_output(const int pos[SERVO_COUNT])
+{
+    TUYA_PWM_NUM_E start[SERVO_COUNT];
+    uint8_t start_cnt = 0;
+
+    for (int i = 0; i < SERVO_COUNT; i++) {
+        int idx = g_otto.oscillator_indices[i];
+        if (idx == -1 || !g_oscillators[idx].is_attached) {
+            continue;
+        }
+
+        Oscillator_t *osc = &g_oscillators[idx];
+        tkl_pwm_duty_set(osc->pwm_channel, oscillator_update(idx, pos[i]));
+        if (!osc->is_running) {
+            start[start_cnt++] = osc->pwm_channel;
+            osc->is_running = true;
+        }
+    }
+
+    if (start_cnt) {
+        tkl_pwm_multichannel_start(start, start_cnt);
+    }
+}
+
+static bool __motion_reached(const OTTO_MOTION_CMD_T *cmd)
+{
+    for (int i = 0; i < SERVO_COUNT; i++) {
+        int idx = g_otto.oscillator_indices[i];
+        if (idx != -1 && oscillator_get_position(idx) != cmd->u.target[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void __motion_play(const OTTO_MOTION_CMD_T *cmd)
+{
+    int from[SERVO_COUNT];
+    int pos[SERVO_COUNT];
+
+    if (cmd->type == OTTO_MOTION_CMD_HOLD) {
+        tal_system_sleep(cmd->time);
+        return;
+    }
+
+    for (int i = 0; i < SERVO_COUNT; i++) {
+        int idx = g_otto.oscillator_indices[i];
+        from[i] = (idx != -1) ? oscillator_get_position(idx) : 90;
+    }
+
+    uint32_t start = __motion_millis();
+    uint32_t deadline = start;
+
+    for (;;) {
+        uint32_t elapsed = __motion_millis() - start;
+        uint32_t t = MIN(elapsed, cmd->time);
+        bool finish = (elapsed >= cmd->time);
+
+        for (int i = 0; i < SERVO_COUNT; i++) {
+            if (cmd->type == OTTO_MOTION_CMD_OSCILLATE) {
+                pos[i] = __motion_osc_position(cmd, i, t);
+            } else if (finish) {
+                pos[i] = cmd->u.target[i];
+            } else {
+                pos[i] = from[i] + (cmd->u.target[i] - from[i]) * (int)t / (int)cmd->time;
+            }
+        }
+        __motion_output(pos);
+
+        if (finish && cmd->type == OTTO_MOTION_CMD_MOVE) {
+            finish = __motion_reached(cmd) || elapsed >= cmd->time + OTTO_MOTION_SETTLE_MS;
+        }
+        if (finish) {
+            break;
+        }
+
+        // sleep to the next tick of the schedule, a late tick does not shift the ones after it
+        deadline += OTTO_MOTION_TICK_MS;
+        uint32_t now = __motion_millis();
+        if ((int32_t)(deadline - now) > 0) {
+            tal_system_sleep(deadline - now);
+        } else {
+            deadline = now;
+        }
+    }
+}
+
+static void __motion_task(void *arg)
+{
+    OTTO_MOTION_CMD_T cmd;
+
+    for (;;) {
+        if (OPRT_OK != tal_queue_fetch(sg_motion.queue, &cmd, 0xFFFFFFFF)) {
+            continue;
+        }
+
+        __motion_play(&cmd);
+        sg_motion.done++;
+    }
+}
+
+static OPERATE_RET __motion_post(OTTO_MOTION_CMD_T *cmd, const int plan[SERVO_COUNT])
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    if (NULL == sg_motion.queue) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    tal_mutex_lock(sg_motion.mutex);
+    rt = tal_queue_post(sg_motion.queue, cmd, 0xFFFFFFFF);
+    if (OPRT_OK == rt) {
+        sg_motion.queued++;
+        if (plan) {
+            memcpy(sg_motion.plan, plan, sizeof(sg_motion.plan));
+        }
+    }
+    tal_mutex_unlock(sg_motion.mutex);
+
+    if (OPRT_OK != rt) {
+        PR_ERR("otto motion post err:%d", rt);
+    }
+
+    return rt;
+}
+
+OPERATE_RET otto_motion_init(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    if (sg_motion.queue) {
+        return OPRT_OK;
+    }
+
+    for (int i = 0; i <= OTTO_MOTION_SIN_SIZE; i++) {
+        sg_sin_q15[i] = (int16_t)lround(32767.0 * sin(2 * M_PI * i / OTTO_MOTION_SIN_SIZE));
+    }
+
+    for (int i = 0; i < SERVO_COUNT; i++) {
+        int idx = g_otto.oscillator_indices[i];
+        sg_motion.plan[i] = (idx != -1) ? oscillator_get_position(idx) : 90;
+    }
+
+    TUYA_CALL_ERR_GOTO(tal_mutex_create_init(&sg_motion.mutex), __ERR);
+    TUYA_CALL_ERR_GOTO(tal_queue_create_init(&sg_motion.queue, sizeof(OTTO_MOTION_CMD_T), OTTO_MOTION_QUEUE_LEN),
+                       __ERR);
+
+    THREAD_CFG_T thrd_param = {
+        .thrdname = "otto_motion",
+        .priority = OTTO_MOTION_TASK_PRIORITY,
+        .stackDepth = OTTO_MOTION_TASK_SIZE,
+    };
+    TUYA_CALL_ERR_GOTO(
+        tal_thread_create_and_start(&sg_motion.thread, NULL, NULL, __motion_task, NULL, &thrd_param), __ERR);
+
+    return OPRT_OK;
+
+__ERR:
+    if (sg_motion.queue) {
+        tal_queue_free(sg_motion.queue);
+        sg_motion.queue = NULL;
+    }
+    if (sg_motion.mutex) {
+        tal_mutex_release(sg_motion.mutex);
+        sg_motion.mutex = NULL;
+    }
+
+    return rt;
+}
+
+OPERATE_RET otto_motion_move(int time, int servo_target[SERVO_COUNT])
+{
+    OTTO_MOTION_CMD_T cmd = {.type = OTTO_MOTION_CMD_MOVE, .time = (uint32_t)MAX(time, 0)};
+    int plan[SERVO_COUNT];
+
+    for (int i = 0; i < SERVO_COUNT; i++) {
+        cmd.u.target[i] = (int16_t)servo_target[i];
+        plan[i] = servo_target[i];
+    }
+
+    return __motion_post(&cmd, plan);
+}
+
+OPERATE_RET otto_motion_oscillate(int amplitude[SERVO_COUNT], int offset[SERVO_COUNT], int period,
+                                  double phase_diff[SERVO_COUNT], float cycles)
+{
+    OTTO_MOTION_CMD_T cmd = {.type = OTTO_MOTION_CMD_OSCILLATE};
+    int plan[SERVO_COUNT];
+
+    if (period <= 0 || cycles < 0) {
+        return OPRT_INVALID_PARM;
+    }
+
+    cmd.time = (uint32_t)(period * cycles);
+    cmd.u.osc.period = (uint32_t)period;
+    for (int i = 0; i < SERVO_COUNT; i++) {
+        cmd.u.osc.amplitude[i] = (int16_t)amplitude[i];
+        cmd.u.osc.offset[i] = (int16_t)offset[i];
+        cmd.u.osc.phase0[i] = __motion_phase_from_rad(phase_diff[i]);
+    }
+
+    // where the servos stop, servos that are not in use keep their plan
+    for (int i = 0; i < SERVO_COUNT; i++) {
+        plan[i] = (g_otto.oscillator_indices[i] != -1) ? __motion_osc_position(&cmd, i, cmd.time) : sg_motion.plan[i];
+    }
+
+    return __motion_post(&cmd, plan);
+}
+
+OPERATE_RET otto_motion_hold(int time)
+{
+    OTTO_MOTION_CMD_T cmd = {.type = OTTO_MOTION_CMD_HOLD, .time = (uint32_t)MAX(time, 0)};
+
+    return __motion_post(&cmd, NULL);
+}
+
+int otto_motion_get_position(int servo_number)
+{
+    if (servo_number < 0 || servo_number >= SERVO_COUNT) {
+        return 90;
+    }
+
+    return sg_motion.plan[servo_number];
+}
+
+OPERATE_RET otto_motion_wait_idle(uint32_t timeout)
+{
+    uint32_t start = __motion_millis();
+
+    while (sg_motion.done != sg_motion.queued) {
+        if (timeout != 0xFFFFFFFF && __motion_millis() - start >= timeout) {
+            return OPRT_TIMEOUT;
+        }
+        tal_system_sleep(OTTO_MOTION_TICK_MS);
+    }
+
+    return OPRT_OK;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file otto_motion.h
+ * @brief Periodic motion engine driving all Otto servos
+ *
+ * Movements are queued as keyframes, oscillations and holds. A high priority
+ * task plays them on a fixed tick against absolute deadlines: each tick it
+ * computes the positions of all servos in one pass, with a fixed-point sine
+ * for oscillations, and writes their PWM duties together. The thread queueing
+ * the movements is never on the timing path, so a loaded system delays the
+ * next command being queued rather than the servo updates.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __OTTO_MOTION_H__
+#define __OTTO_MOTION_H__
+
+#include "tuya_cloud_types.h"
+#include "otto_movements.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+// servo update period in ms, servos are driven at 50Hz
+#ifndef OTTO_MOTION_TICK_MS
+#define OTTO_MOTION_TICK_MS 10
+#endif
+
+// commands that can wait behind the one playing
+#ifndef OTTO_MOTION_QUEUE_LEN
+#define OTTO_MOTION_QUEUE_LEN 16
+#endif
+
+#define OTTO_MOTION_TASK_PRIORITY THREAD_PRIO_1
+#define OTTO_MOTION_TASK_SIZE     2048
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+/**
+ * @brief Start the motion task, the servos must be created with otto_init()
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET otto_motion_init(void);
+
+/**
+ * @brief Queue a move of all servos to target positions
+ * @param time Movement duration in milliseconds
+ * @param servo_target Target positions for all servos (0-180 degrees)
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET otto_motion_move(int time, int servo_target[SERVO_COUNT]);
+
+/**
+ * @brief Queue an oscillation of the servos
+ * @param amplitude Amplitudes for each servo in degrees
+ * @param offset Offsets for each servo in degrees
+ * @param period Oscillation period in milliseconds
+ * @param phase_diff Initial phases for each servo in radians
+ * @param cycles Number of periods, may be fractional
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET otto_motion_oscillate(int amplitude[SERVO_COUNT], int offset[SERVO_COUNT], int period,
+                                  double phase_diff[SERVO_COUNT], float cycles);
+
+/**
+ * @brief Queue a pause, the servos keep their positions
+ * @param time Pause duration in milliseconds
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET otto_motion_hold(int time);
+
+/**
+ * @brief Get the position a servo has once the queued commands are played
+ * @param servo_number Servo index (0-5)
+ * @return Position in degrees
+ */
+int otto_motion_get_position(int servo_number);
+
+/**
+ * @brief Wait until all queued commands are played
+ * @param timeout Milliseconds to wait, 0xFFFFFFFF waits forever
+ * @return OPERATE_RET - OPRT_OK when idle, or an error code on timeout.
+ */
+OPERATE_RET otto_motion_wait_idle(uint32_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __OTTO_MOTION_H__ */
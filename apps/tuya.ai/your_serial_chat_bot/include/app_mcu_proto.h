@@ -0,0 +1,114 @@
+/**
+ * @file app_mcu_proto.h
+ * @brief Framed link to the host MCU over the chat bot UART
+ *
+ * Frames are A5 5A | ver | type | seq | ack | len (LE16) | payload | crc (LE16),
+ * the CRC-16/MODBUS covers ver to the end of the payload. Every frame carries
+ * the cumulative ack, the next seq expected from the peer, and data frames are
+ * sent in a sliding window: up to APP_MCU_PROTO_WINDOW frames wait for their
+ * ack, a lost or corrupted frame is sent again with the ones after it once
+ * APP_MCU_PROTO_RTO_MS pass without progress. A side that stops acking stops
+ * the other side at a full window, which is the flow control.
+ *
+ * Frames are found by the frame detection of the UART driver and parsed in the
+ * rx buffer, with DMA in both directions, so text and PCM or Opus audio can
+ * share a high baud rate link.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __APP_MCU_PROTO_H__
+#define __APP_MCU_PROTO_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define APP_MCU_PROTO_VER 0x01
+
+// data frames sent and not acked yet, at most 127
+#ifndef APP_MCU_PROTO_WINDOW
+#define APP_MCU_PROTO_WINDOW 8
+#endif
+
+// longest payload of a frame, longer data is sent in several frames
+#ifndef APP_MCU_PROTO_PAYLOAD_MAX
+#define APP_MCU_PROTO_PAYLOAD_MAX 1024
+#endif
+
+// time without an ack before the unacked frames are sent again
+#ifndef APP_MCU_PROTO_RTO_MS
+#define APP_MCU_PROTO_RTO_MS 200
+#endif
+
+// default baud rate, 1KB frames take about 11ms at 921600
+#ifndef APP_MCU_PROTO_BAUDRATE
+#define APP_MCU_PROTO_BAUDRATE 921600
+#endif
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef enum {
+    APP_MCU_FRAME_ACK = 0, // no payload, only the ack, not acked itself
+    APP_MCU_FRAME_TEXT,    // UTF-8 text
+    APP_MCU_FRAME_PCM,     // 16 bit mono PCM
+    APP_MCU_FRAME_OPUS,    // one Opus packet per frame
+    APP_MCU_FRAME_STATE,   // one byte, AI_AUDIO_STATE_E
+} APP_MCU_FRAME_TYPE_E;
+
+/**
+ * @brief received data frame, called in order from the rx task
+ *
+ * @param[in] type: APP_MCU_FRAME_TYPE_E
+ * @param[in] data: payload, valid during the call
+ * @param[in] len: payload length
+ * @param[in] arg: arg of APP_MCU_PROTO_CFG_T
+ */
+typedef void (*APP_MCU_PROTO_RECV_CB)(uint8_t type, const uint8_t *data, uint32_t len, void *arg);
+
+typedef struct {
+    TUYA_UART_NUM_E port;
+    uint32_t baudrate;
+    APP_MCU_PROTO_RECV_CB recv_cb;
+    void *arg;
+} APP_MCU_PROTO_CFG_T;
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+/**
+ * @brief Open the UART and start the link
+ *
+ * @param[in] cfg: link configure
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET app_mcu_proto_init(const APP_MCU_PROTO_CFG_T *cfg);
+
+/**
+ * @brief Send data, split in frames of APP_MCU_PROTO_PAYLOAD_MAX
+ *
+ * @param[in] type: APP_MCU_FRAME_TYPE_E, not APP_MCU_FRAME_ACK
+ * @param[in] data: data to send
+ * @param[in] len: data length
+ * @param[in] timeout: ms to wait for room in a full window, 0xFFFFFFFF waits forever
+ *
+ * @note Returns once the frames are sent, not acked. On OPRT_TIMEOUT the frames
+ * before the one that did not fit are sent.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET app_mcu_proto_send(uint8_t type, const uint8_t *data, uint32_t len, uint32_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __APP_MCU_PROTO_H__ */
@@ -11,16 +11,18 @@
 
 #include "ai_audio.h"
 #include "app_chat_bot.h"
+#include "app_mcu_proto.h"
 
 /***********************************************************
 ************************macro define************************
 ***********************************************************/
 #define USER_TEXT_UART TUYA_UART_NUM_0
+
+// ms the AI text may wait for the MCU window, text is dropped after it
+#define USER_TEXT_SEND_TIMEOUT_MS 500
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
-THREAD_HANDLE sg_ai_text_hdl = NULL;
-static uint8_t _serial_text_buf[256] = {0};
 /***********************************************************
 ***********************const declaration********************
 ***********************************************************/
@@ -42,7 +44,7 @@ static void __app_ai_audio_evt_inform_cb(AI_AUDIO_EVENT_E event, uint8_t *data,
 
     } break;
     case AI_AUDIO_EVT_AI_REPLIES_TEXT_DATA: {
-        tal_uart_write(USER_TEXT_UART, data, len);
+        app_mcu_proto_send(APP_MCU_FRAME_TEXT, data, len, USER_TEXT_SEND_TIMEOUT_MS);
     } break;
     case AI_AUDIO_EVT_AI_REPLIES_TEXT_END: {
 
@@ -61,7 +63,8 @@ static void __app_ai_audio_evt_inform_cb(AI_AUDIO_EVENT_E event, uint8_t *data,
 
             if (emo->text) {
                 // PR_DEBUG("emotion text:%s", emo->text);
-                tal_uart_write(USER_TEXT_UART, (uint8_t *)emo->text, strlen(emo->text));
+                app_mcu_proto_send(APP_MCU_FRAME_TEXT, (uint8_t *)emo->text, strlen(emo->text),
+                                   USER_TEXT_SEND_TIMEOUT_MS);
             }
         }
     } break;
@@ -78,7 +81,10 @@ static void __app_ai_audio_evt_inform_cb(AI_AUDIO_EVENT_E event, uint8_t *data,
 
 static void __app_ai_audio_state_inform_cb(AI_AUDIO_STATE_E state)
 {
+    uint8_t mcu_state = (uint8_t)state;
+
     PR_DEBUG("ai audio state: %d", state);
+    app_mcu_proto_send(APP_MCU_FRAME_STATE, &mcu_state, sizeof(mcu_state), USER_TEXT_SEND_TIMEOUT_MS);
     switch (state) {
     case AI_AUDIO_STATE_STANDBY:
         break;
@@ -93,15 +99,22 @@ static void __app_ai_audio_state_inform_cb(AI_AUDIO_STATE_E state)
     }
 }
 
-void __uart_text_scan_task(void *arg)
+static void __app_mcu_recv_cb(uint8_t type, const uint8_t *data, uint32_t len, void *arg)
 {
-    while (1) {
-        int len = tal_uart_read(USER_TEXT_UART, _serial_text_buf, sizeof(_serial_text_buf));
-        tal_uart_write(TUYA_UART_NUM_1, _serial_text_buf, len);
-        ai_text_agent_upload(_serial_text_buf, len);
-        tal_system_sleep(100);
+    switch (type) {
+    case APP_MCU_FRAME_TEXT:
+        ai_text_agent_upload((uint8_t *)data, len);
+        break;
+    case APP_MCU_FRAME_PCM:
+    case APP_MCU_FRAME_OPUS:
+        // the audio input is the board microphone, audio from the MCU is not played yet
+        PR_DEBUG("mcu audio frame type:%d len:%d not used", type, len);
+        break;
+    default:
+        break;
     }
 }
+
 OPERATE_RET app_chat_bot_init(void)
 {
     OPERATE_RET rt = OPRT_OK;
@@ -111,17 +124,13 @@ OPERATE_RET app_chat_bot_init(void)
     ai_audio_cfg.evt_inform_cb = __app_ai_audio_evt_inform_cb;
     ai_audio_cfg.state_inform_cb = __app_ai_audio_state_inform_cb;
 
-    TAL_UART_CFG_T uart_cfg = {0};
-    uart_cfg.base_cfg.baudrate = 115200;
-    uart_cfg.base_cfg.databits = TUYA_UART_DATA_LEN_8BIT;
-    uart_cfg.base_cfg.stopbits = TUYA_UART_STOP_LEN_1BIT;
-    uart_cfg.base_cfg.parity = TUYA_UART_PARITY_TYPE_NONE;
-    uart_cfg.rx_buffer_size = 512;
-    uart_cfg.open_mode = O_BLOCK;
-    tal_uart_init(USER_TEXT_UART, &uart_cfg);
-
-    TUYA_CALL_ERR_RETURN(tkl_thread_create_in_psram(&sg_ai_text_hdl, "uart_text_handle", 1024 * 4, THREAD_PRIO_1,
-                                                  __uart_text_scan_task, NULL));
+    APP_MCU_PROTO_CFG_T mcu_cfg = {
+        .port = USER_TEXT_UART,
+        .baudrate = APP_MCU_PROTO_BAUDRATE,
+        .recv_cb = __app_mcu_recv_cb,
+        .arg = NULL,
+    };
+    TUYA_CALL_ERR_RETURN(app_mcu_proto_init(&mcu_cfg));
     TUYA_CALL_ERR_RETURN(ai_audio_init(&ai_audio_cfg));
 
     return OPRT_OK;
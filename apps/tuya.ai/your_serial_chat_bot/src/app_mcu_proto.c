@@ -0,0 +1,422 @@
+/**
+ * @file app_mcu_proto.c
+ * @brief Framed link to the host MCU over the chat bot UART
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include "tal_api.h"
+#include "tal_uart.h"
+#include "crc_16.h"
+
+#include "app_mcu_proto.h"
+
+#include <string.h>
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define MCU_PROTO_HEAD_0   0xA5
+#define MCU_PROTO_HEAD_1   0x5A
+#define MCU_PROTO_HDR_LEN  8 // head, ver, type, seq, ack, len
+#define MCU_PROTO_CRC_LEN  2
+#define MCU_PROTO_FRAME_MAX (MCU_PROTO_HDR_LEN + APP_MCU_PROTO_PAYLOAD_MAX + MCU_PROTO_CRC_LEN)
+
+// frames and junk the irq can report before the rx task runs, a power of 2
+#define MCU_PROTO_EVT_NUM 32
+
+// rx task wake up period, for the retransmit timer
+#define MCU_PROTO_TICK_MS 20
+
+#ifndef APP_MCU_PROTO_RX_BUF_SIZE
+#define APP_MCU_PROTO_RX_BUF_SIZE (8 * 1024)
+#endif
+
+#define MCU_PROTO_TASK_PRIORITY THREAD_PRIO_1
+#define MCU_PROTO_TASK_SIZE     4096
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    uint8_t result; // TAL_UART_FRAME_E
+    uint32_t len;
+} MCU_PROTO_EVT_T;
+
+typedef struct {
+    APP_MCU_PROTO_CFG_T cfg;
+
+    THREAD_HANDLE thread;
+    SEM_HANDLE rx_sem;
+    SEM_HANDLE win_sem;
+    MUTEX_HANDLE send_mutex; // keeps the frames of one send together
+    MUTEX_HANDLE tx_mutex;   // tx window, ack state and uart writes
+
+    // written by the frame irq, read by the rx task
+    MCU_PROTO_EVT_T evt[MCU_PROTO_EVT_NUM];
+    volatile uint16_t evt_in;
+    volatile uint16_t evt_out;
+    volatile uint32_t evt_drop; // bytes to drop once the events before them are done
+
+    // sent frames waiting for their ack, the oldest at slot tx_head
+    uint8_t *tx_buf;
+    uint16_t tx_len[APP_MCU_PROTO_WINDOW];
+    uint8_t tx_head;
+    uint8_t tx_base; // seq of the oldest unacked frame
+    uint8_t tx_next; // seq of the next new frame
+    uint32_t tx_time;
+
+    // next seq expected from the peer and whether the peer must be told
+    uint8_t rx_expect;
+    bool ack_pending;
+    uint8_t *rx_buf; // frames that wrap in the uart ring
+} MCU_PROTO_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static MCU_PROTO_T sg_proto;
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static uint8_t *__proto_slot(uint8_t i)
+{
+    return sg_proto.tx_buf + (uint32_t)((sg_proto.tx_head + i) % APP_MCU_PROTO_WINDOW) * MCU_PROTO_FRAME_MAX;
+}
+
+static uint8_t __proto_inflight(void)
+{
+    return (uint8_t)(sg_proto.tx_next - sg_proto.tx_base);
+}
+
+// the ack is set on every transmit, so the crc is computed there, called with tx_mutex
+static void __proto_xmit(uint8_t *frame, uint32_t len)
+{
+    uint16_t crc;
+
+    frame[5] = sg_proto.rx_expect;
+    crc = crc_16_update(CRC_16_INIT, &frame[2], len - 2 - MCU_PROTO_CRC_LEN);
+    frame[len - 2] = (uint8_t)crc;
+    frame[len - 1] = (uint8_t)(crc >> 8);
+
+    tal_uart_write(sg_proto.cfg.port, frame, len);
+    sg_proto.ack_pending = false;
+}
+
+static void __proto_frame_hdr(uint8_t *frame, uint8_t type, uint8_t seq, uint16_t len)
+{
+    frame[0] = MCU_PROTO_HEAD_0;
+    frame[1] = MCU_PROTO_HEAD_1;
+    frame[2] = APP_MCU_PROTO_VER;
+    frame[3] = type;
+    frame[4] = seq;
+    frame[6] = (uint8_t)len;
+    frame[7] = (uint8_t)(len >> 8);
+}
+
+static void __proto_send_ack(void)
+{
+    uint8_t frame[MCU_PROTO_HDR_LEN + MCU_PROTO_CRC_LEN];
+
+    __proto_frame_hdr(frame, APP_MCU_FRAME_ACK, 0, 0);
+    __proto_xmit(frame, sizeof(frame));
+}
+
+// called with tx_mutex
+static void __proto_on_ack(uint8_t ack)
+{
+    uint8_t acked = (uint8_t)(ack - sg_proto.tx_base);
+
+    if (acked == 0 || acked > __proto_inflight()) {
+        return;
+    }
+
+    sg_proto.tx_head = (sg_proto.tx_head + acked) % APP_MCU_PROTO_WINDOW;
+    sg_proto.tx_base = ack;
+    sg_proto.tx_time = tal_system_get_millisecond();
+    tal_semaphore_post(sg_proto.win_sem);
+}
+
+static void __proto_parse(const uint8_t *frame, uint32_t len)
+{
+    uint16_t plen = (uint16_t)(frame[6] | (frame[7] << 8));
+    uint16_t crc = (uint16_t)(frame[len - 2] | (frame[len - 1] << 8));
+    uint8_t type = frame[3];
+    bool deliver = false;
+
+    if (crc != crc_16_update(CRC_16_INIT, &frame[2], len - 2 - MCU_PROTO_CRC_LEN)) {
+        PR_DEBUG("mcu proto crc err, len:%d", len);
+        return;
+    }
+    if (frame[2] != APP_MCU_PROTO_VER) {
+        PR_DEBUG("mcu proto ver %d not supported", frame[2]);
+        return;
+    }
+
+    tal_mutex_lock(sg_proto.tx_mutex);
+    __proto_on_ack(frame[5]);
+    if (type != APP_MCU_FRAME_ACK) {
+        // go back N, frames after a lost one are dropped and acked with the old seq
+        if (frame[4] == sg_proto.rx_expect) {
+            sg_proto.rx_expect++;
+            deliver = true;
+        }
+        sg_proto.ack_pending = true;
+    }
+    tal_mutex_unlock(sg_proto.tx_mutex);
+
+    if (deliver && sg_proto.cfg.recv_cb) {
+        sg_proto.cfg.recv_cb(type, &frame[MCU_PROTO_HDR_LEN], plen, sg_proto.cfg.arg);
+    }
+}
+
+static void __proto_rx_frame(uint32_t len)
+{
+    TUYA_UART_NUM_E port = sg_proto.cfg.port;
+    uint8_t *data = NULL;
+    int n = tal_uart_peek(port, &data);
+
+    if (n < 0) {
+        return;
+    }
+
+    // parsed in place unless it wraps in the ring
+    if ((uint32_t)n >= len) {
+        __proto_parse(data, len);
+        tal_uart_consume(port, len);
+        return;
+    }
+
+    memcpy(sg_proto.rx_buf, data, n);
+    tal_uart_consume(port, n);
+    if (tal_uart_peek(port, &data) < (int)(len - n)) {
+        return;
+    }
+    memcpy(sg_proto.rx_buf + n, data, len - n);
+    tal_uart_consume(port, len - n);
+    __proto_parse(sg_proto.rx_buf, len);
+}
+
+static void __proto_frame_cb(TUYA_UART_NUM_E port_id, TAL_UART_FRAME_E result, uint32_t len, void *arg)
+{
+    uint16_t in = sg_proto.evt_in;
+
+    // once an event is dropped the later ones are too, the bytes stay in order
+    if (sg_proto.evt_drop || (uint16_t)(in - sg_proto.evt_out) >= MCU_PROTO_EVT_NUM) {
+        sg_proto.evt_drop += len;
+    } else {
+        sg_proto.evt[in % MCU_PROTO_EVT_NUM].result = (uint8_t)result;
+        sg_proto.evt[in % MCU_PROTO_EVT_NUM].len = len;
+        sg_proto.evt_in = in + 1;
+    }
+
+    tal_semaphore_post(sg_proto.rx_sem);
+}
+
+static void __proto_rx_drain(void)
+{
+    while (sg_proto.evt_out != sg_proto.evt_in) {
+        MCU_PROTO_EVT_T *evt = &sg_proto.evt[sg_proto.evt_out % MCU_PROTO_EVT_NUM];
+
+        if (evt->result == TAL_UART_FRAME_OK) {
+            __proto_rx_frame(evt->len);
+        } else {
+            tal_uart_consume(sg_proto.cfg.port, evt->len);
+        }
+        sg_proto.evt_out++;
+    }
+
+    if (sg_proto.evt_drop) {
+        uint32_t drop = 0;
+
+        TAL_ENTER_CRITICAL();
+        if (sg_proto.evt_out == sg_proto.evt_in) {
+            drop = sg_proto.evt_drop;
+            sg_proto.evt_drop = 0;
+        }
+        TAL_EXIT_CRITICAL();
+
+        if (drop) {
+            PR_DEBUG("mcu proto rx events full, drop %d bytes", drop);
+            tal_uart_consume(sg_proto.cfg.port, drop);
+        }
+    }
+}
+
+static void __proto_tx_poll(void)
+{
+    tal_mutex_lock(sg_proto.tx_mutex);
+
+    uint8_t inflight = __proto_inflight();
+    if (inflight && tal_system_get_millisecond() - sg_proto.tx_time >= APP_MCU_PROTO_RTO_MS) {
+        for (uint8_t i = 0; i < inflight; i++) {
+            __proto_xmit(__proto_slot(i), sg_proto.tx_len[(sg_proto.tx_head + i) % APP_MCU_PROTO_WINDOW]);
+        }
+        sg_proto.tx_time = tal_system_get_millisecond();
+    }
+
+    if (sg_proto.ack_pending) {
+        __proto_send_ack();
+    }
+
+    tal_mutex_unlock(sg_proto.tx_mutex);
+}
+
+static void __proto_task(void *arg)
+{
+    for (;;) {
+        tal_semaphore_wait(sg_proto.rx_sem, MCU_PROTO_TICK_MS);
+        __proto_rx_drain();
+        __proto_tx_poll();
+    }
+}
+
+static OPERATE_RET __proto_send_frame(uint8_t type, const uint8_t *data, uint16_t len, uint32_t timeout)
+{
+    uint32_t start = tal_system_get_millisecond();
+
+    for (;;) {
+        tal_mutex_lock(sg_proto.tx_mutex);
+        if (__proto_inflight() < APP_MCU_PROTO_WINDOW) {
+            break;
+        }
+        tal_mutex_unlock(sg_proto.tx_mutex);
+
+        uint32_t wait = timeout;
+        if (timeout != 0xFFFFFFFF) {
+            uint32_t elapsed = tal_system_get_millisecond() - start;
+            if (elapsed >= timeout) {
+                return OPRT_TIMEOUT;
+            }
+            wait = timeout - elapsed;
+        }
+        tal_semaphore_wait(sg_proto.win_sem, wait);
+    }
+
+    uint8_t inflight = __proto_inflight();
+    uint8_t *frame = __proto_slot(inflight);
+    uint32_t frame_len = MCU_PROTO_HDR_LEN + len + MCU_PROTO_CRC_LEN;
+
+    __proto_frame_hdr(frame, type, sg_proto.tx_next, len);
+    memcpy(&frame[MCU_PROTO_HDR_LEN], data, len);
+    sg_proto.tx_len[(sg_proto.tx_head + inflight) % APP_MCU_PROTO_WINDOW] = (uint16_t)frame_len;
+    if (inflight == 0) {
+        sg_proto.tx_time = tal_system_get_millisecond();
+    }
+    sg_proto.tx_next++;
+    __proto_xmit(frame, frame_len);
+
+    tal_mutex_unlock(sg_proto.tx_mutex);
+
+    return OPRT_OK;
+}
+
+OPERATE_RET app_mcu_proto_send(uint8_t type, const uint8_t *data, uint32_t len, uint32_t timeout)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    if (NULL == sg_proto.thread) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+    if (type == APP_MCU_FRAME_ACK || (NULL == data && len)) {
+        return OPRT_INVALID_PARM;
+    }
+
+    tal_mutex_lock(sg_proto.send_mutex);
+    do {
+        uint16_t n = (uint16_t)MIN(len, APP_MCU_PROTO_PAYLOAD_MAX);
+        rt = __proto_send_frame(type, data, n, timeout);
+        data += n;
+        len -= n;
+    } while (OPRT_OK == rt && len);
+    tal_mutex_unlock(sg_proto.send_mutex);
+
+    return rt;
+}
+
+OPERATE_RET app_mcu_proto_init(const APP_MCU_PROTO_CFG_T *cfg)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    if (NULL == cfg) {
+        return OPRT_INVALID_PARM;
+    }
+    if (sg_proto.thread) {
+        return OPRT_OK;
+    }
+
+    memset(&sg_proto, 0, sizeof(sg_proto));
+    sg_proto.cfg = *cfg;
+
+    sg_proto.tx_buf = tal_malloc(APP_MCU_PROTO_WINDOW * MCU_PROTO_FRAME_MAX);
+    sg_proto.rx_buf = tal_malloc(MCU_PROTO_FRAME_MAX);
+    if (NULL == sg_proto.tx_buf || NULL == sg_proto.rx_buf) {
+        rt = OPRT_MALLOC_FAILED;
+        goto __ERR;
+    }
+
+    TUYA_CALL_ERR_GOTO(tal_semaphore_create_init(&sg_proto.rx_sem, 0, 1), __ERR);
+    TUYA_CALL_ERR_GOTO(tal_semaphore_create_init(&sg_proto.win_sem, 0, 1), __ERR);
+    TUYA_CALL_ERR_GOTO(tal_mutex_create_init(&sg_proto.send_mutex), __ERR);
+    TUYA_CALL_ERR_GOTO(tal_mutex_create_init(&sg_proto.tx_mutex), __ERR);
+
+    TAL_UART_CFG_T uart_cfg = {0};
+    uart_cfg.base_cfg.baudrate = cfg->baudrate ? cfg->baudrate : APP_MCU_PROTO_BAUDRATE;
+    uart_cfg.base_cfg.databits = TUYA_UART_DATA_LEN_8BIT;
+    uart_cfg.base_cfg.stopbits = TUYA_UART_STOP_LEN_1BIT;
+    uart_cfg.base_cfg.parity = TUYA_UART_PARITY_TYPE_NONE;
+    uart_cfg.rx_buffer_size = APP_MCU_PROTO_RX_BUF_SIZE;
+    uart_cfg.open_mode = O_BLOCK | O_RX_DMA | O_TX_DMA;
+    TUYA_CALL_ERR_GOTO(tal_uart_init(cfg->port, &uart_cfg), __ERR);
+
+    TAL_UART_FRAME_CFG_T frame_cfg = {
+        .type = TAL_UART_FRAME_LEN,
+        .head = {MCU_PROTO_HEAD_0, MCU_PROTO_HEAD_1},
+        .head_len = 2,
+        .len_offset = 6,
+        .len_size = 2,
+        .len_big_endian = 0,
+        .len_adjust = MCU_PROTO_HDR_LEN + MCU_PROTO_CRC_LEN,
+        .max_len = MCU_PROTO_FRAME_MAX,
+        .cb = __proto_frame_cb,
+        .arg = NULL,
+    };
+    TUYA_CALL_ERR_GOTO(tal_uart_frame_cfg_set(cfg->port, &frame_cfg), __UART_ERR);
+
+    THREAD_CFG_T thrd_param = {
+        .thrdname = "mcu_proto",
+        .priority = MCU_PROTO_TASK_PRIORITY,
+        .stackDepth = MCU_PROTO_TASK_SIZE,
+    };
+    TUYA_CALL_ERR_GOTO(tal_thread_create_and_start(&sg_proto.thread, NULL, NULL, __proto_task, NULL, &thrd_param),
+                       __UART_ERR);
+
+    return OPRT_OK;
+
+__UART_ERR:
+    tal_uart_deinit(cfg->port);
+__ERR:
+    if (sg_proto.tx_mutex) {
+        tal_mutex_release(sg_proto.tx_mutex);
+    }
+    if (sg_proto.send_mutex) {
+        tal_mutex_release(sg_proto.send_mutex);
+    }
+    if (sg_proto.win_sem) {
+        tal_semaphore_release(sg_proto.win_sem);
+    }
+    if (sg_proto.rx_sem) {
+        tal_semaphore_release(sg_proto.rx_sem);
+    }
+    if (sg_proto.rx_buf) {
+        tal_free(sg_proto.rx_buf);
+    }
+    if (sg_proto.tx_buf) {
+        tal_free(sg_proto.tx_buf);
+    }
+    memset(&sg_proto, 0, sizeof(sg_proto));
+
+    return rt;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file encoder_pcnt.c
+ * @brief encoder_pcnt module decodes the rotary encoder with the ESP32 pulse counter
+ * @version 0.1
+ * @date 2025-09-18
+ */
+#include "encoder_pcnt.h"
+#include "drv_encoder.h"
+
+#include "esp_err.h"
+#include "esp_log.h"
+
+#include "soc/soc_caps.h"
+#if SOC_PCNT_SUPPORTED
+#include "driver/pulse_cnt.h"
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define TAG "encoder_pcnt"
+
+// the unit accumulates across these limits, they only set the overflow interrupt rate
+#define PCNT_HIGH_LIMIT (1000)
+#define PCNT_LOW_LIMIT  (-1000)
+
+#if SOC_PCNT_SUPPORTED
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static pcnt_unit_handle_t sg_pcnt_unit = NULL;
+static int sg_last_count = 0;
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static OPERATE_RET __encoder_pcnt_start(void)
+{
+    pcnt_channel_handle_t chan_a = NULL, chan_b = NULL;
+
+    pcnt_unit_config_t unit_cfg = {
+        .high_limit = PCNT_HIGH_LIMIT,
+        .low_limit = PCNT_LOW_LIMIT,
+        .flags.accum_count = 1,
+    };
+    if (ESP_OK != pcnt_new_unit(&unit_cfg, &sg_pcnt_unit)) {
+        ESP_LOGE(TAG, "no pcnt unit left");
+        return OPRT_COM_ERROR;
+    }
+
+    pcnt_glitch_filter_config_t filter_cfg = {
+        .max_glitch_ns = ENCODER_PCNT_GLITCH_NS,
+    };
+    ESP_ERROR_CHECK(pcnt_unit_set_glitch_filter(sg_pcnt_unit, &filter_cfg));
+
+    // full quadrature decoding, each input counts on its edges with the other as the direction
+    pcnt_chan_config_t chan_a_cfg = {
+        .edge_gpio_num = DECODER_INPUT_A,
+        .level_gpio_num = DECODER_INPUT_B,
+    };
+    ESP_ERROR_CHECK(pcnt_new_channel(sg_pcnt_unit, &chan_a_cfg, &chan_a));
+    pcnt_chan_config_t chan_b_cfg = {
+        .edge_gpio_num = DECODER_INPUT_B,
+        .level_gpio_num = DECODER_INPUT_A,
+    };
+    ESP_ERROR_CHECK(pcnt_new_channel(sg_pcnt_unit, &chan_b_cfg, &chan_b));
+
+    ESP_ERROR_CHECK(pcnt_channel_set_edge_action(chan_a, PCNT_CHANNEL_EDGE_ACTION_DECREASE,
+                                                 PCNT_CHANNEL_EDGE_ACTION_INCREASE));
+    ESP_ERROR_CHECK(
+        pcnt_channel_set_level_action(chan_a, PCNT_CHANNEL_LEVEL_ACTION_KEEP, PCNT_CHANNEL_LEVEL_ACTION_INVERSE));
+    ESP_ERROR_CHECK(pcnt_channel_set_edge_action(chan_b, PCNT_CHANNEL_EDGE_ACTION_INCREASE,
+                                                 PCNT_CHANNEL_EDGE_ACTION_DECREASE));
+    ESP_ERROR_CHECK(
+        pcnt_channel_set_level_action(chan_b, PCNT_CHANNEL_LEVEL_ACTION_KEEP, PCNT_CHANNEL_LEVEL_ACTION_INVERSE));
+
+    // accum_count needs the limits as watch points
+    ESP_ERROR_CHECK(pcnt_unit_add_watch_point(sg_pcnt_unit, PCNT_HIGH_LIMIT));
+    ESP_ERROR_CHECK(pcnt_unit_add_watch_point(sg_pcnt_unit, PCNT_LOW_LIMIT));
+
+    ESP_ERROR_CHECK(pcnt_unit_enable(sg_pcnt_unit));
+    ESP_ERROR_CHECK(pcnt_unit_clear_count(sg_pcnt_unit));
+    ESP_ERROR_CHECK(pcnt_unit_start(sg_pcnt_unit));
+
+    sg_last_count = 0;
+    ESP_LOGI(TAG, "encoder on pcnt, A %d B %d", DECODER_INPUT_A, DECODER_INPUT_B);
+
+    return OPRT_OK;
+}
+
+static int32_t __encoder_pcnt_take(void)
+{
+    int count = 0, steps = 0;
+
+    if (ESP_OK != pcnt_unit_get_count(sg_pcnt_unit, &count)) {
+        return 0;
+    }
+
+    // whole detents only, a half turned one stays in sg_last_count
+    steps = (count - sg_last_count) / ENCODER_PCNT_COUNTS_PER_STEP;
+    sg_last_count += steps * ENCODER_PCNT_COUNTS_PER_STEP;
+
+    return steps;
+}
+
+static const ENCODER_COUNTER_OPS_T sg_pcnt_ops = {
+    .start = __encoder_pcnt_start,
+    .take = __encoder_pcnt_take,
+};
+
+OPERATE_RET encoder_pcnt_register(void)
+{
+    return encoder_counter_register(&sg_pcnt_ops);
+}
+#else
+OPERATE_RET encoder_pcnt_register(void)
+{
+    // no pulse counter on this chip, the encoder stays on the gpio decoding
+    return OPRT_NOT_SUPPORTED;
+}
+#endif
@@ -0,0 +1,50 @@
+/**
+ * @file encoder_pcnt.h
+ * @brief encoder_pcnt module decodes the rotary encoder with the ESP32 pulse counter
+ * @version 0.1
+ * @date 2025-09-18
+ */
+
+#ifndef __ENCODER_PCNT_H__
+#define __ENCODER_PCNT_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+// edges counted per detent, both edges of A and B are counted
+#ifndef ENCODER_PCNT_COUNTS_PER_STEP
+#define ENCODER_PCNT_COUNTS_PER_STEP 4
+#endif
+
+// pulses shorter than this are filtered out
+#ifndef ENCODER_PCNT_GLITCH_NS
+#define ENCODER_PCNT_GLITCH_NS 1000
+#endif
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+
+/**
+ * @brief Registers the pulse counter on DECODER_INPUT_A and DECODER_INPUT_B
+ *        as the encoder counter, call before tkl_encoder_init()
+ *
+ * @return OPERATE_RET
+ */
+OPERATE_RET encoder_pcnt_register(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ENCODER_PCNT_H__ */
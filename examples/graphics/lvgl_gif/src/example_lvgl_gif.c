@@ -26,6 +26,7 @@
 
 #include "lvgl.h"
 #include "lv_vendor.h"
+#include "lv_port_anim.h"
 #include "board_com_api.h"
 
 /***********************************************************
@@ -63,8 +64,9 @@ void user_main(void)
     LV_IMG_DECLARE(tuya_gif2);
     lv_obj_t * img;
 
-    img = lv_gif_create(lv_scr_act());
-    lv_gif_set_src(img, &tuya_gif2);
+    // decoded once into the animation cache, playing it does not run the GIF decoder
+    img = lv_port_anim_create(lv_scr_act());
+    lv_port_anim_set_src(img, &tuya_gif2);
     lv_obj_align(img, LV_ALIGN_CENTER, 0, 0);
 
     lv_vendor_start(5, 1024*8);
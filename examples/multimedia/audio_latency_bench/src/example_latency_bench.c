@@ -0,0 +1,506 @@
+/**
+ * @file example_latency_bench.c
+ * @brief End-to-end audio latency benchmark.
+ *
+ * Runs a fixed sequence of measurements on the board audio path and prints every
+ * result as one line "BENCH,<group>,<metric>,<value>" so it can be collected from
+ * the log, e.g. with grep "^BENCH," and compared between BSP versions:
+ *
+ * - mic:      mic callback period and the time until a frame sits in the ring buffer
+ * - loopback: time from tdl_audio_play of a click until it shows up in the mic
+ * - vad:      time from the onset of a played buzz in the mic until VAD reports speech
+ * - wakeup:   time from the end of the spoken wake word until ASR reports it (needs a user)
+ * - cpu:      share of wall time spent in each stage, in permille
+ *
+ * Loopback and VAD rely on the speaker being heard by the mic, so run them with
+ * hardware AEC disabled. Timestamps come from tal_system_get_millisecond(), single
+ * results are therefore +-1 ms, averages over the rounds are more precise.
+ *
+ * @version 0.1
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ */
+
+#include <stdio.h>
+
+#include "tuya_cloud_types.h"
+#include "tal_api.h"
+#include "spsc_ring.h"
+
+#include "tkl_output.h"
+#include "tkl_vad.h"
+#include "tkl_asr.h"
+#include "tdl_audio_manage.h"
+#include "board_com_api.h"
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define BENCH_SAMPLE_RATE   16000
+#define BENCH_FRAME_MS      10
+#define BENCH_FRAME_SAMPLES (BENCH_SAMPLE_RATE * BENCH_FRAME_MS / 1000)
+#define BENCH_RING_MS       1000
+
+#define BENCH_LOOPBACK_ROUNDS 8
+#define BENCH_VAD_ROUNDS      4
+#define BENCH_WAIT_MS         1000
+
+// set to 0 on boards without a wakeup engine, the test needs someone to speak
+#ifndef BENCH_WAKEUP_ENABLE
+#define BENCH_WAKEUP_ENABLE 1
+#endif
+#define BENCH_WAKEUP_TIMEOUT_MS (15 * 1000)
+
+#define BENCH_ONSET_LEVEL 4000 // |sample| treated as the start of the test signal
+#define BENCH_CLICK_LEVEL 24000
+#define BENCH_CLICK_MS    10
+#define BENCH_BUZZ_LEVEL  16000
+#define BENCH_BUZZ_HZ     150
+#define BENCH_BUZZ_MS     1000
+
+#define BENCH_OUT(group, metric, fmt, ...) PR_DEBUG_RAW("BENCH,%s,%s," fmt "\r\n", group, metric, ##__VA_ARGS__)
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef enum {
+    BENCH_STAGE_MIC = 0,
+    BENCH_STAGE_VAD,
+    BENCH_STAGE_ASR,
+    BENCH_STAGE_PLAY,
+    BENCH_STAGE_MAX,
+} BENCH_STAGE_E;
+
+typedef struct {
+    uint32_t cnt;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} BENCH_STAT_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static const char *cSTAGE_NAME[BENCH_STAGE_MAX] = {"mic_cb", "vad", "asr", "play"};
+
+static TDL_AUDIO_HANDLE_T sg_audio_hdl = NULL;
+static THREAD_HANDLE sg_proc_thrd = NULL;
+static SPSC_RING_T sg_ring;
+
+static volatile uint32_t sg_stage_ms[BENCH_STAGE_MAX];
+static volatile uint32_t sg_asr_audio_ms = 0;
+
+// written by the mic callback
+static BENCH_STAT_T sg_cb_period;
+static volatile SYS_TIME_T sg_last_cb_ms = 0;
+static volatile uint32_t sg_frame_len = 0;
+static volatile uint32_t sg_ring_drop = 0;
+static volatile bool sg_onset_armed = false;
+static volatile SYS_TIME_T sg_onset_ms = 0;
+static volatile SYS_TIME_T sg_last_loud_ms = 0;
+
+// written by the processing task
+static bool sg_asr_ready = false;
+static volatile bool sg_asr_enable = false;
+static volatile SYS_TIME_T sg_vad_speech_ms = 0;
+static volatile SYS_TIME_T sg_wakeup_ms = 0;
+static volatile SYS_TIME_T sg_wakeup_loud_ms = 0;
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static void __bench_stat_add(BENCH_STAT_T *stat, uint32_t val)
+{
+    if (0 == stat->cnt || val < stat->min) {
+        stat->min = val;
+    }
+    if (0 == stat->cnt || val > stat->max) {
+        stat->max = val;
+    }
+    stat->sum += val;
+    stat->cnt++;
+}
+
+static void __bench_stat_report(const char *group, const char *metric, BENCH_STAT_T *stat)
+{
+    char name[32];
+
+    snprintf(name, sizeof(name), "%s_cnt", metric);
+    BENCH_OUT(group, name, "%d", stat->cnt);
+    if (0 == stat->cnt) {
+        return;
+    }
+
+    snprintf(name, sizeof(name), "%s_min_ms", metric);
+    BENCH_OUT(group, name, "%d", stat->min);
+    // one decimal, the rounds average out the millisecond timer
+    snprintf(name, sizeof(name), "%s_avg_ms", metric);
+    uint32_t avg_x10 = (uint32_t)(stat->sum * 10 / stat->cnt);
+    BENCH_OUT(group, name, "%d.%d", avg_x10 / 10, avg_x10 % 10);
+    snprintf(name, sizeof(name), "%s_max_ms", metric);
+    BENCH_OUT(group, name, "%d", stat->max);
+}
+
+static void __bench_mic_cb(TDL_AUDIO_FRAME_FORMAT_E type, TDL_AUDIO_STATUS_E status, uint8_t *data, uint32_t len)
+{
+    SYS_TIME_T now = tal_system_get_millisecond();
+    int16_t *pcm = (int16_t *)data;
+    uint32_t samples = len / sizeof(int16_t);
+    uint32_t i = 0;
+    bool loud = false;
+
+    if (sg_last_cb_ms) {
+        __bench_stat_add(&sg_cb_period, (uint32_t)(now - sg_last_cb_ms));
+    }
+    sg_last_cb_ms = now;
+    sg_frame_len = len;
+
+    for (i = 0; i < samples; i++) {
+        if (pcm[i] > BENCH_ONSET_LEVEL || pcm[i] < -BENCH_ONSET_LEVEL) {
+            loud = true;
+            if (sg_onset_armed) {
+                // the sample was captured (samples - i) sample periods before this callback
+                sg_onset_ms = now - (samples - i) * 1000 / BENCH_SAMPLE_RATE;
+                sg_onset_armed = false;
+            }
+            break;
+        }
+    }
+    if (loud) {
+        sg_last_loud_ms = now;
+    }
+
+    if (spsc_ring_write(&sg_ring, data, len) < len) {
+        sg_ring_drop++;
+    }
+
+    sg_stage_ms[BENCH_STAGE_MIC] += (uint32_t)(tal_system_get_millisecond() - now);
+}
+
+static void __bench_proc_task(void *arg)
+{
+    uint32_t unit_len = BENCH_FRAME_SAMPLES * sizeof(int16_t);
+    TKL_VAD_STATUS_T last_state = TKL_VAD_STATUS_NONE;
+    SYS_TIME_T t0 = 0, t1 = 0;
+    uint32_t off = 0;
+
+    if (sg_asr_ready) {
+        unit_len = tkl_asr_get_process_uint_size();
+    }
+
+    uint8_t *unit = tal_malloc(unit_len);
+    if (NULL == unit) {
+        PR_ERR("malloc fail");
+        return;
+    }
+
+    for (;;) {
+        if (spsc_ring_readable(&sg_ring) < unit_len) {
+            tal_system_sleep(5);
+            continue;
+        }
+        spsc_ring_read(&sg_ring, unit, unit_len);
+
+        // vad takes one frame at a time
+        t0 = tal_system_get_millisecond();
+        for (off = 0; off + BENCH_FRAME_SAMPLES * sizeof(int16_t) <= unit_len;
+             off += BENCH_FRAME_SAMPLES * sizeof(int16_t)) {
+            tkl_vad_feed(unit + off, BENCH_FRAME_SAMPLES * sizeof(int16_t));
+        }
+        t1 = tal_system_get_millisecond();
+        sg_stage_ms[BENCH_STAGE_VAD] += (uint32_t)(t1 - t0);
+
+        TKL_VAD_STATUS_T state = tkl_vad_get_status();
+        if (TKL_VAD_STATUS_SPEECH == state && TKL_VAD_STATUS_SPEECH != last_state) {
+            sg_vad_speech_ms = t1;
+        }
+        last_state = state;
+
+        if (sg_asr_ready && sg_asr_enable) {
+            t0 = tal_system_get_millisecond();
+            TKL_ASR_WAKEUP_WORD_E word = tkl_asr_recognize_wakeup_word(unit, unit_len);
+            t1 = tal_system_get_millisecond();
+            sg_stage_ms[BENCH_STAGE_ASR] += (uint32_t)(t1 - t0);
+            sg_asr_audio_ms += unit_len * 1000 / (BENCH_SAMPLE_RATE * sizeof(int16_t));
+            if (TKL_ASR_WAKEUP_WORD_UNKNOWN != word && 0 == sg_wakeup_ms) {
+                sg_wakeup_loud_ms = sg_last_loud_ms;
+                sg_wakeup_ms = t1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief plays ms of a click or a buzz through tdl_audio_play in frame sized chunks
+ */
+static void __bench_play(bool is_click, uint32_t ms)
+{
+    int16_t frame[BENCH_FRAME_SAMPLES];
+    uint32_t total = BENCH_SAMPLE_RATE * ms / 1000;
+    uint32_t period = BENCH_SAMPLE_RATE / BENCH_BUZZ_HZ;
+    uint32_t n = 0, i = 0, pos = 0;
+
+    while (pos < total) {
+        n = (total - pos > BENCH_FRAME_SAMPLES) ? BENCH_FRAME_SAMPLES : (total - pos);
+        for (i = 0; i < n; i++) {
+            uint32_t t = pos + i;
+            if (is_click) {
+                // 2 kHz square
+                frame[i] = ((t / 4) & 1) ? BENCH_CLICK_LEVEL : -BENCH_CLICK_LEVEL;
+            } else {
+                // sawtooth, rich in harmonics like a voiced sound
+                frame[i] = (int16_t)(((int32_t)(t % period) * 2 * BENCH_BUZZ_LEVEL / period) - BENCH_BUZZ_LEVEL);
+            }
+        }
+
+        SYS_TIME_T t0 = tal_system_get_millisecond();
+        tdl_audio_play(sg_audio_hdl, (uint8_t *)frame, n * sizeof(int16_t));
+        sg_stage_ms[BENCH_STAGE_PLAY] += (uint32_t)(tal_system_get_millisecond() - t0);
+        pos += n;
+    }
+}
+
+static void __bench_wait_quiet(uint32_t quiet_ms)
+{
+    uint32_t waited = 0;
+
+    while (waited < 5 * 1000 && tal_system_get_millisecond() - sg_last_loud_ms < quiet_ms) {
+        tal_system_sleep(20);
+        waited += 20;
+    }
+}
+
+static void __bench_mic(void)
+{
+    tal_system_sleep(BENCH_WAIT_MS);
+
+    uint32_t frame_len = sg_frame_len;
+
+    __bench_stat_report("mic", "cb_period", &sg_cb_period);
+    BENCH_OUT("mic", "frame_bytes", "%d", frame_len);
+    // a frame is complete only once its last sample is captured, then it is copied in the callback
+    BENCH_OUT("mic", "mic_to_rb_ms", "%d", frame_len * 1000 / (BENCH_SAMPLE_RATE * sizeof(int16_t)));
+    BENCH_OUT("mic", "rb_drop_cnt", "%d", sg_ring_drop);
+}
+
+static void __bench_loopback(void)
+{
+    BENCH_STAT_T stat = {0};
+    uint32_t timeout_cnt = 0, r = 0;
+
+    for (r = 0; r < BENCH_LOOPBACK_ROUNDS; r++) {
+        __bench_wait_quiet(300);
+
+        sg_onset_ms = 0;
+        sg_onset_armed = true;
+        SYS_TIME_T t0 = tal_system_get_millisecond();
+        __bench_play(true, BENCH_CLICK_MS);
+
+        while (0 == sg_onset_ms && tal_system_get_millisecond() - t0 < BENCH_WAIT_MS) {
+            tal_system_sleep(5);
+        }
+        sg_onset_armed = false;
+
+        if (sg_onset_ms) {
+            __bench_stat_add(&stat, (uint32_t)(sg_onset_ms - t0));
+        } else {
+            timeout_cnt++;
+        }
+    }
+
+    __bench_stat_report("loopback", "play_to_mic", &stat);
+    BENCH_OUT("loopback", "timeout_cnt", "%d", timeout_cnt);
+}
+
+static void __bench_vad(void)
+{
+    BENCH_STAT_T stat = {0};
+    uint32_t timeout_cnt = 0, r = 0, waited = 0;
+
+    for (r = 0; r < BENCH_VAD_ROUNDS; r++) {
+        __bench_wait_quiet(300);
+        for (waited = 0; TKL_VAD_STATUS_SPEECH == tkl_vad_get_status() && waited < 3 * 1000; waited += 20) {
+            tal_system_sleep(20);
+        }
+
+        sg_vad_speech_ms = 0;
+        sg_onset_ms = 0;
+        sg_onset_armed = true;
+        __bench_play(false, BENCH_BUZZ_MS);
+
+        SYS_TIME_T t0 = tal_system_get_millisecond();
+        while (0 == sg_vad_speech_ms && tal_system_get_millisecond() - t0 < BENCH_WAIT_MS) {
+            tal_system_sleep(5);
+        }
+        sg_onset_armed = false;
+
+        if (sg_onset_ms && sg_vad_speech_ms >= sg_onset_ms) {
+            __bench_stat_add(&stat, (uint32_t)(sg_vad_speech_ms - sg_onset_ms));
+        } else {
+            timeout_cnt++;
+        }
+    }
+
+    __bench_stat_report("vad", "onset_to_speech", &stat);
+    BENCH_OUT("vad", "timeout_cnt", "%d", timeout_cnt);
+}
+
+static void __bench_wakeup(void)
+{
+    if (false == sg_asr_ready) {
+        BENCH_OUT("wakeup", "result", "%s", "skip");
+        return;
+    }
+
+    sg_wakeup_ms = 0;
+    sg_asr_enable = true;
+    BENCH_OUT("wakeup", "prompt", "%s", "say the wake word");
+
+    SYS_TIME_T t0 = tal_system_get_millisecond();
+    while (0 == sg_wakeup_ms && tal_system_get_millisecond() - t0 < BENCH_WAKEUP_TIMEOUT_MS) {
+        tal_system_sleep(10);
+    }
+    sg_asr_enable = false;
+
+    if (0 == sg_wakeup_ms) {
+        BENCH_OUT("wakeup", "result", "%s", "timeout");
+    } else {
+        BENCH_OUT("wakeup", "result", "%s", "ok");
+        // time from the last loud mic frame before the detection
+        BENCH_OUT("wakeup", "speech_end_to_detect_ms", "%d", (uint32_t)(sg_wakeup_ms - sg_wakeup_loud_ms));
+    }
+    if (sg_asr_audio_ms) {
+        BENCH_OUT("wakeup", "asr_rtf_permille", "%d", sg_stage_ms[BENCH_STAGE_ASR] * 1000 / sg_asr_audio_ms);
+    }
+}
+
+static void __bench_cpu(SYS_TIME_T start)
+{
+    uint32_t wall = (uint32_t)(tal_system_get_millisecond() - start);
+    uint32_t i = 0;
+    char name[32];
+
+    BENCH_OUT("cpu", "wall_ms", "%d", wall);
+    for (i = 0; i < BENCH_STAGE_MAX && wall; i++) {
+        snprintf(name, sizeof(name), "%s_permille", cSTAGE_NAME[i]);
+        BENCH_OUT("cpu", name, "%d", (uint32_t)((uint64_t)sg_stage_ms[i] * 1000 / wall));
+    }
+}
+
+static OPERATE_RET __bench_init(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    uint32_t ring_len = BENCH_SAMPLE_RATE * sizeof(int16_t) * BENCH_RING_MS / 1000;
+    uint8_t *ring_buf = tal_malloc(ring_len);
+    TUYA_CHECK_NULL_RETURN(ring_buf, OPRT_MALLOC_FAILED);
+    spsc_ring_init(&sg_ring, ring_buf, ring_len);
+
+    TKL_VAD_CONFIG_T vad_config;
+    vad_config.sample_rate = BENCH_SAMPLE_RATE;
+    vad_config.channel_num = 1;
+    vad_config.speech_min_ms = 300;
+    vad_config.noise_min_ms = 500;
+    vad_config.scale = 1.0;
+    vad_config.frame_duration_ms = BENCH_FRAME_MS;
+    TUYA_CALL_ERR_RETURN(tkl_vad_init(&vad_config));
+    TUYA_CALL_ERR_RETURN(tkl_vad_start());
+
+#if defined(BENCH_WAKEUP_ENABLE) && (BENCH_WAKEUP_ENABLE == 1)
+    TKL_ASR_WAKEUP_WORD_E wakeup_word = TKL_ASR_WAKEUP_NIHAO_TUYA;
+    if (OPRT_OK == tkl_asr_init() && OPRT_OK == tkl_asr_wakeup_word_config(&wakeup_word, 1)) {
+        sg_asr_ready = true;
+    } else {
+        PR_WARN("asr init failed, wakeup test skipped");
+    }
+#endif
+
+    THREAD_CFG_T thrd_param = {4096, THREAD_PRIO_1, "bench_proc"};
+    TUYA_CALL_ERR_RETURN(tal_thread_create_and_start(&sg_proc_thrd, NULL, NULL, __bench_proc_task, NULL, &thrd_param));
+
+    TUYA_CALL_ERR_RETURN(tdl_audio_find(AUDIO_CODEC_NAME, &sg_audio_hdl));
+    TUYA_CALL_ERR_RETURN(tdl_audio_open(sg_audio_hdl, __bench_mic_cb));
+
+    return rt;
+}
+
+void user_main(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    tal_log_init(TAL_LOG_LEVEL_DEBUG, 1024, (TAL_LOG_OUTPUT_CB)tkl_log_output);
+
+    PR_NOTICE("Application information:");
+    PR_NOTICE("Project name:        %s", PROJECT_NAME);
+    PR_NOTICE("App version:         %s", PROJECT_VERSION);
+    PR_NOTICE("Compile time:        %s", __DATE__);
+    PR_NOTICE("TuyaOpen version:    %s", OPEN_VERSION);
+    PR_NOTICE("TuyaOpen commit-id:  %s", OPEN_COMMIT);
+    PR_NOTICE("Platform chip:       %s", PLATFORM_CHIP);
+    PR_NOTICE("Platform board:      %s", PLATFORM_BOARD);
+    PR_NOTICE("Platform commit-id:  %s", PLATFORM_COMMIT);
+
+    /*hardware register*/
+    board_register_hardware();
+
+    TUYA_CALL_ERR_LOG(__bench_init());
+    if (OPRT_OK != rt) {
+        return;
+    }
+
+    SYS_TIME_T start = tal_system_get_millisecond();
+
+    BENCH_OUT("info", "board", "%s", PLATFORM_BOARD);
+    BENCH_OUT("info", "sample_rate", "%d", BENCH_SAMPLE_RATE);
+
+    __bench_mic();
+    __bench_loopback();
+    __bench_vad();
+    __bench_wakeup();
+    __bench_cpu(start);
+
+    BENCH_OUT("info", "done", "%d", 1);
+
+    while (1) {
+        tal_system_sleep(1000);
+    }
+
+    return;
+}
+
+#if OPERATING_SYSTEM == SYSTEM_LINUX
+
+/**
+ * @brief main
+ *
+ * @param argc
+ * @param argv
+ * @return void
+ */
+void main(int argc, char *argv[])
+{
+    user_main();
+}
+#else
+
+/* Tuya thread handle */
+static THREAD_HANDLE ty_app_thread = NULL;
+
+/**
+ * @brief  task thread
+ *
+ * @param[in] arg:Parameters when creating a task
+ * @return none
+ */
+static void tuya_app_thread(void *arg)
+{
+    user_main();
+
+    tal_thread_delete(ty_app_thread);
+    ty_app_thread = NULL;
+}
+
+void tuya_app_main(void)
+{
+    THREAD_CFG_T thrd_param = {4096, 4, "tuya_app_main"};
+    tal_thread_create_and_start(&ty_app_thread, NULL, NULL, tuya_app_thread, NULL, &thrd_param);
+}
+#endif
@@ -9,15 +9,12 @@
 #include "tal_api.h"
 #include "tkl_output.h"
 
-#if defined(ENABLE_DMA2D) && (ENABLE_DMA2D == 1)
-#include "tkl_dma2d.h"
-#endif
-
 #include "board_com_api.h"
 
 #include "tdl_display_manage.h"
 #include "tdl_display_draw.h"
 #include "tdl_camera_manage.h"
+#include "tdl_camera_preview.h"
 /***********************************************************
 *************************micro define***********************
 ***********************************************************/
@@ -32,95 +29,13 @@
 static TDL_DISP_HANDLE_T      sg_tdl_disp_hdl = NULL;
 static TDL_DISP_DEV_INFO_T    sg_display_info;
 static TDL_DISP_FRAME_BUFF_T *sg_p_display_fb = NULL;
-static TDL_DISP_FRAME_BUFF_T *sg_p_display_fb_1 = NULL;
-static TDL_DISP_FRAME_BUFF_T *sg_p_display_fb_2 = NULL;
 static TDL_DISP_FRAME_BUFF_T *sg_p_display_fb_rotat = NULL;
 
 static TDL_CAMERA_HANDLE_T sg_tdl_camera_hdl = NULL;
 
-#if defined(ENABLE_DMA2D) && (ENABLE_DMA2D == 1)
-static TKL_DMA2D_FRAME_INFO_T sg_in_frame = {0};
-static TKL_DMA2D_FRAME_INFO_T sg_out_frame = {0};
-static SEM_HANDLE sg_convert_sem;
-#endif
 /***********************************************************
 ***********************function define**********************
 ***********************************************************/
-#if defined(ENABLE_DMA2D) && (ENABLE_DMA2D == 1)
-static void __dma2d_irq_cb(TUYA_DMA2D_IRQ_E type, VOID_T *args)
-{
-    if(sg_convert_sem) {
-        tal_semaphore_post(sg_convert_sem);
-    }
-}
-
-static OPERATE_RET __dma2d_init(void)
-{
-    OPERATE_RET rt = OPRT_OK;
-
-    TUYA_CALL_ERR_RETURN(tal_semaphore_create_init(&sg_convert_sem, 0, 1));
-
-    TUYA_DMA2D_BASE_CFG_T dma2d_cfg = {
-        .cb = __dma2d_irq_cb, 
-        .arg=NULL,
-    };
-
-    return tkl_dma2d_init(&dma2d_cfg);
-}
-#endif
-
-OPERATE_RET __get_camera_raw_frame_rgb565_cb(TDL_CAMERA_HANDLE_T hdl,  TDL_CAMERA_FRAME_T *frame)
-{
-    OPERATE_RET rt = OPRT_OK;
-
-    if(NULL == sg_p_display_fb) {
-        return OPRT_COM_ERROR;
-    }
-
-#if defined(ENABLE_DMA2D) && (ENABLE_DMA2D == 1)
-    TDL_DISP_FRAME_BUFF_T *target_fb = NULL;
-
-    sg_in_frame.type = TUYA_FRAME_FMT_YUV422;
-    sg_in_frame.width = frame->width;
-    sg_in_frame.height = frame->height;
-    sg_in_frame.axis.x_axis = 0;
-    sg_in_frame.axis.y_axis = 0;
-    sg_in_frame.width_cp = 0;
-    sg_in_frame.height_cp = 0;
-    sg_in_frame.pbuf = frame->data;
-
-    sg_out_frame.type = TUYA_FRAME_FMT_RGB565;
-    sg_out_frame.width = sg_p_display_fb->width;
-    sg_out_frame.height = sg_p_display_fb->height;
-    sg_out_frame.axis.x_axis = 0;
-    sg_out_frame.axis.y_axis = 0;
-    sg_out_frame.width_cp = 0;
-    sg_out_frame.height_cp = 0;
-    sg_out_frame.pbuf = sg_p_display_fb->frame;
-
-    TUYA_CALL_ERR_RETURN(tkl_dma2d_convert(&sg_in_frame, &sg_out_frame));
-
-    TUYA_CALL_ERR_RETURN(tal_semaphore_wait(sg_convert_sem, 100));
-
-    if(sg_display_info.rotation != TUYA_DISPLAY_ROTATION_0) {
-        tdl_disp_draw_rotate(sg_display_info.rotation, sg_p_display_fb, sg_p_display_fb_rotat, sg_display_info.is_swap);
-        target_fb = sg_p_display_fb_rotat;
-    }else {
-        if(true == sg_display_info.is_swap) {
-            tdl_disp_dev_rgb565_swap((uint16_t *)sg_p_display_fb->frame, sg_p_display_fb->len/2);
-        }
-        target_fb = sg_p_display_fb;
-    }
-    
-    tdl_disp_dev_flush(sg_tdl_disp_hdl, target_fb);
-
-    sg_p_display_fb = (sg_p_display_fb == sg_p_display_fb_1) ? \
-                      sg_p_display_fb_2 : sg_p_display_fb_1;
-#endif
-
-    return rt;
-}
-
 /**
  * @brief Converts YUV422 image to binary image using luminance threshold.
  *
@@ -238,30 +153,21 @@ static OPERATE_RET __display_init(void)
  
     tdl_disp_set_brightness(sg_tdl_disp_hdl, 100); // Set brightness to 100%
 
-    /*create frame buffer*/
-    if(sg_display_info.fmt == TUYA_PIXEL_FMT_MONOCHROME ) {
-        frame_len = (EXAMPLE_CAMERA_WIDTH + 7) / 8 * EXAMPLE_CAMERA_HEIGHT;
-    } else {
-        frame_len = EXAMPLE_CAMERA_WIDTH * EXAMPLE_CAMERA_HEIGHT * 2; // RGB565 is 2 bytes per pixel
+    // rgb565 panels are fed by the camera preview, it has its own frame buffers
+    if(sg_display_info.fmt != TUYA_PIXEL_FMT_MONOCHROME) {
+        return OPRT_OK;
     }
-    sg_p_display_fb_1 = tdl_disp_create_frame_buff(DISP_FB_TP_PSRAM, frame_len);
-    if(NULL == sg_p_display_fb_1) {
-        PR_ERR("create display frame buff failed");
-        return OPRT_MALLOC_FAILED;
-    }
-    sg_p_display_fb_1->fmt    = sg_display_info.fmt;
-    sg_p_display_fb_1->width  = EXAMPLE_CAMERA_WIDTH;
-    sg_p_display_fb_1->height = EXAMPLE_CAMERA_HEIGHT;
 
-
-    sg_p_display_fb_2 = tdl_disp_create_frame_buff(DISP_FB_TP_PSRAM, frame_len);
-    if(NULL == sg_p_display_fb_2) {
+    /*create frame buffer*/
+    frame_len = (EXAMPLE_CAMERA_WIDTH + 7) / 8 * EXAMPLE_CAMERA_HEIGHT;
+    sg_p_display_fb = tdl_disp_create_frame_buff(DISP_FB_TP_PSRAM, frame_len);
+    if(NULL == sg_p_display_fb) {
         PR_ERR("create display frame buff failed");
         return OPRT_MALLOC_FAILED;
     }
-    sg_p_display_fb_2->fmt    = sg_display_info.fmt;
-    sg_p_display_fb_2->width  = EXAMPLE_CAMERA_WIDTH;
-    sg_p_display_fb_2->height = EXAMPLE_CAMERA_HEIGHT;
+    sg_p_display_fb->fmt    = sg_display_info.fmt;
+    sg_p_display_fb->width  = EXAMPLE_CAMERA_WIDTH;
+    sg_p_display_fb->height = EXAMPLE_CAMERA_HEIGHT;
 
     if(sg_display_info.rotation != TUYA_DISPLAY_ROTATION_0) {
         sg_p_display_fb_rotat = tdl_disp_create_frame_buff(DISP_FB_TP_PSRAM, frame_len);
@@ -272,10 +178,7 @@ static OPERATE_RET __display_init(void)
         sg_p_display_fb_rotat->fmt    = sg_display_info.fmt;
         sg_p_display_fb_rotat->width  = EXAMPLE_CAMERA_WIDTH;
         sg_p_display_fb_rotat->height = EXAMPLE_CAMERA_HEIGHT;
-
-    } 
-
-    sg_p_display_fb = sg_p_display_fb_1;
+    }
 
     return OPRT_OK;
 }
@@ -300,12 +203,18 @@ static OPERATE_RET __camera_init(void)
 
     if(sg_display_info.fmt == TUYA_PIXEL_FMT_MONOCHROME) {
         cfg.get_frame_cb =  __get_camera_raw_frame_mono_cb;
-    }else {
-        cfg.get_frame_cb =  __get_camera_raw_frame_rgb565_cb;
     }
 
     TUYA_CALL_ERR_RETURN(tdl_camera_dev_open(sg_tdl_camera_hdl, &cfg));
 
+    if(sg_display_info.fmt != TUYA_PIXEL_FMT_MONOCHROME) {
+        TDL_CAMERA_PREVIEW_CFG_T preview_cfg;
+
+        // full camera size at the top left corner
+        memset(&preview_cfg, 0, sizeof(TDL_CAMERA_PREVIEW_CFG_T));
+        TUYA_CALL_ERR_RETURN(tdl_camera_preview_start(sg_tdl_camera_hdl, sg_tdl_disp_hdl, &preview_cfg));
+    }
+
     PR_NOTICE("camera init success");
 
     return OPRT_OK;
@@ -328,10 +237,6 @@ void user_main(void)
     /*hardware register*/
     board_register_hardware();
 
-#if defined(ENABLE_DMA2D) && (ENABLE_DMA2D == 1)
-    TUYA_CALL_ERR_LOG(__dma2d_init());
-#endif
-
     TUYA_CALL_ERR_LOG(__display_init());
 
     TUYA_CALL_ERR_LOG(__camera_init());
@@ -10,22 +10,18 @@
 #include "tkl_output.h"
 #include "tkl_pinmux.h"
 #include "tkl_i2c.h"
-#include "bmi270.h"
-#include "bmi270_common.h"
+#include "bmi2_defs.h"
+#include "tdl_imu.h"
+#include "tdl_imu_fusion.h"
 
 /***********************************************************
 ************************macro define************************
 ***********************************************************/
 /*! Earth's gravity in m/s^2 */
 #define GRAVITY_EARTH  (9.80665f)
-/*! Macros to select the sensors                   */
-#define ACCEL          UINT8_C(0x00)
-#define GYRO           UINT8_C(0x01)
 
 /* BMI270 I2C Configuration */
 #define BMI270_I2C_PORT              TUYA_I2C_NUM_0
-#define BMI270_I2C_ADDR              BMI2_I2C_PRIM_ADDR  /* BMI270 I2C address (ADDR pin = 0) */
-#define BMI270_I2C_ADDR_ALT          BMI2_I2C_SEC_ADDR   /* BMI270 I2C address (ADDR pin = 1) */
 
 #ifndef EXAMPLE_I2C_SCL_PIN
 #define EXAMPLE_I2C_SCL_PIN TUYA_GPIO_NUM_20
@@ -34,6 +30,14 @@
 #ifndef EXAMPLE_I2C_SDA_PIN
 #define EXAMPLE_I2C_SDA_PIN TUYA_GPIO_NUM_21
 #endif
+
+/* Pin wired to INT1 of the BMI270 */
+#ifndef EXAMPLE_IMU_INT_PIN
+#define EXAMPLE_IMU_INT_PIN TUYA_GPIO_NUM_22
+#endif
+
+/* 200Hz read in batches of 40 samples, one burst read every 200ms */
+#define EXAMPLE_IMU_BATCH   40
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
@@ -50,10 +54,52 @@ static TUYA_IIC_BASE_CFG_T g_bmi270_i2c_cfg = {
 /***********************************************************
 ***********************function define**********************
 ***********************************************************/
-static int8_t set_accel_gyro_config(struct bmi2_dev *bmi2_dev);
 static float lsb_to_mps2(int16_t val, float g_range, uint8_t bit_width);
 static float lsb_to_dps(int16_t val, float dps, uint8_t bit_width);
 
+/**
+ * @brief prints the last sample of every batch
+ *
+ * @return none
+ */
+static void imu_batch_cb(const TDL_IMU_SAMPLE_T *samples, uint16_t num, void *arg)
+{
+    const TDL_IMU_SAMPLE_T *last = &samples[num - 1];
+
+    PR_DEBUG("--------------------------- Sensor Data -------------------------------");
+    PR_DEBUG("| Batch            |  %3d samples, last at %llu us", num, last->time_us);
+    PR_DEBUG("-----------------------------------------------------------------------");
+    PR_DEBUG("| Raw Accel (LSB)  |  X: %6d     |  Y: %6d     |  Z: %6d     |", last->acc[0], last->acc[1],
+             last->acc[2]);
+
+    /* Converting lsb to meter per second squared for 16 bit accelerometer at 2G range. */
+    PR_DEBUG("| Value (m/s²)     |  X: %6.2f     |  Y: %6.2f     |  Z: %6.2f     |", lsb_to_mps2(last->acc[0], 2, 16),
+             lsb_to_mps2(last->acc[1], 2, 16), lsb_to_mps2(last->acc[2], 2, 16));
+    PR_DEBUG("-----------------------------------------------------------------------");
+    PR_DEBUG("| Raw Gyro (LSB)   |  X: %6d     |  Y: %6d     |  Z: %6d     |", last->gyr[0], last->gyr[1],
+             last->gyr[2]);
+
+    /* Converting lsb to degree per second for 16 bit gyro at 2000dps range. */
+    PR_DEBUG("| Value (dps)      |  X: %6.2f     |  Y: %6.2f     |  Z: %6.2f     |", lsb_to_dps(last->gyr[0], 2000, 16),
+             lsb_to_dps(last->gyr[1], 2000, 16), lsb_to_dps(last->gyr[2], 2000, 16));
+    PR_DEBUG("-----------------------------------------------------------------------\n");
+}
+
+/**
+ * @brief prints the gestures and the attitude when they happen
+ *
+ * @return none
+ */
+static void imu_gesture_cb(TDL_IMU_GESTURE_E gesture, uint64_t time_us, void *arg)
+{
+    static const char *gesture_name[] = {"tap", "shake", "tilt", "pick-up"};
+    TDL_IMU_ATTITUDE_T attitude;
+
+    tdl_imu_fusion_get_attitude(&attitude);
+    PR_NOTICE("gesture %s at %llu us, roll %d pitch %d (0.01 deg)", gesture_name[gesture], time_us,
+              attitude.roll_cd, attitude.pitch_cd);
+}
+
 /**
  * @brief user_main
  *
@@ -64,20 +110,6 @@ void user_main(void)
     /* Status of api are returned to this variable. */
     OPERATE_RET ret = OPRT_OK;
 
-    /* Assign accel and gyro sensor to variable. */
-    uint8_t sensor_list[2] = { BMI2_ACCEL, BMI2_GYRO };
-
-    /* Sensor initialization configuration. */
-    struct bmi2_dev bmi2_dev;
-
-    /* Create an instance of sensor data structure. */
-    struct bmi2_sens_data sensor_data = { { 0 } };
-
-    /* Initialize the interrupt status of accel and gyro. */
-    uint16_t int_status = 0;
-
-    float x = 0, y = 0, z = 0;
-
     /* basic init */
     tal_log_init(TAL_LOG_LEVEL_DEBUG, 4096, (TAL_LOG_OUTPUT_CB)tkl_log_output);
 
@@ -102,156 +134,33 @@ void user_main(void)
         return;
     }
 
-    /* Interface reference is given as a parameter
-     * For I2C : BMI2_I2C_INTF
-     * For SPI : BMI2_SPI_INTF
-     */
-    uint8_t i2c_port = BMI270_I2C_PORT;
-    bmi2_dev.intf_ptr = &(i2c_port);
-    ret = bmi2_interface_init(&bmi2_dev, BMI2_I2C_INTF);
-    bmi2_error_codes_print_result(ret);
-
-    /* Initialize bmi270. */
-    ret = bmi270_init(&bmi2_dev);
-    bmi2_error_codes_print_result(ret);
-
-    /* Accel and gyro configuration settings. */
-    ret = set_accel_gyro_config(&bmi2_dev);
-    bmi2_error_codes_print_result(ret);
-
-    /* NOTE:
-    * Accel and Gyro enable must be done after setting configurations
-    */
-    ret = bmi270_sensor_enable(sensor_list, 2, &bmi2_dev);
-    bmi2_error_codes_print_result(ret);
-
-    while(1) {
-        /* To get the data ready interrupt status of accel and gyro. */
-        ret = bmi2_get_int_status(&int_status, &bmi2_dev);
-        bmi2_error_codes_print_result(ret);
-
-        /* To check the data ready interrupt status and print the status for 10 samples. */
-        if ((int_status & BMI2_ACC_DRDY_INT_MASK) && (int_status & BMI2_GYR_DRDY_INT_MASK))
-        {
-            /* Get accel and gyro data for x, y and z axis. */
-            ret = bmi2_get_sensor_data(&sensor_data, &bmi2_dev);
-            bmi2_error_codes_print_result(ret);
-
-            PR_DEBUG("--------------------------- Sensor Data -------------------------------");
-            PR_DEBUG("|                           Accelerometer Data                        |");
-            PR_DEBUG("-----------------------------------------------------------------------");
-            PR_DEBUG("| Raw Data (LSB)   |  X: %6d     |  Y: %6d     |  Z: %6d     |", 
-                   sensor_data.acc.x, sensor_data.acc.y, sensor_data.acc.z);
-
-            /* Converting lsb to meter per second squared for 16 bit accelerometer at 2G range. */
-            x = lsb_to_mps2(sensor_data.acc.x, 2, bmi2_dev.resolution);
-            y = lsb_to_mps2(sensor_data.acc.y, 2, bmi2_dev.resolution);
-            z = lsb_to_mps2(sensor_data.acc.z, 2, bmi2_dev.resolution);
-
-            PR_DEBUG("| Value (m/s²)     |  X: %6.2f     |  Y: %6.2f     |  Z: %6.2f     |", x, y, z);
-            PR_DEBUG("-----------------------------------------------------------------------");
-            PR_DEBUG("|                           Gyroscope Data                            |");
-            PR_DEBUG("-----------------------------------------------------------------------");
-            PR_DEBUG("| Raw Data (LSB)   |  X: %6d     |  Y: %6d     |  Z: %6d     |",
-                   sensor_data.gyr.x, sensor_data.gyr.y, sensor_data.gyr.z);
-
-            /* Converting lsb to degree per second for 16 bit gyro at 2000dps range. */
-            x = lsb_to_dps(sensor_data.gyr.x, 2000, bmi2_dev.resolution);
-            y = lsb_to_dps(sensor_data.gyr.y, 2000, bmi2_dev.resolution);
-            z = lsb_to_dps(sensor_data.gyr.z, 2000, bmi2_dev.resolution);
-
-            PR_DEBUG("| Value (dps)      |  X: %6.2f     |  Y: %6.2f     |  Z: %6.2f     |", x, y, z);
-            PR_DEBUG("-----------------------------------------------------------------------\n");
-        }       
-        tal_system_sleep(1000);
+    /* The service reads the FIFO on its watermark interrupt, nothing is polled. */
+    TDL_IMU_CFG_T imu_cfg = {
+        .port = BMI270_I2C_PORT,
+        .int_pin = EXAMPLE_IMU_INT_PIN,
+        .odr = BMI2_ACC_ODR_200HZ,
+        .acc_range = BMI2_ACC_RANGE_2G,
+        .gyr_range = BMI2_GYR_RANGE_2000,
+        .batch = EXAMPLE_IMU_BATCH,
+    };
+    tdl_imu_subscribe(imu_batch_cb, NULL);
+
+    /* Attitude and gestures in fixed point on the same batches. */
+    TDL_IMU_FUSION_CFG_T fusion_cfg = {
+        .acc_range_g = 2,
+        .gyr_range_dps = 2000,
+        .gesture_cb = imu_gesture_cb,
+        .arg = NULL,
+    };
+    tdl_imu_fusion_start(&fusion_cfg);
+    ret = tdl_imu_start(&imu_cfg);
+    if (ret != OPRT_OK) {
+        PR_ERR("Failed to start imu service: %d", ret);
     }
 
     return;
 }
 
-/*!
- * @brief This internal API is used to set configurations for accel and gyro.
- */
-static int8_t set_accel_gyro_config(struct bmi2_dev *bmi2_dev)
-{
-    /* Status of api are returned to this variable. */
-    int8_t ret;
-
-    /* Structure to define accelerometer and gyro configuration. */
-    struct bmi2_sens_config config[2];
-
-    /* Configure the type of feature. */
-    config[ACCEL].type = BMI2_ACCEL;
-    config[GYRO].type = BMI2_GYRO;
-
-    /* Get default configurations for the type of feature selected. */
-    ret = bmi270_get_sensor_config(config, 2, bmi2_dev);
-    bmi2_error_codes_print_result(ret);
-
-    /* Map data ready interrupt to interrupt pin. */
-    ret = bmi2_map_data_int(BMI2_DRDY_INT, BMI2_INT1, bmi2_dev);
-    bmi2_error_codes_print_result(ret);
-
-    if (ret == BMI2_OK)
-    {
-        /* NOTE: The user can change the following configuration parameters according to their requirement. */
-        /* Set Output Data Rate */
-        config[ACCEL].cfg.acc.odr = BMI2_ACC_ODR_200HZ;
-
-        /* Gravity range of the sensor (-/- 2G, 4G, 8G, 16G). */
-        config[ACCEL].cfg.acc.range = BMI2_ACC_RANGE_2G;
-
-        /* The bandwidth parameter is used to configure the number of sensor samples that are averaged
-         * if it is set to 2, then 2^(bandwidth parameter) samples
-         * are averaged, resulting in 4 averaged samples.
-         * Note1 : For more information, refer the datasheet.
-         * Note2 : A higher number of averaged samples will result in a lower noise level of the signal, but
-         * this has an adverse effect on the power consumed.
-         */
-        config[ACCEL].cfg.acc.bwp = BMI2_ACC_NORMAL_AVG4;
-
-        /* Enable the filter performance mode where averaging of samples
-         * will be done based on above set bandwidth and ODR.
-         * There are two modes
-         *  0 -> Ultra low power mode
-         *  1 -> High performance mode(Default)
-         * For more info refer datasheet.
-         */
-        config[ACCEL].cfg.acc.filter_perf = BMI2_PERF_OPT_MODE;
-
-        /* The user can change the following configuration parameters according to their requirement. */
-        /* Set Output Data Rate */
-        config[GYRO].cfg.gyr.odr = BMI2_GYR_ODR_200HZ;
-
-        /* Gyroscope Angular Rate Measurement Range.By default the range is 2000dps. */
-        config[GYRO].cfg.gyr.range = BMI2_GYR_RANGE_2000;
-
-        /* Gyroscope bandwidth parameters. By default the gyro bandwidth is in normal mode. */
-        config[GYRO].cfg.gyr.bwp = BMI2_GYR_NORMAL_MODE;
-
-        /* Enable/Disable the noise performance mode for precision yaw rate sensing
-         * There are two modes
-         *  0 -> Ultra low power mode(Default)
-         *  1 -> High performance mode
-         */
-        config[GYRO].cfg.gyr.noise_perf = BMI2_POWER_OPT_MODE;
-
-        /* Enable/Disable the filter performance mode where averaging of samples
-         * will be done based on above set bandwidth and ODR.
-         * There are two modes
-         *  0 -> Ultra low power mode
-         *  1 -> High performance mode(Default)
-         */
-        config[GYRO].cfg.gyr.filter_perf = BMI2_PERF_OPT_MODE;
-
-        /* Set the accel and gyro configurations. */
-        ret = bmi270_set_sensor_config(config, 2, bmi2_dev);
-        bmi2_error_codes_print_result(ret);
-    }
-
-    return ret;
-}
-
 /*!
  * @brief This function converts lsb to meter per second squared for 16 bit accelerometer at
  * range 2G, 4G, 8G or 16G.
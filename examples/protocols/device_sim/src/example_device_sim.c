@@ -0,0 +1,520 @@
+/**
+ * @file example_device_sim.c
+ * @brief Load simulator running many virtual devices on the Tuya MQTT service.
+ *
+ * Every virtual device owns a tuya_mqtt_context_t, the MQTT service of
+ * tuya_iot with its signature, PV2.3 framing and protocol dispatch, and runs it
+ * on its own thread as tuya_iot does. Reporter threads publish DP reports on
+ * the devices like the application threads of a real device, and commands of
+ * the broker (PRO_CMD) are answered with a report of the DPs they set. So the
+ * broker sees the traffic of a fleet of activated devices and the process
+ * shows what the SDK costs per device.
+ *
+ * The devices log in as activated devices, device i with:
+ * - devid:    SIM_DEVID_PREFIX and i, e.g. "simdev00042"
+ * - seckey:   "simsec" and i, the password is derived from it as on a device
+ * - localkey: "simlocalkey" and i, 16 bytes, the PV2.3 key
+ * so the private broker has to accept these or be set up for them.
+ *
+ * Traffic patterns:
+ * - SIM_PATTERN_SPREAD: every device reports every SIM_REPORT_INTERVAL_MS,
+ *                       starting at a random offset, +- SIM_REPORT_JITTER_PCT
+ * - SIM_PATTERN_BURST:  all devices report at the same time every interval,
+ *                       as after a power cut of a building
+ *
+ * Every SIM_STAT_INTERVAL_MS the counters are printed as
+ * "SIM,<metric>,<value>" lines. heap_per_device is the heap taken by the
+ * connected devices, cpu_us_per_report the CPU time of the process for one
+ * report on the LINUX platform.
+ *
+ * On the LINUX platform the first arguments override the device number, the
+ * report interval, the broker host and port:
+ *     device_sim [num] [interval_ms] [host] [port]
+ *
+ * The LAN service is a single instance in the SDK and is not simulated.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "tuya_cloud_types.h"
+
+#include "tal_api.h"
+#include "tkl_output.h"
+#include "cJSON.h"
+#include "mqtt_service.h"
+#include "tuya_config_defaults.h"
+#include "netmgr.h"
+#if defined(ENABLE_WIFI) && (ENABLE_WIFI == 1)
+#include "netconn_wifi.h"
+#endif
+#if defined(ENABLE_WIRED) && (ENABLE_WIRED == 1)
+#include "netconn_wired.h"
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#ifdef ENABLE_WIFI
+#define DEFAULT_WIFI_SSID "your-ssid-****"
+#define DEFAULT_WIFI_PSWD "your-pswd-****"
+#endif
+
+#ifndef SIM_BROKER_HOST
+#define SIM_BROKER_HOST "127.0.0.1"
+#endif
+
+#ifndef SIM_BROKER_PORT
+#define SIM_BROKER_PORT 1883
+#endif
+
+#ifndef SIM_DEVICE_NUM
+#define SIM_DEVICE_NUM 100
+#endif
+
+#ifndef SIM_DEVICE_MAX
+#define SIM_DEVICE_MAX 1000
+#endif
+
+#ifndef SIM_DEVID_PREFIX
+#define SIM_DEVID_PREFIX "simdev"
+#endif
+
+#define SIM_PATTERN_SPREAD 0
+#define SIM_PATTERN_BURST  1
+
+#ifndef SIM_PATTERN
+#define SIM_PATTERN SIM_PATTERN_SPREAD
+#endif
+
+#ifndef SIM_REPORT_INTERVAL_MS
+#define SIM_REPORT_INTERVAL_MS 10000
+#endif
+
+// random change of every interval, SIM_PATTERN_SPREAD only
+#ifndef SIM_REPORT_JITTER_PCT
+#define SIM_REPORT_JITTER_PCT 10
+#endif
+
+// DPs in one report, bools and values in turn from DP 1
+#ifndef SIM_REPORT_DP_NUM
+#define SIM_REPORT_DP_NUM 4
+#endif
+
+#ifndef SIM_REPORTER_NUM
+#define SIM_REPORTER_NUM 2
+#endif
+
+// delay between two device connects, 0 connects all at once
+#ifndef SIM_CONNECT_RAMP_MS
+#define SIM_CONNECT_RAMP_MS 20
+#endif
+
+#ifndef SIM_STAT_INTERVAL_MS
+#define SIM_STAT_INTERVAL_MS 10000
+#endif
+
+#ifndef SIM_DEVICE_STACK_SIZE
+#define SIM_DEVICE_STACK_SIZE (16 * 1024)
+#endif
+
+#define SIM_TICK_MS 10
+
+#define SIM_OUT(metric, fmt, ...) PR_DEBUG_RAW("SIM,%s," fmt "\r\n", metric, ##__VA_ARGS__)
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    uint16_t idx;
+    char devid[TUYA_MQTT_DEVICE_ID_MAXLEN + 1];
+    char seckey[17];
+    char localkey[17];
+    tuya_mqtt_context_t mqctx;
+    THREAD_HANDLE thread;
+    SYS_TIME_T next_report;
+    int32_t value;
+} SIM_DEVICE_T;
+
+typedef struct {
+    uint32_t connected;
+    uint32_t connects;
+    uint32_t disconnects;
+    uint32_t reports;
+    uint32_t report_fails;
+    uint32_t commands;
+} SIM_STAT_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static uint32_t sg_device_num = SIM_DEVICE_NUM;
+static uint32_t sg_interval_ms = SIM_REPORT_INTERVAL_MS;
+static const char *sg_host = SIM_BROKER_HOST;
+static uint16_t sg_port = SIM_BROKER_PORT;
+
+static SIM_DEVICE_T *sg_devices = NULL;
+static THREAD_HANDLE sg_reporter[SIM_REPORTER_NUM];
+static MUTEX_HANDLE sg_stat_mutex = NULL;
+static SIM_STAT_T sg_stat;
+static netmgr_status_e sg_netmgr_status = NETMGR_LINK_DOWN;
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static void __sim_stat_add(uint32_t *counter, int32_t n)
+{
+    tal_mutex_lock(sg_stat_mutex);
+    *counter += n;
+    tal_mutex_unlock(sg_stat_mutex);
+}
+
+static OPERATE_RET __sim_report(SIM_DEVICE_T *dev, const char *dps)
+{
+    char buf[256];
+    int len = snprintf(buf, sizeof(buf), "{\"devId\":\"%s\",\"dps\":%s}", dev->devid, dps);
+    if (len < 0 || len >= (int)sizeof(buf)) {
+        return OPRT_BUFFER_NOT_ENOUGH;
+    }
+
+    //! the path of tuya_iot_dp_report_json
+    OPERATE_RET rt = tuya_mqtt_protocol_data_publish(&dev->mqctx, PRO_DATA_PUSH, (const uint8_t *)buf, len);
+    __sim_stat_add(OPRT_OK == rt ? &sg_stat.reports : &sg_stat.report_fails, 1);
+    return rt;
+}
+
+static void __sim_report_dps(SIM_DEVICE_T *dev)
+{
+    char dps[160];
+    int i = 0, len = 0;
+
+    dev->value++;
+    len += snprintf(dps + len, sizeof(dps) - len, "{");
+    for (i = 1; i <= SIM_REPORT_DP_NUM && len < (int)sizeof(dps); i++) {
+        if (i & 1) {
+            len += snprintf(dps + len, sizeof(dps) - len, "%s\"%d\":%s", i > 1 ? "," : "", i,
+                            (dev->value & 1) ? "true" : "false");
+        } else {
+            len += snprintf(dps + len, sizeof(dps) - len, ",\"%d\":%d", i, (int)(dev->value % 1000));
+        }
+    }
+    if (len < (int)sizeof(dps)) {
+        snprintf(dps + len, sizeof(dps) - len, "}");
+    }
+    __sim_report(dev, dps);
+}
+
+//! a device answers a command with a report of what it set
+static void __sim_cmd_on(tuya_protocol_event_t *ev)
+{
+    SIM_DEVICE_T *dev = (SIM_DEVICE_T *)ev->user_data;
+    cJSON *dps = cJSON_GetObjectItem((cJSON *)ev->data, "dps");
+
+    __sim_stat_add(&sg_stat.commands, 1);
+    if (NULL == dps) {
+        return;
+    }
+    char *out = cJSON_PrintUnformatted(dps);
+    if (out) {
+        __sim_report(dev, out);
+        cJSON_free(out);
+    }
+}
+
+static void __sim_connected_on(void *context, void *user_data)
+{
+    tal_mutex_lock(sg_stat_mutex);
+    sg_stat.connected++;
+    sg_stat.connects++;
+    tal_mutex_unlock(sg_stat_mutex);
+}
+
+static void __sim_disconnect_on(void *context, void *user_data)
+{
+    tal_mutex_lock(sg_stat_mutex);
+    sg_stat.connected--;
+    sg_stat.disconnects++;
+    tal_mutex_unlock(sg_stat_mutex);
+}
+
+static void __sim_device_task(void *args)
+{
+    SIM_DEVICE_T *dev = (SIM_DEVICE_T *)args;
+
+    tuya_mqtt_start(&dev->mqctx);
+    while (THREAD_STATE_RUNNING == tal_thread_get_state(dev->thread)) {
+        tuya_mqtt_loop(&dev->mqctx);
+    }
+}
+
+static SYS_TIME_T __sim_next_interval(void)
+{
+#if SIM_PATTERN == SIM_PATTERN_BURST
+    return sg_interval_ms;
+#else
+    uint32_t jitter = sg_interval_ms * SIM_REPORT_JITTER_PCT / 100;
+    if (0 == jitter) {
+        return sg_interval_ms;
+    }
+    return sg_interval_ms - jitter + tal_system_get_random(2 * jitter);
+#endif
+}
+
+static void __sim_reporter_task(void *args)
+{
+    uint32_t first = (uint32_t)(uintptr_t)args;
+    uint32_t i = 0;
+    SYS_TIME_T now = 0;
+
+    while (THREAD_STATE_RUNNING == tal_thread_get_state(sg_reporter[first])) {
+        now = tal_system_get_millisecond();
+        for (i = first; i < sg_device_num; i += SIM_REPORTER_NUM) {
+            SIM_DEVICE_T *dev = &sg_devices[i];
+            if (now < dev->next_report || !tuya_mqtt_connected(&dev->mqctx)) {
+                continue;
+            }
+            __sim_report_dps(dev);
+#if SIM_PATTERN == SIM_PATTERN_BURST
+            dev->next_report += __sim_next_interval();
+#else
+            dev->next_report = now + __sim_next_interval();
+#endif
+        }
+        tal_system_sleep(SIM_TICK_MS);
+    }
+}
+
+static OPERATE_RET __sim_device_init(SIM_DEVICE_T *dev, uint16_t idx, SYS_TIME_T start)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    dev->idx = idx;
+    snprintf(dev->devid, sizeof(dev->devid), "%s%05u", SIM_DEVID_PREFIX, idx);
+    snprintf(dev->seckey, sizeof(dev->seckey), "simsec%010u", idx);
+    snprintf(dev->localkey, sizeof(dev->localkey), "simlocalkey%05u", idx);
+#if SIM_PATTERN == SIM_PATTERN_BURST
+    dev->next_report = start + sg_interval_ms;
+#else
+    dev->next_report = start + tal_system_get_random(sg_interval_ms);
+#endif
+
+    TUYA_CALL_ERR_RETURN(tuya_mqtt_init(&dev->mqctx, &(const tuya_mqtt_config_t){
+                                                         .host = sg_host,
+                                                         .port = sg_port,
+                                                         .devid = dev->devid,
+                                                         .seckey = dev->seckey,
+                                                         .localkey = dev->localkey,
+                                                         .timeout = MQTT_RECV_BLOCK_TIME_MS,
+                                                         .user_data = dev,
+                                                         .on_connected = __sim_connected_on,
+                                                         .on_disconnect = __sim_disconnect_on,
+                                                     }));
+    TUYA_CALL_ERR_RETURN(tuya_mqtt_protocol_register(&dev->mqctx, PRO_CMD, __sim_cmd_on, dev));
+
+    THREAD_CFG_T cfg = {SIM_DEVICE_STACK_SIZE, THREAD_PRIO_3, dev->devid};
+    return tal_thread_create_and_start(&dev->thread, NULL, NULL, __sim_device_task, dev, &cfg);
+}
+
+static void __sim_stat_print(int heap_start)
+{
+    SIM_STAT_T stat;
+    int heap = tal_system_get_free_heap_size();
+
+    tal_mutex_lock(sg_stat_mutex);
+    stat = sg_stat;
+    tal_mutex_unlock(sg_stat_mutex);
+
+    SIM_OUT("devices", "%u", sg_device_num);
+    SIM_OUT("connected", "%u", stat.connected);
+    SIM_OUT("connects", "%u", stat.connects);
+    SIM_OUT("disconnects", "%u", stat.disconnects);
+    SIM_OUT("reports", "%u", stat.reports);
+    SIM_OUT("report_fails", "%u", stat.report_fails);
+    SIM_OUT("commands", "%u", stat.commands);
+    SIM_OUT("heap_free", "%d", heap);
+    if (stat.connected && heap_start > heap) {
+        SIM_OUT("heap_per_device", "%d", (heap_start - heap) / (int)stat.connected);
+    }
+#if OPERATING_SYSTEM == SYSTEM_LINUX
+    uint64_t cpu_us = (uint64_t)clock() * 1000000 / CLOCKS_PER_SEC;
+    SIM_OUT("cpu_ms", "%u", (uint32_t)(cpu_us / 1000));
+    if (stat.reports) {
+        SIM_OUT("cpu_us_per_report", "%u", (uint32_t)(cpu_us / stat.reports));
+    }
+#endif
+}
+
+static void __sim_run(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint32_t i = 0;
+    int heap_start = tal_system_get_free_heap_size();
+    SYS_TIME_T start = 0;
+
+    if (0 == sg_device_num || sg_device_num > SIM_DEVICE_MAX) {
+        PR_ERR("device num %u out of 1..%u", sg_device_num, SIM_DEVICE_MAX);
+        return;
+    }
+    TUYA_CALL_ERR_LOG(tal_mutex_create_init(&sg_stat_mutex));
+    sg_devices = tal_calloc(sg_device_num, sizeof(SIM_DEVICE_T));
+    if (NULL == sg_devices || OPRT_OK != rt) {
+        PR_ERR("sim init fail");
+        return;
+    }
+
+    PR_NOTICE("simulating %u devices on %s:%u, report every %u ms", sg_device_num, sg_host, sg_port, sg_interval_ms);
+    SIM_OUT("context_bytes", "%u", (uint32_t)sizeof(SIM_DEVICE_T));
+
+    start = tal_system_get_millisecond();
+    for (i = 0; i < sg_device_num; i++) {
+        rt = __sim_device_init(&sg_devices[i], i, start);
+        if (OPRT_OK != rt) {
+            PR_ERR("device %u init fail %d, %u devices run", i, rt, i);
+            sg_device_num = i;
+            break;
+        }
+        if (SIM_CONNECT_RAMP_MS) {
+            tal_system_sleep(SIM_CONNECT_RAMP_MS);
+        }
+    }
+
+    for (i = 0; i < SIM_REPORTER_NUM; i++) {
+        THREAD_CFG_T cfg = {4096, THREAD_PRIO_3, "sim_report"};
+        tal_thread_create_and_start(&sg_reporter[i], NULL, NULL, __sim_reporter_task, (void *)(uintptr_t)i, &cfg);
+    }
+
+    while (1) {
+        tal_system_sleep(SIM_STAT_INTERVAL_MS);
+        __sim_stat_print(heap_start);
+    }
+}
+
+/**
+ * @brief  __link_status_cb
+ *
+ * @param[in] data: link status
+ * @return OPERATE_RET
+ */
+static OPERATE_RET __link_status_cb(void *data)
+{
+    PR_DEBUG("link status changed: %d", (netmgr_status_e)data);
+    sg_netmgr_status = (netmgr_status_e)data;
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief user_main
+ *
+ * @return void
+ */
+void user_main(void)
+{
+    /* basic init */
+    tal_log_init(TAL_LOG_LEVEL_NOTICE, 1024, (TAL_LOG_OUTPUT_CB)tkl_log_output);
+
+    PR_NOTICE("Application information:");
+    PR_NOTICE("Project name:        %s", PROJECT_NAME);
+    PR_NOTICE("App version:         %s", PROJECT_VERSION);
+    PR_NOTICE("Compile time:        %s", __DATE__);
+    PR_NOTICE("TuyaOpen version:    %s", OPEN_VERSION);
+    PR_NOTICE("TuyaOpen commit-id:  %s", OPEN_COMMIT);
+    PR_NOTICE("Platform chip:       %s", PLATFORM_CHIP);
+    PR_NOTICE("Platform board:      %s", PLATFORM_BOARD);
+    PR_NOTICE("Platform commit-id:  %s", PLATFORM_COMMIT);
+
+    tal_kv_init(&(tal_kv_cfg_t){
+        .seed = "vmlkasdh93dlvlcy",
+        .key = "dflfuap134ddlduq",
+    });
+    tal_sw_timer_init();
+    tal_workq_init();
+    tal_event_subscribe(EVENT_LINK_STATUS_CHG, "device_sim", __link_status_cb, SUBSCRIBE_TYPE_NORMAL);
+
+#if defined(ENABLE_LIBLWIP) && (ENABLE_LIBLWIP == 1)
+    TUYA_LwIP_Init();
+#endif
+
+    // network init
+    netmgr_type_e type = 0;
+#if defined(ENABLE_WIFI) && (ENABLE_WIFI == 1)
+    type |= NETCONN_WIFI;
+#endif
+#if defined(ENABLE_WIRED) && (ENABLE_WIRED == 1)
+    type |= NETCONN_WIRED;
+#endif
+    netmgr_init(type);
+
+#if defined(ENABLE_WIFI) && (ENABLE_WIFI == 1)
+    netconn_wifi_info_t wifi_info = {0};
+    // connect wifi
+    strcpy(wifi_info.ssid, DEFAULT_WIFI_SSID);
+    strcpy(wifi_info.pswd, DEFAULT_WIFI_PSWD);
+    netmgr_conn_set(NETCONN_WIFI, NETCONN_CMD_SSID_PSWD, &wifi_info);
+#endif
+
+    while (sg_netmgr_status != NETMGR_LINK_UP) {
+        tal_system_sleep(50);
+    }
+    __sim_run();
+}
+
+/**
+ * @brief main
+ *
+ * @param argc
+ * @param argv
+ * @return void
+ */
+#if OPERATING_SYSTEM == SYSTEM_LINUX
+void main(int argc, char *argv[])
+{
+    if (argc > 1) {
+        sg_device_num = (uint32_t)atoi(argv[1]);
+    }
+    if (argc > 2) {
+        sg_interval_ms = (uint32_t)atoi(argv[2]);
+    }
+    if (argc > 3) {
+        sg_host = argv[3];
+    }
+    if (argc > 4) {
+        sg_port = (uint16_t)atoi(argv[4]);
+    }
+
+    user_main();
+
+    while (1) {
+        tal_system_sleep(500);
+    }
+}
+#else
+
+/* Tuya thread handle */
+static THREAD_HANDLE ty_app_thread = NULL;
+
+/**
+ * @brief  task thread
+ *
+ * @param[in] arg:Parameters when creating a task
+ * @return none
+ */
+static void tuya_app_thread(void *arg)
+{
+    user_main();
+
+    tal_thread_delete(ty_app_thread);
+    ty_app_thread = NULL;
+}
+
+void tuya_app_main(void)
+{
+    THREAD_CFG_T thrd_param = {4096, 4, "tuya_app_main"};
+    tal_thread_create_and_start(&ty_app_thread, NULL, NULL, tuya_app_thread, NULL, &thrd_param);
+}
+#endif
@@ -0,0 +1,459 @@
+/**
+ * @file example_container_bench.c
+ * @brief Benchmark of the containers in src/common/utilities against the
+ * linear scans and the OS queue they are meant to replace.
+ *
+ * Prints every result as one line "BENCH,<group>,<metric>,<value>", the same
+ * as proto_bench, for tools/ut/bench_compare.py:
+ *
+ * - hash_int_get / scan_int_get: lookup of one of BENCH_N integer keys in a
+ *                                hash_map and in an array scanned in order
+ * - hash_str_get / scan_str_get: the same with string keys and strcmp()
+ * - hash_put_remove:             hash_map_remove() and hash_map_put() of a key
+ * - heap_pop_push:               min_heap_pop() and min_heap_push() of a node
+ *                                with a later key, BENCH_N nodes queued
+ * - heap_update:                 min_heap_update() of a random node
+ * - scan_min:                    the earliest of BENCH_N keys by a scan
+ * - msg_ring_push_pop / mpsc_ring_push_pop / tal_queue_post_fetch:
+ *                                one BENCH_MSG_SIZE message through the ring
+ *                                or the queue
+ * - bitmap_get_put:              bitmap_alloc_get() and bitmap_alloc_put() on
+ *                                a map with every other slot taken
+ *
+ * Rounds, median and spread are computed as in proto_bench.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tuya_cloud_types.h"
+
+#include "tal_api.h"
+#include "tkl_output.h"
+#include "hash_map.h"
+#include "min_heap.h"
+#include "msg_ring.h"
+#include "bitmap_alloc.h"
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#ifndef BENCH_MIN_MS
+#define BENCH_MIN_MS 100
+#endif
+
+#ifndef BENCH_ROUNDS
+#define BENCH_ROUNDS 5
+#endif
+
+// entries of the maps and heaps, about the number of DPs or timers of a device
+#ifndef BENCH_N
+#define BENCH_N 64
+#endif
+
+#define BENCH_MSG_SIZE  16
+#define BENCH_RING_NUM  16
+#define BENCH_BITMAP_N  256
+#define BENCH_KEY_LEN   16
+
+#define BENCH_OUT(group, metric, fmt, ...) PR_DEBUG_RAW("BENCH,%s,%s," fmt "\r\n", group, metric, ##__VA_ARGS__)
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef OPERATE_RET (*BENCH_FN)(void);
+
+typedef struct {
+    const char *name;
+    BENCH_FN fn;
+} BENCH_ITEM_T;
+
+typedef struct {
+    MIN_HEAP_NODE_T node;
+    uint32_t id;
+} BENCH_TIMER_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static uint32_t sg_int_key[BENCH_N];
+static char sg_str_key[BENCH_N][BENCH_KEY_LEN];
+static char sg_str_probe[BENCH_N][BENCH_KEY_LEN]; // equal strings at other addresses
+
+static HASH_MAP_SLOT_T sg_int_slot[256];
+static HASH_MAP_SLOT_T sg_str_slot[256];
+static HASH_MAP_T sg_int_map;
+static HASH_MAP_T sg_str_map;
+
+static BENCH_TIMER_T sg_timer[BENCH_N];
+static MIN_HEAP_NODE_T *sg_heap_node[BENCH_N];
+static MIN_HEAP_T sg_heap;
+static uint32_t sg_scan_key[BENCH_N];
+
+static uint32_t sg_msg_buf[BENCH_MSG_SIZE * BENCH_RING_NUM / sizeof(uint32_t)];
+static uint32_t sg_mpsc_buf[MPSC_RING_BUF_SIZE(BENCH_MSG_SIZE, BENCH_RING_NUM) / sizeof(uint32_t)];
+static MSG_RING_T sg_msg_ring;
+static MPSC_RING_T sg_mpsc_ring;
+static QUEUE_HANDLE sg_queue = NULL;
+
+static uint32_t sg_bitmap_word[BITMAP_ALLOC_WORDS(BENCH_BITMAP_N)];
+static BITMAP_ALLOC_T sg_bitmap;
+
+static uint32_t sg_pos = 0;
+static uint32_t sg_rand = 0x12345678;
+static uint32_t sg_sink = 0; // keeps the results from being optimized away
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+//! xorshift32, cheaper than the platform random and the same on every run
+static uint32_t __bench_rand(void)
+{
+    sg_rand ^= sg_rand << 13;
+    sg_rand ^= sg_rand >> 17;
+    sg_rand ^= sg_rand << 5;
+    return sg_rand;
+}
+
+static uint32_t __bench_next(void)
+{
+    sg_pos = (sg_pos + 1) % BENCH_N;
+    return sg_pos;
+}
+
+static OPERATE_RET __bench_hash_int_get(void)
+{
+    void *value = hash_map_get(&sg_int_map, sg_int_key[__bench_next()]);
+    TUYA_CHECK_NULL_RETURN(value, OPRT_NOT_FOUND);
+    sg_sink += (uint32_t)(uintptr_t)value;
+    return OPRT_OK;
+}
+
+static OPERATE_RET __bench_scan_int_get(void)
+{
+    uint32_t key = sg_int_key[__bench_next()];
+    uint32_t i = 0;
+
+    for (i = 0; i < BENCH_N; i++) {
+        if (sg_int_key[i] == key) {
+            sg_sink += i;
+            return OPRT_OK;
+        }
+    }
+    return OPRT_NOT_FOUND;
+}
+
+static OPERATE_RET __bench_hash_str_get(void)
+{
+    void *value = hash_map_get(&sg_str_map, HASH_MAP_STR(sg_str_probe[__bench_next()]));
+    TUYA_CHECK_NULL_RETURN(value, OPRT_NOT_FOUND);
+    sg_sink += (uint32_t)(uintptr_t)value;
+    return OPRT_OK;
+}
+
+static OPERATE_RET __bench_scan_str_get(void)
+{
+    const char *key = sg_str_probe[__bench_next()];
+    uint32_t i = 0;
+
+    for (i = 0; i < BENCH_N; i++) {
+        if (0 == strcmp(sg_str_key[i], key)) {
+            sg_sink += i;
+            return OPRT_OK;
+        }
+    }
+    return OPRT_NOT_FOUND;
+}
+
+static OPERATE_RET __bench_hash_put_remove(void)
+{
+    uint32_t key = sg_int_key[__bench_next()];
+    void *value = hash_map_remove(&sg_int_map, key);
+
+    TUYA_CHECK_NULL_RETURN(value, OPRT_NOT_FOUND);
+    return hash_map_put(&sg_int_map, key, value, NULL);
+}
+
+static OPERATE_RET __bench_heap_pop_push(void)
+{
+    MIN_HEAP_NODE_T *node = min_heap_pop(&sg_heap);
+
+    TUYA_CHECK_NULL_RETURN(node, OPRT_NOT_FOUND);
+    sg_sink += MIN_HEAP_ENTRY(node, BENCH_TIMER_T, node)->id;
+    return min_heap_push(&sg_heap, node, node->key + 1 + __bench_rand() % 1000);
+}
+
+static OPERATE_RET __bench_heap_update(void)
+{
+    MIN_HEAP_NODE_T *node = &sg_timer[__bench_rand() % BENCH_N].node;
+
+    min_heap_update(&sg_heap, node, min_heap_peek(&sg_heap)->key + __bench_rand() % 1000);
+    return OPRT_OK;
+}
+
+static OPERATE_RET __bench_scan_min(void)
+{
+    uint32_t i = 0, min = 0;
+
+    sg_scan_key[__bench_next()] += __bench_rand() % 1000;
+    for (i = 1; i < BENCH_N; i++) {
+        if ((int32_t)(sg_scan_key[i] - sg_scan_key[min]) < 0) {
+            min = i;
+        }
+    }
+    sg_sink += min;
+    return OPRT_OK;
+}
+
+static OPERATE_RET __bench_msg_ring_push_pop(void)
+{
+    uint32_t msg[BENCH_MSG_SIZE / sizeof(uint32_t)] = {sg_pos++};
+
+    if (!msg_ring_push(&sg_msg_ring, msg) || !msg_ring_pop(&sg_msg_ring, msg)) {
+        return OPRT_COM_ERROR;
+    }
+    sg_sink += msg[0];
+    return OPRT_OK;
+}
+
+static OPERATE_RET __bench_mpsc_ring_push_pop(void)
+{
+    uint32_t msg[BENCH_MSG_SIZE / sizeof(uint32_t)] = {sg_pos++};
+
+    if (!mpsc_ring_push(&sg_mpsc_ring, msg) || !mpsc_ring_pop(&sg_mpsc_ring, msg)) {
+        return OPRT_COM_ERROR;
+    }
+    sg_sink += msg[0];
+    return OPRT_OK;
+}
+
+static OPERATE_RET __bench_tal_queue_post_fetch(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint32_t msg[BENCH_MSG_SIZE / sizeof(uint32_t)] = {sg_pos++};
+
+    TUYA_CALL_ERR_RETURN(tal_queue_post(sg_queue, msg, 0));
+    TUYA_CALL_ERR_RETURN(tal_queue_fetch(sg_queue, msg, 0));
+    sg_sink += msg[0];
+    return OPRT_OK;
+}
+
+static OPERATE_RET __bench_bitmap_get_put(void)
+{
+    int32_t index = bitmap_alloc_get(&sg_bitmap);
+
+    if (index < 0) {
+        return OPRT_EXCEED_UPPER_LIMIT;
+    }
+    bitmap_alloc_put(&sg_bitmap, (uint32_t)index);
+    sg_sink += (uint32_t)index;
+    return OPRT_OK;
+}
+
+static const BENCH_ITEM_T cBENCH_ITEM[] = {
+    {"hash_int_get", __bench_hash_int_get},
+    {"scan_int_get", __bench_scan_int_get},
+    {"hash_str_get", __bench_hash_str_get},
+    {"scan_str_get", __bench_scan_str_get},
+    {"hash_put_remove", __bench_hash_put_remove},
+    {"heap_pop_push", __bench_heap_pop_push},
+    {"heap_update", __bench_heap_update},
+    {"scan_min", __bench_scan_min},
+    {"msg_ring_push_pop", __bench_msg_ring_push_pop},
+    {"mpsc_ring_push_pop", __bench_mpsc_ring_push_pop},
+    {"tal_queue_post_fetch", __bench_tal_queue_post_fetch},
+    {"bitmap_get_put", __bench_bitmap_get_put},
+};
+
+//! one round, ns per call of all calls within BENCH_MIN_MS
+static OPERATE_RET __bench_round(const BENCH_ITEM_T *item, uint32_t *ns)
+{
+    OPERATE_RET rt = OPRT_OK;
+    SYS_TIME_T t0 = 0, ms = 0;
+    uint32_t calls = 0;
+
+    t0 = tal_system_get_millisecond();
+    do {
+        TUYA_CALL_ERR_RETURN(item->fn());
+        calls++;
+        ms = tal_system_get_millisecond() - t0;
+    } while (ms < BENCH_MIN_MS);
+    *ns = (uint32_t)((uint64_t)ms * 1000000 / calls);
+
+    return OPRT_OK;
+}
+
+static void __bench_run(const BENCH_ITEM_T *item)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint32_t ns[BENCH_ROUNDS];
+    uint32_t i = 0, j = 0, tmp = 0, median = 0;
+
+    //! a warm-up call, the first one pays for the caches
+    rt = item->fn();
+    tal_log_set_level(TAL_LOG_LEVEL_ERR);
+    for (i = 0; OPRT_OK == rt && i < BENCH_ROUNDS; i++) {
+        rt = __bench_round(item, &ns[i]);
+    }
+    tal_log_set_level(TAL_LOG_LEVEL_DEBUG);
+    if (OPRT_OK != rt) {
+        PR_ERR("%s fail %d", item->name, rt);
+        return;
+    }
+
+    for (i = 1; i < BENCH_ROUNDS; i++) {
+        for (j = i; j > 0 && ns[j - 1] > ns[j]; j--) {
+            tmp = ns[j];
+            ns[j] = ns[j - 1];
+            ns[j - 1] = tmp;
+        }
+    }
+    median = ns[BENCH_ROUNDS / 2];
+    BENCH_OUT(item->name, "ns_per_call", "%u", median);
+    BENCH_OUT(item->name, "ns_best", "%u", ns[0]);
+    BENCH_OUT(item->name, "spread_permille", "%u",
+              median ? (uint32_t)((uint64_t)(ns[BENCH_ROUNDS - 1] - ns[0]) * 1000 / median) : 0);
+}
+
+static OPERATE_RET __bench_fixture_init(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint32_t i = 0;
+
+    TUYA_CALL_ERR_RETURN(hash_map_init(&sg_int_map, sg_int_slot, hash_map_slots(BENCH_N), HASH_MAP_KEY_INT));
+    TUYA_CALL_ERR_RETURN(hash_map_init(&sg_str_map, sg_str_slot, hash_map_slots(BENCH_N), HASH_MAP_KEY_STR));
+    min_heap_init(&sg_heap, sg_heap_node, BENCH_N);
+
+    for (i = 0; i < BENCH_N; i++) {
+        sg_int_key[i] = __bench_rand();
+        snprintf(sg_str_key[i], BENCH_KEY_LEN, "dp_%u", (unsigned)(sg_int_key[i] % 100000));
+        strcpy(sg_str_probe[i], sg_str_key[i]);
+        TUYA_CALL_ERR_RETURN(hash_map_put(&sg_int_map, sg_int_key[i], (void *)(uintptr_t)(i + 1), NULL));
+        TUYA_CALL_ERR_RETURN(hash_map_put(&sg_str_map, HASH_MAP_STR(sg_str_key[i]), (void *)(uintptr_t)(i + 1), NULL));
+
+        sg_timer[i].id = i;
+        min_heap_node_init(&sg_timer[i].node);
+        TUYA_CALL_ERR_RETURN(min_heap_push(&sg_heap, &sg_timer[i].node, __bench_rand() % 1000));
+        sg_scan_key[i] = sg_timer[i].node.key;
+    }
+
+    if (0 != msg_ring_init(&sg_msg_ring, sg_msg_buf, BENCH_MSG_SIZE, BENCH_RING_NUM) ||
+        0 != mpsc_ring_init(&sg_mpsc_ring, sg_mpsc_buf, BENCH_MSG_SIZE, BENCH_RING_NUM)) {
+        return OPRT_INVALID_PARM;
+    }
+    TUYA_CALL_ERR_RETURN(tal_queue_create_init(&sg_queue, BENCH_MSG_SIZE, BENCH_RING_NUM));
+
+    bitmap_alloc_init(&sg_bitmap, sg_bitmap_word, BENCH_BITMAP_N);
+    for (i = 0; i < BENCH_BITMAP_N; i++) {
+        bitmap_alloc_get(&sg_bitmap);
+    }
+    for (i = 0; i < BENCH_BITMAP_N; i += 2) {
+        bitmap_alloc_put(&sg_bitmap, i);
+    }
+
+    return OPRT_OK;
+}
+
+static void __bench_fixture_deinit(void)
+{
+    if (sg_queue) {
+        tal_queue_free(sg_queue);
+        sg_queue = NULL;
+    }
+}
+
+static void __bench_env(void)
+{
+    BENCH_OUT("env", "board", "%s", PLATFORM_BOARD);
+    BENCH_OUT("env", "min_ms", "%d", BENCH_MIN_MS);
+    BENCH_OUT("env", "rounds", "%d", BENCH_ROUNDS);
+    BENCH_OUT("env", "entries", "%d", BENCH_N);
+    BENCH_OUT("env", "hash_slots", "%u", sg_int_map.mask + 1);
+    BENCH_OUT("env", "msg_bytes", "%d", BENCH_MSG_SIZE);
+}
+
+/**
+ * @brief user_main
+ *
+ * @return none
+ */
+void user_main(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint32_t i = 0;
+
+    /* basic init */
+    tal_log_init(TAL_LOG_LEVEL_DEBUG, 1024, (TAL_LOG_OUTPUT_CB)tkl_log_output);
+
+    PR_NOTICE("Application information:");
+    PR_NOTICE("Project name:        %s", PROJECT_NAME);
+    PR_NOTICE("App version:         %s", PROJECT_VERSION);
+    PR_NOTICE("Compile time:        %s", __DATE__);
+    PR_NOTICE("TuyaOpen version:    %s", OPEN_VERSION);
+    PR_NOTICE("TuyaOpen commit-id:  %s", OPEN_COMMIT);
+    PR_NOTICE("Platform chip:       %s", PLATFORM_CHIP);
+    PR_NOTICE("Platform board:      %s", PLATFORM_BOARD);
+    PR_NOTICE("Platform commit-id:  %s", PLATFORM_COMMIT);
+
+    TUYA_CALL_ERR_GOTO(__bench_fixture_init(), exit);
+
+    PR_NOTICE("------ container bench start ------");
+    __bench_env();
+
+    for (i = 0; i < CNTSOF(cBENCH_ITEM); i++) {
+        __bench_run(&cBENCH_ITEM[i]);
+    }
+
+    PR_NOTICE("------ container bench done ------");
+    PR_DEBUG("result sink %u", sg_sink);
+
+exit:
+    __bench_fixture_deinit();
+
+    return;
+}
+
+/**
+ * @brief main
+ *
+ * @param argc
+ * @param argv
+ * @return void
+ */
+#if OPERATING_SYSTEM == SYSTEM_LINUX
+void main(int argc, char *argv[])
+{
+    user_main();
+
+    while (1) {
+        tal_system_sleep(500);
+    }
+}
+#else
+
+/* Tuya thread handle */
+static THREAD_HANDLE ty_app_thread = NULL;
+
+/**
+ * @brief  task thread
+ *
+ * @param[in] arg:Parameters when creating a task
+ * @return none
+ */
+static void tuya_app_thread(void *arg)
+{
+    user_main();
+
+    tal_thread_delete(ty_app_thread);
+    ty_app_thread = NULL;
+}
+
+void tuya_app_main(void)
+{
+    THREAD_CFG_T thrd_param = {4096, 4, "tuya_app_main"};
+    tal_thread_create_and_start(&ty_app_thread, NULL, NULL, tuya_app_thread, NULL, &thrd_param);
+}
+#endif
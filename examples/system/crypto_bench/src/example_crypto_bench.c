@@ -0,0 +1,579 @@
+/**
+ * @file example_crypto_bench.c
+ * @brief Benchmark of the crypto primitives and the frame encryption of the
+ * cloud and AI protocols.
+ *
+ * Runs a fixed sequence of measurements and prints every result as one line
+ * "BENCH,<group>,<metric>,<value>" so it can be collected from the log, e.g.
+ * with grep "^BENCH," and compared between chips and crypto backends:
+ *
+ * - <primitive>_<size>: calls, us_per_call and kbps of one primitive on one
+ *                       payload size. The tal_aes*_raw functions run with the
+ *                       key schedule cached, "gcm" is cipher_wrapper with a
+ *                       persistent context
+ * - lpv35_<size>:       lpv35_frame_serialize() and lpv35_frame_seal(), the
+ *                       whole cloud frame with its GCM encryption
+ * - ai_sl<n>_<size>:    the steps of the AI packet encryption of security
+ *                       level n, padding, encryption and the HMAC-SHA256
+ *                       signature, as done by tuya_ai_protocol.c
+ * - ecdh / ecdsa:       us_per_call of the P-256 key exchange and signature
+ *                       verification of an ECDHE TLS handshake
+ * - base64_* / hex_*:   the codecs of mix_method with the bounds-checked
+ *                       functions, mbedtls_base64_* the mbedtls ones for
+ *                       comparison. <size> is the length of the binary data
+ * - crc32 / crc16:      hash_crc32i_update() and crc_16_update(), slicing-by-
+ *                       CRC32I_SLICE_BY or the TKL CRC engine, see "env"
+ *
+ * The backend is chosen at build time, group "env" reports which one this
+ * image uses: ENABLE_PLATFORM_AES and ENABLE_PLATFORM_SHA* select the TKL
+ * hardware drivers for tal_aes and tal_hash, and gcm_backend is "accel" when
+ * the platform registered a GCM accelerator with cipher_gcm_accel_register()
+ * before user_main. Build the example once with and once without them to
+ * compare hardware and software.
+ *
+ * Timestamps come from tal_system_get_millisecond(), so every primitive runs
+ * for at least BENCH_MIN_MS and the time of all calls is divided by their number.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tuya_cloud_types.h"
+
+#include "tal_api.h"
+#include "tal_security.h"
+#include "tkl_output.h"
+#include "cipher_wrapper.h"
+#include "tuya_protocol.h"
+#include "tuya_tls.h"
+#include "mix_method.h"
+#include "crc32i.h"
+#include "crc_16.h"
+#include "mbedtls/base64.h"
+#include "mbedtls/chacha20.h"
+#include "mbedtls/ecdh.h"
+#include "mbedtls/ecdsa.h"
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#ifndef BENCH_MIN_MS
+#define BENCH_MIN_MS 300
+#endif
+
+// the public key operations are slow, they run a fixed number of times
+#ifndef BENCH_PK_ROUNDS
+#define BENCH_PK_ROUNDS 8
+#endif
+
+#define BENCH_SIZE_MAX 4096
+#define BENCH_BUF_SIZE (LPV35_FRAME_MINI_SIZE + BENCH_SIZE_MAX + 32)
+#define BENCH_TEXT_SIZE (BENCH_SIZE_MAX * 2 + 1) // hex is the longer text
+
+#define BENCH_TEXT_BASE64 1
+#define BENCH_TEXT_HEX    2
+
+#define BENCH_OUT(group, metric, fmt, ...) PR_DEBUG_RAW("BENCH,%s,%s," fmt "\r\n", group, metric, ##__VA_ARGS__)
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef OPERATE_RET (*BENCH_FN)(uint8_t *buf, uint32_t len);
+
+typedef struct {
+    const char *name;
+    BENCH_FN fn;
+} BENCH_ITEM_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static const uint32_t cPAYLOAD_SIZE[] = {16, 64, 256, 1024, BENCH_SIZE_MAX};
+
+static const uint8_t cKEY[32] = {0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe, 0x2b, 0x73, 0xae,
+                                 0xf0, 0x85, 0x7d, 0x77, 0x81, 0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61,
+                                 0x08, 0xd7, 0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4};
+
+static uint8_t sg_buf[BENCH_BUF_SIZE];
+static uint8_t sg_out[BENCH_BUF_SIZE];
+static uint8_t sg_iv[16];
+static uint8_t sg_tag[32];
+static char sg_text[BENCH_TEXT_SIZE];
+static uint32_t sg_seq = 0;
+static uint32_t sg_crc = 0; // keeps the checksums from being optimized away
+
+static cipher_gcm_ctx_t sg_gcm;
+static tal_hash_mac_context_t sg_hmac;
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+//! block ciphers without padding get whole blocks
+static uint32_t __bench_block_len(uint32_t len)
+{
+    return len & ~15u;
+}
+
+static OPERATE_RET __bench_aes128_ecb(uint8_t *buf, uint32_t len)
+{
+    return tal_aes128_ecb_encode_raw(buf, __bench_block_len(len), buf, (uint8_t *)cKEY);
+}
+
+static OPERATE_RET __bench_aes128_cbc(uint8_t *buf, uint32_t len)
+{
+    return tal_aes128_cbc_encode_raw(buf, __bench_block_len(len), (uint8_t *)cKEY, sg_iv, buf);
+}
+
+static OPERATE_RET __bench_aes256_cbc(uint8_t *buf, uint32_t len)
+{
+    return tal_aes256_cbc_encode_raw(buf, __bench_block_len(len), (uint8_t *)cKEY, sg_iv, buf);
+}
+
+static OPERATE_RET __bench_aes256_ctr(uint8_t *buf, uint32_t len)
+{
+    uint8_t nonce_counter[16] = {0};
+    uint8_t stream_block[16];
+    size_t nc_off = 0;
+
+    return tal_aes256_ctr_raw(buf, len, (uint8_t *)cKEY, &nc_off, nonce_counter, stream_block, buf);
+}
+
+static OPERATE_RET __bench_gcm(uint8_t *buf, uint32_t len)
+{
+    uint8_t nonce[12];
+
+    cipher_gcm_ctx_nonce_next(&sg_gcm, nonce);
+    return cipher_gcm_ctx_auth_encrypt(&sg_gcm, nonce, sizeof(nonce), NULL, 0, buf, len, buf, sg_tag, 16);
+}
+
+static OPERATE_RET __bench_sha256(uint8_t *buf, uint32_t len)
+{
+    return tal_sha256_ret(buf, len, sg_tag, 0);
+}
+
+static OPERATE_RET __bench_sha1(uint8_t *buf, uint32_t len)
+{
+    return tal_sha1_ret(buf, len, sg_tag);
+}
+
+static OPERATE_RET __bench_md5(uint8_t *buf, uint32_t len)
+{
+    return tal_md5_ret(buf, len, sg_tag);
+}
+
+//! a started HMAC context as kept by the AI protocol, the key is not hashed again
+static OPERATE_RET __bench_hmac_sha256(uint8_t *buf, uint32_t len)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    TUYA_CALL_ERR_RETURN(tal_sha256_mac_update(&sg_hmac, buf, len));
+    TUYA_CALL_ERR_RETURN(tal_sha256_mac_finish(&sg_hmac, sg_tag));
+    return tal_sha256_mac_reset(&sg_hmac);
+}
+
+#if defined(MBEDTLS_CHACHA20_C)
+static OPERATE_RET __bench_chacha20(uint8_t *buf, uint32_t len)
+{
+    return mbedtls_chacha20_crypt(cKEY, sg_iv, 0, len, buf, buf);
+}
+#endif
+
+static OPERATE_RET __bench_lpv35_serialize(uint8_t *buf, uint32_t len)
+{
+    int olen = 0;
+    lpv35_frame_object_t frame = {
+        .sequence = sg_seq++,
+        .type = 0,
+        .data = buf,
+        .data_len = len,
+    };
+
+    return lpv35_frame_serialize(cKEY, 16, &frame, sg_out, &olen);
+}
+
+static OPERATE_RET __bench_lpv35_seal(uint8_t *buf, uint32_t len)
+{
+    int olen = 0;
+
+    //! seal encrypts in place, the plaintext is rebuilt for every frame as a caller would
+    memcpy(sg_out + LPV35_FRAME_HEADROOM, buf, len);
+    return lpv35_frame_seal(&sg_gcm, cKEY, 16, sg_seq++, 0, sg_out, len, &olen);
+}
+
+static OPERATE_RET __bench_ai_sl3(uint8_t *buf, uint32_t len)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    memcpy(sg_out, buf, len);
+    uint32_t en_len = tal_pkcs7padding_buffer(sg_out, len);
+    TUYA_CALL_ERR_RETURN(tal_aes256_cbc_encode_raw(sg_out, en_len, (uint8_t *)cKEY, sg_iv, sg_out));
+    return __bench_hmac_sha256(sg_out, en_len);
+}
+
+static OPERATE_RET __bench_ai_sl4(uint8_t *buf, uint32_t len)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    memcpy(sg_out, buf, len);
+    TUYA_CALL_ERR_RETURN(__bench_gcm(sg_out, len));
+    return __bench_hmac_sha256(sg_out, len + 16);
+}
+
+//! the text the decoders read, encoded again only when the data changes
+static int __bench_text(uint8_t kind, uint8_t *buf, uint32_t len)
+{
+    static uint8_t text_kind = 0;
+    static uint32_t text_src = 0;
+    static int text_len = 0;
+
+    if (kind != text_kind || len != text_src) {
+        if (BENCH_TEXT_HEX == kind) {
+            text_len = tuya_hex_encode(buf, len, sg_text, sizeof(sg_text), FALSE);
+        } else {
+            text_len = tuya_base64_encode_buf(buf, len, sg_text, sizeof(sg_text));
+        }
+        text_kind = kind;
+        text_src = len;
+    }
+    return text_len;
+}
+
+static OPERATE_RET __bench_base64_enc(uint8_t *buf, uint32_t len)
+{
+    return (tuya_base64_encode_buf(buf, len, sg_text, sizeof(sg_text)) < 0) ? OPRT_COM_ERROR : OPRT_OK;
+}
+
+static OPERATE_RET __bench_base64_dec(uint8_t *buf, uint32_t len)
+{
+    int text_len = __bench_text(BENCH_TEXT_BASE64, buf, len);
+
+    return (tuya_base64_decode_buf(sg_text, text_len, sg_out, sizeof(sg_out)) < 0) ? OPRT_COM_ERROR : OPRT_OK;
+}
+
+static OPERATE_RET __bench_mbedtls_base64_enc(uint8_t *buf, uint32_t len)
+{
+    size_t olen = 0;
+
+    return mbedtls_base64_encode((uint8_t *)sg_text, sizeof(sg_text), &olen, buf, len);
+}
+
+static OPERATE_RET __bench_mbedtls_base64_dec(uint8_t *buf, uint32_t len)
+{
+    size_t olen = 0;
+    int text_len = __bench_text(BENCH_TEXT_BASE64, buf, len);
+
+    return mbedtls_base64_decode(sg_out, sizeof(sg_out), &olen, (const uint8_t *)sg_text, text_len);
+}
+
+static OPERATE_RET __bench_hex_enc(uint8_t *buf, uint32_t len)
+{
+    return (tuya_hex_encode(buf, len, sg_text, sizeof(sg_text), FALSE) < 0) ? OPRT_COM_ERROR : OPRT_OK;
+}
+
+static OPERATE_RET __bench_hex_dec(uint8_t *buf, uint32_t len)
+{
+    int text_len = __bench_text(BENCH_TEXT_HEX, buf, len);
+
+    return (tuya_hex_decode(sg_text, text_len, sg_out, sizeof(sg_out)) < 0) ? OPRT_COM_ERROR : OPRT_OK;
+}
+
+static OPERATE_RET __bench_crc32(uint8_t *buf, uint32_t len)
+{
+    sg_crc ^= hash_crc32i_update(hash_crc32i_init(), buf, len);
+    return OPRT_OK;
+}
+
+static OPERATE_RET __bench_crc16(uint8_t *buf, uint32_t len)
+{
+    sg_crc ^= crc_16_update(CRC_16_INIT, buf, len);
+    return OPRT_OK;
+}
+
+static const BENCH_ITEM_T cBENCH_ITEM[] = {
+    {"aes128_ecb", __bench_aes128_ecb},
+    {"aes128_cbc", __bench_aes128_cbc},
+    {"aes256_cbc", __bench_aes256_cbc},
+    {"aes256_ctr", __bench_aes256_ctr},
+    {"gcm", __bench_gcm},
+    {"sha256", __bench_sha256},
+    {"sha1", __bench_sha1},
+    {"md5", __bench_md5},
+    {"hmac_sha256", __bench_hmac_sha256},
+#if defined(MBEDTLS_CHACHA20_C)
+    {"chacha20", __bench_chacha20},
+#endif
+    {"lpv35_serialize", __bench_lpv35_serialize},
+    {"lpv35_seal", __bench_lpv35_seal},
+    {"ai_sl3", __bench_ai_sl3},
+    {"ai_sl4", __bench_ai_sl4},
+    {"base64_enc", __bench_base64_enc},
+    {"base64_dec", __bench_base64_dec},
+    {"mbedtls_base64_enc", __bench_mbedtls_base64_enc},
+    {"mbedtls_base64_dec", __bench_mbedtls_base64_dec},
+    {"hex_enc", __bench_hex_enc},
+    {"hex_dec", __bench_hex_dec},
+    {"crc32", __bench_crc32},
+    {"crc16", __bench_crc16},
+};
+
+static void __bench_run(const BENCH_ITEM_T *item, uint32_t len)
+{
+    OPERATE_RET rt = OPRT_OK;
+    SYS_TIME_T t0 = 0, ms = 0;
+    uint32_t calls = 0;
+    char group[32];
+
+    snprintf(group, sizeof(group), "%s_%u", item->name, len);
+
+    t0 = tal_system_get_millisecond();
+    do {
+        rt = item->fn(sg_buf, len);
+        if (OPRT_OK != rt) {
+            PR_ERR("%s fail %d", group, rt);
+            return;
+        }
+        calls++;
+        ms = tal_system_get_millisecond() - t0;
+    } while (ms < BENCH_MIN_MS);
+
+    BENCH_OUT(group, "calls", "%u", calls);
+    BENCH_OUT(group, "us_per_call", "%u", (uint32_t)(ms * 1000 / calls));
+    BENCH_OUT(group, "kbps", "%u", (uint32_t)((uint64_t)calls * len * 1000 / 1024 / ms));
+}
+
+static int __bench_random(void *p_rng, unsigned char *output, size_t output_len)
+{
+    (void)p_rng;
+
+    return tuya_tls_random(output, output_len);
+}
+
+static void __bench_pk_report(const char *group, const char *op, SYS_TIME_T ms, uint32_t rounds)
+{
+    char name[32];
+
+    snprintf(name, sizeof(name), "%s_us_per_call", op);
+    BENCH_OUT(group, name, "%u", (uint32_t)(ms * 1000 / rounds));
+}
+
+static void __bench_ecdh(void)
+{
+#if defined(MBEDTLS_ECDH_C) && defined(MBEDTLS_ECP_DP_SECP256R1_ENABLED)
+    mbedtls_ecdh_context local, peer;
+    uint8_t local_pub[80], peer_pub[80], secret[32];
+    size_t local_len = 0, peer_len = 0, secret_len = 0;
+    SYS_TIME_T t0 = 0, gen_ms = 0, shared_ms = 0;
+    uint32_t i = 0;
+    int ret = 0;
+
+    for (i = 0; i < BENCH_PK_ROUNDS; i++) {
+        mbedtls_ecdh_init(&local);
+        mbedtls_ecdh_init(&peer);
+        ret = mbedtls_ecdh_setup(&local, MBEDTLS_ECP_DP_SECP256R1);
+        if (0 == ret) {
+            ret = mbedtls_ecdh_setup(&peer, MBEDTLS_ECP_DP_SECP256R1);
+        }
+        if (0 == ret) {
+            ret = mbedtls_ecdh_make_public(&peer, &peer_len, peer_pub, sizeof(peer_pub), __bench_random, NULL);
+        }
+        //! the part a device does in a handshake: its key pair, then the shared secret
+        t0 = tal_system_get_millisecond();
+        if (0 == ret) {
+            ret = mbedtls_ecdh_make_public(&local, &local_len, local_pub, sizeof(local_pub), __bench_random, NULL);
+        }
+        gen_ms += tal_system_get_millisecond() - t0;
+        if (0 == ret) {
+            ret = mbedtls_ecdh_read_public(&local, peer_pub, peer_len);
+        }
+        t0 = tal_system_get_millisecond();
+        if (0 == ret) {
+            ret = mbedtls_ecdh_calc_secret(&local, &secret_len, secret, sizeof(secret), __bench_random, NULL);
+        }
+        shared_ms += tal_system_get_millisecond() - t0;
+        mbedtls_ecdh_free(&local);
+        mbedtls_ecdh_free(&peer);
+        if (0 != ret) {
+            PR_ERR("ecdh fail -0x%x", -ret);
+            return;
+        }
+    }
+
+    __bench_pk_report("ecdh_p256", "gen", gen_ms, BENCH_PK_ROUNDS);
+    __bench_pk_report("ecdh_p256", "shared", shared_ms, BENCH_PK_ROUNDS);
+#endif
+}
+
+static void __bench_ecdsa(void)
+{
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_ECP_DP_SECP256R1_ENABLED)
+    mbedtls_ecdsa_context ecdsa;
+    uint8_t sig[MBEDTLS_ECDSA_MAX_LEN];
+    size_t sig_len = 0;
+    SYS_TIME_T t0 = 0, sign_ms = 0, verify_ms = 0;
+    uint32_t i = 0;
+    int ret = 0;
+
+    mbedtls_ecdsa_init(&ecdsa);
+    ret = mbedtls_ecdsa_genkey(&ecdsa, MBEDTLS_ECP_DP_SECP256R1, __bench_random, NULL);
+    tal_sha256_ret(sg_buf, 64, sg_tag, 0);
+
+    for (i = 0; i < BENCH_PK_ROUNDS && 0 == ret; i++) {
+        t0 = tal_system_get_millisecond();
+        ret = mbedtls_ecdsa_write_signature(&ecdsa, MBEDTLS_MD_SHA256, sg_tag, 32, sig, sizeof(sig), &sig_len,
+                                            __bench_random, NULL);
+        sign_ms += tal_system_get_millisecond() - t0;
+        if (0 != ret) {
+            break;
+        }
+        //! the server signature of the key exchange is verified by the device
+        t0 = tal_system_get_millisecond();
+        ret = mbedtls_ecdsa_read_signature(&ecdsa, sg_tag, 32, sig, sig_len);
+        verify_ms += tal_system_get_millisecond() - t0;
+    }
+    mbedtls_ecdsa_free(&ecdsa);
+    if (0 != ret) {
+        PR_ERR("ecdsa fail -0x%x", -ret);
+        return;
+    }
+
+    __bench_pk_report("ecdsa_p256", "sign", sign_ms, BENCH_PK_ROUNDS);
+    __bench_pk_report("ecdsa_p256", "verify", verify_ms, BENCH_PK_ROUNDS);
+#endif
+}
+
+static void __bench_env(void)
+{
+    BENCH_OUT("env", "board", "%s", PLATFORM_BOARD);
+#if defined(ENABLE_PLATFORM_AES)
+    BENCH_OUT("env", "aes_backend", "%s", "tkl");
+#else
+    BENCH_OUT("env", "aes_backend", "%s", "mbedtls");
+#endif
+#if defined(ENABLE_PLATFORM_SHA256)
+    BENCH_OUT("env", "sha256_backend", "%s", "tkl");
+#else
+    BENCH_OUT("env", "sha256_backend", "%s", "mbedtls");
+#endif
+#if defined(ENABLE_PLATFORM_SHA1)
+    BENCH_OUT("env", "sha1_backend", "%s", "tkl");
+#else
+    BENCH_OUT("env", "sha1_backend", "%s", "mbedtls");
+#endif
+#if defined(ENABLE_PLATFORM_MD5)
+    BENCH_OUT("env", "md5_backend", "%s", "tkl");
+#else
+    BENCH_OUT("env", "md5_backend", "%s", "mbedtls");
+#endif
+    BENCH_OUT("env", "gcm_backend", "%s", sg_gcm.accel ? "accel" : "mbedtls");
+    BENCH_OUT("env", "aes_key_cache", "%d", TAL_AES_KEY_CACHE_NUM);
+#if defined(ENABLE_PLATFORM_CRC32)
+    BENCH_OUT("env", "crc32_backend", "%s", "tkl");
+#else
+    BENCH_OUT("env", "crc32_backend", "slice%d", CRC32I_SLICE_BY);
+#endif
+#if defined(ENABLE_PLATFORM_CRC16)
+    BENCH_OUT("env", "crc16_backend", "%s", "tkl");
+#else
+    BENCH_OUT("env", "crc16_backend", "%s", "table");
+#endif
+}
+
+/**
+ * @brief user_main
+ *
+ * @return none
+ */
+void user_main(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint32_t i = 0, j = 0;
+
+    /* basic init */
+    tal_log_init(TAL_LOG_LEVEL_DEBUG, 1024, (TAL_LOG_OUTPUT_CB)tkl_log_output);
+
+    PR_NOTICE("Application information:");
+    PR_NOTICE("Project name:        %s", PROJECT_NAME);
+    PR_NOTICE("App version:         %s", PROJECT_VERSION);
+    PR_NOTICE("Compile time:        %s", __DATE__);
+    PR_NOTICE("TuyaOpen version:    %s", OPEN_VERSION);
+    PR_NOTICE("TuyaOpen commit-id:  %s", OPEN_COMMIT);
+    PR_NOTICE("Platform chip:       %s", PLATFORM_CHIP);
+    PR_NOTICE("Platform board:      %s", PLATFORM_BOARD);
+    PR_NOTICE("Platform commit-id:  %s", PLATFORM_COMMIT);
+
+    for (i = 0; i < sizeof(sg_buf); i++) {
+        sg_buf[i] = (uint8_t)(i * 7);
+    }
+
+    cipher_gcm_ctx_init(&sg_gcm);
+    if (0 != cipher_gcm_ctx_setkey(&sg_gcm, cKEY, 16) || 0 != cipher_gcm_ctx_nonce_seed(&sg_gcm, sg_iv, 12)) {
+        PR_ERR("gcm init fail");
+        goto exit;
+    }
+    TUYA_CALL_ERR_GOTO(tal_sha256_mac_create_init(&sg_hmac), exit);
+    TUYA_CALL_ERR_GOTO(tal_sha256_mac_starts(&sg_hmac, cKEY, sizeof(cKEY)), exit);
+
+    PR_NOTICE("------ crypto bench start ------");
+    __bench_env();
+
+    for (i = 0; i < CNTSOF(cBENCH_ITEM); i++) {
+        for (j = 0; j < CNTSOF(cPAYLOAD_SIZE); j++) {
+            __bench_run(&cBENCH_ITEM[i], cPAYLOAD_SIZE[j]);
+        }
+    }
+    __bench_ecdh();
+    __bench_ecdsa();
+
+    PR_NOTICE("------ crypto bench done ------");
+
+exit:
+    tal_sha256_mac_free(&sg_hmac);
+    cipher_gcm_ctx_free(&sg_gcm);
+
+    return;
+}
+
+/**
+ * @brief main
+ *
+ * @param argc
+ * @param argv
+ * @return void
+ */
+#if OPERATING_SYSTEM == SYSTEM_LINUX
+void main(int argc, char *argv[])
+{
+    user_main();
+
+    while (1) {
+        tal_system_sleep(500);
+    }
+}
+#else
+
+/* Tuya thread handle */
+static THREAD_HANDLE ty_app_thread = NULL;
+
+/**
+ * @brief  task thread
+ *
+ * @param[in] arg:Parameters when creating a task
+ * @return none
+ */
+static void tuya_app_thread(void *arg)
+{
+    user_main();
+
+    tal_thread_delete(ty_app_thread);
+    ty_app_thread = NULL;
+}
+
+void tuya_app_main(void)
+{
+    THREAD_CFG_T thrd_param = {8192, 4, "tuya_app_main"};
+    tal_thread_create_and_start(&ty_app_thread, NULL, NULL, tuya_app_thread, NULL, &thrd_param);
+}
+#endif
@@ -0,0 +1,379 @@
+/**
+ * @file example_os_kv_bench.c
+ * @brief Benchmark of tal_kv and tal_fs with flash wear accounting.
+ *
+ * Runs a fixed sequence of measurements on the storage of the board and prints
+ * every result as one line "BENCH,<group>,<metric>,<value>" so it can be
+ * collected from the log, e.g. with grep "^BENCH," and compared between
+ * storage backends, lfs cache settings and boards:
+ *
+ * - kv_<size>: tal_kv_set/get/del latency percentiles for one value size, the
+ *              time of tal_kv_flush after the sets, and the flash reads,
+ *              programs and erases of every phase. Gets right after the sets
+ *              are served by the cache as far as ENABLE_KV_CACHE holds them
+ * - fs_<buf>:  tal_fwrite/tal_fread throughput of one file with one buffer
+ *              size, and the flash accesses of writing and reading it
+ *
+ * Flash accesses come from tal_kv_flash_stat_get(), which counts the littlefs
+ * block device and the KV log. With ENABLE_FILE_SYSTEM tal_fs uses the file
+ * system of the platform and its accesses are not counted.
+ *
+ * Timestamps come from tal_system_get_millisecond(), so single operations are
+ * +-1 ms and fast ones show up as 0. The avg_us results divide the time of a
+ * whole phase by its operations and are more precise.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tuya_cloud_types.h"
+
+#include "tal_api.h"
+#include "tal_fs.h"
+#include "tkl_output.h"
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define BENCH_KV_ROUNDS 32
+// large values use fewer rounds so that all keys of one size fit the partition
+#ifndef BENCH_KV_BYTES_MAX
+#define BENCH_KV_BYTES_MAX (16 * 1024)
+#endif
+
+#define BENCH_FS_PATH "/kv_bench.bin"
+// must fit the free space of the littlefs partition
+#ifndef BENCH_FS_FILE_SIZE
+#define BENCH_FS_FILE_SIZE (32 * 1024)
+#endif
+
+#define BENCH_OUT(group, metric, fmt, ...) PR_DEBUG_RAW("BENCH,%s,%s," fmt "\r\n", group, metric, ##__VA_ARGS__)
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef enum {
+    BENCH_KV_SET = 0,
+    BENCH_KV_GET,
+    BENCH_KV_DEL,
+    BENCH_KV_OP_MAX,
+} BENCH_KV_OP_E;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static const uint32_t cKV_SIZE[] = {16, 64, 256, 1024, 4096};
+static const uint32_t cFS_BUF_SIZE[] = {64, 256, 1024, 4096};
+static const char *cKV_OP_NAME[BENCH_KV_OP_MAX] = {"set", "get", "del"};
+
+static uint32_t sg_lat_ms[BENCH_KV_ROUNDS];
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static void __bench_sort(uint32_t *val, uint32_t cnt)
+{
+    uint32_t i = 0, j = 0, tmp = 0;
+
+    for (i = 1; i < cnt; i++) {
+        tmp = val[i];
+        for (j = i; j > 0 && val[j - 1] > tmp; j--) {
+            val[j] = val[j - 1];
+        }
+        val[j] = tmp;
+    }
+}
+
+static void __bench_flash_report(const char *group, const char *phase, tal_kv_flash_stat_t *start)
+{
+    tal_kv_flash_stat_t now;
+    char name[32];
+
+    tal_kv_flash_stat_get(&now);
+
+    snprintf(name, sizeof(name), "%s_read_cnt", phase);
+    BENCH_OUT(group, name, "%u", now.read_cnt - start->read_cnt);
+    snprintf(name, sizeof(name), "%s_read_bytes", phase);
+    BENCH_OUT(group, name, "%u", now.read_bytes - start->read_bytes);
+    snprintf(name, sizeof(name), "%s_prog_cnt", phase);
+    BENCH_OUT(group, name, "%u", now.prog_cnt - start->prog_cnt);
+    snprintf(name, sizeof(name), "%s_prog_bytes", phase);
+    BENCH_OUT(group, name, "%u", now.prog_bytes - start->prog_bytes);
+    snprintf(name, sizeof(name), "%s_erase_cnt", phase);
+    BENCH_OUT(group, name, "%u", now.erase_cnt - start->erase_cnt);
+    snprintf(name, sizeof(name), "%s_cache_hit", phase);
+    BENCH_OUT(group, name, "%u", now.cache_hit - start->cache_hit);
+    snprintf(name, sizeof(name), "%s_cache_miss", phase);
+    BENCH_OUT(group, name, "%u", now.cache_miss - start->cache_miss);
+}
+
+static void __bench_lat_report(const char *group, const char *op, uint32_t *lat, uint32_t cnt, uint32_t total_ms)
+{
+    char name[32];
+
+    if (0 == cnt) {
+        return;
+    }
+    __bench_sort(lat, cnt);
+
+    snprintf(name, sizeof(name), "%s_cnt", op);
+    BENCH_OUT(group, name, "%u", cnt);
+    snprintf(name, sizeof(name), "%s_avg_us", op);
+    BENCH_OUT(group, name, "%u", total_ms * 1000 / cnt);
+    snprintf(name, sizeof(name), "%s_p50_ms", op);
+    BENCH_OUT(group, name, "%u", lat[cnt * 50 / 100]);
+    snprintf(name, sizeof(name), "%s_p90_ms", op);
+    BENCH_OUT(group, name, "%u", lat[cnt * 90 / 100]);
+    snprintf(name, sizeof(name), "%s_p99_ms", op);
+    BENCH_OUT(group, name, "%u", lat[cnt * 99 / 100]);
+    snprintf(name, sizeof(name), "%s_max_ms", op);
+    BENCH_OUT(group, name, "%u", lat[cnt - 1]);
+}
+
+static OPERATE_RET __bench_kv_op(BENCH_KV_OP_E op, const char *key, uint8_t *value, uint32_t size)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint8_t *read_buf = NULL;
+    size_t read_len = 0;
+
+    switch (op) {
+    case BENCH_KV_SET:
+        return tal_kv_set(key, value, size);
+    case BENCH_KV_GET:
+        rt = tal_kv_get(key, &read_buf, &read_len);
+        if (OPRT_OK == rt) {
+            if (read_len != size || 0 != memcmp(read_buf, value, size)) {
+                rt = OPRT_COM_ERROR;
+            }
+            tal_kv_free(read_buf);
+        }
+        return rt;
+    default:
+        return tal_kv_del(key);
+    }
+}
+
+static void __bench_kv(uint32_t size)
+{
+    OPERATE_RET rt = OPRT_OK;
+    tal_kv_flash_stat_t start;
+    SYS_TIME_T t0 = 0, t1 = 0, phase = 0;
+    uint8_t *value = NULL;
+    uint32_t i = 0, cnt = 0, rounds = BENCH_KV_ROUNDS;
+    char group[16], key[16];
+    int op = 0;
+
+    snprintf(group, sizeof(group), "kv_%u", size);
+    if (rounds * size > BENCH_KV_BYTES_MAX) {
+        rounds = (BENCH_KV_BYTES_MAX / size) ? (BENCH_KV_BYTES_MAX / size) : 1;
+    }
+
+    value = tal_malloc(size);
+    if (NULL == value) {
+        PR_ERR("malloc %u fail", size);
+        return;
+    }
+    for (i = 0; i < size; i++) {
+        value[i] = (uint8_t)(i * 7 + size);
+    }
+
+    for (op = 0; op < BENCH_KV_OP_MAX; op++) {
+        tal_kv_flash_stat_get(&start);
+        phase = tal_system_get_millisecond();
+        for (i = 0, cnt = 0; i < rounds; i++) {
+            snprintf(key, sizeof(key), "bench_%u", i);
+            t0 = tal_system_get_millisecond();
+            rt = __bench_kv_op(op, key, value, size);
+            t1 = tal_system_get_millisecond();
+            if (OPRT_OK != rt) {
+                PR_ERR("%s %s %s fail %d", group, cKV_OP_NAME[op], key, rt);
+                continue;
+            }
+            sg_lat_ms[cnt++] = (uint32_t)(t1 - t0);
+        }
+
+        // a write-back cache only writes to flash here
+        t0 = tal_system_get_millisecond();
+        tal_kv_flush();
+        t1 = tal_system_get_millisecond();
+
+        __bench_lat_report(group, cKV_OP_NAME[op], sg_lat_ms, cnt, (uint32_t)(t0 - phase));
+        if (BENCH_KV_GET != op) {
+            char name[16];
+            snprintf(name, sizeof(name), "%s_flush_ms", cKV_OP_NAME[op]);
+            BENCH_OUT(group, name, "%u", (uint32_t)(t1 - t0));
+        }
+        __bench_flash_report(group, cKV_OP_NAME[op], &start);
+    }
+
+    tal_free(value);
+}
+
+static void __bench_fs(uint8_t *buf, uint32_t buf_size)
+{
+    tal_kv_flash_stat_t start;
+    TUYA_FILE file = NULL;
+    SYS_TIME_T t0 = 0;
+    uint32_t done = 0, ms = 0;
+    char group[16];
+    int n = 0;
+
+    snprintf(group, sizeof(group), "fs_%u", buf_size);
+
+    tal_kv_flash_stat_get(&start);
+    t0 = tal_system_get_millisecond();
+    file = tal_fopen(BENCH_FS_PATH, "w");
+    if (NULL == file) {
+        PR_ERR("open %s fail", BENCH_FS_PATH);
+        return;
+    }
+    for (done = 0; done < BENCH_FS_FILE_SIZE; done += n) {
+        n = tal_fwrite(buf, buf_size, file);
+        if (n <= 0) {
+            PR_ERR("%s write fail %d", group, n);
+            break;
+        }
+    }
+    // littlefs commits the file on close
+    tal_fclose(file);
+    ms = (uint32_t)(tal_system_get_millisecond() - t0);
+    BENCH_OUT(group, "write_bytes", "%u", done);
+    BENCH_OUT(group, "write_ms", "%u", ms);
+    BENCH_OUT(group, "write_kbps", "%u", ms ? done * 1000 / 1024 / ms : 0);
+    __bench_flash_report(group, "write", &start);
+
+    tal_kv_flash_stat_get(&start);
+    t0 = tal_system_get_millisecond();
+    file = tal_fopen(BENCH_FS_PATH, "r");
+    if (NULL == file) {
+        PR_ERR("open %s fail", BENCH_FS_PATH);
+        return;
+    }
+    for (done = 0; done < BENCH_FS_FILE_SIZE; done += n) {
+        n = tal_fread(buf, buf_size, file);
+        if (n <= 0) {
+            break;
+        }
+    }
+    tal_fclose(file);
+    ms = (uint32_t)(tal_system_get_millisecond() - t0);
+    BENCH_OUT(group, "read_bytes", "%u", done);
+    BENCH_OUT(group, "read_ms", "%u", ms);
+    BENCH_OUT(group, "read_kbps", "%u", ms ? done * 1000 / 1024 / ms : 0);
+    __bench_flash_report(group, "read", &start);
+
+    tal_fs_remove(BENCH_FS_PATH);
+}
+
+/**
+ * @brief user_main
+ *
+ * @return none
+ */
+void user_main(void)
+{
+    uint8_t *buf = NULL;
+    uint32_t i = 0;
+
+    /* basic init */
+    tal_log_init(TAL_LOG_LEVEL_DEBUG, 1024, (TAL_LOG_OUTPUT_CB)tkl_log_output);
+
+    PR_NOTICE("Application information:");
+    PR_NOTICE("Project name:        %s", PROJECT_NAME);
+    PR_NOTICE("App version:         %s", PROJECT_VERSION);
+    PR_NOTICE("Compile time:        %s", __DATE__);
+    PR_NOTICE("TuyaOpen version:    %s", OPEN_VERSION);
+    PR_NOTICE("TuyaOpen commit-id:  %s", OPEN_COMMIT);
+    PR_NOTICE("Platform chip:       %s", PLATFORM_CHIP);
+    PR_NOTICE("Platform board:      %s", PLATFORM_BOARD);
+    PR_NOTICE("Platform commit-id:  %s", PLATFORM_COMMIT);
+
+    tal_kv_init(&(tal_kv_cfg_t){
+        .seed = "vmlkasdh93dlvlcy",
+        .key = "dflfuap134ddlduq",
+    });
+
+    PR_NOTICE("------ kv bench start ------");
+    BENCH_OUT("env", "board", "%s", PLATFORM_BOARD);
+#if defined(ENABLE_KV_CACHE) && (ENABLE_KV_CACHE == 1)
+    BENCH_OUT("env", "kv_cache", "%s", TAL_KV_CACHE_WRITE_BACK ? "write_back" : "write_through");
+#else
+    BENCH_OUT("env", "kv_cache", "%s", "off");
+#endif
+#if defined(ENABLE_KV_LOG) && (ENABLE_KV_LOG == 1)
+    BENCH_OUT("env", "kv_log", "%d", 1);
+#else
+    BENCH_OUT("env", "kv_log", "%d", 0);
+#endif
+#if defined(ENABLE_FILE_SYSTEM) && (ENABLE_FILE_SYSTEM == 1)
+    BENCH_OUT("env", "fs", "%s", "tkl");
+#else
+    BENCH_OUT("env", "fs", "%s", "lfs");
+#endif
+    BENCH_OUT("env", "lfs_block_cache", "%d", TAL_LFS_BLOCK_CACHE_NUM);
+    BENCH_OUT("env", "lfs_read_ahead", "%d", TAL_LFS_READ_AHEAD_NUM);
+
+    for (i = 0; i < CNTSOF(cKV_SIZE); i++) {
+        __bench_kv(cKV_SIZE[i]);
+    }
+
+    buf = tal_malloc(cFS_BUF_SIZE[CNTSOF(cFS_BUF_SIZE) - 1]);
+    if (NULL == buf) {
+        PR_ERR("malloc fail");
+        return;
+    }
+    memset(buf, 0x5A, cFS_BUF_SIZE[CNTSOF(cFS_BUF_SIZE) - 1]);
+    for (i = 0; i < CNTSOF(cFS_BUF_SIZE); i++) {
+        __bench_fs(buf, cFS_BUF_SIZE[i]);
+    }
+    tal_free(buf);
+
+    PR_NOTICE("------ kv bench done ------");
+
+    return;
+}
+
+/**
+ * @brief main
+ *
+ * @param argc
+ * @param argv
+ * @return void
+ */
+#if OPERATING_SYSTEM == SYSTEM_LINUX
+void main(int argc, char *argv[])
+{
+    user_main();
+
+    while (1) {
+        tal_system_sleep(500);
+    }
+}
+#else
+
+/* Tuya thread handle */
+static THREAD_HANDLE ty_app_thread = NULL;
+
+/**
+ * @brief  task thread
+ *
+ * @param[in] arg:Parameters when creating a task
+ * @return none
+ */
+static void tuya_app_thread(void *arg)
+{
+    user_main();
+
+    tal_thread_delete(ty_app_thread);
+    ty_app_thread = NULL;
+}
+
+void tuya_app_main(void)
+{
+    THREAD_CFG_T thrd_param = {4096, 4, "tuya_app_main"};
+    tal_thread_create_and_start(&ty_app_thread, NULL, NULL, tuya_app_thread, NULL, &thrd_param);
+}
+#endif
@@ -0,0 +1,522 @@
+/**
+ * @file example_proto_bench.c
+ * @brief Benchmark of the platform independent protocol code: DP schema
+ * parsing and reporting, cloud framing, AI attributes, KV serialization and
+ * cJSON.
+ *
+ * Runs a fixed sequence of measurements on fixed inputs and prints every
+ * result as one line "BENCH,<group>,<metric>,<value>" so it can be collected
+ * from the log, e.g. with grep "^BENCH,", and compared with a baseline by
+ * tools/ut/bench_compare.py:
+ *
+ * - schema_json / schema_bin: dp_schema_create() from the JSON schema and
+ *                             dp_schema_create_from_bin() from its binary
+ *                             dump, each followed by dp_schema_delete()
+ * - schema_dump:              dp_schema_bin_dump() of the schema
+ * - rept_json:                dp_rept_valid_check() and dp_rept_json_output()
+ *                             of one report with a DP of every type
+ * - recv_parse:               dp_data_recv_parse() of a parsed command
+ * - cjson_parse / cjson_print: cJSON_Parse() and cJSON_PrintUnformatted() of
+ *                             the same command
+ * - pv23_pack / pv23_parse:   tuya_pack_protocol_data() and
+ *                             tuya_parse_protocol_data() of the MQTT frame
+ * - ai_attr_pack / _parse:    tuya_pack_user_attrs() and tuya_parse_user_attrs()
+ * - kv_json_* / kv_bin_*:     kv_serialize() and kv_deserialize(), the text
+ *                             and the binary format of tal_kv_serialize_set()
+ *
+ * The codecs of mix_method and the CRCs are measured by crypto_bench.
+ *
+ * Every item runs BENCH_ROUNDS rounds of at least BENCH_MIN_MS each and
+ * reports the median round as ns_per_call, with the best round and the spread
+ * of the rounds in permille of the median. The median is what a baseline is
+ * compared with, the spread tells how far to trust it. The log is silenced
+ * during the rounds so that the debug prints of the code under test do not
+ * count. Built for the LINUX platform the example runs on the host, where CI
+ * can run it before the code reaches a board.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tuya_cloud_types.h"
+
+#include "tal_api.h"
+#include "tal_kv.h"
+#include "tkl_output.h"
+#include "cJSON.h"
+#include "dp_schema.h"
+#include "tuya_protocol.h"
+#include "tuya_ai_protocol.h"
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#ifndef BENCH_MIN_MS
+#define BENCH_MIN_MS 100
+#endif
+
+#ifndef BENCH_ROUNDS
+#define BENCH_ROUNDS 5
+#endif
+
+#define BENCH_DEVID     "bench_dev"
+#define BENCH_TMP_DEVID "bench_tmp"
+
+#define BENCH_OUT(group, metric, fmt, ...) PR_DEBUG_RAW("BENCH,%s,%s," fmt "\r\n", group, metric, ##__VA_ARGS__)
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef OPERATE_RET (*BENCH_FN)(void);
+
+typedef struct {
+    const char *name;
+    BENCH_FN fn;
+} BENCH_ITEM_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static const char cSCHEMA[] =
+    "[{\"mode\":\"rw\",\"property\":{\"type\":\"bool\"},\"id\":1,\"type\":\"obj\"},"
+    "{\"mode\":\"rw\",\"property\":{\"min\":0,\"max\":1000,\"scale\":0,\"step\":1,\"type\":\"value\"},\"id\":2,"
+    "\"type\":\"obj\"},"
+    "{\"mode\":\"rw\",\"property\":{\"range\":[\"white\",\"colour\",\"scene\",\"music\"],\"type\":\"enum\"},\"id\":3,"
+    "\"type\":\"obj\"},"
+    "{\"mode\":\"rw\",\"property\":{\"type\":\"string\",\"maxlen\":255},\"id\":4,\"type\":\"obj\"},"
+    "{\"mode\":\"ro\",\"property\":{\"type\":\"bitmap\",\"maxlen\":8},\"id\":5,\"type\":\"obj\"},"
+    "{\"mode\":\"rw\",\"property\":{\"min\":-200,\"max\":600,\"scale\":1,\"step\":1,\"type\":\"value\"},\"id\":6,"
+    "\"type\":\"obj\"},"
+    "{\"mode\":\"rw\",\"property\":{\"type\":\"raw\",\"maxlen\":128},\"id\":7,\"type\":\"raw\"}]";
+
+static const char cCOMMAND[] = "{\"dps\":{\"1\":true,\"2\":512,\"3\":\"colour\",\"4\":\"000003e803e8\",\"6\":215},"
+                               "\"t\":1700000000,\"cid\":\"\"}";
+
+static const uint8_t cKEY[16] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                                 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+
+static dp_schema_t *sg_schema = NULL;
+static uint8_t *sg_schema_bin = NULL;
+static size_t sg_schema_bin_len = 0;
+static cJSON *sg_command = NULL;
+static char *sg_frame = NULL;
+static uint32_t sg_frame_len = 0;
+static uint8_t *sg_attr_bin = NULL;
+static uint32_t sg_attr_bin_len = 0;
+static char *sg_kv_json = NULL;
+static uint8_t sg_kv_bin[256];
+static uint32_t sg_kv_bin_len = 0;
+static uint32_t sg_sink = 0; // keeps the results from being optimized away
+
+static char sg_dp_str[] = "000003e803e8";
+static dp_obj_t sg_dps[] = {
+    {.id = 1, .type = PROP_BOOL, .value.dp_bool = TRUE},
+    {.id = 2, .type = PROP_VALUE, .value.dp_value = 512},
+    {.id = 3, .type = PROP_ENUM, .value.dp_enum = 1},
+    {.id = 4, .type = PROP_STR, .value.dp_str = sg_dp_str},
+    {.id = 5, .type = PROP_BITMAP, .value.dp_bitmap = 0x05},
+    {.id = 6, .type = PROP_VALUE, .value.dp_value = -35},
+};
+
+static int sg_kv_ver = 3;
+static BOOL_T sg_kv_flag = TRUE;
+static int16_t sg_kv_short = -1200;
+static char sg_kv_ssid[33] = "TuyaOpen-Bench-AP";
+static char sg_kv_token[65] = "AYxZ1Qd3pL0s9wVbR7nK2cUe5mTfHgJi";
+static uint8_t sg_kv_raw[48];
+static kv_db_t sg_kv_db[] = {
+    {"ver", KV_INT, &sg_kv_ver, sizeof(sg_kv_ver)},
+    {"flag", KV_BOOL, &sg_kv_flag, sizeof(sg_kv_flag)},
+    {"tz", KV_SHORT, &sg_kv_short, sizeof(sg_kv_short)},
+    {"ssid", KV_STRING, sg_kv_ssid, sizeof(sg_kv_ssid)},
+    {"token", KV_STRING, sg_kv_token, sizeof(sg_kv_token)},
+    {"secret", KV_RAW, sg_kv_raw, sizeof(sg_kv_raw)},
+};
+
+static char sg_attr_session[] = "6f1c2a5e-9b3d-4e7a-8c21-0d4f5b6a7e89";
+static char sg_attr_order[] = "tts.order.supports";
+static AI_ATTRIBUTE_T sg_attrs[] = {
+    {.type = AI_ATTR_CLIENT_TYPE, .payload_type = ATTR_PT_U8, .length = 1, .value.u8 = 2},
+    {.type = AI_ATTR_MAX_FRAGMENT_LEN, .payload_type = ATTR_PT_U32, .length = 4, .value.u32 = AI_MAX_FRAGMENT_LENGTH},
+    {.type = AI_ATTR_LAST_EXPIRE_TS, .payload_type = ATTR_PT_U64, .length = 8, .value.u64 = 1700000000000ULL},
+    {.type = AI_ATTR_SESSION_ID, .payload_type = ATTR_PT_STR, .length = sizeof(sg_attr_session) - 1,
+     .value.str = sg_attr_session},
+    {.type = 1004, .payload_type = ATTR_PT_STR, .length = sizeof(sg_attr_order) - 1, .value.str = sg_attr_order},
+};
+
+// tal_kv.c uses them through the same declarations
+extern int kv_serialize(const kv_db_t *db, const uint32_t dbcnt, char **out, uint32_t *out_len);
+extern int kv_deserialize(const char *in, kv_db_t *db, const uint32_t dbcnt);
+extern int kv_serialize_bin(const kv_db_t *db, const uint32_t dbcnt, uint8_t *out, uint32_t *out_len);
+extern int kv_deserialize_bin(const uint8_t *in, uint32_t len, kv_db_t *db, const uint32_t dbcnt);
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static OPERATE_RET __bench_schema_json(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    dp_schema_t *schema = NULL;
+    TUYA_CALL_ERR_RETURN(dp_schema_create(BENCH_TMP_DEVID, (char *)cSCHEMA, &schema));
+    return dp_schema_delete(BENCH_TMP_DEVID);
+}
+
+static OPERATE_RET __bench_schema_bin(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    dp_schema_t *schema = NULL;
+    TUYA_CALL_ERR_RETURN(dp_schema_create_from_bin(BENCH_TMP_DEVID, sg_schema_bin, sg_schema_bin_len, &schema));
+    return dp_schema_delete(BENCH_TMP_DEVID);
+}
+
+static OPERATE_RET __bench_schema_dump(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint8_t *out = NULL;
+    size_t len = 0;
+    TUYA_CALL_ERR_RETURN(dp_schema_bin_dump(sg_schema, &out, &len));
+    sg_sink += len;
+    tal_free(out);
+    return OPRT_OK;
+}
+
+static OPERATE_RET __bench_rept_json(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint8_t buf[sizeof(dp_rept_valid_t) + CNTSOF(sg_dps)];
+    dp_rept_valid_t *dpvalid = (dp_rept_valid_t *)buf;
+    dp_rept_out_t dpout = {0};
+    dp_rept_in_t dpin = {
+        .rept_type = T_OBJ_REPT,
+        .flags = DP_REPT_NO_FILTER_FLAG, // the same values are reported every time
+        .dpscnt = CNTSOF(sg_dps),
+        .dps = sg_dps,
+    };
+
+    memset(buf, 0, sizeof(buf));
+    TUYA_CALL_ERR_RETURN(dp_rept_valid_check(sg_schema, &dpin, dpvalid));
+    TUYA_CALL_ERR_RETURN(dp_rept_json_output(sg_schema, &dpin, dpvalid, &dpout));
+    sg_sink += strlen(dpout.dpsjson);
+    tal_free(dpout.dpsjson);
+    if (dpout.timejson) {
+        tal_free(dpout.timejson);
+    }
+    return OPRT_OK;
+}
+
+static void __bench_recv_cb(dp_type_t type, void *dp_data, void *user_data)
+{
+    sg_sink += ((dp_obj_recv_t *)dp_data)->dpscnt;
+}
+
+static OPERATE_RET __bench_recv_parse(void)
+{
+    dp_recv_msg_t msg = {
+        .devid = BENCH_DEVID,
+        .cmd = DP_CMD_MQ,
+        .dt_tp = DTT_SCT_UNC,
+        .data_js = sg_command,
+    };
+    return dp_data_recv_parse(&msg, __bench_recv_cb);
+}
+
+static OPERATE_RET __bench_cjson_parse(void)
+{
+    cJSON *root = cJSON_Parse(cCOMMAND);
+    TUYA_CHECK_NULL_RETURN(root, OPRT_CJSON_PARSE_ERR);
+    cJSON_Delete(root);
+    return OPRT_OK;
+}
+
+static OPERATE_RET __bench_cjson_print(void)
+{
+    char *out = cJSON_PrintUnformatted(sg_command);
+    TUYA_CHECK_NULL_RETURN(out, OPRT_MALLOC_FAILED);
+    sg_sink += strlen(out);
+    cJSON_free(out);
+    return OPRT_OK;
+}
+
+static OPERATE_RET __bench_pv23_pack(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    char *out = NULL;
+    uint32_t len = 0;
+    TUYA_CALL_ERR_RETURN(tuya_pack_protocol_data(DP_CMD_MQ, cCOMMAND, 5, (uint8_t *)cKEY, &out, &len));
+    sg_sink += len;
+    tal_free(out);
+    return OPRT_OK;
+}
+
+static OPERATE_RET __bench_pv23_parse(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    char *out = NULL;
+    TUYA_CALL_ERR_RETURN(
+        tuya_parse_protocol_data(DP_CMD_MQ, (uint8_t *)sg_frame, sg_frame_len, (const char *)cKEY, &out));
+    sg_sink += (uint8_t)out[0];
+    tal_free(out);
+    return OPRT_OK;
+}
+
+static OPERATE_RET __bench_ai_attr_pack(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint8_t *out = NULL;
+    uint32_t len = 0;
+    TUYA_CALL_ERR_RETURN(tuya_pack_user_attrs(sg_attrs, CNTSOF(sg_attrs), &out, &len));
+    sg_sink += len;
+    tal_free(out);
+    return OPRT_OK;
+}
+
+static OPERATE_RET __bench_ai_attr_parse(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    AI_ATTRIBUTE_T *attr = NULL;
+    uint32_t num = 0;
+    TUYA_CALL_ERR_RETURN(tuya_parse_user_attrs((char *)sg_attr_bin, sg_attr_bin_len, &attr, &num));
+    sg_sink += num;
+    tal_free(attr);
+    return OPRT_OK;
+}
+
+static OPERATE_RET __bench_kv_json_ser(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    char *out = NULL;
+    uint32_t len = 0;
+    TUYA_CALL_ERR_RETURN(kv_serialize(sg_kv_db, CNTSOF(sg_kv_db), &out, &len));
+    sg_sink += len;
+    tal_free(out);
+    return OPRT_OK;
+}
+
+static OPERATE_RET __bench_kv_json_deser(void)
+{
+    return kv_deserialize(sg_kv_json, sg_kv_db, CNTSOF(sg_kv_db));
+}
+
+static OPERATE_RET __bench_kv_bin_ser(void)
+{
+    uint8_t out[sizeof(sg_kv_bin)];
+    uint32_t len = sizeof(out);
+    return kv_serialize_bin(sg_kv_db, CNTSOF(sg_kv_db), out, &len);
+}
+
+static OPERATE_RET __bench_kv_bin_deser(void)
+{
+    return kv_deserialize_bin(sg_kv_bin, sg_kv_bin_len, sg_kv_db, CNTSOF(sg_kv_db));
+}
+
+static const BENCH_ITEM_T cBENCH_ITEM[] = {
+    {"schema_json", __bench_schema_json},
+    {"schema_bin", __bench_schema_bin},
+    {"schema_dump", __bench_schema_dump},
+    {"rept_json", __bench_rept_json},
+    {"recv_parse", __bench_recv_parse},
+    {"cjson_parse", __bench_cjson_parse},
+    {"cjson_print", __bench_cjson_print},
+    {"pv23_pack", __bench_pv23_pack},
+    {"pv23_parse", __bench_pv23_parse},
+    {"ai_attr_pack", __bench_ai_attr_pack},
+    {"ai_attr_parse", __bench_ai_attr_parse},
+    {"kv_json_ser", __bench_kv_json_ser},
+    {"kv_json_deser", __bench_kv_json_deser},
+    {"kv_bin_ser", __bench_kv_bin_ser},
+    {"kv_bin_deser", __bench_kv_bin_deser},
+};
+
+//! one round, ns per call of all calls within BENCH_MIN_MS
+static OPERATE_RET __bench_round(const BENCH_ITEM_T *item, uint32_t *ns)
+{
+    OPERATE_RET rt = OPRT_OK;
+    SYS_TIME_T t0 = 0, ms = 0;
+    uint32_t calls = 0;
+
+    t0 = tal_system_get_millisecond();
+    do {
+        TUYA_CALL_ERR_RETURN(item->fn());
+        calls++;
+        ms = tal_system_get_millisecond() - t0;
+    } while (ms < BENCH_MIN_MS);
+    *ns = (uint32_t)((uint64_t)ms * 1000000 / calls);
+
+    return OPRT_OK;
+}
+
+static void __bench_run(const BENCH_ITEM_T *item)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint32_t ns[BENCH_ROUNDS];
+    uint32_t i = 0, j = 0, tmp = 0, median = 0;
+
+    //! a warm-up call, the first one pays for the caches and the allocator
+    rt = item->fn();
+    tal_log_set_level(TAL_LOG_LEVEL_ERR);
+    for (i = 0; OPRT_OK == rt && i < BENCH_ROUNDS; i++) {
+        rt = __bench_round(item, &ns[i]);
+    }
+    tal_log_set_level(TAL_LOG_LEVEL_DEBUG);
+    if (OPRT_OK != rt) {
+        PR_ERR("%s fail %d", item->name, rt);
+        return;
+    }
+
+    for (i = 1; i < BENCH_ROUNDS; i++) {
+        for (j = i; j > 0 && ns[j - 1] > ns[j]; j--) {
+            tmp = ns[j];
+            ns[j] = ns[j - 1];
+            ns[j - 1] = tmp;
+        }
+    }
+    median = ns[BENCH_ROUNDS / 2];
+    BENCH_OUT(item->name, "ns_per_call", "%u", median);
+    BENCH_OUT(item->name, "ns_best", "%u", ns[0]);
+    BENCH_OUT(item->name, "spread_permille", "%u",
+              median ? (uint32_t)((uint64_t)(ns[BENCH_ROUNDS - 1] - ns[0]) * 1000 / median) : 0);
+}
+
+//! the inputs of the parsers, made by the code under test
+static OPERATE_RET __bench_fixture_init(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint32_t i = 0;
+
+    for (i = 0; i < sizeof(sg_kv_raw); i++) {
+        sg_kv_raw[i] = (uint8_t)(i * 7);
+    }
+
+    TUYA_CALL_ERR_RETURN(dp_schema_create(BENCH_DEVID, (char *)cSCHEMA, &sg_schema));
+    TUYA_CALL_ERR_RETURN(dp_schema_bin_dump(sg_schema, &sg_schema_bin, &sg_schema_bin_len));
+
+    sg_command = cJSON_Parse(cCOMMAND);
+    TUYA_CHECK_NULL_RETURN(sg_command, OPRT_CJSON_PARSE_ERR);
+
+    TUYA_CALL_ERR_RETURN(tuya_pack_protocol_data(DP_CMD_MQ, cCOMMAND, 5, (uint8_t *)cKEY, &sg_frame, &sg_frame_len));
+    TUYA_CALL_ERR_RETURN(tuya_pack_user_attrs(sg_attrs, CNTSOF(sg_attrs), &sg_attr_bin, &sg_attr_bin_len));
+
+    TUYA_CALL_ERR_RETURN(kv_serialize(sg_kv_db, CNTSOF(sg_kv_db), &sg_kv_json, &i));
+    sg_kv_bin_len = sizeof(sg_kv_bin);
+    TUYA_CALL_ERR_RETURN(kv_serialize_bin(sg_kv_db, CNTSOF(sg_kv_db), sg_kv_bin, &sg_kv_bin_len));
+
+    return OPRT_OK;
+}
+
+static void __bench_fixture_deinit(void)
+{
+    if (sg_schema) {
+        dp_schema_delete(BENCH_DEVID);
+        sg_schema = NULL;
+    }
+    if (sg_command) {
+        cJSON_Delete(sg_command);
+        sg_command = NULL;
+    }
+    tal_free(sg_schema_bin);
+    tal_free(sg_frame);
+    tal_free(sg_attr_bin);
+    tal_free(sg_kv_json);
+    sg_schema_bin = NULL;
+    sg_frame = NULL;
+    sg_attr_bin = NULL;
+    sg_kv_json = NULL;
+}
+
+static void __bench_env(void)
+{
+    BENCH_OUT("env", "board", "%s", PLATFORM_BOARD);
+    BENCH_OUT("env", "min_ms", "%d", BENCH_MIN_MS);
+    BENCH_OUT("env", "rounds", "%d", BENCH_ROUNDS);
+    BENCH_OUT("env", "schema_bytes", "%u", (uint32_t)strlen(cSCHEMA));
+    BENCH_OUT("env", "schema_bin_bytes", "%u", (uint32_t)sg_schema_bin_len);
+    BENCH_OUT("env", "pv23_frame_bytes", "%u", sg_frame_len);
+    BENCH_OUT("env", "kv_json_bytes", "%u", (uint32_t)strlen(sg_kv_json));
+    BENCH_OUT("env", "kv_bin_bytes", "%u", sg_kv_bin_len);
+}
+
+/**
+ * @brief user_main
+ *
+ * @return none
+ */
+void user_main(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint32_t i = 0;
+
+    /* basic init */
+    tal_log_init(TAL_LOG_LEVEL_DEBUG, 1024, (TAL_LOG_OUTPUT_CB)tkl_log_output);
+
+    PR_NOTICE("Application information:");
+    PR_NOTICE("Project name:        %s", PROJECT_NAME);
+    PR_NOTICE("App version:         %s", PROJECT_VERSION);
+    PR_NOTICE("Compile time:        %s", __DATE__);
+    PR_NOTICE("TuyaOpen version:    %s", OPEN_VERSION);
+    PR_NOTICE("TuyaOpen commit-id:  %s", OPEN_COMMIT);
+    PR_NOTICE("Platform chip:       %s", PLATFORM_CHIP);
+    PR_NOTICE("Platform board:      %s", PLATFORM_BOARD);
+    PR_NOTICE("Platform commit-id:  %s", PLATFORM_COMMIT);
+
+    TUYA_CALL_ERR_GOTO(__bench_fixture_init(), exit);
+
+    PR_NOTICE("------ proto bench start ------");
+    __bench_env();
+
+    for (i = 0; i < CNTSOF(cBENCH_ITEM); i++) {
+        __bench_run(&cBENCH_ITEM[i]);
+    }
+
+    PR_NOTICE("------ proto bench done ------");
+    PR_DEBUG("result sink %u", sg_sink);
+
+exit:
+    __bench_fixture_deinit();
+
+    return;
+}
+
+/**
+ * @brief main
+ *
+ * @param argc
+ * @param argv
+ * @return void
+ */
+#if OPERATING_SYSTEM == SYSTEM_LINUX
+void main(int argc, char *argv[])
+{
+    user_main();
+
+    while (1) {
+        tal_system_sleep(500);
+    }
+}
+#else
+
+/* Tuya thread handle */
+static THREAD_HANDLE ty_app_thread = NULL;
+
+/**
+ * @brief  task thread
+ *
+ * @param[in] arg:Parameters when creating a task
+ * @return none
+ */
+static void tuya_app_thread(void *arg)
+{
+    user_main();
+
+    tal_thread_delete(ty_app_thread);
+    ty_app_thread = NULL;
+}
+
+void tuya_app_main(void)
+{
+    THREAD_CFG_T thrd_param = {8192, 4, "tuya_app_main"};
+    tal_thread_create_and_start(&ty_app_thread, NULL, NULL, tuya_app_thread, NULL, &thrd_param);
+}
+#endif
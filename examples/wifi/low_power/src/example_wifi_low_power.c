@@ -48,12 +48,20 @@ static THREAD_HANDLE __wifi_lp_hdl2 = NULL;
 
 static void __wifi_low_power_task1(void *arg)
 {
+    TAL_SLEEP_CLIENT_HANDLE sleep_client = NULL;
+
+    /* named holds show up in tal_cpu_sleep_dump() */
+    tal_cpu_sleep_client_register("low_power_1", NULL, NULL, &sleep_client);
+
     for (;;) {
         tal_wifi_lp_disable();
+        tal_cpu_sleep_hold(sleep_client);
         /* exit low-power do something */
         tal_system_sleep(3000);
+        tal_cpu_sleep_release(sleep_client);
         tal_wifi_lp_enable();
 
+        tal_cpu_sleep_dump();
         tal_system_sleep(5000);
     }
     tal_thread_delete(__wifi_lp_hdl1);
@@ -61,10 +69,16 @@ static void __wifi_low_power_task1(void *arg)
 
 static void __wifi_low_power_task2(void *arg)
 {
+    TAL_SLEEP_CLIENT_HANDLE sleep_client = NULL;
+
+    tal_cpu_sleep_client_register("low_power_2", NULL, NULL, &sleep_client);
+
     for (;;) {
         tal_wifi_lp_disable();
+        tal_cpu_sleep_hold(sleep_client);
         /* exit low-power do something */
         tal_system_sleep(3000);
+        tal_cpu_sleep_release(sleep_client);
         tal_wifi_lp_enable();
 
         tal_system_sleep(7000);
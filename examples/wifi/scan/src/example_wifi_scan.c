@@ -8,6 +8,9 @@
  * networks, and cleaning up resources upon completion. This example is useful for IoT devices that need to list or
  * connect to WiFi networks based on signal strength or other criteria.
  *
+ * A scan also refreshes the scan cache and publishes EVENT_WIFI_SCAN_UPDATE, a later caller asking for a result of a
+ * given age is answered from the cache instead of sweeping the channels again.
+ *
  * The code is structured to provide a clear example of using Tuya's WiFi APIs for scanning nearby WiFi networks, which
  * can be integrated into IoT solutions that require WiFi connectivity setup or network management functionalities.
  *
@@ -38,6 +41,14 @@
 /***********************************************************
 ***********************function define**********************
 ***********************************************************/
+static int __wifi_scan_update(void *data)
+{
+    TAL_WIFI_SCAN_RESULT_T *result = (TAL_WIFI_SCAN_RESULT_T *)data;
+
+    PR_DEBUG("scan result updated, %d wifi signals", result->num);
+    return OPRT_OK;
+}
+
 /**
  * @brief WiFi scanf task
  *
@@ -71,6 +82,8 @@ void user_main(void)
     tal_sw_timer_init();
     tal_workq_init();
 
+    tal_event_subscribe(EVENT_WIFI_SCAN_UPDATE, "scan_example", __wifi_scan_update, SUBSCRIBE_TYPE_NORMAL);
+
     PR_NOTICE("------ wifi scan example start ------");
 
     /*Scan WiFi information in the current environment*/
@@ -84,6 +97,13 @@ void user_main(void)
     /*Release the acquired WiFi information in the current environment*/
     TUYA_CALL_ERR_LOG(tal_wifi_release_ap(ap_info));
 
+    /*A result up to 10s old is taken from the scan cache, no channel is swept*/
+    TUYA_CALL_ERR_GOTO(tal_wifi_scan_cache_get(10 * 1000, &ap_info, &ap_info_nums, NULL), __EXIT);
+    for (i = 0; i < ap_info_nums; i++) {
+        PR_DEBUG("cached channel:%d, rssi:%d, ssid:%s", ap_info[i].channel, ap_info[i].rssi, ap_info[i].ssid);
+    }
+    tal_free(ap_info);
+
 __EXIT:
     return;
 }
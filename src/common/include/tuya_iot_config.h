@@ -42,6 +42,48 @@ extern "C" {
 #define TUYA_WEAK_ATTRIBUTE
 #endif
 
+/* code in the section the platform linker script loads to internal RAM, see ENABLE_RAM_FUNC */
+#if defined(ENABLE_RAM_FUNC) && (ENABLE_RAM_FUNC == 1) && !defined(TUYA_RAM_FUNC_SECTION)
+#if defined(PLATFORM_T5) && (PLATFORM_T5 == 1)
+#define TUYA_RAM_FUNC_SECTION ".itcm_sec_code"
+#elif defined(PLATFORM_ESP32) && (PLATFORM_ESP32 == 1)
+#define TUYA_RAM_FUNC_SECTION ".iram1"
+#endif
+#endif
+
+#ifndef TUYA_RAM_FUNC
+#if defined(TUYA_RAM_FUNC_SECTION)
+#define TUYA_RAM_FUNC __attribute__((section(TUYA_RAM_FUNC_SECTION), noinline))
+#else
+#define TUYA_RAM_FUNC
+#endif
+#endif
+
+/* hot path groups, moved while they fit in TUYA_RAM_FUNC_BUDGET */
+#if defined(RAM_FUNC_UART) && (RAM_FUNC_UART == 1)
+#define TUYA_HOT_UART TUYA_RAM_FUNC
+#else
+#define TUYA_HOT_UART
+#endif
+
+#if defined(RAM_FUNC_AUDIO) && (RAM_FUNC_AUDIO == 1)
+#define TUYA_HOT_AUDIO TUYA_RAM_FUNC
+#else
+#define TUYA_HOT_AUDIO
+#endif
+
+#if defined(RAM_FUNC_CRYPTO) && (RAM_FUNC_CRYPTO == 1)
+#define TUYA_HOT_CRYPTO TUYA_RAM_FUNC
+#else
+#define TUYA_HOT_CRYPTO
+#endif
+
+#if defined(RAM_FUNC_DISPLAY) && (RAM_FUNC_DISPLAY == 1)
+#define TUYA_HOT_DISPLAY TUYA_RAM_FUNC
+#else
+#define TUYA_HOT_DISPLAY
+#endif
+
 /* custom settings */
 
 // clang-format on
@@ -0,0 +1,144 @@
+/**
+ * @file qrcode_cache.c
+ * @brief Cache of encoded QR code matrices, see qrcode_cache.h.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#include "qrcode_cache.h"
+#include "tal_memory.h"
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define QRCODE_MATRIX_LEN(size) (((size_t)(size) * (size) + 7) / 8 + 1)
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    char *payload; // NULL for a free slot
+    enum qrcodegen_Ecc ecc;
+    uint32_t used;
+    uint8_t *qr;
+} QRCODE_CACHE_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static QRCODE_CACHE_T s_qr_cache[QRCODE_CACHE_NUM];
+static uint32_t s_qr_used = 0;
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static void __qr_entry_free(QRCODE_CACHE_T *entry)
+{
+    tal_free(entry->payload);
+    tal_free(entry->qr);
+    memset(entry, 0, sizeof(QRCODE_CACHE_T));
+}
+
+//! encodes into a matrix of its own size, NULL on failure
+static uint8_t *__qr_encode(const char *payload, enum qrcodegen_Ecc ecc)
+{
+    size_t len = strlen(payload);
+    size_t buf_len = qrcodegen_BUFFER_LEN_FOR_VERSION(QRCODE_CACHE_VERSION_MAX);
+    uint8_t *qr = NULL, *temp = NULL, *out = NULL;
+    bool ok = false;
+
+    qr = tal_malloc(buf_len);
+    temp = tal_malloc(buf_len);
+    if (NULL == qr || NULL == temp) {
+        goto exit;
+    }
+
+    ok = qrcodegen_encodeText(payload, temp, qr, ecc, qrcodegen_VERSION_MIN, QRCODE_CACHE_VERSION_MAX,
+                              qrcodegen_Mask_AUTO, true);
+    if (!ok && len <= buf_len) {
+        memcpy(temp, payload, len);
+        ok = qrcodegen_encodeBinary(temp, len, qr, ecc, qrcodegen_VERSION_MIN, QRCODE_CACHE_VERSION_MAX,
+                                    qrcodegen_Mask_AUTO, true);
+    }
+    if (!ok) {
+        goto exit;
+    }
+
+    len = QRCODE_MATRIX_LEN(qrcodegen_getSize(qr));
+    out = tal_malloc(len);
+    if (out) {
+        memcpy(out, qr, len);
+    }
+
+exit:
+    tal_free(temp);
+    tal_free(qr);
+    return out;
+}
+
+/**
+ * @brief Gets the matrix of a payload, encoding it when it is not cached.
+ *
+ * @param payload The text to encode, binary mode is used when it does not fit
+ * the text modes.
+ * @param ecc The error correction level, the same payload with another level
+ * is another entry.
+ *
+ * @return The matrix, or NULL when the payload does not fit
+ * QRCODE_CACHE_VERSION_MAX or memory is out. It stays valid until
+ * QRCODE_CACHE_NUM other payloads were requested or qrcode_cache_clear() is
+ * called, use it from one task.
+ */
+const uint8_t *qrcode_cache_get(const char *payload, enum qrcodegen_Ecc ecc)
+{
+    QRCODE_CACHE_T *entry = &s_qr_cache[0];
+    uint8_t *qr = NULL;
+    char *copy = NULL;
+    int i;
+
+    if (NULL == payload) {
+        return NULL;
+    }
+
+    for (i = 0; i < QRCODE_CACHE_NUM; i++) {
+        if (s_qr_cache[i].payload && s_qr_cache[i].ecc == ecc && 0 == strcmp(s_qr_cache[i].payload, payload)) {
+            s_qr_cache[i].used = ++s_qr_used;
+            return s_qr_cache[i].qr;
+        }
+        //! a free slot has used 0, so it is taken before any entry
+        if (s_qr_cache[i].used < entry->used) {
+            entry = &s_qr_cache[i];
+        }
+    }
+
+    qr = __qr_encode(payload, ecc);
+    copy = tal_malloc(strlen(payload) + 1);
+    if (NULL == qr || NULL == copy) {
+        tal_free(qr);
+        tal_free(copy);
+        return NULL;
+    }
+    strcpy(copy, payload);
+
+    __qr_entry_free(entry);
+    entry->payload = copy;
+    entry->ecc = ecc;
+    entry->qr = qr;
+    entry->used = ++s_qr_used;
+
+    return qr;
+}
+
+/**
+ * @brief Frees all cached matrices.
+ *
+ * @return none
+ */
+void qrcode_cache_clear(void)
+{
+    int i;
+
+    for (i = 0; i < QRCODE_CACHE_NUM; i++) {
+        __qr_entry_free(&s_qr_cache[i]);
+    }
+}
@@ -0,0 +1,70 @@
+/**
+ * @file qrcode_cache.h
+ * @brief Cache of encoded QR code matrices.
+ *
+ * A provisioning screen shows the same payload every time it appears, so the
+ * matrix is encoded once and kept. The last QRCODE_CACHE_NUM payloads are
+ * cached, each matrix takes (size * size + 7) / 8 + 1 bytes of heap.
+ *
+ * The matrix is in the format of qrcodegen: qrcodegen_getSize() and
+ * qrcodegen_getModule() read it, and QRCODE_CACHE_BITS() gives its modules
+ * row by row, one bit each, LSB first, as tdl_disp_draw_bitmap() reads them.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#ifndef __QRCODE_CACHE_H__
+#define __QRCODE_CACHE_H__
+
+#include "tuya_cloud_types.h"
+#include "qrcodegen.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#ifndef QRCODE_CACHE_NUM
+#define QRCODE_CACHE_NUM 2
+#endif
+
+// bounds the heap taken while encoding, two buffers of qrcodegen_BUFFER_LEN_FOR_VERSION()
+#ifndef QRCODE_CACHE_VERSION_MAX
+#define QRCODE_CACHE_VERSION_MAX 20
+#endif
+
+#define QRCODE_CACHE_BITS(qr) ((const uint8_t *)(qr) + 1)
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+
+/**
+ * @brief Gets the matrix of a payload, encoding it when it is not cached.
+ *
+ * @param payload The text to encode, binary mode is used when it does not fit
+ * the text modes.
+ * @param ecc The error correction level, the same payload with another level
+ * is another entry.
+ *
+ * @return The matrix, or NULL when the payload does not fit
+ * QRCODE_CACHE_VERSION_MAX or memory is out. It stays valid until
+ * QRCODE_CACHE_NUM other payloads were requested or qrcode_cache_clear() is
+ * called, use it from one task.
+ */
+const uint8_t *qrcode_cache_get(const char *payload, enum qrcodegen_Ecc ecc);
+
+/**
+ * @brief Frees all cached matrices.
+ *
+ * @return none
+ */
+void qrcode_cache_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __QRCODE_CACHE_H__ */
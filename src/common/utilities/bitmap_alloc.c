@@ -0,0 +1,77 @@
+/**
+ * @file bitmap_alloc.c
+ * @brief Lock-free bitmap allocator for fixed size slots.
+ *
+ * The bits past the last slot in the last word are set at init, so a full
+ * word always reads as 0xFFFFFFFF and no search has to check the bound.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#include <string.h>
+
+#include "bitmap_alloc.h"
+
+void bitmap_alloc_init(BITMAP_ALLOC_T *bm, uint32_t *words, uint32_t bits)
+{
+    uint32_t num = BITMAP_ALLOC_WORDS(bits);
+
+    memset(words, 0, num * sizeof(uint32_t));
+    if (bits % 32) {
+        words[num - 1] = ~((1u << (bits % 32)) - 1);
+    }
+    bm->words = words;
+    bm->bits = bits;
+    bm->hint = 0;
+}
+
+int32_t bitmap_alloc_get(BITMAP_ALLOC_T *bm)
+{
+    uint32_t num = BITMAP_ALLOC_WORDS(bm->bits);
+    uint32_t start = __atomic_load_n(&bm->hint, __ATOMIC_RELAXED);
+    uint32_t i = 0, w = 0, word = 0, bit = 0;
+
+    for (i = 0; i < num; i++) {
+        w = (start + i) % num;
+        word = __atomic_load_n(&bm->words[w], __ATOMIC_RELAXED);
+        while (word != 0xFFFFFFFFu) {
+            bit = (uint32_t)__builtin_ctz(~word);
+            // on failure word is reloaded, retry in the same word until it fills up
+            if (__atomic_compare_exchange_n(&bm->words[w], &word, word | (1u << bit), true, __ATOMIC_ACQUIRE,
+                                            __ATOMIC_RELAXED)) {
+                __atomic_store_n(&bm->hint, w, __ATOMIC_RELAXED);
+                return (int32_t)(w * 32 + bit);
+            }
+        }
+    }
+
+    return -1;
+}
+
+void bitmap_alloc_put(BITMAP_ALLOC_T *bm, uint32_t index)
+{
+    if (index >= bm->bits) {
+        return;
+    }
+    __atomic_fetch_and(&bm->words[index / 32], ~(1u << (index % 32)), __ATOMIC_RELEASE);
+}
+
+bool bitmap_alloc_test(BITMAP_ALLOC_T *bm, uint32_t index)
+{
+    if (index >= bm->bits) {
+        return false;
+    }
+    return (__atomic_load_n(&bm->words[index / 32], __ATOMIC_RELAXED) >> (index % 32)) & 1;
+}
+
+uint32_t bitmap_alloc_used(BITMAP_ALLOC_T *bm)
+{
+    uint32_t num = BITMAP_ALLOC_WORDS(bm->bits);
+    uint32_t i = 0, used = 0;
+
+    for (i = 0; i < num; i++) {
+        used += (uint32_t)__builtin_popcount(__atomic_load_n(&bm->words[i], __ATOMIC_RELAXED));
+    }
+
+    return used - (num * 32 - bm->bits);
+}
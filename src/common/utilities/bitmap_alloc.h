@@ -0,0 +1,71 @@
+/**
+ * @file bitmap_alloc.h
+ * @brief Lock-free bitmap allocator for fixed size slots.
+ *
+ * Hands out slot indexes 0..bits-1, one bit per slot in caller provided
+ * 32-bit words. Allocation finds a clear bit with count-trailing-zeros and
+ * sets it with a compare-and-swap, freeing clears it atomically, so both are
+ * safe from any task or ISR without a lock. Searching starts next to the
+ * last allocation so a mostly full map is not rescanned from the start.
+ *
+ * Pair it with an array of equally sized blocks to get a pool allocator
+ * whose state is a few words.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#ifndef __BITMAP_ALLOC_H__
+#define __BITMAP_ALLOC_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t *words;
+    uint32_t bits;
+    uint32_t hint; // word to start the next search at
+} BITMAP_ALLOC_T;
+
+#define BITMAP_ALLOC_WORDS(bits) (((bits) + 31) / 32)
+
+/**
+ * @brief Initializes the allocator with every slot free.
+ *
+ * @param bm The allocator.
+ * @param words BITMAP_ALLOC_WORDS(bits) words, cleared here.
+ * @param bits Number of slots.
+ */
+void bitmap_alloc_init(BITMAP_ALLOC_T *bm, uint32_t *words, uint32_t bits);
+
+/**
+ * @brief Allocates a slot.
+ *
+ * @return The slot index, or -1 when every slot is taken.
+ */
+int32_t bitmap_alloc_get(BITMAP_ALLOC_T *bm);
+
+/**
+ * @brief Frees a slot returned by bitmap_alloc_get().
+ */
+void bitmap_alloc_put(BITMAP_ALLOC_T *bm, uint32_t index);
+
+/**
+ * @brief Whether a slot is allocated.
+ */
+bool bitmap_alloc_test(BITMAP_ALLOC_T *bm, uint32_t index);
+
+/**
+ * @brief Number of allocated slots, a snapshot when other contexts allocate.
+ */
+uint32_t bitmap_alloc_used(BITMAP_ALLOC_T *bm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BITMAP_ALLOC_H__ */
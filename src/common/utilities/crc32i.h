@@ -15,6 +15,11 @@
 #ifndef __CR_CRC32I_H__
 #define __CR_CRC32I_H__
 
+// bytes done per step of hash_crc32i_update, 1, 4 or 8, the tables take 1 KB per byte
+#ifndef CRC32I_SLICE_BY
+#define CRC32I_SLICE_BY 8
+#endif
+
 /**
  * @brief Initializes the CRC32I hash algorithm.
  *
@@ -18,6 +18,22 @@ extern "C" {
 #define __CRC_16_MODULE_EXT extern
 #endif
 
+// initial value of the CRC-16/MODBUS computed here
+#define CRC_16_INIT 0xFFFF
+
+/**
+ * @brief Updates a CRC-16 checksum with the given data.
+ *
+ * Feeding data in parts gives the same result as get_crc_16() over all of it.
+ *
+ * @param crc The current checksum, CRC_16_INIT for the first data.
+ * @param data The data to add.
+ * @param size The size of the data in bytes.
+ * @return The updated checksum.
+ */
+__CRC_16_MODULE_EXT
+unsigned short crc_16_update(unsigned short crc, const void *data, unsigned int size);
+
 /**
  * @brief Calculates the CRC-16 checksum for the given data.
  *
@@ -0,0 +1,179 @@
+/**
+ * @file hash_map.c
+ * @brief Open addressing hash map with integer or string keys.
+ *
+ * A slot is taken by an entry whose hash is not 0, hashes of 0 are stored as
+ * 1. Every entry sits in the probe run that starts at its home slot
+ * (hash & mask), removal keeps it that way by moving later entries of the
+ * run back into the freed slot.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#include <string.h>
+
+#include "hash_map.h"
+
+uint32_t hash_map_str_hash(const char *str)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*str) {
+        hash ^= (uint8_t)*str++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint32_t hash_map_int_hash(uint32_t key)
+{
+    key ^= key >> 16;
+    key *= 0x85ebca6bu;
+    key ^= key >> 13;
+    key *= 0xc2b2ae35u;
+    key ^= key >> 16;
+    return key;
+}
+
+static uint32_t __hash_map_hash(const HASH_MAP_T *map, uintptr_t key)
+{
+    uint32_t hash = (HASH_MAP_KEY_STR == map->type) ? hash_map_str_hash((const char *)key)
+                                                    : hash_map_int_hash((uint32_t)key);
+    return hash ? hash : 1;
+}
+
+static bool __hash_map_key_eq(const HASH_MAP_T *map, const HASH_MAP_SLOT_T *slot, uintptr_t key, uint32_t hash)
+{
+    if (slot->hash != hash) {
+        return false;
+    }
+    if (HASH_MAP_KEY_STR == map->type) {
+        return slot->key == key || 0 == strcmp((const char *)slot->key, (const char *)key);
+    }
+    return slot->key == key;
+}
+
+//! the slot of the key, or the free slot that ends its probe run
+static uint32_t __hash_map_find(const HASH_MAP_T *map, uintptr_t key, uint32_t hash)
+{
+    uint32_t i = hash & map->mask;
+
+    while (map->slots[i].hash && !__hash_map_key_eq(map, &map->slots[i], key, hash)) {
+        i = (i + 1) & map->mask;
+    }
+    return i;
+}
+
+uint32_t hash_map_slots(uint32_t num)
+{
+    uint32_t slots = 4;
+
+    while (slots / 4 * 3 < num) {
+        slots <<= 1;
+    }
+    return slots;
+}
+
+OPERATE_RET hash_map_init(HASH_MAP_T *map, HASH_MAP_SLOT_T *slots, uint32_t slot_num, HASH_MAP_KEY_E type)
+{
+    if (NULL == map || NULL == slots || slot_num < 4 || (slot_num & (slot_num - 1))) {
+        return OPRT_INVALID_PARM;
+    }
+
+    memset(slots, 0, slot_num * sizeof(HASH_MAP_SLOT_T));
+    map->slots = slots;
+    map->mask = slot_num - 1;
+    map->count = 0;
+    map->type = type;
+
+    return OPRT_OK;
+}
+
+OPERATE_RET hash_map_put(HASH_MAP_T *map, uintptr_t key, void *value, void **old)
+{
+    uint32_t hash = __hash_map_hash(map, key);
+    uint32_t i = __hash_map_find(map, key, hash);
+    HASH_MAP_SLOT_T *slot = &map->slots[i];
+
+    if (slot->hash) {
+        if (old) {
+            *old = slot->value;
+        }
+        slot->value = value;
+        return OPRT_OK;
+    }
+
+    // a free slot has to remain so that every probe run ends
+    if (map->count >= (map->mask + 1) / 4 * 3) {
+        return OPRT_EXCEED_UPPER_LIMIT;
+    }
+
+    slot->key = key;
+    slot->value = value;
+    slot->hash = hash;
+    map->count++;
+    if (old) {
+        *old = NULL;
+    }
+
+    return OPRT_OK;
+}
+
+void *hash_map_get(HASH_MAP_T *map, uintptr_t key)
+{
+    uint32_t i = __hash_map_find(map, key, __hash_map_hash(map, key));
+
+    return map->slots[i].hash ? map->slots[i].value : NULL;
+}
+
+void *hash_map_remove(HASH_MAP_T *map, uintptr_t key)
+{
+    uint32_t i = __hash_map_find(map, key, __hash_map_hash(map, key));
+    uint32_t j = i, home = 0;
+    void *value = NULL;
+
+    if (0 == map->slots[i].hash) {
+        return NULL;
+    }
+    value = map->slots[i].value;
+
+    // move back every later entry of the run whose home is not between i and j
+    for (;;) {
+        j = (j + 1) & map->mask;
+        if (0 == map->slots[j].hash) {
+            break;
+        }
+        home = map->slots[j].hash & map->mask;
+        if (((j - home) & map->mask) >= ((j - i) & map->mask)) {
+            map->slots[i] = map->slots[j];
+            i = j;
+        }
+    }
+    memset(&map->slots[i], 0, sizeof(HASH_MAP_SLOT_T));
+    map->count--;
+
+    return value;
+}
+
+void hash_map_clear(HASH_MAP_T *map)
+{
+    memset(map->slots, 0, (map->mask + 1) * sizeof(HASH_MAP_SLOT_T));
+    map->count = 0;
+}
+
+bool hash_map_next(HASH_MAP_T *map, uint32_t *pos, uintptr_t *key, void **value)
+{
+    while (*pos <= map->mask) {
+        HASH_MAP_SLOT_T *slot = &map->slots[(*pos)++];
+        if (slot->hash) {
+            if (key) {
+                *key = slot->key;
+            }
+            if (value) {
+                *value = slot->value;
+            }
+            return true;
+        }
+    }
+    return false;
+}
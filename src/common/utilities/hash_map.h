@@ -0,0 +1,121 @@
+/**
+ * @file hash_map.h
+ * @brief Open addressing hash map with integer or string keys.
+ *
+ * Linear probing over a power of two slot array provided by the caller, so
+ * the map never allocates and can live in any memory region. Removal shifts
+ * the following entries back instead of leaving tombstones, lookups stay
+ * short however often entries come and go. The map holds at most 3/4 of its
+ * slots, hash_map_slots() gives the slot count for a number of entries.
+ *
+ * String keys are not copied, the string must stay valid while it is in the
+ * map, typically it is a member of the value. The map takes no lock.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#ifndef __HASH_MAP_H__
+#define __HASH_MAP_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    HASH_MAP_KEY_INT = 0, // the key is the integer itself
+    HASH_MAP_KEY_STR,     // the key is a pointer to a NUL terminated string
+} HASH_MAP_KEY_E;
+
+typedef struct {
+    uintptr_t key;
+    void *value;
+    uint32_t hash; // 0 marks a free slot
+} HASH_MAP_SLOT_T;
+
+typedef struct {
+    HASH_MAP_SLOT_T *slots;
+    uint32_t mask; // slot count - 1
+    uint32_t count;
+    HASH_MAP_KEY_E type;
+} HASH_MAP_T;
+
+#define HASH_MAP_STR(s) ((uintptr_t)(const char *)(s))
+
+/**
+ * @brief Slot count a map needs for up to num entries.
+ */
+uint32_t hash_map_slots(uint32_t num);
+
+/**
+ * @brief Initializes an empty map on caller provided slots.
+ *
+ * @param map The map.
+ * @param slots Slot array, cleared here.
+ * @param slot_num Number of slots, a power of two.
+ * @param type Key type.
+ *
+ * @return OPRT_OK, or OPRT_INVALID_PARM when slot_num is not a power of two.
+ */
+OPERATE_RET hash_map_init(HASH_MAP_T *map, HASH_MAP_SLOT_T *slots, uint32_t slot_num, HASH_MAP_KEY_E type);
+
+/**
+ * @brief Adds an entry or replaces the value of its key.
+ *
+ * @param map The map.
+ * @param key The key.
+ * @param value The value.
+ * @param old Set to the replaced value, or NULL for a new key. May be NULL.
+ *
+ * @return OPRT_OK, or OPRT_EXCEED_UPPER_LIMIT when a new key finds the map full.
+ */
+OPERATE_RET hash_map_put(HASH_MAP_T *map, uintptr_t key, void *value, void **old);
+
+/**
+ * @brief Looks a key up.
+ *
+ * @return The value, NULL when the key is not in the map.
+ */
+void *hash_map_get(HASH_MAP_T *map, uintptr_t key);
+
+/**
+ * @brief Removes a key.
+ *
+ * @return The value it had, NULL when the key is not in the map.
+ */
+void *hash_map_remove(HASH_MAP_T *map, uintptr_t key);
+
+/**
+ * @brief Removes every entry.
+ */
+void hash_map_clear(HASH_MAP_T *map);
+
+/**
+ * @brief Walks the entries, in no particular order.
+ *
+ * @param map The map.
+ * @param pos Iteration state, set to 0 before the first call.
+ * @param key Set to the key of the entry. May be NULL.
+ * @param value Set to the value of the entry. May be NULL.
+ *
+ * @return false when there is no further entry. The map must not change
+ *         during the walk.
+ */
+bool hash_map_next(HASH_MAP_T *map, uint32_t *pos, uintptr_t *key, void **value);
+
+/**
+ * @brief Hash of a NUL terminated string, FNV-1a.
+ */
+uint32_t hash_map_str_hash(const char *str);
+
+/**
+ * @brief Hash of an integer, the murmur3 finalizer.
+ */
+uint32_t hash_map_int_hash(uint32_t key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HASH_MAP_H__ */
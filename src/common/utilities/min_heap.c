@@ -0,0 +1,121 @@
+/**
+ * @file min_heap.c
+ * @brief Intrusive binary min-heap keyed by wrapping 32-bit values.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#include "min_heap.h"
+
+#define KEY_BEFORE(a, b) ((int32_t)((a) - (b)) < 0)
+
+static inline void __heap_set(MIN_HEAP_T *heap, uint32_t i, MIN_HEAP_NODE_T *node)
+{
+    heap->nodes[i] = node;
+    node->index = i;
+}
+
+static void __heap_sift_up(MIN_HEAP_T *heap, uint32_t i)
+{
+    MIN_HEAP_NODE_T *node = heap->nodes[i];
+
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (!KEY_BEFORE(node->key, heap->nodes[parent]->key)) {
+            break;
+        }
+        __heap_set(heap, i, heap->nodes[parent]);
+        i = parent;
+    }
+    __heap_set(heap, i, node);
+}
+
+static void __heap_sift_down(MIN_HEAP_T *heap, uint32_t i)
+{
+    MIN_HEAP_NODE_T *node = heap->nodes[i];
+
+    for (;;) {
+        uint32_t child = 2 * i + 1;
+        if (child >= heap->count) {
+            break;
+        }
+        if (child + 1 < heap->count && KEY_BEFORE(heap->nodes[child + 1]->key, heap->nodes[child]->key)) {
+            child++;
+        }
+        if (!KEY_BEFORE(heap->nodes[child]->key, node->key)) {
+            break;
+        }
+        __heap_set(heap, i, heap->nodes[child]);
+        i = child;
+    }
+    __heap_set(heap, i, node);
+}
+
+void min_heap_init(MIN_HEAP_T *heap, MIN_HEAP_NODE_T **nodes, uint32_t size)
+{
+    heap->nodes = nodes;
+    heap->size = size;
+    heap->count = 0;
+}
+
+OPERATE_RET min_heap_push(MIN_HEAP_T *heap, MIN_HEAP_NODE_T *node, uint32_t key)
+{
+    if (heap->count >= heap->size) {
+        return OPRT_EXCEED_UPPER_LIMIT;
+    }
+
+    node->key = key;
+    heap->nodes[heap->count] = node;
+    __heap_sift_up(heap, heap->count++);
+
+    return OPRT_OK;
+}
+
+MIN_HEAP_NODE_T *min_heap_pop(MIN_HEAP_T *heap)
+{
+    MIN_HEAP_NODE_T *top = min_heap_peek(heap);
+
+    if (top) {
+        min_heap_remove(heap, top);
+    }
+    return top;
+}
+
+void min_heap_remove(MIN_HEAP_T *heap, MIN_HEAP_NODE_T *node)
+{
+    uint32_t i = node->index;
+
+    if (i >= heap->count || heap->nodes[i] != node) {
+        return;
+    }
+
+    node->index = MIN_HEAP_NONE;
+    if (i == --heap->count) {
+        return;
+    }
+
+    // the last node fills the hole and moves whichever way its key asks for
+    heap->nodes[i] = heap->nodes[heap->count];
+    if (i > 0 && KEY_BEFORE(heap->nodes[i]->key, heap->nodes[(i - 1) / 2]->key)) {
+        __heap_sift_up(heap, i);
+    } else {
+        __heap_sift_down(heap, i);
+    }
+}
+
+void min_heap_update(MIN_HEAP_T *heap, MIN_HEAP_NODE_T *node, uint32_t key)
+{
+    uint32_t i = node->index;
+    uint32_t old = node->key;
+
+    if (i >= heap->count || heap->nodes[i] != node) {
+        return;
+    }
+
+    node->key = key;
+    if (KEY_BEFORE(key, old)) {
+        __heap_sift_up(heap, i);
+    } else {
+        __heap_sift_down(heap, i);
+    }
+}
@@ -0,0 +1,92 @@
+/**
+ * @file min_heap.h
+ * @brief Intrusive binary min-heap keyed by wrapping 32-bit values.
+ *
+ * The node is embedded in the item and remembers its position, so an item can
+ * be removed or re-keyed in O(log n) without a search, which is what timer
+ * and deadline queues need. The pointer array is provided by the caller.
+ *
+ * Keys compare as wrapping tick counts, a before b when (int32_t)(a - b) < 0,
+ * so the keys in one heap must stay within 2^31 of each other. The heap takes
+ * no lock.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#ifndef __MIN_HEAP_H__
+#define __MIN_HEAP_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t key;
+    uint32_t index; // position in the heap, MIN_HEAP_NONE when not in one
+} MIN_HEAP_NODE_T;
+
+typedef struct {
+    MIN_HEAP_NODE_T **nodes;
+    uint32_t size;
+    uint32_t count;
+} MIN_HEAP_T;
+
+#define MIN_HEAP_NONE 0xFFFFFFFFu
+
+#define MIN_HEAP_ENTRY(node, type, member) ((type *)((char *)(node) - offsetof(type, member)))
+
+/**
+ * @brief Initializes an empty heap on a caller provided pointer array.
+ */
+void min_heap_init(MIN_HEAP_T *heap, MIN_HEAP_NODE_T **nodes, uint32_t size);
+
+/**
+ * @brief Marks a node as not in a heap, before its first push.
+ */
+static inline void min_heap_node_init(MIN_HEAP_NODE_T *node)
+{
+    node->index = MIN_HEAP_NONE;
+}
+
+static inline bool min_heap_node_queued(const MIN_HEAP_NODE_T *node)
+{
+    return node->index != MIN_HEAP_NONE;
+}
+
+/**
+ * @brief Adds a node with the given key.
+ *
+ * @return OPRT_OK, or OPRT_EXCEED_UPPER_LIMIT when the heap is full.
+ */
+OPERATE_RET min_heap_push(MIN_HEAP_T *heap, MIN_HEAP_NODE_T *node, uint32_t key);
+
+/**
+ * @brief The node with the smallest key, NULL when the heap is empty.
+ */
+static inline MIN_HEAP_NODE_T *min_heap_peek(const MIN_HEAP_T *heap)
+{
+    return heap->count ? heap->nodes[0] : NULL;
+}
+
+/**
+ * @brief Takes the node with the smallest key out, NULL when the heap is empty.
+ */
+MIN_HEAP_NODE_T *min_heap_pop(MIN_HEAP_T *heap);
+
+/**
+ * @brief Takes a node out wherever it is, nothing when it is not queued.
+ */
+void min_heap_remove(MIN_HEAP_T *heap, MIN_HEAP_NODE_T *node);
+
+/**
+ * @brief Changes the key of a queued node and restores the heap order.
+ */
+void min_heap_update(MIN_HEAP_T *heap, MIN_HEAP_NODE_T *node, uint32_t key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MIN_HEAP_H__ */
@@ -16,7 +16,6 @@
 #define __MIX_METHOD_GLOBALS
 #include "mix_method.h"
 #include "tal_memory.h"
-#include "mbedtls/base64.h"
 
 /***********************************************************
 *************************micro define***********************
@@ -24,9 +23,57 @@
 #define __tolower(c)                 ((('A' <= (c)) && ((c) <= 'Z')) ? ((c) - 'A' + 'a') : (c))
 #define TY_BASE64_BUF_LEN_CALC(slen) (((slen) / 3 + ((slen) % 3 != 0)) * 4 + 1) // 1 for '\0'
 
+#define HEX_BAD    0x10 // in cHEX_VAL, never a nibble, so "& 0x0F" reads it as 0
+#define BASE64_PAD 0x40 // in cBASE64_VAL, '='
+#define BASE64_WS  0x41 // in cBASE64_VAL, '\r', '\n' and ' ' are skipped as mbedtls does
+#define BASE64_BAD 0xFF
+
 /***********************************************************
 *************************variable define********************
 ***********************************************************/
+static const char cHEX_UPPER[16] = "0123456789ABCDEF";
+static const char cHEX_LOWER[16] = "0123456789abcdef";
+
+static const uint8_t cHEX_VAL[256] = {
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+};
+
+static const char cBASE64_CHAR[64] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+//! a value of 64 or more is not data, so four values are checked with one OR
+static const uint8_t cBASE64_VAL[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x41, 0xff, 0xff, 0x41, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x41, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff, 0xff, 0x40, 0xff, 0xff,
+    0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
 
 /***********************************************************
 *************************function define********************
@@ -73,19 +120,7 @@ int uni_strcmp(const char *src, const char *dst)
  */
 unsigned char asc2hex(char asccode)
 {
-    unsigned char ret;
-
-    if ('0' <= asccode && asccode <= '9') {
-        ret = asccode - '0';
-    } else if ('a' <= asccode && asccode <= 'f') {
-        ret = asccode - 'a' + 10;
-    } else if ('A' <= asccode && asccode <= 'F') {
-        ret = asccode - 'A' + 10;
-    } else {
-        ret = 0;
-    }
-
-    return ret;
+    return cHEX_VAL[(uint8_t)asccode] & 0x0F;
 }
 
 /**
@@ -97,23 +132,58 @@ unsigned char asc2hex(char asccode)
  */
 void ascs2hex(unsigned char *hex, unsigned char *ascs, int srclen)
 {
-    unsigned char l4, h4;
-    int i, lenstr;
-    lenstr = srclen;
+    int i;
 
-    if (lenstr % 2) {
-        lenstr -= (lenstr % 2);
+    for (i = 0; i + 1 < srclen; i += 2) {
+        hex[i / 2] = ((cHEX_VAL[ascs[i]] & 0x0F) << 4) | (cHEX_VAL[ascs[i + 1]] & 0x0F);
     }
+}
 
-    if (lenstr == 0) {
-        return;
+/**
+ * @brief Converts a hex string to bytes, checking every character.
+ *
+ * @param src The hex string, upper or lower case.
+ * @param len The length of src, an even number.
+ * @param dst The buffer of the bytes.
+ * @param size The size of dst, at least len / 2.
+ * @return The number of bytes written, OPRT_INVALID_PARM when src is not hex
+ * or OPRT_BUFFER_NOT_ENOUGH.
+ */
+int tuya_hex_decode(const char *src, size_t len, unsigned char *dst, size_t size)
+{
+    const uint8_t *s = (const uint8_t *)src;
+    size_t i = 0, o = 0;
+    uint8_t a, b, c, d;
+
+    if (NULL == src || NULL == dst || len % 2) {
+        return OPRT_INVALID_PARM;
+    }
+    if (size < len / 2) {
+        return OPRT_BUFFER_NOT_ENOUGH;
     }
 
-    for (i = 0; i < lenstr; i += 2) {
-        h4 = asc2hex(ascs[i]);
-        l4 = asc2hex(ascs[i + 1]);
-        hex[i / 2] = (h4 << 4) + l4;
+    //! two bytes a round, their four nibbles are checked at once
+    for (; i + 4 <= len; i += 4, o += 2) {
+        a = cHEX_VAL[s[i]];
+        b = cHEX_VAL[s[i + 1]];
+        c = cHEX_VAL[s[i + 2]];
+        d = cHEX_VAL[s[i + 3]];
+        if ((a | b | c | d) & HEX_BAD) {
+            return OPRT_INVALID_PARM;
+        }
+        dst[o] = (a << 4) | b;
+        dst[o + 1] = (c << 4) | d;
     }
+    if (i < len) {
+        a = cHEX_VAL[s[i]];
+        b = cHEX_VAL[s[i + 1]];
+        if ((a | b) & HEX_BAD) {
+            return OPRT_INVALID_PARM;
+        }
+        dst[o++] = (a << 4) | b;
+    }
+
+    return (int)o;
 }
 
 /**
@@ -125,23 +195,7 @@ void ascs2hex(unsigned char *hex, unsigned char *ascs, int srclen)
  */
 void hex2str(unsigned char *pbDest, unsigned char *pbSrc, int nLen)
 {
-    char ddl, ddh;
-    int i;
-
-    for (i = 0; i < nLen; i++) {
-        ddh = 48 + pbSrc[i] / 16;
-        ddl = 48 + pbSrc[i] % 16;
-        if (ddh > 57) {
-            ddh = ddh + 7;
-        }
-        if (ddl > 57) {
-            ddl = ddl + 7;
-        }
-        pbDest[i * 2] = ddh;
-        pbDest[i * 2 + 1] = ddl;
-    }
-
-    pbDest[nLen * 2] = '\0';
+    byte2str(pbDest, pbSrc, nLen, TRUE);
 }
 
 /**
@@ -168,21 +222,49 @@ void hex2str(unsigned char *pbDest, unsigned char *pbSrc, int nLen)
  */
 void byte2str(unsigned char *pbDest, unsigned char *pbSrc, int nLen, bool_t upper)
 {
-    char to_lower[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'};
-    char to_upper[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
-
-    char *tmp = upper ? to_upper : to_lower;
-
+    const char *tmp = upper ? cHEX_UPPER : cHEX_LOWER;
     int i;
+
     for (i = 0; i < nLen; i++) {
-        pbDest[i * 2] = tmp[((pbSrc[i] & 0xF0) >> 4)];
-        pbDest[i * 2 + 1] = tmp[(pbSrc[i] & 0x0F)];
+        pbDest[i * 2] = tmp[pbSrc[i] >> 4];
+        pbDest[i * 2 + 1] = tmp[pbSrc[i] & 0x0F];
     }
 
     pbDest[nLen * 2] = '\0';
     return;
 }
 
+/**
+ * @brief Converts bytes to a NUL terminated hex string.
+ *
+ * @param src The bytes to convert.
+ * @param len The number of bytes.
+ * @param dst The buffer of the string.
+ * @param size The size of dst, at least len * 2 + 1.
+ * @param upper Use upper case digits.
+ * @return The length of the string, or OPRT_BUFFER_NOT_ENOUGH.
+ */
+int tuya_hex_encode(const unsigned char *src, size_t len, char *dst, size_t size, bool_t upper)
+{
+    const char *tmp = upper ? cHEX_UPPER : cHEX_LOWER;
+    size_t i;
+
+    if (NULL == src || NULL == dst) {
+        return OPRT_INVALID_PARM;
+    }
+    if (0 == size || len > (size - 1) / 2) {
+        return OPRT_BUFFER_NOT_ENOUGH;
+    }
+
+    for (i = 0; i < len; i++) {
+        dst[i * 2] = tmp[src[i] >> 4];
+        dst[i * 2 + 1] = tmp[src[i] & 0x0F];
+    }
+    dst[len * 2] = '\0';
+
+    return (int)(len * 2);
+}
+
 /**
  * @brief Finds the position of a character in a string, starting from the end.
  *
@@ -466,12 +548,54 @@ int tuya_toupper(int c)
  */
 char *tuya_base64_encode(const unsigned char *bindata, char *base64, int binlength)
 {
-    size_t dlen, olen;
-    dlen = TY_BASE64_BUF_LEN_CALC(binlength);
-    mbedtls_base64_encode((unsigned char *)base64, dlen, &olen, bindata, binlength);
+    tuya_base64_encode_buf(bindata, binlength, base64, TY_BASE64_BUF_LEN_CALC(binlength));
     return base64;
 }
 
+/**
+ * @brief Encodes binary data into a NUL terminated base64 string.
+ *
+ * @param bindata The binary data to be encoded.
+ * @param binlength The length of the binary data.
+ * @param base64 The buffer of the string.
+ * @param size The size of base64, at least (binlength + 2) / 3 * 4 + 1.
+ * @return The length of the string, or OPRT_BUFFER_NOT_ENOUGH.
+ */
+int tuya_base64_encode_buf(const unsigned char *bindata, size_t binlength, char *base64, size_t size)
+{
+    size_t i = 0, o = 0;
+    uint32_t w;
+
+    if (NULL == bindata || NULL == base64) {
+        return OPRT_INVALID_PARM;
+    }
+    if (size <= (binlength + 2) / 3 * 4) {
+        return OPRT_BUFFER_NOT_ENOUGH;
+    }
+
+    for (; i + 3 <= binlength; i += 3, o += 4) {
+        w = ((uint32_t)bindata[i] << 16) | ((uint32_t)bindata[i + 1] << 8) | bindata[i + 2];
+        base64[o] = cBASE64_CHAR[w >> 18];
+        base64[o + 1] = cBASE64_CHAR[(w >> 12) & 0x3F];
+        base64[o + 2] = cBASE64_CHAR[(w >> 6) & 0x3F];
+        base64[o + 3] = cBASE64_CHAR[w & 0x3F];
+    }
+    if (i < binlength) {
+        w = (uint32_t)bindata[i] << 16;
+        if (i + 1 < binlength) {
+            w |= (uint32_t)bindata[i + 1] << 8;
+        }
+        base64[o] = cBASE64_CHAR[w >> 18];
+        base64[o + 1] = cBASE64_CHAR[(w >> 12) & 0x3F];
+        base64[o + 2] = (i + 1 < binlength) ? cBASE64_CHAR[(w >> 6) & 0x3F] : '=';
+        base64[o + 3] = '=';
+        o += 4;
+    }
+    base64[o] = '\0';
+
+    return (int)o;
+}
+
 /**
  * @brief Decodes a base64 encoded string.
  *
@@ -484,9 +608,80 @@ char *tuya_base64_encode(const unsigned char *bindata, char *base64, int binleng
  */
 int tuya_base64_decode(const char *base64, unsigned char *bindata)
 {
-    size_t olen = 0;
+    size_t len = strlen(base64);
+    int olen = tuya_base64_decode_buf(base64, len, bindata, len);
+
+    return (olen < 0) ? 0 : olen;
+}
+
+/**
+ * @brief Decodes base64 data, checking every character and the padding.
+ *
+ * @param base64 The base64 data, "\r", "\n" and " " in it are skipped.
+ * @param len The length of base64.
+ * @param bindata The buffer of the decoded data.
+ * @param size The size of bindata, len / 4 * 3 is always enough.
+ * @return The length of the decoded data, OPRT_INVALID_PARM when base64 is not
+ * valid or OPRT_BUFFER_NOT_ENOUGH.
+ */
+int tuya_base64_decode_buf(const char *base64, size_t len, unsigned char *bindata, size_t size)
+{
+    const uint8_t *s = (const uint8_t *)base64;
+    size_t i = 0, o = 0;
+    uint32_t w = 0, n = 0, pad = 0;
+    uint8_t v;
+
+    if (NULL == base64 || NULL == bindata) {
+        return OPRT_INVALID_PARM;
+    }
+
+    while (i < len) {
+        //! a whole group of four data characters goes at once
+        if (0 == n && i + 4 <= len && o + 3 <= size &&
+            0 == ((cBASE64_VAL[s[i]] | cBASE64_VAL[s[i + 1]] | cBASE64_VAL[s[i + 2]] | cBASE64_VAL[s[i + 3]]) &
+                  0xC0)) {
+            if (pad) {
+                return OPRT_INVALID_PARM;
+            }
+            w = ((uint32_t)cBASE64_VAL[s[i]] << 18) | ((uint32_t)cBASE64_VAL[s[i + 1]] << 12) |
+                ((uint32_t)cBASE64_VAL[s[i + 2]] << 6) | cBASE64_VAL[s[i + 3]];
+            bindata[o] = (uint8_t)(w >> 16);
+            bindata[o + 1] = (uint8_t)(w >> 8);
+            bindata[o + 2] = (uint8_t)w;
+            i += 4;
+            o += 3;
+            continue;
+        }
 
-    mbedtls_base64_decode(bindata, strlen(base64), &olen, (unsigned char *)base64, strlen(base64));
+        v = cBASE64_VAL[s[i++]];
+        if (BASE64_WS == v) {
+            continue;
+        }
+        if (BASE64_PAD == v) {
+            if (n < 2 || ++pad > 2) {
+                return OPRT_INVALID_PARM;
+            }
+            v = 0;
+        } else if (v >= 64 || pad) {
+            return OPRT_INVALID_PARM;
+        }
+        w = (w << 6) | v;
+        if (++n < 4) {
+            continue;
+        }
+        if (o + 3 - pad > size) {
+            return OPRT_BUFFER_NOT_ENOUGH;
+        }
+        bindata[o++] = (uint8_t)(w >> 16);
+        if (pad < 2) {
+            bindata[o++] = (uint8_t)(w >> 8);
+        }
+        if (pad < 1) {
+            bindata[o++] = (uint8_t)w;
+        }
+        w = 0;
+        n = 0;
+    }
 
-    return olen;
+    return n ? OPRT_INVALID_PARM : (int)o;
 }
@@ -91,6 +91,32 @@ void hex2str(unsigned char *pbDest, unsigned char *pbSrc, int nLen);
 void byte2str(unsigned char *pbDest, unsigned char *pbSrc, int nLen,
               bool_t upper);
 
+/**
+ * @brief Converts bytes to a NUL terminated hex string.
+ *
+ * @param src The bytes to convert.
+ * @param len The number of bytes.
+ * @param dst The buffer of the string.
+ * @param size The size of dst, at least len * 2 + 1.
+ * @param upper Use upper case digits.
+ * @return The length of the string, or OPRT_BUFFER_NOT_ENOUGH.
+ */
+int tuya_hex_encode(const unsigned char *src, size_t len, char *dst, size_t size, bool_t upper);
+
+/**
+ * @brief Converts a hex string to bytes, checking every character.
+ *
+ * Unlike ascs2hex(), which reads any other character as 0.
+ *
+ * @param src The hex string, upper or lower case.
+ * @param len The length of src, an even number.
+ * @param dst The buffer of the bytes.
+ * @param size The size of dst, at least len / 2.
+ * @return The number of bytes written, OPRT_INVALID_PARM when src is not hex
+ * or OPRT_BUFFER_NOT_ENOUGH.
+ */
+int tuya_hex_decode(const char *src, size_t len, unsigned char *dst, size_t size);
+
 /**
  * @brief find <ch> in <str>, start find in index <revr_index>, find in reverse
  * order.
@@ -203,6 +229,29 @@ char *tuya_base64_encode(const unsigned char *bindata, char *base64,
  */
 int tuya_base64_decode(const char * base64, unsigned char * bindata);
 
+/**
+ * @brief Encodes binary data into a NUL terminated base64 string.
+ *
+ * @param bindata The binary data to be encoded.
+ * @param binlength The length of the binary data.
+ * @param base64 The buffer of the string.
+ * @param size The size of base64, at least (binlength + 2) / 3 * 4 + 1.
+ * @return The length of the string, or OPRT_BUFFER_NOT_ENOUGH.
+ */
+int tuya_base64_encode_buf(const unsigned char *bindata, size_t binlength, char *base64, size_t size);
+
+/**
+ * @brief Decodes base64 data, checking every character and the padding.
+ *
+ * @param base64 The base64 data, "\r", "\n" and " " in it are skipped.
+ * @param len The length of base64.
+ * @param bindata The buffer of the decoded data.
+ * @param size The size of bindata, len / 4 * 3 is always enough.
+ * @return The length of the decoded data, OPRT_INVALID_PARM when base64 is not
+ * valid or OPRT_BUFFER_NOT_ENOUGH.
+ */
+int tuya_base64_decode_buf(const char *base64, size_t len, unsigned char *bindata, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
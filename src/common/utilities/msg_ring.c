@@ -0,0 +1,141 @@
+/**
+ * @file msg_ring.c
+ * @brief Bounded lock-free rings of fixed size messages.
+ *
+ * Counters run freely and wrap at 2^32, the index of a counter is
+ * counter & mask. In the MPSC ring, slot i holds sequence i while free for
+ * the producer of round i, i + 1 once that producer has handed it over, and
+ * i + num once the consumer has read it.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#include <string.h>
+
+#include "msg_ring.h"
+
+#define RING_LOAD_ACQ(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RING_LOAD_RLX(p)     __atomic_load_n((p), __ATOMIC_RELAXED)
+#define RING_STORE_REL(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+static bool __is_pow2(uint32_t num)
+{
+    return num && 0 == (num & (num - 1));
+}
+
+int msg_ring_init(MSG_RING_T *ring, void *buf, uint32_t msg_size, uint32_t num)
+{
+    if (NULL == ring || NULL == buf || 0 == msg_size || !__is_pow2(num)) {
+        return -1;
+    }
+
+    ring->buf = buf;
+    ring->msg_size = msg_size;
+    ring->mask = num - 1;
+    ring->head = 0;
+    ring->tail = 0;
+
+    return 0;
+}
+
+bool msg_ring_push(MSG_RING_T *ring, const void *msg)
+{
+    uint32_t head = ring->head;
+
+    if (head - RING_LOAD_ACQ(&ring->tail) > ring->mask) {
+        return false;
+    }
+
+    memcpy(ring->buf + (head & ring->mask) * ring->msg_size, msg, ring->msg_size);
+    RING_STORE_REL(&ring->head, head + 1);
+
+    return true;
+}
+
+bool msg_ring_pop(MSG_RING_T *ring, void *msg)
+{
+    uint32_t tail = ring->tail;
+
+    if (RING_LOAD_ACQ(&ring->head) == tail) {
+        return false;
+    }
+
+    memcpy(msg, ring->buf + (tail & ring->mask) * ring->msg_size, ring->msg_size);
+    RING_STORE_REL(&ring->tail, tail + 1);
+
+    return true;
+}
+
+uint32_t msg_ring_count(MSG_RING_T *ring)
+{
+    return RING_LOAD_ACQ(&ring->head) - RING_LOAD_ACQ(&ring->tail);
+}
+
+static inline uint32_t *__mpsc_seq(MPSC_RING_T *ring, uint32_t pos)
+{
+    return (uint32_t *)(ring->buf + (pos & ring->mask) * ring->slot_size);
+}
+
+int mpsc_ring_init(MPSC_RING_T *ring, void *buf, uint32_t msg_size, uint32_t num)
+{
+    uint32_t i = 0;
+
+    if (NULL == ring || NULL == buf || 0 == msg_size || !__is_pow2(num)) {
+        return -1;
+    }
+
+    ring->buf = buf;
+    ring->slot_size = MPSC_RING_SLOT_SIZE(msg_size);
+    ring->msg_size = msg_size;
+    ring->mask = num - 1;
+    ring->head = 0;
+    ring->tail = 0;
+    for (i = 0; i < num; i++) {
+        *__mpsc_seq(ring, i) = i;
+    }
+
+    return 0;
+}
+
+bool mpsc_ring_push(MPSC_RING_T *ring, const void *msg)
+{
+    uint32_t pos = RING_LOAD_RLX(&ring->head);
+    uint32_t *seq = NULL;
+    int32_t diff = 0;
+
+    for (;;) {
+        seq = __mpsc_seq(ring, pos);
+        diff = (int32_t)(RING_LOAD_ACQ(seq) - pos);
+        if (0 == diff) {
+            // on failure pos is reloaded with the current head
+            if (__atomic_compare_exchange_n(&ring->head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false; // the consumer has not read this slot of the last round
+        } else {
+            pos = RING_LOAD_RLX(&ring->head);
+        }
+    }
+
+    memcpy(seq + 1, msg, ring->msg_size);
+    RING_STORE_REL(seq, pos + 1);
+
+    return true;
+}
+
+bool mpsc_ring_pop(MPSC_RING_T *ring, void *msg)
+{
+    uint32_t pos = ring->tail;
+    uint32_t *seq = __mpsc_seq(ring, pos);
+
+    if ((int32_t)(RING_LOAD_ACQ(seq) - (pos + 1)) < 0) {
+        return false;
+    }
+
+    memcpy(msg, seq + 1, ring->msg_size);
+    RING_STORE_REL(seq, pos + ring->mask + 1);
+    ring->tail = pos + 1;
+
+    return true;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file msg_ring.h
+ * @brief Bounded lock-free rings of fixed size messages.
+ *
+ * Two rings on caller provided storage, both with a power of two number of
+ * elements copied in and out by value:
+ *
+ * MSG_RING_T is single-producer/single-consumer, like spsc_ring but for
+ * whole messages. Each side owns one free running counter and publishes it
+ * with release ordering.
+ *
+ * MPSC_RING_T takes any number of producers (tasks and ISRs) and one
+ * consumer. Every slot carries a sequence number, a producer claims a slot
+ * by advancing the head with a compare-and-swap and hands it over by
+ * bumping the sequence, so a producer never waits on another one. A
+ * producer preempted between claim and hand-over only holds back the
+ * consumer, which sees the ring empty from that slot on until it resumes.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#ifndef __MSG_RING_H__
+#define __MSG_RING_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint8_t *buf;
+    uint32_t msg_size;
+    uint32_t mask; // element count - 1
+    uint32_t head; // messages pushed, producer only
+    uint32_t tail; // messages popped, consumer only
+} MSG_RING_T;
+
+typedef struct {
+    uint8_t *buf;
+    uint32_t slot_size;
+    uint32_t msg_size;
+    uint32_t mask; // element count - 1
+    uint32_t head; // next slot to claim, shared by the producers
+    uint32_t tail; // next slot to read, consumer only
+} MPSC_RING_T;
+
+//! storage for num messages of size bytes in an MPSC_RING_T, sequence number included
+#define MPSC_RING_SLOT_SIZE(size) ((sizeof(uint32_t) + (size) + 7) & ~(size_t)7)
+#define MPSC_RING_BUF_SIZE(size, num) (MPSC_RING_SLOT_SIZE(size) * (num))
+
+/**
+ * @brief Initializes an SPSC ring.
+ *
+ * @param ring The ring.
+ * @param buf Storage for num messages of msg_size bytes.
+ * @param msg_size Message size in bytes.
+ * @param num Number of messages, a power of two.
+ *
+ * @return 0, or -1 when num is not a power of two.
+ */
+int msg_ring_init(MSG_RING_T *ring, void *buf, uint32_t msg_size, uint32_t num);
+
+/**
+ * @brief Producer: copies a message in.
+ *
+ * @return false when the ring is full.
+ */
+bool msg_ring_push(MSG_RING_T *ring, const void *msg);
+
+/**
+ * @brief Consumer: copies the oldest message out.
+ *
+ * @return false when the ring is empty.
+ */
+bool msg_ring_pop(MSG_RING_T *ring, void *msg);
+
+/**
+ * @brief Messages currently buffered, safe to call from any context.
+ */
+uint32_t msg_ring_count(MSG_RING_T *ring);
+
+/**
+ * @brief Initializes an MPSC ring.
+ *
+ * @param ring The ring.
+ * @param buf Storage of MPSC_RING_BUF_SIZE(msg_size, num) bytes, 4 byte aligned.
+ * @param msg_size Message size in bytes.
+ * @param num Number of messages, a power of two.
+ *
+ * @return 0, or -1 when num is not a power of two.
+ */
+int mpsc_ring_init(MPSC_RING_T *ring, void *buf, uint32_t msg_size, uint32_t num);
+
+/**
+ * @brief Any producer: copies a message in, safe from ISRs.
+ *
+ * @return false when the ring is full.
+ */
+bool mpsc_ring_push(MPSC_RING_T *ring, const void *msg);
+
+/**
+ * @brief Consumer: copies the oldest handed over message out.
+ *
+ * @return false when the ring is empty.
+ */
+bool mpsc_ring_pop(MPSC_RING_T *ring, void *msg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MSG_RING_H__ */
@@ -0,0 +1,227 @@
+/**
+ * @file spsc_ring.c
+ * @brief Lock-free single-producer/single-consumer byte ring buffer.
+ *
+ * Head and tail are kept in [0, size), one byte stays unused so that
+ * head == tail always means empty. Only the owner of an index stores it.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#include <string.h>
+
+#include "tuya_iot_config.h"
+#include "spsc_ring.h"
+
+#define SPSC_LOAD_ACQ(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define SPSC_STORE_REL(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+static uint32_t __spsc_dist(const SPSC_RING_T *ring, uint32_t from, uint32_t to)
+{
+    return (to >= from) ? (to - from) : (ring->size - from + to);
+}
+
+static uint32_t __spsc_advance(const SPSC_RING_T *ring, uint32_t pos, uint32_t len)
+{
+    pos += len;
+    return (pos >= ring->size) ? (pos - ring->size) : pos;
+}
+
+static void __spsc_flush_apply(SPSC_RING_T *ring)
+{
+    uint32_t req = SPSC_LOAD_ACQ(&ring->flush_req);
+    if (req == ring->flush_ack) {
+        return;
+    }
+
+    uint32_t pos = SPSC_LOAD_ACQ(&ring->flush_pos);
+    uint32_t head = SPSC_LOAD_ACQ(&ring->head);
+    // the snapshot is only meaningful while it still lies in the unread part
+    if (__spsc_dist(ring, ring->tail, pos) <= __spsc_dist(ring, ring->tail, head)) {
+        SPSC_STORE_REL(&ring->tail, pos);
+    }
+    ring->flush_ack = req;
+}
+
+void spsc_ring_init(SPSC_RING_T *ring, uint8_t *buf, uint32_t size)
+{
+    if (NULL == ring) {
+        return;
+    }
+
+    memset(ring, 0, sizeof(SPSC_RING_T));
+    ring->buf = buf;
+    ring->size = (NULL == buf) ? 0 : size;
+}
+
+uint32_t spsc_ring_used(SPSC_RING_T *ring)
+{
+    if (NULL == ring || 0 == ring->size) {
+        return 0;
+    }
+
+    uint32_t tail = SPSC_LOAD_ACQ(&ring->tail);
+    uint32_t head = SPSC_LOAD_ACQ(&ring->head);
+    return __spsc_dist(ring, tail, head);
+}
+
+uint32_t spsc_ring_free(SPSC_RING_T *ring)
+{
+    if (NULL == ring || 0 == ring->size) {
+        return 0;
+    }
+
+    return ring->size - 1 - spsc_ring_used(ring);
+}
+
+uint32_t spsc_ring_write_peek(SPSC_RING_T *ring, uint8_t **ptr)
+{
+    if (NULL == ring || NULL == ptr || 0 == ring->size) {
+        return 0;
+    }
+
+    uint32_t head = ring->head;
+    uint32_t tail = SPSC_LOAD_ACQ(&ring->tail);
+    uint32_t len = 0;
+
+    if (head >= tail) {
+        // up to the end of storage, keep the last byte free when tail sits at 0
+        len = ring->size - head - ((0 == tail) ? 1 : 0);
+    } else {
+        len = tail - head - 1;
+    }
+
+    *ptr = ring->buf + head;
+    return len;
+}
+
+void spsc_ring_write_commit(SPSC_RING_T *ring, uint32_t len)
+{
+    if (NULL == ring || 0 == len) {
+        return;
+    }
+
+    SPSC_STORE_REL(&ring->head, __spsc_advance(ring, ring->head, len));
+}
+
+TUYA_HOT_AUDIO
+uint32_t spsc_ring_write(SPSC_RING_T *ring, const void *data, uint32_t len)
+{
+    const uint8_t *src = (const uint8_t *)data;
+    uint32_t written = 0;
+
+    if (NULL == data) {
+        return 0;
+    }
+
+    // at most two spans, the second one starts at the beginning of storage
+    while (written < len) {
+        uint8_t *dst = NULL;
+        uint32_t span = spsc_ring_write_peek(ring, &dst);
+        if (0 == span) {
+            break;
+        }
+        if (span > len - written) {
+            span = len - written;
+        }
+        memcpy(dst, src + written, span);
+        spsc_ring_write_commit(ring, span);
+        written += span;
+    }
+
+    return written;
+}
+
+uint32_t spsc_ring_readable(SPSC_RING_T *ring)
+{
+    if (NULL == ring || 0 == ring->size) {
+        return 0;
+    }
+
+    __spsc_flush_apply(ring);
+    return spsc_ring_used(ring);
+}
+
+uint32_t spsc_ring_peek(SPSC_RING_T *ring, uint8_t **ptr)
+{
+    if (NULL == ring || NULL == ptr || 0 == ring->size) {
+        return 0;
+    }
+
+    __spsc_flush_apply(ring);
+
+    uint32_t tail = ring->tail;
+    uint32_t head = SPSC_LOAD_ACQ(&ring->head);
+
+    *ptr = ring->buf + tail;
+    return (head >= tail) ? (head - tail) : (ring->size - tail);
+}
+
+void spsc_ring_commit(SPSC_RING_T *ring, uint32_t len)
+{
+    if (NULL == ring || 0 == len) {
+        return;
+    }
+
+    SPSC_STORE_REL(&ring->tail, __spsc_advance(ring, ring->tail, len));
+}
+
+uint32_t spsc_ring_read(SPSC_RING_T *ring, void *data, uint32_t len)
+{
+    uint8_t *dst = (uint8_t *)data;
+    uint32_t done = 0;
+
+    if (NULL == data) {
+        return 0;
+    }
+
+    while (done < len) {
+        uint8_t *src = NULL;
+        uint32_t span = spsc_ring_peek(ring, &src);
+        if (0 == span) {
+            break;
+        }
+        if (span > len - done) {
+            span = len - done;
+        }
+        memcpy(dst + done, src, span);
+        spsc_ring_commit(ring, span);
+        done += span;
+    }
+
+    return done;
+}
+
+uint32_t spsc_ring_discard(SPSC_RING_T *ring, uint32_t len)
+{
+    uint32_t used = spsc_ring_readable(ring);
+
+    if (len > used) {
+        len = used;
+    }
+    spsc_ring_commit(ring, len);
+
+    return len;
+}
+
+void spsc_ring_flush_request(SPSC_RING_T *ring)
+{
+    spsc_ring_flush_keep_request(ring, 0);
+}
+
+void spsc_ring_flush_keep_request(SPSC_RING_T *ring, uint32_t keep)
+{
+    if (NULL == ring || 0 == ring->size) {
+        return;
+    }
+
+    if (keep >= ring->size) {
+        return;
+    }
+
+    // a snapshot behind the tail is rejected by __spsc_flush_apply, which keeps everything
+    uint32_t head = SPSC_LOAD_ACQ(&ring->head);
+    uint32_t pos = (head >= keep) ? (head - keep) : (ring->size - keep + head);
+    SPSC_STORE_REL(&ring->flush_pos, pos);
+    __atomic_add_fetch(&ring->flush_req, 1, __ATOMIC_RELEASE);
+}
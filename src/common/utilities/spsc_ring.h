@@ -0,0 +1,133 @@
+/**
+ * @file spsc_ring.h
+ * @brief Lock-free single-producer/single-consumer byte ring buffer.
+ *
+ * One context writes (e.g. an audio driver callback) and one context reads,
+ * neither side takes a lock. The producer owns the head index and the
+ * consumer owns the tail index, each side only publishes its own index with
+ * release ordering and reads the other one with acquire ordering. Storage is
+ * provided by the caller so it can live in PSRAM or any other region.
+ *
+ * Besides copy based read/write, peek/commit give direct access to the
+ * contiguous readable (or writable) region so data can be consumed in place.
+ * A third context may ask for the buffered data to be dropped through
+ * spsc_ring_flush_request(), the consumer applies it on its next access.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#ifndef __SPSC_RING_H__
+#define __SPSC_RING_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint8_t *buf;
+    uint32_t size;
+    uint32_t head;      // next write position, producer only
+    uint32_t tail;      // next read position, consumer only
+    uint32_t flush_pos; // head snapshot of the last flush request
+    uint32_t flush_req; // bumped by flush requests
+    uint32_t flush_ack; // consumer copy of flush_req
+} SPSC_RING_T;
+
+/**
+ * @brief Initializes a ring on caller provided storage.
+ *
+ * @param ring The ring to initialize.
+ * @param buf Storage, one byte of it is kept free to tell full from empty.
+ * @param size Size of buf in bytes.
+ */
+void spsc_ring_init(SPSC_RING_T *ring, uint8_t *buf, uint32_t size);
+
+/**
+ * @brief Bytes currently buffered, safe to call from any context.
+ */
+uint32_t spsc_ring_used(SPSC_RING_T *ring);
+
+/**
+ * @brief Bytes that can still be written, safe to call from any context.
+ */
+uint32_t spsc_ring_free(SPSC_RING_T *ring);
+
+/**
+ * @brief Producer: copies data in, stops when the ring is full.
+ *
+ * @return The number of bytes written.
+ */
+uint32_t spsc_ring_write(SPSC_RING_T *ring, const void *data, uint32_t len);
+
+/**
+ * @brief Producer: gets the contiguous writable region.
+ *
+ * @param ring The ring.
+ * @param ptr Set to the start of the region.
+ * @return Length of the region, fill it and call spsc_ring_write_commit().
+ */
+uint32_t spsc_ring_write_peek(SPSC_RING_T *ring, uint8_t **ptr);
+
+/**
+ * @brief Producer: publishes len bytes written through spsc_ring_write_peek().
+ */
+void spsc_ring_write_commit(SPSC_RING_T *ring, uint32_t len);
+
+/**
+ * @brief Consumer: bytes available to read, pending flush requests are applied first.
+ */
+uint32_t spsc_ring_readable(SPSC_RING_T *ring);
+
+/**
+ * @brief Consumer: gets the contiguous readable region without copying.
+ *
+ * @param ring The ring.
+ * @param ptr Set to the start of the region.
+ * @return Length of the region, call spsc_ring_commit() once it is consumed.
+ *         When the data wraps, a second peek after the commit returns the rest.
+ */
+uint32_t spsc_ring_peek(SPSC_RING_T *ring, uint8_t **ptr);
+
+/**
+ * @brief Consumer: releases len bytes obtained through spsc_ring_peek().
+ */
+void spsc_ring_commit(SPSC_RING_T *ring, uint32_t len);
+
+/**
+ * @brief Consumer: copies up to len bytes out.
+ *
+ * @return The number of bytes read.
+ */
+uint32_t spsc_ring_read(SPSC_RING_T *ring, void *data, uint32_t len);
+
+/**
+ * @brief Consumer: drops up to len bytes.
+ *
+ * @return The number of bytes discarded.
+ */
+uint32_t spsc_ring_discard(SPSC_RING_T *ring, uint32_t len);
+
+/**
+ * @brief Any context: asks the consumer to drop everything written so far.
+ *
+ * Data written after the request is kept, the consumer applies the request
+ * on its next spsc_ring_readable/peek/read/discard call.
+ */
+void spsc_ring_flush_request(SPSC_RING_T *ring);
+
+/**
+ * @brief Any context: like spsc_ring_flush_request() but keeps the newest keep bytes.
+ *
+ * When less than keep bytes are buffered by the time the consumer applies the
+ * request, nothing is dropped.
+ */
+void spsc_ring_flush_keep_request(SPSC_RING_T *ring, uint32_t keep);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SPSC_RING_H__ */
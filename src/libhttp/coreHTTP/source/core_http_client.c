@@ -907,6 +907,17 @@ static int httpParserOnBodyCallback( http_parser * pHttpParser,
     assert( pResponse != NULL );
     assert( pResponse->pBuffer != NULL );
 
+    if( pResponse->bodyCallback != NULL )
+    {
+        if( pResponse->bodyCallback( pResponse->pBodyContext, ( const uint8_t * ) pLoc, length ) != 0 )
+        {
+            LogError( ( "Response body callback stopped the response." ) );
+            return HTTP_PARSER_STOP_PARSING;
+        }
+        pResponse->bodyLen += length;
+        return HTTP_PARSER_CONTINUE_PARSING;
+    }
+
     if (pHttpParser->flags & F_CHUNKED) {
         if ((pResponse->bodyLen + length) > HTTP_MAX_RESPONSE_CHUNK_SIZE_BYTES) {
             shouldContinueParse = HTTP_PARSER_STOP_PARSING;
@@ -2687,6 +2698,8 @@ HTTPStatus_t HTTPClient_Request( const TransportInterface_t * pTransport,
     size_t bytesParsed = 0U;
     size_t   chunkLen    = 0;
     uint8_t *chunkBuffer = NULL;
+    HTTPClient_BodyCallback_t bodyCallback = pResponse->bodyCallback;
+    void *pBodyContext = pResponse->pBodyContext;
 
     while (parsingContext.recvState != HTTP_RECV_DONE) {
 
@@ -2694,6 +2707,8 @@ HTTPStatus_t HTTPClient_Request( const TransportInterface_t * pTransport,
 
         case HTTP_RECV_INIT:
             memset(pResponse, 0, sizeof(HTTPResponse_t));
+            pResponse->bodyCallback = bodyCallback;
+            pResponse->pBodyContext = pBodyContext;
             pResponse->pBuffer = HTTP_MALLOC(HTTP_MAX_RESPONSE_HEADERS_SIZE_BYTES + 1);
             if (NULL == pResponse->pBuffer) {
                 return HTTPInsufficientMemory;
@@ -2773,6 +2788,21 @@ HTTPStatus_t HTTPClient_Request( const TransportInterface_t * pTransport,
                 memcpy(pResponse->pBody, pResponse->pBuffer + headerLen, bodyLen);
                 return OPRT_OK;
             }
+            if (pResponse->bodyCallback) {
+                //! chunked or not, the parser hands the body to the callback as it is received
+                chunkBuffer = HTTP_MALLOC(HTTP_MAX_RESPONSE_CHUNK_ONCE_BYTES + 1);
+                if (NULL == chunkBuffer) {
+                    returnStatus = HTTPInsufficientMemory;
+                    goto __exit;
+                }
+                parsingContext.recvState = HTTP_RECV_CHUNK;
+                if (bodyLen) {
+                    memcpy(chunkBuffer, pResponse->pBuffer + headerLen, bodyLen);
+                    chunkLen = bodyLen;
+                    parsingContext.recvState = HTTP_PARSE_CHUNK;
+                }
+                break;
+            }
             if (parsingContext.httpParser.flags & F_CHUNKED) {
                 chunkBuffer = HTTP_MALLOC(HTTP_MAX_RESPONSE_CHUNK_ONCE_BYTES + 1);
                 if (NULL == chunkBuffer) {
@@ -2880,10 +2910,12 @@ __exit:
 
     if (pResponse->pBuffer) {
         HTTP_FREE(pResponse->pBuffer);
+        pResponse->pBuffer = NULL;
     }
 
     if (pResponse->pBody) {
         HTTP_FREE(pResponse->pBody);
+        pResponse->pBody = NULL;
     }
 
     return returnStatus;
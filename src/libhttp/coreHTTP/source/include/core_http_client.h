@@ -414,6 +414,21 @@ typedef struct HTTPClient_ResponseHeaderParsingCallback
     void * pContext;
 } HTTPClient_ResponseHeaderParsingCallback_t;
 
+/**
+ * @ingroup http_callback_types
+ * @brief Callback getting the response body as it is received from the
+ * network, with the chunked transfer encoding removed.
+ *
+ * @param[in] pContext User context.
+ * @param[in] pData The next part of the body.
+ * @param[in] dataLen Length in bytes of pData.
+ *
+ * @return 0 to go on, anything else to stop receiving the response.
+ */
+typedef int ( * HTTPClient_BodyCallback_t )( void * pContext,
+                                              const uint8_t * pData,
+                                              size_t dataLen );
+
 /**
  * @ingroup http_callback_types
  * @brief Application provided function to query the current time in
@@ -528,6 +543,21 @@ typedef struct HTTPResponse
      * for more information.
      */
     uint32_t respFlags;
+
+    /**
+     * @brief Optional callback getting the body in parts of at most
+     * #HTTP_MAX_RESPONSE_CHUNK_ONCE_BYTES instead of collecting it in pBody.
+     * Set to NULL to disable.
+     *
+     * pBody is NULL then and bodyLen counts the bytes given to the callback.
+     * Chunked bodies are not limited by #HTTP_MAX_RESPONSE_CHUNK_SIZE_BYTES.
+     */
+    HTTPClient_BodyCallback_t bodyCallback;
+
+    /**
+     * @brief Private context for bodyCallback.
+     */
+    void * pBodyContext;
 } HTTPResponse_t;
 
 /**
@@ -19,6 +19,17 @@ typedef struct http_client_header {
     const char *value;
 } http_client_header_t;
 
+/**
+ * @brief Gets the response body as it is received, see
+ * http_client_request_t.body_cb.
+ *
+ * @param arg The body_cb_arg of the request.
+ * @param data The next part of the body, chunked transfer encoding removed.
+ * @param len Length of data.
+ * @return 0 to go on, anything else to stop the request.
+ */
+typedef int (*http_client_body_cb_t)(void *arg, const uint8_t *data, size_t len);
+
 typedef struct http_client_request {
     const char *host;
     uint16_t port;
@@ -31,6 +42,14 @@ typedef struct http_client_request {
     const uint8_t *body;
     size_t body_length;
     uint32_t timeout_ms;
+    /**
+     * @brief Optional, gets the body in parts of at most
+     * HTTP_MAX_RESPONSE_CHUNK_ONCE_BYTES while it is received, so it is never
+     * held in memory as a whole. The body of the response is NULL then and
+     * body_length counts the bytes given to it.
+     */
+    http_client_body_cb_t body_cb;
+    void *body_cb_arg;
 } http_client_request_t;
 
 typedef struct http_client_response {
@@ -64,4 +83,13 @@ http_client_status_t http_client_request(const http_client_request_t *request, h
 
 int http_client_free(http_client_response_t *response);
 
+/**
+ * @brief Closes the connections kept open for later requests.
+ *
+ * http_client_request() keeps a connection per host after a response and
+ * reuses it for the next request, an idle one is closed after
+ * HTTP_CLIENT_KEEPALIVE_IDLE_MS.
+ */
+void http_client_pool_flush(void);
+
 #endif /* ifndef HTTP_CLIENT_INTERFACE_H */
@@ -35,6 +35,7 @@ typedef struct {
     uint32_t timeout_ms;
     size_t range_length;
     size_t file_size;
+    size_t offset; // first byte to download, to resume an interrupted download
     void *user_data;
     http_download_event_cb_t event_handler;
 } http_download_config_t;
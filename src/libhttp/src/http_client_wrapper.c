@@ -4,6 +4,7 @@
 #include "core_http_client.h"
 #include "tuya_tls.h"
 #include "tal_log.h"
+#include "tal_api.h"
 
 #define log_debug PR_DEBUG
 #define log_error PR_ERR
@@ -11,6 +12,209 @@
 #define HEADER_BUFFER_LENGTH (255)
 #define DEFAULT_HTTP_PORT    (80)
 #define DEFAULT_HTTPS_PORT   (443)
+
+/* Connections kept open after a response for the next request to the host */
+#ifndef HTTP_CLIENT_POOL_SIZE
+#define HTTP_CLIENT_POOL_SIZE (2)
+#endif
+
+/* An idle kept connection is closed after this, it holds a whole TLS context */
+#ifndef HTTP_CLIENT_KEEPALIVE_IDLE_MS
+#define HTTP_CLIENT_KEEPALIVE_IDLE_MS (15 * 1000)
+#endif
+
+typedef struct {
+    NetworkContext_t network; // NULL for a free slot
+    char *host;
+    uint16_t port;
+    bool tls;
+    SYS_TIME_T idle_since;
+} http_client_conn_t;
+
+static http_client_conn_t s_conn_pool[HTTP_CLIENT_POOL_SIZE];
+static MUTEX_HANDLE s_conn_mutex = NULL;
+static DELAYED_WORK_HANDLE s_conn_idle_work = NULL;
+
+static void http_conn_close(NetworkContext_t network)
+{
+    tuya_transporter_close(network);
+    tuya_transporter_destroy(network);
+}
+
+static void http_conn_slot_clear(http_client_conn_t *conn)
+{
+    http_conn_close(conn->network);
+    tal_free(conn->host);
+    memset(conn, 0, sizeof(http_client_conn_t));
+}
+
+static void http_conn_idle_process(void *data)
+{
+    int i;
+    bool kept = false;
+    SYS_TIME_T now = tal_system_get_millisecond();
+
+    tal_mutex_lock(s_conn_mutex);
+    for (i = 0; i < HTTP_CLIENT_POOL_SIZE; i++) {
+        if (s_conn_pool[i].network == NULL) {
+            continue;
+        }
+        if (now - s_conn_pool[i].idle_since >= HTTP_CLIENT_KEEPALIVE_IDLE_MS) {
+            log_debug("http conn %s idle, close", s_conn_pool[i].host);
+            http_conn_slot_clear(&s_conn_pool[i]);
+        } else {
+            kept = true;
+        }
+    }
+    tal_mutex_unlock(s_conn_mutex);
+
+    if (kept) {
+        tal_workq_start_delayed(s_conn_idle_work, HTTP_CLIENT_KEEPALIVE_IDLE_MS / 2, LOOP_ONCE);
+    }
+}
+
+static int http_conn_pool_init(void)
+{
+    int rt = OPRT_OK;
+
+    if (s_conn_mutex) {
+        return OPRT_OK;
+    }
+    TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&s_conn_mutex));
+    rt = tal_workq_init_delayed(WORKQ_SYSTEM, http_conn_idle_process, NULL, &s_conn_idle_work);
+    if (rt != OPRT_OK) {
+        tal_mutex_release(s_conn_mutex);
+        s_conn_mutex = NULL;
+    }
+
+    return rt;
+}
+
+/* takes a kept connection to host out of the pool, NULL if there is none */
+static NetworkContext_t http_conn_acquire(const char *host, uint16_t port, bool tls)
+{
+    int i;
+    NetworkContext_t network = NULL;
+
+    if (http_conn_pool_init() != OPRT_OK) {
+        return NULL;
+    }
+
+    tal_mutex_lock(s_conn_mutex);
+    for (i = 0; i < HTTP_CLIENT_POOL_SIZE; i++) {
+        http_client_conn_t *conn = &s_conn_pool[i];
+        if (conn->network && conn->port == port && conn->tls == tls && strcmp(conn->host, host) == 0) {
+            network = conn->network;
+            conn->network = NULL;
+            tal_free(conn->host);
+            memset(conn, 0, sizeof(http_client_conn_t));
+            break;
+        }
+    }
+    tal_mutex_unlock(s_conn_mutex);
+
+    return network;
+}
+
+/* keeps a connection for the next request to host, or closes it */
+static void http_conn_release(NetworkContext_t network, const char *host, uint16_t port, bool tls)
+{
+    int i;
+    http_client_conn_t *slot = NULL;
+
+    if (s_conn_mutex == NULL) {
+        http_conn_close(network);
+        return;
+    }
+
+    tal_mutex_lock(s_conn_mutex);
+    for (i = 0; i < HTTP_CLIENT_POOL_SIZE; i++) {
+        // a free slot, otherwise the one idle the longest
+        if (s_conn_pool[i].network == NULL) {
+            slot = &s_conn_pool[i];
+            break;
+        }
+        if (slot == NULL || s_conn_pool[i].idle_since < slot->idle_since) {
+            slot = &s_conn_pool[i];
+        }
+    }
+    if (slot && slot->network) {
+        http_conn_slot_clear(slot);
+    }
+    if (slot) {
+        slot->host = tal_malloc(strlen(host) + 1);
+    }
+    if (slot == NULL || slot->host == NULL) {
+        tal_mutex_unlock(s_conn_mutex);
+        http_conn_close(network);
+        return;
+    }
+    strcpy(slot->host, host);
+    slot->network = network;
+    slot->port = port;
+    slot->tls = tls;
+    slot->idle_since = tal_system_get_millisecond();
+    tal_mutex_unlock(s_conn_mutex);
+
+    tal_workq_start_delayed(s_conn_idle_work, HTTP_CLIENT_KEEPALIVE_IDLE_MS, LOOP_ONCE);
+}
+
+static NetworkContext_t http_conn_open(const http_client_request_t *request, bool tls, uint16_t port)
+{
+    int ret = OPRT_OK;
+
+    NetworkContext_t network = tuya_transporter_create(tls ? TRANSPORT_TYPE_TLS : TRANSPORT_TYPE_TCP, NULL);
+    if (NULL == network) {
+        return NULL;
+    }
+
+    if (tls) {
+        tuya_tls_config_t tls_config = {
+            .ca_cert = (char *)request->cacert,
+            .ca_cert_size = request->cacert_len,
+            .hostname = (char *)request->host,
+            .port = port,
+            .timeout = request->timeout_ms,
+            .mode = TUYA_TLS_SERVER_CERT_MODE,
+            .verify = true,
+        };
+
+        ret = tuya_transporter_ctrl(network, TUYA_TRANSPORTER_SET_TLS_CONFIG, &tls_config);
+        if (OPRT_OK != ret) {
+            log_error("network_tls_init fail:%d", ret);
+            tuya_transporter_destroy(network);
+            return NULL;
+        }
+    }
+
+    ret = tuya_transporter_connect(network, request->host, port, request->timeout_ms);
+    if (OPRT_OK != ret) {
+        http_conn_close(network);
+        return NULL;
+    }
+    log_debug("%s connencted!", tls ? "tls" : "tcp");
+
+    return network;
+}
+
+/**
+ * @brief Closes all kept connections, e.g. to give their memory back.
+ */
+void http_client_pool_flush(void)
+{
+    int i;
+
+    if (s_conn_mutex == NULL) {
+        return;
+    }
+    tal_mutex_lock(s_conn_mutex);
+    for (i = 0; i < HTTP_CLIENT_POOL_SIZE; i++) {
+        if (s_conn_pool[i].network) {
+            http_conn_slot_clear(&s_conn_pool[i]);
+        }
+    }
+    tal_mutex_unlock(s_conn_mutex);
+}
 static http_client_status_t core_http_request_send(const TransportInterface_t *pTransportInterface,
                                                    const HTTPRequestInfo_t *requestInfo, http_client_header_t *headers,
                                                    uint8_t headers_count, const uint8_t *pRequestBodyBuf,
@@ -65,11 +269,12 @@ static http_client_status_t core_http_request_send(const TransportInterface_t *p
         return HTTP_CLIENT_SEND_FAULT;
     }
 
+    /* a body given to the callback is not kept */
     log_debug("Response Headers:\r\n%.*s\r\n"
               "Response Status:\r\n%u\r\n"
               "Response Body:\r\n%.*s\r\n",
-              (int32_t)response->headersLen, response->pHeaders, response->statusCode, (int32_t)response->bodyLen,
-              response->pBody);
+              (int32_t)response->headersLen, response->pHeaders, response->statusCode,
+              (int32_t)(response->pBody ? response->bodyLen : 0), response->pBody ? (const char *)response->pBody : "");
 
     return HTTP_CLIENT_SUCCESS;
 }
@@ -77,54 +282,13 @@ static http_client_status_t core_http_request_send(const TransportInterface_t *p
 http_client_status_t http_client_request(const http_client_request_t *request, http_client_response_t *response)
 {
     http_client_status_t rt = HTTP_CLIENT_SUCCESS;
-    int ret = OPRT_OK;
 
-    /* TLS pre init */
-    NetworkContext_t network;
-    TUYA_TRANSPORT_TYPE_E transport_type = (request->cacert == NULL) ? TRANSPORT_TYPE_TCP : TRANSPORT_TYPE_TLS;
-    network = tuya_transporter_create(transport_type, NULL);
-    if (NULL == network) {
-        return HTTP_CLIENT_MALLOC_FAULT;
-    }
+    bool tls = (request->cacert != NULL);
+    uint16_t port = request->port ? request->port : (tls ? DEFAULT_HTTPS_PORT : DEFAULT_HTTP_PORT);
 
-    if (transport_type == TRANSPORT_TYPE_TLS) {
-        tuya_tls_config_t tls_config = {
-            .ca_cert = (char *)request->cacert,
-            .ca_cert_size = request->cacert_len,
-            .hostname = (char *)request->host,
-            .port = (request->port == 0) ? DEFAULT_HTTPS_PORT : request->port,
-            .timeout = request->timeout_ms,
-            .mode = TUYA_TLS_SERVER_CERT_MODE,
-            .verify = true,
-        };
-
-        ret = tuya_transporter_ctrl(network, TUYA_TRANSPORTER_SET_TLS_CONFIG, &tls_config);
-        if (OPRT_OK != ret) {
-            log_error("network_tls_init fail:%d", ret);
-            return ret;
-        }
-
-        ret = tuya_transporter_connect(network, tls_config.hostname, tls_config.port, tls_config.timeout);
-        if (OPRT_OK != ret) {
-            tuya_transporter_close(network);
-            tuya_transporter_destroy(network);
-            return HTTP_CLIENT_SEND_FAULT;
-        }
-
-        log_debug("tls connencted!");
-    } else {
-        ret = tuya_transporter_connect(network, request->host, (request->port == 0) ? DEFAULT_HTTP_PORT : request->port,
-                                       request->timeout_ms);
-        if (OPRT_OK != ret) {
-            tuya_transporter_close(network);
-            tuya_transporter_destroy(network);
-            return HTTP_CLIENT_SEND_FAULT;
-        }
-    }
-    /* http client TransportInterface */
-    TransportInterface_t pTransportInterface = {.pNetworkContext = (NetworkContext_t *)&network,
-                                                .recv = (TransportRecv_t)NetworkTransportRecv,
-                                                .send = (TransportSend_t)NetworkTransportSend};
+    /* Reuse a kept connection to the host, the server may have closed it meanwhile */
+    NetworkContext_t network = http_conn_acquire(request->host, port, tls);
+    bool reused = (network != NULL);
 
     /* http client request object make */
     HTTPRequestInfo_t requestInfo = {
@@ -134,25 +298,61 @@ http_client_status_t http_client_request(const http_client_request_t *request, h
         .hostLen = strlen(request->host),
         .pPath = request->path,
         .pathLen = strlen(request->path),
+        .reqFlags = HTTP_REQUEST_KEEP_ALIVE_FLAG,
     };
 
     HTTPResponse_t http_response = {0};
+    bool streamed = false;
 
-    /* HTTP request send */
-    log_debug("http request send!");
-    rt = core_http_request_send((const TransportInterface_t *)&pTransportInterface,
-                                (const HTTPRequestInfo_t *)&requestInfo, request->headers, request->headers_count,
-                                (const uint8_t *)request->body, request->body_length, &http_response);
+    do {
+        if (network == NULL) {
+            reused = false;
+            network = http_conn_open(request, tls, port);
+            if (network == NULL) {
+                return HTTP_CLIENT_SEND_FAULT;
+            }
+        }
 
-    /* tls disconnect */
-    tuya_transporter_close(network);
-    tuya_transporter_destroy(network);
+        /* http client TransportInterface */
+        TransportInterface_t pTransportInterface = {.pNetworkContext = (NetworkContext_t *)&network,
+                                                    .recv = (TransportRecv_t)NetworkTransportRecv,
+                                                    .send = (TransportSend_t)NetworkTransportSend};
+
+        http_response.bodyCallback = request->body_cb;
+        http_response.pBodyContext = request->body_cb_arg;
+
+        /* HTTP request send */
+        log_debug("http request send%s!", reused ? " on kept connection" : "");
+        rt = core_http_request_send((const TransportInterface_t *)&pTransportInterface,
+                                    (const HTTPRequestInfo_t *)&requestInfo, request->headers, request->headers_count,
+                                    (const uint8_t *)request->body, request->body_length, &http_response);
+        if (OPRT_OK != rt) {
+            /* the stream state is unknown, never keep it */
+            http_conn_close(network);
+            network = NULL;
+            /* the callback must not get the start of the body twice */
+            streamed = (request->body_cb && http_response.bodyLen);
+            if (http_response.pBuffer) {
+                tal_free(http_response.pBuffer);
+            }
+            if (http_response.pBody) {
+                tal_free((void *)http_response.pBody);
+            }
+            memset(&http_response, 0, sizeof(http_response));
+        }
+    } while (OPRT_OK != rt && reused && rt == HTTP_CLIENT_SEND_FAULT && !streamed);
 
     if (OPRT_OK != rt) {
         log_error("http_request_send error:%d", rt);
         return rt;
     }
 
+    if (http_response.respFlags & HTTP_RESPONSE_CONNECTION_CLOSE_FLAG) {
+        http_conn_close(network);
+    } else {
+        http_conn_release(network, request->host, port, tls);
+    }
+
     /* Response copy out */
     response->status_code = http_response.statusCode;
     response->body = http_response.pBody;
@@ -118,6 +118,10 @@ static int http_download_range_request(http_download_t *ctx, uint32_t range_star
     int rt = OPRT_OK;
 
     PR_DEBUG("Downloading bytes %d-%d, from %s...: ", range_start, range_end, ctx->host);
+    if (ctx->response.pBuffer) {
+        tal_free(ctx->response.pBuffer);
+    }
+    memset(&ctx->response, 0, sizeof(ctx->response));
     TUYA_CALL_ERR_GOTO(HTTPClient_InitializeRequestHeaders(&ctx->requestHeaders, &ctx->requestInfo), __exit);
     TUYA_CALL_ERR_GOTO(HTTPClient_AddRangeHeader(&ctx->requestHeaders, range_start, range_end), __exit);
     PR_TRACE("Request Headers:\n%.*s", (int32_t)ctx->requestHeaders.headersLen, (char *)ctx->requestHeaders.pBuffer);
@@ -141,6 +145,7 @@ static int http_file_download_init(http_download_t *ctx, http_download_config_t
     memset(ctx, 0, sizeof(http_download_t));
     memcpy(&ctx->config, config, sizeof(http_download_config_t));
     ctx->file_size = ctx->config.file_size;
+    ctx->received_size = ctx->config.offset;
     ctx->config.range_length = config->range_length;
     if (config->range_length == 0) {
         ctx->config.range_length = RANGE_REQUEST_LENGTH_DEFAULT;
@@ -331,6 +336,7 @@ int http_file_download(http_download_config_t *config)
     tuya_transporter_destroy(network);
 
     if (!is_completed) {
+        rt = OPRT_TIMEOUT;
         if (ctx->config.event_handler) {
             ctx->config.event_handler(DL_EVENT_FAULT, &ctx->event);
         }
@@ -16,6 +16,8 @@
 #include "tkl_memory.h"
 #include "tal_api.h"
 #include "tdl_display_manage.h"
+#include "tdl_display_draw.h"
+#include "tdl_display_profile.h"
 
 #if defined(ENABLE_LVGL_DMA2D) && (ENABLE_LVGL_DMA2D == 1)
 #include "tkl_dma2d.h"
@@ -24,6 +26,14 @@
 /*********************
  *      DEFINES
  *********************/
+/*Luma threshold and dithering used for monochrome and I2 panels*/
+#ifndef DISP_GRAY_THRESHOLD
+#define DISP_GRAY_THRESHOLD 128
+#endif
+
+#ifndef DISP_GRAY_DITHER
+#define DISP_GRAY_DITHER TDL_DISP_DITHER_NONE
+#endif
 
 
 /**********************
@@ -47,6 +57,10 @@ static uint8_t __disp_get_pixels_size_bytes(TUYA_DISPLAY_PIXEL_FMT_E pixel_fmt);
 static void __disp_dma2d_init(void);
 #endif
 
+#if defined(ENABLE_DISPLAY_PROFILE) && (ENABLE_DISPLAY_PROFILE == 1)
+static void __disp_prof_render_start_cb(lv_disp_drv_t * disp_drv);
+#endif
+
 /**********************
  *  STATIC VARIABLES
  **********************/
@@ -67,6 +81,15 @@ static TDL_DISP_FRAME_BUFF_T *sg_p_display_fb_2 = NULL;
 #endif
 #endif
 
+static TDL_DISP_RECT_LIST_T sg_dirty_rects;
+/*When LVGL (re)started rendering, for the display profile*/
+static SYS_TIME_T sg_prof_render_start = 0;
+
+#if defined(ENABLE_DISPLAY_PROFILE) && (ENABLE_DISPLAY_PROFILE == 1)
+static lv_obj_t *sg_prof_label = NULL;
+static lv_timer_t *sg_prof_timer = NULL;
+#endif
+
 /**********************
  *      MACROS
  **********************/
@@ -145,6 +168,10 @@ void lv_port_disp_init(char *device)
     /*Used to copy the buffer's content to the display*/
     disp_drv.flush_cb = disp_flush;
 
+#if defined(ENABLE_DISPLAY_PROFILE) && (ENABLE_DISPLAY_PROFILE == 1)
+    disp_drv.render_start_cb = __disp_prof_render_start_cb;
+#endif
+
     /*Set a display buffer*/
     disp_drv.draw_buf = &draw_buf_dsc_2;
 
@@ -173,6 +200,55 @@ void lv_port_disp_deinit(void)
     disp_deinit();
 }
 
+#if defined(ENABLE_DISPLAY_PROFILE) && (ENABLE_DISPLAY_PROFILE == 1)
+static void __disp_prof_render_start_cb(lv_disp_drv_t * disp_drv)
+{
+    sg_prof_render_start = tal_system_get_millisecond();
+}
+
+static void __disp_prof_overlay_timer_cb(lv_timer_t *timer)
+{
+    TDL_DISP_PROF_STATS_T stats;
+
+    if (OPRT_OK != tdl_disp_prof_get_stats(&stats)) {
+        return;
+    }
+
+    lv_label_set_text_fmt(sg_prof_label, "%u.%u FPS %uKB/s\nR%u%% C%u%% T%u%%", \
+                          stats.fps_x10 / 10, stats.fps_x10 % 10, (unsigned)(stats.bytes_per_sec / 1024), \
+                          stats.load[TDL_DISP_PROF_RENDER], stats.load[TDL_DISP_PROF_CONVERT], \
+                          stats.load[TDL_DISP_PROF_TRANSFER]);
+}
+
+void lv_port_disp_prof_overlay(bool enable)
+{
+    if (enable) {
+        if (sg_prof_label) {
+            return;
+        }
+
+        sg_prof_label = lv_label_create(lv_layer_sys());
+        lv_obj_set_style_bg_color(sg_prof_label, lv_color_black(), 0);
+        lv_obj_set_style_bg_opa(sg_prof_label, LV_OPA_50, 0);
+        lv_obj_set_style_text_color(sg_prof_label, lv_color_white(), 0);
+        lv_obj_set_style_pad_all(sg_prof_label, 2, 0);
+        lv_obj_align(sg_prof_label, LV_ALIGN_BOTTOM_RIGHT, 0, 0);
+        lv_label_set_text(sg_prof_label, "");
+
+        sg_prof_timer = lv_timer_create(__disp_prof_overlay_timer_cb, TDL_DISP_PROF_WINDOW_MS, NULL);
+    } else {
+        if (NULL == sg_prof_label) {
+            return;
+        }
+
+        lv_timer_del(sg_prof_timer);
+        sg_prof_timer = NULL;
+        lv_obj_del(sg_prof_label);
+        sg_prof_label = NULL;
+    }
+}
+#endif
+
 #if defined(ENABLE_LVGL_DMA2D) && (ENABLE_LVGL_DMA2D == 1)
 static SEM_HANDLE sg_dma2d_finish_sem = NULL;
 static bool sg_is_wait_dma2d = false;
@@ -416,71 +492,24 @@ static uint8_t __disp_get_pixels_size_bytes(TUYA_DISPLAY_PIXEL_FMT_E pixel_fmt)
     }
 }
 
-static void __disp_mono_write_point(uint32_t x, uint32_t y, bool enable, TDL_DISP_FRAME_BUFF_T *fb)
-{
-    if(NULL == fb || x >= fb->width || y >= fb->height) {
-        PR_ERR("Point (%d, %d) out of bounds", x, y);
-        return;
-    }
-
-    uint32_t write_byte_index = y * (fb->width/8) + x/8;
-    uint8_t write_bit = x%8;
-
-    if (enable) {
-        fb->frame[write_byte_index] |= (1 << write_bit);
-    } else {
-        fb->frame[write_byte_index] &= ~(1 << write_bit);
-    }
-}
-
-static void __disp_i2_write_point(uint32_t x, uint32_t y, uint8_t color, TDL_DISP_FRAME_BUFF_T *fb)
-{
-    if(NULL == fb || x >= fb->width || y >= fb->height) {
-        PR_ERR("Point (%d, %d) out of bounds", x, y);
-        return;
-    }
-
-    uint32_t write_byte_index = y * (fb->width/4) + x/4;
-    uint8_t write_bit = (x%4)*2;
-    uint8_t cleared = fb->frame[write_byte_index] & (~(0x03 << write_bit)); // Clear the bits we are going to write
-
-    fb->frame[write_byte_index] = cleared | ((color & 0x03) << write_bit);
-}
-
 static void __disp_fill_display_framebuffer(const lv_area_t * area, uint8_t * px_map,\
                                             TDL_DISP_FRAME_BUFF_T *fb)
 {
-    uint32_t offset = 0, x = 0, y = 0;
+    uint32_t offset = 0, y = 0;
 
     if(NULL == area || NULL == px_map || NULL == fb) {
         PR_ERR("Invalid parameters: area or px_map or fb is NULL");
         return;
     }
     
-    if(fb->fmt == TUYA_PIXEL_FMT_MONOCHROME) {
-        for(y = area->y1 ; y <= area->y2; y++) {
-            for(x = area->x1; x <= area->x2; x++) {
-                uint16_t *px_map_u16 = (uint16_t *)px_map;
-                bool enable = (px_map_u16[offset++]> 0x8FFF) ? false : true;
-                __disp_mono_write_point(x, y, enable, fb);
-            }
-        }
-    }else if(fb->fmt == TUYA_PIXEL_FMT_I2) { 
-        for(y = area->y1 ; y <= area->y2; y++) {
-            for(x = area->x1; x <= area->x2; x++) {
-                lv_color16_t *px_map_color16 = (lv_color16_t *)px_map;
-            #if LV_COLOR_16_SWAP == 0
-                uint8_t grey2 = ~((px_map_color16[offset].ch.red + px_map_color16[offset].ch.green*2 +\
-                                 px_map_color16[offset].ch.blue) >> 2);
-            #else 
-                uint8_t green = (px_map_color16[offset].ch.green_l) + ((px_map_color16[offset].ch.green_h)<<3);
-                uint8_t grey2 = ~((px_map_color16[offset].ch.red + green*2 +\
-                                 px_map_color16[offset].ch.blue) >> 2);
-            #endif
-                offset++;
-                __disp_i2_write_point(x, y, grey2, fb);
-            }
-        }
+    if(fb->fmt == TUYA_PIXEL_FMT_MONOCHROME || fb->fmt == TUYA_PIXEL_FMT_I2) {
+        TDL_DISP_RECT_T rect = {
+            .x0 = area->x1, .y0 = area->y1,
+            .x1 = area->x2, .y1 = area->y2,
+        };
+
+        tdl_disp_convert_rgb565_to_bits((uint16_t *)px_map, (LV_COLOR_16_SWAP == 1), &rect, fb,\
+                                        DISP_GRAY_THRESHOLD, DISP_GRAY_DITHER);
     }else {
         #if LV_COLOR_16_SWAP == 1
             lv_draw_sw_rgb565_swap(px_map, lv_area_get_width(area) * lv_area_get_height(area));
@@ -545,17 +574,33 @@ static void disp_flush(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_colo
 
     if(disp_flush_enabled) {
 
+        SYS_TIME_T prof_start = TDL_DISP_PROF_NOW();
+
+        tdl_disp_prof_record(TDL_DISP_PROF_RENDER, sg_prof_render_start);
+
+        TDL_DISP_RECT_T dirty = {
+            .x0 = (uint16_t)target_area->x1,
+            .y0 = (uint16_t)target_area->y1,
+            .x1 = (uint16_t)target_area->x2,
+            .y1 = (uint16_t)target_area->y2,
+        };
+        tdl_disp_rect_list_add(&sg_dirty_rects, &dirty);
+
 #if 1
         __disp_fill_display_framebuffer(target_area, color_ptr, &sg_display_fb);
+        tdl_disp_prof_record(TDL_DISP_PROF_CONVERT, prof_start);
 
         if (lv_disp_flush_is_last(disp_drv)) {
-            tdl_disp_dev_flush(sg_tdl_disp_hdl, &sg_display_fb);
+            tdl_disp_dev_flush_rects(sg_tdl_disp_hdl, &sg_display_fb, &sg_dirty_rects);
+            tdl_disp_rect_list_clear(&sg_dirty_rects);
 
 #if defined(ENABLE_LVGL_DUAL_DISP_BUFF) && (ENABLE_LVGL_DUAL_DISP_BUFF == 1)
             uint8_t *next_frame = (sg_display_fb.frame == sg_frame_1) ? \
                                     sg_frame_2 : sg_frame_1;
             if(next_frame) {
+                prof_start = TDL_DISP_PROF_NOW();
                 __disp_framebuffer_memcpy(&sg_display_info, next_frame, sg_display_fb.frame, sg_display_fb.len);
+                tdl_disp_prof_record(TDL_DISP_PROF_CONVERT, prof_start);
                 sg_display_fb.frame = next_frame;
             }
 #endif
@@ -575,6 +620,8 @@ static void disp_flush(lv_disp_drv_t * disp_drv, const lv_area_t * area, lv_colo
 #endif
 #endif 
         }
+
+        sg_prof_render_start = TDL_DISP_PROF_NOW();
     }
 
     /*IMPORTANT!!!
@@ -11,10 +11,14 @@
 #ifdef LVGL_ENABLE_TOUCH
 #include "tdl_touch_manage.h"
 #endif
+#if defined(LVGL_ENABLE_TOUCH) || defined(ENABLE_LVGL_ENCODER)
+#include "tdl_input_sched.h"
+#endif
 
 /*********************
  *      DEFINES
  *********************/
+#define TOUCH_SAMPLE_TIME 20 // ms
 
 /**********************
  *      TYPEDEFS
@@ -33,6 +37,10 @@ static void encoder_init(void);
 static void encoder_read(lv_indev_drv_t * indev_drv, lv_indev_data_t * data);
 static void encoder_handler(void);
 #endif
+
+#if defined(LVGL_ENABLE_TOUCH) || defined(ENABLE_LVGL_ENCODER)
+static void input_event_drain(void);
+#endif
 /**********************
  *  STATIC VARIABLES
  **********************/
@@ -41,6 +49,17 @@ lv_indev_t *indev_encoder;
 
 #ifdef LVGL_ENABLE_TOUCH
 static TDL_TOUCH_HANDLE_T sg_touch_hdl = NULL; // Handle for touch device
+static bool sg_touch_sampled = false;          // Touch comes from the input event queue
+static bool sg_touch_pressed = false;
+static bool sg_touch_unseen = false;           // Pressed and released between two reads
+static int32_t sg_touch_x = 0;
+static int32_t sg_touch_y = 0;
+#endif
+
+#ifdef ENABLE_LVGL_ENCODER
+static int32_t sg_enc_steps = 0;
+static bool sg_enc_pressed = false;
+static bool sg_enc_unseen = false;
 #endif
 
 /**********************
@@ -126,6 +145,14 @@ static void touchpad_init(void *device)
         PR_ERR("open touch dev failed, rt: %d", rt);
         return;
     }
+
+    /*Sample on the input scheduler, reads only take the queued events*/
+    if (OPRT_OK == tdl_input_event_subscribe(TDL_INPUT_SRC_BIT(TDL_INPUT_SRC_TOUCH)) &&
+        OPRT_OK == tdl_touch_dev_sample_start(sg_touch_hdl, TOUCH_SAMPLE_TIME)) {
+        sg_touch_sampled = true;
+    } else {
+        PR_WARN("touch sampling not started, reading the device directly");
+    }
 }
 
 /*Will be called by the library to read the touchpad*/
@@ -136,6 +163,15 @@ static void touchpad_read(lv_indev_drv_t * indev_drv, lv_indev_data_t * data)
     uint8_t point_num = 0;
     TDL_TOUCH_POS_T point;
 
+    if (sg_touch_sampled) {
+        input_event_drain();
+        data->state = (sg_touch_pressed || sg_touch_unseen) ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+        sg_touch_unseen = false;
+        data->point.x = sg_touch_x;
+        data->point.y = sg_touch_y;
+        return;
+    }
+
     tdl_touch_dev_read(sg_touch_hdl, 1, &point, &point_num);
     /*Save the pressed coordinates and the state*/
     if (point_num > 0) {
@@ -163,21 +199,25 @@ lv_indev_state_t encoder_state;
 static void encoder_init(void)
 {
     drv_encoder_init();
+
+    if (OPRT_OK != tdl_input_event_subscribe(TDL_INPUT_SRC_BIT(TDL_INPUT_SRC_ENCODER))) {
+        PR_ERR("encoder event subscribe failed");
+    }
 }
 
 /*Will be called by the library to read the encoder*/
 static void encoder_read(lv_indev_t *indev_drv, lv_indev_data_t *data)
 {
-    static int32_t last_diff = 0;
-    int32_t diff;
-    if (encoder_get_pressed()) {
+    input_event_drain();
+
+    /*Steps turned while pressed are reported once it is released*/
+    if (sg_enc_pressed || sg_enc_unseen) {
         encoder_diff = 0;
         encoder_state = LV_INDEV_STATE_PRESSED;
+        sg_enc_unseen = false;
     } else {
-        diff = encoder_get_angle();
-
-        encoder_diff = diff - last_diff;
-        last_diff = diff;
+        encoder_diff = sg_enc_steps;
+        sg_enc_steps = 0;
 
         encoder_state = LV_INDEV_STATE_RELEASED;
     }
@@ -186,3 +226,45 @@ static void encoder_read(lv_indev_t *indev_drv, lv_indev_data_t *data)
     data->state = encoder_state;
 }
 #endif
+
+/*------------------
+ * Input events
+ * -----------------*/
+#if defined(LVGL_ENABLE_TOUCH) || defined(ENABLE_LVGL_ENCODER)
+/*Take everything the input scheduler queued since the last read*/
+static void input_event_drain(void)
+{
+    TDL_INPUT_EVENT_T ev;
+
+    while (OPRT_OK == tdl_input_event_read(&ev, 0)) {
+        switch (ev.src) {
+#ifdef LVGL_ENABLE_TOUCH
+        case TDL_INPUT_SRC_TOUCH:
+            sg_touch_x = ev.x;
+            sg_touch_y = ev.y;
+            if (TDL_INPUT_EV_PRESS == ev.event) {
+                sg_touch_pressed = true;
+                sg_touch_unseen = true;
+            } else if (TDL_INPUT_EV_RELEASE == ev.event) {
+                sg_touch_pressed = false;
+            }
+            break;
+#endif
+#ifdef ENABLE_LVGL_ENCODER
+        case TDL_INPUT_SRC_ENCODER:
+            if (TDL_INPUT_EV_MOVE == ev.event) {
+                sg_enc_steps += ev.x;
+            } else if (TDL_INPUT_EV_PRESS == ev.event) {
+                sg_enc_pressed = true;
+                sg_enc_unseen = true;
+            } else if (TDL_INPUT_EV_RELEASE == ev.event) {
+                sg_enc_pressed = false;
+            }
+            break;
+#endif
+        default:
+            break;
+        }
+    }
+}
+#endif
@@ -0,0 +1,75 @@
+/**
+ * @file lv_port_qrcode.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_port_qrcode.h"
+
+#if defined(ENABLE_QRCODE) && (ENABLE_QRCODE == 1)
+
+#include "qrcode_cache.h"
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+static void fill_px(lv_color_t *dst, uint32_t num, lv_color_t color)
+{
+    while(num--) {
+        *dst++ = color;
+    }
+}
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+lv_res_t lv_port_qrcode_update(lv_obj_t *canvas, const char *payload, lv_color_t dark_color,
+                               lv_color_t light_color)
+{
+    lv_img_dsc_t *img = lv_canvas_get_img(canvas);
+    const uint8_t *qr = NULL, *bits = NULL;
+    lv_color_t *line = NULL;
+    int32_t qr_size, side, scale, margin_x, margin_y;
+    int32_t row, col, end, idx, k;
+    bool dark;
+
+    if(img->header.cf != LV_IMG_CF_TRUE_COLOR) return LV_RES_INV;
+
+    qr = qrcode_cache_get(payload, qrcodegen_Ecc_MEDIUM);
+    if(NULL == qr) return LV_RES_INV;
+
+    qr_size = qrcodegen_getSize(qr);
+    side = LV_MIN(img->header.w, img->header.h);
+    scale = side / (qr_size + 2 * LV_PORT_QRCODE_QUIET_ZONE);
+    if(scale <= 0) return LV_RES_INV;
+    margin_x = (img->header.w - qr_size * scale) / 2;
+    margin_y = (img->header.h - qr_size * scale) / 2;
+
+    lv_canvas_fill_bg(canvas, light_color, LV_OPA_COVER);
+
+    /*The background is light already, only the runs of dark modules are filled
+     *and every module row is drawn once and copied to the other pixel rows*/
+    bits = QRCODE_CACHE_BITS(qr);
+    for(row = 0; row < qr_size; row++) {
+        line = (lv_color_t *)img->data + (margin_y + row * scale) * img->header.w + margin_x;
+        idx = row * qr_size;
+        for(col = 0; col < qr_size; col = end) {
+            dark = (bits[(idx + col) >> 3] >> ((idx + col) & 7)) & 1;
+            for(end = col + 1; end < qr_size; end++) {
+                if((bool)((bits[(idx + end) >> 3] >> ((idx + end) & 7)) & 1) != dark) break;
+            }
+            if(dark) fill_px(line + col * scale, (end - col) * scale, dark_color);
+        }
+        for(k = 1; k < scale; k++) {
+            lv_memcpy(line + k * img->header.w, line, qr_size * scale * sizeof(lv_color_t));
+        }
+    }
+
+    lv_obj_invalidate(canvas);
+
+    return LV_RES_OK;
+}
+
+#endif /*ENABLE_QRCODE*/
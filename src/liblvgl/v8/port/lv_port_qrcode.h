@@ -0,0 +1,52 @@
+/**
+ * @file lv_port_qrcode.h
+ *
+ */
+
+#ifndef LV_PORT_QRCODE_H
+#define LV_PORT_QRCODE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "tuya_cloud_types.h"
+#include "lvgl.h"
+
+#if defined(ENABLE_QRCODE) && (ENABLE_QRCODE == 1)
+
+/*********************
+ *      DEFINES
+ *********************/
+/*Light modules kept around the code, in modules*/
+#ifndef LV_PORT_QRCODE_QUIET_ZONE
+#define LV_PORT_QRCODE_QUIET_ZONE 1
+#endif
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+/**
+ * Draw the QR code of a payload into a LV_IMG_CF_TRUE_COLOR canvas.
+ * The matrix comes from qrcode_cache_get(), so showing the same payload again
+ * does not encode it again. Every module is a square of whole pixels, the
+ * largest that fits, and the code is centered.
+ * @param canvas    pointer to a canvas object
+ * @param payload   text to encode
+ * @param dark_color color of the dark modules
+ * @param light_color color of the light modules and the rest of the canvas
+ * @return LV_RES_OK: if no error; LV_RES_INV: the payload or the canvas do not fit
+ */
+lv_res_t lv_port_qrcode_update(lv_obj_t *canvas, const char *payload, lv_color_t dark_color,
+                               lv_color_t light_color);
+
+#endif /*ENABLE_QRCODE*/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_PORT_QRCODE_H*/
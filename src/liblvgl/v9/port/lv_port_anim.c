@@ -0,0 +1,720 @@
+/**
+ * @file lv_port_anim.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <string.h>
+
+#include "lv_port_anim.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define MY_CLASS          (&lv_port_anim_class)
+#define SPRITE_RUN_MAX    (64 + 0xFFFF)
+#define SPRITE_DELAY_MIN  10 // ms, the timer period
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct _anim_cache {
+    struct _anim_cache *next; // most recently used first
+    const lv_image_dsc_t *src;
+    lv_port_sprite_hdr_t *sprite;
+    size_t size;
+    uint32_t ref; // players showing it
+} anim_cache_t;
+
+typedef struct {
+    lv_image_t img;
+    lv_timer_t *timer;
+    lv_image_dsc_t imgdsc; // points to buf
+    const lv_port_sprite_hdr_t *sprite;
+    anim_cache_t *cache; // NULL for a sprite source
+#if LV_USE_GIF
+    gd_GIF *gif; // a GIF too big for the cache, decoded while playing
+#endif
+    uint8_t *buf;
+    uint32_t last_call;
+    uint16_t frame;
+    uint16_t play_left; // 0 plays forever
+} lv_port_anim_t;
+
+typedef struct {
+    uint8_t *data;
+    size_t len;
+    size_t cap;
+} anim_buf_t;
+
+typedef struct {
+    uint32_t offset; // in the stream
+    uint32_t color_len;
+    uint16_t delay;
+} anim_frame_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void lv_port_anim_constructor(const lv_obj_class_t *class_p, lv_obj_t *obj);
+static void lv_port_anim_destructor(const lv_obj_class_t *class_p, lv_obj_t *obj);
+static void next_frame_task_cb(lv_timer_t *t);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+const lv_obj_class_t lv_port_anim_class = {
+    .constructor_cb = lv_port_anim_constructor,
+    .destructor_cb = lv_port_anim_destructor,
+    .instance_size = sizeof(lv_port_anim_t),
+    .base_class = &lv_image_class,
+    .name = "port_anim",
+};
+
+static anim_cache_t *sg_cache_list = NULL;
+static size_t sg_cache_used = 0;
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static const uint8_t *__sprite_decode(const uint8_t *src, uint8_t *dst, uint32_t cnt, uint32_t unit)
+{
+    uint8_t op = 0;
+    uint32_t n = 0, i = 0;
+    uint16_t color = 0;
+
+    while (cnt) {
+        op = *src++;
+        n = op & 0x3F;
+        if (0x3F == n) {
+            n = 64 + (src[0] | (src[1] << 8));
+            src += 2;
+        } else {
+            n += 1;
+        }
+        if (n > cnt) {
+            return NULL;
+        }
+
+        switch (op & 0xC0) {
+        case LV_PORT_SPRITE_OP_COPY:
+            lv_memcpy(dst, src, n * unit);
+            src += n * unit;
+            break;
+        case LV_PORT_SPRITE_OP_FILL:
+            if (1 == unit) {
+                lv_memset(dst, *src, n);
+            } else {
+                color = src[0] | (src[1] << 8);
+                for (i = 0; i < n; i++) {
+                    ((uint16_t *)dst)[i] = color;
+                }
+            }
+            src += unit;
+            break;
+        case LV_PORT_SPRITE_OP_SKIP:
+            break;
+        default:
+            return NULL;
+        }
+        dst += n * unit;
+        cnt -= n;
+    }
+
+    return src;
+}
+
+static const lv_port_sprite_frame_t *__sprite_frame(const lv_port_sprite_hdr_t *sprite, uint32_t idx)
+{
+    return (const lv_port_sprite_frame_t *)(sprite + 1) + idx;
+}
+
+static void __anim_decode(lv_port_anim_t *anim, uint32_t idx)
+{
+    const lv_port_sprite_hdr_t *sprite = anim->sprite;
+    const uint8_t *p = (const uint8_t *)sprite + __sprite_frame(sprite, idx)->offset;
+    uint32_t cnt = (uint32_t)sprite->w * sprite->h;
+
+    p = __sprite_decode(p, anim->buf, cnt, 2);
+    if (p && LV_COLOR_FORMAT_RGB565A8 == sprite->cf) {
+        p = __sprite_decode(p, anim->buf + cnt * 2, cnt, 1);
+    }
+    if (NULL == p) {
+        LV_LOG_WARN("corrupted sprite frame %d", (int)idx);
+    }
+    anim->frame = idx;
+}
+
+#if LV_USE_GIF
+static bool __buf_put(anim_buf_t *b, const void *src, size_t len)
+{
+    uint8_t *data = NULL;
+    size_t cap = b->cap ? b->cap : 1024;
+
+    if (b->len + len > b->cap) {
+        while (cap < b->len + len) {
+            cap *= 2;
+        }
+        data = lv_realloc(b->data, cap);
+        if (NULL == data) {
+            return false;
+        }
+        b->data = data;
+        b->cap = cap;
+    }
+    lv_memcpy(b->data + b->len, src, len);
+    b->len += len;
+    return true;
+}
+
+static bool __put_op(anim_buf_t *b, uint8_t op, uint32_t n)
+{
+    uint8_t code[3];
+
+    if (n <= 63) {
+        code[0] = op | (n - 1);
+        return __buf_put(b, code, 1);
+    }
+    n -= 64;
+    code[0] = op | 0x3F;
+    code[1] = n & 0xFF;
+    code[2] = n >> 8;
+    return __buf_put(b, code, 3);
+}
+
+static bool __unit_eq(const uint8_t *a, const uint8_t *b, uint32_t unit)
+{
+    return a[0] == b[0] && (1 == unit || a[1] == b[1]);
+}
+
+// a skip of 2 or a fill of 3 units ends a literal run
+static bool __run_starts(const uint8_t *cur, const uint8_t *prev, uint32_t i, uint32_t cnt, uint32_t unit)
+{
+    if (prev && i + 1 < cnt && __unit_eq(cur + i * unit, prev + i * unit, unit) &&
+        __unit_eq(cur + (i + 1) * unit, prev + (i + 1) * unit, unit)) {
+        return true;
+    }
+    return i + 2 < cnt && __unit_eq(cur + i * unit, cur + (i + 1) * unit, unit) &&
+           __unit_eq(cur + i * unit, cur + (i + 2) * unit, unit);
+}
+
+static bool __sprite_encode(anim_buf_t *b, const uint8_t *cur, const uint8_t *prev, uint32_t cnt, uint32_t unit)
+{
+    uint32_t i = 0, n = 0, start = 0;
+
+    while (i < cnt) {
+        n = 0;
+        while (prev && i + n < cnt && n < SPRITE_RUN_MAX && __unit_eq(cur + (i + n) * unit, prev + (i + n) * unit, unit)) {
+            n++;
+        }
+        if (n >= 2) {
+            if (!__put_op(b, LV_PORT_SPRITE_OP_SKIP, n)) {
+                return false;
+            }
+            i += n;
+            continue;
+        }
+
+        n = 1;
+        while (i + n < cnt && n < SPRITE_RUN_MAX && __unit_eq(cur + (i + n) * unit, cur + i * unit, unit)) {
+            n++;
+        }
+        if (n >= 3) {
+            if (!__put_op(b, LV_PORT_SPRITE_OP_FILL, n) || !__buf_put(b, cur + i * unit, unit)) {
+                return false;
+            }
+            i += n;
+            continue;
+        }
+
+        start = i;
+        do {
+            i++;
+        } while (i < cnt && i - start < SPRITE_RUN_MAX && !__run_starts(cur, prev, i, cnt, unit));
+        if (!__put_op(b, LV_PORT_SPRITE_OP_COPY, i - start) || !__buf_put(b, cur + start * unit, (i - start) * unit)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ARGB8888 canvas to the RGB565A8 planes, true if every pixel is opaque
+static bool __argb_to_native(const uint8_t *argb, uint8_t *dst, uint32_t cnt)
+{
+    uint16_t *color = (uint16_t *)dst;
+    uint8_t *alpha = dst + cnt * 2;
+    bool opaque = true;
+    uint32_t i = 0;
+
+    for (i = 0; i < cnt; i++, argb += 4) {
+        color[i] = ((argb[2] & 0xF8) << 8) | ((argb[1] & 0xFC) << 3) | (argb[0] >> 3);
+        alpha[i] = argb[3];
+        opaque = opaque && 0xFF == argb[3];
+    }
+
+    return opaque;
+}
+
+// NULL with *size 0 when the sprite would not fit in the cache budget
+static lv_port_sprite_hdr_t *__gif_to_sprite(const lv_image_dsc_t *src, size_t *size)
+{
+    gd_GIF *gif = NULL;
+    anim_buf_t stream = {0}, frames = {0};
+    anim_frame_t frame;
+    lv_port_sprite_hdr_t *sprite = NULL;
+    lv_port_sprite_frame_t *table = NULL;
+    uint8_t *planes = NULL, *cur = NULL, *prev = NULL, *tmp = NULL;
+    uint32_t cnt = 0, i = 0, n = 0, len = 0, pos = 0;
+    uint16_t play_cnt = 1;
+    bool opaque = true;
+    int ret = 0;
+
+    *size = 1;
+    gif = gd_open_gif_data(src->data);
+    if (NULL == gif) {
+        LV_LOG_WARN("couldn't open the gif");
+        return NULL;
+    }
+
+    cnt = (uint32_t)gif->width * gif->height;
+    // the current and the previous frame
+    planes = lv_malloc(cnt * 3 * 2);
+    if (NULL == planes) {
+        goto exit;
+    }
+    cur = planes;
+    tmp = planes + cnt * 3;
+
+    ret = gd_get_frame(gif);
+    // the loop extension comes before the first image, the trailer ends the pass
+    if (gif->loop_count >= 0) {
+        play_cnt = gif->loop_count > 0xFFFF ? 0xFFFF : gif->loop_count;
+    }
+    gif->loop_count = 1;
+
+    while (1 == ret && n < 0xFFFF) {
+        gd_render_frame(gif, gif->canvas);
+        opaque = __argb_to_native(gif->canvas, cur, cnt) && opaque;
+
+        frame.offset = stream.len;
+        frame.delay = LV_MAX(gif->gce.delay * 10, SPRITE_DELAY_MIN);
+        if (!__sprite_encode(&stream, cur, prev, cnt, 2)) {
+            goto exit;
+        }
+        frame.color_len = stream.len - frame.offset;
+        if (!__sprite_encode(&stream, cur + cnt * 2, prev ? prev + cnt * 2 : NULL, cnt, 1) ||
+            !__buf_put(&frames, &frame, sizeof(frame))) {
+            goto exit;
+        }
+        n++;
+        if (stream.len > LV_PORT_ANIM_CACHE_SIZE) {
+            *size = 0;
+            goto exit;
+        }
+
+        prev = cur;
+        cur = tmp;
+        tmp = prev;
+        ret = gd_get_frame(gif);
+    }
+    if (0 == n) {
+        LV_LOG_WARN("gif has no frame");
+        goto exit;
+    }
+
+    // an opaque GIF drops the alpha planes
+    len = 0;
+    for (i = 0; i < n; i++) {
+        anim_frame_t *f = (anim_frame_t *)frames.data + i;
+        len += opaque ? f->color_len : (i + 1 < n ? f[1].offset : stream.len) - f->offset;
+    }
+    *size = sizeof(lv_port_sprite_hdr_t) + n * sizeof(lv_port_sprite_frame_t) + len;
+    sprite = lv_malloc(*size);
+    if (NULL == sprite) {
+        goto exit;
+    }
+
+    sprite->magic = LV_PORT_SPRITE_MAGIC;
+    sprite->w = gif->width;
+    sprite->h = gif->height;
+    sprite->cf = opaque ? LV_COLOR_FORMAT_RGB565 : LV_COLOR_FORMAT_RGB565A8;
+    sprite->reserved = 0;
+    sprite->frame_cnt = n;
+    sprite->play_cnt = play_cnt;
+    sprite->reserved2 = 0;
+
+    table = (lv_port_sprite_frame_t *)(sprite + 1);
+    pos = sizeof(lv_port_sprite_hdr_t) + n * sizeof(lv_port_sprite_frame_t);
+    for (i = 0; i < n; i++) {
+        anim_frame_t *f = (anim_frame_t *)frames.data + i;
+        len = opaque ? f->color_len : (i + 1 < n ? f[1].offset : stream.len) - f->offset;
+        table[i].offset = pos;
+        table[i].delay = f->delay;
+        table[i].reserved = 0;
+        lv_memcpy((uint8_t *)sprite + pos, stream.data + f->offset, len);
+        pos += len;
+    }
+
+exit:
+    if (NULL == sprite && *size) {
+        LV_LOG_WARN("gif to sprite failed");
+    }
+    lv_free(planes);
+    lv_free(stream.data);
+    lv_free(frames.data);
+    gd_close_gif(gif);
+    return sprite;
+}
+
+// frees unused sprites, the least recently used first, until need fits in the budget
+static void __cache_trim(size_t need)
+{
+    anim_cache_t **link = NULL, **last = NULL, *entry = NULL;
+
+    while (sg_cache_used + need > LV_PORT_ANIM_CACHE_SIZE) {
+        last = NULL;
+        for (link = &sg_cache_list; *link; link = &(*link)->next) {
+            if (0 == (*link)->ref) {
+                last = link;
+            }
+        }
+        if (NULL == last) {
+            break;
+        }
+        entry = *last;
+        *last = entry->next;
+        sg_cache_used -= entry->size;
+        lv_free(entry->sprite);
+        lv_free(entry);
+    }
+}
+
+static anim_cache_t *__cache_get(const lv_image_dsc_t *src)
+{
+    anim_cache_t **link = NULL, *entry = NULL;
+    lv_port_sprite_hdr_t *sprite = NULL;
+    size_t size = 0;
+
+    for (link = &sg_cache_list; *link; link = &(*link)->next) {
+        if ((*link)->src == src) {
+            entry = *link;
+            *link = entry->next;
+            break;
+        }
+    }
+
+    if (NULL == entry) {
+        sprite = __gif_to_sprite(src, &size);
+        if (NULL == sprite && size) {
+            return NULL;
+        }
+        // a GIF too big to cache is remembered by an entry without sprite
+        entry = lv_malloc(sizeof(anim_cache_t));
+        if (NULL == entry) {
+            lv_free(sprite);
+            return NULL;
+        }
+        __cache_trim(size);
+        entry->src = src;
+        entry->sprite = sprite;
+        entry->size = size;
+        entry->ref = 0;
+        sg_cache_used += size;
+    }
+
+    entry->next = sg_cache_list;
+    sg_cache_list = entry;
+    if (NULL == entry->sprite) {
+        return NULL;
+    }
+    entry->ref++;
+    return entry;
+}
+
+static void __cache_put(anim_cache_t *entry)
+{
+    entry->ref--;
+    __cache_trim(0);
+}
+#endif /*LV_USE_GIF*/
+
+static void __anim_close(lv_port_anim_t *anim)
+{
+    lv_timer_pause(anim->timer);
+    if (NULL == anim->buf) {
+        return;
+    }
+
+    lv_image_cache_drop(&anim->imgdsc);
+#if LV_USE_GIF
+    if (anim->cache) {
+        __cache_put(anim->cache);
+        anim->cache = NULL;
+    }
+    if (anim->gif) {
+        gd_close_gif(anim->gif);
+        anim->gif = NULL;
+    }
+#endif
+    lv_free(anim->buf);
+    anim->buf = NULL;
+    anim->imgdsc.data = NULL;
+    anim->sprite = NULL;
+}
+
+// shows the first frame and starts the timer
+static void __anim_start(lv_port_anim_t *anim)
+{
+    anim->play_left = anim->sprite ? anim->sprite->play_cnt : 0;
+#if LV_USE_GIF
+    if (anim->gif) {
+        gd_rewind(anim->gif);
+        gd_get_frame(anim->gif);
+        gd_render_frame(anim->gif, anim->gif->canvas);
+        __argb_to_native(anim->gif->canvas, anim->buf, (uint32_t)anim->gif->width * anim->gif->height);
+    } else
+#endif
+    {
+        __anim_decode(anim, 0);
+    }
+    lv_image_cache_drop(&anim->imgdsc);
+    lv_obj_invalidate((lv_obj_t *)anim);
+
+    anim->last_call = lv_tick_get();
+    if (NULL == anim->sprite || anim->sprite->frame_cnt > 1) {
+        lv_timer_resume(anim->timer);
+        lv_timer_reset(anim->timer);
+    }
+}
+
+static void lv_port_anim_constructor(const lv_obj_class_t *class_p, lv_obj_t *obj)
+{
+    LV_UNUSED(class_p);
+
+    lv_port_anim_t *anim = (lv_port_anim_t *)obj;
+
+    anim->sprite = NULL;
+    anim->cache = NULL;
+#if LV_USE_GIF
+    anim->gif = NULL;
+#endif
+    anim->buf = NULL;
+    anim->timer = lv_timer_create(next_frame_task_cb, SPRITE_DELAY_MIN, obj);
+    lv_timer_pause(anim->timer);
+}
+
+static void lv_port_anim_destructor(const lv_obj_class_t *class_p, lv_obj_t *obj)
+{
+    LV_UNUSED(class_p);
+
+    lv_port_anim_t *anim = (lv_port_anim_t *)obj;
+
+    __anim_close(anim);
+    lv_timer_delete(anim->timer);
+}
+
+#if LV_USE_GIF
+static void __gif_next_frame(lv_port_anim_t *anim)
+{
+    gd_GIF *gif = anim->gif;
+
+    if (lv_tick_elaps(anim->last_call) < gif->gce.delay * 10) {
+        return;
+    }
+    anim->last_call = lv_tick_get();
+
+    if (0 == gd_get_frame(gif)) {
+        /*It was the last repeat*/
+        lv_timer_pause(anim->timer);
+        lv_obj_send_event((lv_obj_t *)anim, LV_EVENT_READY, NULL);
+        return;
+    }
+
+    gd_render_frame(gif, gif->canvas);
+    __argb_to_native(gif->canvas, anim->buf, (uint32_t)gif->width * gif->height);
+    lv_image_cache_drop(&anim->imgdsc);
+    lv_obj_invalidate((lv_obj_t *)anim);
+}
+#endif
+
+static void next_frame_task_cb(lv_timer_t *t)
+{
+    lv_obj_t *obj = t->user_data;
+    lv_port_anim_t *anim = (lv_port_anim_t *)obj;
+    uint32_t next = anim->frame + 1;
+
+#if LV_USE_GIF
+    if (anim->gif) {
+        __gif_next_frame(anim);
+        return;
+    }
+#endif
+
+    if (lv_tick_elaps(anim->last_call) < __sprite_frame(anim->sprite, anim->frame)->delay) {
+        return;
+    }
+    anim->last_call = lv_tick_get();
+
+    if (next >= anim->sprite->frame_cnt) {
+        if (1 == anim->play_left) {
+            /*It was the last repeat*/
+            lv_timer_pause(t);
+            lv_obj_send_event(obj, LV_EVENT_READY, NULL);
+            return;
+        }
+        if (anim->play_left) {
+            anim->play_left--;
+        }
+        next = 0;
+    }
+
+    __anim_decode(anim, next);
+    lv_image_cache_drop(&anim->imgdsc);
+    lv_obj_invalidate(obj);
+}
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+lv_obj_t *lv_port_anim_create(lv_obj_t *parent)
+{
+    LV_LOG_INFO("begin");
+    lv_obj_t *obj = lv_obj_class_create_obj(MY_CLASS, parent);
+    lv_obj_class_init_obj(obj);
+    return obj;
+}
+
+void lv_port_anim_set_src(lv_obj_t *obj, const lv_image_dsc_t *src)
+{
+    lv_port_anim_t *anim = (lv_port_anim_t *)obj;
+    const lv_port_sprite_hdr_t *sprite = NULL;
+    uint32_t w = 0, h = 0, size = 0;
+    uint8_t cf = LV_COLOR_FORMAT_RGB565A8;
+
+    __anim_close(anim);
+    if (NULL == src || NULL == src->data) {
+        return;
+    }
+
+    sprite = (const lv_port_sprite_hdr_t *)src->data;
+    if (LV_PORT_SPRITE_MAGIC != sprite->magic) {
+        sprite = NULL;
+#if LV_USE_GIF
+        if (0 == memcmp(src->data, "GIF", 3)) {
+            anim->cache = __cache_get(src);
+            if (anim->cache) {
+                sprite = anim->cache->sprite;
+            } else {
+                anim->gif = gd_open_gif_data(src->data);
+            }
+        }
+#endif
+    }
+
+    if (sprite && sprite->frame_cnt) {
+        w = sprite->w;
+        h = sprite->h;
+        cf = sprite->cf;
+#if LV_USE_GIF
+    } else if (anim->gif) {
+        w = anim->gif->width;
+        h = anim->gif->height;
+#endif
+    } else {
+        LV_LOG_WARN("Couldn't load the source");
+        return;
+    }
+
+    size = w * h * (LV_COLOR_FORMAT_RGB565A8 == cf ? 3 : 2);
+    anim->buf = lv_malloc(size);
+    if (NULL == anim->buf) {
+        LV_LOG_WARN("no memory for a %dx%d frame", (int)w, (int)h);
+#if LV_USE_GIF
+        if (anim->cache) {
+            __cache_put(anim->cache);
+            anim->cache = NULL;
+        }
+        if (anim->gif) {
+            gd_close_gif(anim->gif);
+            anim->gif = NULL;
+        }
+#endif
+        return;
+    }
+    anim->sprite = sprite;
+
+    lv_memzero(&anim->imgdsc, sizeof(lv_image_dsc_t));
+    anim->imgdsc.header.magic = LV_IMAGE_HEADER_MAGIC;
+    anim->imgdsc.header.cf = cf;
+    anim->imgdsc.header.w = w;
+    anim->imgdsc.header.h = h;
+    anim->imgdsc.header.stride = w * 2;
+    anim->imgdsc.data_size = size;
+    anim->imgdsc.data = anim->buf;
+
+    __anim_start(anim);
+    lv_image_set_src(obj, &anim->imgdsc);
+}
+
+void lv_port_anim_restart(lv_obj_t *obj)
+{
+    lv_port_anim_t *anim = (lv_port_anim_t *)obj;
+
+    if (NULL == anim->buf) {
+        LV_LOG_WARN("Animation not loaded");
+        return;
+    }
+
+    __anim_start(anim);
+}
+
+void lv_port_anim_pause(lv_obj_t *obj)
+{
+    lv_port_anim_t *anim = (lv_port_anim_t *)obj;
+    lv_timer_pause(anim->timer);
+}
+
+void lv_port_anim_resume(lv_obj_t *obj)
+{
+    lv_port_anim_t *anim = (lv_port_anim_t *)obj;
+
+    if (NULL == anim->buf || (anim->sprite && anim->sprite->frame_cnt <= 1)) {
+        return;
+    }
+
+    lv_timer_resume(anim->timer);
+}
+
+lv_result_t lv_port_anim_cache_preload(const lv_image_dsc_t *src)
+{
+#if LV_USE_GIF
+    anim_cache_t *entry = __cache_get(src);
+
+    if (NULL == entry) {
+        return LV_RESULT_INVALID;
+    }
+    entry->ref--;
+    return LV_RESULT_OK;
+#else
+    LV_UNUSED(src);
+    return LV_RESULT_INVALID;
+#endif
+}
+
+void lv_port_anim_cache_clear(void)
+{
+#if LV_USE_GIF
+    // asking for the whole budget frees every unused entry
+    __cache_trim(LV_PORT_ANIM_CACHE_SIZE);
+#endif
+}
+
+size_t lv_port_anim_cache_get_used(void)
+{
+    return sg_cache_used;
+}
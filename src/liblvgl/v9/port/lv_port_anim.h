@@ -0,0 +1,132 @@
+/**
+ * @file lv_port_anim.h
+ *
+ * Animation player that does not decode while it plays.
+ *
+ * A source is an lv_image_dsc_t holding either GIF data or a sprite made by
+ * tools/sprite_converter. A GIF is decoded once into a sprite kept in a cache
+ * with a memory budget, so showing it again or from several objects costs no
+ * decoding. A GIF whose sprite would not fit in the budget is decoded while
+ * it plays, as lv_gif does. A sprite stores each frame as RLE runs over the
+ * native color format, with unchanged pixels skipped against the previous
+ * frame, and is unpacked straight into the frame buffer LVGL draws.
+ *
+ * The player and the cache must be used from the LVGL thread.
+ */
+
+#ifndef LV_PORT_ANIM_H
+#define LV_PORT_ANIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+// bytes of decoded GIFs kept, sprites shown right now are kept beyond it
+#ifndef LV_PORT_ANIM_CACHE_SIZE
+#if defined(ENABLE_EXT_RAM) && (ENABLE_EXT_RAM == 1)
+#define LV_PORT_ANIM_CACHE_SIZE (1024 * 1024)
+#else
+#define LV_PORT_ANIM_CACHE_SIZE (128 * 1024)
+#endif
+#endif
+
+#define LV_PORT_SPRITE_MAGIC 0x5053564C // "LVSP"
+
+// sprite stream ops, the low 6 bits hold count - 1, 63 means a u16 of count - 64 follows
+#define LV_PORT_SPRITE_OP_COPY 0x00 // count units follow
+#define LV_PORT_SPRITE_OP_FILL 0x40 // one unit follows, repeated count times
+#define LV_PORT_SPRITE_OP_SKIP 0x80 // count units are kept from the previous frame
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+/**
+ * Sprite data, little endian, followed by frame_cnt lv_port_sprite_frame_t.
+ * A frame is the color plane encoded in 2 byte units, then for
+ * LV_COLOR_FORMAT_RGB565A8 the alpha plane in 1 byte units. The first frame
+ * has no skip op.
+ */
+typedef struct {
+    uint32_t magic; // LV_PORT_SPRITE_MAGIC
+    uint16_t w;
+    uint16_t h;
+    uint8_t cf; // LV_COLOR_FORMAT_RGB565 or LV_COLOR_FORMAT_RGB565A8
+    uint8_t reserved;
+    uint16_t frame_cnt;
+    uint16_t play_cnt; // 0 plays forever
+    uint16_t reserved2;
+} lv_port_sprite_hdr_t;
+
+typedef struct {
+    uint32_t offset; // from the start of the sprite
+    uint16_t delay;  // ms
+    uint16_t reserved;
+} lv_port_sprite_frame_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Create an animation player
+ * @param parent    pointer to an object, it will be the parent of the new player
+ * @return          pointer to the player
+ */
+lv_obj_t *lv_port_anim_create(lv_obj_t *parent);
+
+/**
+ * Set the animation to play, it starts from its first frame
+ * @param obj       pointer to a player
+ * @param src       descriptor with GIF data or a sprite, must stay valid while used
+ */
+void lv_port_anim_set_src(lv_obj_t *obj, const lv_image_dsc_t *src);
+
+/**
+ * Play the animation again from its first frame
+ * @param obj       pointer to a player
+ */
+void lv_port_anim_restart(lv_obj_t *obj);
+
+/**
+ * Stop on the current frame
+ * @param obj       pointer to a player
+ */
+void lv_port_anim_pause(lv_obj_t *obj);
+
+/**
+ * Continue after lv_port_anim_pause()
+ * @param obj       pointer to a player
+ */
+void lv_port_anim_resume(lv_obj_t *obj);
+
+/**
+ * Decode a GIF into the cache ahead of its first use
+ * @param src       descriptor with GIF data
+ * @return          LV_RESULT_OK if the sprite is in the cache
+ */
+lv_result_t lv_port_anim_cache_preload(const lv_image_dsc_t *src);
+
+/**
+ * Free the cached sprites no player is showing
+ */
+void lv_port_anim_cache_clear(void);
+
+/**
+ * Get the bytes the cache holds
+ * @return          bytes of all cached sprites
+ */
+size_t lv_port_anim_cache_get_used(void);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_PORT_ANIM_H*/
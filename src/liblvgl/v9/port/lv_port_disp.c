@@ -16,6 +16,8 @@
 #include "tkl_memory.h"
 #include "tal_api.h"
 #include "tdl_display_manage.h"
+#include "tdl_display_draw.h"
+#include "tdl_display_profile.h"
 
 #if defined(ENABLE_LVGL_DMA2D) && (ENABLE_LVGL_DMA2D == 1)
 #include "tkl_dma2d.h"
@@ -34,6 +36,23 @@
 #define LV_MEM_CUSTOM_REALLOC tkl_system_realloc
 #endif
 
+/*Number of panel frames LVGL renders into directly (RGB panels only)*/
+#define DISP_DIRECT_FRAME_NUM  3
+
+/*Longest wait for the panel to release a frame, in ms*/
+#ifndef DISP_DIRECT_FREE_TIMEOUT
+#define DISP_DIRECT_FREE_TIMEOUT 100
+#endif
+
+/*Luma threshold and dithering used for monochrome and I2 panels*/
+#ifndef DISP_GRAY_THRESHOLD
+#define DISP_GRAY_THRESHOLD 128
+#endif
+
+#ifndef DISP_GRAY_DITHER
+#define DISP_GRAY_DITHER TDL_DISP_DITHER_NONE
+#endif
+
 
 /**********************
  *      TYPEDEFS
@@ -48,6 +67,10 @@ static void disp_deinit(void);
 
 static void disp_flush(lv_display_t * disp, const lv_area_t * area, uint8_t * px_map);
 
+#if defined(ENABLE_DISPLAY_PROFILE) && (ENABLE_DISPLAY_PROFILE == 1)
+static void __disp_prof_render_start_cb(lv_event_t *e);
+#endif
+
 static uint8_t * __disp_draw_buf_align_alloc(uint32_t size_bytes);
 
 static lv_color_format_t __disp_get_lv_color_format(TUYA_DISPLAY_PIXEL_FMT_E pixel_fmt);
@@ -58,6 +81,10 @@ static uint8_t __disp_get_pixels_size_bytes(TUYA_DISPLAY_PIXEL_FMT_E pixel_fmt);
 static void __disp_dma2d_init(void);
 #endif
 
+#if defined(ENABLE_LVGL_TRIPLE_DISP_BUFF) && (ENABLE_LVGL_TRIPLE_DISP_BUFF == 1)
+static bool __disp_direct_init(uint32_t frame_len);
+#endif
+
 
 /**********************
  *  STATIC VARIABLES
@@ -80,6 +107,26 @@ static TDL_DISP_FRAME_BUFF_T *sg_p_display_fb_2 = NULL;
 #endif
 
 static uint8_t *sg_rotate_buf = NULL;
+static bool sg_rotate_stream = false;
+static TDL_DISP_RECT_LIST_T sg_dirty_rects;
+/*When LVGL (re)started rendering, for the display profile*/
+static SYS_TIME_T sg_prof_render_start = 0;
+
+#if defined(ENABLE_DISPLAY_PROFILE) && (ENABLE_DISPLAY_PROFILE == 1)
+static lv_obj_t *sg_prof_label = NULL;
+static lv_timer_t *sg_prof_timer = NULL;
+#endif
+
+#if defined(ENABLE_LVGL_TRIPLE_DISP_BUFF) && (ENABLE_LVGL_TRIPLE_DISP_BUFF == 1)
+static bool sg_direct_mode = false;
+static TDL_DISP_FRAME_BUFF_T sg_direct_fb[DISP_DIRECT_FRAME_NUM];
+static lv_draw_buf_t sg_direct_draw_buf[DISP_DIRECT_FRAME_NUM];
+static volatile bool sg_direct_busy[DISP_DIRECT_FRAME_NUM];
+static SEM_HANDLE sg_direct_free_sem = NULL;
+static uint8_t sg_direct_idx = 0;
+/*Dirty rects of the frame before the one being rendered*/
+static TDL_DISP_RECT_LIST_T sg_direct_prev_rects;
+#endif
 /**********************
  *      MACROS
  **********************/
@@ -101,11 +148,32 @@ void lv_port_disp_init(char *device)
      * -----------------------------------*/
     lv_display_t * disp = lv_display_create(sg_display_info.width, sg_display_info.height);
     lv_display_set_flush_cb(disp, disp_flush);
+#if defined(ENABLE_DISPLAY_PROFILE) && (ENABLE_DISPLAY_PROFILE == 1)
+    lv_display_add_event_cb(disp, __disp_prof_render_start_cb, LV_EVENT_RENDER_START, NULL);
+#endif
 
     lv_color_format_t color_format = __disp_get_lv_color_format(sg_display_info.fmt);
     PR_NOTICE("lv_color_format:%d", color_format);
     lv_display_set_color_format(disp, color_format);
 
+#if defined(ENABLE_LVGL_TRIPLE_DISP_BUFF) && (ENABLE_LVGL_TRIPLE_DISP_BUFF == 1)
+    /* Example 3
+     * LVGL renders straight into the panel frames. The panel scans out one frame,
+     * the next waits for vsync and LVGL renders into the third.*/
+    if (sg_direct_mode) {
+        uint32_t stride = lv_draw_buf_width_to_stride(sg_display_info.width, color_format);
+
+        for (uint8_t i = 0; i < DISP_DIRECT_FRAME_NUM; i++) {
+            lv_draw_buf_init(&sg_direct_draw_buf[i], sg_display_info.width, sg_display_info.height, \
+                             color_format, stride, sg_direct_fb[i].frame, sg_direct_fb[i].len);
+        }
+
+        lv_display_set_draw_buffers(disp, &sg_direct_draw_buf[0], NULL);
+        lv_display_set_render_mode(disp, LV_DISPLAY_RENDER_MODE_DIRECT);
+        return;
+    }
+#endif
+
     /* Example 2
      * Two buffers for partial rendering
      * In flush_cb DMA or similar hardware should be used to update the display in the background.*/
@@ -140,9 +208,18 @@ void lv_port_disp_init(char *device)
 
         PR_NOTICE("rotation:%d", sg_display_info.rotation);
 
-        sg_rotate_buf = __disp_draw_buf_align_alloc(buf_len);
-        if (sg_rotate_buf == NULL) {
-            PR_ERR("lvgl rotate buffer malloc fail!\n");
+#if !defined(ENABLE_LVGL_DMA2D) || (ENABLE_LVGL_DMA2D == 0)
+        /*RGB areas are rotated straight into the frame buffer*/
+        if (sg_display_info.fmt == TUYA_PIXEL_FMT_RGB565 || sg_display_info.fmt == TUYA_PIXEL_FMT_RGB888) {
+            sg_rotate_stream = true;
+        }
+#endif
+
+        if (false == sg_rotate_stream) {
+            sg_rotate_buf = __disp_draw_buf_align_alloc(buf_len);
+            if (sg_rotate_buf == NULL) {
+                PR_ERR("lvgl rotate buffer malloc fail!\n");
+            }
         }
     }
 }
@@ -153,14 +230,74 @@ void lv_port_disp_deinit(void)
     disp_deinit();
 }
 
+#if defined(ENABLE_DISPLAY_PROFILE) && (ENABLE_DISPLAY_PROFILE == 1)
+static void __disp_prof_overlay_timer_cb(lv_timer_t *timer)
+{
+    TDL_DISP_PROF_STATS_T stats;
+
+    if (OPRT_OK != tdl_disp_prof_get_stats(&stats)) {
+        return;
+    }
+
+    lv_label_set_text_fmt(sg_prof_label, "%u.%u FPS %uKB/s\nR%u%% C%u%% T%u%%", \
+                          stats.fps_x10 / 10, stats.fps_x10 % 10, (unsigned)(stats.bytes_per_sec / 1024), \
+                          stats.load[TDL_DISP_PROF_RENDER], stats.load[TDL_DISP_PROF_CONVERT], \
+                          stats.load[TDL_DISP_PROF_TRANSFER]);
+}
+
+void lv_port_disp_prof_overlay(bool enable)
+{
+    if (enable) {
+        if (sg_prof_label) {
+            return;
+        }
+
+        sg_prof_label = lv_label_create(lv_layer_sys());
+        lv_obj_set_style_bg_color(sg_prof_label, lv_color_black(), 0);
+        lv_obj_set_style_bg_opa(sg_prof_label, LV_OPA_50, 0);
+        lv_obj_set_style_text_color(sg_prof_label, lv_color_white(), 0);
+        lv_obj_set_style_pad_all(sg_prof_label, 2, 0);
+        lv_obj_align(sg_prof_label, LV_ALIGN_BOTTOM_RIGHT, 0, 0);
+        lv_label_set_text(sg_prof_label, "");
+
+        sg_prof_timer = lv_timer_create(__disp_prof_overlay_timer_cb, TDL_DISP_PROF_WINDOW_MS, NULL);
+    } else {
+        if (NULL == sg_prof_label) {
+            return;
+        }
+
+        lv_timer_delete(sg_prof_timer);
+        sg_prof_timer = NULL;
+        lv_obj_delete(sg_prof_label);
+        sg_prof_label = NULL;
+    }
+}
+#endif
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
+#if defined(ENABLE_DISPLAY_PROFILE) && (ENABLE_DISPLAY_PROFILE == 1)
+static void __disp_prof_render_start_cb(lv_event_t *e)
+{
+    sg_prof_render_start = tal_system_get_millisecond();
+}
+#endif
+
 #if defined(ENABLE_LVGL_DMA2D) && (ENABLE_LVGL_DMA2D == 1)
 static SEM_HANDLE sg_dma2d_finish_sem = NULL;
 static bool sg_is_wait_dma2d = false;
+/*Display whose draw buffer is released when the running copy completes*/
+static lv_display_t * volatile sg_dma2d_ready_disp = NULL;
 static void __disp_dma2d_event_cb(TUYA_DMA2D_IRQ_E type, VOID_T *args)
 {
+    lv_display_t *disp = sg_dma2d_ready_disp;
+
+    if(disp) {
+        sg_dma2d_ready_disp = NULL;
+        lv_display_flush_ready(disp);
+    }
+
     tal_semaphore_post(sg_dma2d_finish_sem);
 }
 
@@ -188,15 +325,19 @@ static void __wait_dma2d_trans_finish(void)
     }
 }
 
-static void __dma2d_drawbuffer_memcpy_syn(const lv_area_t * area, uint8_t * px_map, \
-                                          lv_color_format_t cf, TDL_DISP_FRAME_BUFF_T *fb)
+/*Start copying the area into the frame buffer and return without waiting.
+ *If ready_disp is set the completion irq also releases its draw buffer.
+ *Returns false if nothing was started.*/
+static bool __dma2d_drawbuffer_memcpy_async(const lv_area_t * area, uint8_t * px_map, \
+                                            lv_color_format_t cf, TDL_DISP_FRAME_BUFF_T *fb, \
+                                            lv_display_t *ready_disp)
 {
     TKL_DMA2D_FRAME_INFO_T in_frame = {0};
     TKL_DMA2D_FRAME_INFO_T out_frame = {0};
 
     if (area == NULL || px_map == NULL || fb == NULL) {
         PR_ERR("Invalid parameter");
-        return;
+        return false;
     }
 
     // Perform memory copy based on color format
@@ -211,7 +352,7 @@ static void __dma2d_drawbuffer_memcpy_syn(const lv_area_t * area, uint8_t * px_m
             break;
         default:
             PR_ERR("Unsupported color format");
-            return;
+            return false;
     }
 
     in_frame.width  = area->x2 - area->x1 + 1;
@@ -228,11 +369,16 @@ static void __dma2d_drawbuffer_memcpy_syn(const lv_area_t * area, uint8_t * px_m
     out_frame.axis.x_axis   = area->x1;
     out_frame.axis.y_axis   = area->y1;
 
-    tkl_dma2d_memcpy(&in_frame, &out_frame);
+    sg_dma2d_ready_disp = ready_disp;
+
+    if (OPRT_OK != tkl_dma2d_memcpy(&in_frame, &out_frame)) {
+        sg_dma2d_ready_disp = NULL;
+        return false;
+    }
 
     sg_is_wait_dma2d = true;
 
-    __wait_dma2d_trans_finish();
+    return true;
 }
 
 #if defined(ENABLE_LVGL_DUAL_DISP_BUFF) && (ENABLE_LVGL_DUAL_DISP_BUFF == 1)
@@ -283,6 +429,119 @@ static void __dma2d_framebuffer_memcpy_async(TDL_DISP_DEV_INFO_T *dev_info,\
 #endif
 #endif
 
+#if defined(ENABLE_LVGL_TRIPLE_DISP_BUFF) && (ENABLE_LVGL_TRIPLE_DISP_BUFF == 1)
+/*Called by the rgb driver (in its isr) once the panel scans out a newer frame*/
+static void __disp_direct_fb_free_cb(TDL_DISP_FRAME_BUFF_T *frame_buff)
+{
+    uint8_t i = 0;
+
+    for (i = 0; i < DISP_DIRECT_FRAME_NUM; i++) {
+        if (frame_buff == &sg_direct_fb[i]) {
+            sg_direct_busy[i] = false;
+            tal_semaphore_post(sg_direct_free_sem);
+            break;
+        }
+    }
+}
+
+/*Direct mode needs a panel that scans out a whole frame buffer and pixels
+ *LVGL can render as they are*/
+static bool __disp_direct_init(uint32_t frame_len)
+{
+    uint8_t i = 0;
+
+    if (sg_display_info.type != TUYA_DISPLAY_RGB || \
+        sg_display_info.rotation != TUYA_DISPLAY_ROTATION_0 || \
+        sg_display_info.is_swap || \
+        0 == __disp_get_pixels_size_bytes(sg_display_info.fmt)) {
+        return false;
+    }
+
+    if (OPRT_OK != tal_semaphore_create_init(&sg_direct_free_sem, 0, DISP_DIRECT_FRAME_NUM)) {
+        return false;
+    }
+
+    for (i = 0; i < DISP_DIRECT_FRAME_NUM; i++) {
+        sg_direct_fb[i].type    = DISP_FB_TP_PSRAM;
+        sg_direct_fb[i].fmt     = sg_display_info.fmt;
+        sg_direct_fb[i].width   = sg_display_info.width;
+        sg_direct_fb[i].height  = sg_display_info.height;
+        sg_direct_fb[i].len     = frame_len;
+        sg_direct_fb[i].free_cb = __disp_direct_fb_free_cb;
+        sg_direct_fb[i].frame   = (uint8_t *)LV_MEM_CUSTOM_ALLOC(frame_len);
+        if (NULL == sg_direct_fb[i].frame) {
+            PR_ERR("create direct frame buff %d failed, use partial mode", i);
+            goto __ERR;
+        }
+        sg_direct_busy[i] = false;
+    }
+
+    sg_direct_idx = 0;
+    tdl_disp_rect_list_clear(&sg_direct_prev_rects);
+    sg_direct_mode = true;
+
+    PR_NOTICE("lvgl direct mode, %d frames", DISP_DIRECT_FRAME_NUM);
+
+    return true;
+
+__ERR:
+    for (i = 0; i < DISP_DIRECT_FRAME_NUM; i++) {
+        if (sg_direct_fb[i].frame) {
+            LV_MEM_CUSTOM_FREE(sg_direct_fb[i].frame);
+            sg_direct_fb[i].frame = NULL;
+        }
+    }
+    tal_semaphore_release(sg_direct_free_sem);
+    sg_direct_free_sem = NULL;
+
+    return false;
+}
+
+/*Hand the rendered frame to the panel and move LVGL to the next one*/
+static void __disp_direct_flush_last(lv_display_t *disp)
+{
+    OPERATE_RET rt = OPRT_OK;
+    TDL_DISP_FRAME_BUFF_T *cur_fb  = &sg_direct_fb[sg_direct_idx];
+    uint8_t next_idx = (sg_direct_idx + 1) % DISP_DIRECT_FRAME_NUM;
+    TDL_DISP_FRAME_BUFF_T *next_fb = &sg_direct_fb[next_idx];
+    SYS_TIME_T prof_start = 0;
+    uint8_t i = 0;
+
+    sg_direct_busy[sg_direct_idx] = true;
+    rt = tdl_disp_dev_flush(sg_tdl_disp_hdl, cur_fb);
+    if (rt != OPRT_OK) {
+        PR_ERR("flush direct frame failed, rt: %d", rt);
+        sg_direct_busy[sg_direct_idx] = false;
+    }
+
+    /*Only blocks when LVGL runs two frames ahead of the panel*/
+    while (sg_direct_busy[next_idx]) {
+        if (OPRT_OK != tal_semaphore_wait(sg_direct_free_sem, DISP_DIRECT_FREE_TIMEOUT)) {
+            PR_ERR("wait direct frame %d free timeout", next_idx);
+            sg_direct_busy[next_idx] = false;
+        }
+    }
+
+    /*The next frame is two frames old, bring over what changed since*/
+    prof_start = TDL_DISP_PROF_NOW();
+    for (i = 0; i < sg_direct_prev_rects.num; i++) {
+        tdl_disp_draw_blit(next_fb, sg_direct_prev_rects.rect[i].x0, sg_direct_prev_rects.rect[i].y0, \
+                           cur_fb, &sg_direct_prev_rects.rect[i]);
+    }
+    for (i = 0; i < sg_dirty_rects.num; i++) {
+        tdl_disp_draw_blit(next_fb, sg_dirty_rects.rect[i].x0, sg_dirty_rects.rect[i].y0, \
+                           cur_fb, &sg_dirty_rects.rect[i]);
+    }
+    tdl_disp_prof_record(TDL_DISP_PROF_CONVERT, prof_start);
+
+    sg_direct_prev_rects = sg_dirty_rects;
+    tdl_disp_rect_list_clear(&sg_dirty_rects);
+
+    sg_direct_idx = next_idx;
+    lv_display_set_draw_buffers(disp, &sg_direct_draw_buf[next_idx], NULL);
+}
+#endif
+
 
 /*Initialize your display and the required peripherals.*/
 static void disp_init(char *device)
@@ -313,6 +572,10 @@ static void disp_init(char *device)
 
     tdl_disp_set_brightness(sg_tdl_disp_hdl, 100); // Set brightness to 100%
 
+#if defined(ENABLE_LVGL_DMA2D) && (ENABLE_LVGL_DMA2D == 1)
+    __disp_dma2d_init();
+#endif
+
     if(sg_display_info.fmt == TUYA_PIXEL_FMT_MONOCHROME) {
         frame_len = (sg_display_info.width + 7) / 8 * sg_display_info.height;
     } else if(sg_display_info.fmt == TUYA_PIXEL_FMT_I2){
@@ -321,6 +584,13 @@ static void disp_init(char *device)
         per_pixel_byte = __disp_get_pixels_size_bytes(sg_display_info.fmt);
         frame_len = sg_display_info.width * sg_display_info.height * per_pixel_byte;
     }
+
+#if defined(ENABLE_LVGL_TRIPLE_DISP_BUFF) && (ENABLE_LVGL_TRIPLE_DISP_BUFF == 1)
+    if (__disp_direct_init(frame_len)) {
+        return;
+    }
+#endif
+
 #if 1
     sg_display_fb.fmt    = sg_display_info.fmt;
     sg_display_fb.width  = sg_display_info.width;
@@ -366,11 +636,6 @@ static void disp_init(char *device)
     sg_p_display_fb = sg_p_display_fb_1;
 
 #endif
-
-#if defined(ENABLE_LVGL_DMA2D) && (ENABLE_LVGL_DMA2D == 1)
-    __disp_dma2d_init();
-#endif
-
 }
 
 #define DISP_DRAW_BUF_ALIGN    4
@@ -422,66 +687,32 @@ static uint8_t __disp_get_pixels_size_bytes(TUYA_DISPLAY_PIXEL_FMT_E pixel_fmt)
     }
 }
 
-static void __disp_mono_write_point(uint32_t x, uint32_t y, bool enable, TDL_DISP_FRAME_BUFF_T *fb)
-{
-    if(NULL == fb || x >= fb->width || y >= fb->height) {
-        PR_ERR("Point (%d, %d) out of bounds", x, y);
-        return;
-    }
-
-    uint32_t write_byte_index = y * (fb->width/8) + x/8;
-    uint8_t write_bit = x%8;
-
-    if (enable) {
-        fb->frame[write_byte_index] |= (1 << write_bit);
-    } else {
-        fb->frame[write_byte_index] &= ~(1 << write_bit);
-    }
-}
-
-static void __disp_i2_write_point(uint32_t x, uint32_t y, uint8_t color, TDL_DISP_FRAME_BUFF_T *fb)
+/*Copy the rendered area into the frame buffer. Returns true if the copy still runs
+ *in the background, ready_disp is then released by the copy itself.*/
+static bool __disp_fill_display_framebuffer(const lv_area_t * area, uint8_t * px_map, \
+                                            lv_color_format_t cf, TDL_DISP_FRAME_BUFF_T *fb, \
+                                            lv_display_t *ready_disp)
 {
-    if(NULL == fb || x >= fb->width || y >= fb->height) {
-        PR_ERR("Point (%d, %d) out of bounds", x, y);
-        return;
-    }
-
-    uint32_t write_byte_index = y * (fb->width/4) + x/4;
-    uint8_t write_bit = (x%4)*2;
-    uint8_t cleared = fb->frame[write_byte_index] & (~(0x03 << write_bit)); // Clear the bits we are going to write
-
-    fb->frame[write_byte_index] = cleared | ((color & 0x03) << write_bit);
-}
-
-static void __disp_fill_display_framebuffer(const lv_area_t * area, uint8_t * px_map, \
-                                            lv_color_format_t cf, TDL_DISP_FRAME_BUFF_T *fb)
-{
-    uint32_t offset = 0, x = 0, y = 0;
+    uint32_t offset = 0, y = 0;
 
     if(NULL == area || NULL == px_map || NULL == fb) {
         PR_ERR("Invalid parameters: area or px_map or fb is NULL");
-        return;
+        return false;
     }
     
-    if(fb->fmt == TUYA_PIXEL_FMT_MONOCHROME) {
-        for(y = area->y1 ; y <= area->y2; y++) {
-            for(x = area->x1; x <= area->x2; x++) {
-                uint16_t *px_map_u16 = (uint16_t *)px_map;
-                bool enable = (px_map_u16[offset++]> 0x8FFF) ? false : true;
-                __disp_mono_write_point(x, y, enable, fb);
-            }
-        }
-    }else if(fb->fmt == TUYA_PIXEL_FMT_I2) { 
-        for(y = area->y1 ; y <= area->y2; y++) {
-            for(x = area->x1; x <= area->x2; x++) {
-                lv_color16_t *px_map_color16 = (lv_color16_t *)px_map;
-                uint8_t grey2 = ~((px_map_color16[offset].red + px_map_color16[offset].green*2 +\
-                                 px_map_color16[offset].blue) >> 2);
-                offset++;
-                __disp_i2_write_point(x, y, grey2, fb);
-            }
-        }
+    if(fb->fmt == TUYA_PIXEL_FMT_MONOCHROME || fb->fmt == TUYA_PIXEL_FMT_I2) {
+        TDL_DISP_RECT_T rect = {
+            .x0 = area->x1, .y0 = area->y1,
+            .x1 = area->x2, .y1 = area->y2,
+        };
+
+        tdl_disp_convert_rgb565_to_bits((uint16_t *)px_map, false, &rect, fb,\
+                                        DISP_GRAY_THRESHOLD, DISP_GRAY_DITHER);
     }else {
+        uint8_t *color_ptr = px_map;
+        uint8_t per_pixel_byte = __disp_get_pixels_size_bytes(fb->fmt);
+        int32_t width = lv_area_get_width(area);
+
         if(LV_COLOR_FORMAT_RGB565 == cf) {
             if(sg_display_info.is_swap) {
                 lv_draw_sw_rgb565_swap(px_map, lv_area_get_width(area) * lv_area_get_height(area));
@@ -491,11 +722,10 @@ static void __disp_fill_display_framebuffer(const lv_area_t * area, uint8_t * px
 #if defined(ENABLE_LVGL_DMA2D) && (ENABLE_LVGL_DMA2D == 1)
         __wait_dma2d_trans_finish();
 
-        __dma2d_drawbuffer_memcpy_syn(area, px_map, cf, fb);
-#else
-        uint8_t *color_ptr = px_map;
-        uint8_t per_pixel_byte = __disp_get_pixels_size_bytes(fb->fmt);
-        int32_t width = lv_area_get_width(area);
+        if(__dma2d_drawbuffer_memcpy_async(area, px_map, cf, fb, ready_disp)) {
+            return (NULL != ready_disp);
+        }
+#endif
 
         offset = (area->y1 * fb->width + area->x1) * per_pixel_byte;
         for (y = area->y1; y <= area->y2 && y < fb->height; y++) {
@@ -503,8 +733,9 @@ static void __disp_fill_display_framebuffer(const lv_area_t * area, uint8_t * px
             offset += fb->width * per_pixel_byte; // Move to the next line in the display buffer
             color_ptr += width * per_pixel_byte;
         }
-#endif
     }
+
+    return false;
 }
 
 #if defined(ENABLE_LVGL_DUAL_DISP_BUFF) && (ENABLE_LVGL_DUAL_DISP_BUFF == 1)
@@ -545,6 +776,11 @@ void disp_disable_update(void)
  *`px_map` contains the rendered image as raw pixel map and it should be copied to `area` on the display.
  *You can use DMA or any hardware acceleration to do this operation in the background but
  *'lv_display_flush_ready()' has to be called when it's finished.*/
+static void __disp_flush_done_cb(void *arg)
+{
+    lv_display_flush_ready((lv_display_t *)arg);
+}
+
 static void disp_flush(lv_display_t * disp, const lv_area_t * area, uint8_t * px_map)
 {
     uint8_t *color_ptr = px_map;
@@ -553,54 +789,135 @@ static void disp_flush(lv_display_t * disp, const lv_area_t * area, uint8_t * px
     if (disp_flush_enabled) {
 
         lv_color_format_t cf = lv_display_get_color_format(disp);
+        TDL_DISP_RECT_T dirty;
+        bool is_last = lv_display_flush_is_last(disp);
+        bool is_async = false;
+        SYS_TIME_T prof_start = TDL_DISP_PROF_NOW();
+
+        tdl_disp_prof_record(TDL_DISP_PROF_RENDER, sg_prof_render_start);
+
+#if defined(ENABLE_LVGL_TRIPLE_DISP_BUFF) && (ENABLE_LVGL_TRIPLE_DISP_BUFF == 1)
+        if(sg_direct_mode) {
+            /*Already rendered in place, only track what changed*/
+            dirty.x0 = (uint16_t)area->x1;
+            dirty.y0 = (uint16_t)area->y1;
+            dirty.x1 = (uint16_t)area->x2;
+            dirty.y1 = (uint16_t)area->y2;
+            tdl_disp_rect_list_add(&sg_dirty_rects, &dirty);
+
+            if(is_last) {
+                __disp_direct_flush_last(disp);
+            }
 
-        if(sg_rotate_buf) {
-            lv_display_rotation_t rotation = lv_display_get_rotation(disp);
+            sg_prof_render_start = TDL_DISP_PROF_NOW();
+            lv_display_flush_ready(disp);
+            return;
+        }
+#endif
+
+#if 1
+        if(sg_rotate_stream) {
+            TDL_DISP_FRAME_BUFF_T area_fb = {
+                .fmt     = sg_display_fb.fmt,
+                .x_start = area->x1,
+                .y_start = area->y1,
+                .width   = lv_area_get_width(area),
+                .height  = lv_area_get_height(area),
+                .frame   = px_map,
+            };
+
+            /*Rotate only the rendered area, straight into the frame buffer*/
+            tdl_disp_draw_rotate_area(sg_display_info.rotation, &area_fb, &sg_display_fb, \
+                                      sg_display_info.is_swap, &dirty);
+        }else
+#endif
+        {
             lv_area_t rotated_area;
 
-            rotated_area.x1 = area->x1;
-            rotated_area.x2 = area->x2;
-            rotated_area.y1 = area->y1;
-            rotated_area.y2 = area->y2;
+            if(sg_rotate_buf) {
+                lv_display_rotation_t rotation = lv_display_get_rotation(disp);
 
-            /*Calculate the position of the rotated area*/
-            lv_display_rotate_area(disp, &rotated_area);
+                rotated_area.x1 = area->x1;
+                rotated_area.x2 = area->x2;
+                rotated_area.y1 = area->y1;
+                rotated_area.y2 = area->y2;
 
-            /*Calculate the source stride (bytes in a line) from the width of the area*/
-            uint32_t src_stride = lv_draw_buf_width_to_stride(lv_area_get_width(area), cf);
-            /*Calculate the stride of the destination (rotated) area too*/
-            uint32_t dest_stride = lv_draw_buf_width_to_stride(lv_area_get_width(&rotated_area), cf);
-            /*Have a buffer to store the rotated area and perform the rotation*/
-            
-            int32_t src_w = lv_area_get_width(area);
-            int32_t src_h = lv_area_get_height(area);
+                /*Calculate the position of the rotated area*/
+                lv_display_rotate_area(disp, &rotated_area);
 
-            lv_draw_sw_rotate(px_map, sg_rotate_buf, src_w, src_h, src_stride, dest_stride, rotation, cf);
-            /*Use the rotated area and rotated buffer from now on*/
+                /*Calculate the source stride (bytes in a line) from the width of the area*/
+                uint32_t src_stride = lv_draw_buf_width_to_stride(lv_area_get_width(area), cf);
+                /*Calculate the stride of the destination (rotated) area too*/
+                uint32_t dest_stride = lv_draw_buf_width_to_stride(lv_area_get_width(&rotated_area), cf);
+                /*Have a buffer to store the rotated area and perform the rotation*/
 
-            color_ptr = sg_rotate_buf;
-            target_area = &rotated_area;
-        }
+                int32_t src_w = lv_area_get_width(area);
+                int32_t src_h = lv_area_get_height(area);
+
+#if defined(ENABLE_LVGL_DMA2D) && (ENABLE_LVGL_DMA2D == 1)
+                /*The previous area may still be copied out of the rotate buffer*/
+                __wait_dma2d_trans_finish();
+#endif
+                lv_draw_sw_rotate(px_map, sg_rotate_buf, src_w, src_h, src_stride, dest_stride, rotation, cf);
+                /*Use the rotated area and rotated buffer from now on*/
 
+                color_ptr = sg_rotate_buf;
+                target_area = &rotated_area;
+            }
+
+            dirty.x0 = (uint16_t)target_area->x1;
+            dirty.y0 = (uint16_t)target_area->y1;
+            dirty.x1 = (uint16_t)target_area->x2;
+            dirty.y1 = (uint16_t)target_area->y2;
+
+            /*Except for the last area the copy releases the draw buffer itself,
+             *LVGL renders the next area into its other draw buffer meanwhile*/
 #if 1
-        __disp_fill_display_framebuffer(target_area, color_ptr, cf, &sg_display_fb);
+            is_async = __disp_fill_display_framebuffer(target_area, color_ptr, cf, &sg_display_fb, \
+                                                       is_last ? NULL : disp);
+#else
+            is_async = __disp_fill_display_framebuffer(target_area, color_ptr, cf, sg_p_display_fb, \
+                                                       is_last ? NULL : disp);
+#endif
+        }
 
-        if (lv_display_flush_is_last(disp)) {
-            tdl_disp_dev_flush(sg_tdl_disp_hdl, &sg_display_fb);
+        tdl_disp_rect_list_add(&sg_dirty_rects, &dirty);
+
+        tdl_disp_prof_record(TDL_DISP_PROF_CONVERT, prof_start);
+        sg_prof_render_start = TDL_DISP_PROF_NOW();
+
+        if(is_async) {
+            return;
+        }
+
+#if 1
+        if (is_last) {
+#if defined(ENABLE_LVGL_DMA2D) && (ENABLE_LVGL_DMA2D == 1)
+            /*The panel reads the frame, the last copy must have landed*/
+            __wait_dma2d_trans_finish();
+#endif
+            /*The transfer runs in the background, LVGL renders the next area into
+             *its other draw buffer until __disp_flush_done_cb reports ready*/
+            tdl_disp_dev_flush_rects_async(sg_tdl_disp_hdl, &sg_display_fb, &sg_dirty_rects, \
+                                           __disp_flush_done_cb, disp);
+            tdl_disp_rect_list_clear(&sg_dirty_rects);
 
 #if defined(ENABLE_LVGL_DUAL_DISP_BUFF) && (ENABLE_LVGL_DUAL_DISP_BUFF == 1)
             uint8_t *next_frame = (sg_display_fb.frame == sg_frame_1) ? \
                                     sg_frame_2 : sg_frame_1;
             if(next_frame) {
+                prof_start = TDL_DISP_PROF_NOW();
                 __disp_framebuffer_memcpy(&sg_display_info, next_frame, sg_display_fb.frame, sg_display_fb.len);
+                tdl_disp_prof_record(TDL_DISP_PROF_CONVERT, prof_start);
                 sg_display_fb.frame = next_frame;
             }
 #endif
+            sg_prof_render_start = TDL_DISP_PROF_NOW();
+            return;
 #else 
-        __disp_fill_display_framebuffer(target_area, color_ptr, cf, sg_p_display_fb);
-
         if (lv_display_flush_is_last(disp)) {
-            tdl_disp_dev_flush(sg_tdl_disp_hdl, sg_p_display_fb);
+            tdl_disp_dev_flush_rects(sg_tdl_disp_hdl, sg_p_display_fb, &sg_dirty_rects);
+            tdl_disp_rect_list_clear(&sg_dirty_rects);
 
 #if defined(ENABLE_LVGL_DUAL_DISP_BUFF) && (ENABLE_LVGL_DUAL_DISP_BUFF == 1)
             TDL_DISP_FRAME_BUFF_T *next_fb = (sg_p_display_fb == sg_p_display_fb_1) ? \
@@ -45,6 +45,13 @@ void disp_enable_update(void);
  */
 void disp_disable_update(void);
 
+#if defined(ENABLE_DISPLAY_PROFILE) && (ENABLE_DISPLAY_PROFILE == 1)
+/* Show or hide the display profile (fps, bus rate, stage loads) in a corner of the screen.
+ * Call it with the LVGL lock held.
+ */
+void lv_port_disp_prof_overlay(bool enable);
+#endif
+
 /**********************
  *      MACROS
  **********************/
@@ -1,5 +1,14 @@
 /**
  * @file lv_malloc_core_tuya.c
+ *
+ * Requests up to the largest small object class take a block of the first
+ * class that fits, from fixed block arrays in SRAM, O(1) and without
+ * fragmenting the heap. Requests of LV_PORT_MEM_PSRAM_MIN bytes or more go to
+ * PSRAM. What is left, and whatever a full class or tier could not serve, goes
+ * to the pools added by lv_mem_add_pool() and then to the system heaps.
+ *
+ * Slab and pool blocks are told apart by address, heap blocks carry a header
+ * with their size and tier.
  */
 
 /*********************
@@ -7,26 +16,341 @@
  *********************/
 #include "lvgl.h"
 #include "tkl_memory.h"
+#include "tal_api.h"
+#include "lv_port_mem.h"
 
 /*********************
  *      DEFINES
  *********************/
+#define MEM_ALIGN          8
+#define MEM_ROUND(size)    (((size) + MEM_ALIGN - 1) & ~(size_t)(MEM_ALIGN - 1))
+#define MEM_HDR_SIZE       MEM_ROUND(sizeof(mem_hdr_t))
+#define MEM_POOL_BLK_MIN   MEM_ROUND(MEM_HDR_SIZE + sizeof(void *))
+#define MEM_TAG(tier)      (0x4C560000UL | (tier)) // "LV" and the tier
 
 /**********************
  *      TYPEDEFS
  **********************/
+typedef struct {
+    uint32_t size; // whole block, header included
+    uint32_t tag;  // MEM_TAG() of the owner
+} mem_hdr_t;
 
-/**********************
- *  STATIC PROTOTYPES
- **********************/
+typedef struct mem_free {
+    mem_hdr_t hdr;
+    struct mem_free *next; // address ordered
+} mem_free_t;
+
+typedef struct {
+    uint8_t *base;
+    uint8_t *end;
+    void *free_list; // each free block holds the next one
+    uint16_t block_size;
+    uint16_t block_num;
+    uint16_t used;
+    uint16_t peak;
+} mem_slab_t;
+
+typedef struct {
+    uint8_t *base; // NULL for a free slot
+    uint8_t *end;
+    mem_free_t *free_list;
+} mem_pool_t;
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+static const uint16_t sg_slab_sizes[] = LV_PORT_MEM_SLAB_SIZES;
+static const uint16_t sg_slab_counts[] = LV_PORT_MEM_SLAB_COUNTS;
+static mem_slab_t sg_slab[CNTSOF(sg_slab_sizes)];
+static mem_pool_t sg_pool[LV_PORT_MEM_POOL_MAX];
+static lv_port_mem_stat_t sg_stat[LV_PORT_MEM_TIER_NUM];
+static MUTEX_HANDLE sg_pool_mutex = NULL;
 
 /**********************
- *      MACROS
+ *   STATIC FUNCTIONS
  **********************/
+static void __stat_add(lv_port_mem_tier_t tier, size_t size)
+{
+    lv_port_mem_stat_t *stat = &sg_stat[tier];
+
+    TAL_ENTER_CRITICAL();
+    stat->alloc_cnt++;
+    stat->used_cnt++;
+    stat->used += size;
+    if (stat->used > stat->peak) {
+        stat->peak = stat->used;
+    }
+    TAL_EXIT_CRITICAL();
+}
+
+static void __stat_sub(lv_port_mem_tier_t tier, size_t size)
+{
+    TAL_ENTER_CRITICAL();
+    sg_stat[tier].used_cnt--;
+    sg_stat[tier].used -= size;
+    TAL_EXIT_CRITICAL();
+}
+
+static void __stat_fail(lv_port_mem_tier_t tier)
+{
+    TAL_ENTER_CRITICAL();
+    sg_stat[tier].fail_cnt++;
+    TAL_EXIT_CRITICAL();
+}
+
+static void __slab_init(void)
+{
+    uint32_t i = 0, j = 0;
+    size_t len = 0;
+    mem_slab_t *slab = NULL;
+
+    for (i = 0; i < CNTSOF(sg_slab); i++) {
+        slab = &sg_slab[i];
+        slab->block_size = MEM_ROUND(sg_slab_sizes[i]);
+        slab->block_num = sg_slab_counts[i];
+        len = (size_t)slab->block_size * slab->block_num;
+
+        slab->base = tkl_system_malloc(len);
+        if (NULL == slab->base) {
+            PR_ERR("lvgl slab class %d malloc failed:0x%x", i, len);
+            slab->block_num = 0;
+            continue;
+        }
+        slab->end = slab->base + len;
+        for (j = slab->block_num; j > 0; j--) {
+            *(void **)(slab->base + (j - 1) * slab->block_size) = slab->free_list;
+            slab->free_list = slab->base + (j - 1) * slab->block_size;
+        }
+        sg_stat[LV_PORT_MEM_SLAB].total += len;
+    }
+}
+
+static void *__slab_alloc(size_t size)
+{
+    uint32_t i = 0;
+    void *ptr = NULL;
+    mem_slab_t *slab = NULL;
+
+    for (i = 0; i < CNTSOF(sg_slab); i++) {
+        slab = &sg_slab[i];
+        if (size > slab->block_size) {
+            continue;
+        }
+
+        TAL_ENTER_CRITICAL();
+        ptr = slab->free_list;
+        if (ptr) {
+            slab->free_list = *(void **)ptr;
+            if (++slab->used > slab->peak) {
+                slab->peak = slab->used;
+            }
+        }
+        TAL_EXIT_CRITICAL();
+
+        if (ptr) {
+            __stat_add(LV_PORT_MEM_SLAB, slab->block_size);
+        } else {
+            __stat_fail(LV_PORT_MEM_SLAB);
+        }
+        break;
+    }
+
+    return ptr;
+}
+
+static mem_slab_t *__slab_find(void *ptr)
+{
+    uint32_t i = 0;
+
+    for (i = 0; i < CNTSOF(sg_slab); i++) {
+        if ((uint8_t *)ptr >= sg_slab[i].base && (uint8_t *)ptr < sg_slab[i].end) {
+            return &sg_slab[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void __slab_free(mem_slab_t *slab, void *ptr)
+{
+    TAL_ENTER_CRITICAL();
+    *(void **)ptr = slab->free_list;
+    slab->free_list = ptr;
+    slab->used--;
+    TAL_EXIT_CRITICAL();
+
+    __stat_sub(LV_PORT_MEM_SLAB, slab->block_size);
+}
+
+static mem_pool_t *__pool_find(void *ptr)
+{
+    uint32_t i = 0;
+
+    for (i = 0; i < LV_PORT_MEM_POOL_MAX; i++) {
+        if ((uint8_t *)ptr >= sg_pool[i].base && (uint8_t *)ptr < sg_pool[i].end) {
+            return &sg_pool[i];
+        }
+    }
+
+    return NULL;
+}
+
+// first fit, a remainder big enough for another block is split off
+static void *__pool_alloc(size_t size)
+{
+    uint32_t i = 0;
+    size_t need = MEM_ROUND(size) + MEM_HDR_SIZE;
+    mem_free_t **link = NULL, *blk = NULL, *rest = NULL;
+
+    if (NULL == sg_pool_mutex) {
+        return NULL;
+    }
+    need = need < MEM_POOL_BLK_MIN ? MEM_POOL_BLK_MIN : need;
+
+    tal_mutex_lock(sg_pool_mutex);
+    for (i = 0; i < LV_PORT_MEM_POOL_MAX && NULL == blk; i++) {
+        for (link = &sg_pool[i].free_list; *link; link = &(*link)->next) {
+            if ((*link)->hdr.size < need) {
+                continue;
+            }
+            blk = *link;
+            if (blk->hdr.size - need >= MEM_POOL_BLK_MIN) {
+                rest = (mem_free_t *)((uint8_t *)blk + need);
+                rest->hdr.size = blk->hdr.size - need;
+                rest->hdr.tag = MEM_TAG(LV_PORT_MEM_POOL);
+                rest->next = blk->next;
+                blk->hdr.size = need;
+                *link = rest;
+            } else {
+                *link = blk->next;
+            }
+            break;
+        }
+    }
+    tal_mutex_unlock(sg_pool_mutex);
+
+    if (NULL == blk) {
+        if (sg_stat[LV_PORT_MEM_POOL].total) {
+            __stat_fail(LV_PORT_MEM_POOL);
+        }
+        return NULL;
+    }
+    __stat_add(LV_PORT_MEM_POOL, blk->hdr.size);
+    return (uint8_t *)blk + MEM_HDR_SIZE;
+}
+
+// the free list is address ordered, so neighbours are merged on the way in
+static void __pool_free(mem_pool_t *pool, void *ptr)
+{
+    mem_free_t *blk = (mem_free_t *)((uint8_t *)ptr - MEM_HDR_SIZE);
+    mem_free_t *prev = NULL, *next = NULL;
+    size_t size = blk->hdr.size;
+
+    tal_mutex_lock(sg_pool_mutex);
+    for (next = pool->free_list; next && next < blk; next = next->next) {
+        prev = next;
+    }
+
+    blk->next = next;
+    if (next && (uint8_t *)blk + blk->hdr.size == (uint8_t *)next) {
+        blk->hdr.size += next->hdr.size;
+        blk->next = next->next;
+    }
+    if (prev && (uint8_t *)prev + prev->hdr.size == (uint8_t *)blk) {
+        prev->hdr.size += blk->hdr.size;
+        prev->next = blk->next;
+    } else if (prev) {
+        prev->next = blk;
+    } else {
+        pool->free_list = blk;
+    }
+    tal_mutex_unlock(sg_pool_mutex);
+
+    __stat_sub(LV_PORT_MEM_POOL, size);
+}
+
+static void *__heap_alloc(lv_port_mem_tier_t tier, size_t size)
+{
+    mem_hdr_t *hdr = NULL;
+
+#if defined(ENABLE_EXT_RAM) && (ENABLE_EXT_RAM == 1)
+    if (LV_PORT_MEM_PSRAM == tier) {
+        hdr = tkl_system_psram_malloc(size + MEM_HDR_SIZE);
+    } else
+#endif
+    {
+        hdr = tkl_system_malloc(size + MEM_HDR_SIZE);
+    }
+    if (NULL == hdr) {
+        __stat_fail(tier);
+        return NULL;
+    }
+
+    hdr->size = size + MEM_HDR_SIZE;
+    hdr->tag = MEM_TAG(tier);
+    __stat_add(tier, hdr->size);
+    return (uint8_t *)hdr + MEM_HDR_SIZE;
+}
+
+static void *__heap_realloc(mem_hdr_t *hdr, size_t new_size)
+{
+    lv_port_mem_tier_t tier = (lv_port_mem_tier_t)(hdr->tag & 0xFF);
+    size_t old_size = hdr->size;
+
+#if defined(ENABLE_EXT_RAM) && (ENABLE_EXT_RAM == 1)
+    if (LV_PORT_MEM_PSRAM == tier) {
+        hdr = tkl_system_psram_realloc(hdr, new_size + MEM_HDR_SIZE);
+    } else
+#endif
+    {
+        hdr = tkl_system_realloc(hdr, new_size + MEM_HDR_SIZE);
+    }
+    if (NULL == hdr) {
+        __stat_fail(tier);
+        return NULL;
+    }
+
+    hdr->size = new_size + MEM_HDR_SIZE;
+    TAL_ENTER_CRITICAL();
+    sg_stat[tier].used += hdr->size;
+    sg_stat[tier].used -= old_size;
+    if (sg_stat[tier].used > sg_stat[tier].peak) {
+        sg_stat[tier].peak = sg_stat[tier].used;
+    }
+    TAL_EXIT_CRITICAL();
+    return (uint8_t *)hdr + MEM_HDR_SIZE;
+}
+
+static void __heap_free(mem_hdr_t *hdr)
+{
+    lv_port_mem_tier_t tier = (lv_port_mem_tier_t)(hdr->tag & 0xFF);
+
+    if (MEM_TAG(tier) != hdr->tag || tier < LV_PORT_MEM_SRAM || tier >= LV_PORT_MEM_TIER_NUM) {
+        PR_ERR("lvgl free of a bad block %p", (uint8_t *)hdr + MEM_HDR_SIZE);
+        return;
+    }
+
+    __stat_sub(tier, hdr->size);
+#if defined(ENABLE_EXT_RAM) && (ENABLE_EXT_RAM == 1)
+    if (LV_PORT_MEM_PSRAM == tier) {
+        tkl_system_psram_free(hdr);
+        return;
+    }
+#endif
+    tkl_system_free(hdr);
+}
+
+// usable bytes of a block, pool and heap blocks share the header layout
+static size_t __block_size(void *p)
+{
+    mem_slab_t *slab = __slab_find(p);
+
+    if (slab) {
+        return slab->block_size;
+    }
+    return ((mem_hdr_t *)((uint8_t *)p - MEM_HDR_SIZE))->size - MEM_HDR_SIZE;
+}
 
 /**********************
  *   GLOBAL FUNCTIONS
@@ -34,65 +358,262 @@
 
 void lv_mem_init(void)
 {
-    return; /*Nothing to init*/
+    if (NULL == sg_pool_mutex && OPRT_OK != tal_mutex_create_init(&sg_pool_mutex)) {
+        PR_ERR("lvgl pool mutex create failed");
+    }
+    if (NULL == sg_slab[0].base) {
+        __slab_init();
+    }
 }
 
 void lv_mem_deinit(void)
 {
-    return; /*Nothing to deinit*/
+    uint32_t i = 0;
+
+    for (i = 0; i < CNTSOF(sg_slab); i++) {
+        if (sg_slab[i].base) {
+            tkl_system_free(sg_slab[i].base);
+        }
+    }
+    memset(sg_slab, 0, sizeof(sg_slab));
+    memset(sg_pool, 0, sizeof(sg_pool));
+    memset(sg_stat, 0, sizeof(sg_stat));
 }
 
 lv_mem_pool_t lv_mem_add_pool(void *mem, size_t bytes)
 {
-    /*Not supported*/
-    LV_UNUSED(mem);
-    LV_UNUSED(bytes);
-    return NULL;
+    uint32_t i = 0;
+    uint8_t *base = (uint8_t *)MEM_ROUND((uintptr_t)mem);
+    mem_pool_t *pool = NULL;
+
+    if (NULL == mem || NULL == sg_pool_mutex || bytes < (size_t)(base - (uint8_t *)mem) + MEM_POOL_BLK_MIN) {
+        return NULL;
+    }
+    bytes = (bytes - (base - (uint8_t *)mem)) & ~(size_t)(MEM_ALIGN - 1);
+
+    tal_mutex_lock(sg_pool_mutex);
+    for (i = 0; i < LV_PORT_MEM_POOL_MAX; i++) {
+        if (NULL == sg_pool[i].base) {
+            pool = &sg_pool[i];
+            pool->free_list = (mem_free_t *)base;
+            pool->free_list->hdr.size = bytes;
+            pool->free_list->hdr.tag = MEM_TAG(LV_PORT_MEM_POOL);
+            pool->free_list->next = NULL;
+            pool->end = base + bytes;
+            pool->base = base;
+            break;
+        }
+    }
+    tal_mutex_unlock(sg_pool_mutex);
+
+    if (NULL == pool) {
+        LV_LOG_WARN("no free pool slot, raise LV_PORT_MEM_POOL_MAX");
+        return NULL;
+    }
+    TAL_ENTER_CRITICAL();
+    sg_stat[LV_PORT_MEM_POOL].total += bytes;
+    TAL_EXIT_CRITICAL();
+    return pool;
 }
 
 void lv_mem_remove_pool(lv_mem_pool_t pool)
 {
-    /*Not supported*/
-    LV_UNUSED(pool);
-    return;
+    mem_pool_t *p = pool;
+    bool is_free = false;
+
+    if (NULL == p || NULL == sg_pool_mutex) {
+        return;
+    }
+
+    tal_mutex_lock(sg_pool_mutex);
+    is_free = p->base && (uint8_t *)p->free_list == p->base && NULL == p->free_list->next &&
+              p->base + p->free_list->hdr.size == p->end;
+    if (is_free) {
+        TAL_ENTER_CRITICAL();
+        sg_stat[LV_PORT_MEM_POOL].total -= p->end - p->base;
+        TAL_EXIT_CRITICAL();
+        memset(p, 0, sizeof(mem_pool_t));
+    }
+    tal_mutex_unlock(sg_pool_mutex);
+
+    if (!is_free) {
+        LV_LOG_WARN("pool %p still has blocks in use, not removed", pool);
+    }
 }
 
 void *lv_malloc_core(size_t size)
 {
+    void *p = NULL;
+
+    if (size <= sg_slab[CNTSOF(sg_slab) - 1].block_size) {
+        p = __slab_alloc(size);
+    }
+
+#if defined(ENABLE_EXT_RAM) && (ENABLE_EXT_RAM == 1)
+    if (NULL == p && size >= LV_PORT_MEM_PSRAM_MIN) {
+        p = __heap_alloc(LV_PORT_MEM_PSRAM, size);
+    }
+#endif
+    if (NULL == p) {
+        p = __pool_alloc(size);
+    }
+    if (NULL == p) {
+        p = __heap_alloc(LV_PORT_MEM_SRAM, size);
+    }
 #if defined(ENABLE_EXT_RAM) && (ENABLE_EXT_RAM == 1)
-    return tkl_system_psram_malloc(size);
-#else
-    return tkl_system_malloc(size);
+    if (NULL == p && size < LV_PORT_MEM_PSRAM_MIN) {
+        p = __heap_alloc(LV_PORT_MEM_PSRAM, size);
+    }
 #endif
+
+    return p;
 }
 
 void *lv_realloc_core(void *p, size_t new_size)
 {
-#if defined(ENABLE_EXT_RAM) && (ENABLE_EXT_RAM == 1)
-    return tkl_system_psram_realloc(p, new_size);
-#else
-    return tkl_system_realloc(p, new_size);
-#endif
+    void *new_p = NULL;
+    size_t old_size = 0;
+
+    if (NULL == p) {
+        return lv_malloc_core(new_size);
+    }
+
+    old_size = __block_size(p);
+    if (NULL == __slab_find(p) && NULL == __pool_find(p)) {
+        // a heap block stays in its heap, unless it shrinks into a small object class
+        if (new_size > sg_slab[CNTSOF(sg_slab) - 1].block_size) {
+            return __heap_realloc((mem_hdr_t *)((uint8_t *)p - MEM_HDR_SIZE), new_size);
+        }
+    } else if (new_size <= old_size) {
+        return p;
+    }
+
+    new_p = lv_malloc_core(new_size);
+    if (NULL == new_p) {
+        return NULL;
+    }
+    lv_memcpy(new_p, p, LV_MIN(old_size, new_size));
+    lv_free_core(p);
+    return new_p;
 }
 
 void lv_free_core(void *p)
 {
-#if defined(ENABLE_EXT_RAM) && (ENABLE_EXT_RAM == 1)
-    tkl_system_psram_free(p);
-#else
-    tkl_system_free(p);
-#endif
+    mem_slab_t *slab = NULL;
+    mem_pool_t *pool = NULL;
+
+    if (NULL == p) {
+        return;
+    }
+
+    slab = __slab_find(p);
+    if (slab) {
+        __slab_free(slab, p);
+        return;
+    }
+    pool = __pool_find(p);
+    if (pool) {
+        __pool_free(pool, p);
+        return;
+    }
+    __heap_free((mem_hdr_t *)((uint8_t *)p - MEM_HDR_SIZE));
 }
 
 void lv_mem_monitor_core(lv_mem_monitor_t *mon_p)
 {
-    /*Not supported*/
-    LV_UNUSED(mon_p);
-    return;
+    uint32_t i = 0, tier = 0;
+    mem_free_t *blk = NULL;
+    size_t pool_free = 0;
+
+    lv_memzero(mon_p, sizeof(lv_mem_monitor_t));
+
+    for (i = 0; i < CNTSOF(sg_slab); i++) {
+        mon_p->free_cnt += sg_slab[i].block_num - sg_slab[i].used;
+        if (sg_slab[i].used < sg_slab[i].block_num) {
+            mon_p->free_biggest_size = LV_MAX(mon_p->free_biggest_size, sg_slab[i].block_size);
+        }
+    }
+
+    if (sg_pool_mutex) {
+        tal_mutex_lock(sg_pool_mutex);
+        for (i = 0; i < LV_PORT_MEM_POOL_MAX; i++) {
+            for (blk = sg_pool[i].free_list; blk; blk = blk->next) {
+                mon_p->free_cnt++;
+                pool_free += blk->hdr.size - MEM_HDR_SIZE;
+                mon_p->free_biggest_size = LV_MAX(mon_p->free_biggest_size, blk->hdr.size - MEM_HDR_SIZE);
+            }
+        }
+        tal_mutex_unlock(sg_pool_mutex);
+    }
+
+    // the system heaps count with what LVGL holds of them
+    for (tier = 0; tier < LV_PORT_MEM_TIER_NUM; tier++) {
+        mon_p->total_size += sg_stat[tier].total ? sg_stat[tier].total : sg_stat[tier].used;
+        mon_p->used_cnt += sg_stat[tier].used_cnt;
+        mon_p->max_used += sg_stat[tier].peak;
+    }
+    mon_p->free_size = sg_stat[LV_PORT_MEM_SLAB].total - sg_stat[LV_PORT_MEM_SLAB].used + pool_free;
+
+    if (mon_p->total_size) {
+        mon_p->used_pct = 100 - (uint64_t)mon_p->free_size * 100 / mon_p->total_size;
+    }
+    if (pool_free) {
+        mon_p->frag_pct = 100 - (uint64_t)mon_p->free_biggest_size * 100 / pool_free;
+        mon_p->frag_pct = mon_p->free_biggest_size > pool_free ? 0 : mon_p->frag_pct;
+    }
 }
 
 lv_result_t lv_mem_test_core(void)
 {
-    /*Not supported*/
-    return LV_RESULT_OK;
+    uint32_t i = 0;
+    lv_result_t res = LV_RESULT_OK;
+    mem_free_t *blk = NULL;
+
+    if (NULL == sg_pool_mutex) {
+        return res;
+    }
+
+    // free blocks are in their pool, in address order and never adjacent
+    tal_mutex_lock(sg_pool_mutex);
+    for (i = 0; i < LV_PORT_MEM_POOL_MAX && LV_RESULT_OK == res; i++) {
+        for (blk = sg_pool[i].free_list; blk; blk = blk->next) {
+            if ((uint8_t *)blk < sg_pool[i].base || (uint8_t *)blk + blk->hdr.size > sg_pool[i].end ||
+                MEM_TAG(LV_PORT_MEM_POOL) != blk->hdr.tag ||
+                (blk->next && (uint8_t *)blk + blk->hdr.size >= (uint8_t *)blk->next)) {
+                res = LV_RESULT_INVALID;
+                break;
+            }
+        }
+    }
+    tal_mutex_unlock(sg_pool_mutex);
+
+    return res;
+}
+
+void lv_port_mem_get_stat(lv_port_mem_tier_t tier, lv_port_mem_stat_t *stat)
+{
+    if (tier >= LV_PORT_MEM_TIER_NUM || NULL == stat) {
+        return;
+    }
+
+    TAL_ENTER_CRITICAL();
+    *stat = sg_stat[tier];
+    TAL_EXIT_CRITICAL();
+}
+
+void lv_port_mem_dump(void)
+{
+    static const char *names[LV_PORT_MEM_TIER_NUM] = {"slab", "pool", "sram", "psram"};
+    lv_port_mem_stat_t stat;
+    uint32_t i = 0;
+
+    for (i = 0; i < LV_PORT_MEM_TIER_NUM; i++) {
+        lv_port_mem_get_stat(i, &stat);
+        PR_NOTICE("lvgl %-5s total:%u used:%u peak:%u blocks:%u allocs:%u fails:%u", names[i], stat.total,
+                  stat.used, stat.peak, stat.used_cnt, stat.alloc_cnt, stat.fail_cnt);
+    }
+    for (i = 0; i < CNTSOF(sg_slab); i++) {
+        PR_NOTICE("lvgl slab %3u: %u/%u peak:%u", sg_slab[i].block_size, sg_slab[i].used, sg_slab[i].block_num,
+                  sg_slab[i].peak);
+    }
 }
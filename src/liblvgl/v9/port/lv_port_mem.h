@@ -0,0 +1,84 @@
+/**
+ * @file lv_port_mem.h
+ *
+ * LVGL allocator with separate tiers: small objects come from size classes in
+ * internal SRAM, large ones such as image and draw buffers from PSRAM, and
+ * memory given to lv_mem_add_pool() is used before the system heaps.
+ */
+
+#ifndef LV_PORT_MEM_H
+#define LV_PORT_MEM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+// block size of each small object class, ascending, multiples of 8
+#ifndef LV_PORT_MEM_SLAB_SIZES
+#define LV_PORT_MEM_SLAB_SIZES {16, 32, 64, 128, 256}
+#endif
+
+// number of blocks of each class, all classes live in SRAM
+#ifndef LV_PORT_MEM_SLAB_COUNTS
+#define LV_PORT_MEM_SLAB_COUNTS {128, 128, 64, 32, 16}
+#endif
+
+// requests of at least this size go to PSRAM first, needs ENABLE_EXT_RAM
+#ifndef LV_PORT_MEM_PSRAM_MIN
+#define LV_PORT_MEM_PSRAM_MIN 1024
+#endif
+
+// pools lv_mem_add_pool() can hold
+#ifndef LV_PORT_MEM_POOL_MAX
+#define LV_PORT_MEM_POOL_MAX 4
+#endif
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef enum {
+    LV_PORT_MEM_SLAB = 0, // small object classes
+    LV_PORT_MEM_POOL,     // memory added by lv_mem_add_pool()
+    LV_PORT_MEM_SRAM,     // system heap
+    LV_PORT_MEM_PSRAM,    // PSRAM heap
+    LV_PORT_MEM_TIER_NUM,
+} lv_port_mem_tier_t;
+
+typedef struct {
+    size_t total;      // bytes the tier manages, 0 for the system heaps
+    size_t used;       // bytes handed out, block headers included
+    size_t peak;       // high-water mark of used
+    uint32_t used_cnt; // blocks handed out
+    uint32_t alloc_cnt;
+    uint32_t fail_cnt; // requests the tier could not serve
+} lv_port_mem_stat_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Get the statistics of one tier
+ * @param tier      the tier
+ * @param stat      filled with the counters
+ */
+void lv_port_mem_get_stat(lv_port_mem_tier_t tier, lv_port_mem_stat_t *stat);
+
+/**
+ * Print the statistics of all tiers and small object classes
+ */
+void lv_port_mem_dump(void);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_PORT_MEM_H*/
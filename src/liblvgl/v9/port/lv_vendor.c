@@ -10,6 +10,7 @@
 #include "tkl_thread.h"
 #include "tkl_mutex.h"
 #include "tkl_semaphore.h"
+#include "tal_boot_mark.h"
 
 static TKL_THREAD_HANDLE g_disp_thread_handle = NULL;
 static TKL_MUTEX_HANDLE g_disp_mutex = NULL;
@@ -39,6 +40,7 @@ void lv_vendor_init(void *device)
         return;
     }
 
+    tal_boot_mark("lvgl init");
     lv_init();
 
     lv_port_disp_init(device);
@@ -58,6 +60,7 @@ void lv_vendor_init(void *device)
     }
 
     lv_vendor_initialized = true;
+    tal_boot_mark("lvgl ready");
 
     LV_LOG_INFO("%s complete\n", __func__);
 }
@@ -15,7 +15,24 @@
 #include "tal_thread.h"
 #include "tal_system.h"
 
+/* mailboxes are rings of pointers, a post wakes the fetching thread only
+ * when it waits, see sys_arch.c. 0 uses the tal queue */
+#ifndef LWIP_TUYA_RING_MBOX
+#define LWIP_TUYA_RING_MBOX    1
+#endif
+
+/* sys_arch_protect masks interrupts instead of locking a mutex, the mask
+ * is kept in sys_prot_t */
+#ifndef LWIP_TUYA_PROTECT_CRITICAL
+#define LWIP_TUYA_PROTECT_CRITICAL 1
+#endif
+
+#if LWIP_TUYA_RING_MBOX
+struct sys_ring_mbox;
+#define SYS_MBOX_NULL           ( struct sys_ring_mbox * )0
+#else
 #define SYS_MBOX_NULL           ( QUEUE_HANDLE )0
+#endif
 #define SYS_SEM_NULL            ( SEM_HANDLE )0
 
 /* ------------------------ Type definitions ------------------------------ */
@@ -23,7 +40,11 @@ typedef SEM_HANDLE sys_sem_t;
 typedef MUTEX_HANDLE sys_mutex_t;
 typedef THREAD_HANDLE sys_thread_t;
 typedef int     sys_prot_t;
+#if LWIP_TUYA_RING_MBOX
+typedef struct sys_ring_mbox *sys_mbox_t;
+#else
 typedef QUEUE_HANDLE sys_mbox_t;
+#endif
 
 #endif /* __SYS_RTXC_H__ */
 
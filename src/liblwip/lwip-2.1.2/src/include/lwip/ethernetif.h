@@ -1,141 +1,197 @@
-#ifndef __ETHERNETIF_H__
-#define __ETHERNETIF_H__
-
-
-#include "lwip/err.h"
-#include "lwip/netif.h"
-#include "tuya_cloud_types.h"
-#include "tal_network.h"
-
-/***********************************************************
-*************************micro define***********************
-***********************************************************/
-/* num of netif: 0 is to STATION wifi interface, 1 is to AP wifi interface */
-
-typedef enum {
-    NETIF_STA_IDX = 0,
-    NETIF_AP_IDX,
-#ifdef LWIP_DUAL_NET_SUPPORT    
-    NETIF_ETH_IDX,
-#endif /* LWIP_DUAL_NET_SUPPORT */    
-    NETIF_NUM
-} TUYA_NETIF_TYPE;
-
-typedef struct {
-    ip4_addr_t ip;
-    ip4_addr_t netmask;
-    ip4_addr_t gw;
-} ty_netif_ip_info_s;
-
-/***********************************************************
-*************************variable define********************
-***********************************************************/
-
-/***********************************************************
-*************************function define********************
-***********************************************************/
-
-/**
- * @brief get netif by index
- *
- * @param[in]       net_if_idx    the num of netif index
- * @return  NULL: get netif fail   other: the point of netif
- */
-struct netif *tuya_ethernetif_get_netif_by_index(const TUYA_NETIF_TYPE net_if_idx);
-
-/**
- * @brief set netif ipaddr from lwip
- *
- * @param[in]       net_if_idx    index of netif
- * @param[out]      ip            ip of netif(ip gateway mask)
- * @return  void
- */
-void tuya_ethernetif_broadcast_set(const TUYA_NETIF_TYPE net_if_idx, bool_t enable);
-
-/**
- * @brief set netif ipaddr from lwip
- *
- * @param[in]       net_if_idx    index of netif
- * @param[out]      ip            ip of netif(ip gateway mask)
- * @return  void
- */
-void tuya_ethernetif_set_ip(const TUYA_NETIF_TYPE net_if_idx, NW_IP_S *ip);
-
-/**
- * @brief get netif ipaddr from lwip
- *
- * @param[in]       net_if_idx    index of netif
- * @param[out]      ip            ip of netif(ip gateway mask)
- * @return  void
- */
-int tuya_ethernetif_get_ip(const TUYA_NETIF_TYPE net_if_idx, NW_IP_TYPE type, NW_IP_S *ip);
-
-/**
- * @brief set netif's mac
- *
- * @param[in]       net_if_idx    index of netif
- * @param[in]       mac           mac to set
- * @return  int    OPRT_OS_ADAPTER_OK:success   other:fail
- */
-int tuya_ethernetif_mac_set(const TUYA_NETIF_TYPE net_if_idx, NW_MAC_S *mac);
-
-/**
- * @brief get netif's mac
- *
- * @param[in]       net_if_idx    index of netif
- * @param[out]      mac           mac to set
- * @return  int    OPRT_OS_ADAPTER_OK:success   other:fail
- */
-int tuya_ethernetif_mac_get(const TUYA_NETIF_TYPE net_if_idx, NW_MAC_S *mac);
-
-/**
- * @brief netif check(check netif is up/down and ip is valid)
- *
- * @param   void
- * @return  int    OPRT_OS_ADAPTER_OK:netif is up and ip is valid
- */
-//int tuya_ethernetif_station_state_get(void);
-
-/**
- * @brief ethernet interface recv the packet
- *
- * @param[in]      netif       the netif to which to recieve the packet
- * @param[in]      total_len   the length of the packet recieved from the netif
- * @return  void
- */
-//int tuya_ethernetif_recv(struct netif *netif, struct pbuf *p);
-
-/**
- * @brief ethernet interface sendout the pbuf packet
- *
- * @param[in]      netif     the netif to which to be inited
- * @return  err_t  SEE "err_enum_t" in "lwip/err.h" to see the lwip err(ERR_OK: SUCCESS other:fail)
- */
-err_t tuya_ethernetif_init(struct netif *netif);
-
-
-//unsigned int tuya_ethernetif_ip_chksum(void *buf, unsigned short len);
-
-#if LWIP_EAPOL_SUPPORT
-extern int tuya_hostap_eapol_input(int vif_index, unsigned char *buf, unsigned short len);
-#endif /* LWIP_EAPOL_SUPPORT */
-
-int tuya_ethernetif_get_ifindex_by_mac(NW_MAC_S *mac, TUYA_NETIF_TYPE *net_if_idx);
-
-int tuya_ethernetif_get_dns_srv(NW_IP_TYPE type, NW_IP_S *ip);
-#ifdef LWIP_DUAL_NET_SUPPORT
-/**
- * Helper struct to hold private data used to operate your ethernet interface.
- * Keeping the ethernet address of the MAC in this struct is not necessary
- * as it is already kept in the struct netif.
- * But this is only an example, anyway...
- */
-struct ethernetif {
-    uint16_t rx_len;
-    uint8_t rx_status;
-};
-
-extern err_t ethernetif_init(struct netif *netif);
-#endif /* LWIP_DUAL_NET_SUPPORT */
-
-#endif /* __ETHERNETIF_H__ */
+#ifndef __ETHERNETIF_H__
+#define __ETHERNETIF_H__
+
+
+#include "lwip/err.h"
+#include "lwip/netif.h"
+#include "tuya_cloud_types.h"
+#include "tal_network.h"
+
+/***********************************************************
+*************************micro define***********************
+***********************************************************/
+/* num of netif: 0 is to STATION wifi interface, 1 is to AP wifi interface */
+
+typedef enum {
+    NETIF_STA_IDX = 0,
+    NETIF_AP_IDX,
+#ifdef LWIP_DUAL_NET_SUPPORT    
+    NETIF_ETH_IDX,
+#endif /* LWIP_DUAL_NET_SUPPORT */    
+    NETIF_NUM
+} TUYA_NETIF_TYPE;
+
+typedef struct {
+    ip4_addr_t ip;
+    ip4_addr_t netmask;
+    ip4_addr_t gw;
+} ty_netif_ip_info_s;
+
+/* one piece of an outgoing frame, see tuya_ethernetif_output_segs() */
+typedef struct {
+    const void *data;
+    uint16_t len;
+} ty_netif_seg_s;
+
+/* called once lwip is done with a buffer given to tuya_ethernetif_input_ref() */
+typedef void (*ty_netif_rx_free_cb)(void *buf, void *arg);
+
+typedef struct {
+    uint32_t rx_ref;          /* packets received in place */
+    uint32_t rx_ref_fail;     /* no wrapper for a packet, the driver has to copy it */
+    uint32_t rx_ref_inflight; /* driver buffers still held by lwip */
+    uint32_t rx_ref_peak;
+    uint32_t tx_sg;           /* frames handed to the driver as segments */
+    uint32_t tx_sg_max;       /* most segments in one frame */
+    uint32_t tx_sg_over;      /* chains longer than the driver's descriptor list */
+    uint32_t pbuf_used;       /* pbuf pool use, MEMP_STATS only */
+    uint32_t pbuf_max;
+    uint32_t pbuf_err;
+} ty_netif_stat_s;
+
+/***********************************************************
+*************************variable define********************
+***********************************************************/
+
+/***********************************************************
+*************************function define********************
+***********************************************************/
+
+/**
+ * @brief get netif by index
+ *
+ * @param[in]       net_if_idx    the num of netif index
+ * @return  NULL: get netif fail   other: the point of netif
+ */
+struct netif *tuya_ethernetif_get_netif_by_index(const TUYA_NETIF_TYPE net_if_idx);
+
+/**
+ * @brief set netif ipaddr from lwip
+ *
+ * @param[in]       net_if_idx    index of netif
+ * @param[out]      ip            ip of netif(ip gateway mask)
+ * @return  void
+ */
+void tuya_ethernetif_broadcast_set(const TUYA_NETIF_TYPE net_if_idx, bool_t enable);
+
+/**
+ * @brief set netif ipaddr from lwip
+ *
+ * @param[in]       net_if_idx    index of netif
+ * @param[out]      ip            ip of netif(ip gateway mask)
+ * @return  void
+ */
+void tuya_ethernetif_set_ip(const TUYA_NETIF_TYPE net_if_idx, NW_IP_S *ip);
+
+/**
+ * @brief get netif ipaddr from lwip
+ *
+ * @param[in]       net_if_idx    index of netif
+ * @param[out]      ip            ip of netif(ip gateway mask)
+ * @return  void
+ */
+int tuya_ethernetif_get_ip(const TUYA_NETIF_TYPE net_if_idx, NW_IP_TYPE type, NW_IP_S *ip);
+
+/**
+ * @brief set netif's mac
+ *
+ * @param[in]       net_if_idx    index of netif
+ * @param[in]       mac           mac to set
+ * @return  int    OPRT_OS_ADAPTER_OK:success   other:fail
+ */
+int tuya_ethernetif_mac_set(const TUYA_NETIF_TYPE net_if_idx, NW_MAC_S *mac);
+
+/**
+ * @brief get netif's mac
+ *
+ * @param[in]       net_if_idx    index of netif
+ * @param[out]      mac           mac to set
+ * @return  int    OPRT_OS_ADAPTER_OK:success   other:fail
+ */
+int tuya_ethernetif_mac_get(const TUYA_NETIF_TYPE net_if_idx, NW_MAC_S *mac);
+
+/**
+ * @brief netif check(check netif is up/down and ip is valid)
+ *
+ * @param   void
+ * @return  int    OPRT_OS_ADAPTER_OK:netif is up and ip is valid
+ */
+//int tuya_ethernetif_station_state_get(void);
+
+/**
+ * @brief ethernet interface recv the packet
+ *
+ * @param[in]      netif       the netif to which to recieve the packet
+ * @param[in]      total_len   the length of the packet recieved from the netif
+ * @return  void
+ */
+//int tuya_ethernetif_recv(struct netif *netif, struct pbuf *p);
+
+/**
+ * @brief ethernet interface sendout the pbuf packet
+ *
+ * @param[in]      netif     the netif to which to be inited
+ * @return  err_t  SEE "err_enum_t" in "lwip/err.h" to see the lwip err(ERR_OK: SUCCESS other:fail)
+ */
+err_t tuya_ethernetif_init(struct netif *netif);
+
+
+//unsigned int tuya_ethernetif_ip_chksum(void *buf, unsigned short len);
+
+/**
+ * @brief pass a received frame to lwip without copying it
+ *
+ * @param[in]      netif     the netif the frame arrived on
+ * @param[in]      buf       driver buffer holding the frame
+ * @param[in]      len       frame length
+ * @param[in]      free_cb   gives the buffer back to the driver
+ * @param[in]      arg       argument of free_cb
+ * @return  ERR_OK: free_cb follows once lwip is done; ERR_MEM: not taken, the driver
+ *          still owns buf and may copy it instead; others: dropped, free_cb was called
+ *
+ * @note lwip may hold the buffer for a while, e.g. queued out of order tcp data,
+ *       so the driver should refill its rx ring instead of waiting for it.
+ */
+err_t tuya_ethernetif_input_ref(struct netif *netif, void *buf, u16_t len, ty_netif_rx_free_cb free_cb, void *arg);
+
+/**
+ * @brief describe a pbuf chain as segments, so the driver can send it without linearizing
+ *
+ * @param[in]      p         the frame from linkoutput
+ * @param[out]     segs      one entry per non-empty pbuf
+ * @param[in]      max       entries in segs, e.g. the free dma descriptors
+ * @return  the number of segments, -1 if the chain needs more than max
+ */
+int tuya_ethernetif_output_segs(struct pbuf *p, ty_netif_seg_s *segs, uint32_t max);
+
+/**
+ * @brief get the zero-copy and pbuf pool counters
+ *
+ * @param[out]     stat      counters since boot
+ * @return  void
+ */
+void tuya_ethernetif_stat_get(ty_netif_stat_s *stat);
+
+#if LWIP_EAPOL_SUPPORT
+extern int tuya_hostap_eapol_input(int vif_index, unsigned char *buf, unsigned short len);
+#endif /* LWIP_EAPOL_SUPPORT */
+
+int tuya_ethernetif_get_ifindex_by_mac(NW_MAC_S *mac, TUYA_NETIF_TYPE *net_if_idx);
+
+int tuya_ethernetif_get_dns_srv(NW_IP_TYPE type, NW_IP_S *ip);
+#ifdef LWIP_DUAL_NET_SUPPORT
+/**
+ * Helper struct to hold private data used to operate your ethernet interface.
+ * Keeping the ethernet address of the MAC in this struct is not necessary
+ * as it is already kept in the struct netif.
+ * But this is only an example, anyway...
+ */
+struct ethernetif {
+    uint16_t rx_len;
+    uint8_t rx_status;
+};
+
+extern err_t ethernetif_init(struct netif *netif);
+#endif /* LWIP_DUAL_NET_SUPPORT */
+
+#endif /* __ETHERNETIF_H__ */
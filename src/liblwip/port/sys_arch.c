@@ -47,6 +47,7 @@
 #include "lwip/timeouts.h"
 
 #include "tkl_output.h"
+#include "tal_memory.h"
 
 /* ------------------------ Defines --------------------------------------- */
 #define MAX_FREE_POLL_CNT     50
@@ -116,12 +117,16 @@ void sys_init(void)
  */
 sys_prot_t sys_arch_protect(void)
 {
+#if LWIP_TUYA_PROTECT_CRITICAL
+    return (sys_prot_t)tal_system_enter_critical();
+#else
     if (tal_mutex_lock(g_lwip_mutex) != ERR_OK) {
         SYS_ARCH_DBG("%s: call tal_mutex_lock failed\n", __func__);
         return ERR_MEM;
     }
 
     return ERR_OK;
+#endif
 }
 
 /*
@@ -132,9 +137,13 @@ sys_prot_t sys_arch_protect(void)
  */
 void sys_arch_unprotect(sys_prot_t pval)
 {
+#if LWIP_TUYA_PROTECT_CRITICAL
+    tal_system_exit_critical((uint32_t)pval);
+#else
     if (tal_mutex_unlock(g_lwip_mutex) != ERR_OK) {
         SYS_ARCH_DBG("%s: call tal_mutex_unlock failed\n", __func__);
     }
+#endif
 }
 
 /* ------------------------ Start implementation ( Threads ) -------------- */
@@ -201,34 +210,25 @@ void sys_sem_signal(sys_sem_t *sem)
  * only be blocked for the specified time (measured in
  * milliseconds).
  *
- * If the timeout argument is non-zero, the return value is the number of
- * milliseconds spent waiting for the semaphore to be signaled. If the
- * semaphore wasn't signaled within the specified time, the return value is
- * SYS_ARCH_TIMEOUT. If the thread didn't have to wait for the semaphore
- * (i.e., it was already signaled), the function may return zero.
+ * If the semaphore wasn't signaled within the specified time, the return
+ * value is SYS_ARCH_TIMEOUT, else zero. lwIP 2 only tests for the timeout,
+ * so the time spent waiting is not measured.
  *
  * Notice that lwIP implements a function with a similar name,
  * sys_sem_wait(), that uses the sys_arch_sem_wait() function.
  */
 u32_t sys_arch_sem_wait(sys_sem_t *sem, u32_t timeout)
 {
-    unsigned int start, end, elapsed;
-
     if (0 == timeout) {
         timeout = TY_LWIP_WAIT_FOREVER;
     }
 
-    start = tal_system_get_millisecond();
-
     if (tal_semaphore_wait(*sem, timeout) != ERR_OK) {
         SYS_ARCH_DBG("%s: call tal_semaphore_wait failed\n", __func__);
-        elapsed = SYS_ARCH_TIMEOUT;
-    } else {
-        end = tal_system_get_millisecond();
-        elapsed = end - start;
+        return SYS_ARCH_TIMEOUT;
     }
 
-    return elapsed;
+    return 0;
 }
 
 err_t sys_mutex_trylock(sys_mutex_t *pxMutex)
@@ -240,6 +240,254 @@ err_t sys_mutex_trylock(sys_mutex_t *pxMutex)
     return ERR_OK;
 }
 /* ------------------------ Start implementation ( Mailboxes ) ------------ */
+#if LWIP_TUYA_RING_MBOX
+/*
+ * A mailbox is a ring of pointers guarded by a critical section. The
+ * semaphores are only posted when a thread waits on them, so the tcpip thread
+ * takes queued messages without a kernel call while it is busy. A thread that
+ * takes a message or a slot wakes the next waiter if more are left, as the
+ * semaphores count to 1 only.
+ */
+struct sys_ring_mbox {
+    SEM_HANDLE msg_sem;   /* posted for fetchers when a message is put */
+    SEM_HANDLE space_sem; /* posted for posters when a slot is freed */
+    u16_t fetch_wait;     /* threads waiting in fetch */
+    u16_t post_wait;      /* threads waiting in post */
+    u16_t size;
+    u16_t head;
+    u16_t count;
+    void *msg[];
+};
+
+/*
+Creates an empty mailbox.
+*/
+err_t sys_mbox_new(sys_mbox_t *mbox, int size)
+{
+    struct sys_ring_mbox *ring = NULL;
+
+    if (size <= 0 || size > 0xFFFF) {
+        return ERR_VAL;
+    }
+
+    ring = tal_calloc(1, sizeof(struct sys_ring_mbox) + size * sizeof(void *));
+    if (ring == NULL) {
+        SYS_ARCH_DBG("%s: malloc failed\n", __func__);
+        return ERR_MEM;
+    }
+    ring->size = size;
+
+    if (tal_semaphore_create_init(&ring->msg_sem, 0, 1) != ERR_OK ||
+        tal_semaphore_create_init(&ring->space_sem, 0, 1) != ERR_OK) {
+        SYS_ARCH_DBG("%s: call tal_semaphore_create_init failed\n", __func__);
+        sys_mbox_free(&ring);
+        return ERR_MEM;
+    }
+
+    *mbox = ring;
+
+    return ERR_OK;
+}
+
+/*
+Deallocates a mailbox. If there are messages still present in the
+mailbox when the mailbox is deallocated, it is an indication of a
+programming error in lwIP and the developer should be notified.
+*/
+void sys_mbox_free(sys_mbox_t *mbox)
+{
+    struct sys_ring_mbox *ring = *mbox;
+
+    if (ring == NULL) {
+        return;
+    }
+
+    if (ring->msg_sem) {
+        tal_semaphore_release(ring->msg_sem);
+    }
+    if (ring->space_sem) {
+        tal_semaphore_release(ring->space_sem);
+    }
+    tal_free(ring);
+}
+
+/* puts msg if a slot is free, wake tells to post msg_sem */
+static err_t sys_ring_put(struct sys_ring_mbox *ring, void *msg, u8_t *wake)
+{
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    SYS_ARCH_PROTECT(lev);
+    if (ring->count == ring->size) {
+        SYS_ARCH_UNPROTECT(lev);
+        return ERR_MEM;
+    }
+    ring->msg[(ring->head + ring->count) % ring->size] = msg;
+    ring->count++;
+    *wake = (ring->fetch_wait != 0);
+    SYS_ARCH_UNPROTECT(lev);
+
+    return ERR_OK;
+}
+
+/*
+ * This function sends a message to a mailbox. It is unusual in that no error
+ * return is made. This is because the caller is responsible for ensuring that
+ * the mailbox queue will not fail. The caller does this by limiting the number
+ * of msg structures which exist for a given mailbox.
+ */
+void sys_mbox_post(sys_mbox_t *mbox, void *msg)
+{
+    struct sys_ring_mbox *ring = *mbox;
+    u8_t wake = 0;
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    while (sys_ring_put(ring, msg, &wake) != ERR_OK) {
+        SYS_ARCH_PROTECT(lev);
+        ring->post_wait++;
+        /* a slot freed between the put and here is taken on the next put */
+        if (ring->count == ring->size) {
+            SYS_ARCH_UNPROTECT(lev);
+            tal_semaphore_wait(ring->space_sem, TY_LWIP_WAIT_FOREVER);
+            SYS_ARCH_PROTECT(lev);
+        }
+        ring->post_wait--;
+        SYS_ARCH_UNPROTECT(lev);
+    }
+
+    if (wake) {
+        tal_semaphore_post(ring->msg_sem);
+    }
+}
+
+/*
+ * Try to post the "msg" to the mailbox. Returns ERR_MEM if this one is full,
+ * else, ERR_OK if the "msg" is posted.
+ */
+err_t sys_mbox_trypost(sys_mbox_t *mbox, void *msg)
+{
+    u8_t wake = 0;
+
+    if (sys_ring_put(*mbox, msg, &wake) != ERR_OK) {
+        SYS_ARCH_DBG("%s: mbox full\n", __func__);
+        return ERR_MEM;
+    }
+
+    if (wake) {
+        tal_semaphore_post((*mbox)->msg_sem);
+    }
+
+    return ERR_OK;
+}
+
+/* takes the oldest message, registers the caller as a waiter when empty */
+static err_t sys_ring_take(struct sys_ring_mbox *ring, void **msg, u8_t wait)
+{
+    u8_t wake_post = 0, wake_fetch = 0;
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    SYS_ARCH_PROTECT(lev);
+    if (ring->count == 0) {
+        if (wait) {
+            ring->fetch_wait++;
+        }
+        SYS_ARCH_UNPROTECT(lev);
+        return ERR_WOULDBLOCK;
+    }
+    *msg = ring->msg[ring->head];
+    ring->head = (ring->head + 1) % ring->size;
+    ring->count--;
+    wake_post = (ring->post_wait != 0);
+    wake_fetch = (ring->count != 0 && ring->fetch_wait != 0);
+    SYS_ARCH_UNPROTECT(lev);
+
+    if (wake_post) {
+        tal_semaphore_post(ring->space_sem);
+    }
+    if (wake_fetch) {
+        tal_semaphore_post(ring->msg_sem);
+    }
+
+    return ERR_OK;
+}
+
+/*
+ * Blocks the thread until a message arrives in the mailbox, but does
+ * not block the thread longer than "timeout" milliseconds (similar to
+ * the sys_arch_sem_wait() function). The "msg" argument is a result
+ * parameter that is set by the function (i.e., by doing "*msg =
+ * ptr"). The "msg" parameter maybe NULL to indicate that the message
+ * should be dropped. Returns SYS_ARCH_TIMEOUT or zero.
+ *
+ * Note that a function with a similar name, sys_mbox_fetch(), is
+ * implemented by lwIP.
+ */
+u32_t sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, u32_t timeout)
+{
+    struct sys_ring_mbox *ring = *mbox;
+    void *dummyptr;
+    u32_t start = 0, waited = 0;
+    u8_t started = 0;
+    OPERATE_RET rt = OPRT_OK;
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    if (msg == NULL) {
+        msg = &dummyptr;
+    }
+
+    if (ring == NULL) {
+        *msg = NULL;
+        SYS_ARCH_DBG("%s: input invalid params\n", __func__);
+        return ERR_MEM;
+    }
+
+    while (sys_ring_take(ring, msg, 1) != ERR_OK) {
+        /* the clock is read only when the thread has to block */
+        if (timeout && !started) {
+            start = sys_now();
+            started = 1;
+        }
+        rt = tal_semaphore_wait(ring->msg_sem, timeout ? (timeout - waited) : TY_LWIP_WAIT_FOREVER);
+
+        SYS_ARCH_PROTECT(lev);
+        ring->fetch_wait--;
+        SYS_ARCH_UNPROTECT(lev);
+
+        if (timeout) {
+            waited = sys_now() - start;
+            if (rt != OPRT_OK || waited >= timeout) {
+                if (sys_ring_take(ring, msg, 0) == ERR_OK) {
+                    return 0;
+                }
+                *msg = NULL;
+                return SYS_ARCH_TIMEOUT;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * This is similar to sys_arch_mbox_fetch, however if a message is not present
+ * in the mailbox, it immediately returns with the code SYS_MBOX_EMPTY
+ * On success 0 is returned.
+ */
+u32_t sys_arch_mbox_tryfetch(sys_mbox_t *mbox, void **msg)
+{
+    void *pvDummy;
+
+    if (msg == NULL) {
+        msg = &pvDummy;
+    }
+
+    if (sys_ring_take(*mbox, msg, 0) != ERR_OK) {
+        return SYS_MBOX_EMPTY;
+    }
+
+    return ERR_OK;
+}
+
+#else /* LWIP_TUYA_RING_MBOX */
 
 /*
 Creates an empty mailbox.
@@ -259,11 +507,6 @@ err_t sys_mbox_new(sys_mbox_t *mbox, int size)
     return ERR_OK;
 }
 
-void sys_delay_ms(uint32_t ms)
-{
-    tal_system_sleep(ms);
-}
-
 /*
 Deallocates a mailbox. If there are messages still present in the
 mailbox when the mailbox is deallocated, it is an indication of a
@@ -307,7 +550,7 @@ err_t sys_mbox_trypost(sys_mbox_t *mbox, void *msg)
  * the sys_arch_sem_wait() function). The "msg" argument is a result
  * parameter that is set by the function (i.e., by doing "*msg =
  * ptr"). The "msg" parameter maybe NULL to indicate that the message
- * should be dropped.
+ * should be dropped. Returns SYS_ARCH_TIMEOUT or zero.
  *
  * Note that a function with a similar name, sys_mbox_fetch(), is
  * implemented by lwIP.
@@ -315,10 +558,7 @@ err_t sys_mbox_trypost(sys_mbox_t *mbox, void *msg)
 u32_t sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, u32_t timeout)
 {
     void *dummyptr;
-    unsigned int StartTime, EndTime, Elapsed;
-    unsigned long result;
 
-    StartTime = tal_system_get_millisecond();
     if (msg == NULL) {
         msg = &dummyptr;
     }
@@ -330,34 +570,17 @@ u32_t sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, u32_t timeout)
     }
 
     if (timeout) {
-        if (tal_queue_fetch(*mbox, &(*msg), timeout) == ERR_OK) {
-            EndTime = tal_system_get_millisecond();
-            Elapsed = EndTime - StartTime;
-
-            if (Elapsed == 0) {
-                Elapsed = 1;
-            }
-            result = Elapsed;
-        } else {
+        if (tal_queue_fetch(*mbox, &(*msg), timeout) != ERR_OK) {
             *msg = NULL;
-            result = SYS_ARCH_TIMEOUT;
             SYS_ARCH_DBG("%s: mbox fetch wait timeout %d\n", __func__, timeout);
+            return SYS_ARCH_TIMEOUT;
         }
     } else {
-        while(tal_queue_fetch(*mbox, &(*msg), TY_LWIP_WAIT_FOREVER) != ERR_OK);
-		EndTime = tal_system_get_millisecond();
-        Elapsed = EndTime - StartTime;
-
-        if (Elapsed == 0) {
-            Elapsed = 1;
-        }
-        result = Elapsed;
+        while (tal_queue_fetch(*mbox, &(*msg), TY_LWIP_WAIT_FOREVER) != ERR_OK)
+            ;
     }
 
-    // SYS_ARCH_DBG("%s: mobx fetch timeout %d StartTime %d EndTime %d Elapsed
-    // %d\n",
-    //     __func__, timeout, StartTime, EndTime, Elapsed);
-    return result;
+    return 0;
 }
 
 /*
@@ -380,6 +603,12 @@ u32_t sys_arch_mbox_tryfetch(sys_mbox_t *mbox, void **msg)
 
     return ERR_OK;
 }
+#endif /* LWIP_TUYA_RING_MBOX */
+
+void sys_delay_ms(uint32_t ms)
+{
+    tal_system_sleep(ms);
+}
 
 /** Returns the current time in milliseconds. */
 u32_t sys_now(void)
@@ -69,6 +69,8 @@ mqtt_client_status_t mqtt_client_deinit(void *client);
 
 mqtt_client_status_t mqtt_client_connect(void *client);
 
+mqtt_client_status_t mqtt_client_keepalive_set(void *client, uint16_t keepalive);
+
 mqtt_client_status_t mqtt_client_disconnect(void *client);
 
 mqtt_client_status_t mqtt_client_yield(void *client);
@@ -230,6 +230,15 @@ mqtt_client_status_t mqtt_client_connect(void *client)
     return MQTT_STATUS_SUCCESS;
 }
 
+mqtt_client_status_t mqtt_client_keepalive_set(void *client, uint16_t keepalive)
+{
+    mqtt_client_context_t *context = (mqtt_client_context_t *)client;
+
+    /* Sent in the next CONNECT, the broker keeps the old one until then. */
+    context->config.keepalive = keepalive;
+    return MQTT_STATUS_SUCCESS;
+}
+
 mqtt_client_status_t mqtt_client_disconnect(void *client)
 {
     mqtt_client_context_t *context = (mqtt_client_context_t *)client;
@@ -9,6 +9,7 @@ extern "C" {
 #include "mbedtls/platform.h"
 #include "mbedtls/cipher.h"
 #include "mbedtls/md.h"
+#include "mbedtls/gcm.h"
 
 typedef struct {
     unsigned char *key;
@@ -28,6 +29,69 @@ int mbedtls_cipher_auth_encrypt_wrapper(const cipher_params_t *input, unsigned c
 int mbedtls_cipher_auth_decrypt_wrapper(const cipher_params_t *input, unsigned char *output, size_t *olen,
                                         unsigned char *tag, size_t tag_len);
 
+#define CIPHER_GCM_KEY_MAX   32
+#define CIPHER_GCM_NONCE_MAX 16
+
+/**
+ * @brief optional GCM accelerator, mirrors the mbedtls_gcm streaming api.
+ *        a platform with an AES/GHASH engine registers it once at startup,
+ *        every cipher_gcm_ctx_t created afterwards is bound to one handle.
+ *        mode is MBEDTLS_GCM_ENCRYPT or MBEDTLS_GCM_DECRYPT.
+ */
+typedef struct {
+    void *(*create)(void);
+    void (*release)(void *hw);
+    int (*setkey)(void *hw, const unsigned char *key, unsigned int keybits);
+    int (*starts)(void *hw, int mode, const unsigned char *iv, size_t iv_len);
+    int (*update_ad)(void *hw, const unsigned char *ad, size_t ad_len);
+    int (*update)(void *hw, const unsigned char *input, size_t len, unsigned char *output);
+    int (*finish)(void *hw, unsigned char *tag, size_t tag_len);
+} cipher_gcm_accel_t;
+
+/**
+ * @brief persistent GCM context, the key schedule is only rebuilt when the
+ *        key changes and the nonce can be advanced per message.
+ */
+typedef struct {
+    mbedtls_gcm_context gcm;
+    const cipher_gcm_accel_t *accel;
+    void *hw;
+    unsigned char key[CIPHER_GCM_KEY_MAX];
+    size_t key_len;
+    unsigned char nonce[CIPHER_GCM_NONCE_MAX];
+    size_t nonce_len;
+} cipher_gcm_ctx_t;
+
+int cipher_gcm_accel_register(const cipher_gcm_accel_t *accel);
+
+void cipher_gcm_ctx_init(cipher_gcm_ctx_t *ctx);
+
+void cipher_gcm_ctx_free(cipher_gcm_ctx_t *ctx);
+
+int cipher_gcm_ctx_setkey(cipher_gcm_ctx_t *ctx, const unsigned char *key, size_t key_len);
+
+int cipher_gcm_ctx_starts(cipher_gcm_ctx_t *ctx, int mode, const unsigned char *iv, size_t iv_len);
+
+int cipher_gcm_ctx_update_ad(cipher_gcm_ctx_t *ctx, const unsigned char *ad, size_t ad_len);
+
+int cipher_gcm_ctx_update(cipher_gcm_ctx_t *ctx, const unsigned char *input, size_t len, unsigned char *output);
+
+int cipher_gcm_ctx_finish(cipher_gcm_ctx_t *ctx, unsigned char *tag, size_t tag_len);
+
+int cipher_gcm_ctx_auth_encrypt(cipher_gcm_ctx_t *ctx, const unsigned char *nonce, size_t nonce_len,
+                                const unsigned char *ad, size_t ad_len, const unsigned char *input, size_t len,
+                                unsigned char *output, unsigned char *tag, size_t tag_len);
+
+int cipher_gcm_ctx_auth_decrypt(cipher_gcm_ctx_t *ctx, const unsigned char *nonce, size_t nonce_len,
+                                const unsigned char *ad, size_t ad_len, const unsigned char *input, size_t len,
+                                unsigned char *output, const unsigned char *tag, size_t tag_len);
+
+int cipher_gcm_ctx_nonce_seed(cipher_gcm_ctx_t *ctx, const unsigned char *nonce, size_t nonce_len);
+
+int cipher_gcm_ctx_nonce_next(cipher_gcm_ctx_t *ctx, unsigned char *nonce);
+
+void cipher_gcm_nonce_increment(unsigned char *nonce, size_t nonce_len);
+
 int mbedtls_message_digest(mbedtls_md_type_t md_type, const uint8_t *input, size_t ilen, uint8_t *digest);
 
 int mbedtls_message_digest_hmac(mbedtls_md_type_t md_type, const uint8_t *key, size_t keylen, const uint8_t *input,
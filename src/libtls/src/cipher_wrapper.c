@@ -2,6 +2,7 @@
 #include "cipher_wrapper.h"
 #include "tal_log.h"
 #include "tal_memory.h"
+#include "mbedtls/platform_util.h"
 
 int mbedtls_cipher_auth_encrypt_wrapper(const cipher_params_t *input, unsigned char *output, size_t *olen,
                                         unsigned char *tag, size_t tag_len)
@@ -186,4 +187,219 @@ int mbedtls_message_digest_hmac(mbedtls_md_type_t md_type, const uint8_t *key, s
 exit:
     mbedtls_md_free(&md_ctx);
     return ret;
-}
\ No newline at end of file
+}
+static const cipher_gcm_accel_t *s_gcm_accel = NULL;
+
+int cipher_gcm_accel_register(const cipher_gcm_accel_t *accel)
+{
+    if (accel && (accel->create == NULL || accel->setkey == NULL || accel->starts == NULL ||
+                  accel->update == NULL || accel->finish == NULL)) {
+        return OPRT_INVALID_PARM;
+    }
+
+    s_gcm_accel = accel;
+    return OPRT_OK;
+}
+
+void cipher_gcm_ctx_init(cipher_gcm_ctx_t *ctx)
+{
+    if (ctx == NULL) {
+        return;
+    }
+
+    memset(ctx, 0, sizeof(cipher_gcm_ctx_t));
+    mbedtls_gcm_init(&ctx->gcm);
+    if (s_gcm_accel) {
+        ctx->hw = s_gcm_accel->create();
+        if (ctx->hw) {
+            ctx->accel = s_gcm_accel;
+        }
+    }
+}
+
+void cipher_gcm_ctx_free(cipher_gcm_ctx_t *ctx)
+{
+    if (ctx == NULL) {
+        return;
+    }
+
+    if (ctx->accel && ctx->hw && ctx->accel->release) {
+        ctx->accel->release(ctx->hw);
+    }
+    mbedtls_gcm_free(&ctx->gcm);
+    mbedtls_platform_zeroize(ctx, sizeof(cipher_gcm_ctx_t));
+}
+
+int cipher_gcm_ctx_setkey(cipher_gcm_ctx_t *ctx, const unsigned char *key, size_t key_len)
+{
+    if (ctx == NULL || key == NULL || key_len == 0 || key_len > CIPHER_GCM_KEY_MAX) {
+        return OPRT_INVALID_PARM;
+    }
+
+    // the AES key schedule and GHASH table are kept until the key changes
+    if (ctx->key_len == key_len && memcmp(ctx->key, key, key_len) == 0) {
+        return OPRT_OK;
+    }
+
+    int ret;
+    if (ctx->accel) {
+        ret = ctx->accel->setkey(ctx->hw, key, key_len * 8);
+    } else {
+        ret = mbedtls_gcm_setkey(&ctx->gcm, MBEDTLS_CIPHER_ID_AES, key, key_len * 8);
+    }
+    if (ret != 0) {
+        PR_ERR("gcm setkey error:-0x%04x", -ret);
+        ctx->key_len = 0;
+        return ret;
+    }
+
+    memcpy(ctx->key, key, key_len);
+    ctx->key_len = key_len;
+    return OPRT_OK;
+}
+
+int cipher_gcm_ctx_starts(cipher_gcm_ctx_t *ctx, int mode, const unsigned char *iv, size_t iv_len)
+{
+    if (ctx == NULL || ctx->key_len == 0 || iv == NULL) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (ctx->accel) {
+        return ctx->accel->starts(ctx->hw, mode, iv, iv_len);
+    }
+    return mbedtls_gcm_starts(&ctx->gcm, mode, iv, iv_len);
+}
+
+int cipher_gcm_ctx_update_ad(cipher_gcm_ctx_t *ctx, const unsigned char *ad, size_t ad_len)
+{
+    if (ctx == NULL) {
+        return OPRT_INVALID_PARM;
+    }
+    if (ad == NULL || ad_len == 0) {
+        return OPRT_OK;
+    }
+
+    if (ctx->accel) {
+        return ctx->accel->update_ad ? ctx->accel->update_ad(ctx->hw, ad, ad_len) : OPRT_NOT_SUPPORTED;
+    }
+    return mbedtls_gcm_update_ad(&ctx->gcm, ad, ad_len);
+}
+
+int cipher_gcm_ctx_update(cipher_gcm_ctx_t *ctx, const unsigned char *input, size_t len, unsigned char *output)
+{
+    if (ctx == NULL) {
+        return OPRT_INVALID_PARM;
+    }
+    if (len == 0) {
+        return OPRT_OK;
+    }
+
+    if (ctx->accel) {
+        return ctx->accel->update(ctx->hw, input, len, output);
+    }
+
+    size_t olen = 0;
+    return mbedtls_gcm_update(&ctx->gcm, input, len, output, len, &olen);
+}
+
+int cipher_gcm_ctx_finish(cipher_gcm_ctx_t *ctx, unsigned char *tag, size_t tag_len)
+{
+    if (ctx == NULL || tag == NULL) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (ctx->accel) {
+        return ctx->accel->finish(ctx->hw, tag, tag_len);
+    }
+
+    size_t olen = 0;
+    return mbedtls_gcm_finish(&ctx->gcm, NULL, 0, &olen, tag, tag_len);
+}
+
+int cipher_gcm_ctx_auth_encrypt(cipher_gcm_ctx_t *ctx, const unsigned char *nonce, size_t nonce_len,
+                                const unsigned char *ad, size_t ad_len, const unsigned char *input, size_t len,
+                                unsigned char *output, unsigned char *tag, size_t tag_len)
+{
+    int ret = cipher_gcm_ctx_starts(ctx, MBEDTLS_GCM_ENCRYPT, nonce, nonce_len);
+    if (ret == 0) {
+        ret = cipher_gcm_ctx_update_ad(ctx, ad, ad_len);
+    }
+    if (ret == 0) {
+        ret = cipher_gcm_ctx_update(ctx, input, len, output);
+    }
+    if (ret == 0) {
+        ret = cipher_gcm_ctx_finish(ctx, tag, tag_len);
+    }
+
+    return ret;
+}
+
+int cipher_gcm_ctx_auth_decrypt(cipher_gcm_ctx_t *ctx, const unsigned char *nonce, size_t nonce_len,
+                                const unsigned char *ad, size_t ad_len, const unsigned char *input, size_t len,
+                                unsigned char *output, const unsigned char *tag, size_t tag_len)
+{
+    if (tag == NULL || tag_len == 0 || tag_len > 16) {
+        return OPRT_INVALID_PARM;
+    }
+
+    unsigned char calc_tag[16];
+    int ret = cipher_gcm_ctx_starts(ctx, MBEDTLS_GCM_DECRYPT, nonce, nonce_len);
+    if (ret == 0) {
+        ret = cipher_gcm_ctx_update_ad(ctx, ad, ad_len);
+    }
+    if (ret == 0) {
+        ret = cipher_gcm_ctx_update(ctx, input, len, output);
+    }
+    if (ret == 0) {
+        ret = cipher_gcm_ctx_finish(ctx, calc_tag, tag_len);
+    }
+    if (ret != 0) {
+        return ret;
+    }
+
+    // constant time tag compare
+    size_t i;
+    unsigned char diff = 0;
+    for (i = 0; i < tag_len; i++) {
+        diff |= tag[i] ^ calc_tag[i];
+    }
+    if (diff != 0) {
+        mbedtls_platform_zeroize(output, len);
+        return MBEDTLS_ERR_GCM_AUTH_FAILED;
+    }
+
+    return OPRT_OK;
+}
+
+int cipher_gcm_ctx_nonce_seed(cipher_gcm_ctx_t *ctx, const unsigned char *nonce, size_t nonce_len)
+{
+    if (ctx == NULL || nonce == NULL || nonce_len == 0 || nonce_len > CIPHER_GCM_NONCE_MAX) {
+        return OPRT_INVALID_PARM;
+    }
+
+    memcpy(ctx->nonce, nonce, nonce_len);
+    ctx->nonce_len = nonce_len;
+    return OPRT_OK;
+}
+
+int cipher_gcm_ctx_nonce_next(cipher_gcm_ctx_t *ctx, unsigned char *nonce)
+{
+    if (ctx == NULL || nonce == NULL || ctx->nonce_len == 0) {
+        return OPRT_INVALID_PARM;
+    }
+
+    memcpy(nonce, ctx->nonce, ctx->nonce_len);
+    cipher_gcm_nonce_increment(ctx->nonce, ctx->nonce_len);
+    return OPRT_OK;
+}
+
+void cipher_gcm_nonce_increment(unsigned char *nonce, size_t nonce_len)
+{
+    // big endian counter over the whole nonce
+    while (nonce_len > 0) {
+        nonce_len--;
+        if (++nonce[nonce_len] != 0) {
+            break;
+        }
+    }
+}
@@ -10,6 +10,7 @@
 #include "tal_system.h"
 #include "tal_thread.h"
 #include "tal_uart.h"
+#include "tal_memory.h"
 
 /* MicroPython includes */
 #include "py/compile.h"
@@ -21,6 +22,7 @@
 #include "py/nlr.h"
 #include "py/lexer.h"
 #include "py/parse.h"
+#include "py/frozenmod.h"
 #include "shared/runtime/pyexec.h"
 
 #ifdef ENABLE_MICROPYTHON
@@ -32,14 +34,19 @@ extern TUYA_UART_NUM_E sg_repl_uart_num;
 #define MP_TASK_PRIORITY    5
 #define MP_TASK_STACK_SIZE  (8 * 1024)
 
-/* MicroPython heap configuration */
-#define MP_HEAP_SIZE        (32 * 1024)  /* 32KB heap for MicroPython GC */
+/* Frozen module run at boot instead of the built-in test string */
+#define MP_FROZEN_MAIN      "main.py"
 
 /* MicroPython main task handle */
 static THREAD_HANDLE sg_mp_thread = NULL;
 
-/* Static heap for MicroPython GC */
-static char mp_heap[MP_HEAP_SIZE] __attribute__((aligned(4)));
+/* Static heap for MicroPython GC, see the heap profile in mpconfigport.h */
+static char mp_heap[MICROPY_HEAP_SIZE] __attribute__((aligned(4)));
+
+#if MICROPY_GC_SPLIT_HEAP
+/* PSRAM heap area, allocated once and kept across restarts */
+static char *sg_mp_psram_heap = NULL;
+#endif
 
 /**
  * @brief Execute a Python string
@@ -86,16 +93,37 @@ static void micropython_task(void *arg)
     mp_stack_set_limit(MP_TASK_STACK_SIZE - 1024);
 
     /* Initialize MicroPython heap and GC */
-    gc_init(mp_heap, mp_heap + MP_HEAP_SIZE);
+    gc_init(mp_heap, mp_heap + MICROPY_HEAP_SIZE);
+#if MICROPY_GC_SPLIT_HEAP
+    if (NULL == sg_mp_psram_heap) {
+        sg_mp_psram_heap = tal_psram_malloc(MICROPY_HEAP_PSRAM_SIZE);
+    }
+    if (sg_mp_psram_heap) {
+        gc_add(sg_mp_psram_heap, sg_mp_psram_heap + MICROPY_HEAP_PSRAM_SIZE);
+    } else {
+        PR_WARN("No PSRAM for the MicroPython heap");
+    }
+#endif
+#if MICROPY_GC_ALLOC_THRESHOLD
+    MP_STATE_MEM(gc_alloc_threshold) = MICROPY_GC_THRESHOLD_BYTES / MICROPY_BYTES_PER_GC_BLOCK;
+#endif
 
     /* Initialize MicroPython runtime */
     mp_init();
 
-    PR_NOTICE("MicroPython initialized, heap size: %d bytes", MP_HEAP_SIZE);
-
-    /* Test basic Python execution */
-    PR_NOTICE("Testing Python execution...");
-    do_str("print('do_str() -> Hello from MicroPython on T5AI!')");
+    PR_NOTICE("MicroPython initialized, heap size: %d bytes", MICROPY_HEAP_SIZE);
+
+#if MICROPY_MODULE_FROZEN
+    /* Frozen bytecode runs in place from flash, nothing is compiled at boot */
+    if (MP_IMPORT_STAT_FILE == mp_find_frozen_module(MP_FROZEN_MAIN, NULL, NULL)) {
+        pyexec_frozen_module(MP_FROZEN_MAIN, true);
+    } else
+#endif
+    {
+        /* Test basic Python execution */
+        PR_NOTICE("Testing Python execution...");
+        do_str("print('do_str() -> Hello from MicroPython on T5AI!')");
+    }
 
     /* Initialize REPL */
     PR_NOTICE("Starting MicroPython REPL...");
@@ -0,0 +1,844 @@
+/*
+ * Native TDL bindings for T5AI
+ *
+ * Module "tdl" gives Python the display, camera and audio devices of the TDL
+ * layers without copying pixel or sample data through the VM:
+ *
+ *   FrameBuffer  pixels in tdl_disp_create_frame_buff() memory (PSRAM by
+ *                default), drawn by the tdl_disp_draw_* kernels in C. It has
+ *                the buffer protocol, so bytes(fb), fb[...] style access and a
+ *                framebuf.FrameBuffer built on it share the same memory.
+ *   Display      tdl_disp device, flushes a FrameBuffer.
+ *   Camera       keeps the newest tdl_camera frame retained, frame() hands it
+ *                to Python as a read only buffer until release().
+ *   Audio        tdl_audio device, play() passes the Python buffer straight to
+ *                the driver, the mic is read from a ring buffer.
+ *
+ * The port has no finaliser, so FrameBuffer.deinit(), Frame.release() and the
+ * close/stop methods must be called, the memory is outside the GC heap.
+ */
+
+#include <string.h>
+
+#include "py/runtime.h"
+#include "py/obj.h"
+
+#include "tal_api.h"
+
+#if MICROPY_PY_TDL
+
+#if defined(ENABLE_DISPLAY) && (ENABLE_DISPLAY == 1)
+#include "tdl_display_manage.h"
+#include "tdl_display_draw.h"
+#endif
+#if defined(ENABLE_CAMERA) && (ENABLE_CAMERA == 1)
+#include "tdl_camera_manage.h"
+#endif
+#if defined(ENABLE_AUDIO_CODECS) && (ENABLE_AUDIO_CODECS == 1)
+#include "tdl_audio_manage.h"
+#include "tuya_ringbuf.h"
+#endif
+
+/* Mic samples kept for Audio.readinto(), the oldest are overwritten */
+#ifndef MP_TDL_MIC_BUF_SIZE
+#define MP_TDL_MIC_BUF_SIZE (16 * 1024)
+#endif
+
+static void tdl_check(OPERATE_RET rt)
+{
+    if (OPRT_OK != rt) {
+        mp_raise_OSError(rt);
+    }
+}
+
+/*
+ * Display
+ */
+#if defined(ENABLE_DISPLAY) && (ENABLE_DISPLAY == 1)
+
+/* Glyphs 0x20..0x7f of the unscii-8 font (public domain), one byte per row,
+ * bit 0 is the leftmost pixel */
+static const uint8_t tdl_font_8x8[96][8] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // space
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x18, 0x00}, // !
+    {0x66, 0x66, 0x66, 0x00, 0x00, 0x00, 0x00, 0x00}, // "
+    {0x36, 0x36, 0x7f, 0x36, 0x7f, 0x36, 0x36, 0x00}, // #
+    {0x18, 0x7c, 0x06, 0x3c, 0x60, 0x3e, 0x18, 0x00}, // $
+    {0x00, 0x63, 0x33, 0x18, 0x0c, 0x66, 0x63, 0x00}, // %
+    {0x1c, 0x36, 0x1c, 0x6e, 0x3b, 0x33, 0x6e, 0x00}, // &
+    {0x18, 0x18, 0x0c, 0x00, 0x00, 0x00, 0x00, 0x00}, // '
+    {0x30, 0x18, 0x0c, 0x0c, 0x0c, 0x18, 0x30, 0x00}, // (
+    {0x0c, 0x18, 0x30, 0x30, 0x30, 0x18, 0x0c, 0x00}, // )
+    {0x00, 0x66, 0x3c, 0xff, 0x3c, 0x66, 0x00, 0x00}, // *
+    {0x00, 0x18, 0x18, 0x7e, 0x18, 0x18, 0x00, 0x00}, // +
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x0c}, // ,
+    {0x00, 0x00, 0x00, 0x7e, 0x00, 0x00, 0x00, 0x00}, // -
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x00}, // .
+    {0xc0, 0x60, 0x30, 0x18, 0x0c, 0x06, 0x03, 0x00}, // /
+    {0x3c, 0x66, 0x76, 0x6e, 0x66, 0x66, 0x3c, 0x00}, // 0
+    {0x18, 0x1c, 0x18, 0x18, 0x18, 0x18, 0x7e, 0x00}, // 1
+    {0x3c, 0x66, 0x30, 0x18, 0x0c, 0x06, 0x7e, 0x00}, // 2
+    {0x3c, 0x66, 0x60, 0x38, 0x60, 0x66, 0x3c, 0x00}, // 3
+    {0x38, 0x3c, 0x36, 0x33, 0x7f, 0x30, 0x30, 0x00}, // 4
+    {0x7e, 0x06, 0x3e, 0x60, 0x60, 0x66, 0x3c, 0x00}, // 5
+    {0x38, 0x0c, 0x06, 0x3e, 0x66, 0x66, 0x3c, 0x00}, // 6
+    {0x7e, 0x60, 0x60, 0x30, 0x18, 0x18, 0x18, 0x00}, // 7
+    {0x3c, 0x66, 0x66, 0x3c, 0x66, 0x66, 0x3c, 0x00}, // 8
+    {0x3c, 0x66, 0x66, 0x7c, 0x60, 0x30, 0x1c, 0x00}, // 9
+    {0x00, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x00}, // :
+    {0x00, 0x18, 0x18, 0x00, 0x00, 0x18, 0x18, 0x0c}, // ;
+    {0x30, 0x18, 0x0c, 0x06, 0x0c, 0x18, 0x30, 0x00}, // <
+    {0x00, 0x00, 0x7e, 0x00, 0x7e, 0x00, 0x00, 0x00}, // =
+    {0x06, 0x0c, 0x18, 0x30, 0x18, 0x0c, 0x06, 0x00}, // >
+    {0x3c, 0x66, 0x60, 0x30, 0x18, 0x00, 0x18, 0x00}, // ?
+    {0x3e, 0x63, 0x7b, 0x7b, 0x7b, 0x03, 0x3e, 0x00}, // @
+    {0x18, 0x3c, 0x66, 0x66, 0x7e, 0x66, 0x66, 0x00}, // A
+    {0x3e, 0x66, 0x66, 0x3e, 0x66, 0x66, 0x3e, 0x00}, // B
+    {0x3c, 0x66, 0x06, 0x06, 0x06, 0x66, 0x3c, 0x00}, // C
+    {0x1e, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1e, 0x00}, // D
+    {0x7e, 0x06, 0x06, 0x3e, 0x06, 0x06, 0x7e, 0x00}, // E
+    {0x7e, 0x06, 0x06, 0x3e, 0x06, 0x06, 0x06, 0x00}, // F
+    {0x3c, 0x66, 0x06, 0x76, 0x66, 0x66, 0x7c, 0x00}, // G
+    {0x66, 0x66, 0x66, 0x7e, 0x66, 0x66, 0x66, 0x00}, // H
+    {0x7e, 0x18, 0x18, 0x18, 0x18, 0x18, 0x7e, 0x00}, // I
+    {0x60, 0x60, 0x60, 0x60, 0x60, 0x66, 0x3c, 0x00}, // J
+    {0x63, 0x33, 0x1b, 0x0f, 0x1b, 0x33, 0x63, 0x00}, // K
+    {0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x7e, 0x00}, // L
+    {0x63, 0x77, 0x7f, 0x6b, 0x63, 0x63, 0x63, 0x00}, // M
+    {0x63, 0x67, 0x6f, 0x7b, 0x73, 0x63, 0x63, 0x00}, // N
+    {0x3c, 0x66, 0x66, 0x66, 0x66, 0x66, 0x3c, 0x00}, // O
+    {0x3e, 0x66, 0x66, 0x3e, 0x06, 0x06, 0x06, 0x00}, // P
+    {0x3c, 0x66, 0x66, 0x66, 0x66, 0x36, 0x6c, 0x00}, // Q
+    {0x3e, 0x66, 0x66, 0x3e, 0x36, 0x66, 0x66, 0x00}, // R
+    {0x3c, 0x66, 0x06, 0x3c, 0x60, 0x66, 0x3c, 0x00}, // S
+    {0x7e, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00}, // T
+    {0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x3c, 0x00}, // U
+    {0x66, 0x66, 0x66, 0x66, 0x66, 0x3c, 0x18, 0x00}, // V
+    {0x63, 0x63, 0x63, 0x6b, 0x7f, 0x77, 0x63, 0x00}, // W
+    {0xc3, 0x66, 0x3c, 0x18, 0x3c, 0x66, 0xc3, 0x00}, // X
+    {0xc3, 0x66, 0x3c, 0x18, 0x18, 0x18, 0x18, 0x00}, // Y
+    {0x7e, 0x60, 0x30, 0x18, 0x0c, 0x06, 0x7e, 0x00}, // Z
+    {0x3c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x3c, 0x00}, // [
+    {0x03, 0x06, 0x0c, 0x18, 0x30, 0x60, 0xc0, 0x00}, // backslash
+    {0x3c, 0x30, 0x30, 0x30, 0x30, 0x30, 0x3c, 0x00}, // ]
+    {0x08, 0x1c, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00}, // ^
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff}, // _
+    {0x18, 0x30, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00}, // `
+    {0x00, 0x00, 0x3c, 0x60, 0x7c, 0x66, 0x7c, 0x00}, // a
+    {0x06, 0x06, 0x3e, 0x66, 0x66, 0x66, 0x3e, 0x00}, // b
+    {0x00, 0x00, 0x3c, 0x06, 0x06, 0x06, 0x3c, 0x00}, // c
+    {0x60, 0x60, 0x7c, 0x66, 0x66, 0x66, 0x7c, 0x00}, // d
+    {0x00, 0x00, 0x3c, 0x66, 0x7e, 0x06, 0x3c, 0x00}, // e
+    {0x38, 0x0c, 0x3e, 0x0c, 0x0c, 0x0c, 0x0c, 0x00}, // f
+    {0x00, 0x00, 0x7c, 0x66, 0x66, 0x7c, 0x60, 0x3e}, // g
+    {0x06, 0x06, 0x3e, 0x66, 0x66, 0x66, 0x66, 0x00}, // h
+    {0x18, 0x00, 0x1c, 0x18, 0x18, 0x18, 0x78, 0x00}, // i
+    {0x30, 0x00, 0x30, 0x30, 0x30, 0x30, 0x30, 0x1e}, // j
+    {0x06, 0x06, 0x66, 0x36, 0x1e, 0x36, 0x66, 0x00}, // k
+    {0x1c, 0x18, 0x18, 0x18, 0x18, 0x18, 0x78, 0x00}, // l
+    {0x00, 0x00, 0x33, 0x7f, 0x6b, 0x6b, 0x63, 0x00}, // m
+    {0x00, 0x00, 0x3e, 0x66, 0x66, 0x66, 0x66, 0x00}, // n
+    {0x00, 0x00, 0x3c, 0x66, 0x66, 0x66, 0x3c, 0x00}, // o
+    {0x00, 0x00, 0x3e, 0x66, 0x66, 0x3e, 0x06, 0x06}, // p
+    {0x00, 0x00, 0x7c, 0x66, 0x66, 0x7c, 0x60, 0x60}, // q
+    {0x00, 0x00, 0x3e, 0x66, 0x06, 0x06, 0x06, 0x00}, // r
+    {0x00, 0x00, 0x7c, 0x06, 0x3c, 0x60, 0x3e, 0x00}, // s
+    {0x0c, 0x0c, 0x7e, 0x0c, 0x0c, 0x0c, 0x78, 0x00}, // t
+    {0x00, 0x00, 0x66, 0x66, 0x66, 0x66, 0x7c, 0x00}, // u
+    {0x00, 0x00, 0x66, 0x66, 0x66, 0x3c, 0x18, 0x00}, // v
+    {0x00, 0x00, 0x63, 0x63, 0x6b, 0x3e, 0x36, 0x00}, // w
+    {0x00, 0x00, 0x63, 0x36, 0x1c, 0x36, 0x63, 0x00}, // x
+    {0x00, 0x00, 0x66, 0x66, 0x66, 0x7c, 0x60, 0x3c}, // y
+    {0x00, 0x00, 0x7e, 0x30, 0x18, 0x0c, 0x7e, 0x00}, // z
+    {0x70, 0x18, 0x18, 0x0e, 0x18, 0x18, 0x70, 0x00}, // {
+    {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00}, // |
+    {0x0e, 0x18, 0x18, 0x70, 0x18, 0x18, 0x0e, 0x00}, // }
+    {0x6e, 0x3b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // ~
+    {0x03, 0x05, 0x75, 0x25, 0x23, 0x20, 0x20, 0x00}, // 0x7f
+};
+
+typedef struct {
+    mp_obj_base_t base;
+    TDL_DISP_FRAME_BUFF_T *fb;
+    bool is_swap;
+} tdl_fb_obj_t;
+
+typedef struct {
+    mp_obj_base_t base;
+    TDL_DISP_HANDLE_T hdl;
+    TDL_DISP_DEV_INFO_T info;
+} tdl_disp_obj_t;
+
+static const mp_obj_type_t tdl_fb_type;
+
+static tdl_fb_obj_t *tdl_fb_new(TUYA_DISPLAY_PIXEL_FMT_E fmt, mp_int_t width, mp_int_t height, bool psram,
+                                bool is_swap)
+{
+    uint32_t bits = (uint32_t)width * tdl_disp_get_fmt_bpp(fmt);
+
+    /* the packed formats have no row padding */
+    if (width <= 0 || height <= 0 || width > 0xFFFF || height > 0xFFFF || 0 == bits || bits % 8) {
+        mp_raise_ValueError(MP_ERROR_TEXT("bad size or format"));
+    }
+
+    TDL_DISP_FRAME_BUFF_T *fb = tdl_disp_create_frame_buff(psram ? DISP_FB_TP_PSRAM : DISP_FB_TP_SRAM,
+                                                           bits / 8 * height);
+    if (NULL == fb) {
+        mp_raise_OSError(OPRT_MALLOC_FAILED);
+    }
+    fb->fmt = fmt;
+    fb->width = width;
+    fb->height = height;
+
+    tdl_fb_obj_t *self = mp_obj_malloc(tdl_fb_obj_t, &tdl_fb_type);
+    self->fb = fb;
+    self->is_swap = is_swap;
+    return self;
+}
+
+static tdl_fb_obj_t *tdl_fb_get(mp_obj_t obj)
+{
+    if (!mp_obj_is_type(obj, &tdl_fb_type)) {
+        mp_raise_TypeError(MP_ERROR_TEXT("FrameBuffer expected"));
+    }
+    tdl_fb_obj_t *self = MP_OBJ_TO_PTR(obj);
+    if (NULL == self->fb) {
+        mp_raise_ValueError(MP_ERROR_TEXT("FrameBuffer deinited"));
+    }
+    return self;
+}
+
+/* Clips a rect to the frame buffer, false when nothing is left */
+static bool tdl_fb_clip(TDL_DISP_FRAME_BUFF_T *fb, mp_int_t x, mp_int_t y, mp_int_t w, mp_int_t h,
+                        TDL_DISP_RECT_T *rect)
+{
+    mp_int_t x1 = x + w - 1, y1 = y + h - 1;
+
+    x = MAX(x, 0);
+    y = MAX(y, 0);
+    x1 = MIN(x1, (mp_int_t)fb->width - 1);
+    y1 = MIN(y1, (mp_int_t)fb->height - 1);
+    if (w <= 0 || h <= 0 || x > x1 || y > y1) {
+        return false;
+    }
+    rect->x0 = x + fb->x_start;
+    rect->y0 = y + fb->y_start;
+    rect->x1 = x1 + fb->x_start;
+    rect->y1 = y1 + fb->y_start;
+    return true;
+}
+
+static void tdl_fb_fill_clip(tdl_fb_obj_t *self, mp_int_t x, mp_int_t y, mp_int_t w, mp_int_t h, uint32_t color)
+{
+    TDL_DISP_RECT_T rect;
+
+    if (tdl_fb_clip(self->fb, x, y, w, h, &rect)) {
+        tdl_disp_draw_fill(self->fb, &rect, color, self->is_swap);
+    }
+}
+
+/* FrameBuffer(width, height, fmt=RGB565, psram=True, swap=False) */
+static mp_obj_t tdl_fb_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args)
+{
+    enum { ARG_width, ARG_height, ARG_fmt, ARG_psram, ARG_swap };
+    static const mp_arg_t allowed_args[] = {
+        {MP_QSTR_width, MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = 0}},
+        {MP_QSTR_height, MP_ARG_REQUIRED | MP_ARG_INT, {.u_int = 0}},
+        {MP_QSTR_fmt, MP_ARG_INT, {.u_int = TUYA_PIXEL_FMT_RGB565}},
+        {MP_QSTR_psram, MP_ARG_BOOL, {.u_bool = true}},
+        {MP_QSTR_swap, MP_ARG_BOOL, {.u_bool = false}},
+    };
+    mp_arg_val_t vals[MP_ARRAY_SIZE(allowed_args)];
+
+    mp_arg_parse_all_kw_array(n_args, n_kw, args, MP_ARRAY_SIZE(allowed_args), allowed_args, vals);
+    return MP_OBJ_FROM_PTR(tdl_fb_new(vals[ARG_fmt].u_int, vals[ARG_width].u_int, vals[ARG_height].u_int,
+                                      vals[ARG_psram].u_bool, vals[ARG_swap].u_bool));
+}
+
+static mp_int_t tdl_fb_get_buffer(mp_obj_t self_in, mp_buffer_info_t *bufinfo, mp_uint_t flags)
+{
+    tdl_fb_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    if (NULL == self->fb) {
+        return 1;
+    }
+    bufinfo->buf = self->fb->frame;
+    bufinfo->len = self->fb->len;
+    bufinfo->typecode = 'B';
+    return 0;
+}
+
+static void tdl_fb_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest)
+{
+    tdl_fb_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    if (MP_OBJ_NULL != dest[0] || NULL == self->fb) {
+        dest[1] = MP_OBJ_SENTINEL;
+        return;
+    }
+    switch (attr) {
+    case MP_QSTR_width:
+        dest[0] = MP_OBJ_NEW_SMALL_INT(self->fb->width);
+        break;
+    case MP_QSTR_height:
+        dest[0] = MP_OBJ_NEW_SMALL_INT(self->fb->height);
+        break;
+    case MP_QSTR_fmt:
+        dest[0] = MP_OBJ_NEW_SMALL_INT(self->fb->fmt);
+        break;
+    default:
+        dest[1] = MP_OBJ_SENTINEL;
+        break;
+    }
+}
+
+/* fb.deinit(), frees the pixels */
+static mp_obj_t tdl_fb_deinit(mp_obj_t self_in)
+{
+    tdl_fb_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    if (self->fb) {
+        tdl_disp_free_frame_buff(self->fb);
+        self->fb = NULL;
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(tdl_fb_deinit_obj, tdl_fb_deinit);
+
+/* fb.fill(color) */
+static mp_obj_t tdl_fb_fill(mp_obj_t self_in, mp_obj_t color)
+{
+    tdl_fb_obj_t *self = tdl_fb_get(self_in);
+
+    tdl_disp_draw_fill_full(self->fb, mp_obj_get_int_truncated(color), self->is_swap);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(tdl_fb_fill_obj, tdl_fb_fill);
+
+/* fb.fill_rect(x, y, w, h, color), clipped */
+static mp_obj_t tdl_fb_fill_rect(size_t n_args, const mp_obj_t *args)
+{
+    tdl_fb_obj_t *self = tdl_fb_get(args[0]);
+
+    tdl_fb_fill_clip(self, mp_obj_get_int(args[1]), mp_obj_get_int(args[2]), mp_obj_get_int(args[3]),
+                     mp_obj_get_int(args[4]), mp_obj_get_int_truncated(args[5]));
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(tdl_fb_fill_rect_obj, 6, 6, tdl_fb_fill_rect);
+
+/* fb.pixel(x, y, color), points outside are ignored */
+static mp_obj_t tdl_fb_pixel(size_t n_args, const mp_obj_t *args)
+{
+    tdl_fb_obj_t *self = tdl_fb_get(args[0]);
+    mp_int_t x = mp_obj_get_int(args[1]), y = mp_obj_get_int(args[2]);
+
+    if (x >= 0 && y >= 0 && x < self->fb->width && y < self->fb->height) {
+        tdl_disp_draw_point(self->fb, x + self->fb->x_start, y + self->fb->y_start,
+                            mp_obj_get_int_truncated(args[3]), self->is_swap);
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(tdl_fb_pixel_obj, 4, 4, tdl_fb_pixel);
+
+/* fb.blit(src, x, y), src is clipped to this buffer, formats must match */
+static mp_obj_t tdl_fb_blit(size_t n_args, const mp_obj_t *args)
+{
+    tdl_fb_obj_t *self = tdl_fb_get(args[0]);
+    tdl_fb_obj_t *src = tdl_fb_get(args[1]);
+    mp_int_t x = mp_obj_get_int(args[2]), y = mp_obj_get_int(args[3]);
+    TDL_DISP_RECT_T dst_rect, src_rect;
+
+    if (!tdl_fb_clip(self->fb, x, y, src->fb->width, src->fb->height, &dst_rect)) {
+        return mp_const_none;
+    }
+    src_rect.x0 = src->fb->x_start + (dst_rect.x0 - self->fb->x_start - x);
+    src_rect.y0 = src->fb->y_start + (dst_rect.y0 - self->fb->y_start - y);
+    src_rect.x1 = src_rect.x0 + (dst_rect.x1 - dst_rect.x0);
+    src_rect.y1 = src_rect.y0 + (dst_rect.y1 - dst_rect.y0);
+    tdl_check(tdl_disp_draw_blit(self->fb, dst_rect.x0, dst_rect.y0, src->fb, &src_rect));
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(tdl_fb_blit_obj, 4, 4, tdl_fb_blit);
+
+/*
+ * fb.text(s, x, y, color, bg=None, scale=1), 8x8 cells
+ *
+ * Every glyph row is filled as runs of equal bits, a clear run is only drawn
+ * when bg is given.
+ */
+static mp_obj_t tdl_fb_text(size_t n_args, const mp_obj_t *args)
+{
+    tdl_fb_obj_t *self = tdl_fb_get(args[0]);
+    const char *str = mp_obj_str_get_str(args[1]);
+    mp_int_t x = mp_obj_get_int(args[2]), y = mp_obj_get_int(args[3]);
+    uint32_t fg = mp_obj_get_int_truncated(args[4]), bg = 0;
+    bool has_bg = n_args > 5 && mp_const_none != args[5];
+    mp_int_t scale = n_args > 6 ? mp_obj_get_int(args[6]) : 1;
+
+    if (has_bg) {
+        bg = mp_obj_get_int_truncated(args[5]);
+    }
+    if (scale <= 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("bad scale"));
+    }
+
+    for (; *str; str++, x += 8 * scale) {
+        uint8_t ch = (uint8_t)*str;
+        const uint8_t *glyph = tdl_font_8x8[(ch < 0x20 || ch > 0x7f ? '?' : ch) - 0x20];
+
+        if (x >= self->fb->width) {
+            break;
+        }
+        if (x + 8 * scale <= 0) {
+            continue;
+        }
+        for (int row = 0; row < 8; row++) {
+            int col = 0, end = 0;
+            for (; col < 8; col = end) {
+                bool set = (glyph[row] >> col) & 1;
+                for (end = col + 1; end < 8 && (bool)((glyph[row] >> end) & 1) == set; end++) {
+                }
+                if (set || has_bg) {
+                    tdl_fb_fill_clip(self, x + col * scale, y + row * scale, (end - col) * scale, scale,
+                                     set ? fg : bg);
+                }
+            }
+        }
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(tdl_fb_text_obj, 5, 7, tdl_fb_text);
+
+static const mp_rom_map_elem_t tdl_fb_locals_dict_table[] = {
+    {MP_ROM_QSTR(MP_QSTR_deinit), MP_ROM_PTR(&tdl_fb_deinit_obj)},
+    {MP_ROM_QSTR(MP_QSTR_fill), MP_ROM_PTR(&tdl_fb_fill_obj)},
+    {MP_ROM_QSTR(MP_QSTR_fill_rect), MP_ROM_PTR(&tdl_fb_fill_rect_obj)},
+    {MP_ROM_QSTR(MP_QSTR_pixel), MP_ROM_PTR(&tdl_fb_pixel_obj)},
+    {MP_ROM_QSTR(MP_QSTR_blit), MP_ROM_PTR(&tdl_fb_blit_obj)},
+    {MP_ROM_QSTR(MP_QSTR_text), MP_ROM_PTR(&tdl_fb_text_obj)},
+};
+static MP_DEFINE_CONST_DICT(tdl_fb_locals_dict, tdl_fb_locals_dict_table);
+
+static MP_DEFINE_CONST_OBJ_TYPE(tdl_fb_type, MP_QSTR_FrameBuffer, MP_TYPE_FLAG_NONE, make_new, tdl_fb_make_new,
+                                attr, tdl_fb_attr, buffer, tdl_fb_get_buffer, locals_dict, &tdl_fb_locals_dict);
+
+/* Display(name), opens the registered device */
+static mp_obj_t tdl_disp_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args)
+{
+    mp_arg_check_num(n_args, n_kw, 1, 1, false);
+
+    TDL_DISP_HANDLE_T hdl = tdl_disp_find_dev((char *)mp_obj_str_get_str(args[0]));
+    if (NULL == hdl) {
+        mp_raise_OSError(OPRT_NOT_FOUND);
+    }
+
+    tdl_disp_obj_t *self = mp_obj_malloc(tdl_disp_obj_t, type);
+    self->hdl = hdl;
+    tdl_check(tdl_disp_dev_get_info(hdl, &self->info));
+    tdl_check(tdl_disp_dev_open(hdl));
+    return MP_OBJ_FROM_PTR(self);
+}
+
+/* disp.info() -> (width, height, fmt) */
+static mp_obj_t tdl_disp_info(mp_obj_t self_in)
+{
+    tdl_disp_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_obj_t items[] = {
+        MP_OBJ_NEW_SMALL_INT(self->info.width),
+        MP_OBJ_NEW_SMALL_INT(self->info.height),
+        MP_OBJ_NEW_SMALL_INT(self->info.fmt),
+    };
+
+    return mp_obj_new_tuple(MP_ARRAY_SIZE(items), items);
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(tdl_disp_info_obj, tdl_disp_info);
+
+/* disp.framebuffer(psram=True) -> FrameBuffer of the panel size and format */
+static mp_obj_t tdl_disp_framebuffer(size_t n_args, const mp_obj_t *args)
+{
+    tdl_disp_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    bool psram = n_args > 1 ? mp_obj_is_true(args[1]) : true;
+
+    return MP_OBJ_FROM_PTR(tdl_fb_new(self->info.fmt, self->info.width, self->info.height, psram,
+                                      self->info.is_swap));
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(tdl_disp_framebuffer_obj, 1, 2, tdl_disp_framebuffer);
+
+/* disp.flush(fb) */
+static mp_obj_t tdl_disp_flush(mp_obj_t self_in, mp_obj_t fb_in)
+{
+    tdl_disp_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    tdl_check(tdl_disp_dev_flush(self->hdl, tdl_fb_get(fb_in)->fb));
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(tdl_disp_flush_obj, tdl_disp_flush);
+
+/* disp.brightness(level) */
+static mp_obj_t tdl_disp_brightness(mp_obj_t self_in, mp_obj_t level)
+{
+    tdl_disp_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    tdl_check(tdl_disp_set_brightness(self->hdl, mp_obj_get_int(level)));
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(tdl_disp_brightness_obj, tdl_disp_brightness);
+
+static const mp_rom_map_elem_t tdl_disp_locals_dict_table[] = {
+    {MP_ROM_QSTR(MP_QSTR_info), MP_ROM_PTR(&tdl_disp_info_obj)},
+    {MP_ROM_QSTR(MP_QSTR_framebuffer), MP_ROM_PTR(&tdl_disp_framebuffer_obj)},
+    {MP_ROM_QSTR(MP_QSTR_flush), MP_ROM_PTR(&tdl_disp_flush_obj)},
+    {MP_ROM_QSTR(MP_QSTR_brightness), MP_ROM_PTR(&tdl_disp_brightness_obj)},
+};
+static MP_DEFINE_CONST_DICT(tdl_disp_locals_dict, tdl_disp_locals_dict_table);
+
+static MP_DEFINE_CONST_OBJ_TYPE(tdl_disp_type, MP_QSTR_Display, MP_TYPE_FLAG_NONE, make_new, tdl_disp_make_new,
+                                locals_dict, &tdl_disp_locals_dict);
+
+#endif /* ENABLE_DISPLAY */
+
+/*
+ * Camera
+ */
+#if defined(ENABLE_CAMERA) && (ENABLE_CAMERA == 1)
+
+/* Outside the GC heap, the frame callback may run after the Camera object is gone */
+typedef struct {
+    TDL_CAMERA_HANDLE_T hdl;
+    TDL_CAMERA_FRAME_TYPE_E type;
+    bool started;
+    TDL_CAMERA_FRAME_T *latest; // retained, not handed to Python yet
+} tdl_cam_ctx_t;
+
+typedef struct {
+    mp_obj_base_t base;
+    tdl_cam_ctx_t *ctx;
+} tdl_cam_obj_t;
+
+typedef struct {
+    mp_obj_base_t base;
+    TDL_CAMERA_FRAME_T *frame;
+} tdl_frame_obj_t;
+
+static const mp_obj_type_t tdl_frame_type;
+
+static TDL_CAMERA_FRAME_T *tdl_cam_take(tdl_cam_ctx_t *ctx)
+{
+    TDL_CAMERA_FRAME_T *frame = NULL;
+
+    TAL_ENTER_CRITICAL();
+    frame = ctx->latest;
+    ctx->latest = NULL;
+    TAL_EXIT_CRITICAL();
+    return frame;
+}
+
+/* Runs in the camera flow task, swaps in the new frame and drops an unread one */
+static OPERATE_RET tdl_cam_frame_cb(TDL_CAMERA_HANDLE_T hdl, TDL_CAMERA_FRAME_T *frame, void *arg)
+{
+    tdl_cam_ctx_t *ctx = arg;
+    TDL_CAMERA_FRAME_T *old = NULL;
+
+    if (OPRT_OK != tdl_camera_frame_retain(frame)) {
+        return OPRT_OK;
+    }
+    TAL_ENTER_CRITICAL();
+    old = ctx->latest;
+    ctx->latest = frame;
+    TAL_EXIT_CRITICAL();
+
+    if (old) {
+        tdl_camera_frame_release(old);
+    }
+    return OPRT_OK;
+}
+
+/* Camera(name), the device is opened by the application */
+static mp_obj_t tdl_cam_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args)
+{
+    mp_arg_check_num(n_args, n_kw, 1, 1, false);
+
+    TDL_CAMERA_HANDLE_T hdl = tdl_camera_find_dev((char *)mp_obj_str_get_str(args[0]));
+    if (NULL == hdl) {
+        mp_raise_OSError(OPRT_NOT_FOUND);
+    }
+
+    tdl_cam_ctx_t *ctx = tal_malloc(sizeof(tdl_cam_ctx_t));
+    if (NULL == ctx) {
+        mp_raise_OSError(OPRT_MALLOC_FAILED);
+    }
+    memset(ctx, 0, sizeof(tdl_cam_ctx_t));
+    ctx->hdl = hdl;
+
+    tdl_cam_obj_t *self = mp_obj_malloc(tdl_cam_obj_t, type);
+    self->ctx = ctx;
+    return MP_OBJ_FROM_PTR(self);
+}
+
+/* cam.start(encoded=False, fps=0) */
+static mp_obj_t tdl_cam_start(size_t n_args, const mp_obj_t *args)
+{
+    tdl_cam_ctx_t *ctx = ((tdl_cam_obj_t *)MP_OBJ_TO_PTR(args[0]))->ctx;
+    TDL_CAMERA_FRAME_TYPE_E type = n_args > 1 && mp_obj_is_true(args[1]) ? TDL_CAMERA_FRAME_ENCODED
+                                                                         : TDL_CAMERA_FRAME_RAW;
+    uint16_t fps = n_args > 2 ? mp_obj_get_int(args[2]) : 0;
+
+    if (ctx->started) {
+        return mp_const_none;
+    }
+    tdl_check(tdl_camera_dev_subscribe(ctx->hdl, type, fps, tdl_cam_frame_cb, ctx));
+    ctx->type = type;
+    ctx->started = true;
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(tdl_cam_start_obj, 1, 3, tdl_cam_start);
+
+/* cam.stop(), frames already returned by frame() stay valid until released */
+static mp_obj_t tdl_cam_stop(mp_obj_t self_in)
+{
+    tdl_cam_ctx_t *ctx = ((tdl_cam_obj_t *)MP_OBJ_TO_PTR(self_in))->ctx;
+    TDL_CAMERA_FRAME_T *frame = NULL;
+
+    if (ctx->started) {
+        tdl_camera_dev_unsubscribe(ctx->hdl, tdl_cam_frame_cb, ctx);
+        ctx->started = false;
+    }
+    frame = tdl_cam_take(ctx);
+    if (frame) {
+        tdl_camera_frame_release(frame);
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(tdl_cam_stop_obj, tdl_cam_stop);
+
+/* cam.frame() -> Frame or None, the newest frame since the last call */
+static mp_obj_t tdl_cam_frame(mp_obj_t self_in)
+{
+    tdl_cam_ctx_t *ctx = ((tdl_cam_obj_t *)MP_OBJ_TO_PTR(self_in))->ctx;
+    tdl_frame_obj_t *obj = mp_obj_malloc(tdl_frame_obj_t, &tdl_frame_type);
+
+    obj->frame = tdl_cam_take(ctx);
+    if (NULL == obj->frame) {
+        return mp_const_none;
+    }
+    return MP_OBJ_FROM_PTR(obj);
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(tdl_cam_frame_obj, tdl_cam_frame);
+
+static const mp_rom_map_elem_t tdl_cam_locals_dict_table[] = {
+    {MP_ROM_QSTR(MP_QSTR_start), MP_ROM_PTR(&tdl_cam_start_obj)},
+    {MP_ROM_QSTR(MP_QSTR_stop), MP_ROM_PTR(&tdl_cam_stop_obj)},
+    {MP_ROM_QSTR(MP_QSTR_frame), MP_ROM_PTR(&tdl_cam_frame_obj)},
+};
+static MP_DEFINE_CONST_DICT(tdl_cam_locals_dict, tdl_cam_locals_dict_table);
+
+static MP_DEFINE_CONST_OBJ_TYPE(tdl_cam_type, MP_QSTR_Camera, MP_TYPE_FLAG_NONE, make_new, tdl_cam_make_new,
+                                locals_dict, &tdl_cam_locals_dict);
+
+/* Read only, other consumers share the frame */
+static mp_int_t tdl_frame_get_buffer(mp_obj_t self_in, mp_buffer_info_t *bufinfo, mp_uint_t flags)
+{
+    tdl_frame_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    if (NULL == self->frame || (flags & MP_BUFFER_WRITE)) {
+        return 1;
+    }
+    bufinfo->buf = self->frame->data;
+    bufinfo->len = self->frame->data_len;
+    bufinfo->typecode = 'B';
+    return 0;
+}
+
+static void tdl_frame_attr(mp_obj_t self_in, qstr attr, mp_obj_t *dest)
+{
+    tdl_frame_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    if (MP_OBJ_NULL != dest[0] || NULL == self->frame) {
+        dest[1] = MP_OBJ_SENTINEL;
+        return;
+    }
+    switch (attr) {
+    case MP_QSTR_width:
+        dest[0] = MP_OBJ_NEW_SMALL_INT(self->frame->width);
+        break;
+    case MP_QSTR_height:
+        dest[0] = MP_OBJ_NEW_SMALL_INT(self->frame->height);
+        break;
+    case MP_QSTR_fmt:
+        dest[0] = MP_OBJ_NEW_SMALL_INT(self->frame->fmt);
+        break;
+    case MP_QSTR_id:
+        dest[0] = MP_OBJ_NEW_SMALL_INT(self->frame->id);
+        break;
+    default:
+        dest[1] = MP_OBJ_SENTINEL;
+        break;
+    }
+}
+
+/* frame.release(), gives the buffer back to the camera pool */
+static mp_obj_t tdl_frame_release(mp_obj_t self_in)
+{
+    tdl_frame_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    if (self->frame) {
+        tdl_camera_frame_release(self->frame);
+        self->frame = NULL;
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(tdl_frame_release_obj, tdl_frame_release);
+
+static const mp_rom_map_elem_t tdl_frame_locals_dict_table[] = {
+    {MP_ROM_QSTR(MP_QSTR_release), MP_ROM_PTR(&tdl_frame_release_obj)},
+};
+static MP_DEFINE_CONST_DICT(tdl_frame_locals_dict, tdl_frame_locals_dict_table);
+
+static MP_DEFINE_CONST_OBJ_TYPE(tdl_frame_type, MP_QSTR_Frame, MP_TYPE_FLAG_NONE, attr, tdl_frame_attr, buffer,
+                                tdl_frame_get_buffer, locals_dict, &tdl_frame_locals_dict);
+
+#endif /* ENABLE_CAMERA */
+
+/*
+ * Audio
+ */
+#if defined(ENABLE_AUDIO_CODECS) && (ENABLE_AUDIO_CODECS == 1)
+
+typedef struct {
+    mp_obj_base_t base;
+    TDL_AUDIO_HANDLE_T hdl;
+} tdl_audio_obj_t;
+
+/* The mic callback has no argument, so one device at a time fills the ring */
+static TUYA_RINGBUFF_T sg_tdl_mic_ring = NULL;
+
+static void tdl_audio_mic_cb(TDL_AUDIO_FRAME_FORMAT_E type, TDL_AUDIO_STATUS_E status, uint8_t *data, uint32_t len)
+{
+    if (TDL_AUDIO_FRAME_FORMAT_PCM == type && sg_tdl_mic_ring) {
+        tuya_ring_buff_write(sg_tdl_mic_ring, data, len);
+    }
+}
+
+/* Audio(name) */
+static mp_obj_t tdl_audio_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args)
+{
+    TDL_AUDIO_HANDLE_T hdl = NULL;
+
+    mp_arg_check_num(n_args, n_kw, 1, 1, false);
+    tdl_check(tdl_audio_find((char *)mp_obj_str_get_str(args[0]), &hdl));
+
+    tdl_audio_obj_t *self = mp_obj_malloc(tdl_audio_obj_t, type);
+    self->hdl = hdl;
+    return MP_OBJ_FROM_PTR(self);
+}
+
+/* audio.open(), starts the mic into a MP_TDL_MIC_BUF_SIZE ring */
+static mp_obj_t tdl_audio_open_fn(mp_obj_t self_in)
+{
+    tdl_audio_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    if (NULL == sg_tdl_mic_ring) {
+        tdl_check(tuya_ring_buff_create(MP_TDL_MIC_BUF_SIZE, OVERFLOW_COVERAGE_TYPE, &sg_tdl_mic_ring));
+    }
+    tdl_check(tdl_audio_open(self->hdl, tdl_audio_mic_cb));
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(tdl_audio_open_obj, tdl_audio_open_fn);
+
+/* audio.close() */
+static mp_obj_t tdl_audio_close_fn(mp_obj_t self_in)
+{
+    tdl_audio_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    tdl_check(tdl_audio_close(self->hdl));
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(tdl_audio_close_obj, tdl_audio_close_fn);
+
+/* audio.play(buf), the driver gets the buffer itself, no copy */
+static mp_obj_t tdl_audio_play_fn(mp_obj_t self_in, mp_obj_t buf_in)
+{
+    tdl_audio_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_buffer_info_t bufinfo;
+
+    mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_READ);
+    tdl_check(tdl_audio_play(self->hdl, bufinfo.buf, bufinfo.len));
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(tdl_audio_play_obj, tdl_audio_play_fn);
+
+/* audio.stop() */
+static mp_obj_t tdl_audio_stop_fn(mp_obj_t self_in)
+{
+    tdl_audio_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    tdl_check(tdl_audio_play_stop(self->hdl));
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(tdl_audio_stop_obj, tdl_audio_stop_fn);
+
+/* audio.volume(level) */
+static mp_obj_t tdl_audio_volume_fn(mp_obj_t self_in, mp_obj_t level)
+{
+    tdl_audio_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    tdl_check(tdl_audio_volume_set(self->hdl, mp_obj_get_int(level)));
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(tdl_audio_volume_obj, tdl_audio_volume_fn);
+
+/* audio.readinto(buf) -> bytes of mic PCM copied, 0 when none is waiting */
+static mp_obj_t tdl_audio_readinto(mp_obj_t self_in, mp_obj_t buf_in)
+{
+    mp_buffer_info_t bufinfo;
+
+    mp_get_buffer_raise(buf_in, &bufinfo, MP_BUFFER_WRITE);
+    if (NULL == sg_tdl_mic_ring) {
+        return MP_OBJ_NEW_SMALL_INT(0);
+    }
+    return MP_OBJ_NEW_SMALL_INT(tuya_ring_buff_read(sg_tdl_mic_ring, bufinfo.buf, bufinfo.len));
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(tdl_audio_readinto_obj, tdl_audio_readinto);
+
+static const mp_rom_map_elem_t tdl_audio_locals_dict_table[] = {
+    {MP_ROM_QSTR(MP_QSTR_open), MP_ROM_PTR(&tdl_audio_open_obj)},
+    {MP_ROM_QSTR(MP_QSTR_close), MP_ROM_PTR(&tdl_audio_close_obj)},
+    {MP_ROM_QSTR(MP_QSTR_play), MP_ROM_PTR(&tdl_audio_play_obj)},
+    {MP_ROM_QSTR(MP_QSTR_stop), MP_ROM_PTR(&tdl_audio_stop_obj)},
+    {MP_ROM_QSTR(MP_QSTR_volume), MP_ROM_PTR(&tdl_audio_volume_obj)},
+    {MP_ROM_QSTR(MP_QSTR_readinto), MP_ROM_PTR(&tdl_audio_readinto_obj)},
+};
+static MP_DEFINE_CONST_DICT(tdl_audio_locals_dict, tdl_audio_locals_dict_table);
+
+static MP_DEFINE_CONST_OBJ_TYPE(tdl_audio_type, MP_QSTR_Audio, MP_TYPE_FLAG_NONE, make_new, tdl_audio_make_new,
+                                locals_dict, &tdl_audio_locals_dict);
+
+#endif /* ENABLE_AUDIO_CODECS */
+
+static const mp_rom_map_elem_t tdl_module_globals_table[] = {
+    {MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_tdl)},
+#if defined(ENABLE_DISPLAY) && (ENABLE_DISPLAY == 1)
+    {MP_ROM_QSTR(MP_QSTR_FrameBuffer), MP_ROM_PTR(&tdl_fb_type)},
+    {MP_ROM_QSTR(MP_QSTR_Display), MP_ROM_PTR(&tdl_disp_type)},
+    {MP_ROM_QSTR(MP_QSTR_RGB565), MP_ROM_INT(TUYA_PIXEL_FMT_RGB565)},
+    {MP_ROM_QSTR(MP_QSTR_RGB888), MP_ROM_INT(TUYA_PIXEL_FMT_RGB888)},
+    {MP_ROM_QSTR(MP_QSTR_MONO), MP_ROM_INT(TUYA_PIXEL_FMT_MONOCHROME)},
+    {MP_ROM_QSTR(MP_QSTR_I2), MP_ROM_INT(TUYA_PIXEL_FMT_I2)},
+#endif
+#if defined(ENABLE_CAMERA) && (ENABLE_CAMERA == 1)
+    {MP_ROM_QSTR(MP_QSTR_Camera), MP_ROM_PTR(&tdl_cam_type)},
+#endif
+#if defined(ENABLE_AUDIO_CODECS) && (ENABLE_AUDIO_CODECS == 1)
+    {MP_ROM_QSTR(MP_QSTR_Audio), MP_ROM_PTR(&tdl_audio_type)},
+#endif
+};
+static MP_DEFINE_CONST_DICT(tdl_module_globals, tdl_module_globals_table);
+
+const mp_obj_module_t tdl_module = {
+    .base = {&mp_type_module},
+    .globals = (mp_obj_dict_t *)&tdl_module_globals,
+};
+
+MP_REGISTER_MODULE(MP_QSTR_tdl, tdl_module);
+
+#endif /* MICROPY_PY_TDL */
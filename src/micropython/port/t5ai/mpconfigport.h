@@ -19,7 +19,9 @@
 #define MICROPY_ENABLE_COMPILER     (1)  /* Enable compiler for minimal functionality */
 #define MICROPY_ENABLE_GC           (1)  /* Enable GC for memory management */
 #define MICROPY_HELPER_REPL         (1)  /* Enable REPL for testing */
-#define MICROPY_MODULE_FROZEN_MPY   (0)
+#ifndef MICROPY_MODULE_FROZEN_MPY
+#define MICROPY_MODULE_FROZEN_MPY   (0)  /* Set by the build when MICROPY_FROZEN_MANIFEST is given */
+#endif
 #define MICROPY_QSTR_BYTES_IN_HASH  (2)  /* Use 2 bytes for hash to avoid overflow */
 
 /* Core Python features - disabled for minimal build */
@@ -44,6 +46,18 @@
 
 /* Platform specific - ARM Cortex-M33 */
 #define MICROPY_NLR_THUMB           (1)
+
+/* Native code emitters for @micropython.native, @micropython.viper and
+ * @micropython.asm_thumb, set by the build with CONFIG_MICROPYTHON_NATIVE.
+ * The code is placed in the GC heap. */
+#ifndef MICROPY_EMIT_THUMB
+#define MICROPY_EMIT_THUMB          (0)
+#endif
+#define MICROPY_EMIT_INLINE_THUMB   (MICROPY_EMIT_THUMB)
+#define MICROPY_EMIT_INLINE_THUMB_FLOAT (0)  /* No float support in this build */
+#if MICROPY_EMIT_THUMB
+#define MICROPY_MAKE_POINTER_CALLABLE(p) ((void *)((mp_uint_t)(p) | 1))  /* Thumb state bit */
+#endif
 #define MICROPY_LONGINT_IMPL        (MICROPY_LONGINT_IMPL_MPZ)
 
 /* Use core features configuration level for basic Python functionality */
@@ -60,8 +74,25 @@ typedef long mp_off_t;
 /* We need to provide a type for the GC heap */
 #define MICROPY_GCREGS_SETJMP       (0)
 
-/* Minimal heap size for testing */
-#define MICROPY_HEAP_SIZE           (8 * 1024)
+/* Heap and GC profile
+ * The GC heap is MICROPY_HEAP_SIZE bytes of SRAM. With PSRAM an area of
+ * MICROPY_HEAP_PSRAM_SIZE bytes is added behind it, the SRAM area is used
+ * first so small, hot objects stay in fast memory. A collection runs once
+ * MICROPY_GC_THRESHOLD_BYTES have been allocated since the last one, so
+ * collections come at a steady rate rather than at whichever allocation finds
+ * the heap full. gc.threshold() changes it at run time, -1 turns it off. */
+#ifndef MICROPY_HEAP_SIZE
+#define MICROPY_HEAP_SIZE           (32 * 1024)
+#endif
+#if defined(ENABLE_EXT_RAM) && (ENABLE_EXT_RAM == 1)
+#ifndef MICROPY_HEAP_PSRAM_SIZE
+#define MICROPY_HEAP_PSRAM_SIZE     (512 * 1024)
+#endif
+#define MICROPY_GC_SPLIT_HEAP       (1)
+#endif
+#ifndef MICROPY_GC_THRESHOLD_BYTES
+#define MICROPY_GC_THRESHOLD_BYTES  (16 * 1024)
+#endif
 
 /* Readline configuration */
 #define MICROPY_PY_SYS_STDFILES     (0)
@@ -122,4 +153,7 @@ extern const struct _mp_print_t mp_plat_print;
 /* Tuya module configuration (disabled for now) */
 #define MICROPY_PY_TUYA             (0)
 
+/* tdl module: display frame buffers, camera frames and audio (modtdl.c) */
+#define MICROPY_PY_TDL              (1)
+
 #endif /* MICROPYTHON_MPCONFIGPORT_H */
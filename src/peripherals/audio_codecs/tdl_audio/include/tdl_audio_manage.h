@@ -42,6 +42,8 @@ typedef void *TDL_AUDIO_HANDLE_T;
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
+// called with every buffer accepted by tdl_audio_play, e.g. as echo canceller reference
+typedef void (*TDL_AUDIO_PLAY_TAP_CB)(uint8_t *data, uint32_t len, void *arg);
 
 /***********************************************************
 ********************function declaration********************
@@ -55,6 +57,8 @@ OPERATE_RET tdl_audio_play(TDL_AUDIO_HANDLE_T handle, uint8_t *data, uint32_t le
 
 OPERATE_RET tdl_audio_play_stop(TDL_AUDIO_HANDLE_T handle);
 
+OPERATE_RET tdl_audio_play_tap_set(TDL_AUDIO_HANDLE_T handle, TDL_AUDIO_PLAY_TAP_CB cb, void *arg);
+
 OPERATE_RET tdl_audio_volume_set(TDL_AUDIO_HANDLE_T handle, uint8_t volume);
 
 OPERATE_RET tdl_audio_close(TDL_AUDIO_HANDLE_T handle);
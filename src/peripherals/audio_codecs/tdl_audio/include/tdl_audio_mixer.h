@@ -0,0 +1,152 @@
+/**
+ * @file tdl_audio_mixer.h
+ * @brief Multi-source pcm mixer on top of a TDL audio device.
+ *
+ * Several producers (prompt tones, TTS, music ...) open their own stream at
+ * their own sample rate and write 16 bit pcm into it. A single mixer task
+ * resamples every active stream to the device rate with a fixed-point
+ * polyphase filter, applies the per-stream gain, sums the result straight into
+ * one accumulator frame and hands that frame to tdl_audio_play. The device
+ * therefore sees exactly one playback stream, and the play tap still gets the
+ * signal that actually reaches the speaker.
+ *
+ * Supported rates are 8, 16, 24, 44.1 and 48 kHz, mono or interleaved stereo
+ * input (stereo is downmixed), mono output.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __TDL_AUDIO_MIXER_H__
+#define __TDL_AUDIO_MIXER_H__
+
+#include "tuya_cloud_types.h"
+
+#include "tdl_audio_manage.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+// max streams per mixer
+#ifndef TDL_AUDIO_MIXER_STREAM_MAX
+#define TDL_AUDIO_MIXER_STREAM_MAX 4
+#endif
+
+// taps per polyphase branch
+#ifndef TDL_AUDIO_MIXER_RESAMPLE_TAPS
+#define TDL_AUDIO_MIXER_RESAMPLE_TAPS 16
+#endif
+
+// fractional delay resolution of the resampler
+#ifndef TDL_AUDIO_MIXER_RESAMPLE_PHASES
+#define TDL_AUDIO_MIXER_RESAMPLE_PHASES 32
+#endif
+
+#define TDL_AUDIO_MIXER_GAIN_MAX 100
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef void *TDL_AUDIO_MIXER_HANDLE_T;
+typedef void *TDL_AUDIO_MIXER_STREAM_T;
+
+typedef struct {
+    uint32_t out_rate; // device playback rate in Hz
+    uint16_t frame_ms; // size of one mixed frame handed to the device
+    uint32_t stack_size;
+    uint8_t priority;
+} TDL_AUDIO_MIXER_CFG_T;
+
+typedef struct {
+    uint32_t rate;     // input rate in Hz
+    uint8_t channels;  // 1 or 2
+    uint8_t gain;      // 0 ~ TDL_AUDIO_MIXER_GAIN_MAX
+    uint32_t buf_ms;   // buffered input, the writer blocks when it is full
+} TDL_AUDIO_MIXER_STREAM_CFG_T;
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+/**
+ * @brief Creates a mixer that owns playback on the given device.
+ *
+ * @param handle The opened TDL audio device.
+ * @param cfg Mixer configuration.
+ * @param mixer Returns the mixer handle.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_audio_mixer_create(TDL_AUDIO_HANDLE_T handle, TDL_AUDIO_MIXER_CFG_T *cfg,
+                                   TDL_AUDIO_MIXER_HANDLE_T *mixer);
+
+/**
+ * @brief Stops the mixer task and frees all streams.
+ *
+ * @param mixer The mixer handle.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_audio_mixer_destroy(TDL_AUDIO_MIXER_HANDLE_T mixer);
+
+/**
+ * @brief Opens an input stream.
+ *
+ * @param mixer The mixer handle.
+ * @param cfg Stream configuration.
+ * @param stream Returns the stream handle.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_audio_mixer_stream_open(TDL_AUDIO_MIXER_HANDLE_T mixer, TDL_AUDIO_MIXER_STREAM_CFG_T *cfg,
+                                        TDL_AUDIO_MIXER_STREAM_T *stream);
+
+/**
+ * @brief Closes a stream, data not yet mixed is dropped.
+ *
+ * @param stream The stream handle.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_audio_mixer_stream_close(TDL_AUDIO_MIXER_STREAM_T stream);
+
+/**
+ * @brief Writes pcm into a stream, only one task may write a given stream.
+ *
+ * @param stream The stream handle.
+ * @param data 16 bit pcm at the stream rate.
+ * @param len Length in bytes.
+ * @param timeout_ms How long to wait for room, SEM_WAIT_FOREVER to block.
+ * @return The number of bytes accepted, or a negative error code.
+ */
+int tdl_audio_mixer_stream_write(TDL_AUDIO_MIXER_STREAM_T stream, uint8_t *data, uint32_t len, uint32_t timeout_ms);
+
+/**
+ * @brief Drops everything written to the stream so far, safe from any task.
+ *
+ * @param stream The stream handle.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_audio_mixer_stream_flush(TDL_AUDIO_MIXER_STREAM_T stream);
+
+/**
+ * @brief Changes the stream gain, takes effect from the next mixed frame.
+ *
+ * @param stream The stream handle.
+ * @param gain 0 ~ TDL_AUDIO_MIXER_GAIN_MAX.
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_audio_mixer_stream_gain_set(TDL_AUDIO_MIXER_STREAM_T stream, uint8_t gain);
+
+/**
+ * @brief Bytes still waiting in the stream.
+ *
+ * @param stream The stream handle.
+ * @return Buffered length in bytes.
+ */
+uint32_t tdl_audio_mixer_stream_pending(TDL_AUDIO_MIXER_STREAM_T stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TDL_AUDIO_MIXER_H__ */
@@ -44,6 +44,9 @@ typedef struct list_node {
 
     TDD_AUDIO_HANDLE_T tdd_hdl;
     TDD_AUDIO_INTFS_T tdd_intfs;
+
+    TDL_AUDIO_PLAY_TAP_CB play_tap;
+    void *play_tap_arg;
 } TDL_AUDIO_NODE_T;
 
 typedef struct {
@@ -160,7 +163,24 @@ OPERATE_RET tdl_audio_play(TDL_AUDIO_HANDLE_T handle, uint8_t *data, uint32_t le
         return OPRT_INVALID_PARM;
     }
 
-    return node->tdd_intfs.play(node->tdd_hdl, data, len);
+    OPERATE_RET rt = node->tdd_intfs.play(node->tdd_hdl, data, len);
+    if (OPRT_OK == rt && node->play_tap) {
+        node->play_tap(data, len, node->play_tap_arg);
+    }
+
+    return rt;
+}
+
+OPERATE_RET tdl_audio_play_tap_set(TDL_AUDIO_HANDLE_T handle, TDL_AUDIO_PLAY_TAP_CB cb, void *arg)
+{
+    TDL_AUDIO_NODE_T *node = (TDL_AUDIO_NODE_T *)handle;
+
+    TUYA_CHECK_NULL_RETURN(node, OPRT_INVALID_PARM);
+
+    node->play_tap_arg = arg;
+    node->play_tap = cb;
+
+    return OPRT_OK;
 }
 
 OPERATE_RET tdl_audio_play_stop(TDL_AUDIO_HANDLE_T handle)
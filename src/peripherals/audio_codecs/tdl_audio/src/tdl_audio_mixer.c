@@ -0,0 +1,561 @@
+/**
+ * @file tdl_audio_mixer.c
+ * @brief Multi-source pcm mixer with fixed-point polyphase resampling.
+ *
+ * Every stream owns a lock-free ring, its writer is the producer and the
+ * mixer task the consumer. Input is consumed in place from the ring, pushed
+ * through the stream's delay line and accumulated with gain into a 32 bit
+ * frame, so each source costs no extra full rate copy. The frame is saturated
+ * to 16 bit once and played through tdl_audio_play.
+ *
+ * The resampler keeps its position as an exact fraction acc / out_rate of an
+ * input sample, so rational ratios such as 44.1k -> 16k do not drift. The
+ * fractional position selects one of TDL_AUDIO_MIXER_RESAMPLE_PHASES windowed
+ * sinc branches, built in Q15 when the stream is opened.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include "tdl_audio_mixer.h"
+
+#include "tal_memory.h"
+#include "tal_log.h"
+#include "tal_mutex.h"
+#include "tal_semaphore.h"
+#include "tal_thread.h"
+#include "tal_system.h"
+#include "spsc_ring.h"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__ARM_FEATURE_SIMD32) && (__ARM_FEATURE_SIMD32 == 1)
+#include <arm_acle.h>
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define MIXER_TAPS   TDL_AUDIO_MIXER_RESAMPLE_TAPS
+#define MIXER_PHASES TDL_AUDIO_MIXER_RESAMPLE_PHASES
+
+#define MIXER_PI        3.14159265f
+#define MIXER_CUTOFF    0.9f // fraction of the lower nyquist kept by the anti alias filter
+#define MIXER_UNITY_Q15 32768
+
+#define MIXER_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MIXER_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+#define MIXER_DEFAULT_FRAME_MS  20
+#define MIXER_DEFAULT_BUF_MS    200
+#define MIXER_DEFAULT_STACK     (1024 * 3)
+
+#if (MIXER_TAPS % 4) != 0
+#error "TDL_AUDIO_MIXER_RESAMPLE_TAPS must be a multiple of 4"
+#endif
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+struct mixer;
+
+typedef struct {
+    struct mixer *mixer;
+    bool in_use;
+
+    uint32_t rate;
+    uint8_t channels;
+    uint8_t sample_bytes; // bytes per input frame, 2 or 4
+    volatile int32_t gain_q15;
+
+    SPSC_RING_T ring;
+    uint8_t *ring_buf;
+    SEM_HANDLE room_sem;
+
+    // resampler, coef is NULL when the stream already runs at out_rate
+    int16_t *coef; // MIXER_PHASES x MIXER_TAPS
+    int16_t hist[MIXER_TAPS * 2];
+    uint32_t pos;
+    uint32_t acc;
+} MIXER_STREAM_T;
+
+typedef struct mixer {
+    TDL_AUDIO_HANDLE_T audio_hdl;
+    uint32_t out_rate;
+    uint32_t frame_samples;
+
+    int32_t *mix;
+    int16_t *out;
+
+    MUTEX_HANDLE mutex;
+    SEM_HANDLE data_sem;
+    THREAD_HANDLE thrd_hdl;
+
+    MIXER_STREAM_T stream[TDL_AUDIO_MIXER_STREAM_MAX];
+} MIXER_T;
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static inline int16_t __mixer_sat16(int32_t v)
+{
+    if (v > 32767) {
+        return 32767;
+    }
+    if (v < -32768) {
+        return -32768;
+    }
+    return (int16_t)v;
+}
+
+// only used while building the filter, keeps libm out of the driver layer
+static float __mixer_sinf(float x)
+{
+    float x2 = 0.0f;
+    int32_t k = (int32_t)(x / (2 * MIXER_PI) + ((x >= 0) ? 0.5f : -0.5f));
+
+    x -= k * 2 * MIXER_PI;
+    if (x > MIXER_PI / 2) {
+        x = MIXER_PI - x;
+    } else if (x < -MIXER_PI / 2) {
+        x = -MIXER_PI - x;
+    }
+
+    x2 = x * x;
+    return x * (1 - x2 / 6 * (1 - x2 / 20 * (1 - x2 / 42 * (1 - x2 / 72))));
+}
+
+static bool __mixer_rate_is_valid(uint32_t rate)
+{
+    return (8000 == rate || 16000 == rate || 24000 == rate || 44100 == rate || 48000 == rate);
+}
+
+static int16_t *__mixer_coef_create(uint32_t in_rate, uint32_t out_rate)
+{
+    float fc = MIXER_CUTOFF * ((out_rate < in_rate) ? ((float)out_rate / in_rate) : 1.0f);
+    float h[MIXER_TAPS];
+    uint32_t p = 0, k = 0;
+
+    int16_t *coef = tal_malloc(MIXER_PHASES * MIXER_TAPS * sizeof(int16_t));
+    if (NULL == coef) {
+        return NULL;
+    }
+
+    for (p = 0; p < MIXER_PHASES; p++) {
+        float sum = 0.0f;
+        int32_t isum = 0;
+
+        // tap k weights x(n - k), which lies k + p / PHASES input samples before the output
+        for (k = 0; k < MIXER_TAPS; k++) {
+            float t = (float)k + (float)p / MIXER_PHASES - MIXER_TAPS / 2;
+            float a = MIXER_PI * fc * t;
+            float sinc = (t > -1e-6f && t < 1e-6f) ? 1.0f : __mixer_sinf(a) / a;
+            float win = 0.5f + 0.5f * __mixer_sinf(2 * MIXER_PI * t / MIXER_TAPS + MIXER_PI / 2);
+            h[k] = sinc * win;
+            sum += h[k];
+        }
+
+        // unity dc gain for every branch, rounding error goes to the center tap
+        for (k = 0; k < MIXER_TAPS; k++) {
+            int32_t v = (int32_t)(h[k] / sum * (MIXER_UNITY_Q15 - 1) + ((h[k] >= 0) ? 0.5f : -0.5f));
+            coef[p * MIXER_TAPS + k] = __mixer_sat16(v);
+            isum += coef[p * MIXER_TAPS + k];
+        }
+        coef[p * MIXER_TAPS + MIXER_TAPS / 2] += (int16_t)((MIXER_UNITY_Q15 - 1) - isum);
+    }
+
+    return coef;
+}
+
+static int32_t __mixer_dot_q15(const int16_t *a, const int16_t *b)
+{
+    int32_t acc = 0;
+    uint32_t i = 0;
+
+#if defined(__ARM_NEON)
+    int32x4_t acc32 = vdupq_n_s32(0);
+    for (; i < MIXER_TAPS; i += 4) {
+        acc32 = vmlal_s16(acc32, vld1_s16(a + i), vld1_s16(b + i));
+    }
+    acc = vgetq_lane_s32(acc32, 0) + vgetq_lane_s32(acc32, 1) + vgetq_lane_s32(acc32, 2) + vgetq_lane_s32(acc32, 3);
+#elif defined(__ARM_FEATURE_SIMD32) && (__ARM_FEATURE_SIMD32 == 1)
+    for (; i < MIXER_TAPS; i += 2) {
+        int16x2_t va, vb;
+        memcpy(&va, a + i, sizeof(va));
+        memcpy(&vb, b + i, sizeof(vb));
+        acc = __smlad(va, vb, acc);
+    }
+#else
+    for (; i < MIXER_TAPS; i++) {
+        acc += (int32_t)a[i] * b[i];
+    }
+#endif
+
+    return acc;
+}
+
+static void __mixer_saturate(const int32_t *in, int16_t *out, uint32_t n)
+{
+    uint32_t i = 0;
+
+#if defined(__ARM_NEON)
+    for (; i + 4 <= n; i += 4) {
+        vst1_s16(out + i, vqmovn_s32(vld1q_s32(in + i)));
+    }
+#endif
+
+    for (; i < n; i++) {
+        out[i] = __mixer_sat16(in[i]);
+    }
+}
+
+static inline int32_t __mixer_sample_get(MIXER_STREAM_T *s, const uint8_t *p)
+{
+    int16_t v[2];
+
+    memcpy(v, p, s->sample_bytes);
+    return (2 == s->channels) ? (((int32_t)v[0] + v[1]) >> 1) : v[0];
+}
+
+/**
+ * @brief Adds up to n output samples of one stream into mix.
+ * @return The number of output samples produced.
+ */
+static uint32_t __mixer_stream_mix(MIXER_STREAM_T *s, int32_t *mix, uint32_t n)
+{
+    uint32_t out_rate = s->mixer->out_rate;
+    int32_t gain = s->gain_q15;
+    uint32_t produced = 0;
+    uint8_t *src = NULL;
+    uint32_t avail = 0, used = 0;
+
+    while (produced < n) {
+        if (used >= avail) {
+            spsc_ring_commit(&s->ring, used);
+            avail = spsc_ring_peek(&s->ring, &src);
+            avail -= avail % s->sample_bytes;
+            used = 0;
+            if (0 == avail) {
+                break;
+            }
+        }
+
+        if (NULL == s->coef) {
+            // same rate, gain and sum straight from the ring
+            for (; used < avail && produced < n; used += s->sample_bytes) {
+                mix[produced++] += (__mixer_sample_get(s, src + used) * gain) >> 15;
+            }
+            continue;
+        }
+
+        // pull input until the output position lies within the newest input sample
+        while (s->acc >= out_rate && used < avail) {
+            int16_t x = __mixer_sat16(__mixer_sample_get(s, src + used));
+            used += s->sample_bytes;
+            s->pos = (0 == s->pos) ? (MIXER_TAPS - 1) : (s->pos - 1);
+            s->hist[s->pos] = x;
+            s->hist[s->pos + MIXER_TAPS] = x;
+            s->acc -= out_rate;
+        }
+        if (s->acc >= out_rate) {
+            continue;
+        }
+
+        uint32_t phase = (uint32_t)(((uint64_t)s->acc * MIXER_PHASES) / out_rate);
+        int32_t y = __mixer_sat16(__mixer_dot_q15(&s->coef[phase * MIXER_TAPS], &s->hist[s->pos]) >> 15);
+        mix[produced++] += (y * gain) >> 15;
+        s->acc += s->rate;
+    }
+    spsc_ring_commit(&s->ring, used);
+
+    return produced;
+}
+
+static void __mixer_task(void *args)
+{
+    MIXER_T *mixer = (MIXER_T *)args;
+    uint32_t i = 0;
+
+    while (THREAD_STATE_RUNNING == tal_thread_get_state(mixer->thrd_hdl)) {
+        uint32_t frame_len = 0;
+
+        memset(mixer->mix, 0, mixer->frame_samples * sizeof(int32_t));
+
+        tal_mutex_lock(mixer->mutex);
+        for (i = 0; i < TDL_AUDIO_MIXER_STREAM_MAX; i++) {
+            MIXER_STREAM_T *s = &mixer->stream[i];
+            if (false == s->in_use) {
+                continue;
+            }
+            uint32_t produced = __mixer_stream_mix(s, mixer->mix, mixer->frame_samples);
+            if (produced) {
+                tal_semaphore_post(s->room_sem);
+            }
+            frame_len = MIXER_MAX(frame_len, produced);
+        }
+        tal_mutex_unlock(mixer->mutex);
+
+        if (0 == frame_len) {
+            tal_semaphore_wait(mixer->data_sem, SEM_WAIT_FOREVER);
+            continue;
+        }
+
+        // a short stream is not padded, the device only gets what was mixed
+        __mixer_saturate(mixer->mix, mixer->out, frame_len);
+        tdl_audio_play(mixer->audio_hdl, (uint8_t *)mixer->out, frame_len * sizeof(int16_t));
+    }
+}
+
+static void __mixer_stream_free(MIXER_STREAM_T *s)
+{
+    if (s->ring_buf) {
+        tal_free(s->ring_buf);
+    }
+    if (s->coef) {
+        tal_free(s->coef);
+    }
+    if (s->room_sem) {
+        tal_semaphore_release(s->room_sem);
+    }
+    memset(s, 0, sizeof(MIXER_STREAM_T));
+}
+
+static void __mixer_free(MIXER_T *mixer)
+{
+    uint32_t i = 0;
+
+    for (i = 0; i < TDL_AUDIO_MIXER_STREAM_MAX; i++) {
+        if (mixer->stream[i].in_use) {
+            __mixer_stream_free(&mixer->stream[i]);
+        }
+    }
+    if (mixer->mix) {
+        tal_free(mixer->mix);
+    }
+    if (mixer->out) {
+        tal_free(mixer->out);
+    }
+    if (mixer->data_sem) {
+        tal_semaphore_release(mixer->data_sem);
+    }
+    if (mixer->mutex) {
+        tal_mutex_release(mixer->mutex);
+    }
+    tal_free(mixer);
+}
+
+OPERATE_RET tdl_audio_mixer_create(TDL_AUDIO_HANDLE_T handle, TDL_AUDIO_MIXER_CFG_T *cfg,
+                                   TDL_AUDIO_MIXER_HANDLE_T *mixer)
+{
+    OPERATE_RET rt = OPRT_OK;
+    MIXER_T *mix = NULL;
+
+    TUYA_CHECK_NULL_RETURN(handle, OPRT_INVALID_PARM);
+    TUYA_CHECK_NULL_RETURN(cfg, OPRT_INVALID_PARM);
+    TUYA_CHECK_NULL_RETURN(mixer, OPRT_INVALID_PARM);
+
+    if (false == __mixer_rate_is_valid(cfg->out_rate)) {
+        PR_ERR("mixer not support out rate %d", cfg->out_rate);
+        return OPRT_NOT_SUPPORTED;
+    }
+
+    mix = (MIXER_T *)tal_malloc(sizeof(MIXER_T));
+    TUYA_CHECK_NULL_RETURN(mix, OPRT_MALLOC_FAILED);
+    memset(mix, 0, sizeof(MIXER_T));
+
+    mix->audio_hdl = handle;
+    mix->out_rate = cfg->out_rate;
+    mix->frame_samples = cfg->out_rate * (cfg->frame_ms ? cfg->frame_ms : MIXER_DEFAULT_FRAME_MS) / 1000;
+
+    mix->mix = tal_malloc(mix->frame_samples * sizeof(int32_t));
+    mix->out = tal_malloc(mix->frame_samples * sizeof(int16_t));
+    if (NULL == mix->mix || NULL == mix->out) {
+        rt = OPRT_MALLOC_FAILED;
+        goto __ERR;
+    }
+
+    TUYA_CALL_ERR_GOTO(tal_mutex_create_init(&mix->mutex), __ERR);
+    TUYA_CALL_ERR_GOTO(tal_semaphore_create_init(&mix->data_sem, 0, 1), __ERR);
+
+    THREAD_CFG_T thrd_cfg = {
+        .stackDepth = cfg->stack_size ? cfg->stack_size : MIXER_DEFAULT_STACK,
+        .priority = cfg->priority ? cfg->priority : THREAD_PRIO_1,
+        .thrdname = "audio_mixer",
+    };
+    TUYA_CALL_ERR_GOTO(tal_thread_create_and_start(&mix->thrd_hdl, NULL, NULL, __mixer_task, mix, &thrd_cfg),
+                       __ERR);
+
+    *mixer = (TDL_AUDIO_MIXER_HANDLE_T)mix;
+
+    return OPRT_OK;
+
+__ERR:
+    __mixer_free(mix);
+
+    return rt;
+}
+
+OPERATE_RET tdl_audio_mixer_destroy(TDL_AUDIO_MIXER_HANDLE_T mixer)
+{
+    OPERATE_RET rt = OPRT_OK;
+    MIXER_T *mix = (MIXER_T *)mixer;
+
+    TUYA_CHECK_NULL_RETURN(mix, OPRT_INVALID_PARM);
+
+    TUYA_CALL_ERR_RETURN(tal_thread_delete(mix->thrd_hdl));
+    tal_semaphore_post(mix->data_sem);
+    while (THREAD_STATE_DELETE != tal_thread_get_state(mix->thrd_hdl)) {
+        tal_system_sleep(10);
+    }
+
+    __mixer_free(mix);
+
+    return rt;
+}
+
+OPERATE_RET tdl_audio_mixer_stream_open(TDL_AUDIO_MIXER_HANDLE_T mixer, TDL_AUDIO_MIXER_STREAM_CFG_T *cfg,
+                                        TDL_AUDIO_MIXER_STREAM_T *stream)
+{
+    OPERATE_RET rt = OPRT_OK;
+    MIXER_T *mix = (MIXER_T *)mixer;
+    MIXER_STREAM_T *s = NULL;
+    uint32_t i = 0, buf_len = 0;
+
+    TUYA_CHECK_NULL_RETURN(mix, OPRT_INVALID_PARM);
+    TUYA_CHECK_NULL_RETURN(cfg, OPRT_INVALID_PARM);
+    TUYA_CHECK_NULL_RETURN(stream, OPRT_INVALID_PARM);
+
+    if (false == __mixer_rate_is_valid(cfg->rate) || (1 != cfg->channels && 2 != cfg->channels)) {
+        PR_ERR("mixer not support stream %d/%d", cfg->rate, cfg->channels);
+        return OPRT_NOT_SUPPORTED;
+    }
+
+    tal_mutex_lock(mix->mutex);
+    for (i = 0; i < TDL_AUDIO_MIXER_STREAM_MAX; i++) {
+        if (false == mix->stream[i].in_use) {
+            s = &mix->stream[i];
+            break;
+        }
+    }
+    if (NULL == s) {
+        tal_mutex_unlock(mix->mutex);
+        PR_ERR("mixer stream full");
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    memset(s, 0, sizeof(MIXER_STREAM_T));
+    s->mixer = mix;
+    s->rate = cfg->rate;
+    s->channels = cfg->channels;
+    s->sample_bytes = cfg->channels * sizeof(int16_t);
+    s->gain_q15 = MIXER_MIN(cfg->gain, TDL_AUDIO_MIXER_GAIN_MAX) * MIXER_UNITY_Q15 / TDL_AUDIO_MIXER_GAIN_MAX;
+    s->acc = mix->out_rate;
+
+    // one spare input frame keeps every ring position frame aligned
+    buf_len = cfg->rate * (cfg->buf_ms ? cfg->buf_ms : MIXER_DEFAULT_BUF_MS) / 1000 * s->sample_bytes;
+    s->ring_buf = tal_malloc(buf_len + s->sample_bytes);
+    if (NULL == s->ring_buf) {
+        rt = OPRT_MALLOC_FAILED;
+        goto __ERR;
+    }
+    spsc_ring_init(&s->ring, s->ring_buf, buf_len + s->sample_bytes);
+
+    if (cfg->rate != mix->out_rate) {
+        s->coef = __mixer_coef_create(cfg->rate, mix->out_rate);
+        if (NULL == s->coef) {
+            rt = OPRT_MALLOC_FAILED;
+            goto __ERR;
+        }
+    }
+
+    TUYA_CALL_ERR_GOTO(tal_semaphore_create_init(&s->room_sem, 0, 1), __ERR);
+
+    s->in_use = true;
+    tal_mutex_unlock(mix->mutex);
+
+    *stream = (TDL_AUDIO_MIXER_STREAM_T)s;
+
+    return OPRT_OK;
+
+__ERR:
+    __mixer_stream_free(s);
+    tal_mutex_unlock(mix->mutex);
+
+    return rt;
+}
+
+OPERATE_RET tdl_audio_mixer_stream_close(TDL_AUDIO_MIXER_STREAM_T stream)
+{
+    MIXER_STREAM_T *s = (MIXER_STREAM_T *)stream;
+
+    TUYA_CHECK_NULL_RETURN(s, OPRT_INVALID_PARM);
+    TUYA_CHECK_NULL_RETURN(s->mixer, OPRT_INVALID_PARM);
+
+    MUTEX_HANDLE mutex = s->mixer->mutex;
+
+    tal_mutex_lock(mutex);
+    __mixer_stream_free(s);
+    tal_mutex_unlock(mutex);
+
+    return OPRT_OK;
+}
+
+int tdl_audio_mixer_stream_write(TDL_AUDIO_MIXER_STREAM_T stream, uint8_t *data, uint32_t len, uint32_t timeout_ms)
+{
+    MIXER_STREAM_T *s = (MIXER_STREAM_T *)stream;
+    uint32_t written = 0;
+
+    if (NULL == s || false == s->in_use || NULL == data) {
+        return OPRT_INVALID_PARM;
+    }
+
+    len -= len % s->sample_bytes;
+    while (written < len) {
+        uint32_t room = spsc_ring_free(&s->ring);
+        room -= room % s->sample_bytes;
+        if (room) {
+            written += spsc_ring_write(&s->ring, data + written, MIXER_MIN(room, len - written));
+            tal_semaphore_post(s->mixer->data_sem);
+            continue;
+        }
+        if (OPRT_OK != tal_semaphore_wait(s->room_sem, timeout_ms)) {
+            break;
+        }
+    }
+
+    return (int)written;
+}
+
+OPERATE_RET tdl_audio_mixer_stream_flush(TDL_AUDIO_MIXER_STREAM_T stream)
+{
+    MIXER_STREAM_T *s = (MIXER_STREAM_T *)stream;
+
+    TUYA_CHECK_NULL_RETURN(s, OPRT_INVALID_PARM);
+
+    spsc_ring_flush_request(&s->ring);
+    tal_semaphore_post(s->room_sem);
+
+    return OPRT_OK;
+}
+
+OPERATE_RET tdl_audio_mixer_stream_gain_set(TDL_AUDIO_MIXER_STREAM_T stream, uint8_t gain)
+{
+    MIXER_STREAM_T *s = (MIXER_STREAM_T *)stream;
+
+    TUYA_CHECK_NULL_RETURN(s, OPRT_INVALID_PARM);
+
+    s->gain_q15 = MIXER_MIN(gain, TDL_AUDIO_MIXER_GAIN_MAX) * MIXER_UNITY_Q15 / TDL_AUDIO_MIXER_GAIN_MAX;
+
+    return OPRT_OK;
+}
+
+uint32_t tdl_audio_mixer_stream_pending(TDL_AUDIO_MIXER_STREAM_T stream)
+{
+    MIXER_STREAM_T *s = (MIXER_STREAM_T *)stream;
+
+    if (NULL == s) {
+        return 0;
+    }
+
+    return spsc_ring_used(&s->ring);
+}
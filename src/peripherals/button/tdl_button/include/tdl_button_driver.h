@@ -35,8 +35,8 @@ typedef void *DEVICE_BUTTON_HANDLE;
 typedef void (*TDL_BUTTON_CB)(void *arg);
 
 typedef enum {
-    BUTTON_TIMER_SCAN_MODE = 0,
-    BUTTON_IRQ_MODE,
+    BUTTON_TIMER_SCAN_MODE = 0, // scanned every tdl_button_set_scan_time() forever
+    BUTTON_IRQ_MODE,            // an edge starts the scan, it stops once every button is idle
 } TDL_BUTTON_MODE_E;
 
 typedef struct {
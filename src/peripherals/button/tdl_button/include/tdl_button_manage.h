@@ -120,6 +120,7 @@ OPERATE_RET tdl_button_deep_sleep_ctrl(uint8_t enable);
 
 /**
  * @brief set button task stack size
+ *        buttons are sampled on the shared input scheduler thread, call before the first button is created
  *
  * @param[in] size stack size
  * @return Function Operation Result  OPRT_OK is ok other is fail
@@ -157,6 +158,7 @@ OPERATE_RET tdl_button_set_level(TDL_BUTTON_HANDLE handle, TUYA_GPIO_LEVEL_E lev
 
 /**
  * @brief set button scan time, default is 10ms
+ *        rounded up to a multiple of TDL_INPUT_SCHED_TICK_MS
  * @param[in] time_ms button scan time
  * @return OPRT_OK if successful
  */
@@ -20,9 +20,10 @@
  * - Power-on button state recovery detection
  * - Efficient resource management with dynamic allocation
  *
- * The implementation creates dedicated tasks for button scanning and provides
- * a unified interface for various button hardware implementations through the
- * TDD (Tuya Device Driver) layer abstraction.
+ * Buttons are sampled from the shared input scheduler (tdl_input_sched.h)
+ * instead of a thread of their own, and provides a unified interface for
+ * various button hardware implementations through the TDD (Tuya Device Driver)
+ * layer abstraction.
  *
  * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
  *
@@ -32,15 +33,14 @@
 #include "string.h"
 #include "stdint.h"
 
-#include "tal_semaphore.h"
 #include "tal_mutex.h"
 #include "tal_system.h"
 
 #include "tal_memory.h"
 #include "tal_log.h"
-#include "tal_thread.h"
 #include "tuya_list.h"
 
+#include "tdl_input_sched.h"
 #include "tdl_button_driver.h"
 #include "tdl_button_manage.h"
 #include "tdd_button_gpio.h"
@@ -57,16 +57,14 @@
 #define TDL_LONG_START_VAILD_TIMER 1500  // ms
 #define TDL_LONG_KEEP_TIMER        100   // ms
 #define TDL_BUTTON_DEBOUNCE_TIME   60    // ms
-#define TDL_BUTTON_IRQ_SCAN_TIME   10000 // ms
 #define TDL_BUTTON_SCAN_TIME       10    // 10ms
-#define TDL_BUTTON_IRQ_SCAN_CNT    (TDL_BUTTON_IRQ_SCAN_TIME / tdl_button_scan_time)
 #define TOUCH_DELAY                500 // Interval time 500ms for single/double click recognition
 #define PUT_EVENT_CB(btn, name, ev, arg)                                                                               \
     do {                                                                                                               \
+        __tdl_button_post_event(name, ev);                                                                             \
         if (btn.list_cb[ev])                                                                                           \
             btn.list_cb[ev](name, ev, arg);                                                                            \
     } while (0)
-#define TDL_BUTTON_TASK_STACK_SIZE (2048)
 
 /***********************************************************
 ***********************typedef define***********************
@@ -117,13 +115,12 @@ typedef struct {
 #endif
 
 typedef struct {
-    uint8_t scan_task_flag;   /*Scan thread flag*/
-    uint8_t irq_task_flag;    /*Interrupt thread flag*/
-    uint8_t task_mode;        /*Thread type*/
-    SEM_HANDLE irq_semaphore; /*Interrupt semaphore*/
-    uint32_t irq_scan_cnt;    /*Interrupt thread disconnection count*/
-    MUTEX_HANDLE mutex;       /*Mutex lock*/
-} TDL_BUTTON_LOCAL_T;         // TDL local parameters
+    uint8_t scan_task_flag;           /*Scan entry flag*/
+    uint8_t irq_task_flag;            /*Interrupt entry flag*/
+    uint8_t task_mode;                /*Entry type*/
+    TDL_INPUT_SCHED_HANDLE sched_hdl; /*Input scheduler entry*/
+    MUTEX_HANDLE mutex;               /*Mutex lock*/
+} TDL_BUTTON_LOCAL_T;                 // TDL local parameters
 
 /***********************************************************
 ***********************variable define**********************
@@ -131,20 +128,15 @@ typedef struct {
 TDL_BUTTON_LOCAL_T tdl_button_local = {.irq_task_flag = FALSE,
                                        .scan_task_flag = FALSE,
                                        .task_mode = FALSE,
-                                       .irq_semaphore = NULL,
-                                       .irq_scan_cnt = TDL_BUTTON_IRQ_SCAN_TIME / TDL_BUTTON_SCAN_TIME,
+                                       .sched_hdl = NULL,
                                        .mutex = NULL};
 
-THREAD_HANDLE scan_thread_handle = NULL; // Scan thread handle
-THREAD_HANDLE irq_thread_handle = NULL;  // Interrupt scan thread handle
-
 TDL_BUTTON_LIST_HEAD_T *p_button_list = NULL; // Single button list head
 // TDL_BUTTON_LIST_HEAD_T *p_combine_button_list = NULL;//Combination button list head
 
 static uint8_t g_tdl_button_list_exist = FALSE; // Single button list head initialization flag
 // static uint8_t g_tdl_combine_button_list_exist = FALSE;//Combination button list head initialization flag
 static uint8_t g_tdl_button_scan_mode_exist = 0xFF;
-static uint32_t sg_bt_task_stack_size = TDL_BUTTON_TASK_STACK_SIZE;
 static uint8_t tdl_button_scan_time = TDL_BUTTON_SCAN_TIME;
 
 /***********************************************************
@@ -154,6 +146,18 @@ static OPERATE_RET __tdl_get_operate_info(TDL_BUTTON_LIST_NODE_T *p_node, TDL_BU
 static OPERATE_RET __tdl_button_scan_task(uint8_t enable);
 static OPERATE_RET __tdl_button_irq_task(uint8_t enable);
 
+// Also queue the event for readers of the shared input queue
+static void __tdl_button_post_event(char *name, uint8_t event)
+{
+    TDL_INPUT_EVENT_T input_ev = {
+        .src = TDL_INPUT_SRC_BUTTON,
+        .event = event,
+        .dev = name,
+    };
+
+    tdl_input_event_post(&input_ev);
+}
+
 // Generate single button list head
 static OPERATE_RET __tdl_button_list_init(void)
 {
@@ -163,11 +167,6 @@ static OPERATE_RET __tdl_button_list_init(void)
             return OPRT_MALLOC_FAILED;
         }
 
-        if (tal_semaphore_create_init(&tdl_button_local.irq_semaphore, 0, 1) != 0) {
-            PR_ERR("tdl_semaphore_init err");
-            return OPRT_COM_ERROR;
-        }
-
         if (tal_mutex_create_init(&tdl_button_local.mutex) != 0) {
             PR_ERR("tdl_mutex_init err");
             return OPRT_COM_ERROR;
@@ -396,9 +395,6 @@ static void __tdl_button_state_handle(TDL_BUTTON_LIST_NODE_T *p_node)
     case 0: {
         // PR_NOTICE("case0:tick=%d",p_node->device_data.ticks);
         if (p_node->device_data.status != 0) {
-            if (p_node->device_data.dev_cfg.button_mode == BUTTON_IRQ_MODE) {
-                tdl_button_local.irq_scan_cnt = 0;
-            }
             /*Trigger press down event*/
             /*Trigger press down event*/
             p_node->device_data.ticks = 0;
@@ -418,9 +414,6 @@ static void __tdl_button_state_handle(TDL_BUTTON_LIST_NODE_T *p_node)
     case 1: {
         // PR_NOTICE("case1:tick=%d",p_node->device_data.ticks);
         if (p_node->device_data.status != 0) {
-            if (p_node->device_data.dev_cfg.button_mode == BUTTON_IRQ_MODE) {
-                tdl_button_local.irq_scan_cnt = 0;
-            }
             if (p_node->user_data.button_cfg.long_start_valid_time == 0) {
                 // Long press valid time is 0, do not execute long press
                 // Long press valid time is 0, do not execute long press
@@ -456,9 +449,6 @@ static void __tdl_button_state_handle(TDL_BUTTON_LIST_NODE_T *p_node)
         // PR_NOTICE("case2");
         if (p_node->device_data.status != 0) {
             /*press again*/
-            if (p_node->device_data.dev_cfg.button_mode == BUTTON_IRQ_MODE) {
-                tdl_button_local.irq_scan_cnt = 0;
-            }
             p_node->device_data.repeat++;
             p_node->device_data.pre_event = p_node->device_data.now_event;
             p_node->device_data.now_event = TDL_BUTTON_PRESS_DOWN;
@@ -533,9 +523,6 @@ static void __tdl_button_state_handle(TDL_BUTTON_LIST_NODE_T *p_node)
         if (p_node->device_data.status != 0) {
             /*Trigger long press hold event*/
             /*Trigger long press hold event*/
-            if (p_node->device_data.dev_cfg.button_mode == BUTTON_IRQ_MODE) {
-                tdl_button_local.irq_scan_cnt = 0;
-            }
             hold_tick = p_node->user_data.button_cfg.long_keep_timer / tdl_button_scan_time;
             if (hold_tick == 0) {
                 hold_tick = 1;
@@ -578,12 +565,10 @@ static void __tdl_button_state_handle(TDL_BUTTON_LIST_NODE_T *p_node)
     return;
 }
 
-// Button interrupt callback function
+// Button interrupt callback function: wakes the interrupt scan entry, an edge while it scans costs one extra pass
 static void __tdl_button_irq_cb(void *arg)
 {
-    if (tdl_button_local.irq_scan_cnt >= TDL_BUTTON_IRQ_SCAN_CNT) {
-        tal_semaphore_post(tdl_button_local.irq_semaphore);
-    }
+    tdl_input_sched_kick(tdl_button_local.sched_hdl);
     return;
 }
 
@@ -668,13 +653,13 @@ OPERATE_RET tdl_button_create(char *name, TDL_BUTTON_CFG_T *button_cfg, TDL_BUTT
     }
 
     if (tdl_button_local.task_mode == BUTTON_IRQ_TASK) {
-        __tdl_button_irq_task(1);
+        ret = __tdl_button_irq_task(1);
         if (OPRT_OK != ret) {
             PR_ERR("tdl create err");
             return OPRT_COM_ERROR;
         }
     } else {
-        __tdl_button_scan_task(1);
+        ret = __tdl_button_scan_task(1);
         if (OPRT_OK != ret) {
             PR_ERR("tdl create err");
             return OPRT_COM_ERROR;
@@ -889,8 +874,21 @@ static void __tdl_button_handle(TDL_BUTTON_LIST_NODE_T *p_node)
     return;
 }
 
-// Button scan task: single button, combination button
-static void __tdl_button_scan_thread(void *arg)
+// A button is idle when it is released, settled and its state machine has finished
+static uint8_t __tdl_button_is_idle(TDL_BUTTON_LIST_NODE_T *p_node)
+{
+    if (p_node->device_data.init_flag != TRUE) {
+        return TRUE;
+    }
+
+    return (p_node->device_data.flag == 0 && p_node->device_data.status == 0 &&
+            p_node->device_data.debounce_cnt == 0)
+               ? TRUE
+               : FALSE;
+}
+
+// Button scan entry: single button, combination button, sampled every scan time forever
+static bool __tdl_button_scan_sample(void *arg)
 {
     TDL_BUTTON_LIST_HEAD_T *p_head = p_button_list;
     // TDL_BUTTON_LIST_HEAD_T *p_combine_head = p_combine_button_list;
@@ -898,75 +896,64 @@ static void __tdl_button_scan_thread(void *arg)
     // TDL_BUTTON_COMBINE_LIST_NODE_T *p_combine_node = NULL;
     LIST_HEAD *pos1 = NULL;
 
-    while (1) {
-        tuya_list_for_each(pos1, &p_head->hdr)
-        {
-            p_node = tuya_list_entry(pos1, TDL_BUTTON_LIST_NODE_T, hdr);
-            if ((p_node != NULL) && (p_node->device_data.dev_cfg.button_mode == BUTTON_TIMER_SCAN_MODE)) {
-                tal_mutex_lock(p_node->button_mutex);
-                __tdl_button_handle(p_node);
-                tal_mutex_unlock(p_node->button_mutex);
-            }
+    tuya_list_for_each(pos1, &p_head->hdr)
+    {
+        p_node = tuya_list_entry(pos1, TDL_BUTTON_LIST_NODE_T, hdr);
+        if ((p_node != NULL) && (p_node->device_data.dev_cfg.button_mode == BUTTON_TIMER_SCAN_MODE)) {
+            tal_mutex_lock(p_node->button_mutex);
+            __tdl_button_handle(p_node);
+            tal_mutex_unlock(p_node->button_mutex);
         }
+    }
 #if (COMBINE_BUTTON_ENABLE == 1)
-        // Combination key callback execution
-        tuya_list_for_each(pos2, &p_combine_head->hdr)
-        {
-            p_combine_node = tuya_list_entry(pos2, TDL_BUTTON_COMBINE_LIST_NODE_T, hdr);
-            if (p_combine_node->combine_cb) {
-                p_combine_node->combine_cb();
-            }
+    // Combination key callback execution
+    tuya_list_for_each(pos2, &p_combine_head->hdr)
+    {
+        p_combine_node = tuya_list_entry(pos2, TDL_BUTTON_COMBINE_LIST_NODE_T, hdr);
+        if (p_combine_node->combine_cb) {
+            p_combine_node->combine_cb();
         }
-#endif
-        tal_system_sleep(tdl_button_scan_time);
     }
+#endif
+    return true;
 }
 
-// Button interrupt scan task
-static void __tdl_button_irq_thread(void *arg)
+// Button interrupt scan entry: parked until an edge, sampled every scan time while a button is active
+static bool __tdl_button_irq_sample(void *arg)
 {
     TDL_BUTTON_LIST_HEAD_T *p_head = p_button_list;
     // TDL_BUTTON_LIST_HEAD_T *p_combine_head = p_combine_button_list;
     TDL_BUTTON_LIST_NODE_T *p_node = NULL;
     // TDL_BUTTON_COMBINE_LIST_NODE_T *p_combine_node = NULL;
     LIST_HEAD *pos1 = NULL;
+    uint8_t is_idle = TRUE;
 
-    while (1) {
-        PR_NOTICE("semaphore wait");
-        tal_semaphore_wait(tdl_button_local.irq_semaphore, SEM_WAIT_FOREVER);
-        tdl_button_local.irq_scan_cnt = 0;
-        PR_NOTICE("semaphore across");
-
-        while (1) {
-            tuya_list_for_each(pos1, &p_head->hdr)
-            {
-                p_node = tuya_list_entry(pos1, TDL_BUTTON_LIST_NODE_T, hdr);
-                if ((p_node != NULL) && (p_node->device_data.dev_cfg.button_mode == BUTTON_IRQ_MODE)) {
-                    tal_mutex_lock(p_node->button_mutex);
-                    __tdl_button_handle(p_node);
-                    tal_mutex_unlock(p_node->button_mutex);
-                }
+    tuya_list_for_each(pos1, &p_head->hdr)
+    {
+        p_node = tuya_list_entry(pos1, TDL_BUTTON_LIST_NODE_T, hdr);
+        if ((p_node != NULL) && (p_node->device_data.dev_cfg.button_mode == BUTTON_IRQ_MODE)) {
+            tal_mutex_lock(p_node->button_mutex);
+            __tdl_button_handle(p_node);
+            if (!__tdl_button_is_idle(p_node)) {
+                is_idle = FALSE;
             }
+            tal_mutex_unlock(p_node->button_mutex);
+        }
+    }
 #if (COMBINE_BUTTON_ENABLE == 1)
-            // Combination key callback execution
-            if (tdl_button_local.scan_task_flag == FALSE) {
-                tuya_list_for_each(pos2, &p_combine_head->hdr)
-                {
-                    p_combine_node = tuya_list_entry(pos2, TDL_BUTTON_COMBINE_LIST_NODE_T, hdr);
-                    if (p_combine_node->combine_cb) {
-                        p_combine_node->combine_cb();
-                    }
-                }
-            }
-#endif
-            // Interrupt disconnection count check
-            if (++tdl_button_local.irq_scan_cnt >= TDL_BUTTON_IRQ_SCAN_CNT) {
-                break;
-            } else {
-                tal_system_sleep(tdl_button_scan_time);
+    // Combination key callback execution
+    if (tdl_button_local.scan_task_flag == FALSE) {
+        tuya_list_for_each(pos2, &p_combine_head->hdr)
+        {
+            p_combine_node = tuya_list_entry(pos2, TDL_BUTTON_COMBINE_LIST_NODE_T, hdr);
+            if (p_combine_node->combine_cb) {
+                p_combine_node->combine_cb();
             }
         }
     }
+#endif
+    // Debounce, long press and repeat timing only run while a button is active, the next edge kicks the entry
+    return (is_idle) ? false : true;
 }
 
 // Enable and disable button scan task
@@ -976,28 +963,20 @@ static OPERATE_RET __tdl_button_scan_task(uint8_t enable)
 
     if (tdl_button_local.task_mode & BUTTON_SCAN_TASK) {
         if (enable != 0) {
-            // Create scan task
+            // Add scan entry
             if (tdl_button_local.scan_task_flag == FALSE) {
-
-                THREAD_CFG_T thrd_param = {0};
-
-                thrd_param.thrdname = "button_scan";
-                thrd_param.priority = THREAD_PRIO_1;
-                thrd_param.stackDepth = sg_bt_task_stack_size;
-                if (NULL == scan_thread_handle) {
-                    ret = tal_thread_create_and_start(&scan_thread_handle, NULL, NULL, __tdl_button_scan_thread, NULL,
-                                                      &thrd_param);
-                    if (OPRT_OK != ret) {
-                        PR_ERR("scan_task create error!");
-                        return ret;
-                    }
+                ret = tdl_input_sched_add(__tdl_button_scan_sample, NULL, tdl_button_scan_time, false,
+                                          &tdl_button_local.sched_hdl);
+                if (OPRT_OK != ret) {
+                    PR_ERR("scan_task create error!");
+                    return ret;
                 }
                 tdl_button_local.scan_task_flag = TRUE;
-                PR_DEBUG("button_scan task stack size:%d", sg_bt_task_stack_size);
             }
-        } else {
+        } else if (tdl_button_local.scan_task_flag == TRUE) {
             // Close scan
-            tal_thread_delete(scan_thread_handle);
+            tdl_input_sched_remove(tdl_button_local.sched_hdl);
+            tdl_button_local.sched_hdl = NULL;
             tdl_button_local.scan_task_flag = FALSE;
         }
     }
@@ -1010,29 +989,22 @@ static OPERATE_RET __tdl_button_irq_task(uint8_t enable)
     OPERATE_RET ret = OPRT_COM_ERROR;
     if (tdl_button_local.task_mode & BUTTON_IRQ_TASK) {
         if (enable != 0) {
-            // Create interrupt scan task
+            // Add interrupt scan entry, parked until the first edge
             if (tdl_button_local.irq_task_flag == FALSE) {
-                THREAD_CFG_T thrd_param = {0};
-
-                thrd_param.thrdname = "button_irq";
-                thrd_param.priority = THREAD_PRIO_1;
-                thrd_param.stackDepth = sg_bt_task_stack_size;
-                if (NULL == irq_thread_handle) {
-                    ret = tal_thread_create_and_start(&irq_thread_handle, NULL, NULL, __tdl_button_irq_thread, NULL,
-                                                      &thrd_param);
-                    if (OPRT_OK != ret) {
-                        PR_ERR("irq_task create error!");
-                        return ret;
-                    }
+                ret = tdl_input_sched_add(__tdl_button_irq_sample, NULL, tdl_button_scan_time, true,
+                                          &tdl_button_local.sched_hdl);
+                if (OPRT_OK != ret) {
+                    PR_ERR("irq_task create error!");
+                    return ret;
                 }
                 tdl_button_local.irq_task_flag = TRUE;
-                PR_DEBUG("button_irq task stack size:%d", sg_bt_task_stack_size);
             } else {
                 PR_WARN("button irq tast have already creat");
             }
-        } else {
+        } else if (tdl_button_local.irq_task_flag == TRUE) {
             // Close interrupt scan
-            tal_thread_delete(irq_thread_handle);
+            tdl_input_sched_remove(tdl_button_local.sched_hdl);
+            tdl_button_local.sched_hdl = NULL;
             tdl_button_local.irq_task_flag = FALSE;
         }
     }
@@ -1198,9 +1170,8 @@ OPERATE_RET tdl_button_register(char *name, TDL_BUTTON_CTRL_INFO *button_ctrl_in
  */
 OPERATE_RET tdl_button_set_task_stack_size(uint32_t size)
 {
-    sg_bt_task_stack_size = size;
-
-    return OPRT_OK;
+    // Button callbacks run on the shared input scheduler thread
+    return tdl_input_sched_set_stack_size(size);
 }
 
 /**
@@ -1269,6 +1240,10 @@ OPERATE_RET tdl_button_set_scan_time(uint8_t time_ms)
     if (time_ms < TDL_BUTTON_SCAN_TIME)
         return OPRT_INVALID_PARM;
     tdl_button_scan_time = time_ms;
-    tdl_button_local.irq_scan_cnt = TDL_BUTTON_IRQ_SCAN_TIME / time_ms;
+    // Re-add a running entry so it is sampled at the new period
+    if (tdl_button_local.sched_hdl) {
+        tdl_button_deep_sleep_ctrl(0);
+        return tdl_button_deep_sleep_ctrl(1);
+    }
     return OPRT_OK;
 }
@@ -43,6 +43,9 @@ typedef struct {
     OPERATE_RET (*rst     )(TUYA_CAMERA_IO_CTRL_T *rst_pin, void *arg);
     OPERATE_RET (*init    )(DVP_I2C_CFG_T *i2c, void *arg);
     OPERATE_RET (*set_ppi )(DVP_I2C_CFG_T *i2c, TUYA_CAMERA_PPI_E ppi, uint16_t fps, void *arg);
+    // optional, crops win of the sensor image and scales it to width x height
+    OPERATE_RET (*set_window)(DVP_I2C_CFG_T *i2c, const TDL_CAMERA_WINDOW_T *win, uint16_t width, uint16_t height,\
+                              void *arg);
 }TDD_DVP_SR_INTFS_T;
 
 /***********************************************************
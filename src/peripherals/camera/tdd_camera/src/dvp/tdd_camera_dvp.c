@@ -159,6 +159,15 @@ static OPERATE_RET __tdd_camera_dvp_open(TDD_CAMERA_DEV_HANDLE_T device, TDD_CAM
         TUYA_CALL_ERR_RETURN(dvp_dev->intfs.set_ppi(&p_usr_cfg->i2c, ppi, cfg->fps, dvp_dev->intfs.arg));
     }
 
+    if(cfg->window.width && cfg->window.height) {
+        if(NULL == dvp_dev->intfs.set_window) {
+            PR_ERR("sensor has no window support");
+            return OPRT_NOT_SUPPORTED;
+        }
+        TUYA_CALL_ERR_RETURN(dvp_dev->intfs.set_window(&p_usr_cfg->i2c, &cfg->window, cfg->width, cfg->height,\
+                                                       dvp_dev->intfs.arg));
+    }
+
     return rt;
 }
 
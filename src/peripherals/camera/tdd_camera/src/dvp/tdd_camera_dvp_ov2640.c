@@ -19,6 +19,10 @@
 #define OV2640_WRITE_ADDRESS (0x60)
 #define OV2640_READ_ADDRESS  (0x61)
 
+// UXGA, the sensor mode all dsp windows are taken from
+#define OV2640_SENSOR_WIDTH  (1600)
+#define OV2640_SENSOR_HEIGHT (1200)
+
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
@@ -115,6 +119,68 @@ static OPERATE_RET __dvp_ov2640_init(DVP_I2C_CFG_T *i2c, void *arg)
     return OPRT_OK;
 }
 
+static OPERATE_RET __dvp_ov2640_set_window(DVP_I2C_CFG_T *i2c, const TDL_CAMERA_WINDOW_T *win,\
+                                           uint16_t width, uint16_t height, void *arg)
+{
+    if(NULL == i2c || NULL == win) {
+        return OPRT_INVALID_PARM;
+    }
+
+    (void)arg;
+
+    // the dsp sizes are in units of 4 pixels and the zoom only scales down
+    if(win->x + win->width > OV2640_SENSOR_WIDTH || win->y + win->height > OV2640_SENSOR_HEIGHT ||\
+       0 == width || 0 == height || width > win->width || height > win->height ||\
+       ((win->width | win->height | width | height) & 0x03)) {
+        PR_ERR("ov2640 window %d,%d %dx%d to %dx%d invalid", win->x, win->y, win->width, win->height, width, height);
+        return OPRT_INVALID_PARM;
+    }
+
+    uint16_t hsize = win->width / 4, vsize = win->height / 4;
+    uint16_t zmow = width / 4, zmoh = height / 4;
+    const uint8_t window_tab[][2] = {
+        {BANK_SEL, BANK_DSP},
+        {RESET, RESET_DVP},
+        {HSIZE8, OV2640_SENSOR_WIDTH / 8},
+        {VSIZE8, OV2640_SENSOR_HEIGHT / 8},
+        {HSIZE, hsize & 0xFF},
+        {VSIZE, vsize & 0xFF},
+        {XOFFL, win->x & 0xFF},
+        {YOFFL, win->y & 0xFF},
+        {VHYX, ((vsize >> 1) & 0x80) | ((win->y >> 4) & 0x70) | ((hsize >> 5) & 0x08) | ((win->x >> 8) & 0x07)},
+        {TEST, (hsize >> 2) & 0x80},
+        {ZMOW, zmow & 0xFF},
+        {ZMOH, zmoh & 0xFF},
+        {ZMHH, ((zmoh >> 6) & 0x04) | ((zmow >> 8) & 0x03)},
+        {R_DVP_SP, 0x82},
+        {RESET, 0x00},
+    };
+
+    __dvp_ov2640_update_reg(i2c->port, window_tab, CNTSOF(window_tab));
+
+    PR_NOTICE("ov2640 window %d,%d %dx%d to %dx%d", win->x, win->y, win->width, win->height, width, height);
+
+    return OPRT_OK;
+}
+
+// the largest centered window with the aspect of the frame
+static OPERATE_RET __dvp_ov2640_set_default_window(DVP_I2C_CFG_T *i2c, uint16_t width, uint16_t height)
+{
+    TDL_CAMERA_WINDOW_T win;
+
+    if((uint32_t)width * OV2640_SENSOR_HEIGHT >= (uint32_t)height * OV2640_SENSOR_WIDTH) {
+        win.width  = OV2640_SENSOR_WIDTH;
+        win.height = ((uint32_t)height * OV2640_SENSOR_WIDTH / width) & ~0x03;
+    } else {
+        win.width  = ((uint32_t)width * OV2640_SENSOR_HEIGHT / height) & ~0x03;
+        win.height = OV2640_SENSOR_HEIGHT;
+    }
+    win.x = (OV2640_SENSOR_WIDTH - win.width) / 2;
+    win.y = (OV2640_SENSOR_HEIGHT - win.height) / 2;
+
+    return __dvp_ov2640_set_window(i2c, &win, width, height, NULL);
+}
+
 static OPERATE_RET __dvp_ov2640_set_ppi(DVP_I2C_CFG_T *i2c, TUYA_CAMERA_PPI_E ppi, uint16_t fps, void *arg)
 {
     uint32_t i = 0; 
@@ -135,6 +201,12 @@ static OPERATE_RET __dvp_ov2640_set_ppi(DVP_I2C_CFG_T *i2c, TUYA_CAMERA_PPI_E pp
 
     if(ppi_init_tab) {
         __dvp_ov2640_update_reg(i2c->port, (const uint8_t (*)[2])ppi_init_tab->seq_tab, ppi_init_tab->tab_size);
+    } else {
+        uint16_t width = (uint32_t)ppi >> 16, height = (uint32_t)ppi & 0xFFFF;
+        if(width && height && width <= OV2640_SENSOR_WIDTH && height <= OV2640_SENSOR_HEIGHT &&\
+           0 == ((width | height) & 0x03)) {
+            __dvp_ov2640_set_default_window(i2c, width, height);
+        }
     }
 
     PR_NOTICE("__dvp_ov2640_set_ppi ppi:%x, fps:%d", ppi, fps);
@@ -155,6 +227,7 @@ OPERATE_RET tdd_camera_dvp_ov2640_register(char *name, TDD_DVP_SR_USR_CFG_T *cfg
         .rst      = __dvp_ov2640_reset,
         .init     = __dvp_ov2640_init,
         .set_ppi  = __dvp_ov2640_set_ppi,
+        .set_window = __dvp_ov2640_set_window,
     };
 
     return tdl_camera_dvp_device_register(name, &sg_dvp_sensor, &sr_intfs);
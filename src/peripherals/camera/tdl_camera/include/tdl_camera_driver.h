@@ -77,6 +77,7 @@ typedef struct {
     uint16_t                  width;
     uint16_t                  height;
     TDL_CAMERA_FMT_E          out_fmt;
+    TDL_CAMERA_WINDOW_T       window;
 } TDD_CAMERA_OPEN_CFG_T;
 
 typedef struct {
@@ -19,6 +19,16 @@ extern "C" {
 #define TDL_IMG_FMT_RAW_MASK       0x00FF
 #define TDL_IMG_FMT_ENCODED_MASK   0xFF00
 #define ENCODED_SHIFT(value)      ((value) << 8)
+
+// frame callbacks a device can have besides the ones in TDL_CAMERA_CFG_T
+#ifndef TDL_CAMERA_SUBSCRIBER_MAX
+#define TDL_CAMERA_SUBSCRIBER_MAX  4
+#endif
+
+// fps_x10 of TDL_CAMERA_STATS_T is measured over windows of this length
+#ifndef TDL_CAMERA_STATS_WINDOW_MS
+#define TDL_CAMERA_STATS_WINDOW_MS 1000
+#endif
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
@@ -63,6 +73,58 @@ typedef struct
 
 typedef OPERATE_RET (*TDL_CAMERA_GET_FRAME_CB)(TDL_CAMERA_HANDLE_T hdl,  TDL_CAMERA_FRAME_T *frame);
 
+typedef enum {
+    TDL_CAMERA_FRAME_RAW = 0,
+    TDL_CAMERA_FRAME_ENCODED,
+    TDL_CAMERA_FRAME_TYPE_MAX,
+} TDL_CAMERA_FRAME_TYPE_E;
+
+/**
+ * @brief What happens to frames the flow task can not keep up with.
+ */
+typedef enum {
+    TDL_CAMERA_DROP_NEWEST = 0,  // a full queue refuses the new frame
+    TDL_CAMERA_DROP_OLDEST,      // a full queue gives up its oldest frame
+    TDL_CAMERA_DROP_KEEP_LATEST, // the flow task skips to the newest queued frame
+} TDL_CAMERA_DROP_POLICY_E;
+
+typedef struct {
+    uint32_t count;
+    uint32_t last_ms;
+    uint32_t max_ms;
+    uint32_t total_ms;
+} TDL_CAMERA_TIME_T;
+
+typedef struct {
+    uint32_t posted;            // frames handed over by the driver
+    uint32_t dropped;           // released by the drop policy before any consumer saw them
+    uint32_t late;              // delivered more than one frame interval after capture
+    uint32_t skipped;           // subscriber calls left out by their fps limit
+    uint32_t no_buf;            // captures that found no free frame buffer
+
+    uint16_t fps_x10;           // frames posted per second over the last window, x10
+    uint8_t  queue_depth;       // frames of the device waiting for the flow task
+    uint8_t  queue_max;         // highest queue_depth seen
+    // buffer given to the driver until the frame is posted, for encoded
+    // frames this is the capture plus the encoding
+    TDL_CAMERA_TIME_T produce;
+    // frame callback and all subscribers of one frame
+    TDL_CAMERA_TIME_T consume;
+} TDL_CAMERA_STATS_T;
+
+typedef OPERATE_RET (*TDL_CAMERA_FRAME_NOTIFY_CB)(TDL_CAMERA_HANDLE_T hdl, TDL_CAMERA_FRAME_T *frame, void *arg);
+
+/**
+ * @brief Area of the full sensor image the sensor crops and scales down to
+ *        the frame size, so only those pixels cross the bus.
+ */
+typedef struct {
+    uint16_t                  x;
+    uint16_t                  y;
+    uint16_t                  width;  // 0 for the sensor default for the frame size
+    uint16_t                  height;
+} TDL_CAMERA_WINDOW_T;
+
 typedef struct {
     uint16_t                  fps;
     uint16_t                  width;
@@ -70,6 +132,7 @@ typedef struct {
     TDL_CAMERA_FMT_E          out_fmt;
     TDL_CAMERA_GET_FRAME_CB   get_frame_cb;
     TDL_CAMERA_GET_FRAME_CB   get_encoded_frame_cb;
+    TDL_CAMERA_WINDOW_T       window;
 }TDL_CAMERA_CFG_T;
 
 
@@ -85,6 +148,95 @@ OPERATE_RET tdl_camera_dev_open(TDL_CAMERA_HANDLE_T camera_hdl,  TDL_CAMERA_CFG_
 
 OPERATE_RET tdl_camera_dev_close(TDL_CAMERA_HANDLE_T camera_hdl);
 
+/**
+ * @brief Adds a frame callback to a device.
+ *
+ * Every subscriber of a type gets the same frame, after the callback given in
+ * TDL_CAMERA_CFG_T. The frame goes back to the pool when the callbacks return,
+ * unless one of them took a reference with tdl_camera_frame_retain().
+ *
+ * @param camera_hdl The camera device.
+ * @param type Raw or encoded frames.
+ * @param fps Frames per second the subscriber wants, 0 for every frame.
+ * @param cb Called from the frame flow task, keep it short. Slow work should
+ *           retain the frame and run in its own task.
+ * @param arg Passed to cb.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_camera_dev_subscribe(TDL_CAMERA_HANDLE_T camera_hdl, TDL_CAMERA_FRAME_TYPE_E type, uint16_t fps,\
+                                     TDL_CAMERA_FRAME_NOTIFY_CB cb, void *arg);
+
+/**
+ * @brief Removes a callback added by tdl_camera_dev_subscribe().
+ *
+ * @param camera_hdl The camera device.
+ * @param cb The callback.
+ * @param arg The argument it was added with.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_camera_dev_unsubscribe(TDL_CAMERA_HANDLE_T camera_hdl, TDL_CAMERA_FRAME_NOTIFY_CB cb, void *arg);
+
+/**
+ * @brief Sets how a device drops frames when its consumers fall behind.
+ *
+ * TDL_CAMERA_DROP_NEWEST is the default. TDL_CAMERA_DROP_OLDEST and
+ * TDL_CAMERA_DROP_KEEP_LATEST keep the latency of a live preview bounded.
+ *
+ * @param camera_hdl The camera device.
+ * @param policy The drop policy.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_camera_dev_set_drop_policy(TDL_CAMERA_HANDLE_T camera_hdl, TDL_CAMERA_DROP_POLICY_E policy);
+
+/**
+ * @brief Reads the frame counters of a device.
+ *
+ * @param camera_hdl The camera device.
+ * @param type Raw or encoded frames.
+ * @param stats Filled with the counters.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_camera_dev_get_stats(TDL_CAMERA_HANDLE_T camera_hdl, TDL_CAMERA_FRAME_TYPE_E type,\
+                                     TDL_CAMERA_STATS_T *stats);
+
+/**
+ * @brief Clears the frame counters of a device, the queue depth is kept.
+ *
+ * The counters of all devices are also shown by the `cam_stat` cli command.
+ *
+ * @param camera_hdl The camera device.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_camera_dev_reset_stats(TDL_CAMERA_HANDLE_T camera_hdl);
+
+/**
+ * @brief Keeps a frame after the frame callback returns.
+ *
+ * Only valid inside a frame callback, or on a frame already retained. The
+ * data must not be written, other consumers share it. Each retain needs a
+ * tdl_camera_frame_release(), the pool is small and a held frame is one the
+ * capture can not fill.
+ *
+ * @param frame The frame passed to the callback.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_camera_frame_retain(TDL_CAMERA_FRAME_T *frame);
+
+/**
+ * @brief Drops a reference taken by tdl_camera_frame_retain().
+ *
+ * @param frame The frame.
+ *
+ * @return None.
+ */
+void tdl_camera_frame_release(TDL_CAMERA_FRAME_T *frame);
+
 #ifdef __cplusplus
 }
 #endif
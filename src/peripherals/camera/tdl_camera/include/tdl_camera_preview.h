@@ -0,0 +1,98 @@
+/**
+ * @file tdl_camera_preview.h
+ * @brief Camera preview straight to a display, without going through a GUI.
+ *
+ * Raw YUV422 frames are converted to RGB565, scaled, rotated to the panel
+ * orientation and flushed from a task of their own. When the flow task
+ * delivers a frame faster than the preview shows it, the older pending frame
+ * is dropped, the picture on screen is never more than one frame behind.
+ *
+ * The conversion uses DMA2D when the platform has it and the video is not
+ * scaled. Scaling and rotation are done in software.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __TDL_CAMERA_PREVIEW_H__
+#define __TDL_CAMERA_PREVIEW_H__
+
+#include "tuya_cloud_types.h"
+#include "tdl_camera_manage.h"
+#include "tdl_display_manage.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+/**
+ * @brief Draws on a preview frame before it is flushed.
+ *
+ * @param fb The full frame buffer, in panel orientation.
+ * @param arg The overlay_arg of the config.
+ */
+typedef void (*TDL_CAMERA_PREVIEW_OVERLAY_CB)(TDL_DISP_FRAME_BUFF_T *fb, void *arg);
+
+typedef struct {
+    // video area on the screen, in unrotated (logical) coordinates
+    uint16_t                      x;
+    uint16_t                      y;
+    uint16_t                      width;  // 0 keeps the camera width
+    uint16_t                      height; // 0 keeps the camera height
+    // optional, e.g. to blend a UI layer over the video
+    TDL_CAMERA_PREVIEW_OVERLAY_CB overlay_cb;
+    void                         *overlay_arg;
+} TDL_CAMERA_PREVIEW_CFG_T;
+
+typedef struct {
+    uint32_t shown;   // frames flushed to the display
+    uint32_t dropped; // frames replaced by a newer one before they were shown
+} TDL_CAMERA_PREVIEW_STATS_T;
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+
+/**
+ * @brief Starts showing the raw frames of a camera on a display.
+ *
+ * The camera must be opened with YUV422 output and the display with RGB565,
+ * both at the sizes they will run at.
+ *
+ * @param camera_hdl The camera device.
+ * @param disp_hdl The display device, already opened.
+ * @param cfg Where the video goes.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_camera_preview_start(TDL_CAMERA_HANDLE_T camera_hdl, TDL_DISP_HANDLE_T disp_hdl,
+                                     TDL_CAMERA_PREVIEW_CFG_T *cfg);
+
+/**
+ * @brief Stops the preview, the last frame stays on the screen.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_camera_preview_stop(void);
+
+/**
+ * @brief Reads the preview counters.
+ *
+ * @param stats Filled with the counters.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_camera_preview_get_stats(TDL_CAMERA_PREVIEW_STATS_T *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TDL_CAMERA_PREVIEW_H__ */
@@ -0,0 +1,91 @@
+/**
+ * @file tdl_camera_snapshot.h
+ * @brief On demand JPEG snapshots of a camera.
+ *
+ * The camera encodes JPEG in hardware at the resolution it was opened with, a
+ * snapshot hands out the next complete JPEG frame by reference. Nothing is
+ * copied or re-encoded, the frame buffer can be sent as it is (for example as
+ * the payload of tuya_ai_send_biz_pkt()) and is given back with
+ * tdl_camera_snapshot_release(). Between snapshots the encoded frames are not
+ * touched.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __TDL_CAMERA_SNAPSHOT_H__
+#define __TDL_CAMERA_SNAPSHOT_H__
+
+#include "tuya_cloud_types.h"
+#include "tdl_camera_manage.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef enum {
+    TDL_CAMERA_SNAP_QVGA = 0, // 320x240, smallest upload
+    TDL_CAMERA_SNAP_480P,     // 480x480
+    TDL_CAMERA_SNAP_VGA,      // 640x480
+    TDL_CAMERA_SNAP_PRESET_MAX,
+} TDL_CAMERA_SNAP_PRESET_E;
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+
+/**
+ * @brief Fills the open config of a snapshot preset.
+ *
+ * The resolution is produced by the sensor and the JPEG engine, no scaling
+ * is done in software. The raw stream is kept when cfg already asks for it.
+ *
+ * @param preset The preset.
+ * @param fps Capture rate, a lower rate saves bus and PSRAM bandwidth.
+ * @param cfg Open config, width, height, fps and out_fmt are set.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_camera_snapshot_preset_cfg(TDL_CAMERA_SNAP_PRESET_E preset, uint16_t fps, TDL_CAMERA_CFG_T *cfg);
+
+/**
+ * @brief Enables snapshots on a camera opened with JPEG output.
+ *
+ * @param camera_hdl The camera device.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_camera_snapshot_init(TDL_CAMERA_HANDLE_T camera_hdl);
+
+/**
+ * @brief Waits for the next complete JPEG frame.
+ *
+ * @param timeout_ms Longest wait, one frame interval is typical.
+ * @param frame Set to the frame, must be given back with
+ *              tdl_camera_snapshot_release().
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_camera_snapshot_take(uint32_t timeout_ms, TDL_CAMERA_FRAME_T **frame);
+
+/**
+ * @brief Gives a snapshot back to the camera.
+ *
+ * @param frame The frame from tdl_camera_snapshot_take().
+ *
+ * @return None.
+ */
+void tdl_camera_snapshot_release(TDL_CAMERA_FRAME_T *frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TDL_CAMERA_SNAPSHOT_H__ */
@@ -4,6 +4,8 @@
  * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
  */
 
+#include <stdio.h>
+
 #include "tuya_cloud_types.h"
 #include "tuya_list.h"
 #include "tal_api.h"
@@ -16,8 +18,19 @@
 /***********************************************************
 ************************macro define************************
 ***********************************************************/
+// frames held by subscribers are not available to the capture, size the
+// pools for the longest a consumer keeps a frame
+#ifndef CAMERA_RAW_FRAME_BUFF_CNT
 #define CAMERA_RAW_FRAME_BUFF_CNT           (2)
+#endif
+#ifndef CAMERA_ENCODE_FRAME_BUFF_CNT
 #define CAMERA_ENCODE_FRAME_BUFF_CNT        (CAMERA_RAW_FRAME_BUFF_CNT << 2)
+#endif
+
+// frames waiting for the flow tasks, the drop policy applies when full
+#ifndef CAMERA_FRAME_QUEUE_DEPTH
+#define CAMERA_FRAME_QUEUE_DEPTH            (2)
+#endif
 
 #define CAMERA_RAW_PER_PIXEL_MAX_BYTE       (3)
 #define CAMERA_ENCODE_MIN_COMP_PCT          (20) // uint:ENCODE
@@ -33,6 +46,14 @@
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
+typedef struct {
+    TDL_CAMERA_FRAME_TYPE_E     type;
+    uint16_t                    fps;        // 0: every frame
+    uint16_t                    credit;
+    TDL_CAMERA_FRAME_NOTIFY_CB  cb;
+    void                       *arg;
+} CAMERA_SUBSCRIBER_T;
+
 typedef struct {
     struct tuya_list_head       node;
     bool                        is_open;
@@ -42,6 +63,13 @@ typedef struct {
     TDL_CAMERA_DEV_INFO_T       info;
     TDL_CAMERA_GET_FRAME_CB     get_raw_frame_cb;
     TDL_CAMERA_GET_FRAME_CB     get_encoded_frame_cb;
+    CAMERA_SUBSCRIBER_T         subscriber[TDL_CAMERA_SUBSCRIBER_MAX];
+
+    TDL_CAMERA_DROP_POLICY_E    drop_policy;
+    TDL_CAMERA_STATS_T          stats[TDL_CAMERA_FRAME_TYPE_MAX];
+    // running fps window
+    SYS_TIME_T                  win_start[TDL_CAMERA_FRAME_TYPE_MAX];
+    uint32_t                    win_frames[TDL_CAMERA_FRAME_TYPE_MAX];
 
     struct tuya_list_head       raw_frame_node_list;
     struct tuya_list_head       encoded_frame_node_list;
@@ -52,6 +80,9 @@ typedef struct {
 
 typedef struct {
     struct tuya_list_head       node;
+    struct tuya_list_head      *pool;       // free list the node returns to
+    uint16_t                    ref_cnt;
+    SYS_TIME_T                  assign_ms;  // handed to the driver
     TDD_CAMERA_FRAME_T          tdd_frame;
 } CAMERA_FRAME_NODE_T;
 
@@ -65,14 +96,30 @@ typedef struct {
 typedef struct {
     TDD_CAMERA_FRAME_T         *tdd_frame;
     CAMERA_DEVICE_T            *dev;
+    SYS_TIME_T                  post_ms;
 } CAMERA_MSG_T;
 
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+static void __cli_camera_stat(int argc, char *argv[]);
+
 /***********************************************************
 ***********************variable define**********************
 ***********************************************************/
 static struct tuya_list_head sg_camera_list = LIST_HEAD_INIT(sg_camera_list);
 static CAMERA_MANAGE_INFO_T sg_camera_manage;
 
+static const char *sc_camera_frame_type_name[TDL_CAMERA_FRAME_TYPE_MAX] = {"raw", "encoded"};
+
+static const cli_cmd_t sc_camera_stat_cli_cmd[] = {
+    {
+        .name = "cam_stat",
+        .help = "cam_stat [reset], show camera fps, queue and timing counters",
+        .func = __cli_camera_stat,
+    },
+};
+
 /***********************************************************
 ***********************function define**********************
 ***********************************************************/
@@ -163,6 +210,7 @@ static OPERATE_RET __camera_frame_node_init(struct tuya_list_head *phead, uint32
         }
         frame_node->tdd_frame.frame.data_len = buf_len;
         frame_node->tdd_frame.sys_param = (void *)frame_node;
+        frame_node->pool = phead;
 
         tuya_list_add(&frame_node->node, phead);
 
@@ -172,43 +220,181 @@ static OPERATE_RET __camera_frame_node_init(struct tuya_list_head *phead, uint32
     return OPRT_OK;
 }
 
-static void __raw_flow_task(void *args)
+static CAMERA_FRAME_NODE_T *__camera_frame_to_node(TDL_CAMERA_FRAME_T *frame)
 {
-    CAMERA_MSG_T msg;
+    TDD_CAMERA_FRAME_T *tdd_frame = NULL;
+    CAMERA_FRAME_NODE_T *pnode = NULL;
 
-	while (1)
-	{
+    if (NULL == frame) {
+        return NULL;
+    }
 
-		tal_queue_fetch(sg_camera_manage.raw_frame_queue, &msg, SEM_WAIT_FOREVER);
-		if(NULL == msg.dev || NULL == msg.tdd_frame) {
-            continue;
-        }
+    tdd_frame = (TDD_CAMERA_FRAME_T *)((uint8_t *)frame - OFFSOF(TDD_CAMERA_FRAME_T, frame));
+    pnode = (CAMERA_FRAME_NODE_T *)tdd_frame->sys_param;
+    if (NULL == pnode || &pnode->tdd_frame != tdd_frame) {
+        return NULL;
+    }
 
-		if((true == msg.dev->is_open) && msg.dev->get_raw_frame_cb) {
-            msg.dev->get_raw_frame_cb((TDL_CAMERA_HANDLE_T)msg.dev, &msg.tdd_frame->frame);
-        }
+    return pnode;
+}
 
-		tdl_camera_release_tdd_frame(msg.dev->tdd_hdl, msg.tdd_frame);
-	}
+static void __camera_frame_node_put(CAMERA_FRAME_NODE_T *pnode)
+{
+    TAL_ENTER_CRITICAL();
+    // a node already in the pool must not be added twice
+    if (pnode->ref_cnt > 0 && 0 == --pnode->ref_cnt) {
+        tuya_list_add_tail(&pnode->node, pnode->pool);
+    }
+    TAL_EXIT_CRITICAL();
 }
 
-static void __encoded_flow_task(void *args)
+static TDL_CAMERA_FRAME_TYPE_E __camera_frame_type(TDD_CAMERA_FRAME_T *tdd_frame)
 {
-    CAMERA_MSG_T msg;
+    return __is_camera_frame_encoded(tdd_frame->frame.fmt) ? TDL_CAMERA_FRAME_ENCODED : TDL_CAMERA_FRAME_RAW;
+}
 
-	while (1)
-	{
-		tal_queue_fetch(sg_camera_manage.encoded_frame_queue, &msg, SEM_WAIT_FOREVER);
-		if(NULL == msg.dev || NULL == msg.tdd_frame) {
+static void __camera_stat_inc(uint32_t *cnt)
+{
+    TAL_ENTER_CRITICAL();
+    (*cnt)++;
+    TAL_EXIT_CRITICAL();
+}
+
+static void __camera_time_record(TDL_CAMERA_TIME_T *time, SYS_TIME_T start)
+{
+    uint32_t ms = (uint32_t)(tal_system_get_millisecond() - start);
+
+    TAL_ENTER_CRITICAL();
+    time->count++;
+    time->last_ms = ms;
+    time->total_ms += ms;
+    if (ms > time->max_ms) {
+        time->max_ms = ms;
+    }
+    TAL_EXIT_CRITICAL();
+}
+
+// a message of the device left the queue
+static void __camera_queue_out(CAMERA_MSG_T *msg)
+{
+    TDL_CAMERA_STATS_T *stats = &msg->dev->stats[__camera_frame_type(msg->tdd_frame)];
+
+    TAL_ENTER_CRITICAL();
+    if (stats->queue_depth) {
+        stats->queue_depth--;
+    }
+    TAL_EXIT_CRITICAL();
+}
+
+static void __camera_frame_drop(CAMERA_MSG_T *msg)
+{
+    __camera_stat_inc(&msg->dev->stats[__camera_frame_type(msg->tdd_frame)].dropped);
+    tdl_camera_release_tdd_frame(msg->dev->tdd_hdl, msg->tdd_frame);
+}
+
+// uses the credit of a subscriber and tells whether this frame is its turn
+static bool __camera_subscriber_is_due(CAMERA_SUBSCRIBER_T *sub, uint16_t dev_fps)
+{
+    if (0 == sub->fps || 0 == dev_fps || sub->fps >= dev_fps) {
+        return true;
+    }
+
+    sub->credit += sub->fps;
+    if (sub->credit < dev_fps) {
+        return false;
+    }
+    sub->credit -= dev_fps;
+
+    return true;
+}
+
+static void __camera_frame_notify(CAMERA_MSG_T *msg, TDL_CAMERA_FRAME_TYPE_E type)
+{
+    CAMERA_DEVICE_T *dev = msg->dev;
+    TDL_CAMERA_STATS_T *stats = &dev->stats[type];
+    TDL_CAMERA_GET_FRAME_CB get_frame_cb = NULL;
+    CAMERA_SUBSCRIBER_T subscriber[TDL_CAMERA_SUBSCRIBER_MAX];
+    SYS_TIME_T start = 0;
+    uint32_t i, num = 0;
+
+    if (false == dev->is_open) {
+        return;
+    }
+
+    start = tal_system_get_millisecond();
+
+    if (dev->info.fps && (uint32_t)(tal_system_get_millisecond() - msg->post_ms) > 1000 / dev->info.fps) {
+        __camera_stat_inc(&stats->late);
+    }
+
+    get_frame_cb = (TDL_CAMERA_FRAME_RAW == type) ? dev->get_raw_frame_cb : dev->get_encoded_frame_cb;
+    if (get_frame_cb) {
+        get_frame_cb((TDL_CAMERA_HANDLE_T)dev, &msg->tdd_frame->frame);
+    }
+
+    // work on a copy so a callback may subscribe or unsubscribe
+    tal_mutex_lock(dev->mutex);
+    for (i = 0; i < TDL_CAMERA_SUBSCRIBER_MAX; i++) {
+        if (NULL == dev->subscriber[i].cb || dev->subscriber[i].type != type) {
             continue;
         }
+        if (__camera_subscriber_is_due(&dev->subscriber[i], dev->info.fps)) {
+            subscriber[num++] = dev->subscriber[i];
+        } else {
+            __camera_stat_inc(&stats->skipped);
+        }
+    }
+    tal_mutex_unlock(dev->mutex);
+
+    for (i = 0; i < num; i++) {
+        subscriber[i].cb((TDL_CAMERA_HANDLE_T)dev, &msg->tdd_frame->frame, subscriber[i].arg);
+    }
 
-		if ((true == msg.dev->is_open) && msg.dev->get_encoded_frame_cb) {
-            msg.dev->get_encoded_frame_cb((TDL_CAMERA_HANDLE_T)msg.dev, &msg.tdd_frame->frame);
+    __camera_time_record(&stats->consume, start);
+}
+
+static void __camera_flow_run(QUEUE_HANDLE queue, TDL_CAMERA_FRAME_TYPE_E type)
+{
+    CAMERA_MSG_T msg, next;
+    bool has_next = false;
+
+    while (1) {
+        if (has_next) {
+            msg = next;
+            has_next = false;
+        } else {
+            tal_queue_fetch(queue, &msg, SEM_WAIT_FOREVER);
+        }
+        if (NULL == msg.dev || NULL == msg.tdd_frame) {
+            continue;
+        }
+        __camera_queue_out(&msg);
+
+        // skip to the newest queued frame of this device
+        while (TDL_CAMERA_DROP_KEEP_LATEST == msg.dev->drop_policy && OPRT_OK == tal_queue_fetch(queue, &next, 0)) {
+            if (next.dev != msg.dev) {
+                has_next = true;
+                break;
+            }
+            __camera_queue_out(&next);
+            __camera_frame_drop(&msg);
+            msg = next;
         }
 
-		tdl_camera_release_tdd_frame(msg.dev->tdd_hdl, msg.tdd_frame);
-	}
+        __camera_frame_notify(&msg, type);
+
+        tdl_camera_release_tdd_frame(msg.dev->tdd_hdl, msg.tdd_frame);
+    }
+}
+
+static void __raw_flow_task(void *args)
+{
+    __camera_flow_run(sg_camera_manage.raw_frame_queue, TDL_CAMERA_FRAME_RAW);
+}
+
+static void __encoded_flow_task(void *args)
+{
+    __camera_flow_run(sg_camera_manage.encoded_frame_queue, TDL_CAMERA_FRAME_ENCODED);
 }
 
 static OPERATE_RET __camera_manage_init(TDL_CAMERA_FMT_E out_fmt)
@@ -218,7 +404,7 @@ static OPERATE_RET __camera_manage_init(TDL_CAMERA_FMT_E out_fmt)
     if(out_fmt & TDL_IMG_FMT_RAW_MASK) {
         if(NULL == sg_camera_manage.raw_frame_queue) {
             TUYA_CALL_ERR_RETURN(tal_queue_create_init(&(sg_camera_manage.raw_frame_queue),\
-                                                     sizeof(CAMERA_MSG_T), CAMERA_RAW_FRAME_BUFF_CNT));
+                                                     sizeof(CAMERA_MSG_T), CAMERA_FRAME_QUEUE_DEPTH));
         }
     
         if(NULL == sg_camera_manage.raw_thrd) {
@@ -231,7 +417,7 @@ static OPERATE_RET __camera_manage_init(TDL_CAMERA_FMT_E out_fmt)
     if(out_fmt & TDL_IMG_FMT_ENCODED_MASK) {
         if(NULL == sg_camera_manage.encoded_frame_queue) {
             TUYA_CALL_ERR_RETURN(tal_queue_create_init(&(sg_camera_manage.encoded_frame_queue),\
-                                                     sizeof(CAMERA_MSG_T), CAMERA_RAW_FRAME_BUFF_CNT));
+                                                     sizeof(CAMERA_MSG_T), CAMERA_FRAME_QUEUE_DEPTH));
         }
     
         if(NULL == sg_camera_manage.encoded_thrd) {
@@ -244,6 +430,52 @@ static OPERATE_RET __camera_manage_init(TDL_CAMERA_FMT_E out_fmt)
     return OPRT_OK;
 }
 
+static void __camera_time_print(const char *name, TDL_CAMERA_TIME_T *time)
+{
+    char line[96];
+
+    snprintf(line, SIZEOF(line), "  %-8s n=%u last=%u avg=%u max=%u ms", name, time->count, time->last_ms,
+             time->count ? time->total_ms / time->count : 0, time->max_ms);
+    tal_cli_echo(line);
+}
+
+static void __cli_camera_stat(int argc, char *argv[])
+{
+    CAMERA_DEVICE_T *camera_dev = NULL;
+    struct tuya_list_head *pos = NULL;
+    TDL_CAMERA_STATS_T stats;
+    char line[128];
+    uint32_t i;
+
+    tuya_list_for_each(pos, &sg_camera_list) {
+        camera_dev = tuya_list_entry(pos, CAMERA_DEVICE_T, node);
+
+        if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+            tdl_camera_dev_reset_stats((TDL_CAMERA_HANDLE_T)camera_dev);
+            continue;
+        }
+
+        for (i = 0; i < TDL_CAMERA_FRAME_TYPE_MAX; i++) {
+            tdl_camera_dev_get_stats((TDL_CAMERA_HANDLE_T)camera_dev, i, &stats);
+            if (0 == stats.posted && 0 == stats.no_buf) {
+                continue;
+            }
+
+            snprintf(line, SIZEOF(line), "%s %s: fps %u.%u, queue %u max %u, posted %u dropped %u late %u "
+                     "skipped %u no_buf %u", camera_dev->name, sc_camera_frame_type_name[i], stats.fps_x10 / 10,
+                     stats.fps_x10 % 10, stats.queue_depth, stats.queue_max, stats.posted, stats.dropped,
+                     stats.late, stats.skipped, stats.no_buf);
+            tal_cli_echo(line);
+            __camera_time_print("produce", &stats.produce);
+            __camera_time_print("consume", &stats.consume);
+        }
+    }
+
+    if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+        tal_cli_echo("camera stats reset");
+    }
+}
+
 TDL_CAMERA_HANDLE_T tdl_camera_find_dev(char *name)
 {
     return (TDL_CAMERA_HANDLE_T)__find_camera_device(name);
@@ -303,6 +535,7 @@ OPERATE_RET tdl_camera_dev_open(TDL_CAMERA_HANDLE_T camera_hdl,  TDL_CAMERA_CFG_
         open_cfg.width   = camera_dev->info.width;
         open_cfg.height  = camera_dev->info.height;
         open_cfg.out_fmt = camera_dev->info.out_fmt;
+        open_cfg.window  = cfg->window;
 
         TUYA_CALL_ERR_RETURN(camera_dev->intfs.open(camera_dev->tdd_hdl, &open_cfg));
 
@@ -317,9 +550,161 @@ OPERATE_RET tdl_camera_dev_close(TDL_CAMERA_HANDLE_T camera_hdl)
     return OPRT_NOT_SUPPORTED;
 }
 
+OPERATE_RET tdl_camera_dev_subscribe(TDL_CAMERA_HANDLE_T camera_hdl, TDL_CAMERA_FRAME_TYPE_E type, uint16_t fps,\
+                                     TDL_CAMERA_FRAME_NOTIFY_CB cb, void *arg)
+{
+    OPERATE_RET rt = OPRT_EXCEED_UPPER_LIMIT;
+    CAMERA_DEVICE_T *camera_dev = (CAMERA_DEVICE_T *)camera_hdl;
+    uint32_t i;
+
+    if (NULL == camera_dev || NULL == cb || type >= TDL_CAMERA_FRAME_TYPE_MAX) {
+        return OPRT_INVALID_PARM;
+    }
+
+    tal_mutex_lock(camera_dev->mutex);
+    for (i = 0; i < TDL_CAMERA_SUBSCRIBER_MAX; i++) {
+        if (NULL == camera_dev->subscriber[i].cb) {
+            camera_dev->subscriber[i].type   = type;
+            camera_dev->subscriber[i].fps    = fps;
+            camera_dev->subscriber[i].credit = 0;
+            camera_dev->subscriber[i].cb     = cb;
+            camera_dev->subscriber[i].arg    = arg;
+            rt = OPRT_OK;
+            break;
+        }
+    }
+    tal_mutex_unlock(camera_dev->mutex);
+
+    if (OPRT_OK != rt) {
+        PR_ERR("camera %s subscriber full", camera_dev->name);
+    }
+
+    return rt;
+}
+
+OPERATE_RET tdl_camera_dev_unsubscribe(TDL_CAMERA_HANDLE_T camera_hdl, TDL_CAMERA_FRAME_NOTIFY_CB cb, void *arg)
+{
+    OPERATE_RET rt = OPRT_NOT_FOUND;
+    CAMERA_DEVICE_T *camera_dev = (CAMERA_DEVICE_T *)camera_hdl;
+    uint32_t i;
+
+    if (NULL == camera_dev || NULL == cb) {
+        return OPRT_INVALID_PARM;
+    }
+
+    tal_mutex_lock(camera_dev->mutex);
+    for (i = 0; i < TDL_CAMERA_SUBSCRIBER_MAX; i++) {
+        if (camera_dev->subscriber[i].cb == cb && camera_dev->subscriber[i].arg == arg) {
+            memset(&camera_dev->subscriber[i], 0, sizeof(CAMERA_SUBSCRIBER_T));
+            rt = OPRT_OK;
+            break;
+        }
+    }
+    tal_mutex_unlock(camera_dev->mutex);
+
+    return rt;
+}
+
+OPERATE_RET tdl_camera_dev_set_drop_policy(TDL_CAMERA_HANDLE_T camera_hdl, TDL_CAMERA_DROP_POLICY_E policy)
+{
+    CAMERA_DEVICE_T *camera_dev = (CAMERA_DEVICE_T *)camera_hdl;
+
+    if (NULL == camera_dev || policy > TDL_CAMERA_DROP_KEEP_LATEST) {
+        return OPRT_INVALID_PARM;
+    }
+
+    camera_dev->drop_policy = policy;
+
+    return OPRT_OK;
+}
+
+OPERATE_RET tdl_camera_dev_get_stats(TDL_CAMERA_HANDLE_T camera_hdl, TDL_CAMERA_FRAME_TYPE_E type,\
+                                     TDL_CAMERA_STATS_T *stats)
+{
+    CAMERA_DEVICE_T *camera_dev = (CAMERA_DEVICE_T *)camera_hdl;
+    SYS_TIME_T win_start = 0;
+
+    if (NULL == camera_dev || NULL == stats || type >= TDL_CAMERA_FRAME_TYPE_MAX) {
+        return OPRT_INVALID_PARM;
+    }
+
+    TAL_ENTER_CRITICAL();
+    memcpy(stats, &camera_dev->stats[type], sizeof(TDL_CAMERA_STATS_T));
+    win_start = camera_dev->win_start[type];
+    TAL_EXIT_CRITICAL();
+
+    // no frame closed the window for a while, the stream has stalled
+    if ((uint32_t)(tal_system_get_millisecond() - win_start) >= 2 * TDL_CAMERA_STATS_WINDOW_MS) {
+        stats->fps_x10 = 0;
+    }
+
+    return OPRT_OK;
+}
+
+OPERATE_RET tdl_camera_dev_reset_stats(TDL_CAMERA_HANDLE_T camera_hdl)
+{
+    CAMERA_DEVICE_T *camera_dev = (CAMERA_DEVICE_T *)camera_hdl;
+    TDL_CAMERA_STATS_T *stats = NULL;
+    uint8_t depth = 0;
+    uint32_t i;
+
+    if (NULL == camera_dev) {
+        return OPRT_INVALID_PARM;
+    }
+
+    TAL_ENTER_CRITICAL();
+    for (i = 0; i < TDL_CAMERA_FRAME_TYPE_MAX; i++) {
+        stats = &camera_dev->stats[i];
+        // frames still queued will be fetched and counted out
+        depth = stats->queue_depth;
+        memset(stats, 0, sizeof(TDL_CAMERA_STATS_T));
+        stats->queue_depth = depth;
+        stats->queue_max   = depth;
+        camera_dev->win_start[i]  = 0;
+        camera_dev->win_frames[i] = 0;
+    }
+    TAL_EXIT_CRITICAL();
+
+    return OPRT_OK;
+}
+
+OPERATE_RET tdl_camera_frame_retain(TDL_CAMERA_FRAME_T *frame)
+{
+    OPERATE_RET rt = OPRT_OK;
+    CAMERA_FRAME_NODE_T *pnode = __camera_frame_to_node(frame);
+
+    if (NULL == pnode) {
+        return OPRT_INVALID_PARM;
+    }
+
+    TAL_ENTER_CRITICAL();
+    // a frame back in the pool can not be revived
+    if (0 == pnode->ref_cnt || 0xFFFF == pnode->ref_cnt) {
+        rt = OPRT_COM_ERROR;
+    } else {
+        pnode->ref_cnt++;
+    }
+    TAL_EXIT_CRITICAL();
+
+    return rt;
+}
+
+void tdl_camera_frame_release(TDL_CAMERA_FRAME_T *frame)
+{
+    CAMERA_FRAME_NODE_T *pnode = __camera_frame_to_node(frame);
+
+    if (NULL == pnode) {
+        PR_ERR("frame %p not from a camera pool", frame);
+        return;
+    }
+
+    __camera_frame_node_put(pnode);
+}
+
 OPERATE_RET tdl_camera_device_register(char *name, TDD_CAMERA_DEV_HANDLE_T tdd_hdl, \
                                        TDD_CAMERA_INTFS_T *intfs, TDD_CAMERA_DEV_INFO_T *dev_info)
 {
+    OPERATE_RET rt = OPRT_OK;
     CAMERA_DEVICE_T *camera_dev = NULL;
 
     if (NULL == name || NULL == tdd_hdl || NULL == intfs || NULL == dev_info) {
@@ -334,6 +719,12 @@ OPERATE_RET tdl_camera_device_register(char *name, TDD_CAMERA_DEV_HANDLE_T tdd_h
 
     strncpy(camera_dev->name, name, CAMERA_DEV_NAME_MAX_LEN);
 
+    rt = tal_mutex_create_init(&camera_dev->mutex);
+    if (OPRT_OK != rt) {
+        FreeNode(camera_dev);
+        return rt;
+    }
+
     camera_dev->info.type        = dev_info->type;
     camera_dev->info.max_fps     = dev_info->max_fps;
     camera_dev->info.max_width   = dev_info->max_width;
@@ -350,6 +741,10 @@ OPERATE_RET tdl_camera_device_register(char *name, TDD_CAMERA_DEV_HANDLE_T tdd_h
 
     memcpy(&camera_dev->intfs, intfs, sizeof(TDD_CAMERA_INTFS_T));
 
+    if (tuya_list_empty(&sg_camera_list)) {
+        tal_cli_cmd_register(sc_camera_stat_cli_cmd, CNTSOF(sc_camera_stat_cli_cmd));
+    }
+
     tuya_list_add(&camera_dev->node, &sg_camera_list);
 
     return OPRT_OK;
@@ -368,15 +763,22 @@ TDD_CAMERA_FRAME_T *tdl_camera_create_tdd_frame(TDD_CAMERA_DEV_HANDLE_T tdd_hdl,
 
     pframe_list = (false == __is_camera_frame_encoded(fmt)) ? \
                   &camera_dev->raw_frame_node_list : &camera_dev->encoded_frame_node_list;
-             
+
+    // the capture callback may run in interrupt context
+    TAL_ENTER_CRITICAL();
     if(tuya_list_empty(pframe_list)) {
+        camera_dev->stats[__is_camera_frame_encoded(fmt) ? TDL_CAMERA_FRAME_ENCODED : TDL_CAMERA_FRAME_RAW].no_buf++;
+        TAL_EXIT_CRITICAL();
         return NULL;
     }
 
     pnode = tuya_list_entry(pframe_list->next, CAMERA_FRAME_NODE_T, node);
 
     tuya_list_del(&pnode->node);
+    pnode->ref_cnt = 1;
+    TAL_EXIT_CRITICAL();
 
+    pnode->assign_ms = tal_system_get_millisecond();
     pnode->tdd_frame.frame.fmt = fmt;
 
     return &pnode->tdd_frame;
@@ -384,10 +786,6 @@ TDD_CAMERA_FRAME_T *tdl_camera_create_tdd_frame(TDD_CAMERA_DEV_HANDLE_T tdd_hdl,
 
 void tdl_camera_release_tdd_frame(TDD_CAMERA_DEV_HANDLE_T tdd_hdl, TDD_CAMERA_FRAME_T *frame)
 {    
-    CAMERA_DEVICE_T *camera_dev = NULL;
-    struct tuya_list_head *pframe_list = NULL;
-    CAMERA_FRAME_NODE_T *pnode = NULL;
-
     if(NULL == frame || NULL == tdd_hdl) {
         return;
     }
@@ -397,26 +795,59 @@ void tdl_camera_release_tdd_frame(TDD_CAMERA_DEV_HANDLE_T tdd_hdl, TDD_CAMERA_FR
         return;
     }
 
-    camera_dev = __find_camera_device_from_tdd(tdd_hdl);
-    if (NULL == camera_dev) {
-        return;
+    __camera_frame_node_put((CAMERA_FRAME_NODE_T *)frame->sys_param);
+
+    return;
+}
+
+static void __camera_post_stat(CAMERA_DEVICE_T *dev, TDL_CAMERA_FRAME_TYPE_E type, SYS_TIME_T now)
+{
+    TDL_CAMERA_STATS_T *stats = &dev->stats[type];
+    uint32_t elapsed = 0;
+
+    TAL_ENTER_CRITICAL();
+    stats->posted++;
+
+    if (0 == dev->win_start[type]) {
+        dev->win_start[type] = now;
+    }
+    dev->win_frames[type]++;
+    elapsed = (uint32_t)(now - dev->win_start[type]);
+    if (elapsed >= TDL_CAMERA_STATS_WINDOW_MS) {
+        stats->fps_x10 = (uint16_t)((uint64_t)dev->win_frames[type] * 10000 / elapsed);
+        dev->win_start[type] = now;
+        dev->win_frames[type] = 0;
     }
+    TAL_EXIT_CRITICAL();
+}
 
-    pframe_list = (false == __is_camera_frame_encoded(frame->frame.fmt)) ? \
-                  &camera_dev->raw_frame_node_list : &camera_dev->encoded_frame_node_list;
+// counted before the post, the flow task may fetch it before the post returns
+static bool __camera_queue_in(QUEUE_HANDLE queue, CAMERA_MSG_T *msg, TDL_CAMERA_FRAME_TYPE_E type)
+{
+    TDL_CAMERA_STATS_T *stats = &msg->dev->stats[type];
 
-    pnode = (CAMERA_FRAME_NODE_T *)frame->sys_param;
+    TAL_ENTER_CRITICAL();
+    stats->queue_depth++;
+    if (stats->queue_depth > stats->queue_max) {
+        stats->queue_max = stats->queue_depth;
+    }
+    TAL_EXIT_CRITICAL();
+
+    if (OPRT_OK == tal_queue_post(queue, msg, 0)) {
+        return true;
+    }
 
-    tuya_list_add_tail(&pnode->node, pframe_list);
+    __camera_queue_out(msg);
 
-    return;
+    return false;
 }
 
 OPERATE_RET tdl_camera_post_tdd_frame(TDD_CAMERA_DEV_HANDLE_T tdd_hdl, TDD_CAMERA_FRAME_T *frame)
 {
-    CAMERA_MSG_T msg;
+    CAMERA_MSG_T msg, old;
     QUEUE_HANDLE queue;
     CAMERA_DEVICE_T *camera_dev = NULL;
+    TDL_CAMERA_FRAME_TYPE_E type;
 
     if(NULL == frame || NULL == tdd_hdl) {
         return OPRT_INVALID_PARM;
@@ -441,6 +872,26 @@ OPERATE_RET tdl_camera_post_tdd_frame(TDD_CAMERA_DEV_HANDLE_T tdd_hdl, TDD_CAMER
 
     msg.tdd_frame = frame;
     msg.dev       = camera_dev;
+    msg.post_ms   = tal_system_get_millisecond();
+    type          = __camera_frame_type(frame);
+
+    __camera_post_stat(camera_dev, type, msg.post_ms);
+    __camera_time_record(&camera_dev->stats[type].produce, ((CAMERA_FRAME_NODE_T *)frame->sys_param)->assign_ms);
+
+    if (__camera_queue_in(queue, &msg, type)) {
+        return OPRT_OK;
+    }
 
-    return tal_queue_post(queue, &msg, 0);
-}
\ No newline at end of file
+    // queue full, the driver has no way to free the frame so it is dropped here
+    if (TDL_CAMERA_DROP_NEWEST != camera_dev->drop_policy && OPRT_OK == tal_queue_fetch(queue, &old, 0)) {
+        __camera_queue_out(&old);
+        __camera_frame_drop(&old);
+        if (__camera_queue_in(queue, &msg, type)) {
+            return OPRT_OK;
+        }
+    }
+
+    __camera_frame_drop(&msg);
+
+    return OPRT_OK;
+}
@@ -0,0 +1,473 @@
+/**
+ * @file tdl_camera_preview.c
+ * @brief Camera preview straight to a display, without going through a GUI.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include "tuya_cloud_types.h"
+#include "tal_api.h"
+
+#if defined(ENABLE_DISPLAY) && (ENABLE_DISPLAY == 1)
+#include "tdl_display_draw.h"
+#include "tdl_display_profile.h"
+#include "tdl_camera_preview.h"
+
+// the LVGL port owns the DMA2D completion callback when it uses DMA2D
+#if defined(ENABLE_DMA2D) && (ENABLE_DMA2D == 1) && \
+    !(defined(ENABLE_LVGL_DMA2D) && (ENABLE_LVGL_DMA2D == 1))
+#define CAMERA_PREVIEW_USE_DMA2D 1
+#include "tkl_dma2d.h"
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define CAMERA_PREVIEW_FB_NUM         2
+
+#ifndef CAMERA_PREVIEW_DMA2D_TIMEOUT_MS
+#define CAMERA_PREVIEW_DMA2D_TIMEOUT_MS 100
+#endif
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    TDL_CAMERA_HANDLE_T        camera_hdl;
+    TDL_DISP_HANDLE_T          disp_hdl;
+    TDL_DISP_DEV_INFO_T        disp_info;
+    TDL_CAMERA_PREVIEW_CFG_T   cfg;
+
+    MUTEX_HANDLE               mutex;
+    SEM_HANDLE                 frame_sem;
+    THREAD_HANDLE              thrd;
+    bool                       is_running;
+    TDL_CAMERA_FRAME_T        *pending;
+    TDL_CAMERA_PREVIEW_STATS_T stats;
+
+    TDL_DISP_FRAME_BUFF_T     *fb[CAMERA_PREVIEW_FB_NUM];
+    uint8_t                    fb_idx;
+    TDL_DISP_FRAME_BUFF_T     *video_fb; // logical orientation, only when rotated
+    uint16_t                  *line;     // one converted camera line, only when scaled
+    uint16_t                  *x_map;    // camera column of each video column
+    uint16_t                   line_w;
+    TDL_DISP_RECT_LIST_T       dirty;
+
+#if defined(CAMERA_PREVIEW_USE_DMA2D)
+    SEM_HANDLE                 dma2d_sem;
+#endif
+} CAMERA_PREVIEW_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static CAMERA_PREVIEW_T sg_preview;
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+#if defined(CAMERA_PREVIEW_USE_DMA2D)
+static void __preview_dma2d_irq_cb(TUYA_DMA2D_IRQ_E type, VOID_T *args)
+{
+    if (sg_preview.dma2d_sem) {
+        tal_semaphore_post(sg_preview.dma2d_sem);
+    }
+}
+
+static OPERATE_RET __preview_dma2d_convert(TDL_CAMERA_FRAME_T *frame, TDL_DISP_FRAME_BUFF_T *fb, uint16_t x,
+                                           uint16_t y)
+{
+    OPERATE_RET rt = OPRT_OK;
+    TKL_DMA2D_FRAME_INFO_T in_frame = {0};
+    TKL_DMA2D_FRAME_INFO_T out_frame = {0};
+
+    in_frame.type   = TUYA_FRAME_FMT_YUV422;
+    in_frame.width  = frame->width;
+    in_frame.height = frame->height;
+    in_frame.pbuf   = frame->data;
+
+    out_frame.type        = TUYA_FRAME_FMT_RGB565;
+    out_frame.width       = fb->width;
+    out_frame.height      = fb->height;
+    out_frame.axis.x_axis = x;
+    out_frame.axis.y_axis = y;
+    out_frame.pbuf        = fb->frame;
+
+    TUYA_CALL_ERR_RETURN(tkl_dma2d_convert(&in_frame, &out_frame));
+
+    return tal_semaphore_wait(sg_preview.dma2d_sem, CAMERA_PREVIEW_DMA2D_TIMEOUT_MS);
+}
+#endif
+
+/*Writes the video, w x h, at (x, y) of an RGB565 frame buffer*/
+static OPERATE_RET __preview_convert(TDL_CAMERA_FRAME_T *frame, TDL_DISP_FRAME_BUFF_T *fb, uint16_t x, uint16_t y,
+                                     uint16_t w, uint16_t h, bool is_swap)
+{
+    uint16_t *dst = NULL;
+    uint32_t  src_stride = frame->width * 2;
+    uint32_t  dy = 0, dx = 0, sy = 0, last_sy = 0xFFFFFFFF;
+
+    if (w == frame->width && h == frame->height) {
+#if defined(CAMERA_PREVIEW_USE_DMA2D)
+        if (OPRT_OK == __preview_dma2d_convert(frame, fb, x, y)) {
+            if (is_swap) {
+                for (dy = 0; dy < h; dy++) {
+                    dst = (uint16_t *)fb->frame + (y + dy) * fb->width + x;
+                    tdl_disp_convert_rgb565_swap(dst, dst, w);
+                }
+            }
+            return OPRT_OK;
+        }
+#endif
+        for (dy = 0; dy < h; dy++) {
+            dst = (uint16_t *)fb->frame + (y + dy) * fb->width + x;
+            tdl_disp_convert_yuv422_to_rgb565(frame->data + dy * src_stride, dst, w, is_swap);
+        }
+        return OPRT_OK;
+    }
+
+    // nearest neighbour, each camera line needed is converted once
+    if (NULL == sg_preview.line || sg_preview.line_w < frame->width) {
+        return OPRT_INVALID_PARM;
+    }
+
+    for (dy = 0; dy < h; dy++) {
+        sy = dy * frame->height / h;
+        if (sy != last_sy) {
+            tdl_disp_convert_yuv422_to_rgb565(frame->data + sy * src_stride, sg_preview.line, frame->width, is_swap);
+            last_sy = sy;
+        }
+
+        dst = (uint16_t *)fb->frame + (y + dy) * fb->width + x;
+        for (dx = 0; dx < w; dx++) {
+            dst[dx] = sg_preview.line[sg_preview.x_map[dx]];
+        }
+    }
+
+    return OPRT_OK;
+}
+
+static void __preview_show(TDL_CAMERA_FRAME_T *frame)
+{
+    TDL_CAMERA_PREVIEW_CFG_T *cfg = &sg_preview.cfg;
+    TDL_DISP_FRAME_BUFF_T *fb = sg_preview.fb[sg_preview.fb_idx];
+    TDL_DISP_RECT_T rect;
+    SYS_TIME_T start = TDL_DISP_PROF_NOW();
+    OPERATE_RET rt = OPRT_OK;
+
+    if (TUYA_DISPLAY_ROTATION_0 == sg_preview.disp_info.rotation) {
+        rt = __preview_convert(frame, fb, cfg->x, cfg->y, cfg->width, cfg->height, sg_preview.disp_info.is_swap);
+        rect.x0 = cfg->x;
+        rect.y0 = cfg->y;
+        rect.x1 = cfg->x + cfg->width - 1;
+        rect.y1 = cfg->y + cfg->height - 1;
+    } else {
+        rt = __preview_convert(frame, sg_preview.video_fb, 0, 0, cfg->width, cfg->height, false);
+        if (OPRT_OK == rt) {
+            rt = tdl_disp_draw_rotate_area(sg_preview.disp_info.rotation, sg_preview.video_fb, fb,
+                                           sg_preview.disp_info.is_swap, &rect);
+        }
+    }
+    if (OPRT_OK != rt) {
+        PR_ERR("preview convert failed, rt:%d", rt);
+        return;
+    }
+
+    tdl_disp_prof_record(TDL_DISP_PROF_CONVERT, start);
+
+    if (cfg->overlay_cb) {
+        cfg->overlay_cb(fb, cfg->overlay_arg);
+        tdl_disp_dev_flush(sg_preview.disp_hdl, fb);
+    } else if (sg_preview.disp_info.has_partial) {
+        tdl_disp_rect_list_clear(&sg_preview.dirty);
+        tdl_disp_rect_list_add(&sg_preview.dirty, &rect);
+        tdl_disp_dev_flush_rects(sg_preview.disp_hdl, fb, &sg_preview.dirty);
+    } else {
+        tdl_disp_dev_flush(sg_preview.disp_hdl, fb);
+    }
+
+    tal_mutex_lock(sg_preview.mutex);
+    sg_preview.stats.shown++;
+    tal_mutex_unlock(sg_preview.mutex);
+
+    sg_preview.fb_idx = (sg_preview.fb_idx + 1) % CAMERA_PREVIEW_FB_NUM;
+}
+
+static OPERATE_RET __preview_frame_cb(TDL_CAMERA_HANDLE_T hdl, TDL_CAMERA_FRAME_T *frame, void *arg)
+{
+    TDL_CAMERA_FRAME_T *old = NULL;
+
+    if (TUYA_FRAME_FMT_YUV422 != frame->fmt) {
+        return OPRT_OK;
+    }
+
+    if (OPRT_OK != tdl_camera_frame_retain(frame)) {
+        return OPRT_COM_ERROR;
+    }
+
+    // keep only the newest frame, the flow task never waits for the display
+    tal_mutex_lock(sg_preview.mutex);
+    old = sg_preview.pending;
+    sg_preview.pending = frame;
+    if (old) {
+        sg_preview.stats.dropped++;
+    }
+    tal_mutex_unlock(sg_preview.mutex);
+
+    if (old) {
+        tdl_camera_frame_release(old);
+    }
+    tal_semaphore_post(sg_preview.frame_sem);
+
+    return OPRT_OK;
+}
+
+static void __preview_free(void)
+{
+    uint8_t i = 0;
+
+    for (i = 0; i < CAMERA_PREVIEW_FB_NUM; i++) {
+        if (sg_preview.fb[i]) {
+            tdl_disp_free_frame_buff(sg_preview.fb[i]);
+            sg_preview.fb[i] = NULL;
+        }
+    }
+    if (sg_preview.video_fb) {
+        tdl_disp_free_frame_buff(sg_preview.video_fb);
+        sg_preview.video_fb = NULL;
+    }
+    if (sg_preview.line) {
+        tal_free(sg_preview.line);
+        sg_preview.line = NULL;
+    }
+    if (sg_preview.x_map) {
+        tal_free(sg_preview.x_map);
+        sg_preview.x_map = NULL;
+    }
+}
+
+static void __preview_task(void *args)
+{
+    TDL_CAMERA_FRAME_T *frame = NULL;
+    THREAD_HANDLE thrd = NULL;
+
+    while (sg_preview.is_running) {
+        tal_semaphore_wait(sg_preview.frame_sem, SEM_WAIT_FOREVER);
+
+        tal_mutex_lock(sg_preview.mutex);
+        frame = sg_preview.pending;
+        sg_preview.pending = NULL;
+        tal_mutex_unlock(sg_preview.mutex);
+
+        if (NULL == frame) {
+            continue;
+        }
+
+        if (sg_preview.is_running) {
+            __preview_show(frame);
+        }
+        tdl_camera_frame_release(frame);
+    }
+
+    __preview_free();
+
+    thrd = sg_preview.thrd;
+    sg_preview.thrd = NULL;
+    tal_thread_delete(thrd);
+}
+
+static OPERATE_RET __preview_buf_init(TDL_CAMERA_DEV_INFO_T *camera_info)
+{
+    TDL_DISP_DEV_INFO_T *disp_info = &sg_preview.disp_info;
+    TDL_CAMERA_PREVIEW_CFG_T *cfg = &sg_preview.cfg;
+    uint32_t fb_len = disp_info->width * disp_info->height * 2;
+    uint16_t i = 0;
+
+    for (i = 0; i < CAMERA_PREVIEW_FB_NUM; i++) {
+        sg_preview.fb[i] = tdl_disp_create_frame_buff(DISP_FB_TP_PSRAM, fb_len);
+        TUYA_CHECK_NULL_RETURN(sg_preview.fb[i], OPRT_MALLOC_FAILED);
+        sg_preview.fb[i]->fmt    = TUYA_PIXEL_FMT_RGB565;
+        sg_preview.fb[i]->width  = disp_info->width;
+        sg_preview.fb[i]->height = disp_info->height;
+    }
+
+    if (TUYA_DISPLAY_ROTATION_0 != disp_info->rotation) {
+        sg_preview.video_fb = tdl_disp_create_frame_buff(DISP_FB_TP_PSRAM, cfg->width * cfg->height * 2);
+        TUYA_CHECK_NULL_RETURN(sg_preview.video_fb, OPRT_MALLOC_FAILED);
+        sg_preview.video_fb->fmt     = TUYA_PIXEL_FMT_RGB565;
+        sg_preview.video_fb->x_start = cfg->x;
+        sg_preview.video_fb->y_start = cfg->y;
+        sg_preview.video_fb->width   = cfg->width;
+        sg_preview.video_fb->height  = cfg->height;
+    }
+
+    if (cfg->width != camera_info->width || cfg->height != camera_info->height) {
+        sg_preview.line = (uint16_t *)tal_malloc(camera_info->width * SIZEOF(uint16_t));
+        TUYA_CHECK_NULL_RETURN(sg_preview.line, OPRT_MALLOC_FAILED);
+        sg_preview.line_w = camera_info->width;
+
+        sg_preview.x_map = (uint16_t *)tal_malloc(cfg->width * SIZEOF(uint16_t));
+        TUYA_CHECK_NULL_RETURN(sg_preview.x_map, OPRT_MALLOC_FAILED);
+        for (i = 0; i < cfg->width; i++) {
+            sg_preview.x_map[i] = (uint32_t)i * camera_info->width / cfg->width;
+        }
+    }
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Starts showing the raw frames of a camera on a display.
+ *
+ * @param camera_hdl The camera device.
+ * @param disp_hdl The display device, already opened.
+ * @param cfg Where the video goes.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_camera_preview_start(TDL_CAMERA_HANDLE_T camera_hdl, TDL_DISP_HANDLE_T disp_hdl,
+                                     TDL_CAMERA_PREVIEW_CFG_T *cfg)
+{
+    OPERATE_RET rt = OPRT_OK;
+    TDL_CAMERA_DEV_INFO_T camera_info;
+    uint16_t log_w = 0, log_h = 0;
+
+    if (NULL == camera_hdl || NULL == disp_hdl || NULL == cfg) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (sg_preview.thrd) {
+        PR_ERR("preview already running");
+        return OPRT_COM_ERROR;
+    }
+
+    TUYA_CALL_ERR_RETURN(tdl_camera_dev_get_info(camera_hdl, &camera_info));
+    TUYA_CALL_ERR_RETURN(tdl_disp_dev_get_info(disp_hdl, &sg_preview.disp_info));
+
+    if (0 == (camera_info.out_fmt & TDL_CAMERA_FMT_YUV422) ||
+        TUYA_PIXEL_FMT_RGB565 != sg_preview.disp_info.fmt) {
+        PR_ERR("preview needs yuv422 camera and rgb565 display");
+        return OPRT_NOT_SUPPORTED;
+    }
+
+    if (TUYA_DISPLAY_ROTATION_90 == sg_preview.disp_info.rotation ||
+        TUYA_DISPLAY_ROTATION_270 == sg_preview.disp_info.rotation) {
+        log_w = sg_preview.disp_info.height;
+        log_h = sg_preview.disp_info.width;
+    } else {
+        log_w = sg_preview.disp_info.width;
+        log_h = sg_preview.disp_info.height;
+    }
+
+    memcpy(&sg_preview.cfg, cfg, sizeof(TDL_CAMERA_PREVIEW_CFG_T));
+    if (0 == sg_preview.cfg.width) {
+        sg_preview.cfg.width = camera_info.width;
+    }
+    if (0 == sg_preview.cfg.height) {
+        sg_preview.cfg.height = camera_info.height;
+    }
+    if (sg_preview.cfg.x >= log_w || sg_preview.cfg.y >= log_h) {
+        return OPRT_INVALID_PARM;
+    }
+    sg_preview.cfg.width  = MIN(sg_preview.cfg.width, log_w - sg_preview.cfg.x);
+    sg_preview.cfg.height = MIN(sg_preview.cfg.height, log_h - sg_preview.cfg.y);
+
+    sg_preview.camera_hdl = camera_hdl;
+    sg_preview.disp_hdl   = disp_hdl;
+    sg_preview.pending    = NULL;
+    sg_preview.fb_idx     = 0;
+    memset(&sg_preview.stats, 0, sizeof(TDL_CAMERA_PREVIEW_STATS_T));
+
+    if (NULL == sg_preview.mutex) {
+        TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&sg_preview.mutex));
+        TUYA_CALL_ERR_RETURN(tal_semaphore_create_init(&sg_preview.frame_sem, 0, 1));
+#if defined(CAMERA_PREVIEW_USE_DMA2D)
+        TUYA_CALL_ERR_RETURN(tal_semaphore_create_init(&sg_preview.dma2d_sem, 0, 1));
+        TUYA_DMA2D_BASE_CFG_T dma2d_cfg = {
+            .cb  = __preview_dma2d_irq_cb,
+            .arg = NULL,
+        };
+        TUYA_CALL_ERR_RETURN(tkl_dma2d_init(&dma2d_cfg));
+#endif
+    }
+
+    TUYA_CALL_ERR_GOTO(__preview_buf_init(&camera_info), __ERR);
+
+    sg_preview.is_running = true;
+
+    THREAD_CFG_T thread_cfg = {4096, THREAD_PRIO_1, "camera_preview"};
+    TUYA_CALL_ERR_GOTO(
+        tal_thread_create_and_start(&sg_preview.thrd, NULL, NULL, __preview_task, NULL, &thread_cfg), __ERR);
+
+    TUYA_CALL_ERR_GOTO(tdl_camera_dev_subscribe(camera_hdl, TDL_CAMERA_FRAME_RAW, 0, __preview_frame_cb, NULL),
+                       __STOP);
+
+    return OPRT_OK;
+
+__STOP:
+    // the task frees the buffers
+    sg_preview.is_running = false;
+    tal_semaphore_post(sg_preview.frame_sem);
+    return rt;
+
+__ERR:
+    sg_preview.is_running = false;
+    sg_preview.thrd = NULL;
+    __preview_free();
+    return rt;
+}
+
+/**
+ * @brief Stops the preview, the last frame stays on the screen.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_camera_preview_stop(void)
+{
+    TDL_CAMERA_FRAME_T *frame = NULL;
+
+    if (false == sg_preview.is_running) {
+        return OPRT_OK;
+    }
+
+    tdl_camera_dev_unsubscribe(sg_preview.camera_hdl, __preview_frame_cb, NULL);
+
+    tal_mutex_lock(sg_preview.mutex);
+    sg_preview.is_running = false;
+    frame = sg_preview.pending;
+    sg_preview.pending = NULL;
+    tal_mutex_unlock(sg_preview.mutex);
+
+    if (frame) {
+        tdl_camera_frame_release(frame);
+    }
+
+    tal_semaphore_post(sg_preview.frame_sem);
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Reads the preview counters.
+ *
+ * @param stats Filled with the counters.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_camera_preview_get_stats(TDL_CAMERA_PREVIEW_STATS_T *stats)
+{
+    TUYA_CHECK_NULL_RETURN(stats, OPRT_INVALID_PARM);
+
+    if (NULL == sg_preview.mutex) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    tal_mutex_lock(sg_preview.mutex);
+    memcpy(stats, &sg_preview.stats, sizeof(TDL_CAMERA_PREVIEW_STATS_T));
+    tal_mutex_unlock(sg_preview.mutex);
+
+    return OPRT_OK;
+}
+
+#endif
@@ -0,0 +1,187 @@
+/**
+ * @file tdl_camera_snapshot.c
+ * @brief On demand JPEG snapshots of a camera.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include "tuya_cloud_types.h"
+#include "tal_api.h"
+
+#include "tdl_camera_snapshot.h"
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    TDL_CAMERA_HANDLE_T camera_hdl;
+    MUTEX_HANDLE        mutex;
+    SEM_HANDLE          sem;
+    bool                is_armed;
+    TDL_CAMERA_FRAME_T *frame;
+} CAMERA_SNAPSHOT_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static CAMERA_SNAPSHOT_T sg_snapshot;
+
+static const uint16_t sc_snapshot_preset[TDL_CAMERA_SNAP_PRESET_MAX][2] = {
+    {320, 240},
+    {480, 480},
+    {640, 480},
+};
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static OPERATE_RET __snapshot_frame_cb(TDL_CAMERA_HANDLE_T hdl, TDL_CAMERA_FRAME_T *frame, void *arg)
+{
+    // frames outside a snapshot are left alone
+    if (false == sg_snapshot.is_armed) {
+        return OPRT_OK;
+    }
+
+    if (TUYA_FRAME_FMT_JPEG != frame->fmt || 0 == frame->is_complete) {
+        return OPRT_OK;
+    }
+
+    tal_mutex_lock(sg_snapshot.mutex);
+    if (sg_snapshot.is_armed && NULL == sg_snapshot.frame && OPRT_OK == tdl_camera_frame_retain(frame)) {
+        sg_snapshot.frame = frame;
+        sg_snapshot.is_armed = false;
+        tal_semaphore_post(sg_snapshot.sem);
+    }
+    tal_mutex_unlock(sg_snapshot.mutex);
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Fills the open config of a snapshot preset.
+ *
+ * @param preset The preset.
+ * @param fps Capture rate, a lower rate saves bus and PSRAM bandwidth.
+ * @param cfg Open config, width, height, fps and out_fmt are set.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_camera_snapshot_preset_cfg(TDL_CAMERA_SNAP_PRESET_E preset, uint16_t fps, TDL_CAMERA_CFG_T *cfg)
+{
+    TUYA_CHECK_NULL_RETURN(cfg, OPRT_INVALID_PARM);
+
+    if (preset >= TDL_CAMERA_SNAP_PRESET_MAX || 0 == fps) {
+        return OPRT_INVALID_PARM;
+    }
+
+    cfg->width  = sc_snapshot_preset[preset][0];
+    cfg->height = sc_snapshot_preset[preset][1];
+    cfg->fps    = fps;
+    cfg->out_fmt = (cfg->out_fmt & TDL_IMG_FMT_RAW_MASK) ? TDL_CAMERA_FMT_JPEG_YUV422_BOTH : TDL_CAMERA_FMT_JPEG;
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Enables snapshots on a camera opened with JPEG output.
+ *
+ * @param camera_hdl The camera device.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_camera_snapshot_init(TDL_CAMERA_HANDLE_T camera_hdl)
+{
+    OPERATE_RET rt = OPRT_OK;
+    TDL_CAMERA_DEV_INFO_T info;
+
+    TUYA_CHECK_NULL_RETURN(camera_hdl, OPRT_INVALID_PARM);
+
+    if (sg_snapshot.camera_hdl) {
+        return (sg_snapshot.camera_hdl == camera_hdl) ? OPRT_OK : OPRT_COM_ERROR;
+    }
+
+    TUYA_CALL_ERR_RETURN(tdl_camera_dev_get_info(camera_hdl, &info));
+    if (0 == (info.out_fmt & TDL_CAMERA_FMT_JPEG)) {
+        PR_ERR("camera not opened with jpeg output");
+        return OPRT_NOT_SUPPORTED;
+    }
+
+    TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&sg_snapshot.mutex));
+    TUYA_CALL_ERR_GOTO(tal_semaphore_create_init(&sg_snapshot.sem, 0, 1), __ERR);
+    TUYA_CALL_ERR_GOTO(tdl_camera_dev_subscribe(camera_hdl, TDL_CAMERA_FRAME_ENCODED, 0, __snapshot_frame_cb, NULL),
+                       __ERR);
+
+    sg_snapshot.camera_hdl = camera_hdl;
+
+    return OPRT_OK;
+
+__ERR:
+    if (sg_snapshot.sem) {
+        tal_semaphore_release(sg_snapshot.sem);
+        sg_snapshot.sem = NULL;
+    }
+    tal_mutex_release(sg_snapshot.mutex);
+    sg_snapshot.mutex = NULL;
+
+    return rt;
+}
+
+/**
+ * @brief Waits for the next complete JPEG frame.
+ *
+ * @param timeout_ms Longest wait, one frame interval is typical.
+ * @param frame Set to the frame, must be given back with
+ *              tdl_camera_snapshot_release().
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_camera_snapshot_take(uint32_t timeout_ms, TDL_CAMERA_FRAME_T **frame)
+{
+    TUYA_CHECK_NULL_RETURN(frame, OPRT_INVALID_PARM);
+
+    if (NULL == sg_snapshot.camera_hdl) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    tal_mutex_lock(sg_snapshot.mutex);
+    if (sg_snapshot.is_armed) {
+        tal_mutex_unlock(sg_snapshot.mutex);
+        PR_ERR("snapshot already pending");
+        return OPRT_COM_ERROR;
+    }
+    // a post that raced the last timeout
+    tal_semaphore_wait(sg_snapshot.sem, 0);
+    sg_snapshot.is_armed = true;
+    tal_mutex_unlock(sg_snapshot.mutex);
+
+    tal_semaphore_wait(sg_snapshot.sem, timeout_ms);
+
+    tal_mutex_lock(sg_snapshot.mutex);
+    *frame = sg_snapshot.frame;
+    sg_snapshot.frame = NULL;
+    sg_snapshot.is_armed = false;
+    tal_mutex_unlock(sg_snapshot.mutex);
+
+    return (*frame) ? OPRT_OK : OPRT_TIMEOUT;
+}
+
+/**
+ * @brief Gives a snapshot back to the camera.
+ *
+ * @param frame The frame from tdl_camera_snapshot_take().
+ *
+ * @return None.
+ */
+void tdl_camera_snapshot_release(TDL_CAMERA_FRAME_T *frame)
+{
+    if (NULL == frame) {
+        return;
+    }
+
+    tdl_camera_frame_release(frame);
+}
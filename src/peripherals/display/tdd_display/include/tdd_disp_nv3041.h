@@ -25,6 +25,9 @@ extern "C" {
 #define NV3041_ADDR_1               0x2C
 #define NV3041_ADDR_2               0x00
 
+#define NV3041_CASET                0x2A // Column Address Set
+#define NV3041_RASET                0x2B // Row Address Set
+
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
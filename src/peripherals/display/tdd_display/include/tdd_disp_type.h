@@ -37,6 +37,7 @@ typedef struct {
     TUYA_DISPLAY_ROTATION_E rotation;
     TUYA_DISPLAY_BL_CTRL_T bl;
     TUYA_DISPLAY_IO_CTRL_T power;
+    uint16_t bounce_lines; // sram scanout ring refilled from the frame, 0 scans out the frame directly
 } DISP_RGB_DEVICE_CFG_T;
 
 typedef struct {
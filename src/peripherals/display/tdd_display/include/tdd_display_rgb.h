@@ -36,6 +36,7 @@ typedef struct {
     TDD_DISPLAY_SEQ_INIT_CB     init_cb; 
     TUYA_DISPLAY_ROTATION_E     rotation;
     bool                        is_swap; 
+    uint16_t                    bounce_lines; // sram scanout ring refilled from the frame, 0 scans out the frame directly
 }TDD_DISP_RGB_CFG_T;
 
 /***********************************************************
@@ -55,7 +55,9 @@ typedef struct {
     DISP_SSD1306_INIT_CFG_T  init_cfg;
     TUYA_I2C_NUM_E           port;       // I2C port number
     uint8_t                  slave_addr; // I2C slave address
-    TDL_DISP_FRAME_BUFF_T   *convert_fb; // Frame buffer for conversion
+    TDL_DISP_FRAME_BUFF_T   *convert_fb; // Copy of the panel RAM, page organized
+    uint8_t                 *page_buf;   // One converted page before it is compared
+    bool                     is_synced;  // convert_fb matches the panel RAM
 }DISP_SSD1306_DEV_T;
 
 
@@ -78,30 +80,49 @@ typedef struct {
 // P7 P7 ...
 // P0 P0 ...
 // ...
-static void __tdd_ssd1306_convert(uint32_t width, uint32_t height, uint8_t *in_buf, uint8_t *out_buf)
+/*
+ * Transposes an 8x8 pixel block. in[m] holds 8 pixels of row m (LSB first),
+ * out[k] receives column k with row m in bit m.
+ */
+static void __tdd_ssd1306_transpose8(const uint8_t in[8], uint8_t *out)
 {
-    uint32_t i=0, j=0, m=0, width_bytes = 0;
-    uint8_t b = 0, mix = 0;
+    uint32_t x = 0, y = 0, t = 0;
 
-    if(NULL == in_buf || NULL == out_buf) {
-        return;
-    }
+    x = ((uint32_t)in[7] << 24) | (in[6] << 16) | (in[5] << 8) | in[4];
+    y = ((uint32_t)in[3] << 24) | (in[2] << 16) | (in[1] << 8) | in[0];
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA; x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AA; y = y ^ t ^ (t << 7);
+
+    t = (x ^ (x >> 14)) & 0x0000CCCC; x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCC; y = y ^ t ^ (t << 14);
+
+    t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+    y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+    x = t;
+
+    out[7] = x >> 24; out[6] = x >> 16; out[5] = x >> 8; out[4] = x;
+    out[3] = y >> 24; out[2] = y >> 16; out[1] = y >> 8; out[0] = y;
+}
+
+/*
+ * Converts one page (8 rows starting at row page*8) of the row organized
+ * frame buffer, 8 columns at a time.
+ */
+static void __tdd_ssd1306_convert_page(uint32_t width, uint32_t height, uint8_t *in_buf,\
+                                       uint32_t page, uint8_t *out_buf)
+{
+    uint32_t j = 0, m = 0, width_bytes = 0, row = 0;
+    uint8_t block[8];
 
     width_bytes = width / 8;
+    row = page * 8;
 
-    for(i=0; i<height; i+=8) { 
-        for(j=0; j<width; j++) {
-            for(m=0; m<8; m++) {
-                if(i + m >= height) {
-                    continue;
-                }
-                b = in_buf[(i+m)*width_bytes + j/8];
-                b = (b >> (j%8)) & 0x01;
-                mix |= (b << m);
-            }
-            out_buf[(i/8)*width + j] = mix;
-            mix = 0;
+    for (j = 0; j < width_bytes; j++) {
+        for (m = 0; m < 8; m++) {
+            block[m] = (row + m < height) ? in_buf[(row + m) * width_bytes + j] : 0;
         }
+        __tdd_ssd1306_transpose8(block, out_buf + j * 8);
     }
 }
 
@@ -222,16 +243,23 @@ static OPERATE_RET __tdd_disp_i2c_ssd1306_open(TDD_DISP_DEV_HANDLE_T device)
 
     __disp_i2c_ssd1306_display_on(disp_spi_dev->port, disp_spi_dev->slave_addr);
 
+    disp_spi_dev->is_synced = false;
+
     PR_NOTICE("[SSD1306] Initialize display device successful.");
 
     return rt;
 }
 
+/*
+ * Only the columns that changed since the previous flush are sent, a text
+ * update usually touches one or two pages of the panel.
+ */
 static OPERATE_RET __tdd_disp_i2c_ssd1306_flush(TDD_DISP_DEV_HANDLE_T device, TDL_DISP_FRAME_BUFF_T *frame_buff)
 {
     OPERATE_RET rt = OPRT_OK;
     DISP_SSD1306_DEV_T *disp_spi_dev = NULL;
-    uint16_t j=0, i=0, sizey = 0;
+    uint16_t i=0, sizey = 0, width = 0, x0 = 0, x1 = 0;
+    uint8_t *shadow = NULL;
 
     disp_spi_dev = (DISP_SSD1306_DEV_T *)device;
 
@@ -239,18 +267,40 @@ static OPERATE_RET __tdd_disp_i2c_ssd1306_flush(TDD_DISP_DEV_HANDLE_T device, TD
         return OPRT_INVALID_PARM;
     }
 
-    __tdd_ssd1306_convert(disp_spi_dev->disp_info.width, disp_spi_dev->disp_info.height,
-                          frame_buff->frame, disp_spi_dev->convert_fb->frame);
-
+    width = disp_spi_dev->disp_info.width;
     sizey = (disp_spi_dev->disp_info.height + 7) / 8;
 
     for(i=0; i<sizey; i++) {
-        __disp_i2c_ssd1306_set_pos(disp_spi_dev->port, disp_spi_dev->slave_addr, 0, i);
-        __disp_i2c_write_data(disp_spi_dev->port, disp_spi_dev->slave_addr, SSD1306_DATA_REG,\
-                              disp_spi_dev->convert_fb->frame + j, disp_spi_dev->disp_info.width);
-        j += disp_spi_dev->disp_info.width;
+        shadow = disp_spi_dev->convert_fb->frame + i * width;
+
+        __tdd_ssd1306_convert_page(width, disp_spi_dev->disp_info.height, frame_buff->frame,\
+                                   i, disp_spi_dev->page_buf);
+
+        if(disp_spi_dev->is_synced) {
+            for(x0 = 0; x0 < width && disp_spi_dev->page_buf[x0] == shadow[x0]; x0++);
+            if(x0 == width) {
+                continue;
+            }
+            for(x1 = width - 1; x1 > x0 && disp_spi_dev->page_buf[x1] == shadow[x1]; x1--);
+        }else {
+            x0 = 0;
+            x1 = width - 1;
+        }
+
+        memcpy(shadow + x0, disp_spi_dev->page_buf + x0, x1 - x0 + 1);
+
+        __disp_i2c_ssd1306_set_pos(disp_spi_dev->port, disp_spi_dev->slave_addr, x0, i);
+        rt = __disp_i2c_write_data(disp_spi_dev->port, disp_spi_dev->slave_addr, SSD1306_DATA_REG,\
+                                   shadow + x0, x1 - x0 + 1);
+        if(OPRT_OK != rt) {
+            // the panel RAM is unknown now, resend everything next time
+            disp_spi_dev->is_synced = false;
+            return rt;
+        }
     }
 
+    disp_spi_dev->is_synced = true;
+
     return rt;
 }
 
@@ -294,6 +344,12 @@ OPERATE_RET tdd_disp_i2c_oled_ssd1306_register(char *name, DISP_I2C_OLED_DEVICE_
         return OPRT_MALLOC_FAILED;
     }
 
+    disp_spi_dev->page_buf = (uint8_t *)tal_malloc(dev_cfg->width);
+    if(NULL == disp_spi_dev->page_buf) {
+        return OPRT_MALLOC_FAILED;
+    }
+    memset(disp_spi_dev->page_buf, 0, dev_cfg->width);
+
     disp_spi_dev->port        = dev_cfg->port;
     disp_spi_dev->slave_addr  = dev_cfg->addr;
 
@@ -305,6 +361,7 @@ OPERATE_RET tdd_disp_i2c_oled_ssd1306_register(char *name, DISP_I2C_OLED_DEVICE_
     disp_spi_dev->disp_info.height     = dev_cfg->height;
     disp_spi_dev->disp_info.rotation   = dev_cfg->rotation;
     disp_spi_dev->disp_info.is_swap    = false;
+    disp_spi_dev->disp_info.has_partial = false;
 
     memcpy(&disp_spi_dev->disp_info.power, &dev_cfg->power, sizeof(TUYA_DISPLAY_IO_CTRL_T));
     memcpy(&disp_spi_dev->disp_info.bl, &dev_cfg->bl, sizeof(TUYA_DISPLAY_BL_CTRL_T));
@@ -319,6 +319,7 @@ OPERATE_RET tdd_disp_mcu8080_device_register(char *name, TDD_DISP_MCU8080_CFG_T
     mcu8080_dev_info.fmt      = mcu8080->in_fmt;
     mcu8080_dev_info.rotation = mcu8080->rotation;
     mcu8080_dev_info.is_swap  = mcu8080->is_swap;
+    mcu8080_dev_info.has_partial = false;
 
     memcpy(&mcu8080_dev_info.bl, &mcu8080->bl, sizeof(TUYA_DISPLAY_BL_CTRL_T));
     memcpy(&mcu8080_dev_info.power, &mcu8080->power, sizeof(TUYA_DISPLAY_IO_CTRL_T));
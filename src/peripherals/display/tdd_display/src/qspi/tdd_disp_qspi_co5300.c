@@ -63,11 +63,11 @@ static TDD_DISP_QSPI_CFG_T sg_disp_qspi_cfg = {
 /***********************************************************
 ***********************function define**********************
 ***********************************************************/
+// tdd_display_qspi only calls this when the window changes
 void __tdd_disp_qspi_co5300_set_window(DISP_QSPI_BASE_CFG_T *p_cfg, uint16_t x_start, uint16_t y_start,\
                                            uint16_t x_end, uint16_t y_end)
 {
     uint8_t lcd_data[4];
-    static uint16_t x1=0, x2=0, y1=0, y2=0;
 
     if (NULL == p_cfg) {
         return;
@@ -78,25 +78,17 @@ void __tdd_disp_qspi_co5300_set_window(DISP_QSPI_BASE_CFG_T *p_cfg, uint16_t x_s
     y_start += CO5300_Y_OFFSET;
     y_end   += CO5300_Y_OFFSET;
 
-    if(x1 != x_start || x2 != x_end) {
-        lcd_data[0] = (x_start >> 8) & 0xFF;
-        lcd_data[1] = (x_start & 0xFF);
-        lcd_data[2] = (x_end >> 8) & 0xFF;
-        lcd_data[3] = (x_end & 0xFF);
-        tdd_disp_qspi_send_cmd(p_cfg, CO5300_CASET, lcd_data, sizeof(lcd_data));
-        x1 = x_start;
-        x2 = x_end;
-    }
-
-    if(y1 != y_start || y2 != y_end) {
-        lcd_data[0] = (y_start >> 8) & 0xFF;
-        lcd_data[1] = (y_start & 0xFF);
-        lcd_data[2] = (y_end >> 8) & 0xFF;
-        lcd_data[3] = (y_end & 0xFF);
-        tdd_disp_qspi_send_cmd(p_cfg, CO5300_RASET, lcd_data, sizeof(lcd_data));
-        y1 = y_start;
-        y2 = y_end;
-    }
+    lcd_data[0] = (x_start >> 8) & 0xFF;
+    lcd_data[1] = (x_start & 0xFF);
+    lcd_data[2] = (x_end >> 8) & 0xFF;
+    lcd_data[3] = (x_end & 0xFF);
+    tdd_disp_qspi_send_cmd(p_cfg, CO5300_CASET, lcd_data, sizeof(lcd_data));
+
+    lcd_data[0] = (y_start >> 8) & 0xFF;
+    lcd_data[1] = (y_start & 0xFF);
+    lcd_data[2] = (y_end >> 8) & 0xFF;
+    lcd_data[3] = (y_end & 0xFF);
+    tdd_disp_qspi_send_cmd(p_cfg, CO5300_RASET, lcd_data, sizeof(lcd_data));
 }
 
 
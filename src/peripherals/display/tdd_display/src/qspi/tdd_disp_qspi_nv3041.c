@@ -148,12 +148,32 @@ static TDD_DISP_QSPI_CFG_T sg_disp_qspi_cfg = {
     },
     .is_swap = true,
     .init_seq = cNV3041_INIT_SEQ,
-    .set_window_cb = NULL,
 };
 
 /***********************************************************
 ***********************function define**********************
 ***********************************************************/
+static void __tdd_disp_qspi_nv3041_set_window(DISP_QSPI_BASE_CFG_T *p_cfg, uint16_t x_start, uint16_t y_start,\
+                                              uint16_t x_end, uint16_t y_end)
+{
+    uint8_t lcd_data[4];
+
+    if (NULL == p_cfg) {
+        return;
+    }
+
+    lcd_data[0] = (x_start >> 8) & 0xFF;
+    lcd_data[1] = (x_start & 0xFF);
+    lcd_data[2] = (x_end >> 8) & 0xFF;
+    lcd_data[3] = (x_end & 0xFF);
+    tdd_disp_qspi_send_cmd(p_cfg, NV3041_CASET, lcd_data, sizeof(lcd_data));
+
+    lcd_data[0] = (y_start >> 8) & 0xFF;
+    lcd_data[1] = (y_start & 0xFF);
+    lcd_data[2] = (y_end >> 8) & 0xFF;
+    lcd_data[3] = (y_end & 0xFF);
+    tdd_disp_qspi_send_cmd(p_cfg, NV3041_RASET, lcd_data, sizeof(lcd_data));
+}
 
 OPERATE_RET tdd_disp_qspi_nv3041_register(char *name, DISP_QSPI_DEVICE_CFG_T *dev_cfg)
 {
@@ -170,6 +190,7 @@ OPERATE_RET tdd_disp_qspi_nv3041_register(char *name, DISP_QSPI_DEVICE_CFG_T *de
     sg_disp_qspi_cfg.cfg.freq_hz   = dev_cfg->spi_clk;
     sg_disp_qspi_cfg.cfg.rst_pin   = dev_cfg->rst_pin;
     sg_disp_qspi_cfg.rotation      = dev_cfg->rotation;
+    sg_disp_qspi_cfg.set_window_cb = __tdd_disp_qspi_nv3041_set_window;
 
     memcpy(&sg_disp_qspi_cfg.power, &dev_cfg->power, sizeof(TUYA_DISPLAY_IO_CTRL_T));
     memcpy(&sg_disp_qspi_cfg.bl, &dev_cfg->bl, sizeof(TUYA_DISPLAY_BL_CTRL_T));
@@ -18,10 +18,15 @@
 #include "tkl_gpio.h"
 
 #include "tdd_display_qspi.h"
+#include "tdl_display_draw.h"
 
 /***********************************************************
 ************************macro define************************
 ***********************************************************/
+// longest single dma transfer, tkl_qspi_send() takes a 16 bit length
+#ifndef TDD_DISP_QSPI_DMA_MAX_LEN
+#define TDD_DISP_QSPI_DMA_MAX_LEN 0xFFFC
+#endif
 
 /***********************************************************
 ***********************typedef define***********************
@@ -45,12 +50,24 @@ typedef struct {
     DISP_QSPI_BASE_CFG_T        cfg;
     const uint8_t              *init_seq;
     TDD_DISP_QPI_SET_WINDOW_CB  set_window_cb; // Callback to set the display window
+
+    // last window sent to the panel, CASET/RASET are skipped while it stays the same
+    bool                        win_valid;
+    TDL_DISP_RECT_T             win;
+    SEM_HANDLE                  sync_sem;
 } DISP_QSPI_DEV_T;
 
+// one window, rows of row_len bytes that are stride bytes apart
 typedef struct {
 	QSPI_EVENT_E            event;
 	DISP_QSPI_DEV_T        *dev;
-    TDL_DISP_FRAME_BUFF_T  *p_fb;
+    uint8_t                *data;
+    uint32_t                stride;
+    uint32_t                row_len;
+    uint32_t                rows;
+    TDL_DISP_RECT_T         win;
+    TDL_DISP_FLUSH_DONE_CB  done_cb;
+    void                   *arg;
 } QSPI_MSG_T;
 
 
@@ -148,15 +165,53 @@ static OPERATE_RET __disp_qspi_send_cmd(DISP_QSPI_BASE_CFG_T *p_cfg, uint8_t cmd
     return rt;
 }
 
-static OPERATE_RET __disp_qspi_send_frame(DISP_QSPI_BASE_CFG_T *p_cfg, TDL_DISP_FRAME_BUFF_T *p_fb)
+static OPERATE_RET __disp_qspi_send_dma(DISP_QSPI_BASE_CFG_T *p_cfg, uint8_t *data, uint32_t len)
 {
     OPERATE_RET rt = OPRT_OK;
-    TUYA_QSPI_CMD_T qspi_cmd = {0};
+    uint32_t send_len = 0;
 
-    if (NULL == p_cfg || NULL == p_fb) {
-        return OPRT_INVALID_PARM;
+    while (len) {
+        send_len = MIN(len, TDD_DISP_QSPI_DMA_MAX_LEN);
+
+        TUYA_CALL_ERR_RETURN(tkl_qspi_send(p_cfg->port, data, send_len));//dma
+        TUYA_CALL_ERR_RETURN(tal_semaphore_wait(sg_display_qspi.tx_sem, SEM_WAIT_FOREVER));
+
+        data += send_len;
+        len -= send_len;
+    }
+
+    return rt;
+}
+
+static void __disp_qspi_set_window(DISP_QSPI_DEV_T *dev, TDL_DISP_RECT_T *win)
+{
+    if (NULL == dev->set_window_cb) {
+        return;
+    }
+
+    if (dev->win_valid && 0 == memcmp(&dev->win, win, sizeof(TDL_DISP_RECT_T))) {
+        return;
     }
 
+    dev->set_window_cb(&dev->cfg, win->x0, win->y0, win->x1, win->y1);
+
+    memcpy(&dev->win, win, sizeof(TDL_DISP_RECT_T));
+    dev->win_valid = true;
+}
+
+/*
+ * Sends a window with a single command/address phase, the rows follow as back
+ * to back dma transfers while CS stays low.
+ */
+static OPERATE_RET __disp_qspi_send_window(DISP_QSPI_DEV_T *dev, QSPI_MSG_T *msg)
+{
+    OPERATE_RET rt = OPRT_OK;
+    DISP_QSPI_BASE_CFG_T *p_cfg = &dev->cfg;
+    TUYA_QSPI_CMD_T qspi_cmd = {0};
+    uint32_t row = 0;
+
+    __disp_qspi_set_window(dev, &msg->win);
+
     memset(&qspi_cmd, 0x00, SIZEOF(TUYA_QSPI_CMD_T));
 
     tkl_qspi_force_cs_pin(p_cfg->port, 0);
@@ -175,17 +230,49 @@ static OPERATE_RET __disp_qspi_send_frame(DISP_QSPI_BASE_CFG_T *p_cfg, TDL_DISP_
 
     qspi_cmd.data_size = 0;
     qspi_cmd.dummy_cycle = 0;
-    TUYA_CALL_ERR_RETURN(tkl_qspi_comand(p_cfg->port, &qspi_cmd));
-
-    TUYA_CALL_ERR_RETURN(tkl_qspi_send(p_cfg->port, p_fb->frame, p_fb->len));//dma
-
-    TUYA_CALL_ERR_RETURN(tal_semaphore_wait(sg_display_qspi.tx_sem, SEM_WAIT_FOREVER));
+    TUYA_CALL_ERR_GOTO(tkl_qspi_comand(p_cfg->port, &qspi_cmd), __EXIT);
+
+    // contiguous windows go out straight from the frame
+    if (msg->row_len == msg->stride || 1 == msg->rows) {
+        rt = __disp_qspi_send_dma(p_cfg, msg->data, msg->row_len * msg->rows);
+    } else {
+        for (row = 0; row < msg->rows && OPRT_OK == rt; row++) {
+            rt = __disp_qspi_send_dma(p_cfg, msg->data + row * msg->stride, msg->row_len);
+        }
+    }
 
+__EXIT:
     tkl_qspi_force_cs_pin(p_cfg->port, 1);
 
+    if (OPRT_OK != rt) {
+        // the panel may have missed the window commands
+        dev->win_valid = false;
+    }
+
     return rt;
 }
 
+// describes a frame buffer sent as one window at its x/y position
+static void __disp_qspi_fb_to_msg(DISP_QSPI_DEV_T *dev, TDL_DISP_FRAME_BUFF_T *p_fb, QSPI_MSG_T *msg)
+{
+    memset(msg, 0, sizeof(QSPI_MSG_T));
+    msg->event   = QSPI_FRAME_REQUEST;
+    msg->dev     = dev;
+    msg->data    = p_fb->frame;
+    msg->stride  = p_fb->len;
+    msg->row_len = p_fb->len;
+    msg->rows    = 1;
+    msg->win.x0  = p_fb->x_start;
+    msg->win.y0  = p_fb->y_start;
+    msg->win.x1  = p_fb->x_start + p_fb->width - 1;
+    msg->win.y1  = p_fb->y_start + p_fb->height - 1;
+}
+
+static void __disp_qspi_sync_done_cb(void *arg)
+{
+    tal_semaphore_post((SEM_HANDLE)arg);
+}
+
 static void __tdd_disp_reset(TUYA_GPIO_NUM_E rst_pin)
 {
     if(rst_pin >= TUYA_GPIO_NUM_MAX) {
@@ -241,17 +328,20 @@ static void __display_qspi_task(void *args)
         if(ret == OPRT_OK) {
             switch(msg.event) {
                 case QSPI_FRAME_REQUEST:
-                    if(msg.dev->set_window_cb) {
-                        msg.dev->set_window_cb(&msg.dev->cfg, 0, 0, msg.p_fb->width-1,  msg.p_fb->height-1);
-                    }
+                    __disp_qspi_send_window(msg.dev, &msg);
 
-                    __disp_qspi_send_frame(&msg.dev->cfg, msg.p_fb);
+                    if(msg.done_cb) {
+                        msg.done_cb(msg.arg);
+                    }
                     break;
 
                 case QSPI_FRAME_EXIT:
                     sg_display_qspi.task_running = 0;
                     do {
                         ret = tal_queue_fetch(sg_display_qspi.queue, &msg, 0);//no wait
+                        if(ret == 0 && msg.event == QSPI_FRAME_REQUEST && msg.done_cb) {
+                            msg.done_cb(msg.arg);
+                        }
                     } while(ret == 0);
                     break;
 
@@ -283,6 +373,9 @@ static OPERATE_RET __tdd_display_qspi_open(TDD_DISP_DEV_HANDLE_T device)
 
     __tdd_disp_init_seq(&(disp_qspi_dev->cfg), disp_qspi_dev->init_seq);
 
+    // the reset dropped the panel window
+    disp_qspi_dev->win_valid = false;
+
     if(sg_display_qspi.mutex == NULL) {
         TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&(sg_display_qspi.mutex)));
     }
@@ -291,6 +384,10 @@ static OPERATE_RET __tdd_display_qspi_open(TDD_DISP_DEV_HANDLE_T device)
     TUYA_CALL_ERR_RETURN(tal_semaphore_create_init(&(sg_display_qspi.tx_sem), 0, 1));
     }
 
+    if(disp_qspi_dev->sync_sem == NULL) {
+        TUYA_CALL_ERR_RETURN(tal_semaphore_create_init(&(disp_qspi_dev->sync_sem), 0, 1));
+    }
+
     if(disp_qspi_dev->cfg.is_pixel_memory == 0) {
 
         if(sg_display_qspi.queue == NULL) {
@@ -316,7 +413,7 @@ static OPERATE_RET __tdd_display_qspi_flush(TDD_DISP_DEV_HANDLE_T device, TDL_DI
 {
     OPERATE_RET rt = OPRT_OK;
     DISP_QSPI_DEV_T *disp_qspi_dev = NULL;
-    uint16_t x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    QSPI_MSG_T msg;
 
     if (NULL == device || NULL == frame_buff) {
         return OPRT_INVALID_PARM;
@@ -324,35 +421,70 @@ static OPERATE_RET __tdd_display_qspi_flush(TDD_DISP_DEV_HANDLE_T device, TDL_DI
 
     disp_qspi_dev = (DISP_QSPI_DEV_T *)device;
 
-    tal_mutex_lock(sg_display_qspi.mutex);
+    __disp_qspi_fb_to_msg(disp_qspi_dev, frame_buff, &msg);
 
     if(disp_qspi_dev->cfg.is_pixel_memory) {
-        x0 = frame_buff->x_start;
-        y0 = frame_buff->y_start;
-        x1 = frame_buff->x_start + frame_buff->width - 1;
-        y1 = frame_buff->y_start + frame_buff->height - 1;
+        tal_mutex_lock(sg_display_qspi.mutex);
+        rt = __disp_qspi_send_window(disp_qspi_dev, &msg);
+        tal_mutex_unlock(sg_display_qspi.mutex);
+    }else if(sg_display_qspi.task_running) {
+        // partial windows come from a staging buffer that is reused at once, wait for those
+        if(frame_buff->width != disp_qspi_dev->cfg.width || frame_buff->height != disp_qspi_dev->cfg.height) {
+            msg.done_cb = __disp_qspi_sync_done_cb;
+            msg.arg     = disp_qspi_dev->sync_sem;
+        }
 
+        TUYA_CALL_ERR_RETURN(tal_queue_post(sg_display_qspi.queue, &msg , SEM_WAIT_FOREVER));
 
-        if(disp_qspi_dev->set_window_cb) {
-            disp_qspi_dev->set_window_cb(&disp_qspi_dev->cfg, x0, y0, x1, y1);
+        if(msg.done_cb) {
+            rt = tal_semaphore_wait(disp_qspi_dev->sync_sem, SEM_WAIT_FOREVER);
         }
+    }
 
-        __disp_qspi_send_frame(&(disp_qspi_dev->cfg), frame_buff);
-    }else {
-        if(sg_display_qspi.task_running) {
-            QSPI_MSG_T msg = {
-                .event = QSPI_FRAME_REQUEST,
-                .dev   = disp_qspi_dev,
-                .p_fb  = frame_buff,
-            };
+    return rt;
+}
 
-            tal_queue_post(sg_display_qspi.queue, &msg , SEM_WAIT_FOREVER);
-        }
+static OPERATE_RET __tdd_display_qspi_flush_async(TDD_DISP_DEV_HANDLE_T device, TDL_DISP_FRAME_BUFF_T *frame_buff,
+                                                  TDL_DISP_RECT_T *rect, TDL_DISP_FLUSH_DONE_CB done_cb, void *arg)
+{
+    OPERATE_RET rt = OPRT_OK;
+    DISP_QSPI_DEV_T *disp_qspi_dev = NULL;
+    QSPI_MSG_T msg;
+    uint32_t pixel_bytes = 0;
+
+    if (NULL == device || NULL == frame_buff || NULL == rect) {
+        return OPRT_INVALID_PARM;
     }
 
-    tal_mutex_unlock(sg_display_qspi.mutex);
+    disp_qspi_dev = (DISP_QSPI_DEV_T *)device;
 
-    return rt;
+    pixel_bytes = tdl_disp_get_fmt_bpp(frame_buff->fmt) / 8;
+    if (0 == pixel_bytes) {
+        return OPRT_NOT_SUPPORTED;
+    }
+
+    memset(&msg, 0, sizeof(QSPI_MSG_T));
+    msg.event   = QSPI_FRAME_REQUEST;
+    msg.dev     = disp_qspi_dev;
+    msg.stride  = frame_buff->width * pixel_bytes;
+    msg.data    = frame_buff->frame + rect->y0 * msg.stride + rect->x0 * pixel_bytes;
+    msg.row_len = (rect->x1 - rect->x0 + 1) * pixel_bytes;
+    msg.rows    = rect->y1 - rect->y0 + 1;
+    msg.win     = *rect;
+    msg.done_cb = done_cb;
+    msg.arg     = arg;
+
+    if (disp_qspi_dev->cfg.is_pixel_memory || 0 == sg_display_qspi.task_running) {
+        tal_mutex_lock(sg_display_qspi.mutex);
+        rt = __disp_qspi_send_window(disp_qspi_dev, &msg);
+        tal_mutex_unlock(sg_display_qspi.mutex);
+        if (done_cb) {
+            done_cb(arg);
+        }
+        return rt;
+    }
+
+    return tal_queue_post(sg_display_qspi.queue, &msg, SEM_WAIT_FOREVER);
 }
 
 static OPERATE_RET __tdd_display_qspi_close(TDD_DISP_DEV_HANDLE_T device)
@@ -381,6 +513,7 @@ OPERATE_RET tdd_disp_qspi_device_register(char *name, TDD_DISP_QSPI_CFG_T *qspi)
     if (NULL == disp_qspi_dev) {
         return OPRT_MALLOC_FAILED;
     }
+    memset(disp_qspi_dev, 0x00, sizeof(DISP_QSPI_DEV_T));
     memcpy(&disp_qspi_dev->cfg, &qspi->cfg, sizeof(DISP_QSPI_BASE_CFG_T));
 
     disp_qspi_dev->init_seq      = qspi->init_seq;
@@ -392,6 +525,7 @@ OPERATE_RET tdd_disp_qspi_device_register(char *name, TDD_DISP_QSPI_CFG_T *qspi)
     disp_qspi_dev_info.fmt      = qspi->cfg.pixel_fmt;
     disp_qspi_dev_info.rotation = qspi->rotation;
     disp_qspi_dev_info.is_swap  = qspi->is_swap;
+    disp_qspi_dev_info.has_partial = (qspi->set_window_cb) ? true : false;
 
     memcpy(&disp_qspi_dev_info.bl, &qspi->bl, sizeof(TUYA_DISPLAY_BL_CTRL_T));
     memcpy(&disp_qspi_dev_info.power, &qspi->power, sizeof(TUYA_DISPLAY_IO_CTRL_T));
@@ -400,6 +534,7 @@ OPERATE_RET tdd_disp_qspi_device_register(char *name, TDD_DISP_QSPI_CFG_T *qspi)
         .open  = __tdd_display_qspi_open,
         .flush = __tdd_display_qspi_flush,
         .close = __tdd_display_qspi_close,
+        .flush_async = __tdd_display_qspi_flush_async,
     };
 
     TUYA_CALL_ERR_RETURN(tdl_disp_device_register(name, (TDD_DISP_DEV_HANDLE_T)disp_qspi_dev,\
@@ -179,6 +179,7 @@ OPERATE_RET tdd_disp_rgb_st7701sn_register(char *name, DISP_RGB_DEVICE_CFG_T *de
     sg_disp_rgb.cfg.pixel_fmt = dev_cfg->pixel_fmt;
     sg_disp_rgb.rotation = dev_cfg->rotation;
     sg_disp_rgb.is_swap = false;
+    sg_disp_rgb.bounce_lines = dev_cfg->bounce_lines;
 
     memcpy(&sg_disp_rgb.power, &dev_cfg->power, sizeof(TUYA_DISPLAY_IO_CTRL_T));
     memcpy(&sg_disp_rgb.bl, &dev_cfg->bl, sizeof(TUYA_DISPLAY_BL_CTRL_T));
@@ -25,6 +25,9 @@
 ***********************************************************/
 #define UNACTIVE_LEVEL(level) ((level == 1) ? 0 : 1)
 
+// bounce ring bytes per pixel, wide enough for every frame format
+#define RGB_BOUNCE_PIXEL_SIZE(fmt) (((fmt) == TUYA_PIXEL_FMT_RGB565) ? 2 : 4)
+
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
@@ -47,11 +50,17 @@ typedef struct {
     MUTEX_HANDLE mutex;
     THREAD_HANDLE task;
     QUEUE_HANDLE queue;
+    uint8_t *bounce_buf;       // sram ring the controller scans out, NULL without
+    uint32_t bounce_size;
+    uint16_t bounce_lines;
+    uint16_t bounce_next_line; // next frame line to copy into the ring
+    uint8_t bounce_next_half;  // next half of the ring to be drained
 } TDL_DISP_RGB_INFO_T;
 
 typedef struct {
     TUYA_RGB_BASE_CFG_T cfg;
     TDD_DISPLAY_SEQ_INIT_CB init_cb;
+    uint16_t bounce_lines;
 } DISP_RGB_DEV_T;
 
 /***********************************************************
@@ -67,9 +76,52 @@ static TDL_DISP_RGB_INFO_T sg_display_rgb = {0};
 ***********************function define**********************
 ***********************************************************/
 
-// __attribute__((section(".itcm_sec_code")))
+TUYA_HOT_DISPLAY
+static void __rgb_bounce_fill(TDL_DISP_FRAME_BUFF_T *frame, uint8_t half)
+{
+    uint32_t half_lines = sg_display_rgb.bounce_lines / 2;
+    uint32_t line_size, lines;
+
+    if (NULL == frame || 0 == frame->height || sg_display_rgb.bounce_next_line >= frame->height) {
+        return;
+    }
+
+    line_size = frame->len / frame->height;
+    if (line_size * sg_display_rgb.bounce_lines > sg_display_rgb.bounce_size) {
+        return;
+    }
+
+    lines = frame->height - sg_display_rgb.bounce_next_line;
+    if (lines > half_lines) {
+        lines = half_lines;
+    }
+
+    memcpy(sg_display_rgb.bounce_buf + half * half_lines * line_size,
+           frame->frame + sg_display_rgb.bounce_next_line * line_size, lines * line_size);
+    sg_display_rgb.bounce_next_line += lines;
+}
+
+// the ring is scanned out from its start at every frame, fill both halves ahead
+TUYA_HOT_DISPLAY
+static void __rgb_bounce_prefill(TDL_DISP_FRAME_BUFF_T *frame)
+{
+    sg_display_rgb.bounce_next_line = 0;
+    sg_display_rgb.bounce_next_half = 0;
+    __rgb_bounce_fill(frame, 0);
+    __rgb_bounce_fill(frame, 1);
+}
+
+TUYA_HOT_DISPLAY
 static void __display_rgb_isr(TUYA_RGB_EVENT_E event)
 {
+    if (RGB_BOUNCE_HALF_EMPTY == event) {
+        if (sg_display_rgb.bounce_buf) {
+            __rgb_bounce_fill(sg_display_rgb.display_frame, sg_display_rgb.bounce_next_half);
+            sg_display_rgb.bounce_next_half ^= 1;
+        }
+        return;
+    }
+
     if (sg_display_rgb.pingpong_frame != NULL) {
         if (sg_display_rgb.display_frame != NULL) {
 
@@ -101,6 +153,11 @@ static void __display_rgb_isr(TUYA_RGB_EVENT_E event)
             tal_semaphore_post(sg_display_rgb.flush_sem);
         }
     }
+
+    // frames only change here, between two scanouts, so the ring never mixes them
+    if (sg_display_rgb.bounce_buf) {
+        __rgb_bounce_prefill(sg_display_rgb.display_frame);
+    }
 }
 
 static OPERATE_RET __rgb_display_frame(TDL_DISP_FRAME_BUFF_T *frame)
@@ -112,6 +169,9 @@ static OPERATE_RET __rgb_display_frame(TDL_DISP_FRAME_BUFF_T *frame)
         sg_display_rgb.pingpong_frame = frame;
 
         tkl_rgb_base_addr_set((uint32_t)frame->frame);
+        if (sg_display_rgb.bounce_buf) {
+            __rgb_bounce_prefill(frame);
+        }
         tkl_rgb_display_transfer_start();
     } else {
         if (sg_display_rgb.pingpong_frame != NULL) {
@@ -201,7 +261,29 @@ static OPERATE_RET __tdd_display_rgb_open(TDD_DISP_DEV_HANDLE_T device)
 
     PR_NOTICE("clk:%d", rgb_cfg->clk);
 
-    TUYA_CALL_ERR_RETURN(tkl_rgb_init(rgb_cfg));
+    if (tdd_rgb->bounce_lines >= 2) {
+        sg_display_rgb.bounce_lines = tdd_rgb->bounce_lines & ~1;
+        sg_display_rgb.bounce_size =
+            sg_display_rgb.bounce_lines * rgb_cfg->width * RGB_BOUNCE_PIXEL_SIZE(rgb_cfg->pixel_fmt);
+        sg_display_rgb.bounce_buf = tal_malloc(sg_display_rgb.bounce_size);
+        TUYA_CHECK_NULL_RETURN(sg_display_rgb.bounce_buf, OPRT_MALLOC_FAILED);
+        rgb_cfg->bounce_buf = sg_display_rgb.bounce_buf;
+        rgb_cfg->bounce_lines = sg_display_rgb.bounce_lines;
+    }
+
+    rt = tkl_rgb_init(rgb_cfg);
+    if (OPRT_NOT_SUPPORTED == rt && sg_display_rgb.bounce_buf) {
+        PR_WARN("rgb bounce buffer not supported, scan out the frame");
+        rgb_cfg->bounce_buf = NULL;
+        rgb_cfg->bounce_lines = 0;
+        tal_free(sg_display_rgb.bounce_buf);
+        sg_display_rgb.bounce_buf = NULL;
+        rt = tkl_rgb_init(rgb_cfg);
+    }
+    if (OPRT_OK != rt) {
+        PR_ERR("tkl_rgb_init failed: %d", rt);
+        return rt;
+    }
 
     TUYA_CALL_ERR_RETURN(tkl_rgb_irq_cb_register(__display_rgb_isr));
 
@@ -262,6 +344,7 @@ OPERATE_RET tdd_disp_rgb_device_register(char *name, TDD_DISP_RGB_CFG_T *rgb)
     memcpy(&tdd_rgb->cfg, &rgb->cfg, sizeof(TUYA_RGB_BASE_CFG_T));
 
     tdd_rgb->init_cb = rgb->init_cb;
+    tdd_rgb->bounce_lines = rgb->bounce_lines;
 
     rgb_dev_info.type     = TUYA_DISPLAY_RGB;
     rgb_dev_info.width    = rgb->cfg.width;
@@ -269,6 +352,7 @@ OPERATE_RET tdd_disp_rgb_device_register(char *name, TDD_DISP_RGB_CFG_T *rgb)
     rgb_dev_info.fmt      = rgb->cfg.pixel_fmt;
     rgb_dev_info.rotation = rgb->rotation;
     rgb_dev_info.is_swap  = rgb->is_swap;
+    rgb_dev_info.has_partial = false;
 
     memcpy(&rgb_dev_info.bl, &rgb->bl, sizeof(TUYA_DISPLAY_BL_CTRL_T));
     memcpy(&rgb_dev_info.power, &rgb->power, sizeof(TUYA_DISPLAY_IO_CTRL_T));
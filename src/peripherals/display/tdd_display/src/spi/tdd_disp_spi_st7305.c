@@ -29,7 +29,8 @@
 typedef struct {
     DISP_SPI_BASE_CFG_T cfg;
     uint8_t caset_xs;                  // Column Address Set X Start
-    TDL_DISP_FRAME_BUFF_T *convert_fb; // Frame buffer for conversion
+    TDL_DISP_FRAME_BUFF_T *convert_fb; // Copy of the panel RAM
+    bool is_synced;                    // convert_fb matches the panel RAM
 } DISP_ST7305_DEV_T;
 
 /***********************************************************
@@ -74,11 +75,19 @@ static uint8_t ST7305_INIT_SEQ[] = {
 // Corresponds to one byte of data:
 // BIT7 BIT5 BIT3 BIT1
 // BIT6 BIT4 BIT2 BIT0
-static void __tdd_st7305_convert(TDL_DISP_FRAME_BUFF_T *src_fb, TDL_DISP_FRAME_BUFF_T *dst_fb)
+//
+// Returns the first and last panel line (pair of rows) whose bytes changed,
+// *first > *last when nothing changed.
+static void __tdd_st7305_convert(TDL_DISP_FRAME_BUFF_T *src_fb, TDL_DISP_FRAME_BUFF_T *dst_fb,\
+                                 uint16_t *first, uint16_t *last)
 {
     uint16_t k = 0, i = 0, j = 0, y = 0;
     uint8_t b1 = 0, b2 = 0, mix = 0;
     uint32_t src_width_bytes = 0, offset = 0, dst_width_bytes = 0;
+    bool line_changed = false;
+
+    *first = 0xFFFF;
+    *last = 0;
 
     if (NULL == src_fb || NULL == dst_fb) {
         return;
@@ -94,6 +103,7 @@ static void __tdd_st7305_convert(TDL_DISP_FRAME_BUFF_T *src_fb, TDL_DISP_FRAME_B
         }
 
         k += offset;
+        line_changed = false;
         for (j = 0; j < dst_width_bytes; j += 3) {
 
             for (y = 0; y < 3; y++) {
@@ -113,6 +123,7 @@ static void __tdd_st7305_convert(TDL_DISP_FRAME_BUFF_T *src_fb, TDL_DISP_FRAME_B
                 mix = 0;
                 mix = ((b1 & 0x01) << 7) | ((b2 & 0x01) << 6) | ((b1 & 0x02) << 4) | ((b2 & 0x02) << 3) |
                       ((b1 & 0x04) << 1) | ((b2 & 0x04)) | ((b1 & 0x08) >> 2) | ((b2 & 0x08) >> 3);
+                line_changed |= (dst_fb->frame[k] != mix);
                 dst_fb->frame[k++] = mix;
 
                 // Second 4 bits
@@ -121,15 +132,20 @@ static void __tdd_st7305_convert(TDL_DISP_FRAME_BUFF_T *src_fb, TDL_DISP_FRAME_B
                 mix = 0;
                 mix = ((b1 & 0x01) << 7) | ((b2 & 0x01) << 6) | ((b1 & 0x02) << 4) | ((b2 & 0x02) << 3) |
                       ((b1 & 0x04) << 1) | ((b2 & 0x04)) | ((b1 & 0x08) >> 2) | ((b2 & 0x08) >> 3);
+                line_changed |= (dst_fb->frame[k] != mix);
                 dst_fb->frame[k++] = mix;
             }
         }
 
+        if (line_changed) {
+            *first = MIN(*first, i / 2);
+            *last = i / 2;
+        }
 
     }
 }
 
-static void __disp_spi_st7305_set_addr(DISP_SPI_BASE_CFG_T *p_cfg, uint8_t xs)
+static void __disp_spi_st7305_set_addr(DISP_SPI_BASE_CFG_T *p_cfg, uint8_t xs, uint8_t ys, uint8_t ye)
 {
     uint8_t data[2];
 
@@ -138,8 +154,8 @@ static void __disp_spi_st7305_set_addr(DISP_SPI_BASE_CFG_T *p_cfg, uint8_t xs)
     tdd_disp_spi_send_cmd(p_cfg, p_cfg->cmd_caset);
     tdd_disp_spi_send_data(p_cfg, data, sizeof(data));
 
-    data[0] = 0x00;
-    data[1] = (p_cfg->height + 1) / 2 - 1; // Height is divided by 2 for ST7305
+    data[0] = ys;
+    data[1] = ye; // Height is divided by 2 for ST7305
     tdd_disp_spi_send_cmd(p_cfg, p_cfg->cmd_raset);
     tdd_disp_spi_send_data(p_cfg, data, sizeof(data));
 }
@@ -162,6 +178,8 @@ static OPERATE_RET __tdd_disp_spi_st7305_open(TDD_DISP_DEV_HANDLE_T device)
 
     tdd_disp_spi_init_seq(&(disp_spi_dev->cfg), (const uint8_t *)ST7305_INIT_SEQ);
 
+    disp_spi_dev->is_synced = false;
+
     PR_DEBUG("[ST7305] Initialize display device successful.");
 
     return OPRT_OK;
@@ -171,6 +189,8 @@ static OPERATE_RET __tdd_disp_spi_st7305_flush(TDD_DISP_DEV_HANDLE_T device, TDL
 {
     OPERATE_RET rt = OPRT_OK;
     DISP_ST7305_DEV_T *disp_spi_dev = NULL;
+    uint16_t first = 0, last = 0;
+    uint32_t line_bytes = 0;
 
     if (NULL == device || NULL == frame_buff) {
         return OPRT_INVALID_PARM;
@@ -178,12 +198,26 @@ static OPERATE_RET __tdd_disp_spi_st7305_flush(TDD_DISP_DEV_HANDLE_T device, TDL
 
     disp_spi_dev = (DISP_ST7305_DEV_T *)device;
 
-    __tdd_st7305_convert(frame_buff, disp_spi_dev->convert_fb);
+    __tdd_st7305_convert(frame_buff, disp_spi_dev->convert_fb, &first, &last);
 
-    __disp_spi_st7305_set_addr(&disp_spi_dev->cfg, disp_spi_dev->caset_xs);
+    // only the band of lines that changed is written
+    if (false == disp_spi_dev->is_synced) {
+        first = 0;
+        last = disp_spi_dev->cfg.height / 2 - 1;
+    } else if (first > last) {
+        return OPRT_OK;
+    }
+
+    line_bytes = disp_spi_dev->convert_fb->len / (disp_spi_dev->cfg.height / 2);
+
+    __disp_spi_st7305_set_addr(&disp_spi_dev->cfg, disp_spi_dev->caset_xs, first, last);
 
     tdd_disp_spi_send_cmd(&disp_spi_dev->cfg, disp_spi_dev->cfg.cmd_ramwr);
-    tdd_disp_spi_send_data(&disp_spi_dev->cfg, disp_spi_dev->convert_fb->frame, disp_spi_dev->convert_fb->len);
+    rt = tdd_disp_spi_send_data(&disp_spi_dev->cfg, disp_spi_dev->convert_fb->frame + first * line_bytes,\
+                                (last - first + 1) * line_bytes);
+
+    // resend everything next time if the panel RAM is unknown
+    disp_spi_dev->is_synced = (OPRT_OK == rt);
 
     return rt;
 }
@@ -253,6 +287,7 @@ OPERATE_RET tdd_disp_spi_mono_st7305_register(char *name, DISP_SPI_DEVICE_CFG_T
     disp_spi_dev_info.fmt       = TUYA_PIXEL_FMT_MONOCHROME;
     disp_spi_dev_info.rotation  = dev_cfg->rotation;
     disp_spi_dev_info.is_swap   = false;
+    disp_spi_dev_info.has_partial = false;
 
     memcpy(&disp_spi_dev_info.power, &dev_cfg->power, sizeof(TUYA_DISPLAY_IO_CTRL_T));
     memcpy(&disp_spi_dev_info.bl, &dev_cfg->bl, sizeof(TUYA_DISPLAY_BL_CTRL_T));
@@ -17,10 +17,22 @@
 #include "tkl_gpio.h"
 
 #include "tdd_display_spi.h"
+#include "tdl_display_draw.h"
 
 /***********************************************************
 ************************macro define************************
 ***********************************************************/
+// send frames from a driver task so that the caller keeps rendering meanwhile
+#ifndef TDD_DISP_SPI_ASYNC_ENABLE
+#define TDD_DISP_SPI_ASYNC_ENABLE 1
+#endif
+
+// size of each of the two bands used to pack windows narrower than the frame
+#ifndef TDD_DISP_SPI_BAND_SIZE
+#define TDD_DISP_SPI_BAND_SIZE (4 * 1024)
+#endif
+
+#define TDD_DISP_SPI_QUEUE_NUM 16
 
 /***********************************************************
 ***********************typedef define***********************
@@ -33,8 +45,27 @@ typedef struct {
     DISP_SPI_BASE_CFG_T         cfg;
     const uint8_t              *init_seq;
     TDD_DISP_SPI_SET_WINDOW_CB  set_window_cb;
+
+    THREAD_HANDLE               task;
+    QUEUE_HANDLE                queue;
+    SEM_HANDLE                  sync_sem;
+    uint8_t                    *band[2];
 }DISP_SPI_DEV_T;
 
+// one window, rows of row_len bytes that are stride bytes apart
+typedef struct {
+    uint8_t                *data;
+    uint32_t                stride;
+    uint32_t                row_len;
+    uint32_t                rows;
+    uint16_t                x0;
+    uint16_t                y0;
+    uint16_t                x1;
+    uint16_t                y1;
+    TDL_DISP_FLUSH_DONE_CB  done_cb;
+    void                   *arg;
+} DISP_SPI_MSG_T;
+
 /***********************************************************
 ********************function declaration********************
 ***********************************************************/
@@ -159,6 +190,135 @@ static void __disp_spi_set_window(DISP_SPI_BASE_CFG_T *p_cfg, uint16_t x_start,
     tdd_disp_spi_send_data(p_cfg, lcd_data, 4);
 }
 
+// packs the next part of the window into buf, returns the packed length
+static uint32_t __disp_spi_pack(DISP_SPI_MSG_T *msg, uint32_t *row, uint32_t *offset, uint8_t *buf, uint32_t size)
+{
+    uint32_t len = 0, copy = 0;
+
+    while (len < size && *row < msg->rows) {
+        copy = MIN(msg->row_len - *offset, size - len);
+        memcpy(buf + len, msg->data + *row * msg->stride + *offset, copy);
+        len += copy;
+        *offset += copy;
+        if (*offset == msg->row_len) {
+            *offset = 0;
+            (*row)++;
+        }
+    }
+
+    return len;
+}
+
+static OPERATE_RET __disp_spi_send_window(DISP_SPI_DEV_T *disp_spi_dev, DISP_SPI_MSG_T *msg)
+{
+    OPERATE_RET rt = OPRT_OK;
+    DISP_SPI_BASE_CFG_T *p_cfg = &disp_spi_dev->cfg;
+    uint32_t band_size = MIN(TDD_DISP_SPI_BAND_SIZE, tkl_spi_get_max_dma_data_length());
+    uint32_t row = 0, offset = 0, len = 0, next_len = 0;
+    uint8_t cur = 0;
+
+    if(disp_spi_dev->set_window_cb) {
+        disp_spi_dev->set_window_cb(p_cfg, msg->x0, msg->y0, msg->x1, msg->y1);
+    }else {
+        __disp_spi_set_window(p_cfg, msg->x0, msg->y0, msg->x1, msg->y1);
+    }
+
+    tdd_disp_spi_send_cmd(p_cfg, p_cfg->cmd_ramwr);
+
+    // contiguous windows go out straight from the frame
+    if (msg->row_len == msg->stride || 1 == msg->rows) {
+        return tdd_disp_spi_send_data(p_cfg, msg->data, msg->row_len * msg->rows);
+    }
+
+    if (NULL == disp_spi_dev->band[0]) {
+        for (row = 0; row < msg->rows; row++) {
+            TUYA_CALL_ERR_RETURN(tdd_disp_spi_send_data(p_cfg, msg->data + row * msg->stride, msg->row_len));
+        }
+        return OPRT_OK;
+    }
+
+    // band N is on the wire while the CPU packs band N+1
+    tkl_gpio_write(p_cfg->cs_pin, TUYA_GPIO_LEVEL_LOW);
+    tkl_gpio_write(p_cfg->dc_pin, TUYA_GPIO_LEVEL_HIGH);
+
+    len = __disp_spi_pack(msg, &row, &offset, disp_spi_dev->band[cur], band_size);
+    while (len) {
+        TUYA_CALL_ERR_GOTO(tkl_spi_send(p_cfg->port, disp_spi_dev->band[cur], len), __EXIT);
+
+        next_len = __disp_spi_pack(msg, &row, &offset, disp_spi_dev->band[cur ^ 1], band_size);
+
+        rt = tal_semaphore_wait(sg_disp_spi_sync[p_cfg->port].tx_sem, 100);
+        if (rt != OPRT_OK) {
+            PR_ERR("spi tx wait timeout, port:%d len:%d\r\n", p_cfg->port, len);
+            goto __EXIT;
+        }
+
+        cur ^= 1;
+        len = next_len;
+    }
+
+__EXIT:
+    tkl_gpio_write(p_cfg->cs_pin, TUYA_GPIO_LEVEL_HIGH);
+
+    return rt;
+}
+
+static void __disp_spi_task(void *args)
+{
+    DISP_SPI_DEV_T *disp_spi_dev = (DISP_SPI_DEV_T *)args;
+    DISP_SPI_MSG_T msg;
+
+    for (;;) {
+        if (OPRT_OK != tal_queue_fetch(disp_spi_dev->queue, &msg, SEM_WAIT_FOREVER)) {
+            continue;
+        }
+
+        __disp_spi_send_window(disp_spi_dev, &msg);
+
+        if (msg.done_cb) {
+            msg.done_cb(msg.arg);
+        }
+    }
+}
+
+static void __disp_spi_sync_done_cb(void *arg)
+{
+    tal_semaphore_post((SEM_HANDLE)arg);
+}
+
+static OPERATE_RET __disp_spi_async_init(DISP_SPI_DEV_T *disp_spi_dev)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    if (disp_spi_dev->task) {
+        return OPRT_OK;
+    }
+
+    disp_spi_dev->band[0] = tal_malloc(TDD_DISP_SPI_BAND_SIZE);
+    disp_spi_dev->band[1] = tal_malloc(TDD_DISP_SPI_BAND_SIZE);
+    if (NULL == disp_spi_dev->band[0] || NULL == disp_spi_dev->band[1]) {
+        // windows still go out row by row
+        PR_ERR("spi band malloc failed");
+        if (disp_spi_dev->band[0]) {
+            tal_free(disp_spi_dev->band[0]);
+            disp_spi_dev->band[0] = NULL;
+        }
+        if (disp_spi_dev->band[1]) {
+            tal_free(disp_spi_dev->band[1]);
+            disp_spi_dev->band[1] = NULL;
+        }
+    }
+
+    TUYA_CALL_ERR_RETURN(tal_semaphore_create_init(&disp_spi_dev->sync_sem, 0, 1));
+    TUYA_CALL_ERR_RETURN(tal_queue_create_init(&disp_spi_dev->queue, sizeof(DISP_SPI_MSG_T), TDD_DISP_SPI_QUEUE_NUM));
+
+    THREAD_CFG_T thread_cfg = {4096, THREAD_PRIO_1, "disp_spi_task"};
+    TUYA_CALL_ERR_RETURN(tal_thread_create_and_start(&disp_spi_dev->task, NULL, NULL, __disp_spi_task, \
+                                                     disp_spi_dev, &thread_cfg));
+
+    return OPRT_OK;
+}
+
 static OPERATE_RET __tdd_display_spi_open(TDD_DISP_DEV_HANDLE_T device)
 {
     DISP_SPI_DEV_T *disp_spi_dev = NULL;
@@ -172,6 +332,12 @@ static OPERATE_RET __tdd_display_spi_open(TDD_DISP_DEV_HANDLE_T device)
 
     tdd_disp_spi_init_seq(&(disp_spi_dev->cfg), disp_spi_dev->init_seq);
 
+#if TDD_DISP_SPI_ASYNC_ENABLE
+    if (OPRT_OK != __disp_spi_async_init(disp_spi_dev)) {
+        PR_ERR("spi async init failed, frames are sent synchronously");
+    }
+#endif
+
     return OPRT_OK;
 }
 
@@ -179,7 +345,7 @@ static OPERATE_RET __tdd_display_spi_flush(TDD_DISP_DEV_HANDLE_T device, TDL_DIS
 {
     OPERATE_RET rt = OPRT_OK;
     DISP_SPI_DEV_T *disp_spi_dev = NULL;
-    uint16_t x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    DISP_SPI_MSG_T msg;
 
     if (NULL == device || NULL == frame_buff) {
         return OPRT_INVALID_PARM;
@@ -187,21 +353,67 @@ static OPERATE_RET __tdd_display_spi_flush(TDD_DISP_DEV_HANDLE_T device, TDL_DIS
 
     disp_spi_dev = (DISP_SPI_DEV_T *)device;
 
-    x0 = frame_buff->x_start;
-    y0 = frame_buff->y_start;
-    x1 = frame_buff->x_start + frame_buff->width - 1;
-    y1 = frame_buff->y_start + frame_buff->height - 1;
+    memset(&msg, 0, sizeof(DISP_SPI_MSG_T));
+    msg.data    = frame_buff->frame;
+    msg.stride  = frame_buff->len;
+    msg.row_len = frame_buff->len;
+    msg.rows    = 1;
+    msg.x0      = frame_buff->x_start;
+    msg.y0      = frame_buff->y_start;
+    msg.x1      = frame_buff->x_start + frame_buff->width - 1;
+    msg.y1      = frame_buff->y_start + frame_buff->height - 1;
+
+    if (NULL == disp_spi_dev->task) {
+        return __disp_spi_send_window(disp_spi_dev, &msg);
+    }
 
-    if(disp_spi_dev->set_window_cb) {
-        disp_spi_dev->set_window_cb(&disp_spi_dev->cfg, x0, y0, x1, y1);
-    }else {
-        __disp_spi_set_window(&disp_spi_dev->cfg, x0, y0, x1, y1);
+    // queue behind pending async windows and wait
+    msg.done_cb = __disp_spi_sync_done_cb;
+    msg.arg     = disp_spi_dev->sync_sem;
+    TUYA_CALL_ERR_RETURN(tal_queue_post(disp_spi_dev->queue, &msg, SEM_WAIT_FOREVER));
+
+    return tal_semaphore_wait(disp_spi_dev->sync_sem, SEM_WAIT_FOREVER);
+}
+
+static OPERATE_RET __tdd_display_spi_flush_async(TDD_DISP_DEV_HANDLE_T device, TDL_DISP_FRAME_BUFF_T *frame_buff,
+                                                 TDL_DISP_RECT_T *rect, TDL_DISP_FLUSH_DONE_CB done_cb, void *arg)
+{
+    DISP_SPI_DEV_T *disp_spi_dev = NULL;
+    DISP_SPI_MSG_T msg;
+    uint32_t pixel_bytes = 0;
+
+    if (NULL == device || NULL == frame_buff || NULL == rect) {
+        return OPRT_INVALID_PARM;
     }
 
-    tdd_disp_spi_send_cmd(&disp_spi_dev->cfg, disp_spi_dev->cfg.cmd_ramwr);
-    tdd_disp_spi_send_data(&disp_spi_dev->cfg, frame_buff->frame, frame_buff->len);
+    disp_spi_dev = (DISP_SPI_DEV_T *)device;
 
-    return rt;
+    pixel_bytes = tdl_disp_get_fmt_bpp(frame_buff->fmt) / 8;
+    if (0 == pixel_bytes) {
+        return OPRT_NOT_SUPPORTED;
+    }
+
+    memset(&msg, 0, sizeof(DISP_SPI_MSG_T));
+    msg.stride  = frame_buff->width * pixel_bytes;
+    msg.data    = frame_buff->frame + rect->y0 * msg.stride + rect->x0 * pixel_bytes;
+    msg.row_len = (rect->x1 - rect->x0 + 1) * pixel_bytes;
+    msg.rows    = rect->y1 - rect->y0 + 1;
+    msg.x0      = rect->x0;
+    msg.y0      = rect->y0;
+    msg.x1      = rect->x1;
+    msg.y1      = rect->y1;
+    msg.done_cb = done_cb;
+    msg.arg     = arg;
+
+    if (NULL == disp_spi_dev->task) {
+        OPERATE_RET rt = __disp_spi_send_window(disp_spi_dev, &msg);
+        if (done_cb) {
+            done_cb(arg);
+        }
+        return rt;
+    }
+
+    return tal_queue_post(disp_spi_dev->queue, &msg, SEM_WAIT_FOREVER);
 }
 
 static OPERATE_RET __tdd_display_spi_close(TDD_DISP_DEV_HANDLE_T device)
@@ -417,6 +629,7 @@ OPERATE_RET tdd_disp_spi_device_register(char *name, TDD_DISP_SPI_CFG_T *spi)
     disp_spi_dev_info.fmt      = spi->cfg.pixel_fmt;
     disp_spi_dev_info.rotation = spi->rotation;
     disp_spi_dev_info.is_swap  = spi->is_swap;
+    disp_spi_dev_info.has_partial = true;
 
     memcpy(&disp_spi_dev_info.bl, &spi->bl, sizeof(TUYA_DISPLAY_BL_CTRL_T));
     memcpy(&disp_spi_dev_info.power, &spi->power, sizeof(TUYA_DISPLAY_IO_CTRL_T));
@@ -425,6 +638,7 @@ OPERATE_RET tdd_disp_spi_device_register(char *name, TDD_DISP_SPI_CFG_T *spi)
         .open  = __tdd_display_spi_open,
         .flush = __tdd_display_spi_flush,
         .close = __tdd_display_spi_close,
+        .flush_async = __tdd_display_spi_flush_async,
     };
 
     TUYA_CALL_ERR_RETURN(tdl_disp_device_register(name, (TDD_DISP_DEV_HANDLE_T)disp_spi_dev,\
@@ -22,17 +22,14 @@ extern "C" {
 /***********************************************************
 ************************macro define************************
 ***********************************************************/
-typedef struct {
-    uint16_t x0;
-    uint16_t y0;
-    uint16_t x1;
-    uint16_t y1;
-} TDL_DISP_RECT_T;
 
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
-
+typedef enum {
+    TDL_DISP_DITHER_NONE = 0, // plain threshold
+    TDL_DISP_DITHER_ORDERED,  // 4x4 Bayer ordered dithering
+} TDL_DISP_DITHER_E;
 
 /***********************************************************
 ********************function declaration********************
@@ -70,9 +67,49 @@ OPERATE_RET tdl_disp_draw_fill(TDL_DISP_FRAME_BUFF_T *fb, TDL_DISP_RECT_T *rect,
  */
 OPERATE_RET tdl_disp_draw_fill_full(TDL_DISP_FRAME_BUFF_T *fb, uint32_t color, bool is_swap);
 
+/**
+ * @brief Draws a 1 bit bitmap scaled up by an integer factor, e.g. a QR code.
+ *
+ * Equal bits next to each other are filled as one run with the row kernels of
+ * tdl_disp_draw_fill(), and for RGB formats every scaled row is drawn once and
+ * copied. A dark module of qrcode_cache_get() is a set bit.
+ *
+ * @param fb Pointer to the frame buffer structure.
+ * @param x X coordinate of the top left corner.
+ * @param y Y coordinate of the top left corner.
+ * @param bits Bit (row * w + col) is the pixel at col/row, LSB first, rows are not padded.
+ * @param w Width of the bitmap in bits.
+ * @param h Height of the bitmap in bits.
+ * @param scale Number of pixels per bit in both directions.
+ * @param fg_color Color of a set bit.
+ * @param bg_color Color of a clear bit.
+ * @param is_swap Whether to swap byte order for RGB565 format.
+ * @return OPERATE_RET Operation result code.
+ */
+OPERATE_RET tdl_disp_draw_bitmap(TDL_DISP_FRAME_BUFF_T *fb, uint16_t x, uint16_t y, const uint8_t *bits, uint16_t w,
+                                 uint16_t h, uint8_t scale, uint32_t fg_color, uint32_t bg_color, bool is_swap);
+
+/**
+ * @brief Copies a rectangular area from one frame buffer into another.
+ *
+ * Both frame buffers must have the same RGB pixel format. The buffers may be
+ * the same, overlapping areas are handled.
+ *
+ * @param dst_fb Pointer to the destination frame buffer.
+ * @param x X coordinate of the destination top left corner.
+ * @param y Y coordinate of the destination top left corner.
+ * @param src_fb Pointer to the source frame buffer.
+ * @param src_rect Area of the source to copy, NULL copies the whole source.
+ * @return OPERATE_RET Operation result code.
+ */
+OPERATE_RET tdl_disp_draw_blit(TDL_DISP_FRAME_BUFF_T *dst_fb, uint16_t x, uint16_t y,\
+                               TDL_DISP_FRAME_BUFF_T *src_fb, TDL_DISP_RECT_T *src_rect);
+
 /**
  * @brief Rotates a display frame buffer to the specified angle.
  *
+ * 180 degree rotation may be done in place (in_fb and out_fb sharing the frame).
+ *
  * @param rot Rotation angle (90, 180, 270 degrees).
  * @param in_fb Pointer to the input frame buffer structure.
  * @param out_fb Pointer to the output frame buffer structure.
@@ -84,6 +121,25 @@ OPERATE_RET tdl_disp_draw_rotate(TUYA_DISPLAY_ROTATION_E rot, \
                                    TDL_DISP_FRAME_BUFF_T *out_fb,\
                                    bool is_swap);
 
+/**
+ * @brief Rotates one rendered area straight into its place in a full frame buffer.
+ *
+ * Used by the LVGL port so that only the dirty area is rotated, without an
+ * intermediate rotation buffer. RGB565 and RGB888 only.
+ *
+ * @param rot Rotation angle (90, 180, 270 degrees).
+ * @param in_fb The area pixels, x_start/y_start/width/height give the area in
+ *              unrotated (logical) screen coordinates.
+ * @param out_fb The full frame buffer in panel orientation.
+ * @param is_swap Flag indicating whether to swap the frame buffers(rgb565).
+ * @param out_rect Returns the area covered in out_fb, may be NULL.
+ * @return OPERATE_RET Operation result code.
+ */
+OPERATE_RET tdl_disp_draw_rotate_area(TUYA_DISPLAY_ROTATION_E rot, \
+                                      TDL_DISP_FRAME_BUFF_T *in_fb, \
+                                      TDL_DISP_FRAME_BUFF_T *out_fb,\
+                                      bool is_swap, TDL_DISP_RECT_T *out_rect);
+
 /**
  * @brief Gets the bits per pixel for the specified display pixel format.
  *
@@ -114,6 +170,69 @@ uint32_t tdl_disp_convert_color_fmt(uint32_t color, TUYA_DISPLAY_PIXEL_FMT_E src
  */
 uint32_t tdl_disp_convert_rgb565_to_color(uint16_t rgb565, TUYA_DISPLAY_PIXEL_FMT_E fmt, uint32_t threshold);
 
+/**
+ * @brief Converts a run of RGB565 pixels to RGB888.
+ *
+ * The output is stored the way RGB888 frame buffers are, blue first.
+ *
+ * @param src RGB565 pixels.
+ * @param dst Output, 3 bytes per pixel.
+ * @param num Number of pixels.
+ * @param is_swap Whether the source pixels are byte swapped.
+ * @return None.
+ */
+void tdl_disp_convert_rgb565_to_rgb888(const uint16_t *src, uint8_t *dst, uint32_t num, bool is_swap);
+
+/**
+ * @brief Converts a run of RGB888 pixels (blue first) to RGB565.
+ *
+ * @param src RGB888 pixels, 3 bytes per pixel.
+ * @param dst Output RGB565 pixels.
+ * @param num Number of pixels.
+ * @param is_swap Whether to byte swap the output pixels.
+ * @return None.
+ */
+void tdl_disp_convert_rgb888_to_rgb565(const uint8_t *src, uint16_t *dst, uint32_t num, bool is_swap);
+
+/**
+ * @brief Byte swaps a run of RGB565 pixels, src and dst may be the same buffer.
+ *
+ * @param src RGB565 pixels.
+ * @param dst Output pixels.
+ * @param num Number of pixels.
+ * @return None.
+ */
+void tdl_disp_convert_rgb565_swap(const uint16_t *src, uint16_t *dst, uint32_t num);
+
+/**
+ * @brief Converts a run of YUV422 (YUYV) pixels to RGB565.
+ *
+ * @param src YUYV data, 2 bytes per pixel.
+ * @param dst Output RGB565 pixels.
+ * @param num Number of pixels, an odd last pixel is dropped.
+ * @param is_swap Whether to byte swap the output pixels.
+ * @return None.
+ */
+void tdl_disp_convert_yuv422_to_rgb565(const uint8_t *src, uint16_t *dst, uint32_t num, bool is_swap);
+
+/**
+ * @brief Converts an area of RGB565 pixels into a monochrome or I2 frame buffer.
+ *
+ * Pixels darker than the threshold set their bit in monochrome buffers. In I2
+ * buffers the level grows with darkness, 3 is black.
+ *
+ * @param src RGB565 pixels of the area, rows of (rect->x1 - rect->x0 + 1) pixels.
+ * @param is_swap Whether the source pixels are byte swapped.
+ * @param rect Position of the area in the frame buffer, clipped to the frame buffer.
+ * @param dst_fb Destination frame buffer, TUYA_PIXEL_FMT_MONOCHROME or TUYA_PIXEL_FMT_I2.
+ * @param threshold Luma threshold (0-255) for monochrome output, 128 is the middle.
+ * @param dither Dithering mode.
+ * @return OPERATE_RET Operation result code.
+ */
+OPERATE_RET tdl_disp_convert_rgb565_to_bits(const uint16_t *src, bool is_swap, TDL_DISP_RECT_T *rect,\
+                                            TDL_DISP_FRAME_BUFF_T *dst_fb, uint8_t threshold,\
+                                            TDL_DISP_DITHER_E dither);
+
 #ifdef __cplusplus
 }
 #endif
@@ -64,6 +64,7 @@ typedef struct {
     bool                      is_swap;
     TUYA_DISPLAY_PIXEL_FMT_E  fmt;
     TUYA_DISPLAY_ROTATION_E   rotation;
+    bool                      has_partial; // flush() sends a frame smaller than the panel to its x/y window
     TUYA_DISPLAY_BL_CTRL_T    bl;
     TUYA_DISPLAY_IO_CTRL_T    power;
 } TDD_DISP_DEV_INFO_T;
@@ -72,6 +73,11 @@ typedef struct {
     OPERATE_RET (*open)(TDD_DISP_DEV_HANDLE_T device);
     OPERATE_RET (*flush)(TDD_DISP_DEV_HANDLE_T device, TDL_DISP_FRAME_BUFF_T *frame_buff);
     OPERATE_RET (*close)(TDD_DISP_DEV_HANDLE_T device);
+    /* optional, queues @rect of the full frame @frame_buff (its width is the row
+     * stride) and returns at once. Requests are sent in order, done_cb runs in
+     * the driver task once the frame data is no longer read. */
+    OPERATE_RET (*flush_async)(TDD_DISP_DEV_HANDLE_T device, TDL_DISP_FRAME_BUFF_T *frame_buff,
+                               TDL_DISP_RECT_T *rect, TDL_DISP_FLUSH_DONE_CB done_cb, void *arg);
 } TDD_DISP_INTFS_T;
 
 typedef TDL_DISP_FRAME_BUFF_T *(*TDD_DISP_CONVERT_FB_CB)(TDL_DISP_FRAME_BUFF_T *frame_buff);
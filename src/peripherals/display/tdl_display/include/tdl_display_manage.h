@@ -23,6 +23,26 @@ extern "C" {
 /***********************************************************
 ************************macro define************************
 ***********************************************************/
+// max windows kept by a dirty rect list, further rects are merged into them
+#ifndef TDL_DISP_DIRTY_RECT_MAX
+#define TDL_DISP_DIRTY_RECT_MAX 8
+#endif
+
+// cost of opening one more panel window, in pixels, two rects are merged when
+// their union wastes less than this
+#ifndef TDL_DISP_DIRTY_WINDOW_COST
+#define TDL_DISP_DIRTY_WINDOW_COST 512
+#endif
+
+// dirty area (percent of the panel) above which one full frame is sent instead
+#ifndef TDL_DISP_DIRTY_FULL_PERCENT
+#define TDL_DISP_DIRTY_FULL_PERCENT 70
+#endif
+
+// staging buffer used to pack rects narrower than the frame buffer
+#ifndef TDL_DISP_DIRTY_STAGE_SIZE
+#define TDL_DISP_DIRTY_STAGE_SIZE (8 * 1024)
+#endif
 
 /***********************************************************
 ***********************typedef define***********************
@@ -66,8 +86,24 @@ typedef struct {
     uint16_t height;
     TUYA_DISPLAY_PIXEL_FMT_E fmt;
     bool                     is_swap;
+    bool                     has_partial; // tdl_disp_dev_flush_rects() updates windows
 } TDL_DISP_DEV_INFO_T;
 
+// corners are inclusive
+typedef struct {
+    uint16_t x0;
+    uint16_t y0;
+    uint16_t x1;
+    uint16_t y1;
+} TDL_DISP_RECT_T;
+
+typedef struct {
+    uint8_t num;
+    TDL_DISP_RECT_T rect[TDL_DISP_DIRTY_RECT_MAX];
+} TDL_DISP_RECT_LIST_T;
+
+typedef void (*TDL_DISP_FLUSH_DONE_CB)(void *arg);
+
 /***********************************************************
 ********************function declaration********************
 ***********************************************************/
@@ -157,6 +193,65 @@ void tdl_disp_free_frame_buff(TDL_DISP_FRAME_BUFF_T *frame_buff);
  */
 OPERATE_RET tdl_disp_dev_flush(TDL_DISP_HANDLE_T disp_hdl, TDL_DISP_FRAME_BUFF_T *frame_buff);
 
+/**
+ * @brief Empties a dirty rect list.
+ *
+ * @param list Pointer to the rect list.
+ *
+ * @return None.
+ */
+void tdl_disp_rect_list_clear(TDL_DISP_RECT_LIST_T *list);
+
+/**
+ * @brief Adds a dirty rect to a list.
+ *
+ * Overlapping or nearby rects are merged when a single window is cheaper than
+ * two. When the list is full the rect is merged with the one it grows least.
+ *
+ * @param list Pointer to the rect list.
+ * @param rect The dirty rect in panel coordinates.
+ *
+ * @return None.
+ */
+void tdl_disp_rect_list_add(TDL_DISP_RECT_LIST_T *list, const TDL_DISP_RECT_T *rect);
+
+/**
+ * @brief Flushes only the dirty rects of a full frame buffer to the display device.
+ *
+ * Each rect is sent as its own window. Rects spanning the full width are sent
+ * straight from the frame buffer, narrower rects are packed through a small
+ * staging buffer. The whole frame is sent instead when the panel cannot take
+ * windows (see has_partial), the pixel format is below one byte per pixel, or
+ * the dirty area exceeds TDL_DISP_DIRTY_FULL_PERCENT.
+ *
+ * @param disp_hdl Handle to the display device.
+ * @param frame_buff The full frame, its width is the row stride.
+ * @param list The dirty rects, NULL or empty sends the whole frame.
+ *
+ * @return Returns OPRT_OK on success, or an appropriate error code if flushing fails.
+ */
+OPERATE_RET tdl_disp_dev_flush_rects(TDL_DISP_HANDLE_T disp_hdl, TDL_DISP_FRAME_BUFF_T *frame_buff,
+                                     TDL_DISP_RECT_LIST_T *list);
+
+/**
+ * @brief Flushes the dirty rects of a full frame buffer without waiting for the transfer.
+ *
+ * Rects are chosen as in tdl_disp_dev_flush_rects(). Drivers with a background
+ * transfer queue the rects and return at once, the frame must stay untouched
+ * until done_cb runs (in the driver task). Other drivers flush synchronously
+ * and done_cb is called before returning. done_cb is called on errors too.
+ *
+ * @param disp_hdl Handle to the display device.
+ * @param frame_buff The full frame, its width is the row stride.
+ * @param list The dirty rects, NULL or empty sends the whole frame.
+ * @param done_cb Called once the frame is no longer read, may be NULL.
+ * @param arg Argument of done_cb.
+ *
+ * @return Returns OPRT_OK on success, or an appropriate error code if flushing fails.
+ */
+OPERATE_RET tdl_disp_dev_flush_rects_async(TDL_DISP_HANDLE_T disp_hdl, TDL_DISP_FRAME_BUFF_T *frame_buff,
+                                           TDL_DISP_RECT_LIST_T *list, TDL_DISP_FLUSH_DONE_CB done_cb, void *arg);
+
 /**
  * @brief Closes and deinitializes a display device.
  *
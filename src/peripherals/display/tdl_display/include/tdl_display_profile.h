@@ -0,0 +1,139 @@
+/**
+ * @file tdl_display_profile.h
+ * @brief Timing and throughput counters of the display pipeline.
+ *
+ * The pipeline is split into three stages: rendering by the GUI library,
+ * conversion (rotation, pixel format, copies into the frame buffer) and the
+ * transfer to the panel. tdl_display records the transfer stage and the bytes
+ * sent, the GUI port records the other two. Rates and loads are computed over
+ * a rolling window of TDL_DISP_PROF_WINDOW_MS. The counters are printed by the
+ * `disp_prof` cli command.
+ *
+ * Everything compiles to nothing unless ENABLE_DISPLAY_PROFILE is set.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __TDL_DISPLAY_PROFILE_H__
+#define __TDL_DISPLAY_PROFILE_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+// length of the window fps, bus rate and loads are computed over
+#ifndef TDL_DISP_PROF_WINDOW_MS
+#define TDL_DISP_PROF_WINDOW_MS 1000
+#endif
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef enum {
+    TDL_DISP_PROF_RENDER = 0, // drawing by the GUI library
+    TDL_DISP_PROF_CONVERT,    // rotation, format conversion and frame buffer copies
+    TDL_DISP_PROF_TRANSFER,   // sending to the panel
+    TDL_DISP_PROF_STAGE_MAX,
+} TDL_DISP_PROF_STAGE_E;
+
+typedef struct {
+    uint32_t count;
+    uint32_t last_ms;
+    uint32_t max_ms;
+    uint32_t total_ms;
+} TDL_DISP_PROF_TIME_T;
+
+typedef struct {
+    TDL_DISP_PROF_TIME_T stage[TDL_DISP_PROF_STAGE_MAX];
+    uint32_t frames;
+    uint32_t last_bytes; // bytes of the last frame
+    uint64_t total_bytes;
+
+    // last complete window
+    uint16_t fps_x10;
+    uint32_t bytes_per_sec;
+    uint8_t load[TDL_DISP_PROF_STAGE_MAX]; // percent of the window spent in each stage
+} TDL_DISP_PROF_STATS_T;
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+#if defined(ENABLE_DISPLAY_PROFILE) && (ENABLE_DISPLAY_PROFILE == 1)
+
+/**
+ * @brief Sets up the counters and registers the `disp_prof` cli command.
+ *
+ * Safe to call more than once, tdl_disp_dev_open() calls it.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_disp_prof_init(void);
+
+/**
+ * @brief Adds the time spent in a stage.
+ *
+ * @param stage The pipeline stage.
+ * @param start Timestamp from tal_system_get_millisecond() when the stage began.
+ *
+ * @return None.
+ */
+void tdl_disp_prof_record(TDL_DISP_PROF_STAGE_E stage, SYS_TIME_T start);
+
+/**
+ * @brief Adds bytes sent to the panel for the current frame.
+ *
+ * @param bytes Number of bytes.
+ *
+ * @return None.
+ */
+void tdl_disp_prof_add_bytes(uint32_t bytes);
+
+/**
+ * @brief Marks the end of a frame and updates the rolling window.
+ *
+ * @return None.
+ */
+void tdl_disp_prof_frame_done(void);
+
+/**
+ * @brief Copies the counters.
+ *
+ * @param stats Filled with the counters.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_disp_prof_get_stats(TDL_DISP_PROF_STATS_T *stats);
+
+/**
+ * @brief Clears all counters.
+ *
+ * @return None.
+ */
+void tdl_disp_prof_reset(void);
+
+#define TDL_DISP_PROF_NOW() tal_system_get_millisecond()
+
+#else
+
+#define tdl_disp_prof_init()                   (OPRT_OK)
+#define tdl_disp_prof_record(stage, start)     ((void)(start))
+#define tdl_disp_prof_add_bytes(bytes)         ((void)0)
+#define tdl_disp_prof_frame_done()             ((void)0)
+#define tdl_disp_prof_get_stats(stats)         (OPRT_NOT_SUPPORTED)
+#define tdl_disp_prof_reset()                  ((void)0)
+
+#define TDL_DISP_PROF_NOW() ((SYS_TIME_T)0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TDL_DISPLAY_PROFILE_H__ */
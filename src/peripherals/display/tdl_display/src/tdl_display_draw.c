@@ -14,6 +14,10 @@
 
 #include "tdl_display_draw.h"
 
+#if defined(__ARM_FEATURE_MVE) && __ARM_FEATURE_MVE
+#include <arm_mve.h>
+#endif
+
 /***********************************************************
 ************************macro define************************
 ***********************************************************/
@@ -103,6 +107,181 @@ static bool __is_rect_valid(TDL_DISP_RECT_T *rect, TDL_DISP_FRAME_BUFF_T *fb)
     return false;
 }
 
+/* Row kernels. Colours are prepared once per call, uniform byte patterns go
+ * through memset, everything else is stored a 32 bit word (two RGB565 or
+ * 4/3 RGB888 pixels) at a time, unrolled so the compiler can emit STM/STRD.
+ * Cores with Helium store 8 pixels per instruction. */
+static void __disp_fill_row16(uint16_t *dst, uint32_t num, uint16_t color)
+{
+    if ((color >> 8) == (color & 0xFF)) {
+        memset(dst, color & 0xFF, num * 2);
+        return;
+    }
+
+#if defined(__ARM_FEATURE_MVE) && __ARM_FEATURE_MVE
+    uint16x8_t vec = vdupq_n_u16(color);
+
+    for (; num >= 8; num -= 8, dst += 8) {
+        vst1q_u16(dst, vec);
+    }
+#else
+    uint32_t pattern = ((uint32_t)color << 16) | color;
+    uint32_t *dst32 = NULL;
+
+    if (num && ((uintptr_t)dst & 0x03)) {
+        *dst++ = color;
+        num--;
+    }
+
+    dst32 = (uint32_t *)dst;
+    for (; num >= 8; num -= 8, dst32 += 4) {
+        dst32[0] = pattern;
+        dst32[1] = pattern;
+        dst32[2] = pattern;
+        dst32[3] = pattern;
+    }
+    for (; num >= 2; num -= 2) {
+        *dst32++ = pattern;
+    }
+    dst = (uint16_t *)dst32;
+#endif
+
+    while (num--) {
+        *dst++ = color;
+    }
+}
+
+static void __disp_fill_row24(uint8_t *dst, uint32_t num, uint32_t color)
+{
+    uint8_t b = color & 0xFF, g = (color >> 8) & 0xFF, r = (color >> 16) & 0xFF;
+    uint8_t pixels[12];
+    uint32_t pattern[3];
+    uint32_t *dst32 = NULL;
+    uint32_t i = 0;
+
+    if (b == g && g == r) {
+        memset(dst, b, num * 3);
+        return;
+    }
+
+    // every 4th pixel starts on the same word phase, find the first aligned one
+    while (num && ((uintptr_t)dst & 0x03)) {
+        dst[0] = b;
+        dst[1] = g;
+        dst[2] = r;
+        dst += 3;
+        num--;
+    }
+
+    if (num >= 4) {
+        for (i = 0; i < 12; i += 3) {
+            pixels[i]     = b;
+            pixels[i + 1] = g;
+            pixels[i + 2] = r;
+        }
+        memcpy(pattern, pixels, sizeof(pattern));
+
+        dst32 = (uint32_t *)dst;
+        for (; num >= 4; num -= 4, dst32 += 3) {
+            dst32[0] = pattern[0];
+            dst32[1] = pattern[1];
+            dst32[2] = pattern[2];
+        }
+        dst = (uint8_t *)dst32;
+    }
+
+    while (num--) {
+        dst[0] = b;
+        dst[1] = g;
+        dst[2] = r;
+        dst += 3;
+    }
+}
+
+// fills bit positions [start, end) of a packed row with a repeated byte pattern
+static void __disp_fill_row_bits(uint8_t *row, uint32_t start, uint32_t end, uint8_t pattern)
+{
+    uint32_t first = start / 8, last = (end - 1) / 8;
+    uint8_t head = (uint8_t)(0xFF << (start % 8));
+    uint8_t tail = (uint8_t)(0xFF >> ((8 - end % 8) % 8));
+
+    if (first == last) {
+        head &= tail;
+        row[first] = (row[first] & ~head) | (pattern & head);
+        return;
+    }
+
+    row[first] = (row[first] & ~head) | (pattern & head);
+    if (last > first + 1) {
+        memset(row + first + 1, pattern, last - first - 1);
+    }
+    row[last] = (row[last] & ~tail) | (pattern & tail);
+}
+
+static OPERATE_RET __disp_fill_area(TDL_DISP_FRAME_BUFF_T *fb, uint32_t x, uint32_t y, uint32_t width,
+                                    uint32_t height, uint32_t color, bool is_swap)
+{
+    uint32_t j = 0;
+
+    switch (fb->fmt) {
+        case TUYA_PIXEL_FMT_RGB565: {
+            uint16_t color_16 = (uint16_t)(color & 0xFFFF);
+            uint16_t *p_buf16 = (uint16_t *)fb->frame + y * fb->width + x;
+
+            if (is_swap) {
+                color_16 = WORD_SWAP(color_16);
+            }
+
+            // full width rows are one contiguous run
+            if (width == fb->width) {
+                __disp_fill_row16(p_buf16, width * height, color_16);
+                break;
+            }
+
+            for (j = 0; j < height; j++, p_buf16 += fb->width) {
+                __disp_fill_row16(p_buf16, width, color_16);
+            }
+        }
+        break;
+        case TUYA_PIXEL_FMT_RGB888: {
+            uint8_t *p_buf = fb->frame + (y * fb->width + x) * 3;
+
+            if (width == fb->width) {
+                __disp_fill_row24(p_buf, width * height, color);
+                break;
+            }
+
+            for (j = 0; j < height; j++, p_buf += fb->width * 3) {
+                __disp_fill_row24(p_buf, width, color);
+            }
+        }
+        break;
+        case TUYA_PIXEL_FMT_MONOCHROME: {
+            uint8_t pattern = (color) ? 0x00 : 0xFF;
+            uint32_t stride = fb->width / 8;
+
+            for (j = y; j < y + height; j++) {
+                __disp_fill_row_bits(fb->frame + j * stride, x, x + width, pattern);
+            }
+        }
+        break;
+        case TUYA_PIXEL_FMT_I2: {
+            uint8_t pattern = (uint8_t)((color & 0x03) * 0x55);
+            uint32_t stride = fb->width / 4;
+
+            for (j = y; j < y + height; j++) {
+                __disp_fill_row_bits(fb->frame + j * stride, x * 2, (x + width) * 2, pattern);
+            }
+        }
+        break;
+        default:
+            PR_ERR("Unsupported pixel format for fill: %d", fb->fmt);
+            return OPRT_NOT_SUPPORTED;
+    }
+
+    return OPRT_OK;
+}
+
 /**
  * @brief Draws a point on the display frame buffer.
  *
@@ -171,9 +350,6 @@ OPERATE_RET tdl_disp_draw_point(TDL_DISP_FRAME_BUFF_T *fb, uint16_t x, uint16_t
  */
 OPERATE_RET tdl_disp_draw_fill(TDL_DISP_FRAME_BUFF_T *fb, TDL_DISP_RECT_T *rect, uint32_t color, bool is_swap)
 {
-    OPERATE_RET rt = OPRT_OK;
-    uint32_t width = 0, height = 0;
-
     if(NULL == fb || NULL == fb->frame || NULL == rect ||\
        fb->width == 0 || fb->height == 0) {
         return OPRT_INVALID_PARM;
@@ -183,16 +359,8 @@ OPERATE_RET tdl_disp_draw_fill(TDL_DISP_FRAME_BUFF_T *fb, TDL_DISP_RECT_T *rect,
         return OPRT_INVALID_PARM;
     }
 
-    width = rect->x1 - rect->x0 + 1;
-    height = rect->y1 - rect->y0 + 1;
-
-    for(uint32_t j = 0; j < height ; j++) {
-        for(uint32_t i = 0; i < width; i++) {
-            TUYA_CALL_ERR_RETURN(tdl_disp_draw_point(fb, rect->x0+i, rect->y0+j, color, is_swap));
-        }
-    }
-
-    return rt;
+    return __disp_fill_area(fb, rect->x0 - fb->x_start, rect->y0 - fb->y_start, \
+                            rect->x1 - rect->x0 + 1, rect->y1 - rect->y0 + 1, color, is_swap);
 }
 
 /**
@@ -205,18 +373,166 @@ OPERATE_RET tdl_disp_draw_fill(TDL_DISP_FRAME_BUFF_T *fb, TDL_DISP_RECT_T *rect,
  */
 OPERATE_RET tdl_disp_draw_fill_full(TDL_DISP_FRAME_BUFF_T *fb, uint32_t color, bool is_swap)
 {
-    OPERATE_RET rt = OPRT_OK;
-
     if(NULL == fb || NULL == fb->frame ||\
        fb->width == 0 || fb->height == 0) {
         return OPRT_INVALID_PARM;
     }
 
-    for(uint32_t j = 0; j < fb->height ; j++) {
-        for(uint32_t i = 0; i < fb->width; i++) {
-            TUYA_CALL_ERR_RETURN(tdl_disp_draw_point(fb, fb->x_start+i, fb->y_start+j, color, is_swap));
+    return __disp_fill_area(fb, 0, 0, fb->width, fb->height, color, is_swap);
+}
+
+/**
+ * @brief Draws a 1 bit bitmap scaled up by an integer factor, e.g. a QR code.
+ *
+ * Equal bits next to each other are filled as one run with the row kernels of
+ * tdl_disp_draw_fill(), and for RGB formats every scaled row is drawn once and
+ * copied. A dark module of qrcode_cache_get() is a set bit.
+ *
+ * @param fb Pointer to the frame buffer structure.
+ * @param x X coordinate of the top left corner.
+ * @param y Y coordinate of the top left corner.
+ * @param bits Bit (row * w + col) is the pixel at col/row, LSB first, rows are not padded.
+ * @param w Width of the bitmap in bits.
+ * @param h Height of the bitmap in bits.
+ * @param scale Number of pixels per bit in both directions.
+ * @param fg_color Color of a set bit.
+ * @param bg_color Color of a clear bit.
+ * @param is_swap Whether to swap byte order for RGB565 format.
+ * @return OPERATE_RET Operation result code.
+ */
+OPERATE_RET tdl_disp_draw_bitmap(TDL_DISP_FRAME_BUFF_T *fb, uint16_t x, uint16_t y, const uint8_t *bits, uint16_t w,
+                                 uint16_t h, uint8_t scale, uint32_t fg_color, uint32_t bg_color, bool is_swap)
+{
+    OPERATE_RET rt = OPRT_OK;
+    TDL_DISP_RECT_T rect;
+    uint32_t pixel_bytes = 0, stride = 0, row = 0, col = 0, end = 0, idx = 0, k = 0;
+    uint32_t dx = 0, dy = 0, run_h = 0;
+    uint8_t *line = NULL;
+    bool set = false;
+
+    if(NULL == fb || NULL == fb->frame || NULL == bits || 0 == w || 0 == h || 0 == scale) {
+        return OPRT_INVALID_PARM;
+    }
+
+    rect.x0 = x;
+    rect.y0 = y;
+    rect.x1 = x + w * scale - 1;
+    rect.y1 = y + h * scale - 1;
+    if(false == __is_rect_valid(&rect, fb)) {
+        return OPRT_INVALID_PARM;
+    }
+
+    //! packed formats have no whole byte pixels to copy, they fill all rows of a run at once
+    pixel_bytes = tdl_disp_get_fmt_bpp(fb->fmt) / 8;
+    stride = fb->width * pixel_bytes;
+    run_h = pixel_bytes ? 1 : scale;
+    dx = x - fb->x_start;
+
+    for(row = 0; row < h; row++) {
+        dy = y - fb->y_start + row * scale;
+        idx = row * w;
+        for(col = 0; col < w; col = end) {
+            set = (bits[(idx + col) >> 3] >> ((idx + col) & 7)) & 1;
+            for(end = col + 1; end < w; end++) {
+                if((bool)((bits[(idx + end) >> 3] >> ((idx + end) & 7)) & 1) != set) {
+                    break;
+                }
+            }
+            rt = __disp_fill_area(fb, dx + col * scale, dy, (end - col) * scale, run_h, set ? fg_color : bg_color,
+                                  is_swap);
+            if(OPRT_OK != rt) {
+                return rt;
+            }
+        }
+
+        if(pixel_bytes) {
+            line = fb->frame + dy * stride + dx * pixel_bytes;
+            for(k = 1; k < scale; k++) {
+                memcpy(line + k * stride, line, w * scale * pixel_bytes);
+            }
         }
     }
 
-    return rt;
-}
\ No newline at end of file
+    return OPRT_OK;
+}
+
+/**
+ * @brief Copies a rectangular area from one frame buffer into another.
+ *
+ * Both frame buffers must have the same RGB pixel format. The buffers may be
+ * the same, overlapping areas are handled.
+ *
+ * @param dst_fb Pointer to the destination frame buffer.
+ * @param x X coordinate of the destination top left corner.
+ * @param y Y coordinate of the destination top left corner.
+ * @param src_fb Pointer to the source frame buffer.
+ * @param src_rect Area of the source to copy, NULL copies the whole source.
+ * @return OPERATE_RET Operation result code.
+ */
+OPERATE_RET tdl_disp_draw_blit(TDL_DISP_FRAME_BUFF_T *dst_fb, uint16_t x, uint16_t y,\
+                               TDL_DISP_FRAME_BUFF_T *src_fb, TDL_DISP_RECT_T *src_rect)
+{
+    TDL_DISP_RECT_T src_area, dst_area;
+    uint32_t pixel_bytes = 0, row_len = 0, src_stride = 0, dst_stride = 0, height = 0, j = 0;
+    uint8_t *src = NULL, *dst = NULL;
+
+    if(NULL == dst_fb || NULL == dst_fb->frame || NULL == src_fb || NULL == src_fb->frame) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if(dst_fb->fmt != src_fb->fmt) {
+        PR_ERR("blit format mismatch: %d %d", src_fb->fmt, dst_fb->fmt);
+        return OPRT_NOT_SUPPORTED;
+    }
+
+    pixel_bytes = tdl_disp_get_fmt_bpp(src_fb->fmt) / 8;
+    if(0 == pixel_bytes) {
+        PR_ERR("Unsupported pixel format for blit: %d", src_fb->fmt);
+        return OPRT_NOT_SUPPORTED;
+    }
+
+    if(src_rect) {
+        src_area = *src_rect;
+    }else {
+        src_area.x0 = src_fb->x_start;
+        src_area.y0 = src_fb->y_start;
+        src_area.x1 = src_fb->x_start + src_fb->width - 1;
+        src_area.y1 = src_fb->y_start + src_fb->height - 1;
+    }
+
+    dst_area.x0 = x;
+    dst_area.y0 = y;
+    dst_area.x1 = x + (src_area.x1 - src_area.x0);
+    dst_area.y1 = y + (src_area.y1 - src_area.y0);
+
+    if(false == __is_rect_valid(&src_area, src_fb) || false == __is_rect_valid(&dst_area, dst_fb)) {
+        return OPRT_INVALID_PARM;
+    }
+
+    row_len    = (src_area.x1 - src_area.x0 + 1) * pixel_bytes;
+    height     = src_area.y1 - src_area.y0 + 1;
+    src_stride = src_fb->width * pixel_bytes;
+    dst_stride = dst_fb->width * pixel_bytes;
+    src = src_fb->frame + (src_area.y0 - src_fb->y_start) * src_stride + (src_area.x0 - src_fb->x_start) * pixel_bytes;
+    dst = dst_fb->frame + (dst_area.y0 - dst_fb->y_start) * dst_stride + (dst_area.x0 - dst_fb->x_start) * pixel_bytes;
+
+    if(row_len == src_stride && row_len == dst_stride) {
+        memmove(dst, src, row_len * height);
+        return OPRT_OK;
+    }
+
+    // copy bottom up when the destination overlaps below the source
+    if(dst > src) {
+        src += (height - 1) * src_stride;
+        dst += (height - 1) * dst_stride;
+        for(j = 0; j < height; j++, src -= src_stride, dst -= dst_stride) {
+            memmove(dst, src, row_len);
+        }
+    }else {
+        for(j = 0; j < height; j++, src += src_stride, dst += dst_stride) {
+            memmove(dst, src, row_len);
+        }
+    }
+
+    return OPRT_OK;
+}
@@ -4,6 +4,8 @@
  *
  * This file provides software-based rotation functions for RGB888 and RGB565
  * frame buffers, supporting 90, 180, and 270 degree rotation for Tuya display modules.
+ * 90 and 270 degree rotation walks the image in square tiles so that the
+ * column-wise reads stay in the D-cache and the writes form short bursts.
  *
  * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
  *
@@ -17,6 +19,10 @@
 /***********************************************************
 ************************macro define************************
 ***********************************************************/
+// tile edge in pixels for 90/270 degree rotation
+#ifndef TDL_DISP_ROTATE_TILE
+#define TDL_DISP_ROTATE_TILE 16
+#endif
 
 
 /***********************************************************
@@ -32,137 +38,210 @@
 /***********************************************************
 ***********************function define**********************
 ***********************************************************/
-static void __rotate90_rgb888(uint8_t * src, uint8_t * dst, uint32_t src_width, uint32_t src_height)
+static inline uint16_t __pixel_rgb565(uint16_t color, bool is_swap)
 {
-    uint32_t src_stride = src_width * 3;
-    uint32_t dst_stride = src_height * 3;
-    uint32_t src_index = 0, dst_index = 0;
+    return (is_swap) ? (uint16_t)WORD_SWAP(color) : color;
+}
 
-    for(uint32_t x = 0; x < src_width; ++x) {
-        for(uint32_t y = 0; y < src_height; ++y) {
-            src_index = y * src_stride + x * 3;
-            dst_index = (src_width - x - 1) * dst_stride + y * 3;
-            dst[dst_index] = src[src_index];       /*Red*/
-            dst[dst_index + 1] = src[src_index + 1]; /*Green*/
-            dst[dst_index + 2] = src[src_index + 2]; /*Blue*/
+/* The 90/270 kernels take strides in pixels so that they work on a sub area
+ * of a larger frame buffer as well. dst points at the top left pixel of the
+ * rotated block, which is h pixels wide and w pixels high. */
+TUYA_HOT_DISPLAY
+static void __rotate90_rgb565(const uint16_t *src, uint32_t src_stride, uint16_t *dst, uint32_t dst_stride,
+                              uint32_t w, uint32_t h, bool is_swap)
+{
+    uint32_t tx = 0, ty = 0, x = 0, y = 0, x_end = 0, y_end = 0;
+    const uint16_t *s = NULL;
+    uint16_t *d = NULL;
+
+    for (ty = 0; ty < h; ty += TDL_DISP_ROTATE_TILE) {
+        y_end = MIN(ty + TDL_DISP_ROTATE_TILE, h);
+        for (tx = 0; tx < w; tx += TDL_DISP_ROTATE_TILE) {
+            x_end = MIN(tx + TDL_DISP_ROTATE_TILE, w);
+            for (x = tx; x < x_end; x++) {
+                s = src + ty * src_stride + x;
+                d = dst + (w - x - 1) * dst_stride + ty;
+                for (y = ty; y < y_end; y++, s += src_stride) {
+                    *d++ = __pixel_rgb565(*s, is_swap);
+                }
+            }
         }
     }
 }
 
-static void __rotate180_rgb888(uint8_t * src, uint8_t * dst, uint32_t src_width, uint32_t src_height)
+TUYA_HOT_DISPLAY
+static void __rotate270_rgb565(const uint16_t *src, uint32_t src_stride, uint16_t *dst, uint32_t dst_stride,
+                               uint32_t w, uint32_t h, bool is_swap)
 {
-    uint32_t src_stride = src_width * 3;
-    uint32_t dst_stride = src_width * 3;
-    uint32_t src_index = 0, dst_index = 0;
-
-    for(uint32_t y = 0; y < src_height; ++y) {
-        for(uint32_t x = 0; x < src_width; ++x) {
-            src_index = y * src_stride + x * 3;
-            dst_index = (src_height - y - 1) * dst_stride + (src_width - x - 1) * 3;
-            dst[dst_index] = src[src_index];
-            dst[dst_index + 1] = src[src_index + 1];
-            dst[dst_index + 2] = src[src_index + 2];
+    uint32_t tx = 0, ty = 0, x = 0, y = 0, x_end = 0, y_end = 0;
+    const uint16_t *s = NULL;
+    uint16_t *d = NULL;
+
+    for (ty = 0; ty < h; ty += TDL_DISP_ROTATE_TILE) {
+        y_end = MIN(ty + TDL_DISP_ROTATE_TILE, h);
+        for (tx = 0; tx < w; tx += TDL_DISP_ROTATE_TILE) {
+            x_end = MIN(tx + TDL_DISP_ROTATE_TILE, w);
+            for (x = tx; x < x_end; x++) {
+                s = src + ty * src_stride + x;
+                d = dst + x * dst_stride + (h - ty - 1);
+                for (y = ty; y < y_end; y++, s += src_stride) {
+                    *d-- = __pixel_rgb565(*s, is_swap);
+                }
+            }
         }
     }
 }
 
-static void __rotate270_rgb888(uint8_t * src, uint8_t * dst, uint32_t src_width, uint32_t src_height)
+TUYA_HOT_DISPLAY
+static void __rotate180_rgb565(const uint16_t *src, uint32_t src_stride, uint16_t *dst, uint32_t dst_stride,
+                               uint32_t w, uint32_t h, bool is_swap)
 {
-    uint32_t src_stride = src_width * 3;
-    uint32_t dst_stride = src_height * 3;
-    uint32_t src_index = 0, dst_index = 0;
-
-    for(uint32_t x = 0; x < src_width; ++x) {
-        for(uint32_t y = 0; y < src_height; ++y) {
-            src_index = y * src_stride + x * 3;
-            dst_index = x * dst_stride + (src_height - y - 1) * 3;
-            dst[dst_index] = src[src_index];       /*Red*/
-            dst[dst_index + 1] = src[src_index + 1]; /*Green*/
-            dst[dst_index + 2] = src[src_index + 2]; /*Blue*/
+    uint32_t x = 0, y = 0;
+    const uint16_t *s = NULL;
+    uint16_t *d = NULL;
+
+    for (y = 0; y < h; y++) {
+        s = src + y * src_stride;
+        d = dst + (h - y - 1) * dst_stride + (w - 1);
+        for (x = 0; x < w; x++) {
+            *d-- = __pixel_rgb565(*s++, is_swap);
         }
     }
 }
 
-static void __tdl_disp_draw_sw_rotate_rgb888(TUYA_DISPLAY_ROTATION_E rot, \
-                                            TDL_DISP_FRAME_BUFF_T *in_fb, \
-                                            TDL_DISP_FRAME_BUFF_T *out_fb)
+// reverses a whole frame, src and dst may be the same buffer
+TUYA_HOT_DISPLAY
+static void __reverse_rgb565(uint16_t *src, uint16_t *dst, uint32_t num, bool is_swap)
 {
-    switch(rot) {
-        case TUYA_DISPLAY_ROTATION_90:
-            out_fb->width  = in_fb->height;
-            out_fb->height = in_fb->width;
-            __rotate90_rgb888(in_fb->frame, out_fb->frame, in_fb->width, in_fb->height);
-        break; 
-        case TUYA_DISPLAY_ROTATION_180:
-            __rotate180_rgb888(in_fb->frame, out_fb->frame, in_fb->width, in_fb->height);
-        break;
-        case TUYA_DISPLAY_ROTATION_270:
-            out_fb->width = in_fb->height;
-            out_fb->height = in_fb->width;
-            __rotate270_rgb888(in_fb->frame, out_fb->frame, in_fb->width, in_fb->height);
-        break;       
-        default:
-            break;
+    uint32_t i = 0, j = num - 1;
+    uint16_t a = 0, b = 0;
+
+    for (; i < j; i++, j--) {
+        a = src[i];
+        b = src[j];
+        dst[i] = __pixel_rgb565(b, is_swap);
+        dst[j] = __pixel_rgb565(a, is_swap);
+    }
+
+    if (i == j) {
+        dst[i] = __pixel_rgb565(src[i], is_swap);
     }
 }
 
-static void __rotate270_rgb565(uint16_t * src, uint16_t * dst, uint32_t src_width, uint32_t src_height, bool is_swap)
+static void __rotate90_rgb888(const uint8_t *src, uint32_t src_stride, uint8_t *dst, uint32_t dst_stride,
+                              uint32_t w, uint32_t h)
 {
-    uint32_t src_stride = src_width;
-    uint32_t dst_stride = src_height;
-    uint32_t src_index = 0, dst_index = 0;
+    uint32_t tx = 0, ty = 0, x = 0, y = 0, x_end = 0, y_end = 0;
+    const uint8_t *s = NULL;
+    uint8_t *d = NULL;
+
+    for (ty = 0; ty < h; ty += TDL_DISP_ROTATE_TILE) {
+        y_end = MIN(ty + TDL_DISP_ROTATE_TILE, h);
+        for (tx = 0; tx < w; tx += TDL_DISP_ROTATE_TILE) {
+            x_end = MIN(tx + TDL_DISP_ROTATE_TILE, w);
+            for (x = tx; x < x_end; x++) {
+                s = src + (ty * src_stride + x) * 3;
+                d = dst + ((w - x - 1) * dst_stride + ty) * 3;
+                for (y = ty; y < y_end; y++, s += src_stride * 3, d += 3) {
+                    d[0] = s[0]; /*Red*/
+                    d[1] = s[1]; /*Green*/
+                    d[2] = s[2]; /*Blue*/
+                }
+            }
+        }
+    }
+}
 
-    for(uint32_t x = 0; x < src_width; ++x) {
-        dst_index = x * dst_stride;
-        src_index = x;
-        for(uint32_t y = 0; y < src_height; ++y) {
-            if(true == is_swap) {
-                dst[dst_index + (src_height - y - 1)] = WORD_SWAP(src[src_index]);
-            }else {
-                dst[dst_index + (src_height - y - 1)] = src[src_index];
+static void __rotate270_rgb888(const uint8_t *src, uint32_t src_stride, uint8_t *dst, uint32_t dst_stride,
+                               uint32_t w, uint32_t h)
+{
+    uint32_t tx = 0, ty = 0, x = 0, y = 0, x_end = 0, y_end = 0;
+    const uint8_t *s = NULL;
+    uint8_t *d = NULL;
+
+    for (ty = 0; ty < h; ty += TDL_DISP_ROTATE_TILE) {
+        y_end = MIN(ty + TDL_DISP_ROTATE_TILE, h);
+        for (tx = 0; tx < w; tx += TDL_DISP_ROTATE_TILE) {
+            x_end = MIN(tx + TDL_DISP_ROTATE_TILE, w);
+            for (x = tx; x < x_end; x++) {
+                s = src + (ty * src_stride + x) * 3;
+                d = dst + (x * dst_stride + (h - ty - 1)) * 3;
+                for (y = ty; y < y_end; y++, s += src_stride * 3, d -= 3) {
+                    d[0] = s[0]; /*Red*/
+                    d[1] = s[1]; /*Green*/
+                    d[2] = s[2]; /*Blue*/
+                }
             }
+        }
+    }
+}
 
-            src_index += src_stride;
+static void __rotate180_rgb888(const uint8_t *src, uint32_t src_stride, uint8_t *dst, uint32_t dst_stride,
+                               uint32_t w, uint32_t h)
+{
+    uint32_t x = 0, y = 0;
+    const uint8_t *s = NULL;
+    uint8_t *d = NULL;
+
+    for (y = 0; y < h; y++) {
+        s = src + y * src_stride * 3;
+        d = dst + ((h - y - 1) * dst_stride + (w - 1)) * 3;
+        for (x = 0; x < w; x++, s += 3, d -= 3) {
+            d[0] = s[0];
+            d[1] = s[1];
+            d[2] = s[2];
         }
     }
 }
 
-static void __rotate180_rgb565(uint16_t * src, uint16_t * dst, uint32_t src_width, uint32_t src_height, bool is_swap)
+// reverses a whole frame, src and dst may be the same buffer
+static void __reverse_rgb888(uint8_t *src, uint8_t *dst, uint32_t num)
 {
-    uint32_t src_stride = src_width;
-    uint32_t dst_stride = src_width;
-    uint32_t src_index = 0, dst_index = 0;
+    uint8_t *a = src, *b = src + (num - 1) * 3;
+    uint8_t *da = dst, *db = dst + (num - 1) * 3;
+    uint8_t t0 = 0, t1 = 0, t2 = 0;
+
+    for (; a < b; a += 3, b -= 3, da += 3, db -= 3) {
+        t0 = a[0];
+        t1 = a[1];
+        t2 = a[2];
+        da[0] = b[0];
+        da[1] = b[1];
+        da[2] = b[2];
+        db[0] = t0;
+        db[1] = t1;
+        db[2] = t2;
+    }
 
-    for(uint32_t y = 0; y < src_height; ++y) {
-        dst_index = (src_height - y - 1) * dst_stride;
-        src_index = y * src_stride;
-        for(uint32_t x = 0; x < src_width; ++x) {
-            if(true == is_swap) {
-                dst[dst_index + src_width - x - 1] = WORD_SWAP(src[src_index + x]);
-            }else {
-                dst[dst_index + src_width - x - 1] = src[src_index + x];
-            }
-        }
+    if (a == b && da != a) {
+        da[0] = a[0];
+        da[1] = a[1];
+        da[2] = a[2];
     }
 }
 
-static void __rotate90_rgb565(uint16_t * src, uint16_t * dst, uint32_t src_width, uint32_t src_height, bool is_swap)
+static void __tdl_disp_draw_sw_rotate_rgb888(TUYA_DISPLAY_ROTATION_E rot, \
+                                            TDL_DISP_FRAME_BUFF_T *in_fb, \
+                                            TDL_DISP_FRAME_BUFF_T *out_fb)
 {
-    uint32_t src_stride = src_width;
-    uint32_t dst_stride = src_height;
-    uint32_t src_index = 0, dst_index = 0;
+    uint32_t w = in_fb->width, h = in_fb->height;
 
-    for(uint32_t x = 0; x < src_width; ++x) {
-        dst_index = (src_width - x - 1);
-        src_index = x;
-        for(uint32_t y = 0; y < src_height; ++y) {
-            if(true == is_swap) {
-                dst[dst_index * dst_stride + y] = WORD_SWAP(src[src_index]);
-            }else {
-                dst[dst_index * dst_stride + y] = src[src_index];
-            }
-            src_index += src_stride;
-        }
+    switch(rot) {
+        case TUYA_DISPLAY_ROTATION_90:
+            out_fb->width  = h;
+            out_fb->height = w;
+            __rotate90_rgb888(in_fb->frame, w, out_fb->frame, h, w, h);
+        break; 
+        case TUYA_DISPLAY_ROTATION_180:
+            __reverse_rgb888(in_fb->frame, out_fb->frame, w * h);
+        break;
+        case TUYA_DISPLAY_ROTATION_270:
+            out_fb->width = h;
+            out_fb->height = w;
+            __rotate270_rgb888(in_fb->frame, w, out_fb->frame, h, w, h);
+        break;       
+        default:
+            break;
     }
 }
 
@@ -171,26 +250,28 @@ static void __tdl_disp_draw_sw_rotate_rgb565(TUYA_DISPLAY_ROTATION_E rot, \
                                             TDL_DISP_FRAME_BUFF_T *out_fb,
                                             bool is_swap)
 {
+    uint32_t w = in_fb->width, h = in_fb->height;
+
     switch(rot) {
         case TUYA_DISPLAY_ROTATION_90:
-            out_fb->width  = in_fb->height;
-            out_fb->height = in_fb->width;
-            __rotate90_rgb565((uint16_t *)in_fb->frame, (uint16_t *)out_fb->frame, in_fb->width, in_fb->height, is_swap);
+            out_fb->width  = h;
+            out_fb->height = w;
+            __rotate90_rgb565((uint16_t *)in_fb->frame, w, (uint16_t *)out_fb->frame, h, w, h, is_swap);
         break; 
         case TUYA_DISPLAY_ROTATION_180:
-            __rotate180_rgb565((uint16_t *)in_fb->frame, (uint16_t *)out_fb->frame, in_fb->width, in_fb->height, is_swap);
+            __reverse_rgb565((uint16_t *)in_fb->frame, (uint16_t *)out_fb->frame, w * h, is_swap);
         break;
         case TUYA_DISPLAY_ROTATION_270:
-            out_fb->width = in_fb->height;
-            out_fb->height = in_fb->width;
-            __rotate270_rgb565((uint16_t *)in_fb->frame, (uint16_t *)out_fb->frame, in_fb->width, in_fb->height, is_swap);
+            out_fb->width = h;
+            out_fb->height = w;
+            __rotate270_rgb565((uint16_t *)in_fb->frame, w, (uint16_t *)out_fb->frame, h, w, h, is_swap);
         break;       
         default:
             break;
     }
 }
 
-static void __rotate270_monochrome(uint8_t * src, uint8_t * dst, uint32_t src_width, uint32_t src_height)
+static void __rotate270_monochrome_bits(uint8_t * src, uint8_t * dst, uint32_t src_width, uint32_t src_height)
 {
     uint32_t src_stride = (src_width+7)/8;
     uint32_t dst_stride = (src_height+7)/8;
@@ -215,10 +296,10 @@ static void __rotate270_monochrome(uint8_t * src, uint8_t * dst, uint32_t src_wi
     }
 }
 
-static void __rotate180_monochrome(uint8_t * src, uint8_t * dst, uint32_t src_width, uint32_t src_height)
+static void __rotate90_monochrome_bits(uint8_t * src, uint8_t * dst, uint32_t src_width, uint32_t src_height)
 {
     uint32_t src_stride = (src_width+7)/8;
-    uint32_t dst_stride = (src_width+7)/8;
+    uint32_t dst_stride = (src_height+7)/8;
     uint32_t src_index = 0, dst_index = 0;
     uint32_t src_bit_idx = 0, dst_bit_idx = 0, pixel  = 0; 
 
@@ -228,8 +309,8 @@ static void __rotate180_monochrome(uint8_t * src, uint8_t * dst, uint32_t src_wi
             src_bit_idx = x % 8;
             pixel = (src[src_index] >> src_bit_idx) & 0x01;
 
-            dst_index = (src_height -1 - y) * dst_stride + (src_width -1 -x) / 8;
-            dst_bit_idx = (src_width -1 -x) % 8;
+            dst_index = (x) * dst_stride + (src_height -1 -y) / 8;
+            dst_bit_idx = (src_height -1 -y) % 8;
 
             if(pixel) {
                 dst[dst_index] |= (1 << dst_bit_idx);
@@ -240,27 +321,115 @@ static void __rotate180_monochrome(uint8_t * src, uint8_t * dst, uint32_t src_wi
     }
 }
 
+
+/* Byte aligned 8x8 blocks: eight source rows give one destination byte per
+ * source column, so each destination byte is written once instead of being
+ * read-modify-written for every pixel. */
+static void __rotate270_monochrome(uint8_t * src, uint8_t * dst, uint32_t src_width, uint32_t src_height)
+{
+    uint32_t src_stride = src_width / 8;
+    uint32_t dst_stride = src_height / 8;
+    uint8_t block[8], out = 0;
+
+    for(uint32_t by = 0; by < src_height / 8; ++by) {
+        for(uint32_t bx = 0; bx < src_stride; ++bx) {
+            for(uint32_t j = 0; j < 8; ++j) {
+                block[j] = src[(by * 8 + j) * src_stride + bx];
+            }
+            for(uint32_t i = 0; i < 8; ++i) {
+                out = 0;
+                for(uint32_t j = 0; j < 8; ++j) {
+                    out |= ((block[j] >> i) & 0x01) << j;
+                }
+                dst[(src_width - 1 - (bx * 8 + i)) * dst_stride + by] = out;
+            }
+        }
+    }
+}
+
 static void __rotate90_monochrome(uint8_t * src, uint8_t * dst, uint32_t src_width, uint32_t src_height)
 {
-    uint32_t src_stride = (src_width+7)/8;
-    uint32_t dst_stride = (src_height+7)/8;
-    uint32_t src_index = 0, dst_index = 0;
-    uint32_t src_bit_idx = 0, dst_bit_idx = 0, pixel  = 0; 
+    uint32_t src_stride = src_width / 8;
+    uint32_t dst_stride = src_height / 8;
+    uint8_t block[8], out = 0;
+
+    for(uint32_t by = 0; by < src_height / 8; ++by) {
+        for(uint32_t bx = 0; bx < src_stride; ++bx) {
+            for(uint32_t j = 0; j < 8; ++j) {
+                block[j] = src[(by * 8 + j) * src_stride + bx];
+            }
+            for(uint32_t i = 0; i < 8; ++i) {
+                out = 0;
+                for(uint32_t j = 0; j < 8; ++j) {
+                    out |= ((block[j] >> i) & 0x01) << (7 - j);
+                }
+                dst[(bx * 8 + i) * dst_stride + (dst_stride - 1 - by)] = out;
+            }
+        }
+    }
+}
 
-    for(uint32_t x = 0; x < src_width; ++x) {
-        for(uint32_t y = 0; y < src_height; ++y) {
-            src_index   = y * src_stride + x / 8;
-            src_bit_idx = x % 8;
-            pixel = (src[src_index] >> src_bit_idx) & 0x01;
+static uint8_t __bit_reverse8(uint8_t v)
+{
+    v = (uint8_t)(((v & 0xF0) >> 4) | ((v & 0x0F) << 4));
+    v = (uint8_t)(((v & 0xCC) >> 2) | ((v & 0x33) << 2));
+    v = (uint8_t)(((v & 0xAA) >> 1) | ((v & 0x55) << 1));
 
-            dst_index = (x) * dst_stride + (src_height -1 -y) / 8;
-            dst_bit_idx = (src_height -1 -y) % 8;
+    return v;
+}
 
-            if(pixel) {
-                dst[dst_index] |= (1 << dst_bit_idx);
-            }else {
-                dst[dst_index] &= ~(1 << dst_bit_idx);
-            }
+// with byte aligned rows 180 degrees is a reversal of all bits, src and dst may be the same buffer
+static void __reverse_monochrome(uint8_t *src, uint8_t *dst, uint32_t len)
+{
+    uint32_t i = 0, j = len - 1;
+    uint8_t a = 0, b = 0;
+
+    for (; i < j; i++, j--) {
+        a = src[i];
+        b = src[j];
+        dst[i] = __bit_reverse8(b);
+        dst[j] = __bit_reverse8(a);
+    }
+
+    if (i == j) {
+        dst[i] = __bit_reverse8(src[i]);
+    }
+}
+
+static __inline bool __mono_get(uint8_t *buf, uint32_t stride, uint32_t x, uint32_t y)
+{
+    return (buf[y * stride + x / 8] >> (x % 8)) & 0x01;
+}
+
+static __inline void __mono_set(uint8_t *buf, uint32_t stride, uint32_t x, uint32_t y, bool pixel)
+{
+    if(pixel) {
+        buf[y * stride + x / 8] |= (1 << (x % 8));
+    }else {
+        buf[y * stride + x / 8] &= ~(1 << (x % 8));
+    }
+}
+
+static void __rotate180_monochrome(uint8_t * src, uint8_t * dst, uint32_t src_width, uint32_t src_height)
+{
+    uint32_t stride = (src_width+7)/8;
+    uint32_t num = src_width * src_height;
+    uint32_t i = 0, j = 0;
+    bool a = false, b = false;
+
+    if(0 == src_width % 8) {
+        __reverse_monochrome(src, dst, stride * src_height);
+        return;
+    }
+
+    // swap pixel pairs so that this also works in place
+    for(i = 0, j = num - 1; i <= j; i++, j--) {
+        a = __mono_get(src, stride, i % src_width, i / src_width);
+        b = __mono_get(src, stride, j % src_width, j / src_width);
+        __mono_set(dst, stride, i % src_width, i / src_width, b);
+        __mono_set(dst, stride, j % src_width, j / src_width, a);
+        if(0 == j) {
+            break;
         }
     }
 }
@@ -273,7 +442,11 @@ static void __tdl_disp_draw_sw_rotate_mono(TUYA_DISPLAY_ROTATION_E rot, \
         case TUYA_DISPLAY_ROTATION_90:
             out_fb->width  = in_fb->height;
             out_fb->height = in_fb->width;
-            __rotate90_monochrome(in_fb->frame, out_fb->frame, in_fb->width, in_fb->height);
+            if(0 == in_fb->width % 8 && 0 == in_fb->height % 8) {
+                __rotate90_monochrome(in_fb->frame, out_fb->frame, in_fb->width, in_fb->height);
+            }else {
+                __rotate90_monochrome_bits(in_fb->frame, out_fb->frame, in_fb->width, in_fb->height);
+            }
         break; 
         case TUYA_DISPLAY_ROTATION_180:
             __rotate180_monochrome(in_fb->frame, out_fb->frame, in_fb->width, in_fb->height);
@@ -281,7 +454,11 @@ static void __tdl_disp_draw_sw_rotate_mono(TUYA_DISPLAY_ROTATION_E rot, \
         case TUYA_DISPLAY_ROTATION_270:
             out_fb->width = in_fb->height;
             out_fb->height = in_fb->width;
-            __rotate270_monochrome(in_fb->frame, out_fb->frame, in_fb->width, in_fb->height);
+            if(0 == in_fb->width % 8 && 0 == in_fb->height % 8) {
+                __rotate270_monochrome(in_fb->frame, out_fb->frame, in_fb->width, in_fb->height);
+            }else {
+                __rotate270_monochrome_bits(in_fb->frame, out_fb->frame, in_fb->width, in_fb->height);
+            }
         break;       
         default:
             break;
@@ -321,6 +498,11 @@ OPERATE_RET tdl_disp_draw_rotate(TUYA_DISPLAY_ROTATION_E rot, \
     if(in_fb->len < out_fb->len) {
         PR_NOTICE("output frame lengths is less than input frame lengths");
     }
+
+    if(in_fb->frame == out_fb->frame && TUYA_DISPLAY_ROTATION_180 != rot) {
+        PR_ERR("only 180 degree rotation can be done in place");
+        return OPRT_INVALID_PARM;
+    }
     
     switch(in_fb->fmt) {
         case TUYA_PIXEL_FMT_RGB888:
@@ -338,4 +520,128 @@ OPERATE_RET tdl_disp_draw_rotate(TUYA_DISPLAY_ROTATION_E rot, \
     }
     
     return OPRT_OK;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Rotates one rendered area straight into its place in a full frame buffer.
+ *
+ * @param rot Rotation angle (90, 180, 270 degrees).
+ * @param in_fb The area pixels, x_start/y_start/width/height give the area in
+ *              unrotated (logical) screen coordinates.
+ * @param out_fb The full frame buffer in panel orientation.
+ * @param is_swap Flag indicating whether to swap the frame buffers(rgb565).
+ * @param out_rect Returns the area covered in out_fb, may be NULL.
+ * @return OPERATE_RET Operation result code.
+ */
+OPERATE_RET tdl_disp_draw_rotate_area(TUYA_DISPLAY_ROTATION_E rot, \
+                                      TDL_DISP_FRAME_BUFF_T *in_fb, \
+                                      TDL_DISP_FRAME_BUFF_T *out_fb,\
+                                      bool is_swap, TDL_DISP_RECT_T *out_rect)
+{
+    uint32_t w = 0, h = 0, x = 0, y = 0, log_w = 0, log_h = 0;
+    uint32_t dst_x = 0, dst_y = 0, dst_w = 0, dst_h = 0;
+
+    if (NULL == in_fb || NULL == out_fb ||\
+        NULL == in_fb->frame || NULL == out_fb->frame) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if(in_fb->fmt != out_fb->fmt) {
+        PR_ERR("Input and output frame formats do not match");
+        return OPRT_INVALID_PARM;
+    }
+
+    w = in_fb->width;
+    h = in_fb->height;
+    x = in_fb->x_start;
+    y = in_fb->y_start;
+
+    if(TUYA_DISPLAY_ROTATION_90 == rot || TUYA_DISPLAY_ROTATION_270 == rot) {
+        log_w = out_fb->height;
+        log_h = out_fb->width;
+        dst_w = h;
+        dst_h = w;
+    }else {
+        log_w = out_fb->width;
+        log_h = out_fb->height;
+        dst_w = w;
+        dst_h = h;
+    }
+
+    if(0 == w || 0 == h || x + w > log_w || y + h > log_h) {
+        PR_ERR("area out of range: %d %d %d %d", x, y, w, h);
+        return OPRT_INVALID_PARM;
+    }
+
+    switch(rot) {
+        case TUYA_DISPLAY_ROTATION_0:
+            dst_x = x;
+            dst_y = y;
+        break;
+        case TUYA_DISPLAY_ROTATION_90:
+            dst_x = y;
+            dst_y = log_w - x - w;
+        break;
+        case TUYA_DISPLAY_ROTATION_180:
+            dst_x = log_w - x - w;
+            dst_y = log_h - y - h;
+        break;
+        case TUYA_DISPLAY_ROTATION_270:
+            dst_x = log_h - y - h;
+            dst_y = x;
+        break;
+        default:
+            return OPRT_INVALID_PARM;
+    }
+
+    switch(in_fb->fmt) {
+        case TUYA_PIXEL_FMT_RGB565: {
+            uint16_t *src = (uint16_t *)in_fb->frame;
+            uint16_t *dst = (uint16_t *)out_fb->frame + dst_y * out_fb->width + dst_x;
+
+            if(TUYA_DISPLAY_ROTATION_90 == rot) {
+                __rotate90_rgb565(src, w, dst, out_fb->width, w, h, is_swap);
+            }else if(TUYA_DISPLAY_ROTATION_270 == rot) {
+                __rotate270_rgb565(src, w, dst, out_fb->width, w, h, is_swap);
+            }else if(TUYA_DISPLAY_ROTATION_180 == rot) {
+                __rotate180_rgb565(src, w, dst, out_fb->width, w, h, is_swap);
+            }else {
+                for(uint32_t j = 0; j < h; j++, src += w, dst += out_fb->width) {
+                    for(uint32_t i = 0; i < w; i++) {
+                        dst[i] = __pixel_rgb565(src[i], is_swap);
+                    }
+                }
+            }
+        }
+        break;
+        case TUYA_PIXEL_FMT_RGB888: {
+            uint8_t *src = in_fb->frame;
+            uint8_t *dst = out_fb->frame + (dst_y * out_fb->width + dst_x) * 3;
+
+            if(TUYA_DISPLAY_ROTATION_90 == rot) {
+                __rotate90_rgb888(src, w, dst, out_fb->width, w, h);
+            }else if(TUYA_DISPLAY_ROTATION_270 == rot) {
+                __rotate270_rgb888(src, w, dst, out_fb->width, w, h);
+            }else if(TUYA_DISPLAY_ROTATION_180 == rot) {
+                __rotate180_rgb888(src, w, dst, out_fb->width, w, h);
+            }else {
+                for(uint32_t j = 0; j < h; j++, src += w * 3, dst += out_fb->width * 3) {
+                    memcpy(dst, src, w * 3);
+                }
+            }
+        }
+        break;
+        default:
+            PR_ERR("Unsupported pixel format for area rotation: %d", in_fb->fmt);
+            return OPRT_NOT_SUPPORTED;
+    }
+
+    if(out_rect) {
+        out_rect->x0 = dst_x;
+        out_rect->y0 = dst_y;
+        out_rect->x1 = dst_x + dst_w - 1;
+        out_rect->y1 = dst_y + dst_h - 1;
+    }
+
+    return OPRT_OK;
+}
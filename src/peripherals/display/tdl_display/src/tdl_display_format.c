@@ -13,7 +13,13 @@
 /***********************************************************
 ************************macro define************************
 ***********************************************************/
+#define DISP_RGB565_R(c)  (((c) >> 11) & 0x1F)
+#define DISP_RGB565_G(c)  (((c) >> 5) & 0x3F)
+#define DISP_RGB565_B(c)  ((c) & 0x1F)
 
+// luma of a rgb565 pixel, BT.601 weights
+#define DISP_RGB565_LUMA(c) (sc_luma_r5[DISP_RGB565_R(c)] + sc_luma_g6[DISP_RGB565_G(c)] +\
+                             sc_luma_b5[DISP_RGB565_B(c)])
 
 /***********************************************************
 ***********************typedef define***********************
@@ -43,7 +49,32 @@ typedef union {
 /***********************************************************
 ***********************variable define**********************
 ***********************************************************/
+/* Weighted contribution of each rgb565 channel to the luma (77R + 150G + 29B) / 256,
+ * the channels expanded to 8 bits first. White sums to 255. */
+static const uint8_t sc_luma_r5[32] = {
+      0,   2,   5,   7,  10,  12,  15,  17,  20,  22,  25,  27,  30,  32,  35,  37,
+     40,  42,  45,  47,  50,  52,  54,  57,  60,  62,  64,  67,  69,  72,  74,  77
+};
 
+static const uint8_t sc_luma_g6[64] = {
+      0,   2,   5,   7,   9,  12,  14,  16,  19,  21,  23,  26,  28,  30,  33,  35,
+     38,  40,  43,  45,  47,  50,  52,  54,  57,  59,  62,  64,  66,  69,  71,  73,
+     76,  79,  81,  83,  86,  88,  90,  93,  95,  97, 100, 102, 104, 107, 109, 111,
+    114, 117, 119, 121, 124, 126, 128, 131, 133, 135, 138, 140, 142, 145, 147, 149
+};
+
+static const uint8_t sc_luma_b5[32] = {
+      0,   1,   2,   3,   4,   5,   6,   6,   7,   8,   9,  10,  11,  12,  13,  14,
+     15,  16,  17,  18,  19,  20,  21,  21,  22,  23,  24,  25,  26,  27,  28,  29
+};
+
+// 4x4 Bayer matrix scaled to 0-255
+static const uint8_t sc_bayer_4x4[4][4] = {
+    {  8, 136,  40, 168},
+    {200,  72, 232, 104},
+    { 56, 184,  24, 152},
+    {248, 120, 216,  88},
+};
 
 /***********************************************************
 ***********************function define**********************
@@ -217,4 +248,262 @@ uint32_t tdl_disp_convert_rgb565_to_color(uint16_t rgb565, TUYA_DISPLAY_PIXEL_FM
     }
 
     return color;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Converts a run of RGB565 pixels to RGB888.
+ *
+ * The output is stored the way RGB888 frame buffers are, blue first. The low
+ * bits are filled by replicating the high bits so that white stays 0xFFFFFF.
+ *
+ * @param src RGB565 pixels.
+ * @param dst Output, 3 bytes per pixel.
+ * @param num Number of pixels.
+ * @param is_swap Whether the source pixels are byte swapped.
+ * @return None.
+ */
+TUYA_HOT_DISPLAY
+void tdl_disp_convert_rgb565_to_rgb888(const uint16_t *src, uint8_t *dst, uint32_t num, bool is_swap)
+{
+    uint16_t c = 0;
+    uint8_t r = 0, g = 0, b = 0;
+
+    if (NULL == src || NULL == dst) {
+        return;
+    }
+
+    while (num--) {
+        c = *src++;
+        if (is_swap) {
+            c = WORD_SWAP(c);
+        }
+
+        r = DISP_RGB565_R(c);
+        g = DISP_RGB565_G(c);
+        b = DISP_RGB565_B(c);
+
+        *dst++ = (b << 3) | (b >> 2);
+        *dst++ = (g << 2) | (g >> 4);
+        *dst++ = (r << 3) | (r >> 2);
+    }
+}
+
+/**
+ * @brief Converts a run of RGB888 pixels (blue first) to RGB565.
+ *
+ * @param src RGB888 pixels, 3 bytes per pixel.
+ * @param dst Output RGB565 pixels.
+ * @param num Number of pixels.
+ * @param is_swap Whether to byte swap the output pixels.
+ * @return None.
+ */
+TUYA_HOT_DISPLAY
+void tdl_disp_convert_rgb888_to_rgb565(const uint8_t *src, uint16_t *dst, uint32_t num, bool is_swap)
+{
+    uint16_t c = 0;
+
+    if (NULL == src || NULL == dst) {
+        return;
+    }
+
+    while (num--) {
+        c = ((src[2] & 0xF8) << 8) | ((src[1] & 0xFC) << 3) | (src[0] >> 3);
+        *dst++ = is_swap ? WORD_SWAP(c) : c;
+        src += 3;
+    }
+}
+
+/**
+ * @brief Byte swaps a run of RGB565 pixels.
+ *
+ * Works on two pixels at a time when both buffers are 4 byte aligned. src and
+ * dst may be the same buffer.
+ *
+ * @param src RGB565 pixels.
+ * @param dst Output pixels.
+ * @param num Number of pixels.
+ * @return None.
+ */
+TUYA_HOT_DISPLAY
+void tdl_disp_convert_rgb565_swap(const uint16_t *src, uint16_t *dst, uint32_t num)
+{
+    const uint32_t *src_u32 = NULL;
+    uint32_t *dst_u32 = NULL;
+    uint32_t v = 0;
+
+    if (NULL == src || NULL == dst) {
+        return;
+    }
+
+    if (0 == (((uintptr_t)src | (uintptr_t)dst) & 0x03)) {
+        src_u32 = (const uint32_t *)src;
+        dst_u32 = (uint32_t *)dst;
+
+        while (num >= 2) {
+            v = *src_u32++;
+            *dst_u32++ = ((v & 0xFF00FF00) >> 8) | ((v & 0x00FF00FF) << 8);
+            num -= 2;
+        }
+
+        src = (const uint16_t *)src_u32;
+        dst = (uint16_t *)dst_u32;
+    }
+
+    while (num--) {
+        *dst++ = WORD_SWAP(*src);
+        src++;
+    }
+}
+
+static inline uint8_t __disp_clamp_u8(int32_t v)
+{
+    return (v < 0) ? 0 : ((v > 255) ? 255 : (uint8_t)v);
+}
+
+/**
+ * @brief Converts a run of YUV422 (YUYV) pixels to RGB565.
+ *
+ * Full range BT.601 in 8.8 fixed point, the chroma terms are computed once per
+ * pixel pair.
+ *
+ * @param src YUYV data, 2 bytes per pixel.
+ * @param dst Output RGB565 pixels.
+ * @param num Number of pixels, an odd last pixel is dropped.
+ * @param is_swap Whether to byte swap the output pixels.
+ * @return None.
+ */
+TUYA_HOT_DISPLAY
+void tdl_disp_convert_yuv422_to_rgb565(const uint8_t *src, uint16_t *dst, uint32_t num, bool is_swap)
+{
+    int32_t u = 0, v = 0, y = 0;
+    int32_t r_ofs = 0, g_ofs = 0, b_ofs = 0;
+    uint16_t c = 0;
+    uint8_t i = 0;
+
+    if (NULL == src || NULL == dst) {
+        return;
+    }
+
+    for (num /= 2; num; num--) {
+        u = (int32_t)src[1] - 128;
+        v = (int32_t)src[3] - 128;
+
+        r_ofs = 359 * v;
+        g_ofs = -88 * u - 183 * v;
+        b_ofs = 454 * u;
+
+        for (i = 0; i < 2; i++) {
+            y = (int32_t)src[i * 2] << 8;
+            c = ((__disp_clamp_u8((y + r_ofs + 128) >> 8) & 0xF8) << 8) |
+                ((__disp_clamp_u8((y + g_ofs + 128) >> 8) & 0xFC) << 3) |
+                (__disp_clamp_u8((y + b_ofs + 128) >> 8) >> 3);
+            *dst++ = is_swap ? WORD_SWAP(c) : c;
+        }
+
+        src += 4;
+    }
+}
+
+/**
+ * @brief Converts an area of RGB565 pixels into a monochrome or I2 frame buffer.
+ *
+ * The bits are packed a destination byte at a time, partial bytes at the edges
+ * of the area keep the pixels outside it. Pixels darker than the threshold set
+ * their bit in monochrome buffers. In I2 buffers the level grows with darkness,
+ * 3 is black. With ordered dithering the threshold only shifts the Bayer pattern.
+ *
+ * @param src RGB565 pixels of the area, rows of (rect->x1 - rect->x0 + 1) pixels.
+ * @param is_swap Whether the source pixels are byte swapped.
+ * @param rect Position of the area in the frame buffer, clipped to the frame buffer.
+ * @param dst_fb Destination frame buffer, TUYA_PIXEL_FMT_MONOCHROME or TUYA_PIXEL_FMT_I2.
+ * @param threshold Luma threshold (0-255) for monochrome output, 128 is the middle.
+ * @param dither Dithering mode.
+ * @return OPERATE_RET Operation result code.
+ */
+OPERATE_RET tdl_disp_convert_rgb565_to_bits(const uint16_t *src, bool is_swap, TDL_DISP_RECT_T *rect,\
+                                            TDL_DISP_FRAME_BUFF_T *dst_fb, uint8_t threshold,\
+                                            TDL_DISP_DITHER_E dither)
+{
+    const uint16_t *src_row = NULL;
+    uint8_t *dst = NULL;
+    uint32_t src_stride = 0, dst_stride = 0;
+    int32_t x0 = 0, y0 = 0, x1 = 0, y1 = 0, x = 0, y = 0;
+    int32_t bias = 0;
+    uint8_t bpp = 0, ppb = 0, shift = 0, mask = 0, byte = 0, level = 0, luma = 0;
+    uint16_t c = 0;
+
+    TUYA_CHECK_NULL_RETURN(src, OPRT_INVALID_PARM);
+    TUYA_CHECK_NULL_RETURN(rect, OPRT_INVALID_PARM);
+    TUYA_CHECK_NULL_RETURN(dst_fb, OPRT_INVALID_PARM);
+
+    if (TUYA_PIXEL_FMT_MONOCHROME == dst_fb->fmt) {
+        bpp = 1;
+    } else if (TUYA_PIXEL_FMT_I2 == dst_fb->fmt) {
+        bpp = 2;
+    } else {
+        return OPRT_NOT_SUPPORTED;
+    }
+
+    if (rect->x1 < rect->x0 || rect->y1 < rect->y0) {
+        return OPRT_INVALID_PARM;
+    }
+
+    ppb = 8 / bpp;
+    src_stride = rect->x1 - rect->x0 + 1;
+    dst_stride = dst_fb->width / ppb;
+    bias = (int32_t)threshold - 128;
+
+    x0 = rect->x0;
+    y0 = rect->y0;
+    x1 = MIN(rect->x1, dst_fb->width - 1);
+    y1 = MIN(rect->y1, dst_fb->height - 1);
+
+    for (y = y0; y <= y1; y++) {
+        src_row = src + (y - rect->y0) * src_stride;
+        dst = dst_fb->frame + y * dst_stride + x0 / ppb;
+        shift = (x0 % ppb) * bpp;
+        mask = 0;
+        byte = 0;
+
+        for (x = x0; x <= x1; x++) {
+            c = *src_row++;
+            if (is_swap) {
+                c = WORD_SWAP(c);
+            }
+            luma = DISP_RGB565_LUMA(c);
+
+            if (1 == bpp) {
+                if (TDL_DISP_DITHER_ORDERED == dither) {
+                    level = ((int32_t)luma < (int32_t)sc_bayer_4x4[y & 3][x & 3] + bias) ? 1 : 0;
+                } else {
+                    level = (luma < threshold) ? 1 : 0;
+                }
+            } else {
+                // darkness scaled to 0-765, the level is its top two bits out of 1024
+                if (TDL_DISP_DITHER_ORDERED == dither) {
+                    level = ((255 - luma) * 3 + sc_bayer_4x4[y & 3][x & 3]) >> 8;
+                } else {
+                    level = ((255 - luma) * 3 + 128) >> 8;
+                }
+            }
+
+            byte |= level << shift;
+            mask |= ((1 << bpp) - 1) << shift;
+            shift += bpp;
+
+            if (8 == shift) {
+                *dst = (*dst & ~mask) | byte;
+                dst++;
+                shift = 0;
+                mask = 0;
+                byte = 0;
+            }
+        }
+
+        if (mask) {
+            *dst = (*dst & ~mask) | byte;
+        }
+    }
+
+    return OPRT_OK;
+}
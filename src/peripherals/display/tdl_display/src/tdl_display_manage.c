@@ -23,6 +23,8 @@
 
 #include "tdl_display_driver.h"
 #include "tdl_display_manage.h"
+#include "tdl_display_draw.h"
+#include "tdl_display_profile.h"
 
 /***********************************************************
 ************************macro define************************
@@ -44,6 +46,17 @@ typedef struct {
 
     TDD_DISP_DEV_HANDLE_T tdd_hdl;
     TDD_DISP_INTFS_T intfs;
+
+    uint8_t *stage;
+    uint32_t stage_size;
+
+#if defined(ENABLE_DISPLAY_PROFILE) && (ENABLE_DISPLAY_PROFILE == 1)
+    // async transfer being timed, its done_cb is wrapped
+    bool prof_pending;
+    SYS_TIME_T prof_start;
+    TDL_DISP_FLUSH_DONE_CB prof_done_cb;
+    void *prof_arg;
+#endif
 } DISPLAY_DEVICE_T;
 
 /***********************************************************
@@ -78,6 +91,154 @@ static DISPLAY_DEVICE_T *__find_display_device(char *name)
     return NULL;
 }
 
+static uint32_t __rect_area(const TDL_DISP_RECT_T *rect)
+{
+    return (uint32_t)(rect->x1 - rect->x0 + 1) * (rect->y1 - rect->y0 + 1);
+}
+
+static void __rect_union(const TDL_DISP_RECT_T *a, const TDL_DISP_RECT_T *b, TDL_DISP_RECT_T *out)
+{
+    out->x0 = MIN(a->x0, b->x0);
+    out->y0 = MIN(a->y0, b->y0);
+    out->x1 = MAX(a->x1, b->x1);
+    out->y1 = MAX(a->y1, b->y1);
+}
+
+// every synchronous transfer to the driver goes through here
+static OPERATE_RET __tdl_disp_intfs_flush(DISPLAY_DEVICE_T *display_dev, TDL_DISP_FRAME_BUFF_T *frame_buff)
+{
+    OPERATE_RET rt = OPRT_OK;
+    SYS_TIME_T start = TDL_DISP_PROF_NOW();
+
+    rt = display_dev->intfs.flush(display_dev->tdd_hdl, frame_buff);
+
+    tdl_disp_prof_record(TDL_DISP_PROF_TRANSFER, start);
+    tdl_disp_prof_add_bytes(frame_buff->len);
+
+    return rt;
+}
+
+#if defined(ENABLE_DISPLAY_PROFILE) && (ENABLE_DISPLAY_PROFILE == 1)
+// times an async transfer from queueing until the driver reports it done
+static void __tdl_disp_prof_done_cb(void *arg)
+{
+    DISPLAY_DEVICE_T *display_dev = (DISPLAY_DEVICE_T *)arg;
+    TDL_DISP_FLUSH_DONE_CB done_cb = display_dev->prof_done_cb;
+    void *done_arg = display_dev->prof_arg;
+
+    tdl_disp_prof_record(TDL_DISP_PROF_TRANSFER, display_dev->prof_start);
+    display_dev->prof_pending = false;
+
+    if (done_cb) {
+        done_cb(done_arg);
+    }
+}
+#endif
+
+static bool __rect_clip(TDL_DISP_RECT_T *rect, uint16_t width, uint16_t height)
+{
+    if (rect->x0 >= width || rect->y0 >= height) {
+        return false;
+    }
+
+    rect->x1 = MIN(rect->x1, width - 1);
+    rect->y1 = MIN(rect->y1, height - 1);
+
+    return true;
+}
+
+// picks the windows to send, is_full asks for the whole frame in one flush
+static uint8_t __tdl_disp_pick_rects(DISPLAY_DEVICE_T *display_dev, TDL_DISP_FRAME_BUFF_T *frame_buff,
+                                     TDL_DISP_RECT_LIST_T *list, TDL_DISP_RECT_T *rect, bool *is_full)
+{
+    uint32_t area = 0;
+    uint8_t num = 0, i = 0;
+
+    *is_full = true;
+
+    if (NULL == list || 0 == list->num || false == display_dev->info.has_partial ||
+        tdl_disp_get_fmt_bpp(frame_buff->fmt) < 8 || frame_buff->x_start || frame_buff->y_start) {
+        return 1;
+    }
+
+    for (i = 0; i < list->num && i < TDL_DISP_DIRTY_RECT_MAX; i++) {
+        rect[num] = list->rect[i];
+        if (__rect_clip(&rect[num], frame_buff->width, frame_buff->height)) {
+            area += __rect_area(&rect[num]);
+            num++;
+        }
+    }
+
+    if (area * 100 > (uint32_t)frame_buff->width * frame_buff->height * TDL_DISP_DIRTY_FULL_PERCENT) {
+        return 1;
+    }
+
+    *is_full = false;
+
+    return num;
+}
+
+static OPERATE_RET __tdl_disp_flush_rect(DISPLAY_DEVICE_T *display_dev, TDL_DISP_FRAME_BUFF_T *frame_buff,
+                                         TDL_DISP_RECT_T *rect, uint8_t pixel_bytes)
+{
+    OPERATE_RET rt = OPRT_OK;
+    TDL_DISP_FRAME_BUFF_T sub_fb;
+    uint32_t stride = (uint32_t)frame_buff->width * pixel_bytes;
+    uint16_t width = rect->x1 - rect->x0 + 1;
+    uint32_t row_len = (uint32_t)width * pixel_bytes;
+    uint16_t rows = 0, i = 0;
+    uint32_t y = 0;
+    uint8_t *src = NULL;
+
+    memset(&sub_fb, 0, sizeof(TDL_DISP_FRAME_BUFF_T));
+    sub_fb.type = frame_buff->type;
+    sub_fb.fmt = frame_buff->fmt;
+    sub_fb.x_start = rect->x0;
+    sub_fb.width = width;
+
+    // full width rows are contiguous in the frame buffer
+    if (width == frame_buff->width) {
+        sub_fb.y_start = rect->y0;
+        sub_fb.height = rect->y1 - rect->y0 + 1;
+        sub_fb.len = row_len * sub_fb.height;
+        sub_fb.frame = frame_buff->frame + stride * rect->y0;
+
+        return __tdl_disp_intfs_flush(display_dev, &sub_fb);
+    }
+
+    if (display_dev->stage_size < stride) {
+        if (display_dev->stage) {
+            tkl_system_free(display_dev->stage);
+        }
+        display_dev->stage_size = MAX(TDL_DISP_DIRTY_STAGE_SIZE, stride);
+        display_dev->stage = tkl_system_malloc(display_dev->stage_size);
+        if (NULL == display_dev->stage) {
+            display_dev->stage_size = 0;
+            return OPRT_MALLOC_FAILED;
+        }
+    }
+
+    // drivers send synchronously, so the stage is free again once flush returns
+    for (y = rect->y0; y <= rect->y1; y += rows) {
+        rows = MIN(display_dev->stage_size / row_len, rect->y1 - y + 1);
+
+        src = frame_buff->frame + stride * y + (uint32_t)rect->x0 * pixel_bytes;
+        for (i = 0; i < rows; i++) {
+            memcpy(display_dev->stage + row_len * i, src, row_len);
+            src += stride;
+        }
+
+        sub_fb.y_start = y;
+        sub_fb.height = rows;
+        sub_fb.len = row_len * rows;
+        sub_fb.frame = display_dev->stage;
+
+        TUYA_CALL_ERR_RETURN(__tdl_disp_intfs_flush(display_dev, &sub_fb));
+    }
+
+    return OPRT_OK;
+}
+
 static void __tdl_blacklight_init(TUYA_DISPLAY_BL_CTRL_T *bl_cfg)
 {
     TUYA_GPIO_BASE_CFG_T cfg;
@@ -196,6 +357,8 @@ OPERATE_RET tdl_disp_dev_open(TDL_DISP_HANDLE_T disp_hdl)
         TUYA_CALL_ERR_RETURN(display_dev->intfs.open(display_dev->tdd_hdl));
     }
 
+    tdl_disp_prof_init();
+
     __tdl_blacklight_init(&display_dev->bl);
 
     display_dev->is_open = true;
@@ -230,12 +393,231 @@ OPERATE_RET tdl_disp_dev_flush(TDL_DISP_HANDLE_T disp_hdl, TDL_DISP_FRAME_BUFF_T
     }
 
     if (display_dev->intfs.flush) {
-        TUYA_CALL_ERR_RETURN(display_dev->intfs.flush(display_dev->tdd_hdl, frame_buff));
+        TUYA_CALL_ERR_RETURN(__tdl_disp_intfs_flush(display_dev, frame_buff));
+        tdl_disp_prof_frame_done();
     }
 
     return OPRT_OK;
 }
 
+/**
+ * @brief Empties a dirty rect list.
+ *
+ * @param list Pointer to the rect list.
+ *
+ * @return None.
+ */
+void tdl_disp_rect_list_clear(TDL_DISP_RECT_LIST_T *list)
+{
+    if (list) {
+        list->num = 0;
+    }
+}
+
+/**
+ * @brief Adds a dirty rect to a list.
+ *
+ * Overlapping or nearby rects are merged when a single window is cheaper than
+ * two. When the list is full the rect is merged with the one it grows least.
+ *
+ * @param list Pointer to the rect list.
+ * @param rect The dirty rect in panel coordinates.
+ *
+ * @return None.
+ */
+void tdl_disp_rect_list_add(TDL_DISP_RECT_LIST_T *list, const TDL_DISP_RECT_T *rect)
+{
+    TDL_DISP_RECT_T cur, merged;
+    int32_t cost = 0, best_cost = 0;
+    int best = 0, i = 0;
+
+    if (NULL == list || NULL == rect || rect->x0 > rect->x1 || rect->y0 > rect->y1) {
+        return;
+    }
+
+    cur = *rect;
+
+    // a merged rect may now reach others, keep folding until nothing is worth it
+    while (list->num > 0) {
+        best = -1;
+        best_cost = INT32_MAX;
+        for (i = 0; i < list->num; i++) {
+            __rect_union(&list->rect[i], &cur, &merged);
+            cost = (int32_t)__rect_area(&merged) - (int32_t)__rect_area(&list->rect[i]) - (int32_t)__rect_area(&cur);
+            if (cost < best_cost) {
+                best_cost = cost;
+                best = i;
+            }
+        }
+
+        if (best_cost > TDL_DISP_DIRTY_WINDOW_COST && list->num < TDL_DISP_DIRTY_RECT_MAX) {
+            break;
+        }
+
+        __rect_union(&list->rect[best], &cur, &cur);
+        list->rect[best] = list->rect[list->num - 1];
+        list->num--;
+    }
+
+    list->rect[list->num++] = cur;
+}
+
+/**
+ * @brief Flushes only the dirty rects of a full frame buffer to the display device.
+ *
+ * Each rect is sent as its own window. Rects spanning the full width are sent
+ * straight from the frame buffer, narrower rects are packed through a small
+ * staging buffer. The whole frame is sent instead when the panel cannot take
+ * windows (see has_partial), the pixel format is below one byte per pixel, or
+ * the dirty area exceeds TDL_DISP_DIRTY_FULL_PERCENT.
+ *
+ * @param disp_hdl Handle to the display device.
+ * @param frame_buff The full frame, its width is the row stride.
+ * @param list The dirty rects, NULL or empty sends the whole frame.
+ *
+ * @return Returns OPRT_OK on success, or an appropriate error code if flushing fails.
+ */
+OPERATE_RET tdl_disp_dev_flush_rects(TDL_DISP_HANDLE_T disp_hdl, TDL_DISP_FRAME_BUFF_T *frame_buff,
+                                     TDL_DISP_RECT_LIST_T *list)
+{
+    OPERATE_RET rt = OPRT_OK;
+    DISPLAY_DEVICE_T *display_dev = NULL;
+    TDL_DISP_RECT_T rect[TDL_DISP_DIRTY_RECT_MAX];
+    bool is_full = false;
+    uint8_t bpp = 0, num = 0, i = 0;
+
+    if (NULL == disp_hdl || NULL == frame_buff) {
+        return OPRT_INVALID_PARM;
+    }
+
+    display_dev = (DISPLAY_DEVICE_T *)disp_hdl;
+
+    if (false == display_dev->is_open) {
+        return OPRT_COM_ERROR;
+    }
+
+    if (NULL == display_dev->intfs.flush) {
+        return OPRT_OK;
+    }
+
+    num = __tdl_disp_pick_rects(display_dev, frame_buff, list, rect, &is_full);
+    if (is_full) {
+        TUYA_CALL_ERR_RETURN(__tdl_disp_intfs_flush(display_dev, frame_buff));
+        tdl_disp_prof_frame_done();
+        return OPRT_OK;
+    }
+
+    bpp = tdl_disp_get_fmt_bpp(frame_buff->fmt);
+    for (i = 0; i < num; i++) {
+        TUYA_CALL_ERR_RETURN(__tdl_disp_flush_rect(display_dev, frame_buff, &rect[i], bpp / 8));
+    }
+
+    tdl_disp_prof_frame_done();
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Flushes the dirty rects of a full frame buffer without waiting for the transfer.
+ *
+ * Rects are chosen as in tdl_disp_dev_flush_rects(). Drivers with a background
+ * transfer queue the rects and return at once, the frame must stay untouched
+ * until done_cb runs (in the driver task). Other drivers flush synchronously
+ * and done_cb is called before returning. done_cb is called on errors too.
+ *
+ * @param disp_hdl Handle to the display device.
+ * @param frame_buff The full frame, its width is the row stride.
+ * @param list The dirty rects, NULL or empty sends the whole frame.
+ * @param done_cb Called once the frame is no longer read, may be NULL.
+ * @param arg Argument of done_cb.
+ *
+ * @return Returns OPRT_OK on success, or an appropriate error code if flushing fails.
+ */
+OPERATE_RET tdl_disp_dev_flush_rects_async(TDL_DISP_HANDLE_T disp_hdl, TDL_DISP_FRAME_BUFF_T *frame_buff,
+                                           TDL_DISP_RECT_LIST_T *list, TDL_DISP_FLUSH_DONE_CB done_cb, void *arg)
+{
+    OPERATE_RET rt = OPRT_OK;
+    DISPLAY_DEVICE_T *display_dev = NULL;
+    TDL_DISP_RECT_T rect[TDL_DISP_DIRTY_RECT_MAX];
+    bool is_full = false;
+    uint8_t bpp = 0, num = 0, i = 0;
+
+    if (NULL == disp_hdl || NULL == frame_buff) {
+        rt = OPRT_INVALID_PARM;
+        goto __ERR;
+    }
+
+    display_dev = (DISPLAY_DEVICE_T *)disp_hdl;
+
+    if (NULL == display_dev->intfs.flush_async || tdl_disp_get_fmt_bpp(frame_buff->fmt) < 8) {
+        rt = tdl_disp_dev_flush_rects(disp_hdl, frame_buff, list);
+        if (done_cb) {
+            done_cb(arg);
+        }
+        return rt;
+    }
+
+    if (false == display_dev->is_open) {
+        rt = OPRT_COM_ERROR;
+        goto __ERR;
+    }
+
+    num = __tdl_disp_pick_rects(display_dev, frame_buff, list, rect, &is_full);
+    if (is_full) {
+        rect[0].x0 = 0;
+        rect[0].y0 = 0;
+        rect[0].x1 = frame_buff->width - 1;
+        rect[0].y1 = frame_buff->height - 1;
+    }
+
+    if (0 == num) {
+        if (done_cb) {
+            done_cb(arg);
+        }
+        return OPRT_OK;
+    }
+
+#if defined(ENABLE_DISPLAY_PROFILE) && (ENABLE_DISPLAY_PROFILE == 1)
+    if (false == display_dev->prof_pending) {
+        display_dev->prof_pending = true;
+        display_dev->prof_start = tal_system_get_millisecond();
+        display_dev->prof_done_cb = done_cb;
+        display_dev->prof_arg = arg;
+        done_cb = __tdl_disp_prof_done_cb;
+        arg = display_dev;
+    }
+#endif
+
+    bpp = tdl_disp_get_fmt_bpp(frame_buff->fmt);
+
+    // only the last rect reports, the driver sends in order
+    for (i = 0; i < num; i++) {
+        rt = display_dev->intfs.flush_async(display_dev->tdd_hdl, frame_buff, &rect[i],
+                                            (i == num - 1) ? done_cb : NULL, arg);
+        if (OPRT_OK != rt) {
+            PR_ERR("flush async failed: %d", rt);
+            break;
+        }
+        tdl_disp_prof_add_bytes(__rect_area(&rect[i]) * (bpp / 8));
+    }
+
+    if (OPRT_OK != rt) {
+        goto __ERR;
+    }
+
+    tdl_disp_prof_frame_done();
+
+    return OPRT_OK;
+
+__ERR:
+    // report at once so that the caller does not hang, rects already queued may still be in flight
+    if (done_cb) {
+        done_cb(arg);
+    }
+
+    return rt;
+}
+
 /**
  * @brief Retrieves information about a registered display device.
  *
@@ -343,6 +725,12 @@ OPERATE_RET tdl_disp_dev_close(TDL_DISP_HANDLE_T disp_hdl)
 
     __tdl_power_ctrl_io_deinit(&display_dev->power);
 
+    if (display_dev->stage) {
+        tkl_system_free(display_dev->stage);
+        display_dev->stage = NULL;
+        display_dev->stage_size = 0;
+    }
+
     display_dev->is_open = false;
 
     return OPRT_OK;
@@ -460,6 +848,7 @@ OPERATE_RET tdl_disp_device_register(char *name, TDD_DISP_DEV_HANDLE_T tdd_hdl,
     display_dev->info.fmt = dev_info->fmt;
     display_dev->info.rotation = dev_info->rotation;
     display_dev->info.is_swap  = dev_info->is_swap;
+    display_dev->info.has_partial = dev_info->has_partial;
 
     memcpy(&display_dev->bl, &dev_info->bl, sizeof(TUYA_DISPLAY_BL_CTRL_T));
     memcpy(&display_dev->power, &dev_info->power, sizeof(TUYA_DISPLAY_IO_CTRL_T));
@@ -0,0 +1,256 @@
+/**
+ * @file tdl_display_profile.c
+ * @brief Timing and throughput counters of the display pipeline.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include <stdio.h>
+
+#include "tal_api.h"
+
+#include "tdl_display_profile.h"
+
+#if defined(ENABLE_DISPLAY_PROFILE) && (ENABLE_DISPLAY_PROFILE == 1)
+/***********************************************************
+************************macro define************************
+***********************************************************/
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    MUTEX_HANDLE mutex;
+    TDL_DISP_PROF_STATS_T stats;
+
+    uint32_t frame_bytes;
+
+    // running window
+    SYS_TIME_T win_start;
+    uint32_t win_frames;
+    uint32_t win_bytes;
+    uint32_t win_ms[TDL_DISP_PROF_STAGE_MAX];
+} DISP_PROFILE_T;
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+static void __cli_disp_prof(int argc, char *argv[]);
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static DISP_PROFILE_T sg_disp_prof;
+
+static const char *sc_disp_prof_stage_name[TDL_DISP_PROF_STAGE_MAX] = {"render", "convert", "transfer"};
+
+static const cli_cmd_t sc_disp_prof_cli_cmd[] = {
+    {
+        .name = "disp_prof",
+        .help = "disp_prof [reset], show display flush timing and fps",
+        .func = __cli_disp_prof,
+    },
+};
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static void __disp_prof_print(void (*out)(char *line))
+{
+    TDL_DISP_PROF_STATS_T stats;
+    TDL_DISP_PROF_TIME_T *time = NULL;
+    char line[128];
+    uint8_t i = 0;
+
+    if (OPRT_OK != tdl_disp_prof_get_stats(&stats)) {
+        out("display profile not initialized");
+        return;
+    }
+
+    snprintf(line, SIZEOF(line), "frames %u, fps %u.%u, %u KB/s, last frame %u bytes", stats.frames,
+             stats.fps_x10 / 10, stats.fps_x10 % 10, stats.bytes_per_sec / 1024, stats.last_bytes);
+    out(line);
+
+    for (i = 0; i < TDL_DISP_PROF_STAGE_MAX; i++) {
+        time = &stats.stage[i];
+        snprintf(line, SIZEOF(line), "%-8s n=%u last=%u avg=%u max=%u ms, load %u%%", sc_disp_prof_stage_name[i],
+                 time->count, time->last_ms, time->count ? time->total_ms / time->count : 0, time->max_ms,
+                 stats.load[i]);
+        out(line);
+    }
+}
+
+static void __cli_disp_prof(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+        tdl_disp_prof_reset();
+        tal_cli_echo("display profile reset");
+        return;
+    }
+
+    __disp_prof_print(tal_cli_echo);
+}
+
+/**
+ * @brief Sets up the counters and registers the `disp_prof` cli command.
+ *
+ * Safe to call more than once, tdl_disp_dev_open() calls it.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_disp_prof_init(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    if (sg_disp_prof.mutex) {
+        return OPRT_OK;
+    }
+
+    TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&sg_disp_prof.mutex));
+
+    sg_disp_prof.win_start = tal_system_get_millisecond();
+
+    tal_cli_cmd_register(sc_disp_prof_cli_cmd, CNTSOF(sc_disp_prof_cli_cmd));
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Adds the time spent in a stage.
+ *
+ * @param stage The pipeline stage.
+ * @param start Timestamp from tal_system_get_millisecond() when the stage began.
+ *
+ * @return None.
+ */
+void tdl_disp_prof_record(TDL_DISP_PROF_STAGE_E stage, SYS_TIME_T start)
+{
+    TDL_DISP_PROF_TIME_T *time = NULL;
+    uint32_t ms = 0;
+
+    if (NULL == sg_disp_prof.mutex || stage >= TDL_DISP_PROF_STAGE_MAX) {
+        return;
+    }
+
+    ms = (uint32_t)(tal_system_get_millisecond() - start);
+
+    tal_mutex_lock(sg_disp_prof.mutex);
+
+    time = &sg_disp_prof.stats.stage[stage];
+    time->count++;
+    time->last_ms = ms;
+    time->total_ms += ms;
+    if (ms > time->max_ms) {
+        time->max_ms = ms;
+    }
+    sg_disp_prof.win_ms[stage] += ms;
+
+    tal_mutex_unlock(sg_disp_prof.mutex);
+}
+
+/**
+ * @brief Adds bytes sent to the panel for the current frame.
+ *
+ * @param bytes Number of bytes.
+ *
+ * @return None.
+ */
+void tdl_disp_prof_add_bytes(uint32_t bytes)
+{
+    if (NULL == sg_disp_prof.mutex) {
+        return;
+    }
+
+    tal_mutex_lock(sg_disp_prof.mutex);
+
+    sg_disp_prof.frame_bytes += bytes;
+    sg_disp_prof.stats.total_bytes += bytes;
+    sg_disp_prof.win_bytes += bytes;
+
+    tal_mutex_unlock(sg_disp_prof.mutex);
+}
+
+/**
+ * @brief Marks the end of a frame and updates the rolling window.
+ *
+ * @return None.
+ */
+void tdl_disp_prof_frame_done(void)
+{
+    TDL_DISP_PROF_STATS_T *stats = &sg_disp_prof.stats;
+    uint32_t elapsed = 0;
+    uint8_t i = 0;
+
+    if (NULL == sg_disp_prof.mutex) {
+        return;
+    }
+
+    tal_mutex_lock(sg_disp_prof.mutex);
+
+    stats->frames++;
+    stats->last_bytes = sg_disp_prof.frame_bytes;
+    sg_disp_prof.frame_bytes = 0;
+    sg_disp_prof.win_frames++;
+
+    elapsed = (uint32_t)(tal_system_get_millisecond() - sg_disp_prof.win_start);
+    if (elapsed >= TDL_DISP_PROF_WINDOW_MS) {
+        stats->fps_x10 = (uint16_t)((uint64_t)sg_disp_prof.win_frames * 10000 / elapsed);
+        stats->bytes_per_sec = (uint32_t)((uint64_t)sg_disp_prof.win_bytes * 1000 / elapsed);
+        for (i = 0; i < TDL_DISP_PROF_STAGE_MAX; i++) {
+            // async transfers may overlap the next frame
+            stats->load[i] = (uint8_t)MIN(100, (uint64_t)sg_disp_prof.win_ms[i] * 100 / elapsed);
+            sg_disp_prof.win_ms[i] = 0;
+        }
+
+        sg_disp_prof.win_start += elapsed;
+        sg_disp_prof.win_frames = 0;
+        sg_disp_prof.win_bytes = 0;
+    }
+
+    tal_mutex_unlock(sg_disp_prof.mutex);
+}
+
+/**
+ * @brief Copies the counters.
+ *
+ * @param stats Filled with the counters.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_disp_prof_get_stats(TDL_DISP_PROF_STATS_T *stats)
+{
+    TUYA_CHECK_NULL_RETURN(stats, OPRT_INVALID_PARM);
+
+    if (NULL == sg_disp_prof.mutex) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    tal_mutex_lock(sg_disp_prof.mutex);
+    memcpy(stats, &sg_disp_prof.stats, sizeof(TDL_DISP_PROF_STATS_T));
+    tal_mutex_unlock(sg_disp_prof.mutex);
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Clears all counters.
+ *
+ * @return None.
+ */
+void tdl_disp_prof_reset(void)
+{
+    MUTEX_HANDLE mutex = sg_disp_prof.mutex;
+
+    if (NULL == mutex) {
+        return;
+    }
+
+    tal_mutex_lock(mutex);
+    memset(&sg_disp_prof, 0, sizeof(DISP_PROFILE_T));
+    sg_disp_prof.mutex = mutex;
+    sg_disp_prof.win_start = tal_system_get_millisecond();
+    tal_mutex_unlock(mutex);
+}
+
+#endif
@@ -13,102 +13,266 @@
  * - Interrupt-driven encoder signal processing
  * - Thread-safe angle tracking using mutex protection
  * - Debounced button input detection
- * - Semaphore-based event handling for responsive input processing
- * - GPIO interrupt callbacks for efficient signal processing
+ * - Sampling on the shared input scheduler instead of a thread of its own
+ * - Rotation and press events on the shared input event queue
  *
- * The driver uses a dedicated thread to process encoder events, ensuring
- * reliable operation even under high interrupt loads. The implementation
- * provides accurate position tracking and button state detection.
+ * An edge wakes the sample entry, which confirms the step one sample later and
+ * then waits for both signals to return high. The entry is parked again once
+ * the encoder is at rest, so an idle encoder costs no sampling at all.
+ *
+ * With a hardware quadrature counter registered the GPIO decoding is not used,
+ * the counter is read every ENCODER_COUNTER_POLL_MS and its steps go out as one
+ * move, scaled up on fast turns. Interrupt load no longer grows with the speed.
  *
  * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
  *
  */
 #include "drv_encoder.h"
-
+#include "tdl_input_sched.h"
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define ENCODER_SAMPLE_TIME     5    // ms
+#define ENCODER_RELEASE_TIMEOUT 1000 // ms
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef enum {
+    ENCODER_STATE_IDLE = 0,
+    ENCODER_STATE_CONFIRM, // step seen, checked again on the next sample
+    ENCODER_STATE_RELEASE, // waiting for both signals to return high
+} ENCODER_STATE_E;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
 static int32_t encode_angle = 0;
-
-static SEM_HANDLE example_sem_hdl = NULL;
-static THREAD_HANDLE wait_thrd_hdl = NULL;
 static MUTEX_HANDLE mutex_hdl = NULL;
-
+static TDL_INPUT_SCHED_HANDLE sg_sched_hdl = NULL;
+
+static volatile uint8_t sg_rotate_edge = 0;
+static uint8_t sg_press_irq = 0; // the press pin has its own interrupt, no need to keep sampling it
+static ENCODER_STATE_E sg_state = ENCODER_STATE_IDLE;
+static int8_t sg_step = 0;
+static uint16_t sg_release_ms = 0;
+static uint8_t sg_pressed = 0;
+static uint8_t sg_press_cnt = 0;
+
+static const ENCODER_COUNTER_OPS_T *sg_counter = NULL;
+static int32_t sg_accel_residue = 0; // fraction of a step left by the acceleration, 1/256
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
 static void __gpio_irq_callback(void *args)
 {
     (void)args; // Suppress unused parameter warning
+    sg_rotate_edge = 1;
+    tdl_input_sched_kick(sg_sched_hdl);
+}
+
+static void __press_irq_callback(void *args)
+{
+    (void)args;
+    tdl_input_sched_kick(sg_sched_hdl);
+}
+
+static void __encoder_post_event(uint8_t event, int16_t steps)
+{
+    TDL_INPUT_EVENT_T input_ev = {
+        .src = TDL_INPUT_SRC_ENCODER,
+        .event = event,
+        .x = steps,
+    };
 
-    tal_semaphore_post(example_sem_hdl);
+    tdl_input_event_post(&input_ev);
+}
+
+// the press is taken after two equal samples in a row
+static void __encoder_sample_press(void)
+{
+    TUYA_GPIO_LEVEL_E read_level = TUYA_GPIO_LEVEL_HIGH;
+    uint8_t is_low = 0;
+
+    tkl_gpio_read(DECODER_INPUT_P, &read_level);
+    is_low = (read_level == TUYA_GPIO_LEVEL_LOW) ? 1 : 0;
+
+    if (is_low == sg_pressed) {
+        sg_press_cnt = 0;
+        return;
+    }
+
+    if (++sg_press_cnt >= 2) {
+        sg_press_cnt = 0;
+        sg_pressed = is_low;
+        __encoder_post_event(sg_pressed ? TDL_INPUT_EV_PRESS : TDL_INPUT_EV_RELEASE, 0);
+    }
+}
+
+// +1 for both low, -1 for A low and B high, 0 otherwise
+static int8_t __encoder_read_step(void)
+{
+    TUYA_GPIO_LEVEL_E a_level = 0;
+    TUYA_GPIO_LEVEL_E b_level = 0;
+
+    tkl_gpio_read(DECODER_INPUT_A, &a_level);
+    tkl_gpio_read(DECODER_INPUT_B, &b_level);
+
+    if (a_level == TUYA_GPIO_LEVEL_LOW && b_level == TUYA_GPIO_LEVEL_LOW) {
+        return 1;
+    } else if (a_level == TUYA_GPIO_LEVEL_LOW && b_level == TUYA_GPIO_LEVEL_HIGH) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static uint8_t __encoder_is_released(void)
+{
+    TUYA_GPIO_LEVEL_E a_level = 0;
+    TUYA_GPIO_LEVEL_E b_level = 0;
+
+    tkl_gpio_read(DECODER_INPUT_A, &a_level);
+    tkl_gpio_read(DECODER_INPUT_B, &b_level);
+
+    return (a_level == TUYA_GPIO_LEVEL_HIGH && b_level == TUYA_GPIO_LEVEL_HIGH) ? 1 : 0;
 }
 
 /**
- * @brief Wait for semaphore and process encoder input task.
+ * @brief Sample the encoder from the input scheduler.
  *
- * This function waits for a semaphore in an infinite loop, reads the encoder's input signals,
- * and updates the encoding angle based on the state of the input signals.
- * When the input signal is low, the encoding angle is increased; when the input signal is high,
- * the encoding angle is decreased. The function also checks the thread state to decide whether
- * to exit the loop.
+ * After an edge on input A the step direction is read, confirmed on the next
+ * sample and added to the encoding angle: both inputs low increase it, input A
+ * low and input B high decrease it. The entry then keeps sampling until both
+ * inputs are high again, or gives up after ENCODER_RELEASE_TIMEOUT.
  *
  * @param args The passed-in parameter, currently unused.
+ *
+ * @return true while the encoder or its button is still moving.
  */
-static void __sema_wait_task(void *args)
+static bool __encoder_sample(void *args)
 {
-    uint32_t cnt = 0;
-    TUYA_GPIO_LEVEL_E a_level = 0;
-    TUYA_GPIO_LEVEL_E b_level = 0;
+    int8_t step = 0;
 
-    while (1) {
-        tal_semaphore_wait(example_sem_hdl, SEM_WAIT_FOREVER);
-
-        tkl_gpio_read(DECODER_INPUT_A, &a_level);
-        tkl_gpio_read(DECODER_INPUT_B, &b_level);
-
-        if (a_level == TUYA_GPIO_LEVEL_LOW && b_level == TUYA_GPIO_LEVEL_LOW) {
-            tal_system_sleep(3);
-            tkl_gpio_read(DECODER_INPUT_A, &a_level);
-            tkl_gpio_read(DECODER_INPUT_B, &b_level);
-
-            if (a_level == TUYA_GPIO_LEVEL_LOW && b_level == TUYA_GPIO_LEVEL_LOW) {
-                tal_mutex_lock(mutex_hdl);
-                encode_angle += 1;
-                tal_mutex_unlock(mutex_hdl);
-            }
-        } else if (a_level == TUYA_GPIO_LEVEL_LOW && b_level == TUYA_GPIO_LEVEL_HIGH) {
-            tal_system_sleep(3);
-            tkl_gpio_read(DECODER_INPUT_A, &a_level);
-            tkl_gpio_read(DECODER_INPUT_B, &b_level);
-
-            if (a_level == TUYA_GPIO_LEVEL_LOW && b_level == TUYA_GPIO_LEVEL_HIGH) {
-                tal_mutex_lock(mutex_hdl);
-                encode_angle -= 1;
-                tal_mutex_unlock(mutex_hdl);
-            }
-        }
+    __encoder_sample_press();
 
-        cnt = 0;
-        while (1) {
-            tkl_gpio_read(DECODER_INPUT_A, &a_level);
-            tkl_gpio_read(DECODER_INPUT_B, &b_level);
-
-            if (a_level == TUYA_GPIO_LEVEL_HIGH && b_level == TUYA_GPIO_LEVEL_HIGH) {
-                break;
-            }
-
-            tal_system_sleep(10);
-            cnt++;
-            if (cnt > 100) {
-                PR_ERR("encoder wait timeout");
-                break;
-            }
+    switch (sg_state) {
+    case ENCODER_STATE_IDLE:
+        if (sg_rotate_edge) {
+            sg_rotate_edge = 0;
+            sg_step = __encoder_read_step();
+            sg_release_ms = 0;
+            sg_state = (sg_step) ? ENCODER_STATE_CONFIRM : ENCODER_STATE_RELEASE;
+        }
+        break;
+
+    case ENCODER_STATE_CONFIRM:
+        step = __encoder_read_step();
+        if (step == sg_step) {
+            tal_mutex_lock(mutex_hdl);
+            encode_angle += step;
+            tal_mutex_unlock(mutex_hdl);
+            __encoder_post_event(TDL_INPUT_EV_MOVE, step);
+        }
+        sg_state = ENCODER_STATE_RELEASE;
+        break;
+
+    case ENCODER_STATE_RELEASE:
+        if (__encoder_is_released()) {
+            sg_state = ENCODER_STATE_IDLE;
+        } else if ((sg_release_ms += ENCODER_SAMPLE_TIME) > ENCODER_RELEASE_TIMEOUT) {
+            PR_ERR("encoder wait timeout");
+            sg_state = ENCODER_STATE_IDLE;
         }
+        // edges of this step are not a new one
+        sg_rotate_edge = 0;
+        break;
+
+    default:
+        sg_state = ENCODER_STATE_IDLE;
+        break;
+    }
 
-        if (THREAD_STATE_STOP == tal_thread_get_state(wait_thrd_hdl)) {
-            break;
+    if (sg_state != ENCODER_STATE_IDLE || sg_press_cnt || sg_pressed || 0 == sg_press_irq) {
+        return true;
+    }
+
+    return false;
+}
+
+// scales the steps of one poll with the speed, the fraction is kept for the next poll
+static int16_t __encoder_accel(int32_t steps)
+{
+    int32_t speed = (steps < 0) ? -steps : steps;
+    int32_t factor = 256, scaled = 0, out = 0;
+
+    if (speed > ENCODER_ACCEL_THRESHOLD) {
+        factor += (speed - ENCODER_ACCEL_THRESHOLD) * ENCODER_ACCEL_GAIN;
+        if (factor > ENCODER_ACCEL_MAX * 256) {
+            factor = ENCODER_ACCEL_MAX * 256;
         }
     }
 
-    wait_thrd_hdl = NULL;
-    PR_DEBUG("thread __sema_wait_task will delete");
+    // a fraction of the other direction is dropped
+    if ((steps < 0) != (sg_accel_residue < 0)) {
+        sg_accel_residue = 0;
+    }
+    scaled = steps * factor + sg_accel_residue;
+    out = scaled / 256;
+    sg_accel_residue = scaled - out * 256;
+
+    if (out > INT16_MAX) {
+        out = INT16_MAX;
+    } else if (out < INT16_MIN) {
+        out = INT16_MIN;
+    }
+
+    return (int16_t)out;
+}
+
+/**
+ * @brief Sample the hardware counter from the input scheduler.
+ *
+ * @param args The passed-in parameter, currently unused.
+ *
+ * @return true, the counter is read every period.
+ */
+static bool __encoder_counter_sample(void *args)
+{
+    int32_t steps = 0;
+
+    __encoder_sample_press();
+
+    steps = sg_counter->take();
+    if (0 == steps) {
+        return true;
+    }
+
+    tal_mutex_lock(mutex_hdl);
+    encode_angle += steps;
+    tal_mutex_unlock(mutex_hdl);
+
+    __encoder_post_event(TDL_INPUT_EV_MOVE, __encoder_accel(steps));
+
+    return true;
+}
+
+OPERATE_RET encoder_counter_register(const ENCODER_COUNTER_OPS_T *ops)
+{
+    if (NULL == ops || NULL == ops->start || NULL == ops->take) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (sg_sched_hdl) {
+        PR_ERR("encoder already started");
+        return OPRT_COM_ERROR;
+    }
 
-    return;
+    sg_counter = ops;
+
+    return OPRT_OK;
 }
 
 /**
@@ -159,9 +323,9 @@ uint8_t encoder_get_pressed(void)
 /**
  * @brief Initialize the encoder module.
  *
- * This function is responsible for creating semaphores and mutexes, initializing GPIO input pins,
- * and setting up the encoder input interrupt configuration. If the waiting thread has not been
- * created yet, it will start the thread to handle semaphore waiting.
+ * This function is responsible for creating the mutex, initializing GPIO input pins,
+ * and setting up the encoder input interrupt configuration. The encoder is sampled by
+ * an entry of the shared input scheduler, parked until the first edge.
  *
  * @return OPERATE_RET
  */
@@ -169,18 +333,12 @@ OPERATE_RET tkl_encoder_init(void)
 {
     OPERATE_RET rt = OPRT_OK;
 
-    TUYA_CALL_ERR_RETURN(tal_semaphore_create_init(&example_sem_hdl, 0, 1));
-    TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&mutex_hdl));
-
-    THREAD_CFG_T thread_cfg = {
-        .thrdname = "sem_wait",
-        .stackDepth = 2048,
-        .priority = THREAD_PRIO_2,
-    };
+    if (NULL == mutex_hdl) {
+        TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&mutex_hdl));
+    }
 
-    if (NULL == wait_thrd_hdl) {
-        TUYA_CALL_ERR_RETURN(
-            tal_thread_create_and_start(&wait_thrd_hdl, NULL, NULL, __sema_wait_task, NULL, &thread_cfg));
+    if (sg_sched_hdl) {
+        return OPRT_OK;
     }
 
     /*GPIO input init*/
@@ -189,6 +347,21 @@ OPERATE_RET tkl_encoder_init(void)
         .direct = TUYA_GPIO_INPUT,
     };
 
+    /*Hardware counter, A and B belong to it and the press pin is sampled with it*/
+    if (sg_counter) {
+        rt = sg_counter->start();
+        if (OPRT_OK == rt) {
+            TUYA_CALL_ERR_LOG(tkl_gpio_init(DECODER_INPUT_P, &in_pin_cfg));
+            TUYA_CALL_ERR_RETURN(
+                tdl_input_sched_add(__encoder_counter_sample, NULL, ENCODER_COUNTER_POLL_MS, false, &sg_sched_hdl));
+            return OPRT_OK;
+        }
+        PR_WARN("encoder counter start failed %d, decoding on gpio", rt);
+        sg_counter = NULL;
+    }
+
+    TUYA_CALL_ERR_RETURN(tdl_input_sched_add(__encoder_sample, NULL, ENCODER_SAMPLE_TIME, true, &sg_sched_hdl));
+
     TUYA_CALL_ERR_LOG(tkl_gpio_init(DECODER_INPUT_A, &in_pin_cfg));
 
     TUYA_CALL_ERR_LOG(tkl_gpio_init(DECODER_INPUT_B, &in_pin_cfg));
@@ -206,5 +379,19 @@ OPERATE_RET tkl_encoder_init(void)
     /*irq enable*/
     TUYA_CALL_ERR_LOG(tkl_gpio_irq_enable(DECODER_INPUT_A));
 
+    /*Press input init, without it the press pin is sampled all the time*/
+    TUYA_GPIO_IRQ_T press_irq_cfg = {
+        .cb = __press_irq_callback,
+        .arg = NULL,
+        .mode = TUYA_GPIO_IRQ_RISE_FALL,
+    };
+    if (OPRT_OK == tkl_gpio_irq_init(DECODER_INPUT_P, &press_irq_cfg) &&
+        OPRT_OK == tkl_gpio_irq_enable(DECODER_INPUT_P)) {
+        sg_press_irq = 1;
+    } else {
+        PR_NOTICE("encoder press irq not supported, sampling it");
+    }
+    tdl_input_sched_kick(sg_sched_hdl);
+
     return OPRT_OK;
 }
@@ -12,7 +12,7 @@
  * - Built-in button support for encoder switches
  * - Thread-safe operations using mutex protection
  * - GPIO-based implementation with configurable pins
- * - Semaphore-based event handling for responsive input processing
+ * - Sampling on the shared input scheduler, events on its input event queue
  *
  * The driver abstracts the low-level GPIO operations and interrupt handling,
  * providing a simple interface for applications to read encoder position
@@ -36,6 +36,58 @@ extern "C" {
 #include "tal_api.h"
 #include "tal_log.h"
 #include "tkl_output.h"
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+// period the hardware counter is read at, steps in between are reported as one move
+#ifndef ENCODER_COUNTER_POLL_MS
+#define ENCODER_COUNTER_POLL_MS 10
+#endif
+
+// acceleration of the counter moves: up to THRESHOLD steps per poll go 1:1, each step
+// above it adds GAIN/256 to the factor, which stops at MAX. GAIN 0 turns it off.
+#ifndef ENCODER_ACCEL_THRESHOLD
+#define ENCODER_ACCEL_THRESHOLD 1
+#endif
+
+#ifndef ENCODER_ACCEL_GAIN
+#define ENCODER_ACCEL_GAIN 128
+#endif
+
+#ifndef ENCODER_ACCEL_MAX
+#define ENCODER_ACCEL_MAX 6
+#endif
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+/**
+ * @brief Quadrature counter of the chip, a pulse counter or a timer in encoder mode.
+ *
+ * The counter decodes inputs A and B in hardware, so rotation costs no interrupt at
+ * all. The driver only reads it every ENCODER_COUNTER_POLL_MS.
+ */
+typedef struct {
+    OPERATE_RET (*start)(void);
+    int32_t (*take)(void); // detents turned since the last call, signed
+} ENCODER_COUNTER_OPS_T;
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+/**
+ * @brief Decode with a hardware counter instead of the GPIO interrupt.
+ *
+ * Called before tkl_encoder_init(), usually by the board. When the counter
+ * does not start the GPIO decoding is used.
+ *
+ * @param ops The counter, kept by reference.
+ *
+ * @return OPERATE_RET
+ */
+OPERATE_RET encoder_counter_register(const ENCODER_COUNTER_OPS_T *ops);
+
 /**
  * @brief Get the angle value of the encoder.
  *
@@ -61,9 +113,8 @@ int32_t encoder_get_angle(void);
 /**
  * @brief Check if the encoder button is pressed.
  *
- * This function reads the voltage level of the encoder input pin. If a low voltage level
- * is still detected after a short delay, it returns 1 to indicate that the button is pressed;
- * otherwise, it returns 0 to indicate that it is not pressed.
+ * The press pin is sampled by the input scheduler, a level counts once it has been
+ * read twice in a row. This returns the debounced state without waiting.
  *
  * @return uint8_t Returns 1 if the button is pressed, returns 0 if not pressed.
  */
@@ -72,9 +123,9 @@ uint8_t encoder_get_pressed(void);
 /**
  * @brief Initialize the encoder module.
  *
- * This function is responsible for creating semaphores and mutexes, initializing GPIO input pins,
- * and setting up the encoder input interrupt configuration. If the waiting thread has not been
- * created yet, it will start the thread to handle semaphore waiting.
+ * This function is responsible for creating the mutex, initializing GPIO input pins,
+ * and setting up the encoder input interrupt configuration. The encoder is sampled by
+ * an entry of the shared input scheduler, parked until the first edge.
  *
  * @return OPERATE_RET
  */
@@ -0,0 +1,108 @@
+/**
+ * @file tdl_imu.h
+ * @brief IMU acquisition service on the BMI270 FIFO
+ *
+ * The service runs the BMI270 accelerometer and gyroscope into the sensor FIFO
+ * and maps the FIFO watermark interrupt to INT1. Nothing is read while the FIFO
+ * fills, on the interrupt a thread drains the whole batch in one burst read and
+ * hands the samples, in order and timestamped on the sensor clock, to the
+ * subscribers. The bus and the CPU are idle between batches.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __TDL_IMU_H__
+#define __TDL_IMU_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+// subscribers served at the same time
+#ifndef TDL_IMU_SUBSCRIBER_MAX
+#define TDL_IMU_SUBSCRIBER_MAX 4
+#endif
+
+// largest batch, the FIFO of the BMI270 holds 157 frames of accel and gyro
+#define TDL_IMU_BATCH_MAX 150
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    TUYA_I2C_NUM_E port;      // initialized by the caller, with its pins
+    TUYA_GPIO_NUM_E int_pin;  // wired to INT1 of the BMI270
+    uint8_t odr;              // BMI2_ACC_ODR_25HZ to BMI2_ACC_ODR_1600HZ, for both sensors
+    uint8_t acc_range;        // BMI2_ACC_RANGE_2G ...
+    uint8_t gyr_range;        // BMI2_GYR_RANGE_2000 ...
+    uint16_t batch;           // samples per watermark interrupt, 1 to TDL_IMU_BATCH_MAX
+} TDL_IMU_CFG_T;
+
+typedef struct {
+    uint64_t time_us; // sensor time of the sample
+    int16_t acc[3];   // raw LSB, x y z
+    int16_t gyr[3];   // raw LSB, x y z
+} TDL_IMU_SAMPLE_T;
+
+/**
+ * @brief Samples of a batch, called from the service thread
+ *
+ * @note The next batch waits for the return, do not start or stop the service
+ * from the callback.
+ *
+ * @param[in] samples: samples in time order, valid during the call
+ * @param[in] num: number of samples
+ * @param[in] arg: arg given to tdl_imu_subscribe
+ */
+typedef void (*TDL_IMU_SAMPLE_CB)(const TDL_IMU_SAMPLE_T *samples, uint16_t num, void *arg);
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+/**
+ * @brief Configures the BMI270 and starts the service
+ *
+ * @param[in] cfg: service configure
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_imu_start(const TDL_IMU_CFG_T *cfg);
+
+/**
+ * @brief Stops the service and puts the sensors in suspend
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_imu_stop(void);
+
+/**
+ * @brief Adds a subscriber, it gets the batches read after the call
+ *
+ * @param[in] cb: sample callback
+ * @param[in] arg: passed to cb
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_imu_subscribe(TDL_IMU_SAMPLE_CB cb, void *arg);
+
+/**
+ * @brief Removes a subscriber
+ *
+ * @param[in] cb: sample callback given to tdl_imu_subscribe
+ * @param[in] arg: arg given to tdl_imu_subscribe
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_imu_unsubscribe(TDL_IMU_SAMPLE_CB cb, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TDL_IMU_H__ */
@@ -0,0 +1,167 @@
+/**
+ * @file tdl_imu_fusion.h
+ * @brief Fixed point attitude and gesture detection on the IMU service batches
+ *
+ * A Mahony filter keeps the attitude quaternion in Q30 from the gyro, with the
+ * accel pulling it back to gravity while the device is not accelerating. The
+ * whole path is integer so chips without an FPU run it at the ODR without the
+ * soft float library. Gestures come from thresholds and small state machines on
+ * the same samples: a tap is a short accel spike, a shake alternating linear
+ * acceleration peaks, a tilt the gravity vector away from the reference for a
+ * while, a pick-up an upward push after the device lay still.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __TDL_IMU_FUSION_H__
+#define __TDL_IMU_FUSION_H__
+
+#include "tuya_cloud_types.h"
+#include "tdl_imu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+// Mahony gains, 256 is 1.0
+#ifndef TDL_IMU_FUSION_KP
+#define TDL_IMU_FUSION_KP 256
+#endif
+
+#ifndef TDL_IMU_FUSION_KI
+#define TDL_IMU_FUSION_KI 5
+#endif
+
+// accel is used for the correction within this distance of 1g
+#ifndef TDL_IMU_FUSION_ACC_GATE_MG
+#define TDL_IMU_FUSION_ACC_GATE_MG 150
+#endif
+
+// tap: spike above this, back under half of it within the time
+#ifndef TDL_IMU_TAP_MG
+#define TDL_IMU_TAP_MG 1200
+#endif
+
+#ifndef TDL_IMU_TAP_MAX_MS
+#define TDL_IMU_TAP_MAX_MS 60
+#endif
+
+// shake: peaks of alternating sign above this, so many within the window
+#ifndef TDL_IMU_SHAKE_MG
+#define TDL_IMU_SHAKE_MG 700
+#endif
+
+#ifndef TDL_IMU_SHAKE_PEAKS
+#define TDL_IMU_SHAKE_PEAKS 4
+#endif
+
+#ifndef TDL_IMU_SHAKE_WINDOW_MS
+#define TDL_IMU_SHAKE_WINDOW_MS 1000
+#endif
+
+// tilt: away from the reference by this angle for the time
+#ifndef TDL_IMU_TILT_DEG
+#define TDL_IMU_TILT_DEG 35
+#endif
+
+#ifndef TDL_IMU_TILT_HOLD_MS
+#define TDL_IMU_TILT_HOLD_MS 300
+#endif
+
+// pick-up: still under this for the time, then pushed up by the threshold
+#ifndef TDL_IMU_STILL_MG
+#define TDL_IMU_STILL_MG 40
+#endif
+
+#ifndef TDL_IMU_STILL_MS
+#define TDL_IMU_STILL_MS 1000
+#endif
+
+#ifndef TDL_IMU_PICKUP_MG
+#define TDL_IMU_PICKUP_MG 150
+#endif
+
+// gestures are not reported again within this time
+#ifndef TDL_IMU_GESTURE_HOLDOFF_MS
+#define TDL_IMU_GESTURE_HOLDOFF_MS 300
+#endif
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef enum {
+    TDL_IMU_GESTURE_TAP = 0,
+    TDL_IMU_GESTURE_SHAKE,
+    TDL_IMU_GESTURE_TILT,
+    TDL_IMU_GESTURE_PICK_UP,
+} TDL_IMU_GESTURE_E;
+
+typedef struct {
+    int32_t q[4];     // w x y z, Q30
+    int16_t roll_cd;  // centidegree
+    int16_t pitch_cd; // centidegree
+} TDL_IMU_ATTITUDE_T;
+
+/**
+ * @brief gesture found, called from the IMU service thread
+ *
+ * @param[in] gesture: TDL_IMU_GESTURE_E
+ * @param[in] time_us: sensor time of the sample that completed it
+ * @param[in] arg: arg of TDL_IMU_FUSION_CFG_T
+ */
+typedef void (*TDL_IMU_GESTURE_CB)(TDL_IMU_GESTURE_E gesture, uint64_t time_us, void *arg);
+
+typedef struct {
+    uint8_t acc_range_g;     // 2, 4, 8 or 16, as set on the service
+    uint16_t gyr_range_dps;  // 125 to 2000, as set on the service
+    TDL_IMU_GESTURE_CB gesture_cb;
+    void *arg;
+} TDL_IMU_FUSION_CFG_T;
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+/**
+ * @brief Subscribes the fusion to the IMU service
+ *
+ * @param[in] cfg: fusion configure
+ *
+ * @note The attitude starts level, the tilt reference is the gravity after
+ * the first still period.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_imu_fusion_start(const TDL_IMU_FUSION_CFG_T *cfg);
+
+/**
+ * @brief Unsubscribes the fusion from the IMU service
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_imu_fusion_stop(void);
+
+/**
+ * @brief Gets the attitude after the last batch
+ *
+ * @param[out] attitude: attitude
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_imu_fusion_get_attitude(TDL_IMU_ATTITUDE_T *attitude);
+
+/**
+ * @brief Takes the current gravity as the tilt reference
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_imu_fusion_set_tilt_ref(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TDL_IMU_FUSION_H__ */
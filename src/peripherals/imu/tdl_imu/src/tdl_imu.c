@@ -0,0 +1,454 @@
+/**
+ * @file tdl_imu.c
+ * @brief IMU acquisition service on the BMI270 FIFO
+ *
+ * The FIFO runs in header mode with accel and gyro frames of 13 bytes and the
+ * sensor time frame. Its watermark interrupt posts the service thread, which
+ * reads the fill level and the frames in one burst, a few more bytes than the
+ * level so the sensor time frame comes last. The samples of the batch are
+ * spaced by the ODR period back from that sensor time.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include "tkl_gpio.h"
+#include "tkl_memory.h"
+
+#include "tal_api.h"
+
+#include "bmi270.h"
+#include "bmi270_common.h"
+
+#include "tdl_imu.h"
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define IMU_FIFO_SIZE      2048
+// header, gyro and accel
+#define IMU_FRAME_LEN      13
+#define IMU_FIFO_FRAME_MAX (IMU_FIFO_SIZE / IMU_FRAME_LEN)
+// sensor time frame read after the frames, and the SPI dummy byte
+#define IMU_READ_OVERHEAD  8
+
+#define IMU_SENSOR_TIME_MASK 0xFFFFFF
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    TDL_IMU_SAMPLE_CB cb;
+    void *arg;
+} IMU_SUBSCRIBER_T;
+
+typedef struct {
+    struct bmi2_dev dev;
+    uint8_t port;
+    TDL_IMU_CFG_T cfg;
+    bool running;
+
+    MUTEX_HANDLE mutex; // device and buffers
+    MUTEX_HANDLE sub_mutex;
+    SEM_HANDLE sem;
+    THREAD_HANDLE thread;
+
+    uint16_t frame_cap; // frames the buffers hold
+    uint8_t *fifo_buf;
+    struct bmi2_sens_axes_data *acc;
+    struct bmi2_sens_axes_data *gyr;
+    TDL_IMU_SAMPLE_T *samples;
+
+    uint32_t period_ticks; // ODR period in sensor time ticks of 39.0625us
+    uint32_t last_ticks;   // 24 bit sensor time of the last sample
+    uint64_t time_ticks;   // unwrapped sensor time of the last sample
+
+    IMU_SUBSCRIBER_T subs[TDL_IMU_SUBSCRIBER_MAX];
+} IMU_SERVICE_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static IMU_SERVICE_T sg_imu;
+
+static const uint8_t sg_sensor_list[] = {BMI2_ACCEL, BMI2_GYRO};
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static void __imu_irq_cb(void *args)
+{
+    tal_semaphore_post(sg_imu.sem);
+}
+
+static void __imu_free_buf(void)
+{
+    if (sg_imu.fifo_buf) {
+        tkl_system_free(sg_imu.fifo_buf);
+        sg_imu.fifo_buf = NULL;
+    }
+    if (sg_imu.acc) {
+        tkl_system_free(sg_imu.acc);
+        sg_imu.acc = NULL;
+    }
+    if (sg_imu.gyr) {
+        tkl_system_free(sg_imu.gyr);
+        sg_imu.gyr = NULL;
+    }
+    if (sg_imu.samples) {
+        tkl_system_free(sg_imu.samples);
+        sg_imu.samples = NULL;
+    }
+    sg_imu.frame_cap = 0;
+}
+
+static OPERATE_RET __imu_alloc_buf(uint16_t frames)
+{
+    if (frames <= sg_imu.frame_cap) {
+        return OPRT_OK;
+    }
+
+    __imu_free_buf();
+    sg_imu.fifo_buf = tkl_system_malloc(frames * IMU_FRAME_LEN + IMU_READ_OVERHEAD);
+    sg_imu.acc = tkl_system_malloc(frames * sizeof(struct bmi2_sens_axes_data));
+    sg_imu.gyr = tkl_system_malloc(frames * sizeof(struct bmi2_sens_axes_data));
+    sg_imu.samples = tkl_system_malloc(frames * sizeof(TDL_IMU_SAMPLE_T));
+    if (NULL == sg_imu.fifo_buf || NULL == sg_imu.acc || NULL == sg_imu.gyr || NULL == sg_imu.samples) {
+        __imu_free_buf();
+        return OPRT_MALLOC_FAILED;
+    }
+    sg_imu.frame_cap = frames;
+
+    return OPRT_OK;
+}
+
+static void __imu_publish(uint16_t num)
+{
+    IMU_SUBSCRIBER_T subs[TDL_IMU_SUBSCRIBER_MAX];
+    uint32_t i = 0;
+
+    tal_mutex_lock(sg_imu.sub_mutex);
+    memcpy(subs, sg_imu.subs, sizeof(subs));
+    tal_mutex_unlock(sg_imu.sub_mutex);
+
+    for (i = 0; i < TDL_IMU_SUBSCRIBER_MAX; i++) {
+        if (subs[i].cb) {
+            subs[i].cb(sg_imu.samples, num, subs[i].arg);
+        }
+    }
+}
+
+// reads what the FIFO holds, returns the number of samples published
+static int32_t __imu_drain_once(void)
+{
+    struct bmi2_fifo_frame fifo = {0};
+    uint16_t fifo_len = 0, acc_num = 0, gyr_num = 0, num = 0, i = 0;
+    uint32_t span = 0;
+    int8_t rslt = BMI2_OK;
+
+    rslt = bmi2_get_fifo_length(&fifo_len, &sg_imu.dev);
+    if (BMI2_OK != rslt) {
+        return -1;
+    }
+    if (fifo_len < IMU_FRAME_LEN) {
+        return 0;
+    }
+    if (fifo_len > sg_imu.frame_cap * IMU_FRAME_LEN) {
+        fifo_len = sg_imu.frame_cap * IMU_FRAME_LEN;
+    }
+
+    fifo.data = sg_imu.fifo_buf;
+    fifo.length = fifo_len + IMU_READ_OVERHEAD;
+    rslt = bmi2_read_fifo_data(&fifo, &sg_imu.dev);
+    if (BMI2_OK != rslt) {
+        PR_ERR("imu fifo read err %d", rslt);
+        return -1;
+    }
+
+    acc_num = sg_imu.frame_cap;
+    gyr_num = sg_imu.frame_cap;
+    (void)bmi2_extract_accel(sg_imu.acc, &acc_num, &fifo, &sg_imu.dev);
+    (void)bmi2_extract_gyro(sg_imu.gyr, &gyr_num, &fifo, &sg_imu.dev);
+    if (fifo.skipped_frame_count) {
+        PR_WARN("imu fifo overflow, %d frames skipped", fifo.skipped_frame_count);
+    }
+
+    // frames carry both sensors, the counts only differ on a frame cut by the read
+    num = (acc_num < gyr_num) ? acc_num : gyr_num;
+    if (0 == num) {
+        return 0;
+    }
+
+    // the sensor time frame is missing when the read ended on a frame
+    if (fifo.sensor_time) {
+        span = (fifo.sensor_time - sg_imu.last_ticks) & IMU_SENSOR_TIME_MASK;
+        sg_imu.last_ticks = fifo.sensor_time;
+    } else {
+        span = num * sg_imu.period_ticks;
+        sg_imu.last_ticks = (sg_imu.last_ticks + span) & IMU_SENSOR_TIME_MASK;
+    }
+    sg_imu.time_ticks += span;
+
+    for (i = 0; i < num; i++) {
+        uint64_t ticks = sg_imu.time_ticks - (uint64_t)(num - 1 - i) * sg_imu.period_ticks;
+
+        sg_imu.samples[i].time_us = ticks * 625 / 16;
+        sg_imu.samples[i].acc[0] = sg_imu.acc[i].x;
+        sg_imu.samples[i].acc[1] = sg_imu.acc[i].y;
+        sg_imu.samples[i].acc[2] = sg_imu.acc[i].z;
+        sg_imu.samples[i].gyr[0] = sg_imu.gyr[i].x;
+        sg_imu.samples[i].gyr[1] = sg_imu.gyr[i].y;
+        sg_imu.samples[i].gyr[2] = sg_imu.gyr[i].z;
+    }
+
+    __imu_publish(num);
+
+    return num;
+}
+
+static void __imu_task(void *args)
+{
+    uint32_t timeout = SEM_WAIT_FOREVER;
+    int32_t num = 0;
+
+    (void)args;
+
+    for (;;) {
+        tal_semaphore_wait(sg_imu.sem, timeout);
+
+        tal_mutex_lock(sg_imu.mutex);
+        if (!sg_imu.running) {
+            tal_mutex_unlock(sg_imu.mutex);
+            timeout = SEM_WAIT_FOREVER;
+            continue;
+        }
+
+        // the edge of a batch that filled during the read is lost, keep going
+        // while full batches are left and wake up anyway after two batches
+        do {
+            num = __imu_drain_once();
+        } while (num >= sg_imu.cfg.batch);
+        timeout = (uint32_t)((uint64_t)sg_imu.period_ticks * sg_imu.cfg.batch * 2 * 625 / 16 / 1000) + 1;
+        tal_mutex_unlock(sg_imu.mutex);
+    }
+}
+
+static OPERATE_RET __imu_sensor_config(const TDL_IMU_CFG_T *cfg)
+{
+    struct bmi2_sens_config config[2];
+    struct bmi2_int_pin_config pin_cfg = {0};
+    int8_t rslt = BMI2_OK;
+
+    config[0].type = BMI2_ACCEL;
+    config[1].type = BMI2_GYRO;
+    rslt = bmi270_get_sensor_config(config, 2, &sg_imu.dev);
+    if (BMI2_OK != rslt) {
+        return OPRT_COM_ERROR;
+    }
+
+    config[0].cfg.acc.odr = cfg->odr;
+    config[0].cfg.acc.range = cfg->acc_range;
+    config[0].cfg.acc.bwp = BMI2_ACC_NORMAL_AVG4;
+    config[0].cfg.acc.filter_perf = BMI2_PERF_OPT_MODE;
+    config[1].cfg.gyr.odr = cfg->odr;
+    config[1].cfg.gyr.range = cfg->gyr_range;
+    config[1].cfg.gyr.bwp = BMI2_GYR_NORMAL_MODE;
+    config[1].cfg.gyr.noise_perf = BMI2_POWER_OPT_MODE;
+    config[1].cfg.gyr.filter_perf = BMI2_PERF_OPT_MODE;
+    rslt = bmi270_set_sensor_config(config, 2, &sg_imu.dev);
+    if (BMI2_OK != rslt) {
+        return OPRT_COM_ERROR;
+    }
+
+    // FIFO cleared of the default config, then frames of both sensors with the sensor time
+    rslt = bmi2_set_fifo_config(BMI2_FIFO_ALL_EN | BMI2_FIFO_STOP_ON_FULL, BMI2_DISABLE, &sg_imu.dev);
+    if (BMI2_OK == rslt) {
+        rslt = bmi2_set_fifo_config(BMI2_FIFO_ACC_EN | BMI2_FIFO_GYR_EN | BMI2_FIFO_HEADER_EN | BMI2_FIFO_TIME_EN,
+                                    BMI2_ENABLE, &sg_imu.dev);
+    }
+    if (BMI2_OK == rslt) {
+        rslt = bmi2_set_fifo_wm(cfg->batch * IMU_FRAME_LEN, &sg_imu.dev);
+    }
+    if (BMI2_OK != rslt) {
+        return OPRT_COM_ERROR;
+    }
+
+    // watermark on INT1, high while the FIFO is above it
+    pin_cfg.pin_type = BMI2_INT1;
+    pin_cfg.int_latch = BMI2_INT_NON_LATCH;
+    pin_cfg.pin_cfg[0].lvl = BMI2_INT_ACTIVE_HIGH;
+    pin_cfg.pin_cfg[0].od = BMI2_INT_PUSH_PULL;
+    pin_cfg.pin_cfg[0].output_en = BMI2_INT_OUTPUT_ENABLE;
+    pin_cfg.pin_cfg[0].input_en = BMI2_INT_INPUT_DISABLE;
+    rslt = bmi2_set_int_pin_config(&pin_cfg, &sg_imu.dev);
+    if (BMI2_OK == rslt) {
+        rslt = bmi2_map_data_int(BMI2_FWM_INT, BMI2_INT1, &sg_imu.dev);
+    }
+    if (BMI2_OK != rslt) {
+        return OPRT_COM_ERROR;
+    }
+
+    rslt = bmi270_sensor_enable(sg_sensor_list, 2, &sg_imu.dev);
+    if (BMI2_OK != rslt) {
+        return OPRT_COM_ERROR;
+    }
+
+    return OPRT_OK;
+}
+
+OPERATE_RET tdl_imu_start(const TDL_IMU_CFG_T *cfg)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint16_t frames = 0;
+
+    TUYA_CHECK_NULL_RETURN(cfg, OPRT_INVALID_PARM);
+    if (cfg->odr < BMI2_ACC_ODR_25HZ || cfg->odr > BMI2_ACC_ODR_1600HZ || 0 == cfg->batch ||
+        cfg->batch > TDL_IMU_BATCH_MAX) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (NULL == sg_imu.sub_mutex) {
+        TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&sg_imu.sub_mutex));
+    }
+    if (NULL == sg_imu.mutex) {
+        TUYA_CALL_ERR_RETURN(tal_semaphore_create_init(&sg_imu.sem, 0, 1));
+        TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&sg_imu.mutex));
+    }
+
+    tal_mutex_lock(sg_imu.mutex);
+    if (sg_imu.running) {
+        rt = OPRT_COM_ERROR;
+        goto __EXIT;
+    }
+
+    // room for a late read of up to two batches
+    frames = cfg->batch * 2;
+    if (frames > IMU_FIFO_FRAME_MAX) {
+        frames = IMU_FIFO_FRAME_MAX;
+    }
+    TUYA_CALL_ERR_GOTO(__imu_alloc_buf(frames), __EXIT);
+
+    memcpy(&sg_imu.cfg, cfg, sizeof(TDL_IMU_CFG_T));
+    sg_imu.port = cfg->port;
+    sg_imu.dev.intf_ptr = &sg_imu.port;
+    if (BMI2_OK != bmi2_interface_init(&sg_imu.dev, BMI2_I2C_INTF)) {
+        rt = OPRT_COM_ERROR;
+        goto __EXIT;
+    }
+    if (BMI2_OK != bmi270_init(&sg_imu.dev)) {
+        PR_ERR("bmi270 not found");
+        rt = OPRT_NOT_FOUND;
+        goto __EXIT;
+    }
+    TUYA_CALL_ERR_GOTO(__imu_sensor_config(cfg), __EXIT);
+
+    // 100Hz is 256 ticks, each ODR step doubles the rate
+    sg_imu.period_ticks = 65536u >> cfg->odr;
+    sg_imu.last_ticks = 0;
+    sg_imu.time_ticks = 0;
+
+    TUYA_GPIO_BASE_CFG_T gpio_cfg = {
+        .mode = TUYA_GPIO_PULLDOWN,
+        .direct = TUYA_GPIO_INPUT,
+        .level = TUYA_GPIO_LEVEL_LOW,
+    };
+    TUYA_GPIO_IRQ_T irq_cfg = {
+        .mode = TUYA_GPIO_IRQ_RISE,
+        .cb = __imu_irq_cb,
+        .arg = NULL,
+    };
+    TUYA_CALL_ERR_GOTO(tkl_gpio_init(cfg->int_pin, &gpio_cfg), __EXIT);
+    TUYA_CALL_ERR_GOTO(tkl_gpio_irq_init(cfg->int_pin, &irq_cfg), __EXIT);
+
+    if (NULL == sg_imu.thread) {
+        THREAD_CFG_T thrd_cfg = {
+            .thrdname = "tdl_imu",
+            .priority = THREAD_PRIO_1,
+            .stackDepth = 2048,
+        };
+        TUYA_CALL_ERR_GOTO(
+            tal_thread_create_and_start(&sg_imu.thread, NULL, NULL, __imu_task, NULL, &thrd_cfg), __EXIT);
+    }
+
+    sg_imu.running = true;
+    TUYA_CALL_ERR_GOTO(tkl_gpio_irq_enable(cfg->int_pin), __EXIT);
+    // a FIFO above the watermark already gives no edge
+    tal_semaphore_post(sg_imu.sem);
+
+__EXIT:
+    if (OPRT_OK != rt && !sg_imu.running) {
+        __imu_free_buf();
+    }
+    tal_mutex_unlock(sg_imu.mutex);
+
+    return rt;
+}
+
+OPERATE_RET tdl_imu_stop(void)
+{
+    if (NULL == sg_imu.mutex) {
+        return OPRT_COM_ERROR;
+    }
+
+    tal_mutex_lock(sg_imu.mutex);
+    if (!sg_imu.running) {
+        tal_mutex_unlock(sg_imu.mutex);
+        return OPRT_OK;
+    }
+
+    sg_imu.running = false;
+    tkl_gpio_irq_disable(sg_imu.cfg.int_pin);
+    bmi270_sensor_disable(sg_sensor_list, 2, &sg_imu.dev);
+    bmi2_set_fifo_config(BMI2_FIFO_ALL_EN, BMI2_DISABLE, &sg_imu.dev);
+    __imu_free_buf();
+    tal_mutex_unlock(sg_imu.mutex);
+
+    return OPRT_OK;
+}
+
+OPERATE_RET tdl_imu_subscribe(TDL_IMU_SAMPLE_CB cb, void *arg)
+{
+    OPERATE_RET rt = OPRT_EXCEED_UPPER_LIMIT;
+    uint32_t i = 0;
+
+    TUYA_CHECK_NULL_RETURN(cb, OPRT_INVALID_PARM);
+    if (NULL == sg_imu.sub_mutex) {
+        TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&sg_imu.sub_mutex));
+    }
+
+    tal_mutex_lock(sg_imu.sub_mutex);
+    for (i = 0; i < TDL_IMU_SUBSCRIBER_MAX; i++) {
+        if (NULL == sg_imu.subs[i].cb) {
+            sg_imu.subs[i].cb = cb;
+            sg_imu.subs[i].arg = arg;
+            rt = OPRT_OK;
+            break;
+        }
+    }
+    tal_mutex_unlock(sg_imu.sub_mutex);
+
+    return rt;
+}
+
+OPERATE_RET tdl_imu_unsubscribe(TDL_IMU_SAMPLE_CB cb, void *arg)
+{
+    OPERATE_RET rt = OPRT_NOT_FOUND;
+    uint32_t i = 0;
+
+    if (NULL == sg_imu.sub_mutex) {
+        return OPRT_NOT_FOUND;
+    }
+
+    tal_mutex_lock(sg_imu.sub_mutex);
+    for (i = 0; i < TDL_IMU_SUBSCRIBER_MAX; i++) {
+        if (cb == sg_imu.subs[i].cb && arg == sg_imu.subs[i].arg) {
+            sg_imu.subs[i].cb = NULL;
+            sg_imu.subs[i].arg = NULL;
+            rt = OPRT_OK;
+            break;
+        }
+    }
+    tal_mutex_unlock(sg_imu.sub_mutex);
+
+    return rt;
+}
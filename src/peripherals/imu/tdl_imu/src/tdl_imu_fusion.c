@@ -0,0 +1,446 @@
+/**
+ * @file tdl_imu_fusion.c
+ * @brief Fixed point attitude and gesture detection on the IMU service batches
+ *
+ * Units inside: accel in mg, rates in rad/s Q20, the quaternion and unit
+ * vectors in Q30, angles in centidegrees. Products go through int64. atan is
+ * the quadratic approximation, well under a degree off, which is plenty for
+ * roll, pitch and the tilt angle.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include "tal_api.h"
+
+#include "tdl_imu_fusion.h"
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define Q30_ONE (1 << 30)
+
+// rates under this are still, about 3 dps, Q20
+#define FUSION_STILL_GYR_Q20 52429
+// time after a still period an upward push counts as a pick-up
+#define FUSION_PICKUP_WINDOW_MS 500
+// the push lasts this long, a tap on the table is shorter
+#define FUSION_PICKUP_PUSH_MS 30
+// a step between samples longer than this is a gap, not integrated
+#define FUSION_DT_MAX_US 100000
+
+#define FUSION_GESTURE_PENDING_MAX 4
+
+#define FUSION_ABS(x) (((x) < 0) ? -(x) : (x))
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    TDL_IMU_GESTURE_E gesture;
+    uint64_t time_us;
+} FUSION_GESTURE_T;
+
+typedef struct {
+    bool running;
+    TDL_IMU_FUSION_CFG_T cfg;
+    MUTEX_HANDLE mutex;
+
+    int32_t acc_k; // raw to mg, Q16
+    int32_t gyr_k; // raw to rad/s Q20, Q16
+
+    int32_t q[4];    // Q30
+    int32_t ei[3];   // integral correction, rad/s Q20
+    int32_t grav[3]; // gravity in the sensor frame from q, Q30
+    int32_t ref[3];  // tilt reference, Q30
+    bool has_ref;
+    uint64_t last_us;
+    bool has_last;
+
+    uint64_t holdoff_until;
+    bool tap_on;
+    uint64_t tap_start;
+    int8_t shake_sign;
+    uint8_t shake_peaks;
+    uint64_t shake_start;
+    bool tilt_on;
+    bool tilt_reported;
+    uint64_t tilt_start;
+    bool still_on;
+    bool rested;
+    bool push_on;
+    uint64_t still_start;
+    uint64_t move_start;
+    uint64_t push_start;
+
+    FUSION_GESTURE_T pending[FUSION_GESTURE_PENDING_MAX];
+    uint8_t pending_num;
+} FUSION_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static FUSION_T sg_fusion;
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static uint32_t __isqrt64(uint64_t v)
+{
+    uint64_t res = 0, bit = 1ULL << 62;
+
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= res + bit) {
+            v -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)res;
+}
+
+// atan of r in [0, 1] Q15, centidegree: 45r + 15.64r(1 - r) degrees
+static int32_t __atan_cd(int64_t r)
+{
+    return (int32_t)((4500 * r >> 15) + (1564 * r * (32768 - r) >> 30));
+}
+
+static int32_t __atan2_cd(int64_t y, int64_t x)
+{
+    int64_t ax = FUSION_ABS(x), ay = FUSION_ABS(y);
+    int32_t a = 0;
+
+    if (0 == ax && 0 == ay) {
+        return 0;
+    }
+    if (ax >= ay) {
+        a = __atan_cd((ay << 15) / ax);
+    } else {
+        a = 9000 - __atan_cd((ax << 15) / ay);
+    }
+    if (x < 0) {
+        a = 18000 - a;
+    }
+
+    return (y < 0) ? -a : a;
+}
+
+static void __fusion_emit(TDL_IMU_GESTURE_E gesture, uint64_t time_us)
+{
+    if (time_us < sg_fusion.holdoff_until || sg_fusion.pending_num >= FUSION_GESTURE_PENDING_MAX) {
+        return;
+    }
+
+    sg_fusion.holdoff_until = time_us + TDL_IMU_GESTURE_HOLDOFF_MS * 1000ULL;
+    sg_fusion.pending[sg_fusion.pending_num].gesture = gesture;
+    sg_fusion.pending[sg_fusion.pending_num].time_us = time_us;
+    sg_fusion.pending_num++;
+}
+
+static void __fusion_update(const int32_t a[3], int32_t g[3], uint32_t dt_us)
+{
+    int32_t *q = sg_fusion.q;
+    int32_t *v = sg_fusion.grav;
+    int32_t h[3], dq[4];
+    uint32_t norm = 0, i = 0;
+
+    norm = __isqrt64((uint64_t)((int64_t)a[0] * a[0] + (int64_t)a[1] * a[1] + (int64_t)a[2] * a[2]));
+    // the accel only points to gravity when the device is not accelerating
+    if (norm > 0 && FUSION_ABS((int32_t)norm - 1000) < TDL_IMU_FUSION_ACC_GATE_MG) {
+        int32_t an[3], e[3];
+
+        for (i = 0; i < 3; i++) {
+            an[i] = (int32_t)(((int64_t)a[i] << 30) / norm);
+        }
+        e[0] = (int32_t)(((int64_t)an[1] * v[2] - (int64_t)an[2] * v[1]) >> 30);
+        e[1] = (int32_t)(((int64_t)an[2] * v[0] - (int64_t)an[0] * v[2]) >> 30);
+        e[2] = (int32_t)(((int64_t)an[0] * v[1] - (int64_t)an[1] * v[0]) >> 30);
+
+        for (i = 0; i < 3; i++) {
+            // e is Q30, >> 10 gives rad/s Q20 at a gain of 1.0
+            sg_fusion.ei[i] += (int32_t)((int64_t)(e[i] >> 10) * TDL_IMU_FUSION_KI * dt_us / (256 * 1000000LL));
+            g[i] += (int32_t)((int64_t)(e[i] >> 10) * TDL_IMU_FUSION_KP >> 8) + sg_fusion.ei[i];
+        }
+    }
+
+    // half the rotation of the step, Q30 rad
+    for (i = 0; i < 3; i++) {
+        h[i] = (int32_t)((int64_t)g[i] * dt_us * 512 / 1000000);
+    }
+
+    dq[0] = (int32_t)((-(int64_t)q[1] * h[0] - (int64_t)q[2] * h[1] - (int64_t)q[3] * h[2]) >> 30);
+    dq[1] = (int32_t)(((int64_t)q[0] * h[0] + (int64_t)q[2] * h[2] - (int64_t)q[3] * h[1]) >> 30);
+    dq[2] = (int32_t)(((int64_t)q[0] * h[1] - (int64_t)q[1] * h[2] + (int64_t)q[3] * h[0]) >> 30);
+    dq[3] = (int32_t)(((int64_t)q[0] * h[2] + (int64_t)q[1] * h[1] - (int64_t)q[2] * h[0]) >> 30);
+    for (i = 0; i < 4; i++) {
+        q[i] += dq[i];
+    }
+
+    norm = __isqrt64((uint64_t)((int64_t)q[0] * q[0] + (int64_t)q[1] * q[1] + (int64_t)q[2] * q[2] +
+                                (int64_t)q[3] * q[3]));
+    if (0 == norm) {
+        q[0] = Q30_ONE;
+        q[1] = q[2] = q[3] = 0;
+    } else {
+        for (i = 0; i < 4; i++) {
+            q[i] = (int32_t)(((int64_t)q[i] << 30) / norm);
+        }
+    }
+
+    v[0] = (int32_t)(((int64_t)q[1] * q[3] - (int64_t)q[0] * q[2]) >> 29);
+    v[1] = (int32_t)(((int64_t)q[0] * q[1] + (int64_t)q[2] * q[3]) >> 29);
+    v[2] = (int32_t)(((int64_t)q[0] * q[0] - (int64_t)q[1] * q[1] - (int64_t)q[2] * q[2] + (int64_t)q[3] * q[3]) >>
+                     30);
+}
+
+static void __fusion_tilt(uint64_t t)
+{
+    const int32_t *v = sg_fusion.grav, *r = sg_fusion.ref;
+    int64_t c[3], dot = 0;
+    int32_t angle = 0, i = 0;
+
+    if (!sg_fusion.has_ref) {
+        return;
+    }
+
+    // angle to the reference from the cross and dot products, in Q28 against overflow
+    c[0] = ((int64_t)v[1] * r[2] - (int64_t)v[2] * r[1]) >> 32;
+    c[1] = ((int64_t)v[2] * r[0] - (int64_t)v[0] * r[2]) >> 32;
+    c[2] = ((int64_t)v[0] * r[1] - (int64_t)v[1] * r[0]) >> 32;
+    for (i = 0; i < 3; i++) {
+        dot += (int64_t)v[i] * r[i];
+    }
+    angle = __atan2_cd(__isqrt64((uint64_t)(c[0] * c[0] + c[1] * c[1] + c[2] * c[2])), dot >> 32);
+
+    if (angle > TDL_IMU_TILT_DEG * 100) {
+        if (!sg_fusion.tilt_on) {
+            sg_fusion.tilt_on = true;
+            sg_fusion.tilt_start = t;
+        } else if (!sg_fusion.tilt_reported && t - sg_fusion.tilt_start >= TDL_IMU_TILT_HOLD_MS * 1000ULL) {
+            sg_fusion.tilt_reported = true;
+            __fusion_emit(TDL_IMU_GESTURE_TILT, t);
+        }
+    } else if (angle < TDL_IMU_TILT_DEG * 75) {
+        // re-armed a quarter of the angle back
+        sg_fusion.tilt_on = false;
+        sg_fusion.tilt_reported = false;
+    }
+}
+
+static void __fusion_gesture(const int32_t a[3], const int32_t g[3], uint64_t t)
+{
+    const int32_t *v = sg_fusion.grav;
+    int32_t lin[3], dyn = 0, up = 0, peak = 0;
+    uint32_t norm = 0, i = 0, axis = 0;
+    int8_t sign = 0;
+
+    norm = __isqrt64((uint64_t)((int64_t)a[0] * a[0] + (int64_t)a[1] * a[1] + (int64_t)a[2] * a[2]));
+    dyn = FUSION_ABS((int32_t)norm - 1000);
+    for (i = 0; i < 3; i++) {
+        lin[i] = a[i] - (int32_t)((int64_t)v[i] * 1000 >> 30);
+        up += (int32_t)((int64_t)a[i] * v[i] >> 30);
+        if (FUSION_ABS(lin[i]) > FUSION_ABS(lin[axis])) {
+            axis = i;
+        }
+    }
+    up -= 1000;
+
+    // tap, a short spike
+    if (!sg_fusion.tap_on && dyn > TDL_IMU_TAP_MG) {
+        sg_fusion.tap_on = true;
+        sg_fusion.tap_start = t;
+    } else if (sg_fusion.tap_on && dyn < TDL_IMU_TAP_MG / 2) {
+        sg_fusion.tap_on = false;
+        if (t - sg_fusion.tap_start <= TDL_IMU_TAP_MAX_MS * 1000ULL) {
+            __fusion_emit(TDL_IMU_GESTURE_TAP, t);
+        }
+    }
+
+    // shake, peaks of alternating sign on the strongest axis
+    peak = lin[axis];
+    if (FUSION_ABS(peak) > TDL_IMU_SHAKE_MG) {
+        sign = (peak > 0) ? 1 : -1;
+        if (sign != sg_fusion.shake_sign) {
+            if (0 == sg_fusion.shake_peaks || t - sg_fusion.shake_start > TDL_IMU_SHAKE_WINDOW_MS * 1000ULL) {
+                sg_fusion.shake_start = t;
+                sg_fusion.shake_peaks = 1;
+            } else {
+                sg_fusion.shake_peaks++;
+            }
+            sg_fusion.shake_sign = sign;
+            if (sg_fusion.shake_peaks >= TDL_IMU_SHAKE_PEAKS) {
+                sg_fusion.shake_peaks = 0;
+                sg_fusion.shake_sign = 0;
+                __fusion_emit(TDL_IMU_GESTURE_SHAKE, t);
+            }
+        }
+    }
+
+    __fusion_tilt(t);
+
+    // pick-up, an upward push soon after a still period
+    if (dyn < TDL_IMU_STILL_MG && FUSION_ABS(g[0]) + FUSION_ABS(g[1]) + FUSION_ABS(g[2]) < FUSION_STILL_GYR_Q20) {
+        if (!sg_fusion.still_on) {
+            sg_fusion.still_on = true;
+            sg_fusion.still_start = t;
+        } else if (t - sg_fusion.still_start >= TDL_IMU_STILL_MS * 1000ULL) {
+            sg_fusion.rested = true;
+            if (!sg_fusion.has_ref) {
+                memcpy(sg_fusion.ref, sg_fusion.grav, sizeof(sg_fusion.ref));
+                sg_fusion.has_ref = true;
+            }
+        }
+    } else {
+        if (sg_fusion.still_on) {
+            sg_fusion.still_on = false;
+            sg_fusion.move_start = t;
+        }
+        if (sg_fusion.rested) {
+            if (up > TDL_IMU_PICKUP_MG && dyn < TDL_IMU_TAP_MG) {
+                if (!sg_fusion.push_on) {
+                    sg_fusion.push_on = true;
+                    sg_fusion.push_start = t;
+                } else if (t - sg_fusion.push_start >= FUSION_PICKUP_PUSH_MS * 1000ULL) {
+                    sg_fusion.rested = false;
+                    __fusion_emit(TDL_IMU_GESTURE_PICK_UP, t);
+                }
+            } else {
+                sg_fusion.push_on = false;
+            }
+            if (sg_fusion.rested && t - sg_fusion.move_start > FUSION_PICKUP_WINDOW_MS * 1000ULL) {
+                sg_fusion.rested = false;
+            }
+        }
+        if (!sg_fusion.rested) {
+            sg_fusion.push_on = false;
+        }
+    }
+}
+
+static void __fusion_batch_cb(const TDL_IMU_SAMPLE_T *samples, uint16_t num, void *arg)
+{
+    FUSION_GESTURE_T pending[FUSION_GESTURE_PENDING_MAX];
+    uint8_t pending_num = 0;
+    int32_t a[3], g[3];
+    uint32_t dt_us = 0;
+    uint16_t i = 0, j = 0;
+
+    (void)arg;
+
+    tal_mutex_lock(sg_fusion.mutex);
+    for (i = 0; i < num; i++) {
+        for (j = 0; j < 3; j++) {
+            a[j] = (int32_t)((int64_t)samples[i].acc[j] * sg_fusion.acc_k >> 16);
+            g[j] = (int32_t)((int64_t)samples[i].gyr[j] * sg_fusion.gyr_k >> 16);
+        }
+
+        dt_us = 0;
+        if (sg_fusion.has_last && samples[i].time_us > sg_fusion.last_us &&
+            samples[i].time_us - sg_fusion.last_us < FUSION_DT_MAX_US) {
+            dt_us = (uint32_t)(samples[i].time_us - sg_fusion.last_us);
+        }
+        sg_fusion.last_us = samples[i].time_us;
+        sg_fusion.has_last = true;
+
+        __fusion_gesture(a, g, samples[i].time_us);
+        __fusion_update(a, g, dt_us);
+    }
+
+    pending_num = sg_fusion.pending_num;
+    memcpy(pending, sg_fusion.pending, pending_num * sizeof(FUSION_GESTURE_T));
+    sg_fusion.pending_num = 0;
+    tal_mutex_unlock(sg_fusion.mutex);
+
+    // outside the lock so the callback can read the attitude
+    for (i = 0; i < pending_num && sg_fusion.cfg.gesture_cb; i++) {
+        sg_fusion.cfg.gesture_cb(pending[i].gesture, pending[i].time_us, sg_fusion.cfg.arg);
+    }
+}
+
+OPERATE_RET tdl_imu_fusion_start(const TDL_IMU_FUSION_CFG_T *cfg)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    TUYA_CHECK_NULL_RETURN(cfg, OPRT_INVALID_PARM);
+    if (0 == cfg->acc_range_g || cfg->acc_range_g > 16 || 0 == cfg->gyr_range_dps || cfg->gyr_range_dps > 2000) {
+        return OPRT_INVALID_PARM;
+    }
+    if (sg_fusion.running) {
+        return OPRT_COM_ERROR;
+    }
+
+    if (NULL == sg_fusion.mutex) {
+        TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&sg_fusion.mutex));
+    }
+
+    tal_mutex_lock(sg_fusion.mutex);
+    MUTEX_HANDLE mutex = sg_fusion.mutex;
+    memset(&sg_fusion, 0, sizeof(FUSION_T));
+    sg_fusion.mutex = mutex;
+    memcpy(&sg_fusion.cfg, cfg, sizeof(TDL_IMU_FUSION_CFG_T));
+    // full scale of 32768 LSB: mg = raw * range * 1000 / 32768, rad/s = raw * range * pi / 180 / 32768
+    sg_fusion.acc_k = cfg->acc_range_g * 2000;
+    sg_fusion.gyr_k = cfg->gyr_range_dps * 36603;
+    sg_fusion.q[0] = Q30_ONE;
+    sg_fusion.grav[2] = Q30_ONE;
+    tal_mutex_unlock(sg_fusion.mutex);
+
+    TUYA_CALL_ERR_RETURN(tdl_imu_subscribe(__fusion_batch_cb, NULL));
+    sg_fusion.running = true;
+
+    return rt;
+}
+
+OPERATE_RET tdl_imu_fusion_stop(void)
+{
+    if (!sg_fusion.running) {
+        return OPRT_OK;
+    }
+
+    sg_fusion.running = false;
+
+    return tdl_imu_unsubscribe(__fusion_batch_cb, NULL);
+}
+
+OPERATE_RET tdl_imu_fusion_get_attitude(TDL_IMU_ATTITUDE_T *attitude)
+{
+    int32_t v[3];
+
+    TUYA_CHECK_NULL_RETURN(attitude, OPRT_INVALID_PARM);
+    if (NULL == sg_fusion.mutex) {
+        return OPRT_COM_ERROR;
+    }
+
+    tal_mutex_lock(sg_fusion.mutex);
+    memcpy(attitude->q, sg_fusion.q, sizeof(attitude->q));
+    memcpy(v, sg_fusion.grav, sizeof(v));
+    tal_mutex_unlock(sg_fusion.mutex);
+
+    attitude->roll_cd = (int16_t)__atan2_cd(v[1], v[2]);
+    attitude->pitch_cd =
+        (int16_t)__atan2_cd(-(int64_t)v[0], __isqrt64((uint64_t)((int64_t)v[1] * v[1] + (int64_t)v[2] * v[2])));
+
+    return OPRT_OK;
+}
+
+OPERATE_RET tdl_imu_fusion_set_tilt_ref(void)
+{
+    if (NULL == sg_fusion.mutex) {
+        return OPRT_COM_ERROR;
+    }
+
+    tal_mutex_lock(sg_fusion.mutex);
+    memcpy(sg_fusion.ref, sg_fusion.grav, sizeof(sg_fusion.ref));
+    sg_fusion.has_ref = true;
+    sg_fusion.tilt_on = false;
+    sg_fusion.tilt_reported = false;
+    tal_mutex_unlock(sg_fusion.mutex);
+
+    return OPRT_OK;
+}
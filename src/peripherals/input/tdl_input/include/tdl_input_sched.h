@@ -0,0 +1,187 @@
+/**
+ * @file tdl_input_sched.h
+ * @brief Shared sampling scheduler and event queue for input devices.
+ *
+ * Buttons, joysticks, encoders and touch panels are sampled from one thread
+ * instead of a polling thread each. Every source registers a sample callback
+ * with its own period, the callbacks are kept on a timer wheel with a fixed
+ * tick. A source that is idle can park itself and be woken again by an
+ * interrupt, the thread sleeps without a tick while every source is parked.
+ *
+ * Sources may also post what they detect to a common event queue, which lets
+ * a GUI read all its input from one place instead of polling each driver.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __TDL_INPUT_SCHED_H__
+#define __TDL_INPUT_SCHED_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+// wheel resolution, sample periods are rounded up to a whole tick
+#ifndef TDL_INPUT_SCHED_TICK_MS
+#define TDL_INPUT_SCHED_TICK_MS 5
+#endif
+
+#ifndef TDL_INPUT_SCHED_WHEEL_SLOTS
+#define TDL_INPUT_SCHED_WHEEL_SLOTS 32
+#endif
+
+#ifndef TDL_INPUT_SCHED_STACK_SIZE
+#define TDL_INPUT_SCHED_STACK_SIZE (4096)
+#endif
+
+#ifndef TDL_INPUT_EVENT_QUEUE_DEPTH
+#define TDL_INPUT_EVENT_QUEUE_DEPTH 16
+#endif
+
+#define TDL_INPUT_SRC_BIT(src) (1UL << (src))
+
+// encoder and touch event codes, buttons and joysticks post their own event enums
+#define TDL_INPUT_EV_PRESS   0x00
+#define TDL_INPUT_EV_RELEASE 0x01
+#define TDL_INPUT_EV_MOVE    0x02 // touch moved, or encoder turned by x steps
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef void *TDL_INPUT_SCHED_HANDLE;
+
+/**
+ * @brief Samples one input source, called from the scheduler thread.
+ *
+ * @param arg The arg given to tdl_input_sched_add().
+ *
+ * @return true to be sampled again after one period, false to park until
+ *         tdl_input_sched_kick() is called.
+ */
+typedef bool (*TDL_INPUT_SAMPLE_CB)(void *arg);
+
+typedef enum {
+    TDL_INPUT_SRC_BUTTON = 0,
+    TDL_INPUT_SRC_JOYSTICK,
+    TDL_INPUT_SRC_ENCODER,
+    TDL_INPUT_SRC_TOUCH,
+    TDL_INPUT_SRC_MAX,
+} TDL_INPUT_SRC_E;
+
+typedef struct {
+    TDL_INPUT_SRC_E src;
+    uint8_t event;    // TDL_INPUT_EV_*, or the button / joystick event
+    int16_t x;        // touch position, encoder steps
+    int16_t y;
+    void *dev;        // device handle or name, as the source defines it
+    uint32_t time_ms; // tal_system_get_millisecond() when it was detected
+} TDL_INPUT_EVENT_T;
+
+typedef struct {
+    uint32_t posted;
+    uint32_t dropped; // posted while the queue was full
+} TDL_INPUT_EVENT_STATS_T;
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+
+/**
+ * @brief Adds a sample callback, the scheduler thread is started on the first one.
+ *
+ * Callbacks run one after another on the scheduler thread, they must not
+ * block. A callback may remove itself.
+ *
+ * @param cb The sample callback.
+ * @param arg Passed to cb.
+ * @param period_ms Sample period.
+ * @param is_parked true to wait for the first tdl_input_sched_kick().
+ * @param handle Set to the new entry.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_input_sched_add(TDL_INPUT_SAMPLE_CB cb, void *arg, uint16_t period_ms, bool is_parked,
+                                TDL_INPUT_SCHED_HANDLE *handle);
+
+/**
+ * @brief Removes a sample callback, it is not called again once this returns
+ *        unless it is running right now.
+ *
+ * @param handle The entry.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_input_sched_remove(TDL_INPUT_SCHED_HANDLE handle);
+
+/**
+ * @brief Samples a parked entry as soon as possible, safe from an interrupt.
+ *
+ * @param handle The entry.
+ *
+ * @return None.
+ */
+void tdl_input_sched_kick(TDL_INPUT_SCHED_HANDLE handle);
+
+/**
+ * @brief Raises the stack of the scheduler thread, before it is started.
+ *
+ * Sample callbacks call the user event callbacks of their drivers, the
+ * largest size asked for is used.
+ *
+ * @param size Stack size in bytes.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_input_sched_set_stack_size(uint32_t size);
+
+/**
+ * @brief Creates the event queue and adds sources that post to it.
+ *
+ * Events of other sources are dropped without touching the queue, nothing is
+ * queued before this is called. Each call adds to the sources already chosen.
+ *
+ * @param src_mask TDL_INPUT_SRC_BIT() of each source.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_input_event_subscribe(uint32_t src_mask);
+
+/**
+ * @brief Posts an event without blocking, it is dropped when the queue is full.
+ *
+ * @param event The event, time_ms is filled in when it is 0.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_input_event_post(TDL_INPUT_EVENT_T *event);
+
+/**
+ * @brief Takes the oldest event.
+ *
+ * @param event Filled with the event.
+ * @param timeout_ms 0 returns at once.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_input_event_read(TDL_INPUT_EVENT_T *event, uint32_t timeout_ms);
+
+/**
+ * @brief Reads the event queue counters.
+ *
+ * @param stats Filled with the counters.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_input_event_get_stats(TDL_INPUT_EVENT_STATS_T *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TDL_INPUT_SCHED_H__ */
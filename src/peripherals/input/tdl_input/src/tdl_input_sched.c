@@ -0,0 +1,451 @@
+/**
+ * @file tdl_input_sched.c
+ * @brief Shared sampling scheduler and event queue for input devices.
+ *
+ * One thread walks a timer wheel of TDL_INPUT_SCHED_WHEEL_SLOTS slots, one
+ * slot per tick. An entry sits in the slot of its next sample, with the number
+ * of full turns still to wait when its period is longer than the wheel. Due
+ * entries are moved off the wheel and called without the scheduler lock held,
+ * so a callback may add, remove or kick entries.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include "tuya_cloud_types.h"
+#include "tal_api.h"
+#include "tuya_list.h"
+
+#include "tdl_input_sched.h"
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define INPUT_SCHED_RESYNC_MS (TDL_INPUT_SCHED_TICK_MS * TDL_INPUT_SCHED_WHEEL_SLOTS)
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    LIST_HEAD node; // wheel slot, due list or parked list
+    TDL_INPUT_SAMPLE_CB cb;
+    void *arg;
+    uint16_t period_tick;
+    uint16_t rounds;
+    volatile uint8_t is_kicked;
+    uint8_t is_on_wheel;
+    uint8_t is_removed;
+} INPUT_SCHED_ENTRY_T;
+
+typedef struct {
+    MUTEX_HANDLE mutex;
+    SEM_HANDLE sem;
+    THREAD_HANDLE thrd;
+    uint32_t stack_size;
+
+    LIST_HEAD slot[TDL_INPUT_SCHED_WHEEL_SLOTS];
+    LIST_HEAD parked;
+    uint16_t cur;       // slot of the next tick
+    uint16_t wheel_cnt; // entries on the wheel
+    uint32_t next_ms;   // time of the next tick
+    INPUT_SCHED_ENTRY_T *running;
+    TAL_SLEEP_CLIENT_HANDLE sleep_client;
+} INPUT_SCHED_T;
+
+typedef struct {
+    QUEUE_HANDLE queue;
+    uint32_t src_mask;
+    TDL_INPUT_EVENT_STATS_T stats;
+} INPUT_EVENT_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static INPUT_SCHED_T sg_sched = {.stack_size = TDL_INPUT_SCHED_STACK_SIZE};
+static INPUT_EVENT_T sg_event;
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+// puts an entry on the wheel, it is due on the delay_tick-th tick from now
+static void __input_sched_insert(INPUT_SCHED_ENTRY_T *entry, uint16_t delay_tick)
+{
+    uint16_t slot = 0;
+
+    if (0 == delay_tick) {
+        delay_tick = 1;
+    }
+
+    if (0 == sg_sched.wheel_cnt) {
+        sg_sched.next_ms = tal_system_get_millisecond() + TDL_INPUT_SCHED_TICK_MS;
+    }
+
+    slot = (sg_sched.cur + delay_tick - 1) % TDL_INPUT_SCHED_WHEEL_SLOTS;
+    entry->rounds = (delay_tick - 1) / TDL_INPUT_SCHED_WHEEL_SLOTS;
+    entry->is_on_wheel = 1;
+    tuya_list_add_tail(&entry->node, &sg_sched.slot[slot]);
+    sg_sched.wheel_cnt++;
+}
+
+// moves the entries of the current slot that are due this turn to the due list
+static void __input_sched_take_slot(LIST_HEAD *due)
+{
+    LIST_HEAD *pos = NULL, *next = NULL;
+    INPUT_SCHED_ENTRY_T *entry = NULL;
+
+    tuya_list_for_each_safe(pos, next, &sg_sched.slot[sg_sched.cur])
+    {
+        entry = tuya_list_entry(pos, INPUT_SCHED_ENTRY_T, node);
+        if (entry->rounds) {
+            entry->rounds--;
+            continue;
+        }
+        tuya_list_del(&entry->node);
+        entry->is_on_wheel = 0;
+        sg_sched.wheel_cnt--;
+        tuya_list_add_tail(&entry->node, due);
+    }
+
+    sg_sched.cur = (sg_sched.cur + 1) % TDL_INPUT_SCHED_WHEEL_SLOTS;
+}
+
+static void __input_sched_take_kicked(LIST_HEAD *due)
+{
+    LIST_HEAD *pos = NULL, *next = NULL;
+    INPUT_SCHED_ENTRY_T *entry = NULL;
+
+    tuya_list_for_each_safe(pos, next, &sg_sched.parked)
+    {
+        entry = tuya_list_entry(pos, INPUT_SCHED_ENTRY_T, node);
+        if (entry->is_kicked) {
+            tuya_list_del(&entry->node);
+            tuya_list_add_tail(&entry->node, due);
+        }
+    }
+}
+
+// called and returned with the lock held, the lock is dropped around each callback
+static void __input_sched_run(LIST_HEAD *due)
+{
+    INPUT_SCHED_ENTRY_T *entry = NULL;
+    bool is_keep = false;
+
+    while (!tuya_list_empty(due)) {
+        entry = tuya_list_entry(due->next, INPUT_SCHED_ENTRY_T, node);
+        tuya_list_del(&entry->node);
+        entry->is_kicked = 0;
+        sg_sched.running = entry;
+        tal_mutex_unlock(sg_sched.mutex);
+
+        is_keep = entry->cb(entry->arg);
+
+        tal_mutex_lock(sg_sched.mutex);
+        sg_sched.running = NULL;
+        if (entry->is_removed) {
+            tal_free(entry);
+            continue;
+        }
+
+        if (is_keep) {
+            __input_sched_insert(entry, entry->period_tick);
+        } else {
+            // a kick that came in during the callback is picked up on the next pass
+            tuya_list_add_tail(&entry->node, &sg_sched.parked);
+        }
+    }
+}
+
+static void __input_sched_task(void *args)
+{
+    LIST_HEAD due;
+    uint32_t now = 0, wait_ms = 0;
+
+    for (;;) {
+        tal_mutex_lock(sg_sched.mutex);
+        if (0 == sg_sched.wheel_cnt) {
+            // every entry is parked, only a kick or an add wakes the thread
+            wait_ms = SEM_WAIT_FOREVER;
+        } else {
+            now = tal_system_get_millisecond();
+            wait_ms = ((int32_t)(sg_sched.next_ms - now) > 0) ? (sg_sched.next_ms - now) : 0;
+        }
+        tal_mutex_unlock(sg_sched.mutex);
+
+        if (wait_ms) {
+            tal_semaphore_wait(sg_sched.sem, wait_ms);
+        }
+
+        INIT_LIST_HEAD(&due);
+
+        tal_mutex_lock(sg_sched.mutex);
+        __input_sched_take_kicked(&due);
+
+        now = tal_system_get_millisecond();
+        if (sg_sched.wheel_cnt && (int32_t)(now - sg_sched.next_ms) >= 0) {
+            __input_sched_take_slot(&due);
+            sg_sched.next_ms += TDL_INPUT_SCHED_TICK_MS;
+            // after a long stall start over instead of replaying every missed tick
+            if ((int32_t)(now - sg_sched.next_ms) >= INPUT_SCHED_RESYNC_MS) {
+                sg_sched.next_ms = now + TDL_INPUT_SCHED_TICK_MS;
+            }
+        }
+
+        __input_sched_run(&due);
+        tal_mutex_unlock(sg_sched.mutex);
+    }
+}
+
+// the next tick for the sleep coordinator, nothing while every entry is parked
+static uint32_t __input_sched_deadline(void *arg)
+{
+    uint32_t now = 0, ms = TAL_SLEEP_NO_DEADLINE;
+
+    tal_mutex_lock(sg_sched.mutex);
+    if (sg_sched.wheel_cnt) {
+        now = tal_system_get_millisecond();
+        ms = ((int32_t)(sg_sched.next_ms - now) > 0) ? (sg_sched.next_ms - now) : 0;
+    }
+    tal_mutex_unlock(sg_sched.mutex);
+
+    return ms;
+}
+
+static OPERATE_RET __input_sched_init(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint16_t i = 0;
+
+    if (sg_sched.thrd) {
+        return OPRT_OK;
+    }
+
+    if (NULL == sg_sched.mutex) {
+        TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&sg_sched.mutex));
+    }
+
+    if (NULL == sg_sched.sem) {
+        TUYA_CALL_ERR_RETURN(tal_semaphore_create_init(&sg_sched.sem, 0, 1));
+    }
+
+    for (i = 0; i < TDL_INPUT_SCHED_WHEEL_SLOTS; i++) {
+        INIT_LIST_HEAD(&sg_sched.slot[i]);
+    }
+    INIT_LIST_HEAD(&sg_sched.parked);
+
+    THREAD_CFG_T thrd_cfg = {
+        .thrdname = "input_sched",
+        .priority = THREAD_PRIO_1,
+        .stackDepth = sg_sched.stack_size,
+    };
+    TUYA_CALL_ERR_RETURN(
+        tal_thread_create_and_start(&sg_sched.thrd, NULL, NULL, __input_sched_task, NULL, &thrd_cfg));
+
+    if (NULL == sg_sched.sleep_client) {
+        tal_cpu_sleep_client_register("input", __input_sched_deadline, NULL, &sg_sched.sleep_client);
+    }
+
+    PR_DEBUG("input sched stack size:%d", sg_sched.stack_size);
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Adds a sample callback, the scheduler thread is started on the first one.
+ *
+ * @param cb The sample callback.
+ * @param arg Passed to cb.
+ * @param period_ms Sample period.
+ * @param is_parked true to wait for the first tdl_input_sched_kick().
+ * @param handle Set to the new entry.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_input_sched_add(TDL_INPUT_SAMPLE_CB cb, void *arg, uint16_t period_ms, bool is_parked,
+                                TDL_INPUT_SCHED_HANDLE *handle)
+{
+    OPERATE_RET rt = OPRT_OK;
+    INPUT_SCHED_ENTRY_T *entry = NULL;
+
+    TUYA_CHECK_NULL_RETURN(cb, OPRT_INVALID_PARM);
+    TUYA_CHECK_NULL_RETURN(handle, OPRT_INVALID_PARM);
+
+    TUYA_CALL_ERR_RETURN(__input_sched_init());
+
+    entry = (INPUT_SCHED_ENTRY_T *)tal_malloc(sizeof(INPUT_SCHED_ENTRY_T));
+    TUYA_CHECK_NULL_RETURN(entry, OPRT_MALLOC_FAILED);
+    memset(entry, 0, sizeof(INPUT_SCHED_ENTRY_T));
+
+    entry->cb = cb;
+    entry->arg = arg;
+    entry->period_tick = (period_ms + TDL_INPUT_SCHED_TICK_MS - 1) / TDL_INPUT_SCHED_TICK_MS;
+
+    tal_mutex_lock(sg_sched.mutex);
+    if (is_parked) {
+        tuya_list_add_tail(&entry->node, &sg_sched.parked);
+    } else {
+        __input_sched_insert(entry, entry->period_tick);
+    }
+    tal_mutex_unlock(sg_sched.mutex);
+
+    // the thread may be waiting without a tick
+    tal_semaphore_post(sg_sched.sem);
+
+    *handle = (TDL_INPUT_SCHED_HANDLE)entry;
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Removes a sample callback.
+ *
+ * @param handle The entry.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_input_sched_remove(TDL_INPUT_SCHED_HANDLE handle)
+{
+    INPUT_SCHED_ENTRY_T *entry = (INPUT_SCHED_ENTRY_T *)handle;
+
+    TUYA_CHECK_NULL_RETURN(entry, OPRT_INVALID_PARM);
+
+    tal_mutex_lock(sg_sched.mutex);
+    if (entry == sg_sched.running) {
+        // freed by the thread once the callback returns
+        entry->is_removed = 1;
+    } else {
+        tuya_list_del(&entry->node);
+        if (entry->is_on_wheel) {
+            sg_sched.wheel_cnt--;
+        }
+        tal_free(entry);
+    }
+    tal_mutex_unlock(sg_sched.mutex);
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Samples a parked entry as soon as possible, safe from an interrupt.
+ *
+ * @param handle The entry.
+ *
+ * @return None.
+ */
+void tdl_input_sched_kick(TDL_INPUT_SCHED_HANDLE handle)
+{
+    INPUT_SCHED_ENTRY_T *entry = (INPUT_SCHED_ENTRY_T *)handle;
+
+    if (NULL == entry) {
+        return;
+    }
+
+    entry->is_kicked = 1;
+    tal_semaphore_post(sg_sched.sem);
+}
+
+/**
+ * @brief Raises the stack of the scheduler thread, before it is started.
+ *
+ * @param size Stack size in bytes.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_input_sched_set_stack_size(uint32_t size)
+{
+    if (sg_sched.thrd) {
+        return (size <= sg_sched.stack_size) ? OPRT_OK : OPRT_COM_ERROR;
+    }
+
+    if (size > sg_sched.stack_size) {
+        sg_sched.stack_size = size;
+    }
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Creates the event queue and adds sources that post to it.
+ *
+ * @param src_mask TDL_INPUT_SRC_BIT() of each source.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_input_event_subscribe(uint32_t src_mask)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    if (NULL == sg_event.queue) {
+        TUYA_CALL_ERR_RETURN(
+            tal_queue_create_init(&sg_event.queue, sizeof(TDL_INPUT_EVENT_T), TDL_INPUT_EVENT_QUEUE_DEPTH));
+    }
+
+    sg_event.src_mask |= src_mask;
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Posts an event without blocking, it is dropped when the queue is full.
+ *
+ * @param event The event, time_ms is filled in when it is 0.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_input_event_post(TDL_INPUT_EVENT_T *event)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    TUYA_CHECK_NULL_RETURN(event, OPRT_INVALID_PARM);
+
+    if (NULL == sg_event.queue || 0 == (sg_event.src_mask & TDL_INPUT_SRC_BIT(event->src))) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    if (0 == event->time_ms) {
+        event->time_ms = tal_system_get_millisecond();
+    }
+
+    rt = tal_queue_post(sg_event.queue, event, 0);
+    if (OPRT_OK != rt) {
+        sg_event.stats.dropped++;
+        return rt;
+    }
+    sg_event.stats.posted++;
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Takes the oldest event.
+ *
+ * @param event Filled with the event.
+ * @param timeout_ms 0 returns at once.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_input_event_read(TDL_INPUT_EVENT_T *event, uint32_t timeout_ms)
+{
+    TUYA_CHECK_NULL_RETURN(event, OPRT_INVALID_PARM);
+
+    if (NULL == sg_event.queue) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    return tal_queue_fetch(sg_event.queue, event, timeout_ms);
+}
+
+/**
+ * @brief Reads the event queue counters.
+ *
+ * @param stats Filled with the counters.
+ *
+ * @return OPERATE_RET - OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tdl_input_event_get_stats(TDL_INPUT_EVENT_STATS_T *stats)
+{
+    TUYA_CHECK_NULL_RETURN(stats, OPRT_INVALID_PARM);
+
+    memcpy(stats, &sg_event.stats, sizeof(TDL_INPUT_EVENT_STATS_T));
+
+    return OPRT_OK;
+}
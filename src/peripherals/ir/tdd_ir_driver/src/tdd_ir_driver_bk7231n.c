@@ -37,11 +37,9 @@
 #include "tkl_gpio.h"
 #include "tkl_output.h"
 
-#define EN_TIMER_CAPTURE    0
-
-#if EN_TIMER_CAPTURE
-#include "BkDriverPwm.h"
-#include "pwm_pub.h"
+// IR_DRV_CAPTURE, the receive pin must be a pwm pin
+#ifndef EN_TIMER_CAPTURE
+#define EN_TIMER_CAPTURE    1
 #endif
 
 /***********************************************************
@@ -61,6 +59,8 @@
 
 #define DEF_TIMER_OVERFLOW_MS       (500*1000U) // 500ms
 
+#define IR_RECV_CAPTURE_CLK         (1000000U) // one capture count is 1us
+
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
@@ -84,6 +84,7 @@ typedef struct {
     volatile unsigned int           last_time;
     volatile unsigned int           overflow_cnt;
     unsigned int                    irq_enable_time;
+    volatile TUYA_PWM_POLARITY_E    cap_edge;
 } TDD_IR_RECV_T;
 
 typedef struct {
@@ -443,6 +444,86 @@ static void __tdd_ir_irq_recv_cb(void *drv_handle)
     return;
 }
 
+#if (defined(EN_TIMER_CAPTURE) && (EN_TIMER_CAPTURE==1))
+static int __tdd_ir_recv_capture_start(IR_DRV_INFO_T *drv_info, TUYA_PWM_POLARITY_E edge);
+
+/**
+ * @brief pwm capture callback, the width is latched by the hardware
+ *
+ * Interrupt latency, for example under heavy Wi-Fi load, delays this callback
+ * but does not change the captured value, unlike the gpio irq path which reads
+ * the timer when the callback runs.
+ *
+ * @param[in] port: pwm id
+ * @param[in] data: time since the previous edge, in IR_RECV_CAPTURE_CLK counts
+ * @param[in] arg: driver handle
+ *
+ * @return none
+ */
+static void __tdd_ir_capture_recv_cb(TUYA_PWM_NUM_E port, TUYA_PWM_CAPTURE_DATA_T data, void *arg)
+{
+    IR_DRV_INFO_T *drv_info = NULL;
+    TDD_IR_RECV_T *tdd_recv = NULL;
+
+    if (NULL == arg) {
+        return;
+    }
+    drv_info = (IR_DRV_INFO_T *)arg;
+    tdd_recv = (TDD_IR_RECV_T *)&drv_info->tdd_recv;
+
+    // tdd --data--> tdl
+    if (drv_info->tdl_data.recv_value_cb) {
+        drv_info->tdl_data.recv_value_cb(arg, data.cap_value, drv_info->tdl_data.handle);
+    }
+
+    /* capture the opposite edge next */
+    tkl_pwm_cap_stop(port);
+    __tdd_ir_recv_capture_start(drv_info, (TUYA_PWM_NEGATIVE == tdd_recv->cap_edge) ? TUYA_PWM_POSITIVE : TUYA_PWM_NEGATIVE);
+
+    return;
+}
+
+static int __tdd_ir_recv_capture_start(IR_DRV_INFO_T *drv_info, TUYA_PWM_POLARITY_E edge)
+{
+    TUYA_PWM_CAP_IRQ_T cap_cfg = {
+        .cap_mode = TUYA_PWM_CAPTURE_MODE_PERIOD,
+        .trigger_level = edge,
+        .clk = IR_RECV_CAPTURE_CLK,
+        .cb = __tdd_ir_capture_recv_cb,
+        .arg = (void *)drv_info,
+    };
+
+    drv_info->tdd_recv.cap_edge = edge;
+
+    return tkl_pwm_cap_start(drv_info->tdd_recv.recv_pwm_id, &cap_cfg);
+}
+
+static int __tdd_ir_recv_capture_init(IR_DRV_INFO_T *drv_info)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    /* the receiver output is low while the carrier is present */
+    rt = __tdd_ir_recv_capture_start(drv_info, TUYA_PWM_NEGATIVE);
+    if (OPRT_OK != rt) {
+        tkl_log_output("pwm capture start err\r\n");
+    }
+
+    return rt;
+}
+
+static void __tdd_ir_recv_capture_deinit(IR_DRV_INFO_T *drv_info)
+{
+    if (drv_info->hw_cfg.recv_pin == IR_INPUT_INVALID||\
+        drv_info->tdl_data.driver_mode == IR_MODE_SEND_ONLY) {
+        return;
+    }
+
+    tkl_pwm_cap_stop(drv_info->tdd_recv.recv_pwm_id);
+
+    return;
+}
+#endif
+
 static int __tdd_ir_recv_irq_timer_init(IR_DRV_INFO_T *drv_info)
 {
     OPERATE_RET rt = OPRT_OK;
@@ -517,7 +598,11 @@ static int __tdd_ir_recv_hw_init(IR_DRV_INFO_T *drv_info)
     }
 
     if (IR_DRV_CAPTURE == drv_info->driver_type) {
-        // rt = __tdd_ir_recv_capture_init(drv_info);
+#if (defined(EN_TIMER_CAPTURE) && (EN_TIMER_CAPTURE==1))
+        rt = __tdd_ir_recv_capture_init(drv_info);
+#else
+        rt = OPRT_NOT_SUPPORTED;
+#endif
     } else {
         rt = __tdd_ir_recv_irq_timer_init(drv_info);
     }
@@ -540,7 +625,9 @@ static void __tdd_ir_recv_hw_deinit(IR_DRV_INFO_T *drv_info)
     }
 
     if (IR_DRV_CAPTURE == drv_info->driver_type) {
-        // __tdd_ir_recv_capture_deinit(drv_info);
+#if (defined(EN_TIMER_CAPTURE) && (EN_TIMER_CAPTURE==1))
+        __tdd_ir_recv_capture_deinit(drv_info);
+#endif
     } else {
         __tdd_ir_recv_irq_timer_deinit(drv_info);
     }
@@ -660,6 +747,11 @@ static int __tdd_ir_pre_recv_process(IR_DRV_HANDLE_T drv_hdl)
     drv_info->tdd_recv.overflow_cnt = 0;
     drv_info->tdd_recv.is_receiving = 1;
 
+    /* widths are latched by the capture hardware, interrupts may stay on */
+    if (IR_DRV_CAPTURE == drv_info->driver_type) {
+        return OPRT_OK;
+    }
+
     /* close fiq */
     __tdd_bk7231n_fiq_disable();
 
@@ -681,7 +773,7 @@ static int __tdd_ir_recv_finish_process(IR_DRV_HANDLE_T drv_hdl)
 {
     IR_DRV_INFO_T *drv_info = NULL;
 
-    if (NULL == drv_info) {
+    if (NULL == drv_hdl) {
         return OPRT_INVALID_PARM;
     }
     drv_info = (IR_DRV_INFO_T *)drv_hdl;
@@ -690,6 +782,13 @@ static int __tdd_ir_recv_finish_process(IR_DRV_HANDLE_T drv_hdl)
     drv_info->tdd_recv.overflow_cnt = 0;
     drv_info->tdd_recv.last_time = 0;
 
+    /* restart from the falling edge */
+    if (IR_DRV_CAPTURE == drv_info->driver_type) {
+        __tdd_ir_recv_hw_deinit(drv_info);
+        __tdd_ir_recv_hw_init(drv_info);
+        return OPRT_OK;
+    }
+
     // stop timer
     if (drv_info->tdd_recv.irq_enable_time != 0) {
         tkl_timer_stop(drv_info->hw_cfg.recv_timer);
@@ -789,10 +888,6 @@ static int __tdd_ir_drv_open(IR_DRV_HANDLE_T drv_hdl, unsigned char mode, IR_TDL
     drv_info->tdl_data.output_finish_cb = ir_tdl_cb.output_finish_cb;
     drv_info->tdl_data.recv_value_cb = ir_tdl_cb.recv_cb;
 
-#if EN_TIMER_CAPTURE
-    // TODO
-#endif
-
     if (IR_MODE_RECV_ONLY == mode || IR_MODE_SEND_RECV == mode) {
         drv_info->tdd_recv.is_enable = 1;
         __tdd_ir_recv_hw_deinit(drv_info);
@@ -945,7 +1040,14 @@ int tdd_ir_driver_register(char *dev_name, IR_DRIVER_TYPE_E driver_type, IR_DRV_
     /* receive */
 #if (defined(EN_TIMER_CAPTURE) && (EN_TIMER_CAPTURE==1))
     if (IR_DRV_CAPTURE == driver_type) {
-        // TODO:
+        TUYA_PWM_NUM_E recv_pwm_id = TUYA_PWM_NUM_0;
+        rt = __tdd_get_pwm_id(drv_cfg.recv_pin, &recv_pwm_id);
+        if (OPRT_OK != rt) {
+            PR_ERR("ir capture pin %d is not a pwm pin", drv_cfg.recv_pin);
+            tal_free(drv_info);
+            return rt;
+        }
+        drv_info->tdd_recv.recv_pwm_id = recv_pwm_id;
     }
 #endif
 
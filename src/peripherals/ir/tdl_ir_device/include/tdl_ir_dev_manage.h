@@ -6,10 +6,14 @@
  * communication within the Tuya IoT ecosystem. It implements a complete infrared
  * device management system that supports multiple IR protocols (NEC, timecode),
  * device registration, and both synchronous and asynchronous communication modes.
+ * Received levels are only stored in interrupt context, frames are decoded by
+ * the receive task once the line has been idle for a while. In learning mode
+ * the next frame is kept as raw timecode in a buffer large enough for long
+ * air conditioner codes.
  *
  * Key functionalities provided:
  * - IR device discovery, registration, and lifecycle management
- * - Support for multiple IR protocols (NEC protocol, raw timecode)
+ * - Support for multiple IR protocols (NEC, RC5 protocol, raw timecode)
  * - Bidirectional IR communication (transmit and receive)
  * - Protocol-specific configuration and error handling
  * - Queue-based data management for IR receive operations
@@ -44,7 +48,8 @@ extern "C" {
 typedef uint8_t IR_PROT_E;
 #define IR_PROT_TIMECODE            0
 #define IR_PROT_NEC                 1
-#define IR_PROT_MAX                 2
+#define IR_PROT_RC5                 2
+#define IR_PROT_MAX                 3
 
 typedef unsigned char IR_SEND_STATUS;
 #define IR_STA_SEND_IDLE            0
@@ -74,6 +79,12 @@ typedef unsigned char IR_CMD_E;
 #define IR_CMD_RECV_CB_REGISTER     9
 #define IR_CMD_CODE_INTER_DELAY_SET 10 // Set the delay between continuous transmission of infrared code, unit: (uint32_t) us
 #define IR_CMD_RECV_TASK_STACK_SET  11 // Set the stack size of the infrared receive task
+#define IR_CMD_RECV_LEARN_START     12 // Receive the next frame as raw timecode into a larger buffer, params: (uint32_t *) size in bytes, NULL: IR_RECV_LEARN_BUF_SIZE
+#define IR_CMD_RECV_LEARN_STOP      13 // Leave learning mode before a frame was received
+
+#ifndef IR_RECV_LEARN_BUF_SIZE
+#define IR_RECV_LEARN_BUF_SIZE      (4*1024) // 1024 levels, enough for most air conditioner remotes
+#endif
 
 /***********************************************************
 ***********************typedef define***********************
@@ -93,9 +104,15 @@ typedef struct {
     uint8_t repeat_err;
 } IR_NEC_CFG_T;
 
+/* rc5 protocol config struct */
+typedef struct {
+    uint8_t bit_err; // percent of a half bit, 0: default 30
+} IR_RC5_CFG_T;
+
 /* ir protocol config union */
 typedef union {
     IR_NEC_CFG_T nec_cfg;
+    IR_RC5_CFG_T rc5_cfg;
 } IR_PROT_CFG_U;
 
 /* ir nec protocol data struct */
@@ -105,6 +122,14 @@ typedef struct {
     uint16_t cmd;
     uint16_t repeat_cnt;
 } IR_DATA_NEC_T;
+
+/* ir rc5 protocol data struct */
+typedef struct {
+    uint8_t addr;        // 5 bits
+    uint8_t cmd;         // 7 bits, bit 6 is sent inverted in the second start bit
+    uint8_t toggle;      // flips on every new key press
+    uint16_t repeat_cnt; // frames after the first with the same toggle
+} IR_DATA_RC5_T;
 #pragma pack()
 
 /* ir timecode data struct */
@@ -116,6 +141,7 @@ typedef struct {
 /* ir data union */
 typedef union {
     IR_DATA_NEC_T nec_data;
+    IR_DATA_RC5_T rc5_data;
     IR_DATA_TIMECODE_T timecode;
 } IR_DATA_U;
 
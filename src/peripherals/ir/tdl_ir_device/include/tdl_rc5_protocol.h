@@ -0,0 +1,75 @@
+/**
+ * @file tdl_rc5_protocol.h
+ * @brief RC5 infrared protocol implementation for Tuya IoT devices.
+ *
+ * RC5 sends 14 Manchester coded bits with a 889us half bit: two start bits,
+ * a toggle bit that flips on every new key press, a 5 bit address and a
+ * 6 bit command. The second start bit carries the inverted bit 6 of the
+ * command (RC5X). Frames are repeated every 114ms while a key is held.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __TDL_RC5_PROTOCOL_H__
+#define __TDL_RC5_PROTOCOL_H__
+
+#include "tuya_cloud_types.h"
+
+#include "tdl_ir_dev_manage.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define IR_RC5_MIN_LENGTH       (14)
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+
+/**
+ * @brief RC5 build function, converts RC5 format to timecode format, need to call tdl_ir_rc5_build_release to release timecode after building
+ *
+ * @param[in] ir_rc5_data: RC5 data, repeat_cnt frames are added after the first one
+ * @param[out] timecode: converted timecode format
+ *
+ * @return OPRT_OK on success. Others on error, please refer to "tuya_error_code.h"
+ */
+OPERATE_RET tdl_ir_rc5_build(IR_DATA_RC5_T ir_rc5_data, IR_DATA_TIMECODE_T **timecode);
+
+/**
+ * @brief Release timecode
+ *
+ * @param[in] timecode: timecode to be released
+ *
+ * @return none
+ */
+void tdl_ir_rc5_build_release(IR_DATA_TIMECODE_T *timecode);
+
+/**
+ * @brief Single RC5 frame parsing, received timecode starts with the first active level
+ *
+ * @param[in] data: input data
+ * @param[in] len: input data length
+ * @param[in] rc5_cfg: error rate parameters
+ * @param[out] rc5_code: parsed RC5 data, repeat_cnt is always 0
+ * @param[out] parsed_len: data consumed, the next frame starts there even if parsing failed
+ *
+ * @return OPRT_OK on success. Others on error, please refer to "tuya_error_code.h"
+ */
+OPERATE_RET tdl_ir_rc5_parser_single(uint32_t *data, uint16_t len, IR_RC5_CFG_T *rc5_cfg, IR_DATA_RC5_T *rc5_code, uint16_t *parsed_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TDL_RC5_PROTOCOL_H__ */
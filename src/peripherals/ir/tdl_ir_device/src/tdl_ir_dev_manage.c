@@ -10,8 +10,10 @@
  *
  * Key implementation features:
  * - Device registration and discovery management with linked list storage
- * - Multi-protocol support (NEC protocol and raw timecode transmission)
- * - Ring buffer implementation for efficient IR data reception
+ * - Multi-protocol support (NEC, RC5 protocol and raw timecode transmission)
+ * - Ring buffer implementation for efficient IR data reception, the receive
+ *   interrupt only stores levels and frames are decoded in the receive task
+ * - Learning mode, the next frame is kept raw in a larger buffer
  * - Asynchronous data processing with queue-based messaging
  * - Thread-safe operations with proper synchronization mechanisms
  * - Configurable timing parameters and error tolerance settings
@@ -41,6 +43,7 @@
 
 #include "tdl_ir_dev_manage.h"
 #include "tdl_nec_protocol.h"
+#include "tdl_rc5_protocol.h"
 
 /***********************************************************
 ************************macro define************************
@@ -55,6 +58,10 @@
 
 #define IR_DEVICE_NUM_MAX       5
 
+#define IR_LEARN_REQ_NONE       0
+#define IR_LEARN_REQ_START      1
+#define IR_LEARN_REQ_STOP       2
+
 #ifndef QUEUE_WAIT_FOREVER
 #define QUEUE_WAIT_FOREVER      0xFFFFFFFF
 #endif
@@ -89,6 +96,11 @@ typedef struct {
     QUEUE_HANDLE            recv_queue_hdl;
     IR_APP_RECV_CB          app_recv_cb;
 
+    // learning mode, requests are applied by the receive task while idle
+    uint8_t                 is_learn;
+    volatile uint8_t        learn_req;
+    uint32_t                learn_buf_size;
+
     // NEC sync parser
     volatile uint16_t                addr;
     volatile uint16_t                cmd;
@@ -540,6 +552,7 @@ static int __tdl_ir_output_finish_cb(void *args)
 static int __tdl_ir_recv_cb(IR_DRV_HANDLE_T drv_hdl, unsigned int raw_data, void *args)
 {
     IR_DEV_NODE_T *dev_info = NULL;
+    IR_RING_BUF_T *ring_buf = NULL;
     int temp_data = raw_data;
 
     if (NULL == args) {
@@ -554,11 +567,13 @@ static int __tdl_ir_recv_cb(IR_DRV_HANDLE_T drv_hdl, unsigned int raw_data, void
 
     dev_info->recv_info.last_time = tal_system_get_millisecond(); // update receive time
 
-    if (NULL == dev_info->recv_info.ring_buf) {
+    /* the receive task may swap the buffer for learning, read it once */
+    ring_buf = dev_info->recv_info.ring_buf;
+    if (NULL == ring_buf) {
         return 0;
     }
 
-    if (RING_BUFFER_IS_FULL(dev_info->recv_info.ring_buf)) {
+    if (RING_BUFFER_IS_FULL(ring_buf)) {
         if (IR_STA_RECVING == dev_info->recv_status) {
             dev_info->recv_status = IR_STA_RECV_OVERFLOW;
         }
@@ -569,18 +584,103 @@ static int __tdl_ir_recv_cb(IR_DRV_HANDLE_T drv_hdl, unsigned int raw_data, void
         dev_info->recv_status = IR_STA_RECVING;
         dev_info->drv_intfs->status_notif(dev_info->ir_drv_hdl, IR_DRV_PRE_RECV_STATE, NULL);
 
-        /* receive start, post queue */
+        /* receive start, post queue, must not block in interrupt context */
         if (NULL != sg_list_head.dev_notif_queue_hdl) {
-            tal_queue_post(sg_list_head.dev_notif_queue_hdl, &dev_info, QUEUE_WAIT_FOREVER);
+            tal_queue_post(sg_list_head.dev_notif_queue_hdl, &dev_info, 0);
         }
 
     } else if (IR_STA_RECVING == dev_info->recv_status) {
-        __tdl_ir_ring_buf_write_word(dev_info->recv_info.ring_buf, raw_data);
+        __tdl_ir_ring_buf_write_word(ring_buf, raw_data);
     }
 
     return 0;
 }
 
+/**
+ * @brief output one rc5 frame to the application
+ *
+ * @param[in] dev_info: ir device structure
+ * @param[in] rc5_data: decoded frame
+ *
+ * @return none
+ */
+static void __tdl_ir_recv_rc5_output(IR_DEV_NODE_T *dev_info, IR_DATA_RC5_T *rc5_data)
+{
+    OPERATE_RET rt = OPRT_OK;
+    IR_DATA_U out_rc5, *out_data = NULL;
+
+    if (NULL != dev_info->recv_info.app_recv_cb) {
+        out_rc5.rc5_data = *rc5_data;
+        dev_info->recv_info.app_recv_cb(1, &out_rc5);
+        return;
+    }
+
+    out_data = __tdl_ir_recv_buf_malloc(IR_PROT_RC5, 0);
+    if (NULL == out_data) {
+        return;
+    }
+    out_data->rc5_data = *rc5_data;
+
+    rt = tal_queue_post(dev_info->recv_info.recv_queue_hdl, &out_data, IR_RECV_POST_TIMEOUT_MS);
+    if (OPRT_OK != rt) {
+        PR_ERR("post queue error, %d", rt);
+        __tdl_ir_recv_buf_free(out_data);
+    }
+
+    return;
+}
+
+/**
+ * @brief decode all rc5 frames of one reception, frames repeated while a key is held are counted
+ *
+ * @param[in] dev_info: ir device structure
+ * @param[in] data: received timecode
+ * @param[in] data_len: timecode length
+ *
+ * @return OPRT_OK on success. Others on error, please refer to "tuya_error_code.h"
+ */
+static OPERATE_RET __tdl_ir_recv_rc5_decode(IR_DEV_NODE_T *dev_info, uint32_t *data, uint16_t data_len)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint16_t parser_offset = 0, parser_len = 0;
+    uint8_t have_frame = 0;
+    IR_DATA_RC5_T frame, last_frame;
+
+    while (parser_offset + IR_RC5_MIN_LENGTH <= data_len) {
+        parser_len = 0;
+        rt = tdl_ir_rc5_parser_single(&data[parser_offset], data_len-parser_offset, \
+                                      &dev_info->ir_dev_cfg.prot_cfg.rc5_cfg, &frame, &parser_len);
+        if (0 == parser_len) {
+            break;
+        }
+        parser_offset += parser_len;
+
+        if (OPRT_OK != rt) {
+            continue;
+        }
+
+        if (have_frame && frame.addr == last_frame.addr && frame.cmd == last_frame.cmd && \
+            frame.toggle == last_frame.toggle) {
+            last_frame.repeat_cnt++;
+            continue;
+        }
+
+        if (have_frame) {
+            __tdl_ir_recv_rc5_output(dev_info, &last_frame);
+        }
+        last_frame = frame;
+        have_frame = 1;
+    }
+
+    if (0 == have_frame) {
+        PR_ERR("rc5 decode err");
+        return OPRT_COM_ERROR;
+    }
+    __tdl_ir_recv_rc5_output(dev_info, &last_frame);
+
+    return OPRT_OK;
+}
+
 /**
  * @brief ir receive data process
  *
@@ -597,6 +697,7 @@ static OPERATE_RET __tdl_ir_recv_data_process(IR_DEV_NODE_T *dev_info)
     uint16_t parser_head = 0, parser_offset = 0, parser_len = 0;
     int ret_len = 0;
     IR_DATA_U out_nec, *out_data = NULL;
+    IR_PROT_E prot_opt = IR_PROT_TIMECODE;
 
 
     TUYA_CHECK_NULL_RETURN(dev_info, OPRT_INVALID_PARM);
@@ -604,7 +705,10 @@ static OPERATE_RET __tdl_ir_recv_data_process(IR_DEV_NODE_T *dev_info)
     tmp_rb = dev_info->recv_info.ring_buf;
     data_len = RING_BUFFER_LENGTH_GET(tmp_rb);
 
-    if (dev_info->ir_dev_cfg.prot_opt == IR_PROT_NEC) {
+    /* learned codes are always kept raw */
+    prot_opt = (dev_info->recv_info.is_learn) ? (IR_PROT_TIMECODE) : (dev_info->ir_dev_cfg.prot_opt);
+
+    if (prot_opt == IR_PROT_NEC) {
         if (NULL != dev_info->recv_info.app_recv_cb) {
             if (dev_info->recv_info.have_data) {
                 out_nec.nec_data.addr = dev_info->recv_info.addr;
@@ -659,7 +763,14 @@ static OPERATE_RET __tdl_ir_recv_data_process(IR_DEV_NODE_T *dev_info)
                 tmp_buf = NULL;
             }
         }
-    } else if (dev_info->ir_dev_cfg.prot_opt == IR_PROT_TIMECODE) {
+    } else if (prot_opt == IR_PROT_RC5) {
+        tmp_buf = tal_malloc(data_len * SIZEOF(uint32_t));
+        TUYA_CHECK_NULL_RETURN(tmp_buf, OPRT_MALLOC_FAILED);
+        __tdl_ir_ring_buf_read_no_update(tmp_rb, tmp_buf, data_len);
+        rt = __tdl_ir_recv_rc5_decode(dev_info, tmp_buf, data_len);
+        tal_free(tmp_buf);
+        tmp_buf = NULL;
+    } else if (prot_opt == IR_PROT_TIMECODE) {
         out_data = __tdl_ir_recv_buf_malloc(IR_PROT_TIMECODE, data_len * SIZEOF(uint32_t));
         TUYA_CHECK_NULL_RETURN(out_data, OPRT_MALLOC_FAILED);
         __tdl_ir_ring_buf_read(tmp_rb, out_data->timecode.data, data_len);
@@ -800,6 +911,53 @@ __ERR:
     return rt;
 }
 
+/**
+ * @brief apply a pending learning request, the buffer is only swapped while nothing is received
+ *
+ * @param[in] dev_info: ir device structure
+ *
+ * @return none
+ */
+static void __tdl_ir_recv_learn_update(IR_DEV_NODE_T *dev_info)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint8_t learn_req = dev_info->recv_info.learn_req;
+    uint32_t buf_size = 0;
+    IR_RING_BUF_T *new_buf = NULL, *old_buf = NULL;
+
+    if (IR_LEARN_REQ_NONE == learn_req || IR_STA_RECV_IDLE != dev_info->recv_status || \
+        NULL == dev_info->recv_info.ring_buf) {
+        return;
+    }
+    dev_info->recv_info.learn_req = IR_LEARN_REQ_NONE;
+
+    if (IR_LEARN_REQ_START == learn_req) {
+        buf_size = dev_info->recv_info.learn_buf_size;
+    } else if (dev_info->recv_info.is_learn) {
+        dev_info->recv_info.is_learn = 0;
+        buf_size = dev_info->ir_dev_cfg.recv_buf_size;
+    } else {
+        return;
+    }
+
+    rt = __tdl_ir_ring_buf_init(&new_buf, buf_size);
+    if (OPRT_OK != rt) {
+        PR_ERR("ir recv buffer malloc fail, %d", rt);
+        return;
+    }
+
+    /* the receive interrupt reads the pointer once, the old buffer is unused after the swap */
+    old_buf = dev_info->recv_info.ring_buf;
+    dev_info->recv_info.ring_buf = new_buf;
+    __tdl_ir_ring_buf_deinit(old_buf);
+
+    if (IR_LEARN_REQ_START == learn_req) {
+        dev_info->recv_info.is_learn = 1;
+    }
+    PR_DEBUG("ir learn %s, buffer %d bytes", (dev_info->recv_info.is_learn) ? "start" : "stop", buf_size);
+
+    return;
+}
 
 /**
  * @brief ir receive task
@@ -813,6 +971,7 @@ static void __tdl_ir_recv_task(void *args)
     OPERATE_RET op_ret = OPRT_OK;
     IR_DEV_NODE_T *dev_node = NULL;
     uint32_t cur_time = 0;
+    uint8_t is_overflow = 0;
 
     PR_DEBUG("ir recv task start");
 
@@ -826,9 +985,14 @@ static void __tdl_ir_recv_task(void *args)
             PR_ERR("wait semaphore error, %d", op_ret);
         }
 
+        if (NULL != dev_node && dev_node->recv_info.is_run) {
+            __tdl_ir_recv_learn_update(dev_node);
+        }
+
         if (NULL == dev_node || IR_STA_RECV_IDLE == dev_node->recv_status) {
             continue;
         }
+        is_overflow = 0;
 
         while (IR_STA_RECVING == dev_node->recv_status) {
             /* disable low-power mode */
@@ -849,7 +1013,8 @@ static void __tdl_ir_recv_task(void *args)
                 }
             }
 
-            if (NULL != dev_node->recv_info.app_recv_cb && dev_node->ir_dev_cfg.prot_opt == IR_PROT_NEC) {
+            if (NULL != dev_node->recv_info.app_recv_cb && dev_node->ir_dev_cfg.prot_opt == IR_PROT_NEC && \
+                0 == dev_node->recv_info.is_learn) {
                 op_ret = __tdl_ir_recv_data_process_sync(dev_node);
                 if (OPRT_OK != op_ret) {
                     dev_node->recv_status = IR_STA_RECV_FINISH;
@@ -859,6 +1024,7 @@ static void __tdl_ir_recv_task(void *args)
 
         if (IR_STA_RECV_OVERFLOW == dev_node->recv_status) {
             PR_DEBUG("ir receive overflow");
+            is_overflow = 1;
             dev_node->recv_status = IR_STA_RECV_FINISH;
         }
 
@@ -868,10 +1034,17 @@ static void __tdl_ir_recv_task(void *args)
                 __tdl_ir_ring_buf_write_word(dev_node->recv_info.ring_buf, dev_node->ir_dev_cfg.recv_timeout * 1000);
             }
 
-            PR_DEBUG("recv finish decode");
-            op_ret = __tdl_ir_recv_data_process(dev_node);
-            if (OPRT_OK != op_ret) {
-                PR_DEBUG("recv data process fail");
+            if (dev_node->recv_info.is_learn && is_overflow) {
+                /* a truncated code is useless, keep learning */
+                PR_ERR("ir learn buffer too small, frame dropped");
+            } else {
+                PR_DEBUG("recv finish decode");
+                op_ret = __tdl_ir_recv_data_process(dev_node);
+                if (OPRT_OK != op_ret) {
+                    PR_DEBUG("recv data process fail");
+                } else if (dev_node->recv_info.is_learn) {
+                    dev_node->recv_info.learn_req = IR_LEARN_REQ_STOP;
+                }
             }
 
             /* reset receive status */
@@ -881,6 +1054,8 @@ static void __tdl_ir_recv_task(void *args)
             /* notify tdd driver */
             dev_node->drv_intfs->status_notif(dev_node->ir_drv_hdl, IR_DRV_RECV_FINISH_STATE, NULL);
 
+            __tdl_ir_recv_learn_update(dev_node);
+
             if (TRUE == tal_cpu_get_lp_mode() && sg_cpu_lp_dis_flag) {
                 tal_cpu_lp_enable();
                 sg_cpu_lp_dis_flag = 0;
@@ -1046,6 +1221,8 @@ static OPERATE_RET __tdl_ir_recv_deinit(IR_DEV_NODE_T *ir_device)
     }
 
     ir_device->recv_info.is_run = 0;
+    ir_device->recv_info.is_learn = 0;
+    ir_device->recv_info.learn_req = IR_LEARN_REQ_NONE;
 
     return OPRT_OK;
 }
@@ -1271,6 +1448,15 @@ OPERATE_RET tdl_ir_dev_send(IR_HANDLE_T handle, uint32_t freq, IR_DATA_U ir_data
                 return OPRT_SEND_ERR;
             }
         break;
+        case IR_PROT_RC5:
+            ir_device->send_status = IR_STA_SEND_BUILD;
+            op_ret = tdl_ir_rc5_build(ir_data.rc5_data, &timecode);
+            if (OPRT_OK != op_ret) {
+                ir_device->send_status = IR_STA_SEND_IDLE;
+                PR_ERR("ir rc5 build error\r\n");
+                return OPRT_SEND_ERR;
+            }
+        break;
         default:
         return OPRT_NOT_SUPPORTED;
     }
@@ -1307,9 +1493,11 @@ OPERATE_RET tdl_ir_dev_send(IR_HANDLE_T handle, uint32_t freq, IR_DATA_U ir_data
         ir_device->send_info.send_cnt = 0;
     }
 
-    /* free nec build memory space */
+    /* free nec, rc5 build memory space */
     if (IR_PROT_NEC == ir_device->ir_dev_cfg.prot_opt) {
         tdl_ir_nec_build_release(timecode);
+    } else if (IR_PROT_RC5 == ir_device->ir_dev_cfg.prot_opt) {
+        tdl_ir_rc5_build_release(timecode);
     }
 
     ir_device->send_status = IR_STA_SEND_IDLE;
@@ -1381,6 +1569,7 @@ OPERATE_RET tdl_ir_config(IR_HANDLE_T handle, IR_CMD_E cmd, void *params)
     uint8_t *ir_status = (uint8_t *)params;
     IR_DATA_U *ir_data = NULL;
     uint32_t irq_en_time = 250000; // 250ms
+    uint32_t learn_size = 0;
 
     if (NULL==handle) {
         return OPRT_INVALID_PARM;
@@ -1460,6 +1649,28 @@ OPERATE_RET tdl_ir_config(IR_HANDLE_T handle, IR_CMD_E cmd, void *params)
             PR_NOTICE("Set ir recv task stack size: %d", sg_list_head.stack_size);
         break;
 
+        case IR_CMD_RECV_LEARN_START:
+            if (0 == ir_device->recv_info.is_run || NULL == sg_list_head.dev_notif_queue_hdl) {
+                return OPRT_NOT_SUPPORTED;
+            }
+            learn_size = (NULL != params) ? (*(uint32_t *)params) : (IR_RECV_LEARN_BUF_SIZE);
+            /* a received timecode holds at most 0xFFFF levels */
+            if (learn_size < ir_device->ir_dev_cfg.recv_buf_size || learn_size/SIZEOF(uint32_t) > 0xFFFF) {
+                return OPRT_INVALID_PARM;
+            }
+            ir_device->recv_info.learn_buf_size = learn_size;
+            ir_device->recv_info.learn_req = IR_LEARN_REQ_START;
+            tal_queue_post(sg_list_head.dev_notif_queue_hdl, &ir_device, 0);
+        break;
+
+        case IR_CMD_RECV_LEARN_STOP:
+            if (0 == ir_device->recv_info.is_run || NULL == sg_list_head.dev_notif_queue_hdl) {
+                return OPRT_NOT_SUPPORTED;
+            }
+            ir_device->recv_info.learn_req = IR_LEARN_REQ_STOP;
+            tal_queue_post(sg_list_head.dev_notif_queue_hdl, &ir_device, 0);
+        break;
+
         default: break;
     }
 
@@ -0,0 +1,238 @@
+/**
+ * @file tdl_rc5_protocol.c
+ * @brief Implementation of the RC5 infrared protocol for Tuya IoT devices.
+ *
+ * Frames are converted to and from a list of half bit levels. Each timecode
+ * entry covers one or two half bits, the receiver never sees the leading
+ * inactive half of the first start bit, and the last inactive half of a frame
+ * merges into the gap before the next one.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include <string.h>
+
+#include "tal_memory.h"
+#include "tal_log.h"
+
+#include "tdl_ir_dev_manage.h"
+#include "tdl_rc5_protocol.h"
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+
+#define ABS(a,b)    ((a)>(b)?(a-b):(b-a))
+
+#define RC5_HALF_BIT_US     (889)
+#define RC5_FRAME_BITS      (14)
+#define RC5_HALF_BITS       (RC5_FRAME_BITS*2)
+#define RC5_CODE_CYCLE      (113778UL) // 64 bit times
+
+#define RC5_BIT_ERR_DEFAULT (30) // percent of a half bit
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+
+/**
+ * @brief number of half bits in one timecode entry
+ *
+ * @param[in] time_us: entry length
+ * @param[in] err_us: allowed error of one half bit
+ *
+ * @return 1 or 2, 0 if it fits neither
+ */
+static uint8_t __tdl_rc5_half_bit_cnt(uint32_t time_us, uint32_t err_us)
+{
+    if (ABS(time_us, RC5_HALF_BIT_US) <= err_us) {
+        return 1;
+    }
+
+    if (ABS(time_us, 2*RC5_HALF_BIT_US) <= 2*err_us) {
+        return 2;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief rc5 protocol build
+ *
+ * @param[in] ir_rc5_data: rc5 protocol data
+ * @param[out] timecode: build data
+ *
+ * @return OPRT_OK on success. Others on error, please refer to "tuya_error_code.h"
+ */
+OPERATE_RET tdl_ir_rc5_build(IR_DATA_RC5_T ir_rc5_data, IR_DATA_TIMECODE_T **timecode)
+{
+    uint8_t half[RC5_HALF_BITS];
+    uint32_t frame[RC5_HALF_BITS];
+    uint16_t frame_len = 0, bits = 0, len = 0;
+    uint32_t frame_us = 0;
+    uint8_t i = 0;
+    uint16_t j = 0;
+    IR_DATA_TIMECODE_T *temp_timecode = NULL;
+
+    if (NULL == timecode) {
+        return OPRT_INVALID_PARM;
+    }
+
+    /* S1, S2 (inverted cmd bit 6), toggle, 5 bit address, 6 bit command */
+    bits = (1<<13) | ((ir_rc5_data.cmd & 0x40) ? 0 : (1<<12)) | ((ir_rc5_data.toggle & 0x01)<<11) | \
+           ((ir_rc5_data.addr & 0x1F)<<6) | (ir_rc5_data.cmd & 0x3F);
+
+    /* bit 1: inactive then active, bit 0: active then inactive */
+    for (i=0; i<RC5_FRAME_BITS; i++) {
+        if (bits & (1<<(RC5_FRAME_BITS-1-i))) {
+            half[i*2] = 0;
+            half[i*2+1] = 1;
+        } else {
+            half[i*2] = 1;
+            half[i*2+1] = 0;
+        }
+    }
+
+    /* merge equal levels, the frame starts with the first active half */
+    for (i=1; i<RC5_HALF_BITS; i++) {
+        if (i > 1 && half[i] == half[i-1]) {
+            frame[frame_len-1] += RC5_HALF_BIT_US;
+        } else {
+            frame[frame_len++] = RC5_HALF_BIT_US;
+        }
+        frame_us += RC5_HALF_BIT_US;
+    }
+
+    /* the frame ends with the inactive level up to the code cycle */
+    if (frame_len % 2) {
+        frame[frame_len++] = RC5_CODE_CYCLE - frame_us;
+    } else {
+        frame[frame_len-1] += RC5_CODE_CYCLE - frame_us;
+    }
+
+    len = frame_len * (1 + ir_rc5_data.repeat_cnt);
+
+    temp_timecode = (IR_DATA_TIMECODE_T *)tal_malloc(SIZEOF(IR_DATA_TIMECODE_T) + len * SIZEOF(uint32_t));
+    if (NULL == temp_timecode) {
+        return OPRT_MALLOC_FAILED;
+    }
+    memset(temp_timecode, 0, SIZEOF(IR_DATA_TIMECODE_T) + len*SIZEOF(uint32_t));
+
+    temp_timecode->data = (uint32_t *)(temp_timecode+1);
+    temp_timecode->len = len;
+
+    /* repeat frames keep the toggle bit */
+    for (j=0; j<len; j+=frame_len) {
+        memcpy(&temp_timecode->data[j], frame, frame_len*SIZEOF(uint32_t));
+    }
+
+    *timecode = temp_timecode;
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief rc5 build data release function
+ *
+ * @param[in] timecode: parameters in tdl_ir_rc5_build function
+ *
+ * @return none
+ */
+void tdl_ir_rc5_build_release(IR_DATA_TIMECODE_T *timecode)
+{
+    if (NULL != timecode) {
+        tal_free(timecode);
+    }
+
+    return;
+}
+
+/**
+ * @brief rc5 protocol single parser
+ *
+ * @param[in] data: raw data, even index is the active level
+ * @param[in] len: data length
+ * @param[in] rc5_cfg: rc5 error value
+ * @param[out] rc5_code: decode data
+ * @param[out] parsed_len: parsed data length
+ *
+ * @return OPRT_OK on success. Others on error, please refer to "tuya_error_code.h"
+ */
+OPERATE_RET tdl_ir_rc5_parser_single(uint32_t *data, uint16_t len, IR_RC5_CFG_T *rc5_cfg, IR_DATA_RC5_T *rc5_code, uint16_t *parsed_len)
+{
+    uint8_t half[RC5_HALF_BITS];
+    uint8_t half_cnt = 0, cnt = 0, i = 0;
+    uint16_t idx = 0, bits = 0;
+    uint32_t err_us = 0;
+
+    if (NULL == data || NULL == rc5_code || NULL == parsed_len || len < 2) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (NULL != rc5_cfg && 0 != rc5_cfg->bit_err && rc5_cfg->bit_err < 100) {
+        err_us = RC5_HALF_BIT_US * rc5_cfg->bit_err / 100;
+    } else {
+        err_us = RC5_HALF_BIT_US * RC5_BIT_ERR_DEFAULT / 100;
+    }
+
+    memset(rc5_code, 0, SIZEOF(IR_DATA_RC5_T));
+
+    /* the inactive half of S1 is not received */
+    half[half_cnt++] = 0;
+    for (idx=0; idx<len && half_cnt<RC5_HALF_BITS; idx++) {
+        cnt = __tdl_rc5_half_bit_cnt(data[idx], err_us);
+        if (0 == cnt) {
+            if (idx % 2 == 0 || data[idx] < 2*RC5_HALF_BIT_US) {
+                goto __ERR;
+            }
+            /* a long inactive level is the gap after the frame */
+            cnt = RC5_HALF_BITS - half_cnt;
+        }
+
+        while (cnt-- && half_cnt < RC5_HALF_BITS) {
+            half[half_cnt++] = (idx % 2 == 0) ? 1 : 0;
+        }
+    }
+
+    if (half_cnt < RC5_HALF_BITS) {
+        goto __ERR;
+    }
+
+    for (i=0; i<RC5_FRAME_BITS; i++) {
+        bits <<= 1;
+        if (0 == half[i*2] && 1 == half[i*2+1]) {
+            bits |= 1;
+        } else if (1 != half[i*2] || 0 != half[i*2+1]) {
+            goto __ERR;
+        }
+    }
+
+    rc5_code->addr = (bits>>6) & 0x1F;
+    rc5_code->cmd = (bits & 0x3F) | ((bits & (1<<12)) ? 0 : 0x40);
+    rc5_code->toggle = (bits>>11) & 0x01;
+
+    /* skip the gap, the next frame starts with an active level */
+    if (idx % 2 && idx < len) {
+        idx++;
+    }
+    *parsed_len = idx;
+
+    return OPRT_OK;
+
+__ERR:
+    /* resume after the next gap */
+    for (idx=1; idx<len; idx+=2) {
+        if (data[idx] > 4*RC5_HALF_BIT_US) {
+            break;
+        }
+    }
+    *parsed_len = (idx+1 < len) ? (idx+1) : (len);
+
+    return OPRT_COM_ERROR;
+}
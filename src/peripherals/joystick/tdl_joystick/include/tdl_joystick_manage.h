@@ -117,6 +117,7 @@ OPERATE_RET tdl_joystick_deep_sleep_ctrl(uint8_t enable);
 
 /**
  * @brief set joystick task stack size
+ *        joysticks are sampled on the shared input scheduler thread, call before the first joystick is created
  *
  * @param[in] size stack size
  * @return Function Operation Result  OPRT_OK is ok other is fail
@@ -1,6 +1,6 @@
 /**
  * @file tdl_joystick_manage.c
- * @brief Joystick management module, provides base timer/semaphore/task functions
+ * @brief Joystick management module, sampled from the shared input scheduler
  * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
  *
  * @date 2025-07-08     maidang      Initial version
@@ -9,14 +9,13 @@
 #include "string.h"
 #include "stdint.h"
 
-#include "tal_semaphore.h"
 #include "tal_mutex.h"
 #include "tal_system.h"
 #include "tal_memory.h"
 #include "tal_log.h"
-#include "tal_thread.h"
 #include "tuya_list.h"
 
+#include "tdl_input_sched.h"
 #include "tdl_joystick_driver.h"
 #include "tdl_joystick_manage.h"
 #include "tdd_joystick.h"
@@ -38,9 +37,9 @@
 #define TDL_JOYSTICK_SCAN_TIME       10    // 10ms
 #define TDL_JOYSTICK_IRQ_SCAN_CNT    (TDL_JOYSTICK_IRQ_SCAN_TIME / TDL_JOYSTICK_SCAN_TIME)
 #define TOUCH_DELAY                  500 // Click interval for single/double click differentiation
-#define TDL_JOYSTICK_TASK_STACK_SIZE (4096)
 #define PUT_EVENT_CB(btn, name, ev, arg)                                                                               \
     do {                                                                                                               \
+        __tdl_joystick_post_event(name, ev);                                                                           \
         if (btn.list_cb[ev])                                                                                           \
             btn.list_cb[ev](name, ev, arg);                                                                            \
     } while (0)
@@ -93,10 +92,10 @@ typedef struct {
     uint8_t scan_task_flag;   /* scan task flag */
     uint8_t irq_task_flag;    /* irq task flag */
     uint8_t task_mode;        /* task mode */
-    SEM_HANDLE irq_semaphore; /* irq semaphore */
-    uint32_t irq_scan_cnt;    /* irq scan cnt */
-    MUTEX_HANDLE mutex;       /* mutex */
-} TDL_JOYSTICK_LOCAL_T;       /* TDL joystick local parameters */
+    TDL_INPUT_SCHED_HANDLE sched_hdl; /* input scheduler entry */
+    uint32_t irq_scan_cnt;            /* irq scan cnt */
+    MUTEX_HANDLE mutex;               /* mutex */
+} TDL_JOYSTICK_LOCAL_T;               /* TDL joystick local parameters */
 
 /***********************************************************
 ***********************variable define**********************
@@ -104,17 +103,14 @@ typedef struct {
 TDL_JOYSTICK_LOCAL_T tdl_joystick_local = {.irq_task_flag = FALSE,
                                            .scan_task_flag = FALSE,
                                            .task_mode = FALSE,
-                                           .irq_semaphore = NULL,
+                                           .sched_hdl = NULL,
                                            .irq_scan_cnt = TDL_JOYSTICK_IRQ_SCAN_TIME / TDL_JOYSTICK_SCAN_TIME,
                                            .mutex = NULL};
 
-THREAD_HANDLE stick_scan_thread_handle = NULL;    /* scan thread handle */
-THREAD_HANDLE stick_irq_thread_handle = NULL;     /* irq thread handle */
 TDL_JOYSTICK_LIST_HEAD_T *p_joystick_list = NULL; /* joystick list head */
 
 static uint8_t g_tdl_joystick_list_exist = FALSE;                           /* joystick list head init flag */
 static uint8_t g_tdl_joystick_scan_mode_exist = 0xFF;                       /* joystick scan mode init flag */
-static uint32_t sg_joystick_task_stack_size = TDL_JOYSTICK_TASK_STACK_SIZE; /* joystick task stack size */
 static uint8_t tdl_joystick_scan_time = TDL_JOYSTICK_SCAN_TIME;             /* joystick scan time */
 static uint32_t joystick_ticks = 0;
 /***********************************************************
@@ -126,6 +122,22 @@ static OPERATE_RET __tdl_joystick_irq_task(uint8_t enable);
 OPERATE_RET tdl_joystick_calibrated_xy(TDL_JOYSTICK_HANDLE handle, int *x, int *y);
 OPERATE_RET tdl_joystick_raw_xy(TDL_JOYSTICK_HANDLE handle, int channel_x, int channel_y, int *x, int *y);
 
+/**
+ * @brief Also queue the event for readers of the shared input queue.
+ * @param[in] name Joystick name.
+ * @param[in] event Joystick event.
+ */
+static void __tdl_joystick_post_event(char *name, uint8_t event)
+{
+    TDL_INPUT_EVENT_T input_ev = {
+        .src = TDL_INPUT_SRC_JOYSTICK,
+        .event = event,
+        .dev = name,
+    };
+
+    tdl_input_event_post(&input_ev);
+}
+
 /**
  * @brief Initialize joystick linked list structure
  * @return Operation result, OPRT_OK indicates success
@@ -139,12 +151,6 @@ static OPERATE_RET __tdl_joystick_list_init(void)
             return OPRT_MALLOC_FAILED;
         }
 
-        /* Create semaphore for IRQ synchronization */
-        if (tal_semaphore_create_init(&tdl_joystick_local.irq_semaphore, 0, 1) != 0) {
-            PR_ERR("tdl_joystick_semaphore_init err");
-            return OPRT_COM_ERROR;
-        }
-
         /* Create mutex for thread-safe operations */
         if (tal_mutex_create_init(&tdl_joystick_local.mutex) != 0) {
             PR_ERR("tdl_joystick_mutex_init err");
@@ -596,7 +602,7 @@ static void __tdl_joystick_state_handle(TDL_JOYSTICK_LIST_NODE_T *p_node)
 static void __tdl_joystick_irq_cb(void *arg)
 {
     if (tdl_joystick_local.irq_scan_cnt >= TDL_JOYSTICK_IRQ_SCAN_CNT) {
-        tal_semaphore_post(tdl_joystick_local.irq_semaphore);
+        tdl_input_sched_kick(tdl_joystick_local.sched_hdl);
     }
     return;
 }
@@ -691,13 +697,13 @@ OPERATE_RET tdl_joystick_create(char *name, TDL_JOYSTICK_CFG_T *joystick_cfg, TD
     }
 
     if (tdl_joystick_local.task_mode == JOYSTICK_IRQ_TASK) {
-        __tdl_joystick_irq_task(1);
+        ret = __tdl_joystick_irq_task(1);
         if (OPRT_OK != ret) {
             PR_ERR("tdl create err");
             return OPRT_COM_ERROR;
         }
     } else {
-        __tdl_joystick_scan_task(1);
+        ret = __tdl_joystick_scan_task(1);
         if (OPRT_OK != ret) {
             PR_ERR("tdl create err");
             return OPRT_COM_ERROR;
@@ -764,10 +770,11 @@ static void __tdl_joystick_handle(TDL_JOYSTICK_LIST_NODE_T *p_node)
 }
 
 /**
- * @brief Joystick scan task thread, periodically scans all joystick nodes.
- * @param[in] arg Thread argument.
+ * @brief Joystick scan entry, samples all joystick nodes every scan time.
+ * @param[in] arg Entry argument.
+ * @return true, the entry is never parked.
  */
-static void __tdl_joystick_scan_thread(void *arg)
+static bool __tdl_joystick_scan_sample(void *arg)
 {
     TDL_JOYSTICK_LIST_HEAD_T *p_head = p_joystick_list;
     // TDL_JOYSTICK_LIST_HEAD_T *p_combine_head = p_combine_joystick_list;
@@ -775,35 +782,34 @@ static void __tdl_joystick_scan_thread(void *arg)
     // TDL_JOYSTICK_COMBINE_LIST_NODE_T *p_combine_node = NULL;
     LIST_HEAD *pos1 = NULL;
 
-    while (1) {
-        tuya_list_for_each(pos1, &p_head->hdr)
-        {
-            p_node = tuya_list_entry(pos1, TDL_JOYSTICK_LIST_NODE_T, hdr);
-            if ((p_node != NULL) && (p_node->device_data.dev_cfg.stick_mode == JOYSTICK_TIMER_SCAN_MODE)) {
-                tal_mutex_lock(p_node->joystick_mutex);
-                __tdl_joystick_handle(p_node);
-                tal_mutex_unlock(p_node->joystick_mutex);
-            }
+    tuya_list_for_each(pos1, &p_head->hdr)
+    {
+        p_node = tuya_list_entry(pos1, TDL_JOYSTICK_LIST_NODE_T, hdr);
+        if ((p_node != NULL) && (p_node->device_data.dev_cfg.stick_mode == JOYSTICK_TIMER_SCAN_MODE)) {
+            tal_mutex_lock(p_node->joystick_mutex);
+            __tdl_joystick_handle(p_node);
+            tal_mutex_unlock(p_node->joystick_mutex);
         }
+    }
 #if (COMBINE_JOYSTICK_ENABLE == 1)
-        // Handle the case where the interrupt scan count has reached the limit
-        tuya_list_for_each(pos2, &p_combine_head->hdr)
-        {
-            p_combine_node = tuya_list_entry(pos2, TDL_JOYSTICK_COMBINE_LIST_NODE_T, hdr);
-            if (p_combine_node->combine_cb) {
-                p_combine_node->combine_cb();
-            }
+    // Handle the case where the interrupt scan count has reached the limit
+    tuya_list_for_each(pos2, &p_combine_head->hdr)
+    {
+        p_combine_node = tuya_list_entry(pos2, TDL_JOYSTICK_COMBINE_LIST_NODE_T, hdr);
+        if (p_combine_node->combine_cb) {
+            p_combine_node->combine_cb();
         }
-#endif
-        tal_system_sleep(tdl_joystick_scan_time);
     }
+#endif
+    return true;
 }
 
 /**
- * @brief Joystick interrupt scan task thread, handles joystick nodes in interrupt mode.
- * @param[in] arg Thread argument.
+ * @brief Joystick interrupt scan entry, samples joystick nodes in interrupt mode.
+ * @param[in] arg Entry argument.
+ * @return false to park once the interrupt scan count has reached the limit.
  */
-static void __tdl_joystick_irq_thread(void *arg)
+static bool __tdl_joystick_irq_sample(void *arg)
 {
     TDL_JOYSTICK_LIST_HEAD_T *p_head = p_joystick_list;
     // TDL_JOYSTICK_LIST_HEAD_T *p_combine_head = p_combine_joystick_list;
@@ -811,42 +817,34 @@ static void __tdl_joystick_irq_thread(void *arg)
     // TDL_JOYSTICK_COMBINE_LIST_NODE_T *p_combine_node = NULL;
     LIST_HEAD *pos1 = NULL;
 
-    while (1) {
-        PR_NOTICE("semaphore wait");
-        tal_semaphore_wait(tdl_joystick_local.irq_semaphore, SEM_WAIT_FOREVER);
+    // Woken by an interrupt after being parked
+    if (tdl_joystick_local.irq_scan_cnt >= TDL_JOYSTICK_IRQ_SCAN_CNT) {
         tdl_joystick_local.irq_scan_cnt = 0;
-        PR_NOTICE("semaphore across");
-
-        while (1) {
-            tuya_list_for_each(pos1, &p_head->hdr)
-            {
-                p_node = tuya_list_entry(pos1, TDL_JOYSTICK_LIST_NODE_T, hdr);
-                if ((p_node != NULL) && (p_node->device_data.dev_cfg.stick_mode == JOYSTICK_IRQ_MODE)) {
-                    tal_mutex_lock(p_node->joystick_mutex);
-                    __tdl_joystick_handle(p_node);
-                    tal_mutex_unlock(p_node->joystick_mutex);
-                }
-            }
+    }
+
+    tuya_list_for_each(pos1, &p_head->hdr)
+    {
+        p_node = tuya_list_entry(pos1, TDL_JOYSTICK_LIST_NODE_T, hdr);
+        if ((p_node != NULL) && (p_node->device_data.dev_cfg.stick_mode == JOYSTICK_IRQ_MODE)) {
+            tal_mutex_lock(p_node->joystick_mutex);
+            __tdl_joystick_handle(p_node);
+            tal_mutex_unlock(p_node->joystick_mutex);
+        }
+    }
 #if (COMBINE_JOYSTICK_ENABLE == 1)
-            // Handle the case where the interrupt scan count has reached the limit
-            if (tdl_joystick_local.scan_task_flag == FALSE) {
-                tuya_list_for_each(pos2, &p_combine_head->hdr)
-                {
-                    p_combine_node = tuya_list_entry(pos2, TDL_JOYSTICK_COMBINE_LIST_NODE_T, hdr);
-                    if (p_combine_node->combine_cb) {
-                        p_combine_node->combine_cb();
-                    }
-                }
-            }
-#endif
-            // Check if the interrupt scan count has reached the limit
-            if (++tdl_joystick_local.irq_scan_cnt >= TDL_JOYSTICK_IRQ_SCAN_CNT) {
-                break;
-            } else {
-                tal_system_sleep(tdl_joystick_scan_time);
+    // Handle the case where the interrupt scan count has reached the limit
+    if (tdl_joystick_local.scan_task_flag == FALSE) {
+        tuya_list_for_each(pos2, &p_combine_head->hdr)
+        {
+            p_combine_node = tuya_list_entry(pos2, TDL_JOYSTICK_COMBINE_LIST_NODE_T, hdr);
+            if (p_combine_node->combine_cb) {
+                p_combine_node->combine_cb();
             }
         }
     }
+#endif
+    // Check if the interrupt scan count has reached the limit
+    return (++tdl_joystick_local.irq_scan_cnt >= TDL_JOYSTICK_IRQ_SCAN_CNT) ? false : true;
 }
 
 /**
@@ -860,29 +858,23 @@ static OPERATE_RET __tdl_joystick_scan_task(uint8_t enable)
 
     if (tdl_joystick_local.task_mode & JOYSTICK_SCAN_TASK) {
         if (enable != 0) {
-            // Establish scan task
+            // Establish scan entry
             if (tdl_joystick_local.scan_task_flag == FALSE) {
-
-                THREAD_CFG_T thrd_param = {0};
-
-                thrd_param.thrdname = "joystick_scan";
-                thrd_param.priority = THREAD_PRIO_1;
-                thrd_param.stackDepth = sg_joystick_task_stack_size;
-                if (NULL == stick_scan_thread_handle) {
-                    ret = tal_thread_create_and_start(&stick_scan_thread_handle, NULL, NULL, __tdl_joystick_scan_thread,
-                                                      NULL, &thrd_param);
-                    if (OPRT_OK != ret) {
-                        PR_ERR("scan_task create error!");
-                        return ret;
-                    }
+                ret = tdl_input_sched_add(__tdl_joystick_scan_sample, NULL, tdl_joystick_scan_time, false,
+                                          &tdl_joystick_local.sched_hdl);
+                if (OPRT_OK != ret) {
+                    PR_ERR("scan_task create error!");
+                    return ret;
                 }
                 tdl_joystick_local.scan_task_flag = TRUE;
-                PR_DEBUG("joystick_scan task stack size:%d", sg_joystick_task_stack_size);
             }
-        } else {
-            // Disable scan task
-            tal_thread_delete(stick_scan_thread_handle);
+            ret = OPRT_OK;
+        } else if (tdl_joystick_local.scan_task_flag == TRUE) {
+            // Disable scan entry
+            tdl_input_sched_remove(tdl_joystick_local.sched_hdl);
+            tdl_joystick_local.sched_hdl = NULL;
             tdl_joystick_local.scan_task_flag = FALSE;
+            ret = OPRT_OK;
         }
     }
     return ret;
@@ -898,29 +890,23 @@ static OPERATE_RET __tdl_joystick_irq_task(uint8_t enable)
     OPERATE_RET ret = OPRT_COM_ERROR;
     if (tdl_joystick_local.task_mode & JOYSTICK_IRQ_TASK) {
         if (enable != 0) {
-            // Establish interrupt scan task
+            // Establish interrupt scan entry, parked until the first interrupt
             if (tdl_joystick_local.irq_task_flag == FALSE) {
-                THREAD_CFG_T thrd_param = {0};
-
-                thrd_param.thrdname = "joystick_irq";
-                thrd_param.priority = THREAD_PRIO_1;
-                thrd_param.stackDepth = sg_joystick_task_stack_size;
-                if (NULL == stick_irq_thread_handle) {
-                    ret = tal_thread_create_and_start(&stick_irq_thread_handle, NULL, NULL, __tdl_joystick_irq_thread,
-                                                      NULL, &thrd_param);
-                    if (OPRT_OK != ret) {
-                        PR_ERR("irq_task create error!");
-                        return ret;
-                    }
+                tdl_joystick_local.irq_scan_cnt = TDL_JOYSTICK_IRQ_SCAN_CNT;
+                ret = tdl_input_sched_add(__tdl_joystick_irq_sample, NULL, tdl_joystick_scan_time, true,
+                                          &tdl_joystick_local.sched_hdl);
+                if (OPRT_OK != ret) {
+                    PR_ERR("irq_task create error!");
+                    return ret;
                 }
                 tdl_joystick_local.irq_task_flag = TRUE;
-                PR_DEBUG("joystick_irq task stack size:%d", sg_joystick_task_stack_size);
             } else {
                 PR_WARN("joystick irq tast have already creat");
             }
-        } else {
-            // Disable interrupt scan task
-            tal_thread_delete(stick_irq_thread_handle);
+        } else if (tdl_joystick_local.irq_task_flag == TRUE) {
+            // Disable interrupt scan entry
+            tdl_input_sched_remove(tdl_joystick_local.sched_hdl);
+            tdl_joystick_local.sched_hdl = NULL;
             tdl_joystick_local.irq_task_flag = FALSE;
         }
     }
@@ -1056,9 +1042,8 @@ OPERATE_RET tdl_joystick_deep_sleep_ctrl(uint8_t enable)
  */
 OPERATE_RET tdl_joystick_set_task_stack_size(uint32_t size)
 {
-    sg_joystick_task_stack_size = size;
-
-    return OPRT_OK;
+    // Joystick callbacks run on the shared input scheduler thread
+    return tdl_input_sched_set_stack_size(size);
 }
 
 /**
@@ -1147,6 +1132,11 @@ OPERATE_RET tdl_joystick_set_scan_time(uint8_t time_ms)
         return OPRT_INVALID_PARM;
     tdl_joystick_scan_time = time_ms;
     tdl_joystick_local.irq_scan_cnt = TDL_JOYSTICK_IRQ_SCAN_TIME / time_ms;
+    // Re-add a running entry so it is sampled at the new period
+    if (tdl_joystick_local.sched_hdl) {
+        tdl_joystick_deep_sleep_ctrl(0);
+        return tdl_joystick_deep_sleep_ctrl(1);
+    }
     return OPRT_OK;
 }
 
@@ -22,6 +22,8 @@
 ***********************************************************/
 #define COLOR_PRIMARY_MAX 5
 
+#define COLOR_PRIMARY_NUM 3
+
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
@@ -142,6 +144,103 @@ OPERATE_RET tdd_pixel_create_tx_ctrl(unsigned int tx_buff_len, DRV_PIXEL_TX_CTRL
 
     return OPRT_OK;
 }
+/**
+ * @function:tdd_pixel_tx_ctrl_set_spi_code
+ * @brief: Build the lookup table of SPI symbols for the 0 and 1 codes of a chip
+ * @param[in]   tx_ctrl             the point of DRV_PIXEL_TX_CTRL_T
+ * @param[in]   chip_ic_0           0 code
+ * @param[in]   chip_ic_1           1 code
+ * @return: success -> OPRT_OK
+ */
+OPERATE_RET tdd_pixel_tx_ctrl_set_spi_code(DRV_PIXEL_TX_CTRL_T *tx_ctrl, unsigned char chip_ic_0,
+                                           unsigned char chip_ic_1)
+{
+    unsigned int i = 0;
+
+    if (NULL == tx_ctrl) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (NULL == tx_ctrl->spi_lut) {
+        tx_ctrl->spi_lut = (DRV_PIXEL_SPI_LUT_T *)tal_malloc(sizeof(DRV_PIXEL_SPI_LUT_T));
+        if (NULL == tx_ctrl->spi_lut) {
+            return OPRT_MALLOC_FAILED;
+        }
+    }
+
+    for (i = 0; i < PIXEL_SPI_LUT_SIZE; i++) {
+        tdd_rgb_transform_spi_data((unsigned char)i, chip_ic_0, chip_ic_1, tx_ctrl->spi_lut->symbol[i].code);
+    }
+
+    return OPRT_OK;
+}
+
+static void __rgb_line_seq_index(RGB_ORDER_MODE_E rgb_order, unsigned char *index)
+{
+    static const unsigned char sc_line_seq[][COLOR_PRIMARY_NUM] = {
+        [RGB_ORDER] = {0, 1, 2}, [RBG_ORDER] = {0, 2, 1}, [GRB_ORDER] = {1, 0, 2},
+        [GBR_ORDER] = {1, 2, 0}, [BRG_ORDER] = {2, 0, 1}, [BGR_ORDER] = {2, 1, 0},
+    };
+
+    if (rgb_order >= CNTSOF(sc_line_seq)) {
+        rgb_order = RGB_ORDER;
+    }
+
+    memcpy(index, sc_line_seq[rgb_order], COLOR_PRIMARY_NUM);
+}
+
+/**
+ * @function:tdd_pixel_spi_encode
+ * @brief: Convert color data to the line sequence of the chip and encode it with the lookup table
+ * @param[in]   tx_ctrl             the point of DRV_PIXEL_TX_CTRL_T
+ * @param[in]   data_buf            color data
+ * @param[in]   buf_len             color data length
+ * @param[in]   color_nums          channels per pixel in data_buf
+ * @param[in]   rgb_order           line sequence of the chip
+ * @return: number of bytes encoded
+ */
+unsigned int tdd_pixel_spi_encode(DRV_PIXEL_TX_CTRL_T *tx_ctrl, unsigned short *data_buf, unsigned int buf_len,
+                                  unsigned char color_nums, RGB_ORDER_MODE_E rgb_order)
+{
+    const DRV_PIXEL_SPI_SYMBOL_T *symbol = NULL;
+    unsigned char index[COLOR_PRIMARY_NUM];
+    unsigned char *dst = NULL;
+    unsigned int *dst_word = NULL;
+    unsigned int pixel_num = 0, i = 0, j = 0;
+
+    if (NULL == tx_ctrl || NULL == tx_ctrl->spi_lut || NULL == data_buf || color_nums < COLOR_PRIMARY_NUM) {
+        return 0;
+    }
+
+    __rgb_line_seq_index(rgb_order, index);
+
+    pixel_num = MIN(buf_len / color_nums, tx_ctrl->tx_buffer_len / (ONE_BYTE_LEN * COLOR_PRIMARY_NUM));
+    dst = tx_ctrl->tx_buffer;
+
+    // tx_buffer follows the control block and is word aligned, memcpy covers any other buffer
+    if (0 == ((unsigned long)dst & (sizeof(unsigned int) - 1))) {
+        dst_word = (unsigned int *)dst;
+        for (i = 0; i < pixel_num; i++, data_buf += color_nums) {
+            for (j = 0; j < COLOR_PRIMARY_NUM; j++) {
+                symbol = &tx_ctrl->spi_lut->symbol[(unsigned char)data_buf[index[j]]];
+                dst_word[0] = symbol->word[0];
+                dst_word[1] = symbol->word[1];
+                dst_word += ONE_BYTE_LEN / sizeof(unsigned int);
+            }
+        }
+    } else {
+        for (i = 0; i < pixel_num; i++, data_buf += color_nums) {
+            for (j = 0; j < COLOR_PRIMARY_NUM; j++) {
+                symbol = &tx_ctrl->spi_lut->symbol[(unsigned char)data_buf[index[j]]];
+                memcpy(dst, symbol->code, ONE_BYTE_LEN);
+                dst += ONE_BYTE_LEN;
+            }
+        }
+    }
+
+    return pixel_num * ONE_BYTE_LEN * COLOR_PRIMARY_NUM;
+}
+
 /**
  * @function:tdd_pixel_tx_ctrl_release
  * @brief: Release the buffer for storing sending control parameters
@@ -154,6 +253,9 @@ OPERATE_RET tdd_pixel_tx_ctrl_release(DRV_PIXEL_TX_CTRL_T *tx_ctrl)
         return OPRT_INVALID_PARM;
     }
 
+    if (tx_ctrl->spi_lut) {
+        tal_free(tx_ctrl->spi_lut);
+    }
     tal_free(tx_ctrl);
 
     return OPRT_OK;
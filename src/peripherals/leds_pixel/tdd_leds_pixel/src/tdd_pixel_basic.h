@@ -25,13 +25,26 @@ extern "C" {
 ***********************************************************/
 #define ONE_BYTE_LEN 8
 
+#define PIXEL_SPI_LUT_SIZE 256
+
 /***********************************************************
 ****************************typedef define****************************
 *********************************************************************/
 
+// SPI bytes of one colour byte, MSB first, as words for the fast path
+typedef union {
+    unsigned char code[ONE_BYTE_LEN];
+    unsigned int word[ONE_BYTE_LEN / sizeof(unsigned int)];
+} DRV_PIXEL_SPI_SYMBOL_T;
+
+typedef struct {
+    DRV_PIXEL_SPI_SYMBOL_T symbol[PIXEL_SPI_LUT_SIZE];
+} DRV_PIXEL_SPI_LUT_T;
+
 typedef struct {
     unsigned char *tx_buffer;   // Data -> buffer after data stream is converted to SPI data
     unsigned int tx_buffer_len; // Data length -> length of buffer after data stream is converted to SPI data
+    DRV_PIXEL_SPI_LUT_T *spi_lut; // SPI symbols of every colour byte, set by tdd_pixel_tx_ctrl_set_spi_code
 } DRV_PIXEL_TX_CTRL_T;
 
 /***********************************************************
@@ -71,6 +84,35 @@ OPERATE_RET tdd_rgb_line_seq_transform(unsigned short *data_buf, unsigned short
  */
 OPERATE_RET tdd_pixel_create_tx_ctrl(unsigned int tx_buff_len, DRV_PIXEL_TX_CTRL_T **p_pixel_tx);
 
+/**
+ * @brief      Build the lookup table that expands a colour byte into its SPI symbols
+ *
+ * @param[in]   tx_ctrl           Transmission control parameter
+ * @param[in]   chip_ic_0         Bit 0 code
+ * @param[in]   chip_ic_1         Bit 1 code
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+OPERATE_RET tdd_pixel_tx_ctrl_set_spi_code(DRV_PIXEL_TX_CTRL_T *tx_ctrl, unsigned char chip_ic_0,
+                                           unsigned char chip_ic_1);
+
+/**
+ * @brief      Convert color data to the line sequence of the chip and encode it into tx_buffer
+ *
+ * Only the first three channels of every pixel are encoded, pixels that do not
+ * fit into tx_buffer are ignored.
+ *
+ * @param[in]   tx_ctrl           Transmission control parameter, with the lookup table set
+ * @param[in]   data_buf          Color data
+ * @param[in]   buf_len           Color data length
+ * @param[in]   color_nums        Channels per pixel in data_buf
+ * @param[in]   rgb_order         RGB color order of the chip
+ *
+ * @return Number of bytes encoded
+ */
+unsigned int tdd_pixel_spi_encode(DRV_PIXEL_TX_CTRL_T *tx_ctrl, unsigned short *data_buf, unsigned int buf_len,
+                                  unsigned char color_nums, RGB_ORDER_MODE_E rgb_order);
+
 /**
  * @brief      Release buffer for transmission control parameters
  *
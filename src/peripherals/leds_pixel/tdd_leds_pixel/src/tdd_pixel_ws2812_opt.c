@@ -85,6 +85,12 @@ static OPERATE_RET __tdd_2812_driver_open(DRIVER_HANDLE_T *handle, unsigned shor
         return op_ret;
     }
 
+    op_ret = tdd_pixel_tx_ctrl_set_spi_code(pixels_send, DRVICE_DATA_0, DRVICE_DATA_1);
+    if (op_ret != OPRT_OK) {
+        tdd_pixel_tx_ctrl_release(pixels_send);
+        return op_ret;
+    }
+
     if (NULL != g_pwm_cfg) {
       op_ret = tdd_pixel_pwm_open(g_pwm_cfg);
       if (op_ret != OPRT_OK) {
@@ -109,8 +115,6 @@ static OPERATE_RET __tdd_ws2812_driver_send_data(DRIVER_HANDLE_T handle, unsigne
 {
     OPERATE_RET ret = OPRT_OK;
     DRV_PIXEL_TX_CTRL_T *tx_ctrl = NULL;
-    unsigned short swap_buf[COLOR_PRIMARY_NUM] = {0};
-    unsigned int i = 0, j = 0, idx = 0;
     unsigned char color_nums = COLOR_PRIMARY_NUM;
 
     if (NULL == handle || NULL == data_buf || 0 == buf_len) {
@@ -131,15 +135,7 @@ static OPERATE_RET __tdd_ws2812_driver_send_data(DRIVER_HANDLE_T handle, unsigne
     }
 
     tx_ctrl = (DRV_PIXEL_TX_CTRL_T *)handle;
-    for (j = 0; j < buf_len / color_nums; j++) {
-        memset(swap_buf, 0, sizeof(swap_buf));
-        tdd_rgb_line_seq_transform(&data_buf[j * color_nums], swap_buf, driver_info.line_seq);
-        for (i = 0; i < COLOR_PRIMARY_NUM; i++) {
-            tdd_rgb_transform_spi_data((unsigned char)swap_buf[i], DRVICE_DATA_0, DRVICE_DATA_1,
-                                       &tx_ctrl->tx_buffer[idx]);
-            idx += ONE_BYTE_LEN;
-        }
-    }
+    tdd_pixel_spi_encode(tx_ctrl, data_buf, buf_len, color_nums, driver_info.line_seq);
 
     ret = tkl_spi_send(driver_info.port, tx_ctrl->tx_buffer, tx_ctrl->tx_buffer_len);
 
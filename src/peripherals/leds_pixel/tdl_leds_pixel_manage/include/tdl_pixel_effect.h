@@ -0,0 +1,114 @@
+/**
+ * @file tdl_pixel_effect.h
+ * @brief Frame based effects engine for LED pixel devices
+ *
+ * The engine owns the strip while it runs. Every frame is composed as a whole
+ * into a back buffer, the buffers are swapped on the next tick of a fixed rate
+ * timer and the front buffer is sent from the engine task right away, before
+ * the next frame is composed. The send time therefore does not depend on how
+ * long an effect takes to draw, and the animation advances by frame count, not
+ * by wall clock.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __TDL_PIXEL_EFFECT_H__
+#define __TDL_PIXEL_EFFECT_H__
+
+#include "tdl_pixel_dev_manage.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************************************************************
+******************************macro define****************************
+*********************************************************************/
+#define PIXEL_EFFECT_COLOR_MAX 4
+
+// music level, as given to tdl_pixel_effect_set_level()
+#define PIXEL_EFFECT_LEVEL_MAX 1000
+
+/*********************************************************************
+****************************typedef define****************************
+*********************************************************************/
+typedef unsigned char PIXEL_EFFECT_TYPE_E;
+#define PIXEL_EFFECT_STATIC   0x00 // color[0] on every pixel
+#define PIXEL_EFFECT_GRADIENT 0x01 // colors blended along the strip, scrolls once per period
+#define PIXEL_EFFECT_CHASE    0x02 // length pixels of color[0] over color[1], one lap per period
+#define PIXEL_EFFECT_BREATH   0x03 // fades in and out once per period, the next color every cycle
+#define PIXEL_EFFECT_MUSIC    0x04 // level meter from color[0] to color[1], falls back within period
+
+typedef struct {
+    PIXEL_EFFECT_TYPE_E type;
+    uint8_t color_cnt;
+    uint16_t length;    // chase only, 0 means one pixel
+    uint32_t period_ms; // 0 freezes the animation
+    PIXEL_COLOR_T color[PIXEL_EFFECT_COLOR_MAX];
+} PIXEL_EFFECT_CFG_T;
+
+typedef struct {
+    uint32_t frames;  // frames sent
+    uint32_t overrun; // ticks that found the last frame still being composed or sent
+} PIXEL_EFFECT_STATS_T;
+
+/*********************************************************************
+****************************function define***************************
+*********************************************************************/
+/**
+ * @brief    Start the effects engine on an open device
+ *
+ * The strip shows nothing until tdl_pixel_effect_set() is called. The other
+ * tdl_pixel_* color functions must not be used while the engine runs.
+ *
+ * @param[in]    handle           Device handle
+ * @param[in]    fps              Frame rate
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+int tdl_pixel_effect_start(PIXEL_HANDLE_T handle, uint16_t fps);
+
+/**
+ * @brief    Change the effect, it starts from its first frame on the next tick
+ *
+ * @param[in]    handle           Device handle
+ * @param[in]    cfg              Effect
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+int tdl_pixel_effect_set(PIXEL_HANDLE_T handle, PIXEL_EFFECT_CFG_T *cfg);
+
+/**
+ * @brief    Feed the music effect, for example with the loudness of an audio block
+ *
+ * @param[in]    handle           Device handle
+ * @param[in]    level            0 ~ PIXEL_EFFECT_LEVEL_MAX
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+int tdl_pixel_effect_set_level(PIXEL_HANDLE_T handle, uint16_t level);
+
+/**
+ * @brief    Read the engine counters
+ *
+ * @param[in]    handle           Device handle
+ * @param[out]   stats            Counters
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+int tdl_pixel_effect_get_stats(PIXEL_HANDLE_T handle, PIXEL_EFFECT_STATS_T *stats);
+
+/**
+ * @brief    Stop the effects engine, the last frame stays on the strip
+ *
+ * @param[in]    handle           Device handle
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+int tdl_pixel_effect_stop(PIXEL_HANDLE_T handle);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /*__TDL_PIXEL_EFFECT_H__*/
@@ -226,6 +226,21 @@ static OPERATE_RET __tdl_pixel_left_shift(uint16_t *buff, uint8_t color_num, int
     return OPRT_OK;
 }
 
+/**
+ * @brief    Convert a color into the channels of a device, in any buffer laid out like pixel_buffer
+ *
+ * @param[in]    device           Device
+ * @param[out]   buff             Channel buffer
+ * @param[in]    index            Pixel index
+ * @param[in]    color            Color
+ *
+ * @return none
+ */
+void tdl_pixel_color_to_buffer(PIXEL_DEV_NODE_T *device, uint16_t *buff, uint32_t index, PIXEL_COLOR_T *color)
+{
+    __tdl_pixel_set_color((PIXEL_HANDLE_T)device, buff, device->pixel_color, device->color_num, index, color);
+}
+
 /**
  * @brief    Set pixel segment color (single)
  *
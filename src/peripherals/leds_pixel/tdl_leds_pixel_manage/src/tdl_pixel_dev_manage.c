@@ -197,6 +197,11 @@ static int __tdl_pixel_dev_close(PIXEL_DEV_NODE_T *device)
         return OPRT_COM_ERROR;
     }
 
+    if (NULL != device->effect) {
+        PR_ERR("stop the pixel effect first");
+        return OPRT_COM_ERROR;
+    }
+
     op_ret =
         device->intfs->close(&device->drv_handle); // Original: &device->pixel_drv_handle changed to &device->drv_handle
     if (op_ret != 0) {
@@ -311,6 +316,11 @@ static OPERATE_RET __tdl_pixel_dev_num_set(PIXEL_HANDLE_T *handle, uint16_t num)
         PR_NOTICE("dev pixel num:%d is same", num);
         return OPRT_OK;
     }
+
+    if (NULL != device->effect) {
+        PR_ERR("stop the pixel effect first");
+        return OPRT_COM_ERROR;
+    }
     device->pixel_num = num;
 
     /* tdd resource re-apply */
@@ -0,0 +1,514 @@
+/**
+ * @file tdl_pixel_effect.c
+ * @brief Frame based effects engine for LED pixel devices
+ *
+ * A fixed rate software timer wakes the engine task. On every tick the task
+ * swaps in the frame composed during the previous tick, hands it to the driver
+ * (SPI DMA on the SPI drivers) and then composes the next frame into the back
+ * buffer. Effects are drawn from the frame index, so a late tick delays a frame
+ * but never makes the animation jump.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#include <string.h>
+
+#include "tal_log.h"
+#include "tal_memory.h"
+#include "tal_thread.h"
+#include "tal_sw_timer.h"
+#include "tdl_pixel_effect.h"
+
+/***********************************************************
+*************************private include********************
+***********************************************************/
+#include "tdl_pixel_struct.h"
+
+/***********************************************************
+*************************micro define***********************
+***********************************************************/
+#define PIXEL_EFFECT_FPS_MAX 100
+
+#ifndef PIXEL_EFFECT_TASK_PRIO
+#define PIXEL_EFFECT_TASK_PRIO THREAD_PRIO_1
+#endif
+
+#ifndef PIXEL_EFFECT_TASK_STACK
+#define PIXEL_EFFECT_TASK_STACK 2048
+#endif
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    PIXEL_DEV_NODE_T *device;
+
+    THREAD_HANDLE thrd;
+    TIMER_ID timer;
+    SEM_HANDLE tick_sem;
+    SEM_HANDLE exit_sem;
+    BOOL_T is_running;
+
+    uint32_t frame_ms;
+    uint16_t *buffer[2];
+    uint8_t front;
+    BOOL_T has_frame; // front buffer holds a composed frame
+    SYS_TIME_T last_send;
+
+    // protected by the device mutex
+    PIXEL_EFFECT_CFG_T cfg;
+    BOOL_T has_cfg;
+    BOOL_T cfg_changed;
+    uint16_t level_in;
+    PIXEL_EFFECT_STATS_T stats;
+
+    // engine task only
+    uint32_t frame_idx;
+    uint16_t level;
+} PIXEL_EFFECT_T;
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static void __effect_mix(PIXEL_COLOR_T *a, PIXEL_COLOR_T *b, uint32_t num, uint32_t den, PIXEL_COLOR_T *out)
+{
+    if (0 == den) {
+        *out = *a;
+        return;
+    }
+
+    out->red = (uint16_t)(a->red + ((int32_t)b->red - a->red) * (int32_t)num / (int32_t)den);
+    out->green = (uint16_t)(a->green + ((int32_t)b->green - a->green) * (int32_t)num / (int32_t)den);
+    out->blue = (uint16_t)(a->blue + ((int32_t)b->blue - a->blue) * (int32_t)num / (int32_t)den);
+    out->cold = (uint16_t)(a->cold + ((int32_t)b->cold - a->cold) * (int32_t)num / (int32_t)den);
+    out->warm = (uint16_t)(a->warm + ((int32_t)b->warm - a->warm) * (int32_t)num / (int32_t)den);
+}
+
+static void __effect_scale(PIXEL_COLOR_T *color, uint32_t level, PIXEL_COLOR_T *out)
+{
+    out->red = (uint16_t)(color->red * level / PIXEL_EFFECT_LEVEL_MAX);
+    out->green = (uint16_t)(color->green * level / PIXEL_EFFECT_LEVEL_MAX);
+    out->blue = (uint16_t)(color->blue * level / PIXEL_EFFECT_LEVEL_MAX);
+    out->cold = (uint16_t)(color->cold * level / PIXEL_EFFECT_LEVEL_MAX);
+    out->warm = (uint16_t)(color->warm * level / PIXEL_EFFECT_LEVEL_MAX);
+}
+
+// position of the frame inside the period, scaled to 0 ~ range
+static uint32_t __effect_phase(PIXEL_EFFECT_CFG_T *cfg, uint32_t time_ms, uint32_t range)
+{
+    if (0 == cfg->period_ms) {
+        return 0;
+    }
+
+    return (uint32_t)((uint64_t)(time_ms % cfg->period_ms) * range / cfg->period_ms);
+}
+
+static void __effect_draw_gradient(PIXEL_EFFECT_T *eff, PIXEL_EFFECT_CFG_T *cfg, uint32_t time_ms, uint16_t *buff)
+{
+    PIXEL_DEV_NODE_T *device = eff->device;
+    uint32_t n = device->pixel_num, shift = 0, pos = 0, seg = 0, i;
+    PIXEL_COLOR_T color;
+
+    // the colors form a closed loop so the scroll has no seam
+    shift = __effect_phase(cfg, time_ms, n);
+    for (i = 0; i < n; i++) {
+        pos = (uint32_t)((uint64_t)((i + shift) % n) * cfg->color_cnt * 256 / n);
+        seg = pos >> 8;
+        __effect_mix(&cfg->color[seg], &cfg->color[(seg + 1) % cfg->color_cnt], pos & 0xFF, 256, &color);
+        tdl_pixel_color_to_buffer(device, buff, i, &color);
+    }
+}
+
+static void __effect_draw_chase(PIXEL_EFFECT_T *eff, PIXEL_EFFECT_CFG_T *cfg, uint32_t time_ms, uint16_t *buff)
+{
+    PIXEL_DEV_NODE_T *device = eff->device;
+    PIXEL_COLOR_T back = {0}, color;
+    uint32_t n = device->pixel_num, length = 0, head = 0, dist = 0, i;
+
+    if (cfg->color_cnt > 1) {
+        back = cfg->color[1];
+    }
+    length = MIN(MAX(cfg->length, 1), n);
+    head = __effect_phase(cfg, time_ms, n);
+
+    // the tail fades into the background
+    for (i = 0; i < n; i++) {
+        dist = (head + n - i) % n;
+        if (dist < length) {
+            __effect_mix(&cfg->color[0], &back, dist, length, &color);
+        } else {
+            color = back;
+        }
+        tdl_pixel_color_to_buffer(device, buff, i, &color);
+    }
+}
+
+static void __effect_draw_breath(PIXEL_EFFECT_T *eff, PIXEL_EFFECT_CFG_T *cfg, uint32_t time_ms, uint16_t *buff)
+{
+    PIXEL_DEV_NODE_T *device = eff->device;
+    PIXEL_COLOR_T color;
+    uint32_t tri = 0, idx = 0, i;
+
+    if (0 == cfg->period_ms) {
+        color = cfg->color[0];
+    } else {
+        tri = __effect_phase(cfg, time_ms, 2 * PIXEL_EFFECT_LEVEL_MAX);
+        if (tri > PIXEL_EFFECT_LEVEL_MAX) {
+            tri = 2 * PIXEL_EFFECT_LEVEL_MAX - tri;
+        }
+        idx = (time_ms / cfg->period_ms) % cfg->color_cnt;
+        // squared so the fade looks even to the eye
+        __effect_scale(&cfg->color[idx], tri * tri / PIXEL_EFFECT_LEVEL_MAX, &color);
+    }
+
+    for (i = 0; i < device->pixel_num; i++) {
+        tdl_pixel_color_to_buffer(device, buff, i, &color);
+    }
+}
+
+static void __effect_draw_music(PIXEL_EFFECT_T *eff, PIXEL_EFFECT_CFG_T *cfg, uint16_t level_in, uint16_t *buff)
+{
+    PIXEL_DEV_NODE_T *device = eff->device;
+    PIXEL_COLOR_T off = {0}, color;
+    PIXEL_COLOR_T *top = (cfg->color_cnt > 1) ? &cfg->color[1] : &cfg->color[0];
+    uint32_t n = device->pixel_num, fall = PIXEL_EFFECT_LEVEL_MAX, lit = 0, i;
+
+    // rises at once, falls back from full scale within one period
+    if (cfg->period_ms) {
+        fall = MAX(1, PIXEL_EFFECT_LEVEL_MAX * eff->frame_ms / cfg->period_ms);
+    }
+    if (level_in >= eff->level) {
+        eff->level = level_in;
+    } else {
+        eff->level = (eff->level - level_in > fall) ? (eff->level - fall) : level_in;
+    }
+
+    lit = (uint32_t)eff->level * n / PIXEL_EFFECT_LEVEL_MAX;
+    for (i = 0; i < n; i++) {
+        if (i < lit) {
+            __effect_mix(&cfg->color[0], top, i, n, &color);
+            tdl_pixel_color_to_buffer(device, buff, i, &color);
+        } else {
+            tdl_pixel_color_to_buffer(device, buff, i, &off);
+        }
+    }
+}
+
+static void __effect_compose(PIXEL_EFFECT_T *eff, PIXEL_EFFECT_CFG_T *cfg, uint16_t level_in, uint16_t *buff)
+{
+    uint32_t time_ms = eff->frame_idx * eff->frame_ms;
+    uint32_t i;
+
+    switch (cfg->type) {
+    case PIXEL_EFFECT_GRADIENT:
+        __effect_draw_gradient(eff, cfg, time_ms, buff);
+        break;
+    case PIXEL_EFFECT_CHASE:
+        __effect_draw_chase(eff, cfg, time_ms, buff);
+        break;
+    case PIXEL_EFFECT_BREATH:
+        __effect_draw_breath(eff, cfg, time_ms, buff);
+        break;
+    case PIXEL_EFFECT_MUSIC:
+        __effect_draw_music(eff, cfg, level_in, buff);
+        break;
+    case PIXEL_EFFECT_STATIC:
+    default:
+        for (i = 0; i < eff->device->pixel_num; i++) {
+            tdl_pixel_color_to_buffer(eff->device, buff, i, &cfg->color[0]);
+        }
+        break;
+    }
+
+    eff->frame_idx++;
+}
+
+static void __effect_tick_cb(TIMER_ID timer_id, void *arg)
+{
+    PIXEL_EFFECT_T *eff = (PIXEL_EFFECT_T *)arg;
+
+    // at most one tick is pending, a slow frame is not caught up
+    tal_semaphore_post(eff->tick_sem);
+}
+
+static void __effect_task(void *arg)
+{
+    PIXEL_EFFECT_T *eff = (PIXEL_EFFECT_T *)arg;
+    PIXEL_DEV_NODE_T *device = eff->device;
+    PIXEL_EFFECT_CFG_T cfg;
+    BOOL_T has_cfg = FALSE, is_composed = FALSE;
+    uint16_t level_in = 0;
+    SYS_TIME_T now = 0;
+    THREAD_HANDLE thrd = NULL;
+    int op_ret = OPRT_OK;
+
+    while (1) {
+        tal_semaphore_wait(eff->tick_sem, SEM_WAIT_FOREVER);
+        if (!eff->is_running) {
+            break;
+        }
+
+        tal_mutex_lock(device->mutex);
+
+        if (is_composed) {
+            eff->front ^= 1;
+            eff->has_frame = TRUE;
+            is_composed = FALSE;
+        }
+
+        if (eff->has_frame) {
+            now = tal_system_get_millisecond();
+            if (eff->stats.frames && (uint32_t)(now - eff->last_send) > eff->frame_ms + eff->frame_ms / 2) {
+                eff->stats.overrun++;
+            }
+            eff->last_send = now;
+
+            op_ret = device->intfs->output(device->drv_handle, eff->buffer[eff->front], device->pixel_buffer_len);
+            if (op_ret != OPRT_OK) {
+                PR_ERR("device:%s output is fail:%d!", device->name, op_ret);
+            }
+            eff->stats.frames++;
+        }
+
+        if (eff->cfg_changed) {
+            eff->frame_idx = 0;
+            eff->cfg_changed = FALSE;
+        }
+        cfg = eff->cfg;
+        has_cfg = eff->has_cfg;
+        level_in = eff->level_in;
+
+        tal_mutex_unlock(device->mutex);
+
+        // the back buffer belongs to this task only
+        if (has_cfg) {
+            __effect_compose(eff, &cfg, level_in, eff->buffer[eff->front ^ 1]);
+            is_composed = TRUE;
+        }
+    }
+
+    thrd = eff->thrd;
+    eff->thrd = NULL;
+    tal_semaphore_post(eff->exit_sem);
+
+    tal_thread_delete(thrd);
+}
+
+static void __effect_free(PIXEL_EFFECT_T *eff)
+{
+    if (eff->timer) {
+        tal_sw_timer_stop(eff->timer);
+        tal_sw_timer_delete(eff->timer);
+    }
+    if (eff->tick_sem) {
+        tal_semaphore_release(eff->tick_sem);
+    }
+    if (eff->exit_sem) {
+        tal_semaphore_release(eff->exit_sem);
+    }
+    if (eff->buffer[0]) {
+        tal_free(eff->buffer[0]);
+    }
+    if (eff->buffer[1]) {
+        tal_free(eff->buffer[1]);
+    }
+
+    tal_free(eff);
+}
+
+/**
+ * @brief    Start the effects engine on an open device
+ *
+ * @param[in]    handle           Device handle
+ * @param[in]    fps              Frame rate
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+int tdl_pixel_effect_start(PIXEL_HANDLE_T handle, uint16_t fps)
+{
+    OPERATE_RET rt = OPRT_OK;
+    PIXEL_DEV_NODE_T *device = (PIXEL_DEV_NODE_T *)handle;
+    PIXEL_EFFECT_T *eff = NULL;
+    uint32_t buf_size = 0;
+    THREAD_CFG_T thrd_cfg = {PIXEL_EFFECT_TASK_STACK, PIXEL_EFFECT_TASK_PRIO, "pixel_effect"};
+
+    if (NULL == device || 0 == fps || fps > PIXEL_EFFECT_FPS_MAX) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (0 == device->flag.is_start || NULL != device->effect) {
+        return OPRT_COM_ERROR;
+    }
+
+    eff = (PIXEL_EFFECT_T *)tal_malloc(sizeof(PIXEL_EFFECT_T));
+    if (NULL == eff) {
+        return OPRT_MALLOC_FAILED;
+    }
+    memset(eff, 0, sizeof(PIXEL_EFFECT_T));
+
+    eff->device = device;
+    eff->frame_ms = 1000 / fps;
+
+    buf_size = device->pixel_buffer_len * sizeof(uint16_t);
+    eff->buffer[0] = (uint16_t *)tal_malloc(buf_size);
+    eff->buffer[1] = (uint16_t *)tal_malloc(buf_size);
+    if (NULL == eff->buffer[0] || NULL == eff->buffer[1]) {
+        rt = OPRT_MALLOC_FAILED;
+        goto __ERR;
+    }
+    memset(eff->buffer[0], 0, buf_size);
+    memset(eff->buffer[1], 0, buf_size);
+
+    TUYA_CALL_ERR_GOTO(tal_semaphore_create_init(&eff->tick_sem, 0, 1), __ERR);
+    TUYA_CALL_ERR_GOTO(tal_semaphore_create_init(&eff->exit_sem, 0, 1), __ERR);
+    TUYA_CALL_ERR_GOTO(tal_sw_timer_create(__effect_tick_cb, eff, &eff->timer), __ERR);
+
+    eff->is_running = TRUE;
+    TUYA_CALL_ERR_GOTO(tal_thread_create_and_start(&eff->thrd, NULL, NULL, __effect_task, eff, &thrd_cfg), __ERR);
+
+    tal_mutex_lock(device->mutex);
+    device->effect = eff;
+    tal_mutex_unlock(device->mutex);
+
+    TUYA_CALL_ERR_GOTO(tal_sw_timer_start(eff->timer, eff->frame_ms, TAL_TIMER_CYCLE), __EXIT);
+
+    return OPRT_OK;
+
+__EXIT:
+    tdl_pixel_effect_stop(handle);
+    return rt;
+
+__ERR:
+    __effect_free(eff);
+    return rt;
+}
+
+/**
+ * @brief    Change the effect, it starts from its first frame on the next tick
+ *
+ * @param[in]    handle           Device handle
+ * @param[in]    cfg              Effect
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+int tdl_pixel_effect_set(PIXEL_HANDLE_T handle, PIXEL_EFFECT_CFG_T *cfg)
+{
+    PIXEL_DEV_NODE_T *device = (PIXEL_DEV_NODE_T *)handle;
+    PIXEL_EFFECT_T *eff = NULL;
+    int op_ret = OPRT_OK;
+
+    if (NULL == device || NULL == cfg || 0 == cfg->color_cnt || cfg->color_cnt > PIXEL_EFFECT_COLOR_MAX ||
+        cfg->type > PIXEL_EFFECT_MUSIC) {
+        return OPRT_INVALID_PARM;
+    }
+
+    tal_mutex_lock(device->mutex);
+    eff = (PIXEL_EFFECT_T *)device->effect;
+    if (eff) {
+        memcpy(&eff->cfg, cfg, sizeof(PIXEL_EFFECT_CFG_T));
+        eff->has_cfg = TRUE;
+        eff->cfg_changed = TRUE;
+    } else {
+        op_ret = OPRT_COM_ERROR;
+    }
+    tal_mutex_unlock(device->mutex);
+
+    return op_ret;
+}
+
+/**
+ * @brief    Feed the music effect
+ *
+ * @param[in]    handle           Device handle
+ * @param[in]    level            0 ~ PIXEL_EFFECT_LEVEL_MAX
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+int tdl_pixel_effect_set_level(PIXEL_HANDLE_T handle, uint16_t level)
+{
+    PIXEL_DEV_NODE_T *device = (PIXEL_DEV_NODE_T *)handle;
+    PIXEL_EFFECT_T *eff = NULL;
+    int op_ret = OPRT_OK;
+
+    if (NULL == device) {
+        return OPRT_INVALID_PARM;
+    }
+
+    tal_mutex_lock(device->mutex);
+    eff = (PIXEL_EFFECT_T *)device->effect;
+    if (eff) {
+        eff->level_in = MIN(level, PIXEL_EFFECT_LEVEL_MAX);
+    } else {
+        op_ret = OPRT_COM_ERROR;
+    }
+    tal_mutex_unlock(device->mutex);
+
+    return op_ret;
+}
+
+/**
+ * @brief    Read the engine counters
+ *
+ * @param[in]    handle           Device handle
+ * @param[out]   stats            Counters
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+int tdl_pixel_effect_get_stats(PIXEL_HANDLE_T handle, PIXEL_EFFECT_STATS_T *stats)
+{
+    PIXEL_DEV_NODE_T *device = (PIXEL_DEV_NODE_T *)handle;
+    PIXEL_EFFECT_T *eff = NULL;
+    int op_ret = OPRT_OK;
+
+    if (NULL == device || NULL == stats) {
+        return OPRT_INVALID_PARM;
+    }
+
+    tal_mutex_lock(device->mutex);
+    eff = (PIXEL_EFFECT_T *)device->effect;
+    if (eff) {
+        memcpy(stats, &eff->stats, sizeof(PIXEL_EFFECT_STATS_T));
+    } else {
+        op_ret = OPRT_COM_ERROR;
+    }
+    tal_mutex_unlock(device->mutex);
+
+    return op_ret;
+}
+
+/**
+ * @brief    Stop the effects engine, the last frame stays on the strip
+ *
+ * @param[in]    handle           Device handle
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+int tdl_pixel_effect_stop(PIXEL_HANDLE_T handle)
+{
+    PIXEL_DEV_NODE_T *device = (PIXEL_DEV_NODE_T *)handle;
+    PIXEL_EFFECT_T *eff = NULL;
+
+    if (NULL == device) {
+        return OPRT_INVALID_PARM;
+    }
+
+    tal_mutex_lock(device->mutex);
+    eff = (PIXEL_EFFECT_T *)device->effect;
+    device->effect = NULL;
+    tal_mutex_unlock(device->mutex);
+
+    if (NULL == eff) {
+        return OPRT_OK;
+    }
+
+    tal_sw_timer_stop(eff->timer);
+
+    // the task may be sending, let it finish the frame and leave
+    eff->is_running = FALSE;
+    tal_semaphore_post(eff->tick_sem);
+    tal_semaphore_wait(eff->exit_sem, SEM_WAIT_FOREVER);
+
+    __effect_free(eff);
+
+    return OPRT_OK;
+}
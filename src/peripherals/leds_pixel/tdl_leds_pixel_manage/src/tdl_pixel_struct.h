@@ -56,8 +56,25 @@ typedef struct pixel_dev_list {
     BOOL_T white_color_control; // Independent White Light and Color Light Control
     PIXEL_DRIVER_INTFS_T *intfs;
 
+    void *effect; // effects engine, owns the strip while set
+
 } PIXEL_DEV_NODE_T, PIXEL_DEV_LIST_T;
 
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+/**
+ * @brief    Convert a color into the channels of a device, in any buffer laid out like pixel_buffer
+ *
+ * @param[in]    device           Device
+ * @param[out]   buff             Channel buffer
+ * @param[in]    index            Pixel index
+ * @param[in]    color            Color
+ *
+ * @return none
+ */
+void tdl_pixel_color_to_buffer(PIXEL_DEV_NODE_T *device, uint16_t *buff, uint32_t index, PIXEL_COLOR_T *color);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -396,6 +396,10 @@ OPERATE_RET axp2101_deinit(void);
 OPERATE_RET axp2101_write_reg(axp2101_dev_t *dev, uint8_t reg, uint8_t data);
 OPERATE_RET axp2101_read_regs(axp2101_dev_t *dev, uint8_t reg, uint8_t *data, uint8_t len);
 
+// Register cache, configuration registers are shadowed and the status and ADC
+// registers read in bursts, call after anything else changed the chip
+void axp2101_cache_invalidate(void);
+
 // Print
 void axp2101_print_chg_info(void);
 void axp2101_print_pwr_info(void);
@@ -454,6 +458,9 @@ void axp2101_enableCellbatteryCharge(void);
 // Interrupt control functions
 uint64_t axp2101_getIrqStatus(void);
 void axp2101_clearIrqStatus(void);
+// Refresh the status on the IRQ pin instead of by age, pin is active low
+OPERATE_RET axp2101_irq_refresh_start(TUYA_GPIO_NUM_E pin);
+OPERATE_RET axp2101_irq_refresh_stop(void);
 bool axp2101_enableIRQ(uint64_t opt);
 bool axp2101_disableIRQ(uint64_t opt);
 bool axp2101_enableInterrupt(uint32_t opt);
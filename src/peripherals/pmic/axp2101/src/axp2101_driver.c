@@ -13,13 +13,66 @@
 #include "tal_log.h"
 #include "tuya_error_code.h"
 #include "math.h"
+#include "string.h"
 
 #include "tkl_i2c.h"
 #include "tkl_gpio.h"
+#include "tal_mutex.h"
 /***********************************************************
 ************************macro define************************
 ***********************************************************/
 #define IS_BIT_SET(val, mask) (((val) & (mask)) == (mask))
+
+// keep a shadow of the configuration registers, their reads come from RAM
+#ifndef AXP2101_REG_CACHE_ENABLE
+#define AXP2101_REG_CACHE_ENABLE 1
+#endif
+
+// age of the status block without the IRQ pin
+#ifndef AXP2101_STATUS_CACHE_MS
+#define AXP2101_STATUS_CACHE_MS 500
+#endif
+
+// age of the status block with the IRQ pin, the charge phases raise no interrupt
+#ifndef AXP2101_STATUS_IRQ_CACHE_MS
+#define AXP2101_STATUS_IRQ_CACHE_MS 5000
+#endif
+
+// age of the ADC block, all the measurements are read in one go
+#ifndef AXP2101_ADC_CACHE_MS
+#define AXP2101_ADC_CACHE_MS 500
+#endif
+
+// age of the battery percent, the gauge updates it every few seconds
+#ifndef AXP2101_GAUGE_CACHE_MS
+#define AXP2101_GAUGE_CACHE_MS 2000
+#endif
+
+// interrupt sources that change the status block
+#define AXP2101_STATUS_IRQS                                                                                            \
+    (XPOWERS_AXP2101_VBUS_INSERT_IRQ | XPOWERS_AXP2101_VBUS_REMOVE_IRQ | XPOWERS_AXP2101_BAT_INSERT_IRQ |             \
+     XPOWERS_AXP2101_BAT_REMOVE_IRQ | XPOWERS_AXP2101_BAT_CHG_START_IRQ | XPOWERS_AXP2101_BAT_CHG_DONE_IRQ)
+
+#define AXP2101_BLOCK_DATA_MAX 10
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef enum {
+    AXP2101_BLOCK_STATUS = 0,
+    AXP2101_BLOCK_ADC,
+    AXP2101_BLOCK_GAUGE,
+    AXP2101_BLOCK_NUM,
+} AXP2101_BLOCK_E;
+
+/* registers the chip updates by itself, read in one burst and kept for a while */
+typedef struct {
+    uint8_t reg;
+    uint8_t len;
+    uint32_t max_ms;
+    bool valid;
+    SYS_TIME_T time;
+    uint8_t data[AXP2101_BLOCK_DATA_MAX];
+} AXP2101_BLOCK_T;
 /***********************************************************
 ***********************variable define**********************
 ***********************************************************/
@@ -29,6 +82,23 @@ static axp2101_dev_t axp2101_dev = {
 static uint8_t statusRegister[XPOWERS_AXP2101_INTSTS_CNT];
 static uint8_t intRegister[XPOWERS_AXP2101_INTSTS_CNT];
 static uint32_t __protectedMask = 0;
+
+static MUTEX_HANDLE sg_reg_mutex = NULL;
+static AXP2101_BLOCK_T sg_blocks[AXP2101_BLOCK_NUM] = {
+    [AXP2101_BLOCK_STATUS] = {.reg = XPOWERS_AXP2101_STATUS1, .len = 2, .max_ms = AXP2101_STATUS_CACHE_MS},
+    [AXP2101_BLOCK_ADC] = {.reg = XPOWERS_AXP2101_ADC_DATA_RELUST0, .len = 10, .max_ms = AXP2101_ADC_CACHE_MS},
+    [AXP2101_BLOCK_GAUGE] = {.reg = XPOWERS_AXP2101_BAT_PERCENT_DATA, .len = 1, .max_ms = AXP2101_GAUGE_CACHE_MS},
+};
+
+#if AXP2101_REG_CACHE_ENABLE
+static uint8_t sg_shadow[256];
+static uint8_t sg_shadow_valid[256 / 8];
+#endif
+
+static TUYA_GPIO_NUM_E sg_irq_pin = TUYA_GPIO_NUM_MAX;
+static volatile bool sg_irq_pending = false;
+// interrupt flags cleared on the chip by the IRQ refresh, until axp2101_clearIrqStatus
+static uint8_t sg_irq_latched[XPOWERS_AXP2101_INTSTS_CNT];
 /***********************************************************
 ***********************function define**********************
 ***********************************************************/
@@ -91,6 +161,208 @@ OPERATE_RET axp2101_read_regs(axp2101_dev_t *dev, uint8_t reg, uint8_t *data, ui
     return OPRT_OK;
 }
 
+static void __reg_lock(void)
+{
+    if (sg_reg_mutex) {
+        tal_mutex_lock(sg_reg_mutex);
+    }
+}
+
+static void __reg_unlock(void)
+{
+    if (sg_reg_mutex) {
+        tal_mutex_unlock(sg_reg_mutex);
+    }
+}
+
+static AXP2101_BLOCK_T *__block_find(uint8_t reg, uint8_t len)
+{
+    for (int i = 0; i < AXP2101_BLOCK_NUM; i++) {
+        AXP2101_BLOCK_T *blk = &sg_blocks[i];
+        if (reg >= blk->reg && reg + len <= blk->reg + blk->len) {
+            return blk;
+        }
+    }
+    return NULL;
+}
+
+static void __block_invalidate_all(void)
+{
+    for (int i = 0; i < AXP2101_BLOCK_NUM; i++) {
+        sg_blocks[i].valid = false;
+    }
+}
+
+/* registers that clear themselves, latch events or are written as a stream */
+static bool __reg_cacheable(uint8_t reg)
+{
+    switch (reg) {
+    case XPOWERS_AXP2101_COMMON_CONFIG:    // soft reset and power off
+    case XPOWERS_AXP2101_RESET_FUEL_GAUGE: // gauge reset
+    case XPOWERS_AXP2101_WDT_CTRL:         // watchdog clear
+    case XPOWERS_AXP2101_PWRON_STATUS:
+    case XPOWERS_AXP2101_PWROFF_STATUS:
+    case XPOWERS_AXP2101_INTSTS1:
+    case XPOWERS_AXP2101_INTSTS2:
+    case XPOWERS_AXP2101_INTSTS3:
+    case XPOWERS_AXP2101_BAT_PARAME:
+        return false;
+    default:
+        break;
+    }
+    return (NULL == __block_find(reg, 1));
+}
+
+#if AXP2101_REG_CACHE_ENABLE
+static bool __shadow_get(uint8_t reg, uint8_t *value)
+{
+    if (!__reg_cacheable(reg) || !(sg_shadow_valid[reg >> 3] & (1 << (reg & 7)))) {
+        return false;
+    }
+    *value = sg_shadow[reg];
+    return true;
+}
+
+static void __shadow_set(uint8_t reg, uint8_t value)
+{
+    if (__reg_cacheable(reg)) {
+        sg_shadow[reg] = value;
+        sg_shadow_valid[reg >> 3] |= (1 << (reg & 7));
+    }
+}
+
+static void __shadow_drop(uint8_t reg)
+{
+    sg_shadow_valid[reg >> 3] &= ~(1 << (reg & 7));
+}
+#endif
+
+/*
+ * Reads the interrupt flags after the IRQ pin fell and clears them on the chip
+ * so the pin goes up again for the next event. The flags stay latched for
+ * axp2101_getIrqStatus.
+ */
+static void __irq_service(void)
+{
+    uint8_t sts[XPOWERS_AXP2101_INTSTS_CNT];
+    TUYA_GPIO_LEVEL_E level = TUYA_GPIO_LEVEL_HIGH;
+
+    sg_irq_pending = false;
+    __block_invalidate_all();
+
+    if (OPRT_OK != axp2101_read_regs(&axp2101_dev, XPOWERS_AXP2101_INTSTS1, sts, XPOWERS_AXP2101_INTSTS_CNT)) {
+        sg_irq_pending = true;
+        return;
+    }
+    for (int i = 0; i < XPOWERS_AXP2101_INTSTS_CNT; i++) {
+        if (sts[i]) {
+            sg_irq_latched[i] |= sts[i];
+            axp2101_write_reg(&axp2101_dev, XPOWERS_AXP2101_INTSTS1 + i, sts[i]);
+        }
+    }
+
+    // an event between the read and the clear keeps the pin low without an edge
+    if (OPRT_OK == tkl_gpio_read(sg_irq_pin, &level) && TUYA_GPIO_LEVEL_LOW == level) {
+        sg_irq_pending = true;
+    }
+}
+
+static OPERATE_RET __block_load(AXP2101_BLOCK_T *blk)
+{
+    OPERATE_RET rt = OPRT_OK;
+    SYS_TIME_T now = tal_system_get_millisecond();
+    uint32_t max_ms = blk->max_ms;
+
+    if (TUYA_GPIO_NUM_MAX != sg_irq_pin) {
+        if (sg_irq_pending) {
+            __irq_service();
+        }
+        if (blk == &sg_blocks[AXP2101_BLOCK_STATUS]) {
+            max_ms = AXP2101_STATUS_IRQ_CACHE_MS;
+        }
+    }
+
+    if (blk->valid && now - blk->time < max_ms) {
+        return OPRT_OK;
+    }
+
+    rt = axp2101_read_regs(&axp2101_dev, blk->reg, blk->data, blk->len);
+    blk->valid = (OPRT_OK == rt);
+    blk->time = now;
+
+    return rt;
+}
+
+static OPERATE_RET __reg_read(uint8_t reg, uint8_t *data, uint8_t len)
+{
+    OPERATE_RET rt = OPRT_OK;
+    AXP2101_BLOCK_T *blk = __block_find(reg, len);
+    uint16_t i;
+
+    if (blk) {
+        rt = __block_load(blk);
+        if (OPRT_OK == rt) {
+            memcpy(data, &blk->data[reg - blk->reg], len);
+        }
+        return rt;
+    }
+
+#if AXP2101_REG_CACHE_ENABLE
+    for (i = 0; i < len; i++) {
+        if (!__shadow_get(reg + i, &data[i])) {
+            break;
+        }
+    }
+    if (i == len) {
+        return OPRT_OK;
+    }
+#endif
+
+    rt = axp2101_read_regs(&axp2101_dev, reg, data, len);
+    if (OPRT_OK != rt) {
+        return rt;
+    }
+
+#if AXP2101_REG_CACHE_ENABLE
+    for (i = 0; i < len; i++) {
+        __shadow_set(reg + i, data[i]);
+    }
+#endif
+
+    return OPRT_OK;
+}
+
+static OPERATE_RET __reg_write(uint8_t reg, uint8_t data)
+{
+    OPERATE_RET rt = axp2101_write_reg(&axp2101_dev, reg, data);
+
+#if AXP2101_REG_CACHE_ENABLE
+    if (OPRT_OK == rt) {
+        __shadow_set(reg, data);
+    } else {
+        // the chip may or may not have taken it
+        __shadow_drop(reg);
+    }
+#endif
+    // settings change what the status and the ADC report
+    __block_invalidate_all();
+
+    return rt;
+}
+
+/**
+ * @brief Drops the register shadow and the cached status, the next reads go to the chip
+ */
+void axp2101_cache_invalidate(void)
+{
+    __reg_lock();
+#if AXP2101_REG_CACHE_ENABLE
+    memset(sg_shadow_valid, 0, sizeof(sg_shadow_valid));
+#endif
+    __block_invalidate_all();
+    __reg_unlock();
+}
+
 /**
  * @brief Read single byte from specified register
  * @param reg: Register address
@@ -98,11 +370,14 @@ OPERATE_RET axp2101_read_regs(axp2101_dev_t *dev, uint8_t reg, uint8_t *data, ui
  */
 uint8_t readRegister(uint8_t reg)
 {
-    uint8_t data;
-    if (axp2101_read_regs(&axp2101_dev, reg, &data, 1) == OPRT_OK) {
-        return data;
-    }
-    return 0;
+    uint8_t data = 0;
+    OPERATE_RET rt;
+
+    __reg_lock();
+    rt = __reg_read(reg, &data, 1);
+    __reg_unlock();
+
+    return (OPRT_OK == rt) ? data : 0;
 }
 
 /**
@@ -113,7 +388,13 @@ uint8_t readRegister(uint8_t reg)
  */
 bool writeRegister(uint8_t reg, uint8_t data)
 {
-    return axp2101_write_reg(&axp2101_dev, reg, data) == OPRT_OK;
+    OPERATE_RET rt;
+
+    __reg_lock();
+    rt = __reg_write(reg, data);
+    __reg_unlock();
+
+    return rt == OPRT_OK;
 }
 
 /**
@@ -124,13 +405,38 @@ bool writeRegister(uint8_t reg, uint8_t data)
  */
 bool getRegisterBit(uint8_t reg, uint8_t bit)
 {
-    uint8_t value;
-    if (axp2101_read_regs(&axp2101_dev, reg, &value, 1) != OPRT_OK) {
+    uint8_t value = 0;
+    OPERATE_RET rt;
+
+    __reg_lock();
+    rt = __reg_read(reg, &value, 1);
+    __reg_unlock();
+
+    if (rt != OPRT_OK) {
         return false;
     }
     return (value & (1U << bit)) ? true : false;
 }
 
+static bool __update_bit(uint8_t reg, uint8_t bit, bool set)
+{
+    uint8_t value = 0, new_value;
+    OPERATE_RET rt;
+
+    __reg_lock();
+    rt = __reg_read(reg, &value, 1);
+    if (OPRT_OK == rt) {
+        new_value = set ? (value | (1U << bit)) : (value & ~(1U << bit));
+        // self clearing bits are written every time, shadowed ones only on a change
+        if (new_value != value || !__reg_cacheable(reg) || !AXP2101_REG_CACHE_ENABLE) {
+            rt = __reg_write(reg, new_value);
+        }
+    }
+    __reg_unlock();
+
+    return rt == OPRT_OK;
+}
+
 /**
  * @brief Set a specific bit in the register to 1
  * @param reg: Register address
@@ -139,12 +445,7 @@ bool getRegisterBit(uint8_t reg, uint8_t bit)
  */
 bool setRegisterBit(uint8_t reg, uint8_t bit)
 {
-    uint8_t value;
-    if (axp2101_read_regs(&axp2101_dev, reg, &value, 1) != OPRT_OK) {
-        return false;
-    }
-    value |= (1U << bit);
-    return (axp2101_write_reg(&axp2101_dev, reg, value) == OPRT_OK);
+    return __update_bit(reg, bit, true);
 }
 
 /**
@@ -155,30 +456,40 @@ bool setRegisterBit(uint8_t reg, uint8_t bit)
  */
 bool clrRegisterBit(uint8_t reg, uint8_t bit)
 {
-    uint8_t value;
-    if (axp2101_read_regs(&axp2101_dev, reg, &value, 1) != OPRT_OK) {
-        return false;
+    return __update_bit(reg, bit, false);
+}
+
+/* the ADC results are high byte first, both come from one burst read */
+static uint16_t __read_pair(uint8_t highReg, uint8_t lowReg)
+{
+    uint8_t buf[2] = {0};
+    OPERATE_RET rt;
+
+    __reg_lock();
+    if (lowReg == highReg + 1) {
+        rt = __reg_read(highReg, buf, 2);
+    } else {
+        rt = __reg_read(highReg, &buf[0], 1);
+        if (OPRT_OK == rt) {
+            rt = __reg_read(lowReg, &buf[1], 1);
+        }
+    }
+    __reg_unlock();
+
+    if (OPRT_OK != rt) {
+        return 0;
     }
-    value &= ~(1U << bit);
-    return (axp2101_write_reg(&axp2101_dev, reg, value) == OPRT_OK);
+    return ((uint16_t)buf[0] << 8) | buf[1];
 }
 
 uint16_t readRegisterH6L8(uint8_t highReg, uint8_t lowReg)
 {
-    int h6 = readRegister(highReg);
-    int l8 = readRegister(lowReg);
-    if (h6 == -1 || l8 == -1)
-        return 0;
-    return ((h6 & 0x3F) << 8) | l8;
+    return __read_pair(highReg, lowReg) & 0x3FFF;
 }
 
 uint16_t readRegisterH5L8(uint8_t highReg, uint8_t lowReg)
 {
-    int h5 = readRegister(highReg);
-    int l8 = readRegister(lowReg);
-    if (h5 == -1 || l8 == -1)
-        return 0;
-    return ((h5 & 0x1F) << 8) | l8;
+    return __read_pair(highReg, lowReg) & 0x1FFF;
 }
 
 /*
@@ -2555,9 +2866,18 @@ void fuelGaugeControl(bool writeROM, bool enable)
  */
 uint64_t axp2101_getIrqStatus(void)
 {
-    statusRegister[0] = readRegister(XPOWERS_AXP2101_INTSTS1);
-    statusRegister[1] = readRegister(XPOWERS_AXP2101_INTSTS2);
-    statusRegister[2] = readRegister(XPOWERS_AXP2101_INTSTS3);
+    uint8_t sts[XPOWERS_AXP2101_INTSTS_CNT] = {0};
+
+    __reg_lock();
+    if (TUYA_GPIO_NUM_MAX != sg_irq_pin && sg_irq_pending) {
+        __irq_service();
+    }
+    axp2101_read_regs(&axp2101_dev, XPOWERS_AXP2101_INTSTS1, sts, XPOWERS_AXP2101_INTSTS_CNT);
+    for (int i = 0; i < XPOWERS_AXP2101_INTSTS_CNT; i++) {
+        statusRegister[i] = sts[i] | sg_irq_latched[i];
+    }
+    __reg_unlock();
+
     return (uint32_t)(statusRegister[0] << 16) | (uint32_t)(statusRegister[1] << 8) | (uint32_t)(statusRegister[2]);
 }
 
@@ -2569,7 +2889,70 @@ void axp2101_clearIrqStatus()
     for (int i = 0; i < XPOWERS_AXP2101_INTSTS_CNT; i++) {
         writeRegister(XPOWERS_AXP2101_INTSTS1 + i, 0xFF);
         statusRegister[i] = 0;
+        sg_irq_latched[i] = 0;
+    }
+}
+
+static void __pmu_irq_cb(void *args)
+{
+    // no bus access here, the next status read services it
+    sg_irq_pending = true;
+}
+
+/**
+ * @brief  Refresh the status on the PMU interrupt instead of by age.
+ * @param  pin: GPIO wired to the IRQ pin of the AXP2101, open drain active low
+ * @retval OPRT_OK on success
+ */
+OPERATE_RET axp2101_irq_refresh_start(TUYA_GPIO_NUM_E pin)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    TUYA_GPIO_BASE_CFG_T pin_cfg = {
+        .mode = TUYA_GPIO_PULLUP,
+        .direct = TUYA_GPIO_INPUT,
+    };
+    TUYA_CALL_ERR_RETURN(tkl_gpio_init(pin, &pin_cfg));
+
+    TUYA_GPIO_IRQ_T irq_cfg = {
+        .mode = TUYA_GPIO_IRQ_FALL,
+        .cb = __pmu_irq_cb,
+        .arg = NULL,
+    };
+    TUYA_CALL_ERR_RETURN(tkl_gpio_irq_init(pin, &irq_cfg));
+
+    axp2101_enableIRQ(AXP2101_STATUS_IRQS);
+
+    __reg_lock();
+    sg_irq_pin = pin;
+    // flags raised before the edge was armed would hold the pin low
+    sg_irq_pending = true;
+    __reg_unlock();
+
+    TUYA_CALL_ERR_RETURN(tkl_gpio_irq_enable(pin));
+
+    return rt;
+}
+
+/**
+ * @brief  Go back to refreshing the status by age.
+ * @retval OPRT_OK on success
+ */
+OPERATE_RET axp2101_irq_refresh_stop(void)
+{
+    if (TUYA_GPIO_NUM_MAX == sg_irq_pin) {
+        return OPRT_OK;
     }
+
+    tkl_gpio_irq_disable(sg_irq_pin);
+
+    __reg_lock();
+    sg_irq_pin = TUYA_GPIO_NUM_MAX;
+    sg_irq_pending = false;
+    __block_invalidate_all();
+    __reg_unlock();
+
+    return OPRT_OK;
 }
 
 /*
@@ -3193,6 +3576,12 @@ OPERATE_RET axp2101_init(void)
 
     TUYA_CALL_ERR_RETURN(__i2c_init());
 
+    if (NULL == sg_reg_mutex) {
+        TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&sg_reg_mutex));
+    }
+    // the chip may have been reset since the last init
+    axp2101_cache_invalidate();
+
     if (XPOWERS_AXP2101_CHIP_ID == axp2101_getChipID()) {
         PR_DEBUG("AXP2101 detected");
     } else {
@@ -3206,6 +3595,7 @@ OPERATE_RET axp2101_deinit(void)
 {
     OPERATE_RET rt = OPRT_OK;
 
+    axp2101_irq_refresh_stop();
     TUYA_CALL_ERR_RETURN(tkl_i2c_deinit(axp2101_dev.i2c_port));
 
     PR_DEBUG("AXP2101 deinit succeed");
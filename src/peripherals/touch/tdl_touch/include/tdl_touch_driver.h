@@ -38,11 +38,13 @@ typedef void *TDD_TOUCH_DEV_HANDLE_T;
 typedef struct {
     uint16_t x_max;
     uint16_t y_max;
+    TUYA_GPIO_NUM_E int_pin; // INT of the controller, used with flags.int_en
 
     struct {
         uint32_t swap_xy : 1;
         uint32_t mirror_x : 1;
         uint32_t mirror_y : 1;
+        uint32_t int_en : 1; // int_pin is wired, it falls on every report of the controller
     } flags;
 } TDL_TOUCH_CONFIG_T;
 
@@ -25,6 +25,21 @@ extern "C" {
 ***********************************************************/
 typedef void *TDL_TOUCH_HANDLE_T;
 
+// timestamped points kept for the velocity
+#ifndef TDL_TOUCH_TRACE_LEN
+#define TDL_TOUCH_TRACE_LEN 8
+#endif
+
+// the velocity is taken over the points of this last stretch
+#ifndef TDL_TOUCH_VELOCITY_WINDOW_MS
+#define TDL_TOUCH_VELOCITY_WINDOW_MS 100
+#endif
+
+// with the INT pin, a press without a report for this long is read to catch a release
+#ifndef TDL_TOUCH_RELEASE_POLL_MS
+#define TDL_TOUCH_RELEASE_POLL_MS 100
+#endif
+
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
@@ -43,6 +58,17 @@ OPERATE_RET tdl_touch_dev_open(TDL_TOUCH_HANDLE_T touch_hdl);
 OPERATE_RET tdl_touch_dev_read(TDL_TOUCH_HANDLE_T touch_hdl, uint8_t max_num, TDL_TOUCH_POS_T *point,
                                uint8_t *point_num);
 
+// samples on the input scheduler, the first point is posted as TDL_INPUT_SRC_TOUCH events,
+// moves at most once per period. With the INT pin of the config the device is read only
+// after an interrupt and nothing runs while it is not touched.
+OPERATE_RET tdl_touch_dev_sample_start(TDL_TOUCH_HANDLE_T touch_hdl, uint16_t period_ms);
+
+OPERATE_RET tdl_touch_dev_sample_stop(TDL_TOUCH_HANDLE_T touch_hdl);
+
+// px/s of the first point over the last TDL_TOUCH_VELOCITY_WINDOW_MS, taken from the samples,
+// 0 once it stood still for that long
+OPERATE_RET tdl_touch_dev_get_velocity(TDL_TOUCH_HANDLE_T touch_hdl, int32_t *vx, int32_t *vy);
+
 OPERATE_RET tdl_touch_dev_close(TDL_TOUCH_HANDLE_T touch_hdl);
 
 #ifdef __cplusplus
@@ -17,6 +17,7 @@
 #include "tal_api.h"
 #include "tuya_list.h"
 
+#include "tdl_input_sched.h"
 #include "tdl_touch_driver.h"
 #include "tdl_touch_manage.h"
 
@@ -27,6 +28,12 @@
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint32_t time_ms;
+} TOUCH_TRACE_POINT_T;
+
 typedef struct {
     struct tuya_list_head node;
     bool is_open;
@@ -37,6 +44,17 @@ typedef struct {
     TDD_TOUCH_INTFS_T intfs;
 
     TDL_TOUCH_CONFIG_T config;
+
+    TDL_INPUT_SCHED_HANDLE sched_hdl;
+    bool is_pressed;
+    TDL_TOUCH_POS_T last_point;
+
+    volatile bool irq_pending;
+    uint32_t last_read_ms;
+
+    TOUCH_TRACE_POINT_T trace[TDL_TOUCH_TRACE_LEN];
+    uint8_t trace_head; // slot of the next point
+    uint8_t trace_num;
 } TOUCH_DEVICE_T;
 
 /***********************************************************
@@ -151,6 +169,208 @@ OPERATE_RET tdl_touch_dev_read(TDL_TOUCH_HANDLE_T touch_hdl, uint8_t max_num, TD
     return rt;
 }
 
+static void __touch_trace_add(TOUCH_DEVICE_T *touch_dev, TDL_TOUCH_POS_T *point, uint32_t now, bool is_new)
+{
+    TOUCH_TRACE_POINT_T *trace_point = NULL;
+
+    tal_mutex_lock(touch_dev->mutex);
+    if (is_new) {
+        touch_dev->trace_num = 0;
+    }
+    trace_point = &touch_dev->trace[touch_dev->trace_head];
+    trace_point->x = point->x;
+    trace_point->y = point->y;
+    trace_point->time_ms = now;
+    touch_dev->trace_head = (touch_dev->trace_head + 1) % TDL_TOUCH_TRACE_LEN;
+    if (touch_dev->trace_num < TDL_TOUCH_TRACE_LEN) {
+        touch_dev->trace_num++;
+    }
+    tal_mutex_unlock(touch_dev->mutex);
+}
+
+static void __touch_irq_cb(void *args)
+{
+    TOUCH_DEVICE_T *touch_dev = (TOUCH_DEVICE_T *)args;
+
+    touch_dev->irq_pending = true;
+    tdl_input_sched_kick(touch_dev->sched_hdl);
+}
+
+/*
+ * Posts press, move and release of the first point to the input event queue.
+ * With the INT pin the entry is parked until the controller reports a touch,
+ * the reports that come in while pressed are taken on the next period so the
+ * moves are coalesced to the sample rate.
+ */
+static bool __touch_sample(void *arg)
+{
+    TOUCH_DEVICE_T *touch_dev = (TOUCH_DEVICE_T *)arg;
+    TDL_TOUCH_POS_T point;
+    uint8_t point_num = 0;
+    bool is_int = touch_dev->config.flags.int_en;
+    uint32_t now = tal_system_get_millisecond();
+    TDL_INPUT_EVENT_T input_ev = {
+        .src = TDL_INPUT_SRC_TOUCH,
+        .dev = touch_dev,
+    };
+
+    if (is_int) {
+        if (touch_dev->irq_pending) {
+            touch_dev->irq_pending = false;
+        } else if (false == touch_dev->is_pressed) {
+            return false;
+        } else if (now - touch_dev->last_read_ms < TDL_TOUCH_RELEASE_POLL_MS) {
+            // still pressed without a report, some controllers send none on release
+            return true;
+        }
+    }
+    touch_dev->last_read_ms = now;
+
+    if (OPRT_OK != tdl_touch_dev_read((TDL_TOUCH_HANDLE_T)touch_dev, 1, &point, &point_num)) {
+        touch_dev->irq_pending = is_int;
+        return true;
+    }
+
+    if (point_num > 0) {
+        __touch_trace_add(touch_dev, &point, now, !touch_dev->is_pressed);
+        if (touch_dev->is_pressed && point.x == touch_dev->last_point.x && point.y == touch_dev->last_point.y) {
+            return true;
+        }
+        input_ev.event = (touch_dev->is_pressed) ? TDL_INPUT_EV_MOVE : TDL_INPUT_EV_PRESS;
+        touch_dev->last_point = point;
+        touch_dev->is_pressed = true;
+    } else {
+        if (false == touch_dev->is_pressed) {
+            return !is_int;
+        }
+        input_ev.event = TDL_INPUT_EV_RELEASE;
+        touch_dev->is_pressed = false;
+    }
+
+    input_ev.x = touch_dev->last_point.x;
+    input_ev.y = touch_dev->last_point.y;
+    input_ev.time_ms = now;
+    tdl_input_event_post(&input_ev);
+
+    return (touch_dev->is_pressed || !is_int);
+}
+
+static OPERATE_RET __touch_irq_init(TOUCH_DEVICE_T *touch_dev)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    TUYA_GPIO_BASE_CFG_T pin_cfg = {
+        .mode = TUYA_GPIO_PULLUP,
+        .direct = TUYA_GPIO_INPUT,
+    };
+    TUYA_CALL_ERR_RETURN(tkl_gpio_init(touch_dev->config.int_pin, &pin_cfg));
+
+    TUYA_GPIO_IRQ_T irq_cfg = {
+        .mode = TUYA_GPIO_IRQ_FALL,
+        .cb = __touch_irq_cb,
+        .arg = touch_dev,
+    };
+    TUYA_CALL_ERR_RETURN(tkl_gpio_irq_init(touch_dev->config.int_pin, &irq_cfg));
+    TUYA_CALL_ERR_RETURN(tkl_gpio_irq_enable(touch_dev->config.int_pin));
+
+    return OPRT_OK;
+}
+
+OPERATE_RET tdl_touch_dev_sample_start(TDL_TOUCH_HANDLE_T touch_hdl, uint16_t period_ms)
+{
+    OPERATE_RET rt = OPRT_OK;
+    TOUCH_DEVICE_T *touch_dev = NULL;
+
+    if (NULL == touch_hdl || 0 == period_ms) {
+        return OPRT_INVALID_PARM;
+    }
+
+    touch_dev = (TOUCH_DEVICE_T *)touch_hdl;
+
+    if (false == touch_dev->is_open) {
+        return OPRT_COM_ERROR;
+    }
+
+    if (touch_dev->sched_hdl) {
+        return OPRT_OK;
+    }
+
+    touch_dev->is_pressed = false;
+    if (touch_dev->config.flags.int_en && OPRT_OK != __touch_irq_init(touch_dev)) {
+        PR_WARN("touch int pin %d not usable, polling", touch_dev->config.int_pin);
+        touch_dev->config.flags.int_en = 0;
+    }
+    // read once at the start, a touch already down gives no new edge
+    touch_dev->irq_pending = touch_dev->config.flags.int_en;
+    TUYA_CALL_ERR_RETURN(tdl_input_sched_add(__touch_sample, touch_dev, period_ms, false, &touch_dev->sched_hdl));
+
+    return OPRT_OK;
+}
+
+OPERATE_RET tdl_touch_dev_sample_stop(TDL_TOUCH_HANDLE_T touch_hdl)
+{
+    TOUCH_DEVICE_T *touch_dev = NULL;
+
+    if (NULL == touch_hdl) {
+        return OPRT_INVALID_PARM;
+    }
+
+    touch_dev = (TOUCH_DEVICE_T *)touch_hdl;
+
+    if (touch_dev->sched_hdl) {
+        if (touch_dev->config.flags.int_en) {
+            tkl_gpio_irq_disable(touch_dev->config.int_pin);
+        }
+        tdl_input_sched_remove(touch_dev->sched_hdl);
+        touch_dev->sched_hdl = NULL;
+    }
+
+    return OPRT_OK;
+}
+
+OPERATE_RET tdl_touch_dev_get_velocity(TDL_TOUCH_HANDLE_T touch_hdl, int32_t *vx, int32_t *vy)
+{
+    TOUCH_DEVICE_T *touch_dev = NULL;
+    TOUCH_TRACE_POINT_T *newest = NULL, *oldest = NULL, *trace_point = NULL;
+    uint32_t now = 0, dt = 0;
+
+    if (NULL == touch_hdl || NULL == vx || NULL == vy) {
+        return OPRT_INVALID_PARM;
+    }
+
+    touch_dev = (TOUCH_DEVICE_T *)touch_hdl;
+
+    if (false == touch_dev->is_open) {
+        return OPRT_COM_ERROR;
+    }
+
+    *vx = 0;
+    *vy = 0;
+    now = tal_system_get_millisecond();
+
+    tal_mutex_lock(touch_dev->mutex);
+    if (touch_dev->trace_num >= 2) {
+        newest = &touch_dev->trace[(touch_dev->trace_head + TDL_TOUCH_TRACE_LEN - 1) % TDL_TOUCH_TRACE_LEN];
+        oldest = newest;
+        for (uint8_t i = 1; i < touch_dev->trace_num; i++) {
+            trace_point =
+                &touch_dev->trace[(touch_dev->trace_head + TDL_TOUCH_TRACE_LEN - 1 - i) % TDL_TOUCH_TRACE_LEN];
+            if (newest->time_ms - trace_point->time_ms > TDL_TOUCH_VELOCITY_WINDOW_MS) {
+                break;
+            }
+            oldest = trace_point;
+        }
+        dt = newest->time_ms - oldest->time_ms;
+        if (dt && now - newest->time_ms < TDL_TOUCH_VELOCITY_WINDOW_MS) {
+            *vx = ((int32_t)newest->x - (int32_t)oldest->x) * 1000 / (int32_t)dt;
+            *vy = ((int32_t)newest->y - (int32_t)oldest->y) * 1000 / (int32_t)dt;
+        }
+    }
+    tal_mutex_unlock(touch_dev->mutex);
+
+    return OPRT_OK;
+}
+
 OPERATE_RET tdl_touch_dev_close(TDL_TOUCH_HANDLE_T touch_hdl)
 {
     OPERATE_RET rt = OPRT_OK;
@@ -166,6 +386,8 @@ OPERATE_RET tdl_touch_dev_close(TDL_TOUCH_HANDLE_T touch_hdl)
         return OPRT_OK;
     }
 
+    tdl_touch_dev_sample_stop(touch_hdl);
+
     if (touch_dev->intfs.close) {
         TUYA_CALL_ERR_RETURN(touch_dev->intfs.close(touch_dev->tdd_hdl));
     }
@@ -96,14 +96,13 @@ static OPERATE_RET __tdd_transport_uart_config(TDD_TRANSPORT_HANDLE_T handle, TD
 
     TDD_TRANSPORT_UART_HANDLE_T *hdl = (TDD_TRANSPORT_UART_HANDLE_T *)handle;
 
-    (void)hdl;
-
     switch (cmd) {
     case TDL_TRANSPORT_CMD_RX_BUFFER_RESET: {
-        // Reset the RX buffer
-        // TODO:
-        rt = OPRT_NOT_SUPPORTED;
-        PR_ERR("RX buffer reset not supported");
+        // Drop everything buffered so far
+        int size = tal_uart_get_rx_data_size(hdl->cfg.port_id);
+        if (size > 0) {
+            tal_uart_consume(hdl->cfg.port_id, size);
+        }
     } break;
     default:
         break;
@@ -112,6 +111,34 @@ static OPERATE_RET __tdd_transport_uart_config(TDD_TRANSPORT_HANDLE_T handle, TD
     return rt;
 }
 
+static uint32_t __tdd_transport_uart_peek(TDD_TRANSPORT_HANDLE_T handle, uint8_t **data)
+{
+    TUYA_CHECK_NULL_RETURN(handle, 0);
+    TDD_TRANSPORT_UART_HANDLE_T *hdl = (TDD_TRANSPORT_UART_HANDLE_T *)handle;
+
+    int len = tal_uart_peek(hdl->cfg.port_id, data);
+    if (len < 0) {
+        PR_ERR("UART peek error: %d", len);
+        return 0;
+    }
+
+    return (uint32_t)len;
+}
+
+static uint32_t __tdd_transport_uart_consume(TDD_TRANSPORT_HANDLE_T handle, uint32_t len)
+{
+    TUYA_CHECK_NULL_RETURN(handle, 0);
+    TDD_TRANSPORT_UART_HANDLE_T *hdl = (TDD_TRANSPORT_UART_HANDLE_T *)handle;
+
+    int ret = tal_uart_consume(hdl->cfg.port_id, len);
+    if (ret < 0) {
+        PR_ERR("UART consume error: %d", ret);
+        return 0;
+    }
+
+    return (uint32_t)ret;
+}
+
 static OPERATE_RET __tdd_transport_uart_close(TDD_TRANSPORT_HANDLE_T handle)
 {
     OPERATE_RET rt = OPRT_OK;
@@ -141,6 +168,8 @@ OPERATE_RET tdd_transport_uart_register(char *name, TDD_TRANSPORT_UART_CFG_T cfg
         .available = __tdd_transport_uart_available,
         .config = __tdd_transport_uart_config,
         .close = __tdd_transport_uart_close,
+        .peek = __tdd_transport_uart_peek,
+        .consume = __tdd_transport_uart_consume,
     };
 
     rt = tdl_transport_driver_register(name, &uart_intfs, (TDD_TRANSPORT_HANDLE_T)hdl);
@@ -32,6 +32,9 @@ typedef struct {
     uint32_t (*available)(TDD_TRANSPORT_HANDLE_T handle);
     OPERATE_RET (*config)(TDD_TRANSPORT_HANDLE_T handle, TDL_TRANSPORT_CMD_T cmd, void *param);
     OPERATE_RET (*close)(TDD_TRANSPORT_HANDLE_T handle);
+    // optional, received data lent in place, see tdl_transport_peek()
+    uint32_t (*peek)(TDD_TRANSPORT_HANDLE_T handle, uint8_t **data);
+    uint32_t (*consume)(TDD_TRANSPORT_HANDLE_T handle, uint32_t len);
 } TDD_TRANSPORT_INTFS_T;
 
 /***********************************************************
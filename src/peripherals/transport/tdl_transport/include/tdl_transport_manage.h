@@ -20,12 +20,25 @@ extern "C" {
 ***********************************************************/
 #define TDL_TRANSPORT_NAME_MAX_LEN 32
 
+// buffers queued by tdl_transport_send_async() per transport
+#ifndef TDL_TRANSPORT_TX_DEPTH
+#define TDL_TRANSPORT_TX_DEPTH 8
+#endif
+
+#ifndef TDL_TRANSPORT_TX_STACK_SIZE
+#define TDL_TRANSPORT_TX_STACK_SIZE (1024 * 2)
+#endif
+
 /***********************************************************
 ***********************typedef define***********************
 ***********************************************************/
 // transport handler
 typedef void *TDL_TRANSPORT_HANDLE;
 
+// called from the transport sender thread once the buffer is no longer used
+typedef void (*TDL_TRANSPORT_SEND_CB)(TDL_TRANSPORT_HANDLE handle, const uint8_t *data, uint32_t len,
+                                      OPERATE_RET result, void *arg);
+
 /***********************************************************
 ********************function declaration********************
 ***********************************************************/
@@ -36,8 +49,50 @@ OPERATE_RET tdl_transport_open(TDL_TRANSPORT_HANDLE handle);
 
 OPERATE_RET tdl_transport_send(TDL_TRANSPORT_HANDLE handle, const uint8_t *data, uint32_t len);
 
+/**
+ * @brief queue a buffer for sending without copying it
+ *
+ * @param[in] handle transport handle
+ * @param[in] data buffer lent to the transport, left untouched until cb
+ * @param[in] len buffer length
+ * @param[in] cb completion callback, may be NULL
+ * @param[in] arg callback argument
+ *
+ * @note Up to TDL_TRANSPORT_TX_DEPTH buffers may be in flight, they go out in
+ * order and in turn with tdl_transport_send().
+ *
+ * @return OPRT_OK on queued, OPRT_EXCEED_UPPER_LIMIT when the queue is full.
+ * Others on error, please refer to tuya_error_code.h
+ */
+OPERATE_RET tdl_transport_send_async(TDL_TRANSPORT_HANDLE handle, const uint8_t *data, uint32_t len,
+                                     TDL_TRANSPORT_SEND_CB cb, void *arg);
+
 uint32_t tdl_transport_read(TDL_TRANSPORT_HANDLE handle, uint8_t *data, uint32_t len);
 
+/**
+ * @brief get the received data in place, without copying it
+ *
+ * @param[in] handle transport handle
+ * @param[out] data the oldest unread byte
+ *
+ * @note The data stays buffered until tdl_transport_consume(), a shorter
+ * result than tdl_transport_available() means the rest follows after it. Not
+ * every driver supports it.
+ *
+ * @return the length readable at data, 0 when nothing or not supported
+ */
+uint32_t tdl_transport_peek(TDL_TRANSPORT_HANDLE handle, uint8_t **data);
+
+/**
+ * @brief release data obtained through tdl_transport_peek()
+ *
+ * @param[in] handle transport handle
+ * @param[in] len bytes consumed
+ *
+ * @return the length released
+ */
+uint32_t tdl_transport_consume(TDL_TRANSPORT_HANDLE handle, uint32_t len);
+
 uint32_t tdl_transport_available(TDL_TRANSPORT_HANDLE handle);
 
 OPERATE_RET tdl_transport_config(TDL_TRANSPORT_HANDLE handle, TDL_TRANSPORT_CMD_T cmd, void *param);
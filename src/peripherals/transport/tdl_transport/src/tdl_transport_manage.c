@@ -36,8 +36,19 @@ typedef struct {
     TDD_TRANSPORT_HANDLE_T tdd_handle; // Transport driver handle
 
     TDD_TRANSPORT_INTFS_T intfs; // Transport driver interfaces
+
+    MUTEX_HANDLE tx_mutex;   // One sender at a time, sync or async
+    QUEUE_HANDLE tx_queue;   // Lent buffers, created on the first async send
+    THREAD_HANDLE tx_thread; // Drains tx_queue
 } TDL_TRANSPORT_T, TDL_TRANSPORT_NODE_T;
 
+typedef struct {
+    const uint8_t *data;
+    uint32_t len;
+    TDL_TRANSPORT_SEND_CB cb;
+    void *arg;
+} TDL_TRANSPORT_TX_T;
+
 typedef struct {
     LIST_HEAD head; // List head for managing transport nodes
 
@@ -56,6 +67,78 @@ static TDL_TRANSPORT_LIST_T g_transport_list = {.head = LIST_HEAD_INIT(g_transpo
 /***********************************************************
 ***********************function define**********************
 ***********************************************************/
+static TDL_TRANSPORT_NODE_T *__transport_get_ready(TDL_TRANSPORT_HANDLE handle)
+{
+    TDL_TRANSPORT_NODE_T *node = (TDL_TRANSPORT_NODE_T *)handle;
+
+    if (NULL == node) {
+        return NULL;
+    }
+    if (node->magic != TDL_TRANSPORT_MAGIC) {
+        PR_ERR("Invalid transport handle magic: %d", node->magic);
+        return NULL; // Invalid magic number
+    }
+    if (node->status != TDL_TRANSPORT_STATUS_INITED) {
+        PR_ERR("Transport handle is not init, current status: %d, transport name: %s", node->status, node->name);
+        return NULL;
+    }
+
+    return node;
+}
+
+static void __transport_tx_task(void *arg)
+{
+    TDL_TRANSPORT_NODE_T *node = (TDL_TRANSPORT_NODE_T *)arg;
+    TDL_TRANSPORT_TX_T tx;
+    OPERATE_RET rt = OPRT_OK;
+
+    while (1) {
+        if (OPRT_OK != tal_queue_fetch(node->tx_queue, &tx, SEM_WAIT_FOREVER)) {
+            continue;
+        }
+
+        tal_mutex_lock(node->tx_mutex);
+        rt = node->intfs.send(node->tdd_handle, tx.data, tx.len);
+        tal_mutex_unlock(node->tx_mutex);
+        if (rt < 0) {
+            PR_ERR("Transport async send error: %d", rt);
+        }
+
+        if (tx.cb) {
+            tx.cb((TDL_TRANSPORT_HANDLE)node, tx.data, tx.len, rt < 0 ? rt : OPRT_OK, tx.arg);
+        }
+    }
+}
+
+static OPERATE_RET __transport_tx_start(TDL_TRANSPORT_NODE_T *node)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    tal_mutex_lock(g_transport_list.mutex);
+    if (node->tx_thread) {
+        tal_mutex_unlock(g_transport_list.mutex);
+        return OPRT_OK;
+    }
+
+    TUYA_CALL_ERR_GOTO(tal_queue_create_init(&node->tx_queue, sizeof(TDL_TRANSPORT_TX_T), TDL_TRANSPORT_TX_DEPTH),
+                       __EXIT);
+
+    THREAD_CFG_T thrd_cfg = {
+        .stackDepth = TDL_TRANSPORT_TX_STACK_SIZE,
+        .priority = THREAD_PRIO_2,
+        .thrdname = node->name,
+    };
+    rt = tal_thread_create_and_start(&node->tx_thread, NULL, NULL, __transport_tx_task, node, &thrd_cfg);
+    if (OPRT_OK != rt) {
+        tal_queue_free(node->tx_queue);
+        node->tx_queue = NULL;
+        node->tx_thread = NULL;
+    }
+
+__EXIT:
+    tal_mutex_unlock(g_transport_list.mutex);
+    return rt;
+}
 
 OPERATE_RET tdl_transport_find(const char *name, TDL_TRANSPORT_HANDLE *handle)
 {
@@ -145,7 +228,9 @@ OPERATE_RET tdl_transport_send(TDL_TRANSPORT_HANDLE handle, const uint8_t *data,
     TUYA_CHECK_NULL_RETURN(node->intfs.send, OPRT_INVALID_PARM);
 
     // PR_DEBUG("Sending %s to transport: %s", (char *)data, node->name);
+    tal_mutex_lock(node->tx_mutex);
     rt = node->intfs.send(node->tdd_handle, data, len);
+    tal_mutex_unlock(node->tx_mutex);
     if (rt < 0) {
         PR_ERR("Transport send error: %d", rt);
         return rt; // Return the error code from the send operation
@@ -154,6 +239,38 @@ OPERATE_RET tdl_transport_send(TDL_TRANSPORT_HANDLE handle, const uint8_t *data,
     return OPRT_OK;
 }
 
+OPERATE_RET tdl_transport_send_async(TDL_TRANSPORT_HANDLE handle, const uint8_t *data, uint32_t len,
+                                     TDL_TRANSPORT_SEND_CB cb, void *arg)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    TUYA_CHECK_NULL_RETURN(data, OPRT_INVALID_PARM);
+    if (len == 0) {
+        PR_ERR("Data length must be greater than 0");
+        return OPRT_INVALID_PARM; // Length must be greater than 0
+    }
+
+    TDL_TRANSPORT_NODE_T *node = __transport_get_ready(handle);
+    TUYA_CHECK_NULL_RETURN(node, OPRT_COM_ERROR);
+    TUYA_CHECK_NULL_RETURN(node->intfs.send, OPRT_INVALID_PARM);
+
+    if (NULL == node->tx_thread) {
+        TUYA_CALL_ERR_RETURN(__transport_tx_start(node));
+    }
+
+    TDL_TRANSPORT_TX_T tx = {
+        .data = data,
+        .len = len,
+        .cb = cb,
+        .arg = arg,
+    };
+    if (OPRT_OK != tal_queue_post(node->tx_queue, &tx, 0)) {
+        return OPRT_EXCEED_UPPER_LIMIT;
+    }
+
+    return OPRT_OK;
+}
+
 uint32_t tdl_transport_read(TDL_TRANSPORT_HANDLE handle, uint8_t *data, uint32_t len)
 {
     // OPERATE_RET rt = OPRT_OK;
@@ -182,6 +299,33 @@ uint32_t tdl_transport_read(TDL_TRANSPORT_HANDLE handle, uint8_t *data, uint32_t
     return recv_len;
 }
 
+uint32_t tdl_transport_peek(TDL_TRANSPORT_HANDLE handle, uint8_t **data)
+{
+    TUYA_CHECK_NULL_RETURN(data, 0);
+    *data = NULL;
+
+    TDL_TRANSPORT_NODE_T *node = __transport_get_ready(handle);
+    TUYA_CHECK_NULL_RETURN(node, 0);
+
+    if (NULL == node->intfs.peek || NULL == node->intfs.consume) {
+        return 0;
+    }
+
+    return node->intfs.peek(node->tdd_handle, data);
+}
+
+uint32_t tdl_transport_consume(TDL_TRANSPORT_HANDLE handle, uint32_t len)
+{
+    TDL_TRANSPORT_NODE_T *node = __transport_get_ready(handle);
+    TUYA_CHECK_NULL_RETURN(node, 0);
+
+    if (0 == len || NULL == node->intfs.consume) {
+        return 0;
+    }
+
+    return node->intfs.consume(node->tdd_handle, len);
+}
+
 uint32_t tdl_transport_available(TDL_TRANSPORT_HANDLE handle)
 {
     TUYA_CHECK_NULL_RETURN(handle, 0);
@@ -249,6 +393,12 @@ tdl_transport_driver_register(char *name, TDD_TRANSPORT_INTFS_T *intfs, TDD_TRAN
     TUYA_CHECK_NULL_RETURN(node, OPRT_MALLOC_FAILED);
     memset(node, 0, sizeof(TDL_TRANSPORT_NODE_T));
 
+    rt = tal_mutex_create_init(&node->tx_mutex);
+    if (OPRT_OK != rt) {
+        tal_free(node);
+        return rt;
+    }
+
     INIT_LIST_HEAD(&node->node);
 
     node->magic = TDL_TRANSPORT_MAGIC;
@@ -130,6 +130,30 @@ OPERATE_RET tal_ble_scan_start(TAL_BLE_SCAN_PARAMS_T const *p_scan_param);
  * */
 OPERATE_RET tal_ble_scan_stop(void);
 
+/**
+ * @brief   Filter, deduplicate and batch the advertising reports on the host
+ * @param   [in]filter:     filter, NULL removes it and reports go out one by one again
+ * @return  SUCCESS         Filter applied to the following reports.
+ *          ERROR           Invalid list size or no memory for the batch buffers.
+ * */
+OPERATE_RET tal_ble_scan_filter_set(const TAL_BLE_SCAN_FILTER_T *filter);
+
+/**
+ * @brief   Get the advertising report counters since the filter was set
+ * @param   [out]stat:      counters
+ * @return  SUCCESS         Counters read.
+ * */
+OPERATE_RET tal_ble_scan_stat_get(TAL_BLE_SCAN_STAT_T *stat);
+
+/**
+ * @brief   Get the usage of the NimBLE host buffer pools
+ * @param   [out]stat:      one entry per pool
+ * @param   [inout]num:     entries in stat, pools filled in on return
+ * @return  SUCCESS         Statistics read.
+ *          ERROR           Not supported without the NimBLE host.
+ * */
+OPERATE_RET tal_ble_pool_stat_get(TAL_BLE_POOL_STAT_T *stat, uint8_t *num);
+
 /**
  * @brief   Get the received signal strength for the last connection event.
  * @param   [in]peer:       conn_handle Connection handle.
@@ -241,6 +265,16 @@ OPERATE_RET tal_ble_client_common_read(const TAL_BLE_PEER_INFO_T peer);
  * */
 OPERATE_RET tal_ble_server_exchange_mtu_reply(const TAL_BLE_PEER_INFO_T peer, uint16_t server_mtu);
 
+/**
+ * @brief   [Ble Peripheral] Get the ATT_MTU of the link, as exchanged through
+ * TAL_BLE_EVT_MTU_REQUEST. A notification carries at most att_mtu - 3 bytes.
+ * @param   [in] peer: the peer of the link
+ * @param   [out] p_att_mtu: the mtu, TAL_BLE_ATT_MTU_DEFAULT before an exchange
+ * @return  SUCCESS
+ *          ERROR Not the connected link.
+ * */
+OPERATE_RET tal_ble_server_att_mtu_get(const TAL_BLE_PEER_INFO_T peer, uint16_t *p_att_mtu);
+
 /**
  * @brief   [Ble Central] Start an ATT_MTU exchange by sending an Exchange MTU
  * Request to the server.
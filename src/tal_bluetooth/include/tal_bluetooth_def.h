@@ -66,6 +66,9 @@
 #define TAL_COMMON_NOTIFY_CHAR_INDEX (1)
 #define TAL_COMMON_READ_CHAR_INDEX   (2)
 
+/* ATT_MTU of a link before the MTU exchange */
+#define TAL_BLE_ATT_MTU_DEFAULT (23)
+
 /* Turn on tuya private ble char for iOS execution matter provisioning*/
 #ifndef ENABLE_MATTER_TUYA_BLE_CHAR
 #define ENABLE_MATTER_TUYA_BLE_CHAR (0)
@@ -158,6 +161,48 @@ typedef struct {
     uint8_t filter_dup;     /**< Duplicate filtering ENABLE or DISABLE) */
 } TAL_BLE_SCAN_PARAMS_T;
 
+// entries of each scan filter list
+#ifndef TAL_BLE_SCAN_FILTER_MAX
+#define TAL_BLE_SCAN_FILTER_MAX (8)
+#endif
+// longest manufacturer data prefix, company id included
+#ifndef TAL_BLE_SCAN_MFR_PREFIX_MAX
+#define TAL_BLE_SCAN_MFR_PREFIX_MAX (8)
+#endif
+
+/**< Host side filter of the advertising reports, set by tal_ble_scan_filter_set.
+ * A list left empty matches every report, a report is delivered when it matches all of them. */
+typedef struct {
+    uint8_t mac_num;                                  /**< Entries in mac */
+    uint8_t mac[TAL_BLE_SCAN_FILTER_MAX][6];          /**< Accepted peer addresses */
+    uint8_t uuid_num;                                 /**< Entries in uuid16 */
+    uint16_t uuid16[TAL_BLE_SCAN_FILTER_MAX];         /**< Accepted 16-bit service uuids, listed or as service data */
+    uint8_t mfr_len;                                  /**< Length of mfr_prefix, 0 disables it */
+    uint8_t mfr_prefix[TAL_BLE_SCAN_MFR_PREFIX_MAX];  /**< Manufacturer data start, company id first in little endian */
+
+    int8_t rssi_min;        /**< Drop reports weaker than this, 0 disables it */
+    uint8_t dup_rssi_delta; /**< Report a device seen before only when its rssi moved this many dBm, 0 reports every one */
+    uint16_t dup_refresh_s; /**< Report a suppressed device again after this many seconds, 0 never does */
+    uint16_t batch_ms;      /**< Deliver the reports in TAL_BLE_EVT_ADV_REPORT_BATCH every batch_ms, 0 one by one */
+} TAL_BLE_SCAN_FILTER_T;
+
+typedef struct {
+    uint32_t received;  /**< Reports from the stack */
+    uint32_t filtered;  /**< Dropped by the filter lists or rssi_min */
+    uint32_t duplicate; /**< Dropped as duplicates */
+    uint32_t delivered; /**< Reports given to the application */
+    uint32_t batches;   /**< TAL_BLE_EVT_ADV_REPORT_BATCH events */
+} TAL_BLE_SCAN_STAT_T;
+
+typedef struct {
+    char name[32];        /**< Pool name */
+    uint32_t block_size;  /**< Bytes per block */
+    uint16_t blocks;      /**< Block count of the sizing profile */
+    uint16_t used;        /**< Blocks in use now */
+    uint16_t max_used;    /**< Most blocks in use at once */
+    uint32_t exhausted;   /**< Allocations that found the pool empty */
+} TAL_BLE_POOL_STAT_T;
+
 /**< Define these parameters for connecting */
 typedef struct {
     uint16_t conn_handle;
@@ -270,6 +315,8 @@ typedef enum {
     TAL_BLE_EVT_SUBSCRIBE, /**< [Ble Peripheral] Event Subscribe */
 
     TAL_BLE_EVT_READ_CHAR, /**< [Ble Peripheral] Read Char Event*/
+
+    TAL_BLE_EVT_ADV_REPORT_BATCH, /**< Batched scan result reports, see TAL_BLE_SCAN_FILTER_T batch_ms */
 } TAL_BLE_EVT_TYPE_E;
 
 typedef struct {
@@ -288,6 +335,11 @@ typedef struct {
     uint16_t offset;      /**< Char Offset */
 } TAL_BLE_READ_CHAR_EVT_T;
 
+typedef struct {
+    uint8_t num;                  /**< Reports in report */
+    TAL_BLE_ADV_REPORT_T *report; /**< Reports, valid in the callback only */
+} TAL_BLE_ADV_BATCH_T;
+
 typedef struct {
     TAL_BLE_EVT_TYPE_E type;
 
@@ -308,6 +360,7 @@ typedef struct {
         TAL_BLE_DATA_REPORT_T data_read; /**< After we do read attr in central mode, we will get the callback from bluetooth Kernel */
         TAL_BLE_SUBSCRBE_EVT_T subscribe;  /**< used with TAL_BLE_EVT_SUBSCRIBE*/
         TAL_BLE_READ_CHAR_EVT_T char_read; /**< read char event, used with TAL_BLE_EVT_READ_CHAR*/
+        TAL_BLE_ADV_BATCH_T adv_batch;     /**< used with TAL_BLE_EVT_ADV_REPORT_BATCH */
     } ble_event;
 } TAL_BLE_EVT_PARAMS_T;
 
@@ -16,6 +16,7 @@
 #define _TUYA_HCI_TRANSPORT_H_
 
 #include <inttypes.h>
+#include "tuya_ble_cfg.h"
 #include "tuya_ble_mempool.h"
 
 #ifdef __cplusplus
@@ -293,6 +293,9 @@ struct os_mbuf *os_dyna_mbuf_get(struct os_mbuf_pool *omp, uint16_t leadingspace
 
     extern void *tuya_ble_hci_dyna_buf_alloc(int type, struct os_mempool *dynapool);
     om = tuya_ble_hci_dyna_buf_alloc(0, omp->omp_pool);
+    if (om == NULL) {
+        goto done;
+    }
 
     SLIST_NEXT(om, om_next) = NULL;
     om->om_flags = TUYA_USE_DYNA_RAM_FLAG;
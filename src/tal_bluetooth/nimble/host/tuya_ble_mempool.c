@@ -42,7 +42,7 @@
 #define SYSINIT_MSYS_1_MEMBLOCK_SIZE        OS_ALIGN((TY_HS_MSYS_1_BLOCK_SIZE), 4)
 #define SYSINIT_MSYS_1_MEMPOOL_SIZE         OS_MEMPOOL_SIZE((TY_HS_MSYS_1_BLOCK_COUNT), SYSINIT_MSYS_1_MEMBLOCK_SIZE)
 
-STAILQ_HEAD(, os_mempool)                   g_os_mempool_list;
+STAILQ_HEAD(, os_mempool)                   g_os_mempool_list = STAILQ_HEAD_INITIALIZER(g_os_mempool_list);
 static STAILQ_HEAD(, os_mbuf_pool)          g_msys_pool_list = STAILQ_HEAD_INITIALIZER(g_msys_pool_list);
 
 #if defined(TUYA_USE_DYNA_RAM) && (TUYA_USE_DYNA_RAM==0)
@@ -209,6 +209,19 @@ void os_msys_init(void)
 }
 
 
+/* HCI pools are initialized again on every stack start, list a pool once */
+static void os_mempool_register(struct os_mempool *mp)
+{
+    struct os_mempool *cur;
+
+    STAILQ_FOREACH(cur, &g_os_mempool_list, mp_list) {
+        if (cur == mp) {
+            return;
+        }
+    }
+    STAILQ_INSERT_TAIL(&g_os_mempool_list, mp, mp_list);
+}
+
 static stats_error_t os_mempool_init_internal(struct os_mempool *mp, uint16_t blocks,
                          uint32_t block_size, void *membuf, char *name,
                          uint8_t flags)
@@ -244,6 +257,8 @@ static stats_error_t os_mempool_init_internal(struct os_mempool *mp, uint16_t bl
     mp->mp_num_blocks = blocks;
     mp->mp_membuf_addr = (uint32_t)(uintptr_t)membuf;
     mp->name = name;
+    mp->mp_max_used = 0;
+    mp->mp_exhausted = 0;
     SLIST_FIRST(mp) = membuf;
 
     if (blocks > 0) {
@@ -266,7 +281,7 @@ static stats_error_t os_mempool_init_internal(struct os_mempool *mp, uint16_t bl
         SLIST_NEXT(block_ptr, mb_next) = NULL;
     }
 
-    STAILQ_INSERT_TAIL(&g_os_mempool_list, mp, mp_list);
+    os_mempool_register(mp);
 
     return OS_OK;
 }
@@ -295,6 +310,10 @@ stats_error_t os_dynamempool_init(struct os_mempool *mp, uint16_t blocks, uint32
     mp->mp_num_blocks = blocks;
     mp->name = name;
     mp->mp_membuf_addr = 0;
+    mp->mp_max_used = 0;
+    mp->mp_exhausted = 0;
+
+    os_mempool_register(mp);
 
     return OS_OK;
 }
@@ -468,7 +487,10 @@ void *os_memblock_get(struct os_mempool *mp)
             mp->mp_num_free--;
             if (mp->mp_min_free > mp->mp_num_free) {
                 mp->mp_min_free = mp->mp_num_free;
+                mp->mp_max_used = mp->mp_num_blocks - mp->mp_num_free;
             }
+        } else {
+            mp->mp_exhausted++;
         }
         tuya_ble_hs_exit_critical();
 
@@ -581,6 +603,8 @@ struct os_mempool *os_mempool_info_get_next(struct os_mempool *mp, struct os_mem
     omi->omi_num_blocks = cur->mp_num_blocks;
     omi->omi_num_free = cur->mp_num_free;
     omi->omi_min_free = cur->mp_min_free;
+    omi->omi_max_used = cur->mp_max_used;
+    omi->omi_exhausted = cur->mp_exhausted;
     omi->omi_name[0] = '\0';
     strncat(omi->omi_name, cur->name, sizeof(omi->omi_name) - 1);
 
@@ -589,5 +613,5 @@ struct os_mempool *os_mempool_info_get_next(struct os_mempool *mp, struct os_mem
 
 void os_mempool_module_init(void)
 {
-    STAILQ_INIT(&g_os_mempool_list);
+    /* The list is initialized statically, the HCI pools are set up before the host and must stay in it */
 }
@@ -32,6 +32,7 @@
 #include "tuya_ble_linkqueue.h"
 #include "tuya_ble_mbuf.h"
 #include "ble_endian.h"
+#include "tuya_ble_cfg.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,8 +40,14 @@ extern "C" {
 
 //Dyna Ram Open
 #define TUYA_USE_DYNA_RAM               1
-//Max Dyna Num Limit
+//Max Dyna Num Limit, TAL_BLE_POOL_LIMIT in Kconfig
+#ifndef TUYA_DYNA_ALLOCATION_LIMIT
+#if defined(TAL_BLE_POOL_LIMIT) && (TAL_BLE_POOL_LIMIT == 1)
+#define TUYA_DYNA_ALLOCATION_LIMIT      1
+#else
 #define TUYA_DYNA_ALLOCATION_LIMIT      0
+#endif
+#endif
 #define TUYA_USE_DYNA_RAM_FLAG          0x02
 
 /* OS error enumerations */
@@ -97,6 +104,10 @@ struct os_mempool {
     SLIST_HEAD(,os_memblock);
     /** Name for memory block */
     char *name;
+    /** The most blocks in use at once, may pass mp_num_blocks without the allocation limit */
+    uint16_t mp_max_used;
+    /** Allocations that found no free block */
+    uint32_t mp_exhausted;
 };
 
 /**
@@ -153,6 +164,10 @@ struct os_mempool_info {
     int omi_min_free;
     /** Name of the memory pool */
     char omi_name[OS_MEMPOOL_INFO_NAME_LEN];
+    /** Most blocks in use at once */
+    int omi_max_used;
+    /** Allocations that found no free block */
+    uint32_t omi_exhausted;
 };
 
 /**
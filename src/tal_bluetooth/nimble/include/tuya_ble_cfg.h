@@ -101,6 +101,47 @@
 #define TY_HS_BLE_DEVICE (1)
 #endif
 
+// Host buffer sizing profile chosen in Kconfig, msys blocks, ACL buffers and HCI event buffers
+#if defined(TAL_BLE_POOL_PROVISION) && (TAL_BLE_POOL_PROVISION == 1)
+#ifndef TY_HS_MSYS_1_BLOCK_COUNT
+#define TY_HS_MSYS_1_BLOCK_COUNT 24
+#endif
+#ifndef TUYA_BLE_ACL_BUF_COUNT
+#define TUYA_BLE_ACL_BUF_COUNT (4)
+#endif
+#ifndef TUYA_BLE_HCI_EVT_HI_BUF_COUNT
+#define TUYA_BLE_HCI_EVT_HI_BUF_COUNT (8)
+#endif
+#ifndef TUYA_BLE_HCI_EVT_LO_BUF_COUNT
+#define TUYA_BLE_HCI_EVT_LO_BUF_COUNT (4)
+#endif
+#elif defined(TAL_BLE_POOL_LOCAL) && (TAL_BLE_POOL_LOCAL == 1)
+#ifndef TY_HS_MSYS_1_BLOCK_COUNT
+#define TY_HS_MSYS_1_BLOCK_COUNT 64
+#endif
+#ifndef TUYA_BLE_ACL_BUF_COUNT
+#define TUYA_BLE_ACL_BUF_COUNT (8)
+#endif
+#ifndef TUYA_BLE_HCI_EVT_HI_BUF_COUNT
+#define TUYA_BLE_HCI_EVT_HI_BUF_COUNT (16)
+#endif
+#ifndef TUYA_BLE_HCI_EVT_LO_BUF_COUNT
+#define TUYA_BLE_HCI_EVT_LO_BUF_COUNT (8)
+#endif
+#elif defined(TAL_BLE_POOL_GATEWAY) && (TAL_BLE_POOL_GATEWAY == 1)
+#ifndef TY_HS_MSYS_1_BLOCK_COUNT
+#define TY_HS_MSYS_1_BLOCK_COUNT 256
+#endif
+#ifndef TUYA_BLE_ACL_BUF_COUNT
+#define TUYA_BLE_ACL_BUF_COUNT (24)
+#endif
+#ifndef TUYA_BLE_HCI_EVT_HI_BUF_COUNT
+#define TUYA_BLE_HCI_EVT_HI_BUF_COUNT (32)
+#endif
+#ifndef TUYA_BLE_HCI_EVT_LO_BUF_COUNT
+#define TUYA_BLE_HCI_EVT_LO_BUF_COUNT (32)
+#endif
+#endif
 
 #ifndef TY_HS_MSYS_1_BLOCK_COUNT
 #define TY_HS_MSYS_1_BLOCK_COUNT 1000
@@ -13,6 +13,8 @@
 #include "tal_system.h"
 #include "tkl_hci.h"
 #include "tal_memory.h"
+#include "tal_bluetooth_def.h"
+#include "tuya_ble_mempool.h"
 
 #if (TY_HS_BLE_ROLE_CENTRAL)
 typedef struct {
@@ -1407,3 +1409,29 @@ OPERATE_RET tkl_ble_gattc_exchange_mtu_request(uint16_t conn_handle, uint16_t cl
 
     return OPRT_OK;
 }
+
+/**
+ * @brief   Fill in the usage of the host buffer pools, for tal_ble_pool_stat_get.
+ * @param   [out] stat      one entry per pool
+ *          [in] num        entries in stat
+ * @return  pools filled in
+ * */
+uint8_t tuya_ble_host_pool_stat_get(TAL_BLE_POOL_STAT_T *stat, uint8_t num)
+{
+    struct os_mempool *mp = NULL;
+    struct os_mempool_info omi;
+    uint8_t cnt = 0;
+
+    while (cnt < num && (mp = os_mempool_info_get_next(mp, &omi)) != NULL) {
+        strncpy(stat[cnt].name, omi.omi_name, sizeof(stat[cnt].name) - 1);
+        stat[cnt].name[sizeof(stat[cnt].name) - 1] = '\0';
+        stat[cnt].block_size = omi.omi_block_size;
+        stat[cnt].blocks = omi.omi_num_blocks;
+        stat[cnt].used = (uint16_t)(omi.omi_num_blocks - omi.omi_num_free);
+        stat[cnt].max_used = omi.omi_max_used;
+        stat[cnt].exhausted = omi.omi_exhausted;
+        cnt++;
+    }
+
+    return cnt;
+}
@@ -44,6 +44,7 @@ static TKL_BLE_SERVICE_PARAMS_T *ptkl_ble_service = NULL;
 static TKL_BLE_CHAR_PARAMS_T *ptkl_ble_service_char = NULL;
 
 static uint16_t tkl_ble_common_connect_handle = TKL_BLE_GATT_INVALID_HANDLE;
+static uint16_t tal_ble_common_att_mtu = TAL_BLE_ATT_MTU_DEFAULT;
 
 /**< Use TAL Definitions, TAL Only Support One GATT Link at one time, follow
  * Bluetooth Spec. */
@@ -52,6 +53,51 @@ static TAL_BLE_EVT_FUNC_CB tal_ble_event_callback;
 static TAL_BLE_PEER_INFO_T tal_ble_peer = {0};
 #endif
 
+// devices remembered for the duplicate suppression of the scan filter
+#ifndef TAL_BLE_SCAN_DUP_MAX
+#define TAL_BLE_SCAN_DUP_MAX (32)
+#endif
+// reports held for one TAL_BLE_EVT_ADV_REPORT_BATCH
+#ifndef TAL_BLE_SCAN_BATCH_MAX
+#define TAL_BLE_SCAN_BATCH_MAX (16)
+#endif
+// advertising data kept per batched report, adv and scan response
+#define TAL_BLE_SCAN_DATA_MAX (62)
+
+#define TAL_BLE_AD_TYPE_UUID16_MORE     (0x02)
+#define TAL_BLE_AD_TYPE_UUID16_COMPLETE (0x03)
+#define TAL_BLE_AD_TYPE_SERVICE_DATA16  (0x16)
+#define TAL_BLE_AD_TYPE_MANUFACTURER    (0xFF)
+
+typedef struct {
+    uint8_t addr[6];
+    uint8_t adv_type;
+    int8_t rssi; // rssi of the last delivered report
+    uint32_t seen_ms;
+} TAL_BLE_SCAN_DUP_T;
+
+typedef struct {
+    uint8_t num;
+    TAL_BLE_ADV_REPORT_T report[TAL_BLE_SCAN_BATCH_MAX];
+    uint8_t data[TAL_BLE_SCAN_BATCH_MAX][TAL_BLE_SCAN_DATA_MAX];
+} TAL_BLE_SCAN_BATCH_T;
+
+typedef struct {
+    bool_t enable;
+    TAL_BLE_SCAN_FILTER_T filter;
+    TAL_BLE_SCAN_STAT_T stat;
+    MUTEX_HANDLE mutex;       // filter, dup table and the batch being filled
+    MUTEX_HANDLE flush_mutex; // one batch delivered at a time
+    TIMER_ID timer;
+    TAL_BLE_SCAN_DUP_T *dup;
+    uint8_t dup_num;
+    TAL_BLE_SCAN_BATCH_T *batch; // two, one filled while the other is delivered
+    uint8_t fill;
+} TAL_BLE_SCAN_CTX_T;
+
+// created by the first tal_ble_scan_filter_set and kept, the stack may report at any time
+static TAL_BLE_SCAN_CTX_T *tal_ble_scan_ctx = NULL;
+
 static __attribute__((unused)) uint16_t tal_ble_uuid16_convert(TKL_BLE_UUID_T *p_uuid)
 {
     uint16_t uuid16 = 0xFFFF;
@@ -69,6 +115,183 @@ static __attribute__((unused)) uint16_t tal_ble_uuid16_convert(TKL_BLE_UUID_T *p
     return 0xFFFF;
 }
 
+static bool_t tal_ble_scan_uuid_match(const TAL_BLE_SCAN_FILTER_T *filter, const uint8_t *p_uuid)
+{
+    uint16_t uuid16 = p_uuid[0] | (p_uuid[1] << 8);
+    uint8_t i;
+
+    for (i = 0; i < filter->uuid_num; i++) {
+        if (filter->uuid16[i] == uuid16) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static bool_t tal_ble_scan_match(const TAL_BLE_SCAN_FILTER_T *filter, const TAL_BLE_ADV_REPORT_T *report)
+{
+    bool_t uuid_ok = (filter->uuid_num == 0);
+    bool_t mfr_ok = (filter->mfr_len == 0);
+    uint8_t i, pos, len, type;
+    const uint8_t *field;
+
+    if (filter->rssi_min && (int8_t)report->rssi < filter->rssi_min) {
+        return FALSE;
+    }
+
+    if (filter->mac_num) {
+        for (i = 0; i < filter->mac_num; i++) {
+            if (memcmp(filter->mac[i], report->peer_addr.addr, 6) == 0) {
+                break;
+            }
+        }
+        if (i == filter->mac_num) {
+            return FALSE;
+        }
+    }
+
+    /**< Walk the AD structures: length, type, length - 1 bytes of data */
+    for (pos = 0; (!uuid_ok || !mfr_ok) && pos + 1 < report->data_len; pos += len + 1) {
+        len = report->p_data[pos];
+        if (len == 0 || pos + 1 + len > report->data_len) {
+            break;
+        }
+        type = report->p_data[pos + 1];
+        field = &report->p_data[pos + 2];
+
+        if (type == TAL_BLE_AD_TYPE_UUID16_MORE || type == TAL_BLE_AD_TYPE_UUID16_COMPLETE) {
+            for (i = 0; !uuid_ok && i + 2 < len; i += 2) {
+                uuid_ok = tal_ble_scan_uuid_match(filter, &field[i]);
+            }
+        } else if (type == TAL_BLE_AD_TYPE_SERVICE_DATA16) {
+            uuid_ok = uuid_ok || (len > 2 && tal_ble_scan_uuid_match(filter, field));
+        } else if (type == TAL_BLE_AD_TYPE_MANUFACTURER) {
+            mfr_ok = mfr_ok || (len > filter->mfr_len && memcmp(field, filter->mfr_prefix, filter->mfr_len) == 0);
+        }
+    }
+
+    return (uuid_ok && mfr_ok);
+}
+
+static bool_t tal_ble_scan_is_dup(TAL_BLE_SCAN_CTX_T *ctx, const TAL_BLE_ADV_REPORT_T *report)
+{
+    TAL_BLE_SCAN_DUP_T *entry = NULL;
+    uint32_t now = tal_system_get_millisecond();
+    uint32_t refresh_ms = ctx->filter.dup_refresh_s * 1000;
+    uint8_t i, oldest = 0;
+    int delta;
+
+    if (ctx->dup == NULL || ctx->filter.dup_rssi_delta == 0) {
+        return FALSE;
+    }
+
+    for (i = 0; i < ctx->dup_num; i++) {
+        if (ctx->dup[i].adv_type == report->adv_type && memcmp(ctx->dup[i].addr, report->peer_addr.addr, 6) == 0) {
+            entry = &ctx->dup[i];
+            break;
+        }
+        if (now - ctx->dup[i].seen_ms > now - ctx->dup[oldest].seen_ms) {
+            oldest = i;
+        }
+    }
+
+    if (entry) {
+        delta = (int8_t)report->rssi - entry->rssi;
+        if (delta < 0) {
+            delta = -delta;
+        }
+        if (delta < ctx->filter.dup_rssi_delta && (refresh_ms == 0 || now - entry->seen_ms < refresh_ms)) {
+            return TRUE;
+        }
+    } else {
+        /**< A new device, take a free entry or the one not reported for the longest time */
+        entry = &ctx->dup[(ctx->dup_num < TAL_BLE_SCAN_DUP_MAX) ? ctx->dup_num++ : oldest];
+        memcpy(entry->addr, report->peer_addr.addr, 6);
+        entry->adv_type = report->adv_type;
+    }
+
+    entry->rssi = (int8_t)report->rssi;
+    entry->seen_ms = now;
+    return FALSE;
+}
+
+static void tal_ble_scan_flush(TAL_BLE_SCAN_CTX_T *ctx)
+{
+    TAL_BLE_SCAN_BATCH_T *batch = NULL;
+    TAL_BLE_EVT_PARAMS_T tal_event;
+
+    tal_mutex_lock(ctx->flush_mutex);
+
+    tal_mutex_lock(ctx->mutex);
+    if (ctx->batch && ctx->batch[ctx->fill].num) {
+        batch = &ctx->batch[ctx->fill];
+        ctx->fill ^= 1;
+        ctx->batch[ctx->fill].num = 0;
+        ctx->stat.delivered += batch->num;
+        ctx->stat.batches++;
+    }
+    tal_mutex_unlock(ctx->mutex);
+
+    if (batch && tal_ble_event_callback) {
+        memset(&tal_event, 0, sizeof(TAL_BLE_EVT_PARAMS_T));
+        tal_event.type = TAL_BLE_EVT_ADV_REPORT_BATCH;
+        tal_event.ble_event.adv_batch.num = batch->num;
+        tal_event.ble_event.adv_batch.report = batch->report;
+        tal_ble_event_callback(&tal_event);
+    }
+
+    tal_mutex_unlock(ctx->flush_mutex);
+}
+
+static void tal_ble_scan_timer_cb(TIMER_ID timer_id, void *arg)
+{
+    tal_ble_scan_flush((TAL_BLE_SCAN_CTX_T *)arg);
+}
+
+/**< Return TRUE when the report was dropped or batched, FALSE to deliver it as it is */
+static bool_t tal_ble_scan_take(TAL_BLE_ADV_REPORT_T *report)
+{
+    TAL_BLE_SCAN_CTX_T *ctx = tal_ble_scan_ctx;
+    TAL_BLE_SCAN_BATCH_T *batch;
+    TAL_BLE_ADV_REPORT_T *slot;
+    bool_t taken = TRUE, full = FALSE;
+
+    if (ctx == NULL) {
+        return FALSE;
+    }
+
+    tal_mutex_lock(ctx->mutex);
+    if (ctx->enable) {
+        ctx->stat.received++;
+    }
+
+    if (!ctx->enable) {
+        taken = FALSE;
+    } else if (!tal_ble_scan_match(&ctx->filter, report)) {
+        ctx->stat.filtered++;
+    } else if (tal_ble_scan_is_dup(ctx, report)) {
+        ctx->stat.duplicate++;
+    } else if (ctx->filter.batch_ms == 0 || ctx->batch == NULL) {
+        ctx->stat.delivered++;
+        taken = FALSE;
+    } else {
+        batch = &ctx->batch[ctx->fill];
+        slot = &batch->report[batch->num];
+        *slot = *report;
+        slot->data_len = (report->data_len > TAL_BLE_SCAN_DATA_MAX) ? TAL_BLE_SCAN_DATA_MAX : report->data_len;
+        slot->p_data = batch->data[batch->num];
+        memcpy(slot->p_data, report->p_data, slot->data_len);
+        full = (++batch->num == TAL_BLE_SCAN_BATCH_MAX);
+    }
+    tal_mutex_unlock(ctx->mutex);
+
+    /**< Do not wait for the timer with a full batch, the next report would have nowhere to go */
+    if (full) {
+        tal_ble_scan_flush(ctx);
+    }
+    return taken;
+}
+
 static void tkl_ble_kernel_gap_event_callback(TKL_BLE_GAP_PARAMS_EVT_T *p_event)
 {
     TAL_BLE_EVT_PARAMS_T tal_event;
@@ -136,6 +359,7 @@ static void tkl_ble_kernel_gap_event_callback(TKL_BLE_GAP_PARAMS_EVT_T *p_event)
         if (p_event->gap_event.disconnect.role == TKL_BLE_ROLE_SERVER &&
             p_event->conn_handle == tkl_ble_common_connect_handle) {
             tkl_ble_common_connect_handle = TKL_BLE_GATT_INVALID_HANDLE;
+            tal_ble_common_att_mtu = TAL_BLE_ATT_MTU_DEFAULT;
         }
 
         tal_event.type = TAL_BLE_EVT_DISCONNECT;
@@ -167,6 +391,10 @@ static void tkl_ble_kernel_gap_event_callback(TKL_BLE_GAP_PARAMS_EVT_T *p_event)
              * Device will not use other types. */
             return;
         }
+
+        if (tal_ble_scan_take(&tal_event.ble_event.adv_report)) {
+            return;
+        }
     } break;
 
     case TKL_BLE_GAP_EVT_CONN_PARAM_REQ: {
@@ -216,6 +444,10 @@ static void tkl_ble_kernel_gatt_event_callback(TKL_BLE_GATT_PARAMS_EVT_T *p_even
         tal_event.type = TAL_BLE_EVT_MTU_REQUEST;
         tal_event.ble_event.exchange_mtu.conn_handle = p_event->conn_handle;
         tal_event.ble_event.exchange_mtu.mtu = p_event->gatt_event.exchange_mtu;
+        if (p_event->conn_handle == tkl_ble_common_connect_handle &&
+            p_event->gatt_event.exchange_mtu >= TAL_BLE_ATT_MTU_DEFAULT) {
+            tal_ble_common_att_mtu = p_event->gatt_event.exchange_mtu;
+        }
     } break;
 #if (TY_HS_BLE_ROLE_CENTRAL)
     case TKL_BLE_GATT_EVT_MTU_RSP: {
@@ -745,7 +977,138 @@ OPERATE_RET tal_ble_scan_start(TAL_BLE_SCAN_PARAMS_T const *p_scan_param)
  * */
 OPERATE_RET tal_ble_scan_stop(void)
 {
-    return tkl_ble_gap_scan_stop();
+    OPERATE_RET rt = tkl_ble_gap_scan_stop();
+
+    /**< Hand over what the last interval batched */
+    if (tal_ble_scan_ctx) {
+        tal_ble_scan_flush(tal_ble_scan_ctx);
+    }
+    return rt;
+}
+
+/**
+ * @brief   Filter, deduplicate and batch the advertising reports on the host
+ * @param   [in]filter:     filter, NULL removes it and reports go out one by one again
+ * @return  SUCCESS         Filter applied to the following reports.
+ *          ERROR           Invalid list size or no memory for the batch buffers.
+ * */
+OPERATE_RET tal_ble_scan_filter_set(const TAL_BLE_SCAN_FILTER_T *filter)
+{
+    OPERATE_RET rt = OPRT_OK;
+    TAL_BLE_SCAN_CTX_T *ctx = tal_ble_scan_ctx;
+    TAL_BLE_SCAN_DUP_T *dup = NULL;
+    TAL_BLE_SCAN_BATCH_T *batch = NULL;
+
+    if (filter && (filter->mac_num > TAL_BLE_SCAN_FILTER_MAX || filter->uuid_num > TAL_BLE_SCAN_FILTER_MAX ||
+                   filter->mfr_len > TAL_BLE_SCAN_MFR_PREFIX_MAX)) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (ctx == NULL) {
+        if (filter == NULL) {
+            return OPRT_OK;
+        }
+        ctx = tal_malloc(sizeof(TAL_BLE_SCAN_CTX_T));
+        TUYA_CHECK_NULL_RETURN(ctx, OPRT_MALLOC_FAILED);
+        memset(ctx, 0, sizeof(TAL_BLE_SCAN_CTX_T));
+
+        TUYA_CALL_ERR_GOTO(tal_mutex_create_init(&ctx->mutex), __ERR);
+        TUYA_CALL_ERR_GOTO(tal_mutex_create_init(&ctx->flush_mutex), __ERR);
+        TUYA_CALL_ERR_GOTO(tal_sw_timer_create(tal_ble_scan_timer_cb, ctx, &ctx->timer), __ERR);
+        tal_ble_scan_ctx = ctx;
+    }
+
+    /**< The tables are allocated on first use and kept */
+    if (filter && filter->dup_rssi_delta && ctx->dup == NULL) {
+        dup = tal_malloc(TAL_BLE_SCAN_DUP_MAX * sizeof(TAL_BLE_SCAN_DUP_T));
+        TUYA_CHECK_NULL_RETURN(dup, OPRT_MALLOC_FAILED);
+    }
+    if (filter && filter->batch_ms && ctx->batch == NULL) {
+        batch = tal_malloc(2 * sizeof(TAL_BLE_SCAN_BATCH_T));
+        if (batch == NULL) {
+            tal_free(dup);
+            return OPRT_MALLOC_FAILED;
+        }
+        memset(batch, 0, 2 * sizeof(TAL_BLE_SCAN_BATCH_T));
+    }
+
+    tal_sw_timer_stop(ctx->timer);
+
+    tal_mutex_lock(ctx->mutex);
+    if (dup) {
+        ctx->dup = dup;
+    }
+    if (batch) {
+        ctx->batch = batch;
+    }
+    if (filter) {
+        memcpy(&ctx->filter, filter, sizeof(TAL_BLE_SCAN_FILTER_T));
+    }
+    ctx->enable = (filter != NULL);
+    ctx->dup_num = 0;
+    memset(&ctx->stat, 0, sizeof(TAL_BLE_SCAN_STAT_T));
+    tal_mutex_unlock(ctx->mutex);
+
+    /**< Reports batched under the previous filter go out now */
+    tal_ble_scan_flush(ctx);
+
+    if (filter && filter->batch_ms) {
+        tal_sw_timer_start(ctx->timer, filter->batch_ms, TAL_TIMER_CYCLE);
+    }
+    return OPRT_OK;
+
+__ERR:
+    if (ctx->flush_mutex) {
+        tal_mutex_release(ctx->flush_mutex);
+    }
+    if (ctx->mutex) {
+        tal_mutex_release(ctx->mutex);
+    }
+    tal_free(ctx);
+    return rt;
+}
+
+/**
+ * @brief   Get the advertising report counters since the filter was set
+ * @param   [out]stat:      counters
+ * @return  SUCCESS         Counters read.
+ * */
+OPERATE_RET tal_ble_scan_stat_get(TAL_BLE_SCAN_STAT_T *stat)
+{
+    TUYA_CHECK_NULL_RETURN(stat, OPRT_INVALID_PARM);
+
+    if (tal_ble_scan_ctx == NULL) {
+        memset(stat, 0, sizeof(TAL_BLE_SCAN_STAT_T));
+        return OPRT_OK;
+    }
+
+    tal_mutex_lock(tal_ble_scan_ctx->mutex);
+    memcpy(stat, &tal_ble_scan_ctx->stat, sizeof(TAL_BLE_SCAN_STAT_T));
+    tal_mutex_unlock(tal_ble_scan_ctx->mutex);
+    return OPRT_OK;
+}
+
+/**
+ * @brief   Get the usage of the NimBLE host buffer pools
+ * @param   [out]stat:      one entry per pool
+ * @param   [inout]num:     entries in stat, pools filled in on return
+ * @return  SUCCESS         Statistics read.
+ *          ERROR           Not supported without the NimBLE host.
+ * */
+OPERATE_RET tal_ble_pool_stat_get(TAL_BLE_POOL_STAT_T *stat, uint8_t *num)
+{
+#if defined(ENABLE_NIMBLE) && (ENABLE_NIMBLE == 1)
+    /**< In the NimBLE port, the tal layer does not include the host headers */
+    extern uint8_t tuya_ble_host_pool_stat_get(TAL_BLE_POOL_STAT_T *stat, uint8_t num);
+
+    TUYA_CHECK_NULL_RETURN(stat, OPRT_INVALID_PARM);
+    TUYA_CHECK_NULL_RETURN(num, OPRT_INVALID_PARM);
+
+    *num = tuya_ble_host_pool_stat_get(stat, *num);
+    return OPRT_OK;
+#else
+    return OPRT_NOT_SUPPORTED;
+#endif
 }
 
 /**
@@ -1013,6 +1376,27 @@ OPERATE_RET tal_ble_server_exchange_mtu_reply(const TAL_BLE_PEER_INFO_T peer, ui
     return tkl_ble_gatts_exchange_mtu_reply(conn_handle, server_mtu);
 }
 
+/**
+ * @brief   [Ble Peripheral] Get the ATT_MTU of the link, as exchanged through
+ * TAL_BLE_EVT_MTU_REQUEST. A notification carries at most att_mtu - 3 bytes.
+ * @param   [in] peer: the peer of the link
+ * @param   [out] p_att_mtu: the mtu, TAL_BLE_ATT_MTU_DEFAULT before an exchange
+ * @return  SUCCESS
+ *          ERROR Not the connected link.
+ * */
+OPERATE_RET tal_ble_server_att_mtu_get(const TAL_BLE_PEER_INFO_T peer, uint16_t *p_att_mtu)
+{
+    if (NULL == p_att_mtu) {
+        return OPRT_INVALID_PARM;
+    }
+    if (peer.conn_handle != tkl_ble_common_connect_handle) {
+        return OPRT_OS_ADAPTER_BLE_GATT_CONN_FAILED;
+    }
+
+    *p_att_mtu = tal_ble_common_att_mtu;
+    return OPRT_OK;
+}
+
 #if (TY_HS_BLE_ROLE_CENTRAL)
 /**
  * @brief   [Ble Central] Start an ATT_MTU exchange by sending an Exchange MTU
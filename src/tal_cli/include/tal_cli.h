@@ -61,6 +61,15 @@ int tal_cli_init(void);
  */
 int tal_cli_cmd_register(const cli_cmd_t *cmd, uint8_t num);
 
+/**
+ * @brief add subcommands to the perf command, "perf <name>" runs one
+ * @param[in] cmd Info of the subcommands, must stay valid
+ * @param[in] num Number
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+int tal_cli_perf_register(const cli_cmd_t *cmd, uint8_t num);
+
 /**
  * @brief uart cli init
  *
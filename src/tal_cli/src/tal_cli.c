@@ -15,13 +15,21 @@
  */
 
 /*============================ INCLUDES ======================================*/
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "tuya_slist.h"
 #include "tal_uart.h"
 #include "tal_log.h"
 #include "tal_cli.h"
 #include "tal_thread.h"
+#include "tal_mutex.h"
 #include "tal_memory.h"
+#include "tal_sw_timer.h"
+#include "tal_workq_service.h"
+#include "tal_network.h"
+#include "tal_trace.h"
+#include "tal_boot_mark.h"
 
 /*============================ MACROS ========================================*/
 #ifndef CLI_BUFFER_SIZE
@@ -43,6 +51,11 @@
 #ifndef CLI_CMD_NAME_MAX
 #define CLI_CMD_NAME_MAX 20
 #endif
+
+// perf subcommands other modules may add, see tal_cli_perf_register()
+#ifndef CLI_PERF_EXT_NUM
+#define CLI_PERF_EXT_NUM 4
+#endif
 /*============================ MACROFIED FUNCTIONS ===========================*/
 /*============================ TYPES =========================================*/
 typedef struct {
@@ -95,18 +108,82 @@ typedef struct {
 
 /*============================ PROTOTYPES ====================================*/
 static void cli_hello(int argc, char *argv[]);
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+static void cli_top(int argc, char *argv[]);
+#endif
+static void cli_perf(int argc, char *argv[]);
+static void cli_perf_top(int argc, char *argv[]);
+static void cli_perf_heap(int argc, char *argv[]);
+static void cli_perf_timers(int argc, char *argv[]);
+static void cli_perf_wq(int argc, char *argv[]);
+static void cli_perf_trace(int argc, char *argv[]);
+static void cli_perf_boot(int argc, char *argv[]);
+static void cli_perf_mutex(int argc, char *argv[]);
 static void cli_print_prompt(cli_t *cli);
 
 /*============================ LOCAL VARIABLES ===============================*/
 static cli_t *s_cli_handle = NULL;
 static SLIST_HEAD s_cli_dynamic_table;
 static cli_cmd_table_t s_cli_static_table[CLI_CMD_TABLE_NUM];
+static cli_cmd_table_t s_cli_perf_ext[CLI_PERF_EXT_NUM];
 
-static const cli_cmd_t s_cli_cmd[] = {{
-    .name = "hello",
-    .help = "print helo world",
-    .func = cli_hello,
-}};
+static const cli_cmd_t s_cli_cmd[] = {
+    {
+        .name = "hello",
+        .help = "print helo world",
+        .func = cli_hello,
+    },
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+    {
+        .name = "top",
+        .help = "top [reset], show thread busy share, stack and waits",
+        .func = cli_top,
+    },
+#endif
+    {
+        .name = "perf",
+        .help = "perf <top|heap|timers|wq|trace|boot|mutex|...>, show performance counters",
+        .func = cli_perf,
+    },
+};
+
+static const cli_cmd_t s_cli_perf_cmd[] = {
+    {
+        .name = "top",
+        .help = "top [reset], thread busy share, stack and waits",
+        .func = cli_perf_top,
+    },
+    {
+        .name = "heap",
+        .help = "heap [sites|snap|diff], free heap, fragmentation, slab classes and allocation sites",
+        .func = cli_perf_heap,
+    },
+    {
+        .name = "timers",
+        .help = "timers [reset], software timer latency and overruns",
+        .func = cli_perf_timers,
+    },
+    {
+        .name = "wq",
+        .help = "items waiting in the workqueue services",
+        .func = cli_perf_wq,
+    },
+    {
+        .name = "trace",
+        .help = "trace <start|stop|dump|send <ip> <port>>, timeline of callbacks and waits",
+        .func = cli_perf_trace,
+    },
+    {
+        .name = "boot",
+        .help = "boot timeline, from reset to the cloud connection",
+        .func = cli_perf_boot,
+    },
+    {
+        .name = "mutex",
+        .help = "mutex [reset], lock contention, waits and holds",
+        .func = cli_perf_mutex,
+    },
+};
 
 /*============================ IMPLEMENTATION ================================*/
 static int32_t cli_out_put(TUYA_UART_NUM_E port_id, char *out_str, uint32_t len)
@@ -127,6 +204,382 @@ static void cli_hello(int argc, char *argv[])
     cli_print_string(s_cli_handle, "helo world");
 }
 
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+static void cli_top(int argc, char *argv[])
+{
+    TAL_THREAD_PROF_T *prof = NULL;
+    uint32_t num = 0, i = 0;
+    char line[80];
+
+    if (argc > 1 && 0 == strcmp(argv[1], "reset")) {
+        tal_thread_prof_reset();
+        cli_print_string(s_cli_handle, "thread profile reset");
+        return;
+    }
+
+    prof = tal_malloc(TAL_THREAD_PROF_MAX_NUM * sizeof(TAL_THREAD_PROF_T));
+    if (NULL == prof) {
+        cli_print_string(s_cli_handle, "no memory");
+        return;
+    }
+
+    num = tal_thread_get_prof_all(prof, TAL_THREAD_PROF_MAX_NUM);
+    cli_print_string(s_cli_handle, "name              busy  stack  free   wakes  max_block");
+    for (i = 0; i < num; i++) {
+        snprintf(line, sizeof(line), "%-16s  %3u%%  %5u  %5u  %6u  %6ums", prof[i].name, prof[i].busy_pct,
+                 prof[i].stack_size, prof[i].stack_free, prof[i].wake_cnt, prof[i].max_block_ms);
+        cli_print_string(s_cli_handle, line);
+    }
+
+    tal_free(prof);
+}
+#endif
+
+static void cli_perf_top(int argc, char *argv[])
+{
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+    cli_top(argc, argv);
+#else
+    cli_print_string(s_cli_handle, "thread profiler not built, enable ENABLE_THREAD_PROF");
+#endif
+}
+
+#if defined(ENABLE_MEM_TRACK) && (ENABLE_MEM_TRACK == 1)
+// sites printed by "perf heap sites" and "perf heap diff"
+#define CLI_HEAP_SITE_NUM 20
+
+static void cli_heap_site_name(const char *file, uint32_t line, char *name, uint32_t len)
+{
+    const char *base = NULL;
+
+    if (NULL == file) {
+        snprintf(name, len, "0x%08x", line);
+        return;
+    }
+    base = strrchr(file, '/');
+    snprintf(name, len, "%s:%u", base ? base + 1 : file, line);
+}
+
+static void cli_heap_sites(void)
+{
+    TAL_MEM_SITE_T *site = NULL, tmp;
+    uint32_t num = 0, i = 0, j = 0;
+    char name[40];
+    char line[96];
+
+    site = tal_malloc(TAL_MEM_TRACK_SITE_NUM * sizeof(TAL_MEM_SITE_T));
+    if (NULL == site) {
+        cli_print_string(s_cli_handle, "no memory");
+        return;
+    }
+
+    num = tal_mem_track_get(site, TAL_MEM_TRACK_SITE_NUM);
+    snprintf(line, sizeof(line), "tracked %u bytes in %u sites", tal_mem_track_live_bytes(), num);
+    cli_print_string(s_cli_handle, line);
+    cli_print_string(s_cli_handle, "   bytes  blocks     allocs  site");
+    for (i = 0; i < num && i < CLI_HEAP_SITE_NUM; i++) {
+        for (j = i + 1; j < num; j++) {
+            if (site[j].bytes > site[i].bytes) {
+                tmp = site[i];
+                site[i] = site[j];
+                site[j] = tmp;
+            }
+        }
+        cli_heap_site_name(site[i].file, site[i].line, name, sizeof(name));
+        snprintf(line, sizeof(line), "%8u  %6u  %9u  %s", site[i].bytes, site[i].cnt, site[i].alloc_cnt, name);
+        cli_print_string(s_cli_handle, line);
+    }
+
+    tal_free(site);
+}
+
+static void cli_heap_diff(void)
+{
+    TAL_MEM_SITE_DIFF_T *diff = NULL;
+    uint32_t num = 0, i = 0;
+    char name[40];
+    char line[96];
+
+    diff = tal_malloc(CLI_HEAP_SITE_NUM * sizeof(TAL_MEM_SITE_DIFF_T));
+    if (NULL == diff) {
+        cli_print_string(s_cli_handle, "no memory");
+        return;
+    }
+
+    //! this buffer is itself a change, it is freed before it could be listed
+    num = tal_mem_track_diff(diff, CLI_HEAP_SITE_NUM);
+    cli_print_string(s_cli_handle, "   bytes  blocks  site, since the snapshot");
+    for (i = 0; i < num; i++) {
+        cli_heap_site_name(diff[i].file, diff[i].line, name, sizeof(name));
+        snprintf(line, sizeof(line), "%+8d  %+6d  %s", diff[i].bytes, diff[i].cnt, name);
+        cli_print_string(s_cli_handle, line);
+    }
+
+    tal_free(diff);
+}
+#endif
+
+static void cli_perf_heap(int argc, char *argv[])
+{
+    TAL_MEM_HEAP_STAT_T heap;
+    char line[80];
+
+#if defined(ENABLE_MEM_TRACK) && (ENABLE_MEM_TRACK == 1)
+    if (argc > 1 && 0 == strcmp(argv[1], "sites")) {
+        cli_heap_sites();
+        return;
+    } else if (argc > 1 && 0 == strcmp(argv[1], "snap")) {
+        cli_print_string(s_cli_handle, OPRT_OK == tal_mem_track_snapshot() ? "heap snapshot taken" : "no memory");
+        return;
+    } else if (argc > 1 && 0 == strcmp(argv[1], "diff")) {
+        cli_heap_diff();
+        return;
+    }
+#endif
+
+    if (OPRT_OK == tal_mem_get_heap_stat(&heap)) {
+        snprintf(line, sizeof(line), "free heap %u, largest block %u, fragmentation %u%%", heap.free_size,
+                 heap.largest_free, heap.frag_pct);
+    } else {
+        snprintf(line, sizeof(line), "free heap %d", tal_system_get_free_heap_size());
+    }
+    cli_print_string(s_cli_handle, line);
+
+#if defined(ENABLE_MEM_SLAB) && (ENABLE_MEM_SLAB == 1)
+    TAL_MEM_SLAB_STAT_T stat;
+    uint8_t i = 0;
+
+    cli_print_string(s_cli_handle, "slab   size    num   used   peak      allocs   fails");
+    for (i = 0; i < tal_mem_slab_get_class_num(); i++) {
+        if (OPRT_OK != tal_mem_slab_get_stat(i, &stat)) {
+            continue;
+        }
+        snprintf(line, sizeof(line), "%4u  %5u  %5u  %5u  %5u  %10u  %6u%s", i, stat.block_size, stat.block_num,
+                 stat.used, stat.peak, stat.alloc_cnt, stat.fail_cnt, stat.is_psram ? " psram" : "");
+        cli_print_string(s_cli_handle, line);
+    }
+#endif
+}
+
+static void cli_perf_timers(int argc, char *argv[])
+{
+    TAL_SW_TIMER_STAT_T stat;
+    uint32_t next_ms = tal_sw_timer_get_next_ms();
+    char line[80];
+
+    if (OPRT_OK != tal_sw_timer_stat_get(&stat, argc > 1 && 0 == strcmp(argv[1], "reset"))) {
+        cli_print_string(s_cli_handle, "timer not ready");
+        return;
+    }
+
+    if (0xFFFFFFFF == next_ms) {
+        snprintf(line, sizeof(line), "timers %d, none running", tal_sw_timer_get_num());
+    } else {
+        snprintf(line, sizeof(line), "timers %d, next in %ums", tal_sw_timer_get_num(), next_ms);
+    }
+    cli_print_string(s_cli_handle, line);
+    snprintf(line, sizeof(line), "dispatched %u skipped %u overrun %u", stat.dispatched, stat.skipped,
+             stat.overrun_cnt);
+    cli_print_string(s_cli_handle, line);
+    snprintf(line, sizeof(line), "max cb %ums (%p) max late %ums", stat.max_cb_ms, stat.max_cb, stat.max_late_ms);
+    cli_print_string(s_cli_handle, line);
+}
+
+static void cli_perf_wq(int argc, char *argv[])
+{
+    const char *name[] = {"system", "highpri"};
+    WORKQ_SERVICE_E service[] = {WORKQ_SYSTEM, WORKQ_HIGHTPRI};
+    WORKQUEUE_HANDLE handle = NULL;
+    char line[80];
+    int i = 0;
+
+    for (i = 0; i < CNTSOF(service); i++) {
+        handle = tal_workq_get_handle(service[i]);
+        if (NULL == handle) {
+            snprintf(line, sizeof(line), "%-8s not running", name[i]);
+        } else {
+            snprintf(line, sizeof(line), "%-8s %u queued", name[i], tal_workqueue_get_num(handle));
+        }
+        cli_print_string(s_cli_handle, line);
+    }
+}
+
+static OPERATE_RET cli_trace_print(const char *line, void *arg)
+{
+    cli_print_string(s_cli_handle, (char *)line);
+    return OPRT_OK;
+}
+
+static OPERATE_RET cli_trace_send(const char *line, void *arg)
+{
+    int fd = *(int *)arg;
+    uint32_t len = strlen(line);
+
+    if (tal_net_send(fd, line, len) != (int)len || tal_net_send(fd, "\n", 1) != 1) {
+        return OPRT_SEND_ERR;
+    }
+    return OPRT_OK;
+}
+
+static void cli_perf_trace(int argc, char *argv[])
+{
+    char line[80];
+    uint32_t num = 0;
+    int fd = -1;
+
+    if (argc > 1 && 0 == strcmp(argv[1], "start")) {
+        cli_print_string(s_cli_handle, OPRT_OK == tal_trace_start() ? "trace started" : "no memory");
+        return;
+    } else if (argc > 1 && 0 == strcmp(argv[1], "stop")) {
+        tal_trace_stop();
+        cli_print_string(s_cli_handle, "trace stopped");
+        return;
+    } else if (argc > 1 && 0 == strcmp(argv[1], "dump")) {
+        tal_trace_stop();
+        tal_trace_dump(cli_trace_print, NULL);
+        return;
+    } else if (argc < 4 || 0 != strcmp(argv[1], "send")) {
+        cli_print_string(s_cli_handle, "trace <start|stop|dump|send <ip> <port>>");
+        return;
+    }
+
+    // the records go to a tcp listener, e.g. nc -l <port> > trace.txt
+    tal_trace_stop();
+    fd = tal_net_socket_create(PROTOCOL_TCP);
+    if (fd < 0) {
+        cli_print_string(s_cli_handle, "no socket");
+        return;
+    }
+    if (tal_net_connect(fd, tal_net_str2addr(argv[2]), (uint16_t)atoi(argv[3])) < 0) {
+        cli_print_string(s_cli_handle, "connect failed");
+        tal_net_close(fd);
+        return;
+    }
+    num = tal_trace_dump(cli_trace_send, &fd);
+    tal_net_close(fd);
+    snprintf(line, sizeof(line), "%u records sent", num);
+    cli_print_string(s_cli_handle, line);
+}
+
+static void cli_perf_boot(int argc, char *argv[])
+{
+    TAL_BOOT_MARK_T *mark = NULL;
+    uint32_t num = 0, dropped = 0, i = 0;
+    char line[80];
+
+    mark = tal_malloc(TAL_BOOT_MARK_NUM * sizeof(TAL_BOOT_MARK_T));
+    if (NULL == mark) {
+        cli_print_string(s_cli_handle, "no memory");
+        return;
+    }
+
+    num = tal_boot_mark_get(mark, TAL_BOOT_MARK_NUM, &dropped);
+    snprintf(line, sizeof(line), "%u marks, %u dropped", num, dropped);
+    cli_print_string(s_cli_handle, line);
+    cli_print_string(s_cli_handle, "since reset  since prev  mark");
+    for (i = 0; i < num; i++) {
+        snprintf(line, sizeof(line), "%8u ms  %7u ms  %s", mark[i].time_ms,
+                 i ? mark[i].time_ms - mark[i - 1].time_ms : 0, mark[i].name);
+        cli_print_string(s_cli_handle, line);
+    }
+
+    tal_free(mark);
+}
+
+static void cli_perf_mutex(int argc, char *argv[])
+{
+#if defined(ENABLE_MUTEX_PROF) && (ENABLE_MUTEX_PROF == 1)
+    TAL_MUTEX_PROF_T *prof = NULL;
+    uint32_t num = 0, i = 0;
+    char owner[TAL_THREAD_MAX_NAME_LEN];
+    char name[20];
+    char line[112];
+
+    if (argc > 1 && 0 == strcmp(argv[1], "reset")) {
+        tal_mutex_prof_reset();
+        cli_print_string(s_cli_handle, "mutex profile reset");
+        return;
+    }
+
+    prof = tal_malloc(TAL_MUTEX_PROF_MAX_NUM * sizeof(TAL_MUTEX_PROF_T));
+    if (NULL == prof) {
+        cli_print_string(s_cli_handle, "no memory");
+        return;
+    }
+
+    num = tal_mutex_get_prof_all(prof, TAL_MUTEX_PROF_MAX_NUM);
+    cli_print_string(s_cli_handle, "mutex               locks  contend  wait_max  wait_sum  hold_max  long  longest by");
+    for (i = 0; i < num; i++) {
+        //! unnamed locks are only worth a line once they were contended or held long
+        if (NULL == prof[i].name && 0 == prof[i].contend_cnt && 0 == prof[i].long_hold_cnt) {
+            continue;
+        }
+        if (prof[i].name) {
+            snprintf(name, sizeof(name), "%s", prof[i].name);
+        } else {
+            snprintf(name, sizeof(name), "%p", prof[i].handle);
+        }
+        if (NULL == prof[i].hold_max_owner ||
+            OPRT_OK != tal_thread_get_name_by_id(prof[i].hold_max_owner, owner, sizeof(owner))) {
+            snprintf(owner, sizeof(owner), "%p", prof[i].hold_max_owner);
+        }
+        snprintf(line, sizeof(line), "%-18s %6u  %7u  %6ums  %6ums  %6ums  %4u  %s", name, prof[i].lock_cnt,
+                 prof[i].contend_cnt, prof[i].wait_max_ms, prof[i].wait_total_ms, prof[i].hold_max_ms,
+                 prof[i].long_hold_cnt, owner);
+        cli_print_string(s_cli_handle, line);
+    }
+
+    tal_free(prof);
+#else
+    cli_print_string(s_cli_handle, "mutex profiler not built, enable ENABLE_MUTEX_PROF");
+#endif
+}
+
+static cli_cmd_t *cli_perf_find(char *name)
+{
+    int i, j;
+
+    for (i = 0; i < CNTSOF(s_cli_perf_cmd); i++) {
+        if (0 == strcmp(s_cli_perf_cmd[i].name, name)) {
+            return (cli_cmd_t *)&s_cli_perf_cmd[i];
+        }
+    }
+
+    for (i = 0; i < CLI_PERF_EXT_NUM; i++) {
+        for (j = 0; j < s_cli_perf_ext[i].num; j++) {
+            if (0 == strcmp(s_cli_perf_ext[i].cmd[j].name, name)) {
+                return s_cli_perf_ext[i].cmd + j;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static void cli_perf(int argc, char *argv[])
+{
+    cli_cmd_t *cmd = NULL;
+    char line[96];
+    int i, j;
+
+    cmd = (argc > 1) ? cli_perf_find(argv[1]) : NULL;
+    if (cmd) {
+        cmd->func(argc - 1, argv + 1);
+        return;
+    }
+
+    for (i = 0; i < CNTSOF(s_cli_perf_cmd); i++) {
+        snprintf(line, sizeof(line), "%-8s %s", s_cli_perf_cmd[i].name, s_cli_perf_cmd[i].help);
+        cli_print_string(s_cli_handle, line);
+    }
+    for (i = 0; i < CLI_PERF_EXT_NUM; i++) {
+        for (j = 0; j < s_cli_perf_ext[i].num; j++) {
+            snprintf(line, sizeof(line), "%-8s %s", s_cli_perf_ext[i].cmd[j].name, s_cli_perf_ext[i].cmd[j].help);
+            cli_print_string(s_cli_handle, line);
+        }
+    }
+}
+
 static cli_cmd_t *cli_cmd_find_with_name(char *name)
 {
     int i, j;
@@ -743,6 +1196,34 @@ int tal_cli_cmd_register(const cli_cmd_t *cmd, uint8_t num)
     return cli_cmd_register((cli_cmd_t *)cmd, num);
 }
 
+/**
+ * @brief Adds subcommands to the perf command, "perf <name> ..." calls the
+ * func of the named one with the arguments after perf.
+ *
+ * @param cmd Pointer to the subcommands, must stay valid.
+ * @param num Number of subcommands.
+ * @return OPRT_OK on success, OPRT_EXCEED_UPPER_LIMIT when CLI_PERF_EXT_NUM
+ *         tables are registered already.
+ */
+int tal_cli_perf_register(const cli_cmd_t *cmd, uint8_t num)
+{
+    int i = 0;
+
+    if (NULL == cmd || 0 == num) {
+        return OPRT_INVALID_PARM;
+    }
+
+    for (i = 0; i < CLI_PERF_EXT_NUM; i++) {
+        if (NULL == s_cli_perf_ext[i].cmd) {
+            s_cli_perf_ext[i].cmd = (cli_cmd_t *)cmd;
+            s_cli_perf_ext[i].num = num;
+            return OPRT_OK;
+        }
+    }
+
+    return OPRT_EXCEED_UPPER_LIMIT;
+}
+
 /**
  * @brief Initializes the CLI (Command Line Interface) with the specified UART
  * number.
@@ -776,7 +1257,7 @@ int tal_cli_init_with_uart(uint8_t uart_num)
         PR_ERR("uart init failed", result);
         goto __exit;
     }
-    tal_cli_cmd_register((cli_cmd_t *)&s_cli_cmd, 1);
+    tal_cli_cmd_register((cli_cmd_t *)&s_cli_cmd, CNTSOF(s_cli_cmd));
 
     THREAD_CFG_T param;
 
@@ -18,16 +18,64 @@ extern "C" {
 #define O_BLOCK       1
 #define O_ASYNC_WRITE (1 << 1)
 #define O_FLOW_CTRL   (1 << 2)
-#define O_TX_DMA      (1 << 3)
-#define O_RX_DMA      (1 << 4)
+#define O_TX_DMA      (1 << 3) // writes go to the platform in blocks sent by dma
+#define O_RX_DMA      (1 << 4) // receive by dma, blocks end on rx_timeout_ms of idle line
+
+// most bytes a length prefixed frame header may span, see TAL_UART_FRAME_CFG_T
+#ifndef TAL_UART_FRAME_HDR_MAX
+#define TAL_UART_FRAME_HDR_MAX 8
+#endif
+
+typedef enum {
+    TAL_UART_FRAME_NONE = 0, // no frame detection
+    TAL_UART_FRAME_DELIM,    // a frame ends with the delim byte
+    TAL_UART_FRAME_LEN,      // a frame starts with head and carries its length
+} TAL_UART_FRAME_TYPE_E;
+
+typedef enum {
+    TAL_UART_FRAME_OK = 0, // a whole frame is buffered
+    TAL_UART_FRAME_JUNK,   // bytes that are no frame, e.g. before the head or over max_len
+} TAL_UART_FRAME_E;
+
+/**
+ * @brief frame callback, called in the rx irq, consume len bytes for it
+ *
+ * @param[in] port_id: uart port id
+ * @param[in] result: what the len bytes are
+ * @param[in] len: frame length, counted from the oldest unconsumed frame
+ * @param[in] arg: arg of TAL_UART_FRAME_CFG_T
+ *
+ * @return none
+ */
+typedef void (*TAL_UART_FRAME_CB)(TUYA_UART_NUM_E port_id, TAL_UART_FRAME_E result, uint32_t len, void *arg);
+
+/**
+ * @brief frame detection on the rx data, e.g. for the Tuya MCU protocol
+ * (55 AA ver cmd len_hi len_lo data sum): TAL_UART_FRAME_LEN, head {0x55, 0xAA},
+ * len_offset 4, len_size 2, len_big_endian 1, len_adjust 7
+ */
+typedef struct {
+    TAL_UART_FRAME_TYPE_E type;
+    uint8_t delim;                        // TAL_UART_FRAME_DELIM, last byte of a frame
+    uint8_t head[TAL_UART_FRAME_HDR_MAX]; // TAL_UART_FRAME_LEN, first bytes of a frame
+    uint8_t head_len;
+    uint8_t len_offset; // where the length field starts
+    uint8_t len_size;   // 1 to 4 bytes
+    uint8_t len_big_endian;
+    int32_t len_adjust; // frame length is the field plus len_adjust
+    uint32_t max_len;   // longer frames are junk, 0 for the rx buffer size
+    TAL_UART_FRAME_CB cb;
+    void *arg;
+} TAL_UART_FRAME_CFG_T;
 
 typedef struct {
     uint32_t rx_buffer_size;
-#ifdef CONFIG_TX_ASYNC
+#ifdef CONFIG_UART_ASYNC_WRITE
     uint32_t tx_buffer_size;
 #endif
     uint8_t open_mode;
     TUYA_UART_BASE_CFG_T base_cfg;
+    uint16_t rx_timeout_ms; // O_RX_DMA, idle time that ends a block, 0 for one character time
 } TAL_UART_CFG_T;
 
 /**
@@ -124,7 +172,9 @@ typedef void (*TAL_UART_IRQ_CB)(TUYA_UART_NUM_E port_id, void *buff, uint16_t le
  *                                   it's value must be one of the
  * TUYA_UART_TYPE_E type the low 16bit - means uart port id you can input like
  * this TUYA_UART_PORT_ID(TUYA_UART_SYS, 2)
- * @param[in] rx_cb: receive interrupt callback
+ * @param[in] rx_cb: receive interrupt callback, called in the irq with every
+ * block written to the rx buffer, with O_RX_DMA once per dma block or rx
+ * timeout
  *
  * @return none
  */
@@ -144,6 +194,44 @@ void tal_uart_rx_reg_irq_cb(TUYA_UART_NUM_E port_id, TAL_UART_IRQ_CB rx_cb);
  */
 int tal_uart_get_rx_data_size(TUYA_UART_NUM_E port_num);
 
+/**
+ * @brief get the received data in place, without copying it
+ *
+ * @param[in] port_num: uart port num
+ * @param[out] data: the oldest unread byte in the rx buffer
+ *
+ * @note The data stays buffered until tal_uart_consume(). The rx buffer is a
+ * ring, when the result is shorter than tal_uart_get_rx_data_size() the rest
+ * follows once this part is consumed. Only one thread may read a port.
+ *
+ * @return >=0, the length readable at data; < 0, error
+ */
+int tal_uart_peek(TUYA_UART_NUM_E port_num, uint8_t **data);
+
+/**
+ * @brief drop received data, e.g. after tal_uart_peek() or a frame callback
+ *
+ * @param[in] port_num: uart port num
+ * @param[in] len: the length to drop
+ *
+ * @return >=0, the length dropped; < 0, error
+ */
+int tal_uart_consume(TUYA_UART_NUM_E port_num, uint32_t len);
+
+/**
+ * @brief set the frame detection of the rx data, the callback fires once a
+ * whole frame is buffered, so a parser need not look at every byte
+ *
+ * @param[in] port_num: uart port num
+ * @param[in] cfg: frame configure, NULL or TAL_UART_FRAME_NONE to stop
+ *
+ * @note Detection starts at the next received byte, consume the buffered data
+ * first.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+OPERATE_RET tal_uart_frame_cfg_set(TUYA_UART_NUM_E port_num, const TAL_UART_FRAME_CFG_T *cfg);
+
 #ifdef __cplusplus
 }
 #endif
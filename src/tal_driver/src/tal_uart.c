@@ -16,6 +16,18 @@
 #include "tuya_slist.h"
 #include "tuya_ringbuf.h"
 #include "tal_api.h"
+#include "tal_trace.h"
+
+// tkl_uart_read and tkl_uart_write take a uint16_t length
+#define UART_BLOCK_MAX 0xFFFF
+
+#define UART_MIN(x, y) ((x) < (y) ? (x) : (y))
+#define UART_MAX(x, y) ((x) > (y) ? (x) : (y))
+
+// bytes read at a time to empty the hardware buffer while the rx ring is full
+#ifndef UART_RX_DROP_SIZE
+#define UART_RX_DROP_SIZE 16
+#endif
 
 typedef struct uart_dev_node {
     SLIST_HEAD node;
@@ -24,13 +36,20 @@ typedef struct uart_dev_node {
     SEM_HANDLE rx_ring_sem;
     TUYA_RINGBUFF_T rx_ring;
 #ifdef CONFIG_UART_ASYNC_WRITE
-    TKL_SEM_HANDLE tx_ring_sem;
+    SEM_HANDLE tx_ring_sem;
     TUYA_RINGBUFF_T tx_ring;
 #endif
     uint16_t wait_rx_flag;
     uint16_t wait_tx_flag;
     SEM_HANDLE rx_block_sem;
     SEM_HANDLE tx_block_sem;
+    TAL_UART_IRQ_CB rx_cb; // called in the rx irq with every block written to rx_ring
+    uint32_t rx_drop;      // bytes lost because rx_ring was full
+    TAL_UART_FRAME_CFG_T frame;
+    uint32_t frame_pos;   // bytes of the current frame received
+    uint32_t frame_total; // its length once the header is in, 0 before
+    uint32_t frame_junk;  // junk bytes before the current frame, not reported yet
+    uint8_t frame_hdr[TAL_UART_FRAME_HDR_MAX];
 } TAL_UART_DEV;
 
 struct single_mutext_list {
@@ -84,40 +103,163 @@ OPERATE_RET uart_list_delete_one_node(TAL_UART_DEV *uart_info)
 }
 
 #ifdef CONFIG_UART_ASYNC_WRITE
-void uart_tx_chars_in_isr(uint32_t port_num)
+void uart_tx_chars_in_isr(TUYA_UART_NUM_E port_num)
 {
     TAL_UART_DEV *uart_info = uart_list_get_one_node(port_num);
     if (uart_info == NULL) {
         return;
     }
 
-    ring_buffer_s *tx_ring = uart_info->tx_ring;
-    uint8_t tx_byte;
-    uint8_t tx_count = 0;
+    uint8_t *span = NULL;
+    uint32_t span_len = 0;
+    uint32_t tx_bytes = 0;
+    int ret = 0;
 
+    /*
+     * Every contiguous area of the tx ring is handed to the driver as one
+     * block, with O_TX_DMA the platform sends it by dma.
+     */
     while (1) {
-        ret = tuya_ring_buff_read(tx_ring, &tx_byte, 1);
-        if (ret != 1) {
+        span_len = tuya_ring_buff_read_span(uart_info->tx_ring, &span);
+        if (span_len == 0) {
+            tkl_uart_set_tx_int(port_num, FALSE);
+            //! a write may have filled the ring after it was found empty
+            if (tuya_ring_buff_used_size_get(uart_info->tx_ring)) {
+                tkl_uart_set_tx_int(port_num, TRUE);
+            }
             break;
         }
 
-        ret = tkl_uart_write(port_num, &tx_byte, 1);
-        if (ret != 1) {
+        ret = tkl_uart_write(port_num, span, UART_MIN(span_len, UART_BLOCK_MAX));
+        if (ret <= 0) {
             break;
         }
 
-        tx_count++;
+        tuya_ring_buff_discard(uart_info->tx_ring, ret);
+        tx_bytes += ret;
     }
 
-    if ((uart_info->open_mode & O_BLOCK) && (tx_count > 0)) {
-        if (uart_info->wait_rx_flag == TRUE) {
-            uart_info->wait_rx_flag = FALSE;
+    if ((uart_info->open_mode & O_BLOCK) && (tx_bytes > 0)) {
+        if (uart_info->wait_tx_flag == TRUE) {
+            uart_info->wait_tx_flag = FALSE;
             tal_semaphore_post(uart_info->tx_block_sem);
         }
     }
 }
 #endif
 
+TUYA_HOT_UART
+static void uart_frame_report(TAL_UART_DEV *uart_info, TAL_UART_FRAME_E result, uint32_t len)
+{
+    if (len) {
+        uart_info->frame.cb(uart_info->port_num, result, len, uart_info->frame.arg);
+    }
+}
+
+TUYA_HOT_UART
+static void uart_frame_junk_flush(TAL_UART_DEV *uart_info)
+{
+    uart_frame_report(uart_info, TAL_UART_FRAME_JUNK, uart_info->frame_junk);
+    uart_info->frame_junk = 0;
+}
+
+// frame_total is set while the rest of a line over max_len is skipped
+TUYA_HOT_UART
+static void uart_frame_delim_scan(TAL_UART_DEV *uart_info, const uint8_t *data, uint32_t len)
+{
+    const uint8_t *end = data + len;
+    const uint8_t *hit = NULL;
+
+    while (data < end) {
+        hit = memchr(data, uart_info->frame.delim, end - data);
+        if (hit == NULL) {
+            uart_info->frame_pos += end - data;
+            break;
+        }
+
+        uart_info->frame_pos += hit + 1 - data;
+        data = hit + 1;
+        if (uart_info->frame_total || uart_info->frame_pos > uart_info->frame.max_len) {
+            uart_frame_report(uart_info, TAL_UART_FRAME_JUNK, uart_info->frame_pos);
+        } else {
+            uart_frame_report(uart_info, TAL_UART_FRAME_OK, uart_info->frame_pos);
+        }
+        uart_info->frame_pos = 0;
+        uart_info->frame_total = 0;
+    }
+
+    if (uart_info->frame_pos > uart_info->frame.max_len) {
+        uart_frame_report(uart_info, TAL_UART_FRAME_JUNK, uart_info->frame_pos);
+        uart_info->frame_pos = 0;
+        uart_info->frame_total = 1;
+    }
+}
+
+TUYA_HOT_UART
+static void uart_frame_len_scan(TAL_UART_DEV *uart_info, const uint8_t *data, uint32_t len)
+{
+    TAL_UART_FRAME_CFG_T *cfg = &uart_info->frame;
+    uint32_t hdr_size = UART_MAX(cfg->head_len, cfg->len_offset + cfg->len_size);
+    uint32_t field = 0, n = 0, i = 0;
+    int64_t total = 0;
+
+    while (len) {
+        //! the body is skipped in one step, only header bytes are looked at
+        if (uart_info->frame_total) {
+            n = UART_MIN(len, uart_info->frame_total - uart_info->frame_pos);
+            uart_info->frame_pos += n;
+            data += n;
+            len -= n;
+            if (uart_info->frame_pos == uart_info->frame_total) {
+                uart_frame_junk_flush(uart_info);
+                uart_frame_report(uart_info, TAL_UART_FRAME_OK, uart_info->frame_total);
+                uart_info->frame_pos = 0;
+                uart_info->frame_total = 0;
+            }
+            continue;
+        }
+
+        if (uart_info->frame_pos < cfg->head_len && *data != cfg->head[uart_info->frame_pos]) {
+            if (uart_info->frame_pos == 0) {
+                uart_info->frame_junk++;
+                data++;
+                len--;
+            } else {
+                //! the byte is checked again as the start of a head
+                uart_info->frame_junk += uart_info->frame_pos;
+                uart_info->frame_pos = 0;
+            }
+            continue;
+        }
+
+        uart_info->frame_hdr[uart_info->frame_pos++] = *data++;
+        len--;
+        if (uart_info->frame_pos < hdr_size) {
+            continue;
+        }
+
+        field = 0;
+        for (i = 0; i < cfg->len_size; i++) {
+            n = cfg->len_big_endian ? (cfg->len_offset + i) : (cfg->len_offset + cfg->len_size - 1 - i);
+            field = (field << 8) | uart_info->frame_hdr[n];
+        }
+        total = (int64_t)field + cfg->len_adjust;
+        if (total < hdr_size || total > cfg->max_len) {
+            uart_info->frame_junk += uart_info->frame_pos;
+            uart_info->frame_pos = 0;
+        } else if (total == hdr_size) {
+            uart_frame_junk_flush(uart_info);
+            uart_frame_report(uart_info, TAL_UART_FRAME_OK, hdr_size);
+            uart_info->frame_pos = 0;
+        } else {
+            uart_info->frame_total = (uint32_t)total;
+        }
+    }
+
+    uart_frame_junk_flush(uart_info);
+}
+
+TUYA_HOT_UART
 void uart_rx_chars_in_isr(TUYA_UART_NUM_E port_num)
 {
     TAL_UART_DEV *uart_info = uart_list_get_one_node(port_num);
@@ -125,27 +267,46 @@ void uart_rx_chars_in_isr(TUYA_UART_NUM_E port_num)
         return;
     }
 
-    uint8_t rx_char;
+    uint8_t drop[UART_RX_DROP_SIZE];
+    uint8_t *span = NULL;
+    uint32_t span_len = 0;
     int ret = 0;
     uint32_t rx_bytes = 0;
+    uint32_t trace_us = tal_trace_now();
 
     /*
+     * The hardware buffer, or the dma block with O_RX_DMA, is read straight
+     * into the free area of the ring buffer, one call per contiguous area.
      * When the software buffer is full, the data read will not be written into
      * the software buffer. However, it will continue to read the content of the
      * hardware buffer until it is empty.
      */
     while (1) {
-        ret = tkl_uart_read(port_num, &rx_char, 1);
-        if (ret != 1) {
-            break;
-        }
+        span_len = tuya_ring_buff_write_span(uart_info->rx_ring, &span);
+        if (span_len == 0) {
+            ret = tkl_uart_read(port_num, drop, sizeof(drop));
+            if (ret <= 0) {
+                break;
+            }
+            uart_info->rx_drop += ret;
+        } else {
+            ret = tkl_uart_read(port_num, span, UART_MIN(span_len, UART_BLOCK_MAX));
+            if (ret <= 0) {
+                break;
+            }
+            tuya_ring_buff_write_commit(uart_info->rx_ring, ret);
+            rx_bytes += ret;
 
-        ret = tuya_ring_buff_write(uart_info->rx_ring, &rx_char, 1);
-        if (ret != 1) {
-            break;
-        }
+            if (uart_info->frame.type == TAL_UART_FRAME_DELIM) {
+                uart_frame_delim_scan(uart_info, span, ret);
+            } else if (uart_info->frame.type == TAL_UART_FRAME_LEN) {
+                uart_frame_len_scan(uart_info, span, ret);
+            }
 
-        rx_bytes++;
+            if (uart_info->rx_cb) {
+                uart_info->rx_cb(port_num, span, ret);
+            }
+        }
 
 #if OPERATING_SYSTEM == SYSTEM_LINUX
         break;
@@ -161,6 +322,7 @@ void uart_rx_chars_in_isr(TUYA_UART_NUM_E port_num)
         tal_semaphore_post(uart_info->rx_block_sem);
     }
 
+    tal_trace_span_end(TAL_TRACE_ISR, "uart rx", trace_us);
     return;
 }
 
@@ -250,6 +412,24 @@ OPERATE_RET tal_uart_init(TUYA_UART_NUM_E port_num, TAL_UART_CFG_T *cfg)
         goto ERR_EXIT;
     }
 
+    if (uart_info->open_mode & O_RX_DMA) {
+        TUYA_UART_DMA_CFG_T dma_cfg = {0};
+        dma_cfg.rx_timeout_ms = cfg->rx_timeout_ms;
+        //! a block irq comes before the ring can fill up
+        dma_cfg.block_size = UART_MIN(cfg->rx_buffer_size / 2, UART_BLOCK_MAX);
+        if (OPRT_OK != tkl_uart_ioctl(port_num, TUYA_UART_RX_DMA_CMD, &dma_cfg)) {
+            PR_DEBUG("uart %d rx dma not supported, use rx irq", port_num);
+            uart_info->open_mode &= ~O_RX_DMA;
+        }
+    }
+
+    if (uart_info->open_mode & O_TX_DMA) {
+        if (OPRT_OK != tkl_uart_ioctl(port_num, TUYA_UART_TX_DMA_CMD, NULL)) {
+            PR_DEBUG("uart %d tx dma not supported", port_num);
+            uart_info->open_mode &= ~O_TX_DMA;
+        }
+    }
+
     ret = tuya_ring_buff_create(cfg->rx_buffer_size, OVERFLOW_STOP_TYPE, &uart_info->rx_ring);
     if (ret != OPRT_OK) {
         goto ERR_EXIT;
@@ -261,16 +441,18 @@ OPERATE_RET tal_uart_init(TUYA_UART_NUM_E port_num, TAL_UART_CFG_T *cfg)
     }
 
 #ifdef CONFIG_UART_ASYNC_WRITE
-    tkl_uart_tx_irq_cb_reg(port_num, uart_tx_chars_in_isr);
+    if (uart_info->open_mode & O_ASYNC_WRITE) {
+        ret = tuya_ring_buff_create(cfg->tx_buffer_size, OVERFLOW_STOP_TYPE, &uart_info->tx_ring);
+        if (ret != OPRT_OK) {
+            goto ERR_EXIT;
+        }
 
-    ret = tuya_ring_buff_create(cfg->tx_buffer_size, OVERFLOW_STOP_TYPE, &uart_info->tx_ring);
-    if (ret != OPRT_OK) {
-        goto ERR_EXIT;
-    }
+        ret = tal_semaphore_create_init(&uart_info->tx_ring_sem, 1, 1);
+        if (ret != OPRT_OK) {
+            goto ERR_EXIT;
+        }
 
-    ret = tal_semaphore_create_init(&uart_info->tx_ring_sem, 1, 1);
-    if (ret != OPRT_OK) {
-        goto ERR_EXIT;
+        tkl_uart_tx_irq_cb_reg(port_num, uart_tx_chars_in_isr);
     }
 #endif
 
@@ -347,38 +529,38 @@ int tal_uart_read(TUYA_UART_NUM_E port_num, uint8_t *data, uint32_t len)
     return read_count;
 }
 
-#ifdef CONFIG_UART_WRITE_ASYNC
-OPERATE_RET uart_async_write(TAL_UART_DEV *uart_info, uint8_t *data, uint32_t len)
+#ifdef CONFIG_UART_ASYNC_WRITE
+static int uart_async_write(TAL_UART_DEV *uart_info, const uint8_t *data, uint32_t len)
 {
+    uint32_t tx_bytes = 0;
+
     OPERATE_RET ret = tal_semaphore_wait(uart_info->tx_ring_sem, SEM_WAIT_FOREVER);
-    if (uart_info == NULL) {
+    if (ret != OPRT_OK) {
         return ret;
     }
 
-    uint16_t tx_bytes = tuya_ring_buff_write(uart_info->tx_ring, data, len);
-
-#ifdef CONFIG_UART_BLOCK
-    if (uart_info->open_mode & O_BLOCK) {
-        while (ret == OPRT_OK) {
-            tx_bytes = tuya_ring_buff_write(uart_info->tx_ring, data, len);
-        }
+    while (1) {
+        //! set before the ring is checked, so a drain after the check posts the semaphore
+        uart_info->wait_tx_flag = TRUE;
+        tx_bytes += tuya_ring_buff_write(uart_info->tx_ring, &data[tx_bytes], len - tx_bytes);
         if (tx_bytes != 0) {
+            tkl_uart_set_tx_int(uart_info->port_num, TRUE);
+        }
+
+        if ((tx_bytes == len) || ((uart_info->open_mode & O_BLOCK) == 0)) {
             break;
         }
 
-        uart_info->wait_tx_flag = TRUE;
         ret = tal_semaphore_wait(uart_info->tx_block_sem, SEM_WAIT_FOREVER);
+        if (ret != OPRT_OK) {
+            break;
+        }
     }
-}
-#endif
+    uart_info->wait_tx_flag = FALSE;
 
-if (tx_bytes != 0) {
-    set_tx_int(uart_info->port_num, true);
-}
-
-tal_semaphore_post(uart_info->tx_ring_sem);
+    tal_semaphore_post(uart_info->tx_ring_sem);
 
-return tx_bytes;
+    return tx_bytes;
 }
 #endif
 
@@ -404,18 +586,18 @@ int tal_uart_write(TUYA_UART_NUM_E port_num, const uint8_t *data, uint32_t len)
         return OPRT_INVALID_PARM;
     }
 
-    int tx_bytes = 0;
+    uint32_t tx_bytes = 0;
     int ret;
     if ((uart_info->open_mode & O_ASYNC_WRITE) == 0) {
-        while (tx_bytes != len) {
-            ret = tkl_uart_write(port_num, (void *)&data[tx_bytes], 1);
-            if (ret != 1) {
+        while (tx_bytes < len) {
+            ret = tkl_uart_write(port_num, (void *)&data[tx_bytes], UART_MIN(len - tx_bytes, UART_BLOCK_MAX));
+            if (ret <= 0) {
                 break;
             }
-            tx_bytes++;
+            tx_bytes += ret;
         }
     }
-#ifdef CONFIG_UART_WRITE_ASYNC
+#ifdef CONFIG_UART_ASYNC_WRITE
     else {
         tx_bytes = uart_async_write(uart_info, data, len);
     }
@@ -451,22 +633,28 @@ OPERATE_RET tal_uart_deinit(TUYA_UART_NUM_E port_num)
         return ret;
     }
 
-    tuya_ring_buff_free(uart_info->rx_ring);
-    tal_semaphore_release(uart_info->rx_ring_sem);
+    uart_free_source(uart_info);
 
-#ifdef CONFIG_UART_ASYNC_WRITE
-    tuya_ring_buff_free(uart_info->tx_ring);
-    tal_semaphore_release(uart_info->tx_ring_sem);
-#endif
+    return ret;
+}
 
-    if (uart_info->open_mode & O_BLOCK) {
-        tal_semaphore_release(uart_info->rx_block_sem);
-        tal_semaphore_release(uart_info->tx_block_sem);
+/**
+ * @brief register the callback of received blocks
+ *
+ * @param[in] port_id: uart port number
+ * @param[in] rx_cb: called in the rx irq with every block written to the rx
+ * buffer, with O_RX_DMA once per dma block or rx timeout, NULL to remove
+ *
+ * @return none
+ */
+void tal_uart_rx_reg_irq_cb(TUYA_UART_NUM_E port_id, TAL_UART_IRQ_CB rx_cb)
+{
+    TAL_UART_DEV *uart_info = uart_list_get_one_node(port_id);
+    if (uart_info == NULL) {
+        return;
     }
 
-    tal_free(uart_info);
-
-    return ret;
+    uart_info->rx_cb = rx_cb;
 }
 
 int tal_uart_get_rx_data_size(TUYA_UART_NUM_E port_num)
@@ -481,3 +669,91 @@ int tal_uart_get_rx_data_size(TUYA_UART_NUM_E port_num)
 
     return buffer_size;
 }
+
+/**
+ * @brief get the received data in place, without copying it
+ *
+ * @param[in] port_num: uart port number
+ * @param[out] data: the oldest unread byte in the rx buffer
+ *
+ * @note The data stays buffered until tal_uart_consume(), the rest of a
+ * wrapped buffer follows once this part is consumed.
+ *
+ * @return >=0, the length readable at data; < 0, error
+ */
+int tal_uart_peek(TUYA_UART_NUM_E port_num, uint8_t **data)
+{
+    if (data == NULL) {
+        return OPRT_INVALID_PARM;
+    }
+
+    TAL_UART_DEV *uart_info = uart_list_get_one_node(port_num);
+    if (uart_info == NULL) {
+        return OPRT_INVALID_PARM;
+    }
+
+    return tuya_ring_buff_read_span(uart_info->rx_ring, data);
+}
+
+/**
+ * @brief drop received data, e.g. after tal_uart_peek() or a frame callback
+ *
+ * @param[in] port_num: uart port number
+ * @param[in] len: the length to drop
+ *
+ * @return >=0, the length dropped; < 0, error
+ */
+int tal_uart_consume(TUYA_UART_NUM_E port_num, uint32_t len)
+{
+    TAL_UART_DEV *uart_info = uart_list_get_one_node(port_num);
+    if (uart_info == NULL) {
+        return OPRT_INVALID_PARM;
+    }
+
+    return tuya_ring_buff_discard(uart_info->rx_ring, len);
+}
+
+/**
+ * @brief set the frame detection of the rx data
+ *
+ * @param[in] port_num: uart port number
+ * @param[in] cfg: frame configure, NULL or TAL_UART_FRAME_NONE to stop
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+OPERATE_RET tal_uart_frame_cfg_set(TUYA_UART_NUM_E port_num, const TAL_UART_FRAME_CFG_T *cfg)
+{
+    TAL_UART_FRAME_CFG_T frame = {0};
+
+    TAL_UART_DEV *uart_info = uart_list_get_one_node(port_num);
+    if (uart_info == NULL) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (cfg != NULL && cfg->type != TAL_UART_FRAME_NONE) {
+        if (cfg->cb == NULL) {
+            return OPRT_INVALID_PARM;
+        }
+        if (cfg->type == TAL_UART_FRAME_LEN &&
+            (cfg->len_size == 0 || cfg->len_size > 4 || cfg->head_len > TAL_UART_FRAME_HDR_MAX ||
+             cfg->len_offset + cfg->len_size > TAL_UART_FRAME_HDR_MAX)) {
+            return OPRT_INVALID_PARM;
+        }
+
+        frame = *cfg;
+        if (frame.max_len == 0) {
+            //! a longer frame could never be buffered whole
+            frame.max_len = tuya_ring_buff_free_size_get(uart_info->rx_ring) +
+                            tuya_ring_buff_used_size_get(uart_info->rx_ring);
+        }
+    }
+
+    TAL_ENTER_CRITICAL();
+    uart_info->frame = frame;
+    uart_info->frame_pos = 0;
+    uart_info->frame_total = 0;
+    uart_info->frame_junk = 0;
+    TAL_EXIT_CRITICAL();
+
+    return OPRT_OK;
+}
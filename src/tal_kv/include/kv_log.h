@@ -0,0 +1,182 @@
+/**
+ * @file kv_log.h
+ * @brief Log-structured key-value engine used as a tal_kv backend.
+ *
+ * Records are appended one after another to the sectors of a flash
+ * partition, a new value of a key is a new record and a delete is a
+ * tombstone record, so a write programs flash once and never rewrites
+ * metadata. On init the sectors are scanned in the order they were filled
+ * and a RAM hash index of the latest record of every key is rebuilt, a
+ * record cut by a power loss fails its CRC and ends the scan of its sector.
+ *
+ * Sectors holding replaced records are compacted in the background on the
+ * low priority lane of WORKQ_SYSTEM: live records are copied to the head of
+ * the log and the sector is erased. One sector is always kept free so that
+ * compaction can run even when the log is full.
+ *
+ * Values are stored as given, tal_kv encrypts them before they get here.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#ifndef __KV_LOG_H__
+#define __KV_LOG_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "tuya_cloud_types.h"
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#ifndef TAL_KV_LOG_FLASH_TYPE
+#define TAL_KV_LOG_FLASH_TYPE TUYA_FLASH_TYPE_KV_DATA
+#endif
+
+// keys in the index, tombstones count until they are compacted away
+#ifndef TAL_KV_LOG_KEY_MAX
+#define TAL_KV_LOG_KEY_MAX 128
+#endif
+
+#ifndef TAL_KV_LOG_BUCKET_NUM
+#define TAL_KV_LOG_BUCKET_NUM 32
+#endif
+
+// larger values are refused with OPRT_NOT_SUPPORTED
+#ifndef TAL_KV_LOG_VALUE_MAX
+#define TAL_KV_LOG_VALUE_MAX 1024
+#endif
+
+// background compaction starts when no more sectors than this are free
+#ifndef TAL_KV_LOG_GC_FREE_MIN
+#define TAL_KV_LOG_GC_FREE_MIN 2
+#endif
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef enum {
+    KV_LOG_KEY_UNKNOWN = 0, // never written to the log
+    KV_LOG_KEY_LIVE,
+    KV_LOG_KEY_DELETED, // latest record is a tombstone
+} KV_LOG_KEY_STATE_E;
+
+typedef struct {
+    uint16_t sector_num;
+    uint16_t free_num;
+    uint16_t key_num; // live keys and tombstones
+    uint32_t garbage; // bytes of replaced records
+    uint32_t gc_cnt;  // sectors compacted
+    uint32_t read_cnt;
+    uint32_t read_bytes;
+    uint32_t prog_cnt;
+    uint32_t prog_bytes;
+    uint32_t erase_cnt;
+} KV_LOG_STAT_T;
+
+/**
+ * @brief Writes a value into its record, called with the log locked.
+ *
+ * @param value The value area of the record.
+ * @param length The length passed to kv_log_set_fill().
+ * @param arg The argument passed to kv_log_set_fill().
+ *
+ * @return OPRT_OK to append the record, an error code to drop it.
+ */
+typedef OPERATE_RET (*KV_LOG_FILL_CB)(uint8_t *value, size_t length, void *arg);
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+
+/**
+ * @brief Mounts the log on the TAL_KV_LOG_FLASH_TYPE partition and rebuilds
+ * the index.
+ *
+ * @return OPRT_OK on success, OPRT_NOT_SUPPORTED when the partition is missing
+ * or has less than two sectors, or another error code on failure.
+ */
+OPERATE_RET kv_log_init(void);
+
+/**
+ * @brief Appends a value of a key.
+ *
+ * @param key The key, 1 to 255 characters.
+ * @param value The value.
+ * @param length The length of the value.
+ *
+ * @return OPRT_OK on success, OPRT_NOT_SUPPORTED when the value or the key
+ * does not fit into the log, or another error code on failure.
+ */
+OPERATE_RET kv_log_set(const char *key, const uint8_t *value, size_t length);
+
+/**
+ * @brief Appends a value of a key that is written straight into the record
+ * buffer by a callback, so the caller needs no buffer of its own.
+ *
+ * @param key The key, 1 to 255 characters.
+ * @param length The length of the value.
+ * @param fill Writes the value.
+ * @param arg Passed to fill.
+ *
+ * @return OPRT_OK on success, OPRT_NOT_SUPPORTED when the value or the key
+ * does not fit into the log, the error of fill, or another error code on
+ * failure.
+ */
+OPERATE_RET kv_log_set_fill(const char *key, size_t length, KV_LOG_FILL_CB fill, void *arg);
+
+/**
+ * @brief Reads the latest value of a key.
+ *
+ * @param key The key.
+ * @param value Set to the value, released with tal_free().
+ * @param length Set to the length of the value.
+ *
+ * @return OPRT_OK on success, OPRT_NOT_FOUND when the key is not live in the
+ * log, or another error code on failure.
+ */
+OPERATE_RET kv_log_get(const char *key, uint8_t **value, size_t *length);
+
+/**
+ * @brief Appends a tombstone for a key.
+ *
+ * @param key The key.
+ *
+ * @return OPRT_OK on success, OPRT_NOT_FOUND when the key is not live in the
+ * log, or another error code on failure.
+ */
+OPERATE_RET kv_log_del(const char *key);
+
+/**
+ * @brief Tells whether the log holds a key.
+ *
+ * @param key The key.
+ *
+ * @return KV_LOG_KEY_STATE_E
+ */
+KV_LOG_KEY_STATE_E kv_log_state(const char *key);
+
+/**
+ * @brief Compacts sectors until more than TAL_KV_LOG_GC_FREE_MIN are free or
+ * nothing is left to reclaim.
+ *
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET kv_log_compact(void);
+
+/**
+ * @brief Reads the log counters.
+ *
+ * @param stat Filled with the counters.
+ *
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET kv_log_get_stat(KV_LOG_STAT_T *stat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __KV_LOG_H__ */
@@ -55,11 +55,103 @@ typedef struct {
 
 #define TAL_LV_KEY_LEN 16
 
+/**
+ * @brief RAM cache of decrypted values, enabled by ENABLE_KV_CACHE
+ *
+ * Values read or written are kept until the least recently used ones make
+ * room for others, a cached tal_kv_get() does not touch flash.
+ *
+ * In write-back mode tal_kv_set() and tal_kv_del() only update the cache, the
+ * dirty keys are written to flash together by tal_kv_flush(), which runs when
+ * the dirty data reaches TAL_KV_CACHE_DIRTY_MAX, TAL_KV_CACHE_FLUSH_MS after
+ * the first change, or when the last transaction ends. Repeated writes of one
+ * key are written once. Changes not flushed yet are lost on power failure.
+ * With TAL_KV_CACHE_WRITE_BACK set to 0 every change is written at once.
+ */
+#ifndef TAL_KV_CACHE_WRITE_BACK
+#define TAL_KV_CACHE_WRITE_BACK 1
+#endif
+
+#ifndef TAL_KV_CACHE_ITEM_NUM
+#define TAL_KV_CACHE_ITEM_NUM 16
+#endif
+
+// value bytes of all cached keys
+#ifndef TAL_KV_CACHE_SIZE_MAX
+#define TAL_KV_CACHE_SIZE_MAX 4096
+#endif
+
+// larger values are written to flash at once
+#ifndef TAL_KV_CACHE_VALUE_MAX
+#define TAL_KV_CACHE_VALUE_MAX 512
+#endif
+
+#ifndef TAL_KV_CACHE_DIRTY_MAX
+#define TAL_KV_CACHE_DIRTY_MAX 2048
+#endif
+
+#ifndef TAL_KV_CACHE_FLUSH_MS
+#define TAL_KV_CACHE_FLUSH_MS 2000
+#endif
+
+/**
+ * @brief RAM cache of littlefs blocks between littlefs and tkl_flash, 0
+ * disables it. A block read that continues the previous miss fetches
+ * TAL_LFS_READ_AHEAD_NUM blocks with one flash read, so sequential file reads
+ * run at flash bandwidth. Costs TAL_LFS_BLOCK_CACHE_NUM blocks of heap.
+ */
+#ifndef TAL_LFS_BLOCK_CACHE_NUM
+#define TAL_LFS_BLOCK_CACHE_NUM 0
+#endif
+
+#ifndef TAL_LFS_READ_AHEAD_NUM
+#define TAL_LFS_READ_AHEAD_NUM 2
+#endif
+
+// littlefs lookahead buffer in bytes, multiple of 8, 0 keeps the default
+#ifndef TAL_LFS_LOOKAHEAD_SIZE
+#define TAL_LFS_LOOKAHEAD_SIZE 0
+#endif
+
+// values are encrypted to and from files through a stack buffer of this size
+#ifndef TAL_KV_CRYPT_CHUNK
+#define TAL_KV_CRYPT_CHUNK 128
+#endif
+
+/**
+ * @brief tal_kv_serialize_set() writes the compact binary format when set to
+ * 1 and JSON when set to 0, for example while older firmware may still be
+ * rolled back to. tal_kv_serialize_get() reads both.
+ */
+#ifndef TAL_KV_SERIALIZE_BIN
+#define TAL_KV_SERIALIZE_BIN 1
+#endif
+
+// binary values up to this size are serialized and read on the stack
+#ifndef TAL_KV_SERIALIZE_BUF_LEN
+#define TAL_KV_SERIALIZE_BUF_LEN 256
+#endif
+
 typedef struct {
     char seed[TAL_LV_KEY_LEN + 1];
     char key[TAL_LV_KEY_LEN + 1];
 } tal_kv_cfg_t;
 
+/**
+ * @brief flash accesses of the littlefs partition, and of the log partition
+ * with ENABLE_KV_LOG, since boot. Counters wrap, take differences.
+ */
+typedef struct {
+    uint32_t read_cnt;
+    uint32_t read_bytes;
+    uint32_t prog_cnt;
+    uint32_t prog_bytes;
+    uint32_t erase_cnt;
+    uint32_t cache_hit;  // block reads served by the block cache
+    uint32_t cache_miss;
+    uint32_t read_ahead; // blocks fetched ahead of a sequential read
+} tal_kv_flash_stat_t;
+
 /**
  * @brief Initializes the TAL Key-Value (KV) module.
  *
@@ -102,6 +194,22 @@ int tal_kv_set(const char *key, const uint8_t *value, size_t length);
  */
 int tal_kv_get(const char *key, uint8_t **value, size_t *length);
 
+/**
+ * @brief Reads the value of a key into a buffer of the caller.
+ *
+ * Nothing is allocated when the value is cached, see ENABLE_KV_CACHE. The
+ * value is NUL terminated when the buffer has room for it.
+ *
+ * @param key The key to retrieve the value for.
+ * @param buf The buffer the value is copied to.
+ * @param length In: size of buf. Out: length of the value, also when buf is
+ * too small.
+ *
+ * @return 0 on success, OPRT_BUFFER_NOT_ENOUGH if buf is too small, or a
+ * negative error code if an error occurred.
+ */
+int tal_kv_get_into(const char *key, uint8_t *buf, size_t *length);
+
 /**
  * @brief Frees the memory allocated for a value in the TAL Key-Value store.
  *
@@ -125,11 +233,41 @@ int tal_kv_free(uint8_t *value);
  */
 int tal_kv_del(const char *key);
 
+/**
+ * @brief Writes the keys changed in the write-back cache to flash.
+ *
+ * Does nothing when ENABLE_KV_CACHE is off. Call it before a reset so that
+ * recent changes are kept.
+ *
+ * @return OPRT_OK on success, or the error of the first key that failed, the
+ * failed keys stay dirty.
+ */
+int tal_kv_flush(void);
+
+/**
+ * @brief Starts a transaction, the cache is not flushed by size or time until
+ * the matching tal_kv_txn_end().
+ *
+ * Transactions nest. Does nothing when ENABLE_KV_CACHE is off or the cache
+ * writes through.
+ *
+ * @return OPRT_OK on success.
+ */
+int tal_kv_txn_begin(void);
+
+/**
+ * @brief Ends a transaction, the last one to end flushes the cache.
+ *
+ * @return OPRT_OK on success, or the error returned by tal_kv_flush().
+ */
+int tal_kv_txn_end(void);
+
 /**
  * @brief Serializes and sets the value of a key in the key-value database.
  *
  * This function serializes the provided key-value pair and sets it in the
- * specified key-value database.
+ * specified key-value database, in the binary format unless
+ * TAL_KV_SERIALIZE_BIN is 0.
  *
  * @param key The key to set in the database.
  * @param db A pointer to the key-value database.
@@ -143,7 +281,8 @@ int tal_kv_serialize_set(const char *key, kv_db_t *db, size_t dbcnt);
  *
  * This function serializes a key-value pair retrieval operation by taking the
  * specified key and database, and returns the number of key-value pairs found
- * in the database.
+ * in the database. A value still stored as JSON is parsed and written back in
+ * the binary format.
  *
  * @param key The key to retrieve.
  * @param db The database to search for the key.
@@ -171,6 +310,24 @@ void tal_kv_cmd(int argc, char *argv[]);
  */
 lfs_t *tal_lfs_get();
 
+/**
+ * @brief Gets the flash address of a littlefs block, valid after tal_kv_init()
+ *
+ * @param block The block.
+ *
+ * @return the flash address, as used by tkl_flash_read()
+ */
+uint32_t tal_lfs_block_addr(lfs_block_t block);
+
+/**
+ * @brief Reads the flash access counters.
+ *
+ * @param stat Filled with the counters.
+ *
+ * @return OPRT_OK on success, or OPRT_INVALID_PARM.
+ */
+int tal_kv_flash_stat_get(tal_kv_flash_stat_t *stat);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,881 @@
+/**
+ * @file kv_log.c
+ * @brief Log-structured key-value engine on a raw flash partition.
+ *
+ * Every sector starts with a header carrying a sequence number, sectors are
+ * filled one at a time and the sequence number orders them on mount. A
+ * record is a header, the key and the value, padded to 4 bytes and written
+ * with one flash program. The index keeps the key hash and the location of
+ * the latest record of each key, keys are compared by reading them back
+ * from flash.
+ *
+ * A tombstone is copied like a live record during compaction while an
+ * older sector may still hold a value of its key, it is dropped when its
+ * own sector is the oldest one.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include <string.h>
+
+#include "tal_api.h"
+#include "tkl_flash.h"
+#include "crc32i.h"
+
+#include "kv_log.h"
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define KV_LOG_SECTOR_MAGIC 0x474C564B // "KVLG"
+#define KV_LOG_REC_MAGIC    0x5652
+#define KV_LOG_REC_ERASED   0xFFFF
+#define KV_LOG_REC_F_DEL    0x01
+
+#define KV_LOG_KEY_LEN_MAX 255
+#define KV_LOG_NONE        0xFFFF
+
+#define KV_LOG_ALIGN(x) (((x) + 3) & ~3UL)
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+} KV_LOG_SECTOR_HDR_T;
+
+typedef struct {
+    uint16_t magic;
+    uint8_t flags;
+    uint8_t key_len;
+    uint16_t val_len;
+    uint16_t reserved;
+    uint32_t crc; // flags, key_len, val_len, key and value
+} KV_LOG_REC_HDR_T;
+
+typedef struct {
+    uint32_t seq;     // 0 when the sector is free
+    uint32_t used;    // write offset
+    uint32_t garbage; // bytes of records no longer in the index
+} KV_LOG_SECTOR_T;
+
+typedef struct {
+    uint32_t hash;
+    uint32_t addr; // partition offset of the record
+    uint16_t size; // padded record size
+    uint8_t is_del;
+    uint16_t next; // next entry of the bucket, or of the free list
+} KV_LOG_ENTRY_T;
+
+typedef struct {
+    MUTEX_HANDLE mutex;
+    uint32_t base;
+    uint32_t sector_size;
+    uint16_t sector_num;
+    uint16_t active;
+    uint32_t seq;
+    KV_LOG_SECTOR_T *sector;
+    KV_LOG_ENTRY_T *entry;
+    uint16_t bucket[TAL_KV_LOG_BUCKET_NUM];
+    uint16_t free_entry;
+    uint16_t entry_cnt;
+    uint32_t gc_cnt;
+    uint32_t read_cnt;
+    uint32_t read_bytes;
+    uint32_t prog_cnt;
+    uint32_t prog_bytes;
+    uint32_t erase_cnt;
+    bool is_gc_pending;
+} KV_LOG_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static KV_LOG_T *s_kv_log = NULL;
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+
+static OPERATE_RET __kv_log_read(uint32_t addr, void *buf, uint32_t len)
+{
+    s_kv_log->read_cnt++;
+    s_kv_log->read_bytes += len;
+
+    return tkl_flash_read(s_kv_log->base + addr, buf, len);
+}
+
+static uint32_t __kv_log_hash(const char *key, uint8_t key_len)
+{
+    return hash_crc32i_total(key, key_len);
+}
+
+static uint32_t __kv_log_rec_crc(KV_LOG_REC_HDR_T *hdr, const void *key, const void *value)
+{
+    uint32_t crc = hash_crc32i_init();
+
+    crc = hash_crc32i_update(crc, &hdr->flags, SIZEOF(hdr->flags));
+    crc = hash_crc32i_update(crc, &hdr->key_len, SIZEOF(hdr->key_len));
+    crc = hash_crc32i_update(crc, &hdr->val_len, SIZEOF(hdr->val_len));
+    crc = hash_crc32i_update(crc, key, hdr->key_len);
+    if (hdr->val_len) {
+        crc = hash_crc32i_update(crc, value, hdr->val_len);
+    }
+
+    return hash_crc32i_finish(crc);
+}
+
+static uint16_t __kv_log_free_num(void)
+{
+    uint16_t i, cnt = 0;
+
+    for (i = 0; i < s_kv_log->sector_num; i++) {
+        if (0 == s_kv_log->sector[i].seq) {
+            cnt++;
+        }
+    }
+
+    return cnt;
+}
+
+/**
+ * @brief finds the index entry of a key
+ *
+ * @param[in] key: key
+ * @param[in] key_len: key length
+ * @param[in] hash: key hash
+ * @param[out] prev: entry before it in the bucket, KV_LOG_NONE if first, may be NULL
+ *
+ * @return entry index, KV_LOG_NONE if not found
+ */
+static uint16_t __kv_log_find(const char *key, uint8_t key_len, uint32_t hash, uint16_t *prev)
+{
+    uint8_t buf[SIZEOF(KV_LOG_REC_HDR_T) + KV_LOG_KEY_LEN_MAX];
+    KV_LOG_REC_HDR_T *hdr = (KV_LOG_REC_HDR_T *)buf;
+    KV_LOG_ENTRY_T *entry = NULL;
+    uint16_t idx, last = KV_LOG_NONE;
+
+    for (idx = s_kv_log->bucket[hash % TAL_KV_LOG_BUCKET_NUM]; idx != KV_LOG_NONE; idx = entry->next) {
+        entry = &s_kv_log->entry[idx];
+        if (entry->hash == hash && entry->size >= SIZEOF(KV_LOG_REC_HDR_T) + key_len &&
+            OPRT_OK == __kv_log_read(entry->addr, buf, SIZEOF(KV_LOG_REC_HDR_T) + key_len) &&
+            hdr->key_len == key_len && 0 == memcmp(buf + SIZEOF(KV_LOG_REC_HDR_T), key, key_len)) {
+            if (prev) {
+                *prev = last;
+            }
+            return idx;
+        }
+        last = idx;
+    }
+
+    return KV_LOG_NONE;
+}
+
+/**
+ * @brief points the index entry of a key to a new record
+ *
+ * @return OPRT_OK on success, OPRT_EXCEED_UPPER_LIMIT if the index is full
+ */
+static OPERATE_RET __kv_log_index_put(const char *key, uint8_t key_len, uint32_t addr, uint16_t size, bool is_del)
+{
+    uint32_t hash = __kv_log_hash(key, key_len);
+    uint16_t idx = __kv_log_find(key, key_len, hash, NULL);
+    KV_LOG_ENTRY_T *entry = NULL;
+
+    if (KV_LOG_NONE != idx) {
+        entry = &s_kv_log->entry[idx];
+        s_kv_log->sector[entry->addr / s_kv_log->sector_size].garbage += entry->size;
+    } else {
+        if (KV_LOG_NONE == s_kv_log->free_entry) {
+            return OPRT_EXCEED_UPPER_LIMIT;
+        }
+        idx = s_kv_log->free_entry;
+        entry = &s_kv_log->entry[idx];
+        s_kv_log->free_entry = entry->next;
+        entry->hash = hash;
+        entry->next = s_kv_log->bucket[hash % TAL_KV_LOG_BUCKET_NUM];
+        s_kv_log->bucket[hash % TAL_KV_LOG_BUCKET_NUM] = idx;
+        s_kv_log->entry_cnt++;
+    }
+
+    entry->addr = addr;
+    entry->size = size;
+    entry->is_del = is_del;
+
+    return OPRT_OK;
+}
+
+static void __kv_log_index_drop(uint16_t bucket, uint16_t prev, uint16_t idx)
+{
+    KV_LOG_ENTRY_T *entry = &s_kv_log->entry[idx];
+
+    if (KV_LOG_NONE == prev) {
+        s_kv_log->bucket[bucket] = entry->next;
+    } else {
+        s_kv_log->entry[prev].next = entry->next;
+    }
+    s_kv_log->sector[entry->addr / s_kv_log->sector_size].garbage += entry->size;
+
+    entry->next = s_kv_log->free_entry;
+    s_kv_log->free_entry = idx;
+    s_kv_log->entry_cnt--;
+}
+
+/**
+ * @brief erases a free sector and makes it the head of the log
+ *
+ * @return OPRT_OK on success, OPRT_KVS_WR_FAIL if no sector is free
+ */
+static OPERATE_RET __kv_log_open_sector(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    KV_LOG_SECTOR_HDR_T hdr;
+    uint16_t i;
+
+    for (i = 0; i < s_kv_log->sector_num; i++) {
+        if (0 == s_kv_log->sector[i].seq) {
+            break;
+        }
+    }
+    if (i >= s_kv_log->sector_num) {
+        return OPRT_KVS_WR_FAIL;
+    }
+
+    TUYA_CALL_ERR_RETURN(tkl_flash_erase(s_kv_log->base + i * s_kv_log->sector_size, s_kv_log->sector_size));
+    s_kv_log->erase_cnt++;
+
+    hdr.magic = KV_LOG_SECTOR_MAGIC;
+    hdr.seq = s_kv_log->seq + 1;
+    TUYA_CALL_ERR_RETURN(tkl_flash_write(s_kv_log->base + i * s_kv_log->sector_size, (uint8_t *)&hdr, SIZEOF(hdr)));
+    s_kv_log->prog_cnt++;
+    s_kv_log->prog_bytes += SIZEOF(hdr);
+
+    s_kv_log->seq = hdr.seq;
+    s_kv_log->sector[i].seq = hdr.seq;
+    s_kv_log->sector[i].used = SIZEOF(hdr);
+    s_kv_log->sector[i].garbage = 0;
+    s_kv_log->active = i;
+
+    return OPRT_OK;
+}
+
+// writes a whole record at the head, the caller made room for it
+static OPERATE_RET __kv_log_program(const uint8_t *rec, uint32_t size, uint32_t *addr)
+{
+    OPERATE_RET rt = OPRT_OK;
+    KV_LOG_SECTOR_T *sector = &s_kv_log->sector[s_kv_log->active];
+
+    *addr = s_kv_log->active * s_kv_log->sector_size + sector->used;
+    rt = tkl_flash_write(s_kv_log->base + *addr, rec, size);
+    s_kv_log->prog_cnt++;
+    s_kv_log->prog_bytes += size;
+    // a cut record is skipped on mount, never write over it
+    sector->used += size;
+
+    return rt;
+}
+
+static bool __kv_log_fits(uint32_t size)
+{
+    return s_kv_log->sector[s_kv_log->active].used + size <= s_kv_log->sector_size;
+}
+
+/**
+ * @brief copies the live records of the sector with the most garbage to the
+ * head and erases it
+ *
+ * @return OPRT_OK on success, OPRT_NOT_FOUND if nothing can be reclaimed
+ */
+static OPERATE_RET __kv_log_gc_one(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    KV_LOG_SECTOR_T *sector = s_kv_log->sector;
+    KV_LOG_ENTRY_T *entry = NULL;
+    uint8_t *rec = NULL;
+    uint32_t oldest = 0xFFFFFFFF, addr = 0;
+    uint16_t i, victim = KV_LOG_NONE, b, idx, prev, next;
+
+    for (i = 0; i < s_kv_log->sector_num; i++) {
+        if (0 == sector[i].seq) {
+            continue;
+        }
+        if (sector[i].seq < oldest) {
+            oldest = sector[i].seq;
+        }
+        if (i != s_kv_log->active && sector[i].garbage &&
+            (KV_LOG_NONE == victim || sector[i].garbage > sector[victim].garbage)) {
+            victim = i;
+        }
+    }
+    if (KV_LOG_NONE == victim) {
+        return OPRT_NOT_FOUND;
+    }
+
+    rec = tal_malloc(s_kv_log->sector_size);
+    if (NULL == rec) {
+        return OPRT_MALLOC_FAILED;
+    }
+
+    for (b = 0; b < TAL_KV_LOG_BUCKET_NUM; b++) {
+        prev = KV_LOG_NONE;
+        for (idx = s_kv_log->bucket[b]; idx != KV_LOG_NONE; idx = next) {
+            entry = &s_kv_log->entry[idx];
+            next = entry->next;
+            if (entry->addr / s_kv_log->sector_size != victim) {
+                prev = idx;
+                continue;
+            }
+
+            if (entry->is_del && sector[victim].seq == oldest) {
+                __kv_log_index_drop(b, prev, idx);
+                continue;
+            }
+
+            if (!__kv_log_fits(entry->size)) {
+                TUYA_CALL_ERR_GOTO(__kv_log_open_sector(), __EXIT);
+            }
+            TUYA_CALL_ERR_GOTO(__kv_log_read(entry->addr, rec, entry->size), __EXIT);
+            TUYA_CALL_ERR_GOTO(__kv_log_program(rec, entry->size, &addr), __EXIT);
+            entry->addr = addr;
+            prev = idx;
+        }
+    }
+
+    TUYA_CALL_ERR_GOTO(tkl_flash_erase(s_kv_log->base + victim * s_kv_log->sector_size, s_kv_log->sector_size),
+                       __EXIT);
+    sector[victim].seq = 0;
+    sector[victim].used = 0;
+    sector[victim].garbage = 0;
+    s_kv_log->gc_cnt++;
+    s_kv_log->erase_cnt++;
+
+__EXIT:
+    tal_free(rec);
+
+    return rt;
+}
+
+// a sector other than the head has at least a quarter of it to reclaim
+static bool __kv_log_gc_worth(void)
+{
+    uint16_t i;
+
+    for (i = 0; i < s_kv_log->sector_num; i++) {
+        if (i != s_kv_log->active && s_kv_log->sector[i].seq &&
+            s_kv_log->sector[i].garbage >= s_kv_log->sector_size / 4) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+// makes room for a record at the head, one sector is left free for compaction
+static OPERATE_RET __kv_log_reserve(uint32_t size)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    while (!__kv_log_fits(size)) {
+        if (__kv_log_free_num() > 1) {
+            TUYA_CALL_ERR_RETURN(__kv_log_open_sector());
+            continue;
+        }
+
+        rt = __kv_log_gc_one();
+        if (OPRT_OK != rt) {
+            PR_ERR("kv log full %d", rt);
+            return OPRT_KVS_WR_FAIL;
+        }
+    }
+
+    return OPRT_OK;
+}
+
+static void __kv_log_gc_work(void *data)
+{
+    kv_log_compact();
+}
+
+static OPERATE_RET __kv_log_copy(uint8_t *value, size_t length, void *arg)
+{
+    memcpy(value, arg, length);
+
+    return OPRT_OK;
+}
+
+static OPERATE_RET __kv_log_append(const char *key, uint8_t key_len, KV_LOG_FILL_CB fill, void *arg,
+                                   uint16_t val_len, uint8_t flags)
+{
+    OPERATE_RET rt = OPRT_OK;
+    KV_LOG_REC_HDR_T *hdr = NULL;
+    uint32_t size = KV_LOG_ALIGN(SIZEOF(KV_LOG_REC_HDR_T) + key_len + val_len);
+    uint32_t addr = 0;
+    uint8_t *rec = NULL;
+
+    TUYA_CALL_ERR_RETURN(__kv_log_reserve(size));
+
+    rec = tal_malloc(size);
+    if (NULL == rec) {
+        return OPRT_MALLOC_FAILED;
+    }
+    memset(rec, 0xFF, size);
+
+    hdr = (KV_LOG_REC_HDR_T *)rec;
+    hdr->magic = KV_LOG_REC_MAGIC;
+    hdr->flags = flags;
+    hdr->key_len = key_len;
+    hdr->val_len = val_len;
+    memcpy(rec + SIZEOF(KV_LOG_REC_HDR_T), key, key_len);
+    if (val_len) {
+        rt = fill(rec + SIZEOF(KV_LOG_REC_HDR_T) + key_len, val_len, arg);
+        if (OPRT_OK != rt) {
+            tal_free(rec);
+            return rt;
+        }
+    }
+    hdr->crc = __kv_log_rec_crc(hdr, key, rec + SIZEOF(KV_LOG_REC_HDR_T) + key_len);
+
+    rt = __kv_log_program(rec, size, &addr);
+    tal_free(rec);
+    if (OPRT_OK != rt) {
+        PR_ERR("kv log write %s fail %d", key, rt);
+        return OPRT_KVS_WR_FAIL;
+    }
+
+    TUYA_CALL_ERR_RETURN(__kv_log_index_put(key, key_len, addr, size, flags & KV_LOG_REC_F_DEL));
+
+    if (!s_kv_log->is_gc_pending && __kv_log_free_num() <= TAL_KV_LOG_GC_FREE_MIN && __kv_log_gc_worth() &&
+        OPRT_OK == tal_workq_schedule_prio(WORKQ_SYSTEM, WORKQ_PRIO_LOW, __kv_log_gc_work, NULL)) {
+        s_kv_log->is_gc_pending = TRUE;
+    }
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief scans the records of a sector into the index
+ *
+ * @param[in] i: sector index
+ * @param[in] buf: scratch buffer of a whole record
+ *
+ * @return none
+ */
+static void __kv_log_scan_sector(uint16_t i, uint8_t *buf)
+{
+    KV_LOG_SECTOR_T *sector = &s_kv_log->sector[i];
+    KV_LOG_REC_HDR_T *hdr = (KV_LOG_REC_HDR_T *)buf;
+    uint32_t base = i * s_kv_log->sector_size;
+    uint32_t off = SIZEOF(KV_LOG_SECTOR_HDR_T), size = 0;
+    uint8_t *key = buf + SIZEOF(KV_LOG_REC_HDR_T);
+
+    while (1) {
+        if (off + SIZEOF(KV_LOG_REC_HDR_T) > s_kv_log->sector_size) {
+            // full, the tail is too short for a record
+            sector->garbage += s_kv_log->sector_size - off;
+            sector->used = s_kv_log->sector_size;
+            return;
+        }
+        if (OPRT_OK != __kv_log_read(base + off, hdr, SIZEOF(KV_LOG_REC_HDR_T))) {
+            break;
+        }
+        if (KV_LOG_REC_ERASED == hdr->magic) {
+            sector->used = off;
+            return;
+        }
+
+        size = KV_LOG_ALIGN(SIZEOF(KV_LOG_REC_HDR_T) + hdr->key_len + hdr->val_len);
+        if (KV_LOG_REC_MAGIC != hdr->magic || 0 == hdr->key_len || hdr->val_len > TAL_KV_LOG_VALUE_MAX ||
+            off + size > s_kv_log->sector_size) {
+            break;
+        }
+        if (OPRT_OK != __kv_log_read(base + off + SIZEOF(KV_LOG_REC_HDR_T), key, hdr->key_len + hdr->val_len) ||
+            hdr->crc != __kv_log_rec_crc(hdr, key, key + hdr->key_len)) {
+            break;
+        }
+
+        if (OPRT_OK != __kv_log_index_put((const char *)key, hdr->key_len, base + off, size,
+                                          hdr->flags & KV_LOG_REC_F_DEL)) {
+            PR_ERR("kv log index full, record at 0x%x lost", base + off);
+            sector->garbage += size;
+        }
+        off += size;
+    }
+
+    // cut by a power loss, nothing is appended after it
+    PR_WARN("kv log sector %d broken at 0x%x", i, off);
+    sector->garbage += s_kv_log->sector_size - off;
+    sector->used = s_kv_log->sector_size;
+}
+
+/**
+ * @brief Mounts the log on the TAL_KV_LOG_FLASH_TYPE partition and rebuilds
+ * the index.
+ *
+ * @return OPRT_OK on success, OPRT_NOT_SUPPORTED when the partition is missing
+ * or has less than two sectors, or another error code on failure.
+ */
+OPERATE_RET kv_log_init(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    TUYA_FLASH_BASE_INFO_T info;
+    KV_LOG_SECTOR_HDR_T hdr;
+    uint8_t *buf = NULL;
+    uint16_t i, j, n = 0;
+    uint16_t *order = NULL;
+
+    if (s_kv_log) {
+        return OPRT_OK;
+    }
+
+    memset(&info, 0, SIZEOF(info));
+    if (OPRT_OK != tkl_flash_get_one_type_info(TAL_KV_LOG_FLASH_TYPE, &info) || 0 == info.partition_num ||
+        0 == info.partition[0].block_size || info.partition[0].size < 2 * info.partition[0].block_size) {
+        return OPRT_NOT_SUPPORTED;
+    }
+
+    s_kv_log = tal_malloc(SIZEOF(KV_LOG_T));
+    if (NULL == s_kv_log) {
+        return OPRT_MALLOC_FAILED;
+    }
+    memset(s_kv_log, 0, SIZEOF(KV_LOG_T));
+
+    s_kv_log->base = info.partition[0].start_addr;
+    s_kv_log->sector_size = info.partition[0].block_size;
+    s_kv_log->sector_num = info.partition[0].size / info.partition[0].block_size;
+
+    s_kv_log->sector = tal_malloc(s_kv_log->sector_num * SIZEOF(KV_LOG_SECTOR_T));
+    s_kv_log->entry = tal_malloc(TAL_KV_LOG_KEY_MAX * SIZEOF(KV_LOG_ENTRY_T));
+    order = tal_malloc(s_kv_log->sector_num * SIZEOF(uint16_t));
+    buf = tal_malloc(SIZEOF(KV_LOG_REC_HDR_T) + KV_LOG_KEY_LEN_MAX + TAL_KV_LOG_VALUE_MAX);
+    if (NULL == s_kv_log->sector || NULL == s_kv_log->entry || NULL == order || NULL == buf) {
+        rt = OPRT_MALLOC_FAILED;
+        goto __ERR;
+    }
+    memset(s_kv_log->sector, 0, s_kv_log->sector_num * SIZEOF(KV_LOG_SECTOR_T));
+    memset(s_kv_log->bucket, 0xFF, SIZEOF(s_kv_log->bucket));
+    for (i = 0; i < TAL_KV_LOG_KEY_MAX; i++) {
+        s_kv_log->entry[i].next = (i + 1 < TAL_KV_LOG_KEY_MAX) ? (i + 1) : KV_LOG_NONE;
+    }
+    s_kv_log->free_entry = 0;
+
+    TUYA_CALL_ERR_GOTO(tal_mutex_create_init(&s_kv_log->mutex), __ERR);
+
+    // sectors in the order they were filled
+    for (i = 0; i < s_kv_log->sector_num; i++) {
+        if (OPRT_OK != __kv_log_read(i * s_kv_log->sector_size, &hdr, SIZEOF(hdr)) ||
+            KV_LOG_SECTOR_MAGIC != hdr.magic || 0 == hdr.seq || 0xFFFFFFFF == hdr.seq) {
+            continue;
+        }
+        s_kv_log->sector[i].seq = hdr.seq;
+        for (j = n; j > 0 && s_kv_log->sector[order[j - 1]].seq > hdr.seq; j--) {
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+        n++;
+    }
+
+    for (j = 0; j < n; j++) {
+        __kv_log_scan_sector(order[j], buf);
+    }
+
+    if (n) {
+        s_kv_log->active = order[n - 1];
+        s_kv_log->seq = s_kv_log->sector[s_kv_log->active].seq;
+    } else {
+        TUYA_CALL_ERR_GOTO(__kv_log_open_sector(), __ERR);
+    }
+
+    tal_free(order);
+    tal_free(buf);
+
+    PR_DEBUG("kv log %d sectors, %d keys", s_kv_log->sector_num, s_kv_log->entry_cnt);
+
+    return OPRT_OK;
+
+__ERR:
+    if (s_kv_log->mutex) {
+        tal_mutex_release(s_kv_log->mutex);
+    }
+    if (s_kv_log->sector) {
+        tal_free(s_kv_log->sector);
+    }
+    if (s_kv_log->entry) {
+        tal_free(s_kv_log->entry);
+    }
+    if (order) {
+        tal_free(order);
+    }
+    if (buf) {
+        tal_free(buf);
+    }
+    tal_free(s_kv_log);
+    s_kv_log = NULL;
+
+    return rt;
+}
+
+/**
+ * @brief Appends a value of a key.
+ *
+ * @param key The key, 1 to 255 characters.
+ * @param value The value.
+ * @param length The length of the value.
+ *
+ * @return OPRT_OK on success, OPRT_NOT_SUPPORTED when the value or the key
+ * does not fit into the log, or another error code on failure.
+ */
+OPERATE_RET kv_log_set(const char *key, const uint8_t *value, size_t length)
+{
+    if (NULL == value) {
+        return OPRT_INVALID_PARM;
+    }
+
+    return kv_log_set_fill(key, length, __kv_log_copy, (void *)value);
+}
+
+/**
+ * @brief Appends a value of a key that is written by a callback.
+ *
+ * @param key The key, 1 to 255 characters.
+ * @param length The length of the value.
+ * @param fill Writes the value into the record.
+ * @param arg Passed to fill.
+ *
+ * @return OPRT_OK on success, OPRT_NOT_SUPPORTED when the value or the key
+ * does not fit into the log, the error of fill, or another error code on
+ * failure.
+ */
+OPERATE_RET kv_log_set_fill(const char *key, size_t length, KV_LOG_FILL_CB fill, void *arg)
+{
+    OPERATE_RET rt = OPRT_OK;
+    size_t key_len = 0;
+    uint32_t size = 0;
+
+    if (NULL == s_kv_log) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+    if (NULL == key || NULL == fill || 0 == length) {
+        return OPRT_INVALID_PARM;
+    }
+
+    key_len = strlen(key);
+    size = KV_LOG_ALIGN(SIZEOF(KV_LOG_REC_HDR_T) + key_len + length);
+    if (0 == key_len || key_len > KV_LOG_KEY_LEN_MAX || length > TAL_KV_LOG_VALUE_MAX ||
+        size > s_kv_log->sector_size - SIZEOF(KV_LOG_SECTOR_HDR_T)) {
+        return OPRT_NOT_SUPPORTED;
+    }
+
+    tal_mutex_lock(s_kv_log->mutex);
+    if (KV_LOG_NONE == s_kv_log->free_entry &&
+        KV_LOG_NONE == __kv_log_find(key, key_len, __kv_log_hash(key, key_len), NULL)) {
+        rt = OPRT_NOT_SUPPORTED;
+    } else {
+        rt = __kv_log_append(key, key_len, fill, arg, length, 0);
+    }
+    tal_mutex_unlock(s_kv_log->mutex);
+
+    return rt;
+}
+
+/**
+ * @brief Reads the latest value of a key.
+ *
+ * @param key The key.
+ * @param value Set to the value, released with tal_free().
+ * @param length Set to the length of the value.
+ *
+ * @return OPRT_OK on success, OPRT_NOT_FOUND when the key is not live in the
+ * log, or another error code on failure.
+ */
+OPERATE_RET kv_log_get(const char *key, uint8_t **value, size_t *length)
+{
+    OPERATE_RET rt = OPRT_OK;
+    KV_LOG_ENTRY_T *entry = NULL;
+    KV_LOG_REC_HDR_T *hdr = NULL;
+    uint8_t *rec = NULL;
+    size_t key_len = 0;
+    uint16_t idx;
+
+    if (NULL == s_kv_log) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+    if (NULL == key || NULL == value || NULL == length) {
+        return OPRT_INVALID_PARM;
+    }
+
+    key_len = strlen(key);
+    if (0 == key_len || key_len > KV_LOG_KEY_LEN_MAX) {
+        return OPRT_NOT_FOUND;
+    }
+
+    tal_mutex_lock(s_kv_log->mutex);
+    idx = __kv_log_find(key, key_len, __kv_log_hash(key, key_len), NULL);
+    if (KV_LOG_NONE == idx || s_kv_log->entry[idx].is_del) {
+        tal_mutex_unlock(s_kv_log->mutex);
+        return OPRT_NOT_FOUND;
+    }
+    entry = &s_kv_log->entry[idx];
+
+    rec = tal_malloc(entry->size + 1);
+    if (NULL == rec) {
+        tal_mutex_unlock(s_kv_log->mutex);
+        return OPRT_MALLOC_FAILED;
+    }
+    rt = __kv_log_read(entry->addr, rec, entry->size);
+    tal_mutex_unlock(s_kv_log->mutex);
+
+    hdr = (KV_LOG_REC_HDR_T *)rec;
+    if (OPRT_OK != rt ||
+        hdr->crc != __kv_log_rec_crc(hdr, rec + SIZEOF(KV_LOG_REC_HDR_T), rec + SIZEOF(KV_LOG_REC_HDR_T) + key_len)) {
+        PR_ERR("kv log read %s fail %d", key, rt);
+        tal_free(rec);
+        return OPRT_KVS_RD_FAIL;
+    }
+
+    // the value is moved to the front of the record buffer
+    *length = hdr->val_len;
+    memmove(rec, rec + SIZEOF(KV_LOG_REC_HDR_T) + key_len, *length);
+    rec[*length] = 0;
+    *value = rec;
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Appends a tombstone for a key.
+ *
+ * @param key The key.
+ *
+ * @return OPRT_OK on success, OPRT_NOT_FOUND when the key is not live in the
+ * log, or another error code on failure.
+ */
+OPERATE_RET kv_log_del(const char *key)
+{
+    OPERATE_RET rt = OPRT_OK;
+    size_t key_len = 0;
+    uint16_t idx;
+
+    if (NULL == s_kv_log) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+    if (NULL == key) {
+        return OPRT_INVALID_PARM;
+    }
+
+    key_len = strlen(key);
+    if (0 == key_len || key_len > KV_LOG_KEY_LEN_MAX) {
+        return OPRT_NOT_FOUND;
+    }
+
+    tal_mutex_lock(s_kv_log->mutex);
+    idx = __kv_log_find(key, key_len, __kv_log_hash(key, key_len), NULL);
+    if (KV_LOG_NONE == idx || s_kv_log->entry[idx].is_del) {
+        rt = OPRT_NOT_FOUND;
+    } else {
+        rt = __kv_log_append(key, key_len, NULL, NULL, 0, KV_LOG_REC_F_DEL);
+    }
+    tal_mutex_unlock(s_kv_log->mutex);
+
+    return rt;
+}
+
+/**
+ * @brief Tells whether the log holds a key.
+ *
+ * @param key The key.
+ *
+ * @return KV_LOG_KEY_STATE_E
+ */
+KV_LOG_KEY_STATE_E kv_log_state(const char *key)
+{
+    KV_LOG_KEY_STATE_E state = KV_LOG_KEY_UNKNOWN;
+    size_t key_len = 0;
+    uint16_t idx;
+
+    if (NULL == s_kv_log || NULL == key) {
+        return KV_LOG_KEY_UNKNOWN;
+    }
+
+    key_len = strlen(key);
+    if (0 == key_len || key_len > KV_LOG_KEY_LEN_MAX) {
+        return KV_LOG_KEY_UNKNOWN;
+    }
+
+    tal_mutex_lock(s_kv_log->mutex);
+    idx = __kv_log_find(key, key_len, __kv_log_hash(key, key_len), NULL);
+    if (KV_LOG_NONE != idx) {
+        state = s_kv_log->entry[idx].is_del ? KV_LOG_KEY_DELETED : KV_LOG_KEY_LIVE;
+    }
+    tal_mutex_unlock(s_kv_log->mutex);
+
+    return state;
+}
+
+/**
+ * @brief Compacts sectors until more than TAL_KV_LOG_GC_FREE_MIN are free or
+ * nothing is left to reclaim.
+ *
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET kv_log_compact(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint16_t i;
+
+    if (NULL == s_kv_log) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    tal_mutex_lock(s_kv_log->mutex);
+    s_kv_log->is_gc_pending = FALSE;
+    for (i = 0; i < s_kv_log->sector_num && __kv_log_free_num() <= TAL_KV_LOG_GC_FREE_MIN && __kv_log_gc_worth();
+         i++) {
+        rt = __kv_log_gc_one();
+        if (OPRT_OK != rt) {
+            break;
+        }
+    }
+    tal_mutex_unlock(s_kv_log->mutex);
+
+    return (OPRT_NOT_FOUND == rt) ? OPRT_OK : rt;
+}
+
+/**
+ * @brief Reads the log counters.
+ *
+ * @param stat Filled with the counters.
+ *
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET kv_log_get_stat(KV_LOG_STAT_T *stat)
+{
+    uint16_t i;
+
+    if (NULL == s_kv_log) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+    if (NULL == stat) {
+        return OPRT_INVALID_PARM;
+    }
+
+    memset(stat, 0, SIZEOF(KV_LOG_STAT_T));
+
+    tal_mutex_lock(s_kv_log->mutex);
+    stat->sector_num = s_kv_log->sector_num;
+    stat->free_num = __kv_log_free_num();
+    stat->key_num = s_kv_log->entry_cnt;
+    for (i = 0; i < s_kv_log->sector_num; i++) {
+        stat->garbage += s_kv_log->sector[i].garbage;
+    }
+    stat->gc_cnt = s_kv_log->gc_cnt;
+    stat->read_cnt = s_kv_log->read_cnt;
+    stat->read_bytes = s_kv_log->read_bytes;
+    stat->prog_cnt = s_kv_log->prog_cnt;
+    stat->prog_bytes = s_kv_log->prog_bytes;
+    stat->erase_cnt = s_kv_log->erase_cnt;
+    tal_mutex_unlock(s_kv_log->mutex);
+
+    return OPRT_OK;
+}
@@ -15,6 +15,10 @@
  * includes optimizations for memory usage and processing time, making it
  * suitable for resource-constrained environments.
  *
+ * A compact versioned binary format is provided as well. It is written into a
+ * buffer of the caller and read without any parsing allocations, JSON is
+ * still read for values stored by older firmware.
+ *
  * @copyright Copyright (c) 2021-2024 Tuya Inc. All Rights Reserved.
  *
  */
@@ -275,3 +279,268 @@ ERR_EXIT:
 
     return op_ret;
 }
+
+/*
+ * Binary format, all numbers little endian:
+ *   header: magic 0xA5, version, item count (u16)
+ *   item:   key length (u8), key, type (u8), value length (u16), value
+ * Integer types are stored as 4 byte values, bools as one byte, strings
+ * without their terminator and an empty string or raw value has length 0.
+ * Items are found by key, so fields may be added or dropped between
+ * versions of a kv_db_t array as with JSON.
+ */
+#define KV_BIN_MAGIC     0xA5
+#define KV_BIN_VERSION   1
+#define KV_BIN_HDR_LEN   4
+#define KV_BIN_ITEM_HDR  4 // key length, type, value length
+
+static uint16_t __kv_bin_val_len(const kv_db_t *item)
+{
+    if (item->tp <= KV_INT) {
+        return 4;
+    } else if (item->tp == KV_BOOL) {
+        return 1;
+    } else if (item->tp == KV_STRING) {
+        return strlen((char *)item->val);
+    }
+
+    return item->len;
+}
+
+static int32_t __kv_bin_int_get(const kv_db_t *item)
+{
+    switch (item->tp) {
+    case KV_CHAR:
+        return *((char *)item->val);
+    case KV_BYTE:
+        return *((uint8_t *)item->val);
+    case KV_SHORT:
+        return *((int16_t *)item->val);
+    case KV_USHORT:
+        return *((uint16_t *)item->val);
+    default:
+        return *((int32_t *)item->val);
+    }
+}
+
+/**
+ * @brief Tells whether a stored value is in the binary format.
+ *
+ * @param[in] in The stored value.
+ * @param[in] len The length of the stored value.
+ * @return TRUE for the binary format, FALSE for JSON.
+ */
+BOOL_T kv_serialize_is_bin(const uint8_t *in, uint32_t len)
+{
+    return (len >= KV_BIN_HDR_LEN && KV_BIN_MAGIC == in[0]) ? TRUE : FALSE;
+}
+
+/**
+ * @brief Serializes a key-value database into the binary format.
+ *
+ * Nothing is allocated, the caller provides the buffer. Passing a NULL
+ * buffer only computes the length.
+ *
+ * @param[in] db The key-value database.
+ * @param[in] dbcnt The number of elements in the database.
+ * @param[out] out The output buffer, may be NULL.
+ * @param[in,out] out_len In: size of out. Out: length of the serialized data,
+ * also when out is too small.
+ * @return OPRT_OK on success, OPRT_BUFFER_NOT_ENOUGH when out is NULL or too
+ * small, or another error code on failure.
+ */
+int kv_serialize_bin(const kv_db_t *db, const uint32_t dbcnt, uint8_t *out, uint32_t *out_len)
+{
+    uint32_t i = 0, len = KV_BIN_HDR_LEN, offset = 0;
+    size_t key_len = 0;
+    uint16_t val_len = 0;
+    int32_t num = 0;
+
+    if (NULL == db || NULL == out_len || dbcnt > 0xFFFF) {
+        return OPRT_INVALID_PARM;
+    }
+
+    for (i = 0; i < dbcnt; i++) {
+        key_len = strlen(db[i].key);
+        if (0 == key_len || key_len > 0xFF || db[i].tp > KV_RAW) {
+            PR_ERR("item invalid %s %d", db[i].key, db[i].tp);
+            return OPRT_COM_ERROR;
+        }
+        len += KV_BIN_ITEM_HDR + key_len + __kv_bin_val_len(&db[i]);
+    }
+
+    if (NULL == out || *out_len < len) {
+        *out_len = len;
+        return OPRT_BUFFER_NOT_ENOUGH;
+    }
+
+    out[offset++] = KV_BIN_MAGIC;
+    out[offset++] = KV_BIN_VERSION;
+    out[offset++] = dbcnt & 0xFF;
+    out[offset++] = (dbcnt >> 8) & 0xFF;
+
+    for (i = 0; i < dbcnt; i++) {
+        key_len = strlen(db[i].key);
+        val_len = __kv_bin_val_len(&db[i]);
+
+        out[offset++] = key_len;
+        memcpy(out + offset, db[i].key, key_len);
+        offset += key_len;
+        out[offset++] = db[i].tp;
+        out[offset++] = val_len & 0xFF;
+        out[offset++] = (val_len >> 8) & 0xFF;
+
+        if (db[i].tp <= KV_INT) {
+            num = __kv_bin_int_get(&db[i]);
+            out[offset++] = num & 0xFF;
+            out[offset++] = (num >> 8) & 0xFF;
+            out[offset++] = (num >> 16) & 0xFF;
+            out[offset++] = (num >> 24) & 0xFF;
+        } else if (db[i].tp == KV_BOOL) {
+            out[offset++] = (FALSE == *((BOOL_T *)(db[i].val))) ? 0 : 1;
+        } else {
+            memcpy(out + offset, db[i].val, val_len);
+            offset += val_len;
+        }
+    }
+
+    *out_len = offset;
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Deserializes the binary format into a key-value database.
+ *
+ * Keys missing in the data are set to zero as kv_deserialize() does.
+ *
+ * @param[in] in The serialized data.
+ * @param[in] len The length of the serialized data.
+ * @param[in,out] db The key-value database to populate.
+ * @param[in] dbcnt The number of elements in the database.
+ * @return OPRT_OK on success, OPRT_NOT_SUPPORTED for an unknown version, or
+ * another error code on failure.
+ */
+int kv_deserialize_bin(const uint8_t *in, uint32_t len, kv_db_t *db, const uint32_t dbcnt)
+{
+    const uint8_t *item = NULL, *val = NULL;
+    uint32_t i = 0, j = 0, offset = 0, cnt = 0;
+    uint8_t key_len = 0, tp = 0;
+    uint16_t val_len = 0;
+    int32_t num = 0;
+
+    if (NULL == in || NULL == db) {
+        return OPRT_INVALID_PARM;
+    }
+    if (!kv_serialize_is_bin(in, len)) {
+        return OPRT_COM_ERROR;
+    }
+    if (KV_BIN_VERSION != in[1]) {
+        PR_ERR("kv bin version %d", in[1]);
+        return OPRT_NOT_SUPPORTED;
+    }
+    cnt = in[2] | (in[3] << 8);
+
+    for (i = 0; i < dbcnt; i++) {
+        val = NULL;
+        for (j = 0, offset = KV_BIN_HDR_LEN; j < cnt; j++) {
+            item = in + offset;
+            if (offset + 1 > len || offset + KV_BIN_ITEM_HDR + item[0] > len) {
+                goto ERR_EXIT;
+            }
+            key_len = item[0];
+            tp = item[1 + key_len];
+            val_len = item[2 + key_len] | (item[3 + key_len] << 8);
+            offset += KV_BIN_ITEM_HDR + key_len + val_len;
+            if (offset > len) {
+                goto ERR_EXIT;
+            }
+            if (key_len == strlen(db[i].key) && 0 == memcmp(item + 1, db[i].key, key_len)) {
+                val = item + KV_BIN_ITEM_HDR + key_len;
+                break;
+            }
+        }
+
+        if (NULL == val) { // default set zero
+            memset(db[i].val, 0, db[i].len);
+            continue;
+        }
+
+        if ((db[i].tp <= KV_INT && (tp > KV_INT || 4 != val_len)) ||
+            (db[i].tp == KV_BOOL && (tp != KV_BOOL || 1 != val_len)) ||
+            ((db[i].tp == KV_STRING || db[i].tp == KV_RAW) && tp != db[i].tp)) {
+            PR_ERR("kv bin type mismatch %s %d-%d", db[i].key, db[i].tp, tp);
+            return OPRT_COM_ERROR;
+        }
+        if (db[i].tp <= KV_INT) {
+            num = (int32_t)((uint32_t)val[0] | ((uint32_t)val[1] << 8) | ((uint32_t)val[2] << 16) |
+                            ((uint32_t)val[3] << 24));
+        }
+
+        switch (db[i].tp) {
+        case KV_CHAR: {
+            if (num < -128 || num > 127) {
+                return OPRT_COM_ERROR;
+            }
+            *((char *)db[i].val) = num;
+        } break;
+
+        case KV_BYTE: {
+            if (num < 0 || num > 255) {
+                return OPRT_COM_ERROR;
+            }
+            *((uint8_t *)db[i].val) = num;
+        } break;
+
+        case KV_SHORT: {
+            if (num < -32768 || num > 32767) {
+                return OPRT_COM_ERROR;
+            }
+            *((int16_t *)db[i].val) = num;
+        } break;
+
+        case KV_USHORT: {
+            if (num < 0 || num > 65535) {
+                return OPRT_COM_ERROR;
+            }
+            *((uint16_t *)db[i].val) = num;
+        } break;
+
+        case KV_INT: {
+            *((int *)db[i].val) = num;
+        } break;
+
+        case KV_BOOL: {
+            *((BOOL_T *)db[i].val) = val[0] ? 1 : 0;
+        } break;
+
+        case KV_STRING: {
+            if (db[i].len < val_len + 1) {
+                return OPRT_COM_ERROR;
+            }
+            memcpy(db[i].val, val, val_len);
+            ((char *)db[i].val)[val_len] = 0;
+        } break;
+
+        case KV_RAW: {
+            if (db[i].len < val_len) {
+                return OPRT_COM_ERROR;
+            }
+            memcpy(db[i].val, val, val_len);
+            db[i].len = val_len;
+        } break;
+
+        default: {
+            PR_ERR("type invalid %d", db[i].tp);
+            return OPRT_COM_ERROR;
+        }
+        }
+    }
+
+    return OPRT_OK;
+
+ERR_EXIT:
+    PR_ERR("kv bin truncated %d", len);
+
+    return OPRT_COM_ERROR;
+}
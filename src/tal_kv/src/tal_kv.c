@@ -29,6 +29,10 @@
 #include "tkl_flash.h"
 #include "tal_api.h"
 #include "tal_security.h"
+#include "tal_boot_mark.h"
+#if defined(ENABLE_KV_LOG) && (ENABLE_KV_LOG == 1)
+#include "kv_log.h"
+#endif
 
 // variables used by the filesystem
 static lfs_t lfs;
@@ -36,8 +40,178 @@ static lfs_size_t lfs_flash_addr;
 static tal_kv_cfg_t lfs_kv_cfg;
 static MUTEX_HANDLE lfs_mutex;
 
+#if defined(ENABLE_KV_LOG) && (ENABLE_KV_LOG == 1)
+// keys go to the log once it is mounted, files are still read and removed
+static bool s_kv_log_ready = FALSE;
+#endif
+
+#if defined(ENABLE_KV_CACHE) && (ENABLE_KV_CACHE == 1)
+typedef uint8_t KV_CACHE_STATE_E;
+#define KV_CACHE_CLEAN   0 // same as flash
+#define KV_CACHE_DIRTY   1 // value not written yet
+#define KV_CACHE_DELETED 2 // key not removed from flash yet
+
+typedef struct {
+    KV_CACHE_STATE_E state;
+    uint32_t use; // tick of the last use, the lowest clean one is evicted first
+    size_t len;
+    uint8_t *value;
+    char key[0];
+} KV_CACHE_ITEM_T;
+
+typedef struct {
+    KV_CACHE_ITEM_T *item[TAL_KV_CACHE_ITEM_NUM];
+    uint32_t size; // value bytes of all items
+    uint32_t dirty_size;
+    uint32_t txn_cnt;
+    uint32_t tick;
+    uint32_t hit;
+    uint32_t miss;
+    TIMER_ID flush_timer;
+} KV_CACHE_T;
+
+static KV_CACHE_T s_kv_cache;
+#endif
+
+static tal_kv_flash_stat_t s_kv_flash_stat;
+
+#if TAL_LFS_BLOCK_CACHE_NUM > 0
+#define LFS_BLOCK_NONE ((lfs_block_t)-1)
+
+typedef struct {
+    MUTEX_HANDLE mutex;
+    uint8_t *data; // TAL_LFS_BLOCK_CACHE_NUM blocks
+    lfs_block_t block[TAL_LFS_BLOCK_CACHE_NUM];
+    uint8_t next;          // slot replaced next, slots are reused in turn
+    lfs_block_t last_miss; // last block fetched from flash
+} LFS_BLOCK_CACHE_T;
+
+static LFS_BLOCK_CACHE_T s_lfs_block_cache;
+#endif
+
 extern int kv_serialize(const kv_db_t *db, const uint32_t dbcnt, char **out, uint32_t *out_len);
 extern int kv_deserialize(const char *in, kv_db_t *db, const uint32_t dbcnt);
+extern BOOL_T kv_serialize_is_bin(const uint8_t *in, uint32_t len);
+extern int kv_serialize_bin(const kv_db_t *db, const uint32_t dbcnt, uint8_t *out, uint32_t *out_len);
+extern int kv_deserialize_bin(const uint8_t *in, uint32_t len, kv_db_t *db, const uint32_t dbcnt);
+
+static int __lfs_flash_read(uint32_t addr, void *buffer, lfs_size_t size)
+{
+    s_kv_flash_stat.read_cnt++;
+    s_kv_flash_stat.read_bytes += size;
+
+    return (OPRT_OK == tkl_flash_read(addr, buffer, size)) ? LFS_ERR_OK : LFS_ERR_IO;
+}
+
+#if TAL_LFS_BLOCK_CACHE_NUM > 0
+static int __lfs_block_cache_find(lfs_block_t block)
+{
+    int i;
+
+    for (i = 0; i < TAL_LFS_BLOCK_CACHE_NUM; i++) {
+        if (s_lfs_block_cache.block[i] == block) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static void __lfs_block_cache_drop(lfs_block_t block)
+{
+    int i;
+
+    if (NULL == s_lfs_block_cache.data) {
+        return;
+    }
+
+    tal_mutex_lock(s_lfs_block_cache.mutex);
+    i = __lfs_block_cache_find(block);
+    if (i >= 0) {
+        s_lfs_block_cache.block[i] = LFS_BLOCK_NONE;
+    }
+    tal_mutex_unlock(s_lfs_block_cache.mutex);
+}
+
+static int __lfs_block_cache_read(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buffer,
+                                  lfs_size_t size)
+{
+    int result = LFS_ERR_OK;
+    uint32_t n = 1, k;
+    int i;
+
+    tal_mutex_lock(s_lfs_block_cache.mutex);
+    i = __lfs_block_cache_find(block);
+    if (i >= 0) {
+        s_kv_flash_stat.cache_hit++;
+        memcpy(buffer, s_lfs_block_cache.data + i * c->block_size + off, size);
+        tal_mutex_unlock(s_lfs_block_cache.mutex);
+        return LFS_ERR_OK;
+    }
+    s_kv_flash_stat.cache_miss++;
+
+    // a read continuing the last fetch is sequential, the following blocks come along
+    if (block == s_lfs_block_cache.last_miss + 1) {
+        n = TAL_LFS_READ_AHEAD_NUM;
+    }
+    if (n > TAL_LFS_BLOCK_CACHE_NUM) {
+        n = TAL_LFS_BLOCK_CACHE_NUM;
+    }
+    if (block + n > c->block_count) {
+        n = c->block_count - block;
+    }
+    for (k = 1; k < n; k++) {
+        if (__lfs_block_cache_find(block + k) >= 0) {
+            n = k;
+            break;
+        }
+    }
+
+    // the blocks of one fetch take adjacent slots
+    if (s_lfs_block_cache.next + n > TAL_LFS_BLOCK_CACHE_NUM) {
+        s_lfs_block_cache.next = 0;
+    }
+    i = s_lfs_block_cache.next;
+    result = __lfs_flash_read(lfs_flash_addr + c->block_size * block, s_lfs_block_cache.data + i * c->block_size,
+                              n * c->block_size);
+    for (k = 0; k < n; k++) {
+        s_lfs_block_cache.block[i + k] = (LFS_ERR_OK == result) ? (block + k) : LFS_BLOCK_NONE;
+    }
+    if (LFS_ERR_OK == result) {
+        memcpy(buffer, s_lfs_block_cache.data + i * c->block_size + off, size);
+        s_kv_flash_stat.read_ahead += n - 1;
+        s_lfs_block_cache.next = (i + n) % TAL_LFS_BLOCK_CACHE_NUM;
+        s_lfs_block_cache.last_miss = block + n - 1;
+    }
+    tal_mutex_unlock(s_lfs_block_cache.mutex);
+
+    return result;
+}
+
+static void __lfs_block_cache_init(uint32_t block_size)
+{
+    int i;
+
+    if (s_lfs_block_cache.data) {
+        return;
+    }
+
+    for (i = 0; i < TAL_LFS_BLOCK_CACHE_NUM; i++) {
+        s_lfs_block_cache.block[i] = LFS_BLOCK_NONE;
+    }
+    s_lfs_block_cache.last_miss = LFS_BLOCK_NONE - 1;
+
+    if (OPRT_OK != tal_mutex_create_init(&s_lfs_block_cache.mutex)) {
+        return;
+    }
+    s_lfs_block_cache.data = tal_malloc(TAL_LFS_BLOCK_CACHE_NUM * block_size);
+    if (NULL == s_lfs_block_cache.data) {
+        PR_WARN("lfs block cache malloc %d fail", TAL_LFS_BLOCK_CACHE_NUM * block_size);
+        tal_mutex_release(s_lfs_block_cache.mutex);
+        s_lfs_block_cache.mutex = NULL;
+    }
+}
+#endif
 
 /**
  * Reads data from a user-provided block device.
@@ -56,12 +230,13 @@ extern int kv_deserialize(const char *in, kv_db_t *db, const uint32_t dbcnt);
 int user_provided_block_device_read(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buffer,
                                     lfs_size_t size)
 {
-
-    OPERATE_RET ret = tkl_flash_read(lfs_flash_addr + c->block_size * block + off, buffer, size);
-    if (OPRT_OK != ret) {
-        return LFS_ERR_IO;
+#if TAL_LFS_BLOCK_CACHE_NUM > 0
+    if (s_lfs_block_cache.data) {
+        return __lfs_block_cache_read(c, block, off, buffer, size);
     }
-    return LFS_ERR_OK;
+#endif
+
+    return __lfs_flash_read(lfs_flash_addr + c->block_size * block + off, buffer, size);
 }
 
 /**
@@ -82,8 +257,13 @@ int user_provided_block_device_read(const struct lfs_config *c, lfs_block_t bloc
 int user_provided_block_device_prog(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buffer,
                                     lfs_size_t size)
 {
+#if TAL_LFS_BLOCK_CACHE_NUM > 0
+    __lfs_block_cache_drop(block);
+#endif
 
     OPERATE_RET ret = tkl_flash_write(lfs_flash_addr + c->block_size * block + off, buffer, size);
+    s_kv_flash_stat.prog_cnt++;
+    s_kv_flash_stat.prog_bytes += size;
     if (OPRT_OK != ret) {
         return LFS_ERR_IO;
     }
@@ -103,8 +283,12 @@ int user_provided_block_device_prog(const struct lfs_config *c, lfs_block_t bloc
  */
 int user_provided_block_device_erase(const struct lfs_config *c, lfs_block_t block)
 {
+#if TAL_LFS_BLOCK_CACHE_NUM > 0
+    __lfs_block_cache_drop(block);
+#endif
 
     OPERATE_RET ret = tkl_flash_erase(lfs_flash_addr + c->block_size * block, c->block_size);
+    s_kv_flash_stat.erase_cnt++;
     if (OPRT_OK != ret) {
         return LFS_ERR_IO;
     }
@@ -126,6 +310,525 @@ int user_provided_block_device_sync(const struct lfs_config *c)
     return LFS_ERR_OK;
 }
 
+static OPERATE_RET __kv_crypt_init(TAL_AES_CBC_STREAM_T *stream, int32_t mode)
+{
+    return tal_aes_cbc_stream_init(stream, mode, (const uint8_t *)lfs_kv_cfg.key, 128,
+                                   (const uint8_t *)lfs_kv_cfg.seed);
+}
+
+/**
+ * @brief Encrypts a value into the file of its key chunk by chunk, lfs_mutex
+ * must be held.
+ */
+static int __kv_file_write(const char *key, const uint8_t *value, size_t length)
+{
+    int result;
+    lfs_file_t file;
+    TAL_AES_CBC_STREAM_T stream;
+    uint8_t chunk[TAL_KV_CRYPT_CHUNK + 16];
+    size_t offset = 0, n = 0, ec_len = 0;
+
+    result = __kv_crypt_init(&stream, SYMMETRY_ENCRYPT);
+    if (OPRT_OK != result) {
+        PR_DEBUG("key %s encrypt failed", key);
+        return result;
+    }
+
+    result = lfs_file_open(&lfs, &file, key, LFS_O_RDWR | LFS_O_CREAT | LFS_O_TRUNC);
+    if (LFS_ERR_OK != result) {
+        PR_ERR("lfs open %s err", key);
+        tal_aes_cbc_stream_deinit(&stream);
+        return result;
+    }
+    lfs_file_rewind(&lfs, &file);
+
+    while (offset < length) {
+        n = (length - offset > TAL_KV_CRYPT_CHUNK) ? TAL_KV_CRYPT_CHUNK : (length - offset);
+        result = tal_aes_cbc_stream_update(&stream, value + offset, n, chunk, &ec_len);
+        if (OPRT_OK != result) {
+            goto __EXIT;
+        }
+        offset += n;
+        if (ec_len && lfs_file_write(&lfs, &file, chunk, ec_len) != (lfs_ssize_t)ec_len) {
+            result = OPRT_KVS_WR_FAIL;
+            goto __EXIT;
+        }
+    }
+
+    result = tal_aes_cbc_stream_final(&stream, chunk, &ec_len);
+    if (OPRT_OK == result && lfs_file_write(&lfs, &file, chunk, ec_len) != (lfs_ssize_t)ec_len) {
+        result = OPRT_KVS_WR_FAIL;
+    }
+
+__EXIT:
+    tal_aes_cbc_stream_deinit(&stream);
+    lfs_file_close(&lfs, &file);
+    if (OPRT_OK != result) {
+        PR_ERR("kv write fail %d", result);
+        return OPRT_KVS_WR_FAIL;
+    }
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Decrypts the file of a key chunk by chunk into one value buffer,
+ * lfs_mutex must be held.
+ */
+static int __kv_file_read(const char *key, uint8_t **value, size_t *length)
+{
+    int result;
+    lfs_file_t file;
+    TAL_AES_CBC_STREAM_T stream;
+    uint8_t chunk[TAL_KV_CRYPT_CHUNK];
+    uint8_t *dec_data = NULL;
+    lfs_ssize_t n = 0;
+    size_t ec_len = 0, dec_len = 0, out_len = 0;
+
+    result = lfs_file_open(&lfs, &file, key, LFS_O_RDONLY);
+    if (LFS_ERR_OK != result) {
+        PR_ERR("lfs open %s %d err", key, result);
+        return result;
+    }
+    ec_len = lfs_file_size(&lfs, &file);
+    PR_DEBUG("key:%s, len:%d", key, ec_len);
+    if (0 == ec_len || ec_len % 16) {
+        lfs_file_close(&lfs, &file);
+        PR_ERR("kv read error %d", ec_len);
+        return OPRT_KVS_RD_FAIL;
+    }
+
+    // the value is shorter than the ciphertext, one byte is kept for the NUL
+    dec_data = tal_malloc(ec_len);
+    if (NULL == dec_data) {
+        lfs_file_close(&lfs, &file);
+        return OPRT_MALLOC_FAILED;
+    }
+
+    result = __kv_crypt_init(&stream, SYMMETRY_DECRYPT);
+    if (OPRT_OK != result) {
+        goto __EXIT;
+    }
+    while ((n = lfs_file_read(&lfs, &file, chunk, sizeof(chunk))) > 0) {
+        result = tal_aes_cbc_stream_update(&stream, chunk, n, dec_data + dec_len, &out_len);
+        if (OPRT_OK != result) {
+            goto __EXIT;
+        }
+        dec_len += out_len;
+    }
+    if (n < 0) {
+        PR_ERR("kv read error %d", n);
+        result = OPRT_KVS_RD_FAIL;
+        goto __EXIT;
+    }
+    result = tal_aes_cbc_stream_final(&stream, dec_data + dec_len, &out_len);
+    dec_len += out_len;
+
+__EXIT:
+    tal_aes_cbc_stream_deinit(&stream);
+    lfs_file_close(&lfs, &file);
+    if (OPRT_OK != result) {
+        PR_ERR("key %s decrypt failed %d", key, result);
+        tal_free(dec_data);
+        return (OPRT_KVS_RD_FAIL == result) ? result : OPRT_BUFFER_NOT_ENOUGH;
+    }
+    dec_data[dec_len] = 0;
+    *value = dec_data;
+    *length = dec_len;
+
+    return OPRT_OK;
+}
+
+#if defined(ENABLE_KV_LOG) && (ENABLE_KV_LOG == 1)
+typedef struct {
+    const uint8_t *value;
+    size_t length;
+} KV_LOG_VALUE_T;
+
+// encrypts a value straight into its log record
+static OPERATE_RET __kv_log_encrypt(uint8_t *ec_data, size_t ec_len, void *arg)
+{
+    OPERATE_RET result;
+    KV_LOG_VALUE_T *value = (KV_LOG_VALUE_T *)arg;
+    TAL_AES_CBC_STREAM_T stream;
+    size_t n = 0, tail = 0;
+
+    result = __kv_crypt_init(&stream, SYMMETRY_ENCRYPT);
+    if (OPRT_OK != result) {
+        return result;
+    }
+    result = tal_aes_cbc_stream_update(&stream, value->value, value->length, ec_data, &n);
+    if (OPRT_OK == result) {
+        result = tal_aes_cbc_stream_final(&stream, ec_data + n, &tail);
+    }
+    tal_aes_cbc_stream_deinit(&stream);
+
+    return result;
+}
+
+// decrypts a value read from the log in place
+static OPERATE_RET __kv_log_decrypt(uint8_t *data, size_t *length)
+{
+    OPERATE_RET result;
+    TAL_AES_CBC_STREAM_T stream;
+    size_t n = 0, tail = 0;
+
+    result = __kv_crypt_init(&stream, SYMMETRY_DECRYPT);
+    if (OPRT_OK != result) {
+        return result;
+    }
+    result = tal_aes_cbc_stream_update(&stream, data, *length, data, &n);
+    if (OPRT_OK == result) {
+        result = tal_aes_cbc_stream_final(&stream, data + n, &tail);
+    }
+    tal_aes_cbc_stream_deinit(&stream);
+    *length = n + tail;
+
+    return result;
+}
+#endif
+
+/**
+ * @brief Encrypts a value and stores it, lfs_mutex must be held.
+ *
+ * With ENABLE_KV_LOG the value is encrypted into a log record, the file of
+ * the key is only written when the value is too large for the log. Either
+ * way no buffer of the whole ciphertext is allocated here.
+ *
+ * @param key The key.
+ * @param value The value.
+ * @param length The length of the value in bytes.
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+static int __kv_flash_set(const char *key, const uint8_t *value, size_t length)
+{
+    int result;
+
+    if (NULL == value || 0 == length) {
+        return OPRT_INVALID_PARM;
+    }
+
+#if defined(ENABLE_KV_LOG) && (ENABLE_KV_LOG == 1)
+    if (s_kv_log_ready) {
+        KV_LOG_KEY_STATE_E state = kv_log_state(key);
+        KV_LOG_VALUE_T log_value = {value, length};
+
+        result = kv_log_set_fill(key, TAL_AES_CBC_PKCS7_LEN(length), __kv_log_encrypt, &log_value);
+        if (OPRT_OK == result) {
+            // the file is older than the log record, it would only waste space
+            if (KV_LOG_KEY_LIVE != state) {
+                lfs_remove(&lfs, key);
+            }
+            return OPRT_OK;
+        }
+        if (OPRT_NOT_SUPPORTED != result) {
+            return result;
+        }
+
+        // the file takes over, the log record goes once the file is written
+        result = __kv_file_write(key, value, length);
+        if (OPRT_OK == result && KV_LOG_KEY_LIVE == state) {
+            kv_log_del(key);
+        }
+        return result;
+    }
+#endif
+
+    return __kv_file_write(key, value, length);
+}
+
+/**
+ * @brief Reads and decrypts the value of a key from flash, lfs_mutex must be
+ * held.
+ *
+ * @param key The key.
+ * @param value Set to the value, released with tal_kv_free().
+ * @param length Set to the length of the value.
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+static int __kv_flash_get(const char *key, uint8_t **value, size_t *length)
+{
+    int result = OPRT_NOT_FOUND;
+
+#if defined(ENABLE_KV_LOG) && (ENABLE_KV_LOG == 1)
+    if (s_kv_log_ready) {
+        uint8_t *data = NULL;
+        size_t len = 0;
+
+        result = kv_log_get(key, &data, &len);
+        if (OPRT_OK == result) {
+            result = __kv_log_decrypt(data, &len);
+            if (OPRT_OK != result) {
+                PR_ERR("key %s decrypt failed %d", key, result);
+                tal_free(data);
+                *length = 0;
+                return OPRT_BUFFER_NOT_ENOUGH;
+            }
+            data[len] = 0;
+            *value = data;
+            *length = len;
+            return OPRT_OK;
+        }
+        if (OPRT_NOT_FOUND != result) {
+            *length = 0;
+            return result;
+        }
+    }
+#endif
+
+    result = __kv_file_read(key, value, length);
+    if (OPRT_OK != result) {
+        *length = 0;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Removes a key from flash, lfs_mutex must be held.
+ *
+ * @return LFS_ERR_OK on success, LFS_ERR_NOENT if the key is not stored.
+ */
+static int __kv_flash_del(const char *key)
+{
+    int result = lfs_remove(&lfs, key);
+
+#if defined(ENABLE_KV_LOG) && (ENABLE_KV_LOG == 1)
+    if (s_kv_log_ready && OPRT_OK == kv_log_del(key)) {
+        result = LFS_ERR_OK;
+    }
+#endif
+
+    return result;
+}
+
+#if defined(ENABLE_KV_CACHE) && (ENABLE_KV_CACHE == 1)
+// tells whether a key is stored in flash without reading its value
+static bool __kv_flash_exist(const char *key)
+{
+    struct lfs_info info;
+
+#if defined(ENABLE_KV_LOG) && (ENABLE_KV_LOG == 1)
+    if (s_kv_log_ready && KV_LOG_KEY_LIVE == kv_log_state(key)) {
+        return TRUE;
+    }
+#endif
+
+    return LFS_ERR_OK == lfs_stat(&lfs, key, &info);
+}
+#endif
+
+#if defined(ENABLE_KV_CACHE) && (ENABLE_KV_CACHE == 1)
+static int __kv_cache_find(const char *key)
+{
+    int i;
+
+    for (i = 0; i < TAL_KV_CACHE_ITEM_NUM; i++) {
+        if (s_kv_cache.item[i] && 0 == strcmp(s_kv_cache.item[i]->key, key)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// bytes an item adds to the next flush
+static uint32_t __kv_cache_dirty_size(KV_CACHE_ITEM_T *item)
+{
+    if (KV_CACHE_CLEAN == item->state) {
+        return 0;
+    }
+
+    return strlen(item->key) + 1 + item->len;
+}
+
+static KV_CACHE_ITEM_T *__kv_cache_item_new(const char *key, const uint8_t *value, size_t length,
+                                            KV_CACHE_STATE_E state)
+{
+    size_t key_len = strlen(key) + 1;
+    KV_CACHE_ITEM_T *item = tal_malloc(sizeof(KV_CACHE_ITEM_T) + key_len + length + 1);
+    if (NULL == item) {
+        return NULL;
+    }
+
+    item->state = state;
+    item->len = length;
+    memcpy(item->key, key, key_len);
+    item->value = (uint8_t *)item->key + key_len;
+    if (length) {
+        memcpy(item->value, value, length);
+    }
+    item->value[length] = 0;
+
+    return item;
+}
+
+static void __kv_cache_drop(int idx)
+{
+    s_kv_cache.dirty_size -= __kv_cache_dirty_size(s_kv_cache.item[idx]);
+    s_kv_cache.size -= s_kv_cache.item[idx]->len;
+    tal_free(s_kv_cache.item[idx]);
+    s_kv_cache.item[idx] = NULL;
+}
+
+// finds a cached item and marks it used, lfs_mutex must be held
+static KV_CACHE_ITEM_T *__kv_cache_hit(const char *key)
+{
+    int idx = __kv_cache_find(key);
+
+    if (idx < 0) {
+        s_kv_cache.miss++;
+        return NULL;
+    }
+
+    s_kv_cache.hit++;
+    s_kv_cache.item[idx]->use = ++s_kv_cache.tick;
+
+    return s_kv_cache.item[idx];
+}
+
+/**
+ * @brief Evicts the least recently used clean items until a value of length
+ * bytes fits, lfs_mutex must be held.
+ *
+ * @return The index of a free slot, or -1 when only dirty items are left.
+ */
+static int __kv_cache_evict(size_t length)
+{
+    int i, idx, lru;
+
+    while (1) {
+        idx = -1;
+        lru = -1;
+        for (i = 0; i < TAL_KV_CACHE_ITEM_NUM; i++) {
+            if (NULL == s_kv_cache.item[i]) {
+                idx = i;
+            } else if (KV_CACHE_CLEAN == s_kv_cache.item[i]->state &&
+                       (lru < 0 || s_kv_cache.item[i]->use < s_kv_cache.item[lru]->use)) {
+                lru = i;
+            }
+        }
+
+        if (idx >= 0 && s_kv_cache.size + length <= TAL_KV_CACHE_SIZE_MAX) {
+            return idx;
+        }
+        if (lru < 0) {
+            return -1;
+        }
+        __kv_cache_drop(lru);
+    }
+}
+
+/**
+ * @brief Writes every dirty item, lfs_mutex must be held.
+ *
+ * Written items stay in the cache as clean copies, deleted ones are dropped.
+ *
+ * @return OPRT_OK on success, or the error of the first item that failed.
+ */
+static int __kv_cache_flush(void)
+{
+    int i, result, ret = OPRT_OK;
+    KV_CACHE_ITEM_T *item = NULL;
+
+    for (i = 0; i < TAL_KV_CACHE_ITEM_NUM; i++) {
+        item = s_kv_cache.item[i];
+        if (NULL == item || KV_CACHE_CLEAN == item->state) {
+            continue;
+        }
+
+        if (KV_CACHE_DIRTY == item->state) {
+            result = __kv_flash_set(item->key, item->value, item->len);
+        } else {
+            result = __kv_flash_del(item->key);
+            if (LFS_ERR_NOENT == result) {
+                result = OPRT_OK;
+            }
+        }
+        if (OPRT_OK != result) {
+            PR_ERR("kv flush %s fail %d", item->key, result);
+            if (OPRT_OK == ret) {
+                ret = result;
+            }
+            continue;
+        }
+
+        if (KV_CACHE_DELETED == item->state) {
+            __kv_cache_drop(i);
+        } else {
+            s_kv_cache.dirty_size -= __kv_cache_dirty_size(item);
+            item->state = KV_CACHE_CLEAN;
+        }
+    }
+
+    // failed items are tried again later
+    if (s_kv_cache.flush_timer) {
+        if (0 == s_kv_cache.dirty_size) {
+            tal_sw_timer_stop(s_kv_cache.flush_timer);
+        } else if (!tal_sw_timer_is_running(s_kv_cache.flush_timer)) {
+            tal_sw_timer_start(s_kv_cache.flush_timer, TAL_KV_CACHE_FLUSH_MS, TAL_TIMER_ONCE);
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Drops the item of a key and finds a slot for a new one of length
+ * bytes, lfs_mutex must be held.
+ *
+ * Clean items are evicted least recently used first, the cache is flushed
+ * when only dirty items are left.
+ *
+ * @return The index, or -1 when no slot could be freed.
+ */
+static int __kv_cache_slot(const char *key, size_t length)
+{
+    int idx;
+
+    idx = __kv_cache_find(key);
+    if (idx >= 0) {
+        __kv_cache_drop(idx);
+    }
+
+    idx = __kv_cache_evict(length);
+    if (idx < 0) {
+        __kv_cache_flush();
+        idx = __kv_cache_evict(length);
+    }
+
+    return idx;
+}
+
+// places an item into a slot from __kv_cache_slot() and applies the flush policy
+static void __kv_cache_put(int idx, KV_CACHE_ITEM_T *item)
+{
+    s_kv_cache.item[idx] = item;
+    s_kv_cache.size += item->len;
+    s_kv_cache.dirty_size += __kv_cache_dirty_size(item);
+    item->use = ++s_kv_cache.tick;
+
+    if (KV_CACHE_CLEAN == item->state || s_kv_cache.txn_cnt || 0 == TAL_KV_CACHE_WRITE_BACK) {
+        return;
+    }
+
+    if (s_kv_cache.dirty_size >= TAL_KV_CACHE_DIRTY_MAX) {
+        __kv_cache_flush();
+    } else if (s_kv_cache.flush_timer && !tal_sw_timer_is_running(s_kv_cache.flush_timer)) {
+        tal_sw_timer_start(s_kv_cache.flush_timer, TAL_KV_CACHE_FLUSH_MS, TAL_TIMER_ONCE);
+    }
+}
+
+static void __kv_cache_timer_cb(TIMER_ID timer_id, void *arg)
+{
+    tal_mutex_lock(lfs_mutex);
+    if (0 == s_kv_cache.txn_cnt) {
+        __kv_cache_flush();
+    }
+    tal_mutex_unlock(lfs_mutex);
+}
+#endif
+
 /**
  * @brief Initializes the TAL Key-Value (KV) module.
  *
@@ -139,6 +842,8 @@ int tal_kv_init(tal_kv_cfg_t *kv_cfg)
 {
     uint8_t sha256_ret[32];
 
+    tal_boot_mark("kv init");
+
     //! init flash key
     memset(&lfs_kv_cfg, 0, sizeof(lfs_kv_cfg));
     tal_sha256_ret((const uint8_t *)kv_cfg->seed, TAL_LV_KEY_LEN, sha256_ret, 0);
@@ -147,6 +852,13 @@ int tal_kv_init(tal_kv_cfg_t *kv_cfg)
     memcpy(lfs_kv_cfg.key, sha256_ret, TAL_LV_KEY_LEN);
 
     tal_mutex_create_init(&lfs_mutex);
+    tal_mutex_set_name(lfs_mutex, "kv lfs");
+
+#if defined(ENABLE_KV_CACHE) && (ENABLE_KV_CACHE == 1)
+    if (NULL == s_kv_cache.flush_timer) {
+        tal_sw_timer_create(__kv_cache_timer_cb, NULL, &s_kv_cache.flush_timer);
+    }
+#endif
 
     TUYA_FLASH_BASE_INFO_T info;
     tkl_flash_get_one_type_info(TUYA_FLASH_TYPE_UF, &info);
@@ -166,8 +878,15 @@ int tal_kv_init(tal_kv_cfg_t *kv_cfg)
     lfs_cfg.block_count = info.partition[0].size / info.partition[0].block_size;
     lfs_cfg.cache_size = info.partition[0].block_size;
     lfs_cfg.lookahead_size = lfs_cfg.block_count / 8 + (8 - (lfs_cfg.block_count / 8));
+#if TAL_LFS_LOOKAHEAD_SIZE > 0
+    lfs_cfg.lookahead_size = TAL_LFS_LOOKAHEAD_SIZE;
+#endif
     lfs_cfg.block_cycles = 500;
 
+#if TAL_LFS_BLOCK_CACHE_NUM > 0
+    __lfs_block_cache_init(lfs_cfg.block_size);
+#endif
+
     // mount the filesystem
     int err = lfs_mount(&lfs, &lfs_cfg);
 
@@ -177,6 +896,16 @@ int tal_kv_init(tal_kv_cfg_t *kv_cfg)
         lfs_format(&lfs, &lfs_cfg);
         err = lfs_mount(&lfs, &lfs_cfg);
     }
+    tal_boot_mark("kv mounted");
+
+#if defined(ENABLE_KV_LOG) && (ENABLE_KV_LOG == 1)
+    if (OPRT_OK == kv_log_init()) {
+        s_kv_log_ready = TRUE;
+    } else {
+        PR_WARN("kv log not mounted, keys are kept in files");
+    }
+    tal_boot_mark("kv log ready");
+#endif
 
     return err;
 }
@@ -186,7 +915,8 @@ int tal_kv_init(tal_kv_cfg_t *kv_cfg)
  *
  * This function sets a key-value pair in the key-value store. The key is a
  * string, the value is a byte array, and the length specifies the number of
- * bytes in the value.
+ * bytes in the value. With ENABLE_KV_CACHE the value is kept in the write-back
+ * cache and written by the next flush.
  *
  * @param key The key to set in the key-value store.
  * @param value The value to associate with the key.
@@ -197,7 +927,6 @@ int tal_kv_init(tal_kv_cfg_t *kv_cfg)
 int tal_kv_set(const char *key, const uint8_t *value, size_t length)
 {
     int result;
-    lfs_file_t file;
 
     PR_DEBUG("key:%s, len %d", key, length);
 
@@ -205,37 +934,55 @@ int tal_kv_set(const char *key, const uint8_t *value, size_t length)
         return OPRT_INVALID_PARM;
     }
 
+#if defined(ENABLE_KV_CACHE) && (ENABLE_KV_CACHE == 1)
+    KV_CACHE_ITEM_T *item = NULL;
+    int idx = -1;
+
+    if (length <= TAL_KV_CACHE_VALUE_MAX) {
+        item = __kv_cache_item_new(key, value, length, KV_CACHE_DIRTY);
+    }
+
     tal_mutex_lock(lfs_mutex);
-    result = lfs_file_open(&lfs, &file, key, LFS_O_RDWR | LFS_O_CREAT | LFS_O_TRUNC);
-    if (LFS_ERR_OK != result) {
+    idx = __kv_cache_find(key);
+    if (item && idx >= 0 && KV_CACHE_DELETED != s_kv_cache.item[idx]->state &&
+        s_kv_cache.item[idx]->len == length && 0 == memcmp(s_kv_cache.item[idx]->value, value, length)) {
+        // same value, nothing to write
         tal_mutex_unlock(lfs_mutex);
-        PR_ERR("lfs open %s err", key);
-        return result;
+        tal_free(item);
+        return OPRT_OK;
     }
-    uint8_t *ec_data = NULL;
-    uint32_t ec_len = 0;
-    uint8_t iv[16];
-
-    memcpy(iv, lfs_kv_cfg.seed, 16);
-    result =
-        tal_aes128_cbc_encode((uint8_t *)value, length, (uint8_t *)lfs_kv_cfg.key, iv, &ec_data, (uint32_t *)&ec_len);
-    if (OPRT_OK != result) {
-        lfs_file_close(&lfs, &file);
+    if (item) {
+        idx = __kv_cache_slot(key, length);
+    }
+    if (item && idx >= 0) {
+        __kv_cache_put(idx, item);
+        result = OPRT_OK;
+#if (TAL_KV_CACHE_WRITE_BACK == 0)
+        result = __kv_cache_flush();
+        if (OPRT_OK != result) {
+            __kv_cache_drop(idx);
+        }
+#endif
         tal_mutex_unlock(lfs_mutex);
-        PR_DEBUG("key %s encrypt failed", key);
         return result;
     }
-    lfs_file_rewind(&lfs, &file);
-    result = lfs_file_write(&lfs, &file, ec_data, ec_len);
-    lfs_file_close(&lfs, &file);
-    tal_aes_free_data(ec_data);
+
+    // too large or no room, the cached copy must not hide the new value
+    if (idx >= 0) {
+        __kv_cache_drop(idx);
+    }
+    result = __kv_flash_set(key, value, length);
     tal_mutex_unlock(lfs_mutex);
-    if (result != ec_len) {
-        PR_ERR("kv write fail %d", result);
-        return OPRT_KVS_WR_FAIL;
+    if (item) {
+        tal_free(item);
     }
+#else
+    tal_mutex_lock(lfs_mutex);
+    result = __kv_flash_set(key, value, length);
+    tal_mutex_unlock(lfs_mutex);
+#endif
 
-    return OPRT_OK;
+    return result;
 }
 
 /**
@@ -257,55 +1004,118 @@ int tal_kv_set(const char *key, const uint8_t *value, size_t length)
 int tal_kv_get(const char *key, uint8_t **value, size_t *length)
 {
     int result;
-    lfs_file_t file;
 
     if (NULL == key || NULL == value || NULL == length) {
         return OPRT_INVALID_PARM;
     }
 
     tal_mutex_lock(lfs_mutex);
-    result = lfs_file_open(&lfs, &file, key, LFS_O_RDONLY);
-    if (LFS_ERR_OK != result) {
-        PR_ERR("lfs open %s %d err", key, result);
+#if defined(ENABLE_KV_CACHE) && (ENABLE_KV_CACHE == 1)
+    KV_CACHE_ITEM_T *item = __kv_cache_hit(key);
+    int idx = -1;
+
+    if (item) {
+        if (KV_CACHE_DELETED == item->state) {
+            tal_mutex_unlock(lfs_mutex);
+            return LFS_ERR_NOENT;
+        }
+
+        *value = tal_malloc(item->len + 1);
+        if (NULL == *value) {
+            tal_mutex_unlock(lfs_mutex);
+            return OPRT_MALLOC_FAILED;
+        }
+        memcpy(*value, item->value, item->len + 1);
+        *length = item->len;
         tal_mutex_unlock(lfs_mutex);
-        return result;
+        return OPRT_OK;
+    }
+#endif
+
+    result = __kv_flash_get(key, value, length);
+
+#if defined(ENABLE_KV_CACHE) && (ENABLE_KV_CACHE == 1)
+    // keep a clean copy in place of the least recently used ones
+    if (OPRT_OK == result && *length <= TAL_KV_CACHE_VALUE_MAX) {
+        idx = __kv_cache_evict(*length);
+        if (idx >= 0) {
+            item = __kv_cache_item_new(key, *value, *length, KV_CACHE_CLEAN);
+            if (item) {
+                __kv_cache_put(idx, item);
+            }
+        }
+    }
+#endif
+    tal_mutex_unlock(lfs_mutex);
+
+    return result;
+}
+
+/**
+ * @brief Reads the value of a key into a buffer of the caller.
+ *
+ * @param key The key to retrieve the value for.
+ * @param buf The buffer the value is copied to.
+ * @param length In: size of buf. Out: length of the value, also when buf is
+ * too small.
+ *
+ * @return 0 on success, OPRT_BUFFER_NOT_ENOUGH if buf is too small, or a
+ * negative error code if an error occurred.
+ */
+int tal_kv_get_into(const char *key, uint8_t *buf, size_t *length)
+{
+    int result;
+    uint8_t *value = NULL;
+    size_t len = 0;
+
+    if (NULL == key || NULL == buf || NULL == length || 0 == *length) {
+        return OPRT_INVALID_PARM;
     }
-    uint8_t *ec_data = NULL;
-    uint32_t ec_len = lfs_file_size(&lfs, &file);
 
-    ec_data = tal_malloc(ec_len + 1);
-    if (NULL == ec_data) {
-        result = OPRT_MALLOC_FAILED;
+#if defined(ENABLE_KV_CACHE) && (ENABLE_KV_CACHE == 1)
+    KV_CACHE_ITEM_T *item = NULL;
+
+    tal_mutex_lock(lfs_mutex);
+    item = __kv_cache_hit(key);
+    if (item) {
+        if (KV_CACHE_DELETED == item->state) {
+            result = LFS_ERR_NOENT;
+        } else if (item->len > *length) {
+            result = OPRT_BUFFER_NOT_ENOUGH;
+        } else {
+            memcpy(buf, item->value, item->len);
+            if (item->len < *length) {
+                buf[item->len] = 0;
+            }
+            result = OPRT_OK;
+        }
+        if (KV_CACHE_DELETED != item->state) {
+            *length = item->len;
+        }
         tal_mutex_unlock(lfs_mutex);
         return result;
     }
-    PR_DEBUG("key:%s, len:%d", key, ec_len);
-    result = lfs_file_read(&lfs, &file, ec_data, ec_len);
-    lfs_file_close(&lfs, &file);
     tal_mutex_unlock(lfs_mutex);
-    if (result <= 0) {
-        *length = 0;
-        tal_free(ec_data);
-        PR_ERR("kv read error %d", result);
-        return OPRT_KVS_RD_FAIL;
+#endif
+
+    // a miss is read from flash and cached by tal_kv_get()
+    result = tal_kv_get(key, &value, &len);
+    if (OPRT_OK != result) {
+        return result;
     }
-    uint8_t *dec_data = NULL;
-    uint32_t dec_len = 0;
-    uint8_t iv[16];
 
-    memcpy(iv, lfs_kv_cfg.seed, 16);
-    result = tal_aes128_cbc_decode(ec_data, ec_len, (uint8_t *)lfs_kv_cfg.key, iv, &dec_data, (uint32_t *)&dec_len);
-    dec_len = tal_aes_get_actual_length(dec_data, dec_len);
-    tal_free(ec_data);
-    if (OPRT_OK != result || dec_len > ec_len) {
-        PR_ERR("key %s decrypt failed %d, %d-%d", key, result, dec_len, ec_len);
-        return OPRT_BUFFER_NOT_ENOUGH;
+    if (len > *length) {
+        result = OPRT_BUFFER_NOT_ENOUGH;
+    } else {
+        memcpy(buf, value, len);
+        if (len < *length) {
+            buf[len] = 0;
+        }
     }
-    *value = dec_data;
-    *length = (size_t)dec_len;
-    dec_data[dec_len] = 0;
+    *length = len;
+    tal_kv_free(value);
 
-    return OPRT_OK;
+    return result;
 }
 
 /**
@@ -322,7 +1132,47 @@ int tal_kv_del(const char *key)
     PR_DEBUG("key:%s", key);
 
     tal_mutex_lock(lfs_mutex);
-    int result = lfs_remove(&lfs, key);
+#if defined(ENABLE_KV_CACHE) && (ENABLE_KV_CACHE == 1)
+    KV_CACHE_ITEM_T *item = NULL;
+    int idx = __kv_cache_find(key);
+
+    if (idx < 0 && !__kv_flash_exist(key)) {
+        tal_mutex_unlock(lfs_mutex);
+        PR_DEBUG("Deleted failed, %s not found", key);
+        return OPRT_COM_ERROR;
+    }
+    if (idx >= 0 && KV_CACHE_DELETED == s_kv_cache.item[idx]->state) {
+        tal_mutex_unlock(lfs_mutex);
+        PR_DEBUG("Deleted failed, %s not found", key);
+        return OPRT_COM_ERROR;
+    }
+
+    item = __kv_cache_item_new(key, NULL, 0, KV_CACHE_DELETED);
+    if (item) {
+        idx = __kv_cache_slot(key, 0);
+    }
+    if (item && idx >= 0) {
+        __kv_cache_put(idx, item);
+        int ret = OPRT_OK;
+#if (TAL_KV_CACHE_WRITE_BACK == 0)
+        ret = __kv_cache_flush();
+        if (OPRT_OK != ret) {
+            __kv_cache_drop(idx);
+            ret = OPRT_COM_ERROR;
+        }
+#endif
+        tal_mutex_unlock(lfs_mutex);
+        return ret;
+    }
+
+    if (idx >= 0) {
+        __kv_cache_drop(idx);
+    }
+    if (item) {
+        tal_free(item);
+    }
+#endif
+    int result = __kv_flash_del(key);
     tal_mutex_unlock(lfs_mutex);
     if (LFS_ERR_OK == result) {
         PR_DEBUG("Deleted successfully");
@@ -334,6 +1184,64 @@ int tal_kv_del(const char *key)
     return OPRT_COM_ERROR;
 }
 
+/**
+ * @brief Writes the keys changed in the write-back cache to flash.
+ *
+ * @return OPRT_OK on success, or the error of the first key that failed.
+ */
+int tal_kv_flush(void)
+{
+    int result = OPRT_OK;
+
+#if defined(ENABLE_KV_CACHE) && (ENABLE_KV_CACHE == 1)
+    tal_mutex_lock(lfs_mutex);
+    result = __kv_cache_flush();
+    tal_mutex_unlock(lfs_mutex);
+#endif
+
+    return result;
+}
+
+/**
+ * @brief Starts a transaction, the cache is not flushed by size or time until
+ * the matching tal_kv_txn_end().
+ *
+ * @return OPRT_OK on success.
+ */
+int tal_kv_txn_begin(void)
+{
+#if defined(ENABLE_KV_CACHE) && (ENABLE_KV_CACHE == 1)
+    tal_mutex_lock(lfs_mutex);
+    s_kv_cache.txn_cnt++;
+    tal_mutex_unlock(lfs_mutex);
+#endif
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Ends a transaction, the last one to end flushes the cache.
+ *
+ * @return OPRT_OK on success, or the error returned by tal_kv_flush().
+ */
+int tal_kv_txn_end(void)
+{
+    int result = OPRT_OK;
+
+#if defined(ENABLE_KV_CACHE) && (ENABLE_KV_CACHE == 1)
+    tal_mutex_lock(lfs_mutex);
+    if (s_kv_cache.txn_cnt) {
+        s_kv_cache.txn_cnt--;
+    }
+    if (0 == s_kv_cache.txn_cnt) {
+        result = __kv_cache_flush();
+    }
+    tal_mutex_unlock(lfs_mutex);
+#endif
+
+    return result;
+}
+
 /**
  * @brief Frees the memory allocated for a value in the TAL Key-Value store.
  *
@@ -365,6 +1273,33 @@ int tal_kv_free(uint8_t *value)
  */
 void tal_kv_cmd(int argc, char *argv[])
 {
+    if (argc == 2 && 0 == strcmp("flush", argv[1])) {
+        tal_kv_flush();
+        return;
+    }
+
+    if (argc == 2 && 0 == strcmp("stat", argv[1])) {
+#if defined(ENABLE_KV_CACHE) && (ENABLE_KV_CACHE == 1)
+        tal_mutex_lock(lfs_mutex);
+        PR_DEBUG("kv cache size %d dirty %d hit %d miss %d", s_kv_cache.size, s_kv_cache.dirty_size, s_kv_cache.hit,
+                 s_kv_cache.miss);
+        tal_mutex_unlock(lfs_mutex);
+#endif
+#if defined(ENABLE_KV_LOG) && (ENABLE_KV_LOG == 1)
+        KV_LOG_STAT_T stat;
+        if (OPRT_OK == kv_log_get_stat(&stat)) {
+            PR_DEBUG("kv log sectors %d free %d keys %d garbage %d gc %d", stat.sector_num, stat.free_num,
+                     stat.key_num, stat.garbage, stat.gc_cnt);
+        }
+#endif
+        tal_kv_flash_stat_t flash;
+        tal_kv_flash_stat_get(&flash);
+        PR_DEBUG("kv flash read %d/%d prog %d/%d erase %d", flash.read_cnt, flash.read_bytes, flash.prog_cnt,
+                 flash.prog_bytes, flash.erase_cnt);
+        PR_DEBUG("lfs block cache hit %d miss %d ahead %d", flash.cache_hit, flash.cache_miss, flash.read_ahead);
+        return;
+    }
+
     if (argc < 3) {
         return;
     }
@@ -414,12 +1349,37 @@ int tal_kv_serialize_set(const char *key, kv_db_t *db, size_t dbcnt)
     uint32_t len = 0;
     int ret = OPRT_OK;
 
+#if TAL_KV_SERIALIZE_BIN
+    uint8_t stack_buf[TAL_KV_SERIALIZE_BUF_LEN];
+
+    len = SIZEOF(stack_buf);
+    ret = kv_serialize_bin(db, dbcnt, stack_buf, &len);
+    if (OPRT_OK == ret) {
+        ret = tal_kv_set(key, stack_buf, len);
+        if (OPRT_OK != ret) {
+            PR_ERR("kv_set fails %s %d", key, ret);
+        }
+        return ret;
+    }
+    if (OPRT_BUFFER_NOT_ENOUGH != ret) {
+        PR_ERR("kv_serialize_bin fail. %d", ret);
+        return ret;
+    }
+
+    // len is the required size now
+    buf = tal_malloc(len);
+    if (NULL == buf) {
+        return OPRT_MALLOC_FAILED;
+    }
+    ret = kv_serialize_bin(db, dbcnt, (uint8_t *)buf, &len);
+#else
     ret = kv_serialize(db, dbcnt, &buf, &len);
+#endif
     if (OPRT_OK != ret) {
         PR_ERR("kv_serialize  fail. %d", ret);
+        tal_free(buf);
         return ret;
     }
-    PR_TRACE("write buf:%s", buf);
     ret = tal_kv_set(key, (const uint8_t *)buf, len);
     tal_free(buf);
     if (OPRT_OK != ret) {
@@ -437,6 +1397,10 @@ int tal_kv_serialize_set(const char *key, kv_db_t *db, size_t dbcnt)
  * retrieves it from the key-value database. The serialized value is then
  * deserialized and stored in the provided `db` array.
  *
+ * Binary values that fit TAL_KV_SERIALIZE_BUF_LEN are read into a stack
+ * buffer. A JSON value of older firmware is parsed once and written back in
+ * the binary format, so later boots skip the JSON parser.
+ *
  * @param key The key for which to retrieve the value.
  * @param db Pointer to the array where the deserialized value will be stored.
  * @param dbcnt The size of the `db` array.
@@ -449,17 +1413,42 @@ int tal_kv_serialize_get(const char *key, kv_db_t *db, size_t dbcnt)
         return OPRT_INVALID_PARM;
     }
 
-    uint8_t *buf = NULL;
-    size_t len = 0;
+    uint8_t stack_buf[TAL_KV_SERIALIZE_BUF_LEN];
+    uint8_t *buf = stack_buf;
+    size_t len = SIZEOF(stack_buf);
     int ret = OPRT_OK;
 
-    ret = tal_kv_get(key, &buf, &len);
+    ret = tal_kv_get_into(key, stack_buf, &len);
+    if (OPRT_BUFFER_NOT_ENOUGH == ret) {
+        ret = tal_kv_get(key, &buf, &len);
+    }
     if (OPRT_OK != ret) {
         PR_ERR("kv_get fails %s %d", key, ret);
         return ret;
     }
-    ret = kv_deserialize((char *)buf, db, dbcnt);
-    tal_free(buf);
+
+    if (kv_serialize_is_bin(buf, len)) {
+        ret = kv_deserialize_bin(buf, len, db, dbcnt);
+    } else {
+        // the JSON parser needs the terminator, tal_kv_get() always adds one
+        if (buf == stack_buf && len == SIZEOF(stack_buf)) {
+            len = 0;
+            ret = tal_kv_get(key, &buf, &len);
+            if (OPRT_OK != ret) {
+                PR_ERR("kv_get fails %s %d", key, ret);
+                return ret;
+            }
+        }
+        ret = kv_deserialize((char *)buf, db, dbcnt);
+#if TAL_KV_SERIALIZE_BIN
+        if (OPRT_OK == ret && OPRT_OK == tal_kv_serialize_set(key, db, dbcnt)) {
+            PR_DEBUG("key %s migrated to binary", key);
+        }
+#endif
+    }
+    if (buf != stack_buf) {
+        tal_free(buf);
+    }
     if (OPRT_OK != ret) {
         PR_ERR("kv_deserialize fail. %d", ret);
     }
@@ -475,4 +1464,46 @@ int tal_kv_serialize_get(const char *key, kv_db_t *db, size_t dbcnt)
 lfs_t *tal_lfs_get()
 {
     return &lfs;
+}
+
+/**
+ * @brief Gets the flash address of a littlefs block.
+ *
+ * @param block The block.
+ *
+ * @return the flash address, as used by tkl_flash_read()
+ */
+uint32_t tal_lfs_block_addr(lfs_block_t block)
+{
+    return lfs_flash_addr + lfs.cfg->block_size * block;
+}
+
+/**
+ * @brief Reads the flash access counters of littlefs and the KV log.
+ *
+ * @param stat Filled with the counters.
+ *
+ * @return OPRT_OK on success, or OPRT_INVALID_PARM.
+ */
+int tal_kv_flash_stat_get(tal_kv_flash_stat_t *stat)
+{
+    if (NULL == stat) {
+        return OPRT_INVALID_PARM;
+    }
+
+    *stat = s_kv_flash_stat;
+
+#if defined(ENABLE_KV_LOG) && (ENABLE_KV_LOG == 1)
+    KV_LOG_STAT_T log_stat;
+
+    if (s_kv_log_ready && OPRT_OK == kv_log_get_stat(&log_stat)) {
+        stat->read_cnt += log_stat.read_cnt;
+        stat->read_bytes += log_stat.read_bytes;
+        stat->prog_cnt += log_stat.prog_cnt;
+        stat->prog_bytes += log_stat.prog_bytes;
+        stat->erase_cnt += log_stat.erase_cnt;
+    }
+#endif
+
+    return OPRT_OK;
 }
\ No newline at end of file
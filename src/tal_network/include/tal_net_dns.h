@@ -0,0 +1,94 @@
+/**
+ * @file tal_net_dns.h
+ * @brief Cache of resolved host addresses used by tal_net_gethostbyname.
+ *
+ * An address is used for TAL_NET_DNS_CACHE_TTL_S after it was resolved, the
+ * platform resolvers do not report the TTL of the record. A lookup in the last
+ * TAL_NET_DNS_PREFETCH_S of that time is answered from the cache and resolves
+ * the host again on a thread of its own, so hosts in use do not expire.
+ *
+ * When resolving fails, an address up to TAL_NET_DNS_STALE_S old is returned
+ * instead. The cached hosts are kept in KV, so after a boot their last
+ * addresses are at hand when the first lookups fail.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#ifndef __TAL_NET_DNS_H__
+#define __TAL_NET_DNS_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+// 0 disables the cache
+#ifndef TAL_NET_DNS_CACHE_NUM
+#define TAL_NET_DNS_CACHE_NUM 8
+#endif
+
+// longer host names are not cached
+#ifndef TAL_NET_DNS_HOST_LEN
+#define TAL_NET_DNS_HOST_LEN 64
+#endif
+
+#ifndef TAL_NET_DNS_CACHE_TTL_S
+#define TAL_NET_DNS_CACHE_TTL_S (10 * 60)
+#endif
+
+#ifndef TAL_NET_DNS_PREFETCH_S
+#define TAL_NET_DNS_PREFETCH_S 60
+#endif
+
+#ifndef TAL_NET_DNS_STALE_S
+#define TAL_NET_DNS_STALE_S (24 * 60 * 60)
+#endif
+
+#ifndef TAL_NET_DNS_PERSIST
+#define TAL_NET_DNS_PERSIST 1
+#endif
+
+#ifndef TAL_NET_DNS_PREFETCH_STACK_SIZE
+#define TAL_NET_DNS_PREFETCH_STACK_SIZE (3 * 1024)
+#endif
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef OPERATE_RET (*TAL_NET_DNS_QUERY_CB)(const char *domain, TUYA_IP_ADDR_T *addr);
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+
+/**
+ * @brief Gets the address of a host from the cache, or resolves it.
+ *
+ * @param[in] domain host name
+ * @param[out] addr address
+ * @param[in] query resolves a host that is not cached
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+OPERATE_RET tal_net_dns_cache_get(const char *domain, TUYA_IP_ADDR_T *addr, TAL_NET_DNS_QUERY_CB query);
+
+/**
+ * @brief Makes the next lookup of a host resolve it again, e.g. when its
+ * address could not be connected. The address is still returned when
+ * resolving fails.
+ *
+ * @param[in] domain host name
+ *
+ * @return OPRT_OK on success, OPRT_NOT_FOUND when the host is not cached.
+ */
+OPERATE_RET tal_net_dns_cache_expire(const char *domain);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TAL_NET_DNS_H__ */
@@ -0,0 +1,126 @@
+/**
+ * @file tal_net_reactor.h
+ * @brief Shared socket event loop on top of tal_net_select.
+ *
+ * Sockets are registered with read, write and error callbacks and an optional
+ * idle timeout. One thread waits for all of them with a single
+ * tal_net_select() and runs the callbacks, so modules that only react to
+ * socket events need no thread and no select loop of their own.
+ *
+ * Callbacks run on the reactor thread one after another and must not block.
+ * They may add, modify and delete any socket, their own included.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#ifndef __TAL_NET_REACTOR_H__
+#define __TAL_NET_REACTOR_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#ifndef TAL_NET_REACTOR_FD_MAX
+#define TAL_NET_REACTOR_FD_MAX 16
+#endif
+
+#ifndef TAL_NET_REACTOR_STACK_SIZE
+#define TAL_NET_REACTOR_STACK_SIZE (4 * 1024)
+#endif
+
+#ifndef TAL_NET_REACTOR_PRIO
+#define TAL_NET_REACTOR_PRIO THREAD_PRIO_2
+#endif
+
+/**
+ * @brief Loopback UDP port of the socket that wakes the reactor thread when
+ * sockets are changed from other threads. 0 disables it, changes are then
+ * picked up within TAL_NET_REACTOR_TICK_MS.
+ */
+#ifndef TAL_NET_REACTOR_WAKE_PORT
+#define TAL_NET_REACTOR_WAKE_PORT 0
+#endif
+
+#ifndef TAL_NET_REACTOR_TICK_MS
+#define TAL_NET_REACTOR_TICK_MS 1000
+#endif
+
+#define TAL_NET_EV_READ    (1 << 0)
+#define TAL_NET_EV_WRITE   (1 << 1)
+#define TAL_NET_EV_ERROR   (1 << 2)
+#define TAL_NET_EV_TIMEOUT (1 << 3)
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef void (*TAL_NET_REACTOR_FD_CB)(int fd, void *arg);
+
+typedef struct {
+    TAL_NET_REACTOR_FD_CB on_read;
+    TAL_NET_REACTOR_FD_CB on_write;
+    TAL_NET_REACTOR_FD_CB on_error;
+    TAL_NET_REACTOR_FD_CB on_timeout; // no read or write for timeout_ms
+    uint32_t timeout_ms;              // 0 for none
+} TAL_NET_REACTOR_CB_T;
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+
+/**
+ * @brief Starts the reactor thread, does nothing when it runs already.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+OPERATE_RET tal_net_reactor_init(void);
+
+/**
+ * @brief Registers a socket.
+ *
+ * @param[in] fd socket
+ * @param[in] events TAL_NET_EV_* to watch, the callbacks of the others
+ * are not called
+ * @param[in] cb callbacks, copied
+ * @param[in] arg passed to the callbacks
+ *
+ * @note Write readiness is reported for as long as the socket can be written,
+ * watch TAL_NET_EV_WRITE only while there is something to send.
+ *
+ * @return OPRT_OK on success, OPRT_EXCEED_UPPER_LIMIT when
+ * TAL_NET_REACTOR_FD_MAX sockets are registered. Others on error, please refer
+ * to tuya_error_code.h
+ */
+OPERATE_RET tal_net_reactor_add(int fd, uint8_t events, const TAL_NET_REACTOR_CB_T *cb, void *arg);
+
+/**
+ * @brief Changes the events watched on a socket.
+ *
+ * @param[in] fd socket
+ * @param[in] events TAL_NET_EV_* to watch
+ *
+ * @return OPRT_OK on success, OPRT_NOT_FOUND when fd is not registered.
+ */
+OPERATE_RET tal_net_reactor_mod(int fd, uint8_t events);
+
+/**
+ * @brief Unregisters a socket, the socket is not closed.
+ *
+ * @param[in] fd socket
+ *
+ * @note Called from another thread while a callback of fd runs, this waits
+ * for the callback to return, so arg may be released afterwards.
+ *
+ * @return OPRT_OK on success, OPRT_NOT_FOUND when fd is not registered.
+ */
+OPERATE_RET tal_net_reactor_del(int fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TAL_NET_REACTOR_H__ */
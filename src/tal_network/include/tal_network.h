@@ -37,6 +37,23 @@ extern "C" {
 /* tuya sdk definition of 255.255.255.255 */
 #define TY_IPADDR_BROADCAST ((uint32_t)0xffffffffUL)
 
+/* vectors taken by one tal_net_sendv/tal_net_recvv call */
+#ifndef TAL_NET_IOV_MAX
+#define TAL_NET_IOV_MAX 16
+#endif
+
+/* without a native sendv/recvv the vectors are copied through a buffer, on the
+ * stack up to this size */
+#ifndef TAL_NET_IOV_STACK_BUF
+#define TAL_NET_IOV_STACK_BUF 256
+#endif
+
+/* one buffer of a scatter-gather send or receive */
+typedef struct {
+    void *iov_base;
+    size_t iov_len;
+} TAL_NET_IOVEC_T;
+
 /**
  * @brief Get error code of network
  *
@@ -285,6 +302,35 @@ int tal_net_accept(const int fd, TUYA_IP_ADDR_T *addr, uint16_t *port);
  */
 TUYA_ERRNO tal_net_recv(const int fd, void *buf, const uint32_t nbytes);
 
+/**
+ * @brief Send data gathered from several buffers
+ *
+ * @param[in] fd: file descriptor
+ * @param[in] iov: buffers, sent in order
+ * @param[in] iovcnt: count of buffers, up to TAL_NET_IOV_MAX
+ *
+ * @note This API is used for sending a header and a payload without joining
+ * them first. The buffers go out as one datagram on a UDP socket.
+ *
+ * @return >0 on num of send, <0 please refer to the error no of the target
+ * system
+ */
+TUYA_ERRNO tal_net_sendv(const int fd, const TAL_NET_IOVEC_T *iov, const int iovcnt);
+
+/**
+ * @brief Receive data scattered into several buffers
+ *
+ * @param[in] fd: file descriptor
+ * @param[in] iov: buffers, filled in order
+ * @param[in] iovcnt: count of buffers, up to TAL_NET_IOV_MAX
+ *
+ * @note This API is used for receiving data from network
+ *
+ * @return >0 on num of recv, <0 please refer to the error no of the target
+ * system
+ */
+TUYA_ERRNO tal_net_recvv(const int fd, const TAL_NET_IOVEC_T *iov, const int iovcnt);
+
 /**
  * @brief Receive data from network with need size
  *
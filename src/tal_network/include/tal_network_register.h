@@ -9,6 +9,7 @@
 #define __TAL_NETWORK_REGISTER_H__
 
 #include "tuya_cloud_types.h"
+#include "tal_network.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -59,6 +60,9 @@ typedef struct {
                               const int optlen);
     OPERATE_RET (*getsockopt)(const int fd, const TUYA_OPT_LEVEL level, const TUYA_OPT_NAME optname, void *optval,
                               int *optlen);
+    // optional, tal_net_sendv/tal_net_recvv copy through one buffer without them
+    TUYA_ERRNO (*sendv)(const int fd, const TAL_NET_IOVEC_T *iov, const int iovcnt);
+    TUYA_ERRNO (*recvv)(const int fd, const TAL_NET_IOVEC_T *iov, const int iovcnt);
 
 } TAL_NETWORK_OPS_T;
 
@@ -87,6 +91,16 @@ TAL_NETWORK_CARD_TYPE_E tal_network_card_get_active_type(void);
 
 TAL_NETWORK_OPS_T *tal_network_get_active_ops(void);
 
+/**
+ * @brief ops of a network card whether it is active or not, e.g. to probe a
+ * standby link
+ *
+ * @param[in] type card type
+ *
+ * @return the ops, NULL when the card is not registered
+ */
+TAL_NETWORK_OPS_T *tal_network_get_ops(TAL_NETWORK_CARD_TYPE_E type);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,296 @@
+/**
+ * @file tal_net_dns.c
+ * @brief Cache of resolved host addresses, see tal_net_dns.h.
+ *
+ * The hosts and their addresses are written to KV as one value whenever an
+ * address changes, the times are kept in RAM only.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#include "tal_api.h"
+#include "tal_net_dns.h"
+
+#if TAL_NET_DNS_CACHE_NUM > 0
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define DNS_CACHE_KEY     "net_dns"
+#define DNS_CACHE_VERSION 1
+
+#define DNS_TTL_MS      ((SYS_TIME_T)TAL_NET_DNS_CACHE_TTL_S * 1000)
+#define DNS_PREFETCH_MS ((SYS_TIME_T)TAL_NET_DNS_PREFETCH_S * 1000)
+#define DNS_STALE_MS    ((SYS_TIME_T)TAL_NET_DNS_STALE_S * 1000)
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    char host[TAL_NET_DNS_HOST_LEN]; // empty for a free slot
+    TUYA_IP_ADDR_T addr;
+} DNS_HOST_T;
+
+typedef struct {
+    DNS_HOST_T h;
+    SYS_TIME_T resolved; // 0 when loaded from KV or expired, the age is unknown then
+    SYS_TIME_T used;
+    BOOL_T prefetch;
+} DNS_ENTRY_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static struct {
+    MUTEX_HANDLE mutex;
+    THREAD_HANDLE prefetch_thrd;
+    TAL_NET_DNS_QUERY_CB query;
+    BOOL_T loaded;
+    DNS_ENTRY_T entries[TAL_NET_DNS_CACHE_NUM];
+} s_dns;
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static void __dns_load(void)
+{
+    uint8_t *buf = NULL;
+    size_t len = 0;
+
+    s_dns.loaded = TRUE;
+#if TAL_NET_DNS_PERSIST
+    if (OPRT_OK != tal_kv_get(DNS_CACHE_KEY, &buf, &len)) {
+        return;
+    }
+    if (len == 1 + TAL_NET_DNS_CACHE_NUM * sizeof(DNS_HOST_T) && DNS_CACHE_VERSION == buf[0]) {
+        for (int i = 0; i < TAL_NET_DNS_CACHE_NUM; i++) {
+            memcpy(&s_dns.entries[i].h, buf + 1 + i * sizeof(DNS_HOST_T), sizeof(DNS_HOST_T));
+            s_dns.entries[i].h.host[TAL_NET_DNS_HOST_LEN - 1] = '\0';
+        }
+    }
+    tal_kv_free(buf);
+#endif
+}
+
+static void __dns_save(void)
+{
+#if TAL_NET_DNS_PERSIST
+    size_t len = 1 + TAL_NET_DNS_CACHE_NUM * sizeof(DNS_HOST_T);
+    uint8_t *buf = tal_malloc(len);
+
+    if (NULL == buf) {
+        return;
+    }
+    buf[0] = DNS_CACHE_VERSION;
+    for (int i = 0; i < TAL_NET_DNS_CACHE_NUM; i++) {
+        memcpy(buf + 1 + i * sizeof(DNS_HOST_T), &s_dns.entries[i].h, sizeof(DNS_HOST_T));
+    }
+    tal_kv_set(DNS_CACHE_KEY, buf, len);
+    tal_free(buf);
+#endif
+}
+
+static OPERATE_RET __dns_init(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    if (NULL == s_dns.mutex) {
+        TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&s_dns.mutex));
+    }
+
+    tal_mutex_lock(s_dns.mutex);
+    if (!s_dns.loaded) {
+        __dns_load();
+    }
+    tal_mutex_unlock(s_dns.mutex);
+
+    return rt;
+}
+
+static DNS_ENTRY_T *__dns_find(const char *domain)
+{
+    for (int i = 0; i < TAL_NET_DNS_CACHE_NUM; i++) {
+        if (0 == strcmp(s_dns.entries[i].h.host, domain)) {
+            return &s_dns.entries[i];
+        }
+    }
+    return NULL;
+}
+
+static void __dns_store(const char *domain, TUYA_IP_ADDR_T *addr, SYS_TIME_T now)
+{
+    BOOL_T changed = FALSE;
+    DNS_ENTRY_T *entry = __dns_find(domain);
+
+    if (NULL == entry) {
+        //! a free slot was never used, so it is taken first
+        entry = &s_dns.entries[0];
+        for (int i = 1; i < TAL_NET_DNS_CACHE_NUM; i++) {
+            if (s_dns.entries[i].used < entry->used) {
+                entry = &s_dns.entries[i];
+            }
+        }
+        memset(entry, 0, sizeof(DNS_ENTRY_T));
+        strcpy(entry->h.host, domain);
+        changed = TRUE;
+    } else if (memcmp(&entry->h.addr, addr, sizeof(TUYA_IP_ADDR_T))) {
+        changed = TRUE;
+    }
+
+    memcpy(&entry->h.addr, addr, sizeof(TUYA_IP_ADDR_T));
+    entry->resolved = now;
+    entry->used = now;
+    entry->prefetch = FALSE;
+    if (changed) {
+        __dns_save();
+    }
+}
+
+static void __dns_prefetch_task(void *arg)
+{
+    char host[TAL_NET_DNS_HOST_LEN];
+    TUYA_IP_ADDR_T addr;
+    DNS_ENTRY_T *entry = NULL;
+
+    for (;;) {
+        tal_mutex_lock(s_dns.mutex);
+        entry = NULL;
+        for (int i = 0; i < TAL_NET_DNS_CACHE_NUM; i++) {
+            if (s_dns.entries[i].prefetch) {
+                entry = &s_dns.entries[i];
+                break;
+            }
+        }
+        if (NULL == entry) {
+            tal_thread_delete(s_dns.prefetch_thrd);
+            s_dns.prefetch_thrd = NULL;
+            tal_mutex_unlock(s_dns.mutex);
+            return;
+        }
+        entry->prefetch = FALSE;
+        strcpy(host, entry->h.host);
+        tal_mutex_unlock(s_dns.mutex);
+
+        if (OPRT_OK == s_dns.query(host, &addr)) {
+            tal_mutex_lock(s_dns.mutex);
+            __dns_store(host, &addr, tal_system_get_millisecond());
+            tal_mutex_unlock(s_dns.mutex);
+        }
+    }
+}
+
+static void __dns_prefetch_start(DNS_ENTRY_T *entry)
+{
+    entry->prefetch = TRUE;
+    if (s_dns.prefetch_thrd) {
+        return;
+    }
+
+    THREAD_CFG_T thrd_param = {0};
+    thrd_param.priority = THREAD_PRIO_3;
+    thrd_param.stackDepth = TAL_NET_DNS_PREFETCH_STACK_SIZE;
+    thrd_param.thrdname = "dns_prefetch";
+    if (OPRT_OK != tal_thread_create_and_start(&s_dns.prefetch_thrd, NULL, NULL, __dns_prefetch_task, NULL,
+                                               &thrd_param)) {
+        s_dns.prefetch_thrd = NULL;
+        entry->prefetch = FALSE;
+    }
+}
+
+/**
+ * @brief Gets the address of a host from the cache, or resolves it.
+ *
+ * @param[in] domain host name
+ * @param[out] addr address
+ * @param[in] query resolves a host that is not cached
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+OPERATE_RET tal_net_dns_cache_get(const char *domain, TUYA_IP_ADDR_T *addr, TAL_NET_DNS_QUERY_CB query)
+{
+    OPERATE_RET rt = OPRT_OK;
+    TUYA_IP_ADDR_T resolved;
+    DNS_ENTRY_T *entry = NULL;
+
+    if ('\0' == domain[0] || strlen(domain) >= TAL_NET_DNS_HOST_LEN) {
+        return query(domain, addr);
+    }
+    TUYA_CALL_ERR_RETURN(__dns_init());
+
+    SYS_TIME_T now = tal_system_get_millisecond();
+
+    tal_mutex_lock(s_dns.mutex);
+    s_dns.query = query;
+    entry = __dns_find(domain);
+    if (entry && entry->resolved && now - entry->resolved < DNS_TTL_MS) {
+        memcpy(addr, &entry->h.addr, sizeof(TUYA_IP_ADDR_T));
+        entry->used = now;
+        if (now - entry->resolved >= DNS_TTL_MS - DNS_PREFETCH_MS && !entry->prefetch) {
+            __dns_prefetch_start(entry);
+        }
+        tal_mutex_unlock(s_dns.mutex);
+        return OPRT_OK;
+    }
+    tal_mutex_unlock(s_dns.mutex);
+
+    rt = query(domain, &resolved);
+
+    tal_mutex_lock(s_dns.mutex);
+    if (OPRT_OK == rt) {
+        __dns_store(domain, &resolved, tal_system_get_millisecond());
+        memcpy(addr, &resolved, sizeof(TUYA_IP_ADDR_T));
+    } else {
+        entry = __dns_find(domain);
+        if (entry && (0 == entry->resolved || now - entry->resolved < DNS_STALE_MS)) {
+            PR_WARN("resolve %s failed %d, use cached address", domain, rt);
+            memcpy(addr, &entry->h.addr, sizeof(TUYA_IP_ADDR_T));
+            entry->used = now;
+            rt = OPRT_OK;
+        }
+    }
+    tal_mutex_unlock(s_dns.mutex);
+
+    return rt;
+}
+
+/**
+ * @brief Makes the next lookup of a host resolve it again, e.g. when its
+ * address could not be connected. The address is still returned when
+ * resolving fails.
+ *
+ * @param[in] domain host name
+ *
+ * @return OPRT_OK on success, OPRT_NOT_FOUND when the host is not cached.
+ */
+OPERATE_RET tal_net_dns_cache_expire(const char *domain)
+{
+    OPERATE_RET rt = OPRT_NOT_FOUND;
+
+    if (NULL == domain || NULL == s_dns.mutex) {
+        return rt;
+    }
+
+    tal_mutex_lock(s_dns.mutex);
+    DNS_ENTRY_T *entry = __dns_find(domain);
+    if (entry) {
+        entry->resolved = 0;
+        rt = OPRT_OK;
+    }
+    tal_mutex_unlock(s_dns.mutex);
+
+    return rt;
+}
+
+#else
+
+OPERATE_RET tal_net_dns_cache_get(const char *domain, TUYA_IP_ADDR_T *addr, TAL_NET_DNS_QUERY_CB query)
+{
+    return query(domain, addr);
+}
+
+OPERATE_RET tal_net_dns_cache_expire(const char *domain)
+{
+    return OPRT_NOT_FOUND;
+}
+
+#endif
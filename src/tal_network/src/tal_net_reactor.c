@@ -0,0 +1,488 @@
+/**
+ * @file tal_net_reactor.c
+ * @brief Shared socket event loop on top of tal_net_select.
+ *
+ * The sockets live in a fixed table. Every round the reactor thread builds
+ * the fd sets from the table, waits in tal_net_select() until an event, the
+ * nearest idle timeout or a wake-up, then calls the callbacks of the ready
+ * sockets with the table unlocked. A slot remembers the events it was armed
+ * with, so a socket added or replaced while the thread waits is not handed
+ * events meant for the previous one.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#include "tal_api.h"
+#include "tal_net_reactor.h"
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define REACTOR_NO_SLOT (-1)
+
+/***********************************************************
+***********************typedef define***********************
+***********************************************************/
+typedef struct {
+    int fd; // -1 when free
+    uint8_t events;
+    uint8_t armed; // events in the fd sets of this round
+    TAL_NET_REACTOR_CB_T cb;
+    void *arg;
+    SYS_TIME_T last_ms; // last read or write event
+} REACTOR_SLOT_T;
+
+typedef struct {
+    MUTEX_HANDLE mutex;
+    THREAD_HANDLE thread;
+    int wake_fd;
+    int busy; // slot whose callbacks run
+    REACTOR_SLOT_T slot[TAL_NET_REACTOR_FD_MAX];
+    TUYA_FD_SET_T rfds;
+    TUYA_FD_SET_T wfds;
+    TUYA_FD_SET_T efds;
+} REACTOR_T;
+
+/***********************************************************
+***********************variable define**********************
+***********************************************************/
+static REACTOR_T *s_reactor = NULL;
+
+/***********************************************************
+***********************function define**********************
+***********************************************************/
+static BOOL_T __reactor_is_self(void)
+{
+    BOOL_T self = FALSE;
+
+    tal_thread_is_self(s_reactor->thread, &self);
+
+    return self;
+}
+
+static void __reactor_wake(void)
+{
+#if TAL_NET_REACTOR_WAKE_PORT > 0
+    if (s_reactor->wake_fd < 0 || __reactor_is_self()) {
+        return;
+    }
+
+    tal_net_send_to(s_reactor->wake_fd, "w", 1, TY_IPADDR_LOOPBACK, TAL_NET_REACTOR_WAKE_PORT);
+#endif
+}
+
+static int __reactor_find(int fd)
+{
+    int i;
+
+    for (i = 0; i < TAL_NET_REACTOR_FD_MAX; i++) {
+        if (s_reactor->slot[i].fd == fd) {
+            return i;
+        }
+    }
+
+    return REACTOR_NO_SLOT;
+}
+
+static uint32_t __reactor_left_ms(REACTOR_SLOT_T *slot, SYS_TIME_T now)
+{
+    SYS_TIME_T elapsed = now - slot->last_ms;
+
+    return (elapsed >= slot->cb.timeout_ms) ? 0 : (uint32_t)(slot->cb.timeout_ms - elapsed);
+}
+
+static BOOL_T __reactor_timed(REACTOR_SLOT_T *slot)
+{
+    return (slot->events & TAL_NET_EV_TIMEOUT) && slot->cb.on_timeout && slot->cb.timeout_ms;
+}
+
+/**
+ * @brief fills the fd sets with the table
+ *
+ * @param[out] wait_ms time to the nearest idle timeout, 0 to wait for events only
+ *
+ * @return highest fd in the sets, -1 for none
+ */
+static int __reactor_arm(uint32_t *wait_ms)
+{
+    REACTOR_SLOT_T *slot = NULL;
+    SYS_TIME_T now = tal_system_get_millisecond();
+    uint32_t left = 0;
+    int maxfd = -1, i;
+
+    tal_net_fd_zero(&s_reactor->rfds);
+    tal_net_fd_zero(&s_reactor->wfds);
+    tal_net_fd_zero(&s_reactor->efds);
+    *wait_ms = (s_reactor->wake_fd < 0) ? TAL_NET_REACTOR_TICK_MS : 0;
+
+    if (s_reactor->wake_fd >= 0) {
+        tal_net_fd_set(s_reactor->wake_fd, &s_reactor->rfds);
+        maxfd = s_reactor->wake_fd;
+    }
+
+    tal_mutex_lock(s_reactor->mutex);
+    for (i = 0; i < TAL_NET_REACTOR_FD_MAX; i++) {
+        slot = &s_reactor->slot[i];
+        slot->armed = 0;
+        if (slot->fd < 0) {
+            continue;
+        }
+
+        if (slot->events & TAL_NET_EV_READ) {
+            tal_net_fd_set(slot->fd, &s_reactor->rfds);
+        }
+        if (slot->events & TAL_NET_EV_WRITE) {
+            tal_net_fd_set(slot->fd, &s_reactor->wfds);
+        }
+        if (slot->events & TAL_NET_EV_ERROR) {
+            tal_net_fd_set(slot->fd, &s_reactor->efds);
+        }
+        slot->armed = slot->events;
+        if (slot->events & (TAL_NET_EV_READ | TAL_NET_EV_WRITE | TAL_NET_EV_ERROR) && slot->fd > maxfd) {
+            maxfd = slot->fd;
+        }
+
+        if (__reactor_timed(slot)) {
+            // select takes 0 as forever, a due timeout polls
+            left = __reactor_left_ms(slot, now);
+            left = left ? left : 1;
+            if (0 == *wait_ms || left < *wait_ms) {
+                *wait_ms = left;
+            }
+        }
+    }
+    tal_mutex_unlock(s_reactor->mutex);
+
+    return maxfd;
+}
+
+static BOOL_T __reactor_slot_alive(int idx, int fd, void *arg)
+{
+    BOOL_T alive = FALSE;
+
+    tal_mutex_lock(s_reactor->mutex);
+    alive = (s_reactor->slot[idx].fd == fd && s_reactor->slot[idx].arg == arg && s_reactor->slot[idx].armed);
+    tal_mutex_unlock(s_reactor->mutex);
+
+    return alive;
+}
+
+static void __reactor_dispatch(int idx, BOOL_T selected)
+{
+    REACTOR_SLOT_T *slot = &s_reactor->slot[idx];
+    TAL_NET_REACTOR_CB_T cb;
+    void *arg = NULL;
+    uint8_t ev = 0;
+    int fd = -1;
+
+    tal_mutex_lock(s_reactor->mutex);
+    if (slot->fd < 0 || 0 == slot->armed) {
+        tal_mutex_unlock(s_reactor->mutex);
+        return;
+    }
+
+    fd = slot->fd;
+    if (selected) {
+        if ((slot->armed & TAL_NET_EV_ERROR) && tal_net_fd_isset(fd, &s_reactor->efds)) {
+            ev |= TAL_NET_EV_ERROR;
+        }
+        if ((slot->armed & TAL_NET_EV_READ) && tal_net_fd_isset(fd, &s_reactor->rfds)) {
+            ev |= TAL_NET_EV_READ;
+        }
+        if ((slot->armed & TAL_NET_EV_WRITE) && tal_net_fd_isset(fd, &s_reactor->wfds)) {
+            ev |= TAL_NET_EV_WRITE;
+        }
+    }
+    if (ev & (TAL_NET_EV_READ | TAL_NET_EV_WRITE)) {
+        slot->last_ms = tal_system_get_millisecond();
+    } else if (__reactor_timed(slot) && 0 == __reactor_left_ms(slot, tal_system_get_millisecond())) {
+        ev |= TAL_NET_EV_TIMEOUT;
+        slot->last_ms = tal_system_get_millisecond();
+    }
+
+    if (0 == ev) {
+        tal_mutex_unlock(s_reactor->mutex);
+        return;
+    }
+
+    cb = slot->cb;
+    arg = slot->arg;
+    s_reactor->busy = idx;
+    tal_mutex_unlock(s_reactor->mutex);
+
+    // every callback may delete or replace the socket
+    if ((ev & TAL_NET_EV_ERROR) && cb.on_error) {
+        cb.on_error(fd, arg);
+    }
+    if ((ev & TAL_NET_EV_READ) && cb.on_read && __reactor_slot_alive(idx, fd, arg)) {
+        cb.on_read(fd, arg);
+    }
+    if ((ev & TAL_NET_EV_WRITE) && cb.on_write && __reactor_slot_alive(idx, fd, arg)) {
+        cb.on_write(fd, arg);
+    }
+    if ((ev & TAL_NET_EV_TIMEOUT) && __reactor_slot_alive(idx, fd, arg)) {
+        cb.on_timeout(fd, arg);
+    }
+
+    tal_mutex_lock(s_reactor->mutex);
+    s_reactor->busy = REACTOR_NO_SLOT;
+    tal_mutex_unlock(s_reactor->mutex);
+}
+
+/**
+ * @brief a socket closed without being deleted fails the whole select, find it
+ * by polling the sockets one by one, report it as an error and drop it
+ */
+static void __reactor_select_err(void)
+{
+    TUYA_FD_SET_T *fds = &s_reactor->rfds;
+    int i, fd;
+
+    for (i = 0; i < TAL_NET_REACTOR_FD_MAX; i++) {
+        tal_mutex_lock(s_reactor->mutex);
+        fd = s_reactor->slot[i].fd;
+        tal_mutex_unlock(s_reactor->mutex);
+        if (fd < 0) {
+            continue;
+        }
+
+        tal_net_fd_zero(fds);
+        tal_net_fd_set(fd, fds);
+        if (tal_net_select(fd + 1, fds, NULL, NULL, 1) >= 0) {
+            continue;
+        }
+
+        PR_ERR("reactor fd %d select err %d", fd, tal_net_get_errno());
+        tal_net_fd_zero(&s_reactor->efds);
+        tal_net_fd_set(fd, &s_reactor->efds);
+        tal_mutex_lock(s_reactor->mutex);
+        s_reactor->slot[i].armed = (s_reactor->slot[i].fd == fd) ? TAL_NET_EV_ERROR : 0;
+        tal_mutex_unlock(s_reactor->mutex);
+        tal_net_fd_zero(&s_reactor->rfds);
+        tal_net_fd_zero(&s_reactor->wfds);
+        __reactor_dispatch(i, TRUE);
+
+        tal_mutex_lock(s_reactor->mutex);
+        if (s_reactor->slot[i].fd == fd) {
+            s_reactor->slot[i].fd = -1;
+        }
+        tal_mutex_unlock(s_reactor->mutex);
+    }
+}
+
+static void __reactor_task(void *args)
+{
+    uint8_t drain[8];
+    uint32_t wait_ms = 0;
+    int maxfd = -1, cnt = 0, i;
+
+    for (;;) {
+        maxfd = __reactor_arm(&wait_ms);
+        if (maxfd < 0) {
+            tal_system_sleep(wait_ms);
+            cnt = 0;
+        } else {
+            cnt = tal_net_select(maxfd + 1, &s_reactor->rfds, &s_reactor->wfds, &s_reactor->efds, wait_ms);
+            if (cnt < 0) {
+                __reactor_select_err();
+                tal_system_sleep(10);
+                continue;
+            }
+        }
+
+        if (cnt > 0 && s_reactor->wake_fd >= 0 && tal_net_fd_isset(s_reactor->wake_fd, &s_reactor->rfds)) {
+            while (tal_net_recv(s_reactor->wake_fd, drain, sizeof(drain)) > 0) {
+            }
+        }
+
+        // without events only the idle timeouts can be due
+        for (i = 0; i < TAL_NET_REACTOR_FD_MAX; i++) {
+            __reactor_dispatch(i, cnt > 0);
+        }
+    }
+}
+
+/**
+ * @brief Starts the reactor thread, does nothing when it runs already.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+OPERATE_RET tal_net_reactor_init(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    int i;
+
+    if (s_reactor) {
+        return OPRT_OK;
+    }
+
+    s_reactor = tal_malloc(sizeof(REACTOR_T));
+    if (NULL == s_reactor) {
+        return OPRT_MALLOC_FAILED;
+    }
+    memset(s_reactor, 0, sizeof(REACTOR_T));
+    s_reactor->wake_fd = -1;
+    s_reactor->busy = REACTOR_NO_SLOT;
+    for (i = 0; i < TAL_NET_REACTOR_FD_MAX; i++) {
+        s_reactor->slot[i].fd = -1;
+    }
+
+    TUYA_CALL_ERR_GOTO(tal_mutex_create_init(&s_reactor->mutex), __ERR);
+
+#if TAL_NET_REACTOR_WAKE_PORT > 0
+    s_reactor->wake_fd = tal_net_socket_create(PROTOCOL_UDP);
+    if (s_reactor->wake_fd >= 0) {
+        if (0 != tal_net_bind(s_reactor->wake_fd, TY_IPADDR_LOOPBACK, TAL_NET_REACTOR_WAKE_PORT)) {
+            PR_WARN("reactor wake port %d bind fail, tick %dms", TAL_NET_REACTOR_WAKE_PORT, TAL_NET_REACTOR_TICK_MS);
+            tal_net_close(s_reactor->wake_fd);
+            s_reactor->wake_fd = -1;
+        } else {
+            tal_net_set_block(s_reactor->wake_fd, FALSE);
+        }
+    }
+#endif
+
+    THREAD_CFG_T thread_cfg = {
+        .priority = TAL_NET_REACTOR_PRIO, .stackDepth = TAL_NET_REACTOR_STACK_SIZE, .thrdname = "net_reactor"};
+    TUYA_CALL_ERR_GOTO(tal_thread_create_and_start(&s_reactor->thread, NULL, NULL, __reactor_task, NULL, &thread_cfg),
+                       __ERR);
+
+    return OPRT_OK;
+
+__ERR:
+    if (s_reactor->wake_fd >= 0) {
+        tal_net_close(s_reactor->wake_fd);
+    }
+    if (s_reactor->mutex) {
+        tal_mutex_release(s_reactor->mutex);
+    }
+    tal_free(s_reactor);
+    s_reactor = NULL;
+
+    return rt;
+}
+
+/**
+ * @brief Registers a socket.
+ *
+ * @param[in] fd socket
+ * @param[in] events TAL_NET_EV_* to watch, the callbacks of the others
+ * are not called
+ * @param[in] cb callbacks, copied
+ * @param[in] arg passed to the callbacks
+ *
+ * @return OPRT_OK on success, OPRT_EXCEED_UPPER_LIMIT when
+ * TAL_NET_REACTOR_FD_MAX sockets are registered. Others on error, please refer
+ * to tuya_error_code.h
+ */
+OPERATE_RET tal_net_reactor_add(int fd, uint8_t events, const TAL_NET_REACTOR_CB_T *cb, void *arg)
+{
+    REACTOR_SLOT_T *slot = NULL;
+    int idx;
+
+    if (fd < 0 || NULL == cb) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (NULL == s_reactor) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    tal_mutex_lock(s_reactor->mutex);
+    // a registered socket is replaced
+    idx = __reactor_find(fd);
+    if (REACTOR_NO_SLOT == idx) {
+        idx = __reactor_find(-1);
+    }
+    if (REACTOR_NO_SLOT == idx) {
+        tal_mutex_unlock(s_reactor->mutex);
+        PR_ERR("reactor full, fd %d", fd);
+        return OPRT_EXCEED_UPPER_LIMIT;
+    }
+
+    slot = &s_reactor->slot[idx];
+    slot->fd = fd;
+    slot->events = events;
+    slot->armed = 0;
+    slot->cb = *cb;
+    slot->arg = arg;
+    slot->last_ms = tal_system_get_millisecond();
+    tal_mutex_unlock(s_reactor->mutex);
+
+    __reactor_wake();
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Changes the events watched on a socket.
+ *
+ * @param[in] fd socket
+ * @param[in] events TAL_NET_EV_* to watch
+ *
+ * @return OPRT_OK on success, OPRT_NOT_FOUND when fd is not registered.
+ */
+OPERATE_RET tal_net_reactor_mod(int fd, uint8_t events)
+{
+    int idx;
+
+    if (NULL == s_reactor || fd < 0) {
+        return OPRT_NOT_FOUND;
+    }
+
+    tal_mutex_lock(s_reactor->mutex);
+    idx = __reactor_find(fd);
+    if (REACTOR_NO_SLOT != idx) {
+        s_reactor->slot[idx].events = events;
+        s_reactor->slot[idx].armed &= events;
+    }
+    tal_mutex_unlock(s_reactor->mutex);
+
+    if (REACTOR_NO_SLOT == idx) {
+        return OPRT_NOT_FOUND;
+    }
+
+    __reactor_wake();
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Unregisters a socket, the socket is not closed.
+ *
+ * @param[in] fd socket
+ *
+ * @return OPRT_OK on success, OPRT_NOT_FOUND when fd is not registered.
+ */
+OPERATE_RET tal_net_reactor_del(int fd)
+{
+    BOOL_T self = FALSE;
+    int idx;
+
+    if (NULL == s_reactor || fd < 0) {
+        return OPRT_NOT_FOUND;
+    }
+
+    self = __reactor_is_self();
+
+    tal_mutex_lock(s_reactor->mutex);
+    idx = __reactor_find(fd);
+    if (REACTOR_NO_SLOT != idx) {
+        s_reactor->slot[idx].fd = -1;
+        s_reactor->slot[idx].armed = 0;
+        while (!self && s_reactor->busy == idx) {
+            tal_mutex_unlock(s_reactor->mutex);
+            tal_system_sleep(1);
+            tal_mutex_lock(s_reactor->mutex);
+        }
+    }
+    tal_mutex_unlock(s_reactor->mutex);
+
+    if (REACTOR_NO_SLOT == idx) {
+        return OPRT_NOT_FOUND;
+    }
+
+    __reactor_wake();
+
+    return OPRT_OK;
+}
@@ -33,6 +33,7 @@
 #include "tal_api.h"
 
 #include "tal_network_register.h"
+#include "tal_net_dns.h"
 
 /***********************************************************
 ************************macro define************************
@@ -441,6 +442,136 @@ TUYA_ERRNO tal_net_recv(const int fd, void *buf, const uint32_t nbytes)
     TAL_NET_EXEC_OP(recv, -1, fd, buf, nbytes);
 }
 
+static int __net_iov_len(const TAL_NET_IOVEC_T *iov, const int iovcnt)
+{
+    int i, len = 0;
+
+    for (i = 0; i < iovcnt; i++) {
+        if (NULL == iov[i].iov_base && iov[i].iov_len) {
+            return -1;
+        }
+        len += iov[i].iov_len;
+    }
+
+    return len;
+}
+
+/**
+ * @brief Send data gathered from several buffers
+ *
+ * @param[in] fd: file descriptor
+ * @param[in] iov: buffers, sent in order
+ * @param[in] iovcnt: count of buffers, up to TAL_NET_IOV_MAX
+ *
+ * @note This API is used for sending a header and a payload without joining
+ * them first. The buffers go out as one datagram on a UDP socket.
+ *
+ * @return >0 on num of send, <0 please refer to the error no of the target
+ * system
+ */
+TUYA_ERRNO tal_net_sendv(const int fd, const TAL_NET_IOVEC_T *iov, const int iovcnt)
+{
+    uint8_t stack_buf[TAL_NET_IOV_STACK_BUF];
+    uint8_t *buf = stack_buf;
+    int len = 0, off = 0, i;
+    TUYA_ERRNO ret = -1;
+
+    if ((fd < 0) || (iov == NULL) || (iovcnt <= 0) || (iovcnt > TAL_NET_IOV_MAX)) {
+        return -3000 + fd;
+    }
+
+    len = __net_iov_len(iov, iovcnt);
+    if (len <= 0) {
+        return -3000 + fd;
+    }
+
+    TAL_NETWORK_OPS_T *ops = tal_network_get_active_ops();
+    if (NULL != ops && ops->sendv) {
+        return ops->sendv(fd, iov, iovcnt);
+    }
+
+    if (1 == iovcnt) {
+        return tal_net_send(fd, iov[0].iov_base, iov[0].iov_len);
+    }
+
+    if (len > (int)SIZEOF(stack_buf)) {
+        buf = tal_malloc(len);
+        if (NULL == buf) {
+            return -1;
+        }
+    }
+    for (i = 0; i < iovcnt; i++) {
+        memcpy(buf + off, iov[i].iov_base, iov[i].iov_len);
+        off += iov[i].iov_len;
+    }
+
+    ret = tal_net_send(fd, buf, len);
+
+    if (buf != stack_buf) {
+        tal_free(buf);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Receive data scattered into several buffers
+ *
+ * @param[in] fd: file descriptor
+ * @param[in] iov: buffers, filled in order
+ * @param[in] iovcnt: count of buffers, up to TAL_NET_IOV_MAX
+ *
+ * @note This API is used for receiving data from network
+ *
+ * @return >0 on num of recv, <0 please refer to the error no of the target
+ * system
+ */
+TUYA_ERRNO tal_net_recvv(const int fd, const TAL_NET_IOVEC_T *iov, const int iovcnt)
+{
+    uint8_t stack_buf[TAL_NET_IOV_STACK_BUF];
+    uint8_t *buf = stack_buf;
+    int len = 0, off = 0, n = 0, i;
+    TUYA_ERRNO ret = -1;
+
+    if ((fd < 0) || (iov == NULL) || (iovcnt <= 0) || (iovcnt > TAL_NET_IOV_MAX)) {
+        return -3000 + fd;
+    }
+
+    len = __net_iov_len(iov, iovcnt);
+    if (len <= 0) {
+        return -3000 + fd;
+    }
+
+    TAL_NETWORK_OPS_T *ops = tal_network_get_active_ops();
+    if (NULL != ops && ops->recvv) {
+        return ops->recvv(fd, iov, iovcnt);
+    }
+
+    if (1 == iovcnt) {
+        return tal_net_recv(fd, iov[0].iov_base, iov[0].iov_len);
+    }
+
+    if (len > (int)SIZEOF(stack_buf)) {
+        buf = tal_malloc(len);
+        if (NULL == buf) {
+            return -1;
+        }
+    }
+
+    ret = tal_net_recv(fd, buf, len);
+    for (i = 0; i < iovcnt && off < ret; i++) {
+        n = ((size_t)(ret - off) < iov[i].iov_len) ? (ret - off) : (int)iov[i].iov_len;
+        memcpy(iov[i].iov_base, buf + off, n);
+        off += n;
+    }
+
+    if (buf != stack_buf) {
+        tal_free(buf);
+    }
+
+    return ret;
+}
+
 /**
  * @brief Receive data from network with need size
  *
@@ -624,13 +755,19 @@ OPERATE_RET tal_net_set_broadcast(const int fd)
     TAL_NET_EXEC_OP(set_broadcast, OPRT_COM_ERROR, fd);
 }
 
+static OPERATE_RET __net_gethostbyname(const char *domain, TUYA_IP_ADDR_T *addr)
+{
+    TAL_NET_EXEC_OP(gethostbyname, OPRT_COM_ERROR, domain, addr);
+}
+
 /**
  * @brief Get address information by domain
  *
  * @param[in] domain: domain information
  * @param[in] addr: address information
  *
- * @note This API is used for getting address information by domain.
+ * @note This API is used for getting address information by domain, the
+ * addresses are cached as described in tal_net_dns.h.
  *
  * @return OPRT_OK on success. Others on error, please refer to
  * tuya_error_code.h
@@ -641,7 +778,7 @@ OPERATE_RET tal_net_gethostbyname(const char *domain, TUYA_IP_ADDR_T *addr)
         return -2;
     }
 
-    TAL_NET_EXEC_OP(gethostbyname, OPRT_COM_ERROR, domain, addr);
+    return tal_net_dns_cache_get(domain, addr, __net_gethostbyname);
 }
 
 /**
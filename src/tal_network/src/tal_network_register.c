@@ -97,3 +97,12 @@ TAL_NETWORK_OPS_T *tal_network_get_active_ops(void)
 
     return &card->ops;
 }
+
+TAL_NETWORK_OPS_T *tal_network_get_ops(TAL_NETWORK_CARD_TYPE_E type)
+{
+    if (type >= TAL_NET_TYPE_MAX || NULL == tal_network_card_manager.active_card[type]) {
+        return NULL;
+    }
+
+    return &tal_network_card_manager.active_card[type]->ops;
+}
@@ -55,13 +55,19 @@
 #include <sys/time.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <sys/uio.h>
 
 #define ENABLE_BIND_INTERFACE 1
+#define NET_WRITEV            writev
+#define NET_READV             readv
 
 #elif defined(ENABLE_LIBLWIP) && (ENABLE_LIBLWIP == 1)
 #include "lwip/netdb.h"
 #include "lwip/dns.h"
 #include "lwip/errno.h"
+
+#define NET_WRITEV lwip_writev
+#define NET_READV  lwip_readv
 #endif
 
 typedef struct NETWORK_ERRNO_TRANS {
@@ -575,6 +581,35 @@ TUYA_ERRNO tal_net_posix_send(const int fd, const void *buf, const uint32_t nbyt
     return ret;
 }
 
+/**
+ * @brief Send data gathered from several buffers
+ *
+ * @param[in] fd: file descriptor
+ * @param[in] iov: buffers, sent in order
+ * @param[in] iovcnt: count of buffers
+ *
+ * @note This API is used for sending data to network
+ *
+ * @return >0 on num of send, <0 please refer to the error no of the target
+ * system
+ */
+TUYA_ERRNO tal_net_posix_sendv(const int fd, const TAL_NET_IOVEC_T *iov, const int iovcnt)
+{
+    struct iovec vec[TAL_NET_IOV_MAX];
+    int i;
+
+    if ((fd < 0) || (iov == NULL) || (iovcnt <= 0) || (iovcnt > TAL_NET_IOV_MAX)) {
+        return -3000 + fd;
+    }
+
+    for (i = 0; i < iovcnt; i++) {
+        vec[i].iov_base = iov[i].iov_base;
+        vec[i].iov_len = iov[i].iov_len;
+    }
+
+    return NET_WRITEV(fd, vec, iovcnt);
+}
+
 /**
  * @brief Send data to specified server
  *
@@ -642,6 +677,35 @@ TUYA_ERRNO tal_net_posix_recv(const int fd, void *buf, const uint32_t nbytes)
     return ret;
 }
 
+/**
+ * @brief Receive data scattered into several buffers
+ *
+ * @param[in] fd: file descriptor
+ * @param[in] iov: buffers, filled in order
+ * @param[in] iovcnt: count of buffers
+ *
+ * @note This API is used for receiving data from network
+ *
+ * @return >0 on num of recv, <0 please refer to the error no of the target
+ * system
+ */
+TUYA_ERRNO tal_net_posix_recvv(const int fd, const TAL_NET_IOVEC_T *iov, const int iovcnt)
+{
+    struct iovec vec[TAL_NET_IOV_MAX];
+    int i;
+
+    if ((fd < 0) || (iov == NULL) || (iovcnt <= 0) || (iovcnt > TAL_NET_IOV_MAX)) {
+        return -3000 + fd;
+    }
+
+    for (i = 0; i < iovcnt; i++) {
+        vec[i].iov_base = iov[i].iov_base;
+        vec[i].iov_len = iov[i].iov_len;
+    }
+
+    return NET_READV(fd, vec, iovcnt);
+}
+
 /**
  * @brief Receive data from network with need size
  *
@@ -1072,6 +1136,8 @@ TAL_NETWORK_CARD_T tal_network_card_posix = {
             .addr2str = tal_net_posix_addr2str,
             .setsockopt = tal_net_posix_setsockopt,
             .getsockopt = tal_net_posix_getsockopt,
+            .sendv = tal_net_posix_sendv,
+            .recvv = tal_net_posix_recvv,
         },
 };
 
@@ -359,6 +359,20 @@ OPERATE_RET tal_sha256_mac_update(tal_hash_mac_context_t *hmac_handle, const uin
  */
 OPERATE_RET tal_sha256_mac_finish(tal_hash_mac_context_t *hmac_handle, uint8_t *output);
 
+/**
+ * @brief This function prepares a sha256 mac context for a new
+ *                 calculation with the key of the last starts.
+ *
+ * @param[in] hmac_handle: The context to use. This must be started.
+ *
+ * @note This API is used to sign many messages with one key, the key is not
+ * processed again.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_sha256_mac_reset(tal_hash_mac_context_t *hmac_handle);
+
 /**
  * @brief          This function calculates the SHA-256 MAC
  *                 checksum of a buffer.
@@ -450,6 +464,20 @@ OPERATE_RET tal_sha1_mac_update(tal_hash_mac_context_t *hmac_handle, const uint8
  */
 OPERATE_RET tal_sha1_mac_finish(tal_hash_mac_context_t *hmac_handle, uint8_t *output);
 
+/**
+ * @brief This function prepares a sha1 mac context for a new
+ *                 calculation with the key of the last starts.
+ *
+ * @param[in] hmac_handle: The context to use. This must be started.
+ *
+ * @note This API is used to sign many messages with one key, the key is not
+ * processed again.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_sha1_mac_reset(tal_hash_mac_context_t *hmac_handle);
+
 /**
  * @brief          This function calculates the SHA-256 MAC
  *                 checksum of a buffer.
@@ -37,6 +37,30 @@ typedef enum {
     SYMMETRY_ENCRYPT = 1,
 } TAL_SYMMETRY_CRYPT_MODE;
 
+// keyed contexts kept by the one-shot *_raw functions, so a key used again is
+// not expanded again, 0 expands the key on every call
+#ifndef TAL_AES_KEY_CACHE_NUM
+#define TAL_AES_KEY_CACHE_NUM 4
+#endif
+
+// length of a PKCS7 padded CBC ciphertext
+#define TAL_AES_CBC_PKCS7_LEN(len) (((len) / 16 + 1) * 16)
+
+/**
+ * @brief State of a chunked AES-CBC operation with PKCS7 padding.
+ *
+ * Only one block is buffered, the data itself stays in the buffers of the
+ * caller. On decryption the last block is held back until
+ * tal_aes_cbc_stream_final() so that the padding can be stripped.
+ */
+typedef struct {
+    TKL_SYMMETRY_HANDLE ctx;
+    int32_t mode;
+    uint8_t iv[16];
+    uint8_t block[16];
+    uint8_t block_len;
+} TAL_AES_CBC_STREAM_T;
+
 /**
  * @brief This function Create&initializes a aes context.
  *
@@ -316,6 +340,37 @@ uint32_t tal_pkcs7padding_buffer(uint8_t *p_buffer, uint32_t length);
  */
 int32_t tal_aes_get_actual_length(uint8_t *dec_data, uint32_t dec_data_len);
 
+/**
+ * @brief Pads data with PKCS7 and encodes it using AES-128 ECB mode into a
+ * buffer of the caller.
+ *
+ * @param data Pointer to the input data to be encoded.
+ * @param len Length of the input data.
+ * @param ec_data The output buffer of TAL_AES_CBC_PKCS7_LEN(len) bytes, it may
+ * be data.
+ * @param ec_len The length of the encoded data.
+ * @param key Pointer to the AES-128 key.
+ *
+ * @return OPERATE_RET Returns the status of the encoding operation.
+ */
+OPERATE_RET tal_aes128_ecb_encode_buf(uint8_t *data, uint32_t len, uint8_t *ec_data, uint32_t *ec_len, uint8_t *key);
+
+/**
+ * @brief Pads data with PKCS7 and encrypts it using AES-128 in CBC mode into a
+ * buffer of the caller.
+ *
+ * @param data The input data to be encrypted.
+ * @param len The length of the input data.
+ * @param key The encryption key.
+ * @param iv The initialization vector (IV), updated as by tal_aes_crypt_cbc().
+ * @param ec_data The output buffer of TAL_AES_CBC_PKCS7_LEN(len) bytes, it may
+ * be data.
+ * @param ec_len The length of the encrypted data.
+ * @return The result of the encryption operation.
+ */
+OPERATE_RET tal_aes128_cbc_encode_buf(uint8_t *data, uint32_t len, uint8_t *key, uint8_t *iv, uint8_t *ec_data,
+                                      uint32_t *ec_len);
+
 /**
  * @brief Encrypts data using AES-128 ECB mode.
  *
@@ -395,6 +450,70 @@ OPERATE_RET tal_aes128_cbc_encode(uint8_t *data, uint32_t len, uint8_t *key, uin
 OPERATE_RET tal_aes128_cbc_decode(uint8_t *data, uint32_t len, uint8_t *key, uint8_t *iv, uint8_t **dec_data,
                                   uint32_t *dec_len);
 
+/**
+ * @brief Starts a chunked AES-CBC encryption or decryption with PKCS7
+ * padding.
+ *
+ * The output is the same as tal_aes128_cbc_encode() and the input of
+ * tal_aes128_cbc_decode() for 128 bit keys, without allocating a buffer of the
+ * whole data.
+ *
+ * @param stream The stream state.
+ * @param mode SYMMETRY_ENCRYPT or SYMMETRY_DECRYPT.
+ * @param key The key.
+ * @param keybits 128, 192 or 256.
+ * @param iv The initialization vector, copied into the stream.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_aes_cbc_stream_init(TAL_AES_CBC_STREAM_T *stream, int32_t mode, const uint8_t *key,
+                                    uint32_t keybits, const uint8_t iv[16]);
+
+/**
+ * @brief Feeds a chunk of data into a stream.
+ *
+ * Whole blocks are written to output, the rest is kept for the next call.
+ * output may be the same buffer as input.
+ *
+ * @param stream The stream state.
+ * @param input The chunk.
+ * @param length The length of the chunk.
+ * @param output Receives up to length + 15 bytes.
+ * @param out_len Set to the number of bytes written to output.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_aes_cbc_stream_update(TAL_AES_CBC_STREAM_T *stream, const uint8_t *input, size_t length,
+                                      uint8_t *output, size_t *out_len);
+
+/**
+ * @brief Finishes a stream and releases its AES context.
+ *
+ * Encryption writes the padded last block, decryption the last block without
+ * its padding.
+ *
+ * @param stream The stream state.
+ * @param output Receives up to 16 bytes.
+ * @param out_len Set to the number of bytes written to output.
+ *
+ * @return OPRT_OK on success, OPRT_COM_ERROR when the decrypted padding is
+ * invalid or the ciphertext is not a whole number of blocks. Others on error,
+ * please refer to tuya_error_code.h
+ */
+OPERATE_RET tal_aes_cbc_stream_final(TAL_AES_CBC_STREAM_T *stream, uint8_t *output, size_t *out_len);
+
+/**
+ * @brief Releases the AES context of a stream that is abandoned before
+ * tal_aes_cbc_stream_final().
+ *
+ * @param stream The stream state.
+ *
+ * @return none
+ */
+void tal_aes_cbc_stream_deinit(TAL_AES_CBC_STREAM_T *stream);
+
 /**
  * @brief Frees the memory allocated for AES data.
  *
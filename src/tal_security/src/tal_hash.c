@@ -574,6 +574,28 @@ exit:
 
     return ret;
 }
+/**
+ * @brief This function prepares a sha256 mac context for a new
+ *                 calculation with the key of the last starts.
+ *
+ * @param[in] hmac_handle: The context to use. This must be started.
+ *
+ * @note This API is used to sign many messages with one key, the key is not
+ * processed again.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_sha256_mac_reset(tal_hash_mac_context_t *hmac_handle)
+{
+    OPERATE_RET ret = OPRT_OK;
+
+    if ((ret = tal_sha256_starts_ret(hmac_handle->ctx, 0)) != OPRT_OK) {
+        return ret;
+    }
+
+    return tal_sha256_update_ret(hmac_handle->ctx, hmac_handle->ipad, 64);
+}
 /**
  * @brief          This function calculates the SHA-256 MAC
  *                 checksum of a buffer.
@@ -783,6 +805,28 @@ exit:
 
     return ret;
 }
+/**
+ * @brief This function prepares a sha1 mac context for a new
+ *                 calculation with the key of the last starts.
+ *
+ * @param[in] hmac_handle: The context to use. This must be started.
+ *
+ * @note This API is used to sign many messages with one key, the key is not
+ * processed again.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_sha1_mac_reset(tal_hash_mac_context_t *hmac_handle)
+{
+    OPERATE_RET ret = OPRT_OK;
+
+    if ((ret = tal_sha1_starts_ret(hmac_handle->ctx)) != OPRT_OK) {
+        return ret;
+    }
+
+    return tal_sha1_update_ret(hmac_handle->ctx, hmac_handle->ipad, 64);
+}
 /**
  * @brief          This function calculates the SHA-256 MAC
  *                 checksum of a buffer.
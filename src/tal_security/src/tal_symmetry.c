@@ -15,6 +15,20 @@
 #include "tal_symmetry.h"
 #include "tal_log.h"
 #include "tal_memory.h"
+#include "tal_system.h"
+
+// Keyed context kept between the one-shot calls below, most callers use one key many times
+typedef struct {
+    TKL_SYMMETRY_HANDLE ctx;
+    uint8_t key[32];
+    uint32_t keybits; // 0 while no key is set
+    int32_t mode;
+    bool busy;
+    uint32_t used;
+} AES_KEY_CACHE_T;
+
+static AES_KEY_CACHE_T s_aes_key_cache[TAL_AES_KEY_CACHE_NUM > 0 ? TAL_AES_KEY_CACHE_NUM : 1];
+static uint32_t s_aes_key_tick = 0;
 
 /**
  * @brief This function Create&initializes a aes context.
@@ -214,6 +228,111 @@ exit:
     return (ret);
 }
 
+/**
+ * @brief Gets a context with the key set from the key cache, a cached context
+ * with the same key and mode is used without setting the key again.
+ *
+ * @param[in] key: the key
+ * @param[in] keybits: 128, 192 or 256
+ * @param[in] mode: SYMMETRY_ENCRYPT or SYMMETRY_DECRYPT
+ * @param[out] ctx: the context, give it back with __aes_ctx_put()
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+static OPERATE_RET __aes_ctx_get(uint8_t *key, uint32_t keybits, int32_t mode, TKL_SYMMETRY_HANDLE *ctx)
+{
+    OPERATE_RET ret = OPRT_OK;
+    AES_KEY_CACHE_T *entry = NULL;
+    AES_KEY_CACHE_T *victim = NULL;
+    bool hit = false;
+    uint32_t i;
+
+    TAL_ENTER_CRITICAL();
+    for (i = 0; i < TAL_AES_KEY_CACHE_NUM; i++) {
+        AES_KEY_CACHE_T *cache = &s_aes_key_cache[i];
+        if (cache->busy) {
+            continue;
+        }
+        if (cache->keybits == keybits && cache->mode == mode && 0 == memcmp(cache->key, key, keybits / 8)) {
+            entry = cache;
+            hit = true;
+            break;
+        }
+        if (NULL == victim || cache->used < victim->used) {
+            victim = cache;
+        }
+    }
+    if (NULL == entry) {
+        entry = victim;
+    }
+    if (entry) {
+        entry->busy = true;
+        entry->used = ++s_aes_key_tick;
+        if (!hit) {
+            entry->keybits = 0;
+        }
+    }
+    TAL_EXIT_CRITICAL();
+
+    if (hit) {
+        *ctx = entry->ctx;
+        return OPRT_OK;
+    }
+
+    //! entry is NULL when every cached context is in use by other threads, this call then gets one of its own
+    TKL_SYMMETRY_HANDLE new_ctx = entry ? entry->ctx : NULL;
+    if (NULL == new_ctx) {
+        ret = tal_aes_create_init(&new_ctx);
+    }
+    if (OPRT_OK == ret) {
+        ret = (SYMMETRY_ENCRYPT == mode) ? tal_aes_setkey_enc(new_ctx, key, keybits)
+                                         : tal_aes_setkey_dec(new_ctx, key, keybits);
+    }
+    if (entry) {
+        entry->ctx = new_ctx;
+        if (OPRT_OK == ret) {
+            memcpy(entry->key, key, keybits / 8);
+            entry->mode = mode;
+            entry->keybits = keybits;
+        } else {
+            entry->busy = false;
+        }
+    } else if (OPRT_OK != ret && new_ctx) {
+        tal_aes_free(new_ctx);
+    }
+    if (OPRT_OK == ret) {
+        *ctx = new_ctx;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Gives back a context of __aes_ctx_get().
+ *
+ * @param[in] ctx: the context
+ */
+static void __aes_ctx_put(TKL_SYMMETRY_HANDLE ctx)
+{
+    bool cached = false;
+    uint32_t i;
+
+    TAL_ENTER_CRITICAL();
+    for (i = 0; i < TAL_AES_KEY_CACHE_NUM; i++) {
+        if (s_aes_key_cache[i].busy && s_aes_key_cache[i].ctx == ctx) {
+            s_aes_key_cache[i].busy = false;
+            cached = true;
+            break;
+        }
+    }
+    TAL_EXIT_CRITICAL();
+
+    if (!cached) {
+        tal_aes_free(ctx);
+    }
+}
+
 /**
  * @brief Encodes data using AES-128 ECB mode.
  *
@@ -232,22 +351,12 @@ OPERATE_RET tal_aes128_ecb_encode_raw(uint8_t *data, size_t len, uint8_t *ec_dat
     OPERATE_RET ret;
     TKL_SYMMETRY_HANDLE ctx = NULL;
 
-    if ((ret = tal_aes_create_init(&ctx)) != OPRT_OK) {
-        goto exit;
-    }
-
-    if ((ret = tal_aes_setkey_enc(ctx, key, 128)) != OPRT_OK) {
-        goto exit;
-    }
-
-    if ((ret = tal_aes_crypt_ecb(ctx, SYMMETRY_ENCRYPT, len, data, ec_data)) != OPRT_OK) {
-        goto exit;
+    if ((ret = __aes_ctx_get(key, 128, SYMMETRY_ENCRYPT, &ctx)) != OPRT_OK) {
+        return ret;
     }
 
-exit:
-    if (ctx) {
-        ret = tal_aes_free(ctx);
-    }
+    ret = tal_aes_crypt_ecb(ctx, SYMMETRY_ENCRYPT, len, data, ec_data);
+    __aes_ctx_put(ctx);
 
     return (ret);
 }
@@ -272,22 +381,12 @@ OPERATE_RET tal_aes128_ecb_decode_raw(uint8_t *data, size_t len, uint8_t *dec_da
     OPERATE_RET ret;
     TKL_SYMMETRY_HANDLE ctx = NULL;
 
-    if ((ret = tal_aes_create_init(&ctx)) != OPRT_OK) {
-        goto exit;
-    }
-
-    if ((ret = tal_aes_setkey_dec(ctx, key, 128)) != OPRT_OK) {
-        goto exit;
-    }
-
-    if ((ret = tal_aes_crypt_ecb(ctx, SYMMETRY_DECRYPT, len, data, dec_data)) != OPRT_OK) {
-        goto exit;
+    if ((ret = __aes_ctx_get(key, 128, SYMMETRY_DECRYPT, &ctx)) != OPRT_OK) {
+        return ret;
     }
 
-exit:
-    if (ctx) {
-        ret = tal_aes_free(ctx);
-    }
+    ret = tal_aes_crypt_ecb(ctx, SYMMETRY_DECRYPT, len, data, dec_data);
+    __aes_ctx_put(ctx);
 
     return (ret);
 }
@@ -312,22 +411,12 @@ OPERATE_RET tal_aes128_cbc_encode_raw(uint8_t *data, size_t len, uint8_t *key, u
     OPERATE_RET ret;
     TKL_SYMMETRY_HANDLE ctx = NULL;
 
-    if ((ret = tal_aes_create_init(&ctx)) != OPRT_OK) {
-        goto exit;
-    }
-
-    if ((ret = tal_aes_setkey_enc(ctx, key, 128)) != OPRT_OK) {
-        goto exit;
-    }
-
-    if ((ret = tal_aes_crypt_cbc(ctx, SYMMETRY_ENCRYPT, len, iv, data, ec_data)) != OPRT_OK) {
-        goto exit;
+    if ((ret = __aes_ctx_get(key, 128, SYMMETRY_ENCRYPT, &ctx)) != OPRT_OK) {
+        return ret;
     }
 
-exit:
-    if (ctx) {
-        ret = tal_aes_free(ctx);
-    }
+    ret = tal_aes_crypt_cbc(ctx, SYMMETRY_ENCRYPT, len, iv, data, ec_data);
+    __aes_ctx_put(ctx);
 
     return (ret);
 }
@@ -352,22 +441,12 @@ OPERATE_RET tal_aes128_cbc_decode_raw(uint8_t *data, size_t len, uint8_t *key, u
     OPERATE_RET ret;
     TKL_SYMMETRY_HANDLE ctx = NULL;
 
-    if ((ret = tal_aes_create_init(&ctx)) != OPRT_OK) {
-        goto exit;
-    }
-
-    if ((ret = tal_aes_setkey_dec(ctx, key, 128)) != OPRT_OK) {
-        goto exit;
-    }
-
-    if ((ret = tal_aes_crypt_cbc(ctx, SYMMETRY_DECRYPT, len, iv, data, dec_data)) != OPRT_OK) {
-        goto exit;
+    if ((ret = __aes_ctx_get(key, 128, SYMMETRY_DECRYPT, &ctx)) != OPRT_OK) {
+        return ret;
     }
 
-exit:
-    if (ctx) {
-        ret = tal_aes_free(ctx);
-    }
+    ret = tal_aes_crypt_cbc(ctx, SYMMETRY_DECRYPT, len, iv, data, dec_data);
+    __aes_ctx_put(ctx);
 
     return (ret);
 }
@@ -391,22 +470,12 @@ OPERATE_RET tal_aes256_cbc_encode_raw(uint8_t *data, size_t len, uint8_t *key, u
     OPERATE_RET ret;
     TKL_SYMMETRY_HANDLE ctx = NULL;
 
-    if ((ret = tal_aes_create_init(&ctx)) != OPRT_OK) {
-        goto exit;
-    }
-
-    if ((ret = tal_aes_setkey_enc(ctx, key, 256)) != OPRT_OK) {
-        goto exit;
-    }
-
-    if ((ret = tal_aes_crypt_cbc(ctx, SYMMETRY_ENCRYPT, len, iv, data, ec_data)) != OPRT_OK) {
-        goto exit;
+    if ((ret = __aes_ctx_get(key, 256, SYMMETRY_ENCRYPT, &ctx)) != OPRT_OK) {
+        return ret;
     }
 
-exit:
-    if (ctx) {
-        ret = tal_aes_free(ctx);
-    }
+    ret = tal_aes_crypt_cbc(ctx, SYMMETRY_ENCRYPT, len, iv, data, ec_data);
+    __aes_ctx_put(ctx);
 
     return (ret);
 }
@@ -429,22 +498,12 @@ OPERATE_RET tal_aes256_cbc_decode_raw(uint8_t *data, size_t len, uint8_t *key, u
     OPERATE_RET ret;
     TKL_SYMMETRY_HANDLE ctx = NULL;
 
-    if ((ret = tal_aes_create_init(&ctx)) != OPRT_OK) {
-        goto exit;
-    }
-
-    if ((ret = tal_aes_setkey_dec(ctx, key, 256)) != OPRT_OK) {
-        goto exit;
+    if ((ret = __aes_ctx_get(key, 256, SYMMETRY_DECRYPT, &ctx)) != OPRT_OK) {
+        return ret;
     }
 
-    if ((ret = tal_aes_crypt_cbc(ctx, SYMMETRY_DECRYPT, len, iv, data, dec_data)) != OPRT_OK) {
-        goto exit;
-    }
-
-exit:
-    if (ctx) {
-        ret = tal_aes_free(ctx);
-    }
+    ret = tal_aes_crypt_cbc(ctx, SYMMETRY_DECRYPT, len, iv, data, dec_data);
+    __aes_ctx_put(ctx);
 
     return (ret);
 }
@@ -471,22 +530,12 @@ OPERATE_RET tal_aes256_ctr_raw(uint8_t *input, size_t len, uint8_t *key, size_t
     OPERATE_RET ret;
     TKL_SYMMETRY_HANDLE ctx = NULL;
 
-    if ((ret = tal_aes_create_init(&ctx)) != OPRT_OK) {
-        goto exit;
-    }
-
-    if ((ret = tal_aes_setkey_enc(ctx, key, 256)) != OPRT_OK) {
-        goto exit;
-    }
-
-    if ((ret = tal_aes_crypt_ctr(ctx, len, nc_off, nonce_counter, stream_block, input, output)) != OPRT_OK) {
-        goto exit;
+    if ((ret = __aes_ctx_get(key, 256, SYMMETRY_ENCRYPT, &ctx)) != OPRT_OK) {
+        return ret;
     }
 
-exit:
-    if (ctx) {
-        ret = tal_aes_free(ctx);
-    }
+    ret = tal_aes_crypt_ctr(ctx, len, nc_off, nonce_counter, stream_block, input, output);
+    __aes_ctx_put(ctx);
 
     return (ret);
 }
@@ -556,6 +605,61 @@ int32_t tal_aes_get_actual_length(uint8_t *dec_data, uint32_t dec_data_len)
     return dec_data_len - lastdata_val;
 }
 
+/**
+ * @brief Pads data with PKCS7 and encodes it using AES-128 ECB mode into a
+ * buffer of the caller.
+ *
+ * @param data Pointer to the input data to be encoded.
+ * @param len Length of the input data.
+ * @param ec_data The output buffer of TAL_AES_CBC_PKCS7_LEN(len) bytes, it may
+ * be data.
+ * @param ec_len The length of the encoded data.
+ * @param key Pointer to the AES-128 key.
+ *
+ * @return OPERATE_RET Returns the status of the encoding operation.
+ */
+OPERATE_RET tal_aes128_ecb_encode_buf(uint8_t *data, uint32_t len, uint8_t *ec_data, uint32_t *ec_len, uint8_t *key)
+{
+    if (NULL == data || NULL == key || NULL == ec_data || NULL == ec_len || 0 == len) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (ec_data != data) {
+        memmove(ec_data, data, len);
+    }
+    *ec_len = __Add_Pkcs(ec_data, len);
+
+    return tal_aes128_ecb_encode_raw(ec_data, *ec_len, ec_data, key);
+}
+
+/**
+ * @brief Pads data with PKCS7 and encrypts it using AES-128 in CBC mode into a
+ * buffer of the caller.
+ *
+ * @param data The input data to be encrypted.
+ * @param len The length of the input data.
+ * @param key The encryption key.
+ * @param iv The initialization vector (IV), updated as by tal_aes_crypt_cbc().
+ * @param ec_data The output buffer of TAL_AES_CBC_PKCS7_LEN(len) bytes, it may
+ * be data.
+ * @param ec_len The length of the encrypted data.
+ * @return The result of the encryption operation.
+ */
+OPERATE_RET tal_aes128_cbc_encode_buf(uint8_t *data, uint32_t len, uint8_t *key, uint8_t *iv, uint8_t *ec_data,
+                                      uint32_t *ec_len)
+{
+    if (NULL == data || 0 == len || NULL == key || NULL == iv || NULL == ec_data || NULL == ec_len) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (ec_data != data) {
+        memmove(ec_data, data, len);
+    }
+    *ec_len = __Add_Pkcs(ec_data, len);
+
+    return tal_aes128_cbc_encode_raw(ec_data, *ec_len, key, iv, ec_data);
+}
+
 /**
  * @brief Encodes data using AES-128 ECB mode.
  *
@@ -580,11 +684,7 @@ OPERATE_RET tal_aes128_ecb_encode(uint8_t *data, uint32_t len, uint8_t **ec_data
         return OPRT_MALLOC_FAILED;
     }
 
-    memcpy(*ec_data, data, len);
-    uint32_t pkcs7Len = __Add_Pkcs(*ec_data, len);
-    *ec_len = pkcs7Len;
-
-    OPERATE_RET ret = tal_aes128_ecb_encode_raw(*ec_data, pkcs7Len, *ec_data, key);
+    OPERATE_RET ret = tal_aes128_ecb_encode_buf(data, len, *ec_data, ec_len, key);
     if (ret != OPRT_OK) {
         tal_free(*ec_data);
         *ec_data = NULL;
@@ -656,11 +756,8 @@ OPERATE_RET tal_aes128_cbc_encode(uint8_t *data, uint32_t len, uint8_t *key, uin
     if (NULL == *ec_data) {
         return OPRT_MALLOC_FAILED;
     }
-    memcpy(*ec_data, data, len);
-    uint32_t pkcs7Len = __Add_Pkcs(*ec_data, len);
-    *ec_len = pkcs7Len;
 
-    OPERATE_RET ret = tal_aes128_cbc_encode_raw(*ec_data, pkcs7Len, key, iv, *ec_data);
+    OPERATE_RET ret = tal_aes128_cbc_encode_buf(data, len, key, iv, *ec_data, ec_len);
     if (ret != OPRT_OK) {
         tal_free(*ec_data);
         *ec_data = NULL;
@@ -710,6 +807,192 @@ OPERATE_RET tal_aes128_cbc_decode(uint8_t *data, uint32_t len, uint8_t *key, uin
     return OPRT_OK;
 }
 
+/**
+ * @brief Starts a chunked AES-CBC encryption or decryption with PKCS7
+ * padding.
+ *
+ * @param stream The stream state.
+ * @param mode SYMMETRY_ENCRYPT or SYMMETRY_DECRYPT.
+ * @param key The key.
+ * @param keybits 128, 192 or 256.
+ * @param iv The initialization vector, copied into the stream.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_aes_cbc_stream_init(TAL_AES_CBC_STREAM_T *stream, int32_t mode, const uint8_t *key,
+                                    uint32_t keybits, const uint8_t iv[16])
+{
+    OPERATE_RET ret;
+
+    if (NULL == stream || NULL == key || NULL == iv) {
+        return OPRT_INVALID_PARM;
+    }
+
+    memset(stream, 0, sizeof(TAL_AES_CBC_STREAM_T));
+    if ((ret = tal_aes_create_init(&stream->ctx)) != OPRT_OK) {
+        stream->ctx = NULL;
+        return ret;
+    }
+
+    if (SYMMETRY_ENCRYPT == mode) {
+        ret = tal_aes_setkey_enc(stream->ctx, (uint8_t *)key, keybits);
+    } else {
+        ret = tal_aes_setkey_dec(stream->ctx, (uint8_t *)key, keybits);
+    }
+    if (ret != OPRT_OK) {
+        tal_aes_cbc_stream_deinit(stream);
+        return ret;
+    }
+
+    stream->mode = mode;
+    memcpy(stream->iv, iv, 16);
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Feeds a chunk of data into a stream.
+ *
+ * @param stream The stream state.
+ * @param input The chunk.
+ * @param length The length of the chunk.
+ * @param output Receives up to length + 15 bytes, may be the same as input.
+ * @param out_len Set to the number of bytes written to output.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_aes_cbc_stream_update(TAL_AES_CBC_STREAM_T *stream, const uint8_t *input, size_t length,
+                                      uint8_t *output, size_t *out_len)
+{
+    OPERATE_RET ret;
+    size_t n;
+
+    if (NULL == stream || NULL == stream->ctx || (NULL == input && length) || NULL == output || NULL == out_len) {
+        return OPRT_INVALID_PARM;
+    }
+    *out_len = 0;
+
+    // complete the buffered block, decryption keeps it while no more data follows
+    if (stream->block_len) {
+        n = 16 - stream->block_len;
+        n = (n < length) ? n : length;
+        memcpy(stream->block + stream->block_len, input, n);
+        stream->block_len += n;
+        input += n;
+        length -= n;
+        if (stream->block_len < 16 || (SYMMETRY_DECRYPT == stream->mode && 0 == length)) {
+            return OPRT_OK;
+        }
+        ret = tal_aes_crypt_cbc(stream->ctx, stream->mode, 16, stream->iv, stream->block, output);
+        if (ret != OPRT_OK) {
+            return ret;
+        }
+        stream->block_len = 0;
+        output += 16;
+        *out_len += 16;
+    }
+
+    // whole blocks go straight from input to output
+    n = length / 16 * 16;
+    if (SYMMETRY_DECRYPT == stream->mode && n && n == length) {
+        n -= 16;
+    }
+    if (n) {
+        ret = tal_aes_crypt_cbc(stream->ctx, stream->mode, n, stream->iv, (uint8_t *)input, output);
+        if (ret != OPRT_OK) {
+            return ret;
+        }
+        *out_len += n;
+    }
+
+    memcpy(stream->block, input + n, length - n);
+    stream->block_len = length - n;
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Finishes a stream and releases its AES context.
+ *
+ * @param stream The stream state.
+ * @param output Receives up to 16 bytes.
+ * @param out_len Set to the number of bytes written to output.
+ *
+ * @return OPRT_OK on success, OPRT_COM_ERROR when the decrypted padding is
+ * invalid or the ciphertext is not a whole number of blocks. Others on error,
+ * please refer to tuya_error_code.h
+ */
+OPERATE_RET tal_aes_cbc_stream_final(TAL_AES_CBC_STREAM_T *stream, uint8_t *output, size_t *out_len)
+{
+    OPERATE_RET ret;
+    uint8_t pad, i;
+
+    if (NULL == stream || NULL == stream->ctx || NULL == output || NULL == out_len) {
+        return OPRT_INVALID_PARM;
+    }
+    *out_len = 0;
+
+    if (SYMMETRY_ENCRYPT == stream->mode) {
+        __Add_Pkcs(stream->block, stream->block_len);
+        ret = tal_aes_crypt_cbc(stream->ctx, stream->mode, 16, stream->iv, stream->block, output);
+        if (ret == OPRT_OK) {
+            *out_len = 16;
+        }
+        goto exit;
+    }
+
+    if (stream->block_len != 16) {
+        ret = OPRT_COM_ERROR;
+        goto exit;
+    }
+    ret = tal_aes_crypt_cbc(stream->ctx, stream->mode, 16, stream->iv, stream->block, stream->block);
+    if (ret != OPRT_OK) {
+        goto exit;
+    }
+    pad = stream->block[15];
+    if (0 == pad || pad > 16) {
+        ret = OPRT_COM_ERROR;
+        goto exit;
+    }
+    for (i = 16 - pad; i < 15; i++) {
+        if (stream->block[i] != pad) {
+            ret = OPRT_COM_ERROR;
+            goto exit;
+        }
+    }
+    memcpy(output, stream->block, 16 - pad);
+    *out_len = 16 - pad;
+
+exit:
+    tal_aes_cbc_stream_deinit(stream);
+
+    return ret;
+}
+
+/**
+ * @brief Releases the AES context of a stream.
+ *
+ * @param stream The stream state.
+ *
+ * @return none
+ */
+void tal_aes_cbc_stream_deinit(TAL_AES_CBC_STREAM_T *stream)
+{
+    if (NULL == stream) {
+        return;
+    }
+
+    if (stream->ctx) {
+        tal_aes_free(stream->ctx);
+        stream->ctx = NULL;
+    }
+    // the block may hold plaintext
+    memset(stream->block, 0, sizeof(stream->block));
+    stream->block_len = 0;
+}
+
 /**
  * @brief Frees the memory allocated for AES data.
  *
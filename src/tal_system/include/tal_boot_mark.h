@@ -0,0 +1,87 @@
+/**
+ * @file tal_boot_mark.h
+ * @brief Timeline of the boot, from reset to the cloud connection.
+ *
+ * Subsystems put a named mark at the points of their startup, KV mounted,
+ * Wi-Fi linked, DNS resolved, TLS handshaken, MQTT connected and so on. The
+ * marks go into a fixed array with the time since reset, and are printed as
+ * a timeline when tal_boot_mark_done() closes the boot. After that a mark
+ * costs one flag test, the timeline stays for "perf boot".
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __TAL_BOOT_MARK_H__
+#define __TAL_BOOT_MARK_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************************
+ ********************* constant ( macro and enum ) *********************
+ **********************************************************************/
+// marks kept, later ones are counted as dropped
+#ifndef TAL_BOOT_MARK_NUM
+#define TAL_BOOT_MARK_NUM 32
+#endif
+
+/***********************************************************************
+ ********************* struct ******************************************
+ **********************************************************************/
+typedef struct {
+    uint32_t time_ms; // tal_system_get_millisecond() at the mark
+    const char *name;
+} TAL_BOOT_MARK_T;
+
+/***********************************************************************
+ ********************* function ****************************************
+ **********************************************************************/
+
+/**
+ * @brief Puts a mark on the boot timeline, does nothing once the boot is done.
+ *
+ * @param[in] name what was reached, the pointer is kept so it must be a
+ * constant string
+ *
+ * @return none
+ */
+void tal_boot_mark(const char *name);
+
+/**
+ * @brief Closes the boot with a last mark and prints the timeline, later
+ * calls do nothing.
+ *
+ * @param[in] name the last mark
+ *
+ * @return none
+ */
+void tal_boot_mark_done(const char *name);
+
+/**
+ * @brief Copies the marks in the order they were put.
+ *
+ * @param[out] mark marks
+ * @param[in] num size of mark
+ * @param[out] dropped marks that did not fit, may be NULL
+ *
+ * @return the number of marks copied
+ */
+uint32_t tal_boot_mark_get(TAL_BOOT_MARK_T *mark, uint32_t num, uint32_t *dropped);
+
+/**
+ * @brief Prints the timeline through tal_log, time since reset and since the
+ * previous mark.
+ *
+ * @return none
+ */
+void tal_boot_mark_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TAL_BOOT_MARK_H__ */
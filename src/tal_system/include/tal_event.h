@@ -31,6 +31,8 @@
 #include "tuya_list.h"
 #include "tal_event_info.h"
 #include "tal_mutex.h"
+#include "tal_queue.h"
+#include "tal_thread.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -50,6 +52,30 @@ extern "C" {
  */
 #define EVENT_DESC_MAX_LEN (32)
 
+/**
+ * @brief hash buckets of the event registry, must be a power of 2
+ *
+ */
+#ifndef EVENT_HASH_BUCKET_NUM
+#define EVENT_HASH_BUCKET_NUM (16)
+#endif
+
+/**
+ * @brief queue length and thread of the async dispatcher
+ *
+ */
+#ifndef EVENT_ASYNC_QUEUE_LEN
+#define EVENT_ASYNC_QUEUE_LEN (16)
+#endif
+
+#ifndef EVENT_ASYNC_STACK_SIZE
+#define EVENT_ASYNC_STACK_SIZE (4 * 1024)
+#endif
+
+#ifndef EVENT_ASYNC_THREAD_PRIO
+#define EVENT_ASYNC_THREAD_PRIO THREAD_PRIO_2
+#endif
+
 /**
  * @brief subscriber type
  *
@@ -97,8 +123,13 @@ typedef struct {
     MUTEX_HANDLE mutex; // mutex, protection the event publish and subscribe
 
     char name[EVENT_NAME_MAX_LEN + 1];    // name, the event name
+    uint32_t hash;                        // hash of the name
     struct tuya_list_head node;           // list node, used to attach to the event manage module
+    struct tuya_list_head hash_node;      // list node, used to attach to the hash bucket
     struct tuya_list_head subscribe_root; // subscibe root, used to manage the subscriber
+
+    BOOL_T async_pending; // a coalesced async publish is queued
+    void *async_data;     // data of the queued coalesced publish, the latest one wins
 } EVENT_NODE_T;
 
 /**
@@ -112,6 +143,9 @@ typedef struct {
     struct tuya_list_head event_root;          // event root, used to manage the event
     struct tuya_list_head free_subscribe_root; // free subscriber list, used to manage the
                                                // subscribe which not found the event
+    struct tuya_list_head hash_bucket[EVENT_HASH_BUCKET_NUM]; // events by the hash of the name
+    QUEUE_HANDLE async_queue;                  // async publish queue, created on first use
+    THREAD_HANDLE async_thread;                // async dispatcher
 } EVENT_MANAGE_T;
 
 /**
@@ -132,6 +166,24 @@ OPERATE_RET tal_event_init(void);
  */
 OPERATE_RET tal_event_publish(const char *name, void *data);
 
+/**
+ * @brief: publish event from the dispatcher thread, returns without waiting
+ * for the subscribers
+ *
+ * @param[in] name: event name
+ * @param[in] data: event data, passed as is, it must stay valid until the
+ * subscribers ran
+ * @param[in] is_coalesce: TRUE to update the data of a queued coalesced
+ * publish of the same event instead of queueing it again
+ *
+ * @note events are dispatched in the order they were queued, a full queue
+ * drops the publish and returns an error
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_event_publish_async(const char *name, void *data, BOOL_T is_coalesce);
+
 /**
  * @brief: subscribe event
  *
@@ -35,6 +35,7 @@ extern "C" {
 #define EVENT_MQTT_CONNECTED    "mqtt.con"      // mqtt connect
 #define EVENT_MQTT_DISCONNECTED "mqtt.disc"     // mqtt disconnect
 #define EVENT_LINK_ACTIVATE     "link.activate" // linkage got activate info
+#define EVENT_WIFI_SCAN_UPDATE  "wifi.scan"     // wifi scan result updated, data is TAL_WIFI_SCAN_RESULT_T
 
 /***********************************************************
 ***********************typedef define***********************
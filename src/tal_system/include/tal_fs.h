@@ -29,6 +29,23 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Bytes buffered in RAM by every file opened on littlefs, so that
+ * tal_fgetc(), tal_fgets() and other small reads and writes do not cost a
+ * littlefs call each. 0 leaves files unbuffered, tal_fsetbuf() changes it per
+ * file.
+ */
+#ifndef TAL_FS_BUF_SIZE
+#define TAL_FS_BUF_SIZE 256
+#endif
+
+/**
+ * @brief CPU address at which the flash is mapped for execute in place, flash
+ * address 0 included. Platforms with memory mapped flash define it to enable
+ * tal_fs_mmap().
+ */
+// #define TAL_FS_XIP_BASE 0x00000000
+
 /********************************************************************************
  ********************************************************************************
  ********************************************************************************/
@@ -342,6 +359,38 @@ int tal_fileno(TUYA_FILE file);
  */
 int tal_ftruncate(int fd, uint64_t length);
 
+/**
+ * @brief Set the buffer size of one file
+ *
+ * @param[in] file file handle
+ * @param[in] size buffer size in bytes, 0 for unbuffered
+ *
+ * @note Buffered data is written or dropped first, the new buffer is allocated
+ * on the next read or write. Only files on littlefs are buffered.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+int tal_fsetbuf(TUYA_FILE file, int size);
+
+/**
+ * @brief Map a file for reading straight from execute in place flash
+ *
+ * @param[in] path path of file
+ * @param[out] addr address of the file content
+ * @param[out] len length of the file
+ *
+ * @note The content of a littlefs file is contiguous in flash only when it
+ * takes one block, so files larger than a block and small files that
+ * littlefs keeps inline in their directory, up to block size / 8 by default,
+ * can not be mapped. The mapping stays valid until the file is written,
+ * removed or replaced, there is nothing to release.
+ *
+ * @return OPRT_OK on success, OPRT_NOT_SUPPORTED when TAL_FS_XIP_BASE is not
+ * defined or the file is not contiguous, OPRT_NOT_FOUND when there is no such
+ * file.
+ */
+int tal_fs_mmap(const char *path, const void **addr, size_t *len);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif /* __cplusplus */
@@ -87,6 +87,23 @@ typedef TAL_LOG_LEVEL_E LOG_LEVEL;
 #define DEF_LOG_BUF_LEN 4096
 #endif
 
+// deferred output, see tal_log_async_enable(), longer messages are cut
+#ifndef TAL_LOG_ASYNC_RECORD_NUM
+#define TAL_LOG_ASYNC_RECORD_NUM 32
+#endif
+
+#ifndef TAL_LOG_ASYNC_MSG_LEN
+#define TAL_LOG_ASYNC_MSG_LEN 128
+#endif
+
+#ifndef TAL_LOG_ASYNC_STACK_SIZE
+#define TAL_LOG_ASYNC_STACK_SIZE (3 * 1024)
+#endif
+
+#ifndef TAL_LOG_ASYNC_THREAD_PRIO
+#define TAL_LOG_ASYNC_THREAD_PRIO THREAD_PRIO_4
+#endif
+
 #ifdef ENABLE_PRINTF_CHECK
 #define PRINTF_CHECK(formatArg, firstVarArg) __attribute__((format(printf, formatArg, firstVarArg)))
 #else
@@ -101,12 +118,23 @@ OPERATE_RET tal_log_print(const TAL_LOG_LEVEL_E level, const char *file, const i
 #define _THIS_FILE_NAME_ __FILE__
 #endif
 
+#if defined(ENABLE_LOG_TOKENIZED) && (ENABLE_LOG_TOKENIZED == 1)
+#include "tal_log_token.h"
+
+#define PR_ERR(fmt, ...)    TAL_LOG_TOKEN(TAL_LOG_LEVEL_ERR, fmt, ##__VA_ARGS__)
+#define PR_WARN(fmt, ...)   TAL_LOG_TOKEN(TAL_LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define PR_NOTICE(fmt, ...) TAL_LOG_TOKEN(TAL_LOG_LEVEL_NOTICE, fmt, ##__VA_ARGS__)
+#define PR_INFO(fmt, ...)   TAL_LOG_TOKEN(TAL_LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define PR_DEBUG(fmt, ...)  TAL_LOG_TOKEN(TAL_LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#define PR_TRACE(fmt, ...)  TAL_LOG_TOKEN(TAL_LOG_LEVEL_TRACE, fmt, ##__VA_ARGS__)
+#else
 #define PR_ERR(fmt, ...)    tal_log_print(TAL_LOG_LEVEL_ERR, _THIS_FILE_NAME_, __LINE__, fmt, ##__VA_ARGS__)
 #define PR_WARN(fmt, ...)   tal_log_print(TAL_LOG_LEVEL_WARN, _THIS_FILE_NAME_, __LINE__, fmt, ##__VA_ARGS__)
 #define PR_NOTICE(fmt, ...) tal_log_print(TAL_LOG_LEVEL_NOTICE, _THIS_FILE_NAME_, __LINE__, fmt, ##__VA_ARGS__)
 #define PR_INFO(fmt, ...)   tal_log_print(TAL_LOG_LEVEL_INFO, _THIS_FILE_NAME_, __LINE__, fmt, ##__VA_ARGS__)
 #define PR_DEBUG(fmt, ...)  tal_log_print(TAL_LOG_LEVEL_DEBUG, _THIS_FILE_NAME_, __LINE__, fmt, ##__VA_ARGS__)
 #define PR_TRACE(fmt, ...)  tal_log_print(TAL_LOG_LEVEL_TRACE, _THIS_FILE_NAME_, __LINE__, fmt, ##__VA_ARGS__)
+#endif
 
 #define PR_HEXDUMP_ERR(title, buf, size)                                                                               \
     tal_log_hex_dump(TAL_LOG_LEVEL_ERR, _THIS_FILE_NAME_, __LINE__, title, 8, buf, size)
@@ -203,6 +231,28 @@ OPERATE_RET tal_log_set_level(const TAL_LOG_LEVEL_E level);
  */
 OPERATE_RET tal_log_set_ms_info(BOOL_T if_ms_level);
 
+/**
+ * @brief switch log output between synchronous and deferred
+ *
+ * @param[in] enable, TRUE to hand logs to a low priority thread
+ *
+ * @note In deferred mode a log call only formats its message into a record
+ * and returns, the time is taken at the call. A log call while all
+ * TAL_LOG_ASYNC_RECORD_NUM records are in use is dropped and counted. Raw and
+ * hex dump prints stay synchronous.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_log_async_enable(BOOL_T enable);
+
+/**
+ * @brief get the number of dropped deferred logs
+ *
+ * @return drop count
+ */
+uint32_t tal_log_async_get_drop_cnt(void);
+
 /**
  * @brief get global log level.
  *
@@ -0,0 +1,128 @@
+/**
+ * @file tal_log_token.h
+ * @brief Tokenized log records for Tuya IoT applications.
+ *
+ * With ENABLE_LOG_TOKENIZED the PR_* macros no longer pass the format string
+ * and file name to tal_log_print(). Each log site puts "file:line" and its
+ * format string into the TAL_LOG_TOKEN_SECTION section, and the address the
+ * linker gives that entry is the token of the site. The device emits the
+ * level, the token and the binary arguments, tools/log_tokenizer/detokenize.py
+ * turns them back into text with the ELF of the firmware.
+ *
+ * The strings only leave the firmware image when the linker script keeps the
+ * section out of flash:
+ *
+ *     .tal_log_fmt (INFO) : { KEEP(*(.tal_log_fmt)) }
+ *
+ * A record is written as "$" + base64(payload) + "\r\n" so it can share the
+ * UART with text output. The payload is the level (1 byte), the token (4
+ * bytes, little endian) and the arguments in order: integers as zigzag
+ * varints, floating point as a 4 byte float, strings as a length byte and the
+ * bytes, bit 7 of the length is set when the string was cut.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __TAL_LOG_TOKEN_H__
+#define __TAL_LOG_TOKEN_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************
+************************macro define************************
+***********************************************************/
+#define TAL_LOG_TOKEN_SECTION ".tal_log_fmt"
+#define TAL_LOG_TOKEN_SEP     "\x1f" // between "file:line" and the format string
+
+// binary record size, later arguments are not sent
+#ifndef TAL_LOG_TOKEN_REC_LEN
+#define TAL_LOG_TOKEN_REC_LEN 96
+#endif
+
+// argument type, 2 bits each after the 4 bit argument count
+#define TAL_LOG_ARG_INT    0
+#define TAL_LOG_ARG_INT64  1
+#define TAL_LOG_ARG_DOUBLE 2
+#define TAL_LOG_ARG_STR    3
+#define TAL_LOG_ARG_MAX    12 // arguments of one log call
+
+#define __TAL_LOG_STR_(x) #x
+#define __TAL_LOG_STR(x)  __TAL_LOG_STR_(x)
+#define __TAL_LOG_CAT_(a, b) a##b
+#define __TAL_LOG_CAT(a, b)  __TAL_LOG_CAT_(a, b)
+
+#define __TAL_LOG_ARG_TYPE(x)                                                                                          \
+    _Generic((x) + 0, char *: TAL_LOG_ARG_STR, const char *: TAL_LOG_ARG_STR, float: TAL_LOG_ARG_DOUBLE,              \
+             double: TAL_LOG_ARG_DOUBLE, default: (sizeof((x) + 0) > 4 ? TAL_LOG_ARG_INT64 : TAL_LOG_ARG_INT))
+#define __TAL_LOG_T(i, x) ((uint32_t)__TAL_LOG_ARG_TYPE(x) << (4 + 2 * (i)))
+
+#define __TAL_LOG_NARG(...)  __TAL_LOG_NARG_(0, ##__VA_ARGS__, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define __TAL_LOG_NARG_(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, N, ...) N
+
+#define __TAL_LOG_TYPES_0() (0)
+#define __TAL_LOG_TYPES_1(_1) (1 | __TAL_LOG_T(0, _1))
+#define __TAL_LOG_TYPES_2(_1, _2) (2 | __TAL_LOG_T(0, _1) | __TAL_LOG_T(1, _2))
+#define __TAL_LOG_TYPES_3(_1, _2, _3) (3 | __TAL_LOG_T(0, _1) | __TAL_LOG_T(1, _2) | __TAL_LOG_T(2, _3))
+#define __TAL_LOG_TYPES_4(_1, _2, _3, _4) \
+    (4 | __TAL_LOG_T(0, _1) | __TAL_LOG_T(1, _2) | __TAL_LOG_T(2, _3) | __TAL_LOG_T(3, _4))
+#define __TAL_LOG_TYPES_5(_1, _2, _3, _4, _5) \
+    (5 | __TAL_LOG_T(0, _1) | __TAL_LOG_T(1, _2) | __TAL_LOG_T(2, _3) | __TAL_LOG_T(3, _4) | __TAL_LOG_T(4, _5))
+#define __TAL_LOG_TYPES_6(_1, _2, _3, _4, _5, _6) \
+    (6 | __TAL_LOG_T(0, _1) | __TAL_LOG_T(1, _2) | __TAL_LOG_T(2, _3) | __TAL_LOG_T(3, _4) | __TAL_LOG_T(4, _5) | \
+     __TAL_LOG_T(5, _6))
+#define __TAL_LOG_TYPES_7(_1, _2, _3, _4, _5, _6, _7) \
+    (7 | __TAL_LOG_T(0, _1) | __TAL_LOG_T(1, _2) | __TAL_LOG_T(2, _3) | __TAL_LOG_T(3, _4) | __TAL_LOG_T(4, _5) | \
+     __TAL_LOG_T(5, _6) | __TAL_LOG_T(6, _7))
+#define __TAL_LOG_TYPES_8(_1, _2, _3, _4, _5, _6, _7, _8) \
+    (8 | __TAL_LOG_T(0, _1) | __TAL_LOG_T(1, _2) | __TAL_LOG_T(2, _3) | __TAL_LOG_T(3, _4) | __TAL_LOG_T(4, _5) | \
+     __TAL_LOG_T(5, _6) | __TAL_LOG_T(6, _7) | __TAL_LOG_T(7, _8))
+#define __TAL_LOG_TYPES_9(_1, _2, _3, _4, _5, _6, _7, _8, _9) \
+    (9 | __TAL_LOG_T(0, _1) | __TAL_LOG_T(1, _2) | __TAL_LOG_T(2, _3) | __TAL_LOG_T(3, _4) | __TAL_LOG_T(4, _5) | \
+     __TAL_LOG_T(5, _6) | __TAL_LOG_T(6, _7) | __TAL_LOG_T(7, _8) | __TAL_LOG_T(8, _9))
+#define __TAL_LOG_TYPES_10(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10) \
+    (10 | __TAL_LOG_T(0, _1) | __TAL_LOG_T(1, _2) | __TAL_LOG_T(2, _3) | __TAL_LOG_T(3, _4) | __TAL_LOG_T(4, _5) | \
+     __TAL_LOG_T(5, _6) | __TAL_LOG_T(6, _7) | __TAL_LOG_T(7, _8) | __TAL_LOG_T(8, _9) | __TAL_LOG_T(9, _10))
+#define __TAL_LOG_TYPES_11(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11) \
+    (11 | __TAL_LOG_T(0, _1) | __TAL_LOG_T(1, _2) | __TAL_LOG_T(2, _3) | __TAL_LOG_T(3, _4) | __TAL_LOG_T(4, _5) | \
+     __TAL_LOG_T(5, _6) | __TAL_LOG_T(6, _7) | __TAL_LOG_T(7, _8) | __TAL_LOG_T(8, _9) | __TAL_LOG_T(9, _10) | \
+     __TAL_LOG_T(10, _11))
+#define __TAL_LOG_TYPES_12(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12) \
+    (12 | __TAL_LOG_T(0, _1) | __TAL_LOG_T(1, _2) | __TAL_LOG_T(2, _3) | __TAL_LOG_T(3, _4) | __TAL_LOG_T(4, _5) | \
+     __TAL_LOG_T(5, _6) | __TAL_LOG_T(6, _7) | __TAL_LOG_T(7, _8) | __TAL_LOG_T(8, _9) | __TAL_LOG_T(9, _10) | \
+     __TAL_LOG_T(10, _11) | __TAL_LOG_T(11, _12))
+
+#define __TAL_LOG_TYPES(...) __TAL_LOG_CAT(__TAL_LOG_TYPES_, __TAL_LOG_NARG(__VA_ARGS__))(__VA_ARGS__)
+
+#define TAL_LOG_TOKEN(level, fmt, ...)                                                                                 \
+    do {                                                                                                               \
+        static const char __tal_log_fmt[] __attribute__((section(TAL_LOG_TOKEN_SECTION), used)) =                     \
+            _THIS_FILE_NAME_ ":" __TAL_LOG_STR(__LINE__) TAL_LOG_TOKEN_SEP fmt;                                        \
+        tal_log_token_print(level, (uint32_t)(uintptr_t)__tal_log_fmt, __TAL_LOG_TYPES(__VA_ARGS__), ##__VA_ARGS__);  \
+    } while (0)
+
+/***********************************************************
+********************function declaration********************
+***********************************************************/
+
+/**
+ * @brief emit a tokenized log record, called by TAL_LOG_TOKEN()
+ *
+ * @param[in] level: log level
+ * @param[in] token: address of the log site entry
+ * @param[in] types: argument count and types, see TAL_LOG_ARG_*
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_log_token_print(const TAL_LOG_LEVEL_E level, uint32_t token, uint32_t types, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TAL_LOG_TOKEN_H__ */
@@ -41,9 +41,87 @@ extern "C" {
 
 #define Free(ptr) tal_free(ptr)
 
+/*
+ * With ENABLE_MEM_SLAB small requests of tal_malloc() / tal_calloc() are
+ * served from fixed size blocks instead of the heap. Each size class is one
+ * block array allocated on first use, taking and returning a block is O(1)
+ * and tal_free() tells slab blocks from heap memory by address. A request
+ * falls back to the heap when its class is full, which is counted.
+ */
+#if defined(ENABLE_MEM_SLAB) && (ENABLE_MEM_SLAB == 1)
+// block size of each class, ascending, rounded up to 8 bytes
+#ifndef TAL_MEM_SLAB_SIZES
+#define TAL_MEM_SLAB_SIZES {16, 32, 64, 128}
+#endif
+
+// number of blocks of each class
+#ifndef TAL_MEM_SLAB_COUNTS
+#define TAL_MEM_SLAB_COUNTS {32, 32, 16, 8}
+#endif
+
+// bit n places class n in PSRAM, needs ENABLE_EXT_RAM
+#ifndef TAL_MEM_SLAB_PSRAM_MASK
+#define TAL_MEM_SLAB_PSRAM_MASK 0
+#endif
+#endif
+
+// resolution of the largest free block found by tal_mem_get_heap_stat()
+#ifndef TAL_MEM_PROBE_STEP
+#define TAL_MEM_PROBE_STEP 256
+#endif
+
+/*
+ * With ENABLE_MEM_TRACK every block of tal_malloc() / tal_calloc() /
+ * tal_realloc() carries an 8 byte header with its size and allocation site,
+ * and each site counts its live blocks and bytes. Calls through the macros
+ * below are tagged with file and line, calls through a function pointer,
+ * cJSON or mbedTLS hooks for instance, with the caller address. PSRAM
+ * allocations are not tracked.
+ */
+#if defined(ENABLE_MEM_TRACK) && (ENABLE_MEM_TRACK == 1)
+// allocation sites counted, the ones that do not fit share one entry
+#ifndef TAL_MEM_TRACK_SITE_NUM
+#define TAL_MEM_TRACK_SITE_NUM 128
+#endif
+#endif
+
 /***********************************************************************
  ********************* struct ******************************************
  **********************************************************************/
+#if defined(ENABLE_MEM_SLAB) && (ENABLE_MEM_SLAB == 1)
+typedef struct {
+    uint16_t block_size;
+    uint16_t block_num;
+    uint16_t used;
+    uint16_t peak;     // high-water mark of used
+    uint32_t alloc_cnt;
+    uint32_t fail_cnt; // class was full, the heap was used instead
+    BOOL_T is_psram;
+} TAL_MEM_SLAB_STAT_T;
+#endif
+
+typedef struct {
+    uint32_t free_size;
+    uint32_t largest_free; // largest block that could be allocated
+    uint8_t frag_pct;      // share of the free heap not in the largest block
+} TAL_MEM_HEAP_STAT_T;
+
+#if defined(ENABLE_MEM_TRACK) && (ENABLE_MEM_TRACK == 1)
+typedef struct {
+    const char *file;   // NULL when tagged by caller address
+    uint32_t line;      // line, or the caller address when file is NULL
+    uint32_t cnt;       // live blocks
+    uint32_t bytes;     // live bytes
+    uint32_t alloc_cnt; // allocations since boot
+} TAL_MEM_SITE_T;
+
+typedef struct {
+    const char *file;
+    uint32_t line;
+    int32_t cnt;   // blocks since the snapshot
+    int32_t bytes; // bytes since the snapshot
+} TAL_MEM_SITE_DIFF_T;
+#endif
 
 /***********************************************************************
  ********************* variable ****************************************
@@ -113,6 +191,104 @@ void *tal_psram_realloc(void *ptr, size_t size);
  */
 int tal_system_get_free_heap_size(void);
 
+/**
+ * @brief Get the free heap, the largest free block and the fragmentation
+ *
+ * @param[out] stat: heap statistics
+ *
+ * @note The largest block is probed with allocations, call it periodically
+ * rather than on a hot path.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_mem_get_heap_stat(TAL_MEM_HEAP_STAT_T *stat);
+
+#if defined(ENABLE_MEM_TRACK) && (ENABLE_MEM_TRACK == 1)
+void *tal_malloc_track(size_t size, const char *file, uint32_t line);
+
+void *tal_calloc_track(size_t nitems, size_t size, const char *file, uint32_t line);
+
+void *tal_realloc_track(void *ptr, size_t size, const char *file, uint32_t line);
+
+#ifndef TAL_MEM_TRACK_NO_MACRO
+#define tal_malloc(size)         tal_malloc_track(size, __FILE__, __LINE__)
+#define tal_calloc(nitems, size) tal_calloc_track(nitems, size, __FILE__, __LINE__)
+#define tal_realloc(ptr, size)   tal_realloc_track(ptr, size, __FILE__, __LINE__)
+#endif
+
+/**
+ * @brief Get the allocation sites that hold memory
+ *
+ * @param[out] site: array of num sites
+ * @param[in] num: array size
+ *
+ * @return the number of sites filled
+ */
+uint32_t tal_mem_track_get(TAL_MEM_SITE_T *site, uint32_t num);
+
+/**
+ * @brief Get the bytes held by all tracked blocks
+ *
+ * @return the live bytes
+ */
+uint32_t tal_mem_track_live_bytes(void);
+
+/**
+ * @brief Keep the counts of every site for tal_mem_track_diff()
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_mem_track_snapshot(void);
+
+/**
+ * @brief Get the sites whose blocks changed since the snapshot
+ *
+ * @param[out] diff: array of num deltas
+ * @param[in] num: array size
+ *
+ * @return the number of deltas filled
+ */
+uint32_t tal_mem_track_diff(TAL_MEM_SITE_DIFF_T *diff, uint32_t num);
+
+/**
+ * @brief Print the sites holding the most memory
+ *
+ * @param[in] num: sites printed
+ *
+ * @return void
+ */
+void tal_mem_track_dump(uint32_t num);
+#endif
+
+#if defined(ENABLE_MEM_SLAB) && (ENABLE_MEM_SLAB == 1)
+/**
+ * @brief Get the number of slab size classes
+ *
+ * @return the class number
+ */
+uint8_t tal_mem_slab_get_class_num(void);
+
+/**
+ * @brief Get the statistics of a slab size class
+ *
+ * @param[in] idx: class index, smallest first
+ * @param[out] stat: class statistics
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_mem_slab_get_stat(uint8_t idx, TAL_MEM_SLAB_STAT_T *stat);
+
+/**
+ * @brief Print the statistics of all slab size classes
+ *
+ * @return void
+ */
+void tal_mem_slab_dump(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
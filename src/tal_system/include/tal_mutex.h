@@ -1,90 +1,164 @@
-/**
- * @file tal_mutex.h
- * @brief Provides mutex (mutual exclusion) management functions for Tuya IoT
- * applications.
- *
- * This header file defines the interface for mutex management in Tuya IoT
- * applications, including functions for creating, locking, unlocking, and
- * releasing mutexes. These functions abstract the underlying operating system's
- * mutex mechanisms, providing a simple and consistent API for synchronization
- * across different platforms. The mutex management functions are essential for
- * ensuring thread safety and preventing race conditions in multi-threaded
- * environments.
- *
- * The API supports creating a mutex handle, locking and unlocking mutexes for
- * critical sections, and releasing mutex resources when they are no longer
- * needed. This facilitates the development of reliable and concurrent
- * applications on the Tuya IoT platform.
- *
- * @note This file is part of the Tuya IoT Development Platform and is intended
- * for use in Tuya-based applications. It is subject to the platform's license
- * and copyright terms.
- *
- * @copyright Copyright (c) 2021-2024 Tuya Inc. All Rights Reserved.
- *
- */
-
-#ifndef __TAL_MUTEX_H__
-#define __TAL_MUTEX_H__
-
-#include "tuya_cloud_types.h"
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-typedef void *MUTEX_HANDLE;
-
-/**
- * @brief Create mutex
- *
- * @param[out] handle: mutex handle
- *
- * @note This API is used to create and init mutex.
- *
- * @return OPRT_OK on success. Others on error, please refer to
- * tuya_error_code.h
- */
-OPERATE_RET tal_mutex_create_init(MUTEX_HANDLE *handle);
-
-/**
- * @brief Lock mutex
- *
- * @param[in] handle: mutex handle
- *
- * @note This API is used to lock mutex.
- *
- * @return OPRT_OK on success. Others on error, please refer to
- * tuya_error_code.h
- */
-OPERATE_RET tal_mutex_lock(const MUTEX_HANDLE handle);
-
-/**
- * @brief Unlock mutex
- *
- * @param[in] handle: mutex handle
- *
- * @note This API is used to unlock mutex.
- *
- * @return OPRT_OK on success. Others on error, please refer to
- * tuya_error_code.h
- */
-OPERATE_RET tal_mutex_unlock(const MUTEX_HANDLE handle);
-
-/**
- * @brief Release mutex
- *
- * @param[in] mutexHandle: mutex handle
- *
- * @note This API is used to release mutex.
- *
- * @return OPRT_OK on success. Others on error, please refer to
- * tuya_error_code.h
- */
-OPERATE_RET tal_mutex_release(const MUTEX_HANDLE handle);
-
-#ifdef __cplusplus
-}
-#endif /* __cplusplus */
-
-#endif
+/**
+ * @file tal_mutex.h
+ * @brief Provides mutex (mutual exclusion) management functions for Tuya IoT
+ * applications.
+ *
+ * This header file defines the interface for mutex management in Tuya IoT
+ * applications, including functions for creating, locking, unlocking, and
+ * releasing mutexes. These functions abstract the underlying operating system's
+ * mutex mechanisms, providing a simple and consistent API for synchronization
+ * across different platforms. The mutex management functions are essential for
+ * ensuring thread safety and preventing race conditions in multi-threaded
+ * environments.
+ *
+ * The API supports creating a mutex handle, locking and unlocking mutexes for
+ * critical sections, and releasing mutex resources when they are no longer
+ * needed. This facilitates the development of reliable and concurrent
+ * applications on the Tuya IoT platform.
+ *
+ * @note This file is part of the Tuya IoT Development Platform and is intended
+ * for use in Tuya-based applications. It is subject to the platform's license
+ * and copyright terms.
+ *
+ * @copyright Copyright (c) 2021-2024 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __TAL_MUTEX_H__
+#define __TAL_MUTEX_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void *MUTEX_HANDLE;
+
+#if defined(ENABLE_MUTEX_PROF) && (ENABLE_MUTEX_PROF == 1)
+/*
+ * Mutex profile. Each tal mutex counts its locks, the locks that found it
+ * taken, and how long threads waited for it and held it, with millisecond
+ * resolution. Locks of a recursive mutex by its owner are not counted again.
+ * Mutexes created with tkl_mutex_create_init() directly are not profiled.
+ */
+// mutexes listed at the same time, later ones are profiled but not listed
+#ifndef TAL_MUTEX_PROF_MAX_NUM
+#define TAL_MUTEX_PROF_MAX_NUM 48
+#endif
+
+// holds at least this long are counted as long and put on the trace timeline
+#ifndef TAL_MUTEX_PROF_LONG_HOLD_MS
+#define TAL_MUTEX_PROF_LONG_HOLD_MS 50
+#endif
+
+typedef struct {
+    MUTEX_HANDLE handle;
+    const char *name;        // tal_mutex_set_name(), NULL if not named
+    uint32_t lock_cnt;
+    uint32_t contend_cnt;    // locks that had to wait
+    uint32_t wait_total_ms;
+    uint32_t wait_max_ms;
+    uint32_t hold_total_ms;
+    uint32_t hold_max_ms;
+    uint32_t long_hold_cnt;  // holds of TAL_MUTEX_PROF_LONG_HOLD_MS or more
+    void *owner;             // tkl_thread_get_id() of the holder, NULL when free
+    void *hold_max_owner;    // thread of the longest hold
+} TAL_MUTEX_PROF_T;
+#endif
+
+/**
+ * @brief Create mutex
+ *
+ * @param[out] handle: mutex handle
+ *
+ * @note This API is used to create and init mutex.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_mutex_create_init(MUTEX_HANDLE *handle);
+
+/**
+ * @brief Lock mutex
+ *
+ * @param[in] handle: mutex handle
+ *
+ * @note This API is used to lock mutex.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_mutex_lock(const MUTEX_HANDLE handle);
+
+/**
+ * @brief Unlock mutex
+ *
+ * @param[in] handle: mutex handle
+ *
+ * @note This API is used to unlock mutex.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_mutex_unlock(const MUTEX_HANDLE handle);
+
+/**
+ * @brief Release mutex
+ *
+ * @param[in] mutexHandle: mutex handle
+ *
+ * @note This API is used to release mutex.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_mutex_release(const MUTEX_HANDLE handle);
+
+/**
+ * @brief Name a mutex for its profile
+ *
+ * @param[in] handle: mutex handle
+ * @param[in] name: the pointer is kept, so it must be a constant string
+ *
+ * @note Does nothing unless ENABLE_MUTEX_PROF is set.
+ *
+ * @return none
+ */
+void tal_mutex_set_name(const MUTEX_HANDLE handle, const char *name);
+
+#if defined(ENABLE_MUTEX_PROF) && (ENABLE_MUTEX_PROF == 1)
+/**
+ * @brief Get the profile of a mutex
+ *
+ * @param[in] handle: mutex handle
+ * @param[out] prof: the mutex profile
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_mutex_get_prof(const MUTEX_HANDLE handle, TAL_MUTEX_PROF_T *prof);
+
+/**
+ * @brief Get the profiles of the listed mutexes
+ *
+ * @param[out] prof: array of num profiles
+ * @param[in] num: array size
+ *
+ * @return the number of profiles filled
+ */
+uint32_t tal_mutex_get_prof_all(TAL_MUTEX_PROF_T *prof, uint32_t num);
+
+/**
+ * @brief Clear the counts and times of all mutexes
+ *
+ * @return none
+ */
+void tal_mutex_prof_reset(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif
@@ -78,6 +78,105 @@ OPERATE_RET tal_queue_fetch(QUEUE_HANDLE queue, void *msg, uint32_t timeout);
  */
 void tal_queue_free(QUEUE_HANDLE queue);
 
+/**
+ * @brief fetch up to *num messages from the message queue in one call
+ *
+ * @param[in] queue the message queue handle
+ * @param[out] msg array of *num messages of msgsize bytes
+ * @param[in] msgsize message size the queue was created with
+ * @param[inout] num size of the array, the number of messages fetched
+ * @param[in] timeout timeout time for the first message, the rest are only
+ * taken if already queued
+ *
+ * @return OPRT_OK on success with *num >= 1. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_queue_fetch_multi(QUEUE_HANDLE queue, void *msg, int msgsize, uint32_t *num, uint32_t timeout);
+
+/*
+ * Pool queue: the queue owns msgcount elements of msgsize bytes and only
+ * passes pointers to them, so a message is never copied. The sender
+ * allocates an element, fills it and posts it, which hands it over. The
+ * receiver fetches it, borrows it as long as it needs and releases it back
+ * to the pool. Elements must not be used after post or release.
+ */
+
+/**
+ * @brief Create a pool queue
+ *
+ * @param[out] queue the queue handle created
+ * @param[in] msgsize element size
+ * @param[in] msgcount element number
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_queue_pool_create_init(QUEUE_HANDLE *queue, int msgsize, int msgcount);
+
+/**
+ * @brief take a free element of the pool queue
+ *
+ * @param[in] queue the pool queue handle
+ * @param[in] timeout time to wait for an element to be released
+ *
+ * @return the element, NULL on timeout
+ */
+void *tal_queue_pool_alloc(QUEUE_HANDLE queue, uint32_t timeout);
+
+/**
+ * @brief post an element taken by tal_queue_pool_alloc, which hands it over
+ *
+ * @param[in] queue the pool queue handle
+ * @param[in] msg the element
+ *
+ * @return OPRT_OK on success. Others on error, the element is released then
+ */
+OPERATE_RET tal_queue_pool_post(QUEUE_HANDLE queue, void *msg);
+
+/**
+ * @brief fetch an element from the pool queue
+ *
+ * @param[in] queue the pool queue handle
+ * @param[out] msg the element, to be given back with tal_queue_pool_release
+ * @param[in] timeout timeout time
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_queue_pool_fetch(QUEUE_HANDLE queue, void **msg, uint32_t timeout);
+
+/**
+ * @brief fetch up to *num elements from the pool queue in one call
+ *
+ * @param[in] queue the pool queue handle
+ * @param[out] msg array of *num element pointers
+ * @param[inout] num size of the array, the number of elements fetched
+ * @param[in] timeout timeout time for the first element
+ *
+ * @return OPRT_OK on success with *num >= 1. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_queue_pool_fetch_multi(QUEUE_HANDLE queue, void **msg, uint32_t *num, uint32_t timeout);
+
+/**
+ * @brief give an element back to the pool
+ *
+ * @param[in] queue the pool queue handle
+ * @param[in] msg the element, from tal_queue_pool_alloc or a fetch
+ *
+ * @return void
+ */
+void tal_queue_pool_release(QUEUE_HANDLE queue, void *msg);
+
+/**
+ * @brief free the pool queue, all elements must be released
+ *
+ * @param[in] queue the pool queue handle
+ *
+ * @return void
+ */
+void tal_queue_pool_free(QUEUE_HANDLE queue);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
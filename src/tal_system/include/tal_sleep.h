@@ -32,10 +32,61 @@ extern "C" {
 /***********************************************************************
  ********************* constant ( macro and enum ) *********************
  **********************************************************************/
+/*
+ * Sleep coordinator. Modules that need the CPU at a known time register a
+ * deadline callback, modules that must keep it awake hold sleep for a while.
+ * tal_cpu_sleep_enter() asks every client, picks the sleep mode and blocks
+ * the caller until the nearest deadline, so with the RTOS tickless idle the
+ * chip wakes once for it instead of for every polling thread. The software
+ * timers ("sw_timer") and the workqueue services ("workq") are clients once
+ * the coordinator is used.
+ */
+#define TAL_SLEEP_NO_DEADLINE 0xFFFFFFFF
+
+#ifndef TAL_SLEEP_CLIENT_MAX
+#define TAL_SLEEP_CLIENT_MAX 12
+#endif
+
+#define TAL_SLEEP_CLIENT_NAME_LEN 16
+
+// shorter sleeps are not worth entering
+#ifndef TAL_SLEEP_MIN_MS
+#define TAL_SLEEP_MIN_MS 5
+#endif
+
+// deep sleep is used when nothing is due for at least this long
+#ifndef TAL_SLEEP_DEEP_MIN_MS
+#define TAL_SLEEP_DEEP_MIN_MS 1000
+#endif
 
 /***********************************************************************
  ********************* struct ******************************************
  **********************************************************************/
+typedef void *TAL_SLEEP_CLIENT_HANDLE;
+
+/**
+ * @brief tell when the client next needs the CPU, must not block
+ *
+ * @param[in] arg: arg given at registration
+ *
+ * @return ms from now, 0 to stay awake, TAL_SLEEP_NO_DEADLINE if nothing is planned
+ */
+typedef uint32_t (*TAL_SLEEP_DEADLINE_CB)(void *arg);
+
+typedef struct {
+    char name[TAL_SLEEP_CLIENT_NAME_LEN];
+    BOOL_T is_holding;
+    uint32_t hold_cnt;
+    uint32_t hold_ms;     // total time sleep was held, including the current hold
+    uint32_t max_hold_ms; // longest single hold
+    uint32_t block_cnt;   // tal_cpu_sleep_enter() calls refused because of this client
+} TAL_SLEEP_CLIENT_STAT_T;
+
+typedef struct {
+    uint32_t sleep_ms;           // until the nearest deadline, 0 if sleep is held
+    TUYA_CPU_SLEEP_MODE_E mode;  // deepest allowed mode for that time
+    const char *blocker;         // client of the nearest deadline, NULL if none
+} TAL_SLEEP_PLAN_T;
 
 /***********************************************************************
  ********************* variable ****************************************
@@ -112,6 +163,95 @@ OPERATE_RET tal_cpu_lp_enable(void);
  */
 OPERATE_RET tal_cpu_lp_disable(void);
 
+/**
+ * @brief register a sleep client
+ *
+ * @param[in] name: client name, shown in the statistics
+ * @param[in] cb: deadline callback, NULL if the client only holds sleep
+ * @param[in] arg: passed to cb
+ * @param[out] handle: the client
+ *
+ * @note Clients can not be removed, there are at most TAL_SLEEP_CLIENT_MAX.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_cpu_sleep_client_register(const char *name, TAL_SLEEP_DEADLINE_CB cb, void *arg,
+                                          TAL_SLEEP_CLIENT_HANDLE *handle);
+
+/**
+ * @brief keep the CPU awake until tal_cpu_sleep_release(), disables low power
+ * like tal_cpu_lp_disable()
+ *
+ * @param[in] handle: the client, holding twice is the same as once
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_cpu_sleep_hold(TAL_SLEEP_CLIENT_HANDLE handle);
+
+/**
+ * @brief end the hold of a client
+ *
+ * @param[in] handle: the client
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_cpu_sleep_release(TAL_SLEEP_CLIENT_HANDLE handle);
+
+/**
+ * @brief allow TUYA_CPU_DEEP_SLEEP for long idle times, off by default as
+ * it stops peripherals on some chips
+ *
+ * @param[in] is_allowed: allow deep sleep
+ *
+ * @return none
+ */
+void tal_cpu_sleep_allow_deep(BOOL_T is_allowed);
+
+/**
+ * @brief ask every client when the CPU is next needed
+ *
+ * @param[out] plan: the nearest deadline and the mode for it
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_cpu_sleep_plan(TAL_SLEEP_PLAN_T *plan);
+
+/**
+ * @brief sleep the calling thread until the nearest deadline, in the deepest
+ * allowed mode
+ *
+ * @param[in] max_ms: longest sleep
+ *
+ * @note Other threads still wake up on their events. Low power mode must be
+ * on, see tal_cpu_set_lp_mode().
+ *
+ * @return OPRT_OK after sleeping, OPRT_RESOURCE_NOT_READY if a client kept
+ * the CPU awake. Others on error, please refer to tuya_error_code.h
+ */
+OPERATE_RET tal_cpu_sleep_enter(uint32_t max_ms);
+
+/**
+ * @brief get the statistics of a sleep client
+ *
+ * @param[in] idx: client index in registration order
+ * @param[out] stat: client statistics
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_cpu_sleep_client_stat_get(uint8_t idx, TAL_SLEEP_CLIENT_STAT_T *stat);
+
+/**
+ * @brief print the sleep statistics of all clients
+ *
+ * @return none
+ */
+void tal_cpu_sleep_dump(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,187 +1,280 @@
-/**
- * @file tal_sw_timer.h
- * @brief Provides software timer management functions for Tuya IoT
- * applications.
- *
- * This header file defines the interface for managing software timers in Tuya
- * IoT applications, including functions for initializing the timer system,
- * creating, starting, stopping, deleting timers, and querying timer status.
- * Software timers facilitate time-based operations and scheduling in
- * applications, allowing for timed actions, periodic tasks, and timeout
- * mechanisms without relying on hardware timer resources.
- *
- * The API abstracts the underlying implementation details, offering a simple
- * and efficient way to incorporate timing and scheduling capabilities into IoT
- * applications. This is particularly useful in scenarios where precise timing
- * or periodic task execution is required.
- *
- * @note This file is part of the Tuya IoT Development Platform and is intended
- * for use in Tuya-based applications. It is subject to the platform's license
- * and copyright terms.
- *
- * @copyright Copyright (c) 2021-2024 Tuya Inc. All Rights Reserved.
- *
- */
-
-#ifndef __TAL_SW_TIMER_H__
-#define __TAL_SW_TIMER_H__
-
-#include "tuya_cloud_types.h"
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-/***********************************************************************
- ********************* constant ( macro and enum ) *********************
- **********************************************************************/
-/**
- * @brief the type of timer
- */
-typedef enum {
-    TAL_TIMER_ONCE = 0,
-    TAL_TIMER_CYCLE,
-} TIMER_TYPE;
-
-/***********************************************************************
- ********************* struct ******************************************
- **********************************************************************/
-// Timer ID
-typedef void *TIMER_ID;
-
-typedef void (*TAL_TIMER_CB)(TIMER_ID timer_id, void *arg);
-
-/***********************************************************************
- ********************* variable ****************************************
- **********************************************************************/
-
-/***********************************************************************
- ********************* function ****************************************
- **********************************************************************/
-
-/**
- * @brief Initializing the software timer
- *
- * @param void
- *
- * @note This API is used for initializing the software timer
- *
- * @return OPRT_OK on success. Others on error, please refer to
- * tuya_error_code.h
- */
-OPERATE_RET tal_sw_timer_init(void);
-
-/**
- * @brief create a software timer
- *
- * @param[in] func: the processing function of the timer
- * @param[in] arg: the parameater of the timer function
- * @param[out] timer_id: timer id
- *
- * @note This API is used for create a software timer
- *
- * @return OPRT_OK on success. Others on error, please refer to
- * tuya_error_code.h
- */
-OPERATE_RET tal_sw_timer_create(TAL_TIMER_CB func, void *arg, TIMER_ID *timer_id);
-
-/**
- * @brief Delete the software timer
- *
- * @param[in] timer_id: timer id
- *
- * @note This API is used for deleting the software timer
- *
- * @return OPRT_OK on success. Others on error, please refer to
- * tuya_error_code.h
- */
-OPERATE_RET tal_sw_timer_delete(TIMER_ID timer_id);
-
-/**
- * @brief Stop the software timer
- *
- * @param[in] timer_id: timer id
- *
- * @note This API is used for stopping the software timer
- *
- * @return OPRT_OK on success. Others on error, please refer to
- * tuya_error_code.h
- */
-OPERATE_RET tal_sw_timer_stop(TIMER_ID timer_id);
-
-/**
- * @brief Identify the software timer is running
- *
- * @param[in] timer_id: timer id
- *
- * @note This API is used to identify wheather the software timer is running
- *
- * @return TRUE or FALSE
- */
-BOOL_T tal_sw_timer_is_running(TIMER_ID timer_id);
-
-/**
- * @brief Identify the software timer is running
- *
- * @param[in] timer_id: timer id
- * @param[in] remain_time: ms
- *
- * @return OPRT_OK on success. Others on error, please refer to
- * tuya_error_code.h
- */
-OPERATE_RET tal_sw_timer_remain_time_get(TIMER_ID timer_id, uint32_t *remain_time);
-
-/**
- * @brief Start the software timer
- *
- * @param[in] timer_id: timer id
- * @param[in] time_ms: timer running cycle
- * @param[in] timer_type: timer type
- *
- * @note This API is used for starting the software timer
- *
- * @return OPRT_OK on success. Others on error, please refer to
- * tuya_error_code.h
- */
-OPERATE_RET tal_sw_timer_start(TIMER_ID timer_id, TIME_MS time_ms, TIMER_TYPE timer_type);
-
-/**
- * @brief Trigger the software timer
- *
- * @param[in] timer_id: timer id
- *
- * @note This API is used for triggering the software timer instantly.
- *
- * @return OPRT_OK on success. Others on error, please refer to
- * tuya_error_code.h
- */
-OPERATE_RET tal_sw_timer_trigger(TIMER_ID timer_id);
-
-/**
- * @brief Release all resource of the software timer
- *
- * @param void
- *
- * @note This API is used for releasing all resource of the software timer
- *
- * @return OPRT_OK on success. Others on error, please refer to
- * tuya_error_code.h
- */
-OPERATE_RET tal_sw_timer_release(void);
-
-/**
- * @brief Get timer node currently
- *
- * @param void
- *
- * @note This API is used for getting the timer node currently.
- *
- * @return the timer node count.
- */
-int tal_sw_timer_get_num(void);
-
-#ifdef __cplusplus
-}
-#endif
-
-#endif /* __TAL_SW_TIMER_H__ */
+/**
+ * @file tal_sw_timer.h
+ * @brief Provides software timer management functions for Tuya IoT
+ * applications.
+ *
+ * This header file defines the interface for managing software timers in Tuya
+ * IoT applications, including functions for initializing the timer system,
+ * creating, starting, stopping, deleting timers, and querying timer status.
+ * Software timers facilitate time-based operations and scheduling in
+ * applications, allowing for timed actions, periodic tasks, and timeout
+ * mechanisms without relying on hardware timer resources.
+ *
+ * The API abstracts the underlying implementation details, offering a simple
+ * and efficient way to incorporate timing and scheduling capabilities into IoT
+ * applications. This is particularly useful in scenarios where precise timing
+ * or periodic task execution is required.
+ *
+ * @note This file is part of the Tuya IoT Development Platform and is intended
+ * for use in Tuya-based applications. It is subject to the platform's license
+ * and copyright terms.
+ *
+ * @copyright Copyright (c) 2021-2024 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __TAL_SW_TIMER_H__
+#define __TAL_SW_TIMER_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************************
+ ********************* constant ( macro and enum ) *********************
+ **********************************************************************/
+/**
+ * @brief the type of timer
+ */
+typedef enum {
+    TAL_TIMER_ONCE = 0,
+    TAL_TIMER_CYCLE,
+} TIMER_TYPE;
+
+/**
+ * @brief where the callback of a timer runs
+ */
+typedef enum {
+    TAL_TIMER_EXEC_INLINE = 0, // in the timer thread, the default, it delays every other timer while it runs
+    TAL_TIMER_EXEC_WORKQ,      // posted to the WORKQ_SYSTEM workqueue, may block
+    TAL_TIMER_EXEC_LANE,       // posted to a high priority thread shared by the lane timers, must not block
+} TAL_TIMER_EXEC_E;
+
+// a callback running longer than this is counted as an overrun
+#ifndef TAL_SW_TIMER_OVERRUN_MS
+#define TAL_SW_TIMER_OVERRUN_MS 20
+#endif
+
+/***********************************************************************
+ ********************* struct ******************************************
+ **********************************************************************/
+// Timer ID
+typedef void *TIMER_ID;
+
+typedef void (*TAL_TIMER_CB)(TIMER_ID timer_id, void *arg);
+
+/**
+ * @brief callback statistics, see tal_sw_timer_stat_get()
+ */
+typedef struct {
+    uint32_t dispatched;  // expiries handled, run inline or posted
+    uint32_t skipped;     // expiries not posted, the last post had not run yet or the queue was full
+    uint32_t overrun_cnt; // callbacks that ran longer than TAL_SW_TIMER_OVERRUN_MS
+    uint32_t max_cb_ms;   // longest callback
+    TAL_TIMER_CB max_cb;  // the callback that took max_cb_ms
+    uint32_t max_late_ms; // most a callback started after its expire time
+} TAL_SW_TIMER_STAT_T;
+
+/***********************************************************************
+ ********************* variable ****************************************
+ **********************************************************************/
+
+/***********************************************************************
+ ********************* function ****************************************
+ **********************************************************************/
+
+/**
+ * @brief Initializing the software timer
+ *
+ * @param void
+ *
+ * @note This API is used for initializing the software timer
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_sw_timer_init(void);
+
+/**
+ * @brief create a software timer
+ *
+ * @param[in] func: the processing function of the timer
+ * @param[in] arg: the parameater of the timer function
+ * @param[out] timer_id: timer id
+ *
+ * @note This API is used for create a software timer
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_sw_timer_create(TAL_TIMER_CB func, void *arg, TIMER_ID *timer_id);
+
+// 8-byte words that hold one timer, checked against the real size in
+// tal_sw_timer.c
+#define TAL_SW_TIMER_STATIC_WORDS 16
+
+typedef struct {
+    uint64_t opaque[TAL_SW_TIMER_STATIC_WORDS];
+} TAL_SW_TIMER_STATIC_T;
+
+// declare the storage of a long-lived timer
+#define TAL_SW_TIMER_DEFINE_STATIC(name) static TAL_SW_TIMER_STATIC_T name
+
+/**
+ * @brief create a software timer in caller-provided storage
+ *
+ * @param[in] storage: the timer, usually from TAL_SW_TIMER_DEFINE_STATIC, valid
+ * until the timer is deleted
+ * @param[in] func: the processing function of the timer
+ * @param[in] arg: the parameater of the timer function
+ * @param[out] timer_id: timer id
+ *
+ * @note While the storage is held by a deleted timer whose callback has not
+ * returned yet, the timer falls back to the heap.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_sw_timer_create_static(TAL_SW_TIMER_STATIC_T *storage, TAL_TIMER_CB func, void *arg,
+                                       TIMER_ID *timer_id);
+
+/**
+ * @brief Delete the software timer
+ *
+ * @param[in] timer_id: timer id
+ *
+ * @note This API is used for deleting the software timer
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_sw_timer_delete(TIMER_ID timer_id);
+
+/**
+ * @brief Stop the software timer
+ *
+ * @param[in] timer_id: timer id
+ *
+ * @note This API is used for stopping the software timer
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_sw_timer_stop(TIMER_ID timer_id);
+
+/**
+ * @brief Identify the software timer is running
+ *
+ * @param[in] timer_id: timer id
+ *
+ * @note This API is used to identify wheather the software timer is running
+ *
+ * @return TRUE or FALSE
+ */
+BOOL_T tal_sw_timer_is_running(TIMER_ID timer_id);
+
+/**
+ * @brief Identify the software timer is running
+ *
+ * @param[in] timer_id: timer id
+ * @param[in] remain_time: ms
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_sw_timer_remain_time_get(TIMER_ID timer_id, uint32_t *remain_time);
+
+/**
+ * @brief Start the software timer
+ *
+ * @param[in] timer_id: timer id
+ * @param[in] time_ms: timer running cycle
+ * @param[in] timer_type: timer type
+ *
+ * @note This API is used for starting the software timer
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_sw_timer_start(TIMER_ID timer_id, TIME_MS time_ms, TIMER_TYPE timer_type);
+
+/**
+ * @brief Trigger the software timer
+ *
+ * @param[in] timer_id: timer id
+ *
+ * @note This API is used for triggering the software timer instantly.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_sw_timer_trigger(TIMER_ID timer_id);
+
+/**
+ * @brief Choose where the callback of a timer runs
+ *
+ * @param[in] timer_id: timer id
+ * @param[in] exec: see TAL_TIMER_EXEC_E
+ *
+ * @note A posted callback never runs twice at the same time, an expiry while
+ * the last post is pending is skipped. The timer may be deleted at any time,
+ * a pending callback that has not started is dropped.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_sw_timer_set_exec(TIMER_ID timer_id, TAL_TIMER_EXEC_E exec);
+
+/**
+ * @brief Get the callback statistics
+ *
+ * @param[out] stat: statistics
+ * @param[in] is_reset: TRUE to clear them after reading
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_sw_timer_stat_get(TAL_SW_TIMER_STAT_T *stat, BOOL_T is_reset);
+
+/**
+ * @brief Release all resource of the software timer
+ *
+ * @param void
+ *
+ * @note This API is used for releasing all resource of the software timer
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_sw_timer_release(void);
+
+/**
+ * @brief Get timer node currently
+ *
+ * @param void
+ *
+ * @note This API is used for getting the timer node currently.
+ *
+ * @return the timer node count.
+ */
+int tal_sw_timer_get_num(void);
+
+/**
+ * @brief Get the time until the timer thread next has work
+ *
+ * @param void
+ *
+ * @note The wheel may wake up before the nearest expiry to move long timers
+ * down a level, the result is never later than it.
+ *
+ * @return ms until then, 0 if callbacks are due, 0xFFFFFFFF if no timer is running.
+ */
+uint32_t tal_sw_timer_get_next_ms(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TAL_SW_TIMER_H__ */
@@ -1,148 +1,274 @@
-/**
- * @file tal_thread.h
- * @brief Provides thread management functions for Tuya IoT applications.
- *
- * This header file defines the interface for thread management in Tuya IoT
- * applications, including creating and starting threads, stopping and deleting
- * threads, checking thread context, and getting thread running status. It
- * offers functionalities to manage threads' lifecycle, prioritize tasks, and
- * ensure efficient execution of concurrent operations within Tuya-based IoT
- * applications. The API abstracts underlying threading mechanisms, providing a
- * portable and simplified interface for application development.
- *
- * Thread management is crucial for achieving multitasking and parallel
- * processing in embedded systems, enabling applications to perform multiple
- * operations simultaneously, thus improving responsiveness and operational
- * efficiency.
- *
- * @note This file is part of the Tuya IoT Development Platform and is intended
- * for use in Tuya-based applications. It is subject to the platform's license
- * and copyright terms.
- *
- * @copyright Copyright (c) 2021-2024 Tuya Inc. All Rights Reserved.
- *
- */
-
-#ifndef __TAL_THREAD_H__
-#define __TAL_THREAD_H__
-
-#include "tuya_cloud_types.h"
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-typedef void *THREAD_HANDLE;
-
-/**
- * @brief max length of thread name
- *
- */
-#define TAL_THREAD_MAX_NAME_LEN 16
-
-/**
- * @brief thread process function
- *
- */
-typedef void (*THREAD_FUNC_CB)(void *args);
-/**
- * @brief thread enter function
- *
- */
-typedef void (*THREAD_ENTER_CB)(void);
-
-/**
- * @brief thread exut function
- *
- */
-typedef void (*THREAD_EXIT_CB)(void); // thread extract
-/**
- * @brief thread running status
- *
- */
-typedef enum {
-    THREAD_STATE_EMPTY = 0,
-    THREAD_STATE_RUNNING,
-    THREAD_STATE_STOP,
-    THREAD_STATE_DELETE,
-} THREAD_STATE_E;
-
-/**
- * @brief thread priority
- *
- */
-typedef enum {
-    THREAD_PRIO_0 = 5,
-    THREAD_PRIO_1 = 4,
-    THREAD_PRIO_2 = 3,
-    THREAD_PRIO_3 = 2,
-    THREAD_PRIO_4 = 1,
-    THREAD_PRIO_5 = 0,
-    THREAD_PRIO_6 = 0,
-} THREAD_PRIO_E;
-/**
- * @brief thread parameters
- *
- */
-typedef struct {
-    uint32_t stackDepth; // stack size
-    uint8_t priority;    // thread priority
-    char *thrdname;      // thread name
-} THREAD_CFG_T;
-
-/**
- * @brief create and start a tuya sdk thread
- *
- * @param[in] enter: the function called before the thread process called.can be
- * null
- * @param[in] exit: the function called after the thread process called.can be
- * null
- * @param[in] func: the main thread process function
- * @param[in] func_args: the args of the pThrdFunc.can be null
- * @param[in] cfg: the param of creating a thread
- * @param[out] handle: the tuya sdk thread context
- * @return OPRT_OK on success. Others on error, please refer to
- * tuya_error_code.h
- */
-OPERATE_RET tal_thread_create_and_start(THREAD_HANDLE *handle, const THREAD_ENTER_CB enter, const THREAD_EXIT_CB exit,
-                                        const THREAD_FUNC_CB func, const void *func_args, const THREAD_CFG_T *cfg);
-/**
- * @brief stop and free a tuya sdk thread
- *
- * @param[in] handle: the input thread context
- * @return OPRT_OK on success. Others on error, please refer to
- * tuya_error_code.h
- */
-OPERATE_RET tal_thread_delete(const THREAD_HANDLE handle);
-
-/**
- * @brief check the function caller is in the input thread context
- *
- * @param[in] handle: the input thread context
- * @param[in] bl: run in self space
- * @return OPRT_OK on success. Others on error, please refer to
- * tuya_error_code.h
- */
-OPERATE_RET tal_thread_is_self(const THREAD_HANDLE handle, BOOL_T *bl);
-
-/**
- * @brief get the thread context running status
- *
- * @param[in] thrdHandle: the input thread context
- * @return the thread status
- */
-THREAD_STATE_E tal_thread_get_state(const THREAD_HANDLE handle);
-
-/**
- * @brief diagnose the thread(dump task stack, etc.)
- *
- * @param[in] thrdHandle: the input thread context
- * @return OPRT_OK on success. Others on error, please refer to
- * tuya_error_code.h
- */
-OPERATE_RET tal_thread_diagnose(const THREAD_HANDLE handle);
-#ifdef __cplusplus
-}
-#endif /* __cplusplus */
-
-#endif
+/**
+ * @file tal_thread.h
+ * @brief Provides thread management functions for Tuya IoT applications.
+ *
+ * This header file defines the interface for thread management in Tuya IoT
+ * applications, including creating and starting threads, stopping and deleting
+ * threads, checking thread context, and getting thread running status. It
+ * offers functionalities to manage threads' lifecycle, prioritize tasks, and
+ * ensure efficient execution of concurrent operations within Tuya-based IoT
+ * applications. The API abstracts underlying threading mechanisms, providing a
+ * portable and simplified interface for application development.
+ *
+ * Thread management is crucial for achieving multitasking and parallel
+ * processing in embedded systems, enabling applications to perform multiple
+ * operations simultaneously, thus improving responsiveness and operational
+ * efficiency.
+ *
+ * @note This file is part of the Tuya IoT Development Platform and is intended
+ * for use in Tuya-based applications. It is subject to the platform's license
+ * and copyright terms.
+ *
+ * @copyright Copyright (c) 2021-2024 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __TAL_THREAD_H__
+#define __TAL_THREAD_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void *THREAD_HANDLE;
+
+/**
+ * @brief max length of thread name
+ *
+ */
+#define TAL_THREAD_MAX_NAME_LEN 16
+
+/**
+ * @brief thread process function
+ *
+ */
+typedef void (*THREAD_FUNC_CB)(void *args);
+/**
+ * @brief thread enter function
+ *
+ */
+typedef void (*THREAD_ENTER_CB)(void);
+
+/**
+ * @brief thread exut function
+ *
+ */
+typedef void (*THREAD_EXIT_CB)(void); // thread extract
+/**
+ * @brief thread running status
+ *
+ */
+typedef enum {
+    THREAD_STATE_EMPTY = 0,
+    THREAD_STATE_RUNNING,
+    THREAD_STATE_STOP,
+    THREAD_STATE_DELETE,
+} THREAD_STATE_E;
+
+/**
+ * @brief thread priority
+ *
+ */
+typedef enum {
+    THREAD_PRIO_0 = 5,
+    THREAD_PRIO_1 = 4,
+    THREAD_PRIO_2 = 3,
+    THREAD_PRIO_3 = 2,
+    THREAD_PRIO_4 = 1,
+    THREAD_PRIO_5 = 0,
+    THREAD_PRIO_6 = 0,
+} THREAD_PRIO_E;
+/**
+ * @brief thread parameters
+ *
+ */
+typedef struct {
+    uint32_t stackDepth; // stack size
+    uint8_t priority;    // thread priority
+    char *thrdname;      // thread name
+} THREAD_CFG_T;
+
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+/*
+ * Thread profile. The kernel layer has no run time counters, so a thread is
+ * taken as busy while it is not blocked in tal_semaphore_wait(),
+ * tal_queue_fetch() or tal_system_sleep(). Busy time includes time the
+ * thread was ready but preempted, and waits in the OS or vendor code directly
+ * are not seen. Threads not created by tal_thread_create_and_start() are not
+ * profiled.
+ */
+// threads profiled at the same time
+#ifndef TAL_THREAD_PROF_MAX_NUM
+#define TAL_THREAD_PROF_MAX_NUM 32
+#endif
+
+// busy_pct is measured over windows of this length
+#ifndef TAL_THREAD_PROF_WINDOW_MS
+#define TAL_THREAD_PROF_WINDOW_MS (5 * 1000)
+#endif
+
+typedef struct {
+    char name[TAL_THREAD_MAX_NAME_LEN];
+    uint32_t stack_size;
+    uint32_t stack_free;   // lowest free stack, 0 if the OS does not track it
+    uint8_t busy_pct;      // share of the last completed window not spent waiting
+    uint32_t wake_cnt;     // returns from a blocking wait
+    uint32_t max_block_ms; // longest single wait, including the current one
+} TAL_THREAD_PROF_T;
+#endif
+
+// 8-byte words that hold the control block of one thread, checked against
+// the real size in tal_thread.c
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+#define TAL_THREAD_STATIC_WORDS (18 + TAL_THREAD_MAX_NAME_LEN / 8)
+#else
+#define TAL_THREAD_STATIC_WORDS (12 + TAL_THREAD_MAX_NAME_LEN / 8)
+#endif
+
+/**
+ * @brief caller-provided control block of a thread, see
+ * tal_thread_create_static()
+ *
+ */
+typedef struct {
+    uint64_t opaque[TAL_THREAD_STATIC_WORDS];
+} TAL_THREAD_STATIC_T;
+
+// declare the control block of a long-lived thread
+#define TAL_THREAD_DEFINE_STATIC(name) static TAL_THREAD_STATIC_T name
+
+/**
+ * @brief create and start a tuya sdk thread
+ *
+ * @param[in] enter: the function called before the thread process called.can be
+ * null
+ * @param[in] exit: the function called after the thread process called.can be
+ * null
+ * @param[in] func: the main thread process function
+ * @param[in] func_args: the args of the pThrdFunc.can be null
+ * @param[in] cfg: the param of creating a thread
+ * @param[out] handle: the tuya sdk thread context
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_thread_create_and_start(THREAD_HANDLE *handle, const THREAD_ENTER_CB enter, const THREAD_EXIT_CB exit,
+                                        const THREAD_FUNC_CB func, const void *func_args, const THREAD_CFG_T *cfg);
+
+/**
+ * @brief create and start a tuya sdk thread with its control block in
+ * caller-provided storage
+ *
+ * The storage must stay valid until the thread is deleted. The stack still
+ * comes from the kernel layer. While the storage is held by a thread that is
+ * not freed yet, the control block falls back to the heap.
+ *
+ * @param[in] storage: control block, usually from TAL_THREAD_DEFINE_STATIC
+ * @param[in] enter: the function called before the thread process called.can be
+ * null
+ * @param[in] exit: the function called after the thread process called.can be
+ * null
+ * @param[in] func: the main thread process function
+ * @param[in] func_args: the args of the pThrdFunc.can be null
+ * @param[in] cfg: the param of creating a thread
+ * @param[out] handle: the tuya sdk thread context
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_thread_create_static(THREAD_HANDLE *handle, TAL_THREAD_STATIC_T *storage, const THREAD_ENTER_CB enter,
+                                     const THREAD_EXIT_CB exit, const THREAD_FUNC_CB func, const void *func_args,
+                                     const THREAD_CFG_T *cfg);
+/**
+ * @brief stop and free a tuya sdk thread
+ *
+ * @param[in] handle: the input thread context
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_thread_delete(const THREAD_HANDLE handle);
+
+/**
+ * @brief check the function caller is in the input thread context
+ *
+ * @param[in] handle: the input thread context
+ * @param[in] bl: run in self space
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_thread_is_self(const THREAD_HANDLE handle, BOOL_T *bl);
+
+/**
+ * @brief get the thread context running status
+ *
+ * @param[in] thrdHandle: the input thread context
+ * @return the thread status
+ */
+THREAD_STATE_E tal_thread_get_state(const THREAD_HANDLE handle);
+
+/**
+ * @brief diagnose the thread(dump task stack, etc.)
+ *
+ * @param[in] thrdHandle: the input thread context
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_thread_diagnose(const THREAD_HANDLE handle);
+
+/**
+ * @brief get the name of a tal thread from its os thread id
+ *
+ * @param[in] id: os thread id, as given by tkl_thread_get_id()
+ * @param[out] name: the thread name
+ * @param[in] len: size of name
+ * @return OPRT_OK on success, OPRT_NOT_FOUND if no tal thread has this id
+ */
+OPERATE_RET tal_thread_get_name_by_id(const void *id, char *name, uint32_t len);
+
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+/**
+ * @brief get the profile of a thread
+ *
+ * @param[in] handle: the input thread context
+ * @param[out] prof: the thread profile
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_thread_get_prof(const THREAD_HANDLE handle, TAL_THREAD_PROF_T *prof);
+
+/**
+ * @brief get the profiles of all running threads
+ *
+ * @param[out] prof: array of num profiles
+ * @param[in] num: array size
+ * @return the number of profiles filled
+ */
+uint32_t tal_thread_get_prof_all(TAL_THREAD_PROF_T *prof, uint32_t num);
+
+/**
+ * @brief clear the wake counts and the longest waits of all threads
+ *
+ * @return none
+ */
+void tal_thread_prof_reset(void);
+
+/**
+ * @brief mark the calling thread as blocked, called by the TAL wait functions
+ *
+ * @return context for tal_thread_prof_wait_end(), NULL if the thread is not profiled
+ */
+void *tal_thread_prof_wait_begin(void);
+
+/**
+ * @brief mark the calling thread as running again
+ *
+ * @param[in] ctx: return value of tal_thread_prof_wait_begin()
+ * @return none
+ */
+void tal_thread_prof_wait_end(void *ctx);
+#endif
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif
@@ -147,6 +147,17 @@ TIME_T tal_time_get_posix(void);
  */
 SYS_TICK_T tal_time_get_posix_ms(void);
 
+/**
+ * @brief get the time since boot in micro-seconds, monotonic and not affected
+ * by time synchronization
+ *
+ * @note The resolution is that of tal_system_get_millisecond(), unless the
+ * platform maps TAL_TIME_MONO_US() to a finer counter.
+ *
+ * @return the current micro-second time
+ */
+uint64_t tal_time_get_mono_us(void);
+
 /**
  * @brief get IoTOS last synchronized UTC time in TIME_T format
  *
@@ -0,0 +1,180 @@
+/**
+ * @file tal_trace.h
+ * @brief Ring of timing records for field diagnosis.
+ *
+ * While a trace runs, the workqueue workers and the software timers record
+ * every callback they run with its start time and duration, threads record
+ * the time they block in semaphores, queues, sleeps and contended mutexes,
+ * and drivers and applications add their own spans and marks. Once stopped
+ * the ring is kept until the next start, so it can be read afterwards or
+ * dumped as text for tools/trace/trace2chrome.py. When no trace runs a record
+ * point costs one flag test.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __TAL_TRACE_H__
+#define __TAL_TRACE_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***********************************************************************
+ ********************* constant ( macro and enum ) *********************
+ **********************************************************************/
+// records kept, the oldest are overwritten
+#ifndef TAL_TRACE_NUM
+#define TAL_TRACE_NUM 256
+#endif
+
+// mutex waits shorter than this are not recorded
+#ifndef TAL_TRACE_MUTEX_MIN_US
+#define TAL_TRACE_MUTEX_MIN_US 1000
+#endif
+
+// time base of the records, a platform with a finer counter can map it here
+#ifndef TAL_TRACE_TIME_US
+#define TAL_TRACE_TIME_US() ((uint32_t)(tal_system_get_millisecond() * 1000))
+#endif
+
+typedef enum {
+    TAL_TRACE_TIMER,       // software timer callback, obj the callback
+    TAL_TRACE_WORK,        // workqueue item, obj the callback
+    TAL_TRACE_USER,        // span recorded by the application, obj its name
+    TAL_TRACE_THREAD,      // a tal thread started, obj its function, no duration
+    TAL_TRACE_ISR,         // interrupt handler, obj its name
+    TAL_TRACE_MUTEX_WAIT,  // waited for a mutex, obj the mutex
+    TAL_TRACE_SEM_WAIT,    // blocked in a semaphore, obj the semaphore
+    TAL_TRACE_QUEUE_POST,  // message posted, obj the queue, no duration
+    TAL_TRACE_QUEUE_FETCH, // blocked in a queue, obj the queue
+    TAL_TRACE_SLEEP,       // tal_system_sleep()
+    TAL_TRACE_MARK,        // point reached, obj its name, no duration
+    TAL_TRACE_MUTEX_HOLD,  // long hold of a profiled mutex, obj the mutex
+    TAL_TRACE_TYPE_MAX,
+} TAL_TRACE_TYPE_E;
+
+/***********************************************************************
+ ********************* struct ******************************************
+ **********************************************************************/
+typedef struct {
+    uint32_t start_us; // TAL_TRACE_TIME_US() when it started
+    uint32_t cost_us;
+    const void *obj;   // callback, name or handle, see TAL_TRACE_TYPE_E
+    void *thread;      // tkl_thread_get_id() of the thread that recorded it
+    uint8_t type;      // TAL_TRACE_TYPE_E
+} TAL_TRACE_REC_T;
+
+/**
+ * @brief Receives the dump one line at a time.
+ *
+ * @param[in] line text without line end
+ * @param[in] arg arg of tal_trace_dump()
+ *
+ * @return OPRT_OK to go on, others stop the dump
+ */
+typedef OPERATE_RET (*TAL_TRACE_OUTPUT_CB)(const char *line, void *arg);
+
+/***********************************************************************
+ ********************* function ****************************************
+ **********************************************************************/
+
+/**
+ * @brief Clears the ring and starts recording.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_trace_start(void);
+
+/**
+ * @brief Stops recording, the records are kept.
+ *
+ * @return none
+ */
+void tal_trace_stop(void);
+
+/**
+ * @brief Tells if a trace runs, a record point checks it before timing its
+ * callback.
+ *
+ * @return TRUE while recording
+ */
+BOOL_T tal_trace_is_running(void);
+
+/**
+ * @brief Gets the time for a span start.
+ *
+ * @return TAL_TRACE_TIME_US(), 0 when no trace runs
+ */
+uint32_t tal_trace_now(void);
+
+/**
+ * @brief Records one callback or span, does nothing when no trace runs.
+ *
+ * @param[in] type TAL_TRACE_TYPE_E
+ * @param[in] obj callback, name or handle
+ * @param[in] start_us when it started
+ * @param[in] cost_us how long it ran
+ *
+ * @note Safe in interrupts and from several cores, a slot of the ring is
+ * taken with one atomic add.
+ *
+ * @return none
+ */
+void tal_trace_record(TAL_TRACE_TYPE_E type, const void *obj, uint32_t start_us, uint32_t cost_us);
+
+/**
+ * @brief Records a span from start_us to now, does nothing when no trace
+ * runs or start_us is 0.
+ *
+ * @param[in] type TAL_TRACE_TYPE_E
+ * @param[in] obj callback, name or handle, names must be constant strings
+ * @param[in] start_us tal_trace_now() at the start
+ *
+ * @return none
+ */
+void tal_trace_span_end(TAL_TRACE_TYPE_E type, const void *obj, uint32_t start_us);
+
+/**
+ * @brief Records that a point was reached.
+ *
+ * @param[in] name constant string
+ *
+ * @return none
+ */
+void tal_trace_mark(const char *name);
+
+/**
+ * @brief Copies the records, oldest first.
+ *
+ * @param[out] rec records
+ * @param[in] num size of rec
+ *
+ * @return the number of records copied
+ */
+uint32_t tal_trace_get(TAL_TRACE_REC_T *rec, uint32_t num);
+
+/**
+ * @brief Writes the records as text lines for tools/trace/trace2chrome.py.
+ *
+ * "TRACE,<type>,<start_us>,<cost_us>,<thread>,<obj>[,<name>]" per record,
+ * oldest first, then "TRACE_THREAD,<thread>,<name>" for the tal threads
+ * seen and "TRACE_END,<records>,<overwritten>". Stop the trace first so the
+ * ring does not move during the dump.
+ *
+ * @param[in] out line output
+ * @param[in] arg passed to out
+ *
+ * @return the number of records written
+ */
+uint32_t tal_trace_dump(TAL_TRACE_OUTPUT_CB out, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TAL_TRACE_H__ */
@@ -28,7 +28,8 @@
  */
 typedef enum {
     /**
-     * low priority workqueue(block operations are allowed)
+     * low priority workqueue(block operations are allowed), runs on
+     * WORKQ_SYSTEM_WORKER_NUM threads so works may run in parallel
      */
     WORKQ_SYSTEM,
     /**
@@ -78,6 +79,20 @@ OPERATE_RET tal_workq_schedule(WORKQ_SERVICE_E service, WORKQUEUE_CB cb, void *d
  */
 OPERATE_RET tal_workq_schedule_instant(WORKQ_SERVICE_E service, WORKQUEUE_CB cb, void *data);
 
+/**
+ * @brief put work task in a priority lane of a workqueue service, high items
+ * run before the backlog of normal ones
+ *
+ * @param[in] service the workqueue service
+ * @param[in] prio the lane, see WORKQ_PRIO_E
+ * @param[in] cb the work callback
+ * @param[in] data the work data
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_workq_schedule_prio(WORKQ_SERVICE_E service, WORKQ_PRIO_E prio, WORKQUEUE_CB cb, void *data);
+
 /**
  * @brief cancel work task in workqueue
  *
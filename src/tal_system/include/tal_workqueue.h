@@ -30,6 +30,21 @@ extern "C" {
 
 typedef enum { LOOP_ONCE, LOOP_CYCLE } LOOP_TYPE;
 
+/**
+ * @brief priority lanes of a workqueue
+ *
+ * High items run before any normal item and low items only when no normal
+ * item is waiting, a busy normal lane can hold low items back indefinitely.
+ * Each lane is first in first out. An item that is already running is not
+ * interrupted.
+ */
+typedef enum {
+    WORKQ_PRIO_HIGH = 0,
+    WORKQ_PRIO_NORMAL,
+    WORKQ_PRIO_LOW,
+    WORKQ_PRIO_MAX,
+} WORKQ_PRIO_E;
+
 typedef void *WORKQUEUE_HANDLE;
 typedef void (*WORKQUEUE_CB)(void *data);
 
@@ -52,6 +67,29 @@ typedef BOOL_T (*WORKQUEUE_TRAVERSE_CB)(WORK_ITEM_T *item, void *ctx);
  */
 OPERATE_RET tal_workqueue_create(const uint16_t queue_len, THREAD_CFG_T *thread_cfg, WORKQUEUE_HANDLE *handle);
 
+/**
+ * @brief create and initialize a workqueue that runs its items on several
+ * threads
+ *
+ * @param[in] queue_len the maximum number of items of each worker
+ * @param[in] worker_num number of worker threads
+ * @param[in] thread_cfg thread param of every worker, the name gets the
+ * worker index appended when there are several
+ * @param[out] handle the workqueue handle
+ *
+ * @note Every worker has its own queue, new items go to the shortest one and
+ * a worker without items takes them from the others, so one blocking item
+ * holds up only its own worker. Items may run in parallel and complete out of
+ * order, instant items are only dequeued first by the worker they land on.
+ * All other workqueue APIs work on a pool, tal_workqueue_get_thread returns
+ * the first worker.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_workqueue_create_pool(const uint16_t queue_len, const uint8_t worker_num, THREAD_CFG_T *thread_cfg,
+                                      WORKQUEUE_HANDLE *handle);
+
 /**
  * @brief put work task in workqueue
  *
@@ -76,6 +114,23 @@ OPERATE_RET tal_workqueue_schedule(WORKQUEUE_HANDLE handle, WORKQUEUE_CB cb, voi
  */
 OPERATE_RET tal_workqueue_schedule_instant(WORKQUEUE_HANDLE handle, WORKQUEUE_CB cb, void *data);
 
+/**
+ * @brief put work task in a priority lane of the workqueue
+ *
+ * @param[in] handle the workqueue handle
+ * @param[in] prio the lane, WORKQ_PRIO_NORMAL is the same as
+ * tal_workqueue_schedule
+ * @param[in] cb the work callback
+ * @param[in] data the work data
+ *
+ * @note The high and low lanes hold queue_len items each and are shared by
+ * all workers of a pool.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_workqueue_schedule_prio(WORKQUEUE_HANDLE handle, WORKQ_PRIO_E prio, WORKQUEUE_CB cb, void *data);
+
 /**
  * @brief cancel work task in workqueue
  *
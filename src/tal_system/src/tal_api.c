@@ -20,14 +20,21 @@
  *
  */
 
+#include <string.h>
+
 #include "tkl_semaphore.h"
 #include "tkl_mutex.h"
 #include "tkl_ota.h"
 #include "tkl_queue.h"
+#include "tkl_thread.h"
 #include "tal_mutex.h"
 #include "tal_semaphore.h"
 #include "tal_queue.h"
 #include "tal_ota.h"
+#include "tal_thread.h"
+#include "tal_system.h"
+#include "tal_trace.h"
+#include "tal_memory.h"
 
 //! sem
 OPERATE_RET tal_semaphore_create_init(SEM_HANDLE *handle, uint32_t sem_cnt, uint32_t sem_max)
@@ -37,7 +44,16 @@ OPERATE_RET tal_semaphore_create_init(SEM_HANDLE *handle, uint32_t sem_cnt, uint
 
 OPERATE_RET tal_semaphore_wait(SEM_HANDLE handle, uint32_t timeout)
 {
-    return tkl_semaphore_wait(handle, timeout);
+    uint32_t trace_us = timeout ? tal_trace_now() : 0;
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+    void *prof = timeout ? tal_thread_prof_wait_begin() : NULL;
+    OPERATE_RET rt = tkl_semaphore_wait(handle, timeout);
+    tal_thread_prof_wait_end(prof);
+#else
+    OPERATE_RET rt = tkl_semaphore_wait(handle, timeout);
+#endif
+    tal_trace_span_end(TAL_TRACE_SEM_WAIT, handle, trace_us);
+    return rt;
 }
 
 OPERATE_RET tal_semaphore_post(SEM_HANDLE handle)
@@ -51,6 +67,202 @@ OPERATE_RET tal_semaphore_release(SEM_HANDLE handle)
 }
 
 //! mutex
+#if defined(ENABLE_MUTEX_PROF) && (ENABLE_MUTEX_PROF == 1)
+//! a tal mutex is the kernel mutex with its profile, the handle points here
+typedef struct {
+    TKL_MUTEX_HANDLE mutex;
+    TAL_MUTEX_PROF_T prof;
+    uint32_t depth;       // recursive locks by the owner
+    SYS_TIME_T hold_since;
+    uint32_t hold_trace_us;
+} MUTEX_PROF_T;
+
+static MUTEX_PROF_T *s_mutex_prof[TAL_MUTEX_PROF_MAX_NUM];
+
+OPERATE_RET tal_mutex_create_init(MUTEX_HANDLE *handle)
+{
+    OPERATE_RET rt = OPRT_OK;
+    MUTEX_PROF_T *m = NULL;
+    uint32_t i = 0;
+
+    if (NULL == handle) {
+        return OPRT_INVALID_PARM;
+    }
+
+    m = tal_malloc(sizeof(MUTEX_PROF_T));
+    if (NULL == m) {
+        return OPRT_MALLOC_FAILED;
+    }
+    memset(m, 0, sizeof(MUTEX_PROF_T));
+    rt = tkl_mutex_create_init(&m->mutex);
+    if (OPRT_OK != rt) {
+        tal_free(m);
+        return rt;
+    }
+    m->prof.handle = m;
+
+    TAL_ENTER_CRITICAL();
+    for (i = 0; i < TAL_MUTEX_PROF_MAX_NUM; i++) {
+        if (NULL == s_mutex_prof[i]) {
+            s_mutex_prof[i] = m;
+            break;
+        }
+    }
+    TAL_EXIT_CRITICAL();
+
+    *handle = m;
+    return OPRT_OK;
+}
+
+OPERATE_RET tal_mutex_lock(const MUTEX_HANDLE handle)
+{
+    MUTEX_PROF_T *m = (MUTEX_PROF_T *)handle;
+    uint32_t trace_us = 0, wait_ms = 0;
+    SYS_TIME_T start = 0;
+    TKL_THREAD_HANDLE self = NULL;
+    OPERATE_RET rt = OPRT_OK;
+
+    if (NULL == m) {
+        return OPRT_INVALID_PARM;
+    }
+
+    //! a failed try is a contended lock
+    if (OPRT_OK != tkl_mutex_trylock(m->mutex)) {
+        trace_us = tal_trace_now();
+        start = tal_system_get_millisecond();
+        rt = tkl_mutex_lock(m->mutex);
+        if (OPRT_OK != rt) {
+            return rt;
+        }
+        wait_ms = (uint32_t)(tal_system_get_millisecond() - start);
+        m->prof.contend_cnt++;
+        m->prof.wait_total_ms += wait_ms;
+        if (wait_ms > m->prof.wait_max_ms) {
+            m->prof.wait_max_ms = wait_ms;
+        }
+        if (trace_us && TAL_TRACE_TIME_US() - trace_us >= TAL_TRACE_MUTEX_MIN_US) {
+            tal_trace_span_end(TAL_TRACE_MUTEX_WAIT, handle, trace_us);
+        }
+    }
+
+    //! the mutex is held from here, the profile needs no other lock
+    if (0 == m->depth++) {
+        tkl_thread_get_id(&self);
+        m->prof.owner = self;
+        m->prof.lock_cnt++;
+        m->hold_since = tal_system_get_millisecond();
+        m->hold_trace_us = tal_trace_now();
+    }
+    return OPRT_OK;
+}
+
+OPERATE_RET tal_mutex_unlock(const MUTEX_HANDLE handle)
+{
+    MUTEX_PROF_T *m = (MUTEX_PROF_T *)handle;
+    uint32_t hold_ms = 0;
+
+    if (NULL == m) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (m->depth && 0 == --m->depth) {
+        hold_ms = (uint32_t)(tal_system_get_millisecond() - m->hold_since);
+        m->prof.hold_total_ms += hold_ms;
+        if (hold_ms > m->prof.hold_max_ms) {
+            m->prof.hold_max_ms = hold_ms;
+            m->prof.hold_max_owner = m->prof.owner;
+        }
+        if (hold_ms >= TAL_MUTEX_PROF_LONG_HOLD_MS) {
+            m->prof.long_hold_cnt++;
+            tal_trace_span_end(TAL_TRACE_MUTEX_HOLD, handle, m->hold_trace_us);
+        }
+        m->prof.owner = NULL;
+    }
+    return tkl_mutex_unlock(m->mutex);
+}
+
+OPERATE_RET tal_mutex_release(const MUTEX_HANDLE handle)
+{
+    MUTEX_PROF_T *m = (MUTEX_PROF_T *)handle;
+    OPERATE_RET rt = OPRT_OK;
+    uint32_t i = 0;
+
+    if (NULL == m) {
+        return OPRT_INVALID_PARM;
+    }
+
+    TAL_ENTER_CRITICAL();
+    for (i = 0; i < TAL_MUTEX_PROF_MAX_NUM; i++) {
+        if (m == s_mutex_prof[i]) {
+            s_mutex_prof[i] = NULL;
+            break;
+        }
+    }
+    TAL_EXIT_CRITICAL();
+
+    rt = tkl_mutex_release(m->mutex);
+    tal_free(m);
+    return rt;
+}
+
+void tal_mutex_set_name(const MUTEX_HANDLE handle, const char *name)
+{
+    if (handle) {
+        ((MUTEX_PROF_T *)handle)->prof.name = name;
+    }
+}
+
+OPERATE_RET tal_mutex_get_prof(const MUTEX_HANDLE handle, TAL_MUTEX_PROF_T *prof)
+{
+    if (NULL == handle || NULL == prof) {
+        return OPRT_INVALID_PARM;
+    }
+
+    *prof = ((MUTEX_PROF_T *)handle)->prof;
+    return OPRT_OK;
+}
+
+uint32_t tal_mutex_get_prof_all(TAL_MUTEX_PROF_T *prof, uint32_t num)
+{
+    uint32_t i = 0, cnt = 0;
+
+    if (NULL == prof) {
+        return 0;
+    }
+
+    TAL_ENTER_CRITICAL();
+    for (i = 0; i < TAL_MUTEX_PROF_MAX_NUM && cnt < num; i++) {
+        if (s_mutex_prof[i]) {
+            prof[cnt++] = s_mutex_prof[i]->prof;
+        }
+    }
+    TAL_EXIT_CRITICAL();
+
+    return cnt;
+}
+
+void tal_mutex_prof_reset(void)
+{
+    TAL_MUTEX_PROF_T *prof = NULL;
+    uint32_t i = 0;
+
+    TAL_ENTER_CRITICAL();
+    for (i = 0; i < TAL_MUTEX_PROF_MAX_NUM; i++) {
+        if (s_mutex_prof[i]) {
+            prof = &s_mutex_prof[i]->prof;
+            prof->lock_cnt = 0;
+            prof->contend_cnt = 0;
+            prof->wait_total_ms = 0;
+            prof->wait_max_ms = 0;
+            prof->hold_total_ms = 0;
+            prof->hold_max_ms = 0;
+            prof->long_hold_cnt = 0;
+            prof->hold_max_owner = NULL;
+        }
+    }
+    TAL_EXIT_CRITICAL();
+}
+#else
 OPERATE_RET tal_mutex_create_init(MUTEX_HANDLE *handle)
 {
     return tkl_mutex_create_init(handle);
@@ -58,7 +270,14 @@ OPERATE_RET tal_mutex_create_init(MUTEX_HANDLE *handle)
 
 OPERATE_RET tal_mutex_lock(const MUTEX_HANDLE handle)
 {
-    return tkl_mutex_lock(handle);
+    uint32_t trace_us = tal_trace_now();
+    OPERATE_RET rt = tkl_mutex_lock(handle);
+
+    //! only contended locks, the others would flood the ring
+    if (trace_us && TAL_TRACE_TIME_US() - trace_us >= TAL_TRACE_MUTEX_MIN_US) {
+        tal_trace_span_end(TAL_TRACE_MUTEX_WAIT, handle, trace_us);
+    }
+    return rt;
 }
 
 OPERATE_RET tal_mutex_unlock(const MUTEX_HANDLE handle)
@@ -71,6 +290,13 @@ OPERATE_RET tal_mutex_release(const MUTEX_HANDLE handle)
     return tkl_mutex_release(handle);
 }
 
+void tal_mutex_set_name(const MUTEX_HANDLE handle, const char *name)
+{
+    (void)handle;
+    (void)name;
+}
+#endif
+
 //! ota
 OPERATE_RET tal_ota_get_ability(uint32_t *image_size, TUYA_OTA_TYPE_E *type)
 {
@@ -100,15 +326,194 @@ OPERATE_RET tal_queue_create_init(QUEUE_HANDLE *queue, int msgsize, int msgcount
 
 OPERATE_RET tal_queue_post(QUEUE_HANDLE queue, void *data, uint32_t timeout)
 {
+    if (tal_trace_is_running()) {
+        tal_trace_record(TAL_TRACE_QUEUE_POST, queue, tal_trace_now(), 0);
+    }
     return tkl_queue_post(queue, data, timeout);
 }
 
 OPERATE_RET tal_queue_fetch(QUEUE_HANDLE queue, void *msg, uint32_t timeout)
 {
-    return tkl_queue_fetch(queue, msg, timeout);
+    uint32_t trace_us = timeout ? tal_trace_now() : 0;
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+    void *prof = timeout ? tal_thread_prof_wait_begin() : NULL;
+    OPERATE_RET rt = tkl_queue_fetch(queue, msg, timeout);
+    tal_thread_prof_wait_end(prof);
+#else
+    OPERATE_RET rt = tkl_queue_fetch(queue, msg, timeout);
+#endif
+    tal_trace_span_end(TAL_TRACE_QUEUE_FETCH, queue, trace_us);
+    return rt;
 }
 
 void tal_queue_free(QUEUE_HANDLE queue)
 {
     tkl_queue_free(queue);
 }
+
+OPERATE_RET tal_queue_fetch_multi(QUEUE_HANDLE queue, void *msg, int msgsize, uint32_t *num, uint32_t timeout)
+{
+    if (NULL == msg || msgsize <= 0 || NULL == num || 0 == *num) {
+        return OPRT_INVALID_PARM;
+    }
+
+    uint32_t max = *num;
+    *num = 0;
+
+    OPERATE_RET rt = tal_queue_fetch(queue, msg, timeout);
+    if (OPRT_OK != rt) {
+        return rt;
+    }
+
+    for (*num = 1; *num < max; (*num)++) {
+        if (OPRT_OK != tkl_queue_fetch(queue, (uint8_t *)msg + *num * msgsize, 0)) {
+            break;
+        }
+    }
+
+    return OPRT_OK;
+}
+
+typedef struct {
+    QUEUE_HANDLE queue;  // carries element pointers
+    SEM_HANDLE free_sem; // counts the free elements
+    void *free_list;     // linked through the first word of each free element
+    uint8_t *buf;
+    uint32_t size;
+} TAL_QUEUE_POOL_T;
+
+OPERATE_RET tal_queue_pool_create_init(QUEUE_HANDLE *queue, int msgsize, int msgcount)
+{
+    OPERATE_RET rt = OPRT_OK;
+    TAL_QUEUE_POOL_T *pool = NULL;
+
+    if (NULL == queue || msgsize <= 0 || msgcount <= 0) {
+        return OPRT_INVALID_PARM;
+    }
+
+    pool = tal_malloc(sizeof(TAL_QUEUE_POOL_T));
+    if (NULL == pool) {
+        return OPRT_MALLOC_FAILED;
+    }
+    memset(pool, 0, sizeof(TAL_QUEUE_POOL_T));
+
+    // keep every element aligned for any member type
+    pool->size = (msgsize + 7) & ~7;
+    pool->buf = tal_malloc(pool->size * msgcount);
+    if (NULL == pool->buf) {
+        rt = OPRT_MALLOC_FAILED;
+        goto __EXIT;
+    }
+    for (int i = msgcount - 1; i >= 0; i--) {
+        void *elem = pool->buf + i * pool->size;
+        *(void **)elem = pool->free_list;
+        pool->free_list = elem;
+    }
+
+    rt = tkl_semaphore_create_init(&pool->free_sem, msgcount, msgcount);
+    if (OPRT_OK != rt) {
+        goto __EXIT;
+    }
+    rt = tkl_queue_create_init(&pool->queue, sizeof(void *), msgcount);
+    if (OPRT_OK != rt) {
+        goto __EXIT;
+    }
+
+    *queue = pool;
+    return OPRT_OK;
+
+__EXIT:
+    if (pool->free_sem) {
+        tkl_semaphore_release(pool->free_sem);
+    }
+    if (pool->buf) {
+        tal_free(pool->buf);
+    }
+    tal_free(pool);
+    return rt;
+}
+
+void *tal_queue_pool_alloc(QUEUE_HANDLE queue, uint32_t timeout)
+{
+    TAL_QUEUE_POOL_T *pool = (TAL_QUEUE_POOL_T *)queue;
+    void *elem = NULL;
+
+    if (NULL == pool || OPRT_OK != tal_semaphore_wait(pool->free_sem, timeout)) {
+        return NULL;
+    }
+
+    TAL_ENTER_CRITICAL();
+    elem = pool->free_list;
+    pool->free_list = *(void **)elem;
+    TAL_EXIT_CRITICAL();
+
+    return elem;
+}
+
+void tal_queue_pool_release(QUEUE_HANDLE queue, void *msg)
+{
+    TAL_QUEUE_POOL_T *pool = (TAL_QUEUE_POOL_T *)queue;
+
+    if (NULL == pool || NULL == msg) {
+        return;
+    }
+
+    TAL_ENTER_CRITICAL();
+    *(void **)msg = pool->free_list;
+    pool->free_list = msg;
+    TAL_EXIT_CRITICAL();
+
+    tkl_semaphore_post(pool->free_sem);
+}
+
+OPERATE_RET tal_queue_pool_post(QUEUE_HANDLE queue, void *msg)
+{
+    TAL_QUEUE_POOL_T *pool = (TAL_QUEUE_POOL_T *)queue;
+
+    if (NULL == pool || NULL == msg) {
+        return OPRT_INVALID_PARM;
+    }
+
+    // the queue has room for every element, so this never waits
+    OPERATE_RET rt = tal_queue_post(pool->queue, &msg, 0);
+    if (OPRT_OK != rt) {
+        tal_queue_pool_release(queue, msg);
+    }
+    return rt;
+}
+
+OPERATE_RET tal_queue_pool_fetch(QUEUE_HANDLE queue, void **msg, uint32_t timeout)
+{
+    TAL_QUEUE_POOL_T *pool = (TAL_QUEUE_POOL_T *)queue;
+
+    if (NULL == pool || NULL == msg) {
+        return OPRT_INVALID_PARM;
+    }
+
+    return tal_queue_fetch(pool->queue, msg, timeout);
+}
+
+OPERATE_RET tal_queue_pool_fetch_multi(QUEUE_HANDLE queue, void **msg, uint32_t *num, uint32_t timeout)
+{
+    TAL_QUEUE_POOL_T *pool = (TAL_QUEUE_POOL_T *)queue;
+
+    if (NULL == pool) {
+        return OPRT_INVALID_PARM;
+    }
+
+    return tal_queue_fetch_multi(pool->queue, msg, sizeof(void *), num, timeout);
+}
+
+void tal_queue_pool_free(QUEUE_HANDLE queue)
+{
+    TAL_QUEUE_POOL_T *pool = (TAL_QUEUE_POOL_T *)queue;
+
+    if (NULL == pool) {
+        return;
+    }
+
+    tkl_queue_free(pool->queue);
+    tkl_semaphore_release(pool->free_sem);
+    tal_free(pool->buf);
+    tal_free(pool);
+}
@@ -0,0 +1,121 @@
+/**
+ * @file tal_boot_mark.c
+ * @brief Timeline of the boot, see tal_boot_mark.h.
+ *
+ * The array is static so marks can be put before the heap and the log are
+ * initialized, the time comes from the tick counter which runs from reset.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include "tal_system.h"
+#include "tal_log.h"
+#include "tal_boot_mark.h"
+
+static struct {
+    volatile BOOL_T done;
+    uint32_t count;
+    uint32_t dropped;
+    TAL_BOOT_MARK_T mark[TAL_BOOT_MARK_NUM];
+} s_boot;
+
+/**
+ * @brief Puts a mark on the boot timeline, does nothing once the boot is done.
+ *
+ * @param[in] name what was reached, the pointer is kept so it must be a
+ * constant string
+ *
+ * @return none
+ */
+void tal_boot_mark(const char *name)
+{
+    if (s_boot.done || NULL == name) {
+        return;
+    }
+
+    uint32_t now = (uint32_t)tal_system_get_millisecond();
+
+    TAL_ENTER_CRITICAL();
+    if (s_boot.count < TAL_BOOT_MARK_NUM) {
+        s_boot.mark[s_boot.count].time_ms = now;
+        s_boot.mark[s_boot.count].name = name;
+        s_boot.count++;
+    } else {
+        s_boot.dropped++;
+    }
+    TAL_EXIT_CRITICAL();
+}
+
+/**
+ * @brief Closes the boot with a last mark and prints the timeline, later
+ * calls do nothing.
+ *
+ * @param[in] name the last mark
+ *
+ * @return none
+ */
+void tal_boot_mark_done(const char *name)
+{
+    if (s_boot.done) {
+        return;
+    }
+
+    tal_boot_mark(name);
+    s_boot.done = TRUE;
+    tal_boot_mark_dump();
+}
+
+/**
+ * @brief Copies the marks in the order they were put.
+ *
+ * @param[out] mark marks
+ * @param[in] num size of mark
+ * @param[out] dropped marks that did not fit, may be NULL
+ *
+ * @return the number of marks copied
+ */
+uint32_t tal_boot_mark_get(TAL_BOOT_MARK_T *mark, uint32_t num, uint32_t *dropped)
+{
+    uint32_t i = 0;
+
+    if (NULL == mark) {
+        return 0;
+    }
+
+    TAL_ENTER_CRITICAL();
+    if (num > s_boot.count) {
+        num = s_boot.count;
+    }
+    for (i = 0; i < num; i++) {
+        mark[i] = s_boot.mark[i];
+    }
+    if (dropped) {
+        *dropped = s_boot.dropped;
+    }
+    TAL_EXIT_CRITICAL();
+
+    return num;
+}
+
+/**
+ * @brief Prints the timeline through tal_log, time since reset and since the
+ * previous mark.
+ *
+ * @return none
+ */
+void tal_boot_mark_dump(void)
+{
+    uint32_t i = 0, prev = 0;
+
+    // marks are only appended, the ones below count never change
+    uint32_t num = s_boot.count;
+
+    PR_NOTICE("boot timeline, %u marks, %u dropped", num, s_boot.dropped);
+    PR_NOTICE("    since reset  since prev  mark");
+    for (i = 0; i < num; i++) {
+        PR_NOTICE("  %9u ms  %7u ms  %s", s_boot.mark[i].time_ms, i ? s_boot.mark[i].time_ms - prev : 0,
+                  s_boot.mark[i].name);
+        prev = s_boot.mark[i].time_ms;
+    }
+}
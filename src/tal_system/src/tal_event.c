@@ -34,8 +34,25 @@
 #include "tal_event.h"
 #include "tal_api.h"
 
+typedef struct {
+    EVENT_NODE_T *event;
+    void *data;
+    BOOL_T is_coalesce; // data is taken from the event when dispatched
+} EVENT_ASYNC_ITEM_T;
+
 static EVENT_MANAGE_T g_event_manager = {0};
 
+static uint32_t _event_name_hash(const char *name)
+{
+    uint32_t hash = 5381;
+
+    while (*name) {
+        hash = (hash << 5) + hash + (uint8_t)(*name++);
+    }
+
+    return hash;
+}
+
 BOOL_T _event_name_is_valid(const char *name)
 {
     if (!name) {
@@ -62,6 +79,8 @@ BOOL_T _event_desc_is_valid(const char *desc)
     return TRUE;
 }
 
+EVENT_NODE_T *_event_node_get_by_hash(const char *name, uint32_t hash);
+
 EVENT_NODE_T *_event_node_create_init(const char *name)
 {
     // allocate memory
@@ -72,11 +91,21 @@ EVENT_NODE_T *_event_node_create_init(const char *name)
     // initialze the event node
     memcpy(event->name, name, strlen(name));
     event->name[strlen(name)] = '\0';
+    event->hash = _event_name_hash(name);
     INIT_LIST_HEAD(&event->subscribe_root);
-    tal_mutex_create_init(&event->mutex);
 
     tal_mutex_lock(g_event_manager.mutex);
 
+    // another thread may have created it meanwhile
+    EVENT_NODE_T *exist = _event_node_get_by_hash(name, event->hash);
+    if (exist) {
+        tal_mutex_unlock(g_event_manager.mutex);
+        tal_free(event);
+        return exist;
+    }
+
+    tal_mutex_create_init(&event->mutex);
+
     // need check if there have free subscriber which subscribe this event
     struct tuya_list_head *free_pos = NULL;
     struct tuya_list_head *free_next = NULL;
@@ -100,6 +129,7 @@ EVENT_NODE_T *_event_node_create_init(const char *name)
 
     // at last, need add this event to event manage root
     tuya_list_add_tail(&event->node, &g_event_manager.event_root);
+    tuya_list_add_tail(&event->hash_node, &g_event_manager.hash_bucket[event->hash & (EVENT_HASH_BUCKET_NUM - 1)]);
     g_event_manager.event_cnt++;
 
     tal_mutex_unlock(g_event_manager.mutex);
@@ -107,16 +137,16 @@ EVENT_NODE_T *_event_node_create_init(const char *name)
     return event;
 }
 
-EVENT_NODE_T *_event_node_get(const char *name)
+EVENT_NODE_T *_event_node_get_by_hash(const char *name, uint32_t hash)
 {
-    // try to get event from event root
+    // try to get event from the hash bucket, events are never removed
     EVENT_NODE_T *entry = NULL;
     struct tuya_list_head *pos = NULL;
-    tuya_list_for_each(pos, &g_event_manager.event_root)
+    tuya_list_for_each(pos, &g_event_manager.hash_bucket[hash & (EVENT_HASH_BUCKET_NUM - 1)])
     {
-        // find by name
-        entry = tuya_list_entry(pos, EVENT_NODE_T, node);
-        if (0 == strcmp(entry->name, name)) {
+        // find by hash first, then by name
+        entry = tuya_list_entry(pos, EVENT_NODE_T, hash_node);
+        if (entry->hash == hash && 0 == strcmp(entry->name, name)) {
             return entry;
         }
     }
@@ -124,6 +154,11 @@ EVENT_NODE_T *_event_node_get(const char *name)
     return NULL;
 }
 
+EVENT_NODE_T *_event_node_get(const char *name)
+{
+    return _event_node_get_by_hash(name, _event_name_hash(name));
+}
+
 SUBSCRIBE_NODE_T *_event_node_get_free_subscribe(SUBSCRIBE_NODE_T *subscribe)
 {
     struct tuya_list_head *pos = NULL;
@@ -337,6 +372,9 @@ OPERATE_RET tal_event_init(void)
 
     INIT_LIST_HEAD(&g_event_manager.event_root);
     INIT_LIST_HEAD(&g_event_manager.free_subscribe_root);
+    for (int i = 0; i < EVENT_HASH_BUCKET_NUM; i++) {
+        INIT_LIST_HEAD(&g_event_manager.hash_bucket[i]);
+    }
     tal_mutex_create_init(&g_event_manager.mutex);
     g_event_manager.event_cnt = 0;
     g_event_manager.inited = TRUE;
@@ -394,6 +432,113 @@ OPERATE_RET tal_event_publish(const char *name, void *data)
     return rt;
 }
 
+static void _event_async_thread(void *arg)
+{
+    EVENT_ASYNC_ITEM_T item;
+
+    while (THREAD_STATE_RUNNING == tal_thread_get_state(g_event_manager.async_thread)) {
+        if (OPRT_OK != tal_queue_fetch(g_event_manager.async_queue, &item, SEM_WAIT_FOREVER)) {
+            continue;
+        }
+
+        // publishes after this point queue again
+        if (item.is_coalesce) {
+            tal_mutex_lock(g_event_manager.mutex);
+            item.data = item.event->async_data;
+            item.event->async_pending = FALSE;
+            tal_mutex_unlock(g_event_manager.mutex);
+        }
+
+        tal_mutex_lock(item.event->mutex);
+        _event_node_dispatch(item.event, item.data);
+        tal_mutex_unlock(item.event->mutex);
+    }
+}
+
+// called with the manage mutex locked
+static OPERATE_RET _event_async_init(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    if (g_event_manager.async_queue) {
+        return OPRT_OK;
+    }
+
+    TUYA_CALL_ERR_RETURN(
+        tal_queue_create_init(&g_event_manager.async_queue, sizeof(EVENT_ASYNC_ITEM_T), EVENT_ASYNC_QUEUE_LEN));
+
+    THREAD_CFG_T thread_cfg = {
+        .stackDepth = EVENT_ASYNC_STACK_SIZE, .priority = EVENT_ASYNC_THREAD_PRIO, .thrdname = "event_async"};
+    rt = tal_thread_create_and_start(&g_event_manager.async_thread, NULL, NULL, _event_async_thread, NULL,
+                                     &thread_cfg);
+    if (OPRT_OK != rt) {
+        tal_queue_free(g_event_manager.async_queue);
+        g_event_manager.async_queue = NULL;
+    }
+
+    return rt;
+}
+
+/**
+ * @brief Publishes an event from the dispatcher thread.
+ *
+ * The event is queued to the async dispatcher and the function returns at
+ * once, the subscribers run on the dispatcher thread in queue order. With
+ * is_coalesce, a publish of an event that already has a coalesced publish
+ * queued only replaces its data, so a burst of state changes costs the
+ * subscribers one call with the latest state.
+ *
+ * @param[in] name The name of the event to publish.
+ * @param[in] data The data associated with the event, it must stay valid
+ * until dispatched.
+ * @param[in] is_coalesce Merge with a queued coalesced publish.
+ * @return The operation result. Returns OPRT_OK on success, or an error code on
+ * failure.
+ */
+OPERATE_RET tal_event_publish_async(const char *name, void *data, BOOL_T is_coalesce)
+{
+    if (g_event_manager.inited != TRUE) {
+        tal_event_init();
+    }
+
+    if (!_event_name_is_valid(name)) {
+        return OPRT_BASE_EVENT_INVALID_EVENT_NAME;
+    }
+
+    OPERATE_RET rt = OPRT_OK;
+    EVENT_NODE_T *event = _event_node_get(name);
+    if (!event) {
+        event = _event_node_create_init(name);
+        TUYA_CHECK_NULL_RETURN(event, OPRT_MALLOC_FAILED);
+    }
+
+    EVENT_ASYNC_ITEM_T item = {.event = event, .data = data, .is_coalesce = is_coalesce};
+
+    tal_mutex_lock(g_event_manager.mutex);
+    rt = _event_async_init();
+    if (OPRT_OK != rt) {
+        goto __EXIT;
+    }
+
+    if (is_coalesce) {
+        event->async_data = data;
+        if (event->async_pending) {
+            goto __EXIT;
+        }
+    }
+
+    // never block the publisher, the dispatcher may be busy
+    rt = tal_queue_post(g_event_manager.async_queue, &item, 0);
+    if (OPRT_OK == rt && is_coalesce) {
+        event->async_pending = TRUE;
+    }
+
+__EXIT:
+    tal_mutex_unlock(g_event_manager.mutex);
+
+    return rt;
+}
+
 /**
  * @brief Subscribes to an event.
  *
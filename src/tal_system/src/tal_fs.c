@@ -29,6 +29,74 @@
 #endif
 
 #if !(defined(ENABLE_FILE_SYSTEM) && (ENABLE_FILE_SYSTEM == 1))
+/**
+ * @brief littlefs file with a RAM buffer. The buffer holds either data read
+ * ahead of the caller, buf[pos..fill), or data not written yet, buf[0..fill)
+ * when dirty.
+ */
+typedef struct {
+    lfs_file_t file;
+    uint8_t *buf; // allocated on first use
+    int size;     // 0 for unbuffered
+    int pos;
+    int fill;
+    BOOL_T dirty;
+} TAL_FS_FILE_T;
+
+static BOOL_T __fs_buf_ready(TAL_FS_FILE_T *f)
+{
+    if (0 == f->size) {
+        return FALSE;
+    }
+
+    if (NULL == f->buf) {
+        f->buf = tal_malloc(f->size);
+        if (NULL == f->buf) {
+            PR_WARN("fs buf malloc %d fail", f->size);
+            f->size = 0;
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+// writes the pending data, or moves littlefs back to the first byte not read yet
+static int __fs_buf_sync(TAL_FS_FILE_T *f)
+{
+    int rt = 0;
+
+    if (f->dirty) {
+        rt = lfs_file_write(tal_lfs_get(), &f->file, f->buf, f->fill);
+    } else if (f->pos < f->fill) {
+        rt = lfs_file_seek(tal_lfs_get(), &f->file, f->pos - f->fill, LFS_SEEK_CUR);
+    }
+
+    f->pos = 0;
+    f->fill = 0;
+    f->dirty = FALSE;
+
+    return (rt < 0) ? rt : 0;
+}
+
+static int __fs_buf_fill(TAL_FS_FILE_T *f)
+{
+    int rt = 0;
+
+    if (f->dirty) {
+        rt = __fs_buf_sync(f);
+        if (rt < 0) {
+            return rt;
+        }
+    }
+
+    rt = lfs_file_read(tal_lfs_get(), &f->file, f->buf, f->size);
+    f->pos = 0;
+    f->fill = (rt > 0) ? rt : 0;
+
+    return rt;
+}
+
 int __lfs_get_cfg(const char *mode)
 {
     int flag = 0;
@@ -351,15 +419,16 @@ TUYA_FILE tal_fopen(const char *path, const char *mode)
 #if defined(ENABLE_FILE_SYSTEM) && (ENABLE_FILE_SYSTEM == 1)
     return tkl_fopen(path, mode);
 #else
-    lfs_file_t *f = tal_malloc(sizeof(lfs_file_t));
+    TAL_FS_FILE_T *f = tal_malloc(sizeof(TAL_FS_FILE_T));
     if (!f)
         return NULL;
 
-    memset(f, 0, sizeof(lfs_file_t));
-    if (0 != lfs_file_open(tal_lfs_get(), f, path, __lfs_get_cfg(mode))) {
+    memset(f, 0, sizeof(TAL_FS_FILE_T));
+    if (0 != lfs_file_open(tal_lfs_get(), &f->file, path, __lfs_get_cfg(mode))) {
         tal_free(f);
         return NULL;
     }
+    f->size = TAL_FS_BUF_SIZE;
 
     return f;
 #endif
@@ -382,7 +451,12 @@ int tal_fclose(TUYA_FILE file)
     if (NULL == file)
         return OPRT_OK;
 
-    lfs_file_close(tal_lfs_get(), (lfs_file_t *)file);
+    TAL_FS_FILE_T *f = (TAL_FS_FILE_T *)file;
+    __fs_buf_sync(f);
+    lfs_file_close(tal_lfs_get(), &f->file);
+    if (f->buf) {
+        tal_free(f->buf);
+    }
     tal_free(file);
     file = NULL;
     return OPRT_OK;
@@ -405,7 +479,46 @@ int tal_fread(void *buf, int bytes, TUYA_FILE file)
 #if defined(ENABLE_FILE_SYSTEM) && (ENABLE_FILE_SYSTEM == 1)
     return tkl_fread(buf, bytes, file);
 #else
-    return lfs_file_read(tal_lfs_get(), (lfs_file_t *)file, buf, bytes);
+    TAL_FS_FILE_T *f = (TAL_FS_FILE_T *)file;
+    int done = 0, n = 0, rt = 0;
+
+    if (!__fs_buf_ready(f)) {
+        return lfs_file_read(tal_lfs_get(), &f->file, buf, bytes);
+    }
+
+    if (f->dirty) {
+        rt = __fs_buf_sync(f);
+        if (rt < 0) {
+            return rt;
+        }
+    }
+
+    while (done < bytes) {
+        if (f->pos >= f->fill) {
+            // large reads bypass the empty buffer
+            if (bytes - done >= f->size) {
+                rt = lfs_file_read(tal_lfs_get(), &f->file, (uint8_t *)buf + done, bytes - done);
+                if (rt > 0) {
+                    done += rt;
+                }
+                break;
+            }
+            rt = __fs_buf_fill(f);
+            if (rt <= 0) {
+                break;
+            }
+        }
+
+        n = f->fill - f->pos;
+        if (n > bytes - done) {
+            n = bytes - done;
+        }
+        memcpy((uint8_t *)buf + done, f->buf + f->pos, n);
+        f->pos += n;
+        done += n;
+    }
+
+    return (0 == done && rt < 0) ? rt : done;
 #endif
 }
 
@@ -425,7 +538,29 @@ int tal_fwrite(void *buf, int bytes, TUYA_FILE file)
 #if defined(ENABLE_FILE_SYSTEM) && (ENABLE_FILE_SYSTEM == 1)
     return tkl_fwrite(buf, bytes, file);
 #else
-    return lfs_file_write(tal_lfs_get(), (lfs_file_t *)file, buf, bytes);
+    TAL_FS_FILE_T *f = (TAL_FS_FILE_T *)file;
+    int rt = 0;
+
+    if (!__fs_buf_ready(f)) {
+        return lfs_file_write(tal_lfs_get(), &f->file, buf, bytes);
+    }
+
+    if (!f->dirty || f->fill + bytes > f->size) {
+        rt = __fs_buf_sync(f);
+        if (rt < 0) {
+            return rt;
+        }
+    }
+
+    if (bytes >= f->size) {
+        return lfs_file_write(tal_lfs_get(), &f->file, buf, bytes);
+    }
+
+    memcpy(f->buf + f->fill, buf, bytes);
+    f->fill += bytes;
+    f->dirty = TRUE;
+
+    return bytes;
 #endif
 }
 
@@ -443,7 +578,13 @@ int tal_fsync(TUYA_FILE file)
 #if defined(ENABLE_FILE_SYSTEM) && (ENABLE_FILE_SYSTEM == 1)
     return tkl_fsync(file);
 #else
-    return lfs_file_sync(tal_lfs_get(), (lfs_file_t *)file);
+    TAL_FS_FILE_T *f = (TAL_FS_FILE_T *)file;
+    int rt = __fs_buf_sync(f);
+    if (rt < 0) {
+        return rt;
+    }
+
+    return lfs_file_sync(tal_lfs_get(), &f->file);
 #endif
 }
 
@@ -463,10 +604,43 @@ char *tal_fgets(char *buf, int len, TUYA_FILE file)
 #if defined(ENABLE_FILE_SYSTEM) && (ENABLE_FILE_SYSTEM == 1)
     return tkl_fgets(buf, len, file);
 #else
+    TAL_FS_FILE_T *f = (TAL_FS_FILE_T *)file;
     int i = 0;
     char c;
+
+    if (__fs_buf_ready(f)) {
+        while (i < len - 1) {
+            if (f->pos >= f->fill) {
+                int rt = __fs_buf_fill(f);
+                if (rt < 0) {
+                    return NULL;
+                } else if (rt == 0) {
+                    break;
+                }
+            }
+
+            int n = f->fill - f->pos;
+            if (n > len - 1 - i) {
+                n = len - 1 - i;
+            }
+            uint8_t *nl = memchr(f->buf + f->pos, '\n', n);
+            if (nl) {
+                n = nl - (f->buf + f->pos) + 1;
+            }
+            memcpy(buf + i, f->buf + f->pos, n);
+            f->pos += n;
+            i += n;
+            if (nl) {
+                break;
+            }
+        }
+
+        buf[i] = '\0';
+        return (0 == i) ? NULL : buf;
+    }
+
     while (i < len - 1) {
-        int rt = lfs_file_read(tal_lfs_get(), file, &c, 1);
+        int rt = lfs_file_read(tal_lfs_get(), &f->file, &c, 1);
         if (rt < 0) {
             return NULL;
         } else if (rt == 0) {
@@ -502,12 +676,21 @@ int tal_feof(TUYA_FILE file)
 #if defined(ENABLE_FILE_SYSTEM) && (ENABLE_FILE_SYSTEM == 1)
     return tkl_feof(file);
 #else
+    TAL_FS_FILE_T *f = (TAL_FS_FILE_T *)file;
     char ch;
-    if (0 == lfs_file_read(tal_lfs_get(), (lfs_file_t *)file, &ch, 1))
+
+    if (__fs_buf_ready(f)) {
+        if (f->pos < f->fill) {
+            return 0;
+        }
+        return (0 == __fs_buf_fill(f)) ? 1 : 0;
+    }
+
+    if (0 == lfs_file_read(tal_lfs_get(), &f->file, &ch, 1))
         return 1;
 
     // if not EOF, need seek back (read will change the offset)
-    lfs_file_seek(tal_lfs_get(), (lfs_file_t *)file, -1, LFS_SEEK_CUR);
+    lfs_file_seek(tal_lfs_get(), &f->file, -1, LFS_SEEK_CUR);
     return 0;
 #endif
 }
@@ -528,7 +711,20 @@ int tal_fseek(TUYA_FILE file, int64_t offs, int whence)
 #if defined(ENABLE_FILE_SYSTEM) && (ENABLE_FILE_SYSTEM == 1)
     return tkl_fseek(file, offs, whence);
 #else
-    return lfs_file_seek(tal_lfs_get(), (lfs_file_t *)file, offs, whence);
+    TAL_FS_FILE_T *f = (TAL_FS_FILE_T *)file;
+
+    // short relative seeks stay inside the read buffer
+    if (LFS_SEEK_CUR == whence && !f->dirty && f->fill > 0 && offs >= -f->pos && offs <= f->fill - f->pos) {
+        f->pos += offs;
+        return tal_ftell(file);
+    }
+
+    int rt = __fs_buf_sync(f);
+    if (rt < 0) {
+        return rt;
+    }
+
+    return lfs_file_seek(tal_lfs_get(), &f->file, offs, whence);
 #endif
 }
 
@@ -546,7 +742,14 @@ int64_t tal_ftell(TUYA_FILE file)
 #if defined(ENABLE_FILE_SYSTEM) && (ENABLE_FILE_SYSTEM == 1)
     return tkl_ftell(file);
 #else
-    return lfs_file_tell(tal_lfs_get(), (lfs_file_t *)file);
+    TAL_FS_FILE_T *f = (TAL_FS_FILE_T *)file;
+    int64_t pos = lfs_file_tell(tal_lfs_get(), &f->file);
+
+    if (pos < 0) {
+        return pos;
+    }
+
+    return f->dirty ? (pos + f->fill) : (pos - (f->fill - f->pos));
 #endif
 }
 
@@ -608,9 +811,18 @@ int tal_fgetc(TUYA_FILE file)
 #if defined(ENABLE_FILE_SYSTEM) && (ENABLE_FILE_SYSTEM == 1)
     return tkl_fgetc(file);
 #else
-    char ch;
-    if (0 == lfs_file_read(tal_lfs_get(), (lfs_file_t *)file, &ch, 1))
-        ch = EOF;
+    TAL_FS_FILE_T *f = (TAL_FS_FILE_T *)file;
+    uint8_t ch;
+
+    if (__fs_buf_ready(f)) {
+        if (f->pos >= f->fill && __fs_buf_fill(f) <= 0) {
+            return EOF;
+        }
+        return f->buf[f->pos++];
+    }
+
+    if (1 != lfs_file_read(tal_lfs_get(), &f->file, &ch, 1))
+        return EOF;
     return ch;
 #endif
 }
@@ -629,7 +841,7 @@ int tal_fflush(TUYA_FILE file)
 #if defined(ENABLE_FILE_SYSTEM) && (ENABLE_FILE_SYSTEM == 1)
     return tkl_fflush(file);
 #else
-    return lfs_file_sync(tal_lfs_get(), (lfs_file_t *)file);
+    return tal_fsync(file);
 #endif
 }
 
@@ -670,3 +882,79 @@ int tal_ftruncate(int fd, uint64_t length)
     return OPRT_NOT_SUPPORTED;
 #endif
 }
+
+/**
+ * @brief Set the buffer size of one file
+ *
+ * @param[in] file file handle
+ * @param[in] size buffer size in bytes, 0 for unbuffered
+ *
+ * @note Buffered data is written or dropped first, the new buffer is allocated
+ * on the next read or write. Only files on littlefs are buffered.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+int tal_fsetbuf(TUYA_FILE file, int size)
+{
+#if defined(ENABLE_FILE_SYSTEM) && (ENABLE_FILE_SYSTEM == 1)
+    return OPRT_NOT_SUPPORTED;
+#else
+    TAL_FS_FILE_T *f = (TAL_FS_FILE_T *)file;
+
+    if (NULL == f || size < 0) {
+        return OPRT_INVALID_PARM;
+    }
+
+    int rt = __fs_buf_sync(f);
+    if (f->buf) {
+        tal_free(f->buf);
+        f->buf = NULL;
+    }
+    f->size = size;
+
+    return (rt < 0) ? OPRT_COM_ERROR : OPRT_OK;
+#endif
+}
+
+/**
+ * @brief Map a file for reading straight from execute in place flash
+ *
+ * @param[in] path path of file
+ * @param[out] addr address of the file content
+ * @param[out] len length of the file
+ *
+ * @note The first block of a littlefs CTZ list holds data only, the next ones
+ * start with skip-list pointers, so only a file of one block is contiguous.
+ *
+ * @return OPRT_OK on success, OPRT_NOT_SUPPORTED when TAL_FS_XIP_BASE is not
+ * defined or the file is not contiguous, OPRT_NOT_FOUND when there is no such
+ * file.
+ */
+int tal_fs_mmap(const char *path, const void **addr, size_t *len)
+{
+#if !(defined(ENABLE_FILE_SYSTEM) && (ENABLE_FILE_SYSTEM == 1)) && defined(TAL_FS_XIP_BASE)
+    lfs_file_t file;
+    int ret = OPRT_NOT_SUPPORTED;
+
+    if (NULL == path || NULL == addr || NULL == len) {
+        return OPRT_INVALID_PARM;
+    }
+
+    memset(&file, 0, sizeof(file));
+    if (0 != lfs_file_open(tal_lfs_get(), &file, path, LFS_O_RDONLY)) {
+        return OPRT_NOT_FOUND;
+    }
+
+    if (!(file.flags & LFS_F_INLINE) && file.ctz.size > 0 && file.ctz.size <= tal_lfs_get()->cfg->block_size) {
+        *addr = (const void *)(uintptr_t)(TAL_FS_XIP_BASE + tal_lfs_block_addr(file.ctz.head));
+        *len = file.ctz.size;
+        ret = OPRT_OK;
+    }
+
+    lfs_file_close(tal_lfs_get(), &file);
+
+    return ret;
+#else
+    return OPRT_NOT_SUPPORTED;
+#endif
+}
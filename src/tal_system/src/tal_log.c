@@ -38,6 +38,8 @@
 #include "tal_system.h"
 #include "tal_time_service.h"
 #include "tal_memory.h"
+#include "tal_thread.h"
+#include "tal_semaphore.h"
 
 /***********************************************************
 *************************micro define***********************
@@ -45,6 +47,29 @@
 #define LOG_LEVEL_MIN 0
 #define LOG_LEVEL_MAX 5
 
+#define LOG_RECORD_FREE    0
+#define LOG_RECORD_WRITING 1 // slot taken, the producer is formatting the message
+#define LOG_RECORD_READY   2
+
+typedef struct {
+    volatile uint8_t state;
+    LOG_LEVEL level;
+    uint32_t line;
+    const char *file; // points into __FILE__, never freed
+    SYS_TICK_T time_ms;
+    char msg[TAL_LOG_ASYNC_MSG_LEN];
+} LOG_RECORD_S;
+
+typedef struct {
+    BOOL_T enable;
+    THREAD_HANDLE thread;
+    SEM_HANDLE sem;
+    uint16_t head; // next slot to take, moved in a critical section
+    uint16_t tail; // next slot to output, only moved by the log thread
+    uint32_t drop_cnt;
+    LOG_RECORD_S record[TAL_LOG_ASYNC_RECORD_NUM];
+} LOG_ASYNC_S;
+
 typedef struct {
     LIST_HEAD node;
     char *name;
@@ -73,6 +98,8 @@ typedef struct {
     int log_buf_len;
     BOOL_T ms_level;
     char *log_buf;
+
+    LOG_ASYNC_S *async;
 } LOG_MANAGE, *P_LOG_MANAGE;
 
 #define DEF_OUTPUT_NAME "def_output"
@@ -125,11 +152,13 @@ OPERATE_RET tal_log_init(const TAL_LOG_LEVEL_E level, const int buf_len, const T
         }
         tmp_log_mng->log_buf_len = buf_len;
         tmp_log_mng->log_buf = (char *)(tmp_log_mng + 1);
+        tmp_log_mng->async = NULL;
         op_ret = tal_mutex_create_init(&tmp_log_mng->mutex);
         if (OPRT_OK != op_ret) {
             tal_free(tmp_log_mng);
             return op_ret;
         }
+        tal_mutex_set_name(tmp_log_mng->mutex, "log");
         INIT_LIST_HEAD(&(tmp_log_mng->listHead));
         INIT_LIST_HEAD(&(tmp_log_mng->log_list));
         tmp_log_mng->curLogLevel = level;
@@ -363,40 +392,28 @@ OPERATE_RET tal_log_get_level(TAL_LOG_LEVEL_E *level)
  *     - OPRT_BASE_LOG_MNG_FORMAT_STRING_FAILED if there was an error formatting
  * the log message.
  */
-OPERATE_RET PrintLogV(LOG_LEVEL logLevel, char *pFile, uint32_t line, const char *pFmt, va_list ap)
+static const char *__log_file_name(const char *pFile)
 {
-    int len = 0;
-    int cnt = 0;
+    int pos = 0;
 
-    if (!pLogManage) {
-        return OPRT_INVALID_PARM;
-    }
-    if (logLevel < LOG_LEVEL_MIN || logLevel > LOG_LEVEL_MAX) {
-        return OPRT_INVALID_PARM;
-    }
-    LOG_LEVEL tmpLogLevel = pLogManage->curLogLevel;
-    if (logLevel > tmpLogLevel) {
-        return OPRT_BASE_LOG_MNG_PRINT_LOG_LEVEL_HIGHER;
+    if (NULL == pFile) {
+        return "Null";
     }
-    const char *pTmpModuleName = "ty";
-    const char *pTmpFilename = NULL;
 
-    if (NULL == pFile) {
-        pTmpFilename = "Null";
-    } else {
-        int pos = 0;
-        pTmpFilename = pFile;
-        pos = tal_log_strrchr((char *)pFile, '/');
-        if (pos < 0) {
-            pos = tal_log_strrchr((char *)pFile, '\\');
-            if (pos >= 0) {
-                pTmpFilename = pFile + pos + 1;
-            }
-        } else {
-            pTmpFilename = pFile + pos + 1;
-        }
+    pos = tal_log_strrchr((char *)pFile, '/');
+    if (pos < 0) {
+        pos = tal_log_strrchr((char *)pFile, '\\');
     }
-    tal_mutex_lock(pLogManage->mutex);
+
+    return (pos >= 0) ? (pFile + pos + 1) : pFile;
+}
+
+// color, time, level and location in front of the message, time_ms 0 is now
+static int __log_format_prefix(LOG_LEVEL logLevel, const char *pTmpFilename, uint32_t line, SYS_TICK_T time_ms)
+{
+    int len = 0;
+    int cnt = 0;
+    const char *pTmpModuleName = "ty";
 
     // color prefix
     if (pLogManage->log_color.enable_color) {
@@ -405,7 +422,7 @@ OPERATE_RET PrintLogV(LOG_LEVEL logLevel, char *pFile, uint32_t line, const char
                        pLogManage->log_color.style[logLevel].font_color,
                        pLogManage->log_color.style[logLevel].background_color);
         if (cnt <= 0) {
-            goto ERR_EXIT;
+            return -1;
         }
         len += cnt;
     }
@@ -414,12 +431,14 @@ OPERATE_RET PrintLogV(LOG_LEVEL logLevel, char *pFile, uint32_t line, const char
     memset(&tm, 0, sizeof(tm));
 
     if (pLogManage->ms_level == FALSE) {
-        tal_time_get_local_time_custom(0, &tm);
+        tal_time_get_local_time_custom((TIME_T)(time_ms / 1000), &tm);
         cnt = snprintf(pLogManage->log_buf + len, pLogManage->log_buf_len - len,
                        "[%02d-%02d %02d:%02d:%02d %s %s][%s:%" PRIu32 "] ", tm.tm_mon + 1, tm.tm_mday, tm.tm_hour,
                        tm.tm_min, tm.tm_sec, pTmpModuleName, sLevelStr[logLevel], pTmpFilename, line);
     } else {
-        SYS_TICK_T time_ms = tal_time_get_posix_ms();
+        if (0 == time_ms) {
+            time_ms = tal_time_get_posix_ms();
+        }
         TIME_T sec = (TIME_T)(time_ms / 1000);
         uint32_t ms = (uint32_t)(time_ms % 1000);
         tal_time_get_local_time_custom(sec, &tm);
@@ -428,14 +447,15 @@ OPERATE_RET PrintLogV(LOG_LEVEL logLevel, char *pFile, uint32_t line, const char
                        tm.tm_hour, tm.tm_min, tm.tm_sec, ms, pTmpModuleName, sLevelStr[logLevel], pTmpFilename, line);
     }
     if (cnt <= 0) {
-        goto ERR_EXIT;
-    }
-    len += cnt;
-    cnt = vsnprintf(pLogManage->log_buf + len, pLogManage->log_buf_len - len, pFmt, ap);
-    if (cnt <= 0) {
-        goto ERR_EXIT;
+        return -1;
     }
-    len += cnt;
+
+    return len + cnt;
+}
+
+static int __log_format_suffix(int len)
+{
+    int cnt = 0;
 
     char *p_suffix = (pLogManage->log_color.enable_color) ? "\033[0m\r\n" : "\r\n";
     if (len > (int)(pLogManage->log_buf_len - strlen(p_suffix) - 1)) { // 1 -> "\0"
@@ -443,11 +463,112 @@ OPERATE_RET PrintLogV(LOG_LEVEL logLevel, char *pFile, uint32_t line, const char
     }
     cnt = snprintf(pLogManage->log_buf + len, pLogManage->log_buf_len - len, "%s", p_suffix);
     if (cnt <= 0) {
-        goto ERR_EXIT;
+        return -1;
     }
     len += cnt;
     pLogManage->log_buf[len] = '\0';
 
+    return len;
+}
+
+static void __log_async_task(void *arg)
+{
+    LOG_ASYNC_S *async = (LOG_ASYNC_S *)arg;
+    LOG_RECORD_S *record = NULL;
+    int len = 0;
+
+    while (THREAD_STATE_RUNNING == tal_thread_get_state(async->thread)) {
+        tal_semaphore_wait(async->sem, SEM_WAIT_FOREVER);
+
+        // output in order, a slot still being written holds up the later ones
+        record = &async->record[async->tail];
+        while (LOG_RECORD_READY == record->state) {
+            tal_mutex_lock(pLogManage->mutex);
+            len = __log_format_prefix(record->level, record->file, record->line, record->time_ms);
+            if (len > 0) {
+                len += snprintf(pLogManage->log_buf + len, pLogManage->log_buf_len - len, "%s", record->msg);
+                if (__log_format_suffix(len) > 0) {
+                    __output_logManage_buf();
+                }
+            }
+            tal_mutex_unlock(pLogManage->mutex);
+
+            record->state = LOG_RECORD_FREE;
+            async->tail = (async->tail + 1) % TAL_LOG_ASYNC_RECORD_NUM;
+            record = &async->record[async->tail];
+        }
+    }
+}
+
+static OPERATE_RET __log_async_put(LOG_LEVEL logLevel, const char *pTmpFilename, uint32_t line, const char *pFmt,
+                                   va_list ap)
+{
+    LOG_ASYNC_S *async = pLogManage->async;
+    LOG_RECORD_S *record = NULL;
+
+    // only taking the slot is serialized, it is safe from any thread
+    TAL_ENTER_CRITICAL();
+    record = &async->record[async->head];
+    if (LOG_RECORD_FREE != record->state) {
+        async->drop_cnt++;
+        TAL_EXIT_CRITICAL();
+        return OPRT_EXCEED_UPPER_LIMIT;
+    }
+    record->state = LOG_RECORD_WRITING;
+    async->head = (async->head + 1) % TAL_LOG_ASYNC_RECORD_NUM;
+    TAL_EXIT_CRITICAL();
+
+    record->level = logLevel;
+    record->file = pTmpFilename;
+    record->line = line;
+    record->time_ms = tal_time_get_posix_ms();
+    if (vsnprintf(record->msg, sizeof(record->msg), pFmt, ap) < 0) {
+        record->msg[0] = '\0';
+    }
+    record->state = LOG_RECORD_READY;
+
+    tal_semaphore_post(async->sem);
+
+    return OPRT_OK;
+}
+
+OPERATE_RET PrintLogV(LOG_LEVEL logLevel, char *pFile, uint32_t line, const char *pFmt, va_list ap)
+{
+    int len = 0;
+    int cnt = 0;
+
+    if (!pLogManage) {
+        return OPRT_INVALID_PARM;
+    }
+    if (logLevel < LOG_LEVEL_MIN || logLevel > LOG_LEVEL_MAX) {
+        return OPRT_INVALID_PARM;
+    }
+    LOG_LEVEL tmpLogLevel = pLogManage->curLogLevel;
+    if (logLevel > tmpLogLevel) {
+        return OPRT_BASE_LOG_MNG_PRINT_LOG_LEVEL_HIGHER;
+    }
+    const char *pTmpFilename = __log_file_name(pFile);
+
+    if (pLogManage->async && pLogManage->async->enable) {
+        return __log_async_put(logLevel, pTmpFilename, line, pFmt, ap);
+    }
+
+    tal_mutex_lock(pLogManage->mutex);
+
+    len = __log_format_prefix(logLevel, pTmpFilename, line, 0);
+    if (len <= 0) {
+        goto ERR_EXIT;
+    }
+    cnt = vsnprintf(pLogManage->log_buf + len, pLogManage->log_buf_len - len, pFmt, ap);
+    if (cnt <= 0) {
+        goto ERR_EXIT;
+    }
+    len += cnt;
+
+    if (__log_format_suffix(len) <= 0) {
+        goto ERR_EXIT;
+    }
+
     __output_logManage_buf();
     tal_mutex_unlock(pLogManage->mutex);
 
@@ -458,6 +579,204 @@ ERR_EXIT:
     return OPRT_BASE_LOG_MNG_FORMAT_STRING_FAILED;
 }
 
+/**
+ * @brief Switches between synchronous and deferred log output.
+ *
+ * In deferred mode a log call takes a record slot in a short critical
+ * section, formats only its message into the slot and returns. A low priority
+ * thread adds the prefix and writes the records to the output terms in order,
+ * so the caller no longer waits for the mutex or the output. A log made while
+ * every slot is in use is dropped and counted. Raw and hex dump prints stay
+ * synchronous.
+ *
+ * @param enable TRUE for deferred output, the thread and records are allocated
+ * on the first call.
+ * @return OPERATE_RET Returns OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tal_log_async_enable(BOOL_T enable)
+{
+    OPERATE_RET rt = OPRT_OK;
+    LOG_ASYNC_S *async = NULL;
+
+    if (!pLogManage) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (NULL == pLogManage->async) {
+        if (!enable) {
+            return OPRT_OK;
+        }
+
+        async = (LOG_ASYNC_S *)tal_calloc(1, sizeof(LOG_ASYNC_S));
+        if (NULL == async) {
+            return OPRT_MALLOC_FAILED;
+        }
+
+        rt = tal_semaphore_create_init(&async->sem, 0, TAL_LOG_ASYNC_RECORD_NUM);
+        if (OPRT_OK != rt) {
+            tal_free(async);
+            return rt;
+        }
+
+        THREAD_CFG_T thread_cfg = {
+            .stackDepth = TAL_LOG_ASYNC_STACK_SIZE, .priority = TAL_LOG_ASYNC_THREAD_PRIO, .thrdname = "log_async"};
+        rt = tal_thread_create_and_start(&async->thread, NULL, NULL, __log_async_task, async, &thread_cfg);
+        if (OPRT_OK != rt) {
+            tal_semaphore_release(async->sem);
+            tal_free(async);
+            return rt;
+        }
+        pLogManage->async = async;
+    }
+
+    pLogManage->async->enable = enable;
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Gets the number of deferred logs dropped because every record was in
+ * use.
+ *
+ * @return The drop count since the deferred mode was first enabled.
+ */
+uint32_t tal_log_async_get_drop_cnt(void)
+{
+    if (!pLogManage || !pLogManage->async) {
+        return 0;
+    }
+
+    return pLogManage->async->drop_cnt;
+}
+
+#if defined(ENABLE_LOG_TOKENIZED) && (ENABLE_LOG_TOKENIZED == 1)
+static const char sBase64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static uint32_t __log_token_varint(uint8_t *buf, uint64_t value)
+{
+    uint32_t len = 0;
+
+    do {
+        buf[len] = (uint8_t)(value & 0x7F);
+        value >>= 7;
+        if (value) {
+            buf[len] |= 0x80;
+        }
+        len++;
+    } while (value);
+
+    return len;
+}
+
+static uint32_t __log_token_base64(const uint8_t *in, uint32_t len, char *out)
+{
+    uint32_t i = 0, n = 0, v = 0;
+
+    for (i = 0; i < len; i += 3) {
+        v = (uint32_t)in[i] << 16;
+        v |= (i + 1 < len) ? ((uint32_t)in[i + 1] << 8) : 0;
+        v |= (i + 2 < len) ? in[i + 2] : 0;
+        out[n++] = sBase64[(v >> 18) & 0x3F];
+        out[n++] = sBase64[(v >> 12) & 0x3F];
+        out[n++] = (i + 1 < len) ? sBase64[(v >> 6) & 0x3F] : '=';
+        out[n++] = (i + 2 < len) ? sBase64[v & 0x3F] : '=';
+    }
+
+    return n;
+}
+
+/**
+ * @brief Emits a tokenized log record.
+ *
+ * The record is cut after the last argument that fits TAL_LOG_TOKEN_REC_LEN,
+ * the decoder prints the missing ones as cut.
+ *
+ * @param level The log level of the message.
+ * @param token Address of the log site entry in TAL_LOG_TOKEN_SECTION.
+ * @param types Argument count and types made by TAL_LOG_TOKEN().
+ * @return The result of the log printing operation.
+ */
+OPERATE_RET tal_log_token_print(const TAL_LOG_LEVEL_E level, uint32_t token, uint32_t types, ...)
+{
+    uint8_t rec[TAL_LOG_TOKEN_REC_LEN];
+    uint32_t len = 0, i = 0, cnt = types & 0x0F;
+    uint32_t str_len = 0;
+    const char *str = NULL;
+    int64_t value = 0;
+    float fvalue = 0;
+    va_list ap;
+
+    if (!pLogManage) {
+        return OPRT_INVALID_PARM;
+    }
+    if (level < LOG_LEVEL_MIN || level > LOG_LEVEL_MAX) {
+        return OPRT_INVALID_PARM;
+    }
+    if (level > pLogManage->curLogLevel) {
+        return OPRT_BASE_LOG_MNG_PRINT_LOG_LEVEL_HIGHER;
+    }
+
+    rec[len++] = (uint8_t)level;
+    for (i = 0; i < 4; i++) {
+        rec[len++] = (uint8_t)(token >> (8 * i));
+    }
+
+    va_start(ap, types);
+    for (i = 0; i < cnt; i++) {
+        // the longest integer takes 10 bytes
+        if (len + 10 > sizeof(rec)) {
+            break;
+        }
+
+        switch ((types >> (4 + 2 * i)) & 0x03) {
+        case TAL_LOG_ARG_INT:
+            value = va_arg(ap, int32_t);
+            len += __log_token_varint(rec + len, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+            break;
+        case TAL_LOG_ARG_INT64:
+            value = va_arg(ap, int64_t);
+            len += __log_token_varint(rec + len, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+            break;
+        case TAL_LOG_ARG_DOUBLE:
+            fvalue = (float)va_arg(ap, double);
+            memcpy(rec + len, &fvalue, sizeof(fvalue));
+            len += sizeof(fvalue);
+            break;
+        default:
+            str = va_arg(ap, const char *);
+            str = str ? str : "(null)";
+            str_len = strlen(str);
+            if (str_len > sizeof(rec) - len - 1 || str_len > 0x7F) {
+                str_len = (sizeof(rec) - len - 1 > 0x7F) ? 0x7F : (sizeof(rec) - len - 1);
+                rec[len++] = (uint8_t)(str_len | 0x80);
+            } else {
+                rec[len++] = (uint8_t)str_len;
+            }
+            memcpy(rec + len, str, str_len);
+            len += str_len;
+            break;
+        }
+    }
+    va_end(ap);
+
+    if (pLogManage->log_buf_len < (int)(1 + (len + 2) / 3 * 4 + 2 + 1)) {
+        return OPRT_BASE_LOG_MNG_FORMAT_STRING_FAILED;
+    }
+
+    tal_mutex_lock(pLogManage->mutex);
+    i = 0;
+    pLogManage->log_buf[i++] = '$';
+    i += __log_token_base64(rec, len, pLogManage->log_buf + i);
+    pLogManage->log_buf[i++] = '\r';
+    pLogManage->log_buf[i++] = '\n';
+    pLogManage->log_buf[i] = '\0';
+    __output_logManage_buf();
+    tal_mutex_unlock(pLogManage->mutex);
+
+    return OPRT_OK;
+}
+#endif
+
 /**
  * @brief Prints a log message with the specified log level, file, line number,
  * and format string.
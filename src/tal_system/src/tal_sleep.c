@@ -28,16 +28,33 @@
  *
  */
 
+#include <string.h>
+
 #include "tal_sleep.h"
 #include "tal_mutex.h"
 #include "tal_log.h"
+#include "tal_system.h"
+#include "tal_sw_timer.h"
+#include "tal_workq_service.h"
 #include "tkl_sleep.h"
 
+typedef struct {
+    TAL_SLEEP_DEADLINE_CB cb;
+    void *arg;
+    SYS_TIME_T hold_since;
+    TAL_SLEEP_CLIENT_STAT_T stat;
+} TAL_SLEEP_CLIENT_T;
+
 typedef struct {
     BOOL_T lp_enable;
     uint8_t lp_mode_cnt;
     MUTEX_HANDLE lp_mutex;
     uint32_t lp_disable_cnt;
+
+    BOOL_T is_deep_allowed;
+    BOOL_T is_builtin_added;
+    uint8_t client_num;
+    TAL_SLEEP_CLIENT_T client[TAL_SLEEP_CLIENT_MAX];
 } TAL_CPU_T;
 
 static TAL_CPU_T s_tal_cpu = {0};
@@ -181,3 +198,340 @@ OPERATE_RET tal_cpu_lp_disable(void)
 
     return op_ret;
 }
+
+static uint32_t __sleep_sw_timer_deadline(void *arg)
+{
+    return tal_sw_timer_get_next_ms();
+}
+
+static BOOL_T __sleep_workq_count(WORK_ITEM_T *item, void *ctx)
+{
+    if (item->cb) {
+        (*(uint32_t *)ctx)++;
+    }
+
+    return TRUE;
+}
+
+static uint32_t __sleep_workq_deadline(void *arg)
+{
+    uint32_t num = 0;
+
+    tal_workqueue_traverse(tal_workq_get_handle(WORKQ_SYSTEM), __sleep_workq_count, &num);
+    tal_workqueue_traverse(tal_workq_get_handle(WORKQ_HIGHTPRI), __sleep_workq_count, &num);
+
+    return num ? 0 : TAL_SLEEP_NO_DEADLINE;
+}
+
+static OPERATE_RET __sleep_client_add(const char *name, TAL_SLEEP_DEADLINE_CB cb, void *arg,
+                                      TAL_SLEEP_CLIENT_HANDLE *handle)
+{
+    TAL_SLEEP_CLIENT_T *client = NULL;
+
+    if (s_tal_cpu.client_num >= TAL_SLEEP_CLIENT_MAX) {
+        PR_ERR("sleep client %s: too many", name);
+        return OPRT_EXCEED_UPPER_LIMIT;
+    }
+
+    client = &s_tal_cpu.client[s_tal_cpu.client_num];
+    memset(client, 0, sizeof(TAL_SLEEP_CLIENT_T));
+    strncpy(client->stat.name, name, TAL_SLEEP_CLIENT_NAME_LEN - 1);
+    client->cb = cb;
+    client->arg = arg;
+    s_tal_cpu.client_num++;
+
+    if (handle) {
+        *handle = client;
+    }
+
+    return OPRT_OK;
+}
+
+// called with lp_mutex locked
+static void __sleep_builtin_add(void)
+{
+    if (s_tal_cpu.is_builtin_added) {
+        return;
+    }
+
+    __sleep_client_add("sw_timer", __sleep_sw_timer_deadline, NULL, NULL);
+    __sleep_client_add("workq", __sleep_workq_deadline, NULL, NULL);
+    s_tal_cpu.is_builtin_added = TRUE;
+}
+
+/**
+ * @brief Registers a sleep client.
+ *
+ * @param name Client name, shown in the statistics.
+ * @param cb Deadline callback, NULL if the client only holds sleep.
+ * @param arg Passed to cb.
+ * @param handle Set to the client.
+ *
+ * @return The result of the operation. OPRT_OK if successful, an error code
+ * otherwise.
+ */
+OPERATE_RET tal_cpu_sleep_client_register(const char *name, TAL_SLEEP_DEADLINE_CB cb, void *arg,
+                                          TAL_SLEEP_CLIENT_HANDLE *handle)
+{
+    OPERATE_RET op_ret = OPRT_OK;
+
+    if (NULL == name || NULL == handle) {
+        return OPRT_INVALID_PARM;
+    }
+
+    op_ret = tal_cpu_lp_init_mutex();
+    if (OPRT_OK != op_ret) {
+        return op_ret;
+    }
+
+    tal_mutex_lock(s_tal_cpu.lp_mutex);
+    __sleep_builtin_add();
+    op_ret = __sleep_client_add(name, cb, arg, handle);
+    tal_mutex_unlock(s_tal_cpu.lp_mutex);
+
+    return op_ret;
+}
+
+/**
+ * @brief Keeps the CPU awake until tal_cpu_sleep_release() is called.
+ *
+ * @param handle The client.
+ *
+ * @return The result of the operation. OPRT_OK if successful, an error code
+ * otherwise.
+ */
+OPERATE_RET tal_cpu_sleep_hold(TAL_SLEEP_CLIENT_HANDLE handle)
+{
+    TAL_SLEEP_CLIENT_T *client = (TAL_SLEEP_CLIENT_T *)handle;
+    BOOL_T is_new = FALSE;
+
+    if (NULL == client) {
+        return OPRT_INVALID_PARM;
+    }
+
+    tal_mutex_lock(s_tal_cpu.lp_mutex);
+    if (!client->stat.is_holding) {
+        client->stat.is_holding = TRUE;
+        client->stat.hold_cnt++;
+        client->hold_since = tal_system_get_millisecond();
+        is_new = TRUE;
+    }
+    tal_mutex_unlock(s_tal_cpu.lp_mutex);
+
+    return is_new ? tal_cpu_lp_disable() : OPRT_OK;
+}
+
+/**
+ * @brief Ends the hold of a client.
+ *
+ * @param handle The client.
+ *
+ * @return The result of the operation. OPRT_OK if successful, an error code
+ * otherwise.
+ */
+OPERATE_RET tal_cpu_sleep_release(TAL_SLEEP_CLIENT_HANDLE handle)
+{
+    TAL_SLEEP_CLIENT_T *client = (TAL_SLEEP_CLIENT_T *)handle;
+    BOOL_T is_held = FALSE;
+    uint32_t hold_ms = 0;
+
+    if (NULL == client) {
+        return OPRT_INVALID_PARM;
+    }
+
+    tal_mutex_lock(s_tal_cpu.lp_mutex);
+    if (client->stat.is_holding) {
+        hold_ms = (uint32_t)(tal_system_get_millisecond() - client->hold_since);
+        client->stat.is_holding = FALSE;
+        client->stat.hold_ms += hold_ms;
+        if (hold_ms > client->stat.max_hold_ms) {
+            client->stat.max_hold_ms = hold_ms;
+        }
+        is_held = TRUE;
+    }
+    tal_mutex_unlock(s_tal_cpu.lp_mutex);
+
+    if (is_held && tal_cpu_get_lp_mode()) {
+        return tal_cpu_lp_enable();
+    }
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Allows deep sleep for long idle times.
+ *
+ * @param is_allowed Whether TUYA_CPU_DEEP_SLEEP may be used.
+ */
+void tal_cpu_sleep_allow_deep(BOOL_T is_allowed)
+{
+    s_tal_cpu.is_deep_allowed = is_allowed;
+}
+
+/**
+ * @brief Asks every client when the CPU is next needed.
+ *
+ * The callbacks are called without the lock held, they may take their own
+ * locks. A holding client is not asked.
+ *
+ * @param plan Filled with the nearest deadline and the mode for it.
+ *
+ * @return The result of the operation. OPRT_OK if successful, an error code
+ * otherwise.
+ */
+OPERATE_RET tal_cpu_sleep_plan(TAL_SLEEP_PLAN_T *plan)
+{
+    OPERATE_RET op_ret = OPRT_OK;
+    TAL_SLEEP_CLIENT_T *client = NULL;
+    uint8_t i = 0, num = 0;
+    uint32_t ms = 0;
+
+    if (NULL == plan) {
+        return OPRT_INVALID_PARM;
+    }
+
+    op_ret = tal_cpu_lp_init_mutex();
+    if (OPRT_OK != op_ret) {
+        return op_ret;
+    }
+
+    tal_mutex_lock(s_tal_cpu.lp_mutex);
+    __sleep_builtin_add();
+    num = s_tal_cpu.client_num;
+    tal_mutex_unlock(s_tal_cpu.lp_mutex);
+
+    plan->sleep_ms = TAL_SLEEP_NO_DEADLINE;
+    plan->blocker = NULL;
+
+    // clients are never removed, the first num entries stay valid
+    for (i = 0; i < num && plan->sleep_ms; i++) {
+        client = &s_tal_cpu.client[i];
+        if (client->stat.is_holding) {
+            ms = 0;
+        } else if (client->cb) {
+            ms = client->cb(client->arg);
+        } else {
+            continue;
+        }
+
+        if (ms < plan->sleep_ms) {
+            plan->sleep_ms = ms;
+            plan->blocker = client->stat.name;
+        }
+    }
+
+    plan->mode = (s_tal_cpu.is_deep_allowed && plan->sleep_ms >= TAL_SLEEP_DEEP_MIN_MS) ? TUYA_CPU_DEEP_SLEEP
+                                                                                       : TUYA_CPU_SLEEP;
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Sleeps the calling thread until the nearest deadline.
+ *
+ * @param max_ms The longest sleep.
+ *
+ * @return OPRT_OK after sleeping, OPRT_RESOURCE_NOT_READY if a client kept the
+ * CPU awake, an error code otherwise.
+ */
+OPERATE_RET tal_cpu_sleep_enter(uint32_t max_ms)
+{
+    OPERATE_RET op_ret = OPRT_OK;
+    TAL_SLEEP_PLAN_T plan;
+    uint8_t i = 0;
+
+    if (!tal_cpu_get_lp_mode()) {
+        return OPRT_COM_ERROR;
+    }
+
+    op_ret = tal_cpu_sleep_plan(&plan);
+    if (OPRT_OK != op_ret) {
+        return op_ret;
+    }
+
+    if (plan.sleep_ms < TAL_SLEEP_MIN_MS || s_tal_cpu.lp_disable_cnt) {
+        tal_mutex_lock(s_tal_cpu.lp_mutex);
+        for (i = 0; i < s_tal_cpu.client_num; i++) {
+            if (plan.blocker == s_tal_cpu.client[i].stat.name) {
+                s_tal_cpu.client[i].stat.block_cnt++;
+            }
+        }
+        tal_mutex_unlock(s_tal_cpu.lp_mutex);
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    if (plan.sleep_ms > max_ms) {
+        plan.sleep_ms = max_ms;
+        plan.mode = (s_tal_cpu.is_deep_allowed && max_ms >= TAL_SLEEP_DEEP_MIN_MS) ? TUYA_CPU_DEEP_SLEEP
+                                                                                  : TUYA_CPU_SLEEP;
+    }
+
+    if (TUYA_CPU_DEEP_SLEEP == plan.mode) {
+        tal_cpu_sleep_mode_set(TRUE, TUYA_CPU_DEEP_SLEEP);
+    }
+
+    tal_system_sleep(plan.sleep_ms);
+
+    if (TUYA_CPU_DEEP_SLEEP == plan.mode) {
+        tal_mutex_lock(s_tal_cpu.lp_mutex);
+        // a hold taken meanwhile switched sleep off, leave it off
+        if (!s_tal_cpu.lp_disable_cnt) {
+            tal_cpu_sleep_mode_set(TRUE, TUYA_CPU_SLEEP);
+        }
+        tal_mutex_unlock(s_tal_cpu.lp_mutex);
+    }
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Gets the statistics of a sleep client.
+ *
+ * @param idx Client index in registration order.
+ * @param stat Filled with the client statistics.
+ *
+ * @return The result of the operation. OPRT_OK if successful, an error code
+ * otherwise.
+ */
+OPERATE_RET tal_cpu_sleep_client_stat_get(uint8_t idx, TAL_SLEEP_CLIENT_STAT_T *stat)
+{
+    TAL_SLEEP_CLIENT_T *client = NULL;
+
+    if (NULL == stat || NULL == s_tal_cpu.lp_mutex) {
+        return OPRT_INVALID_PARM;
+    }
+
+    tal_mutex_lock(s_tal_cpu.lp_mutex);
+    if (idx >= s_tal_cpu.client_num) {
+        tal_mutex_unlock(s_tal_cpu.lp_mutex);
+        return OPRT_NOT_FOUND;
+    }
+    client = &s_tal_cpu.client[idx];
+    *stat = client->stat;
+    if (client->stat.is_holding) {
+        stat->hold_ms += (uint32_t)(tal_system_get_millisecond() - client->hold_since);
+    }
+    tal_mutex_unlock(s_tal_cpu.lp_mutex);
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Prints the sleep statistics of all clients.
+ */
+void tal_cpu_sleep_dump(void)
+{
+    TAL_SLEEP_CLIENT_STAT_T stat;
+    TAL_SLEEP_PLAN_T plan;
+    uint8_t i = 0;
+
+    if (OPRT_OK == tal_cpu_sleep_plan(&plan)) {
+        PR_INFO("sleep next:%dms by %s, lp disable cnt:%d", plan.sleep_ms, plan.blocker ? plan.blocker : "none",
+                s_tal_cpu.lp_disable_cnt);
+    }
+
+    for (i = 0; OPRT_OK == tal_cpu_sleep_client_stat_get(i, &stat); i++) {
+        PR_INFO("sleep client %s holding:%d holds:%d hold:%dms max:%dms blocked:%d", stat.name, stat.is_holding,
+                stat.hold_cnt, stat.hold_ms, stat.max_hold_ms, stat.block_cnt);
+    }
+}
@@ -7,11 +7,37 @@
 #include "tal_semaphore.h"
 #include "tal_sw_timer.h"
 #include "tal_time_service.h"
+#include "tal_workqueue.h"
+#include "tal_workq_service.h"
+#include "tal_trace.h"
 
 #ifndef STACK_SIZE_TIMERQ
 #define STACK_SIZE_TIMERQ (4 * 1024)
 #endif
 
+#ifndef STACK_SIZE_TIMER_LANE
+#define STACK_SIZE_TIMER_LANE (4 * 1024)
+#endif
+
+#ifndef TIMER_LANE_QUEUE_LEN
+#define TIMER_LANE_QUEUE_LEN 16
+#endif
+
+// running timers are kept on a hierarchical wheel with 1ms resolution, level n
+// has 64 slots of 64^n ms each. Start and stop are O(1), a slot of an upper
+// level is moved down when its window begins, so timers fire on their exact ms.
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SIZE (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SIZE - 1)
+
+#ifndef TIMER_WHEEL_LEVELS
+#define TIMER_WHEEL_LEVELS 5 // 64^5 ms is about 12 days, longer timers wait in the last level
+#endif
+
+#define TIMER_WHEEL_RANGE       ((uint64_t)1 << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))
+#define TIMER_WHEEL_SHIFT(lvl)  (TIMER_WHEEL_BITS * (lvl))
+#define TIMER_WHEEL_NONE        ((uint64_t)-1)
+
 typedef struct {
     LIST_HEAD node;
 
@@ -23,10 +49,23 @@ typedef struct {
     BOOL_T is_running;
     TIMER_ID timer_id;
     TIMER_TYPE type;
+
+    TAL_TIMER_EXEC_E exec;
+    uint64_t due_time; // expire time of the expiry being handled
+    BOOL_T is_posted;  // callback waits in or runs from a workqueue
+    BOOL_T is_deleted; // freed by the workqueue once the posted callback is done
+    uint8_t is_static; // in caller storage, not freed
+    uint8_t in_use;    // static storage held until the timer is freed
 } TIMER_T;
 
+// TAL_SW_TIMER_STATIC_WORDS too small for TIMER_T
+typedef char __timer_static_size_check[(sizeof(TIMER_T) <= sizeof(TAL_SW_TIMER_STATIC_T)) ? 1 : -1];
+
 typedef struct {
-    LIST_HEAD list_active;
+    LIST_HEAD wheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SIZE];
+    uint64_t wheel_bitmap[TIMER_WHEEL_LEVELS]; // slots that may hold timers, cleared lazily
+    uint64_t wheel_ms;                         // next ms the wheel will process
+    LIST_HEAD list_expired;                    // due timers waiting for their callback
     LIST_HEAD list_standby;
     MUTEX_HANDLE mutex;
     uint16_t total_cnt;
@@ -36,44 +75,228 @@ typedef struct {
     THREAD_HANDLE thread;
     SEM_HANDLE sem;
     TAL_TIMER_CB last_cb; // used to debug which cb is blocked
+
+    WORKQUEUE_HANDLE lane; // TAL_TIMER_EXEC_LANE, created on first use
+    TAL_SW_TIMER_STAT_T stat;
 } SW_TIMER_MGR_T;
 
 static SW_TIMER_MGR_T s_timer_mgr;
+TAL_THREAD_DEFINE_STATIC(s_timer_thread);
+
+static uint64_t __timer_now_ms(void)
+{
+    TIME_S secTime = 0;
+    TIME_MS msTime = 0;
+
+    tal_time_get_system_time(&secTime, &msTime);
+
+    return (uint64_t)secTime * 1000 + (uint64_t)msTime;
+}
+
+static uint8_t __timer_bit_first(uint64_t bits)
+{
+    uint8_t n = 0;
+
+    if (0 == (bits & 0xFFFFFFFFULL)) {
+        n += 32;
+        bits >>= 32;
+    }
+    if (0 == (bits & 0xFFFF)) {
+        n += 16;
+        bits >>= 16;
+    }
+    if (0 == (bits & 0xFF)) {
+        n += 8;
+        bits >>= 8;
+    }
+    if (0 == (bits & 0xF)) {
+        n += 4;
+        bits >>= 4;
+    }
+    if (0 == (bits & 0x3)) {
+        n += 2;
+        bits >>= 2;
+    }
+    if (0 == (bits & 0x1)) {
+        n += 1;
+    }
+
+    return n;
+}
 
 static void __timer_attach(TIMER_T *timer)
 {
+    uint64_t expire = timer->expire_time;
+    uint64_t delta = 0;
+    uint8_t level = 0;
+    uint8_t idx = 0;
+
     tuya_list_del(&(timer->node));
 
-    if (tuya_list_empty(&(s_timer_mgr.list_active))) {
-        tuya_list_add_tail(&(timer->node), &(s_timer_mgr.list_active));
-    } else {
-        TIMER_T *timer_tmp = NULL;
-        struct tuya_list_head *p = NULL;
-        tuya_list_for_each(p, &(s_timer_mgr.list_active))
-        {
-            timer_tmp = tuya_list_entry(p, TIMER_T, node);
+    // already due, e.g. triggered, fire on the next dispatch
+    if (expire < s_timer_mgr.wheel_ms) {
+        tuya_list_add_tail(&(timer->node), &(s_timer_mgr.list_expired));
+        return;
+    }
+
+    // parked at the end of the wheel, placed again with its real expire time when that slot is moved down
+    delta = expire - s_timer_mgr.wheel_ms;
+    if (delta >= TIMER_WHEEL_RANGE) {
+        delta = TIMER_WHEEL_RANGE - 1;
+        expire = s_timer_mgr.wheel_ms + delta;
+    }
+
+    while ((level < TIMER_WHEEL_LEVELS - 1) && (delta >= ((uint64_t)1 << TIMER_WHEEL_SHIFT(level + 1)))) {
+        level++;
+    }
+
+    idx = (expire >> TIMER_WHEEL_SHIFT(level)) & TIMER_WHEEL_MASK;
+    tuya_list_add_tail(&(timer->node), &(s_timer_mgr.wheel[level][idx]));
+    s_timer_mgr.wheel_bitmap[level] |= ((uint64_t)1 << idx);
+}
+
+static void __timer_cascade(uint8_t level, uint8_t idx)
+{
+    struct tuya_list_head *p = NULL;
+    struct tuya_list_head *n = NULL;
+
+    s_timer_mgr.wheel_bitmap[level] &= ~((uint64_t)1 << idx);
+
+    // every timer of this slot expires within the window that starts now, so it lands on a lower level
+    tuya_list_for_each_safe(p, n, &(s_timer_mgr.wheel[level][idx]))
+    {
+        __timer_attach(tuya_list_entry(p, TIMER_T, node));
+    }
+}
+
+/**
+ * @brief the ms at which the wheel next has work, firing a level 0 slot or
+ * moving down an upper level slot
+ *
+ * @return the ms, TIMER_WHEEL_NONE if no timer is running
+ */
+static uint64_t __timer_wheel_next(void)
+{
+    uint64_t next_ms = TIMER_WHEEL_NONE;
+    uint64_t slot_ms = 0;
+    uint64_t pending = 0;
+    uint64_t rotated = 0;
+    uint64_t low_mask = 0;
+    uint8_t level = 0;
+    uint8_t cur = 0;
+    uint8_t offset = 0;
+    uint8_t idx = 0;
+
+    for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        cur = (s_timer_mgr.wheel_ms >> TIMER_WHEEL_SHIFT(level)) & TIMER_WHEEL_MASK;
+        low_mask = ((uint64_t)1 << TIMER_WHEEL_SHIFT(level)) - 1;
+
+        pending = s_timer_mgr.wheel_bitmap[level];
+        while (pending) {
+            rotated = (0 == cur) ? pending : ((pending >> cur) | (pending << (TIMER_WHEEL_SIZE - cur)));
+
+            // an upper level slot under the current position is only reached after a full turn
+            if (level > 0 && (s_timer_mgr.wheel_ms & low_mask) && (rotated & ~(uint64_t)1)) {
+                rotated &= ~(uint64_t)1;
+            }
+
+            offset = __timer_bit_first(rotated);
+            idx = (cur + offset) & TIMER_WHEEL_MASK;
+            if (tuya_list_empty(&(s_timer_mgr.wheel[level][idx]))) {
+                s_timer_mgr.wheel_bitmap[level] &= ~((uint64_t)1 << idx);
+                pending &= ~((uint64_t)1 << idx);
+                continue;
+            }
+
+            if (0 == level) {
+                slot_ms = s_timer_mgr.wheel_ms + offset;
+            } else {
+                if (0 == offset && (s_timer_mgr.wheel_ms & low_mask)) {
+                    offset = TIMER_WHEEL_SIZE;
+                }
+                slot_ms = ((s_timer_mgr.wheel_ms >> TIMER_WHEEL_SHIFT(level)) + offset) << TIMER_WHEEL_SHIFT(level);
+            }
+
+            if (slot_ms < next_ms) {
+                next_ms = slot_ms;
+            }
+            break;
+        }
+    }
+
+    return next_ms;
+}
+
+/**
+ * @brief move every timer due up to now_ms to list_expired, in expire order
+ *
+ * @param[in] now_ms: current time
+ *
+ * @return none
+ */
+static void __timer_wheel_advance(uint64_t now_ms)
+{
+    struct tuya_list_head *p = NULL;
+    struct tuya_list_head *n = NULL;
+    uint64_t next_ms = 0;
+    uint8_t level = 0;
+    uint8_t idx = 0;
+
+    while (s_timer_mgr.wheel_ms <= now_ms) {
+        // skip the slots without timers
+        next_ms = __timer_wheel_next();
+        if (next_ms > now_ms) {
+            s_timer_mgr.wheel_ms = now_ms + 1;
+            break;
+        }
+        s_timer_mgr.wheel_ms = next_ms;
 
-            if (timer_tmp->expire_time >= timer->expire_time) {
-                tuya_list_add(&(timer->node), (&(timer_tmp->node))->prev);
+        for (level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+            if (s_timer_mgr.wheel_ms & (((uint64_t)1 << TIMER_WHEEL_SHIFT(level)) - 1)) {
                 break;
             }
+            __timer_cascade(level, (s_timer_mgr.wheel_ms >> TIMER_WHEEL_SHIFT(level)) & TIMER_WHEEL_MASK);
         }
 
-        if (p == &(s_timer_mgr.list_active)) {
-            tuya_list_add_tail(&(timer->node), &(s_timer_mgr.list_active));
+        idx = s_timer_mgr.wheel_ms & TIMER_WHEEL_MASK;
+        s_timer_mgr.wheel_bitmap[0] &= ~((uint64_t)1 << idx);
+        tuya_list_for_each_safe(p, n, &(s_timer_mgr.wheel[0][idx]))
+        {
+            tuya_list_del(p);
+            tuya_list_add_tail(p, &(s_timer_mgr.list_expired));
         }
+
+        s_timer_mgr.wheel_ms++;
     }
 }
 
-static void __timer_dump(void)
+static void __timer_dump_list(LIST_HEAD *list)
 {
     struct tuya_list_head *p = NULL;
     TIMER_T *timer = NULL;
     TAL_TIMER_CB *cb = NULL;
     TIMER_ID *timer_id = NULL;
 
+    tuya_list_for_each(p, list)
+    {
+        timer = tuya_list_entry(p, TIMER_T, node);
+        cb = &(timer->cb);
+        if (timer->data) {
+            timer_id = timer->data;
+            if (*timer_id == timer->timer_id) {
+                cb = (TAL_TIMER_CB *)((char *)timer->data + sizeof(TIMER_ID));
+            }
+        }
+        PR_NOTICE("%08x %d %d %p", timer->timer_id, timer->type, timer->interval, *cb);
+    }
+}
+
+static void __timer_dump(void)
+{
     TIME_S nowSecTime = 0;
     TIME_MS nowMsTime = 0;
+    uint8_t level = 0;
+    uint8_t idx = 0;
 
     tal_time_get_system_time(&nowSecTime, &nowMsTime);
 
@@ -86,87 +309,183 @@ static void __timer_dump(void)
     tal_mutex_lock(s_timer_mgr.mutex);
 
     PR_NOTICE("running timers count:%d", s_timer_mgr.running_cnt);
-    tuya_list_for_each(p, &(s_timer_mgr.list_active))
-    {
-        timer = tuya_list_entry(p, TIMER_T, node);
-        cb = &(timer->cb);
-        if (timer->data) {
-            timer_id = timer->data;
-            if (*timer_id == timer->timer_id) {
-                cb = (TAL_TIMER_CB *)((char *)timer->data + sizeof(TIMER_ID));
-            }
+    __timer_dump_list(&(s_timer_mgr.list_expired));
+    for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        for (idx = 0; idx < TIMER_WHEEL_SIZE; idx++) {
+            __timer_dump_list(&(s_timer_mgr.wheel[level][idx]));
         }
-        PR_NOTICE("%08x %d %d %p", timer->timer_id, timer->type, timer->interval, *cb);
     }
 
     PR_NOTICE("standby timers count:%d", s_timer_mgr.total_cnt - s_timer_mgr.running_cnt);
-    tuya_list_for_each(p, &(s_timer_mgr.list_standby))
-    {
-        timer = tuya_list_entry(p, TIMER_T, node);
-        cb = &(timer->cb);
-        if (timer->data) {
-            timer_id = timer->data;
-            if (*timer_id == timer->timer_id) {
-                cb = (TAL_TIMER_CB *)((char *)timer->data + sizeof(TIMER_ID));
-            }
-        }
-        PR_NOTICE("%08x %d %d %p", timer->timer_id, timer->type, timer->interval, *cb);
+    __timer_dump_list(&(s_timer_mgr.list_standby));
+
+    tal_mutex_unlock(s_timer_mgr.mutex);
+}
+
+// called with the mutex held
+static void __timer_stat_start(TIMER_T *timer, uint64_t start_ms)
+{
+    // a triggered timer has no expire time
+    if (timer->due_time && start_ms > timer->due_time &&
+        start_ms - timer->due_time > s_timer_mgr.stat.max_late_ms) {
+        s_timer_mgr.stat.max_late_ms = start_ms - timer->due_time;
+    }
+}
+
+// called with the mutex held
+static void __timer_stat_finish(TAL_TIMER_CB timer_cb, uint64_t start_ms)
+{
+    uint32_t cost_ms = (uint32_t)(__timer_now_ms() - start_ms);
+
+    if (cost_ms > TAL_SW_TIMER_OVERRUN_MS) {
+        s_timer_mgr.stat.overrun_cnt++;
+    }
+
+    if (cost_ms > s_timer_mgr.stat.max_cb_ms) {
+        s_timer_mgr.stat.max_cb_ms = cost_ms;
+        s_timer_mgr.stat.max_cb = timer_cb;
+    }
+
+    //! the callback was timed in ms, the trace keeps TAL_TRACE_TIME_US() times
+    if (tal_trace_is_running()) {
+        tal_trace_record(TAL_TRACE_TIMER, timer_cb, tal_trace_now() - cost_ms * 1000, cost_ms * 1000);
+    }
+}
+
+// called with the mutex held
+static void __timer_free(TIMER_T *timer)
+{
+    if (timer->is_static) {
+        timer->in_use = FALSE;
+    } else {
+        tal_free(timer);
+    }
+}
+
+static void __timer_work_cb(void *data)
+{
+    TIMER_T *timer = (TIMER_T *)data;
+    TAL_TIMER_CB timer_cb = NULL;
+    TIMER_ID timer_id = NULL;
+    void *timer_data = NULL;
+    uint64_t start_ms = 0;
+    BOOL_T is_deleted = FALSE;
+
+    tal_mutex_lock(s_timer_mgr.mutex);
+    if (timer->is_deleted) {
+        __timer_free(timer);
+        tal_mutex_unlock(s_timer_mgr.mutex);
+        return;
     }
+    timer_cb = timer->cb;
+    timer_id = timer->timer_id;
+    timer_data = timer->data;
+    start_ms = __timer_now_ms();
+    __timer_stat_start(timer, start_ms);
+    tal_mutex_unlock(s_timer_mgr.mutex);
+
+    timer_cb(timer_id, timer_data);
 
+    tal_mutex_lock(s_timer_mgr.mutex);
+    __timer_stat_finish(timer_cb, start_ms);
+    timer->is_posted = FALSE;
+    is_deleted = timer->is_deleted;
+    if (is_deleted) {
+        __timer_free(timer);
+    }
     tal_mutex_unlock(s_timer_mgr.mutex);
 }
 
+// called with the mutex held, the worker can not look at the timer before is_posted is set
+static void __timer_post(TIMER_T *timer, uint64_t due_ms)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    if (timer->is_posted) {
+        s_timer_mgr.stat.skipped++;
+        return;
+    }
+
+    if (TAL_TIMER_EXEC_LANE == timer->exec) {
+        rt = tal_workqueue_schedule(s_timer_mgr.lane, __timer_work_cb, timer);
+    } else {
+        rt = tal_workq_schedule(WORKQ_SYSTEM, __timer_work_cb, timer);
+    }
+
+    if (OPRT_OK != rt) {
+        s_timer_mgr.stat.skipped++;
+        return;
+    }
+    timer->is_posted = TRUE;
+    timer->due_time = due_ms;
+}
+
 static void __timer_dispatch(SYS_TIME_T *next_expired)
 {
-    TIME_S nowSecTime = 0;
-    TIME_MS nowMsTime = 0;
     uint64_t nowMS = 0;
+    uint64_t next_ms = 0;
+    uint64_t start_ms = 0;
+    uint64_t due_ms = 0;
     TIMER_T *timer = NULL;
     TAL_TIMER_CB timer_cb = NULL;
-    struct tuya_list_head *p = NULL;
-
-    *next_expired = SEM_WAIT_FOREVER;
+    TIMER_ID timer_id = NULL;
+    void *timer_data = NULL;
 
-    do {
-        tal_time_get_system_time(&nowSecTime, &nowMsTime);
-        nowMS = (uint64_t)nowSecTime * 1000 + (uint64_t)nowMsTime;
+    nowMS = __timer_now_ms();
 
-        tal_mutex_lock(s_timer_mgr.mutex);
-
-        timer_cb = NULL;
-        tuya_list_for_each(p, &(s_timer_mgr.list_active))
-        {
-            timer = tuya_list_entry(p, TIMER_T, node);
+    tal_mutex_lock(s_timer_mgr.mutex);
 
-            if (timer->expire_time > nowMS) {
-                p = &(s_timer_mgr.list_active);
-                *next_expired = timer->expire_time - nowMS;
-            } else {
-                timer_cb = timer->cb;
-
-                if (TAL_TIMER_ONCE == timer->type) {
-                    timer->is_running = FALSE;
-                    s_timer_mgr.running_cnt--;
-                    tuya_list_del(&(timer->node));
-                    tuya_list_add_tail(&(timer->node), &(s_timer_mgr.list_standby));
-                } else {
-                    timer->expire_time = nowMS + timer->interval;
-                    __timer_attach(timer);
-                }
-            }
+    __timer_wheel_advance(nowMS);
+
+    // a callback may stop, restart or delete the timers still waiting here
+    while (!tuya_list_empty(&(s_timer_mgr.list_expired))) {
+        timer = tuya_list_entry(s_timer_mgr.list_expired.next, TIMER_T, node);
+        timer_cb = timer->cb;
+        timer_id = timer->timer_id;
+        timer_data = timer->data;
+        due_ms = timer->expire_time;
+        s_timer_mgr.stat.dispatched++;
+
+        if (TAL_TIMER_ONCE == timer->type) {
+            timer->is_running = FALSE;
+            s_timer_mgr.running_cnt--;
+            tuya_list_del(&(timer->node));
+            tuya_list_add_tail(&(timer->node), &(s_timer_mgr.list_standby));
+        } else {
+            timer->expire_time = nowMS + timer->interval;
+            __timer_attach(timer);
+        }
 
-            break;
+        if (TAL_TIMER_EXEC_INLINE != timer->exec) {
+            __timer_post(timer, due_ms);
+            continue;
         }
 
+        timer->due_time = due_ms;
+        start_ms = __timer_now_ms();
+        __timer_stat_start(timer, start_ms);
+
         tal_mutex_unlock(s_timer_mgr.mutex);
 
-        if (timer_cb) {
-            s_timer_mgr.last_cb = timer_cb;
-            timer_cb(timer->timer_id, timer->data);
-            timer_cb = NULL;
-            s_timer_mgr.last_cb = NULL;
-        }
-    } while (p != &(s_timer_mgr.list_active));
+        s_timer_mgr.last_cb = timer_cb;
+        timer_cb(timer_id, timer_data);
+        s_timer_mgr.last_cb = NULL;
+
+        tal_mutex_lock(s_timer_mgr.mutex);
+
+        __timer_stat_finish(timer_cb, start_ms);
+    }
+
+    next_ms = __timer_wheel_next();
+
+    tal_mutex_unlock(s_timer_mgr.mutex);
+
+    if (TIMER_WHEEL_NONE == next_ms) {
+        *next_expired = SEM_WAIT_FOREVER;
+    } else {
+        nowMS = __timer_now_ms();
+        *next_expired = (next_ms > nowMS) ? (next_ms - nowMS) : 0;
+    }
 }
 
 static void __timer_thread_cb(void *data)
@@ -193,20 +512,31 @@ static void __timer_thread_cb(void *data)
 OPERATE_RET tal_sw_timer_init(void)
 {
     OPERATE_RET op_ret = OPRT_OK;
+    uint8_t level = 0;
+    uint8_t idx = 0;
 
     if (s_timer_mgr.inited) {
         return OPRT_OK;
     }
 
     tal_mutex_create_init(&s_timer_mgr.mutex);
+    tal_mutex_set_name(s_timer_mgr.mutex, "sw timer");
     tal_semaphore_create_init(&s_timer_mgr.sem, 0, 2);
 
-    INIT_LIST_HEAD(&(s_timer_mgr.list_active));
+    for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        for (idx = 0; idx < TIMER_WHEEL_SIZE; idx++) {
+            INIT_LIST_HEAD(&(s_timer_mgr.wheel[level][idx]));
+        }
+        s_timer_mgr.wheel_bitmap[level] = 0;
+    }
+    s_timer_mgr.wheel_ms = __timer_now_ms();
+    INIT_LIST_HEAD(&(s_timer_mgr.list_expired));
     INIT_LIST_HEAD(&(s_timer_mgr.list_standby));
 
     THREAD_CFG_T thread_cfg = {.stackDepth = STACK_SIZE_TIMERQ, .priority = THREAD_PRIO_0, .thrdname = "sys_timer"};
 
-    op_ret = tal_thread_create_and_start(&s_timer_mgr.thread, NULL, NULL, __timer_thread_cb, NULL, &thread_cfg);
+    op_ret = tal_thread_create_static(&s_timer_mgr.thread, &s_timer_thread, NULL, NULL, __timer_thread_cb, NULL,
+                                      &thread_cfg);
     if (OPRT_OK == op_ret) {
         s_timer_mgr.inited = TRUE;
     }
@@ -214,6 +544,20 @@ OPERATE_RET tal_sw_timer_init(void)
     return op_ret;
 }
 
+static void __timer_add(TIMER_T *timer, TAL_TIMER_CB func, void *arg, uint8_t is_static)
+{
+    timer->cb = func;
+    timer->data = arg;
+    timer->timer_id = (TIMER_ID)timer;
+    timer->is_static = is_static;
+    timer->in_use = TRUE;
+
+    tal_mutex_lock(s_timer_mgr.mutex);
+    s_timer_mgr.total_cnt++;
+    tuya_list_add_tail(&(timer->node), &(s_timer_mgr.list_standby));
+    tal_mutex_unlock(s_timer_mgr.mutex);
+}
+
 /**
  * @brief create a software timer
  *
@@ -237,15 +581,45 @@ OPERATE_RET tal_sw_timer_create(TAL_TIMER_CB func, void *arg, TIMER_ID *timer_id
         return OPRT_MALLOC_FAILED;
     }
 
-    timer->cb = func;
-    timer->data = arg;
-    timer->timer_id = (TIMER_ID)timer;
+    __timer_add(timer, func, arg, FALSE);
+    *timer_id = timer->timer_id;
 
-    tal_mutex_lock(s_timer_mgr.mutex);
-    s_timer_mgr.total_cnt++;
-    tuya_list_add_tail(&(timer->node), &(s_timer_mgr.list_standby));
-    tal_mutex_unlock(s_timer_mgr.mutex);
+    return OPRT_OK;
+}
+
+/**
+ * @brief create a software timer in caller-provided storage
+ *
+ * @param[in] storage: the timer, valid until the timer is deleted
+ * @param[in] func: the processing function of the timer
+ * @param[in] arg: the parameater of the timer function
+ * @param[out] timer_id: timer id
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_sw_timer_create_static(TAL_SW_TIMER_STATIC_T *storage, TAL_TIMER_CB func, void *arg,
+                                       TIMER_ID *timer_id)
+{
+    TIMER_T *timer = (TIMER_T *)storage;
+    BOOL_T is_held = FALSE;
+
+    if ((NULL == storage) || (NULL == func) || (NULL == timer_id)) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (s_timer_mgr.mutex) {
+        tal_mutex_lock(s_timer_mgr.mutex);
+        is_held = timer->in_use;
+        tal_mutex_unlock(s_timer_mgr.mutex);
+    }
+    if (is_held) {
+        PR_WARN("timer storage %p still held, using heap", storage);
+        return tal_sw_timer_create(func, arg, timer_id);
+    }
 
+    memset(timer, 0, sizeof(TIMER_T));
+    __timer_add(timer, func, arg, TRUE);
     *timer_id = timer->timer_id;
 
     return OPRT_OK;
@@ -268,6 +642,7 @@ OPERATE_RET tal_sw_timer_delete(TIMER_ID timer_id)
     }
 
     TIMER_T *timer = (TIMER_T *)timer_id;
+    BOOL_T is_posted = FALSE;
 
     tal_mutex_lock(s_timer_mgr.mutex);
     tuya_list_del(&(timer->node));
@@ -275,9 +650,14 @@ OPERATE_RET tal_sw_timer_delete(TIMER_ID timer_id)
     if (timer->is_running) {
         s_timer_mgr.running_cnt--;
     }
+    timer->is_deleted = TRUE;
+    is_posted = timer->is_posted;
+    // the workqueue frees it after the posted callback
+    if (!is_posted) {
+        __timer_free(timer);
+    }
     tal_mutex_unlock(s_timer_mgr.mutex);
     tal_semaphore_post(s_timer_mgr.sem);
-    tal_free(timer);
 
     return OPRT_OK;
 }
@@ -442,8 +822,7 @@ OPERATE_RET tal_sw_timer_trigger(TIMER_ID timer_id)
     tal_mutex_lock(s_timer_mgr.mutex);
     timer->expire_time = 0;
     if (timer->is_running) {
-        tuya_list_del(&(timer->node));
-        tuya_list_add(&(timer->node), &(s_timer_mgr.list_active));
+        __timer_attach(timer);
     }
     tal_mutex_unlock(s_timer_mgr.mutex);
     tal_semaphore_post(s_timer_mgr.sem);
@@ -451,6 +830,68 @@ OPERATE_RET tal_sw_timer_trigger(TIMER_ID timer_id)
     return OPRT_OK;
 }
 
+/**
+ * @brief Choose where the callback of a timer runs
+ *
+ * @param[in] timer_id: timer id
+ * @param[in] exec: see TAL_TIMER_EXEC_E
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_sw_timer_set_exec(TIMER_ID timer_id, TAL_TIMER_EXEC_E exec)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    if (NULL == timer_id || exec > TAL_TIMER_EXEC_LANE) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (TAL_TIMER_EXEC_WORKQ == exec && NULL == tal_workq_get_handle(WORKQ_SYSTEM)) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    TIMER_T *timer = (TIMER_T *)timer_id;
+
+    tal_mutex_lock(s_timer_mgr.mutex);
+    if (TAL_TIMER_EXEC_LANE == exec && NULL == s_timer_mgr.lane) {
+        THREAD_CFG_T thread_cfg = {
+            .stackDepth = STACK_SIZE_TIMER_LANE, .priority = THREAD_PRIO_0, .thrdname = "sys_timer_lane"};
+        rt = tal_workqueue_create(TIMER_LANE_QUEUE_LEN, &thread_cfg, &s_timer_mgr.lane);
+    }
+    if (OPRT_OK == rt) {
+        timer->exec = exec;
+    }
+    tal_mutex_unlock(s_timer_mgr.mutex);
+
+    return rt;
+}
+
+/**
+ * @brief Get the callback statistics
+ *
+ * @param[out] stat: statistics
+ * @param[in] is_reset: TRUE to clear them after reading
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_sw_timer_stat_get(TAL_SW_TIMER_STAT_T *stat, BOOL_T is_reset)
+{
+    if (NULL == stat) {
+        return OPRT_INVALID_PARM;
+    }
+
+    tal_mutex_lock(s_timer_mgr.mutex);
+    *stat = s_timer_mgr.stat;
+    if (is_reset) {
+        memset(&s_timer_mgr.stat, 0, sizeof(s_timer_mgr.stat));
+    }
+    tal_mutex_unlock(s_timer_mgr.mutex);
+
+    return OPRT_OK;
+}
+
 /**
  * @brief Release all resource of the software timer
  *
@@ -486,10 +927,49 @@ int tal_sw_timer_get_num(void)
     return s_timer_mgr.running_cnt;
 }
 
+/**
+ * @brief Get the time until the timer thread next has work
+ *
+ * @param void
+ *
+ * @return ms until then, 0 if callbacks are due, 0xFFFFFFFF if no timer is running.
+ */
+uint32_t tal_sw_timer_get_next_ms(void)
+{
+    uint64_t next_ms = TIMER_WHEEL_NONE;
+    uint64_t now_ms = 0;
+
+    if (!s_timer_mgr.inited) {
+        return 0xFFFFFFFF;
+    }
+
+    tal_mutex_lock(s_timer_mgr.mutex);
+    if (!tuya_list_empty(&s_timer_mgr.list_expired)) {
+        next_ms = 0;
+    } else {
+        next_ms = __timer_wheel_next();
+    }
+    tal_mutex_unlock(s_timer_mgr.mutex);
+
+    if (TIMER_WHEEL_NONE == next_ms) {
+        return 0xFFFFFFFF;
+    }
+
+    now_ms = __timer_now_ms();
+    if (next_ms <= now_ms) {
+        return 0;
+    }
+
+    return (next_ms - now_ms >= 0xFFFFFFFF) ? 0xFFFFFFFE : (uint32_t)(next_ms - now_ms);
+}
+
 // used for debug
 void tal_sw_timer_dump(void)
 {
     PR_NOTICE("---------timer queue dump begin---------");
+    PR_NOTICE("dispatched:%d skipped:%d overrun:%d max cb:%dms %p max late:%dms", s_timer_mgr.stat.dispatched,
+              s_timer_mgr.stat.skipped, s_timer_mgr.stat.overrun_cnt, s_timer_mgr.stat.max_cb_ms,
+              s_timer_mgr.stat.max_cb, s_timer_mgr.stat.max_late_ms);
     __timer_dump();
     PR_NOTICE("---------timer queue dump end---------");
 }
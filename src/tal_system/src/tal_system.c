@@ -27,37 +27,415 @@
  *
  */
 
+// the functions are defined here under their own names
+#define TAL_MEM_TRACK_NO_MACRO
+
 #include "tkl_system.h"
 #include "tkl_memory.h"
 #include "tal_system.h"
 #include "tal_sleep.h"
 #include "tal_log.h"
 #include "tal_memory.h"
+#include "tal_thread.h"
+#include "tal_trace.h"
 
-/**
- * @brief Allocates a block of memory of the specified size.
- *
- * This function is used to dynamically allocate memory of the specified size.
- *
- * @param size The size of the memory block to allocate.
- * @return A pointer to the allocated memory block, or NULL if the allocation
- * fails.
- */
-void *tal_malloc(size_t size)
+#include <string.h>
+
+#if defined(ENABLE_MEM_SLAB) && (ENABLE_MEM_SLAB == 1)
+
+#define MEM_SLAB_ALIGN       8
+#define MEM_SLAB_ROUND(size) (((size) + MEM_SLAB_ALIGN - 1) & ~(MEM_SLAB_ALIGN - 1))
+
+typedef enum {
+    MEM_SLAB_IDLE = 0,
+    MEM_SLAB_INITING,
+    MEM_SLAB_READY,
+    MEM_SLAB_DISABLED,
+} MEM_SLAB_STATE_E;
+
+typedef struct {
+    uint8_t *base;
+    uint8_t *end;
+    void *free_list; // each free block holds the next one
+    TAL_MEM_SLAB_STAT_T stat;
+} MEM_SLAB_CLASS_T;
+
+static const uint16_t sg_slab_sizes[] = TAL_MEM_SLAB_SIZES;
+static const uint16_t sg_slab_counts[] = TAL_MEM_SLAB_COUNTS;
+static MEM_SLAB_CLASS_T sg_slab[CNTSOF(sg_slab_sizes)];
+static volatile uint8_t sg_slab_state = MEM_SLAB_IDLE;
+
+static BOOL_T __slab_set_state(uint8_t from, uint8_t to)
+{
+    BOOL_T is_set = FALSE;
+
+    TAL_ENTER_CRITICAL();
+    if (sg_slab_state == from) {
+        sg_slab_state = to;
+        is_set = TRUE;
+    }
+    TAL_EXIT_CRITICAL();
+
+    return is_set;
+}
+
+static void __slab_init(void)
+{
+    uint8_t i = 0;
+    uint16_t j = 0;
+    size_t len = 0;
+    MEM_SLAB_CLASS_T *slab = NULL;
+
+    // requests made meanwhile go to the heap
+    if (!__slab_set_state(MEM_SLAB_IDLE, MEM_SLAB_INITING)) {
+        return;
+    }
+
+    for (i = 0; i < CNTSOF(sg_slab); i++) {
+        slab = &sg_slab[i];
+        slab->stat.block_size = MEM_SLAB_ROUND(sg_slab_sizes[i]);
+        slab->stat.block_num = sg_slab_counts[i];
+        len = (size_t)slab->stat.block_size * slab->stat.block_num;
+
+#if defined(ENABLE_EXT_RAM) && (ENABLE_EXT_RAM == 1)
+        if (TAL_MEM_SLAB_PSRAM_MASK & (1UL << i)) {
+            slab->stat.is_psram = TRUE;
+            slab->base = tkl_system_psram_malloc(len);
+        } else
+#endif
+        {
+            slab->base = tkl_system_malloc(len);
+        }
+        if (NULL == slab->base) {
+            PR_ERR("slab class %d malloc failed:0x%x", i, len);
+            goto __ERR;
+        }
+        slab->end = slab->base + len;
+
+        for (j = slab->stat.block_num; j > 0; j--) {
+            *(void **)(slab->base + (j - 1) * slab->stat.block_size) = slab->free_list;
+            slab->free_list = slab->base + (j - 1) * slab->stat.block_size;
+        }
+    }
+
+    __slab_set_state(MEM_SLAB_INITING, MEM_SLAB_READY);
+    return;
+
+__ERR:
+    for (i = 0; i < CNTSOF(sg_slab); i++) {
+        if (NULL == sg_slab[i].base) {
+            continue;
+        }
+#if defined(ENABLE_EXT_RAM) && (ENABLE_EXT_RAM == 1)
+        if (sg_slab[i].stat.is_psram) {
+            tkl_system_psram_free(sg_slab[i].base);
+            continue;
+        }
+#endif
+        tkl_system_free(sg_slab[i].base);
+    }
+    memset(sg_slab, 0, sizeof(sg_slab));
+    __slab_set_state(MEM_SLAB_INITING, MEM_SLAB_DISABLED);
+}
+
+static void *__slab_alloc(size_t size)
+{
+    uint8_t i = 0;
+    void *ptr = NULL;
+    MEM_SLAB_CLASS_T *slab = NULL;
+
+    if (MEM_SLAB_IDLE == sg_slab_state) {
+        __slab_init();
+    }
+    if (MEM_SLAB_READY != sg_slab_state) {
+        return NULL;
+    }
+
+    for (i = 0; i < CNTSOF(sg_slab); i++) {
+        slab = &sg_slab[i];
+        if (size > slab->stat.block_size) {
+            continue;
+        }
+
+        TAL_ENTER_CRITICAL();
+        ptr = slab->free_list;
+        if (ptr) {
+            slab->free_list = *(void **)ptr;
+            slab->stat.alloc_cnt++;
+            if (++slab->stat.used > slab->stat.peak) {
+                slab->stat.peak = slab->stat.used;
+            }
+        } else {
+            slab->stat.fail_cnt++;
+        }
+        TAL_EXIT_CRITICAL();
+        break;
+    }
+
+    return ptr;
+}
+
+static MEM_SLAB_CLASS_T *__slab_find(void *ptr)
+{
+    uint8_t i = 0;
+
+    if (MEM_SLAB_READY != sg_slab_state) {
+        return NULL;
+    }
+
+    for (i = 0; i < CNTSOF(sg_slab); i++) {
+        if ((uint8_t *)ptr >= sg_slab[i].base && (uint8_t *)ptr < sg_slab[i].end) {
+            return &sg_slab[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void __slab_free(MEM_SLAB_CLASS_T *slab, void *ptr)
+{
+    TAL_ENTER_CRITICAL();
+    *(void **)ptr = slab->free_list;
+    slab->free_list = ptr;
+    slab->stat.used--;
+    TAL_EXIT_CRITICAL();
+}
+#endif
+
+static void *__heap_malloc(size_t size, void *caller)
 {
     if (0 == size) {
         return NULL;
     }
 
     void *ptr = NULL;
+#if defined(ENABLE_MEM_SLAB) && (ENABLE_MEM_SLAB == 1)
+    ptr = __slab_alloc(size);
+    if (NULL != ptr) {
+        return ptr;
+    }
+#endif
     ptr = tkl_system_malloc(size);
     if (NULL == ptr) {
-        PR_ERR("0x%x malloc failed:0x%x free:0x%x", __builtin_return_address(0), size, tal_system_get_free_heap_size());
+        PR_ERR("0x%x malloc failed:0x%x free:0x%x", caller, size, tal_system_get_free_heap_size());
     }
 
     return ptr;
 }
 
+static void __heap_free(void *ptr)
+{
+    if (NULL == ptr) {
+        return;
+    }
+
+#if defined(ENABLE_MEM_SLAB) && (ENABLE_MEM_SLAB == 1)
+    MEM_SLAB_CLASS_T *slab = __slab_find(ptr);
+    if (NULL != slab) {
+        __slab_free(slab, ptr);
+        return;
+    }
+#endif
+
+    tkl_system_free(ptr);
+}
+
+static void *__heap_calloc(size_t nitems, size_t size)
+{
+#if defined(ENABLE_MEM_SLAB) && (ENABLE_MEM_SLAB == 1)
+    void *ptr = NULL;
+    if (nitems && size && nitems <= ((size_t)-1) / size) {
+        ptr = __slab_alloc(nitems * size);
+        if (NULL != ptr) {
+            memset(ptr, 0, nitems * size);
+            return ptr;
+        }
+    }
+#endif
+
+    return tkl_system_calloc(nitems, size);
+}
+
+static void *__heap_realloc(void *ptr, size_t size, void *caller)
+{
+#if defined(ENABLE_MEM_SLAB) && (ENABLE_MEM_SLAB == 1)
+    MEM_SLAB_CLASS_T *slab = __slab_find(ptr);
+    void *new_ptr = NULL;
+
+    if (NULL != slab) {
+        if (0 == size) {
+            __slab_free(slab, ptr);
+            return NULL;
+        }
+        if (size <= slab->stat.block_size) {
+            return ptr;
+        }
+
+        new_ptr = __heap_malloc(size, caller);
+        if (NULL != new_ptr) {
+            memcpy(new_ptr, ptr, slab->stat.block_size);
+            __slab_free(slab, ptr);
+        }
+        return new_ptr;
+    }
+#endif
+
+    return tkl_system_realloc(ptr, size);
+}
+
+#if defined(ENABLE_MEM_TRACK) && (ENABLE_MEM_TRACK == 1)
+#define MEM_TRACK_MAGIC 0x7A3C
+
+//! in front of every tracked block, 8 bytes so the block keeps its alignment
+typedef struct {
+    uint16_t magic;
+    uint16_t site;
+    uint32_t size;
+} MEM_TRACK_HDR_T;
+
+typedef struct {
+    uint32_t cnt;
+    uint32_t bytes;
+} MEM_TRACK_SNAP_T;
+
+//! site 0 takes the blocks of sites that did not fit in the table
+static TAL_MEM_SITE_T s_mem_site[TAL_MEM_TRACK_SITE_NUM];
+static uint32_t s_mem_live_bytes;
+static MEM_TRACK_SNAP_T *s_mem_snap;
+
+// called in the critical section
+static uint16_t __track_site(const char *file, uint32_t line)
+{
+    uint32_t i = 0, idx = 0;
+    TAL_MEM_SITE_T *site = NULL;
+
+    idx = (((uint32_t)(uintptr_t)file >> 2) ^ (line * 2654435761u)) % (TAL_MEM_TRACK_SITE_NUM - 1);
+    for (i = 0; i < TAL_MEM_TRACK_SITE_NUM - 1; i++) {
+        site = &s_mem_site[1 + (idx + i) % (TAL_MEM_TRACK_SITE_NUM - 1)];
+        if (site->file == file && site->line == line && site->alloc_cnt) {
+            return site - s_mem_site;
+        }
+        if (0 == site->alloc_cnt) {
+            site->file = file;
+            site->line = line;
+            return site - s_mem_site;
+        }
+    }
+
+    return 0;
+}
+
+static void *__track_add(MEM_TRACK_HDR_T *hdr, size_t size, const char *file, uint32_t line)
+{
+    uint16_t idx = 0;
+
+    if (NULL == hdr) {
+        return NULL;
+    }
+
+    TAL_ENTER_CRITICAL();
+    idx = __track_site(file, line);
+    s_mem_site[idx].cnt++;
+    s_mem_site[idx].bytes += size;
+    s_mem_site[idx].alloc_cnt++;
+    s_mem_live_bytes += size;
+    TAL_EXIT_CRITICAL();
+
+    hdr->magic = MEM_TRACK_MAGIC;
+    hdr->site = idx;
+    hdr->size = size;
+    return hdr + 1;
+}
+
+static void __track_sub(uint16_t idx, uint32_t size)
+{
+    TAL_ENTER_CRITICAL();
+    s_mem_site[idx].cnt--;
+    s_mem_site[idx].bytes -= size;
+    s_mem_live_bytes -= size;
+    TAL_EXIT_CRITICAL();
+}
+
+//! NULL when ptr did not come from tal_malloc(), vendor memory freed here
+static MEM_TRACK_HDR_T *__track_hdr(void *ptr)
+{
+    MEM_TRACK_HDR_T *hdr = (MEM_TRACK_HDR_T *)ptr - 1;
+
+    if (MEM_TRACK_MAGIC != hdr->magic || hdr->site >= TAL_MEM_TRACK_SITE_NUM) {
+        return NULL;
+    }
+    return hdr;
+}
+
+void *tal_malloc_track(size_t size, const char *file, uint32_t line)
+{
+    if (0 == size || size > UINT32_MAX - sizeof(MEM_TRACK_HDR_T)) {
+        return NULL;
+    }
+
+    return __track_add(__heap_malloc(size + sizeof(MEM_TRACK_HDR_T), __builtin_return_address(0)), size, file, line);
+}
+
+void *tal_calloc_track(size_t nitems, size_t size, const char *file, uint32_t line)
+{
+    size_t total = 0;
+
+    if (0 == nitems || 0 == size || nitems > (UINT32_MAX - sizeof(MEM_TRACK_HDR_T)) / size) {
+        return NULL;
+    }
+
+    total = nitems * size;
+    return __track_add(__heap_calloc(1, total + sizeof(MEM_TRACK_HDR_T)), total, file, line);
+}
+
+void *tal_realloc_track(void *ptr, size_t size, const char *file, uint32_t line)
+{
+    MEM_TRACK_HDR_T *hdr = NULL, old;
+    void *new_ptr = NULL;
+
+    if (NULL == ptr) {
+        return tal_malloc_track(size, file, line);
+    }
+    hdr = __track_hdr(ptr);
+    if (NULL == hdr) {
+        return __heap_realloc(ptr, size, __builtin_return_address(0));
+    }
+    if (0 == size) {
+        tal_free(ptr);
+        return NULL;
+    }
+    if (size > UINT32_MAX - sizeof(MEM_TRACK_HDR_T)) {
+        return NULL;
+    }
+
+    old = *hdr;
+    new_ptr = __heap_realloc(hdr, size + sizeof(MEM_TRACK_HDR_T), __builtin_return_address(0));
+    if (NULL == new_ptr) {
+        return NULL;
+    }
+    __track_sub(old.site, old.size);
+    return __track_add(new_ptr, size, file, line);
+}
+#endif
+
+/**
+ * @brief Allocates a block of memory of the specified size.
+ *
+ * This function is used to dynamically allocate memory of the specified size.
+ *
+ * @param size The size of the memory block to allocate.
+ * @return A pointer to the allocated memory block, or NULL if the allocation
+ * fails.
+ */
+void *tal_malloc(size_t size)
+{
+#if defined(ENABLE_MEM_TRACK) && (ENABLE_MEM_TRACK == 1)
+    return tal_malloc_track(size, NULL, (uint32_t)(uintptr_t)__builtin_return_address(0));
+#else
+    return __heap_malloc(size, __builtin_return_address(0));
+#endif
+}
+
 /**
  * @brief Frees the memory pointed to by the given pointer.
  *
@@ -73,7 +451,16 @@ void tal_free(void *ptr)
         return;
     }
 
-    tkl_system_free(ptr);
+#if defined(ENABLE_MEM_TRACK) && (ENABLE_MEM_TRACK == 1)
+    MEM_TRACK_HDR_T *hdr = __track_hdr(ptr);
+    if (NULL != hdr) {
+        __track_sub(hdr->site, hdr->size);
+        hdr->magic = 0;
+        ptr = hdr;
+    }
+#endif
+
+    __heap_free(ptr);
 }
 
 /**
@@ -88,7 +475,11 @@ void tal_free(void *ptr)
  */
 void *tal_calloc(size_t nitems, size_t size)
 {
-    return tkl_system_calloc(nitems, size);
+#if defined(ENABLE_MEM_TRACK) && (ENABLE_MEM_TRACK == 1)
+    return tal_calloc_track(nitems, size, NULL, (uint32_t)(uintptr_t)__builtin_return_address(0));
+#else
+    return __heap_calloc(nitems, size);
+#endif
 }
 
 /**
@@ -102,7 +493,11 @@ void *tal_calloc(size_t nitems, size_t size)
  */
 void *tal_realloc(void *ptr, size_t size)
 {
-    return tkl_system_realloc(ptr, size);
+#if defined(ENABLE_MEM_TRACK) && (ENABLE_MEM_TRACK == 1)
+    return tal_realloc_track(ptr, size, NULL, (uint32_t)(uintptr_t)__builtin_return_address(0));
+#else
+    return __heap_realloc(ptr, size, __builtin_return_address(0));
+#endif
 }
 
 #if defined(ENABLE_EXT_RAM) && (ENABLE_EXT_RAM == 1)
@@ -143,6 +538,244 @@ void *tal_psram_realloc(void *ptr, size_t size)
 }
 #endif
 
+#if defined(ENABLE_MEM_SLAB) && (ENABLE_MEM_SLAB == 1)
+/**
+ * @brief Get the number of slab size classes.
+ *
+ * @return The number of classes set by TAL_MEM_SLAB_SIZES.
+ */
+uint8_t tal_mem_slab_get_class_num(void)
+{
+    return CNTSOF(sg_slab);
+}
+
+/**
+ * @brief Get the statistics of a slab size class.
+ *
+ * The block arrays are allocated by the first small request, until then
+ * there is nothing to report.
+ *
+ * @param idx Class index, smallest first.
+ * @param stat Filled with the class statistics.
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tal_mem_slab_get_stat(uint8_t idx, TAL_MEM_SLAB_STAT_T *stat)
+{
+    if (idx >= CNTSOF(sg_slab) || NULL == stat) {
+        return OPRT_INVALID_PARM;
+    }
+    if (MEM_SLAB_READY != sg_slab_state) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    TAL_ENTER_CRITICAL();
+    *stat = sg_slab[idx].stat;
+    TAL_EXIT_CRITICAL();
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Print the statistics of all slab size classes.
+ */
+void tal_mem_slab_dump(void)
+{
+    uint8_t i = 0;
+    TAL_MEM_SLAB_STAT_T stat;
+
+    for (i = 0; i < CNTSOF(sg_slab); i++) {
+        if (OPRT_OK != tal_mem_slab_get_stat(i, &stat)) {
+            PR_INFO("slab not ready");
+            return;
+        }
+        PR_INFO("slab %d size:%d num:%d used:%d peak:%d alloc:%d fail:%d%s", i, stat.block_size, stat.block_num,
+                stat.used, stat.peak, stat.alloc_cnt, stat.fail_cnt, stat.is_psram ? " psram" : "");
+    }
+}
+#endif
+
+/**
+ * @brief Get the free heap, the largest block it can still give and how
+ * fragmented it is.
+ *
+ * The kernel layer reports only the free size, so the largest block is found
+ * by trying allocations, halving the step down to TAL_MEM_PROBE_STEP. It is
+ * an estimate while other threads allocate, and takes some tens of
+ * allocations, so it is meant for periodic checks.
+ *
+ * @param stat Filled with the heap statistics.
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tal_mem_get_heap_stat(TAL_MEM_HEAP_STAT_T *stat)
+{
+    uint32_t lo = 0, hi = 0, mid = 0;
+    void *ptr = NULL;
+    int free_size = 0;
+
+    if (NULL == stat) {
+        return OPRT_INVALID_PARM;
+    }
+
+    free_size = tal_system_get_free_heap_size();
+    memset(stat, 0, sizeof(TAL_MEM_HEAP_STAT_T));
+    if (free_size <= 0) {
+        return OPRT_COM_ERROR;
+    }
+    stat->free_size = (uint32_t)free_size;
+
+    hi = stat->free_size;
+    while (hi - lo > TAL_MEM_PROBE_STEP) {
+        mid = lo + (hi - lo) / 2;
+        ptr = tkl_system_malloc(mid);
+        if (ptr) {
+            tkl_system_free(ptr);
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    stat->largest_free = lo;
+    stat->frag_pct = (uint8_t)(100 - (uint64_t)lo * 100 / stat->free_size);
+
+    return OPRT_OK;
+}
+
+#if defined(ENABLE_MEM_TRACK) && (ENABLE_MEM_TRACK == 1)
+/**
+ * @brief Get the allocation sites that hold memory.
+ *
+ * @param site Array of num sites.
+ * @param num Array size.
+ * @return The number of sites filled.
+ */
+uint32_t tal_mem_track_get(TAL_MEM_SITE_T *site, uint32_t num)
+{
+    uint32_t i = 0, cnt = 0;
+
+    if (NULL == site) {
+        return 0;
+    }
+
+    TAL_ENTER_CRITICAL();
+    for (i = 0; i < TAL_MEM_TRACK_SITE_NUM && cnt < num; i++) {
+        if (s_mem_site[i].cnt) {
+            site[cnt++] = s_mem_site[i];
+        }
+    }
+    TAL_EXIT_CRITICAL();
+
+    return cnt;
+}
+
+/**
+ * @brief Get the bytes held by all tracked blocks.
+ *
+ * @return The live bytes, without the block headers.
+ */
+uint32_t tal_mem_track_live_bytes(void)
+{
+    return s_mem_live_bytes;
+}
+
+/**
+ * @brief Keep the counts of every site for a later tal_mem_track_diff().
+ *
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tal_mem_track_snapshot(void)
+{
+    uint32_t i = 0;
+
+    if (NULL == s_mem_snap) {
+        // not tracked, it would show up in every diff
+        s_mem_snap = __heap_malloc(TAL_MEM_TRACK_SITE_NUM * sizeof(MEM_TRACK_SNAP_T), __builtin_return_address(0));
+        if (NULL == s_mem_snap) {
+            return OPRT_MALLOC_FAILED;
+        }
+    }
+
+    TAL_ENTER_CRITICAL();
+    for (i = 0; i < TAL_MEM_TRACK_SITE_NUM; i++) {
+        s_mem_snap[i].cnt = s_mem_site[i].cnt;
+        s_mem_snap[i].bytes = s_mem_site[i].bytes;
+    }
+    TAL_EXIT_CRITICAL();
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Get the sites whose blocks changed since tal_mem_track_snapshot().
+ *
+ * Memory taken between two points and not given back shows up as positive
+ * deltas, a site that grows on every diff is a leak candidate.
+ *
+ * @param diff Array of num deltas.
+ * @param num Array size.
+ * @return The number of deltas filled.
+ */
+uint32_t tal_mem_track_diff(TAL_MEM_SITE_DIFF_T *diff, uint32_t num)
+{
+    uint32_t i = 0, cnt = 0;
+
+    if (NULL == diff || NULL == s_mem_snap) {
+        return 0;
+    }
+
+    TAL_ENTER_CRITICAL();
+    for (i = 0; i < TAL_MEM_TRACK_SITE_NUM && cnt < num; i++) {
+        if (s_mem_site[i].bytes == s_mem_snap[i].bytes && s_mem_site[i].cnt == s_mem_snap[i].cnt) {
+            continue;
+        }
+        diff[cnt].file = s_mem_site[i].file;
+        diff[cnt].line = s_mem_site[i].line;
+        diff[cnt].cnt = (int32_t)(s_mem_site[i].cnt - s_mem_snap[i].cnt);
+        diff[cnt].bytes = (int32_t)(s_mem_site[i].bytes - s_mem_snap[i].bytes);
+        cnt++;
+    }
+    TAL_EXIT_CRITICAL();
+
+    return cnt;
+}
+
+/**
+ * @brief Print the sites holding the most memory.
+ *
+ * @param num How many sites to print.
+ */
+void tal_mem_track_dump(uint32_t num)
+{
+    TAL_MEM_SITE_T *site = NULL, tmp;
+    uint32_t cnt = 0, i = 0, j = 0;
+
+    site = __heap_malloc(TAL_MEM_TRACK_SITE_NUM * sizeof(TAL_MEM_SITE_T), __builtin_return_address(0));
+    if (NULL == site) {
+        return;
+    }
+
+    cnt = tal_mem_track_get(site, TAL_MEM_TRACK_SITE_NUM);
+    PR_NOTICE("heap tracked %u bytes in %u sites", s_mem_live_bytes, cnt);
+    for (i = 0; i < cnt && i < num; i++) {
+        for (j = i + 1; j < cnt; j++) {
+            if (site[j].bytes > site[i].bytes) {
+                tmp = site[i];
+                site[i] = site[j];
+                site[j] = tmp;
+            }
+        }
+        if (site[i].file) {
+            PR_NOTICE("  %8u bytes %5u blocks %8u allocs  %s:%u", site[i].bytes, site[i].cnt, site[i].alloc_cnt,
+                      site[i].file, site[i].line);
+        } else {
+            PR_NOTICE("  %8u bytes %5u blocks %8u allocs  0x%08x", site[i].bytes, site[i].cnt, site[i].alloc_cnt,
+                      site[i].line);
+        }
+    }
+
+    __heap_free(site);
+}
+#endif
+
 /**
  * @brief Sleeps for the specified amount of time in milliseconds.
  *
@@ -153,7 +786,15 @@ void *tal_psram_realloc(void *ptr, size_t size)
  */
 void tal_system_sleep(uint32_t time_ms)
 {
+    uint32_t trace_us = tal_trace_now();
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+    void *prof = tal_thread_prof_wait_begin();
     tkl_system_sleep(time_ms);
+    tal_thread_prof_wait_end(prof);
+#else
+    tkl_system_sleep(time_ms);
+#endif
+    tal_trace_span_end(TAL_TRACE_SLEEP, NULL, trace_us);
 }
 
 /**
@@ -38,9 +38,25 @@
 #include "tal_log.h"
 #include "tal_memory.h"
 #include "tal_system.h"
+#include "tal_trace.h"
+
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+typedef struct {
+    TKL_THREAD_HANDLE id; // taken by the thread itself, thrdID may not be set yet when it starts
+    BOOL_T is_waiting;
+    SYS_TIME_T wait_since;
+    uint32_t win_block_ms;
+    uint32_t wake_cnt;
+    uint32_t max_block_ms;
+    uint8_t busy_pct;
+} THRD_PROF_T;
+#endif
+
 typedef struct {
     THREAD_HANDLE thrdID;
     int thrdRunSta;
+    uint8_t is_static; // in caller storage, not freed
+    uint8_t in_use;    // static storage held until the node is freed
     THREAD_FUNC_CB pThrdFunc;
     void *pThrdFuncArg;
     uint32_t stackDepth;
@@ -48,8 +64,14 @@ typedef struct {
     THREAD_EXIT_CB exit;
     char thread_name[TAL_THREAD_MAX_NAME_LEN];
     LIST_HEAD node;
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+    THRD_PROF_T prof;
+#endif
 } THRD_MANAGE, *P_THRD_MANAGE;
 
+// TAL_THREAD_STATIC_WORDS too small for THRD_MANAGE
+typedef char __thrd_static_size_check[(sizeof(THRD_MANAGE) <= sizeof(TAL_THREAD_STATIC_T)) ? 1 : -1];
+
 typedef struct {
     LIST_HEAD list;
     MUTEX_HANDLE mutex;
@@ -61,6 +83,104 @@ static LIST_HEAD s_all_thrd_mag;
 static void __WrapRunFunc(void *pArg);
 static void __inner_del_thread(THREAD_HANDLE thrdID);
 
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+// running threads by OS handle, looked up by the wait hooks
+static THRD_MANAGE *s_prof_thrd[TAL_THREAD_PROF_MAX_NUM];
+static SYS_TIME_T s_prof_win_start;
+
+static void __prof_add(THRD_MANAGE *thrd)
+{
+    uint32_t i = 0;
+
+    if (OPRT_OK != tkl_thread_get_id(&thrd->prof.id) || NULL == thrd->prof.id) {
+        return;
+    }
+
+    TAL_ENTER_CRITICAL();
+    for (i = 0; i < TAL_THREAD_PROF_MAX_NUM; i++) {
+        if (NULL == s_prof_thrd[i]) {
+            s_prof_thrd[i] = thrd;
+            break;
+        }
+    }
+    TAL_EXIT_CRITICAL();
+}
+
+static void __prof_del(THRD_MANAGE *thrd)
+{
+    uint32_t i = 0;
+
+    TAL_ENTER_CRITICAL();
+    for (i = 0; i < TAL_THREAD_PROF_MAX_NUM; i++) {
+        if (thrd == s_prof_thrd[i]) {
+            s_prof_thrd[i] = NULL;
+            break;
+        }
+    }
+    TAL_EXIT_CRITICAL();
+}
+
+// part of the current wait inside the window, called in the critical section
+static uint32_t __prof_wait_in_win(THRD_MANAGE *thrd, SYS_TIME_T now)
+{
+    if (!thrd->prof.is_waiting) {
+        return 0;
+    }
+
+    return (uint32_t)(now - ((thrd->prof.wait_since > s_prof_win_start) ? thrd->prof.wait_since : s_prof_win_start));
+}
+
+// latch busy_pct when a window is over, called with the thread list locked
+static void __prof_roll_window(SYS_TIME_T now)
+{
+    LIST_HEAD *pos = NULL;
+    THRD_MANAGE *thrd = NULL;
+    uint32_t elapsed = (uint32_t)(now - s_prof_win_start);
+    uint32_t block_ms = 0;
+
+    if (elapsed < TAL_THREAD_PROF_WINDOW_MS) {
+        return;
+    }
+
+    TAL_ENTER_CRITICAL();
+    tuya_list_for_each(pos, &s_all_thrd_mag)
+    {
+        thrd = tuya_list_entry(pos, THRD_MANAGE, node);
+        block_ms = thrd->prof.win_block_ms + __prof_wait_in_win(thrd, now);
+        thrd->prof.busy_pct = (block_ms >= elapsed) ? 0 : (uint8_t)(100 - (uint64_t)block_ms * 100 / elapsed);
+        thrd->prof.win_block_ms = 0;
+    }
+    s_prof_win_start = now;
+    TAL_EXIT_CRITICAL();
+}
+
+static void __prof_fill(THRD_MANAGE *thrd, SYS_TIME_T now, TAL_THREAD_PROF_T *prof)
+{
+    uint32_t watermark = 0;
+    uint32_t cur_block_ms = 0;
+
+    memset(prof, 0, sizeof(TAL_THREAD_PROF_T));
+    strncpy(prof->name, thrd->thread_name, TAL_THREAD_MAX_NAME_LEN - 1);
+    prof->stack_size = thrd->stackDepth;
+    if (thrd->thrdID && OPRT_OK == tkl_thread_get_watermark(thrd->thrdID, &watermark)) {
+        prof->stack_free = watermark;
+    }
+
+    TAL_ENTER_CRITICAL();
+    prof->busy_pct = thrd->prof.busy_pct;
+    prof->wake_cnt = thrd->prof.wake_cnt;
+    prof->max_block_ms = thrd->prof.max_block_ms;
+    if (thrd->prof.is_waiting) {
+        cur_block_ms = (uint32_t)(now - thrd->prof.wait_since);
+    }
+    TAL_EXIT_CRITICAL();
+
+    if (cur_block_ms > prof->max_block_ms) {
+        prof->max_block_ms = cur_block_ms;
+    }
+}
+#endif
+
 static OPERATE_RET __cr_and_init_del_thrd_mag(void)
 {
     if (NULL != s_del_thrd_mag) {
@@ -105,6 +225,15 @@ static void __inner_del_thread(THREAD_HANDLE thrdID)
     tkl_thread_release(thrdID);
 }
 
+static void __free_thrd_node(THRD_MANAGE *thrd)
+{
+    if (thrd->is_static) {
+        thrd->in_use = FALSE;
+    } else {
+        tal_free(thrd);
+    }
+}
+
 static void __free_all_del_thrd_node(void)
 {
     if (NULL == s_del_thrd_mag) {
@@ -137,7 +266,7 @@ static void __free_all_del_thrd_node(void)
         } else {
             PR_DEBUG("delete thread not self");
             thrdID = tmp_node->thrdID;
-            tal_free(tmp_node);
+            __free_thrd_node(tmp_node);
             __inner_del_thread(thrdID);
         }
     }
@@ -146,48 +275,56 @@ static void __free_all_del_thrd_node(void)
     if (is_self) {
         PR_DEBUG("finally delete thread self");
         thrdID = self_node->thrdID;
-        tal_free(self_node);
+        __free_thrd_node(self_node);
         __inner_del_thread(thrdID);
     }
 }
 
-/**
- * @brief Creates and starts a new thread.
- *
- * This function creates and starts a new thread with the specified parameters.
- *
- * @param handle Pointer to a THREAD_HANDLE variable to store the thread handle.
- * @param enter Callback function to be called when the thread starts.
- * @param exit Callback function to be called when the thread exits.
- * @param func Callback function that represents the thread's main function.
- * @param func_args Arguments to be passed to the thread's main function.
- * @param cfg Pointer to a THREAD_CFG_T structure containing thread
- * configuration parameters.
- *
- * @return OPERATE_RET Returns OPRT_OK on success, or an error code on failure.
- */
-OPERATE_RET tal_thread_create_and_start(THREAD_HANDLE *handle, const THREAD_ENTER_CB enter, const THREAD_EXIT_CB exit,
-                                        const THREAD_FUNC_CB func, const void *func_args, const THREAD_CFG_T *cfg)
+static OPERATE_RET __thread_create(THREAD_HANDLE *handle, TAL_THREAD_STATIC_T *storage, const THREAD_ENTER_CB enter,
+                                   const THREAD_EXIT_CB exit, const THREAD_FUNC_CB func, const void *func_args,
+                                   const THREAD_CFG_T *cfg)
 {
+    THRD_MANAGE *pMgr = NULL;
+    uint8_t is_static = FALSE;
+
     if (NULL == s_del_thrd_mag) {
         PR_TRACE("Init Thread Del Mgr");
         __cr_and_init_del_thrd_mag();
         INIT_LIST_HEAD(&s_all_thrd_mag);
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+        s_prof_win_start = tal_system_get_millisecond();
+#endif
     }
 
     if (!handle || !func) {
         PR_ERR("Para null");
         return OPRT_INVALID_PARM;
     }
-    THRD_MANAGE *pMgr = (P_THRD_MANAGE)tal_malloc(sizeof(THRD_MANAGE));
-    if (pMgr == NULL) {
-        PR_ERR("Malloc err");
-        return OPRT_MALLOC_FAILED;
+
+    if (storage) {
+        tal_mutex_lock(s_del_thrd_mag->mutex);
+        if (!((THRD_MANAGE *)storage)->in_use) {
+            pMgr = (THRD_MANAGE *)storage;
+            is_static = TRUE;
+        }
+        tal_mutex_unlock(s_del_thrd_mag->mutex);
+        if (NULL == pMgr) {
+            PR_WARN("%s storage still held, using heap", cfg->thrdname);
+        }
+    }
+    if (NULL == pMgr) {
+        pMgr = (P_THRD_MANAGE)tal_malloc(sizeof(THRD_MANAGE));
+        if (pMgr == NULL) {
+            PR_ERR("Malloc err");
+            return OPRT_MALLOC_FAILED;
+        }
     }
     memset(pMgr, 0, sizeof(THRD_MANAGE));
     INIT_LIST_HEAD(&(pMgr->node));
 
     pMgr->thrdRunSta = THREAD_STATE_EMPTY;
+    pMgr->is_static = is_static;
+    pMgr->in_use = TRUE;
     pMgr->pThrdFunc = func;
     pMgr->pThrdFuncArg = (void *)func_args;
     pMgr->enter = enter;
@@ -207,25 +344,75 @@ OPERATE_RET tal_thread_create_and_start(THREAD_HANDLE *handle, const THREAD_ENTE
         tal_mutex_lock(s_del_thrd_mag->mutex);
         tuya_list_del(&(pMgr->node));
         tal_mutex_unlock(s_del_thrd_mag->mutex);
-        tal_free(pMgr);
+        __free_thrd_node(pMgr);
         *handle = NULL;
         return OPRT_OS_ADAPTER_THRD_CREAT_FAILED;
     }
 
     static int stack_cnt = 0;
     stack_cnt += cfg->stackDepth;
-    PR_INFO("thread_create name:%s,stackDepth:%d,totalstackDepth:%d,priority:%d", cfg->thrdname, cfg->stackDepth,
-            stack_cnt, cfg->priority);
+    PR_INFO("thread_create name:%s,stackDepth:%d,totalstackDepth:%d,priority:%d%s", cfg->thrdname, cfg->stackDepth,
+            stack_cnt, cfg->priority, is_static ? ",static" : "");
 
     return OPRT_OK;
 }
 
+/**
+ * @brief Creates and starts a new thread.
+ *
+ * This function creates and starts a new thread with the specified parameters.
+ *
+ * @param handle Pointer to a THREAD_HANDLE variable to store the thread handle.
+ * @param enter Callback function to be called when the thread starts.
+ * @param exit Callback function to be called when the thread exits.
+ * @param func Callback function that represents the thread's main function.
+ * @param func_args Arguments to be passed to the thread's main function.
+ * @param cfg Pointer to a THREAD_CFG_T structure containing thread
+ * configuration parameters.
+ *
+ * @return OPERATE_RET Returns OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tal_thread_create_and_start(THREAD_HANDLE *handle, const THREAD_ENTER_CB enter, const THREAD_EXIT_CB exit,
+                                        const THREAD_FUNC_CB func, const void *func_args, const THREAD_CFG_T *cfg)
+{
+    return __thread_create(handle, NULL, enter, exit, func, func_args, cfg);
+}
+
+/**
+ * @brief Creates and starts a new thread with its control block in
+ * caller-provided storage.
+ *
+ * @param handle Pointer to a THREAD_HANDLE variable to store the thread handle.
+ * @param storage Control block, valid until the thread is deleted.
+ * @param enter Callback function to be called when the thread starts.
+ * @param exit Callback function to be called when the thread exits.
+ * @param func Callback function that represents the thread's main function.
+ * @param func_args Arguments to be passed to the thread's main function.
+ * @param cfg Pointer to a THREAD_CFG_T structure containing thread
+ * configuration parameters.
+ *
+ * @return OPERATE_RET Returns OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tal_thread_create_static(THREAD_HANDLE *handle, TAL_THREAD_STATIC_T *storage, const THREAD_ENTER_CB enter,
+                                     const THREAD_EXIT_CB exit, const THREAD_FUNC_CB func, const void *func_args,
+                                     const THREAD_CFG_T *cfg)
+{
+    if (NULL == storage) {
+        return OPRT_INVALID_PARM;
+    }
+
+    return __thread_create(handle, storage, enter, exit, func, func_args, cfg);
+}
+
 static void __WrapRunFunc(void *pArg)
 {
     __free_all_del_thrd_node();
 
     P_THRD_MANAGE pThrdManage = (P_THRD_MANAGE)pArg;
 
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+    __prof_add(pThrdManage);
+#endif
 #if OPERATING_SYSTEM == SYSTEM_LINUX
     tkl_thread_set_self_name(pThrdManage->thread_name);
 #endif
@@ -235,7 +422,13 @@ static void __WrapRunFunc(void *pArg)
     }
     PR_DEBUG("Thread:%s Exec Start. Set to Running Stat", pThrdManage->thread_name);
     pThrdManage->thrdRunSta = THREAD_STATE_RUNNING;
+    if (tal_trace_is_running()) {
+        tal_trace_record(TAL_TRACE_THREAD, pThrdManage->pThrdFunc, tal_trace_now(), 0);
+    }
     pThrdManage->pThrdFunc(pThrdManage->pThrdFuncArg);
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+    __prof_del(pThrdManage);
+#endif
     // must call <DeleteThrdHandle> to delete thread
     THREAD_STATE_E status = THREAD_STATE_EMPTY;
     do {
@@ -368,6 +561,40 @@ OPERATE_RET tal_thread_diagnose(const THREAD_HANDLE handle)
     return ret;
 }
 
+/**
+ * @brief Gets the name of a tal thread from its os thread id.
+ *
+ * @param id The os thread id, as given by tkl_thread_get_id().
+ * @param name The thread name.
+ * @param len Size of name.
+ * @return OPRT_OK on success, OPRT_NOT_FOUND if no tal thread has this id.
+ */
+OPERATE_RET tal_thread_get_name_by_id(const void *id, char *name, uint32_t len)
+{
+    OPERATE_RET ret = OPRT_NOT_FOUND;
+    LIST_HEAD *pos = NULL;
+    THRD_MANAGE *thrd = NULL;
+
+    if (NULL == id || NULL == name || 0 == len || NULL == s_del_thrd_mag) {
+        return OPRT_INVALID_PARM;
+    }
+
+    tal_mutex_lock(s_del_thrd_mag->mutex);
+    tuya_list_for_each(pos, &s_all_thrd_mag)
+    {
+        thrd = tuya_list_entry(pos, THRD_MANAGE, node);
+        if (thrd->thrdID == id) {
+            strncpy(name, thrd->thread_name, len - 1);
+            name[len - 1] = '\0';
+            ret = OPRT_OK;
+            break;
+        }
+    }
+    tal_mutex_unlock(s_del_thrd_mag->mutex);
+
+    return ret;
+}
+
 /**
  * @brief Dumps the watermark information for each thread managed by the system.
  *        The watermark represents the amount of free stack space available for
@@ -399,3 +626,144 @@ void tal_thread_dump_watermark(void)
     }
     tal_mutex_unlock(s_del_thrd_mag->mutex);
 }
+
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+/**
+ * @brief Gets the profile of a thread.
+ *
+ * @param handle The handle of the thread.
+ * @param prof Filled with the thread profile.
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tal_thread_get_prof(const THREAD_HANDLE handle, TAL_THREAD_PROF_T *prof)
+{
+    SYS_TIME_T now = 0;
+
+    if (NULL == handle || NULL == prof || NULL == s_del_thrd_mag) {
+        return OPRT_INVALID_PARM;
+    }
+
+    tal_mutex_lock(s_del_thrd_mag->mutex);
+    now = tal_system_get_millisecond();
+    __prof_roll_window(now);
+    __prof_fill((THRD_MANAGE *)handle, now, prof);
+    tal_mutex_unlock(s_del_thrd_mag->mutex);
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Gets the profiles of all running threads.
+ *
+ * @param prof Array of num profiles to fill.
+ * @param num The array size.
+ * @return The number of profiles filled.
+ */
+uint32_t tal_thread_get_prof_all(TAL_THREAD_PROF_T *prof, uint32_t num)
+{
+    LIST_HEAD *pos = NULL;
+    SYS_TIME_T now = 0;
+    uint32_t cnt = 0;
+
+    if (NULL == prof || NULL == s_del_thrd_mag) {
+        return 0;
+    }
+
+    tal_mutex_lock(s_del_thrd_mag->mutex);
+    now = tal_system_get_millisecond();
+    __prof_roll_window(now);
+    tuya_list_for_each(pos, &s_all_thrd_mag)
+    {
+        if (cnt >= num) {
+            break;
+        }
+        __prof_fill(tuya_list_entry(pos, THRD_MANAGE, node), now, &prof[cnt++]);
+    }
+    tal_mutex_unlock(s_del_thrd_mag->mutex);
+
+    return cnt;
+}
+
+/**
+ * @brief Clears the wake counts and the longest waits of all threads.
+ */
+void tal_thread_prof_reset(void)
+{
+    LIST_HEAD *pos = NULL;
+    THRD_MANAGE *thrd = NULL;
+
+    if (NULL == s_del_thrd_mag) {
+        return;
+    }
+
+    tal_mutex_lock(s_del_thrd_mag->mutex);
+    TAL_ENTER_CRITICAL();
+    tuya_list_for_each(pos, &s_all_thrd_mag)
+    {
+        thrd = tuya_list_entry(pos, THRD_MANAGE, node);
+        thrd->prof.wake_cnt = 0;
+        thrd->prof.max_block_ms = 0;
+    }
+    TAL_EXIT_CRITICAL();
+    tal_mutex_unlock(s_del_thrd_mag->mutex);
+}
+
+/**
+ * @brief Marks the calling thread as blocked.
+ *
+ * @return Context for tal_thread_prof_wait_end(), NULL if the calling thread
+ * is not profiled.
+ */
+void *tal_thread_prof_wait_begin(void)
+{
+    TKL_THREAD_HANDLE id = NULL;
+    THRD_MANAGE *thrd = NULL;
+    SYS_TIME_T now = 0;
+    uint32_t i = 0;
+
+    if (OPRT_OK != tkl_thread_get_id(&id) || NULL == id) {
+        return NULL;
+    }
+    now = tal_system_get_millisecond();
+
+    TAL_ENTER_CRITICAL();
+    for (i = 0; i < TAL_THREAD_PROF_MAX_NUM; i++) {
+        if (s_prof_thrd[i] && s_prof_thrd[i]->prof.id == id) {
+            thrd = s_prof_thrd[i];
+            thrd->prof.is_waiting = TRUE;
+            thrd->prof.wait_since = now;
+            break;
+        }
+    }
+    TAL_EXIT_CRITICAL();
+
+    return thrd;
+}
+
+/**
+ * @brief Marks the calling thread as running again.
+ *
+ * @param ctx The return value of tal_thread_prof_wait_begin().
+ */
+void tal_thread_prof_wait_end(void *ctx)
+{
+    THRD_MANAGE *thrd = (THRD_MANAGE *)ctx;
+    SYS_TIME_T now = 0;
+    uint32_t block_ms = 0;
+
+    if (NULL == thrd) {
+        return;
+    }
+    now = tal_system_get_millisecond();
+
+    TAL_ENTER_CRITICAL();
+    block_ms = (uint32_t)(now - thrd->prof.wait_since);
+    thrd->prof.win_block_ms += __prof_wait_in_win(thrd, now);
+    if (block_ms > thrd->prof.max_block_ms) {
+        thrd->prof.max_block_ms = block_ms;
+    }
+    thrd->prof.wake_cnt++;
+    thrd->prof.is_waiting = FALSE;
+    TAL_EXIT_CRITICAL();
+}
+#endif
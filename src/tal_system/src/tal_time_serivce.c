@@ -36,6 +36,7 @@
 #include <ctype.h>
 #include "tal_log.h"
 #include "tal_event.h"
+#include "tal_system.h"
 
 /***********************************************************
 *************************micro define***********************
@@ -61,6 +62,21 @@ static BOOL_T s_time_cloud_sync = FALSE;
 static TIME_T s_time_cloud_posix = 0;
 static BOOL_T s_time_disable_update = FALSE;
 
+// summer time answer valid for posix times in [s_time_sz_from, s_time_sz_to]
+static BOOL_T s_time_sz_valid = FALSE;
+static BOOL_T s_time_sz_in = FALSE;
+static TIME_T s_time_sz_from = 0;
+static TIME_T s_time_sz_to = 0;
+
+// last local time conversion, another one on the same day only redoes the clock
+static BOOL_T s_time_tm_valid = FALSE;
+static TIME_T s_time_tm_day = 0;
+static POSIX_TM_S s_time_tm_cache;
+
+// monotonic clock, extends a 32 bit millisecond counter
+static SYS_TIME_T s_time_mono_last_ms = 0;
+static uint64_t s_time_mono_wrap_ms = 0;
+
 /***********************************************************
 *************************function define********************
 ***********************************************************/
@@ -76,17 +92,45 @@ static BOOL_T s_time_disable_update = FALSE;
  */
 BOOL_T tal_time_is_in_sum_zone(TIME_T time)
 {
-    tal_mutex_lock(s_time_mutex);
+    BOOL_T in = FALSE;
+    TIME_T from = 0, to = (TIME_T)-1;
     uint32_t i = 0;
+
+    tal_mutex_lock(s_time_mutex);
+
+    // the answer only changes at a table edge, most calls hit the current period
+    if (s_time_sz_valid && time >= s_time_sz_from && time <= s_time_sz_to) {
+        in = s_time_sz_in;
+        tal_mutex_unlock(s_time_mutex);
+        return in;
+    }
+
     for (i = 0; i < s_time_sz_tbl.cnt; i++) {
-        if ((time >= s_time_sz_tbl.zone[i].posix_min) && (time <= s_time_sz_tbl.zone[i].posix_max)) {
-            tal_mutex_unlock(s_time_mutex);
-            return TRUE;
+        const SUM_ZONE_S *zone = &s_time_sz_tbl.zone[i];
+
+        if ((time >= zone->posix_min) && (time <= zone->posix_max)) {
+            in = TRUE;
+            from = zone->posix_min;
+            to = zone->posix_max;
+            break;
+        }
+        // narrow the gap around time down to the neighbour zones
+        if (zone->posix_max < time && zone->posix_max >= from) {
+            from = zone->posix_max + 1;
+        }
+        if (zone->posix_min > time && zone->posix_min <= to) {
+            to = zone->posix_min - 1;
         }
     }
+
+    s_time_sz_in = in;
+    s_time_sz_from = from;
+    s_time_sz_to = to;
+    s_time_sz_valid = TRUE;
+
     tal_mutex_unlock(s_time_mutex);
 
-    return FALSE;
+    return in;
 }
 
 /**
@@ -435,6 +479,33 @@ OPERATE_RET tal_time_check_time_zone_sync(void)
  *
  * @return the current second time in TIME_T format
  */
+/**
+ * @brief get the time since boot in micro-seconds, monotonic and not affected
+ * by time synchronization
+ *
+ * @return the current micro-second time
+ */
+uint64_t tal_time_get_mono_us(void)
+{
+#ifdef TAL_TIME_MONO_US
+    return TAL_TIME_MONO_US();
+#else
+    uint64_t ms = 0;
+    uint32_t irq_mask = tal_system_enter_critical();
+    SYS_TIME_T curr_ms = tal_system_get_millisecond();
+
+    if (sizeof(SYS_TIME_T) < sizeof(uint64_t) && curr_ms < s_time_mono_last_ms) { // recycle
+        s_time_mono_wrap_ms += 0x100000000ULL;
+    }
+    s_time_mono_last_ms = curr_ms;
+    ms = s_time_mono_wrap_ms + curr_ms;
+
+    tal_system_exit_critical(irq_mask);
+
+    return ms * 1000;
+#endif
+}
+
 TIME_T tal_time_get_posix(void)
 {
     TIME_T tmp_cur_posix_time = 0;
@@ -583,10 +654,33 @@ OPERATE_RET tal_time_get_local_time_custom(TIME_T in_time, POSIX_TM_S *tm)
         local_time += SEC_PER_HOUR;
     }
 
+    TIME_T day = local_time / SEC_PER_DAY;
+    TIME_T rem = local_time % SEC_PER_DAY;
+
+    // the date part only changes at midnight, keep it from the last conversion
+    tal_mutex_lock(s_time_mutex);
+    if (s_time_tm_valid && day == s_time_tm_day) {
+        *tm = s_time_tm_cache;
+        tal_mutex_unlock(s_time_mutex);
+
+        tm->tm_hour = rem / SEC_PER_HOUR;
+        rem = rem % SEC_PER_HOUR;
+        tm->tm_min = rem / 60;
+        tm->tm_sec = rem % 60;
+        return OPRT_OK;
+    }
+    tal_mutex_unlock(s_time_mutex);
+
     if (tal_time_gmtime_r((const TIME_T *)&local_time, tm) == NULL) {
         return OPRT_COM_ERROR;
     }
 
+    tal_mutex_lock(s_time_mutex);
+    s_time_tm_cache = *tm;
+    s_time_tm_day = day;
+    s_time_tm_valid = TRUE;
+    tal_mutex_unlock(s_time_mutex);
+
     return OPRT_OK;
 }
 
@@ -601,11 +695,15 @@ OPERATE_RET tal_time_get_local_time_custom(TIME_T in_time, POSIX_TM_S *tm)
 void tal_time_set_sum_zone_tbl(const SUM_ZONE_S *zone, const uint32_t cnt)
 {
     if (NULL == zone || 0 == cnt) {
+        tal_mutex_lock(s_time_mutex);
         s_time_sz_tbl.cnt = 0;
+        s_time_sz_valid = FALSE;
+        tal_mutex_unlock(s_time_mutex);
         return;
     }
 
     tal_mutex_lock(s_time_mutex);
+    s_time_sz_valid = FALSE;
     s_time_sz_tbl.cnt = cnt;
     if (cnt > SUM_ZONE_TAB_LMT) {
         s_time_sz_tbl.cnt = SUM_ZONE_TAB_LMT;
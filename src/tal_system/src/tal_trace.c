@@ -0,0 +1,254 @@
+/**
+ * @file tal_trace.c
+ * @brief Ring of timing records, see tal_trace.h.
+ *
+ * The ring is allocated by the first start and never freed, so a record point
+ * racing with a stop still writes to valid memory. Writers take a slot with an
+ * atomic add on the record count and fill it without a lock, so recording
+ * works the same in interrupts and on several cores; a record being written
+ * while the ring is read may come out torn.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tkl_thread.h"
+#include "tal_memory.h"
+#include "tal_system.h"
+#include "tal_thread.h"
+#include "tal_trace.h"
+
+// threads whose names are looked up at the end of a dump
+#ifndef TAL_TRACE_DUMP_THREAD_MAX
+#define TAL_TRACE_DUMP_THREAD_MAX 32
+#endif
+
+static const char *sc_trace_type_name[TAL_TRACE_TYPE_MAX] = {
+    "timer", "work", "user", "thread", "isr", "mutex", "sem", "qpost", "qfetch", "sleep", "mark", "hold",
+};
+
+static struct {
+    volatile BOOL_T running;
+    TAL_TRACE_REC_T *ring;
+    uint32_t count; // records written since the start
+} s_trace;
+
+static BOOL_T __trace_obj_is_name(uint8_t type)
+{
+    return (TAL_TRACE_USER == type || TAL_TRACE_ISR == type || TAL_TRACE_MARK == type);
+}
+
+/**
+ * @brief Clears the ring and starts recording.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_trace_start(void)
+{
+    if (NULL == s_trace.ring) {
+        s_trace.ring = tal_malloc(TAL_TRACE_NUM * sizeof(TAL_TRACE_REC_T));
+        if (NULL == s_trace.ring) {
+            return OPRT_MALLOC_FAILED;
+        }
+    }
+
+    TAL_ENTER_CRITICAL();
+    __atomic_store_n(&s_trace.count, 0, __ATOMIC_RELAXED);
+    s_trace.running = TRUE;
+    TAL_EXIT_CRITICAL();
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Stops recording, the records are kept.
+ *
+ * @return none
+ */
+void tal_trace_stop(void)
+{
+    s_trace.running = FALSE;
+}
+
+/**
+ * @brief Tells if a trace runs, a record point checks it before timing its
+ * callback.
+ *
+ * @return TRUE while recording
+ */
+BOOL_T tal_trace_is_running(void)
+{
+    return s_trace.running;
+}
+
+/**
+ * @brief Gets the time for a span start.
+ *
+ * @return TAL_TRACE_TIME_US(), 0 when no trace runs
+ */
+uint32_t tal_trace_now(void)
+{
+    return s_trace.running ? TAL_TRACE_TIME_US() : 0;
+}
+
+/**
+ * @brief Records one callback or span, does nothing when no trace runs.
+ *
+ * @param[in] type TAL_TRACE_TYPE_E
+ * @param[in] obj callback, name or handle
+ * @param[in] start_us when it started
+ * @param[in] cost_us how long it ran
+ *
+ * @return none
+ */
+void tal_trace_record(TAL_TRACE_TYPE_E type, const void *obj, uint32_t start_us, uint32_t cost_us)
+{
+    TKL_THREAD_HANDLE thread = NULL;
+    TAL_TRACE_REC_T *rec = NULL;
+
+    if (!s_trace.running) {
+        return;
+    }
+
+    tkl_thread_get_id(&thread);
+    rec = &s_trace.ring[__atomic_fetch_add(&s_trace.count, 1, __ATOMIC_RELAXED) % TAL_TRACE_NUM];
+    rec->start_us = start_us;
+    rec->cost_us = cost_us;
+    rec->obj = obj;
+    rec->thread = thread;
+    rec->type = type;
+}
+
+/**
+ * @brief Records a span from start_us to now, does nothing when no trace
+ * runs or start_us is 0.
+ *
+ * @param[in] type TAL_TRACE_TYPE_E
+ * @param[in] obj callback, name or handle, names must be constant strings
+ * @param[in] start_us tal_trace_now() at the start
+ *
+ * @return none
+ */
+void tal_trace_span_end(TAL_TRACE_TYPE_E type, const void *obj, uint32_t start_us)
+{
+    if (!s_trace.running || 0 == start_us) {
+        return;
+    }
+
+    tal_trace_record(type, obj, start_us, TAL_TRACE_TIME_US() - start_us);
+}
+
+/**
+ * @brief Records that a point was reached.
+ *
+ * @param[in] name constant string
+ *
+ * @return none
+ */
+void tal_trace_mark(const char *name)
+{
+    if (!s_trace.running) {
+        return;
+    }
+
+    tal_trace_record(TAL_TRACE_MARK, name, TAL_TRACE_TIME_US(), 0);
+}
+
+/**
+ * @brief Copies the records, oldest first.
+ *
+ * @param[out] rec records
+ * @param[in] num size of rec
+ *
+ * @return the number of records copied
+ */
+uint32_t tal_trace_get(TAL_TRACE_REC_T *rec, uint32_t num)
+{
+    uint32_t i = 0, first = 0, total = 0, count = 0;
+
+    if (NULL == rec || NULL == s_trace.ring) {
+        return 0;
+    }
+
+    count = __atomic_load_n(&s_trace.count, __ATOMIC_RELAXED);
+    total = count < TAL_TRACE_NUM ? count : TAL_TRACE_NUM;
+    first = count - total;
+    if (total > num) {
+        first += total - num;
+        total = num;
+    }
+    for (i = 0; i < total; i++) {
+        rec[i] = s_trace.ring[(first + i) % TAL_TRACE_NUM];
+    }
+
+    return total;
+}
+
+/**
+ * @brief Writes the records as text lines for tools/trace/trace2chrome.py.
+ *
+ * @param[in] out line output
+ * @param[in] arg passed to out
+ *
+ * @return the number of records written
+ */
+uint32_t tal_trace_dump(TAL_TRACE_OUTPUT_CB out, void *arg)
+{
+    void *thread[TAL_TRACE_DUMP_THREAD_MAX];
+    uint32_t thread_num = 0;
+    uint32_t i = 0, j = 0, first = 0, total = 0, count = 0;
+    TAL_TRACE_REC_T rec;
+    char name[TAL_THREAD_MAX_NAME_LEN];
+    char line[112];
+    int len = 0;
+
+    if (NULL == out || NULL == s_trace.ring) {
+        return 0;
+    }
+
+    count = __atomic_load_n(&s_trace.count, __ATOMIC_RELAXED);
+    total = count < TAL_TRACE_NUM ? count : TAL_TRACE_NUM;
+    first = count - total;
+
+    snprintf(line, sizeof(line), "TRACE_BEGIN,1,%u", TAL_TRACE_TIME_US());
+    if (OPRT_OK != out(line, arg)) {
+        return 0;
+    }
+
+    for (i = 0; i < total; i++) {
+        rec = s_trace.ring[(first + i) % TAL_TRACE_NUM];
+        len = snprintf(line, sizeof(line), "TRACE,%s,%u,%u,%p,%p",
+                       rec.type < TAL_TRACE_TYPE_MAX ? sc_trace_type_name[rec.type] : "?", rec.start_us, rec.cost_us,
+                       rec.thread, rec.obj);
+        if (__trace_obj_is_name(rec.type) && rec.obj && len > 0 && len < (int)sizeof(line)) {
+            snprintf(line + len, sizeof(line) - len, ",%s", (const char *)rec.obj);
+        }
+        if (OPRT_OK != out(line, arg)) {
+            return i;
+        }
+
+        for (j = 0; j < thread_num && thread[j] != rec.thread; j++) {
+        }
+        if (j == thread_num && thread_num < TAL_TRACE_DUMP_THREAD_MAX && rec.thread) {
+            thread[thread_num++] = rec.thread;
+        }
+    }
+
+    for (j = 0; j < thread_num; j++) {
+        if (OPRT_OK == tal_thread_get_name_by_id(thread[j], name, sizeof(name))) {
+            snprintf(line, sizeof(line), "TRACE_THREAD,%p,%s", thread[j], name);
+            if (OPRT_OK != out(line, arg)) {
+                return total;
+            }
+        }
+    }
+
+    snprintf(line, sizeof(line), "TRACE_END,%u,%u", total, first);
+    out(line, arg);
+
+    return total;
+}
@@ -49,6 +49,11 @@
 #define STACK_SIZE_MSG_QUEUE (4 * 1024)
 #endif
 
+// WORKQ_SYSTEM workers, one blocking work holds up only one of them, 1 keeps works serialized
+#ifndef WORKQ_SYSTEM_WORKER_NUM
+#define WORKQ_SYSTEM_WORKER_NUM 2
+#endif
+
 static WORKQUEUE_HANDLE wq_system;
 static WORKQUEUE_HANDLE wq_highpri;
 
@@ -73,7 +78,9 @@ OPERATE_RET tal_workq_init(void)
     thread_cfg.stackDepth += 1024;
 #endif
     thread_cfg.thrdname = "wq_system";
-    TUYA_CALL_ERR_GOTO(tal_workqueue_create(MAX_NODE_NUM_WORK_QUEUE, &thread_cfg, &wq_system), ERR_EXIT);
+    TUYA_CALL_ERR_GOTO(
+        tal_workqueue_create_pool(MAX_NODE_NUM_WORK_QUEUE, WORKQ_SYSTEM_WORKER_NUM, &thread_cfg, &wq_system),
+        ERR_EXIT);
 
     thread_cfg.priority = THREAD_PRIO_1;
     thread_cfg.stackDepth = STACK_SIZE_MSG_QUEUE;
@@ -151,6 +158,22 @@ OPERATE_RET tal_workq_schedule_instant(WORKQ_SERVICE_E service, WORKQUEUE_CB cb,
     return tal_workqueue_schedule_instant(tal_workq_get_handle(service), cb, data);
 }
 
+/**
+ * @brief put work task in a priority lane of a workqueue service
+ *
+ * @param[in] service the workqueue service
+ * @param[in] prio the lane
+ * @param[in] cb the work callback
+ * @param[in] data the work data
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_workq_schedule_prio(WORKQ_SERVICE_E service, WORKQ_PRIO_E prio, WORKQUEUE_CB cb, void *data)
+{
+    return tal_workqueue_schedule_prio(tal_workq_get_handle(service), prio, cb, data);
+}
+
 /**
  * @brief cancel work task in workqueue
  *
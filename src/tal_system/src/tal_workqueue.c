@@ -31,45 +31,195 @@
  *
  */
 
+#include <stdio.h>
+
 #include "tuya_queue.h"
 #include "tal_log.h"
 #include "tal_memory.h"
 #include "tal_thread.h"
 #include "tal_system.h"
 #include "tal_semaphore.h"
+#include "tal_mutex.h"
 #include "tal_workqueue.h"
-#include "tal_sw_timer.h"
+#include "tal_trace.h"
+
+#define WORKER_NAME_LEN 16
+
+struct TAL_WORKQUEUE;
+
+typedef struct DELAYED_WORK {
+    struct DELAYED_WORK *next; // in the deadline list of the workqueue
+    SYS_TIME_T deadline;
+    TIME_MS interval;
+    LOOP_TYPE type;
+    BOOL_T is_armed;
+    WORKQUEUE_CB cb;
+    void *data;
+    WORKQUEUE_HANDLE handle;
+} DELAYED_WORK_T;
 
 typedef struct {
-    TUYA_QUEUE_HANDLE queue;
+    TUYA_QUEUE_HANDLE queue; // own items, idle workers steal from it
     THREAD_HANDLE thread;
-    SEM_HANDLE sem;
+    struct TAL_WORKQUEUE *workqueue;
     WORKQUEUE_CB last_cb; // used to debug which cb is blocked
+    char name[WORKER_NAME_LEN];
+} TAL_WORKER_T;
+
+typedef struct TAL_WORKQUEUE {
+    SEM_HANDLE sem; // counts the items of all workers and lanes
+    TUYA_QUEUE_HANDLE high; // shared lane run before any normal item
+    TUYA_QUEUE_HANDLE low;  // shared lane run when no normal item is left
+    uint8_t worker_num;
+    uint8_t next; // worker the next item is tried on first
+    TAL_WORKER_T *worker;
+    MUTEX_HANDLE delay_mutex;
+    DELAYED_WORK_T *delay_list; // armed delayed works, earliest deadline first
 } TAL_WORKQUEUE_T;
 
+static OPERATE_RET __workqueue_put(TAL_WORKQUEUE_T *workqueue, WORK_ITEM_T *work_item, WORKQ_PRIO_E prio,
+                                   BOOL_T is_instant);
+
+static void __delayed_unlink(TAL_WORKQUEUE_T *workqueue, DELAYED_WORK_T *delayed)
+{
+    DELAYED_WORK_T **pp = &workqueue->delay_list;
+
+    while (*pp && (*pp != delayed)) {
+        pp = &(*pp)->next;
+    }
+    if (*pp) {
+        *pp = delayed->next;
+    }
+    delayed->next = NULL;
+    delayed->is_armed = FALSE;
+}
+
+// returns TRUE when it is the new head, the waiting workers have to recompute
+// their timeout
+static BOOL_T __delayed_link(TAL_WORKQUEUE_T *workqueue, DELAYED_WORK_T *delayed)
+{
+    DELAYED_WORK_T **pp = &workqueue->delay_list;
+
+    while (*pp && ((*pp)->deadline <= delayed->deadline)) {
+        pp = &(*pp)->next;
+    }
+    delayed->next = *pp;
+    *pp = delayed;
+    delayed->is_armed = TRUE;
+
+    return (pp == &workqueue->delay_list) ? TRUE : FALSE;
+}
+
+// ms until the earliest deadline, SEM_WAIT_FOREVER when nothing is armed
+static uint32_t __delayed_timeout(TAL_WORKQUEUE_T *workqueue)
+{
+    uint32_t timeout = SEM_WAIT_FOREVER;
+    SYS_TIME_T now = 0;
+
+    tal_mutex_lock(workqueue->delay_mutex);
+    if (workqueue->delay_list) {
+        now = tal_system_get_millisecond();
+        if (workqueue->delay_list->deadline <= now) {
+            timeout = 0;
+        } else if (workqueue->delay_list->deadline - now < SEM_WAIT_FOREVER) {
+            timeout = (uint32_t)(workqueue->delay_list->deadline - now);
+        }
+    }
+    tal_mutex_unlock(workqueue->delay_mutex);
+
+    return timeout;
+}
+
+// move the due delayed works to the normal lane, cycle ones are armed again
+static void __delayed_expire(TAL_WORKQUEUE_T *workqueue)
+{
+    DELAYED_WORK_T *delayed = NULL;
+    WORK_ITEM_T work_item = {0};
+    SYS_TIME_T now = 0;
+
+    tal_mutex_lock(workqueue->delay_mutex);
+    now = tal_system_get_millisecond();
+    while (workqueue->delay_list && (workqueue->delay_list->deadline <= now)) {
+        delayed = workqueue->delay_list;
+        __delayed_unlink(workqueue, delayed);
+        if (LOOP_CYCLE == delayed->type) {
+            // keep the period, unless the queue fell behind by a whole one
+            delayed->deadline += delayed->interval;
+            if (delayed->deadline <= now) {
+                delayed->deadline = now + delayed->interval;
+            }
+            __delayed_link(workqueue, delayed);
+        }
+
+        work_item.cb = delayed->cb;
+        work_item.data = delayed->data;
+        if (OPRT_OK != __workqueue_put(workqueue, &work_item, WORKQ_PRIO_NORMAL, FALSE)) {
+            PR_ERR("delayed %p dropped, workqueue full", delayed->cb);
+        }
+    }
+    tal_mutex_unlock(workqueue->delay_mutex);
+}
+
+static OPERATE_RET __work_take(TAL_WORKER_T *worker, WORK_ITEM_T *work_item)
+{
+    TAL_WORKQUEUE_T *workqueue = worker->workqueue;
+    uint8_t idx = worker - workqueue->worker;
+    uint8_t i = 0;
+
+    if (OPRT_OK == tuya_queue_output(workqueue->high, work_item)) {
+        return OPRT_OK;
+    }
+
+    if (OPRT_OK == tuya_queue_output(worker->queue, work_item)) {
+        return OPRT_OK;
+    }
+
+    // steal from the others, their owners are busy running a callback
+    for (i = 1; i < workqueue->worker_num; i++) {
+        if (OPRT_OK == tuya_queue_output(workqueue->worker[(idx + i) % workqueue->worker_num].queue, work_item)) {
+            return OPRT_OK;
+        }
+    }
+
+    return tuya_queue_output(workqueue->low, work_item);
+}
+
 static void __work_thread_cb(void *data)
 {
     OPERATE_RET op_ret = OPRT_OK;
-    TAL_WORKQUEUE_T *workqueue = (TAL_WORKQUEUE_T *)data;
+    TAL_WORKER_T *worker = (TAL_WORKER_T *)data;
+    TAL_WORKQUEUE_T *workqueue = worker->workqueue;
     WORK_ITEM_T work_item = {0};
-
-    while (THREAD_STATE_RUNNING == tal_thread_get_state(workqueue->thread)) {
-        op_ret = tal_semaphore_wait(workqueue->sem, SEM_WAIT_FOREVER);
+    uint32_t timeout = 0;
+
+    while (THREAD_STATE_RUNNING == tal_thread_get_state(worker->thread)) {
+        // the earliest deadline bounds the wait, whichever worker wakes first
+        // moves the due works over
+        timeout = __delayed_timeout(workqueue);
+        op_ret = tal_semaphore_wait(workqueue->sem, timeout);
+        __delayed_expire(workqueue);
         if (OPRT_OK != op_ret) {
-            tal_system_sleep(10);
+            if (SEM_WAIT_FOREVER == timeout) {
+                tal_system_sleep(10);
+            }
             continue;
         }
 
-        op_ret = tuya_queue_output(workqueue->queue, &work_item);
+        // nothing to take after a post that only wakes the workers for a new
+        // earliest deadline
+        op_ret = __work_take(worker, &work_item);
         if (OPRT_OK != op_ret) {
-            tal_system_sleep(10);
             continue;
         }
 
         if (work_item.cb) {
-            workqueue->last_cb = work_item.cb;
+            uint32_t trace_us = tal_trace_now();
+
+            worker->last_cb = work_item.cb;
             work_item.cb(work_item.data);
-            workqueue->last_cb = NULL;
+            worker->last_cb = NULL;
+
+            tal_trace_span_end(TAL_TRACE_WORK, work_item.cb, trace_us);
         }
     }
 }
@@ -97,6 +247,97 @@ static BOOL_T __work_cancel_traverse(void *item, void *ctx)
     return TRUE;
 }
 
+static OPERATE_RET __workqueue_free(TAL_WORKQUEUE_T *workqueue)
+{
+    OPERATE_RET op_ret = OPRT_OK;
+    uint8_t i = 0;
+    uint32_t count = 1;
+
+    for (i = 0; i < workqueue->worker_num; i++) {
+        if (workqueue->worker[i].thread) {
+            op_ret = tal_thread_delete(workqueue->worker[i].thread);
+            if (OPRT_OK != op_ret) {
+                return op_ret;
+            }
+        }
+    }
+
+    for (i = 0; workqueue->sem && i < workqueue->worker_num; i++) {
+        tal_semaphore_post(workqueue->sem);
+    }
+
+    for (i = 0; i < workqueue->worker_num; i++) {
+        if (NULL == workqueue->worker[i].thread) {
+            continue;
+        }
+        while (THREAD_STATE_DELETE != tal_thread_get_state(workqueue->worker[i].thread)) {
+            tal_system_sleep(10);
+            if ((count++) % 500 == 0) {
+                PR_NOTICE("%p still running", workqueue->worker[i].thread);
+            }
+        }
+    }
+
+    for (i = 0; i < workqueue->worker_num; i++) {
+        if (workqueue->worker[i].queue) {
+            tuya_queue_release(workqueue->worker[i].queue);
+        }
+    }
+    if (workqueue->high) {
+        tuya_queue_release(workqueue->high);
+    }
+    if (workqueue->low) {
+        tuya_queue_release(workqueue->low);
+    }
+
+    if (workqueue->sem) {
+        tal_semaphore_release(workqueue->sem);
+    }
+    if (workqueue->delay_mutex) {
+        tal_mutex_release(workqueue->delay_mutex);
+    }
+    tal_free(workqueue);
+
+    return OPRT_OK;
+}
+
+static OPERATE_RET __workqueue_put(TAL_WORKQUEUE_T *workqueue, WORK_ITEM_T *work_item, WORKQ_PRIO_E prio,
+                                   BOOL_T is_instant)
+{
+    OPERATE_RET op_ret = OPRT_COM_ERROR;
+    TUYA_QUEUE_HANDLE queue = NULL;
+    uint32_t used = 0, min_used = 0xFFFFFFFF;
+    uint8_t i = 0, idx = 0, start = workqueue->next;
+
+    if (WORKQ_PRIO_HIGH == prio) {
+        queue = workqueue->high;
+    } else if (WORKQ_PRIO_LOW == prio) {
+        queue = workqueue->low;
+    } else {
+        // the shortest queue, a busy owner gets robbed by the idle ones anyway
+        for (i = 0; i < workqueue->worker_num; i++) {
+            idx = (start + i) % workqueue->worker_num;
+            used = tuya_queue_get_used_num(workqueue->worker[idx].queue);
+            if (used < min_used) {
+                min_used = used;
+                queue = workqueue->worker[idx].queue;
+            }
+        }
+        workqueue->next = (start + 1) % workqueue->worker_num;
+    }
+
+    if (is_instant) {
+        op_ret = tuya_queue_input_instant(queue, work_item);
+    } else {
+        op_ret = tuya_queue_input(queue, work_item);
+    }
+    if (OPRT_OK == op_ret) {
+        op_ret = tal_semaphore_post(workqueue->sem);
+    }
+
+    return op_ret;
+}
+
 /**
  * @brief create and initialize a workqueue which runs in thread context
  *
@@ -109,41 +350,92 @@ static BOOL_T __work_cancel_traverse(void *item, void *ctx)
  * tuya_error_code.h
  */
 OPERATE_RET tal_workqueue_create(const uint16_t queue_len, THREAD_CFG_T *thread_cfg, WORKQUEUE_HANDLE *handle)
+{
+    return tal_workqueue_create_pool(queue_len, 1, thread_cfg, handle);
+}
+
+/**
+ * @brief create and initialize a workqueue that runs its items on several
+ * threads
+ *
+ * @param[in] queue_len the maximum number of items of each worker
+ * @param[in] worker_num number of worker threads
+ * @param[in] thread_cfg thread param of every worker, the name gets the
+ * worker index appended when there are several
+ * @param[out] handle the workqueue handle
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_workqueue_create_pool(const uint16_t queue_len, const uint8_t worker_num, THREAD_CFG_T *thread_cfg,
+                                      WORKQUEUE_HANDLE *handle)
 {
     OPERATE_RET op_ret = OPRT_OK;
     TAL_WORKQUEUE_T *workqueue = NULL;
+    TAL_WORKER_T *worker = NULL;
+    THREAD_CFG_T worker_cfg;
+    uint8_t i = 0;
 
-    if ((0 == queue_len) || (NULL == thread_cfg) || (NULL == handle)) {
+    if ((0 == queue_len) || (0 == worker_num) || (NULL == thread_cfg) || (NULL == handle)) {
         return OPRT_INVALID_PARM;
     }
 
-    workqueue = (TAL_WORKQUEUE_T *)tal_calloc(1, sizeof(TAL_WORKQUEUE_T));
+    workqueue = (TAL_WORKQUEUE_T *)tal_calloc(1, sizeof(TAL_WORKQUEUE_T) + worker_num * sizeof(TAL_WORKER_T));
     if (NULL == workqueue) {
         return OPRT_MALLOC_FAILED;
     }
+    workqueue->worker = (TAL_WORKER_T *)(workqueue + 1);
+    workqueue->worker_num = worker_num;
 
-    op_ret = tuya_queue_create(queue_len, sizeof(WORK_ITEM_T), &workqueue->queue);
+    op_ret = tal_semaphore_create_init(&workqueue->sem, 0, (uint32_t)queue_len * (worker_num + 2));
     if (OPRT_OK != op_ret) {
-        tal_free(workqueue);
-        return op_ret;
+        goto __ERR;
     }
 
-    op_ret = tal_semaphore_create_init(&workqueue->sem, 0, queue_len);
+    op_ret = tal_mutex_create_init(&workqueue->delay_mutex);
     if (OPRT_OK != op_ret) {
-        tuya_queue_release(workqueue->queue);
-        tal_free(workqueue);
-        return op_ret;
+        goto __ERR;
     }
+    tal_mutex_set_name(workqueue->delay_mutex, "wq delay");
 
-    op_ret = tal_thread_create_and_start(&workqueue->thread, NULL, NULL, __work_thread_cb, workqueue, thread_cfg);
+    op_ret = tuya_queue_create(queue_len, sizeof(WORK_ITEM_T), &workqueue->high);
     if (OPRT_OK != op_ret) {
-        tal_semaphore_release(workqueue->sem);
-        tuya_queue_release(workqueue->queue);
-        tal_free(workqueue);
-    } else {
-        *handle = workqueue;
+        goto __ERR;
+    }
+    op_ret = tuya_queue_create(queue_len, sizeof(WORK_ITEM_T), &workqueue->low);
+    if (OPRT_OK != op_ret) {
+        goto __ERR;
+    }
+
+    for (i = 0; i < worker_num; i++) {
+        op_ret = tuya_queue_create(queue_len, sizeof(WORK_ITEM_T), &workqueue->worker[i].queue);
+        if (OPRT_OK != op_ret) {
+            goto __ERR;
+        }
+    }
+
+    worker_cfg = *thread_cfg;
+    for (i = 0; i < worker_num; i++) {
+        worker = &workqueue->worker[i];
+        worker->workqueue = workqueue;
+        if (worker_num > 1) {
+            snprintf(worker->name, sizeof(worker->name), "%s%d", thread_cfg->thrdname ? thread_cfg->thrdname : "wq",
+                     i);
+            worker_cfg.thrdname = worker->name;
+        }
+        op_ret = tal_thread_create_and_start(&worker->thread, NULL, NULL, __work_thread_cb, worker, &worker_cfg);
+        if (OPRT_OK != op_ret) {
+            goto __ERR;
+        }
     }
 
+    *handle = workqueue;
+
+    return OPRT_OK;
+
+__ERR:
+    __workqueue_free(workqueue);
+
     return op_ret;
 }
 
@@ -168,10 +460,7 @@ OPERATE_RET tal_workqueue_schedule(WORKQUEUE_HANDLE handle, WORKQUEUE_CB cb, voi
     TAL_WORKQUEUE_T *workqueue = (TAL_WORKQUEUE_T *)handle;
     WORK_ITEM_T work_item = {.cb = cb, .data = data};
 
-    op_ret = tuya_queue_input(workqueue->queue, &work_item);
-    if (OPRT_OK == op_ret) {
-        op_ret = tal_semaphore_post(workqueue->sem);
-    }
+    op_ret = __workqueue_put(workqueue, &work_item, WORKQ_PRIO_NORMAL, FALSE);
 
     return op_ret;
 }
@@ -197,11 +486,36 @@ OPERATE_RET tal_workqueue_schedule_instant(WORKQUEUE_HANDLE handle, WORKQUEUE_CB
     TAL_WORKQUEUE_T *workqueue = (TAL_WORKQUEUE_T *)handle;
     WORK_ITEM_T work_item = {.cb = cb, .data = data};
 
-    op_ret = tuya_queue_input_instant(workqueue->queue, &work_item);
-    if (OPRT_OK == op_ret) {
-        op_ret = tal_semaphore_post(workqueue->sem);
+    op_ret = __workqueue_put(workqueue, &work_item, WORKQ_PRIO_NORMAL, TRUE);
+
+    return op_ret;
+}
+
+/**
+ * @brief put work task in a priority lane of the workqueue
+ *
+ * @param[in] handle the workqueue handle
+ * @param[in] prio the lane, WORKQ_PRIO_NORMAL is the same as
+ * tal_workqueue_schedule
+ * @param[in] cb the work callback
+ * @param[in] data the work data
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_workqueue_schedule_prio(WORKQUEUE_HANDLE handle, WORKQ_PRIO_E prio, WORKQUEUE_CB cb, void *data)
+{
+    OPERATE_RET op_ret = OPRT_OK;
+
+    if ((NULL == handle) || (NULL == cb) || (prio >= WORKQ_PRIO_MAX)) {
+        return OPRT_INVALID_PARM;
     }
 
+    TAL_WORKQUEUE_T *workqueue = (TAL_WORKQUEUE_T *)handle;
+    WORK_ITEM_T work_item = {.cb = cb, .data = data};
+
+    op_ret = __workqueue_put(workqueue, &work_item, prio, FALSE);
+
     return op_ret;
 }
 
@@ -223,8 +537,15 @@ OPERATE_RET tal_workqueue_cancel(WORKQUEUE_HANDLE handle, WORKQUEUE_CB cb, void
 
     TAL_WORKQUEUE_T *workqueue = (TAL_WORKQUEUE_T *)handle;
     WORK_ITEM_T work_item = {.cb = cb, .data = data};
+    uint8_t i = 0;
+
+    tuya_queue_traverse(workqueue->high, __work_cancel_traverse, &work_item);
+    for (i = 0; i < workqueue->worker_num; i++) {
+        tuya_queue_traverse(workqueue->worker[i].queue, __work_cancel_traverse, &work_item);
+    }
+    tuya_queue_traverse(workqueue->low, __work_cancel_traverse, &work_item);
 
-    return tuya_queue_traverse(workqueue->queue, __work_cancel_traverse, &work_item);
+    return OPRT_OK;
 }
 
 /**
@@ -244,7 +565,15 @@ OPERATE_RET tal_workqueue_traverse(WORKQUEUE_HANDLE handle, WORKQUEUE_TRAVERSE_C
     }
 
     TAL_WORKQUEUE_T *workqueue = (TAL_WORKQUEUE_T *)handle;
-    return tuya_queue_traverse(workqueue->queue, (TRAVERSE_CB)cb, ctx);
+    uint8_t i = 0;
+
+    tuya_queue_traverse(workqueue->high, (TRAVERSE_CB)cb, ctx);
+    for (i = 0; i < workqueue->worker_num; i++) {
+        tuya_queue_traverse(workqueue->worker[i].queue, (TRAVERSE_CB)cb, ctx);
+    }
+    tuya_queue_traverse(workqueue->low, (TRAVERSE_CB)cb, ctx);
+
+    return OPRT_OK;
 }
 
 /**
@@ -261,12 +590,18 @@ uint16_t tal_workqueue_get_num(WORKQUEUE_HANDLE handle)
     }
 
     TAL_WORKQUEUE_T *workqueue = (TAL_WORKQUEUE_T *)handle;
+    uint32_t num = 0;
+    uint8_t i = 0;
 
-    if (workqueue->last_cb) {
-        PR_NOTICE("%p:last_cb %p", workqueue->thread, workqueue->last_cb);
+    for (i = 0; i < workqueue->worker_num; i++) {
+        if (workqueue->worker[i].last_cb) {
+            PR_NOTICE("%p:last_cb %p", workqueue->worker[i].thread, workqueue->worker[i].last_cb);
+        }
+        num += tuya_queue_get_used_num(workqueue->worker[i].queue);
     }
+    num += tuya_queue_get_used_num(workqueue->high) + tuya_queue_get_used_num(workqueue->low);
 
-    return tuya_queue_get_used_num(workqueue->queue);
+    return num;
 }
 
 /**
@@ -283,29 +618,7 @@ OPERATE_RET tal_workqueue_release(WORKQUEUE_HANDLE handle)
         return OPRT_INVALID_PARM;
     }
 
-    OPERATE_RET op_ret = OPRT_OK;
-    uint32_t count = 1;
-    TAL_WORKQUEUE_T *workqueue = (TAL_WORKQUEUE_T *)handle;
-
-    op_ret = tal_thread_delete(workqueue->thread);
-    if (OPRT_OK != op_ret) {
-        return op_ret;
-    }
-
-    tal_semaphore_post(workqueue->sem);
-
-    while (THREAD_STATE_DELETE != tal_thread_get_state(workqueue->thread)) {
-        tal_system_sleep(10);
-        if ((count++) % 500 == 0) {
-            PR_NOTICE("%p still running", workqueue->thread);
-        }
-    }
-
-    tuya_queue_release(workqueue->queue);
-    tal_semaphore_release(workqueue->sem);
-    tal_free(workqueue);
-
-    return OPRT_OK;
+    return __workqueue_free((TAL_WORKQUEUE_T *)handle);
 }
 
 /**
@@ -322,21 +635,7 @@ THREAD_HANDLE tal_workqueue_get_thread(WORKQUEUE_HANDLE handle)
     }
 
     TAL_WORKQUEUE_T *workqueue = (TAL_WORKQUEUE_T *)handle;
-    return workqueue->thread;
-}
-
-typedef struct {
-    TIMER_ID timer;
-    WORKQUEUE_CB cb;
-    void *data;
-    WORKQUEUE_HANDLE handle;
-} DELAYED_WORK_T;
-
-void __delayed_work_cb(TIMER_ID timer_id, void *arg)
-{
-    DELAYED_WORK_T *p_delayed_work = (DELAYED_WORK_T *)arg;
-
-    tal_workqueue_schedule(p_delayed_work->handle, p_delayed_work->cb, p_delayed_work->data);
+    return workqueue->worker[0].thread;
 }
 
 /**
@@ -353,8 +652,6 @@ void __delayed_work_cb(TIMER_ID timer_id, void *arg)
 OPERATE_RET tal_workqueue_init_delayed(WORKQUEUE_HANDLE handle, WORKQUEUE_CB cb, void *data,
                                        DELAYED_WORK_HANDLE *delayed_work)
 {
-    OPERATE_RET op_ret = OPRT_OK;
-
     if (NULL == handle || NULL == delayed_work) {
         return OPRT_INVALID_PARM;
     }
@@ -368,12 +665,6 @@ OPERATE_RET tal_workqueue_init_delayed(WORKQUEUE_HANDLE handle, WORKQUEUE_CB cb,
     p_delayed_work->cb = cb;
     p_delayed_work->handle = handle;
 
-    op_ret = tal_sw_timer_create(__delayed_work_cb, p_delayed_work, &p_delayed_work->timer);
-    if (OPRT_OK != op_ret) {
-        tal_free(p_delayed_work);
-        return OPRT_COM_ERROR;
-    }
-
     *delayed_work = (DELAYED_WORK_HANDLE)p_delayed_work;
 
     return OPRT_OK;
@@ -396,8 +687,28 @@ OPERATE_RET tal_workqueue_start_delayed(DELAYED_WORK_HANDLE delayed_work, TIME_M
     }
 
     DELAYED_WORK_T *p_delayed_work = (DELAYED_WORK_T *)delayed_work;
+    TAL_WORKQUEUE_T *workqueue = (TAL_WORKQUEUE_T *)p_delayed_work->handle;
+    BOOL_T is_head = FALSE;
+
+    if ((LOOP_CYCLE == type) && (0 == interval)) {
+        interval = 1; // a cycle of 0 would never leave the expire loop
+    }
+
+    tal_mutex_lock(workqueue->delay_mutex);
+    if (p_delayed_work->is_armed) {
+        __delayed_unlink(workqueue, p_delayed_work);
+    }
+    p_delayed_work->interval = interval;
+    p_delayed_work->type = type;
+    p_delayed_work->deadline = tal_system_get_millisecond() + interval;
+    is_head = __delayed_link(workqueue, p_delayed_work);
+    tal_mutex_unlock(workqueue->delay_mutex);
+
+    if (is_head) {
+        tal_semaphore_post(workqueue->sem);
+    }
 
-    return tal_sw_timer_start(p_delayed_work->timer, interval, type);
+    return OPRT_OK;
 }
 
 /**
@@ -415,8 +726,15 @@ OPERATE_RET tal_workqueue_stop_delayed(DELAYED_WORK_HANDLE delayed_work)
     }
 
     DELAYED_WORK_T *p_delayed_work = (DELAYED_WORK_T *)delayed_work;
+    TAL_WORKQUEUE_T *workqueue = (TAL_WORKQUEUE_T *)p_delayed_work->handle;
+
+    tal_mutex_lock(workqueue->delay_mutex);
+    if (p_delayed_work->is_armed) {
+        __delayed_unlink(workqueue, p_delayed_work);
+    }
+    tal_mutex_unlock(workqueue->delay_mutex);
 
-    return tal_sw_timer_stop(p_delayed_work->timer);
+    return OPRT_OK;
 }
 
 /**
@@ -434,8 +752,13 @@ OPERATE_RET tal_workqueue_cancel_delayed(DELAYED_WORK_HANDLE delayed_work)
     }
 
     DELAYED_WORK_T *p_delayed_work = (DELAYED_WORK_T *)delayed_work;
+    TAL_WORKQUEUE_T *workqueue = (TAL_WORKQUEUE_T *)p_delayed_work->handle;
 
-    tal_sw_timer_delete(p_delayed_work->timer);
+    tal_mutex_lock(workqueue->delay_mutex);
+    if (p_delayed_work->is_armed) {
+        __delayed_unlink(workqueue, p_delayed_work);
+    }
+    tal_mutex_unlock(workqueue->delay_mutex);
     tal_workqueue_cancel(p_delayed_work->handle, p_delayed_work->cb, p_delayed_work->data);
 
     tal_free(p_delayed_work);
@@ -38,6 +38,20 @@ extern "C" {
 #define PROBE_REQUEST_PAYLOAD_LEN_MAX 255
 #define BROADCAST_MAC_ADDR            0xFFFFFFFF
 
+// aps kept from the last full scan, 0 disables the scan cache
+#ifndef TAL_WIFI_SCAN_CACHE_NUM
+#define TAL_WIFI_SCAN_CACHE_NUM 32
+#endif
+
+/**
+ * @brief data of EVENT_WIFI_SCAN_UPDATE, valid in the callback only
+ *
+ */
+typedef struct {
+    AP_IF_S *ap_ary;
+    uint32_t num;
+} TAL_WIFI_SCAN_RESULT_T;
+
 /**
  * @brief WIFI chip detects the local AP information structure
  * @struct MIMO_IF_S
@@ -232,6 +246,42 @@ OPERATE_RET tal_wifi_assign_ap_scan(int8_t *ssid, AP_IF_S **ap);
  */
 OPERATE_RET tal_wifi_release_ap(AP_IF_S *ap);
 
+/**
+ * @brief get the aps of the last full scan, scanning only when it is older
+ *        than max_age_ms. Every full scan, including the ones of
+ *        <tal_wifi_all_ap_scan>, refreshes the cache and publishes
+ *        EVENT_WIFI_SCAN_UPDATE, so callers share one channel sweep.
+ *
+ * @param[in]       max_age_ms  the oldest result to accept
+ * @param[out]      ap_ary      a copy of the ap info array, free it with
+ *                              tal_free
+ * @param[out]      num         the num of ap_ary
+ * @param[out]      age_ms      the age of the result, may be NULL
+ * @return  OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_wifi_scan_cache_get(uint32_t max_age_ms, AP_IF_S **ap_ary, uint32_t *num, uint32_t *age_ms);
+
+/**
+ * @brief find the ap with the best rssi of a ssid in the last full scan,
+ *        without scanning
+ *
+ * @param[in]       ssid        the specific ssid
+ * @param[in]       max_age_ms  the oldest result to accept
+ * @param[out]      ap          the ap info
+ * @return  OPRT_OK on success, OPRT_NOT_FOUND when the ssid is not in a
+ * result that young. Others on error, please refer to tuya_error_code.h
+ */
+OPERATE_RET tal_wifi_scan_cache_find(const int8_t *ssid, uint32_t max_age_ms, AP_IF_S *ap);
+
+/**
+ * @brief drop the cached scan result, e.g. after moving to another place
+ *
+ * @return  OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_wifi_scan_cache_clear(void);
+
 /**
  * @brief set wifi interface work channel
  *
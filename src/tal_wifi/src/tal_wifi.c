@@ -36,10 +36,62 @@ typedef struct {
     BOOL_T set_mode_done;
     uint32_t lp_disable_cnt;
     uint32_t lps_dtim;
+#if TAL_WIFI_SCAN_CACHE_NUM > 0
+    struct {
+        SYS_TIME_T time; // 0 when nothing is cached
+        uint32_t num;
+        AP_IF_S ap[TAL_WIFI_SCAN_CACHE_NUM];
+    } scan;
+#endif
 } TAL_WIFI_T;
 
 static TAL_WIFI_T s_tal_wifi = {0};
 
+#if TAL_WIFI_SCAN_CACHE_NUM > 0
+//! the strongest aps are kept when there are more than fit
+static void __tal_wifi_scan_cache_store(AP_IF_S *ap_ary, uint32_t num)
+{
+    uint32_t cnt = 0;
+
+    for (uint32_t i = 0; i < num; i++) {
+        uint32_t pos = cnt;
+        while (pos > 0 && s_tal_wifi.scan.ap[pos - 1].rssi < ap_ary[i].rssi) {
+            pos--;
+        }
+        if (pos >= TAL_WIFI_SCAN_CACHE_NUM) {
+            continue;
+        }
+        if (cnt < TAL_WIFI_SCAN_CACHE_NUM) {
+            cnt++;
+        }
+        memmove(&s_tal_wifi.scan.ap[pos + 1], &s_tal_wifi.scan.ap[pos], (cnt - 1 - pos) * sizeof(AP_IF_S));
+        memcpy(&s_tal_wifi.scan.ap[pos], &ap_ary[i], sizeof(AP_IF_S));
+        s_tal_wifi.scan.ap[pos].data_len = 0;
+    }
+    s_tal_wifi.scan.num = cnt;
+    s_tal_wifi.scan.time = tal_system_get_millisecond();
+    if (0 == s_tal_wifi.scan.time) {
+        s_tal_wifi.scan.time = 1;
+    }
+}
+
+static BOOL_T __tal_wifi_scan_cache_fresh(uint32_t max_age_ms, uint32_t *age_ms)
+{
+    if (0 == s_tal_wifi.scan.time) {
+        return FALSE;
+    }
+
+    SYS_TIME_T age = tal_system_get_millisecond() - s_tal_wifi.scan.time;
+    if (age > max_age_ms) {
+        return FALSE;
+    }
+    if (age_ms) {
+        *age_ms = (uint32_t)age;
+    }
+    return TRUE;
+}
+#endif
+
 OPERATE_RET tal_wifi_init(WIFI_EVENT_CB cb)
 {
     TAL_WIFI_CHECK_PARM(cb);
@@ -77,9 +129,21 @@ OPERATE_RET tal_wifi_all_ap_scan(AP_IF_S **ap_ary, uint32_t *num)
     op_ret = tuya_wpa_supp_scan(NULL, ap_ary, num);
 #else
     op_ret = tkl_wifi_scan_ap(NULL, ap_ary, num);
+#endif
+#if TAL_WIFI_SCAN_CACHE_NUM > 0
+    if (OPRT_OK == op_ret && *ap_ary) {
+        __tal_wifi_scan_cache_store(*ap_ary, *num);
+    }
 #endif
     TAL_WIFI_UNLOCK();
 
+#if TAL_WIFI_SCAN_CACHE_NUM > 0
+    if (OPRT_OK == op_ret && *ap_ary) {
+        TAL_WIFI_SCAN_RESULT_T result = {.ap_ary = *ap_ary, .num = *num};
+        tal_event_publish(EVENT_WIFI_SCAN_UPDATE, &result);
+    }
+#endif
+
     return op_ret;
 }
 /**
@@ -162,6 +226,114 @@ OPERATE_RET tal_wifi_release_ap(AP_IF_S *ap)
     return tkl_wifi_release_ap(ap);
 #endif
 }
+/**
+ * @brief get the aps of the last full scan, scanning only when it is older
+ *        than max_age_ms. Every full scan, including the ones of
+ *        <tal_wifi_all_ap_scan>, refreshes the cache and publishes
+ *        EVENT_WIFI_SCAN_UPDATE, so callers share one channel sweep.
+ *
+ * @param[in]       max_age_ms  the oldest result to accept
+ * @param[out]      ap_ary      a copy of the ap info array, free it with
+ *                              tal_free
+ * @param[out]      num         the num of ap_ary
+ * @param[out]      age_ms      the age of the result, may be NULL
+ * @return  OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_wifi_scan_cache_get(uint32_t max_age_ms, AP_IF_S **ap_ary, uint32_t *num, uint32_t *age_ms)
+{
+    TAL_WIFI_CHECK_PARM(ap_ary && num);
+
+#if TAL_WIFI_SCAN_CACHE_NUM > 0
+    OPERATE_RET op_ret = OPRT_OK;
+    AP_IF_S *list = NULL;
+    uint32_t cnt = 0;
+
+    //! a caller coming in during a scan waits for it and takes its result
+    TAL_WIFI_LOCK();
+    if (!__tal_wifi_scan_cache_fresh(max_age_ms, age_ms)) {
+        op_ret = tal_wifi_all_ap_scan(&list, &cnt);
+        if (OPRT_OK != op_ret) {
+            TAL_WIFI_UNLOCK();
+            return op_ret;
+        }
+        if (list) {
+            tal_wifi_release_ap(list);
+        }
+        if (age_ms) {
+            *age_ms = 0;
+        }
+    }
+
+    *num = s_tal_wifi.scan.num;
+    *ap_ary = tal_malloc((s_tal_wifi.scan.num ? s_tal_wifi.scan.num : 1) * sizeof(AP_IF_S));
+    if (NULL == *ap_ary) {
+        op_ret = OPRT_MALLOC_FAILED;
+    } else {
+        memcpy(*ap_ary, s_tal_wifi.scan.ap, s_tal_wifi.scan.num * sizeof(AP_IF_S));
+    }
+    TAL_WIFI_UNLOCK();
+
+    return op_ret;
+#else
+    return OPRT_NOT_SUPPORTED;
+#endif
+}
+
+/**
+ * @brief find the ap with the best rssi of a ssid in the last full scan,
+ *        without scanning
+ *
+ * @param[in]       ssid        the specific ssid
+ * @param[in]       max_age_ms  the oldest result to accept
+ * @param[out]      ap          the ap info
+ * @return  OPRT_OK on success, OPRT_NOT_FOUND when the ssid is not in a
+ * result that young. Others on error, please refer to tuya_error_code.h
+ */
+OPERATE_RET tal_wifi_scan_cache_find(const int8_t *ssid, uint32_t max_age_ms, AP_IF_S *ap)
+{
+    TAL_WIFI_CHECK_PARM(ssid && ap);
+
+#if TAL_WIFI_SCAN_CACHE_NUM > 0
+    OPERATE_RET op_ret = OPRT_NOT_FOUND;
+
+    TAL_WIFI_LOCK();
+    if (__tal_wifi_scan_cache_fresh(max_age_ms, NULL)) {
+        //! the cache is sorted by rssi, the first match is the best
+        for (uint32_t i = 0; i < s_tal_wifi.scan.num; i++) {
+            if (0 == strcmp((const char *)s_tal_wifi.scan.ap[i].ssid, (const char *)ssid)) {
+                memcpy(ap, &s_tal_wifi.scan.ap[i], sizeof(AP_IF_S));
+                op_ret = OPRT_OK;
+                break;
+            }
+        }
+    }
+    TAL_WIFI_UNLOCK();
+
+    return op_ret;
+#else
+    return OPRT_NOT_SUPPORTED;
+#endif
+}
+
+/**
+ * @brief drop the cached scan result, e.g. after moving to another place
+ *
+ * @return  OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET tal_wifi_scan_cache_clear(void)
+{
+#if TAL_WIFI_SCAN_CACHE_NUM > 0
+    TAL_WIFI_LOCK();
+    s_tal_wifi.scan.time = 0;
+    s_tal_wifi.scan.num = 0;
+    TAL_WIFI_UNLOCK();
+#endif
+
+    return OPRT_OK;
+}
+
 /**
  * @brief set wifi interface work channel
  *
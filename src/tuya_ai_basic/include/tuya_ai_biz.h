@@ -136,6 +136,12 @@ typedef OPERATE_RET (*AI_BIZ_RECV_CB)(AI_BIZ_ATTR_INFO_T *attr, AI_BIZ_HEAD_INFO
 typedef OPERATE_RET (*AI_BIZ_MONITOR_CB)(uint16_t id, AI_BIZ_ATTR_INFO_T *attr, AI_BIZ_HEAD_INFO_T *head, char *data,
                                          void *usr_data);
 
+typedef uint8_t AI_BIZ_SEND_PRIO;
+#define AI_BIZ_PRIO_AUTO     0 // derived from packet type
+#define AI_BIZ_PRIO_REALTIME 1 // audio, served first on every pass
+#define AI_BIZ_PRIO_CONTROL  2 // event and text
+#define AI_BIZ_PRIO_BULK     3 // video, image and file, sent in slices between the others
+
 typedef struct {
     /** send packet type */
     AI_PACKET_PT type;
@@ -145,6 +151,8 @@ typedef struct {
     AI_BIZ_SEND_GET_CB get_cb;
     /** send channel free cb */
     AI_BIZ_SEND_FREE_CB free_cb;
+    /** send channel priority class */
+    AI_BIZ_SEND_PRIO prio;
 } AI_BIZ_SEND_DATA_T;
 
 typedef struct {
@@ -193,6 +201,18 @@ OPERATE_RET tuya_ai_biz_crt_session(uint32_t bizCode, AI_SESSION_CFG_T *cfg, uin
  */
 OPERATE_RET tuya_ai_biz_del_session(AI_SESSION_ID id, AI_STATUS_CODE code);
 
+/**
+ * @brief notify the send task that data is ready on a send channel
+ *
+ * @note once notified, the channel is only polled after a notify, get_cb is called
+ *       until it returns an error
+ *
+ * @param[in] id send channel id
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+OPERATE_RET tuya_ai_biz_send_notify(uint16_t id);
+
 /**
  * @brief send ai biz packet
  *
@@ -279,15 +279,23 @@ typedef enum {
     AI_STAGE_PRE_WRITE,
 } AI_STAGE_E;
 
+typedef struct {
+    void *buf;
+    uint32_t len;
+} AI_PACKET_SEG_T;
+
 struct ai_send_packet_t;
 struct ai_packet_writer_t;
 typedef OPERATE_RET (*AI_PACKET_DATA_UPDATE_CB)(AI_STAGE_E stage, void *data, struct ai_send_packet_t *info);
 typedef OPERATE_RET (*AI_PACKET_WRITE_CB)(struct ai_packet_writer_t *writer, void *buf, uint32_t buf_len);
+typedef OPERATE_RET (*AI_PACKET_WRITEV_CB)(struct ai_packet_writer_t *writer, AI_PACKET_SEG_T *segs,
+                                           uint32_t seg_num);
 
 typedef struct ai_packet_writer_t {
     AI_PACKET_DATA_UPDATE_CB update; // callback to update internal data
     AI_PACKET_WRITE_CB write;        // callback to write packet data
     void *user_data;                 // user data to pass to the writer callback
+    AI_PACKET_WRITEV_CB writev;      // optional, write several segments at once, falls back to write
 } AI_PACKET_WRITER_T;
 
 typedef struct ai_send_packet_t {
@@ -298,6 +306,9 @@ typedef struct ai_send_packet_t {
     uint32_t len;
     char *data;
     AI_PACKET_WRITER_T *writer;
+    AI_PACKET_SEG_T *segs; // optional, payload given as segments instead of data
+    uint32_t seg_num;
+    uint32_t seg_offset; // payload offset into segs
 } AI_SEND_PACKET_T;
 
 typedef struct {
@@ -439,6 +450,9 @@ OPERATE_RET tuya_ai_basic_conn_close(AI_STATUS_CODE code);
 /**
  * @brief read ai packet
  *
+ * @note unfragmented packets are decrypted in place in the receive buffer, out is only
+ *       valid until the next read and must be released by tuya_ai_basic_pkt_free
+ *
  * @param[out] out packet data
  * @param[out] out_len packet data length
  * @param[out] out_frag packet fragment flag
@@ -505,6 +519,46 @@ AI_ATOP_CFG_INFO_T *tuya_ai_basic_get_atop_cfg(void);
  */
 OPERATE_RET tuya_ai_basic_connect(void);
 
+/**
+ * @brief check whether the atop config can still be used to connect
+ *
+ * @param[in] margin_s seconds the config must stay valid for
+ *
+ * @return TRUE if hosts and credential are present and not expiring within margin_s
+ */
+uint8_t tuya_ai_basic_cfg_is_valid(uint32_t margin_s);
+
+/**
+ * @brief close the link and reset per connection state, keep the atop config
+ *
+ * Lets the client reconnect with tuya_ai_basic_connect() without a new atop request.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+OPERATE_RET tuya_ai_basic_reconnect_prepare(void);
+
+/**
+ * @brief pre-connect a standby socket to the ai server
+ *
+ * The next tuya_ai_basic_connect() takes it over instead of connecting, unless it
+ * is older than AI_STANDBY_MAX_AGE_MS.
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+OPERATE_RET tuya_ai_basic_standby_connect(void);
+
+/**
+ * @brief close the standby socket if any
+ */
+void tuya_ai_basic_standby_close(void);
+
+/**
+ * @brief get the time the last packet was written to the ai link
+ *
+ * @return tal_system_get_millisecond() of the last successful send, 0 if none
+ */
+SYS_TIME_T tuya_ai_basic_get_last_send_time(void);
+
 /**
  * @brief ai basic disconnect
  *
@@ -624,6 +678,24 @@ OPERATE_RET tuya_ai_basic_text(AI_TEXT_ATTR_T *text, char *data, uint32_t len, u
  */
 OPERATE_RET tuya_ai_basic_event(AI_EVENT_ATTR_T *event, char *data, uint32_t len, AI_PACKET_WRITER_T *writer);
 
+/**
+ * @brief send biz packet whose payload is given as segments
+ *
+ * The segments are referenced as-is, no copy of the payload is made before
+ * it is encrypted into the transporter.
+ *
+ * @param[in] type packet type, only AI_PT_VIDEO/AUDIO/IMAGE/FILE/TEXT supported
+ * @param[in] attr attr of the type, such as AI_AUDIO_ATTR_T, NULL if no attr
+ * @param[in] segs payload segments, the first one starts with the biz head
+ * @param[in] seg_num segment number
+ * @param[in] total_len total len
+ * @param[in] writer packet writer, NULL to use the cloud transporter
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+OPERATE_RET tuya_ai_basic_segs(AI_PACKET_PT type, void *attr, AI_PACKET_SEG_T *segs, uint32_t seg_num,
+                               uint32_t total_len, AI_PACKET_WRITER_T *writer);
+
 /**
  * @brief get attr value
  *
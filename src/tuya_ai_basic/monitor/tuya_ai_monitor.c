@@ -14,8 +14,12 @@
 #include "tuya_ai_private.h"
 
 #include "tal_api.h"
+#include "tal_fs.h"
+#include "tal_trace.h"
+#include "tuya_ringbuf.h"
 
 #include "tuya_iot.h"
+#include "tuya_health.h"
 #include "netmgr.h"
 #include "tuya_lan.h"
 #include "lan_sock.h"
@@ -38,6 +42,27 @@
 #define AI_MONITOR_DIR_ACK 2 // Device ack to client
 #define AI_MONITOR_DIR_MAX 3 // Maximum direction type
 
+// Stage latency histogram buckets, the last one collects everything above the last bound
+#define AI_MONITOR_LAT_BUCKET_NUM 8
+#define AI_MONITOR_LAT_TEXT_LEN   1024
+
+// Capture queue between the biz hooks and the sender thread
+#ifndef AI_MONITOR_CAP_BUF_SIZE
+#define AI_MONITOR_CAP_BUF_SIZE (32 * 1024)
+#endif
+// Largest packed frame, bigger ones are dropped
+#ifndef AI_MONITOR_CAP_FRAME_MAX
+#define AI_MONITOR_CAP_FRAME_MAX (8 * 1024)
+#endif
+#ifndef AI_MONITOR_CAP_STACK_SIZE
+#define AI_MONITOR_CAP_STACK_SIZE (3 * 1024)
+#endif
+
+// Capture file: this header, then per frame an ai_monitor_cap_rec_t and the
+// frame as it goes to the clients, little endian
+#define AI_MONITOR_CAP_FILE_MAGIC   "TYAIMCAP"
+#define AI_MONITOR_CAP_FILE_VERSION 1
+
 #pragma pack(1)
 typedef struct {
     uint32_t magic;              // magic number for frame synchronization
@@ -45,8 +70,36 @@ typedef struct {
     uint8_t direction : 2;       // direction: 0 for device upload, 1 for cloud download, 2 for device ack to client
     AI_PACKET_HEAD_T pkg_header; // Base 2.0 Protocol header
 } ai_monitor_header_t;
+
+typedef struct {
+    char magic[8];       // AI_MONITOR_CAP_FILE_MAGIC
+    uint16_t version;    // AI_MONITOR_CAP_FILE_VERSION
+    uint16_t rec_len;    // size of ai_monitor_cap_rec_t
+    uint32_t reserved;
+} ai_monitor_cap_file_head_t;
+
+typedef struct {
+    uint64_t ts_ms;    // posix time the frame was captured
+    uint32_t len;      // frame bytes that follow
+    uint8_t direction; // AI_MONITOR_DIR_xxx
+    uint8_t type;      // AI_PACKET_PT, clients registered for it get the frame
+    uint16_t id;       // biz channel id
+} ai_monitor_cap_rec_t;
 #pragma pack()
 
+typedef struct {
+    TUYA_RINGBUFF_T ring;        // records waiting for the sender
+    MUTEX_HANDLE mutex;          // producers and the ring
+    SEM_HANDLE sem;              // posted per record
+    THREAD_HANDLE thread;        // sender
+    uint8_t *frame;              // packed by the producer, under mutex
+    uint32_t frame_len;          // bytes in frame
+    uint8_t frame_over;          // packet did not fit in frame
+    uint8_t *tx;                 // record taken by the sender
+    TUYA_FILE file;              // capture file, NULL when not recording
+    ai_monitor_cap_stat_t stat;  // counters
+} ai_monitor_cap_t;
+
 typedef struct {
     int fd;                      // socket fd
     TUYA_IP_ADDR_T addr;         // client address
@@ -76,6 +129,19 @@ typedef struct {
     QUEUE_HANDLE log_queue;       // log queue
 } ai_monitor_server_t;
 
+typedef struct {
+    uint32_t count;                             // number of samples
+    uint32_t sum_ms;                            // sum of all samples
+    uint32_t max_ms;                            // largest sample
+    uint32_t bucket[AI_MONITOR_LAT_BUCKET_NUM]; // sample count per bucket
+} ai_monitor_hist_t;
+
+typedef struct {
+    SYS_TIME_T ts[AI_MONITOR_STAGE_MAX];          // stage time of the current turn, 0 if not reached
+    ai_monitor_hist_t hist[AI_MONITOR_STAGE_MAX]; // delay from the previous reached stage
+    ai_monitor_hist_t total;                      // vad stop to playback start
+} ai_monitor_latency_t;
+
 typedef struct {
     AI_PACKET_WRITER_T *writer; // packet writer
     int fd;                     // socket fd
@@ -100,6 +166,29 @@ static void __session_close_all(void);
 static OPERATE_RET __default_update(AI_STAGE_E stage, void *data, AI_SEND_PACKET_T *info);
 static OPERATE_RET __default_write(AI_PACKET_WRITER_T *writer, void *buf, uint32_t buf_len);
 static void __log_output(const char *str);
+static OPERATE_RET __latency_send(ai_monitor_client_t *client);
+static void __cli_latency(int argc, char *argv[]);
+static void __cli_capture(int argc, char *argv[]);
+static OPERATE_RET __capture_write(AI_PACKET_WRITER_T *writer, void *buf, uint32_t buf_len);
+
+static ai_monitor_latency_t s_latency = {0};
+static uint8_t s_latency_cli_registered = FALSE;
+static const uint32_t sc_latency_bound_ms[AI_MONITOR_LAT_BUCKET_NUM - 1] = {50, 100, 200, 400, 800, 1600, 3200};
+static const char *sc_latency_stage_name[AI_MONITOR_STAGE_MAX] = {"vad_start", "uplink", "vad_stop", "asr",
+                                                                  "nlg",       "tts",    "play"};
+
+static const cli_cmd_t s_latency_cli_cmd[] = {
+    {
+        .name = "ai_latency",
+        .help = "ai_latency [reset], show ai stage latency histograms",
+        .func = __cli_latency,
+    },
+    {
+        .name = "ai_capture",
+        .help = "ai_capture [start <path>|stop], record monitored frames, show capture counters",
+        .func = __cli_capture,
+    },
+};
 
 ai_monitor_writer_cfg_t s_monitor_writer_cfg = {
     .writer = NULL, // Will be set later
@@ -114,6 +203,21 @@ AI_PACKET_WRITER_T s_default_writer = {
     .user_data = &s_monitor_writer_cfg,
 };
 
+// packs biz frames into s_cap.frame instead of a socket
+static ai_monitor_cap_t s_cap = {0};
+static AI_PACKET_WRITER_T s_capture_writer;
+static ai_monitor_writer_cfg_t s_capture_writer_cfg = {
+    .writer = &s_capture_writer,
+    .fd = -1,
+    .direction = 0,
+    .sequence_out = 1,
+};
+static AI_PACKET_WRITER_T s_capture_writer = {
+    .update = __default_update,
+    .write = __capture_write,
+    .user_data = &s_capture_writer_cfg,
+};
+
 #define AI_MONITOR_WRITER_UPDATE(_writer, _fd, _direction)                                                             \
     do {                                                                                                               \
         ((ai_monitor_writer_cfg_t *)_writer->user_data)->writer = &s_default_writer;                                   \
@@ -315,6 +419,17 @@ static OPERATE_RET __handle_event_alg_ctrl(ai_monitor_client_t *client, AI_EVENT
     return OPRT_NOT_SUPPORTED; // Not implemented yet, return not supported
 }
 
+static OPERATE_RET __handle_event_latency(ai_monitor_client_t *client, AI_EVENT_ATTR_T *event)
+{
+    OPERATE_RET rt = __latency_send(client);
+
+    if (event->user_len > 0 && event->user_data[0] == 1) {
+        tuya_ai_monitor_latency_reset();
+    }
+
+    return rt;
+}
+
 static OPERATE_RET __handle_event(ai_monitor_client_t *client, AI_EVENT_ATTR_T *event, char *payload)
 {
     OPERATE_RET rt = OPRT_OK;
@@ -330,6 +445,9 @@ static OPERATE_RET __handle_event(ai_monitor_client_t *client, AI_EVENT_ATTR_T *
     } else if (event_type == AI_EVENT_MONITOR_ALG_CTRL) {
         // Handle algorithm control event
         rt = __handle_event_alg_ctrl(client, event);
+    } else if (event_type == AI_EVENT_MONITOR_LATENCY) {
+        // Handle stage latency request
+        rt = __handle_event_latency(client, event);
     } else {
         // Unsupported event type
         PR_ERR("Unsupported event type: %d", event_type);
@@ -446,16 +564,25 @@ static OPERATE_RET __parse_pkg(ai_monitor_client_t *client, char *data, uint32_t
     }
 }
 
-static int __find_sync_frame(const uint8_t *data, uint32_t len)
+/**
+ * @brief Offset of the first magic word, in one pass with a rolling word
+ *
+ * The magic is sent in network order, so the bytes are shifted in from the
+ * right. Without a match *keep is the tail that may still start one.
+ */
+static int __find_sync_frame(const uint8_t *data, uint32_t len, uint32_t *keep)
 {
-    // Search for magic number
-    uint32_t magic = UNI_HTONL(AI_MONITOR_MAGIC);
-    for (uint32_t offset = 0; offset <= len; offset++) {
-        if (memcmp(data + offset, &magic, sizeof(magic)) == 0) {
-            return offset; // Found sync frame
+    uint32_t word = 0;
+
+    for (uint32_t i = 0; i < len; i++) {
+        word = (word << 8) | data[i];
+        if (i >= sizeof(word) - 1 && word == AI_MONITOR_MAGIC) {
+            return i - (sizeof(word) - 1);
         }
     }
-    return OPRT_NOT_FOUND; // No valid frame found
+
+    *keep = (len < sizeof(word) - 1) ? len : sizeof(word) - 1;
+    return OPRT_NOT_FOUND;
 }
 
 /**
@@ -494,12 +621,13 @@ static void __socket_read_handler(int32_t sock)
     uint32_t processed = 0;
     while (processed < client->recv_len) {
         // find sync frame with magic number
-        OPERATE_RET ret = __find_sync_frame(client->recv_buf + processed, client->recv_len - processed);
-        if (ret != OPRT_OK) {
-            // drop all data before the sync frame
-            PR_ERR("find sync frame failed: %d", ret);
-            processed = client->recv_len;
-            break; // No valid frame found
+        uint32_t keep = 0;
+        int ret = __find_sync_frame(client->recv_buf + processed, client->recv_len - processed, &keep);
+        if (ret < 0) {
+            // drop all data but a tail that may start the next magic
+            PR_DEBUG("no sync frame in %u bytes", client->recv_len - processed);
+            processed = client->recv_len - keep;
+            break;
         }
         processed += ret; // Move to the start of the sync frame
 
@@ -749,6 +877,199 @@ static void __accept_err(int fd)
     return;
 }
 
+static OPERATE_RET __capture_write(AI_PACKET_WRITER_T *writer, void *buf, uint32_t buf_len)
+{
+    if (!buf || buf_len == 0) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (s_cap.frame_len + buf_len > AI_MONITOR_CAP_FRAME_MAX) {
+        s_cap.frame_over = TRUE;
+        return OPRT_BUFFER_NOT_ENOUGH;
+    }
+    memcpy(s_cap.frame + s_cap.frame_len, buf, buf_len);
+    s_cap.frame_len += buf_len;
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief pack a biz frame and queue it for the sender thread, dropped when
+ * the queue is full
+ */
+static OPERATE_RET __capture_put(uint8_t direction, uint16_t id, AI_BIZ_ATTR_INFO_T *attr, AI_BIZ_HEAD_INFO_T *head,
+                                 char *data)
+{
+    OPERATE_RET rt = OPRT_OK;
+    ai_monitor_cap_rec_t rec = {0};
+
+    if (NULL == s_cap.ring) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    tal_mutex_lock(s_cap.mutex);
+    s_cap.frame_len = 0;
+    s_cap.frame_over = FALSE;
+    s_capture_writer_cfg.direction = direction;
+    rt = tuya_ai_send_biz_pkt_custom(id, attr, attr->type, head, data, &s_capture_writer);
+    if (OPRT_OK != rt || s_cap.frame_over) {
+        s_cap.stat.drop_big++;
+        tal_mutex_unlock(s_cap.mutex);
+        return s_cap.frame_over ? OPRT_BUFFER_NOT_ENOUGH : rt;
+    }
+
+    if (tuya_ring_buff_free_size_get(s_cap.ring) < sizeof(rec) + s_cap.frame_len) {
+        s_cap.stat.drop_full++;
+        tal_mutex_unlock(s_cap.mutex);
+        return OPRT_EXCEED_UPPER_LIMIT;
+    }
+
+    rec.ts_ms = tal_time_get_posix_ms();
+    rec.len = s_cap.frame_len;
+    rec.direction = direction;
+    rec.type = attr->type;
+    rec.id = id;
+    tuya_ring_buff_write(s_cap.ring, &rec, sizeof(rec));
+    tuya_ring_buff_write(s_cap.ring, s_cap.frame, s_cap.frame_len);
+    s_cap.stat.records++;
+    s_cap.stat.bytes += s_cap.frame_len;
+    tal_mutex_unlock(s_cap.mutex);
+
+    tal_semaphore_post(s_cap.sem);
+
+    return OPRT_OK;
+}
+
+static uint8_t __capture_take(ai_monitor_cap_rec_t *rec)
+{
+    uint8_t got = FALSE;
+
+    tal_mutex_lock(s_cap.mutex);
+    if (tuya_ring_buff_used_size_get(s_cap.ring) >= sizeof(*rec)) {
+        tuya_ring_buff_read(s_cap.ring, rec, sizeof(*rec));
+        tuya_ring_buff_read(s_cap.ring, s_cap.tx, rec->len);
+        got = TRUE;
+    }
+    tal_mutex_unlock(s_cap.mutex);
+
+    return got;
+}
+
+static OPERATE_RET __send_all(int fd, const uint8_t *buf, uint32_t len)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint32_t total_sent = 0;
+
+    while (total_sent < len) {
+        rt = tal_net_send(fd, buf + total_sent, len - total_sent);
+        if (rt <= 0) {
+            TUYA_ERRNO err = tal_net_get_errno();
+            // FIXME: some platforms may return different error codes
+            if (err == UNW_EAGAIN || err == UNW_EWOULDBLOCK || err == 11) {
+                // Non-blocking mode, retry
+                tal_system_sleep(50); // Sleep for a short time before retrying
+                continue;
+            }
+            PR_ERR("send data failed, rt=%d, errno=%d", rt, err);
+            return OPRT_COM_ERROR;
+        }
+        total_sent += rt;
+    }
+
+    return OPRT_OK;
+}
+
+static void __capture_deliver(ai_monitor_cap_rec_t *rec)
+{
+    ai_monitor_server_t *server = &g_ai_monitor_server;
+
+    // send to specific client which registered this type
+    for (uint32_t i = 0; i < server->config.max_clients; i++) {
+        ai_monitor_client_t *client = &server->clients[i];
+        if (!client->connected || client->fd < 0 || !__is_client_registered(client, rec->type)) {
+            continue;
+        }
+        PR_TRACE("Sending to client %d, id=%d, type=%d, len=%u", client->fd, rec->id, rec->type, rec->len);
+        if (OPRT_OK != __send_all(client->fd, s_cap.tx, rec->len)) {
+            s_cap.stat.send_err++;
+        }
+    }
+
+    tal_mutex_lock(s_cap.mutex);
+    if (s_cap.file) {
+        if (tal_fwrite(rec, sizeof(*rec), s_cap.file) != sizeof(*rec) ||
+            tal_fwrite(s_cap.tx, rec->len, s_cap.file) != (int)rec->len) {
+            s_cap.stat.file_err++;
+        }
+    }
+    tal_mutex_unlock(s_cap.mutex);
+}
+
+static void __capture_task(void *args)
+{
+    ai_monitor_cap_rec_t rec;
+
+    while (THREAD_STATE_RUNNING == tal_thread_get_state(s_cap.thread)) {
+        tal_semaphore_wait(s_cap.sem, SEM_WAIT_FOREVER);
+        while (__capture_take(&rec)) {
+            __capture_deliver(&rec);
+        }
+    }
+}
+
+static void __capture_deinit(void)
+{
+    if (s_cap.thread) {
+        tal_thread_delete(s_cap.thread);
+        tal_semaphore_post(s_cap.sem);
+        while (THREAD_STATE_DELETE != tal_thread_get_state(s_cap.thread)) {
+            tal_system_sleep(10);
+        }
+    }
+    tuya_ai_monitor_capture_stop();
+    if (s_cap.ring) {
+        tuya_ring_buff_free(s_cap.ring);
+    }
+    if (s_cap.sem) {
+        tal_semaphore_release(s_cap.sem);
+    }
+    if (s_cap.mutex) {
+        tal_mutex_release(s_cap.mutex);
+    }
+    OS_FREE(s_cap.frame);
+    OS_FREE(s_cap.tx);
+    memset(&s_cap, 0, sizeof(s_cap));
+}
+
+static OPERATE_RET __capture_init(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+    THREAD_CFG_T thrd_param = {0};
+
+    TUYA_CALL_ERR_GOTO(tuya_ring_buff_create(AI_MONITOR_CAP_BUF_SIZE, OVERFLOW_STOP_TYPE, &s_cap.ring), __ERR);
+    TUYA_CALL_ERR_GOTO(tal_mutex_create_init(&s_cap.mutex), __ERR);
+    tal_mutex_set_name(s_cap.mutex, "ai mon cap");
+    TUYA_CALL_ERR_GOTO(tal_semaphore_create_init(&s_cap.sem, 0, 0xFFFF), __ERR);
+    s_cap.frame = OS_MALLOC(AI_MONITOR_CAP_FRAME_MAX);
+    s_cap.tx = OS_MALLOC(AI_MONITOR_CAP_FRAME_MAX);
+    if (!s_cap.frame || !s_cap.tx) {
+        rt = OPRT_MALLOC_FAILED;
+        goto __ERR;
+    }
+
+    thrd_param.priority = THREAD_PRIO_3;
+    thrd_param.thrdname = "ai_mon_cap";
+    thrd_param.stackDepth = AI_MONITOR_CAP_STACK_SIZE;
+    TUYA_CALL_ERR_GOTO(tal_thread_create_and_start(&s_cap.thread, NULL, NULL, __capture_task, NULL, &thrd_param),
+                       __ERR);
+
+    return OPRT_OK;
+
+__ERR:
+    __capture_deinit();
+    return rt;
+}
+
 static OPERATE_RET __ai_biz_handler(uint8_t direction, uint16_t id, AI_BIZ_ATTR_INFO_T *attr, AI_BIZ_HEAD_INFO_T *head,
                                     char *data, void *usr_data)
 {
@@ -756,49 +1077,47 @@ static OPERATE_RET __ai_biz_handler(uint8_t direction, uint16_t id, AI_BIZ_ATTR_
         return OPRT_INVALID_PARM;
     }
 
+    if (attr->type == AI_PT_AUDIO) {
+        if (direction == AI_MONITOR_DIR_US) {
+            tuya_ai_monitor_stage_mark(AI_MONITOR_STAGE_UPLINK);
+        } else if (direction == AI_MONITOR_DIR_DS) {
+            tuya_ai_monitor_stage_mark(AI_MONITOR_STAGE_TTS);
+        }
+    }
+
     // FIXME: 暂不支持分片报文,需要在底层协议处理部分将分片信息分实例进行管理，否则会导致分片标志乱序
     if (head->total_len > 0 && head->total_len != head->len) {
         PR_ERR("Unsupported fragmented message, total_len=%d, len=%d", head->total_len, head->len);
         return OPRT_NOT_SUPPORTED;
     }
 
-    OPERATE_RET ret = OPRT_OK;
     ai_monitor_server_t *server = (ai_monitor_server_t *)usr_data;
+    uint8_t wanted = (NULL != s_cap.file);
 
-    // send to specific client which registered this type
-    for (uint32_t i = 0; i < server->config.max_clients; i++) {
-        ai_monitor_client_t *client = &server->clients[i];
-        if (!client->connected || client->fd < 0) {
-            continue; // Skip disconnected clients
-        }
-
-        uint8_t registered = __is_client_registered(client, attr->type);
-        if (!registered) {
-            PR_TRACE("client %d not registered for type %d", i, attr->type);
-            continue; // Skip unregistered or disconnected clients
-        }
-        PR_TRACE("Sending to client %d, id=%d, type=%d, head len=%d, data len=%d", client->fd, id, attr->type,
-                 head->len, head->total_len);
-        ret = __pack_and_send(client, direction, id, attr, head, data);
-        if (ret != OPRT_OK) {
-            PR_ERR("send to client %d failed: %d", client->fd, ret);
-            continue; // Try next client
-        }
+    for (uint32_t i = 0; !wanted && i < server->config.max_clients; i++) {
+        wanted = __is_client_registered(&server->clients[i], attr->type);
+    }
+    if (!wanted) {
+        return OPRT_OK;
     }
 
-    return ret;
+    // only packed here, the sender thread does the socket and file writes
+    return __capture_put(direction, id, attr, head, data);
 }
 
 static OPERATE_RET __ai_biz_recv_handler(uint16_t id, AI_BIZ_ATTR_INFO_T *attr, AI_BIZ_HEAD_INFO_T *head, char *data,
                                          void *usr_data)
 {
-    return __ai_biz_handler(AI_MONITOR_DIR_DS, id, attr, head, data, usr_data);
+    // a frame the monitor drops must not fail the biz path
+    __ai_biz_handler(AI_MONITOR_DIR_DS, id, attr, head, data, usr_data);
+    return OPRT_OK;
 }
 
 static OPERATE_RET __ai_biz_send_handler(uint16_t id, AI_BIZ_ATTR_INFO_T *attr, AI_BIZ_HEAD_INFO_T *head, char *data,
                                          void *usr_data)
 {
-    return __ai_biz_handler(AI_MONITOR_DIR_US, id, attr, head, data, usr_data);
+    __ai_biz_handler(AI_MONITOR_DIR_US, id, attr, head, data, usr_data);
+    return OPRT_OK;
 }
 
 static void __monitor_tm_cb(TIMER_ID timerID, void *pTimerArg)
@@ -933,6 +1252,17 @@ OPERATE_RET tuya_ai_monitor_init(const ai_monitor_config_t *config)
         return rt;
     }
 
+    rt = __capture_init();
+    if (rt != OPRT_OK) {
+        PR_ERR("create capture queue failed: %d", rt);
+        tal_sw_timer_delete(g_ai_monitor_server.timer);
+        OS_FREE(g_ai_monitor_server.clients);
+        g_ai_monitor_server.clients = NULL;
+        tal_mutex_release(g_ai_monitor_server.mutex);
+        g_ai_monitor_server.mutex = NULL;
+        return rt;
+    }
+
     g_ai_monitor_server.initialized = TRUE;
     g_ai_monitor_server.running = FALSE;
     g_ai_monitor_server.server_fd = -1;
@@ -940,6 +1270,11 @@ OPERATE_RET tuya_ai_monitor_init(const ai_monitor_config_t *config)
     g_ai_monitor_server.sequence = tal_system_get_random(0xFFFF);
     g_ai_monitor_server.session_id = tal_system_get_random(0xFFFFFFFF);
 
+    if (!s_latency_cli_registered) {
+        tal_cli_cmd_register(s_latency_cli_cmd, CNTSOF(s_latency_cli_cmd));
+        s_latency_cli_registered = TRUE;
+    }
+
     PR_INFO("AI monitor initialized, port=%d, max_clients=%d, inital sid=%u", config->port, config->max_clients,
             g_ai_monitor_server.session_id);
 
@@ -1005,6 +1340,9 @@ OPERATE_RET tuya_ai_monitor_deinit(void)
         __ai_monitor_stop();
     }
 
+    tuya_ai_biz_monitor_register(NULL, NULL, NULL);
+    __capture_deinit();
+
     // Free resources
     if (g_ai_monitor_server.clients) {
         OS_FREE(g_ai_monitor_server.clients);
@@ -1053,6 +1391,7 @@ OPERATE_RET tuya_ai_monitor_broadcast(uint16_t id, AI_BIZ_ATTR_INFO_T *attr, AI_
 #define TY_AI_MONITOR_US_MIC   0x8003
 #define TY_AI_MONITOR_US_REF   0x8005
 #define TY_AI_MONITOR_US_AEC   0x8007
+#define TY_AI_MONITOR_US_LAT   0x8009
 
 /**
  * @brief broadcast text data to all connected clients
@@ -1184,9 +1523,302 @@ void tuya_ai_monitor_dump_status(void)
                     g_ai_monitor_server.clients[i].addr, g_ai_monitor_server.clients[i].last_ping_time);
         }
     }
+    PR_INFO("Capture: records=%u, bytes=%u, drop_full=%u, drop_big=%u, send_err=%u, file=%s", s_cap.stat.records,
+            s_cap.stat.bytes, s_cap.stat.drop_full, s_cap.stat.drop_big, s_cap.stat.send_err,
+            s_cap.file ? "on" : "off");
     PR_INFO("========================");
 }
 
+/**
+ * @brief record every monitored frame to a capture file
+ */
+OPERATE_RET tuya_ai_monitor_capture_start(const char *path)
+{
+    ai_monitor_cap_file_head_t head = {0};
+    TUYA_FILE file = NULL;
+
+    if (!path) {
+        return OPRT_INVALID_PARM;
+    }
+    if (!s_cap.mutex) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    file = tal_fopen(path, "w");
+    if (!file) {
+        PR_ERR("open capture file %s failed", path);
+        return OPRT_FILE_OPEN_FAILED;
+    }
+    memcpy(head.magic, AI_MONITOR_CAP_FILE_MAGIC, sizeof(head.magic));
+    head.version = AI_MONITOR_CAP_FILE_VERSION;
+    head.rec_len = sizeof(ai_monitor_cap_rec_t);
+    if (tal_fwrite(&head, sizeof(head), file) != sizeof(head)) {
+        tal_fclose(file);
+        return OPRT_FILE_WRITE_FAILED;
+    }
+
+    tuya_ai_monitor_capture_stop();
+    tal_mutex_lock(s_cap.mutex);
+    s_cap.file = file;
+    tal_mutex_unlock(s_cap.mutex);
+    PR_INFO("AI monitor capture to %s", path);
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief stop recording the capture file
+ */
+void tuya_ai_monitor_capture_stop(void)
+{
+    TUYA_FILE file = NULL;
+
+    if (!s_cap.mutex) {
+        return;
+    }
+
+    tal_mutex_lock(s_cap.mutex);
+    file = s_cap.file;
+    s_cap.file = NULL;
+    tal_mutex_unlock(s_cap.mutex);
+
+    if (file) {
+        tal_fclose(file);
+    }
+}
+
+/**
+ * @brief get the capture queue counters
+ */
+OPERATE_RET tuya_ai_monitor_get_cap_stat(ai_monitor_cap_stat_t *stat)
+{
+    if (!stat) {
+        return OPRT_INVALID_PARM;
+    }
+
+    memcpy(stat, &s_cap.stat, sizeof(ai_monitor_cap_stat_t));
+
+    return OPRT_OK;
+}
+
+static void __latency_hist_add(ai_monitor_hist_t *hist, uint32_t ms)
+{
+    uint32_t idx = 0;
+
+    while (idx < CNTSOF(sc_latency_bound_ms) && ms >= sc_latency_bound_ms[idx]) {
+        idx++;
+    }
+    hist->bucket[idx]++;
+    hist->count++;
+    hist->sum_ms += ms;
+    if (ms > hist->max_ms) {
+        hist->max_ms = ms;
+    }
+}
+
+/**
+ * @brief mark that the current chat turn reached a pipeline stage
+ */
+void tuya_ai_monitor_stage_mark(AI_MONITOR_STAGE_E stage)
+{
+    if (stage >= AI_MONITOR_STAGE_MAX) {
+        return;
+    }
+    tal_trace_mark(sc_latency_stage_name[stage]);
+
+    SYS_TIME_T now = tal_system_get_millisecond();
+    uint32_t total_ms = 0;
+    if (now == 0) {
+        now = 1; // 0 means not reached
+    }
+
+    TAL_ENTER_CRITICAL();
+    if (stage == AI_MONITOR_STAGE_VAD_START) {
+        memset(s_latency.ts, 0, SIZEOF(s_latency.ts));
+        s_latency.ts[stage] = now;
+    } else if (s_latency.ts[AI_MONITOR_STAGE_VAD_START] != 0 && s_latency.ts[stage] == 0) {
+        s_latency.ts[stage] = now;
+        for (int prev = stage - 1; prev >= 0; prev--) {
+            if (s_latency.ts[prev] != 0) {
+                __latency_hist_add(&s_latency.hist[stage], (uint32_t)(now - s_latency.ts[prev]));
+                break;
+            }
+        }
+        if (stage == AI_MONITOR_STAGE_PLAY && s_latency.ts[AI_MONITOR_STAGE_VAD_STOP] != 0) {
+            total_ms = (uint32_t)(now - s_latency.ts[AI_MONITOR_STAGE_VAD_STOP]);
+            __latency_hist_add(&s_latency.total, total_ms);
+        }
+    }
+    TAL_EXIT_CRITICAL();
+
+    if (total_ms) {
+        tuya_health_metric_sample(HEALTH_METRIC_AI_LATENCY, total_ms);
+    }
+}
+
+/**
+ * @brief clear all stage latency histograms
+ */
+void tuya_ai_monitor_latency_reset(void)
+{
+    TAL_ENTER_CRITICAL();
+    memset(&s_latency, 0, SIZEOF(s_latency));
+    TAL_EXIT_CRITICAL();
+}
+
+static void __latency_snapshot(ai_monitor_latency_t *snap)
+{
+    TAL_ENTER_CRITICAL();
+    memcpy(snap, &s_latency, SIZEOF(ai_monitor_latency_t));
+    TAL_EXIT_CRITICAL();
+}
+
+static int __latency_hist_json(char *buf, uint32_t len, const char *name, ai_monitor_hist_t *hist)
+{
+    int off = snprintf(buf, len, "{\"name\":\"%s\",\"count\":%u,\"avg\":%u,\"max\":%u,\"hist\":[", name,
+                       hist->count, hist->count ? hist->sum_ms / hist->count : 0, hist->max_ms);
+    for (uint32_t i = 0; i < AI_MONITOR_LAT_BUCKET_NUM && off < (int)len; i++) {
+        off += snprintf(buf + off, len - off, "%s%u", i ? "," : "", hist->bucket[i]);
+    }
+    if (off < (int)len) {
+        off += snprintf(buf + off, len - off, "]}");
+    }
+    return off;
+}
+
+/**
+ * @brief send stage latency histograms to one client as json text
+ */
+static OPERATE_RET __latency_send(ai_monitor_client_t *client)
+{
+    ai_monitor_latency_t snap;
+    uint32_t len = AI_MONITOR_LAT_TEXT_LEN;
+    int off = 0;
+
+    char *buf = OS_MALLOC(len);
+    if (!buf) {
+        return OPRT_MALLOC_FAILED;
+    }
+
+    __latency_snapshot(&snap);
+    off = snprintf(buf, len, "{\"type\":\"latency\",\"bucket_ms\":[");
+    for (uint32_t i = 0; i < CNTSOF(sc_latency_bound_ms); i++) {
+        off += snprintf(buf + off, len - off, "%s%u", i ? "," : "", sc_latency_bound_ms[i]);
+    }
+    off += snprintf(buf + off, len - off, "],\"stages\":[");
+    for (uint32_t i = AI_MONITOR_STAGE_VAD_START + 1; i < AI_MONITOR_STAGE_MAX && off < (int)len; i++) {
+        off += __latency_hist_json(buf + off, len - off, sc_latency_stage_name[i], &snap.hist[i]);
+        if (off < (int)len) {
+            buf[off++] = ',';
+        }
+    }
+    if (off < (int)len) {
+        off += __latency_hist_json(buf + off, len - off, "total", &snap.total);
+    }
+    if (off < (int)len) {
+        off += snprintf(buf + off, len - off, "]}");
+    }
+    if (off >= (int)len) {
+        PR_ERR("latency text truncated");
+        OS_FREE(buf);
+        return OPRT_BUFFER_NOT_ENOUGH;
+    }
+
+    AI_BIZ_ATTR_INFO_T attr = {
+        .flag = AI_HAS_ATTR,
+        .type = AI_PT_TEXT,
+        .value.text =
+            {
+                .session_id_list = NULL,
+            },
+    };
+
+    AI_BIZ_HEAD_INFO_T head = {
+        .stream_flag = AI_STREAM_START | AI_STREAM_END,
+        .total_len = off,
+        .len = off,
+    };
+
+    OPERATE_RET rt = __pack_and_send(client, AI_MONITOR_DIR_ACK, TY_AI_MONITOR_US_LAT, &attr, &head, buf);
+    OS_FREE(buf);
+    return rt;
+}
+
+static void __latency_print(void (*out)(char *line))
+{
+    ai_monitor_latency_t snap;
+    char line[160];
+    int off = 0;
+
+    __latency_snapshot(&snap);
+    off = snprintf(line, SIZEOF(line), "bucket(ms):");
+    for (uint32_t i = 0; i < CNTSOF(sc_latency_bound_ms); i++) {
+        off += snprintf(line + off, SIZEOF(line) - off, " <%u", sc_latency_bound_ms[i]);
+    }
+    snprintf(line + off, SIZEOF(line) - off, " >=%u", sc_latency_bound_ms[CNTSOF(sc_latency_bound_ms) - 1]);
+    out(line);
+
+    for (uint32_t i = AI_MONITOR_STAGE_VAD_START + 1; i <= AI_MONITOR_STAGE_MAX; i++) {
+        ai_monitor_hist_t *hist = (i == AI_MONITOR_STAGE_MAX) ? &snap.total : &snap.hist[i];
+        const char *name = (i == AI_MONITOR_STAGE_MAX) ? "total" : sc_latency_stage_name[i];
+
+        off = snprintf(line, SIZEOF(line), "%-9s n=%u avg=%u max=%u |", name, hist->count,
+                       hist->count ? hist->sum_ms / hist->count : 0, hist->max_ms);
+        for (uint32_t j = 0; j < AI_MONITOR_LAT_BUCKET_NUM && off < (int)SIZEOF(line); j++) {
+            off += snprintf(line + off, SIZEOF(line) - off, " %u", hist->bucket[j]);
+        }
+        out(line);
+    }
+}
+
+static void __latency_log_line(char *line)
+{
+    PR_INFO("%s", line);
+}
+
+/**
+ * @brief dump stage latency histograms to the log
+ */
+void tuya_ai_monitor_latency_dump(void)
+{
+    PR_INFO("=== AI Stage Latency ===");
+    __latency_print(__latency_log_line);
+    PR_INFO("========================");
+}
+
+static void __cli_latency(int argc, char *argv[])
+{
+    if (argc > 1 && strcmp(argv[1], "reset") == 0) {
+        tuya_ai_monitor_latency_reset();
+        tal_cli_echo("ai latency reset");
+        return;
+    }
+
+    __latency_print(tal_cli_echo);
+}
+
+static void __cli_capture(int argc, char *argv[])
+{
+    char line[128];
+
+    if (argc > 2 && strcmp(argv[1], "start") == 0) {
+        OPERATE_RET rt = tuya_ai_monitor_capture_start(argv[2]);
+        snprintf(line, sizeof(line), "capture to %s: %d", argv[2], rt);
+        tal_cli_echo(line);
+        return;
+    }
+    if (argc > 1 && strcmp(argv[1], "stop") == 0) {
+        tuya_ai_monitor_capture_stop();
+        tal_cli_echo("capture stopped");
+        return;
+    }
+
+    snprintf(line, sizeof(line), "records %u, bytes %u, drop full %u, drop big %u, send err %u, file err %u, file %s",
+             s_cap.stat.records, s_cap.stat.bytes, s_cap.stat.drop_full, s_cap.stat.drop_big, s_cap.stat.send_err,
+             s_cap.stat.file_err, s_cap.file ? "on" : "off");
+    tal_cli_echo(line);
+}
+
 static OPERATE_RET __default_update(AI_STAGE_E stage, void *data, AI_SEND_PACKET_T *info)
 {
     ai_monitor_writer_cfg_t *cfg = (ai_monitor_writer_cfg_t *)info->writer->user_data;
@@ -1218,28 +1850,7 @@ static OPERATE_RET __default_write(AI_PACKET_WRITER_T *writer, void *buf, uint32
         return OPRT_INVALID_PARM;
     }
 
-    OPERATE_RET rt = OPRT_OK;
-    uint32_t total_sent = 0;
-    uint32_t remaining = buf_len;
-
-    while (remaining > 0) {
-        rt = tal_net_send(cfg->fd, (char *)buf + total_sent, remaining);
-        if (rt <= 0) {
-            TUYA_ERRNO err = tal_net_get_errno();
-            // FIXME: some platforms may return different error codes
-            if (err == UNW_EAGAIN || err == UNW_EWOULDBLOCK || err == 11) {
-                // Non-blocking mode, retry
-                tal_system_sleep(50); // Sleep for a short time before retrying
-                continue;
-            }
-            PR_ERR("send data failed, rt=%d, errno=%d", rt, err);
-            return OPRT_COM_ERROR;
-        }
-        total_sent += rt;
-        remaining -= rt;
-    }
-
-    return OPRT_OK;
+    return __send_all(cfg->fd, buf, buf_len);
 }
 
 #if 0
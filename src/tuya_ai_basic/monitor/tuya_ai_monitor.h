@@ -22,6 +22,7 @@ extern "C" {
 
 #define AI_EVENT_MONITOR_FILTER   0xF000 // Filter for AI event monitor type filtering
 #define AI_EVENT_MONITOR_ALG_CTRL 0xF001 // Filter for AI event monitor algorithm control
+#define AI_EVENT_MONITOR_LATENCY  0xF002 // Request stage latency histograms, user data 1 also resets them
 #define AI_EVENT_MONITOR_INVALID  0xFFFF // Invalid event monitor type
 
 /**
@@ -39,6 +40,19 @@ typedef enum {
     AI_MSG_TYPE_ERROR = 0xFF       // error message
 } ai_monitor_msg_type_e;
 
+/**
+ * @brief AI pipeline stages, in the order they occur in one chat turn
+ */
+typedef uint8_t AI_MONITOR_STAGE_E;
+#define AI_MONITOR_STAGE_VAD_START 0 // valid voice detected, starts a new turn
+#define AI_MONITOR_STAGE_UPLINK    1 // first uplink audio packet
+#define AI_MONITOR_STAGE_VAD_STOP  2 // valid voice end
+#define AI_MONITOR_STAGE_ASR       3 // final ASR text received
+#define AI_MONITOR_STAGE_NLG       4 // first NLG token received
+#define AI_MONITOR_STAGE_TTS       5 // first TTS audio packet received
+#define AI_MONITOR_STAGE_PLAY      6 // playback started
+#define AI_MONITOR_STAGE_MAX       7
+
 /**
  * @brief AI monitor server configuration
  */
@@ -52,6 +66,18 @@ typedef struct {
     uint8_t enable_broadcast;    // enable broadcast to all clients
 } ai_monitor_config_t;
 
+/**
+ * @brief AI monitor capture queue counters
+ */
+typedef struct {
+    uint32_t records;   // frames queued for the clients and the capture file
+    uint32_t bytes;     // bytes of those frames
+    uint32_t drop_full; // frames dropped because the queue was full
+    uint32_t drop_big;  // frames dropped because they could not be packed
+    uint32_t send_err;  // failed sends to a client
+    uint32_t file_err;  // failed writes to the capture file
+} ai_monitor_cap_stat_t;
+
 #define AI_MONITOR_PORT_DEFAULT        5055
 #define AI_MONITOR_MAX_CLIENTS_DEFAULT 3
 #define AI_MONITOR_CFG_DEFAULT                                                                                         \
@@ -146,6 +172,57 @@ OPERATE_RET tuya_ai_monitor_broadcast_audio_aec(AI_STREAM_TYPE stype, char *data
  */
 void tuya_ai_monitor_dump_status(void);
 
+/**
+ * @brief record every monitored frame to a capture file
+ *
+ * The file holds a header and per frame a timestamp, direction, type, id and
+ * the frame as it is sent to the clients, tools/ai_monitor/ai_mon_cap.py lists
+ * and replays it. Recording runs until tuya_ai_monitor_capture_stop().
+ *
+ * @param[in] path file path
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+OPERATE_RET tuya_ai_monitor_capture_start(const char *path);
+
+/**
+ * @brief stop recording the capture file
+ *
+ */
+void tuya_ai_monitor_capture_stop(void);
+
+/**
+ * @brief get the capture queue counters
+ *
+ * @param[out] stat counters
+ *
+ * @return OPRT_OK on success. Others on error, please refer to tuya_error_code.h
+ */
+OPERATE_RET tuya_ai_monitor_get_cap_stat(ai_monitor_cap_stat_t *stat);
+
+/**
+ * @brief mark that the current chat turn reached a pipeline stage
+ *
+ * Only the first mark of each stage per turn is recorded, the delay from the
+ * previous reached stage is added to that stage's latency histogram.
+ * AI_MONITOR_STAGE_VAD_START starts a new turn.
+ *
+ * @param[in] stage pipeline stage, see AI_MONITOR_STAGE_E
+ */
+void tuya_ai_monitor_stage_mark(AI_MONITOR_STAGE_E stage);
+
+/**
+ * @brief clear all stage latency histograms
+ *
+ */
+void tuya_ai_monitor_latency_reset(void);
+
+/**
+ * @brief dump stage latency histograms to the log
+ *
+ */
+void tuya_ai_monitor_latency_dump(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -25,6 +25,7 @@
 #include "tal_system.h"
 #include "tal_thread.h"
 #include "tal_mutex.h"
+#include "tal_semaphore.h"
 #include "uni_random.h"
 #include "tal_log.h"
 #include "tal_memory.h"
@@ -40,10 +41,16 @@
 #ifndef AI_BIZ_TASK_DELAY
 #define AI_BIZ_TASK_DELAY 10
 #endif
+// bulk packets are cut into slices of this size so realtime channels get a turn in between
+#ifndef AI_BIZ_BULK_SLICE_LEN
+#define AI_BIZ_BULK_SLICE_LEN (4 * 1024)
+#endif
 
 typedef struct {
     char id[AI_UUID_V4_LEN];
     AI_SESSION_CFG_T cfg;
+    uint8_t notify[AI_MAX_SESSION_ID_NUM];           // channel signals data by tuya_ai_biz_send_notify
+    volatile uint8_t pending[AI_MAX_SESSION_ID_NUM]; // channel has data waiting to be sent
 } AI_SESSION_T;
 
 typedef struct {
@@ -52,11 +59,26 @@ typedef struct {
     void *usr_data;
 } AI_BASIC_BIZ_MONITOR_T;
 
+typedef struct {
+    uint8_t active;
+    uint8_t session_idx;
+    uint8_t sidx;
+    uint16_t id;
+    AI_PACKET_PT type;
+    AI_BIZ_SEND_FREE_CB free_cb;
+    AI_BIZ_ATTR_INFO_T attr;
+    AI_BIZ_HEAD_INFO_T head;
+    char *payload;
+    uint32_t offset;
+} AI_BIZ_BULK_T;
+
 typedef struct {
     THREAD_HANDLE thread;
     BOOL_T terminate;
     MUTEX_HANDLE mutex;
+    SEM_HANDLE send_sem;
     AI_SESSION_T session[AI_SESSION_MAX_NUM];
+    AI_BIZ_BULK_T bulk; // bulk packet being sent slice by slice
     AI_BIZ_RECV_CB cb;
     AI_BASIC_BIZ_MONITOR_T *monitor;
 } AI_BASIC_BIZ_T;
@@ -64,6 +86,7 @@ typedef struct {
 AI_BASIC_BIZ_MONITOR_T ai_monitor;
 
 AI_BASIC_BIZ_T *ai_basic_biz;
+TAL_THREAD_DEFINE_STATIC(s_ai_biz_thread);
 
 OPERATE_RET tuya_ai_send_biz_pkt(uint16_t id, AI_BIZ_ATTR_INFO_T *attr, AI_PACKET_PT type, AI_BIZ_HEAD_INFO_T *head,
                                  char *payload)
@@ -98,7 +121,8 @@ OPERATE_RET tuya_ai_send_biz_pkt_custom(uint16_t id, AI_BIZ_ATTR_INFO_T *attr, A
                                         AI_BIZ_HEAD_INFO_T *head, char *payload, AI_PACKET_WRITER_T *writer)
 {
     OPERATE_RET rt = OPRT_OK;
-    uint32_t payload_len = 0, total_len = 0;
+    uint32_t payload_len = 0, total_len = 0, seg_num = 0;
+    AI_PACKET_SEG_T segs[2];
     if (ai_basic_biz == NULL) {
         PR_ERR("ai biz is null");
         return OPRT_COM_ERROR;
@@ -109,110 +133,85 @@ OPERATE_RET tuya_ai_send_biz_pkt_custom(uint16_t id, AI_BIZ_ATTR_INFO_T *attr, A
     AI_PROTO_D("biz len:%d, total len:%d", head->len, head->total_len);
     tuya_ai_client_start_ping();
     if (type == AI_PT_VIDEO) {
-        payload_len = SIZEOF(AI_VIDEO_HEAD_T) + head->len;
         total_len = SIZEOF(AI_VIDEO_HEAD_T) + head->total_len;
-        char *video = OS_MALLOC(payload_len);
-        TUYA_CHECK_NULL_RETURN(video, OPRT_MALLOC_FAILED);
-        memset(video, 0, payload_len);
-        AI_VIDEO_HEAD_T *video_head = (AI_VIDEO_HEAD_T *)video;
-        video_head->id = UNI_HTONS(id);
-        video_head->stream_flag = head->stream_flag;
-        video_head->timestamp = head->value.video.timestamp;
-        video_head->pts = head->value.video.pts;
-        UNI_HTONLL(video_head->timestamp);
-        UNI_HTONLL(video_head->pts);
-        video_head->length = UNI_HTONL(head->total_len);
+        AI_VIDEO_HEAD_T video_head = {0};
+        video_head.id = UNI_HTONS(id);
+        video_head.stream_flag = head->stream_flag;
+        video_head.timestamp = head->value.video.timestamp;
+        video_head.pts = head->value.video.pts;
+        UNI_HTONLL(video_head.timestamp);
+        UNI_HTONLL(video_head.pts);
+        video_head.length = UNI_HTONL(head->total_len);
+        segs[seg_num].buf = &video_head;
+        segs[seg_num++].len = SIZEOF(AI_VIDEO_HEAD_T);
         if (payload && head->len) {
-            memcpy(video + SIZEOF(AI_VIDEO_HEAD_T), payload, head->len);
+            segs[seg_num].buf = payload;
+            segs[seg_num++].len = head->len;
         }
-        if (attr && (attr->flag == AI_HAS_ATTR)) {
-            rt = tuya_ai_basic_video(&(attr->value.video), video, payload_len, total_len, writer);
-        } else {
-            rt = tuya_ai_basic_video(NULL, video, payload_len, total_len, writer);
-        }
-        OS_FREE(video);
+        rt = tuya_ai_basic_segs(type, (attr && (attr->flag == AI_HAS_ATTR)) ? &(attr->value.video) : NULL, segs,
+                                seg_num, total_len, writer);
     } else if (type == AI_PT_AUDIO) {
-        payload_len = SIZEOF(AI_AUDIO_HEAD_T) + head->len;
         total_len = SIZEOF(AI_AUDIO_HEAD_T) + head->total_len;
-        char *audio = OS_MALLOC(payload_len);
-        TUYA_CHECK_NULL_RETURN(audio, OPRT_MALLOC_FAILED);
-        memset(audio, 0, payload_len);
-        AI_AUDIO_HEAD_T *audio_head = (AI_AUDIO_HEAD_T *)audio;
-        audio_head->id = UNI_HTONS(id);
-        audio_head->stream_flag = head->stream_flag;
-        audio_head->timestamp = head->value.audio.timestamp;
-        audio_head->pts = head->value.audio.pts;
-        UNI_HTONLL(audio_head->timestamp);
-        UNI_HTONLL(audio_head->pts);
-        audio_head->length = UNI_HTONL(head->total_len);
+        AI_AUDIO_HEAD_T audio_head = {0};
+        audio_head.id = UNI_HTONS(id);
+        audio_head.stream_flag = head->stream_flag;
+        audio_head.timestamp = head->value.audio.timestamp;
+        audio_head.pts = head->value.audio.pts;
+        UNI_HTONLL(audio_head.timestamp);
+        UNI_HTONLL(audio_head.pts);
+        audio_head.length = UNI_HTONL(head->total_len);
+        segs[seg_num].buf = &audio_head;
+        segs[seg_num++].len = SIZEOF(AI_AUDIO_HEAD_T);
         if (payload && head->len) {
-            memcpy(audio + SIZEOF(AI_AUDIO_HEAD_T), payload, head->len);
-        }
-        if (attr && (attr->flag == AI_HAS_ATTR)) {
-            rt = tuya_ai_basic_audio(&(attr->value.audio), audio, payload_len, total_len, writer);
-        } else {
-            rt = tuya_ai_basic_audio(NULL, audio, payload_len, total_len, writer);
+            segs[seg_num].buf = payload;
+            segs[seg_num++].len = head->len;
         }
-        OS_FREE(audio);
+        rt = tuya_ai_basic_segs(type, (attr && (attr->flag == AI_HAS_ATTR)) ? &(attr->value.audio) : NULL, segs,
+                                seg_num, total_len, writer);
     } else if (type == AI_PT_IMAGE) {
-        payload_len = SIZEOF(AI_IMAGE_HEAD_T) + head->len;
         total_len = SIZEOF(AI_IMAGE_HEAD_T) + head->total_len;
-        char *image = OS_MALLOC(payload_len);
-        TUYA_CHECK_NULL_RETURN(image, OPRT_MALLOC_FAILED);
-        memset(image, 0, payload_len);
-        AI_IMAGE_HEAD_T *image_head = (AI_IMAGE_HEAD_T *)image;
-        image_head->id = UNI_HTONS(id);
-        image_head->stream_flag = head->stream_flag;
-        image_head->timestamp = head->value.image.timestamp;
-        UNI_HTONLL(image_head->timestamp);
-        image_head->length = UNI_HTONL(head->total_len);
+        AI_IMAGE_HEAD_T image_head = {0};
+        image_head.id = UNI_HTONS(id);
+        image_head.stream_flag = head->stream_flag;
+        image_head.timestamp = head->value.image.timestamp;
+        UNI_HTONLL(image_head.timestamp);
+        image_head.length = UNI_HTONL(head->total_len);
+        segs[seg_num].buf = &image_head;
+        segs[seg_num++].len = SIZEOF(AI_IMAGE_HEAD_T);
         if (payload && head->len) {
-            memcpy(image + SIZEOF(AI_IMAGE_HEAD_T), payload, head->len);
+            segs[seg_num].buf = payload;
+            segs[seg_num++].len = head->len;
         }
-        if (attr && (attr->flag == AI_HAS_ATTR)) {
-            rt = tuya_ai_basic_image(&(attr->value.image), image, payload_len, total_len, writer);
-        } else {
-            rt = tuya_ai_basic_image(NULL, image, payload_len, total_len, writer);
-        }
-        OS_FREE(image);
+        rt = tuya_ai_basic_segs(type, (attr && (attr->flag == AI_HAS_ATTR)) ? &(attr->value.image) : NULL, segs,
+                                seg_num, total_len, writer);
     } else if (type == AI_PT_FILE) {
-        payload_len = SIZEOF(AI_FILE_HEAD_T) + head->len;
         total_len = SIZEOF(AI_FILE_HEAD_T) + head->total_len;
-        char *file = OS_MALLOC(payload_len);
-        TUYA_CHECK_NULL_RETURN(file, OPRT_MALLOC_FAILED);
-        memset(file, 0, payload_len);
-        AI_FILE_HEAD_T *file_head = (AI_FILE_HEAD_T *)file;
-        file_head->id = UNI_HTONS(id);
-        file_head->stream_flag = head->stream_flag;
-        file_head->length = UNI_HTONL(head->total_len);
+        AI_FILE_HEAD_T file_head = {0};
+        file_head.id = UNI_HTONS(id);
+        file_head.stream_flag = head->stream_flag;
+        file_head.length = UNI_HTONL(head->total_len);
+        segs[seg_num].buf = &file_head;
+        segs[seg_num++].len = SIZEOF(AI_FILE_HEAD_T);
         if (payload && head->len) {
-            memcpy(file + SIZEOF(AI_FILE_HEAD_T), payload, head->len);
-        }
-        if (attr && (attr->flag == AI_HAS_ATTR)) {
-            rt = tuya_ai_basic_file(&(attr->value.file), file, payload_len, total_len, writer);
-        } else {
-            rt = tuya_ai_basic_file(NULL, file, payload_len, total_len, writer);
+            segs[seg_num].buf = payload;
+            segs[seg_num++].len = head->len;
         }
-        OS_FREE(file);
+        rt = tuya_ai_basic_segs(type, (attr && (attr->flag == AI_HAS_ATTR)) ? &(attr->value.file) : NULL, segs,
+                                seg_num, total_len, writer);
     } else if (type == AI_PT_TEXT) {
-        payload_len = SIZEOF(AI_TEXT_HEAD_T) + head->len;
         total_len = SIZEOF(AI_TEXT_HEAD_T) + head->total_len;
-        char *text = OS_MALLOC(payload_len);
-        TUYA_CHECK_NULL_RETURN(text, OPRT_MALLOC_FAILED);
-        memset(text, 0, payload_len);
-        AI_TEXT_HEAD_T *text_head = (AI_TEXT_HEAD_T *)text;
-        text_head->id = UNI_HTONS(id);
-        text_head->stream_flag = head->stream_flag;
-        text_head->length = UNI_HTONL(head->total_len);
+        AI_TEXT_HEAD_T text_head = {0};
+        text_head.id = UNI_HTONS(id);
+        text_head.stream_flag = head->stream_flag;
+        text_head.length = UNI_HTONL(head->total_len);
+        segs[seg_num].buf = &text_head;
+        segs[seg_num++].len = SIZEOF(AI_TEXT_HEAD_T);
         if (payload && head->len) {
-            memcpy(text + SIZEOF(AI_TEXT_HEAD_T), payload, head->len);
+            segs[seg_num].buf = payload;
+            segs[seg_num++].len = head->len;
         }
-        if (attr && (attr->flag == AI_HAS_ATTR)) {
-            rt = tuya_ai_basic_text(&(attr->value.text), text, payload_len, total_len, writer);
-        } else {
-            rt = tuya_ai_basic_text(NULL, text, payload_len, total_len, writer);
-        }
-        OS_FREE(text);
+        rt = tuya_ai_basic_segs(type, (attr && (attr->flag == AI_HAS_ATTR)) ? &(attr->value.text) : NULL, segs,
+                                seg_num, total_len, writer);
     } else if (type == AI_PT_EVENT) {
         payload_len = SIZEOF(AI_EVENT_HEAD_T) + head->len;
         total_len = SIZEOF(AI_EVENT_HEAD_T) + head->total_len;
@@ -242,52 +241,199 @@ OPERATE_RET tuya_ai_send_biz_pkt_custom(uint16_t id, AI_BIZ_ATTR_INFO_T *attr, A
     return rt;
 }
 
-static void __ai_biz_thread_cb(void *args)
+static AI_BIZ_SEND_PRIO __ai_biz_get_prio(AI_BIZ_SEND_DATA_T *send)
+{
+    if (send->prio != AI_BIZ_PRIO_AUTO) {
+        return send->prio;
+    }
+    if (send->type == AI_PT_AUDIO) {
+        return AI_BIZ_PRIO_REALTIME;
+    } else if ((send->type == AI_PT_VIDEO) || (send->type == AI_PT_IMAGE) || (send->type == AI_PT_FILE)) {
+        return AI_BIZ_PRIO_BULK;
+    }
+    return AI_BIZ_PRIO_CONTROL;
+}
+
+static uint8_t __ai_biz_get_data(AI_SESSION_T *session, uint32_t sidx, AI_BIZ_ATTR_INFO_T *attr,
+                                 AI_BIZ_HEAD_INFO_T *head, char **payload)
+{
+    if (session->notify[sidx]) {
+        if (!session->pending[sidx]) {
+            return false;
+        }
+        session->pending[sidx] = false;
+    }
+    if (session->cfg.send[sidx].get_cb(attr, head, payload) != OPRT_OK) {
+        return false;
+    }
+    if (session->notify[sidx]) {
+        // more data may be queued, come back after the other channels had their turn
+        session->pending[sidx] = true;
+    }
+    return true;
+}
+
+static uint8_t __ai_biz_send_channel(AI_SESSION_T *session, uint32_t sidx)
+{
+    AI_BIZ_SEND_DATA_T *send = &session->cfg.send[sidx];
+    AI_BIZ_ATTR_INFO_T attr = {0};
+    AI_BIZ_HEAD_INFO_T head = {0};
+    char *payload = NULL;
+
+    if (!__ai_biz_get_data(session, sidx, &attr, &head, &payload)) {
+        return false;
+    }
+    tuya_ai_send_biz_pkt(send->id, &attr, send->type, &head, payload);
+    if (send->free_cb) {
+        send->free_cb(payload);
+    }
+    return session->notify[sidx];
+}
+
+static void __ai_biz_bulk_done(void)
+{
+    AI_BIZ_BULK_T *bulk = &ai_basic_biz->bulk;
+    if (bulk->active && bulk->free_cb) {
+        bulk->free_cb(bulk->payload);
+    }
+    memset(bulk, 0, sizeof(AI_BIZ_BULK_T));
+}
+
+static uint8_t __ai_biz_bulk_slice(void)
 {
     OPERATE_RET rt = OPRT_OK;
+    AI_BIZ_BULK_T *bulk = &ai_basic_biz->bulk;
+    AI_SESSION_T *session = &ai_basic_biz->session[bulk->session_idx];
+
+    // the session may have been closed between two slices
+    if ((session->id[0] == 0) || (session->cfg.send[bulk->sidx].id != bulk->id)) {
+        PR_NOTICE("bulk send aborted, id:%d", bulk->id);
+        __ai_biz_bulk_done();
+        return false;
+    }
+
+    AI_BIZ_HEAD_INFO_T head = bulk->head;
+    uint32_t left = bulk->head.len - bulk->offset;
+    head.len = (left > AI_BIZ_BULK_SLICE_LEN) ? AI_BIZ_BULK_SLICE_LEN : left;
+    rt = tuya_ai_send_biz_pkt(bulk->id, &bulk->attr, bulk->type, &head, bulk->payload + bulk->offset);
+    bulk->offset += head.len;
+    if ((rt != OPRT_OK) || (bulk->offset >= bulk->head.len)) {
+        __ai_biz_bulk_done();
+        return false;
+    }
+    return true;
+}
+
+static uint8_t __ai_biz_send_bulk(void)
+{
+    uint32_t idx = 0, sidx = 0;
+    AI_BIZ_BULK_T *bulk = &ai_basic_biz->bulk;
+
+    if (bulk->active) {
+        // one more pass after the last slice, the channel may have queued more
+        __ai_biz_bulk_slice();
+        return true;
+    }
+    for (idx = 0; idx < AI_SESSION_MAX_NUM; idx++) {
+        AI_SESSION_T *session = &ai_basic_biz->session[idx];
+        if (session->id[0] == 0) {
+            continue;
+        }
+        for (sidx = 0; sidx < session->cfg.send_num; sidx++) {
+            AI_BIZ_SEND_DATA_T *send = &session->cfg.send[sidx];
+            if (!send->get_cb || (__ai_biz_get_prio(send) != AI_BIZ_PRIO_BULK)) {
+                continue;
+            }
+            if (!__ai_biz_get_data(session, sidx, &bulk->attr, &bulk->head, &bulk->payload)) {
+                continue;
+            }
+            bulk->active = true;
+            bulk->session_idx = idx;
+            bulk->sidx = sidx;
+            bulk->id = send->id;
+            bulk->type = send->type;
+            bulk->free_cb = send->free_cb;
+            if (bulk->head.total_len == 0) {
+                bulk->head.total_len = bulk->head.len;
+            }
+            __ai_biz_bulk_slice();
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint8_t __ai_biz_send_class(AI_BIZ_SEND_PRIO prio)
+{
     uint32_t idx = 0, sidx = 0, kdx = 0;
+    uint8_t busy = false;
+    uint16_t sent_ids[AI_MAX_SESSION_ID_NUM * AI_SESSION_MAX_NUM] = {0};
+    uint32_t sent_ids_count = 0;
+
+    for (idx = 0; idx < AI_SESSION_MAX_NUM; idx++) {
+        if (ai_basic_biz->session[idx].id[0] != 0) {
+            AI_SESSION_T *session = &ai_basic_biz->session[idx];
+            for (sidx = 0; sidx < session->cfg.send_num; sidx++) {
+                if (!session->cfg.send[sidx].get_cb || (__ai_biz_get_prio(&session->cfg.send[sidx]) != prio)) {
+                    continue;
+                }
+                uint16_t send_id = session->cfg.send[sidx].id;
+                uint8_t already_sent = false;
+                for (kdx = 0; kdx < sent_ids_count; kdx++) {
+                    if (sent_ids[kdx] == send_id) {
+                        already_sent = true;
+                        break;
+                    }
+                }
+                if (!already_sent) {
+                    sent_ids[sent_ids_count++] = send_id;
+                    busy |= __ai_biz_send_channel(session, sidx);
+                }
+            }
+        }
+    }
+    return busy;
+}
+
+static uint32_t __ai_biz_send_timeout(void)
+{
+    uint32_t idx = 0, sidx = 0;
+    for (idx = 0; idx < AI_SESSION_MAX_NUM; idx++) {
+        if (ai_basic_biz->session[idx].id[0] != 0) {
+            AI_SESSION_T *session = &ai_basic_biz->session[idx];
+            for (sidx = 0; sidx < session->cfg.send_num; sidx++) {
+                if (session->cfg.send[sidx].get_cb && !session->notify[sidx]) {
+                    return AI_BIZ_TASK_DELAY;
+                }
+            }
+        }
+    }
+    return SEM_WAIT_FOREVER;
+}
+
+static void __ai_biz_thread_cb(void *args)
+{
+    uint32_t timeout = AI_BIZ_TASK_DELAY;
+    uint8_t busy = false;
     while (!ai_basic_biz->terminate && tal_thread_get_state(ai_basic_biz->thread) == THREAD_STATE_RUNNING) {
         if (!tuya_ai_client_is_ready()) {
-            tal_system_sleep(200);
+            tal_semaphore_wait(ai_basic_biz->send_sem, 200);
+            busy = true; // scan once notifies consumed while not ready
             continue;
         }
-        tal_mutex_lock(ai_basic_biz->mutex);
-        uint16_t sent_ids[AI_MAX_SESSION_ID_NUM * AI_SESSION_MAX_NUM] = {0};
-        uint32_t sent_ids_count = 0;
-        for (idx = 0; idx < AI_SESSION_MAX_NUM; idx++) {
-            if (ai_basic_biz->session[idx].id[0] != 0) {
-                AI_SESSION_T *session = &ai_basic_biz->session[idx];
-                for (sidx = 0; sidx < session->cfg.send_num; sidx++) {
-                    uint16_t send_id = session->cfg.send[sidx].id;
-                    uint8_t already_sent = false;
-                    for (kdx = 0; kdx < sent_ids_count; kdx++) {
-                        if (sent_ids[kdx] == send_id) {
-                            already_sent = true;
-                            break;
-                        }
-                    }
-                    if (!already_sent) {
-                        sent_ids[sent_ids_count++] = send_id;
-                        AI_BIZ_SEND_DATA_T *send = &session->cfg.send[sidx];
-                        if (send->get_cb) {
-                            AI_BIZ_ATTR_INFO_T attr = {0};
-                            AI_BIZ_HEAD_INFO_T head = {0};
-                            char *payload = NULL;
-                            rt = send->get_cb(&attr, &head, &payload);
-                            if (rt != OPRT_OK) {
-                                continue;
-                            }
-                            tuya_ai_send_biz_pkt(send->id, &attr, send->type, &head, payload);
-                            if (send->free_cb) {
-                                send->free_cb(payload);
-                            }
-                        }
-                    }
-                }
+        if (!busy) {
+            tal_semaphore_wait(ai_basic_biz->send_sem, timeout);
+            if (ai_basic_biz->terminate) {
+                break;
             }
         }
+        // realtime first, then control, then at most one bulk slice per pass
+        tal_mutex_lock(ai_basic_biz->mutex);
+        busy = __ai_biz_send_class(AI_BIZ_PRIO_REALTIME);
+        busy |= __ai_biz_send_class(AI_BIZ_PRIO_CONTROL);
+        busy |= __ai_biz_send_bulk();
+        timeout = __ai_biz_send_timeout();
         tal_mutex_unlock(ai_basic_biz->mutex);
-        tal_system_sleep(AI_BIZ_TASK_DELAY);
     }
 
     PR_NOTICE("ai biz thread exit");
@@ -324,7 +470,8 @@ static OPERATE_RET __ai_biz_create_task(void)
     thrd_param.psram_mode = 1;
 #endif
 
-    rt = tal_thread_create_and_start(&ai_basic_biz->thread, NULL, NULL, __ai_biz_thread_cb, NULL, &thrd_param);
+    rt = tal_thread_create_static(&ai_basic_biz->thread, &s_ai_biz_thread, NULL, NULL, __ai_biz_thread_cb, NULL,
+                                  &thrd_param);
     if (OPRT_OK != rt) {
         PR_ERR("ai biz thread create err, rt:%d", rt);
     }
@@ -339,10 +486,15 @@ static void __ai_biz_deinit(void)
             tal_thread_delete(ai_basic_biz->thread);
             ai_basic_biz->thread = NULL;
         }
+        __ai_biz_bulk_done();
         if (ai_basic_biz->mutex) {
             tal_mutex_release(ai_basic_biz->mutex);
             ai_basic_biz->mutex = NULL;
         }
+        if (ai_basic_biz->send_sem) {
+            tal_semaphore_release(ai_basic_biz->send_sem);
+            ai_basic_biz->send_sem = NULL;
+        }
         OS_FREE(ai_basic_biz);
         ai_basic_biz = NULL;
     }
@@ -910,8 +1062,12 @@ static OPERATE_RET __ai_clt_run_evt(void *data)
         memset(ai_basic_biz, 0, sizeof(AI_BASIC_BIZ_T));
         ai_basic_biz->monitor = &ai_monitor;
         TUYA_CALL_ERR_GOTO(tal_mutex_create_init(&ai_basic_biz->mutex), EXIT);
+        tal_mutex_set_name(ai_basic_biz->mutex, "ai biz");
+        TUYA_CALL_ERR_GOTO(tal_semaphore_create_init(&ai_basic_biz->send_sem, 0, 1), EXIT);
         tuya_ai_client_reg_cb(__ai_biz_recv_handle);
         PR_NOTICE("ai biz init success");
+    } else {
+        tal_semaphore_post(ai_basic_biz->send_sem);
     }
     tal_event_publish(EVENT_AI_SESSION_NEW, NULL);
     PR_NOTICE("ai biz publish session new event");
@@ -934,11 +1090,16 @@ void tuya_ai_biz_deinit(void)
     if (ai_basic_biz) {
         if (ai_basic_biz->thread) {
             ai_basic_biz->terminate = TRUE;
+            tal_semaphore_post(ai_basic_biz->send_sem);
         } else {
             if (ai_basic_biz->mutex) {
                 tal_mutex_release(ai_basic_biz->mutex);
                 ai_basic_biz->mutex = NULL;
             }
+            if (ai_basic_biz->send_sem) {
+                tal_semaphore_release(ai_basic_biz->send_sem);
+                ai_basic_biz->send_sem = NULL;
+            }
             OS_FREE(ai_basic_biz);
             ai_basic_biz = NULL;
         }
@@ -1023,6 +1184,7 @@ OPERATE_RET tuya_ai_biz_crt_session(uint32_t bizCode, AI_SESSION_CFG_T *cfg, uin
         __ai_biz_create_task();
     }
     tal_mutex_unlock(ai_basic_biz->mutex);
+    tal_semaphore_post(ai_basic_biz->send_sem);
 
     if (idx == AI_SESSION_MAX_NUM) {
         PR_ERR("session num is full");
@@ -1037,6 +1199,32 @@ OPERATE_RET tuya_ai_biz_del_session(AI_SESSION_ID id, AI_STATUS_CODE code)
     return __ai_biz_session_destory(id, code, true);
 }
 
+OPERATE_RET tuya_ai_biz_send_notify(uint16_t id)
+{
+    uint32_t idx = 0, sidx = 0;
+    if (ai_basic_biz == NULL) {
+        PR_ERR("ai biz is null");
+        return OPRT_COM_ERROR;
+    }
+
+    // flags only, the send task may hold the biz mutex while writing to the network
+    for (idx = 0; idx < AI_SESSION_MAX_NUM; idx++) {
+        AI_SESSION_T *session = &ai_basic_biz->session[idx];
+        if (session->id[0] == 0) {
+            continue;
+        }
+        for (sidx = 0; sidx < session->cfg.send_num; sidx++) {
+            if (session->cfg.send[sidx].id == id) {
+                session->notify[sidx] = true;
+                session->pending[sidx] = true;
+            }
+        }
+    }
+    // a full semaphore already means the task will wake up
+    tal_semaphore_post(ai_basic_biz->send_sem);
+    return OPRT_OK;
+}
+
 int tuya_ai_biz_get_send_id(void)
 {
     static int odd_number = 1;
@@ -10,7 +10,10 @@
  * Key features include:
  * - Configurable reconnection attempts (AI_RECONN_TIME_NUM)
  * - Customizable ping timeout settings (AT_PING_TIMEOUT)
+ * - Adaptive ping interval, skipped while data flows (AI_KEEPALIVE_MAX_S, AI_KEEPALIVE_CELLULAR_S)
  * - Thread stack size configuration (AI_CLIENT_STACK_SIZE)
+ * - Reconnect without atop request while the config is valid (AI_FAST_RECONN_MARGIN)
+ * - Warm standby socket pre-connected on ping loss (AI_CLIENT_WARM_STANDBY)
  * - Secure communication through tal_security integration
  * - Asynchronous task processing via work queue service
  * - Network state management with netmgr integration
@@ -42,6 +45,27 @@
 #define AI_CLIENT_STACK_SIZE 4096
 #endif
 
+// ping interval bounds, the interval stretches by AI_KEEPALIVE_STEP_S after each idle pong
+#ifndef AI_KEEPALIVE_MAX_S
+#define AI_KEEPALIVE_MAX_S 120
+#endif
+#ifndef AI_KEEPALIVE_STEP_S
+#define AI_KEEPALIVE_STEP_S 30
+#endif
+// fixed ping interval on cellular, short enough for carrier NAT timeouts
+#ifndef AI_KEEPALIVE_CELLULAR_S
+#define AI_KEEPALIVE_CELLULAR_S 20
+#endif
+
+// reconnect with the cached atop config while it stays valid for this long
+#ifndef AI_FAST_RECONN_MARGIN
+#define AI_FAST_RECONN_MARGIN 60
+#endif
+// pre-connect a standby socket once a ping is lost
+#ifndef AI_CLIENT_WARM_STANDBY
+#define AI_CLIENT_WARM_STANDBY 1
+#endif
+
 typedef struct {
     uint32_t min;
     uint32_t max;
@@ -66,13 +90,19 @@ typedef struct {
     TIMER_ID tid;
     AI_CLIENT_STATE_E state;
     uint32_t heartbeat_interval;
+    uint32_t keepalive_s;
+    SYS_TIME_T last_recv_ts;
     DELAYED_WORK_HANDLE alive_work;
     TIMER_ID alive_timeout_timer;
     uint8_t heartbeat_lost_cnt;
+    volatile uint8_t standby_req;
     AI_BASIC_DATA_HANDLE cb;
 } AI_BASIC_CLIENT_T;
 
 static AI_BASIC_CLIENT_T *ai_basic_client = NULL;
+TAL_THREAD_DEFINE_STATIC(s_ai_client_thread);
+TAL_SW_TIMER_DEFINE_STATIC(s_ai_conn_timer);
+TAL_SW_TIMER_DEFINE_STATIC(s_ai_alive_timer);
 
 static uint32_t __ai_get_random_value(uint32_t min, uint32_t max)
 {
@@ -85,6 +115,52 @@ static void __ai_client_set_state(AI_CLIENT_STATE_E state)
     ai_basic_client->state = state;
 }
 
+static uint8_t __ai_link_is_cellular(void)
+{
+#if defined(ENABLE_CELLULAR)
+    netmgr_status_e status = NETMGR_LINK_DOWN;
+#if defined(ENABLE_WIFI)
+    netmgr_conn_get(NETCONN_WIFI, NETCONN_CMD_STATUS, &status);
+    if (status == NETMGR_LINK_UP) {
+        return FALSE;
+    }
+#endif
+#if defined(ENABLE_WIRED)
+    netmgr_conn_get(NETCONN_WIRED, NETCONN_CMD_STATUS, &status);
+    if (status == NETMGR_LINK_UP) {
+        return FALSE;
+    }
+#endif
+    netmgr_conn_get(NETCONN_CELLULAR, NETCONN_CMD_STATUS, &status);
+    return (status == NETMGR_LINK_UP);
+#else
+    return FALSE;
+#endif
+}
+
+/**
+ * @brief update the ping interval, reset to the base on loss, stretch after an idle pong
+ */
+static void __ai_keepalive_update(uint8_t stretch)
+{
+    uint32_t base = ai_basic_client->heartbeat_interval;
+    uint32_t max = AI_KEEPALIVE_MAX_S;
+
+    if (__ai_link_is_cellular()) {
+        base = max = AI_KEEPALIVE_CELLULAR_S;
+    }
+
+    if (!stretch || ai_basic_client->keepalive_s < base) {
+        ai_basic_client->keepalive_s = base;
+    } else {
+        ai_basic_client->keepalive_s += AI_KEEPALIVE_STEP_S;
+    }
+    if (ai_basic_client->keepalive_s > max) {
+        ai_basic_client->keepalive_s = max;
+    }
+    AI_PROTO_D("keepalive interval %d s", ai_basic_client->keepalive_s);
+}
+
 static OPERATE_RET __ai_connect()
 {
     OPERATE_RET rt = OPRT_OK;
@@ -131,7 +207,8 @@ static OPERATE_RET __ai_auth_resp(void)
         return rt;
     }
     ai_basic_client->heartbeat_lost_cnt = 0;
-    tal_workq_start_delayed(ai_basic_client->alive_work, (ai_basic_client->heartbeat_interval * 1000), LOOP_ONCE);
+    __ai_keepalive_update(FALSE);
+    tal_workq_start_delayed(ai_basic_client->alive_work, (ai_basic_client->keepalive_s * 1000), LOOP_ONCE);
     __ai_client_set_state(AI_STATE_RUNNING);
     tal_event_publish(EVENT_AI_CLIENT_RUN, NULL);
     return rt;
@@ -168,6 +245,7 @@ static void __ai_client_handle_err()
             ai_basic_client->reconn_cnt++;
         }
     } else if ((ai_basic_client->state == AI_STATE_CONNECT) || (ai_basic_client->state == AI_STATE_AUTH_RESP)) {
+        tuya_ai_basic_standby_close();
         tal_system_sleep(1000);
         __ai_client_set_state(AI_STATE_SETUP);
     } else if (ai_basic_client->state == AI_STATE_RUNNING) {
@@ -243,7 +321,9 @@ static void __ai_handle_conn_close(char *data, uint32_t len)
 static void __ai_handle_pong(char *data, uint32_t len)
 {
     tuya_ai_pong(data, len);
-    tal_workq_start_delayed(ai_basic_client->alive_work, (ai_basic_client->heartbeat_interval * 1000), LOOP_ONCE);
+    tuya_ai_basic_standby_close();
+    __ai_keepalive_update(TRUE);
+    tal_workq_start_delayed(ai_basic_client->alive_work, (ai_basic_client->keepalive_s * 1000), LOOP_ONCE);
     PR_NOTICE("ai pong");
 }
 
@@ -254,6 +334,13 @@ static OPERATE_RET __ai_running(void)
     uint32_t de_len = 0;
     AI_FRAG_FLAG frag = AI_PACKET_NO_FRAG;
 
+#if defined(AI_CLIENT_WARM_STANDBY) && (AI_CLIENT_WARM_STANDBY == 1)
+    if (ai_basic_client->standby_req) {
+        ai_basic_client->standby_req = FALSE;
+        tuya_ai_basic_standby_connect();
+    }
+#endif
+
     rt = tuya_ai_basic_pkt_read(&de_buf, &de_len, &frag);
     if (OPRT_RESOURCE_NOT_READY == rt) {
         return OPRT_OK;
@@ -262,6 +349,8 @@ static OPERATE_RET __ai_running(void)
         return rt;
     }
     __ai_stop_alive_time();
+    ai_basic_client->last_recv_ts = tal_system_get_millisecond();
+    ai_basic_client->standby_req = FALSE;
     if ((frag == AI_PACKET_NO_FRAG) || (frag == AI_PACKET_FRAG_START)) {
         AI_PACKET_PT pkt_type = tuya_ai_basic_get_pkt_type(de_buf);
         AI_PROTO_D("ai recv data type:%d, %d", pkt_type, de_len);
@@ -294,6 +383,13 @@ static OPERATE_RET __ai_idle()
         return OPRT_COM_ERROR;
     }
 
+    // skip the atop request if the last config is still valid
+    if (tuya_ai_basic_cfg_is_valid(AI_FAST_RECONN_MARGIN) && (OPRT_OK == tuya_ai_basic_reconnect_prepare())) {
+        tal_workq_stop_delayed(ai_basic_client->alive_work);
+        __ai_client_set_state(AI_STATE_CONNECT);
+        return OPRT_OK;
+    }
+
     __ai_client_set_state(AI_STATE_SETUP);
     return OPRT_OK;
 }
@@ -384,7 +480,8 @@ static OPERATE_RET __ai_client_create_task(void)
     thrd_param.psram_mode = 1;
 #endif
 
-    rt = tal_thread_create_and_start(&ai_basic_client->thread, NULL, NULL, __ai_client_thread_cb, NULL, &thrd_param);
+    rt = tal_thread_create_static(&ai_basic_client->thread, &s_ai_client_thread, NULL, NULL, __ai_client_thread_cb,
+                                  NULL, &thrd_param);
     if (OPRT_OK != rt) {
         PR_ERR("ai client thread create err, rt:%d", rt);
     }
@@ -394,6 +491,17 @@ static OPERATE_RET __ai_client_create_task(void)
 static void __ai_ping(void *data)
 {
     OPERATE_RET rt = OPRT_OK;
+    SYS_TIME_T now = tal_system_get_millisecond();
+    uint32_t window_ms = ai_basic_client->keepalive_s * 1000;
+
+    // data is flowing both ways, the link is alive without a ping
+    if ((ai_basic_client->heartbeat_lost_cnt == 0) && (now - ai_basic_client->last_recv_ts < window_ms) &&
+        (now - tuya_ai_basic_get_last_send_time() < window_ms)) {
+        AI_PROTO_D("link active, skip ping");
+        tal_workq_start_delayed(ai_basic_client->alive_work, window_ms, LOOP_ONCE);
+        return;
+    }
+
     tal_sw_timer_start(ai_basic_client->alive_timeout_timer, AT_PING_TIMEOUT * 1000, TAL_TIMER_ONCE);
     rt = tuya_ai_basic_ping();
     if (OPRT_OK != rt) {
@@ -405,6 +513,8 @@ static void __ai_alive_timeout(TIMER_ID timer_id, void *data)
 {
     PR_ERR("alive timeout");
     ai_basic_client->heartbeat_lost_cnt++;
+    __ai_keepalive_update(FALSE);
+    ai_basic_client->standby_req = TRUE;
     if (ai_basic_client->heartbeat_lost_cnt >= 3) {
         PR_ERR("ping lost >= 3, close tcp connection");
         __ai_conn_close();
@@ -420,6 +530,7 @@ static int __ai_client_link_type_event_subscribe(void *data)
     OPERATE_RET rt = OPRT_OK;
 
     PR_NOTICE("ai client link type change, reset ai client");
+    tuya_ai_basic_standby_close();
     __ai_conn_close();
 
     return rt;
@@ -453,7 +564,7 @@ void tuya_ai_client_stop_ping(void)
 
 void tuya_ai_client_start_ping(void)
 {
-    tal_workq_start_delayed(ai_basic_client->alive_work, (ai_basic_client->heartbeat_interval * 1000), LOOP_ONCE);
+    tal_workq_start_delayed(ai_basic_client->alive_work, (ai_basic_client->keepalive_s * 1000), LOOP_ONCE);
 }
 
 OPERATE_RET tuya_ai_client_init(void)
@@ -467,13 +578,17 @@ OPERATE_RET tuya_ai_client_init(void)
 
     memset(ai_basic_client, 0, sizeof(AI_BASIC_CLIENT_T));
     ai_basic_client->heartbeat_interval = 30;
+    ai_basic_client->keepalive_s = ai_basic_client->heartbeat_interval;
     AI_RECONN_TIME_T reconn[AI_RECONN_TIME_NUM] = {{5, 10},   {10, 20},   {20, 40},  {40, 80},
                                                    {80, 160}, {160, 320}, {320, 640}};
     memcpy(ai_basic_client->reconn, reconn, sizeof(reconn));
     tuya_ai_biz_init();
-    TUYA_CALL_ERR_GOTO(tal_sw_timer_create(__ai_conn_refresh, NULL, &ai_basic_client->tid), EXIT);
+    TUYA_CALL_ERR_GOTO(tal_sw_timer_create_static(&s_ai_conn_timer, __ai_conn_refresh, NULL, &ai_basic_client->tid),
+                       EXIT);
     TUYA_CALL_ERR_GOTO(__ai_client_create_task(), EXIT);
-    TUYA_CALL_ERR_GOTO(tal_sw_timer_create(__ai_alive_timeout, NULL, &ai_basic_client->alive_timeout_timer), EXIT);
+    TUYA_CALL_ERR_GOTO(tal_sw_timer_create_static(&s_ai_alive_timer, __ai_alive_timeout, NULL,
+                                                  &ai_basic_client->alive_timeout_timer),
+                       EXIT);
     TUYA_CALL_ERR_GOTO(tal_workq_init_delayed(WORKQ_HIGHTPRI, __ai_ping, NULL, &ai_basic_client->alive_work), EXIT);
 #ifdef EVENT_LINK_TYPE_CHG
     TUYA_CALL_ERR_LOG(tal_event_subscribe(EVENT_LINK_TYPE_CHG, "ai client reset", __ai_client_link_type_event_subscribe,
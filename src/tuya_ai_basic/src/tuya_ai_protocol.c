@@ -28,6 +28,7 @@
 #include "tuya_transporter.h"
 #include "mbedtls/hkdf.h"
 #include "mbedtls/chacha20.h"
+#include "mbedtls/gcm.h"
 #include "mix_method.h"
 #include "tuya_iot.h"
 #include "cJSON.h"
@@ -52,6 +53,27 @@
 #ifndef AI_WRITE_SOCKET_BUF_SIZE
 #define AI_WRITE_SOCKET_BUF_SIZE 0
 #endif
+// transporter read buffer, the packet head arrives in small reads, 0 disables it
+#ifndef AI_TRANSPORTER_READ_BUF_SIZE
+#define AI_TRANSPORTER_READ_BUF_SIZE 512
+#endif
+
+// size of the window payload is encrypted into before it is written
+#ifndef AI_SEND_CHUNK_LEN
+#define AI_SEND_CHUNK_LEN 4096
+#endif
+#define AI_SEND_MAX_SEG_NUM 4
+// a pre-connected standby socket older than this is dropped instead of adopted
+#ifndef AI_STANDBY_MAX_AGE_MS
+#define AI_STANDBY_MAX_AGE_MS (20 * 1000)
+#endif
+// attributes are taken from a static pool, values up to AI_ATTR_POOL_VALUE_LEN are stored inline
+#ifndef AI_ATTR_POOL_NUM
+#define AI_ATTR_POOL_NUM (2 * AI_MAX_ATTR_NUM)
+#endif
+#ifndef AI_ATTR_POOL_VALUE_LEN
+#define AI_ATTR_POOL_VALUE_LEN 48
+#endif
 
 /**
  *
@@ -64,6 +86,7 @@
 typedef struct {
     AI_FRAG_FLAG frag_flag;
     uint32_t offset;
+    uint32_t size;
     char *data;
 } AI_RECV_FRAG_MNG_T;
 
@@ -71,10 +94,20 @@ typedef struct {
     uint32_t offset;
 } AI_SEND_FRAG_MNG_T;
 
+typedef struct {
+    AI_PACKET_WRITER_T *writer;
+    uint32_t sign_len; // head + payload length covered by the signature
+    uint32_t pos;      // packet bytes emitted so far
+    uint8_t sign_data[64];
+} AI_PKT_STREAM_T;
+
 typedef struct {
     AI_ATOP_CFG_INFO_T config;
     MUTEX_HANDLE mutex;
     tuya_transporter_t transporter;
+    tuya_transporter_t standby;
+    SYS_TIME_T standby_ts;
+    SYS_TIME_T last_send_ts;
     char crypt_key[AI_KEY_LEN + 1];
     char sign_key[AI_KEY_LEN + 1];
     uint16_t sequence_in;
@@ -87,12 +120,25 @@ typedef struct {
     char encrypt_iv[AI_IV_LEN + 1];
     char decrypt_iv[AI_IV_LEN + 1];
     AI_RECV_FRAG_MNG_T recv_frag_mng;
-    AI_SEND_FRAG_MNG_T send_frag_mng[2]; // 0:image,1:file
+    AI_SEND_FRAG_MNG_T send_frag_mng[AI_PT_TEXT - AI_PT_VIDEO + 1]; // video, audio, image, file, text
     bool frag_flag;
+#if (AI_PACKET_SECURITY_LEVEL == AI_PACKET_SL4)
+    cipher_gcm_ctx_t gcm_en_ctx;
+    cipher_gcm_ctx_t gcm_de_ctx;
+#endif
+    tal_hash_mac_context_t sign_en_ctx; // Started with sign_key, reset after every packet
+    tal_hash_mac_context_t sign_de_ctx;
     char recv_buf[AI_MAX_FRAGMENT_LENGTH + AI_ADD_PKT_LEN];
 } AI_BASIC_PROTO_T;
 
+typedef struct {
+    AI_ATTRIBUTE_T attr;
+    char value[AI_ATTR_POOL_VALUE_LEN + 1];
+} AI_ATTR_SLOT_T;
+
 static AI_BASIC_PROTO_T *ai_basic_proto = NULL;
+static AI_ATTR_SLOT_T s_attr_pool[AI_ATTR_POOL_NUM];
+static uint8_t s_attr_pool_used[AI_ATTR_POOL_NUM];
 
 static OPERATE_RET __default_write(AI_PACKET_WRITER_T *writer, void *buf, uint32_t buf_len);
 
@@ -177,14 +223,16 @@ static OPERATE_RET __ai_generate_sign_key()
     rt = mbedtls_hkdf(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), (const unsigned char *)slat, salt_len,
                       (const unsigned char *)ikm, ikm_len, (const unsigned char *)info, info_len,
                       (unsigned char *)ai_basic_proto->sign_key, AI_KEY_LEN);
+    if (OPRT_OK != rt) {
+        return rt;
+    }
+    TUYA_CALL_ERR_RETURN(
+        tal_sha256_mac_starts(&ai_basic_proto->sign_en_ctx, (uint8_t *)ai_basic_proto->sign_key, AI_KEY_LEN));
+    TUYA_CALL_ERR_RETURN(
+        tal_sha256_mac_starts(&ai_basic_proto->sign_de_ctx, (uint8_t *)ai_basic_proto->sign_key, AI_KEY_LEN));
     return rt;
 }
 
-static char *__ai_get_sign_key(void)
-{
-    return ai_basic_proto->sign_key;
-}
-
 static AI_PACKET_SL __ai_get_sl(AI_SEND_PACKET_T *info, uint8_t is_decrypt)
 {
     if (info && info->writer) {
@@ -202,6 +250,15 @@ static AI_PACKET_SL __ai_get_sl(AI_SEND_PACKET_T *info, uint8_t is_decrypt)
     }
 }
 
+static void __ai_standby_free(void)
+{
+    if (ai_basic_proto->standby) {
+        tuya_transporter_close(ai_basic_proto->standby);
+        tuya_transporter_destroy(ai_basic_proto->standby);
+        ai_basic_proto->standby = NULL;
+    }
+}
+
 static void __ai_basic_proto_deinit(void)
 {
     if (ai_basic_proto) {
@@ -210,6 +267,7 @@ static void __ai_basic_proto_deinit(void)
             tuya_transporter_destroy(ai_basic_proto->transporter);
             ai_basic_proto->transporter = NULL;
         }
+        __ai_standby_free();
         if (ai_basic_proto->mutex) {
             tal_mutex_release(ai_basic_proto->mutex);
             ai_basic_proto->mutex = NULL;
@@ -219,21 +277,28 @@ static void __ai_basic_proto_deinit(void)
             OS_FREE(ai_basic_proto->connection_id);
             ai_basic_proto->connection_id = NULL;
         }
+#if (AI_PACKET_SECURITY_LEVEL == AI_PACKET_SL4)
+        cipher_gcm_ctx_free(&ai_basic_proto->gcm_en_ctx);
+        cipher_gcm_ctx_free(&ai_basic_proto->gcm_de_ctx);
+#endif
+        tal_sha256_mac_free(&ai_basic_proto->sign_en_ctx);
+        tal_sha256_mac_free(&ai_basic_proto->sign_de_ctx);
         OS_FREE(ai_basic_proto);
         ai_basic_proto = NULL;
     }
     return;
 }
 
-static void __ai_basic_proto_reinit(void)
+/**
+ * @brief close the link and reset per connection state, the atop config is kept
+ */
+static void __ai_basic_proto_reset(void)
 {
-    tal_mutex_lock(ai_basic_proto->mutex);
     if (ai_basic_proto->transporter) {
         tuya_transporter_close(ai_basic_proto->transporter);
         tuya_transporter_destroy(ai_basic_proto->transporter);
         ai_basic_proto->transporter = NULL;
     }
-    __ai_atop_cfg_free();
     if (ai_basic_proto->connection_id) {
         OS_FREE(ai_basic_proto->connection_id);
         ai_basic_proto->connection_id = NULL;
@@ -249,6 +314,14 @@ static void __ai_basic_proto_reinit(void)
     ai_basic_proto->sl = AI_PACKET_SECURITY_LEVEL;
     memset(ai_basic_proto->decrypt_iv, 0, AI_IV_LEN);
     memset(&ai_basic_proto->recv_frag_mng, 0, sizeof(ai_basic_proto->recv_frag_mng));
+}
+
+static void __ai_basic_proto_reinit(void)
+{
+    tal_mutex_lock(ai_basic_proto->mutex);
+    __ai_standby_free();
+    __ai_atop_cfg_free();
+    __ai_basic_proto_reset();
     tal_mutex_unlock(ai_basic_proto->mutex);
     PR_NOTICE("ai proto reinit success");
     return;
@@ -263,6 +336,12 @@ static OPERATE_RET __ai_basic_proto_init(void)
         ai_basic_proto = OS_MALLOC(sizeof(AI_BASIC_PROTO_T));
         TUYA_CHECK_NULL_RETURN(ai_basic_proto, OPRT_MALLOC_FAILED);
         memset(ai_basic_proto, 0, sizeof(AI_BASIC_PROTO_T));
+#if (AI_PACKET_SECURITY_LEVEL == AI_PACKET_SL4)
+        cipher_gcm_ctx_init(&ai_basic_proto->gcm_en_ctx);
+        cipher_gcm_ctx_init(&ai_basic_proto->gcm_de_ctx);
+#endif
+        TUYA_CALL_ERR_GOTO(tal_sha256_mac_create_init(&ai_basic_proto->sign_en_ctx), EXIT);
+        TUYA_CALL_ERR_GOTO(tal_sha256_mac_create_init(&ai_basic_proto->sign_de_ctx), EXIT);
         TUYA_CALL_ERR_GOTO(__ai_generate_crypt_key(), EXIT);
         TUYA_CALL_ERR_GOTO(__ai_generate_sign_key(), EXIT);
         TUYA_CALL_ERR_GOTO(tal_mutex_create_init(&ai_basic_proto->mutex), EXIT);
@@ -426,39 +505,6 @@ static uint32_t __ai_get_payload_len(char *buf)
     return __ai_get_packet_len(buf) - AI_SIGN_LEN;
 }
 
-static OPERATE_RET __ai_packet_sign(char *buf, uint8_t *signature)
-{
-    OPERATE_RET rt = OPRT_OK;
-    char *sign_key = __ai_get_sign_key();
-    TUYA_CHECK_NULL_RETURN(sign_key, OPRT_COM_ERROR);
-
-    uint32_t head_len = __ai_get_head_len(buf);
-    uint32_t payload_len = __ai_get_payload_len(buf);
-
-    // transport first 32 byte and packet last 32 byte, if less than 64 byte,use all packet
-    uint8_t sign_data[64] = {0};
-    uint32_t sign_len = 0;
-
-    AI_PROTO_D("start sign head_len:%d, payload_len:%d", head_len, payload_len);
-    if (head_len + payload_len <= sizeof(sign_data)) {
-        memcpy(sign_data, buf, head_len + payload_len);
-        sign_len = head_len + payload_len;
-    } else {
-        memcpy(sign_data, buf, 32);
-        char *payload = buf + head_len;
-        uint32_t offset = (payload_len > 32) ? payload_len - 32 : 0;
-        uint32_t copy_len = (payload_len > 32) ? 32 : payload_len;
-        memcpy(sign_data + 32, payload + offset, copy_len);
-        sign_len = sizeof(sign_data);
-    }
-
-    rt = tal_sha256_mac((uint8_t *)sign_key, AI_KEY_LEN, (uint8_t *)sign_data, sign_len, signature);
-    if (OPRT_OK != rt) {
-        PR_ERR("sign packet failed, rt:%d", rt);
-    }
-    return rt;
-}
-
 uint32_t __ai_get_send_attr_len(AI_SEND_PACKET_T *info)
 {
     uint32_t len = 0, idx = 0;
@@ -554,7 +600,9 @@ static OPERATE_RET __ai_encrypt_packet(AI_SEND_PACKET_T *info, char *data, uint3
     AI_PACKET_SL sl = __ai_get_sl(info, false);
     if (sl == AI_PACKET_SL2) {
 #if (AI_PACKET_SECURITY_LEVEL == AI_PACKET_SL2)
-        memcpy(output, data, len);
+        if (output != data) {
+            memcpy(output, data, len);
+        }
         data_out_len = __ai_encrypt_add_pkcs(output, len);
         char nonce[12] = {0};
         memcpy(nonce, ai_basic_proto->encrypt_iv, sizeof(nonce));
@@ -567,7 +615,9 @@ static OPERATE_RET __ai_encrypt_packet(AI_SEND_PACKET_T *info, char *data, uint3
 #endif
     } else if (sl == AI_PACKET_SL3) {
 #if (AI_PACKET_SECURITY_LEVEL == AI_PACKET_SL3)
-        memcpy(output, data, len);
+        if (output != data) {
+            memcpy(output, data, len);
+        }
         data_out_len = tal_pkcs7padding_buffer((uint8_t *)output, len);
         rt = tal_aes256_cbc_encode_raw((uint8_t *)output, data_out_len, (uint8_t *)key,
                                        (uint8_t *)ai_basic_proto->encrypt_iv, (uint8_t *)output);
@@ -576,35 +626,12 @@ static OPERATE_RET __ai_encrypt_packet(AI_SEND_PACKET_T *info, char *data, uint3
             return rt;
         }
         *en_len = data_out_len;
-#endif
-    } else if (sl == AI_PACKET_SL4) {
-#if (AI_PACKET_SECURITY_LEVEL == AI_PACKET_SL4)
-        uint8_t tag[AI_GCM_TAG_LEN] = {0};
-        memcpy(output, data, len);
-        data_out_len = __ai_encrypt_add_pkcs(output, len);
-
-        const cipher_params_t en_input = {
-            .cipher_type = MBEDTLS_CIPHER_AES_256_GCM,
-            .key = (unsigned char *)key,
-            .key_len = AI_KEY_LEN,
-            .nonce = (uint8_t *)ai_basic_proto->encrypt_iv,
-            .nonce_len = AI_IV_LEN,
-            .ad = NULL,
-            .ad_len = 0,
-            .data = (uint8_t *)output,
-            .data_len = data_out_len,
-        };
-        rt = mbedtls_cipher_auth_encrypt_wrapper(&en_input, (uint8_t *)output, (size_t *)en_len, tag, sizeof(tag));
-        if (rt != OPRT_OK) {
-            PR_ERR("aes128_gcm_encode error:%x", rt);
-        }
-        memcpy(output + *en_len, tag, sizeof(tag));
-        *en_len += sizeof(tag);
-        // tuya_debug_hex_dump("encrypt_data", 64, (uint8_t *)output, *en_len);
 #endif
     } else if (sl == AI_PACKET_SL0) {
         AI_PROTO_D("sl:%d do not need crypt", sl);
-        memcpy(output, data, len);
+        if (output != data) {
+            memcpy(output, data, len);
+        }
         *en_len = len;
     } else {
         PR_ERR("sl:%d err", sl);
@@ -641,36 +668,12 @@ static OPERATE_RET __ai_decrypt_packet(char *data, uint32_t len, char *output, u
             return rt;
         }
         *de_len = len - output[len - 1];
-#endif
-    } else if (sl == AI_PACKET_SL4) {
-#if (AI_PACKET_SECURITY_LEVEL == AI_PACKET_SL4)
-        // tuya_debug_hex_dump("decrypt_data", 64, (uint8_t *)data, len - AI_GCM_TAG_LEN);
-        // tuya_debug_hex_dump("decrypt_key", 64, (uint8_t *)key, AI_KEY_LEN);
-        // tuya_debug_hex_dump("decrypt_iv", 64, (uint8_t *)ai_basic_proto->decrypt_iv, AI_IV_LEN);
-        // tuya_debug_hex_dump("decrypt_tag", 64, (uint8_t *)(data + len - AI_GCM_TAG_LEN), AI_GCM_TAG_LEN);
-        const cipher_params_t de_input = {
-            .cipher_type = MBEDTLS_CIPHER_AES_256_GCM,
-            .key = (unsigned char *)key,
-            .key_len = AI_KEY_LEN,
-            .nonce = (uint8_t *)ai_basic_proto->decrypt_iv,
-            .nonce_len = AI_IV_LEN,
-            .ad = NULL,
-            .ad_len = 0,
-            .data = (uint8_t *)data,
-            .data_len = len - AI_GCM_TAG_LEN,
-        };
-
-        rt = mbedtls_cipher_auth_decrypt_wrapper(&de_input, (uint8_t *)output, (size_t *)de_len,
-                                                 (uint8_t *)(data + len - AI_GCM_TAG_LEN), AI_GCM_TAG_LEN);
-        if (rt != OPRT_OK) {
-            PR_ERR("aes128_gcm_decode error:%x", rt);
-            return rt;
-        }
-        *de_len = *de_len - output[*de_len - 1];
 #endif
     } else if (sl == AI_PACKET_SL0) {
         AI_PROTO_D("sl:%d do not need crypt ", sl);
-        memcpy(output, data, len);
+        if (output != data) {
+            memcpy(output, data, len);
+        }
         *de_len = len;
     } else {
         AI_PROTO_D("sl:%d err", sl);
@@ -680,18 +683,12 @@ static OPERATE_RET __ai_decrypt_packet(char *data, uint32_t len, char *output, u
     return rt;
 }
 
-static OPERATE_RET __ai_pack_payload(AI_SEND_PACKET_T *info, char *payload_buf, uint32_t *payload_len,
-                                     AI_FRAG_FLAG frag, uint32_t origin_len)
+static OPERATE_RET __ai_pack_payload_prefix(AI_SEND_PACKET_T *info, char *buf, uint32_t *prefix_len,
+                                            AI_FRAG_FLAG frag, uint32_t origin_len)
 {
-    OPERATE_RET rt = OPRT_OK;
-    uint32_t idx = 0, attr_len = 0, packet_len = 0;
+    uint32_t idx = 0, attr_len = 0;
     uint32_t offset = 0;
     TUYA_CHECK_NULL_RETURN(info, OPRT_INVALID_PARM);
-    packet_len = __ai_get_send_payload_len(info, frag);
-
-    char *buf = OS_MALLOC(packet_len);
-    TUYA_CHECK_NULL_RETURN(buf, OPRT_MALLOC_FAILED);
-    memset(buf, 0, packet_len);
 
     if (tuya_ai_is_need_attr(frag)) {
         AI_PAYLOAD_HEAD_T payload_head = {0};
@@ -732,7 +729,6 @@ static OPERATE_RET __ai_pack_payload(AI_SEND_PACKET_T *info, char *payload_buf,
                     memcpy(buf + offset, info->attrs[idx]->value.str, attr_idx_len);
                 } else {
                     PR_ERR("unknow payload type:%d", payload_type);
-                    OS_FREE(buf);
                     return OPRT_COM_ERROR;
                 }
                 offset += attr_idx_len;
@@ -746,20 +742,290 @@ static OPERATE_RET __ai_pack_payload(AI_SEND_PACKET_T *info, char *payload_buf,
         offset += sizeof(info->len);
     }
 
-    memcpy(buf + offset, info->data, info->len);
-    offset += info->len;
-    AI_PROTO_D("payload len:%d, offset:%d", packet_len, offset);
+    *prefix_len = offset;
+    return OPRT_OK;
+}
+
+static uint32_t __ai_get_data_segs(AI_SEND_PACKET_T *info, AI_PACKET_SEG_T *segs)
+{
+    uint32_t idx = 0, num = 0;
+    uint32_t skip = info->seg_offset, left = info->len;
+
+    if (info->seg_num == 0) {
+        if (info->len == 0) {
+            return 0;
+        }
+        segs[0].buf = info->data;
+        segs[0].len = info->len;
+        return 1;
+    }
+
+    for (idx = 0; (idx < info->seg_num) && (left > 0); idx++) {
+        uint32_t seg_len = info->segs[idx].len;
+        if (skip >= seg_len) {
+            skip -= seg_len;
+            continue;
+        }
+        segs[num].buf = (uint8_t *)info->segs[idx].buf + skip;
+        segs[num].len = (seg_len - skip) > left ? left : (seg_len - skip);
+        left -= segs[num].len;
+        skip = 0;
+        num++;
+    }
+    return num;
+}
+
+static void __ai_pkt_data_seek(AI_SEND_PACKET_T *info, char *origin_data, uint32_t offset)
+{
+    if (info->seg_num) {
+        info->seg_offset = offset;
+    } else {
+        info->data = origin_data + offset;
+    }
+}
 
-    // tuya_debug_hex_dump("payload_uncrypt", 64, (uint8_t *)buf, packet_len);
-    rt = __ai_encrypt_packet(info, buf, packet_len, payload_buf, payload_len);
+static void __ai_pkt_data_skip(AI_SEND_PACKET_T *info, uint32_t len)
+{
+    if (info->seg_num) {
+        info->seg_offset += len;
+    } else {
+        info->data += len;
+    }
+    info->len -= len;
+}
+
+static uint32_t __ai_get_cipher_len(AI_PACKET_SL sl, uint32_t plain_len)
+{
+    if (sl == AI_PACKET_SL0) {
+        return plain_len;
+    }
+    // pkcs padding always adds 1 to 16 bytes
+    plain_len += 16 - (plain_len % 16);
+    if (sl == AI_PACKET_SL4) {
+        plain_len += AI_GCM_TAG_LEN;
+    }
+    return plain_len;
+}
+
+static void __ai_stream_feed(AI_PKT_STREAM_T *stream, AI_PACKET_SEG_T *segs, uint32_t seg_num)
+{
+    // transport first 32 byte and packet last 32 byte, if less than 64 byte,use all packet
+    uint32_t idx = 0, start = 0, end = 0, from = 0, to = 0;
+    uint32_t tail = stream->sign_len - 32;
+
+    for (idx = 0; idx < seg_num; idx++) {
+        uint8_t *buf = (uint8_t *)segs[idx].buf;
+        start = stream->pos;
+        end = start + segs[idx].len;
+        if (stream->sign_len <= sizeof(stream->sign_data)) {
+            to = (end < stream->sign_len) ? end : stream->sign_len;
+            if (start < to) {
+                memcpy(stream->sign_data + start, buf, to - start);
+            }
+        } else {
+            if (start < 32) {
+                to = (end < 32) ? end : 32;
+                memcpy(stream->sign_data + start, buf, to - start);
+            }
+            if ((end > tail) && (start < stream->sign_len)) {
+                from = (start > tail) ? start : tail;
+                to = (end < stream->sign_len) ? end : stream->sign_len;
+                memcpy(stream->sign_data + 32 + (from - tail), buf + (from - start), to - from);
+            }
+        }
+        stream->pos = end;
+    }
+}
+
+static OPERATE_RET __ai_stream_sign(tal_hash_mac_context_t *hmac, AI_PKT_STREAM_T *stream, uint8_t *signature)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    uint32_t sign_len = stream->sign_len;
+    if (sign_len > sizeof(stream->sign_data)) {
+        sign_len = sizeof(stream->sign_data);
+    }
+    rt = tal_sha256_mac_update(hmac, stream->sign_data, sign_len);
+    if (OPRT_OK == rt) {
+        rt = tal_sha256_mac_finish(hmac, signature);
+    }
     if (OPRT_OK != rt) {
-        PR_ERR("encrypt packet failed, rt:%d", rt);
+        PR_ERR("sign packet failed, rt:%d", rt);
     }
+    //! the key stays in the context, reset it for the next packet also after a failure
+    if (OPRT_OK != tal_sha256_mac_reset(hmac)) {
+        PR_ERR("sign context reset failed");
+    }
+    return rt;
+}
+
+static OPERATE_RET __ai_stream_writev(AI_PKT_STREAM_T *stream, AI_PACKET_SEG_T *segs, uint32_t seg_num)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint32_t idx = 0;
+    AI_PACKET_WRITER_T *writer = stream->writer;
 
-    OS_FREE(buf);
+    if (writer->writev) {
+        return writer->writev(writer, segs, seg_num);
+    }
+    for (idx = 0; idx < seg_num; idx++) {
+        if (segs[idx].len == 0) {
+            continue;
+        }
+        rt = writer->write(writer, segs[idx].buf, segs[idx].len);
+        if (OPRT_OK != rt) {
+            return rt;
+        }
+    }
     return rt;
 }
 
+static OPERATE_RET __ai_packet_write_plain(AI_PKT_STREAM_T *stream, AI_SEND_PACKET_T *info, char *buf,
+                                           uint32_t buf_len)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint8_t signature[AI_SIGN_LEN] = {0};
+    AI_PACKET_SEG_T segs[AI_SEND_MAX_SEG_NUM + 2];
+    uint32_t seg_num = 0;
+
+    // header and attributes, then the payload segments are written as they are
+    segs[seg_num].buf = buf;
+    segs[seg_num++].len = buf_len;
+    seg_num += __ai_get_data_segs(info, &segs[seg_num]);
+    __ai_stream_feed(stream, segs, seg_num);
+
+    rt = __ai_stream_sign(&ai_basic_proto->sign_en_ctx, stream, signature);
+    if (OPRT_OK != rt) {
+        return rt;
+    }
+    segs[seg_num].buf = signature;
+    segs[seg_num++].len = AI_SIGN_LEN;
+    return __ai_stream_writev(stream, segs, seg_num);
+}
+
+#if (AI_PACKET_SECURITY_LEVEL == AI_PACKET_SL4)
+static OPERATE_RET __ai_packet_write_gcm(AI_PKT_STREAM_T *stream, AI_SEND_PACKET_T *info, char *buf,
+                                         uint32_t head_len, uint32_t prefix_len, uint32_t window_len)
+{
+    OPERATE_RET rt = OPRT_OK;
+    AI_PACKET_SEG_T data_segs[AI_SEND_MAX_SEG_NUM];
+    AI_PACKET_SEG_T segs[2];
+    uint8_t tail[16 + AI_GCM_TAG_LEN + AI_SIGN_LEN]; // padding + tag + sign
+    uint8_t *window = (uint8_t *)buf + head_len;
+    uint8_t *out = (uint8_t *)buf;
+    uint32_t fill = prefix_len, idx = 0, seg_num = 0, pad = 0;
+    cipher_gcm_ctx_t *gcm = &ai_basic_proto->gcm_en_ctx;
+    char *key = __ai_get_crypt_key();
+    TUYA_CHECK_NULL_RETURN(key, OPRT_COM_ERROR);
+
+    // key schedule is cached in the context and only rebuilt after a new session key
+    rt = cipher_gcm_ctx_setkey(gcm, (uint8_t *)key, AI_KEY_LEN);
+    if (rt != 0) {
+        PR_ERR("gcm setkey error:%x", rt);
+        return OPRT_COM_ERROR;
+    }
+    rt = cipher_gcm_ctx_starts(gcm, MBEDTLS_GCM_ENCRYPT, (uint8_t *)ai_basic_proto->encrypt_iv, AI_IV_LEN);
+    if (rt != 0) {
+        PR_ERR("gcm starts error:%x", rt);
+        return OPRT_COM_ERROR;
+    }
+
+    // attributes are encrypted in place, payload goes through the window chunk by chunk
+    rt = cipher_gcm_ctx_update(gcm, window, prefix_len, window);
+    seg_num = __ai_get_data_segs(info, data_segs);
+    for (idx = 0; (idx < seg_num) && (rt == 0); idx++) {
+        uint8_t *src = (uint8_t *)data_segs[idx].buf;
+        uint32_t left = data_segs[idx].len;
+        while (left > 0) {
+            uint32_t len = window_len - fill;
+            if (len > left) {
+                len = left;
+            }
+            rt = cipher_gcm_ctx_update(gcm, src, len, window + fill);
+            if (rt != 0) {
+                break;
+            }
+            src += len;
+            left -= len;
+            fill += len;
+            if (fill == window_len) {
+                segs[0].buf = out;
+                segs[0].len = window + fill - out;
+                __ai_stream_feed(stream, segs, 1);
+                rt = __ai_stream_writev(stream, segs, 1);
+                if (OPRT_OK != rt) {
+                    PR_ERR("write packet chunk failed, rt:%d", rt);
+                    return rt;
+                }
+                out = window;
+                fill = 0;
+            }
+        }
+    }
+
+    pad = 16 - ((prefix_len + info->len) % 16);
+    memset(tail, pad, pad);
+    if (rt == 0) {
+        rt = cipher_gcm_ctx_update(gcm, tail, pad, tail);
+    }
+    if (rt == 0) {
+        rt = cipher_gcm_ctx_finish(gcm, tail + pad, AI_GCM_TAG_LEN);
+    }
+    if (rt != 0) {
+        PR_ERR("aes256_gcm_encode error:%x", rt);
+        return OPRT_COM_ERROR;
+    }
+
+    segs[0].buf = out;
+    segs[0].len = window + fill - out;
+    segs[1].buf = tail;
+    segs[1].len = pad + AI_GCM_TAG_LEN;
+    __ai_stream_feed(stream, segs, 2);
+    rt = __ai_stream_sign(&ai_basic_proto->sign_en_ctx, stream, tail + segs[1].len);
+    if (OPRT_OK != rt) {
+        return rt;
+    }
+    segs[1].len += AI_SIGN_LEN;
+    if (segs[0].len == 0) {
+        return __ai_stream_writev(stream, &segs[1], 1);
+    }
+    return __ai_stream_writev(stream, segs, 2);
+}
+#endif
+
+static OPERATE_RET __ai_packet_write_block(AI_PKT_STREAM_T *stream, AI_SEND_PACKET_T *info, char *buf,
+                                           uint32_t head_len, uint32_t prefix_len)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint8_t signature[AI_SIGN_LEN] = {0};
+    AI_PACKET_SEG_T data_segs[AI_SEND_MAX_SEG_NUM];
+    AI_PACKET_SEG_T segs[2];
+    uint32_t idx = 0, seg_num = 0, offset = prefix_len, en_len = 0;
+    char *payload = buf + head_len;
+
+    seg_num = __ai_get_data_segs(info, data_segs);
+    for (idx = 0; idx < seg_num; idx++) {
+        memcpy(payload + offset, data_segs[idx].buf, data_segs[idx].len);
+        offset += data_segs[idx].len;
+    }
+    rt = __ai_encrypt_packet(info, payload, offset, payload, &en_len);
+    if (OPRT_OK != rt) {
+        PR_ERR("encrypt packet failed, rt:%d", rt);
+        return rt;
+    }
+
+    segs[0].buf = buf;
+    segs[0].len = head_len + en_len;
+    __ai_stream_feed(stream, segs, 1);
+    rt = __ai_stream_sign(&ai_basic_proto->sign_en_ctx, stream, signature);
+    if (OPRT_OK != rt) {
+        return rt;
+    }
+    segs[1].buf = signature;
+    segs[1].len = AI_SIGN_LEN;
+    return __ai_stream_writev(stream, segs, 2);
+}
+
 static uint8_t __ai_check_attr_vaild(AI_ATTRIBUTE_T *attr)
 {
     AI_ATTR_TYPE type = attr->type;
@@ -868,9 +1134,9 @@ OPERATE_RET tuya_ai_get_attr_value(char *de_buf, uint32_t *offset, AI_ATTRIBUTE_
 static OPERATE_RET __ai_packet_write(AI_SEND_PACKET_T *info, AI_FRAG_FLAG frag, uint32_t origin_len)
 {
     OPERATE_RET rt = OPRT_OK;
-    uint32_t payload_len = 0, offset = 0;
+    uint32_t prefix_len = 0, window_len = 0;
     AI_PACKET_SL sl = __ai_get_sl(info, false);
-    uint8_t signature[AI_SIGN_LEN] = {0};
+    AI_PKT_STREAM_T stream = {0};
     uint16_t sequence;
     if (info->writer && info->writer->update) {
         rt = info->writer->update(AI_STAGE_PRE_WRITE, NULL, info);
@@ -892,12 +1158,6 @@ static OPERATE_RET __ai_packet_write(AI_SEND_PACKET_T *info, AI_FRAG_FLAG frag,
         PR_ERR("send packet too long, len: %d", uncrypt_len);
         return OPRT_COM_ERROR;
     }
-    char *send_pkt_buf = OS_MALLOC(uncrypt_len);
-    TUYA_CHECK_NULL_RETURN(send_pkt_buf, OPRT_MALLOC_FAILED);
-    memset(send_pkt_buf, 0, uncrypt_len);
-
-    uint32_t head_len = sizeof(AI_PACKET_HEAD_T);
-    // AI_PROTO_D("head len:%d", head_len);
 
     AI_PACKET_HEAD_T head = {0};
     head.version = 0x01;
@@ -906,84 +1166,125 @@ static OPERATE_RET __ai_packet_write(AI_SEND_PACKET_T *info, AI_FRAG_FLAG frag,
     head.security_level = sl;
     head.iv_flag = __ai_is_need_iv(info, frag);
 
-    memcpy(send_pkt_buf, &head, head_len);
-    offset += head_len;
-
+    uint32_t head_len = sizeof(AI_PACKET_HEAD_T) + sizeof(uint32_t);
     if (head.iv_flag) {
-        memcpy(send_pkt_buf + offset, ai_basic_proto->encrypt_iv, AI_IV_LEN);
-        offset += AI_IV_LEN;
+        head_len += AI_IV_LEN;
     }
+    uint32_t plain_len = __ai_get_send_payload_len(info, frag);
+    uint32_t payload_len = __ai_get_cipher_len(sl, plain_len);
 
-    uint32_t length = 0;
-    offset += sizeof(length);
-
-    rt = __ai_pack_payload(info, send_pkt_buf + offset, &payload_len, frag, origin_len);
-    if (OPRT_OK != rt) {
-        goto EXIT;
+    // only head and attributes are staged, payload is referenced or streamed through the cipher
+    if (sl == AI_PACKET_SL0) {
+        window_len = plain_len - info->len;
+    } else if (sl == AI_PACKET_SL4) {
+        window_len = plain_len - info->len;
+        window_len += (info->len > AI_SEND_CHUNK_LEN) ? AI_SEND_CHUNK_LEN : info->len;
+    } else {
+        window_len = payload_len;
     }
-    length = UNI_HTONL(payload_len + AI_SIGN_LEN);
+    char *send_pkt_buf = OS_MALLOC(head_len + window_len);
+    TUYA_CHECK_NULL_RETURN(send_pkt_buf, OPRT_MALLOC_FAILED);
+    memset(send_pkt_buf, 0, head_len + window_len);
 
+    uint32_t offset = sizeof(AI_PACKET_HEAD_T);
+    memcpy(send_pkt_buf, &head, offset);
     if (head.iv_flag) {
-        memcpy(send_pkt_buf + head_len + AI_IV_LEN, &length, sizeof(length));
-    } else {
-        memcpy(send_pkt_buf + head_len, &length, sizeof(length));
+        memcpy(send_pkt_buf + offset, ai_basic_proto->encrypt_iv, AI_IV_LEN);
+        offset += AI_IV_LEN;
     }
+    uint32_t length = UNI_HTONL(payload_len + AI_SIGN_LEN);
+    memcpy(send_pkt_buf + offset, &length, sizeof(length));
 
-    rt = __ai_packet_sign(send_pkt_buf, signature);
+    rt = __ai_pack_payload_prefix(info, send_pkt_buf + head_len, &prefix_len, frag, origin_len);
     if (OPRT_OK != rt) {
         goto EXIT;
     }
-    offset += payload_len;
-    memcpy(send_pkt_buf + offset, signature, AI_SIGN_LEN);
-    offset += AI_SIGN_LEN;
 
-    AI_PROTO_D("send packet len:%d", payload_len + AI_SIGN_LEN);
-    AI_PROTO_D("send payload len:%d", payload_len);
-
-    AI_PROTO_D("send total len:%d, send_len:%d", offset, uncrypt_len);
-    // tuya_debug_hex_dump("send_pkt_buf", 64, (uint8_t *)send_pkt_buf, offset);
-#if 0
-    if (ai_basic_proto->transporter) {
-        rt = tuya_transporter_write(ai_basic_proto->transporter, (uint8_t *)send_pkt_buf, offset, 0);
+    stream.writer = info->writer;
+    if (!stream.writer) {
+        stream.writer = &s_default_packet_writer;
+        stream.writer->user_data = ai_basic_proto->transporter;
     }
-#else
-    AI_PACKET_WRITER_T *writer = info->writer;
-    if (!writer) {
-        writer = &s_default_packet_writer;
-        writer->user_data = ai_basic_proto->transporter;
+    stream.sign_len = head_len + payload_len;
+    AI_PROTO_D("send packet len:%d, payload len:%d", head_len + payload_len + AI_SIGN_LEN, payload_len);
+
+    if (sl == AI_PACKET_SL0) {
+        rt = __ai_packet_write_plain(&stream, info, send_pkt_buf, head_len + prefix_len);
+#if (AI_PACKET_SECURITY_LEVEL == AI_PACKET_SL4)
+    } else if (sl == AI_PACKET_SL4) {
+        rt = __ai_packet_write_gcm(&stream, info, send_pkt_buf, head_len, prefix_len, window_len);
+#endif
+    } else {
+        rt = __ai_packet_write_block(&stream, info, send_pkt_buf, head_len, prefix_len);
     }
-    rt = writer->write(writer, send_pkt_buf, offset);
     if (OPRT_OK != rt) {
         PR_ERR("write packet failed, rt:%d", rt);
-        goto EXIT;
+    } else if (!info->writer) {
+        ai_basic_proto->last_send_ts = tal_system_get_millisecond();
     }
-#endif
 
 EXIT:
     OS_FREE(send_pkt_buf);
     return rt;
 }
 
+static AI_ATTR_SLOT_T *__ai_attr_slot(AI_ATTRIBUTE_T *attr)
+{
+    char *ptr = (char *)attr;
+    if ((ptr >= (char *)s_attr_pool) && (ptr < (char *)s_attr_pool + sizeof(s_attr_pool))) {
+        return (AI_ATTR_SLOT_T *)attr;
+    }
+    return NULL;
+}
+
+static AI_ATTR_SLOT_T *__ai_attr_slot_alloc(void)
+{
+    uint32_t idx = 0;
+    AI_ATTR_SLOT_T *slot = NULL;
+    TAL_ENTER_CRITICAL();
+    for (idx = 0; idx < AI_ATTR_POOL_NUM; idx++) {
+        if (!s_attr_pool_used[idx]) {
+            s_attr_pool_used[idx] = true;
+            slot = &s_attr_pool[idx];
+            break;
+        }
+    }
+    TAL_EXIT_CRITICAL();
+    return slot;
+}
+
+static void __ai_attr_slot_free(AI_ATTR_SLOT_T *slot)
+{
+    TAL_ENTER_CRITICAL();
+    s_attr_pool_used[slot - s_attr_pool] = false;
+    TAL_EXIT_CRITICAL();
+}
+
 void tuya_ai_free_attribute(AI_ATTRIBUTE_T *attr)
 {
     if (!attr) {
         return;
     }
+    AI_ATTR_SLOT_T *slot = __ai_attr_slot(attr);
     switch (attr->payload_type) {
     case ATTR_PT_BYTES:
-        if (attr->value.bytes) {
+        if (attr->value.bytes && (!slot || (attr->value.bytes != (uint8_t *)slot->value))) {
             OS_FREE(attr->value.bytes);
         }
         break;
     case ATTR_PT_STR:
-        if (attr->value.str) {
+        if (attr->value.str && (!slot || (attr->value.str != slot->value))) {
             OS_FREE(attr->value.str);
         }
         break;
     default:
         break;
     }
-    OS_FREE(attr);
+    if (slot) {
+        __ai_attr_slot_free(slot);
+    } else {
+        OS_FREE(attr);
+    }
 }
 
 void tuya_ai_free_attrs(AI_SEND_PACKET_T *pkt)
@@ -999,6 +1300,9 @@ void tuya_ai_free_attrs(AI_SEND_PACKET_T *pkt)
 static void __ai_basic_reset_send_frag(AI_PACKET_PT type)
 {
     uint8_t idx = type - AI_PT_VIDEO;
+    if (idx >= CNTSOF(ai_basic_proto->send_frag_mng)) {
+        return;
+    }
     ai_basic_proto->send_frag_mng[idx].offset = 0;
 }
 
@@ -1011,7 +1315,7 @@ static void __ai_basic_get_send_frag(AI_SEND_PACKET_T *info, AI_FRAG_FLAG *frag_
     uint32_t biz_head_len = 0;
     uint8_t idx = type - AI_PT_VIDEO;
     uint32_t actual_len = 0, actual_total_len = 0;
-    if (idx >= SIZEOF(ai_basic_proto->send_frag_mng)) {
+    if (idx >= CNTSOF(ai_basic_proto->send_frag_mng)) {
         PR_ERR("send frag mng idx err, type:%d", type);
         return;
     }
@@ -1049,13 +1353,11 @@ static void __ai_basic_get_send_frag(AI_SEND_PACKET_T *info, AI_FRAG_FLAG *frag_
     } else if ((*offset + actual_len) == actual_total_len) {
         *offset = 0;
         *frag_flag = AI_PACKET_FRAG_END;
-        info->data += biz_head_len;
-        info->len -= biz_head_len;
+        __ai_pkt_data_skip(info, biz_head_len);
     } else if ((*offset + actual_len) < actual_total_len) {
         *offset += actual_len;
         *frag_flag = AI_PACKET_FRAG_ING;
-        info->data += biz_head_len;
-        info->len -= biz_head_len;
+        __ai_pkt_data_skip(info, biz_head_len);
     } else {
         PR_ERR("send packet err, offset:%d, frag_len:%d, total_len:%d", *offset, actual_len, actual_total_len);
         *offset = 0;
@@ -1133,7 +1435,7 @@ OPERATE_RET tuya_ai_basic_pkt_send(AI_SEND_PACKET_T *info)
                 one_packet_len = AI_MAX_FRAGMENT_LENGTH - min_pkt_len;
             }
             frag_len = (origin_len - offset) > one_packet_len ? one_packet_len : (origin_len - offset);
-            info->data = origin_data + offset;
+            __ai_pkt_data_seek(info, origin_data, offset);
             info->len = frag_len;
             AI_PROTO_D("offset:%d, frag_len:%d, %d", offset, frag_len, origin_len);
             if (offset == 0) {
@@ -1149,7 +1451,7 @@ OPERATE_RET tuya_ai_basic_pkt_send(AI_SEND_PACKET_T *info)
             }
             offset += frag_len;
         }
-        info->data = origin_data;
+        __ai_pkt_data_seek(info, origin_data, 0);
         info->len = origin_len;
     }
     tuya_ai_free_attrs(info);
@@ -1176,7 +1478,8 @@ static bool __ai_check_attr_created(AI_SEND_PACKET_T *pkt)
 
 AI_ATTRIBUTE_T *tuya_ai_create_attribute(AI_ATTR_TYPE type, AI_ATTR_PT payload_type, void *value, uint32_t len)
 {
-    AI_ATTRIBUTE_T *attr = (AI_ATTRIBUTE_T *)OS_MALLOC(sizeof(AI_ATTRIBUTE_T));
+    AI_ATTR_SLOT_T *slot = __ai_attr_slot_alloc();
+    AI_ATTRIBUTE_T *attr = slot ? &slot->attr : (AI_ATTRIBUTE_T *)OS_MALLOC(sizeof(AI_ATTRIBUTE_T));
     if (!attr) {
         PR_ERR("malloc attr failed");
         return NULL;
@@ -1203,15 +1506,23 @@ AI_ATTRIBUTE_T *tuya_ai_create_attribute(AI_ATTR_TYPE type, AI_ATTR_PT payload_t
         AI_PROTO_D("add value:%llu", attr->value.u64);
         break;
     case ATTR_PT_BYTES:
-        attr->value.bytes = OS_MALLOC(len);
-        memset(attr->value.bytes, 0, len);
+        if (slot && (len <= AI_ATTR_POOL_VALUE_LEN)) {
+            attr->value.bytes = (uint8_t *)slot->value;
+        } else {
+            attr->value.bytes = OS_MALLOC(len);
+        }
         if (attr->value.bytes) {
             memcpy(attr->value.bytes, value, len);
             // tuya_debug_hex_dump("AI_ATTR_VALUE", 64, attr->value.bytes, len);
         }
         break;
     case ATTR_PT_STR:
-        attr->value.str = mm_strdup((char *)value);
+        if (slot && (strlen((char *)value) <= AI_ATTR_POOL_VALUE_LEN)) {
+            strcpy(slot->value, (char *)value);
+            attr->value.str = slot->value;
+        } else {
+            attr->value.str = mm_strdup((char *)value);
+        }
         AI_PROTO_D("add value:%s", attr->value.str);
         break;
     default:
@@ -1491,7 +1802,11 @@ static int __ai_baisc_read_pkt_head(char *recv_buf)
 
 void tuya_ai_basic_pkt_free(char *data)
 {
-    if (data == ai_basic_proto->recv_frag_mng.data) {
+    char *recv_buf = ai_basic_proto->recv_buf;
+    if ((data >= recv_buf) && (data < recv_buf + sizeof(ai_basic_proto->recv_buf))) {
+        // decrypted in place, nothing to free
+        return;
+    } else if (data == ai_basic_proto->recv_frag_mng.data) {
         OS_FREE(data);
         ai_basic_proto->recv_frag_mng.data = NULL;
         memset(&ai_basic_proto->recv_frag_mng, 0, sizeof(AI_RECV_FRAG_MNG_T));
@@ -1513,16 +1828,168 @@ static bool __ai_basic_get_frag_flag(void)
 {
     return ai_basic_proto->frag_flag;
 }
-OPERATE_RET tuya_ai_basic_pkt_read(char **out, uint32_t *out_len, AI_FRAG_FLAG *out_frag)
+#if (AI_PACKET_SECURITY_LEVEL == AI_PACKET_SL4)
+static OPERATE_RET __ai_gcm_decrypt_starts(cipher_gcm_ctx_t *gcm)
+{
+    int ret = 0;
+    char *key = __ai_get_crypt_key();
+    TUYA_CHECK_NULL_RETURN(key, OPRT_COM_ERROR);
+
+    ret = cipher_gcm_ctx_setkey(gcm, (uint8_t *)key, AI_KEY_LEN);
+    if (ret == 0) {
+        ret = cipher_gcm_ctx_starts(gcm, MBEDTLS_GCM_DECRYPT, (uint8_t *)ai_basic_proto->decrypt_iv, AI_IV_LEN);
+    }
+    if (ret != 0) {
+        PR_ERR("gcm decrypt starts error:%x", ret);
+        return OPRT_COM_ERROR;
+    }
+    return OPRT_OK;
+}
+
+static OPERATE_RET __ai_gcm_decrypt_finish(cipher_gcm_ctx_t *gcm, uint8_t *tag, char *output, uint32_t len,
+                                           uint32_t *de_len)
+{
+    uint8_t calc_tag[AI_GCM_TAG_LEN] = {0};
+    uint8_t diff = 0;
+    uint32_t idx = 0, pad = 0;
+
+    if (cipher_gcm_ctx_finish(gcm, calc_tag, AI_GCM_TAG_LEN) != 0) {
+        PR_ERR("gcm decrypt finish error");
+        return OPRT_COM_ERROR;
+    }
+    for (idx = 0; idx < AI_GCM_TAG_LEN; idx++) {
+        diff |= calc_tag[idx] ^ tag[idx];
+    }
+    if (diff) {
+        PR_ERR("aes128_gcm_decode tag error");
+        return OPRT_COM_ERROR;
+    }
+    pad = (uint8_t)output[len - 1];
+    if ((pad == 0) || (pad > 16) || (pad > len)) {
+        PR_ERR("gcm decrypt padding error:%d", pad);
+        return OPRT_COM_ERROR;
+    }
+    *de_len = len - pad;
+    return OPRT_OK;
+}
+#endif
+
+/**
+ * @brief read the rest of a packet whose head is already in recv_buf, verify it and decrypt the payload to output.
+ * With gcm every chunk is decrypted as soon as it arrives, output may be recv_buf + head_len for in place.
+ */
+static OPERATE_RET __ai_basic_read_payload(char *recv_buf, uint32_t offset, char *output, uint32_t *de_len)
 {
     OPERATE_RET rt = OPRT_OK;
+    int recv_len = 0;
     uint8_t calc_sign[AI_SIGN_LEN] = {0};
-    uint8_t packet_sign[AI_SIGN_LEN] = {0};
-    char *decrypt_buf = NULL;
+    AI_PKT_STREAM_T stream = {0};
+    AI_PACKET_SEG_T seg;
+    uint32_t head_len = __ai_get_head_len(recv_buf);
+    uint32_t payload_len = __ai_get_payload_len(recv_buf);
+    uint32_t total_len = head_len + payload_len + AI_SIGN_LEN;
+    char *payload = recv_buf + head_len;
+    bool streaming = false;
+#if (AI_PACKET_SECURITY_LEVEL == AI_PACKET_SL4)
+    cipher_gcm_ctx_t *gcm = &ai_basic_proto->gcm_de_ctx;
+    uint32_t cipher_len = 0, de_pos = 0, avail = 0;
+    if (__ai_get_sl(NULL, true) == AI_PACKET_SL4) {
+        if (payload_len < AI_GCM_TAG_LEN + 16) {
+            PR_ERR("gcm payload too short:%d", payload_len);
+            return OPRT_COM_ERROR;
+        }
+        cipher_len = payload_len - AI_GCM_TAG_LEN;
+        rt = __ai_gcm_decrypt_starts(gcm);
+        if (OPRT_OK != rt) {
+            return rt;
+        }
+        streaming = true;
+    }
+#endif
+
+    // signature covers the cipher text, so capture it before any in place decrypt
+    stream.sign_len = head_len + payload_len;
+    seg.buf = recv_buf;
+    seg.len = offset;
+    __ai_stream_feed(&stream, &seg, 1);
+
+    while (total_len > offset) {
+        recv_len = tuya_transporter_read(ai_basic_proto->transporter, (uint8_t *)(recv_buf + offset),
+                                         total_len - offset, AI_DEFAULT_TIMEOUT_MS);
+        if (recv_len <= 0) {
+            if (recv_len == OPRT_RESOURCE_NOT_READY) {
+                continue;
+            }
+            PR_ERR("continue read failed, rt:%d, %d", recv_len, total_len - offset);
+            return (recv_len == 0) ? OPRT_COM_ERROR : recv_len;
+        }
+        seg.buf = recv_buf + offset;
+        seg.len = recv_len;
+        __ai_stream_feed(&stream, &seg, 1);
+        offset += recv_len;
+#if (AI_PACKET_SECURITY_LEVEL == AI_PACKET_SL4)
+        if (streaming) {
+            avail = offset - head_len;
+            if (avail > cipher_len) {
+                avail = cipher_len;
+            }
+            if ((avail > de_pos) &&
+                (cipher_gcm_ctx_update(gcm, (uint8_t *)payload + de_pos, avail - de_pos,
+                                       (uint8_t *)output + de_pos) != 0)) {
+                PR_ERR("gcm decrypt update error");
+                return OPRT_COM_ERROR;
+            }
+            de_pos = avail;
+        }
+#endif
+    }
+
+    rt = __ai_stream_sign(&ai_basic_proto->sign_de_ctx, &stream, calc_sign);
+    if (OPRT_OK != rt) {
+        PR_ERR("packet sign failed, rt:%d", rt);
+        return rt;
+    }
+    if (memcmp(calc_sign, payload + payload_len, sizeof(calc_sign))) {
+        PR_ERR("packet sign error");
+        return OPRT_RESOURCE_NOT_READY;
+    }
+    AI_PROTO_D("sign ok");
+
+#if (AI_PACKET_SECURITY_LEVEL == AI_PACKET_SL4)
+    if (streaming) {
+        return __ai_gcm_decrypt_finish(gcm, (uint8_t *)payload + cipher_len, output, cipher_len, de_len);
+    }
+#endif
+    rt = __ai_decrypt_packet(payload, payload_len, output, de_len);
+    if (OPRT_OK != rt) {
+        PR_ERR("decrypt packet failed, rt:%d", rt);
+    }
+    return rt;
+}
+
+static bool __ai_basic_frag_append(char *data, uint32_t len)
+{
+    AI_RECV_FRAG_MNG_T *frag_mng = &ai_basic_proto->recv_frag_mng;
+    if ((frag_mng->data == NULL) || (frag_mng->offset + len > frag_mng->size)) {
+        PR_ERR("recv frag overflow, offset:%d, len:%d, size:%d", frag_mng->offset, len, frag_mng->size);
+        return false;
+    }
+    if (data != frag_mng->data + frag_mng->offset) {
+        memcpy(frag_mng->data + frag_mng->offset, data, len);
+    }
+    frag_mng->offset += len;
+    return true;
+}
+
+OPERATE_RET tuya_ai_basic_pkt_read(char **out, uint32_t *out_len, AI_FRAG_FLAG *out_frag)
+{
+    OPERATE_RET rt = OPRT_OK;
     char *recv_buf = ai_basic_proto->recv_buf;
+    char *decrypt_buf = NULL;
+    uint32_t decrypt_len = 0;
+    AI_RECV_FRAG_MNG_T *frag_mng = &ai_basic_proto->recv_frag_mng;
     TUYA_CHECK_NULL_RETURN(recv_buf, OPRT_COM_ERROR);
 
-    memset(recv_buf, 0, sizeof(ai_basic_proto->recv_buf));
     AI_PROTO_D("recv packet ing");
     int recv_len = __ai_baisc_read_pkt_head(recv_buf);
     if (recv_len <= 0) {
@@ -1542,8 +2009,8 @@ OPERATE_RET tuya_ai_basic_pkt_read(char **out, uint32_t *out_len, AI_FRAG_FLAG *
     AI_PROTO_D("recv head len:%d", head_len);
     AI_PROTO_D("recv packet len:%d", packet_len);
 
-    if (packet_len + head_len > sizeof(ai_basic_proto->recv_buf)) {
-        PR_ERR("recv packet too long, pkt len:%u, head len:%u", packet_len, head_len);
+    if ((packet_len + head_len > sizeof(ai_basic_proto->recv_buf)) || (packet_len < AI_SIGN_LEN)) {
+        PR_ERR("recv packet len err, pkt len:%u, head len:%u", packet_len, head_len);
         recv_len = OPRT_RESOURCE_NOT_READY;
         goto EXIT;
     }
@@ -1559,55 +2026,26 @@ OPERATE_RET tuya_ai_basic_pkt_read(char **out, uint32_t *out_len, AI_FRAG_FLAG *
         ai_basic_proto->sequence_in = 0;
     }
 
-    uint32_t continue_recv_len = 0;
-    int offset = recv_len;
-    while (packet_len + head_len > offset) {
-        continue_recv_len = packet_len + head_len - offset;
-        recv_len = tuya_transporter_read(ai_basic_proto->transporter, (uint8_t *)(recv_buf + offset), continue_recv_len,
-                                         AI_DEFAULT_TIMEOUT_MS);
-        if (recv_len <= 0) {
-            if (recv_len == OPRT_RESOURCE_NOT_READY) {
-                continue;
-            }
-            PR_ERR("continue read failed, rt:%d, %d", recv_len, continue_recv_len);
-            goto EXIT;
-        }
-        offset += recv_len;
-    }
-
-    rt = __ai_packet_sign(recv_buf, calc_sign);
-    if (OPRT_OK != rt) {
-        PR_ERR("packet sign failed, rt:%d", rt);
-        goto EXIT;
-    }
-
-    AI_PROTO_D("sign ok");
-    uint32_t payload_len = __ai_get_payload_len(recv_buf);
-    char *payload = recv_buf + head_len;
-    memcpy(packet_sign, payload + payload_len, AI_SIGN_LEN);
-    if (memcmp(calc_sign, packet_sign, sizeof(calc_sign))) {
-        PR_ERR("packet sign error");
-        // tuya_debug_hex_dump("calc_sign", AI_SIGN_LEN, calc_sign, AI_SIGN_LEN);
-        // tuya_debug_hex_dump("packet_sign", AI_SIGN_LEN, packet_sign, AI_SIGN_LEN);
-        recv_len = OPRT_RESOURCE_NOT_READY;
-        goto EXIT;
+    // continue fragments are decrypted straight into the reassembly buffer, others in place
+    bool reassemble = !__ai_basic_get_frag_flag();
+    AI_FRAG_FLAG current_frag_flag = head->frag_flag;
+    uint32_t payload_len = packet_len - AI_SIGN_LEN;
+    decrypt_buf = recv_buf + head_len;
+    if (reassemble && ((current_frag_flag == AI_PACKET_FRAG_ING) || (current_frag_flag == AI_PACKET_FRAG_END)) &&
+        frag_mng->data && (frag_mng->offset + payload_len <= frag_mng->size)) {
+        decrypt_buf = frag_mng->data + frag_mng->offset;
     }
 
-    uint32_t decrypt_len = 0;
-    decrypt_buf = OS_MALLOC(packet_len + head_len + AI_ADD_PKT_LEN);
-    TUYA_CHECK_NULL_RETURN(decrypt_buf, OPRT_MALLOC_FAILED);
-    memset(decrypt_buf, 0, packet_len + head_len + AI_ADD_PKT_LEN);
-    rt = __ai_decrypt_packet(payload, payload_len, decrypt_buf, &decrypt_len);
+    rt = __ai_basic_read_payload(recv_buf, recv_len, decrypt_buf, &decrypt_len);
     if (OPRT_OK != rt) {
-        PR_ERR("decrypt packet failed, rt:%d", rt);
+        recv_len = rt;
         goto EXIT;
     }
     AI_PROTO_D("decrypt len:%d", decrypt_len);
-    AI_PROTO_D("frag flag:%d, sdk frag flag:%d", head->frag_flag, __ai_basic_get_frag_flag());
+    AI_PROTO_D("frag flag:%d, sdk frag flag:%d", current_frag_flag, __ai_basic_get_frag_flag());
 
-    if (!__ai_basic_get_frag_flag()) {
-        AI_FRAG_FLAG current_frag_flag = head->frag_flag;
-        AI_FRAG_FLAG last_frag_flag = ai_basic_proto->recv_frag_mng.frag_flag;
+    if (reassemble) {
+        AI_FRAG_FLAG last_frag_flag = frag_mng->frag_flag;
         if ((last_frag_flag == AI_PACKET_FRAG_START) || (last_frag_flag == AI_PACKET_FRAG_ING)) {
             if ((current_frag_flag != AI_PACKET_FRAG_ING) && (current_frag_flag != AI_PACKET_FRAG_END)) {
                 PR_ERR("recv start frag packet, but not continue %d, %d", current_frag_flag, last_frag_flag);
@@ -1615,9 +2053,7 @@ OPERATE_RET tuya_ai_basic_pkt_read(char **out, uint32_t *out_len, AI_FRAG_FLAG *
             }
         }
 
-        AI_PROTO_D("frag flag:%d", head->frag_flag);
-        AI_PROTO_D("frag mng info, flag:%d, offset:%d", ai_basic_proto->recv_frag_mng.frag_flag,
-                   ai_basic_proto->recv_frag_mng.offset);
+        AI_PROTO_D("frag mng info, flag:%d, offset:%d", frag_mng->frag_flag, frag_mng->offset);
         if (current_frag_flag == AI_PACKET_FRAG_START) {
             uint32_t origin_len = 0, frag_offset = 0, attr_len = 0, frag_total_len = 0;
             AI_PAYLOAD_HEAD_T *pkt_head = (AI_PAYLOAD_HEAD_T *)decrypt_buf;
@@ -1639,45 +2075,44 @@ OPERATE_RET tuya_ai_basic_pkt_read(char **out, uint32_t *out_len, AI_FRAG_FLAG *
                 PR_ERR("origin len error, origin len:%d, decrypt len:%d", origin_len, decrypt_len);
                 goto EXIT;
             }
-            memset(&ai_basic_proto->recv_frag_mng, 0, sizeof(AI_RECV_FRAG_MNG_T));
-            ai_basic_proto->recv_frag_mng.frag_flag = current_frag_flag;
+            if (frag_mng->data) {
+                OS_FREE(frag_mng->data);
+            }
+            memset(frag_mng, 0, sizeof(AI_RECV_FRAG_MNG_T));
+            frag_mng->frag_flag = current_frag_flag;
             frag_total_len = origin_len + frag_offset + AI_ADD_PKT_LEN;
             AI_PROTO_D("frag_total_len %d", frag_total_len);
-            ai_basic_proto->recv_frag_mng.data = OS_MALLOC(frag_total_len);
-            if (!ai_basic_proto->recv_frag_mng.data) {
-                PR_ERR("malloc origin data failed len:%d", decrypt_len);
+            frag_mng->data = OS_MALLOC(frag_total_len);
+            if (!frag_mng->data) {
+                PR_ERR("malloc origin data failed len:%d", frag_total_len);
                 goto EXIT;
             }
-            AI_PROTO_D("malloc recv_frag_mng data addr %p", ai_basic_proto->recv_frag_mng.data);
-            memset(ai_basic_proto->recv_frag_mng.data, 0, frag_total_len);
-            memcpy(ai_basic_proto->recv_frag_mng.data, decrypt_buf, decrypt_len);
-            ai_basic_proto->recv_frag_mng.offset = decrypt_len;
-            OS_FREE(decrypt_buf);
-            decrypt_buf = NULL;
+            AI_PROTO_D("malloc recv_frag_mng data addr %p", frag_mng->data);
+            frag_mng->size = frag_total_len;
+            memcpy(frag_mng->data, decrypt_buf, decrypt_len);
+            frag_mng->offset = decrypt_len;
             rt = tuya_ai_basic_pkt_read(out, out_len, out_frag);
             if (rt != OPRT_OK) {
                 PR_ERR("read continue frag packet failed, rt:%d", rt);
                 goto EXIT;
             }
         } else if (current_frag_flag == AI_PACKET_FRAG_ING) {
-            memcpy(ai_basic_proto->recv_frag_mng.data + ai_basic_proto->recv_frag_mng.offset, decrypt_buf, decrypt_len);
-            ai_basic_proto->recv_frag_mng.frag_flag = current_frag_flag;
-            ai_basic_proto->recv_frag_mng.offset += decrypt_len;
-            OS_FREE(decrypt_buf);
-            decrypt_buf = NULL;
+            if (!__ai_basic_frag_append(decrypt_buf, decrypt_len)) {
+                goto EXIT;
+            }
+            frag_mng->frag_flag = current_frag_flag;
             rt = tuya_ai_basic_pkt_read(out, out_len, out_frag);
             if (rt != OPRT_OK) {
                 PR_ERR("read continue ing frag packet failed, rt:%d", rt);
                 goto EXIT;
             }
         } else if (current_frag_flag == AI_PACKET_FRAG_END) {
-            memcpy(ai_basic_proto->recv_frag_mng.data + ai_basic_proto->recv_frag_mng.offset, decrypt_buf, decrypt_len);
-            ai_basic_proto->recv_frag_mng.frag_flag = current_frag_flag;
-            ai_basic_proto->recv_frag_mng.offset += decrypt_len;
-            OS_FREE(decrypt_buf);
-            decrypt_buf = NULL;
-            *out = ai_basic_proto->recv_frag_mng.data;
-            *out_len = ai_basic_proto->recv_frag_mng.offset;
+            if (!__ai_basic_frag_append(decrypt_buf, decrypt_len)) {
+                goto EXIT;
+            }
+            frag_mng->frag_flag = current_frag_flag;
+            *out = frag_mng->data;
+            *out_len = frag_mng->offset;
             *out_frag = AI_PACKET_NO_FRAG;
         } else {
             *out = decrypt_buf;
@@ -1687,20 +2122,16 @@ OPERATE_RET tuya_ai_basic_pkt_read(char **out, uint32_t *out_len, AI_FRAG_FLAG *
     } else {
         *out = decrypt_buf;
         *out_len = decrypt_len;
-        *out_frag = head->frag_flag;
+        *out_frag = current_frag_flag;
     }
     AI_PROTO_D("recv packet len:%d", *out_len);
     return rt;
 
 EXIT:
-    if (decrypt_buf) {
-        OS_FREE(decrypt_buf);
-        decrypt_buf = NULL;
+    if (frag_mng->data) {
+        OS_FREE(frag_mng->data);
     }
-    if (ai_basic_proto->recv_frag_mng.data) {
-        OS_FREE(ai_basic_proto->recv_frag_mng.data);
-    }
-    memset(&ai_basic_proto->recv_frag_mng, 0, SIZEOF(AI_RECV_FRAG_MNG_T));
+    memset(frag_mng, 0, SIZEOF(AI_RECV_FRAG_MNG_T));
     return recv_len;
 }
 
@@ -1823,7 +2254,7 @@ OPERATE_RET tuya_ai_auth_resp(void)
     AI_PAYLOAD_HEAD_T *packet = (AI_PAYLOAD_HEAD_T *)de_buf;
     if (packet->attribute_flag != AI_HAS_ATTR) {
         PR_ERR("auth resp packet has no attribute");
-        OS_FREE(de_buf);
+        tuya_ai_basic_pkt_free(de_buf);
         return OPRT_COM_ERROR;
     }
 
@@ -1839,7 +2270,7 @@ OPERATE_RET tuya_ai_auth_resp(void)
         PR_ERR("auth resp packet type error %d", packet->type);
         rt = OPRT_COM_ERROR;
     }
-    OS_FREE(de_buf);
+    tuya_ai_basic_pkt_free(de_buf);
     return rt;
 }
 
@@ -1869,27 +2300,124 @@ OPERATE_RET tuya_ai_basic_ping(void)
     return rt;
 }
 
+static OPERATE_RET __ai_transporter_connect(tuya_transporter_t transporter)
+{
+    OPERATE_RET rt = OPRT_COM_ERROR;
+    uint32_t idx = 0;
+
+#if AI_TRANSPORTER_READ_BUF_SIZE > 0
+    tuya_transporter_set_read_buffer(transporter, AI_TRANSPORTER_READ_BUF_SIZE);
+#endif
+    for (idx = 0; idx < ai_basic_proto->config.host_num; idx++) {
+        PR_NOTICE("connect to host :%s, port: %d", ai_basic_proto->config.hosts[idx], ai_basic_proto->config.tcp_port);
+        rt = tuya_transporter_connect(transporter, ai_basic_proto->config.hosts[idx], ai_basic_proto->config.tcp_port,
+                                      AI_DEFAULT_TIMEOUT_MS);
+        if (OPRT_OK == rt) {
+            break;
+        }
+    }
+    return rt;
+}
+
 OPERATE_RET tuya_ai_basic_connect(void)
 {
     OPERATE_RET rt = OPRT_OK;
+
+    tal_mutex_lock(ai_basic_proto->mutex);
+    if (ai_basic_proto->standby) {
+        if (tal_system_get_millisecond() - ai_basic_proto->standby_ts < AI_STANDBY_MAX_AGE_MS) {
+            ai_basic_proto->transporter = ai_basic_proto->standby;
+            ai_basic_proto->standby = NULL;
+            ai_basic_proto->connected = true;
+            tal_mutex_unlock(ai_basic_proto->mutex);
+            PR_NOTICE("take over standby connection");
+            return OPRT_OK;
+        }
+        __ai_standby_free();
+    }
+    tal_mutex_unlock(ai_basic_proto->mutex);
+
     ai_basic_proto->transporter = tuya_transporter_create(TRANSPORT_TYPE_TCP, NULL);
     if (!ai_basic_proto->transporter) {
         PR_ERR("create transporter err");
         return OPRT_COM_ERROR;
     }
-    uint32_t idx = 0;
-    for (idx = 0; idx < ai_basic_proto->config.host_num; idx++) {
-        PR_NOTICE("connect to host :%s, port: %d", ai_basic_proto->config.hosts[idx], ai_basic_proto->config.tcp_port);
-        rt = tuya_transporter_connect(ai_basic_proto->transporter, ai_basic_proto->config.hosts[idx],
-                                      ai_basic_proto->config.tcp_port, AI_DEFAULT_TIMEOUT_MS);
-        if (OPRT_OK == rt) {
-            ai_basic_proto->connected = true;
-            break;
-        }
+    rt = __ai_transporter_connect(ai_basic_proto->transporter);
+    if (OPRT_OK == rt) {
+        ai_basic_proto->connected = true;
     }
     return rt;
 }
 
+uint8_t tuya_ai_basic_cfg_is_valid(uint32_t margin_s)
+{
+    if (!ai_basic_proto || !ai_basic_proto->config.hosts || !ai_basic_proto->config.credential) {
+        return FALSE;
+    }
+    return ai_basic_proto->config.expire > (uint64_t)tal_time_get_posix() + margin_s;
+}
+
+OPERATE_RET tuya_ai_basic_reconnect_prepare(void)
+{
+    if (!ai_basic_proto) {
+        return OPRT_COM_ERROR;
+    }
+    tal_mutex_lock(ai_basic_proto->mutex);
+    __ai_basic_proto_reset();
+    tal_mutex_unlock(ai_basic_proto->mutex);
+    PR_NOTICE("ai proto reset, keep atop config");
+    return OPRT_OK;
+}
+
+OPERATE_RET tuya_ai_basic_standby_connect(void)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    if (!ai_basic_proto || !ai_basic_proto->config.hosts) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    tal_mutex_lock(ai_basic_proto->mutex);
+    if (ai_basic_proto->standby) {
+        tal_mutex_unlock(ai_basic_proto->mutex);
+        return OPRT_OK;
+    }
+    tal_mutex_unlock(ai_basic_proto->mutex);
+
+    tuya_transporter_t standby = tuya_transporter_create(TRANSPORT_TYPE_TCP, NULL);
+    TUYA_CHECK_NULL_RETURN(standby, OPRT_MALLOC_FAILED);
+    rt = __ai_transporter_connect(standby);
+    if (OPRT_OK != rt) {
+        PR_ERR("standby connect failed, rt:%d", rt);
+        tuya_transporter_close(standby);
+        tuya_transporter_destroy(standby);
+        return rt;
+    }
+
+    tal_mutex_lock(ai_basic_proto->mutex);
+    __ai_standby_free();
+    ai_basic_proto->standby = standby;
+    ai_basic_proto->standby_ts = tal_system_get_millisecond();
+    tal_mutex_unlock(ai_basic_proto->mutex);
+    PR_NOTICE("standby connection ready");
+    return OPRT_OK;
+}
+
+SYS_TIME_T tuya_ai_basic_get_last_send_time(void)
+{
+    return ai_basic_proto ? ai_basic_proto->last_send_ts : 0;
+}
+
+void tuya_ai_basic_standby_close(void)
+{
+    if (!ai_basic_proto) {
+        return;
+    }
+    tal_mutex_lock(ai_basic_proto->mutex);
+    __ai_standby_free();
+    tal_mutex_unlock(ai_basic_proto->mutex);
+}
+
 AI_PACKET_PT tuya_ai_basic_get_pkt_type(char *buf)
 {
     AI_PAYLOAD_HEAD_T *payload = (AI_PAYLOAD_HEAD_T *)buf;
@@ -2298,6 +2826,53 @@ OPERATE_RET tuya_ai_basic_event(AI_EVENT_ATTR_T *event, char *data, uint32_t len
     return tuya_ai_basic_pkt_send(&pkt);
 }
 
+OPERATE_RET tuya_ai_basic_segs(AI_PACKET_PT type, void *attr, AI_PACKET_SEG_T *segs, uint32_t seg_num,
+                               uint32_t total_len, AI_PACKET_WRITER_T *writer)
+{
+    OPERATE_RET rt = OPRT_OK;
+    uint32_t idx = 0;
+    AI_SEND_PACKET_T pkt = {0};
+    if ((NULL == segs) || (0 == seg_num) || (seg_num > AI_SEND_MAX_SEG_NUM)) {
+        PR_ERR("invalid segs, num:%d", seg_num);
+        return OPRT_INVALID_PARM;
+    }
+    if ((type != AI_PT_VIDEO) && (type != AI_PT_AUDIO) && (type != AI_PT_IMAGE) && (type != AI_PT_FILE) &&
+        (type != AI_PT_TEXT)) {
+        PR_ERR("segs not support type:%d", type);
+        return OPRT_INVALID_PARM;
+    }
+    pkt.writer = writer;
+    pkt.type = type;
+    if (attr) {
+        if (type == AI_PT_VIDEO) {
+            rt = __create_video_attrs(&pkt, (AI_VIDEO_ATTR_T *)attr);
+        } else if (type == AI_PT_AUDIO) {
+            rt = __create_audio_attrs(&pkt, (AI_AUDIO_ATTR_T *)attr);
+        } else if (type == AI_PT_IMAGE) {
+            rt = __create_image_attrs(&pkt, (AI_IMAGE_ATTR_T *)attr);
+        } else if (type == AI_PT_FILE) {
+            rt = __create_file_attrs(&pkt, (AI_FILE_ATTR_T *)attr);
+        } else {
+            rt = __create_text_attrs(&pkt, (AI_TEXT_ATTR_T *)attr);
+        }
+        if (OPRT_OK != rt) {
+            return rt;
+        }
+    }
+    for (idx = 0; idx < seg_num; idx++) {
+        pkt.len += segs[idx].len;
+    }
+    pkt.segs = segs;
+    pkt.seg_num = seg_num;
+    pkt.total_len = total_len;
+    AI_PROTO_D("send segs, type:%d, num:%d", type, seg_num);
+    if (pkt.len == pkt.total_len) {
+        return tuya_ai_basic_pkt_send(&pkt);
+    } else {
+        return tuya_ai_basic_pkt_frag_send(&pkt);
+    }
+}
+
 // such as f47ac10b-58cc-42d5-0136-4067a8e7d6b3
 OPERATE_RET tuya_ai_basic_uuid_v4(char *uuid_str)
 {
@@ -85,6 +85,7 @@ OPERATE_RET tuya_authorize_write(const char *uuid, const char *authkey)
         (OPRT_OK == tal_kv_set(KVKEY_TYOPEN_AUTHKEY, (const uint8_t *)authkey, AUTHKEY_LENGTH))) {
         PR_INFO("Authorization write succeeds.");
 
+        tal_kv_flush();
         tal_system_reset();
         return OPRT_OK;
     } else {
@@ -103,21 +104,16 @@ OPERATE_RET tuya_authorize_write(const char *uuid, const char *authkey)
  */
 OPERATE_RET tuya_authorize_read(tuya_iot_license_t *license)
 {
-    char *uuid = NULL;
-    char *authkey = NULL;
-    size_t readlen = 0;
+    size_t uuid_len = UUID_LENGTH;
+    size_t authkey_len = AUTHKEY_LENGTH;
 
-    if ((OPRT_OK == tal_kv_get(KVKEY_TYOPEN_UUID, (uint8_t **)&uuid, &readlen)) &&
-        (OPRT_OK == tal_kv_get(KVKEY_TYOPEN_AUTHKEY, (uint8_t **)&authkey, &readlen))) {
+    if ((OPRT_OK == tal_kv_get_into(KVKEY_TYOPEN_UUID, (uint8_t *)UUID_BUF, &uuid_len)) &&
+        (OPRT_OK == tal_kv_get_into(KVKEY_TYOPEN_AUTHKEY, (uint8_t *)AUTHKEY_BUF, &authkey_len))) {
         // KV read
-        memcpy(UUID_BUF, uuid, UUID_LENGTH);
-        UUID_BUF[UUID_LENGTH] = '\0';
-        memcpy(AUTHKEY_BUF, authkey, AUTHKEY_LENGTH);
-        AUTHKEY_BUF[AUTHKEY_LENGTH] = '\0';
+        UUID_BUF[uuid_len] = '\0';
+        AUTHKEY_BUF[authkey_len] = '\0';
         license->uuid = UUID_BUF;
         license->authkey = AUTHKEY_BUF;
-        tal_kv_free((uint8_t *)uuid);
-        tal_kv_free((uint8_t *)authkey);
         PR_INFO("Authorization read succeeds.");
         return OPRT_OK;
     } else {
@@ -17,6 +17,16 @@
 
 static uint8_t service_rand[16] = {0};
 
+typedef struct {
+    TKL_SYMMETRY_HANDLE ctx;
+    bool key_set;
+    uint8_t key[16];
+} ble_aes_ctx_t;
+
+//! one context per direction, indexed by TAL_SYMMETRY_CRYPT_MODE, the key
+//! schedule is only redone when the key changes
+static ble_aes_ctx_t s_aes_ctx[2];
+
 static bool ble_key_generate(ble_crypto_param_t *p, uint8_t mode, uint8_t *key_out)
 {
     uint16_t len = 0;
@@ -104,6 +114,28 @@ static bool ble_key_generate(ble_crypto_param_t *p, uint8_t mode, uint8_t *key_o
     return true;
 }
 
+static int ble_aes128_cbc(int32_t mode, uint8_t *key, uint8_t *iv, uint8_t *in_buf, uint32_t len, uint8_t *out_buf)
+{
+    int rt = OPRT_OK;
+    ble_aes_ctx_t *aes = &s_aes_ctx[SYMMETRY_ENCRYPT == mode ? SYMMETRY_ENCRYPT : SYMMETRY_DECRYPT];
+
+    if (NULL == aes->ctx) {
+        TUYA_CALL_ERR_RETURN(tal_aes_create_init(&aes->ctx));
+    }
+    if (!aes->key_set || memcmp(aes->key, key, sizeof(aes->key))) {
+        aes->key_set = false;
+        if (SYMMETRY_ENCRYPT == mode) {
+            TUYA_CALL_ERR_RETURN(tal_aes_setkey_enc(aes->ctx, key, 128));
+        } else {
+            TUYA_CALL_ERR_RETURN(tal_aes_setkey_dec(aes->ctx, key, 128));
+        }
+        memcpy(aes->key, key, sizeof(aes->key));
+        aes->key_set = true;
+    }
+
+    return tal_aes_crypt_cbc(aes->ctx, mode, len, iv, in_buf, out_buf);
+}
+
 static uint16_t ble_add_pkcs(uint8_t *p, uint16_t len)
 {
     uint8_t pkcs[16];
@@ -232,7 +264,9 @@ int tuya_ble_rsp_id_encrypt(uint8_t *key, uint8_t key_len, uint8_t *in_buf, uint
  * @param in_buf            Pointer to the input buffer.
  * @param in_len            Length of the input buffer.
  * @param out_len           Pointer to store the length of the output buffer.
- * @param out_buf           Pointer to the output buffer.
+ * @param out_buf           Pointer to the output buffer, may be in_buf.
+ *
+ * @note in_buf is padded in place, it must have room for up to 15 more bytes.
  *
  * @return                  0 if encryption is successful.
  *                          2 if the encryption mode is invalid.
@@ -250,7 +284,9 @@ uint8_t tuya_ble_encryption(ble_crypto_param_t *p, uint8_t encryption_mode, uint
     }
 
     if (encryption_mode == ENCRYPTION_MODE_NONE) {
-        memcpy(out_buf, in_buf, in_len);
+        if (out_buf != in_buf) {
+            memcpy(out_buf, in_buf, in_len);
+        }
         *out_len = in_len;
         return 0;
     } else {
@@ -260,7 +296,7 @@ uint8_t tuya_ble_encryption(ble_crypto_param_t *p, uint8_t encryption_mode, uint
     memset(key, 0, sizeof(key));
     if (ble_key_generate(p, encryption_mode, key)) {
         *out_len = len;
-        int rt = tal_aes128_cbc_encode_raw(in_buf, len, key, iv, out_buf);
+        int rt = ble_aes128_cbc(SYMMETRY_ENCRYPT, key, iv, in_buf, len, out_buf);
         return rt == OPRT_OK ? 0 : 3;
     }
 
@@ -281,7 +317,8 @@ uint8_t tuya_ble_encryption(ble_crypto_param_t *p, uint8_t encryption_mode, uint
  * @param out_len   Pointer to a variable that will store the length of the
  *                  decrypted data.
  * @param out_buf   Pointer to the output buffer where the decrypted data will
- *                  be stored.
+ *                  be stored, may be in_buf + 17, or in_buf + 1 for
+ *                  ENCRYPTION_MODE_NONE.
  *
  * @return          Returns `0` on success, or an error code if decryption
  * fails.
@@ -304,7 +341,7 @@ uint8_t tuya_ble_decryption(ble_crypto_param_t *p, uint8_t *in_buf, uint32_t in_
 
     if (in_buf[0] == ENCRYPTION_MODE_NONE) {
         len = in_len - 1;
-        memcpy(out_buf, in_buf + 1, len);
+        memmove(out_buf, in_buf + 1, len);
         *out_len = len;
         return 0;
     }
@@ -322,13 +359,51 @@ uint8_t tuya_ble_decryption(ble_crypto_param_t *p, uint8_t *in_buf, uint32_t in_
     if (ble_key_generate(p, mode, key)) {
         memcpy(IV, in_buf + 1, 16);
         *out_len = len;
-        int rt = tal_aes128_cbc_decode_raw((uint8_t *)(in_buf + 17), len, key, IV, out_buf);
+        int rt = ble_aes128_cbc(SYMMETRY_DECRYPT, key, IV, (uint8_t *)(in_buf + 17), len, out_buf);
         return rt == OPRT_OK ? 0 : 3;
     }
 
     return 4;
 }
 
+/**
+ * @brief Decrypts a received frame in its own buffer.
+ *
+ * @param p         Pointer to the `ble_crypto_param_t` structure containing the
+ *                  encryption parameters.
+ * @param buf       The frame, flag and iv followed by the encrypted data.
+ * @param len       Length of the frame.
+ * @param out       Set to the decrypted data inside buf.
+ * @param out_len   Length of the decrypted data.
+ *
+ * @return          Returns `0` on success, or an error code as
+ *                  tuya_ble_decryption() does.
+ */
+uint8_t tuya_ble_decryption_inplace(ble_crypto_param_t *p, uint8_t *buf, uint32_t len, uint8_t **out,
+                                    uint32_t *out_len)
+{
+    if (len < 17) {
+        return 1;
+    }
+
+    *out = buf + (ENCRYPTION_MODE_NONE == buf[0] ? 1 : 17);
+
+    return tuya_ble_decryption(p, buf, len, out_len, *out);
+}
+
+/**
+ * @brief Releases the AES contexts kept between packets.
+ */
+void tuya_ble_cryption_deinit(void)
+{
+    for (int i = 0; i < sizeof(s_aes_ctx) / sizeof(s_aes_ctx[0]); i++) {
+        if (s_aes_ctx[i].ctx) {
+            tal_aes_free(s_aes_ctx[i].ctx);
+        }
+    }
+    memset(s_aes_ctx, 0, sizeof(s_aes_ctx));
+}
+
 /**
  * @brief Compresses the given ID using a specific algorithm.
  *
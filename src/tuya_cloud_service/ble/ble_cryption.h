@@ -80,6 +80,25 @@ uint8_t tuya_ble_encryption(ble_crypto_param_t *p, uint8_t encryption_mode, uint
 uint8_t tuya_ble_decryption(ble_crypto_param_t *p, uint8_t *in_buf, uint32_t in_len, uint32_t *out_len,
                             uint8_t *out_buf);
 
+/**
+ * @brief Decrypts a received frame in its own buffer.
+ *
+ * @param p Pointer to the BLE crypto parameters.
+ * @param buf The frame, flag and iv followed by the encrypted data.
+ * @param len Length of the frame.
+ * @param out Set to the decrypted data inside buf.
+ * @param out_len Length of the decrypted data.
+ *
+ * @return Returns 0 on success, or an error code on failure.
+ */
+uint8_t tuya_ble_decryption_inplace(ble_crypto_param_t *p, uint8_t *buf, uint32_t len, uint8_t **out,
+                                    uint32_t *out_len);
+
+/**
+ * @brief Releases the AES contexts kept between packets.
+ */
+void tuya_ble_cryption_deinit(void);
+
 /**
  * @brief Generates a key for registering with Tuya BLE.
  *
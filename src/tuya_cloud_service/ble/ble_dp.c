@@ -51,6 +51,24 @@ typedef struct s_klv_node {
     uint8_t *data;
 } klv_node_s;
 
+// untimed obj reports within this many ms are sent as one frame, 0 sends each at once
+#ifndef TUYA_BLE_DP_BATCH_MS
+#define TUYA_BLE_DP_BATCH_MS 0
+#endif
+
+#if TUYA_BLE_DP_BATCH_MS > 0
+//! the klv header of a node in a v4 report
+#define DP_BATCH_NODE_HEAD 4
+
+static struct {
+    MUTEX_HANDLE mutex;
+    DELAYED_WORK_HANDLE work;
+    klv_node_s *list;
+    uint32_t len;
+    BOOL_T armed; // the flush is started by the first report of a batch, later ones do not delay it
+} s_dp_batch;
+#endif
+
 void tuya_change_bt_dp_tlv(dp_type type, void *data, uint16_t *len)
 {
     if (DT_ENUM == type) {
@@ -496,6 +514,66 @@ uint32_t __dp_get_time_stamp(dp_obj_t *dp_data, const uint32_t cnt)
     return dp_data[0].time_stamp;
 }
 
+#if TUYA_BLE_DP_BATCH_MS > 0
+static void __dp_batch_flush(void *data)
+{
+    tal_mutex_lock(s_dp_batch.mutex);
+    klv_node_s *list = s_dp_batch.list;
+    s_dp_batch.list = NULL;
+    s_dp_batch.len = 0;
+    s_dp_batch.armed = FALSE;
+    tal_mutex_unlock(s_dp_batch.mutex);
+
+    if (list) {
+        ty_bt_dp_data_report(list, 0);
+    }
+}
+
+//! takes the nodes of list, a dp already pending gets the new value
+static OPERATE_RET __dp_batch_add(klv_node_s *list)
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    if (NULL == s_dp_batch.mutex) {
+        TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&s_dp_batch.mutex));
+        TUYA_CALL_ERR_RETURN(tal_workq_init_delayed(WORKQ_SYSTEM, __dp_batch_flush, NULL, &s_dp_batch.work));
+    }
+
+    tal_mutex_lock(s_dp_batch.mutex);
+    while (list) {
+        klv_node_s *node = list;
+        list = list->next;
+
+        for (klv_node_s **pp = &s_dp_batch.list; *pp; pp = &(*pp)->next) {
+            if ((*pp)->id == node->id) {
+                klv_node_s *old = *pp;
+                *pp = old->next;
+                s_dp_batch.len -= DP_BATCH_NODE_HEAD + old->len;
+                old->next = NULL;
+                free_klv_list(old);
+                break;
+            }
+        }
+        if (s_dp_batch.list &&
+            s_dp_batch.len + DP_BATCH_NODE_HEAD + node->len > TUYA_BLE_TRANSMISSION_MAX_DATA_LEN - 16) {
+            tal_mutex_unlock(s_dp_batch.mutex);
+            __dp_batch_flush(NULL);
+            tal_mutex_lock(s_dp_batch.mutex);
+        }
+        node->next = s_dp_batch.list;
+        s_dp_batch.list = node;
+        s_dp_batch.len += DP_BATCH_NODE_HEAD + node->len;
+    }
+    if (!s_dp_batch.armed) {
+        s_dp_batch.armed = TRUE;
+        rt = tal_workq_start_delayed(s_dp_batch.work, TUYA_BLE_DP_BATCH_MS, LOOP_ONCE);
+    }
+    tal_mutex_unlock(s_dp_batch.mutex);
+
+    return rt;
+}
+#endif
+
 static int ble_dp_report(const dp_rept_in_t *dpin)
 {
     klv_node_s *p_node = NULL;
@@ -523,6 +601,13 @@ static int ble_dp_report(const dp_rept_in_t *dpin)
         return OPRT_INVALID_PARM;
     }
 
+#if TUYA_BLE_DP_BATCH_MS > 0
+    //! a frame carries one time stamp, so timed reports go alone
+    if (T_OBJ_REPT == dpin->rept_type && 0 == time_stamp && p_node) {
+        return __dp_batch_add(p_node);
+    }
+#endif
+
     return ty_bt_dp_data_report(p_node, time_stamp);
 }
 
@@ -47,6 +47,7 @@ typedef struct {
     void *user_data;
     uint8_t *raw_data;
     size_t raw_data_len;
+    size_t raw_data_offset; // position of raw_data in a streamed MATOP response
 } atop_base_response_t;
 
 /**
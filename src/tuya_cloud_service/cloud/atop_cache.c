@@ -0,0 +1,243 @@
+/**
+ * @file atop_cache.c
+ * @brief Cache of atop results kept in KV, see atop_cache.h.
+ *
+ * Every result is printed to one KV value named after the CRC32 of its key,
+ * with its terminating NUL.
+ * An index of the cached keys and their fetch times is kept in RAM and in one
+ * more KV value, so a lookup reads KV only on a hit.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include "tuya_config_defaults.h"
+#include "atop_cache.h"
+#include "tal_api.h"
+#include "crc32i.h"
+
+#define ATOP_CACHE_INDEX_KEY     "atop_c_idx"
+#define ATOP_CACHE_INDEX_VERSION 1
+#define ATOP_CACHE_KEY_FMT       "atop_c_%08x"
+
+typedef struct {
+    uint32_t id;   // CRC32 of the key, 0 for a free slot
+    uint32_t time; // when the result was fetched
+} atop_cache_entry_t;
+
+static struct {
+    MUTEX_HANDLE mutex;
+    bool loaded;
+    atop_cache_entry_t entries[ATOP_CACHE_MAX];
+} s_cache;
+
+static void cache_kv_key(uint32_t id, char key[TAL_LV_KEY_LEN])
+{
+    snprintf(key, TAL_LV_KEY_LEN, ATOP_CACHE_KEY_FMT, id);
+}
+
+static void cache_index_load(void)
+{
+    uint8_t *buf = NULL;
+    size_t len = 0;
+
+    s_cache.loaded = true;
+    if (OPRT_OK != tal_kv_get(ATOP_CACHE_INDEX_KEY, &buf, &len)) {
+        return;
+    }
+    if (len == 1 + sizeof(s_cache.entries) && ATOP_CACHE_INDEX_VERSION == buf[0]) {
+        memcpy(s_cache.entries, buf + 1, sizeof(s_cache.entries));
+    }
+    tal_kv_free(buf);
+}
+
+static int cache_index_save(void)
+{
+    uint8_t buf[1 + sizeof(s_cache.entries)];
+
+    buf[0] = ATOP_CACHE_INDEX_VERSION;
+    memcpy(buf + 1, s_cache.entries, sizeof(s_cache.entries));
+    return tal_kv_set(ATOP_CACHE_INDEX_KEY, buf, sizeof(buf));
+}
+
+static int cache_init(void)
+{
+    int rt = OPRT_OK;
+
+    if (NULL == s_cache.mutex) {
+        TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&s_cache.mutex));
+    }
+
+    tal_mutex_lock(s_cache.mutex);
+    if (!s_cache.loaded) {
+        cache_index_load();
+    }
+    tal_mutex_unlock(s_cache.mutex);
+
+    return rt;
+}
+
+static atop_cache_entry_t *cache_find(uint32_t id)
+{
+    for (int i = 0; i < ATOP_CACHE_MAX; i++) {
+        if (s_cache.entries[i].id == id) {
+            return &s_cache.entries[i];
+        }
+    }
+    return NULL;
+}
+
+//! the cached result if it is younger than max_age_s, to be freed by the caller
+static cJSON *cache_result_get(uint32_t id, uint32_t max_age_s, uint32_t *time)
+{
+    char key[TAL_LV_KEY_LEN];
+    uint8_t *buf = NULL;
+    size_t len = 0;
+    cJSON *result = NULL;
+    TIME_T now = tal_time_get_posix();
+
+    if (OPRT_OK != tal_time_check_time_sync()) {
+        return NULL;
+    }
+
+    tal_mutex_lock(s_cache.mutex);
+    atop_cache_entry_t *entry = cache_find(id);
+    if (NULL == entry || now < entry->time || now - entry->time >= max_age_s) {
+        tal_mutex_unlock(s_cache.mutex);
+        return NULL;
+    }
+    *time = entry->time;
+    cache_kv_key(id, key);
+    if (OPRT_OK == tal_kv_get(key, &buf, &len)) {
+        if (len && '\0' == buf[len - 1]) {
+            result = cJSON_Parse((const char *)buf);
+        }
+        tal_kv_free(buf);
+    }
+    tal_mutex_unlock(s_cache.mutex);
+
+    return result;
+}
+
+static void cache_result_set(uint32_t id, cJSON *result)
+{
+    char key[TAL_LV_KEY_LEN];
+    char *str = cJSON_PrintUnformatted(result);
+
+    if (NULL == str) {
+        return;
+    }
+
+    tal_mutex_lock(s_cache.mutex);
+    atop_cache_entry_t *entry = cache_find(id);
+    if (NULL == entry) {
+        //! a free slot has time 0, so it is taken before any result
+        entry = &s_cache.entries[0];
+        for (int i = 1; i < ATOP_CACHE_MAX; i++) {
+            if (s_cache.entries[i].time < entry->time) {
+                entry = &s_cache.entries[i];
+            }
+        }
+        if (entry->id) {
+            cache_kv_key(entry->id, key);
+            tal_kv_del(key);
+        }
+    }
+    entry->id = id;
+    entry->time = tal_time_get_posix();
+    cache_kv_key(id, key);
+    if (OPRT_OK != tal_kv_set(key, (const uint8_t *)str, strlen(str) + 1)) {
+        memset(entry, 0, sizeof(atop_cache_entry_t));
+    }
+    cache_index_save();
+    tal_mutex_unlock(s_cache.mutex);
+
+    cJSON_free(str);
+}
+
+static void cache_response_fill(atop_base_response_t *response, cJSON *result, uint32_t time)
+{
+    memset(response, 0, sizeof(atop_base_response_t));
+    response->success = true;
+    response->result = result;
+    response->t = time;
+}
+
+/**
+ * @brief Gets the result of an atop request from the cache, or fetches it.
+ *
+ * @param key Names the request, the same key must always mean the same request.
+ * @param ttl_s How long a cached result is used, in seconds.
+ * @param fetch Sends the request when there is no usable result.
+ * @param arg Passed to fetch.
+ * @param response Filled as by atop_base_request(), t is the time the result
+ * was fetched, free it with atop_base_response_free().
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+int atop_cache_request(const char *key, uint32_t ttl_s, atop_cache_fetch_t fetch, void *arg,
+                       atop_base_response_t *response)
+{
+    int rt = OPRT_OK;
+    uint32_t time = 0;
+    cJSON *result = NULL;
+
+    if (NULL == key || NULL == fetch || NULL == response) {
+        return OPRT_INVALID_PARM;
+    }
+    TUYA_CALL_ERR_RETURN(cache_init());
+
+    uint32_t id = hash_crc32i_total(key, strlen(key));
+    if (0 == id) {
+        id = 1;
+    }
+
+    result = cache_result_get(id, ttl_s, &time);
+    if (result) {
+        PR_DEBUG("atop cache hit %s", key);
+        cache_response_fill(response, result, time);
+        return OPRT_OK;
+    }
+
+    memset(response, 0, sizeof(atop_base_response_t));
+    rt = fetch(arg, response);
+    if (OPRT_OK == rt && response->success && response->result) {
+        cache_result_set(id, response->result);
+        return OPRT_OK;
+    }
+
+    result = cache_result_get(id, ATOP_CACHE_STALE_MAX_S, &time);
+    if (result) {
+        PR_WARN("atop fetch %s error:%d, return result of %d", key, rt, time);
+        atop_base_response_free(response);
+        cache_response_fill(response, result, time);
+        return OPRT_OK;
+    }
+
+    return rt;
+}
+
+/**
+ * @brief Drops all cached results and their KV copies.
+ *
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+int atop_cache_clear(void)
+{
+    int rt = OPRT_OK;
+    char key[TAL_LV_KEY_LEN];
+
+    TUYA_CALL_ERR_RETURN(cache_init());
+
+    tal_mutex_lock(s_cache.mutex);
+    for (int i = 0; i < ATOP_CACHE_MAX; i++) {
+        if (s_cache.entries[i].id) {
+            cache_kv_key(s_cache.entries[i].id, key);
+            tal_kv_del(key);
+        }
+    }
+    memset(s_cache.entries, 0, sizeof(s_cache.entries));
+    tal_kv_del(ATOP_CACHE_INDEX_KEY);
+    tal_mutex_unlock(s_cache.mutex);
+
+    return rt;
+}
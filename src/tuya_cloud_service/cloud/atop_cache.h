@@ -0,0 +1,61 @@
+/**
+ * @file atop_cache.h
+ * @brief Cache of atop results kept in KV.
+ *
+ * The result object of a successful atop request is kept under a key chosen
+ * by the caller, together with the time it was fetched. A request for the same
+ * key is answered from the cache while the result is younger than the TTL
+ * given by the caller, so data polled often, like weather for a clock face,
+ * costs no HTTPS request and survives a reboot. When fetching a new result
+ * fails, a result up to ATOP_CACHE_STALE_MAX_S old is returned instead.
+ *
+ * At most ATOP_CACHE_MAX results are kept, the oldest one makes room.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __ATOP_CACHE_H__
+#define __ATOP_CACHE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "tuya_cloud_types.h"
+#include "atop_base.h"
+
+/**
+ * @brief Sends the atop request whose result is cached.
+ *
+ * @param arg The argument given to atop_cache_request().
+ * @param response The response to fill, as atop_base_request() does.
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+typedef int (*atop_cache_fetch_t)(void *arg, atop_base_response_t *response);
+
+/**
+ * @brief Gets the result of an atop request from the cache, or fetches it.
+ *
+ * @param key Names the request, the same key must always mean the same request.
+ * @param ttl_s How long a cached result is used, in seconds.
+ * @param fetch Sends the request when there is no usable result.
+ * @param arg Passed to fetch.
+ * @param response Filled as by atop_base_request(), t is the time the result
+ * was fetched, free it with atop_base_response_free().
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+int atop_cache_request(const char *key, uint32_t ttl_s, atop_cache_fetch_t fetch, void *arg,
+                       atop_base_response_t *response);
+
+/**
+ * @brief Drops all cached results and their KV copies.
+ *
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+int atop_cache_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -20,6 +20,47 @@
 
 #define MATOP_DEFAULT_BUFFER_LEN (128)
 
+#define MATOP_DEADLINE_PASSED(deadline, now) ((int32_t)((now) - (deadline)) >= 0)
+
+/* -------------------------------------------------------------------------- */
+/*                               Request table                                */
+/* -------------------------------------------------------------------------- */
+static void matop_message_table_init(matop_context_t *matop)
+{
+    bitmap_alloc_init(&matop->message_free, matop->message_free_words, MATOP_INFLIGHT_MAX);
+    hash_map_init(&matop->message_map, matop->message_slots, MATOP_MESSAGE_MAP_SLOTS, HASH_MAP_KEY_INT);
+    min_heap_init(&matop->deadlines, matop->deadline_nodes, MATOP_INFLIGHT_MAX);
+}
+
+static mqtt_atop_message_t *matop_message_alloc(matop_context_t *matop, uint32_t timeout)
+{
+    int32_t index = bitmap_alloc_get(&matop->message_free);
+    if (index < 0) {
+        return NULL;
+    }
+
+    mqtt_atop_message_t *message = &matop->message_pool[index];
+    memset(message, 0, sizeof(mqtt_atop_message_t));
+    min_heap_node_init(&message->deadline);
+
+    /* skip ids still waiting for a response after the counter wrapped */
+    do {
+        message->id = (uint16_t)++matop->id_cnt;
+    } while (hash_map_get(&matop->message_map, message->id));
+
+    message->timeout = timeout;
+    hash_map_put(&matop->message_map, message->id, message, NULL);
+    min_heap_push(&matop->deadlines, &message->deadline, (uint32_t)tal_system_get_millisecond() + timeout);
+    return message;
+}
+
+static void matop_message_free(matop_context_t *matop, mqtt_atop_message_t *message)
+{
+    hash_map_remove(&matop->message_map, message->id);
+    min_heap_remove(&matop->deadlines, &message->deadline);
+    bitmap_alloc_put(&matop->message_free, (uint32_t)(message - matop->message_pool));
+}
+
 /* -------------------------------------------------------------------------- */
 /*                              Internal callback                             */
 /* -------------------------------------------------------------------------- */
@@ -45,14 +86,16 @@ static int matop_service_data_receive_cb(void *context, const uint8_t *input, si
     uint16_t id = cJSON_GetObjectItem(root, "id")->valueint;
     cJSON *data = cJSON_GetObjectItem(root, "data");
 
-    /* found message id */
-    mqtt_atop_message_t *target_message = matop->message_list;
-    while (target_message) {
-        if (target_message->id == id) {
-            break;
-        }
-        target_message = target_message->next;
+    /* found message id, the entry is released before the callback so that it
+     * can send the next request */
+    tal_mutex_lock(matop->mutex);
+    mqtt_atop_message_t *target_message = hash_map_get(&matop->message_map, id);
+    mqtt_atop_message_t message = {0};
+    if (target_message) {
+        message = *target_message;
+        matop_message_free(matop, target_message);
     }
+    tal_mutex_unlock(matop->mutex);
 
     if (target_message == NULL) {
         PR_WARN("not found id.");
@@ -73,25 +116,13 @@ static int matop_service_data_receive_cb(void *context, const uint8_t *input, si
     atop_base_response_t response = {.success = success,
                                      .result = result,
                                      .t = success ? cJSON_GetObjectItem(data, "t")->valueint : 0,
-                                     .user_data = target_message->user_data};
+                                     .user_data = message.user_data};
 
-    if (target_message->notify_cb) {
-        target_message->notify_cb(&response, target_message->user_data);
+    if (message.notify_cb) {
+        message.notify_cb(&response, message.user_data);
     }
 
     cJSON_Delete(root);
-
-    /* remove target from list  */
-    mqtt_atop_message_t **current;
-    for (current = &matop->message_list; *current;) {
-        mqtt_atop_message_t *entry = *current;
-        if (entry == target_message) {
-            *current = entry->next;
-            tal_free(entry);
-        } else {
-            current = &entry->next;
-        }
-    }
     return 0;
 }
 
@@ -107,14 +138,21 @@ static int matop_service_file_rawdata_receive_cb(void *context, const uint8_t *i
     uint32_t id = ((input[0] & 0xff) << 24) | ((input[1] & 0xff) << 16) | ((input[2] & 0xff) << 8) | (input[3] & 0xff);
     PR_INFO("file data id:%d", id);
 
-    /* found message id */
-    mqtt_atop_message_t *target_message = matop->message_list;
-    while (target_message) {
-        if (target_message->id == id) {
-            break;
+    /* found message id, a streamed request stays until its last piece */
+    tal_mutex_lock(matop->mutex);
+    mqtt_atop_message_t *target_message = hash_map_get(&matop->message_map, (uint16_t)id);
+    mqtt_atop_message_t message = {0};
+    if (target_message) {
+        message = *target_message;
+        target_message->received += ilen - sizeof(uint32_t);
+        if (target_message->received < target_message->stream_len) {
+            min_heap_update(&matop->deadlines, &target_message->deadline,
+                            (uint32_t)tal_system_get_millisecond() + target_message->timeout);
+        } else {
+            matop_message_free(matop, target_message);
         }
-        target_message = target_message->next;
     }
+    tal_mutex_unlock(matop->mutex);
 
     if (target_message == NULL) {
         PR_WARN("not found id.");
@@ -127,23 +165,12 @@ static int matop_service_file_rawdata_receive_cb(void *context, const uint8_t *i
         .t = 0,
         .raw_data = (uint8_t *)(input + sizeof(uint32_t)),
         .raw_data_len = ilen - sizeof(uint32_t),
-        .user_data = target_message->user_data,
+        .raw_data_offset = message.received,
+        .user_data = message.user_data,
     };
 
-    if (target_message->notify_cb) {
-        target_message->notify_cb(&response, target_message->user_data);
-    }
-
-    /* remove target from list  */
-    mqtt_atop_message_t **current;
-    for (current = &matop->message_list; *current;) {
-        mqtt_atop_message_t *entry = *current;
-        if (entry == target_message) {
-            *current = entry->next;
-            tal_free(entry);
-        } else {
-            current = &entry->next;
-        }
+    if (message.notify_cb) {
+        message.notify_cb(&response, message.user_data);
     }
     return 0;
 }
@@ -190,6 +217,13 @@ int matop_serice_init(matop_context_t *context, const matop_config_t *config)
 
     memset(context, 0, sizeof(matop_context_t));
     context->config = *config;
+    matop_message_table_init(context);
+
+    ret = tal_mutex_create_init(&context->mutex);
+    if (ret != OPRT_OK) {
+        PR_ERR("mutex create error:%d", ret);
+        return ret;
+    }
 
     sprintf(topic_buffer, "rpc/rsp/%s", config->devid);
     ret = tuya_mqtt_subscribe_message_callback_register(context->config.mqctx, topic_buffer,
@@ -214,8 +248,8 @@ int matop_serice_init(matop_context_t *context, const matop_config_t *config)
 /**
  * @brief Performs a yield operation for the MATOP service.
  *
- * This function removes the target from the message list if it has timed out.
- * If a timeout occurs, the corresponding callback function is called with a
+ * This function removes every request that has timed out from the request
+ * table, the earliest deadline first, and calls its callback function with a
  * failure response.
  *
  * @param context The MATOP context.
@@ -228,23 +262,33 @@ int matop_serice_yield(matop_context_t *context)
         return OPRT_INVALID_PARM;
     }
 
-    /* remove target from list  */
-    mqtt_atop_message_t **current;
-    for (current = &context->message_list; *current;) {
-        mqtt_atop_message_t *entry = *current;
-        if (tal_system_get_millisecond() > entry->timeout) {
-            PR_WARN("Message id %d timeout.", entry->id);
-            if (entry->notify_cb) {
-                entry->notify_cb(&(atop_base_response_t){.success = false}, entry->user_data);
-            }
-            *current = entry->next;
-            tal_free(entry);
-            return OPRT_TIMEOUT;
-        } else {
-            current = &entry->next;
+    /* destroyed, nothing in flight */
+    if (context->mutex == NULL) {
+        return OPRT_OK;
+    }
+
+    int rt = OPRT_OK;
+    uint32_t now = (uint32_t)tal_system_get_millisecond();
+
+    for (;;) {
+        tal_mutex_lock(context->mutex);
+        MIN_HEAP_NODE_T *node = min_heap_peek(&context->deadlines);
+        if (node == NULL || !MATOP_DEADLINE_PASSED(node->key, now)) {
+            tal_mutex_unlock(context->mutex);
+            break;
+        }
+        mqtt_atop_message_t *entry = MIN_HEAP_ENTRY(node, mqtt_atop_message_t, deadline);
+        mqtt_atop_message_t message = *entry;
+        matop_message_free(context, entry);
+        tal_mutex_unlock(context->mutex);
+
+        PR_WARN("Message id %d timeout.", message.id);
+        if (message.notify_cb) {
+            message.notify_cb(&(atop_base_response_t){.success = false}, message.user_data);
         }
+        rt = OPRT_TIMEOUT;
     }
-    return OPRT_OK;
+    return rt;
 }
 
 /**
@@ -274,12 +318,13 @@ int matop_serice_destory(matop_context_t *context)
     tuya_mqtt_subscribe_message_callback_unregister(context->config.mqctx, topic_buffer);
     PR_DEBUG("MQTT unsubscribe %s result:%d", topic_buffer, ret);
 
-    /* remove target from list when destory */
-    mqtt_atop_message_t **current;
-    for (current = &context->message_list; *current;) {
-        mqtt_atop_message_t *entry = *current;
-        *current = entry->next;
-        tal_free(entry);
+    /* drop the requests in flight when destory */
+    if (context->mutex) {
+        tal_mutex_lock(context->mutex);
+        matop_message_table_init(context);
+        tal_mutex_unlock(context->mutex);
+        tal_mutex_release(context->mutex);
+        context->mutex = NULL;
     }
 
     return OPRT_OK;
@@ -289,17 +334,20 @@ int matop_serice_destory(matop_context_t *context)
  * @brief Sends an asynchronous request to the matop service.
  *
  * This function sends an asynchronous request to the matop service using the
- * provided context, request, notification callback, and user data. It handles
- * the initialization of the request message and the creation of the request
- * buffer. The request buffer is formatted with the necessary data and sent to
- * the matop service using the `matop_request_send` function.
+ * provided context, request, notification callback, and user data. The request
+ * takes an entry of the request table before it is sent, so any number of
+ * requests up to MATOP_INFLIGHT_MAX can wait for their responses at the same
+ * time and their round trips overlap. The request buffer is formatted with the
+ * necessary data and sent to the matop service using the `matop_request_send`
+ * function.
  *
  * @param context The matop context.
  * @param request The MQTT atop request.
  * @param notify_cb The notification callback function.
  * @param user_data The user data to be passed to the notification callback.
- * @return Returns OPRT_OK if the request was sent successfully, otherwise
- * returns an error code.
+ * @return Returns OPRT_OK if the request was sent successfully,
+ * OPRT_EXCEED_UPPER_LIMIT when MATOP_INFLIGHT_MAX requests are in flight,
+ * otherwise returns an error code.
  */
 int matop_service_request_async(matop_context_t *context, const mqtt_atop_request_t *request,
                                 mqtt_atop_response_cb_t notify_cb, void *user_data)
@@ -308,21 +356,29 @@ int matop_service_request_async(matop_context_t *context, const mqtt_atop_reques
         return OPRT_INVALID_PARM;
     }
 
+    if (NULL == context->mutex) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
     int rt = OPRT_OK;
     matop_context_t *matop = context;
 
-    /* handle init */
-    mqtt_atop_message_t *message_handle = tal_malloc(sizeof(mqtt_atop_message_t));
+    /* handle init, before the send so that a fast response finds it */
+    tal_mutex_lock(matop->mutex);
+    uint16_t id = 0;
+    mqtt_atop_message_t *message_handle =
+        matop_message_alloc(matop, request->timeout == 0 ? MATOP_TIMEOUT_MS_DEFAULT : request->timeout);
+    if (message_handle) {
+        message_handle->stream_len = request->stream_len;
+        message_handle->notify_cb = notify_cb;
+        message_handle->user_data = user_data;
+        id = message_handle->id;
+    }
+    tal_mutex_unlock(matop->mutex);
     if (message_handle == NULL) {
-        PR_ERR("response_buffer malloc fail");
-        return OPRT_MALLOC_FAILED;
+        PR_ERR("matop request table full");
+        return OPRT_EXCEED_UPPER_LIMIT;
     }
-    message_handle->next = NULL;
-    message_handle->id = ++matop->id_cnt;
-    message_handle->timeout =
-        tal_system_get_millisecond() + (request->timeout == 0 ? MATOP_TIMEOUT_MS_DEFAULT : request->timeout);
-    message_handle->notify_cb = notify_cb;
-    message_handle->user_data = user_data;
 
     /* request buffer make */
     size_t request_datalen = 0;
@@ -330,14 +386,13 @@ int matop_service_request_async(matop_context_t *context, const mqtt_atop_reques
     char *request_buffer = tal_malloc(request_bufferlen);
     if (request_buffer == NULL) {
         PR_ERR("response_buffer malloc fail");
-        tal_free(message_handle);
-        return OPRT_MALLOC_FAILED;
+        rt = OPRT_MALLOC_FAILED;
+        goto __EXIT;
     }
 
     /* buffer format */
-    request_datalen =
-        snprintf(request_buffer, request_bufferlen, "{\"id\":%d,\"a\":\"%s\",\"t\":%d,\"data\":%s", message_handle->id,
-                 request->api, tal_time_get_posix(), request->data ? ((char *)request->data) : "{}");
+    request_datalen = snprintf(request_buffer, request_bufferlen, "{\"id\":%d,\"a\":\"%s\",\"t\":%d,\"data\":%s", id,
+                               request->api, tal_time_get_posix(), request->data ? ((char *)request->data) : "{}");
     if (request->version) {
         request_datalen += snprintf(request_buffer + request_datalen, request_bufferlen - request_datalen,
                                     ",\"v\":\"%s\"", request->version);
@@ -347,27 +402,20 @@ int matop_service_request_async(matop_context_t *context, const mqtt_atop_reques
 
     rt = matop_request_send(matop, (const uint8_t *)request_buffer, request_datalen);
     tal_free(request_buffer);
-
     if (rt != OPRT_OK) {
         PR_ERR("mqtt_atop_request_send error:%d", rt);
-        tal_free(message_handle);
-        return rt;
-    }
-
-    /* first head message */
-    if (matop->message_list == NULL) {
-        matop->message_list = message_handle;
-        return OPRT_OK;
     }
 
-    /* add to message list */
-    mqtt_atop_message_t *target = matop->message_list;
-    while (target->next) {
-        target = target->next;
+__EXIT:
+    /* not sent, give the entry back unless a response already took it */
+    if (rt != OPRT_OK) {
+        tal_mutex_lock(matop->mutex);
+        if (hash_map_get(&matop->message_map, id) == message_handle) {
+            matop_message_free(matop, message_handle);
+        }
+        tal_mutex_unlock(matop->mutex);
     }
-    target->next = message_handle;
-
-    return OPRT_OK;
+    return rt;
 }
 
 /**
@@ -424,6 +472,24 @@ int matop_service_client_reset(matop_context_t *context)
  * service request.
  */
 int matop_service_version_update(matop_context_t *context, const char *versions)
+{
+    return matop_service_version_update_async(context, versions, NULL, context);
+}
+
+/**
+ * @brief Updates the version of the MATOP service and reports the result.
+ *
+ * The same request as matop_service_version_update(), the callback tells
+ * whether the cloud took the versions.
+ *
+ * @param context A pointer to the MATOP context.
+ * @param versions The new version to be updated.
+ * @param notify_cb The callback function to be called with the response.
+ * @param user_data User data to be passed to the callback function.
+ * @return Returns OPRT_OK on success, or an error code on failure.
+ */
+int matop_service_version_update_async(matop_context_t *context, const char *versions,
+                                       mqtt_atop_response_cb_t notify_cb, void *user_data)
 {
     if (NULL == context || NULL == versions) {
         return OPRT_INVALID_PARM;
@@ -431,17 +497,16 @@ int matop_service_version_update(matop_context_t *context, const char *versions)
 
     int rt = OPRT_OK;
 
-    /* post data */
-#define UPDATE_VERSION_BUFFER_LEN 196
+    /* post data, the versions of extension modules can be long */
     size_t buffer_len = 0;
-    char *buffer = tal_malloc(UPDATE_VERSION_BUFFER_LEN);
+    size_t buffer_size = 64 + strlen(versions);
+    char *buffer = tal_malloc(buffer_size);
     if (NULL == buffer) {
         PR_ERR("post buffer malloc fail");
         return OPRT_MALLOC_FAILED;
     }
 
-    buffer_len =
-        snprintf(buffer, UPDATE_VERSION_BUFFER_LEN, "{\"versions\":\"%s\",\"t\":%d}", versions, tal_time_get_posix());
+    buffer_len = snprintf(buffer, buffer_size, "{\"versions\":\"%s\",\"t\":%d}", versions, tal_time_get_posix());
     PR_TRACE("POST JSON:%s", buffer);
 
     /* ATOP service request send */
@@ -452,7 +517,7 @@ int matop_service_version_update(matop_context_t *context, const char *versions)
                                          .data = (uint8_t *)buffer,
                                          .data_len = buffer_len,
                                      },
-                                     NULL, context);
+                                     notify_cb, user_data);
     tal_free(buffer);
     return rt;
 }
@@ -591,23 +656,10 @@ int matop_service_auto_upgrade_info_get(matop_context_t *context, mqtt_atop_resp
     return rt;
 }
 
-/**
- * Downloads a file from a specified URL within a given range.
- *
- * @param context The matop context.
- * @param url The URL of the file to be downloaded.
- * @param range_start The starting byte position of the range to be downloaded.
- * @param range_end The ending byte position of the range to be downloaded.
- * @param timeout_ms The timeout value in milliseconds for the download
- * operation.
- * @param notify_cb The callback function to be called when the download
- * operation completes.
- * @param user_data User data to be passed to the callback function.
- * @return Returns OPRT_OK if the download request was sent successfully,
- * otherwise returns an error code.
- */
-int matop_service_file_download_range(matop_context_t *context, const char *url, int range_start, int range_end,
-                                      uint32_t timeout_ms, mqtt_atop_response_cb_t notify_cb, void *user_data)
+/* file download request, stream_len 0 delivers the first piece only */
+static int matop_service_file_download(matop_context_t *context, const char *url, int range_start, int range_end,
+                                       uint32_t timeout_ms, size_t stream_len, mqtt_atop_response_cb_t notify_cb,
+                                       void *user_data)
 {
     if (NULL == context) {
         return OPRT_INVALID_PARM;
@@ -634,12 +686,61 @@ int matop_service_file_download_range(matop_context_t *context, const char *url,
                                                                   .version = "1.0",
                                                                   .data = (uint8_t *)buffer,
                                                                   .data_len = buffer_len,
-                                                                  .timeout = timeout_ms},
+                                                                  .timeout = timeout_ms,
+                                                                  .stream_len = stream_len},
                                      notify_cb, user_data);
     tal_free(buffer);
     return rt;
 }
 
+/**
+ * Downloads a file from a specified URL within a given range.
+ *
+ * @param context The matop context.
+ * @param url The URL of the file to be downloaded.
+ * @param range_start The starting byte position of the range to be downloaded.
+ * @param range_end The ending byte position of the range to be downloaded.
+ * @param timeout_ms The timeout value in milliseconds for the download
+ * operation.
+ * @param notify_cb The callback function to be called when the download
+ * operation completes.
+ * @param user_data User data to be passed to the callback function.
+ * @return Returns OPRT_OK if the download request was sent successfully,
+ * otherwise returns an error code.
+ */
+int matop_service_file_download_range(matop_context_t *context, const char *url, int range_start, int range_end,
+                                      uint32_t timeout_ms, mqtt_atop_response_cb_t notify_cb, void *user_data)
+{
+    return matop_service_file_download(context, url, range_start, range_end, timeout_ms, 0, notify_cb, user_data);
+}
+
+/**
+ * Downloads a range of a file that the cloud may send in several pieces.
+ *
+ * The request stays in the request table until range_end - range_start + 1
+ * bytes have arrived, every piece is passed to notify_cb with its offset in
+ * raw_data_offset and restarts the timeout.
+ *
+ * @param context The matop context.
+ * @param url The URL of the file to be downloaded.
+ * @param range_start The starting byte position of the range to be downloaded.
+ * @param range_end The ending byte position of the range, inclusive.
+ * @param timeout_ms The timeout value in milliseconds for each piece.
+ * @param notify_cb The callback function to be called for each piece.
+ * @param user_data User data to be passed to the callback function.
+ * @return Returns OPRT_OK if the download request was sent successfully,
+ * otherwise returns an error code.
+ */
+int matop_service_file_download_stream(matop_context_t *context, const char *url, int range_start, int range_end,
+                                       uint32_t timeout_ms, mqtt_atop_response_cb_t notify_cb, void *user_data)
+{
+    if (range_end < range_start) {
+        return OPRT_INVALID_PARM;
+    }
+    return matop_service_file_download(context, url, range_start, range_end, timeout_ms,
+                                       (size_t)(range_end - range_start) + 1, notify_cb, user_data);
+}
+
 /**
  * @brief Puts a reset log for the MATOP service.
  *
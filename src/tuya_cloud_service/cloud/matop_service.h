@@ -23,9 +23,14 @@
 extern "C" {
 #endif
 
+#include "tuya_config_defaults.h"
 #include "atop_base.h"
 #include "atop_service.h"
 #include "mqtt_service.h"
+#include "tal_mutex.h"
+#include "hash_map.h"
+#include "min_heap.h"
+#include "bitmap_alloc.h"
 
 typedef struct {
     const char *api;
@@ -33,14 +38,20 @@ typedef struct {
     uint8_t *data;
     size_t data_len;
     uint32_t timeout;
+    /* total raw file data of the response, 0 ends the request with the first
+     * piece. Otherwise every piece is passed to notify_cb as it arrives, at
+     * raw_data_offset, and each one restarts the timeout. */
+    size_t stream_len;
 } mqtt_atop_request_t;
 
 typedef void (*mqtt_atop_response_cb_t)(atop_base_response_t *response, void *user_data);
 
 typedef struct mqtt_atop_message {
-    struct mqtt_atop_message *next;
+    MIN_HEAP_NODE_T deadline; // keyed by the millisecond it times out at
     uint16_t id;
     uint32_t timeout;
+    size_t stream_len;
+    size_t received;
     mqtt_atop_response_cb_t notify_cb;
     void *user_data;
 } mqtt_atop_message_t;
@@ -50,11 +61,24 @@ typedef struct matop_config {
     const char *devid;
 } matop_config_t;
 
+#define MATOP_MESSAGE_MAP_SLOTS (MATOP_INFLIGHT_MAX * 2)
+
+/* Requests in flight live in a fixed pool: the bitmap hands out free
+ * entries, the map finds an entry by its id and the heap orders them by
+ * deadline, so no request allocates and a response or a timeout sweep never
+ * walks the whole table. */
 typedef struct matop_context {
     matop_config_t config;
     uint32_t id_cnt;
     char resquest_topic[64];
-    mqtt_atop_message_t *message_list;
+    MUTEX_HANDLE mutex;
+    mqtt_atop_message_t message_pool[MATOP_INFLIGHT_MAX];
+    uint32_t message_free_words[BITMAP_ALLOC_WORDS(MATOP_INFLIGHT_MAX)];
+    BITMAP_ALLOC_T message_free;
+    HASH_MAP_SLOT_T message_slots[MATOP_MESSAGE_MAP_SLOTS];
+    HASH_MAP_T message_map;
+    MIN_HEAP_NODE_T *deadline_nodes[MATOP_INFLIGHT_MAX];
+    MIN_HEAP_T deadlines;
 } matop_context_t;
 
 /**
@@ -135,6 +159,19 @@ int matop_service_client_reset(matop_context_t *context);
  */
 int matop_service_version_update(matop_context_t *context, const char *versions);
 
+/**
+ * @brief Updates the version of the matop service and reports the result.
+ *
+ * @param context A pointer to the matop_context_t structure.
+ * @param versions The new version to be set for the matop service.
+ * @param notify_cb The callback function to be called with the response.
+ * @param user_data User data to be passed to the callback function.
+ *
+ * @return Returns 0 on success, or a negative error code on failure.
+ */
+int matop_service_version_update_async(matop_context_t *context, const char *versions,
+                                       mqtt_atop_response_cb_t notify_cb, void *user_data);
+
 /**
  * @brief Updates the upgrade status for the MATOP service.
  *
@@ -195,6 +232,25 @@ int matop_service_auto_upgrade_info_get(matop_context_t *context, mqtt_atop_resp
 int matop_service_file_download_range(matop_context_t *context, const char *url, int range_start, int range_end,
                                       uint32_t timeout_ms, mqtt_atop_response_cb_t notify_cb, void *user_data);
 
+/**
+ * Downloads a range of a file that the cloud may send in several pieces.
+ *
+ * notify_cb is called for every piece with its raw_data_offset in the range,
+ * the request ends when the whole range has arrived or when no piece came
+ * within timeout_ms, the latter with success false.
+ *
+ * @param context The MATOP context.
+ * @param url The URL of the file to download.
+ * @param range_start The starting byte position of the range to download.
+ * @param range_end The ending byte position of the range, inclusive.
+ * @param timeout_ms The timeout value in milliseconds for each piece.
+ * @param notify_cb The callback function to be called for each piece.
+ * @param user_data User-defined data to be passed to the callback function.
+ * @return Returns 0 on success, or a negative error code on failure.
+ */
+int matop_service_file_download_stream(matop_context_t *context, const char *url, int range_start, int range_end,
+                                       uint32_t timeout_ms, mqtt_atop_response_cb_t notify_cb, void *user_data);
+
 /**
  * @brief Puts a reset log for the MATOP service.
  *
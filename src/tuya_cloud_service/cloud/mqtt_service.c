@@ -44,6 +44,23 @@ typedef struct {
     uint8_t data[0];
 } pv22_packet_object_t;
 
+static uint32_t mqtt_topic_hash(const char *topic, size_t *length)
+{
+    // FNV-1a, the length comes for free
+    uint32_t hash = 2166136261U;
+    const char *p = topic;
+
+    for (; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619U;
+    }
+    *length = p - topic;
+
+    return hash;
+}
+
+#define MQTT_SUBSCRIBE_BUCKET(context, hash) (&(context)->subscribe_bucket[(hash) % TUYA_MQTT_SUBSCRIBE_BUCKET_NUM])
+#define MQTT_PROTOCOL_BUCKET(context, id)    (&(context)->protocol_bucket[(id) % TUYA_MQTT_PROTOCOL_BUCKET_NUM])
+
 static int tuya_mqtt_signature_tool(const tuya_meta_info_t *input, tuya_mqtt_access_t *signout)
 {
     if (NULL == input || signout == NULL) {
@@ -119,10 +136,15 @@ int tuya_mqtt_subscribe_message_callback_register(tuya_mqtt_context_t *context,
         return OPRT_COM_ERROR;
     }
 
+    size_t topic_length = 0;
+    uint32_t topic_hash = mqtt_topic_hash(topic, &topic_length);
+    mqtt_subscribe_handle_t **bucket = MQTT_SUBSCRIBE_BUCKET(context, topic_hash);
+
     /* Repetition filter */
-    mqtt_subscribe_handle_t *target = context->subscribe_list;
+    mqtt_subscribe_handle_t *target = *bucket;
     while (target) {
-        if (!memcmp(target->topic, topic, target->topic_length) && target->cb == cb) {
+        if (target->topic_hash == topic_hash && target->topic_length == topic_length &&
+            !memcmp(target->topic, topic, topic_length) && target->cb == (cb ? cb : on_subscribe_message_default)) {
             PR_WARN("Repetition:%s", topic);
             return OPRT_OK;
         }
@@ -136,8 +158,14 @@ int tuya_mqtt_subscribe_message_callback_register(tuya_mqtt_context_t *context,
         return OPRT_MALLOC_FAILED;
     }
 
-    newtarget->topic_length = strlen(topic);
+    newtarget->topic_length = topic_length;
+    newtarget->topic_hash = topic_hash;
     newtarget->topic = tal_calloc(1, newtarget->topic_length + 1); // strdup
+    if (!newtarget->topic) {
+        tal_free(newtarget);
+        PR_ERR("malloc error");
+        return OPRT_MALLOC_FAILED;
+    }
     strcpy(newtarget->topic, topic);
 
     if (cb) {
@@ -147,8 +175,8 @@ int tuya_mqtt_subscribe_message_callback_register(tuya_mqtt_context_t *context,
     }
     newtarget->userdata = userdata;
     /* LOCK */
-    newtarget->next = context->subscribe_list;
-    context->subscribe_list = newtarget;
+    newtarget->next = *bucket;
+    *bucket = newtarget;
     /* UNLOCK */
     return OPRT_OK;
 }
@@ -172,14 +200,16 @@ int tuya_mqtt_subscribe_message_callback_unregister(tuya_mqtt_context_t *context
         return OPRT_INVALID_PARM;
     }
 
-    size_t topic_length = strlen(topic);
+    size_t topic_length = 0;
+    uint32_t topic_hash = mqtt_topic_hash(topic, &topic_length);
 
     /* LOCK */
     /* Remove object form list */
-    mqtt_subscribe_handle_t **target = &context->subscribe_list;
+    mqtt_subscribe_handle_t **target = MQTT_SUBSCRIBE_BUCKET(context, topic_hash);
     while (*target) {
         mqtt_subscribe_handle_t *entry = *target;
-        if (entry->topic_length == topic_length && !memcmp(topic, entry->topic, topic_length)) {
+        if (entry->topic_hash == topic_hash && entry->topic_length == topic_length &&
+            !memcmp(topic, entry->topic, topic_length)) {
             *target = entry->next;
             tal_free(entry->topic);
             tal_free(entry);
@@ -201,12 +231,14 @@ static void mqtt_subscribe_message_distribute(tuya_mqtt_context_t *context, uint
                                               const mqtt_client_message_t *msg)
 {
     const char *topic = msg->topic;
-    size_t topic_length = strlen(msg->topic);
+    size_t topic_length = 0;
+    uint32_t topic_hash = mqtt_topic_hash(topic, &topic_length);
 
     /* LOCK */
-    mqtt_subscribe_handle_t *target = context->subscribe_list;
+    mqtt_subscribe_handle_t *target = *MQTT_SUBSCRIBE_BUCKET(context, topic_hash);
     for (; target; target = target->next) {
-        if (target->topic_length == topic_length && !memcmp(topic, target->topic, target->topic_length)) {
+        if (target->topic_hash == topic_hash && target->topic_length == topic_length &&
+            !memcmp(topic, target->topic, topic_length)) {
             target->cb(msgid, msg, target->userdata);
         }
     }
@@ -264,7 +296,7 @@ static int tuya_protocol_message_parse_process(tuya_mqtt_context_t *context, con
     event.data = cJSON_GetObjectItem(root, "data");
 
     /* LOCK */
-    tuya_protocol_handle_t *target = context->protocol_list;
+    tuya_protocol_handle_t *target = *MQTT_PROTOCOL_BUCKET(context, (uint16_t)protocol_id);
     for (; target; target = target->next) {
         if (target->id == protocol_id) {
             event.user_data = target->user_data, target->cb(&event);
@@ -331,6 +363,106 @@ static void mqtt_client_subscribed_cb(void *client, uint16_t msgid, void *userda
     PR_DEBUG("Subscribe successed ID:%d", msgid);
 }
 
+/* -------------------------------------------------------------------------- */
+/*                          QoS1 publish slot pool                            */
+/* -------------------------------------------------------------------------- */
+#define MQTT_TIME_AFTER(a, b) ((int32_t)((uint32_t)(a) - (uint32_t)(b)) >= 0)
+
+/* A sent message sits at msgid % TUYA_MQTT_PUBLISH_SLOT_NUM or after it */
+static mqtt_publish_handle_t *mqtt_publish_slot_find(tuya_mqtt_context_t *context, uint16_t msgid)
+{
+    for (uint16_t i = 0; i < TUYA_MQTT_PUBLISH_SLOT_NUM; i++) {
+        mqtt_publish_handle_t *entry = &context->publish_slot[(msgid + i) % TUYA_MQTT_PUBLISH_SLOT_NUM];
+        if (entry->used && entry->msgid == msgid) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static mqtt_publish_handle_t *mqtt_publish_slot_alloc(tuya_mqtt_context_t *context, uint32_t home)
+{
+    for (uint16_t i = 0; i < TUYA_MQTT_PUBLISH_SLOT_NUM; i++) {
+        mqtt_publish_handle_t *entry = &context->publish_slot[(home + i) % TUYA_MQTT_PUBLISH_SLOT_NUM];
+        if (!entry->used) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static void mqtt_publish_slot_release(tuya_mqtt_context_t *context, mqtt_publish_handle_t *entry, int result)
+{
+    mqtt_publish_notify_cb_t cb = entry->cb;
+    void *user_data = entry->user_data;
+
+    if (entry->msgid) {
+        context->publish_inflight--;
+    } else {
+        context->publish_pending--;
+    }
+    if (entry->payload) {
+        tal_free(entry->payload);
+    }
+    memset(entry, 0, sizeof(mqtt_publish_handle_t));
+
+    // the slot is free before cb may publish again
+    cb(result, user_data);
+}
+
+static void mqtt_publish_pending_send(tuya_mqtt_context_t *context)
+{
+    while (context->publish_pending && context->publish_inflight < TUYA_MQTT_INFLIGHT_MAX) {
+        mqtt_publish_handle_t *entry = NULL;
+        for (uint16_t i = 0; i < TUYA_MQTT_PUBLISH_SLOT_NUM; i++) {
+            mqtt_publish_handle_t *slot = &context->publish_slot[i];
+            if (slot->used && 0 == slot->msgid &&
+                (NULL == entry || (int32_t)(slot->order - entry->order) < 0)) {
+                entry = slot;
+            }
+        }
+        if (NULL == entry) {
+            break;
+        }
+
+        uint16_t msgid =
+            mqtt_client_publish(context->mqtt_client, entry->topic, entry->payload, entry->payload_length, MQTT_QOS_1);
+        if (msgid <= 0) {
+            break;
+        }
+        tal_free(entry->payload);
+        entry->payload = NULL;
+        entry->msgid = msgid;
+        context->publish_pending--;
+        context->publish_inflight++;
+
+        mqtt_publish_handle_t *home = &context->publish_slot[msgid % TUYA_MQTT_PUBLISH_SLOT_NUM];
+        if (!home->used) {
+            *home = *entry;
+            memset(entry, 0, sizeof(mqtt_publish_handle_t));
+        }
+    }
+}
+
+static void mqtt_publish_timeout_sweep(tuya_mqtt_context_t *context)
+{
+    uint32_t now = (uint32_t)tal_system_get_millisecond();
+
+    if (0 == context->publish_inflight + context->publish_pending || !MQTT_TIME_AFTER(now, context->publish_sweep)) {
+        return;
+    }
+    context->publish_sweep = now + TUYA_MQTT_PUBLISH_SWEEP_MS;
+
+    for (uint16_t i = 0; i < TUYA_MQTT_PUBLISH_SLOT_NUM; i++) {
+        mqtt_publish_handle_t *entry = &context->publish_slot[i];
+        if (entry->used && MQTT_TIME_AFTER(now, entry->timeout)) {
+            mqtt_publish_slot_release(context, entry, OPRT_TIMEOUT);
+        }
+    }
+}
+
 static void mqtt_client_puback_cb(void *client, uint16_t msgid, void *userdata)
 {
     client = client;
@@ -339,16 +471,9 @@ static void mqtt_client_puback_cb(void *client, uint16_t msgid, void *userdata)
 
     /* LOCK */
     /* publish async process */
-    mqtt_publish_handle_t **next_handle = &context->publish_list;
-    for (; *next_handle; next_handle = &(*next_handle)->next) {
-        mqtt_publish_handle_t *entry = *next_handle;
-        if (msgid == entry->msgid) {
-            entry->cb(OPRT_OK, entry->user_data);
-            *next_handle = entry->next;
-            tal_free(entry->payload);
-            tal_free(entry);
-            break;
-        }
+    mqtt_publish_handle_t *entry = mqtt_publish_slot_find(context, msgid);
+    if (entry) {
+        mqtt_publish_slot_release(context, entry, OPRT_OK);
     }
     /* UNLOCK */
 }
@@ -511,6 +636,25 @@ int tuya_mqtt_stop(tuya_mqtt_context_t *context)
     return OPRT_OK;
 }
 
+/**
+ * @brief Sets the MQTT keepalive.
+ *
+ * The keepalive is sent to the broker in the next connect.
+ *
+ * @param context Pointer to the MQTT context.
+ * @param keepalive Keepalive in seconds.
+ * @return Returns 0 on success, or a negative error code on failure.
+ */
+int tuya_mqtt_keepalive_set(tuya_mqtt_context_t *context, uint16_t keepalive)
+{
+    if (context == NULL || context->is_inited == false || keepalive == 0) {
+        return OPRT_INVALID_PARM;
+    }
+
+    mqtt_client_keepalive_set(context->mqtt_client, keepalive);
+    return OPRT_OK;
+}
+
 /**
  * @brief Registers a MQTT protocol with the given context.
  *
@@ -533,9 +677,11 @@ int tuya_mqtt_protocol_register(tuya_mqtt_context_t *context, uint16_t protocol_
         return OPRT_INVALID_PARM;
     }
 
+    tuya_protocol_handle_t **bucket = MQTT_PROTOCOL_BUCKET(context, protocol_id);
+
     /* LOCK */
     /* Repetition filter */
-    tuya_protocol_handle_t *target = context->protocol_list;
+    tuya_protocol_handle_t *target = *bucket;
     while (target) {
         if (target->id == protocol_id && target->cb == cb) {
             return OPRT_COM_ERROR;
@@ -550,8 +696,8 @@ int tuya_mqtt_protocol_register(tuya_mqtt_context_t *context, uint16_t protocol_
     new_handle->id = protocol_id;
     new_handle->cb = cb;
     new_handle->user_data = user_data;
-    new_handle->next = context->protocol_list;
-    context->protocol_list = new_handle;
+    new_handle->next = *bucket;
+    *bucket = new_handle;
     /* UNLOCK */
 
     return OPRT_OK;
@@ -577,7 +723,7 @@ int tuya_mqtt_protocol_unregister(tuya_mqtt_context_t *context, uint16_t protoco
 
     /* LOCK */
     /* Remove object form list */
-    tuya_protocol_handle_t **target = &context->protocol_list;
+    tuya_protocol_handle_t **target = MQTT_PROTOCOL_BUCKET(context, protocol_id);
     while (*target) {
         tuya_protocol_handle_t *entry = *target;
         if (entry->id == protocol_id && entry->cb == cb) {
@@ -610,16 +756,17 @@ int tuya_mqtt_protocol_unregister_all(tuya_mqtt_context_t *context)
     /* LOCK */
     /* Remove object form list */
     tuya_protocol_handle_t *entry = NULL;
-    tuya_protocol_handle_t *target = context->protocol_list;
-    while (target) {
-        entry = target;
-        target = entry->next;
-        tal_free(entry);
+    for (int i = 0; i < TUYA_MQTT_PROTOCOL_BUCKET_NUM; i++) {
+        tuya_protocol_handle_t *target = context->protocol_bucket[i];
+        while (target) {
+            entry = target;
+            target = entry->next;
+            tal_free(entry);
+        }
+        context->protocol_bucket[i] = NULL;
     }
     /* UNLOCK */
 
-    context->protocol_list = NULL;
-
     return OPRT_OK;
 }
 
@@ -654,36 +801,36 @@ int tuya_mqtt_client_publish_common(tuya_mqtt_context_t *context, const char *to
         return OPRT_OK;
     }
 
-    mqtt_publish_handle_t *handle = tal_malloc(sizeof(mqtt_publish_handle_t));
-    TUYA_CHECK_NULL_RETURN(handle, OPRT_MALLOC_FAILED);
-    handle->next = NULL;
-    handle->msgid = 0;
-    handle->topic = (char *)topic;
-    handle->timeout = tal_time_get_posix() + timeout_ms;
-    handle->cb = cb;
-    handle->user_data = user_data;
-    handle->payload_length = payload_length;
-    handle->payload = tal_malloc(payload_length);
-    if (handle->payload == NULL) {
-        return OPRT_MALLOC_FAILED;
-    }
-    memcpy(handle->payload, payload, payload_length);
-
-    if (async == false) {
-        handle->msgid = mqtt_client_publish(context->mqtt_client, handle->topic, handle->payload,
-                                            handle->payload_length, MQTT_QOS_1);
+    /* LOCK */
+    if (context->publish_inflight + context->publish_pending >= TUYA_MQTT_PUBLISH_SLOT_NUM) {
+        PR_WARN("publish slots full");
+        return OPRT_EXCEED_UPPER_LIMIT;
     }
 
-    if (context->publish_list == NULL) {
-        context->publish_list = handle;
-        return OPRT_OK;
+    //! keep the order, nothing overtakes the waiting ones
+    uint16_t msgid = 0;
+    if (async == false && 0 == context->publish_pending && context->publish_inflight < TUYA_MQTT_INFLIGHT_MAX) {
+        msgid = mqtt_client_publish(context->mqtt_client, topic, payload, payload_length, MQTT_QOS_1);
     }
 
-    mqtt_publish_handle_t *last = context->publish_list;
-    while (last->next != NULL) {
-        last = last->next;
+    mqtt_publish_handle_t *handle = mqtt_publish_slot_alloc(context, msgid ? msgid : context->publish_order);
+    if (0 == msgid) {
+        handle->payload = tal_malloc(payload_length);
+        TUYA_CHECK_NULL_RETURN(handle->payload, OPRT_MALLOC_FAILED);
+        memcpy(handle->payload, payload, payload_length);
+        handle->order = context->publish_order++;
+        context->publish_pending++;
+    } else {
+        context->publish_inflight++;
     }
-    last->next = handle;
+    handle->used = true;
+    handle->msgid = msgid;
+    handle->topic = topic;
+    handle->timeout = (uint32_t)tal_system_get_millisecond() + timeout_ms;
+    handle->cb = cb;
+    handle->user_data = user_data;
+    handle->payload_length = payload_length;
+    /* UNLOCK */
 
     return OPRT_OK;
 }
@@ -853,23 +1000,8 @@ int tuya_mqtt_loop(tuya_mqtt_context_t *context)
 
     /* LOCK */
     /* publish async process */
-    mqtt_publish_handle_t **next_handle = &context->publish_list;
-    for (; *next_handle; next_handle = &(*next_handle)->next) {
-        mqtt_publish_handle_t *entry = *next_handle;
-
-        if (entry->timeout <= tal_time_get_posix()) {
-            entry->cb(OPRT_TIMEOUT, entry->user_data);
-            *next_handle = entry->next;
-            tal_free(entry->payload);
-            tal_free(entry);
-            continue;
-        }
-
-        if (entry->msgid <= 0) {
-            entry->msgid =
-                mqtt_client_publish(context->mqtt_client, entry->topic, entry->payload, entry->payload_length, 1);
-        }
-    }
+    mqtt_publish_timeout_sweep(context);
+    mqtt_publish_pending_send(context);
     /* UNLOCK */
 
     /* yield */
@@ -894,6 +1026,14 @@ int tuya_mqtt_destory(tuya_mqtt_context_t *context)
     }
 
     tuya_mqtt_protocol_unregister_all(context);
+    for (uint16_t i = 0; i < TUYA_MQTT_PUBLISH_SLOT_NUM; i++) {
+        if (context->publish_slot[i].payload) {
+            tal_free(context->publish_slot[i].payload);
+        }
+    }
+    memset(context->publish_slot, 0, sizeof(context->publish_slot));
+    context->publish_inflight = 0;
+    context->publish_pending = 0;
     if (context->mqtt_client) {
         mqtt_client_status_t mqtt_status = mqtt_client_deinit(context->mqtt_client);
         mqtt_client_free(context->mqtt_client);
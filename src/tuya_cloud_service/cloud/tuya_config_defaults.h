@@ -45,6 +45,25 @@
 #define MQTT_KEEPALIVE_INTERVALIN (120)
 #endif
 
+/**
+ * @brief Low bandwidth profile, used while the active link is cellular:
+ * a longer MQTT keep alive and DP reports with the whitespace stripped.
+ *
+ */
+#ifndef TUYA_LOW_BANDWIDTH_PROFILE
+#define TUYA_LOW_BANDWIDTH_PROFILE (1)
+#endif
+
+#ifndef MQTT_KEEPALIVE_INTERVALIN_LOW_BW
+#define MQTT_KEEPALIVE_INTERVALIN_LOW_BW (300)
+#endif
+
+// Leave devId out of DP reports on a low bandwidth link, only for a cloud
+// that takes the device from the topic
+#ifndef TUYA_LOW_BW_DEVID_ELIDE
+#define TUYA_LOW_BW_DEVID_ELIDE (0)
+#endif
+
 /**
  * @brief Defaults auto check upgrade interval.
  *
@@ -97,4 +116,117 @@
 #define MATOP_TIMEOUT_MS_DEFAULT (8000U)
 #endif
 
+/**
+ * @brief The maximum number of MATOP requests waiting for a response, a power
+ * of two.
+ */
+#ifndef MATOP_INFLIGHT_MAX
+#define MATOP_INFLIGHT_MAX (16)
+#endif
+
+/**
+ * @brief Window in which reported object dps are merged into one message,
+ * 0 sends every report at once.
+ */
+#ifndef DP_REPORT_MERGE_WINDOW_MS
+#define DP_REPORT_MERGE_WINDOW_MS (0U)
+#endif
+
+/**
+ * @brief The maximum number of dps with a report policy.
+ */
+#ifndef DP_REPORT_POLICY_MAX
+#define DP_REPORT_POLICY_MAX (8)
+#endif
+
+/**
+ * @brief The maximum number of object dps kept while offline, 0 disables the
+ * offline queue.
+ */
+#ifndef DP_OFFLINE_QUEUE_MAX
+#define DP_OFFLINE_QUEUE_MAX (32U)
+#endif
+
+/**
+ * @brief Longer string dps are not kept while offline.
+ */
+#ifndef DP_OFFLINE_STR_MAX
+#define DP_OFFLINE_STR_MAX (64U)
+#endif
+
+/**
+ * @brief The maximum number of offline dps replayed in one message.
+ */
+#ifndef DP_OFFLINE_REPLAY_BATCH
+#define DP_OFFLINE_REPLAY_BATCH (8U)
+#endif
+
+/**
+ * @brief Interval between two replayed offline messages.
+ */
+#ifndef DP_OFFLINE_REPLAY_INTERVAL_MS
+#define DP_OFFLINE_REPLAY_INTERVAL_MS (1000U)
+#endif
+
+/**
+ * @brief Offline queue changes are written to KV after this delay, so that a
+ * burst costs one write.
+ */
+#ifndef DP_OFFLINE_SAVE_DELAY_MS
+#define DP_OFFLINE_SAVE_DELAY_MS (2000U)
+#endif
+
+/**
+ * @brief An activated device connects MQTT with the endpoint kept in KV right
+ * away and syncs its version after connecting, instead of before.
+ */
+#ifndef TUYA_IOT_FAST_CONNECT
+#define TUYA_IOT_FAST_CONNECT (1)
+#endif
+
+/**
+ * @brief Failed MQTT connects with the endpoint kept in KV before it is
+ * resolved again.
+ */
+#ifndef TUYA_IOT_FAST_CONNECT_RETRY
+#define TUYA_IOT_FAST_CONNECT_RETRY (2U)
+#endif
+
+/**
+ * @brief How often the client polls the network while waiting for it on
+ * startup.
+ */
+#ifndef TUYA_IOT_NETWORK_CHECK_INTERVAL_MS
+#define TUYA_IOT_NETWORK_CHECK_INTERVAL_MS (100U)
+#endif
+
+/**
+ * @brief Times an interrupted OTA download is resumed from the last byte
+ * written before the upgrade is given up.
+ */
+#ifndef TUYA_OTA_RESUME_RETRY
+#define TUYA_OTA_RESUME_RETRY (5U)
+#endif
+
+/**
+ * @brief Delay before an interrupted OTA download is resumed.
+ */
+#ifndef TUYA_OTA_RESUME_DELAY_MS
+#define TUYA_OTA_RESUME_DELAY_MS (10 * 1000U)
+#endif
+
+/**
+ * @brief The maximum number of atop results kept by the atop cache.
+ */
+#ifndef ATOP_CACHE_MAX
+#define ATOP_CACHE_MAX (8)
+#endif
+
+/**
+ * @brief The oldest cached atop result returned when fetching a new one fails.
+ */
+#ifndef ATOP_CACHE_STALE_MAX_S
+#define ATOP_CACHE_STALE_MAX_S (24 * 60 * 60U)
+#endif
+
 #endif /* ifndef TUYA_CONFIG_DEFAULTS_H_ */
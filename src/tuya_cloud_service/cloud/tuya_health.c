@@ -27,6 +27,8 @@
 #include "tuya_iot_config.h"
 #include "tal_api.h"
 #include "tuya_health.h"
+#include "tuya_iot.h"
+#include "tal_kv.h"
 #if ENABLE_WATCHDOG
 #include "tkl_watchdog.h"
 #endif
@@ -56,6 +58,22 @@ typedef struct {
 
 static health_mgr_t *s_health_mgr = NULL;
 
+// AI latency buckets in ms, the p95 is reported as the bound of its bucket
+static const uint16_t sc_metric_lat_bound_ms[] = {100, 200, 300, 500, 800, 1000, 1500, 2000, 3000, 4000, 6000, 8000};
+
+// current window, counted from any thread
+typedef struct {
+    SYS_TIME_T start;
+    uint32_t heap_min;
+    uint32_t workq_max;
+    uint32_t count[HEALTH_METRIC_MAX];
+    uint32_t lat_bucket[CNTSOF(sc_metric_lat_bound_ms) + 1];
+    uint32_t lat_max;
+} health_metric_win_t;
+
+static health_metric_win_t s_metric_win;
+static health_metrics_t s_metric_report;
+
 #if defined(ENABLE_WATCHDOG) && (ENABLE_WATCHDOG == 1)
 static uint32_t __watchdog_init_and_start(const int timeval)
 {
@@ -81,6 +99,7 @@ static bool __watchdog_feed(void)
 static int __health_reboot_cb(void *data)
 {
     PR_DEBUG("recive reboot req ack! device will reboot!");
+    tal_kv_flush();
     tal_system_reset();
     return OPRT_OK;
 }
@@ -311,6 +330,227 @@ static void __health_memory_notify(void)
     return;
 }
 
+static bool __health_largest_block_check(void)
+{
+    TAL_MEM_HEAP_STAT_T stat;
+
+    if (OPRT_OK != tal_mem_get_heap_stat(&stat)) {
+        return FALSE;
+    }
+    PR_NOTICE("cur largest free block: %d, fragmentation: %d%%", stat.largest_free, stat.frag_pct);
+    if (stat.largest_free < HEALTH_LARGEST_MEM_BLOK_THRESHOLD) {
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+static void __health_heap_notify(void)
+{
+#if defined(ENABLE_MEM_TRACK) && (ENABLE_MEM_TRACK == 1)
+    tal_mem_track_dump(HEALTH_HEAP_DUMP_SITES);
+#else
+    PR_WARN("heap fragmented, enable ENABLE_MEM_TRACK to see the allocation sites");
+#endif
+}
+
+#if defined(ENABLE_MEM_TRACK) && (ENABLE_MEM_TRACK == 1)
+static bool __health_heap_growth_check(void)
+{
+    static uint32_t s_last_live = 0;
+    uint32_t live = tal_mem_track_live_bytes();
+    bool is_grow = (live > s_last_live + HEALTH_HEAP_GROWTH_THRESHOLD);
+
+    PR_NOTICE("cur tracked heap: %d", live);
+    s_last_live = live;
+
+    return is_grow;
+}
+#endif
+
+static uint32_t __health_metric_p95(const health_metric_win_t *win, uint32_t *cnt)
+{
+    uint32_t total = 0, target = 0, sum = 0, i = 0;
+
+    for (i = 0; i < CNTSOF(win->lat_bucket); i++) {
+        total += win->lat_bucket[i];
+    }
+    *cnt = total;
+    if (0 == total) {
+        return 0;
+    }
+
+    target = (total * 95 + 99) / 100;
+    for (i = 0; i < CNTSOF(sc_metric_lat_bound_ms); i++) {
+        sum += win->lat_bucket[i];
+        if (sum >= target) {
+            return sc_metric_lat_bound_ms[i];
+        }
+    }
+    return win->lat_max;
+}
+
+// called with the critical section held
+static void __health_metric_fill(const health_metric_win_t *win, SYS_TIME_T now, health_metrics_t *metrics)
+{
+    memset(metrics, 0, sizeof(health_metrics_t));
+    metrics->window_s = (uint32_t)((now - win->start) / 1000);
+    metrics->value[HEALTH_METRIC_HEAP_MIN] = win->heap_min;
+    metrics->value[HEALTH_METRIC_WORKQ_MAX] = win->workq_max;
+    metrics->value[HEALTH_METRIC_RECONNECT] = win->count[HEALTH_METRIC_RECONNECT];
+    metrics->value[HEALTH_METRIC_AUDIO_UNDERRUN] = win->count[HEALTH_METRIC_AUDIO_UNDERRUN];
+    metrics->value[HEALTH_METRIC_AI_LATENCY] = __health_metric_p95(win, &metrics->ai_latency_cnt);
+}
+
+static void __health_metrics_report(void *data)
+{
+    health_metrics_t *m = &s_metric_report;
+    char buf[192];
+    int len = 0;
+
+    len = snprintf(buf, sizeof(buf),
+                   "{\"win\":%u,\"heap_min\":%u,\"wq_max\":%u,\"tmr_late\":%u,\"reconn\":%u,\"aud_ur\":%u,"
+                   "\"ai_p95\":%u,\"ai_n\":%u}",
+                   m->window_s, m->value[HEALTH_METRIC_HEAP_MIN], m->value[HEALTH_METRIC_WORKQ_MAX],
+                   m->value[HEALTH_METRIC_TIMER_LATE], m->value[HEALTH_METRIC_RECONNECT],
+                   m->value[HEALTH_METRIC_AUDIO_UNDERRUN], m->value[HEALTH_METRIC_AI_LATENCY], m->ai_latency_cnt);
+    if (len <= 0 || len >= (int)sizeof(buf)) {
+        return;
+    }
+    PR_NOTICE("health metrics %s", buf);
+
+#if HEALTH_METRICS_DP_ID > 0
+    // a string dp, reported on the LAN when a client is connected, else on MQTT
+    char dp[256];
+    int i = 0, j = 0;
+
+    j = snprintf(dp, sizeof(dp), "{\"%d\":\"", HEALTH_METRICS_DP_ID);
+    for (i = 0; i < len && j < (int)sizeof(dp) - 4; i++) {
+        if ('"' == buf[i]) {
+            dp[j++] = '\\';
+        }
+        dp[j++] = buf[i];
+    }
+    dp[j++] = '"';
+    dp[j++] = '}';
+    dp[j] = '\0';
+    tuya_iot_dp_report_json(tuya_iot_client_get(), dp);
+#endif
+
+#ifdef HEALTH_METRICS_TOPIC
+    if (tuya_iot_is_connected()) {
+        tuya_mqtt_client_publish_common(&tuya_iot_client_get()->mqctx, HEALTH_METRICS_TOPIC, (const uint8_t *)buf,
+                                        len, NULL, NULL, 5000, FALSE);
+    }
+#endif
+}
+
+static void __health_metrics_roll(SYS_TIME_T now)
+{
+    TAL_ENTER_CRITICAL();
+    __health_metric_fill(&s_metric_win, now, &s_metric_report);
+    memset(&s_metric_win, 0, sizeof(s_metric_win));
+    s_metric_win.start = now;
+    TAL_EXIT_CRITICAL();
+}
+
+// run by the monitor thread every HEALTH_SLEEP_INTERVAL
+static void __health_metrics_update(void)
+{
+    TAL_SW_TIMER_STAT_T timer_stat;
+    SYS_TIME_T now = tal_system_get_millisecond();
+    int free_heap = tal_system_get_free_heap_size();
+    uint32_t workq_num = tal_workq_get_num(WORKQ_SYSTEM);
+
+    TAL_ENTER_CRITICAL();
+    if (free_heap > 0 && (0 == s_metric_win.heap_min || (uint32_t)free_heap < s_metric_win.heap_min)) {
+        s_metric_win.heap_min = (uint32_t)free_heap;
+    }
+    if (workq_num > s_metric_win.workq_max) {
+        s_metric_win.workq_max = workq_num;
+    }
+    TAL_EXIT_CRITICAL();
+
+    if (0 == HEALTH_METRICS_INTERVAL || now - s_metric_win.start < HEALTH_METRICS_INTERVAL * 1000ULL) {
+        return;
+    }
+
+    __health_metrics_roll(now);
+
+    // the timer statistics restart with each window
+    if (OPRT_OK == tal_sw_timer_stat_get(&timer_stat, TRUE)) {
+        s_metric_report.value[HEALTH_METRIC_TIMER_LATE] = timer_stat.max_late_ms;
+    }
+    tal_workq_schedule(WORKQ_SYSTEM, __health_metrics_report, NULL);
+}
+
+static int __health_mqtt_disc_cb(void *data)
+{
+    tuya_health_metric_count(HEALTH_METRIC_RECONNECT);
+    return OPRT_OK;
+}
+
+/**
+ * @brief Counts one event of a counter metric.
+ *
+ * @param metric HEALTH_METRIC_RECONNECT or HEALTH_METRIC_AUDIO_UNDERRUN.
+ */
+void tuya_health_metric_count(HEALTH_METRIC_E metric)
+{
+    if (metric >= HEALTH_METRIC_MAX) {
+        return;
+    }
+
+    TAL_ENTER_CRITICAL();
+    s_metric_win.count[metric]++;
+    TAL_EXIT_CRITICAL();
+}
+
+/**
+ * @brief Adds a sample to a distribution metric.
+ *
+ * @param metric HEALTH_METRIC_AI_LATENCY.
+ * @param value The sample in ms.
+ */
+void tuya_health_metric_sample(HEALTH_METRIC_E metric, uint32_t value)
+{
+    uint32_t idx = 0;
+
+    if (HEALTH_METRIC_AI_LATENCY != metric) {
+        return;
+    }
+
+    while (idx < CNTSOF(sc_metric_lat_bound_ms) && value > sc_metric_lat_bound_ms[idx]) {
+        idx++;
+    }
+    TAL_ENTER_CRITICAL();
+    s_metric_win.lat_bucket[idx]++;
+    if (value > s_metric_win.lat_max) {
+        s_metric_win.lat_max = value;
+    }
+    TAL_EXIT_CRITICAL();
+}
+
+/**
+ * @brief Gets the metrics of the current window.
+ *
+ * @param metrics Filled with the metrics so far, the timer lateness is only
+ * known at the end of a window and is reported as 0.
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+int tuya_health_metrics_get(health_metrics_t *metrics)
+{
+    if (NULL == metrics) {
+        return OPRT_INVALID_PARM;
+    }
+
+    TAL_ENTER_CRITICAL();
+    __health_metric_fill(&s_metric_win, tal_system_get_millisecond(), metrics);
+    TAL_EXIT_CRITICAL();
+
+    return OPRT_OK;
+}
+
 static bool __health_workq_check(void)
 {
     uint16_t workq_num = tal_workq_get_num(WORKQ_SYSTEM);
@@ -354,6 +594,33 @@ static bool __health_timeq_check(void)
     return FALSE;
 }
 
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+static bool __health_thread_check(void)
+{
+    TAL_THREAD_PROF_T *prof = NULL;
+    uint32_t num = 0, i = 0;
+    bool is_alarm = FALSE;
+
+    prof = Malloc(TAL_THREAD_PROF_MAX_NUM * sizeof(TAL_THREAD_PROF_T));
+    if (NULL == prof) {
+        return FALSE;
+    }
+
+    num = tal_thread_get_prof_all(prof, TAL_THREAD_PROF_MAX_NUM);
+    for (i = 0; i < num; i++) {
+        if ((prof[i].stack_free && prof[i].stack_free < HEALTH_THREAD_STACK_THRESHOLD) ||
+            prof[i].busy_pct > HEALTH_THREAD_BUSY_THRESHOLD) {
+            PR_WARN("thread %s stack free:%d busy:%d%% wakes:%d max block:%dms", prof[i].name, prof[i].stack_free,
+                    prof[i].busy_pct, prof[i].wake_cnt, prof[i].max_block_ms);
+            is_alarm = TRUE;
+        }
+    }
+    Free(prof);
+
+    return is_alarm;
+}
+#endif
+
 static void __health_foreach_item(void)
 {
     P_LIST_HEAD pPos, pNext;
@@ -426,13 +693,14 @@ static void __health_monitor_task(void *arg)
         tal_mutex_lock(s_health_mgr->mutex);
         __health_foreach_item();
         tal_mutex_unlock(s_health_mgr->mutex);
+        __health_metrics_update();
         tal_system_sleep(HEALTH_SLEEP_INTERVAL * 1000);
     }
 }
 
 static health_policy_t g_health_policy[] = {
     {HEALTH_RULE_FREE_MEM_SIZE, 1, HEALTH_DETECT_INTERVAL, __health_memory_check, __health_memory_notify},
-    {HEALTH_RULE_MAX_MEM_SIZE, 1, HEALTH_DETECT_INTERVAL, NULL, NULL},
+    {HEALTH_RULE_MAX_MEM_SIZE, 1, HEALTH_DETECT_INTERVAL, __health_largest_block_check, __health_heap_notify},
     {HEALTH_RULE_ATOP_REFUSE, 5, HEALTH_DETECT_INTERVAL, NULL, NULL},
     {HEALTH_RULE_ATOP_SIGN_FAILED, 5, HEALTH_DETECT_INTERVAL, NULL, NULL},
     {HEALTH_RULE_WORKQ_DEPTH, 1, HEALTH_DETECT_INTERVAL, __health_workq_check, __health_workq_notify},
@@ -483,8 +751,19 @@ int tuya_health_monitor_init(void)
     TUYA_CALL_ERR_GOTO(tal_event_subscribe(EVENT_HEALTH_ALERT, "health_monitor", __health_alert_cb, FALSE), __exit);
     TUYA_CALL_ERR_GOTO(
         tal_event_subscribe(EVENT_REBOOT_ACK, "health_monitor", __health_reboot_cb, SUBSCRIBE_TYPE_NORMAL), __exit);
+    TUYA_CALL_ERR_GOTO(tal_event_subscribe(EVENT_MQTT_DISCONNECTED, "health_monitor", __health_mqtt_disc_cb,
+                                           SUBSCRIBE_TYPE_NORMAL),
+                       __exit);
+    s_metric_win.start = tal_system_get_millisecond();
 
     __health_item_load();
+#if defined(ENABLE_THREAD_PROF) && (ENABLE_THREAD_PROF == 1)
+    tuya_health_item_add(1, HEALTH_DETECT_INTERVAL, __health_thread_check, NULL);
+#endif
+#if defined(ENABLE_MEM_TRACK) && (ENABLE_MEM_TRACK == 1)
+    tuya_health_item_add(HEALTH_HEAP_GROWTH_TIMES, HEALTH_DETECT_INTERVAL, __health_heap_growth_check,
+                         __health_heap_notify);
+#endif
     // init and start watch dog, use the return value as the real watch dog
     // interval
 #if defined(ENABLE_WATCHDOG) && (ENABLE_WATCHDOG == 1)
@@ -530,6 +809,7 @@ __exit:
         }
         tal_event_unsubscribe(EVENT_REBOOT_ACK, "health_monitor", __health_reboot_cb);
         tal_event_unsubscribe(EVENT_HEALTH_ALERT, "health_monitor", __health_alert_cb);
+        tal_event_unsubscribe(EVENT_MQTT_DISCONNECTED, "health_monitor", __health_mqtt_disc_cb);
 
         Free(s_health_mgr);
         s_health_mgr = NULL;
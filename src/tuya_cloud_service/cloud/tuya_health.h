@@ -35,7 +35,22 @@ extern "C" {
 // Default minimum memory block threshold set to 5K, normal access to the
 // cloud/FLASH requires a one-time allocation of more than 4K of memory
 // (tentative)
+#ifndef HEALTH_LARGEST_MEM_BLOK_THRESHOLD
 #define HEALTH_LARGEST_MEM_BLOK_THRESHOLD (1024 * 5)
+#endif
+// Default growth of the tracked heap per check counted as a leak step, needs
+// ENABLE_MEM_TRACK
+#ifndef HEALTH_HEAP_GROWTH_THRESHOLD
+#define HEALTH_HEAP_GROWTH_THRESHOLD (512)
+#endif
+// Default number of checks in a row with growth before the sites are dumped
+#ifndef HEALTH_HEAP_GROWTH_TIMES
+#define HEALTH_HEAP_GROWTH_TIMES (6)
+#endif
+// Default number of sites dumped on a heap alarm
+#ifndef HEALTH_HEAP_DUMP_SITES
+#define HEALTH_HEAP_DUMP_SITES (16)
+#endif
 
 // Default maximum workq depth
 #define HEALTH_WORKQ_THRESHOLD (50)
@@ -44,6 +59,27 @@ extern "C" {
 // Default maximum timeq number
 #define HEALTH_TIMEQ_THRESHOLD (100)
 
+// Default minimum free stack of a thread, needs ENABLE_THREAD_PROF
+#ifndef HEALTH_THREAD_STACK_THRESHOLD
+#define HEALTH_THREAD_STACK_THRESHOLD (256)
+#endif
+// Default maximum busy share of a thread in percent, needs ENABLE_THREAD_PROF
+#ifndef HEALTH_THREAD_BUSY_THRESHOLD
+#define HEALTH_THREAD_BUSY_THRESHOLD (90)
+#endif
+
+// Default window of the rolling metrics in seconds, reported at its end, 0
+// disables them
+#ifndef HEALTH_METRICS_INTERVAL
+#define HEALTH_METRICS_INTERVAL HEALTH_REPORT_INTERVAL
+#endif
+// Default string DP the metrics are reported in, 0 reports them only on
+// HEALTH_METRICS_TOPIC or the log
+#ifndef HEALTH_METRICS_DP_ID
+#define HEALTH_METRICS_DP_ID 0
+#endif
+// Define HEALTH_METRICS_TOPIC to also publish the metrics on that MQTT topic
+
 // Default watchdog timer interval, must be a multiple of 20 seconds
 #define HEALTH_WATCHDOG_INTERVAL 60
 // Default health monitoring scan interval, in seconds, must be a multiple of 20
@@ -64,6 +100,23 @@ typedef enum {
     HEALTH_RULE_RUNTIME_REPT
 } HEALTH_MONITOR_RULE_E;
 
+// Rolling metrics, a window of HEALTH_METRICS_INTERVAL each
+typedef enum {
+    HEALTH_METRIC_HEAP_MIN,       // lowest free heap, sampled by the monitor
+    HEALTH_METRIC_WORKQ_MAX,      // deepest system workqueue, sampled by the monitor
+    HEALTH_METRIC_TIMER_LATE,     // most a software timer started late, ms
+    HEALTH_METRIC_RECONNECT,      // MQTT disconnections
+    HEALTH_METRIC_AUDIO_UNDERRUN, // playback buffer underruns
+    HEALTH_METRIC_AI_LATENCY,     // p95 of the AI response time, ms
+    HEALTH_METRIC_MAX
+} HEALTH_METRIC_E;
+
+typedef struct {
+    uint32_t window_s; // length of the window so far
+    uint32_t value[HEALTH_METRIC_MAX];
+    uint32_t ai_latency_cnt; // samples behind the p95
+} health_metrics_t;
+
 typedef void (*health_notify_cb)(void);
 typedef bool (*health_check_cb)(void);
 
@@ -141,6 +194,33 @@ void tuya_health_item_dump(void);
  */
 void tuya_health_disable_watchdog(void);
 
+/**
+ * @brief count one event of a counter metric
+ *
+ * @param[in] metric HEALTH_METRIC_RECONNECT or HEALTH_METRIC_AUDIO_UNDERRUN
+ *
+ */
+void tuya_health_metric_count(HEALTH_METRIC_E metric);
+
+/**
+ * @brief add a sample to a distribution metric
+ *
+ * @param[in] metric HEALTH_METRIC_AI_LATENCY
+ * @param[in] value sample in ms
+ *
+ */
+void tuya_health_metric_sample(HEALTH_METRIC_E metric, uint32_t value);
+
+/**
+ * @brief get the metrics of the current window
+ *
+ * @param[out] metrics metrics
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+int tuya_health_metrics_get(health_metrics_t *metrics);
+
 #ifdef __cplusplus
 }
 #endif
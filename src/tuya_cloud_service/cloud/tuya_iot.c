@@ -20,11 +20,14 @@
 #include "tal_kv.h"
 #include "atop_base.h"
 #include "atop_service.h"
+#include "atop_cache.h"
 #include "mqtt_bind.h"
 #include "cJSON.h"
 #include "tal_sw_timer.h"
 #include "tal_api.h"
+#include "tal_boot_mark.h"
 #include "tuya_iot_dp.h"
+#include "tuya_iot_dp_offline.h"
 #include "tuya_register_center.h"
 #include "tuya_tls.h"
 #include "netmgr.h"
@@ -50,6 +53,35 @@ typedef enum {
     STATE_EXIT,
 } tuya_run_state_t;
 
+/* Time spent in each state from STATE_START to the first STATE_MQTT_YIELD */
+static struct {
+    bool running;
+    SYS_TIME_T start;
+    uint8_t last; /* state of the previous yield, a new one is put on the boot timeline */
+    uint32_t cost[STATE_EXIT + 1];
+} s_startup_profile;
+
+static const char *const s_state_name[STATE_EXIT + 1] = {
+    [STATE_IDLE] = "idle",
+    [STATE_START] = "start",
+    [STATE_DATA_LOAD] = "data_load",
+    [STATE_ENDPOINT_GET] = "endpoint_get",
+    [STATE_ENDPOINT_UPDATE] = "endpoint_update",
+    [STATE_TOKEN_PENDING] = "token_pending",
+    [STATE_ACTIVATING] = "activating",
+    [STATE_NETWORK_CHECK] = "network_check",
+    [STATE_NETWORK_RECONNECT] = "network_reconnect",
+    [STATE_STARTUP_UPDATE] = "startup_update",
+    [STATE_MQTT_CONNECT_START] = "mqtt_connect_start",
+    [STATE_MQTT_CONNECTING] = "mqtt_connecting",
+    [STATE_MQTT_RECONNECT] = "mqtt_reconnect",
+    [STATE_MQTT_YIELD] = "mqtt_yield",
+    [STATE_RESTART] = "restart",
+    [STATE_RESET] = "reset",
+    [STATE_STOP] = "stop",
+    [STATE_EXIT] = "exit",
+};
+
 static tuya_iot_client_t *s_iot_client_solo;
 
 /* -------------------------------------------------------------------------- */
@@ -103,11 +135,30 @@ __exit:
     return result;
 }
 
+/* Key of the pre-parsed schema kept next to the JSON of schema_id */
+static void schema_bin_key(const char *schema_id, char key[MAX_LENGTH_SCHEMA_ID + 5])
+{
+    snprintf(key, MAX_LENGTH_SCHEMA_ID + 5, "%s_bin", schema_id);
+}
+
 static dp_schema_t *schema_instance_create(char *devid, char *schema_id)
 {
     dp_schema_t *schema = NULL;
     size_t readlen = 0;
     uint8_t *schema_data = NULL;
+    char bin_key[MAX_LENGTH_SCHEMA_ID + 5];
+
+    /* The binary form saves parsing the JSON on every boot */
+    schema_bin_key(schema_id, bin_key);
+    if (OPRT_OK == tal_kv_get(bin_key, &schema_data, &readlen)) {
+        dp_schema_create_from_bin(devid, schema_data, readlen, &schema);
+        tal_kv_free(schema_data);
+        schema_data = NULL;
+        if (schema) {
+            return schema;
+        }
+        tal_kv_del(bin_key);
+    }
 
     if (OPRT_OK != tal_kv_get((const char *)schema_id, &schema_data, &readlen)) {
         PR_WARN("schema data read failed");
@@ -115,6 +166,14 @@ static dp_schema_t *schema_instance_create(char *devid, char *schema_id)
     }
 
     dp_schema_create(devid, (char *)schema_data, &schema);
+    if (schema) {
+        uint8_t *bin = NULL;
+        size_t binlen = 0;
+        if (OPRT_OK == dp_schema_bin_dump(schema, &bin, &binlen)) {
+            tal_kv_set(bin_key, bin, binlen);
+            tal_free(bin);
+        }
+    }
 
 __exit:
     if (schema_data) {
@@ -179,6 +238,9 @@ static int activate_response_parse(atop_base_response_t *response)
 
     // cJSON object to string save
     char *schemaId = cJSON_GetObjectItem(result_root, "schemaId")->valuestring;
+    char bin_key[MAX_LENGTH_SCHEMA_ID + 5];
+    schema_bin_key(schemaId, bin_key);
+    tal_kv_del(bin_key);
     cJSON *schema_obj = cJSON_DetachItemFromObject(result_root, "schema");
     ret = tal_kv_set(schemaId, (const uint8_t *)schema_obj->valuestring, strlen(schema_obj->valuestring));
     cJSON_Delete(schema_obj);
@@ -198,6 +260,13 @@ static int activate_response_parse(atop_base_response_t *response)
         return OPRT_KVS_WR_FAIL;
     }
 
+    // activation must survive a power loss
+    ret = tal_kv_flush();
+    if (ret != OPRT_OK) {
+        PR_ERR("activate data flush error:%d", ret);
+        return OPRT_KVS_WR_FAIL;
+    }
+
     return OPRT_OK;
 }
 
@@ -206,14 +275,11 @@ static int client_activate_process(tuya_iot_client_t *client, const char *token)
     /* Try to read the already exist devId */
     char devid_key[MAX_LENGTH_UUID + 7];
     char devid_cache[MAX_LENGTH_DEVICE_ID + 1] = {0};
-    size_t devid_len = 0;
+    size_t devid_len = sizeof(devid_cache) - 1;
     bool exist_devid = false;
-    char *devid_vaule = NULL;
 
     snprintf(devid_key, sizeof devid_key, "%s.devid", client->config.storage_namespace);
-    if (tal_kv_get(devid_key, (uint8_t **)&devid_vaule, &devid_len) == OPRT_OK) {
-        memcpy(devid_cache, devid_vaule, devid_len);
-        tal_kv_free((uint8_t *)devid_vaule);
+    if (tal_kv_get_into(devid_key, (uint8_t *)devid_cache, &devid_len) == OPRT_OK) {
         exist_devid = true;
     }
 
@@ -374,18 +440,146 @@ static void mqtt_service_upgrade_notify_on(tuya_mqtt_event_t *ev)
     }
 }
 
+/* The versions JSON of the firmware and the extension modules, NULL when it
+ * is unchanged since the last sync or on no memory */
+static char *iot_version_changed_get(tuya_iot_client_t *client, size_t *len)
+{
+#define VERSION_BUFFER_MAX (128)
+    size_t prealloc_size = VERSION_BUFFER_MAX;
+    if (client->config.modules) {
+        prealloc_size += strlen(client->config.modules) + 10;
+    }
+
+    char *version_buffer = tal_malloc(prealloc_size);
+    if (version_buffer == NULL) {
+        return NULL;
+    }
+
+    /* Format version JSON buffer */
+    size_t version_len = 0;
+    if (client->config.modules) {
+        /* extension modules version */
+        version_len += sprintf(version_buffer + version_len, "%s", client->config.modules);
+        version_len -= 1; // remove ']'
+        version_len += sprintf(version_buffer + version_len, ",");
+    } else {
+        version_len += sprintf(version_buffer + version_len, "[");
+    }
+
+    /* Main firmware information */
+    version_len += sprintf(version_buffer + version_len,
+                           "{\\\"otaChannel\\\":%d,\\\"protocolVer\\\":\\\"%s\\\","
+                           "\\\"baselineVer\\\":\\\"%s\\\",\\\"softVer\\\":\\\"%s\\\"}",
+                           0, PV_VERSION, BS_VERSION, client->config.software_ver);
+
+    version_len += sprintf(version_buffer + version_len, "]");
+    PR_DEBUG("%s", version_buffer);
+
+    /* local storage read buffer*/
+    size_t readlen = 0;
+    char *readbuf = NULL;
+
+    /* Try read activate config data */
+    char version_key[32];
+    snprintf(version_key, sizeof version_key, "%s.ver", client->config.storage_namespace);
+    int rt = tal_kv_get((const char *)version_key, (uint8_t **)&readbuf, &readlen);
+    if (OPRT_OK != rt) {
+        PR_WARN("version save info not found:%d", rt);
+    }
+
+    /* Compare the version info changed? */
+    if (readbuf && memcmp(version_buffer, readbuf, version_len) == 0) {
+        PR_DEBUG("The verison unchanged, dont need sync.");
+        tal_kv_free((uint8_t *)readbuf);
+        tal_free(version_buffer);
+        return NULL;
+    }
+    tal_kv_free((uint8_t *)readbuf);
+
+    *len = version_len;
+    return version_buffer;
+}
+
+static int iot_version_save(tuya_iot_client_t *client, const char *version_buffer, size_t version_len)
+{
+    char version_key[32];
+    snprintf(version_key, sizeof version_key, "%s.ver", client->config.storage_namespace);
+    return tal_kv_set((const char *)version_key, (const uint8_t *)version_buffer, version_len);
+}
+
+#if TUYA_IOT_FAST_CONNECT
+static void iot_version_sync_matop_on(atop_base_response_t *response, void *user_data)
+{
+    tuya_iot_client_t *client = (tuya_iot_client_t *)user_data;
+
+    if (response->success == false) {
+        PR_WARN("version sync failed, retry on next connect");
+        return;
+    }
+
+    /* The versions do not change at runtime without a new sync, make them again */
+    size_t version_len = 0;
+    char *version_buffer = iot_version_changed_get(client, &version_len);
+    if (version_buffer) {
+        iot_version_save(client, version_buffer, version_len);
+        tal_free(version_buffer);
+    }
+}
+
+/* Sends the version sync as a MATOP request, it shares the round trip of
+ * whatever else is in flight instead of opening an HTTPS connection */
+static int iot_version_sync_matop(tuya_iot_client_t *client)
+{
+    size_t version_len = 0;
+    char *version_buffer = iot_version_changed_get(client, &version_len);
+    if (version_buffer == NULL) {
+        return OPRT_OK;
+    }
+
+    int rt = matop_service_version_update_async(&client->matop, version_buffer, iot_version_sync_matop_on, client);
+    tal_free(version_buffer);
+    return rt;
+}
+#endif
+
+static void iot_version_sync_work(void *data)
+{
+    int rt = tuya_iot_version_update_sync((tuya_iot_client_t *)data);
+    if (rt != OPRT_OK) {
+        PR_WARN("version sync error:%d, retry on next connect", rt);
+    }
+}
+
 static void mqtt_client_connected_on(void *context, void *user_data)
 {
     tuya_iot_client_t *client = (tuya_iot_client_t *)user_data;
 
+    client->mqtt_connect_fail = 0;
+
     /* MATOP Init */
     matop_serice_init(&client->matop,
                       &(const matop_config_t){.mqctx = &client->mqctx, .devid = client->activate.devid});
 
+#if TUYA_IOT_FAST_CONNECT
+    /* Version sync and the upgrade check go out back to back over MQTT and
+     * share one round trip, off the connect path. HTTPS is the fallback. */
+    if (iot_version_sync_matop(client) != OPRT_OK) {
+        tal_workq_schedule(WORKQ_SYSTEM, iot_version_sync_work, client);
+    }
+
+    if (tal_sw_timer_is_running(client->check_upgrade_timer) == false) {
+        matop_service_auto_upgrade_info_get(&client->matop, matop_upgrade_info_on, client);
+        tal_sw_timer_start(client->check_upgrade_timer, AUTO_UPGRADE_CHECK_INTERVAL, TAL_TIMER_ONCE);
+    }
+#else
     /* Auto check upgrade timer start */
     if (tal_sw_timer_is_running(client->check_upgrade_timer) == false) {
         tal_sw_timer_start(client->check_upgrade_timer, 1000 * 1, TAL_TIMER_ONCE);
     }
+#endif
+
+    /* Replay the dps reported while offline */
+    tuya_iot_dp_offline_replay_start(client);
 
     /* Send connected event*/
     client->event.id = TUYA_EVENT_MQTT_CONNECTED;
@@ -460,8 +654,10 @@ static int run_state_startup_update(tuya_iot_client_t *client)
 {
     int rt = OPRT_OK;
 
+#if !TUYA_IOT_FAST_CONNECT
     /* Update client version */
     tuya_iot_version_update_sync(client);
+#endif
 
     /* MQTT Client Init */
     const tuya_endpoint_t *endpoint = tuya_endpoint_get();
@@ -483,8 +679,21 @@ static int run_state_startup_update(tuya_iot_client_t *client)
     return rt;
 }
 
+static bool iot_low_bandwidth(void)
+{
+#if TUYA_LOW_BANDWIDTH_PROFILE
+    return netmgr_active_get() == NETCONN_CELLULAR;
+#else
+    return false;
+#endif
+}
+
 static int run_state_mqtt_connect_start(tuya_iot_client_t *client)
 {
+    /* The link may have changed since the last connect */
+    tuya_mqtt_keepalive_set(&client->mqctx,
+                            iot_low_bandwidth() ? MQTT_KEEPALIVE_INTERVALIN_LOW_BW : MQTT_KEEPALIVE_INTERVALIN);
+
     int rt = tuya_mqtt_start(&client->mqctx);
     if (OPRT_OK != rt) {
         PR_ERR("tuya mqtt start error:%d", rt);
@@ -781,6 +990,47 @@ static OPERATE_RET __tuya_iot_link_type_change_cb(void *data)
  * @param client Pointer to the Tuya IoT client structure.
  * @return Returns 0 on success, or a negative error code on failure.
  */
+static void startup_profile_enter(uint8_t state)
+{
+    if (state == STATE_MQTT_YIELD || state == s_startup_profile.last) {
+        return;
+    }
+    if (state == STATE_START || s_startup_profile.running) {
+        s_startup_profile.last = state;
+        tal_boot_mark(s_state_name[state]);
+    }
+}
+
+static void startup_profile_update(uint8_t state, SYS_TIME_T begin)
+{
+    if (state == STATE_START) {
+        memset(&s_startup_profile, 0, sizeof(s_startup_profile));
+        s_startup_profile.running = true;
+        s_startup_profile.start = begin;
+        s_startup_profile.last = STATE_START;
+    }
+    if (!s_startup_profile.running) {
+        return;
+    }
+
+    SYS_TIME_T now = tal_system_get_millisecond();
+    if (state != STATE_MQTT_YIELD) {
+        s_startup_profile.cost[state] += (uint32_t)(now - begin);
+        return;
+    }
+
+    /* First yield, MQTT is up: report where the time went */
+    s_startup_profile.running = false;
+    PR_NOTICE("startup to mqtt connected: %u ms", (uint32_t)(now - s_startup_profile.start));
+    int i;
+    for (i = 0; i <= STATE_EXIT; i++) {
+        if (s_startup_profile.cost[i]) {
+            PR_NOTICE("  %-20s %u ms", s_state_name[i], s_startup_profile.cost[i]);
+        }
+    }
+    tal_boot_mark_done("mqtt connected");
+}
+
 int tuya_iot_yield(tuya_iot_client_t *client)
 {
     if (client == NULL) {
@@ -789,6 +1039,8 @@ int tuya_iot_yield(tuya_iot_client_t *client)
 
     int rt = OPRT_OK;
     client->state = client->nextstate;
+    SYS_TIME_T begin = tal_system_get_millisecond();
+    startup_profile_enter(client->state);
 
     switch (client->state) {
 
@@ -867,7 +1119,7 @@ int tuya_iot_yield(tuya_iot_client_t *client)
             client->status = TUYA_STATUS_WIFI_CONNECTED;
             client->nextstate = client->is_activated ? STATE_ENDPOINT_GET : STATE_ENDPOINT_UPDATE;
         } else {
-            tal_system_sleep(1000);
+            tal_system_sleep(TUYA_IOT_NETWORK_CHECK_INTERVAL_MS);
         }
         break;
 
@@ -878,6 +1130,8 @@ int tuya_iot_yield(tuya_iot_client_t *client)
             PR_WARN("tuya endpoint get error %d; need update", rt);
             client->nextstate = STATE_ENDPOINT_UPDATE;
         } else {
+            client->endpoint_cached = true;
+            client->mqtt_connect_fail = 0;
             client->nextstate = STATE_STARTUP_UPDATE;
         }
         break;
@@ -888,6 +1142,7 @@ int tuya_iot_yield(tuya_iot_client_t *client)
             tal_system_sleep(1000);
             break;
         }
+        client->endpoint_cached = false;
         if (client->is_activated) {
             rt = tuya_endpoint_cert_set((tuya_endpoint_t *)tuya_endpoint_get());
             rt |= tuya_endpoint_domain_set((tuya_endpoint_t *)tuya_endpoint_get());
@@ -946,8 +1201,16 @@ int tuya_iot_yield(tuya_iot_client_t *client)
         break;
 
     case STATE_MQTT_CONNECT_START:
-        if (run_state_mqtt_connect_start(client) == OPRT_OK) {
+        rt = run_state_mqtt_connect_start(client);
+        if (rt == OPRT_OK) {
             client->nextstate = STATE_MQTT_CONNECTING;
+        } else if (TUYA_IOT_FAST_CONNECT && rt != OPRT_AUTHENTICATION_FAIL && client->endpoint_cached &&
+                   ++client->mqtt_connect_fail >= TUYA_IOT_FAST_CONNECT_RETRY) {
+            /* The cached endpoint may be stale, resolve it again */
+            PR_WARN("mqtt connect fail %d times with cached endpoint", client->mqtt_connect_fail);
+            tuya_mqtt_destory(&client->mqctx);
+            client->endpoint_cached = false;
+            client->nextstate = STATE_ENDPOINT_UPDATE;
         }
         break;
 
@@ -999,6 +1262,8 @@ int tuya_iot_yield(tuya_iot_client_t *client)
         break;
     }
 
+    startup_profile_update(client->state, begin);
+
     return rt;
 }
 
@@ -1036,10 +1301,16 @@ int tuya_iot_activated_data_remove(tuya_iot_client_t *client)
     }
 
     /* Clean client local data */
+    char bin_key[MAX_LENGTH_SCHEMA_ID + 5];
+    schema_bin_key(client->activate.schemaId, bin_key);
     dp_schema_delete(client->activate.devid);
     tal_kv_del((const char *)(client->activate.schemaId));
+    tal_kv_del(bin_key);
     tal_kv_del((const char *)(client->config.storage_namespace));
+    tuya_iot_dp_offline_clear();
+    atop_cache_clear();
     tuya_endpoint_remove();
+    tal_kv_flush();
     client->is_activated = false;
     PR_INFO("Activated data remove successed");
 
@@ -1050,6 +1321,30 @@ int tuya_iot_activated_data_remove(tuya_iot_client_t *client)
     return OPRT_OK;
 }
 
+/* Copy a JSON text without the whitespace between tokens, returns the length */
+static int iot_json_compact(char *dst, const char *src)
+{
+    char *out = dst;
+    bool in_str = false;
+
+    for (; *src; src++) {
+        if (in_str) {
+            if (*src == '\\' && src[1]) {
+                *out++ = *src++;
+            } else if (*src == '"') {
+                in_str = false;
+            }
+        } else if (*src == ' ' || *src == '\t' || *src == '\r' || *src == '\n') {
+            continue;
+        } else if (*src == '"') {
+            in_str = true;
+        }
+        *out++ = *src;
+    }
+    *out = '\0';
+    return out - dst;
+}
+
 static int tuya_iot_dp_report_json_common(tuya_iot_client_t *client, const char *dps, const char *time,
                                           tuya_dp_notify_cb_t cb, void *user_data, int timeout_ms, bool async)
 {
@@ -1063,14 +1358,23 @@ static int tuya_iot_dp_report_json_common(tuya_iot_client_t *client, const char
     char *buffer = NULL;
 
     /* Package JSON format */
+    bool low_bw = iot_low_bandwidth();
+    buffer = tal_malloc(strlen(dps) + (time ? strlen(time) : 0) + 64);
+    TUYA_CHECK_NULL_RETURN(buffer, OPRT_MALLOC_FAILED);
+    if (low_bw && TUYA_LOW_BW_DEVID_ELIDE) {
+        printlen = sprintf(buffer, "{\"dps\":");
+    } else {
+        printlen = sprintf(buffer, "{\"devId\":\"%s\",\"dps\":", client->activate.devid);
+    }
+    if (low_bw) {
+        printlen += iot_json_compact(buffer + printlen, dps);
+    } else {
+        printlen += sprintf(buffer + printlen, "%s", dps);
+    }
     if (time) {
-        buffer = tal_malloc(strlen(dps) + strlen(time) + 64);
-        TUYA_CHECK_NULL_RETURN(buffer, OPRT_MALLOC_FAILED);
-        printlen = sprintf(buffer, "{\"devId\":\"%s\",\"dps\":%s,\"t\":%s}", client->activate.devid, dps, time);
+        printlen += sprintf(buffer + printlen, ",\"t\":%s}", time);
     } else {
-        buffer = tal_malloc(strlen(dps) + 64);
-        TUYA_CHECK_NULL_RETURN(buffer, OPRT_MALLOC_FAILED);
-        printlen = sprintf(buffer, "{\"devId\":\"%s\",\"dps\":%s}", client->activate.devid, dps);
+        printlen += sprintf(buffer + printlen, "}");
     }
 
     /* Report buffer */
@@ -1216,68 +1520,21 @@ int tuya_iot_version_update_sync(tuya_iot_client_t *client)
     }
 
     int rt = OPRT_OK;
-
-#define VERSION_BUFFER_MAX (128)
-    size_t prealloc_size = VERSION_BUFFER_MAX;
-    if (client->config.modules) {
-        prealloc_size += strlen(client->config.modules) + 10;
-    }
-
-    char *version_buffer = tal_malloc(prealloc_size);
-    if (version_buffer == NULL) {
-        return OPRT_INVALID_PARM;
-    }
-
-    /* Format version JSON buffer */
     size_t version_len = 0;
-    if (client->config.modules) {
-        /* extension modules version */
-        version_len += sprintf(version_buffer + version_len, "%s", client->config.modules);
-        version_len -= 1; // remove ']'
-        version_len += sprintf(version_buffer + version_len, ",");
-    } else {
-        version_len += sprintf(version_buffer + version_len, "[");
-    }
-
-    /* Main firmware information */
-    version_len += sprintf(version_buffer + version_len,
-                           "{\\\"otaChannel\\\":%d,\\\"protocolVer\\\":\\\"%s\\\","
-                           "\\\"baselineVer\\\":\\\"%s\\\",\\\"softVer\\\":\\\"%s\\\"}",
-                           0, PV_VERSION, BS_VERSION, client->config.software_ver);
-
-    version_len += sprintf(version_buffer + version_len, "]");
-    PR_DEBUG("%s", version_buffer);
-
-    /* local storage read buffer*/
-    size_t readlen = 0;
-    char *readbuf = NULL;
-
-    /* Try read activate config data */
-    char version_key[32];
-    snprintf(version_key, sizeof version_key, "%s.ver", client->config.storage_namespace);
-    rt = tal_kv_get((const char *)version_key, (uint8_t **)&readbuf, &readlen);
-    if (OPRT_OK != rt) {
-        PR_WARN("version save info not found:%d", rt);
-    }
-
-    /* Compare the version info changed? */
-    if (readbuf && memcmp(version_buffer, readbuf, version_len) == 0) {
-        PR_DEBUG("The verison unchanged, dont need sync.");
-        tal_kv_free((uint8_t *)readbuf);
-        tal_free(version_buffer);
+    char *version_buffer = iot_version_changed_get(client, &version_len);
+    if (version_buffer == NULL) {
         return OPRT_OK;
     }
 
     /* Post version info to ATOP service */
     rt = atop_service_version_update_v41(client->activate.devid, client->activate.seckey, (const char *)version_buffer);
-    tal_kv_free((uint8_t *)readbuf);
     if (rt != OPRT_OK) {
         tal_free(version_buffer);
         return rt;
     }
 
     /* Save version info */
-    rt = tal_kv_set((const char *)version_key, (const uint8_t *)version_buffer, version_len);
+    rt = iot_version_save(client, version_buffer, version_len);
     tal_free(version_buffer);
 
     return rt;
@@ -230,6 +230,8 @@ struct tuya_iot_client_handle {
     uint8_t state;
     uint8_t nextstate;
     bool is_activated;
+    bool endpoint_cached;      // endpoint read from KV, not resolved this run
+    uint8_t mqtt_connect_fail; // failed connects with the cached endpoint
     /** device manage */
     dp_schema_t *schema;
 };
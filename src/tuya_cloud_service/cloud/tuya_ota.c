@@ -20,6 +20,7 @@
 #include "tuya_endpoint.h"
 #include "iotdns.h"
 #include "mix_method.h"
+#include "tuya_config_defaults.h"
 
 typedef struct {
     tuya_ota_config_t config;
@@ -27,6 +28,8 @@ typedef struct {
     tuya_ota_event_t event;
     uint8_t channel;
     uint8_t progress_percent;
+    TUYA_OTA_TYPE_E type;
+    size_t offset; // bytes written and hashed, a resumed download starts here
     THREAD_HANDLE upgrade_thrd;
     TKL_HASH_HANDLE sha256;
 } tuya_ota_t;
@@ -36,6 +39,15 @@ int tuya_ota_upgrade_progress_report(tuya_ota_t *handle, int percent);
 
 static tuya_ota_t *s_ota_ctx;
 
+static void ota_fault_notify(tuya_ota_t *ota, int status)
+{
+    tuya_ota_upgrade_status_report(ota, status);
+    if (ota->config.event_cb) {
+        ota->event.id = TUYA_OTA_EVENT_FAULT;
+        ota->config.event_cb(&ota->msg, &ota->event);
+    }
+}
+
 static void file_download_event_cb(http_download_event_id_t id, http_download_event_t *event)
 {
     tuya_ota_t *ota = (tuya_ota_t *)event->user_data;
@@ -48,15 +60,26 @@ static void file_download_event_cb(http_download_event_id_t id, http_download_ev
     switch (id) {
     case DL_EVENT_START:
         PR_DEBUG("DL_EVENT_START");
+        //! a resumed download keeps the flash and the hash of the first run
+        if (ota->offset) {
+            break;
+        }
+        ota->progress_percent = 0;
         tuya_ota_upgrade_status_report(ota, TUS_UPGRDING);
+        if (ota->sha256) {
+            tal_sha256_free(ota->sha256);
+        }
         tal_sha256_create_init(&ota->sha256);
         tal_sha256_starts_ret(ota->sha256, 0);
         break;
 
     case DL_EVENT_ON_FILESIZE:
         PR_DEBUG("DL_EVENT_ON_FILESIZE");
+        if (ota->offset) {
+            break;
+        }
         if (0 == ota->channel) {
-            tal_ota_start_notify(event->file_size, TUYA_OTA_FULL, TUYA_OTA_PATH_AIR);
+            tal_ota_start_notify(event->file_size, ota->type, TUYA_OTA_PATH_AIR);
         } else if (event_cb) {
             ota->event.id = TUYA_OTA_EVENT_START;
             ota->event.file_size = event->file_size;
@@ -77,11 +100,6 @@ static void file_download_event_cb(http_download_event_id_t id, http_download_ev
             ota_pack.len = event->data_len;
             ota_pack.pri_data = NULL;
             tal_ota_data_process(&ota_pack, (uint32_t *)&event->remain_len);
-            if (event->remain_len) {
-                tal_sha256_update_ret(ota->sha256, event->data, event->data_len - event->remain_len);
-            } else {
-                tal_sha256_update_ret(ota->sha256, event->data, event->data_len);
-            }
         } else if (event_cb) {
             ota->event.id = TUYA_OTA_EVENT_ON_DATA;
             ota->event.data = event->data;
@@ -89,6 +107,9 @@ static void file_download_event_cb(http_download_event_id_t id, http_download_ev
             ota->event.offset = event->offset;
             event_cb(&ota->msg, &ota->event);
         }
+        //! hash what was written, the remain is handed in again with the next data
+        tal_sha256_update_ret(ota->sha256, event->data, event->data_len - event->remain_len);
+        ota->offset = event->offset + event->data_len - event->remain_len;
         uint8_t percent = event->offset * 100 / event->file_size;
         if (percent - ota->progress_percent > 5) {
             PR_DEBUG("File Download Percent: %d%%", percent);
@@ -103,6 +124,7 @@ static void file_download_event_cb(http_download_event_id_t id, http_download_ev
         PR_DEBUG("File Download Percent: %d%%", 100);
         tal_sha256_finish_ret(ota->sha256, file_hmac);
         tal_sha256_free(ota->sha256);
+        ota->sha256 = NULL;
         hex2str((uint8_t *)file_sha256, file_hmac, 32);
         tal_sha256_mac((const uint8_t *)client->activate.seckey, strlen(client->activate.seckey), file_sha256, 32 * 2,
                        file_hmac);
@@ -117,16 +139,15 @@ static void file_download_event_cb(http_download_event_id_t id, http_download_ev
                 ota->event.id = TUYA_OTA_EVENT_FINISH;
                 event_cb(&ota->msg, &ota->event);
             }
+        } else {
+            PR_ERR("file hmac check failed");
+            ota_fault_notify(ota, TUS_DOWNLOAD_ERROR_HMAC);
         }
         break;
 
     case DL_EVENT_FAULT:
+        //! reported by the download thread once resuming is given up
         PR_DEBUG("DL_EVENT_FAULT");
-        tuya_ota_upgrade_status_report(ota, TUS_UPGRD_EXEC);
-        if (event_cb) {
-            ota->event.id = TUYA_OTA_EVENT_FAULT;
-            event_cb(&ota->msg, &ota->event);
-        }
         break;
 
     default:
@@ -163,6 +184,20 @@ static void ota_process_thread_func(void *arg)
 {
     tuya_ota_t *ota = (tuya_ota_t *)arg;
 
+    //! a platform that upgrades with difference packages is sent and applies those
+    if (0 == ota->channel) {
+        uint32_t image_size = 0;
+
+        ota->type = TUYA_OTA_FULL;
+        if (OPRT_OK == tal_ota_get_ability(&image_size, &ota->type) && image_size &&
+            ota->msg.file_size > image_size) {
+            PR_ERR("ota file %d larger than image area %d", (int)ota->msg.file_size, image_size);
+            tuya_ota_upgrade_status_report(ota, TUS_DOWNLOAD_ERROR_STORAGE_NOT_ENOUGH);
+            return;
+        }
+        PR_DEBUG("ota type %d, image area %d", ota->type, image_size);
+    }
+
     //! get ota cert
     uint8_t *cert = NULL;
     uint16_t cert_len = 0;
@@ -179,7 +214,27 @@ static void ota_process_thread_func(void *arg)
     download_cfg.event_handler = file_download_event_cb;
     download_cfg.user_data = ota;
 
-    http_file_download(&download_cfg);
+    int rt = OPRT_OK;
+    uint32_t retry = 0;
+
+    ota->offset = 0;
+    for (;;) {
+        download_cfg.offset = ota->offset;
+        rt = http_file_download(&download_cfg);
+        if (OPRT_OK == rt || retry++ >= TUYA_OTA_RESUME_RETRY) {
+            break;
+        }
+        PR_WARN("ota download stopped at %d, resume %d/%d", (int)ota->offset, retry, TUYA_OTA_RESUME_RETRY);
+        tal_system_sleep(TUYA_OTA_RESUME_DELAY_MS);
+    }
+
+    if (OPRT_OK != rt) {
+        ota_fault_notify(ota, TUS_UPGRD_EXEC);
+    }
+    if (ota->sha256) {
+        tal_sha256_free(ota->sha256);
+        ota->sha256 = NULL;
+    }
     tal_free(cert);
 }
 
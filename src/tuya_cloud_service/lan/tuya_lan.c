@@ -36,17 +36,32 @@
 #define SERV_PORT_APP_UDP_BCAST 7000 // APP broadcast, device listening port
 
 #define UDP_T_ITRV         5 // s
-#define CLIENT_LMT         3
+#ifndef CLIENT_LMT
+#define CLIENT_LMT 3 // sessions, the least recently active is evicted for a new one
+#endif
 #define RECV_BUF_LMT       512
 #define LAN_FRAME_MAX_LEN  (4 * 1024)
 #define HEART_BEAT_TIMEOUT 30
 #define ALLOW_NO_KEY_NUM   3
 
+// discovery broadcast interval range in s, see lan_udp_serv_sock_pre_select
+#ifndef LAN_UDP_BCAST_MIN_INTV
+#define LAN_UDP_BCAST_MIN_INTV 1
+#endif
+#ifndef LAN_UDP_BCAST_MAX_INTV
+#define LAN_UDP_BCAST_MAX_INTV 300
+#endif
+
+// bytes queued for a client that reads slowly before it is dropped
+#ifndef LAN_TX_QUEUE_MAX
+#define LAN_TX_QUEUE_MAX (2 * LAN_FRAME_MAX_LEN)
+#endif
+
 #define HMAC_LEN       32
 #define RAND_LEN       16
 #define SESSIONKEY_LEN 16
 
-typedef struct {
+typedef struct lan_session {
     BOOL_T active;
     BOOL_T fault;
     int fd;
@@ -57,6 +72,13 @@ typedef struct {
     uint8_t randB[RAND_LEN];
     uint8_t hmac[HMAC_LEN];
     uint8_t secret_key[SESSIONKEY_LEN];
+    cipher_gcm_ctx_t gcm; // reused for every frame sent on this session
+    uint8_t *tx_buf;      // bytes the socket did not take yet
+    uint32_t tx_off;
+    uint32_t tx_len;
+    struct lan_session *hnext; // fd hash chain
+    struct lan_session *prev;  // activity list, least recent first
+    struct lan_session *next;
 } lan_session_t;
 
 typedef struct {
@@ -79,7 +101,11 @@ typedef struct {
 
 typedef struct {
     int fd_num;
+    int fault_num;
     lan_session_t *session;
+    lan_session_t **fd_hash; // client_num buckets of active sessions
+    lan_session_t *lru_head; // active sessions by activity, faulty ones first
+    lan_session_t *lru_tail;
     MUTEX_HANDLE mutex;
     MUTEX_HANDLE tcp_mutex;
 
@@ -92,6 +118,12 @@ typedef struct {
 
     tuya_iot_client_t *iot_client;
     lan_cfg_t *cfg;
+    cipher_gcm_ctx_t gcm; // used by lan_msg_gcm_encrpt, protected by mutex
+    uint8_t *udp_pkt;     // encrypted discovery packet, see lan_udp_packet_get
+    int udp_pkt_len;
+    uint32_t udp_pkt_crc; // of its plaintext
+    uint32_t bcast_intv;  // s, 0 while clients are connected
+    SYS_TIME_T bcast_next;
     // extension
     uint32_t recv_offset;
     uint8_t recv_buf[0]; // keep it last !!!
@@ -113,10 +145,80 @@ static lan_mgr_t *lan_mgr_get(void)
 
 static void lan_session_free(lan_session_t *session)
 {
+    cipher_gcm_ctx_free(&session->gcm);
+    if (session->tx_buf) {
+        tal_free(session->tx_buf);
+    }
     memset(session, 0, sizeof(lan_session_t));
     session->fd = -1;
 }
 
+static void lan_session_lru_remove(lan_mgr_t *lan, lan_session_t *session)
+{
+    if (session->prev) {
+        session->prev->next = session->next;
+    } else {
+        lan->lru_head = session->next;
+    }
+    if (session->next) {
+        session->next->prev = session->prev;
+    } else {
+        lan->lru_tail = session->prev;
+    }
+    session->prev = session->next = NULL;
+}
+
+static void lan_session_lru_append(lan_mgr_t *lan, lan_session_t *session)
+{
+    session->prev = lan->lru_tail;
+    session->next = NULL;
+    if (lan->lru_tail) {
+        lan->lru_tail->next = session;
+    } else {
+        lan->lru_head = session;
+    }
+    lan->lru_tail = session;
+}
+
+static void lan_session_lru_prepend(lan_mgr_t *lan, lan_session_t *session)
+{
+    session->prev = NULL;
+    session->next = lan->lru_head;
+    if (lan->lru_head) {
+        lan->lru_head->prev = session;
+    } else {
+        lan->lru_tail = session;
+    }
+    lan->lru_head = session;
+}
+
+/* hooks an active session into the fd hash and the activity list, mutex held */
+static void lan_session_link(lan_mgr_t *lan, lan_session_t *session)
+{
+    lan_session_t **bucket = &lan->fd_hash[(uint32_t)session->fd % lan->cfg->client_num];
+
+    session->hnext = *bucket;
+    *bucket = session;
+    lan_session_lru_append(lan, session);
+}
+
+static void lan_session_unlink(lan_mgr_t *lan, lan_session_t *session)
+{
+    lan_session_t **pp = &lan->fd_hash[(uint32_t)session->fd % lan->cfg->client_num];
+
+    while (*pp && *pp != session) {
+        pp = &(*pp)->hnext;
+    }
+    if (*pp) {
+        *pp = session->hnext;
+    }
+    session->hnext = NULL;
+    lan_session_lru_remove(lan, session);
+    if (session->fault) {
+        lan->fault_num--;
+    }
+}
+
 static void lan_session_close(lan_session_t *session)
 {
     lan_mgr_t *lan = lan_mgr_get();
@@ -133,6 +235,7 @@ static void lan_session_close(lan_session_t *session)
     if (session->fd != -1) {
         tal_event_publish(EVENT_LAN_CLIENT_CLOSE, &session->fd);
         tuya_unreg_lan_sock(session->fd);
+        lan_session_unlink(lan, session);
         lan_session_free(session);
         lan->fd_num--;
     }
@@ -145,12 +248,17 @@ static void lan_sesison_add(int socket, TIME_T time)
 
     lan_mgr_t *lan = lan_mgr_get();
 
-    if (lan == NULL || socket < 0 || (lan->fd_num >= lan->cfg->client_num)) {
+    if (lan == NULL || socket < 0) {
         PR_ERR("add socket err socket %d", socket);
         return;
     }
 
     tal_mutex_lock(lan->mutex);
+    if (lan->fd_num >= lan->cfg->client_num && lan->lru_head) {
+        // full, make room by dropping the least recently active session
+        PR_DEBUG("evict session socket:%d", lan->lru_head->fd);
+        lan_session_close(lan->lru_head);
+    }
     for (i = 0; i < lan->cfg->client_num; i++) {
         if (lan->session[i].active) {
             continue;
@@ -162,6 +270,8 @@ static void lan_sesison_add(int socket, TIME_T time)
         lan->session[i].fault = false;
         lan->session[i].time = time;
         lan->session[i].sequence_out = uni_random_range(0xFFFF);
+        cipher_gcm_ctx_init(&lan->session[i].gcm);
+        lan_session_link(lan, &lan->session[i]);
         lan->fd_num++;
         break;
     }
@@ -181,7 +291,15 @@ static void lan_session_fault_set(lan_session_t *session)
         return;
     }
     PR_DEBUG("set socket fault %d", session->fd);
-    session->fault = true;
+    tal_mutex_lock(lan->mutex);
+    if (!session->fault) {
+        session->fault = true;
+        lan->fault_num++;
+        // first in line for lan_session_time_check
+        lan_session_lru_remove(lan, session);
+        lan_session_lru_prepend(lan, session);
+    }
+    tal_mutex_unlock(lan->mutex);
 }
 
 static void lan_session_close_all(void)
@@ -204,14 +322,19 @@ static void lan_session_close_all(void)
         tuya_unreg_lan_sock(lan->udp_serv_fd);
         lan->udp_serv_fd = -1;
     }
-    for (i = 0; i < lan->cfg->client_num; i++) {
+    for (i = 0; lan->session && i < lan->cfg->client_num; i++) {
         if (lan->session[i].active) {
             tal_event_publish(EVENT_LAN_CLIENT_CLOSE, &lan->session[i].fd);
             tuya_unreg_lan_sock(lan->session[i].fd);
             lan_session_free(&lan->session[i]);
         }
     }
+    if (lan->fd_hash) {
+        memset(lan->fd_hash, 0, sizeof(lan_session_t *) * lan->cfg->client_num);
+    }
+    lan->lru_head = lan->lru_tail = NULL;
     lan->fd_num = 0;
+    lan->fault_num = 0;
     tal_mutex_unlock(lan->mutex);
 }
 
@@ -228,9 +351,19 @@ static void lan_session_time_update(lan_session_t *session, const TIME_T time)
         return;
     }
     PR_TRACE("up_socket_time %d", session->time);
+    tal_mutex_lock(lan->mutex);
     session->time = time;
+    if (!session->fault) {
+        lan_session_lru_remove(lan, session);
+        lan_session_lru_append(lan, session);
+    }
+    tal_mutex_unlock(lan->mutex);
 }
 
+/*
+ * Closes faulty and idle sessions. The activity list has those first, so
+ * only the sessions closed and one more are looked at.
+ */
 static void lan_session_time_check(const TIME_T time)
 {
     lan_mgr_t *lan = lan_mgr_get();
@@ -238,32 +371,43 @@ static void lan_session_time_check(const TIME_T time)
     if (0 == lan->fd_num) {
         return;
     }
-    int i;
-    for (i = 0; i < lan->cfg->client_num; i++) {
-        if (lan->session[i].active) {
-            if ((time - lan->session[i].time) >= 2592000 && (true != lan->session[i].fault)) { // 1 month sencond
-                continue;
-            } else if ((time - lan->session[i].time >= lan->cfg->heart_timeout) || (lan->session[i].fault == true)) {
-                PR_DEBUG("i:%d,time:%d,time:%d,fault:%d", i, time, lan->session[i].time, lan->session[i].fault);
-                lan_session_close(&lan->session[i]);
-            }
+    tal_mutex_lock(lan->mutex);
+    lan_session_t *session = lan->lru_head;
+    while (session) {
+        if (!session->fault && (time - session->time) >= 2592000) { // 1 month sencond
+            // the clock jumped, count the idle time from now on
+            session->time = time;
+            lan_session_lru_remove(lan, session);
+            lan_session_lru_append(lan, session);
+            session = lan->lru_head;
+            continue;
         }
+        if (!session->fault && (time - session->time) < lan->cfg->heart_timeout) {
+            break;
+        }
+        PR_DEBUG("fd:%d,time:%d,time:%d,fault:%d", session->fd, time, session->time, session->fault);
+        lan_session_close(session);
+        session = lan->lru_head;
     }
+    tal_mutex_unlock(lan->mutex);
 }
 
 static lan_session_t *lan_session_get_by_fd(int fd)
 {
-    int i;
-
     lan_mgr_t *lan = lan_mgr_get();
 
-    for (i = 0; lan && i < lan->cfg->client_num; i++) {
-        if (lan->session[i].fd == fd) {
-            return &lan->session[i];
-        }
+    if (lan == NULL || lan->fd_hash == NULL || fd < 0) {
+        return NULL;
+    }
+
+    tal_mutex_lock(lan->mutex);
+    lan_session_t *session = lan->fd_hash[(uint32_t)fd % lan->cfg->client_num];
+    while (session && session->fd != fd) {
+        session = session->hnext;
     }
+    tal_mutex_unlock(lan->mutex);
 
-    return NULL;
+    return session;
 }
 
 static int lan_session_active_num_get(void)
@@ -309,7 +453,14 @@ int lan_msg_gcm_encrpt(uint8_t *data, uint32_t len, uint8_t **ec_data, uint32_t
         return OPRT_MALLOC_FAILED;
     }
     memset(send_buf, 0, lpv35_frame_buffer_size_get(&frame));
-    op_ret = lpv35_frame_serialize(key, APP_KEY_LEN, &frame, send_buf, &olen);
+    lan_mgr_t *lan = lan_mgr_get();
+    if (lan) {
+        tal_mutex_lock(lan->mutex);
+        op_ret = lpv35_frame_serialize_ctx(&lan->gcm, key, APP_KEY_LEN, &frame, send_buf, &olen);
+        tal_mutex_unlock(lan->mutex);
+    } else {
+        op_ret = lpv35_frame_serialize(key, APP_KEY_LEN, &frame, send_buf, &olen);
+    }
     if (OPRT_OK == op_ret) {
         *ec_data = send_buf;
         *ec_len = olen;
@@ -399,32 +550,124 @@ static int lan_get_valid_socket_num(lan_mgr_t *lan)
         return 0;
     }
 
-    int num = 0;
-
     tal_mutex_lock(lan->mutex);
-    num = lan->fd_num;
-    if (0 == num) {
-        tal_mutex_unlock(lan->mutex);
-        return 0;
+    int num = lan->fd_num - lan->fault_num;
+    tal_mutex_unlock(lan->mutex);
+
+    PR_TRACE("socketNum:%d ", num);
+    return num;
+}
+
+static uint8_t *lan_session_key_get(lan_mgr_t *lan, lan_session_t *session)
+{
+    if (!lan->iot_client->is_activated) {
+        //! TODO:
+        return NULL;
     }
+    if (session->secret_key[0]) {
+        return (uint8_t *)session->secret_key;
+    }
+    return (uint8_t *)lan->iot_client->activate.localkey;
+}
 
-    int i, fault_cnt = 0;
-    for (i = 0; i < lan->cfg->client_num; i++) {
-        if (lan->session[i].active) {
-            if (lan->session[i].fault == true) {
-                fault_cnt++;
+/* sends what is queued on the session, the caller holds lan->mutex */
+static void lan_session_tx_flush(lan_session_t *session)
+{
+    while (session->tx_len) {
+        int ret = tal_net_send(session->fd, session->tx_buf + session->tx_off, session->tx_len);
+        if (ret <= 0) {
+            if (tal_net_get_errno() != UNW_EINTR && tal_net_get_errno() != UNW_EAGAIN) {
+                PR_ERR("send err:%d errno:%d", ret, tal_net_get_errno());
+                lan_session_fault_set(session);
             }
+            return;
         }
+        session->tx_off += ret;
+        session->tx_len -= ret;
     }
-    tal_mutex_unlock(lan->mutex);
+    tal_free(session->tx_buf);
+    session->tx_buf = NULL;
+    session->tx_off = 0;
+}
 
-    if (fault_cnt >= num) {
-        PR_TRACE("socket all falult:%d ", num);
-        return 0;
+/*
+ * Writes a frame without blocking, the caller holds lan->mutex. What the
+ * socket does not take is queued on the session behind earlier frames and
+ * sent from the sock loop, so a slow client does not hold up the others.
+ */
+static int lan_session_frame_send(lan_session_t *session, const uint8_t *frame, uint32_t len)
+{
+    uint32_t sent = 0;
+
+    if (session->tx_len) {
+        lan_session_tx_flush(session);
+    }
+    if (session->fault) {
+        return OPRT_SVC_LAN_SEND_ERR;
+    }
+
+    while (session->tx_len == 0 && sent < len) {
+        int ret = tal_net_send(session->fd, frame + sent, len - sent);
+        if (ret <= 0) {
+            if (tal_net_get_errno() == UNW_EINTR || tal_net_get_errno() == UNW_EAGAIN) {
+                break;
+            }
+            PR_ERR("send err:%d errno:%d", ret, tal_net_get_errno());
+            lan_session_fault_set(session);
+            return OPRT_SVC_LAN_SEND_ERR;
+        }
+        sent += ret;
+    }
+    if (sent == len) {
+        return OPRT_OK;
     }
 
-    PR_TRACE("socketNum:%d ", num - fault_cnt);
-    return (num - fault_cnt);
+    // queue the rest
+    uint32_t rest = len - sent;
+    if (session->tx_len + rest > LAN_TX_QUEUE_MAX) {
+        PR_ERR("session %d tx queue full:%d", session->fd, session->tx_len);
+        lan_session_fault_set(session);
+        return OPRT_SVC_LAN_SEND_ERR;
+    }
+    if (session->tx_off) {
+        memmove(session->tx_buf, session->tx_buf + session->tx_off, session->tx_len);
+        session->tx_off = 0;
+    }
+    uint8_t *tx_buf = tal_realloc(session->tx_buf, session->tx_len + rest);
+    if (tx_buf == NULL) {
+        lan_session_fault_set(session);
+        return OPRT_MALLOC_FAILED;
+    }
+    memcpy(tx_buf + session->tx_len, frame + sent, rest);
+    session->tx_buf = tx_buf;
+    session->tx_len += rest;
+    PR_TRACE("session %d queued:%d", session->fd, session->tx_len);
+
+    return OPRT_OK;
+}
+
+/*
+ * Seals the plaintext at buf + LPV35_FRAME_HEADROOM for the session and sends
+ * it, the caller holds lan->mutex. buf keeps the cipher text afterwards.
+ */
+static int lan_session_seal_send(lan_mgr_t *lan, lan_session_t *session, uint32_t fr_type, uint8_t *buf,
+                                 uint32_t plaintext_len)
+{
+    int op_ret = OPRT_OK;
+    int send_len = 0;
+
+    uint8_t *key = lan_session_key_get(lan, session);
+    if (key == NULL) {
+        return OPRT_COM_ERROR;
+    }
+    op_ret = lpv35_frame_seal(&session->gcm, key, SESSIONKEY_LEN, session->sequence_out++, fr_type, buf,
+                              plaintext_len, &send_len);
+    if (op_ret != OPRT_OK) {
+        PR_ERR("lpv35_frame_seal fail:%d", op_ret);
+        return OPRT_COM_ERROR;
+    }
+
+    return lan_session_frame_send(session, buf, send_len);
 }
 
 static int lan_send(lan_session_t *session, uint32_t fr_num, uint32_t fr_type, uint32_t ret_code, uint8_t *data,
@@ -439,80 +682,77 @@ static int lan_send(lan_session_t *session, uint32_t fr_num, uint32_t fr_type, u
         PR_ERR("session->active == false");
         return OPRT_COM_ERROR;
     }
-    tal_mutex_lock(s_lan_mgr->mutex);
-    if (session->fault == true) {
-        PR_ERR("session is error");
-        tal_mutex_unlock(s_lan_mgr->mutex);
-        return OPRT_SVC_LAN_SOCKET_FAULT;
-    }
-    tal_mutex_unlock(s_lan_mgr->mutex);
-
-    uint8_t *send_buf = NULL;
-    uint32_t send_len = 0;
 
     PR_TRACE("tcp sendbuf socket:%d fr_num:%u fr_type:%d ret:%d len:%d", session->fd, fr_num, fr_type, ret_code, len);
 
-    uint8_t *key = NULL;
     lan_mgr_t *lan = lan_mgr_get();
-    if (lan->iot_client->is_activated) {
-        if (session->secret_key[0]) {
-            key = (uint8_t *)session->secret_key;
-        } else {
-            key = (uint8_t *)lan->iot_client->activate.localkey;
-        }
-    } else {
-        //! TODO:
-        return OPRT_COM_ERROR;
-    }
+    // the plaintext is built inside the frame buffer and encrypted in place
     int plaintext_len = sizeof(lpv35_plaintext_data_t) + len;
-    lpv35_plaintext_data_t *plaintext_data = tal_malloc(plaintext_len);
-    if (plaintext_data == NULL) {
-        PR_ERR("plaintext_data fail");
+    uint8_t *send_buf = tal_malloc(LPV35_FRAME_HEADROOM + plaintext_len + LPV35_FRAME_TAILROOM);
+    if (send_buf == NULL) {
+        PR_ERR("send_buf malloc fail");
         return OPRT_MALLOC_FAILED;
     }
-    memset(plaintext_data, 0, plaintext_len);
+    lpv35_plaintext_data_t *plaintext_data = (lpv35_plaintext_data_t *)(send_buf + LPV35_FRAME_HEADROOM);
     plaintext_data->ret_code = ret_code;
-    memcpy(plaintext_data->data, data, len);
-    // lpv3.5 test arch
-    lpv35_frame_object_t frame = {.sequence = session->sequence_out++,
-                                  .type = fr_type,
-                                  .data = (void *)plaintext_data,
-                                  .data_len = plaintext_len};
-    send_buf = tal_malloc(lpv35_frame_buffer_size_get(&frame));
-    if (send_buf == NULL) {
-        PR_ERR("send_buf malloc fail");
-        tal_free(plaintext_data);
+    if (len) {
+        memcpy(plaintext_data->data, data, len);
+    }
+
+    tal_mutex_lock(lan->mutex);
+    if (session->fault == true) {
+        PR_ERR("session is error");
+        op_ret = OPRT_SVC_LAN_SOCKET_FAULT;
+    } else {
+        op_ret = lan_session_seal_send(lan, session, fr_type, send_buf, plaintext_len);
+    }
+    tal_mutex_unlock(lan->mutex);
+    tal_free(send_buf);
+
+    return op_ret;
+}
+
+/*
+ * Sends one plaintext to every usable session. The plaintext is built once,
+ * each session only copies it into the shared frame buffer and seals it with
+ * its own key, and no write blocks on a slow client.
+ */
+static int lan_broadcast(lan_mgr_t *lan, uint32_t fr_type, uint32_t ret_code, const uint8_t *data, uint32_t len,
+                         BOOL_T need_session_key)
+{
+    int i = 0;
+    int op_ret = OPRT_OK;
+    uint32_t plaintext_len = sizeof(lpv35_plaintext_data_t) + len;
+    uint32_t frame_len = LPV35_FRAME_HEADROOM + plaintext_len + LPV35_FRAME_TAILROOM;
+
+    // plaintext behind the frame buffer, sealing overwrites the frame only
+    uint8_t *buf = tal_malloc(frame_len + plaintext_len);
+    if (buf == NULL) {
+        PR_ERR("broadcast malloc fail");
         return OPRT_MALLOC_FAILED;
     }
-    memset(send_buf, 0, lpv35_frame_buffer_size_get(&frame));
-    op_ret = lpv35_frame_serialize(key, 16, &frame, send_buf, (int *)&send_len);
-    tal_free(plaintext_data);
-    if (op_ret != OPRT_OK) {
-        PR_ERR("lpv35_frame_serialize fail:%d", op_ret);
-        tal_free(send_buf);
-        return OPRT_COM_ERROR;
+    lpv35_plaintext_data_t *plaintext_data = (lpv35_plaintext_data_t *)(buf + frame_len);
+    plaintext_data->ret_code = ret_code;
+    if (len) {
+        memcpy(plaintext_data->data, data, len);
     }
-    tal_mutex_lock(s_lan_mgr->mutex);
-    int ret = tal_net_send(session->fd, send_buf, send_len);
-    if (ret <= 0 || ret != send_len) {
-        if ((tal_net_get_errno() == UNW_EINTR) || (tal_net_get_errno() == UNW_EAGAIN)) {
-            tal_system_sleep(100);
-            ret = tal_net_send(session->fd, send_buf, send_len);
-            if (ret <= 0 || ret != send_len) {
-                op_ret = OPRT_SVC_LAN_SEND_ERR;
-            }
-        } else {
-            op_ret = OPRT_SVC_LAN_SEND_ERR;
+
+    lan_session_t *session = lan_sessions_get();
+    tal_mutex_lock(lan->mutex);
+    for (i = 0; i < lan->cfg->client_num; i++) {
+        if (!session[i].active || session[i].fault || (need_session_key && session[i].secret_key[0] == '\0')) {
+            continue;
+        }
+        memcpy(buf + LPV35_FRAME_HEADROOM, plaintext_data, plaintext_len);
+        op_ret = lan_session_seal_send(lan, &session[i], fr_type, buf, plaintext_len);
+        if (OPRT_OK != op_ret) {
+            PR_ERR("tcp_send op_ret:%d", op_ret);
         }
     }
+    tal_mutex_unlock(lan->mutex);
+    tal_free(buf);
 
-    tal_free(send_buf);
-    if (op_ret == OPRT_SVC_LAN_SEND_ERR) {
-        lan_session_fault_set(session);
-        PR_ERR("ret:%d send_len:%d errno:%d", ret, send_len, tal_net_get_errno());
-    }
-    tal_mutex_unlock(s_lan_mgr->mutex);
-    return op_ret;
+    return OPRT_OK;
 }
 
 static int lan_setup_udp_serv_socket(int port)
@@ -544,7 +784,12 @@ __exit:
     return ret;
 }
 
-static void lan_make_udp_packets(uint8_t **out, int *p_olen)
+/*
+ * Returns the discovery packet. It is kept encrypted in lan_mgr_t and only
+ * built again when its plaintext changes, which also restarts the broadcast
+ * schedule, since a new ip or activation is worth announcing quickly.
+ */
+static const uint8_t *lan_udp_packet_get(lan_mgr_t *lan, int *p_olen)
 {
     int op_ret = OPRT_OK;
     NW_IP_S ip;
@@ -554,8 +799,6 @@ static void lan_make_udp_packets(uint8_t **out, int *p_olen)
     //! TODO:
     netmgr_conn_get(NETCONN_AUTO, NETCONN_CMD_IP, &ip);
 
-    lan_mgr_t *lan = lan_mgr_get();
-
     uint32_t offset = 0;
     char *id = NULL;
     if (lan->iot_client->is_activated) {
@@ -564,64 +807,61 @@ static void lan_make_udp_packets(uint8_t **out, int *p_olen)
         id = (char *)lan->iot_client->config.uuid;
     }
 
-    uint32_t data_len = 256;
-    char *json_buf = tal_malloc(data_len);
-    if (NULL == json_buf) {
-        PR_ERR("tal_malloc Fail");
-        return;
-    }
-    memset(json_buf, 0, data_len);
-
-    offset += sprintf(json_buf + offset, "{\"ip\":\"%s\",\"gwId\":\"%s\",\"uuid\":\"%s\"", ip.ip, id,
-                      lan->iot_client->config.uuid);
-    offset += sprintf(json_buf + offset, ",\"active\":%d,\"ablilty\":0", lan->iot_client->is_activated ? 2 : 0);
-    offset += sprintf(json_buf + offset, ",\"encrypt\":true");
-    offset += sprintf(json_buf + offset, ",\"productKey\":\"%s\"", lan->iot_client->config.productkey);
-    offset += sprintf(json_buf + offset, ",\"version\":\"%s\"", TUYA_LPV35);
-    offset += sprintf(json_buf + offset, ",\"sl\":%d", TUYA_SECURITY_LEVEL);
-    json_buf[offset] = '}';
-    json_buf[offset + 1] = 0;
-
-    // PR_DEBUG("BufToSend %d %d:%s",data_len, offset, json_buf);
-    int plaintext_len = sizeof(lpv35_plaintext_data_t) + strlen(json_buf);
-    lpv35_plaintext_data_t *plaintext_data = tal_malloc(plaintext_len);
-    if (plaintext_data == NULL) {
-        PR_ERR("plaintext_data fail");
-        tal_free(json_buf);
-        return;
+    char json_buf[256];
+    offset += snprintf(json_buf + offset, sizeof(json_buf) - offset, "{\"ip\":\"%s\",\"gwId\":\"%s\",\"uuid\":\"%s\"",
+                       ip.ip, id, lan->iot_client->config.uuid);
+    offset += snprintf(json_buf + offset, sizeof(json_buf) - offset, ",\"active\":%d,\"ablilty\":0",
+                       lan->iot_client->is_activated ? 2 : 0);
+    offset += snprintf(json_buf + offset, sizeof(json_buf) - offset, ",\"encrypt\":true");
+    offset += snprintf(json_buf + offset, sizeof(json_buf) - offset, ",\"productKey\":\"%s\"",
+                       lan->iot_client->config.productkey);
+    offset += snprintf(json_buf + offset, sizeof(json_buf) - offset, ",\"version\":\"%s\"", TUYA_LPV35);
+    offset += snprintf(json_buf + offset, sizeof(json_buf) - offset, ",\"sl\":%d}", TUYA_SECURITY_LEVEL);
+    if (offset >= sizeof(json_buf)) {
+        PR_ERR("udp packet too long:%d", offset);
+        return NULL;
     }
-    memset(plaintext_data, 0, plaintext_len);
-    plaintext_data->ret_code = 0;
-    memcpy(plaintext_data->data, json_buf, strlen(json_buf));
-    tal_free(json_buf);
 
-    // lpv3.5 test arch
-    lpv35_frame_object_t frame = {
-        .sequence = 0,
-        .type = FRM_TYPE_ENCRYPTION,
-        .data = (uint8_t *)plaintext_data,
-        .data_len = plaintext_len,
-    };
+    uint32_t crc = hash_crc32i_total(json_buf, offset);
+    if (lan->udp_pkt && crc == lan->udp_pkt_crc) {
+        *p_olen = lan->udp_pkt_len;
+        return lan->udp_pkt;
+    }
 
-    uint8_t *send_buf = tal_malloc(lpv35_frame_buffer_size_get(&frame));
+    // PR_DEBUG("BufToSend %d:%s", offset, json_buf);
+    uint32_t plaintext_len = sizeof(lpv35_plaintext_data_t) + offset;
+    uint8_t *send_buf = tal_malloc(LPV35_FRAME_HEADROOM + plaintext_len + LPV35_FRAME_TAILROOM);
     if (send_buf == NULL) {
         PR_ERR("send_buf malloc fail");
-        tal_free(plaintext_data);
-        return;
+        return NULL;
     }
-    memset(send_buf, 0, lpv35_frame_buffer_size_get(&frame));
-    op_ret = lpv35_frame_serialize(app_key2, APP_KEY_LEN, &frame, send_buf, p_olen);
-    tal_free(plaintext_data);
+    lpv35_plaintext_data_t *plaintext_data = (lpv35_plaintext_data_t *)(send_buf + LPV35_FRAME_HEADROOM);
+    plaintext_data->ret_code = 0;
+    memcpy(plaintext_data->data, json_buf, offset);
+
+    int olen = 0;
+    tal_mutex_lock(lan->mutex);
+    op_ret = lpv35_frame_seal(&lan->gcm, app_key2, APP_KEY_LEN, 0, FRM_TYPE_ENCRYPTION, send_buf, plaintext_len,
+                              &olen);
+    tal_mutex_unlock(lan->mutex);
     if (op_ret != OPRT_OK) {
-        PR_ERR("lpv35_frame_serialize fail:%d", op_ret);
+        PR_ERR("lpv35_frame_seal fail:%d", op_ret);
         tal_free(send_buf);
-        return;
+        return NULL;
     }
 
-    // tuya_debug_hex_dump("frame", 8, send_buf, olen);
-    // PR_DEBUG("local key:%s", gw_cntl->gw_actv.local_key);
+    if (lan->udp_pkt) {
+        tal_free(lan->udp_pkt);
+    }
+    lan->udp_pkt = send_buf;
+    lan->udp_pkt_len = olen;
+    lan->udp_pkt_crc = crc;
+    lan->bcast_intv = LAN_UDP_BCAST_MIN_INTV;
+    lan->bcast_next = tal_system_get_millisecond();
+    PR_DEBUG("udp packet rebuilt, len:%d", olen);
 
-    *out = send_buf;
+    *p_olen = olen;
+    return send_buf;
 }
 
 /**
@@ -658,17 +898,7 @@ int tuya_lan_dp_report(char *dpstr)
         PR_DEBUG("Prepare To Send Lan:%s, msg_len:%d, out_len:%d", out, strlen(dpstr), out_len);
     }
 
-    lan_session_t *session = lan_sessions_get();
-    int i = 0;
-
-    for (i = 0; i < lan->cfg->client_num; i++) {
-        if (session[i].active && session[i].fault == false && session[i].secret_key[0] != '\0') {
-            op_ret = lan_send(&session[i], 0, FRM_TP_STAT_REPORT, 0, out, out_len, false);
-            if (OPRT_OK != op_ret) {
-                PR_ERR("tcp_send op_ret:%d", op_ret);
-            }
-        }
-    }
+    lan_broadcast(lan, FRM_TP_STAT_REPORT, 0, out, out_len, true);
     tal_free(out);
 
     return OPRT_OK;
@@ -973,19 +1203,19 @@ recv_again:
             continue;
         }
         //! TODO:
+        // decrypted in place, the frame is consumed afterwards anyway
         lpv35_frame_object_t frame_out = {0};
-        ret = lpv35_frame_parse(key, SESSIONKEY_LEN, frame_buffer, frame_len, &frame_out);
+        tal_mutex_lock(lan->mutex);
+        ret = lpv35_frame_open(&session->gcm, key, SESSIONKEY_LEN, frame_buffer, frame_len, &frame_out);
+        tal_mutex_unlock(lan->mutex);
         if (ret != OPRT_OK) {
-            PR_ERR("lpv35_frame_parse fail:%d", ret);
+            PR_ERR("lpv35_frame_open fail:%d", ret);
             break;
         }
         offset += frame_len;
         // update time
         lan_session_time_update(session, tal_time_get_posix());
         lan_protocol_process(lan, session, &frame_out);
-        if (frame_out.data) {
-            tal_free(frame_out.data);
-        }
     }
 
     if (tmp_recv_buf) {
@@ -1010,13 +1240,9 @@ static void lan_tcp_serv_sock_read(int32_t fd)
         PR_ERR("accept failed %d (errno: %d)", cfd, tal_net_get_errno());
         return;
     }
-    lan_mgr_t *lan = lan_mgr_get();
-    // out of limit
-    if (lan_session_active_num_get() >= lan->cfg->client_num) {
-        // PR_ERR("out of session limit");
-        PR_ERR("out of session limit:0x%x", addr);
-        tal_net_close(cfd);
-        return;
+    // out of limit, lan_sesison_add evicts the least recently active session
+    if (lan_session_active_num_get() >= s_lan_cfg.client_num) {
+        PR_DEBUG("out of session limit:0x%x", addr);
     }
     // set reuse
     tal_net_set_reuse(cfd);
@@ -1108,33 +1334,31 @@ static void lan_udp_serv_sock_read(int32_t fd)
     uint32_t frame_len =
         LPV35_FRAME_HEAD_SIZE + sizeof(lpv35_fixed_head_t) + UNI_NTOHL(fixed_head->length) + LPV35_FRAME_TAIL_SIZE;
     lpv35_frame_object_t frame_out = {0};
-    op_ret = lpv35_frame_parse(app_key2, APP_KEY_LEN, frame_buffer, frame_len, &frame_out);
+    tal_mutex_lock(lan->mutex);
+    op_ret = lpv35_frame_open(&lan->gcm, app_key2, APP_KEY_LEN, frame_buffer, frame_len, &frame_out);
+    tal_mutex_unlock(lan->mutex);
     if (op_ret != OPRT_OK) {
-        PR_ERR("lpv35_frame_parse fail:%d", op_ret);
+        PR_ERR("lpv35_frame_open fail:%d", op_ret);
         return;
     }
     cJSON *root = NULL;
     root = cJSON_Parse((char *)frame_out.data);
     if (NULL == root) {
         PR_ERR("Json err");
-        tal_free(frame_out.data);
         return;
     }
     if ((NULL == cJSON_GetObjectItem(root, "ip")) || (NULL == cJSON_GetObjectItem(root, "from"))) {
         PR_ERR("json data invaild");
         cJSON_Delete(root);
-        tal_free(frame_out.data);
         return;
     }
     addr_json = tal_net_str2addr(cJSON_GetObjectItem(root, "ip")->valuestring);
     // PR_DEBUG("ip:%s", cJSON_GetObjectItem(root, "ip")->valuestring);
     // PR_DEBUG("addr:0x%x, addr_json:0x%x", addr, addr_json);
     cJSON_Delete(root);
-    tal_free(frame_out.data);
 
     int olen = 0;
-    uint8_t *send_buf = NULL;
-    lan_make_udp_packets(&send_buf, &olen);
+    const uint8_t *send_buf = lan_udp_packet_get(lan, &olen);
     if (NULL == send_buf) {
         return;
     }
@@ -1150,12 +1374,53 @@ static void lan_udp_serv_sock_read(int32_t fd)
             op_ret = OPRT_SVC_LAN_SEND_ERR;
         }
     }
-    tal_free(send_buf);
     if (op_ret == OPRT_SVC_LAN_SEND_ERR) {
         PR_ERR("sendto Fail: len:%d ret:%d,errno:%d port:%d", olen, ret, tal_net_get_errno(), SERV_PORT_APP_UDP_BCAST);
     }
 }
 
+/*
+ * Announces the device on SERV_PORT_APP_UDP_BCAST. Starts fast, doubles the
+ * interval after every packet nobody connects on, and stays silent while any
+ * client is connected; once the last one leaves it starts over at
+ * UDP_T_ITRV.
+ */
+static void lan_udp_serv_sock_pre_select(void)
+{
+    lan_mgr_t *lan = lan_mgr_get();
+
+    if (lan == NULL || lan->udp_serv_fd < 0) {
+        return;
+    }
+
+    SYS_TIME_T now = tal_system_get_millisecond();
+    if (lan_session_active_num_get() > 0) {
+        lan->bcast_intv = 0;
+        return;
+    }
+    if (lan->bcast_intv == 0) {
+        lan->bcast_intv = UDP_T_ITRV;
+        lan->bcast_next = now + UDP_T_ITRV * 1000;
+        return;
+    }
+
+    int olen = 0;
+    const uint8_t *send_buf = lan_udp_packet_get(lan, &olen);
+    if (NULL == send_buf || (int32_t)(now - lan->bcast_next) < 0) {
+        return;
+    }
+
+    if (tal_net_send_to(lan->udp_serv_fd, send_buf, olen, TY_IPADDR_BROADCAST, SERV_PORT_APP_UDP_BCAST) < 0) {
+        PR_ERR("bcast fail errno:%d", tal_net_get_errno());
+    }
+    lan->bcast_next = now + lan->bcast_intv * 1000;
+    lan->bcast_intv *= 2;
+    if (lan->bcast_intv > LAN_UDP_BCAST_MAX_INTV) {
+        lan->bcast_intv = LAN_UDP_BCAST_MAX_INTV;
+    }
+    PR_TRACE("udp bcast, next in %ds", lan->bcast_intv);
+}
+
 static void lan_udp_serv_sock_err(int fd)
 {
     if (s_lan_mgr->udp_serv_fd != -1) {
@@ -1177,8 +1442,10 @@ static int lan_udp_create_serv_socket(void)
         return -1;
     }
 
+    tal_net_set_broadcast(s_lan_mgr->udp_serv_fd);
+
     sloop_sock_t udp_sock_info = {.sock = s_lan_mgr->udp_serv_fd,
-                                  .pre_select = NULL,
+                                  .pre_select = lan_udp_serv_sock_pre_select,
                                   .read = lan_udp_serv_sock_read,
                                   .err = lan_udp_serv_sock_err,
                                   .quit = NULL};
@@ -1202,6 +1469,16 @@ static void lan_tcp_serv_sock_pre_select(void)
     }
 
     lan_session_time_check(tal_time_get_posix());
+
+    // push out what slow clients left queued
+    int i;
+    tal_mutex_lock(s_lan_mgr->mutex);
+    for (i = 0; i < s_lan_mgr->cfg->client_num; i++) {
+        if (s_lan_mgr->session[i].active && !s_lan_mgr->session[i].fault && s_lan_mgr->session[i].tx_len) {
+            lan_session_tx_flush(&s_lan_mgr->session[i]);
+        }
+    }
+    tal_mutex_unlock(s_lan_mgr->mutex);
 }
 
 static int lan_tcp_create_serv_socket(lan_mgr_t *lan)
@@ -1257,6 +1534,7 @@ int tuya_lan_init(tuya_iot_client_t *iot_client)
     s_lan_mgr->udp_client_fd = -1;
     s_lan_mgr->udp_serv_fd = -1;
     s_lan_mgr->cfg = &s_lan_cfg;
+    cipher_gcm_ctx_init(&s_lan_mgr->gcm);
     // INIT_LIST_HEAD(&s_lan_mgr->lan_ext_proto);
 
     int op_ret;
@@ -1279,6 +1557,10 @@ int tuya_lan_init(tuya_iot_client_t *iot_client)
         goto __exit;
     }
     memset(s_lan_mgr->session, 0, client_len);
+    s_lan_mgr->fd_hash = tal_calloc(s_lan_mgr->cfg->client_num, sizeof(lan_session_t *));
+    if (NULL == s_lan_mgr->fd_hash) {
+        goto __exit;
+    }
     s_lan_mgr->iot_client = iot_client;
 
     if (lan_tcp_create_serv_socket(s_lan_mgr) < 0) {
@@ -1318,12 +1600,20 @@ int tuya_lan_exit(void)
         tal_free(s_lan_mgr->session);
         s_lan_mgr->session = NULL;
     }
+    if (s_lan_mgr->fd_hash) {
+        tal_free(s_lan_mgr->fd_hash);
+        s_lan_mgr->fd_hash = NULL;
+    }
     if (s_lan_mgr->udp_client_fd >= 0) {
         tal_net_close(s_lan_mgr->udp_client_fd);
         s_lan_mgr->udp_client_fd = -1;
     }
     tal_mutex_release(s_lan_mgr->mutex);
     tal_mutex_release(s_lan_mgr->tcp_mutex);
+    cipher_gcm_ctx_free(&s_lan_mgr->gcm);
+    if (s_lan_mgr->udp_pkt) {
+        tal_free(s_lan_mgr->udp_pkt);
+    }
     tal_free(s_lan_mgr);
     s_lan_mgr = NULL;
 
@@ -1345,9 +1635,6 @@ int tuya_lan_exit(void)
  */
 int tuya_lan_data_report(uint32_t fr_type, uint32_t ret_code, uint8_t *data, uint32_t len)
 {
-    int op_ret = OPRT_OK;
-    int i = 0;
-
     lan_mgr_t *lan = lan_mgr_get();
     if (NULL == lan) {
         return OPRT_COM_ERROR;
@@ -1359,18 +1646,7 @@ int tuya_lan_data_report(uint32_t fr_type, uint32_t ret_code, uint8_t *data, uin
         return OPRT_SVC_LAN_NO_CLIENT_CONNECTED;
     }
 
-    lan_session_t *session = lan_sessions_get();
-
-    for (i = 0; i < lan->cfg->client_num; i++) {
-        if (session[i].active && session[i].fault == false) {
-            op_ret = lan_send(&session[i], 0, fr_type, ret_code, data, len, true);
-            if (OPRT_OK != op_ret) {
-                PR_ERR("tcp_send op_ret:%d", op_ret);
-            }
-        }
-    }
-
-    return OPRT_OK;
+    return lan_broadcast(lan, fr_type, ret_code, data, len, false);
 }
 
 /**
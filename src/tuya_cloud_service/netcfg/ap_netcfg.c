@@ -37,6 +37,7 @@
 #endif
 
 #define AP_TLS_PSK_LEN  (37)
+#define AP_SCAN_MAX_AGE (10 * 1000) // ms, a wifi list this old is answered without scanning
 #define AP_MAX_STA_CONN (1)
 
 #define AP_CFG_EXT_CMD 0x01E
@@ -391,12 +392,21 @@ static int ap_get_wifi_list(char *wifi_list, uint16_t wifi_list_size, uint16_t m
     AP_IF_S *ap_if = NULL;
     uint32_t ap_num = 0;
     BOOL_T first_ap = TRUE;
+    BOOL_T cached = FALSE;
 
     TUYA_CHECK_NULL_RETURN(wifi_list, OPRT_INVALID_PARM);
 
-    ret = tal_wifi_all_ap_scan(&ap_if, &ap_num);
+    ret = tal_wifi_scan_cache_get(AP_SCAN_MAX_AGE, &ap_if, &ap_num, NULL);
+    if (OPRT_NOT_SUPPORTED == ret) {
+        ret = tal_wifi_all_ap_scan(&ap_if, &ap_num);
+    } else if (OPRT_OK == ret) {
+        cached = TRUE;
+    }
     if ((OPRT_OK != ret) || (ap_num == 0)) {
         PR_DEBUG("scan ap null:%d %d", ret, ap_num);
+        if (cached) {
+            tal_free(ap_if);
+        }
 
         sprintf(wifi_list + offset, "{\"wifi_list\":[]}");
         return OPRT_OK;
@@ -420,7 +430,11 @@ static int ap_get_wifi_list(char *wifi_list, uint16_t wifi_list_size, uint16_t m
         first_ap = FALSE;
     }
     offset += sprintf(wifi_list + offset, "]}");
-    tal_wifi_release_ap(ap_if);
+    if (cached) {
+        tal_free(ap_if);
+    } else {
+        tal_wifi_release_ap(ap_if);
+    }
 
     return ret;
 }
@@ -10,19 +10,51 @@
  * password storage and to securely generate encryption keys from user-provided
  * passwords.
  *
- * The implementation leverages the mbedtls cryptographic library to perform the
- * SHA-256 hashing and the PBKDF2 algorithm. It includes a generic pbkdf2_sha256
+ * The hashing goes through tal_hash, so a platform SHA-256 engine is used when
+ * ENABLE_PLATFORM_SHA256 is set. It includes a generic pbkdf2_sha256
  * function for key derivation and a specific ap_pbkdf2_cacl function tailored
- * for use cases within the Tuya IoT SDK.
+ * for use cases within the Tuya IoT SDK, whose result is kept in RAM and KV as
+ * it only depends on the pincode and uuid of the device.
  *
  * @copyright Copyright (c) 2021-2024 Tuya Inc. All Rights Reserved.
  *
  */
 
 #include "tuya_cloud_types.h"
-#include "mbedtls/md.h"
-#include "mbedtls/pkcs5.h"
+#include "tal_hash.h"
+#include "tal_kv.h"
 #include "tal_log.h"
+#include "crc32i.h"
+
+#define AP_PBKDF2_ITERATIONS 1024
+#define AP_PBKDF2_KEY_LEN    37
+
+//! version, crc of pincode and uuid, then the key
+#define AP_PBKDF2_CACHE_KEY     "ap_psk"
+#define AP_PBKDF2_CACHE_VERSION 1
+#define AP_PBKDF2_CACHE_HEAD    (1 + sizeof(uint32_t))
+
+static struct {
+    uint32_t id; // 0 when nothing is cached
+    uint8_t key[AP_PBKDF2_KEY_LEN];
+} s_ap_pbkdf2;
+
+//! output = SHA256(pad || input), pad being the 64 byte ipad or opad block
+static OPERATE_RET __hmac_half(TKL_HASH_HANDLE ctx, const uint8_t pad[64], const uint8_t *input, size_t ilen,
+                               const uint8_t *input2, size_t ilen2, uint8_t output[32])
+{
+    OPERATE_RET rt = OPRT_OK;
+
+    TUYA_CALL_ERR_RETURN(tal_sha256_starts_ret(ctx, 0));
+    TUYA_CALL_ERR_RETURN(tal_sha256_update_ret(ctx, pad, 64));
+    TUYA_CALL_ERR_RETURN(tal_sha256_update_ret(ctx, input, ilen));
+    if (ilen2) {
+        TUYA_CALL_ERR_RETURN(tal_sha256_update_ret(ctx, input2, ilen2));
+    }
+    TUYA_CALL_ERR_RETURN(tal_sha256_finish_ret(ctx, output));
+
+    return rt;
+}
 
 /**
  * @brief Performs the PBKDF2 key derivation function using SHA256 as the
@@ -48,9 +80,15 @@ int pbkdf2_sha256(const char *passphrase, size_t passphrase_len, const char *sal
                   uint32_t key_length, unsigned char *buf, size_t buflen)
 
 {
-    int ret;
+    int ret = 0;
+    TKL_HASH_HANDLE ctx = NULL;
+    uint8_t key[32];
+    uint8_t ipad[64], opad[64];
+    uint8_t u[32], t[32];
+    uint8_t counter[4];
+    const uint8_t *pass = (const uint8_t *)passphrase;
 
-    if (NULL == passphrase || NULL == salt) {
+    if (NULL == passphrase || NULL == salt || iterations < 1) {
         return -1;
     }
 
@@ -58,39 +96,108 @@ int pbkdf2_sha256(const char *passphrase, size_t passphrase_len, const char *sal
         return -1;
     }
 
-#if (MBEDTLS_VERSION_NUMBER <= 0x03010000)
-    mbedtls_md_context_t sha_ctx;
-    const mbedtls_md_info_t *info_sha;
-    mbedtls_md_init(&sha_ctx);
-
-    info_sha = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
-    if (info_sha == NULL) {
-        ret = -1;
-        goto exit;
+    if (OPRT_OK != tal_sha256_create_init(&ctx)) {
+        return -1;
     }
 
-    if ((ret = mbedtls_md_setup(&sha_ctx, info_sha, 1)) != 0) {
-        ret = -1;
-        goto exit;
+    //! the pads are made once, every iteration then hashes two blocks less
+    if (passphrase_len > 64) {
+        if (OPRT_OK != tal_sha256_ret(pass, passphrase_len, key, 0)) {
+            ret = -1;
+            goto exit;
+        }
+        pass = key;
+        passphrase_len = 32;
+    }
+    memset(ipad, 0x36, sizeof(ipad));
+    memset(opad, 0x5C, sizeof(opad));
+    for (size_t i = 0; i < passphrase_len; i++) {
+        ipad[i] ^= pass[i];
+        opad[i] ^= pass[i];
     }
 
-    ret = mbedtls_pkcs5_pbkdf2_hmac(&sha_ctx, (const unsigned char *)passphrase, passphrase_len,
-                                    (const unsigned char *)salt, salt_len, iterations, key_length, buf);
-    if (ret != 0) {
-        ret = -1;
-        goto exit;
+    for (uint32_t block = 1, off = 0; off < key_length; block++) {
+        counter[0] = (uint8_t)(block >> 24);
+        counter[1] = (uint8_t)(block >> 16);
+        counter[2] = (uint8_t)(block >> 8);
+        counter[3] = (uint8_t)block;
+
+        if (OPRT_OK != __hmac_half(ctx, ipad, (const uint8_t *)salt, salt_len, counter, sizeof(counter), u) ||
+            OPRT_OK != __hmac_half(ctx, opad, u, sizeof(u), NULL, 0, u)) {
+            ret = -1;
+            goto exit;
+        }
+        memcpy(t, u, sizeof(t));
+
+        for (int j = 1; j < iterations; j++) {
+            if (OPRT_OK != __hmac_half(ctx, ipad, u, sizeof(u), NULL, 0, u) ||
+                OPRT_OK != __hmac_half(ctx, opad, u, sizeof(u), NULL, 0, u)) {
+                ret = -1;
+                goto exit;
+            }
+            for (size_t k = 0; k < sizeof(t); k++) {
+                t[k] ^= u[k];
+            }
+        }
+
+        uint32_t n = (key_length - off < sizeof(t)) ? key_length - off : sizeof(t);
+        memcpy(buf + off, t, n);
+        off += n;
     }
 
 exit:
-    mbedtls_md_free(&sha_ctx);
-#else
-    ret = mbedtls_pkcs5_pbkdf2_hmac_ext(MBEDTLS_MD_SHA256, (const unsigned char *)passphrase, passphrase_len,
-                                        (const unsigned char *)salt, salt_len, iterations, key_length, buf);
-#endif
+    tal_sha256_free(ctx);
+    memset(key, 0, sizeof(key));
+    memset(ipad, 0, sizeof(ipad));
+    memset(opad, 0, sizeof(opad));
+    memset(u, 0, sizeof(u));
+    memset(t, 0, sizeof(t));
 
     return ret;
 }
 
+static uint32_t __ap_pbkdf2_id(const char *pin, const char *uuid)
+{
+    uint32_t id = hash_crc32i_total(pin, strlen(pin) + 1);
+
+    id ^= hash_crc32i_total(uuid, strlen(uuid));
+    return id ? id : 1;
+}
+
+static BOOL_T __ap_pbkdf2_cache_load(uint32_t id)
+{
+    uint8_t *value = NULL;
+    size_t len = 0;
+    uint32_t value_id = 0;
+    BOOL_T hit = FALSE;
+
+    if (OPRT_OK != tal_kv_get(AP_PBKDF2_CACHE_KEY, &value, &len)) {
+        return FALSE;
+    }
+    if (AP_PBKDF2_CACHE_HEAD + AP_PBKDF2_KEY_LEN == len && AP_PBKDF2_CACHE_VERSION == value[0]) {
+        memcpy(&value_id, value + 1, sizeof(value_id));
+        if (value_id == id) {
+            memcpy(s_ap_pbkdf2.key, value + AP_PBKDF2_CACHE_HEAD, AP_PBKDF2_KEY_LEN);
+            s_ap_pbkdf2.id = id;
+            hit = TRUE;
+        }
+    }
+    tal_kv_free(value);
+
+    return hit;
+}
+
+static void __ap_pbkdf2_cache_save(uint32_t id)
+{
+    uint8_t value[AP_PBKDF2_CACHE_HEAD + AP_PBKDF2_KEY_LEN];
+
+    value[0] = AP_PBKDF2_CACHE_VERSION;
+    memcpy(value + 1, &id, sizeof(id));
+    memcpy(value + AP_PBKDF2_CACHE_HEAD, s_ap_pbkdf2.key, AP_PBKDF2_KEY_LEN);
+    tal_kv_set(AP_PBKDF2_CACHE_KEY, value, sizeof(value));
+    memset(value, 0, sizeof(value));
+}
+
 /**
  * Calculates the AP PBKDF2 (Password-Based Key Derivation Function 2) value.
  *
@@ -105,5 +212,21 @@ exit:
  */
 int ap_pbkdf2_cacl(char *pin, char *uuid, uint8_t *buf, uint8_t buflen)
 {
-    return pbkdf2_sha256(pin, strlen(pin), uuid, strlen(uuid), 1024, 37, (unsigned char *)buf, buflen);
+    if (NULL == pin || NULL == uuid || buflen < AP_PBKDF2_KEY_LEN) {
+        return -1;
+    }
+
+    uint32_t id = __ap_pbkdf2_id(pin, uuid);
+    if (id != s_ap_pbkdf2.id && !__ap_pbkdf2_cache_load(id)) {
+        if (0 != pbkdf2_sha256(pin, strlen(pin), uuid, strlen(uuid), AP_PBKDF2_ITERATIONS, AP_PBKDF2_KEY_LEN,
+                               s_ap_pbkdf2.key, sizeof(s_ap_pbkdf2.key))) {
+            s_ap_pbkdf2.id = 0;
+            return -1;
+        }
+        s_ap_pbkdf2.id = id;
+        __ap_pbkdf2_cache_save(id);
+    }
+    memcpy(buf, s_ap_pbkdf2.key, AP_PBKDF2_KEY_LEN);
+
+    return 0;
 }
@@ -16,6 +16,8 @@
 #include "cJSON.h"
 #include "ap_netcfg.h"
 #include "tuya_lan.h"
+#include "crc32i.h"
+#include "tal_boot_mark.h"
 
 #include "tal_network_register.h"
 
@@ -29,8 +31,14 @@ typedef enum {
     NETCONN_WIFI_MSG_CONNECT,
     NETCONN_WIFI_MSG_DISCONNECT,
     NETCONN_WIFI_MSG_SCAN,
+    NETCONN_WIFI_MSG_FAST_SAVE,
 } netmgr_wifi_msg_type_t;
 
+//! version, crc of ssid and passwd, then the ap info of the platform
+#define NETCONN_WIFI_FAST_KEY     "wifi_fast"
+#define NETCONN_WIFI_FAST_VERSION 1
+#define NETCONN_WIFI_FAST_HEAD    8 // keeps the ap info word aligned
+
 typedef struct {
     int type;
     netmgr_conn_wifi_t *handle;
@@ -60,23 +68,120 @@ netmgr_conn_wifi_t s_netmgr_wifi = {
         },
 };
 
+#if NETCONN_WIFI_FAST_CONNECT
+static uint32_t __netconn_wifi_fast_id(netconn_wifi_info_t *info)
+{
+    char buf[sizeof(info->ssid) + sizeof(info->pswd)];
+    size_t len = snprintf(buf, sizeof(buf), "%s%c%s", info->ssid, '\0', info->pswd);
+
+    return hash_crc32i_total(buf, len);
+}
+
+//! the kept ap info of the wifi to connect, to be freed by tal_kv_free
+static uint8_t *__netconn_wifi_fast_load(netmgr_conn_wifi_t *wifi)
+{
+    uint8_t *buf = NULL;
+    size_t len = 0;
+    uint32_t id = 0;
+    FAST_WF_CONNECTED_AP_INFO_T *info = NULL;
+
+    if (OPRT_OK != tal_kv_get(NETCONN_WIFI_FAST_KEY, &buf, &len)) {
+        return NULL;
+    }
+
+    if (len >= NETCONN_WIFI_FAST_HEAD + sizeof(FAST_WF_CONNECTED_AP_INFO_T) && NETCONN_WIFI_FAST_VERSION == buf[0]) {
+        memcpy(&id, buf + 4, sizeof(id));
+        info = (FAST_WF_CONNECTED_AP_INFO_T *)(buf + NETCONN_WIFI_FAST_HEAD);
+        if (id == __netconn_wifi_fast_id(&wifi->conn.wifi_conn_info) &&
+            len == NETCONN_WIFI_FAST_HEAD + sizeof(FAST_WF_CONNECTED_AP_INFO_T) + info->len) {
+            wifi->conn.fast_crc = hash_crc32i_total(buf, len);
+            return buf;
+        }
+    }
+    tal_kv_free(buf);
+
+    return NULL;
+}
+
+static void __netconn_wifi_fast_save(netmgr_conn_wifi_t *wifi)
+{
+    FAST_WF_CONNECTED_AP_INFO_T *info = NULL;
+
+    if (OPRT_OK != tal_wifi_get_connected_ap_info(&info) || NULL == info) {
+        return;
+    }
+
+    size_t len = NETCONN_WIFI_FAST_HEAD + sizeof(FAST_WF_CONNECTED_AP_INFO_T) + info->len;
+    uint8_t *buf = (info->len <= NETCONN_WIFI_FAST_INFO_MAX) ? tal_malloc(len) : NULL;
+    if (buf) {
+        uint32_t id = __netconn_wifi_fast_id(&wifi->conn.wifi_conn_info);
+        memset(buf, 0, NETCONN_WIFI_FAST_HEAD);
+        buf[0] = NETCONN_WIFI_FAST_VERSION;
+        memcpy(buf + 4, &id, sizeof(id));
+        memcpy(buf + NETCONN_WIFI_FAST_HEAD, info, len - NETCONN_WIFI_FAST_HEAD);
+
+        //! the ap info stays the same over most reconnects, spare the flash
+        uint32_t crc = hash_crc32i_total(buf, len);
+        if (crc != wifi->conn.fast_crc && OPRT_OK == tal_kv_set(NETCONN_WIFI_FAST_KEY, buf, len)) {
+            PR_DEBUG("wifi fast connect info saved, len %d", info->len);
+            wifi->conn.fast_crc = crc;
+        }
+        tal_free(buf);
+    }
+    tal_free(info);
+}
+#endif
+
+static void __netconn_wifi_fast_drop(netmgr_conn_wifi_t *wifi)
+{
+    wifi->conn.fast = FALSE;
+    if (wifi->conn.fast_crc) {
+        tal_kv_del(NETCONN_WIFI_FAST_KEY);
+        wifi->conn.fast_crc = 0;
+    }
+}
+
 static void __netconn_wifi_connect_process(void *msg)
 {
     netmgr_wifi_msg_t *wifi_msg = (netmgr_wifi_msg_t *)msg;
     netmgr_conn_wifi_t *wifi = wifi_msg->handle;
 
     switch (wifi_msg->type) {
-    case NETCONN_WIFI_MSG_CONNECT:
+    case NETCONN_WIFI_MSG_CONNECT: {
+        uint8_t *fast = NULL;
         PR_DEBUG("wifi connnet %s", wifi->conn.wifi_conn_info.ssid);
         tal_wifi_station_disconnect();
-        tal_sw_timer_start(wifi->conn.timer, WIFI_CONN_TIMEOUT_MAX * 1000, TAL_TIMER_ONCE);
+#if NETCONN_WIFI_FAST_CONNECT
+        fast = __netconn_wifi_fast_load(wifi);
+#endif
+        wifi->conn.fast = (NULL != fast);
+        tal_sw_timer_start(wifi->conn.timer, (fast ? NETCONN_WIFI_FAST_TIMEOUT : WIFI_CONN_TIMEOUT_MAX) * 1000,
+                           TAL_TIMER_ONCE);
         wifi->conn.stat = NETCONN_WIFI_CONN_CHECK;
         tal_wifi_set_work_mode(WWM_STATION);
-        tal_wifi_station_connect((int8_t *)wifi->conn.wifi_conn_info.ssid, (int8_t *)wifi->conn.wifi_conn_info.pswd);
+        tal_boot_mark(fast ? "wifi fast connect" : "wifi connect");
+        if (fast) {
+            //! no scan, the ap of the last connection is joined on its channel
+            PR_DEBUG("wifi fast connect");
+            tal_fast_station_connect((FAST_WF_CONNECTED_AP_INFO_T *)(fast + NETCONN_WIFI_FAST_HEAD));
+            tal_kv_free(fast);
+        } else {
+            tal_wifi_station_connect((int8_t *)wifi->conn.wifi_conn_info.ssid,
+                                     (int8_t *)wifi->conn.wifi_conn_info.pswd);
+        }
+    } break;
+
+#if NETCONN_WIFI_FAST_CONNECT
+    case NETCONN_WIFI_MSG_FAST_SAVE:
+        if (NETCONN_WIFI_CONN_LINKUP == wifi->conn.stat) {
+            __netconn_wifi_fast_save(wifi);
+        }
         break;
+#endif
 
     case NETCONN_WIFI_MSG_DISCONNECT:
         tal_sw_timer_stop(wifi->conn.timer);
+        wifi->conn.fast = FALSE;
         wifi->conn.count = 0;
         wifi->conn.stat = NETCONN_WIFI_CONN_STOP;
         tal_wifi_station_disconnect();
@@ -90,6 +195,17 @@ static void __netconn_wifi_connect_process(void *msg)
     tal_free(wifi_msg);
 }
 
+static OPERATE_RET __netconn_wifi_msg_send(netmgr_conn_wifi_t *wifi, int type)
+{
+    netmgr_wifi_msg_t *wifi_msg = tal_malloc(sizeof(netmgr_wifi_msg_t));
+    if (NULL == wifi_msg) {
+        return OPRT_MALLOC_FAILED;
+    }
+    wifi_msg->type = type;
+    wifi_msg->handle = wifi;
+    return tal_workq_schedule(WORKQ_SYSTEM, __netconn_wifi_connect_process, wifi_msg);
+}
+
 OPERATE_RET __netconn_wifi_connect(void)
 {
     netmgr_conn_wifi_t *wifi = &s_netmgr_wifi;
@@ -98,13 +214,7 @@ OPERATE_RET __netconn_wifi_connect(void)
         return OPRT_OK;
     }
 
-    netmgr_wifi_msg_t *wifi_msg = tal_malloc(sizeof(netmgr_wifi_msg_t));
-    if (NULL == wifi_msg) {
-        return OPRT_MALLOC_FAILED;
-    }
-    wifi_msg->type = NETCONN_WIFI_MSG_CONNECT;
-    wifi_msg->handle = wifi;
-    return tal_workq_schedule(WORKQ_SYSTEM, __netconn_wifi_connect_process, wifi_msg);
+    return __netconn_wifi_msg_send(wifi, NETCONN_WIFI_MSG_CONNECT);
 }
 
 OPERATE_RET __netconn_wifi_disconnect(void)
@@ -115,15 +225,7 @@ OPERATE_RET __netconn_wifi_disconnect(void)
         return OPRT_OK;
     }
 
-    netmgr_wifi_msg_t *wifi_msg = tal_malloc(sizeof(netmgr_wifi_msg_t));
-    if (NULL == wifi_msg) {
-        return OPRT_MALLOC_FAILED;
-    }
-
-    wifi_msg->type = NETCONN_WIFI_MSG_DISCONNECT;
-    wifi_msg->handle = wifi;
-
-    return tal_workq_schedule(WORKQ_SYSTEM, __netconn_wifi_connect_process, wifi_msg);
+    return __netconn_wifi_msg_send(wifi, NETCONN_WIFI_MSG_DISCONNECT);
 }
 
 static void __netconn_wifi_event(WF_EVENT_E event, void *arg)
@@ -135,11 +237,20 @@ static void __netconn_wifi_event(WF_EVENT_E event, void *arg)
     if (event == WFE_CONNECTED) {
         PR_DEBUG("wifi connected in stat %d", wifi->conn.stat);
         wifi->conn.count = 0;
+        wifi->conn.fast = FALSE;
         wifi->conn.stat = NETCONN_WIFI_CONN_LINKUP;
         wifi->base.status = NETMGR_LINK_UP;
+        tal_boot_mark("wifi connected");
+#if NETCONN_WIFI_FAST_CONNECT
+        __netconn_wifi_msg_send(wifi, NETCONN_WIFI_MSG_FAST_SAVE);
+#endif
     } else {
         //! faild or disconnect auto connect
-        if (NETCONN_WIFI_CONN_CHECK == wifi->conn.stat || NETCONN_WIFI_CONN_WAIT == wifi->conn.stat) {
+        if (wifi->conn.fast && NETCONN_WIFI_CONN_CHECK == wifi->conn.stat) {
+            PR_DEBUG("wifi fast connect failed, scan");
+            __netconn_wifi_fast_drop(wifi);
+            __netconn_wifi_connect();
+        } else if (NETCONN_WIFI_CONN_CHECK == wifi->conn.stat || NETCONN_WIFI_CONN_WAIT == wifi->conn.stat) {
             PR_DEBUG("wifi connect wait %d-%d", wifi->conn.count, wifi->conn.table[wifi->conn.count]);
             tal_sw_timer_start(wifi->conn.timer, wifi->conn.table[wifi->conn.count] * 1000, TAL_TIMER_ONCE);
             if (wifi->conn.count < wifi->conn.table_size - 1) {
@@ -172,6 +283,10 @@ static void __netconn_wifi_conn_timer(TIMER_ID timer_id, void *arg)
         wifi->conn.stat = NETCONN_WIFI_CONN_CHECK;
     } else if (NETCONN_WIFI_CONN_STOP == wifi->conn.stat) {
         wifi->conn.stat = NETCONN_WIFI_CONN_REDAY;
+    } else if (wifi->conn.fast && NETCONN_WIFI_CONN_CHECK == wifi->conn.stat) {
+        PR_DEBUG("wifi fast connect timeout, scan");
+        __netconn_wifi_fast_drop(wifi);
+        __netconn_wifi_connect();
     } else if (NETCONN_WIFI_CONN_CHECK == wifi->conn.stat) {
         PR_DEBUG("wifi connect wait %d-%d", wifi->conn.count, wifi->conn.table[wifi->conn.count]);
         tal_sw_timer_start(wifi->conn.timer, wifi->conn.table[wifi->conn.count] * 1000, TAL_TIMER_ONCE);
@@ -243,14 +358,17 @@ OPERATE_RET __netconn_wifi_netcfg_finish(int type, netcfg_info_t *info)
 {
     netmgr_conn_wifi_t *netmgr_wifi = &s_netmgr_wifi;
 
-    // save wifi info
     memcpy(netmgr_wifi->conn.wifi_conn_info.ssid, info->ssid, info->s_len);
     memcpy(netmgr_wifi->conn.wifi_conn_info.pswd, info->passwd, info->p_len);
-    __netconn_wifi_info_set(&netmgr_wifi->conn.wifi_conn_info);
     PR_DEBUG("netcfg finished,  ssid %s, passwd %s, token %s", netmgr_wifi->conn.wifi_conn_info.ssid,
              netmgr_wifi->conn.wifi_conn_info.pswd, info->token);
-    // stop all netcfg
+    // stop all netcfg, the softap gives the radio back to the station
     netcfg_stop(NETCFG_STOP_ALL_CFG_MODULE);
+    //! associate right away, saving the wifi info and the activation go on meanwhile
+    __netconn_wifi_connect();
+
+    // save wifi info
+    __netconn_wifi_info_set(&netmgr_wifi->conn.wifi_conn_info);
 
     tuya_binding_info_t binding;
     memset(&binding, 0, sizeof(tuya_binding_info_t));
@@ -260,8 +378,6 @@ OPERATE_RET __netconn_wifi_netcfg_finish(int type, netcfg_info_t *info)
 
     tal_event_unsubscribe(EVENT_LINK_ACTIVATE, "wifi", __wifi_link_activete_cb);
     tal_event_publish(EVENT_LINK_ACTIVATE, &binding);
-    // notify netcfg finished and save
-    __netconn_wifi_connect();
 
     return OPRT_OK;
 }
@@ -278,20 +394,26 @@ int __netconn_activate_token_get(tuya_iot_config_t *config)
         tal_event_subscribe(EVENT_LINK_ACTIVATE, "wifi", __wifi_link_activete_cb, SUBSCRIBE_TYPE_ONETIME));
 
     // init netcfg
+    int types = 0;
     netcfg_init();
     TAL_NETWORK_CARD_TYPE_E active_type = tal_network_card_get_active_type();
     if (netmgr_wifi->netcfg.type & TUYA_NETMGR_NETCFG_AP && active_type != TAL_NET_TYPE_AT_MODEM) {
         ap_netcfg_init(&netmgr_wifi->netcfg);
-        netcfg_start(NETCFG_TUYA_WIFI_AP, __netconn_wifi_netcfg_finish, NULL);
+        types |= NETCFG_TUYA_WIFI_AP;
     }
 
 #ifdef ENABLE_BLUETOOTH
     if (netmgr_wifi->netcfg.type & TUYA_NETMGR_NETCFG_BLE) {
         ble_netcfg_init(&netmgr_wifi->netcfg);
-        netcfg_start(NETCFG_TUYA_BLE, __netconn_wifi_netcfg_finish, NULL);
+        types |= NETCFG_TUYA_BLE;
     }
 #endif
 
+    //! all methods listen at once, the first one with credentials stops the others
+    if (types) {
+        netcfg_start_multi(types, __netconn_wifi_netcfg_finish, NULL);
+    }
+
     return rt;
 }
 
@@ -308,6 +430,8 @@ static OPERATE_RET __wifi_reset_event_cb(void *data)
     rt = tal_wifi_station_disconnect();
     if (client->is_activated) {
         tal_kv_del("netinfo");
+        tal_kv_del(NETCONN_WIFI_FAST_KEY);
+        netmgr_wifi->conn.fast_crc = 0;
         memset(&netmgr_wifi->conn.wifi_conn_info, 0, sizeof(netmgr_wifi->conn.wifi_conn_info));
     } else {
         // stop all netcfg
@@ -418,6 +542,8 @@ OPERATE_RET netconn_wifi_set(netmgr_conn_config_type_e cmd, void *param)
 
     case NETCONN_CMD_RESET:
         tal_kv_del("netinfo");
+        tal_kv_del(NETCONN_WIFI_FAST_KEY);
+        netmgr_wifi->conn.fast_crc = 0;
         netmgr_wifi->conn.stat = NETCONN_WIFI_CONN_STOP;
         memset(&netmgr_wifi->conn.wifi_conn_info, 0, sizeof(netmgr_wifi->conn.wifi_conn_info));
         tal_wifi_station_disconnect();
@@ -71,6 +71,25 @@ typedef enum {
  */
 #define NETCONN_WIFI_CONN_TABLE 6
 #define WIFI_CONN_TIMEOUT_MAX   20
+
+/**
+ * @brief fast connect with the ap info (bssid, channel, pmk) of the last
+ * connection, kept in KV, 0 disables it
+ *
+ */
+#ifndef NETCONN_WIFI_FAST_CONNECT
+#define NETCONN_WIFI_FAST_CONNECT 1
+#endif
+
+// seconds to wait for a fast connect before scanning
+#ifndef NETCONN_WIFI_FAST_TIMEOUT
+#define NETCONN_WIFI_FAST_TIMEOUT 5
+#endif
+
+// larger ap info is not kept
+#ifndef NETCONN_WIFI_FAST_INFO_MAX
+#define NETCONN_WIFI_FAST_INFO_MAX 512
+#endif
 typedef struct {
     char ssid[WIFI_SSID_LEN + 1];   // wifi ap ssid
     char pswd[WIFI_PASSWD_LEN + 1]; // wifi passwd
@@ -86,6 +105,8 @@ typedef struct {
     uint32_t table_size;
     uint32_t table[NETCONN_WIFI_CONN_TABLE];
     TIMER_ID timer;
+    BOOL_T fast;                        // connecting with the kept ap info
+    uint32_t fast_crc;                  // crc of the ap info in KV, 0 for none
     netconn_wifi_info_t wifi_conn_info; // the connected wifi info
 } netconn_wifi_conn_t;
 
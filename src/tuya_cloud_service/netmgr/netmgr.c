@@ -32,6 +32,7 @@
 #include "tuya_cloud_com_defs.h"
 #include "tuya_error_code.h"
 #include "tuya_lan.h"
+#include "tuya_endpoint.h"
 
 #ifdef ENABLE_WIFI
 #include "netconn_wifi.h"
@@ -52,6 +53,38 @@ extern netmgr_conn_cellular_t s_netmgr_cellular;
 #include "ble_mgr.h"
 #endif
 
+/*
+ * With more than one connection, a thread connects to the MQTT broker over
+ * every link that is up each NETMGR_PROBE_INTERVAL_MS. A link failing
+ * NETMGR_PROBE_FAIL_MAX probes in a row is not used while another one passes,
+ * so a link that is up without reaching the cloud is left before MQTT fails
+ * on it. A link of higher priority that comes back has to stay up for
+ * NETMGR_FAILBACK_HOLD_MS before it takes over from a working one.
+ *
+ * Links are probed per network card, Wi-Fi and wired share the lwIP card and
+ * its routing, so only links on different cards (e.g. lwIP and a cellular
+ * modem) are told apart by the probes.
+ */
+#ifndef NETMGR_PROBE_INTERVAL_MS
+#define NETMGR_PROBE_INTERVAL_MS (10 * 1000) // 0 disables the probes and the hold
+#endif
+
+#ifndef NETMGR_PROBE_TIMEOUT_MS
+#define NETMGR_PROBE_TIMEOUT_MS (3 * 1000)
+#endif
+
+#ifndef NETMGR_PROBE_FAIL_MAX
+#define NETMGR_PROBE_FAIL_MAX 3
+#endif
+
+#ifndef NETMGR_FAILBACK_HOLD_MS
+#define NETMGR_FAILBACK_HOLD_MS (30 * 1000)
+#endif
+
+#ifndef NETMGR_PROBE_STACK_SIZE
+#define NETMGR_PROBE_STACK_SIZE (3 * 1024)
+#endif
+
 typedef struct {
     MUTEX_HANDLE lock; // mutex
     BOOL_T inited;
@@ -61,12 +94,30 @@ typedef struct {
     netmgr_status_e status; // the network status
 
     netmgr_conn_base_t *conn; // connections
+    THREAD_HANDLE probe_thrd;
 } netmgr_t;
 
 static netmgr_t s_netmgr = {0};
 
 static TIMER_ID sg_lan_init_timer = NULL;
 
+static BOOL_T __conn_is_up(netmgr_conn_base_t *conn)
+{
+    netmgr_status_e netmgr_status = NETMGR_LINK_DOWN;
+
+    conn->get(NETCONN_CMD_STATUS, &netmgr_status);
+    if (netmgr_status != NETMGR_LINK_UP) {
+        conn->good_since = 0;
+        conn->probe_fail = 0;
+        conn->rtt_ms = 0;
+        return FALSE;
+    }
+    if (0 == conn->good_since && conn->probe_fail < NETMGR_PROBE_FAIL_MAX) {
+        conn->good_since = tal_system_get_millisecond();
+    }
+    return TRUE;
+}
+
 /**
  * @brief get active connection status and
  *
@@ -74,31 +125,48 @@ static TIMER_ID sg_lan_init_timer = NULL;
  */
 static netmgr_type_e __get_active_conn()
 {
-    netmgr_type_e active_type = NETCONN_AUTO;
     netmgr_conn_base_t *cur_conn = s_netmgr.conn;
+    netmgr_conn_base_t *fallback = NULL;
+    BOOL_T active_ok = FALSE;
 
     if (NULL == cur_conn) {
         PR_ERR("no connection registered");
         return NETCONN_AUTO;
     }
 
-    netmgr_status_e netmgr_status = NETMGR_LINK_DOWN;
-
-    active_type = cur_conn->type;
+    // the active connection is kept against one that came back just now
+    for (; cur_conn; cur_conn = cur_conn->next) {
+        if (cur_conn->type == s_netmgr.active) {
+            active_ok = __conn_is_up(cur_conn) && cur_conn->probe_fail < NETMGR_PROBE_FAIL_MAX;
+        }
+    }
 
-    while (cur_conn) {
-        netmgr_status = NETMGR_LINK_DOWN;
-        cur_conn->get(NETCONN_CMD_STATUS, &netmgr_status);
-        if (netmgr_status == NETMGR_LINK_UP) {
-            // return the first connection which is up
-            PR_DEBUG("netmgr active connection [%s]", NETMGR_TYPE_TO_STR(cur_conn->type));
-            active_type = cur_conn->type;
-            break;
+#if NETMGR_PROBE_INTERVAL_MS > 0
+    SYS_TIME_T now = tal_system_get_millisecond();
+#endif
+    for (cur_conn = s_netmgr.conn; cur_conn; cur_conn = cur_conn->next) {
+        if (!__conn_is_up(cur_conn)) {
+            continue;
         }
-        cur_conn = cur_conn->next;
+        if (NULL == fallback) {
+            fallback = cur_conn;
+        }
+        if (cur_conn->probe_fail >= NETMGR_PROBE_FAIL_MAX) {
+            continue;
+        }
+#if NETMGR_PROBE_INTERVAL_MS > 0
+        if (s_netmgr.probe_thrd && active_ok && cur_conn->type != s_netmgr.active &&
+            now - cur_conn->good_since < NETMGR_FAILBACK_HOLD_MS) {
+            continue;
+        }
+#endif
+        // the first connection which is up and works
+        PR_DEBUG("netmgr active connection [%s]", NETMGR_TYPE_TO_STR(cur_conn->type));
+        return cur_conn->type;
     }
 
-    return active_type;
+    // no connection works, keep to the first one up
+    return fallback ? fallback->type : s_netmgr.conn->type;
 }
 
 void __tuya_lan_init_tm_cb(TIMER_ID timer_id, void *arg)
@@ -179,6 +247,48 @@ static OPERATE_RET __get_netmgr_status(netmgr_type_e type, netmgr_status_e *stat
     return rt;
 }
 
+/**
+ * @brief selects the connection to use again and publishes the changes
+ */
+static void __netmgr_update(void)
+{
+    tal_mutex_lock(s_netmgr.lock);
+
+    netmgr_status_e active_status = NETMGR_LINK_DOWN;
+    netmgr_type_e active_conn = __get_active_conn();
+    __get_netmgr_status(active_conn, &active_status);
+
+    // both changed
+    if (active_status != s_netmgr.status && active_conn != s_netmgr.active) {
+        PR_DEBUG("netmgr conn type changed [%s] --> [%s], status changed %d --> %d",
+                 NETMGR_TYPE_TO_STR(s_netmgr.active), NETMGR_TYPE_TO_STR(active_conn), s_netmgr.status,
+                 active_status);
+        s_netmgr.status = active_status;
+        s_netmgr.active = active_conn;
+        netmgr_conn_base_t *p_conn = __get_conn_by_type(active_conn);
+        tal_network_card_set_active(p_conn->card_type);
+        tal_event_publish(EVENT_LINK_TYPE_CHG, (void *)s_netmgr.active);
+        tal_event_publish(EVENT_LINK_STATUS_CHG, (void *)s_netmgr.status);
+    } else if (active_status != s_netmgr.status) {
+        // active_status changed
+        PR_DEBUG("netmgr conn status changed [%s] --> [%s]", NETMGR_STATUS_TO_STR(s_netmgr.status),
+                 NETMGR_STATUS_TO_STR(active_status));
+        s_netmgr.status = active_status;
+        tal_event_publish(EVENT_LINK_STATUS_CHG, (void *)s_netmgr.status);
+    } else if (active_conn != s_netmgr.active) {
+        // active_conn changed
+        PR_DEBUG("netmgr conn type changed [%s] --> [%s]", NETMGR_TYPE_TO_STR(s_netmgr.active),
+                 NETMGR_TYPE_TO_STR(active_conn));
+        s_netmgr.active = active_conn;
+        netmgr_conn_base_t *p_conn = __get_conn_by_type(active_conn);
+        tal_network_card_set_active(p_conn->card_type);
+        tal_event_publish(EVENT_LINK_TYPE_CHG, (void *)s_netmgr.active);
+    }
+    tal_mutex_unlock(s_netmgr.lock);
+
+    return;
+}
+
 /**
  * @brief connection event callback, called when connection event happed
  *
@@ -190,41 +300,100 @@ static void __netmgr_event_cb(netmgr_type_e type, netmgr_status_e status)
     (void)status;
 
     if (s_netmgr.type & type) {
-        netmgr_status_e active_status = NETMGR_LINK_DOWN;
-        netmgr_type_e active_conn = __get_active_conn();
-        __get_netmgr_status(active_conn, &active_status);
-
-        // both changed
-        if (active_status != s_netmgr.status && active_conn != s_netmgr.active) {
-            PR_DEBUG("netmgr conn type changed [%s] --> [%s], status changed %d --> %d",
-                     NETMGR_TYPE_TO_STR(s_netmgr.active), NETMGR_TYPE_TO_STR(active_conn), s_netmgr.status,
-                     active_status);
-            s_netmgr.status = active_status;
-            s_netmgr.active = active_conn;
-            netmgr_conn_base_t *p_conn = __get_conn_by_type(active_conn);
-            tal_network_card_set_active(p_conn->card_type);
-            tal_event_publish(EVENT_LINK_TYPE_CHG, (void *)s_netmgr.active);
-            tal_event_publish(EVENT_LINK_STATUS_CHG, (void *)s_netmgr.status);
-        } else if (active_status != s_netmgr.status) {
-            // active_status changed
-            PR_DEBUG("netmgr conn status changed [%s] --> [%s]", NETMGR_STATUS_TO_STR(s_netmgr.status),
-                     NETMGR_STATUS_TO_STR(active_status));
-            s_netmgr.status = active_status;
-            tal_event_publish(EVENT_LINK_STATUS_CHG, (void *)s_netmgr.status);
-        } else if (active_conn != s_netmgr.active) {
-            // active_conn changed
-            PR_DEBUG("netmgr conn type changed [%s] --> [%s]", NETMGR_TYPE_TO_STR(s_netmgr.active),
-                     NETMGR_TYPE_TO_STR(active_conn));
-            s_netmgr.active = active_conn;
-            netmgr_conn_base_t *p_conn = __get_conn_by_type(active_conn);
-            tal_network_card_set_active(p_conn->card_type);
-            tal_event_publish(EVENT_LINK_TYPE_CHG, (void *)s_netmgr.active);
-        }
+        __netmgr_update();
     }
 
     return;
 }
 
+#if NETMGR_PROBE_INTERVAL_MS > 0
+/**
+ * @brief connects to the broker over one network card
+ */
+static OPERATE_RET __netmgr_probe_card(TAL_NETWORK_CARD_TYPE_E card_type, const char *host, uint16_t port,
+                                       uint32_t *rtt_ms)
+{
+    OPERATE_RET rt = OPRT_OK;
+    TUYA_IP_ADDR_T addr;
+    TUYA_FD_SET_T wfds, efds;
+    TAL_NETWORK_OPS_T *ops = tal_network_get_ops(card_type);
+
+    if (NULL == ops || NULL == ops->gethostbyname || NULL == ops->socket_create || NULL == ops->select) {
+        return OPRT_NOT_SUPPORTED;
+    }
+    TUYA_CALL_ERR_RETURN(ops->gethostbyname(host, &addr));
+
+    int fd = ops->socket_create(PROTOCOL_TCP);
+    if (fd < 0) {
+        return OPRT_SOCK_ERR;
+    }
+    ops->set_block(fd, FALSE);
+
+    SYS_TIME_T start = tal_system_get_millisecond();
+    ops->connect(fd, addr, port);
+    ops->fd_zero(&wfds);
+    ops->fd_set(fd, &wfds);
+    ops->fd_zero(&efds);
+    ops->fd_set(fd, &efds);
+    if (ops->select(fd + 1, NULL, &wfds, &efds, NETMGR_PROBE_TIMEOUT_MS) > 0 && ops->fd_isset(fd, &wfds) &&
+        !ops->fd_isset(fd, &efds)) {
+        *rtt_ms = (uint32_t)(tal_system_get_millisecond() - start);
+    } else {
+        rt = OPRT_TIMEOUT;
+    }
+    ops->close(fd);
+
+    return rt;
+}
+
+static void __netmgr_probe_task(void *arg)
+{
+    OPERATE_RET rt[TAL_NET_TYPE_MAX];
+    uint32_t rtt[TAL_NET_TYPE_MAX];
+    netmgr_conn_base_t *conn = NULL;
+
+    for (;;) {
+        tal_system_sleep(NETMGR_PROBE_INTERVAL_MS);
+
+        const tuya_endpoint_t *endpoint = tuya_endpoint_get();
+        if (endpoint && endpoint->mqtt.host[0]) {
+            for (int i = 0; i < TAL_NET_TYPE_MAX; i++) {
+                rt[i] = OPRT_RESOURCE_NOT_READY; // not probed yet
+            }
+            for (conn = s_netmgr.conn; conn; conn = conn->next) {
+                if (conn->card_type >= TAL_NET_TYPE_MAX || !__conn_is_up(conn)) {
+                    continue;
+                }
+                if (OPRT_RESOURCE_NOT_READY == rt[conn->card_type]) {
+                    rt[conn->card_type] =
+                        __netmgr_probe_card(conn->card_type, endpoint->mqtt.host, endpoint->mqtt.port,
+                                            &rtt[conn->card_type]);
+                }
+                if (OPRT_NOT_SUPPORTED == rt[conn->card_type]) {
+                    continue;
+                }
+                tal_mutex_lock(s_netmgr.lock);
+                if (OPRT_OK == rt[conn->card_type]) {
+                    conn->rtt_ms = conn->rtt_ms ? (conn->rtt_ms * 3 + rtt[conn->card_type]) / 4 : rtt[conn->card_type];
+                    if (conn->probe_fail >= NETMGR_PROBE_FAIL_MAX) {
+                        PR_NOTICE("netmgr [%s] reaches the broker again", NETMGR_TYPE_TO_STR(conn->type));
+                        conn->good_since = tal_system_get_millisecond();
+                    }
+                    conn->probe_fail = 0;
+                } else if (conn->probe_fail < NETMGR_PROBE_FAIL_MAX && ++conn->probe_fail >= NETMGR_PROBE_FAIL_MAX) {
+                    PR_WARN("netmgr [%s] is up but does not reach the broker", NETMGR_TYPE_TO_STR(conn->type));
+                    conn->good_since = 0;
+                }
+                tal_mutex_unlock(s_netmgr.lock);
+            }
+        }
+
+        // also ends the failback hold
+        __netmgr_update();
+    }
+}
+#endif
+
 OPERATE_RET __netmgr_conn_register(netmgr_type_e type, netmgr_conn_base_t *conn)
 {
     OPERATE_RET rt = OPRT_OK;
@@ -340,6 +509,17 @@ OPERATE_RET netmgr_init(netmgr_type_e type)
 
     s_netmgr.inited = TRUE;
 
+#if NETMGR_PROBE_INTERVAL_MS > 0
+    if (s_netmgr.conn->next) {
+        THREAD_CFG_T thrd_param = {0};
+        thrd_param.priority = THREAD_PRIO_3;
+        thrd_param.stackDepth = NETMGR_PROBE_STACK_SIZE;
+        thrd_param.thrdname = "netmgr_probe";
+        TUYA_CALL_ERR_LOG(tal_thread_create_and_start(&s_netmgr.probe_thrd, NULL, NULL, __netmgr_probe_task, NULL,
+                                                      &thrd_param));
+    }
+#endif
+
     // Cellular not support LAN
 #if !defined(ENABLE_CELLULAR) || (ENABLE_CELLULAR == 0)
     tal_sw_timer_create(__tuya_lan_init_tm_cb, NULL, &sg_lan_init_timer);
@@ -437,6 +617,16 @@ OPERATE_RET netmgr_conn_get(netmgr_type_e type, netmgr_conn_config_type_e cmd, v
     return rt;
 }
 
+/**
+ * @brief get the connection used now
+ *
+ * @return the active connection type, 0 before netmgr_init
+ */
+netmgr_type_e netmgr_active_get(void)
+{
+    return s_netmgr.active;
+}
+
 /**
  * @brief Executes a network manager command.
  *
@@ -466,13 +656,22 @@ void netmgr_cmd(int argc, char *argv[])
         if (s_netmgr.type & NETCONN_WIFI) {
             p_conn = __get_conn_by_type(NETCONN_WIFI);
             if (p_conn) {
-                PR_NOTICE("type wifi pri %d status %s", p_conn->pri, NETMGR_STATUS_TO_STR(p_conn->status));
+                PR_NOTICE("type wifi pri %d status %s rtt %dms probe fail %d", p_conn->pri,
+                          NETMGR_STATUS_TO_STR(p_conn->status), p_conn->rtt_ms, p_conn->probe_fail);
             }
         }
         if (s_netmgr.type & NETCONN_WIRED) {
             p_conn = __get_conn_by_type(NETCONN_WIRED);
             if (p_conn) {
-                PR_NOTICE("type wire pri %d status %s", p_conn->pri, NETMGR_STATUS_TO_STR(p_conn->status));
+                PR_NOTICE("type wire pri %d status %s rtt %dms probe fail %d", p_conn->pri,
+                          NETMGR_STATUS_TO_STR(p_conn->status), p_conn->rtt_ms, p_conn->probe_fail);
+            }
+        }
+        if (s_netmgr.type & NETCONN_CELLULAR) {
+            p_conn = __get_conn_by_type(NETCONN_CELLULAR);
+            if (p_conn) {
+                PR_NOTICE("type cellular pri %d status %s rtt %dms probe fail %d", p_conn->pri,
+                          NETMGR_STATUS_TO_STR(p_conn->status), p_conn->rtt_ms, p_conn->probe_fail);
             }
         }
     } else {
@@ -496,9 +695,14 @@ void netmgr_cmd(int argc, char *argv[])
             } else if (0 == strcmp(argv[2], "down")) {
                 netmgr_conn_set(NETCONN_WIFI, NETCONN_CMD_CLOSE, NULL);
             } else if (0 == strcmp(argv[2], "scan")) {
-                AP_IF_S *aplist;
-                uint32_t num;
-                tal_wifi_all_ap_scan(&aplist, &num);
+                AP_IF_S *aplist = NULL;
+                uint32_t num = 0;
+                if (OPRT_OK == tal_wifi_all_ap_scan(&aplist, &num) && aplist) {
+                    for (uint32_t i = 0; i < num; i++) {
+                        PR_INFO("ch %2d rssi %4d %s", aplist[i].channel, aplist[i].rssi, aplist[i].ssid);
+                    }
+                    tal_wifi_release_ap(aplist);
+                }
             } else {
                 PR_INFO("usage: netmgr [wifi] [down/up/scan]");
             }
@@ -92,6 +92,11 @@ typedef struct netmgr_conn_base {
     OPERATE_RET (*get)(netmgr_conn_config_type_e cmd, void *param);
     void (*event_cb)(netmgr_type_e type, netmgr_status_e event);
 
+    // link quality, kept by netmgr
+    uint32_t rtt_ms;       // smoothed connect time to the MQTT broker
+    uint8_t probe_fail;    // probes failed in a row
+    SYS_TIME_T good_since; // when the link came up or passed a probe again, 0 while down
+
     struct netmgr_conn_base *next; // for linked list
 } netmgr_conn_base_t;
 
@@ -123,6 +128,13 @@ OPERATE_RET netmgr_conn_get(netmgr_type_e type, netmgr_conn_config_type_e cmd, v
  */
 OPERATE_RET netmgr_conn_set(netmgr_type_e type, netmgr_conn_config_type_e cmd, void *param);
 
+/**
+ * @brief get the connection used now
+ *
+ * @return the active connection type, 0 before netmgr_init
+ */
+netmgr_type_e netmgr_active_get(void);
+
 #ifdef __cplusplus
 }
 #endif
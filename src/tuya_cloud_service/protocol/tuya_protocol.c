@@ -512,6 +512,187 @@ OPERATE_RET lpv35_frame_serialize(const uint8_t *key, int key_len, const lpv35_f
     return op_ret;
 }
 
+/**
+ * @brief Serializes an LPV35 frame with a persistent GCM context.
+ *
+ * Same frame layout as lpv35_frame_serialize, but the AES key schedule is
+ * kept in the context between frames and the nonce is a counter seeded from
+ * random bytes on first use instead of 12 fresh random bytes per frame. The
+ * nonce travels in the frame, so the receiver side is unaffected.
+ *
+ * @param gcm Persistent GCM context, initialized with cipher_gcm_ctx_init.
+ * @param key The key used for serialization.
+ * @param key_len The length of the key.
+ * @param input The LPV35 frame object to be serialized.
+ * @param output The byte array to store the serialized data.
+ * @param olen A pointer to the length of the output byte array.
+ * @return OPERATE_RET Returns an OPERATE_RET value indicating the success or
+ * failure of the serialization process.
+ */
+OPERATE_RET lpv35_frame_serialize_ctx(cipher_gcm_ctx_t *gcm, const uint8_t *key, int key_len,
+                                      const lpv35_frame_object_t *input, uint8_t *output, int *olen)
+{
+    if (input == NULL || output == NULL || (input->data == NULL && input->data_len)) {
+        PR_ERR("PARAM ERROR");
+        return OPRT_INVALID_PARM;
+    }
+
+    if (input->data_len && input->data != output + LPV35_FRAME_HEADROOM) {
+        memmove(output + LPV35_FRAME_HEADROOM, input->data, input->data_len);
+    }
+
+    return lpv35_frame_seal(gcm, key, key_len, input->sequence, input->type, output, input->data_len, olen);
+}
+
+/**
+ * @brief Builds an LPV35 frame around a plaintext already in the buffer.
+ *
+ * The caller puts the plaintext at buf + LPV35_FRAME_HEADROOM and leaves
+ * LPV35_FRAME_TAILROOM bytes behind it. The header and nonce are written in
+ * front, the plaintext is encrypted in place and the tag and tail follow it,
+ * so no memory is needed besides the caller's buffer. Nonces are made as in
+ * lpv35_frame_serialize_ctx.
+ *
+ * @param gcm Persistent GCM context, initialized with cipher_gcm_ctx_init.
+ * @param key The key used for serialization.
+ * @param key_len The length of the key.
+ * @param sequence The frame sequence.
+ * @param type The frame type.
+ * @param buf The frame buffer holding the plaintext.
+ * @param data_len The length of the plaintext.
+ * @param olen A pointer to the length of the frame.
+ * @return OPERATE_RET Returns an OPERATE_RET value indicating the success or
+ * failure of the serialization process.
+ */
+OPERATE_RET lpv35_frame_seal(cipher_gcm_ctx_t *gcm, const uint8_t *key, int key_len, uint32_t sequence,
+                             uint32_t type, uint8_t *buf, uint32_t data_len, int *olen)
+{
+    if (gcm == NULL || key == NULL || key_len == 0 || buf == NULL || olen == NULL) {
+        PR_ERR("PARAM ERROR");
+        return OPRT_INVALID_PARM;
+    }
+
+    OPERATE_RET op_ret = OPRT_OK;
+    int offset = 0;
+    uint8_t *data = buf + LPV35_FRAME_HEADROOM;
+
+    // HEAD
+    memcpy(buf, LPV35_FRAME_HEAD, LPV35_FRAME_HEAD_SIZE);
+    offset += LPV35_FRAME_HEAD_SIZE;
+
+    // AD
+    lpv35_additional_data_t ad = {.version = 0,
+                                  .sequence = UNI_HTONL(sequence),
+                                  .type = UNI_HTONL(type),
+                                  .length = UNI_HTONL(LPV35_FRAME_NONCE_SIZE + data_len + LPV35_FRAME_TAG_SIZE)};
+    memcpy(buf + offset, (uint8_t *)&ad, sizeof(lpv35_additional_data_t));
+    offset += sizeof(lpv35_additional_data_t);
+
+    // nonce counter
+    uint8_t nonce[LPV35_FRAME_NONCE_SIZE];
+    if (gcm->nonce_len != LPV35_FRAME_NONCE_SIZE) {
+        uint8_t i = 0;
+        for (i = 0; i < LPV35_FRAME_NONCE_SIZE; i++) {
+            nonce[i] = uni_random_range(0xFF);
+        }
+        cipher_gcm_ctx_nonce_seed(gcm, nonce, LPV35_FRAME_NONCE_SIZE);
+    }
+    cipher_gcm_ctx_nonce_next(gcm, nonce);
+    memcpy(buf + offset, nonce, LPV35_FRAME_NONCE_SIZE);
+    offset += LPV35_FRAME_NONCE_SIZE;
+
+    // AES GCM encrypt in place, tag lands right behind the cipher text
+    op_ret = cipher_gcm_ctx_setkey(gcm, key, key_len);
+    if (op_ret == OPRT_OK) {
+        op_ret = cipher_gcm_ctx_auth_encrypt(gcm, nonce, LPV35_FRAME_NONCE_SIZE, (uint8_t *)(&ad),
+                                             sizeof(lpv35_additional_data_t), data, data_len, data, data + data_len,
+                                             LPV35_FRAME_TAG_SIZE);
+    }
+    if (op_ret != OPRT_OK) {
+        PR_ERR("cipher_gcm_ctx_auth_encrypt:0x%x", -op_ret);
+        return op_ret;
+    }
+    offset += data_len + LPV35_FRAME_TAG_SIZE;
+
+    // TAIL
+    memcpy(buf + offset, LPV35_FRAME_TAIL, LPV35_FRAME_TAIL_SIZE);
+    offset += LPV35_FRAME_TAIL_SIZE;
+    *olen = offset;
+
+    return op_ret;
+}
+
+/**
+ * @brief Parses an LPV35 frame, decrypting it in place.
+ *
+ * Checks the frame as lpv35_frame_parse does, but the plaintext replaces the
+ * cipher text in the input buffer and is terminated over the first tag byte,
+ * so nothing is allocated.
+ *
+ * @param gcm GCM context, its key schedule is reused between frames.
+ * @param key The LPV35 frame key.
+ * @param key_len The length of the LPV35 frame key.
+ * @param input The LPV35 frame, overwritten with the plaintext.
+ * @param ilen The length of the frame.
+ * @param output The output object, its data points into input.
+ *
+ * @return OPRT_OK on success, OPRT_INVALID_PARM for invalid parameters,
+ * OPRT_VERSION_FMT_ERR or OPRT_COM_ERROR for a malformed frame, or the error of
+ * the decryption.
+ */
+OPERATE_RET lpv35_frame_open(cipher_gcm_ctx_t *gcm, const uint8_t *key, int key_len, uint8_t *input, int ilen,
+                             lpv35_frame_object_t *output)
+{
+    OPERATE_RET op_ret = OPRT_OK;
+
+    if (gcm == NULL || key == NULL || key_len == 0 || input == NULL || ilen < LPV35_FRAME_MINI_SIZE ||
+        output == NULL) {
+        PR_ERR("PARAM ERROR");
+        return OPRT_INVALID_PARM;
+    }
+
+    // head tail verify
+    if ((memcmp(input, LPV35_FRAME_HEAD, LPV35_FRAME_HEAD_SIZE) != 0) ||
+        (memcmp(input + (ilen - LPV35_FRAME_TAIL_SIZE), LPV35_FRAME_TAIL, LPV35_FRAME_TAIL_SIZE) != 0)) {
+        PR_ERR("LPV35 HEAD OR TAIL ERROR");
+        return OPRT_VERSION_FMT_ERR;
+    }
+
+    lpv35_additional_data_t ad;
+    memcpy(&ad, input + LPV35_FRAME_HEAD_SIZE, sizeof(lpv35_additional_data_t));
+    output->sequence = UNI_HTONL(ad.sequence);
+    output->type = UNI_HTONL(ad.type);
+
+    // length verify
+    uint32_t length = UNI_HTONL(ad.length);
+    if (length != ilen - LPV35_FRAME_HEAD_SIZE - sizeof(lpv35_additional_data_t) - LPV35_FRAME_TAIL_SIZE) {
+        PR_ERR("length error, length:%d", length);
+        return OPRT_COM_ERROR;
+    }
+
+    uint8_t *nonce = input + LPV35_FRAME_HEAD_SIZE + sizeof(lpv35_additional_data_t);
+    uint8_t *data = input + LPV35_FRAME_HEADROOM;
+    uint32_t data_len = length - LPV35_FRAME_NONCE_SIZE - LPV35_FRAME_TAG_SIZE;
+    uint8_t tag[LPV35_FRAME_TAG_SIZE];
+    memcpy(tag, data + data_len, LPV35_FRAME_TAG_SIZE);
+
+    op_ret = cipher_gcm_ctx_setkey(gcm, key, key_len);
+    if (op_ret == OPRT_OK) {
+        op_ret = cipher_gcm_ctx_auth_decrypt(gcm, nonce, LPV35_FRAME_NONCE_SIZE, (uint8_t *)(&ad),
+                                             sizeof(lpv35_additional_data_t), data, data_len, data, tag,
+                                             LPV35_FRAME_TAG_SIZE);
+    }
+    if (op_ret != OPRT_OK) {
+        PR_ERR("cipher_gcm_ctx_auth_decrypt:0x%x", -op_ret);
+        return op_ret;
+    }
+    data[data_len] = 0;
+    output->data = data;
+    output->data_len = data_len;
+
+    return OPRT_OK;
+}
+
 /**
  * @brief Parses an LPV35 frame.
  *
@@ -63,6 +63,12 @@ extern "C" {
      LPV35_FRAME_TYPE_SIZE + LPV35_FRAME_DATALEN_SIZE + LPV35_FRAME_NONCE_SIZE + LPV35_FRAME_TAG_SIZE +                \
      LPV35_FRAME_TAIL_SIZE)
 
+/* room a caller leaves around the plaintext for lpv35_frame_seal */
+#define LPV35_FRAME_HEADROOM                                                                                           \
+    (LPV35_FRAME_HEAD_SIZE + LPV35_FRAME_VERSION_SIZE + LPV35_FRAME_RESERVE_SIZE + LPV35_FRAME_SEQUENCE_SIZE +         \
+     LPV35_FRAME_TYPE_SIZE + LPV35_FRAME_DATALEN_SIZE + LPV35_FRAME_NONCE_SIZE)
+#define LPV35_FRAME_TAILROOM (LPV35_FRAME_TAG_SIZE + LPV35_FRAME_TAIL_SIZE)
+
 #pragma pack(1)
 typedef struct {
     uint8_t version : 4;
@@ -144,6 +150,58 @@ OPERATE_RET tuya_pack_protocol_data(const DP_CMD_TYPE_E cmd, const char *src, co
 OPERATE_RET lpv35_frame_serialize(const uint8_t *key, int key_len, const lpv35_frame_object_t *input, uint8_t *output,
                                   int *olen);
 
+/**
+ * @brief add head and tail in lpv35 frame, reusing a persistent gcm context
+ *
+ * @param[in] gcm gcm context, key schedule and nonce counter are kept in it
+ * @param[in] key encrypt key
+ * @param[in] key_len encrypt key len
+ * @param[in] input raw data of lpv35 frame
+ * @param[out] output out frame data
+ * @param[out] olen out frame data len
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET lpv35_frame_serialize_ctx(cipher_gcm_ctx_t *gcm, const uint8_t *key, int key_len,
+                                      const lpv35_frame_object_t *input, uint8_t *output, int *olen);
+
+/**
+ * @brief build a lpv35 frame around a plaintext, encrypting in place
+ *
+ * @param[in] gcm gcm context, key schedule and nonce counter are kept in it
+ * @param[in] key encrypt key
+ * @param[in] key_len encrypt key len
+ * @param[in] sequence frame sequence
+ * @param[in] type frame type
+ * @param[inout] buf LPV35_FRAME_HEADROOM bytes, the plaintext, then
+ * LPV35_FRAME_TAILROOM bytes; holds the frame on return
+ * @param[in] data_len plaintext len
+ * @param[out] olen frame len
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET lpv35_frame_seal(cipher_gcm_ctx_t *gcm, const uint8_t *key, int key_len, uint32_t sequence,
+                             uint32_t type, uint8_t *buf, uint32_t data_len, int *olen);
+
+/**
+ * @brief lpv35 frame parse, decrypting in place
+ *
+ * @param[in] gcm gcm context, only its key schedule is used
+ * @param[in] key decrypt key
+ * @param[in] key_len decrypt key len
+ * @param[inout] input lpv35 frame, overwritten with the plaintext
+ * @param[in] ilen lpv35 frame len
+ * @param[out] output data points into input and is NUL terminated, it is
+ * not to be freed
+ *
+ * @return OPRT_OK on success. Others on error, please refer to
+ * tuya_error_code.h
+ */
+OPERATE_RET lpv35_frame_open(cipher_gcm_ctx_t *gcm, const uint8_t *key, int key_len, uint8_t *input, int ilen,
+                             lpv35_frame_object_t *output);
+
 /**
  * @brief lpv35 frame parse
  *
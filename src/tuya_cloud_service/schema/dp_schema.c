@@ -19,11 +19,11 @@
 #include "mix_method.h"
 #include "tal_api.h"
 
-#define MAX_ITEM_LEN 1024
-
 #define MAX_TRANS_TYPE_NUM (DTT_SCT_SCENE + 1)
 
+#ifndef DP_SCHEMA_NUM_MAX
 #define DP_SCHEMA_NUM_MAX 1
+#endif
 
 typedef struct {
     // DELAYED_WORK_HANDLE tmm_dp_sync;
@@ -35,6 +35,144 @@ typedef struct {
 
 static dp_schema_mgr_t s_dsmgr = {0};
 
+// FNV-1a, lets dp_schema_find skip the devid compare of other schemas
+static uint32_t dp_devid_hash(const char *devid)
+{
+    uint32_t hash = 2166136261U;
+
+    while (*devid) {
+        hash ^= (uint8_t)*devid++;
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+void dp_json_raw(dp_json_writer_t *w, const char *s, uint32_t n)
+{
+    if (w->buf && w->len < w->size) {
+        uint32_t room = w->size - w->len;
+        memcpy(w->buf + w->len, s, n < room ? n : room);
+    }
+    w->len += n;
+}
+
+void dp_json_str(dp_json_writer_t *w, const char *s)
+{
+    const char *run = s;
+    char esc[8];
+
+    dp_json_raw(w, "\"", 1);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        const char *rep = NULL;
+
+        switch (c) {
+        case '"':
+            rep = "\\\"";
+            break;
+        case '\\':
+            rep = "\\\\";
+            break;
+        case '\b':
+            rep = "\\b";
+            break;
+        case '\f':
+            rep = "\\f";
+            break;
+        case '\n':
+            rep = "\\n";
+            break;
+        case '\r':
+            rep = "\\r";
+            break;
+        case '\t':
+            rep = "\\t";
+            break;
+        default:
+            if (c < 0x20) {
+                snprintf(esc, sizeof(esc), "\\u%04x", c);
+                rep = esc;
+            }
+            break;
+        }
+        if (rep) {
+            dp_json_raw(w, run, s - run);
+            dp_json_raw(w, rep, strlen(rep));
+            run = s + 1;
+        }
+    }
+    dp_json_raw(w, run, s - run);
+    dp_json_raw(w, "\"", 1);
+}
+
+void dp_json_begin(dp_json_writer_t *w, char *buf, uint32_t size)
+{
+    w->buf = buf;
+    w->size = buf ? size : 0;
+    w->len = 0;
+    w->first = TRUE;
+    dp_json_raw(w, "{", 1);
+}
+
+void dp_json_key(dp_json_writer_t *w, uint8_t id)
+{
+    char key[8];
+    int n = snprintf(key, sizeof(key), "%s\"%u\":", w->first ? "" : ",", id);
+
+    w->first = FALSE;
+    dp_json_raw(w, key, n);
+}
+
+void dp_json_dp(dp_json_writer_t *w, const dp_obj_t *dp, const dp_node_t *dpnode)
+{
+    char num[16];
+    int n = 0;
+
+    dp_json_key(w, dp->id);
+    switch (dp->type) {
+    case PROP_BOOL:
+        if (dp->value.dp_bool) {
+            dp_json_raw(w, "true", 4);
+        } else {
+            dp_json_raw(w, "false", 5);
+        }
+        break;
+
+    case PROP_VALUE:
+        n = snprintf(num, sizeof(num), "%d", dp->value.dp_value);
+        dp_json_raw(w, num, n);
+        break;
+
+    case PROP_BITMAP:
+        n = snprintf(num, sizeof(num), "%" PRIu32, dp->value.dp_bitmap);
+        dp_json_raw(w, num, n);
+        break;
+
+    case PROP_STR:
+        dp_json_str(w, dp->value.dp_str ? dp->value.dp_str : "");
+        break;
+
+    case PROP_ENUM:
+        dp_json_str(w, dpnode->prop.prop_enum.pp_enum[dp->value.dp_enum]);
+        break;
+
+    default:
+        dp_json_raw(w, "null", 4);
+        break;
+    }
+}
+
+uint32_t dp_json_end(dp_json_writer_t *w)
+{
+    dp_json_raw(w, "}", 1);
+    if (w->buf && w->size) {
+        w->buf[w->len < w->size ? w->len : w->size - 1] = 0;
+    }
+
+    return w->len;
+}
+
 /**
  * @brief Appends a JSON string to the given data with the specified time, type,
  * and repetition sequence.
@@ -118,16 +256,34 @@ __err_exit:
  */
 dp_node_t *dp_node_find(dp_schema_t *schema, int id)
 {
-    int i;
-    dp_node_t *dpnode = NULL;
+    if (id < 0 || id >= (int)sizeof(schema->node_idx) || 0 == schema->node_idx[id]) {
+        return NULL;
+    }
 
-    for (i = 0; i < schema->num; i++) {
-        if (schema->node[i].desc.id == id) {
-            dpnode = &schema->node[i];
-            break;
-        }
+    return &schema->node[schema->node_idx[id] - 1];
+}
+
+/**
+ * Tells whether every reported value of a DP counts on its own, so that a
+ * newer value must not replace an older one that is not sent yet.
+ *
+ * @param schema The DP schema of the device.
+ * @param dp The reported DP.
+ * @return true for DPs with their own time stamp, direct trigger or
+ * statistics.
+ */
+bool dp_rept_is_record(dp_schema_t *schema, dp_obj_t *dp)
+{
+    if (dp->time_stamp) {
+        return true;
+    }
+
+    dp_node_t *dpnode = dp_node_find(schema, dp->id);
+    if (NULL == dpnode) {
+        return false;
     }
-    return dpnode;
+
+    return TRIG_DIRECT == dpnode->desc.trig || DST_NONE != dpnode->desc.stat;
 }
 
 /**
@@ -139,11 +295,12 @@ dp_node_t *dp_node_find(dp_schema_t *schema, int id)
 dp_schema_t *dp_schema_find(const char *devid)
 {
     int i = 0;
+    uint32_t hash = dp_devid_hash(devid);
 
     PR_TRACE("try to find schema devid %s", devid);
     dp_schema_mgr_t *dsmgr = &s_dsmgr;
     for (i = 0; i < DP_SCHEMA_NUM_MAX; i++) {
-        if (NULL == dsmgr->schema_list[i]) {
+        if (NULL == dsmgr->schema_list[i] || hash != dsmgr->schema_list[i]->devid_hash) {
             continue;
         }
         if (0 == strcmp(devid, dsmgr->schema_list[i]->devid)) {
@@ -168,20 +325,12 @@ dp_schema_t *dp_schema_find(const char *devid)
  */
 dp_node_t *dp_node_find_by_devid(char *devid, int id)
 {
-    int i;
-    dp_node_t *dpnode = NULL;
-
     dp_schema_t *schema = dp_schema_find(devid);
     if (NULL == schema) {
         return NULL;
     }
-    for (i = 0; i < schema->num; i++) {
-        if (schema->node[i].desc.id == id) {
-            dpnode = &schema->node[i];
-            break;
-        }
-    }
-    return dpnode;
+
+    return dp_node_find(schema, id);
 }
 
 static __attribute__((unused)) OPERATE_RET dp_obj_equal_resp(dp_schema_t *schema, uint8_t *dpid, uint8_t num,
@@ -697,7 +846,7 @@ static bool dp_type_check(dp_rept_type_t dp_rept_type, dp_obj_t *dp, dp_node_t *
         }
 
         case PROP_BITMAP:
-            if (dp->type != cJSON_Number) {
+            if (dp->type != PROP_BITMAP) {
                 PR_ERR("bitmap check fail %d %d %d", dp->type, dp->value.dp_bitmap, node->prop.prop_bitmap.max_len);
                 return FALSE;
             }
@@ -744,6 +893,7 @@ static bool dp_type_check(dp_rept_type_t dp_rept_type, dp_obj_t *dp, dp_node_t *
 int dp_rept_valid_check(dp_schema_t *schema, dp_rept_in_t *dpin, dp_rept_valid_t *dpvalid)
 {
     int i;
+    uint32_t len = 2; // braces and terminator, less the first separator
 
     tal_mutex_lock(schema->mutex);
     for (i = 0; i < dpin->dpscnt; i++) {
@@ -776,33 +926,28 @@ int dp_rept_valid_check(dp_schema_t *schema, dp_rept_in_t *dpin, dp_rept_valid_t
             }
         }
 
-        switch (dp->type) {
-        case PROP_BOOL:
-        case PROP_VALUE:
-        case PROP_BITMAP: {
-            dpvalid->len += 20;
-            break;
-        }
-
-        case PROP_STR: {
-            dpvalid->len += 2 * strlen(dp->value.dp_str) + 15;
-        } break;
-
-        case PROP_ENUM: {
-            if (dp->value.dp_enum >= dpnode->prop.prop_enum.cnt) {
-                PR_ERR("dparr[%d] enum not match:%d %d", i, dp->value.dp_enum, dpnode->prop.prop_enum.cnt);
-                tal_mutex_unlock(schema->mutex);
-                return OPRT_SVC_DP_TYPE_PROP_ILLEGAL;
-            }
-            dpvalid->len += strlen(dpnode->prop.prop_enum.pp_enum[dp->value.dp_enum]) + 15;
-        } break;
-
-        default: {
+        if (dp->type > PROP_BITMAP) {
             PR_ERR("dparr[%d] type invalid %d", i, dp->type);
             tal_mutex_unlock(schema->mutex);
             return OPRT_COM_ERROR;
         }
+        if (PROP_ENUM == dp->type && dp->value.dp_enum >= dpnode->prop.prop_enum.cnt) {
+            PR_ERR("dparr[%d] enum not match:%d %d", i, dp->value.dp_enum, dpnode->prop.prop_enum.cnt);
+            tal_mutex_unlock(schema->mutex);
+            return OPRT_SVC_DP_TYPE_PROP_ILLEGAL;
+        }
+
+        // exact size of the dp in the report, strings with their escapes
+        dp_json_writer_t m = {0};
+        m.first = FALSE;
+        dp_json_dp(&m, dp, dpnode);
+        if (len + m.len > UINT16_MAX) {
+            PR_ERR("dparr[%d] report too long", i);
+            tal_mutex_unlock(schema->mutex);
+            return OPRT_EXCEED_UPPER_LIMIT;
         }
+        len += m.len;
+
         if (dp->time_stamp) {
             dpvalid->timelen += 30;
         }
@@ -815,6 +960,7 @@ int dp_rept_valid_check(dp_schema_t *schema, dp_rept_in_t *dpin, dp_rept_valid_t
         return OPRT_SVC_DP_ID_NOT_FOUND;
     }
 
+    dpvalid->len = len;
     dpvalid->schema = schema;
 
     return OPRT_OK;
@@ -837,12 +983,12 @@ int dp_rept_valid_check(dp_schema_t *schema, dp_rept_in_t *dpin, dp_rept_valid_t
 int dp_rept_json_output(dp_schema_t *schema, dp_rept_in_t *dpin, dp_rept_valid_t *dpvalid, dp_rept_out_t *dpout)
 {
     uint16_t i, j;
-    uint16_t offset = 0;
-    uint16_t time_offset = 0;
     OPERATE_RET op_ret = OPRT_OK;
     char *dpstr = NULL;
     char *dptimestr = NULL;
     bool is_need_time = false;
+    dp_json_writer_t w;
+    dp_json_writer_t tw;
 
     dpstr = (char *)tal_malloc(dpvalid->len);
     if (NULL == dpstr) {
@@ -859,9 +1005,9 @@ int dp_rept_json_output(dp_schema_t *schema, dp_rept_in_t *dpin, dp_rept_valid_t
         }
         is_need_time = true;
     }
-    dpstr[offset++] = '{';
+    dp_json_begin(&w, dpstr, dpvalid->len);
     if (is_need_time) {
-        dptimestr[time_offset++] = '{';
+        dp_json_begin(&tw, dptimestr, dpvalid->timelen);
     }
 
     for (i = 0; i < dpvalid->num; i++) {
@@ -877,7 +1023,6 @@ int dp_rept_json_output(dp_schema_t *schema, dp_rept_in_t *dpin, dp_rept_valid_t
             op_ret = OPRT_SVC_DP_ID_NOT_FOUND;
             goto __err_exit;
         }
-        // dp_obj_t  *dp     = &dpin->dps[dpvalid->dpid[i]];
         dp_node_t *dpnode = dp_node_find(schema, dp->id);
         if (NULL == dpnode) {
             PR_DEBUG("dp->id = %d not found", dp->id);
@@ -890,58 +1035,28 @@ int dp_rept_json_output(dp_schema_t *schema, dp_rept_in_t *dpin, dp_rept_valid_t
             goto __err_exit;
         }
 
-        switch (dp->type) {
-        case PROP_BOOL: {
-            if (TRUE == dp->value.dp_bool) {
-                offset += sprintf(dpstr + offset, "\"%d\":true,", dp->id);
-            } else {
-                offset += sprintf(dpstr + offset, "\"%d\":false,", dp->id);
-            }
-            break;
-        }
-
-        case PROP_VALUE: {
-            offset += sprintf(dpstr + offset, "\"%d\":%d,", dp->id, dp->value.dp_value);
-            break;
-        }
-
-        case PROP_BITMAP: {
-            offset += sprintf(dpstr + offset, "\"%d\":%" PRIu32 ",", dp->id, dp->value.dp_bitmap);
-            break;
-        }
-
-        case PROP_STR: {
-            cJSON *temp_str = cJSON_CreateString(dp->value.dp_str);
-            char *tmp_data = cJSON_PrintUnformatted(temp_str);
-            if (tmp_data) {
-                offset += sprintf(dpstr + offset, "\"%d\":%s,", dp->id, tmp_data);
-            }
-            tal_free(tmp_data);
-            cJSON_Delete(temp_str);
-            break;
-        }
-
-        case PROP_ENUM: {
-            offset +=
-                sprintf(dpstr + offset, "\"%d\":\"%s\",", dp->id, dpnode->prop.prop_enum.pp_enum[dp->value.dp_enum]);
-        } break;
-        }
+        dp_json_dp(&w, dp, dpnode);
 
         if (is_need_time && dp->time_stamp) {
-            time_offset += sprintf(dptimestr + time_offset, "\"%d\":%u,", dp->id, dp->time_stamp);
+            char ts[12];
+            int n = snprintf(ts, sizeof(ts), "%u", dp->time_stamp);
+            dp_json_key(&tw, dp->id);
+            dp_json_raw(&tw, ts, n);
         }
     }
 
-    dpstr[offset - 1] = '}';
-    dpstr[offset] = 0;
+    if (dp_json_end(&w) >= dpvalid->len) {
+        PR_ERR("dp rept overflow:%u %d", w.len, dpvalid->len);
+        op_ret = OPRT_BUFFER_NOT_ENOUGH;
+        goto __err_exit;
+    }
 
     dpout->dpsjson = dpstr;
 
     PR_DEBUG("dp rept out: %s", dpstr);
 
     if (is_need_time) {
-        dptimestr[time_offset - 1] = '}';
-        dptimestr[time_offset] = 0;
+        dp_json_end(&tw);
         PR_DEBUG("dptimestr:%s", dptimestr);
         dpout->timejson = dptimestr;
     }
@@ -993,56 +1108,115 @@ __err_exit:
 //     return op_ret;
 // }
 
-static int dp_obj_json_create(cJSON *root, dp_node_t *dpnode)
+static bool dp_node_json_write(dp_json_writer_t *w, dp_node_t *dpnode)
 {
-    int length = 0;
+    dp_obj_t dp = {0};
 
-    char dpid[10] = {0};
-    snprintf(dpid, 10, "%d", dpnode->desc.id);
+    dp.id = dpnode->desc.id;
+    dp.type = dpnode->desc.prop_tp;
 
     switch (dpnode->desc.prop_tp) {
     case PROP_BOOL: {
-        length += 10;
-        cJSON_AddBoolToObject(root, dpid, dpnode->prop.prop_bool.value);
+        dp.value.dp_bool = dpnode->prop.prop_bool.value;
         break;
     }
 
     case PROP_VALUE: {
-        length += 10;
-        cJSON_AddNumberToObject(root, dpid, dpnode->prop.prop_int.value);
+        dp.value.dp_value = dpnode->prop.prop_int.value;
         break;
     }
 
     case PROP_STR: {
+        bool written = FALSE;
         tal_mutex_lock(dpnode->prop.prop_str.dp_str_mutex);
         if (dpnode->prop.prop_str.value) {
-            length += (10 + strlen(dpnode->prop.prop_str.value));
-            cJSON_AddStringToObject(root, dpid, dpnode->prop.prop_str.value);
+            dp.value.dp_str = dpnode->prop.prop_str.value;
+            dp_json_dp(w, &dp, dpnode);
+            written = TRUE;
         }
         tal_mutex_unlock(dpnode->prop.prop_str.dp_str_mutex);
-        break;
+        return written;
     }
 
     case PROP_ENUM: {
-        int value = dpnode->prop.prop_enum.value;
-        length += (10 + strlen(dpnode->prop.prop_enum.pp_enum[value]));
-        cJSON_AddStringToObject(root, dpid, dpnode->prop.prop_enum.pp_enum[value]);
+        dp.value.dp_enum = dpnode->prop.prop_enum.value;
         break;
     }
 
     case PROP_BITMAP: {
-        length += 10;
-        cJSON_AddNumberToObject(root, dpid, dpnode->prop.prop_bitmap.value);
+        dp.value.dp_bitmap = dpnode->prop.prop_bitmap.value;
         break;
     }
 
     default: {
         PR_ERR("dp type err:%d", dpnode->desc.prop_tp);
-        break;
+        return FALSE;
+    }
     }
+
+    dp_json_dp(w, &dp, dpnode);
+    return TRUE;
+}
+
+/**
+ * @brief Writes the values of the schema nodes into an exactly sized buffer.
+ *
+ * The first pass only measures. A string that grows before the second pass
+ * makes it overflow, the output is measured again in that case.
+ */
+static int dp_obj_dump_json(dp_schema_t *schema, bool local_only, dp_rept_valid_t *dpvalid, uint8_t max,
+                            char **out)
+{
+    int i, tries;
+    uint16_t cnt = 0;
+    dp_json_writer_t w;
+    char *buf = NULL;
+    uint32_t size = 0;
+
+    for (tries = 0; tries < 3; tries++) {
+        dp_json_begin(&w, buf, size);
+        cnt = 0;
+        if (dpvalid) {
+            dpvalid->num = 0;
+        }
+        for (i = 0; i < schema->num; i++) {
+            dp_node_t *dpnode = &(schema->node[i]);
+            if (local_only && T_OBJ == dpnode->desc.type && PV_STAT_CLOUD == dpnode->pv_stat) {
+                continue;
+            }
+            if (dpvalid) {
+                if (dpvalid->num >= max) {
+                    continue;
+                }
+                dpvalid->dpid[dpvalid->num++] = dpnode->desc.id;
+            }
+            if (dp_node_json_write(&w, dpnode)) {
+                cnt++;
+            }
+        }
+        dp_json_end(&w);
+
+        if (0 == cnt) {
+            PR_DEBUG("Nothing To Pack");
+            tal_free(buf);
+            return OPRT_SVC_DP_ID_NOT_FOUND;
+        }
+        if (buf && w.len < size) {
+            *out = buf;
+            return OPRT_OK;
+        }
+
+        tal_free(buf);
+        size = w.len + 1;
+        buf = tal_malloc(size);
+        if (NULL == buf) {
+            PR_ERR("malloc err:%u", size);
+            return OPRT_MALLOC_FAILED;
+        }
     }
 
-    return length;
+    tal_free(buf);
+    return OPRT_COM_ERROR;
 }
 
 /**
@@ -1067,16 +1241,18 @@ static int dp_obj_json_create(cJSON *root, dp_node_t *dpnode)
 int dp_obj_dump_stat_local_json(char *devid, dp_rept_valid_t **outdpvalid, char **outjson, int flags)
 {
     int i;
-    size_t length = 0;
+    int op_ret = OPRT_OK;
+    char *jsonstr = NULL;
     dp_schema_t *schema = dp_schema_find(devid);
     uint8_t dp_stat_local_num = 0;
 
+    if (NULL == schema) {
+        PR_ERR("schema err");
+        return OPRT_COM_ERROR;
+    }
+
     for (i = 0; i < schema->num; i++) {
         dp_node_t *dpnode = &(schema->node[i]);
-        if (dpnode == NULL) {
-            PR_DEBUG("dpnode NULL");
-            break;
-        }
         if (T_OBJ == dpnode->desc.type && PV_STAT_CLOUD != dpnode->pv_stat) {
             dp_stat_local_num++;
             continue;
@@ -1087,46 +1263,17 @@ int dp_obj_dump_stat_local_json(char *devid, dp_rept_valid_t **outdpvalid, char
         return OPRT_OK;
     }
 
-    cJSON *cjson = cJSON_CreateObject();
-    if (NULL == cjson) {
-        PR_ERR("json err");
-        return OPRT_MALLOC_FAILED;
-    }
-
     dp_rept_valid_t *dpvaild = tal_malloc(sizeof(dp_rept_valid_t) + sizeof(uint8_t) * dp_stat_local_num);
     if (NULL == dpvaild) {
-        cJSON_Delete(cjson);
         return OPRT_MALLOC_FAILED;
     }
     memset(dpvaild, 0, sizeof(dp_rept_valid_t) + sizeof(uint8_t) * dp_stat_local_num);
     dpvaild->schema = schema;
 
-    for (i = 0; i < schema->num; i++) {
-        dp_node_t *dpnode = &(schema->node[i]);
-        if (dpnode == NULL) {
-            PR_DEBUG("dpnode NULL");
-            break;
-        }
-        if (T_OBJ == dpnode->desc.type && PV_STAT_CLOUD == dpnode->pv_stat) {
-            continue;
-        }
-        if (dpvaild->num < dp_stat_local_num) {
-            dpvaild->dpid[dpvaild->num++] = dpnode->desc.id;
-            length += dp_obj_json_create(cjson, dpnode);
-        }
-    }
-
-    if (length == 0) {
-        PR_DEBUG("Nothing To Pack");
-        cJSON_Delete(cjson);
-        return OPRT_SVC_DP_ID_NOT_FOUND;
-    }
-    char *jsonstr = cJSON_PrintUnformatted(cjson);
-    cJSON_Delete(cjson);
-    if (NULL == jsonstr) {
+    op_ret = dp_obj_dump_json(schema, TRUE, dpvaild, dp_stat_local_num, &jsonstr);
+    if (OPRT_OK != op_ret) {
         tal_free(dpvaild);
-        PR_ERR("Json err");
-        return OPRT_CR_CJSON_ERR;
+        return op_ret;
     }
 
     if (flags & DP_APPEND_HEADER_FLAG) {
@@ -1166,344 +1313,693 @@ int dp_obj_dump_stat_local_json(char *devid, dp_rept_valid_t **outdpvalid, char
  */
 char *dp_obj_dump_all_json(char *devid, int flags)
 {
-    cJSON *cjson = cJSON_CreateObject();
-    if (NULL == cjson) {
-        PR_ERR("json err");
-        return NULL;
-    }
-
-    size_t length = 0;
+    char *out = NULL;
     dp_schema_t *schema = dp_schema_find(devid);
     if (NULL == schema) {
-        cJSON_Delete(cjson);
         PR_ERR("schema err");
         return NULL;
     }
 
-    int i;
-
-    for (i = 0; i < schema->num; i++) {
-        dp_node_t *dpnode = &(schema->node[i]);
-        if (dpnode == NULL) {
-            PR_DEBUG("dpnode NULL");
-            break;
-        }
-        if (DP_DUMP_STAT_LOCAL_FLAG & flags) {
-            if (T_OBJ == dpnode->desc.type && PV_STAT_CLOUD == dpnode->pv_stat) {
-                continue;
-            }
-        }
-        length += dp_obj_json_create(cjson, dpnode);
-    } /* end of for */
-
-    if (length == 0) {
-        PR_DEBUG("Nothing To Pack");
-        cJSON_Delete(cjson);
-        return NULL;
-    }
-
-    char *tmp = cJSON_PrintUnformatted(cjson);
-    cJSON_Delete(cjson);
-    if (NULL == tmp) {
-        PR_ERR("Json err");
+    if (OPRT_OK != dp_obj_dump_json(schema, (DP_DUMP_STAT_LOCAL_FLAG & flags) ? TRUE : FALSE, NULL, 0, &out)) {
         return NULL;
     }
 
-    char *out = tmp;
-
     if (flags & DP_APPEND_HEADER_FLAG) {
-        dp_rept_json_append(schema, out, NULL, NULL, 0, &out);
+        char *tmp = out;
+        out = NULL;
+        dp_rept_json_append(schema, tmp, NULL, NULL, 0, &out);
+        tal_free(tmp);
     }
 
     return out;
 }
 
-typedef struct {
-    uint16_t start;
-    uint16_t end;
-} dp_node_pos_t;
-
-#define MAX_ITEM_LEN 1024
-
-static int dp_node_pos_decode(char *schema_json, dp_node_pos_t pos[], int pos_num)
+static dp_schema_t *dp_schema_alloc(int nodenum)
 {
-    if (!schema_json) {
-        return 0;
+    dp_schema_t *dp_schema = (dp_schema_t *)tal_malloc(sizeof(dp_schema_t) + nodenum * sizeof(dp_node_t));
+    if (NULL == dp_schema) {
+        PR_ERR("malloc fail:%d", nodenum);
+        return NULL;
+    }
+    memset(dp_schema, 0, sizeof(dp_schema_t) + nodenum * sizeof(dp_node_t));
+    if (OPRT_OK != tal_mutex_create_init(&(dp_schema->mutex))) {
+        PR_ERR("mutex create fail");
+        tal_free(dp_schema);
+        return NULL;
     }
+    dp_schema->num = nodenum;
 
-    int i = 0, brace = 0, n = 0;
+    return dp_schema;
+}
 
-    while (*schema_json) {
-        if (*schema_json == '{') {
-            if (brace == 0) {
-                pos[n].start = i;
-            }
-            brace++;
-        } else if (*schema_json == '}') {
-            brace--;
-            if (brace == 0) {
-                pos[n++].end = i;
-            }
+static void dp_node_release(dp_node_t *dpnode)
+{
+    int i;
 
-            if (n >= pos_num) {
-                return n;
-            }
+    if (T_OBJ != dpnode->desc.type) {
+        return;
+    }
+    if (PROP_ENUM == dpnode->desc.prop_tp && dpnode->prop.prop_enum.pp_enum) {
+        for (i = 0; i < dpnode->prop.prop_enum.cnt; i++) {
+            tal_free(dpnode->prop.prop_enum.pp_enum[i]);
         }
-        i++;
-        schema_json++;
+        tal_free(dpnode->prop.prop_enum.pp_enum);
+    } else if (PROP_STR == dpnode->desc.prop_tp) {
+        if (dpnode->prop.prop_str.dp_str_mutex) {
+            tal_mutex_release(dpnode->prop.prop_str.dp_str_mutex);
+        }
+        tal_free(dpnode->prop.prop_str.value);
     }
-
-    return n;
 }
 
-static OPERATE_RET dp_node_parse(char *schema_json, dp_node_pos_t *nodepos, uint16_t nodenum, dp_node_t *dpnode,
-                                 SCHEMA_OTHER_ATTR_S *other_attr)
+static void dp_schema_free(dp_schema_t *dp_schema)
 {
-    OPERATE_RET op_ret = OPRT_OK;
-    dp_desc_t *dp_desc;
-    dp_prop_vaule_t *prop;
-
-    cJSON *cjson = NULL;
-    cJSON *item = NULL;
-    char *pBuf = NULL;
+    int i;
 
-    pBuf = (char *)tal_malloc(MAX_ITEM_LEN);
-    if (NULL == pBuf) {
-        PR_ERR("malloc fail");
-        op_ret = OPRT_COM_ERROR;
-        goto __exit;
+    for (i = 0; i < dp_schema->num; i++) {
+        dp_node_release(&dp_schema->node[i]);
     }
+    tal_mutex_release(dp_schema->mutex);
+    tal_free(dp_schema);
+}
 
-    int i = 0;
+static void dp_schema_install(dp_schema_t *dp_schema, char *devid, bool preprocess, dp_schema_t **dp_schema_out)
+{
+    int i;
 
-    for (i = 0; i < nodenum; i++) {
-        dp_desc = &(dpnode[i].desc);
-        prop = &(dpnode[i].prop);
-
-        memset(pBuf, 0, MAX_ITEM_LEN);
-        memcpy(pBuf, schema_json + nodepos[i].start, nodepos[i].end - nodepos[i].start + 1);
-        cjson = cJSON_Parse(pBuf);
-        if (NULL == cjson) {
-            PR_ERR("cjson NULL:%s", pBuf);
-            op_ret = OPRT_CJSON_PARSE_ERR;
-            goto __exit;
-        }
-        item = cJSON_GetObjectItem(cjson, "id"); // id
-        if (NULL == item) {
-            PR_ERR("get id null");
-            op_ret = OPRT_CJSON_GET_ERR;
-            goto __exit;
-        }
-        if (item->type == cJSON_String) {
-            dp_desc->id = atoi(item->valuestring);
-        } else {
-            dp_desc->id = item->valueint;
-        }
-        //! mode
-        item = cJSON_GetObjectItem(cjson, "mode");
-        if (NULL == item) {
-            PR_ERR("get mode null");
-            op_ret = OPRT_CJSON_GET_ERR;
-            goto __exit;
-        }
-        if (!strcmp(item->valuestring, "rw")) {
-            dp_desc->mode = M_RW;
-        } else if (!strcmp(item->valuestring, "ro")) {
-            dp_desc->mode = M_RO;
-        } else {
-            dp_desc->mode = M_WR;
+    dp_schema->actv.preprocess = preprocess;
+    dp_schema->actv.attach_dp_if = TRUE;
+    strncpy(dp_schema->devid, devid, DEV_ID_LEN);
+    dp_schema->devid_hash = dp_devid_hash(dp_schema->devid);
+    // the first node of an id wins, as with the former linear search
+    for (i = 0; i < dp_schema->num; i++) {
+        uint8_t id = dp_schema->node[i].desc.id;
+        if (0 == dp_schema->node_idx[id]) {
+            dp_schema->node_idx[id] = i + 1;
         }
-        //! passive
-        item = cJSON_GetObjectItem(cjson, "passive");
-        if (item == NULL) {
-            dp_desc->passive = PSV_FALSE;
-        } else {
-            other_attr->preprocess = TRUE;
-            // passive processing is disabled first. The default value is false
-            dp_desc->passive = PSV_FALSE;
-        }
-        //! trigger
-        item = cJSON_GetObjectItem(cjson, "trigger");
-        if (NULL == item) {
-            dp_desc->trig = TRIG_PULSE;
-        } else {
-            if (!strcmp(item->valuestring, "pulse")) {
-                dp_desc->trig = TRIG_PULSE;
-            } else {
-                dp_desc->trig = TRIG_DIRECT;
-            }
+    }
+    if (dp_schema_out) {
+        *dp_schema_out = dp_schema;
+    }
+    for (i = 0; i < DP_SCHEMA_NUM_MAX; i++) {
+        if (NULL == s_dsmgr.schema_list[i]) {
+            s_dsmgr.schema_list[i] = dp_schema;
+            s_dsmgr.schema_num++;
+            break;
         }
-        // route
-        item = cJSON_GetObjectItem(cjson, "route");
-        if (NULL == item) {
-            dp_desc->route_t = ROUTE_DEFAULT;
-        } else {
-            if (item->valueint == 2) {
-                dp_desc->route_t = ROUTE_FORCE_BT;
-            }
+    }
+}
 
-            else if (item->valueint == 1) {
-                dp_desc->route_t = ROUTE_BLE_FIRST;
-            } else {
-                dp_desc->route_t = ROUTE_DEFAULT;
-            }
-        }
-        // stat //todo
-        item = cJSON_GetObjectItem(cjson, "stat");
-        if (NULL == item) {
-            dp_desc->stat = DST_NONE;
-        } else {
-            if (!strcmp(item->valuestring, "total")) {
-                dp_desc->stat = DST_TOTAL;
-            } else {
-                dp_desc->stat = DST_INC;
-            }
-        }
-        // type
-        item = cJSON_GetObjectItem(cjson, "type");
-        if (NULL == item) {
-            dp_desc->type = T_OBJ;
-        } else {
-            if (!strcmp(item->valuestring, "obj")) {
-                dp_desc->type = T_OBJ;
-            } else {
-                if (!strcmp(item->valuestring, "raw")) {
-                    dp_desc->type = T_RAW;
-                } else {
-                    dp_desc->type = T_FILE;
-                }
-                cJSON_Delete(cjson);
-                continue;
-            }
+/*
+ * Streaming schema parser. The JSON is tokenized as it is fed and every dp
+ * object is turned into its dp_node_t when it closes, only the current token,
+ * key and node are kept besides the parsed nodes.
+ */
+#ifndef DP_SCHEMA_TOKEN_MAX
+#define DP_SCHEMA_TOKEN_MAX 128 // longest string value, enum items included
+#endif
+
+#define DP_SCHEMA_KEY_MAX   16
+#define DP_SCHEMA_DEPTH_MAX 8
+
+typedef enum {
+    CTX_TOP = 0, // the array of dps
+    CTX_NODE,    // a dp object
+    CTX_PROP,    // its property object
+    CTX_RANGE,   // the range array of an enum
+    CTX_SKIP,    // anything else, ignored
+} dp_parse_ctx_t;
+
+typedef enum {
+    LEX_VALUE = 0,
+    LEX_STR,
+    LEX_STR_ESC,
+    LEX_STR_U,
+    LEX_LIT,
+} dp_parse_lex_t;
+
+#define DP_PARSE_ID         (1 << 0)
+#define DP_PARSE_MODE       (1 << 1)
+#define DP_PARSE_PROP       (1 << 2)
+#define DP_PARSE_PROP_TP    (1 << 3)
+#define DP_PARSE_MAX        (1 << 4)
+#define DP_PARSE_MIN        (1 << 5)
+#define DP_PARSE_SCALE      (1 << 6)
+#define DP_PARSE_MAXLEN     (1 << 7)
+#define DP_PARSE_PROP_ERR   (1 << 8)
+
+#define DP_PROP_TP_NONE 0xFF
+
+struct dp_schema_parser {
+    OPERATE_RET err;
+    bool preprocess;
+    bool done;
+    /* lexer */
+    uint8_t lex;
+    uint8_t depth;
+    uint8_t obj_mask; // bit n set when depth n is an object
+    uint8_t ctx[DP_SCHEMA_DEPTH_MAX];
+    bool expect_key;
+    bool is_key;
+    uint8_t u_left;
+    uint16_t u_code;
+    uint16_t toklen;
+    char tok[DP_SCHEMA_TOKEN_MAX + 1];
+    char key[DP_SCHEMA_KEY_MAX + 1];
+    /* node being parsed */
+    dp_node_t cur;
+    uint16_t seen;
+    int max, min, scale, maxlen;
+    char **range;
+    uint16_t range_cnt;
+    /* nodes parsed */
+    dp_node_t *node;
+    uint16_t num;
+    uint16_t cap;
+};
+
+static void dp_parse_range_free(dp_schema_parser_t *p)
+{
+    int i;
+
+    for (i = 0; i < p->range_cnt; i++) {
+        tal_free(p->range[i]);
+    }
+    tal_free(p->range);
+    p->range = NULL;
+    p->range_cnt = 0;
+}
+
+static void dp_parse_node_begin(dp_schema_parser_t *p)
+{
+    dp_parse_range_free(p);
+    memset(&p->cur, 0, sizeof(p->cur));
+    p->cur.desc.type = T_OBJ;
+    p->cur.desc.trig = TRIG_PULSE;
+    p->cur.desc.stat = DST_NONE;
+    p->cur.desc.route_t = ROUTE_DEFAULT;
+    p->cur.desc.passive = PSV_FALSE;
+    p->cur.desc.prop_tp = DP_PROP_TP_NONE;
+    p->seen = 0;
+    p->scale = 0;
+}
+
+static OPERATE_RET dp_parse_node_end(dp_schema_parser_t *p)
+{
+    dp_node_t *node = &p->cur;
+    dp_prop_vaule_t *prop = &node->prop;
+
+    if (!(p->seen & DP_PARSE_ID) || !(p->seen & DP_PARSE_MODE)) {
+        PR_ERR("get id or mode null");
+        return OPRT_CJSON_GET_ERR;
+    }
+    if (p->num >= 254) {
+        PR_ERR("dp num parse err:%d", p->num + 1);
+        return OPRT_SVC_DEVOS_DEV_DP_CNT_INVALID;
+    }
+    // room first, nothing is allocated for the node yet
+    if (p->num == p->cap) {
+        uint16_t cap = p->cap ? p->cap * 2 : 8;
+        dp_node_t *grown = tal_realloc(p->node, cap * sizeof(dp_node_t));
+        if (NULL == grown) {
+            return OPRT_MALLOC_FAILED;
         }
-        // property
-        item = cJSON_GetObjectItem(cjson, "property");
-        if (NULL == item) {
-            PR_ERR("get property null");
-            op_ret = OPRT_CJSON_GET_ERR;
-            goto __exit;
-        }
-        cJSON *child;
-        child = cJSON_GetObjectItem(item, "type");
-        if (NULL == child) {
-            PR_ERR("get type null");
-            op_ret = OPRT_CJSON_GET_ERR;
-            goto __exit;
-        }
-        if (!strcmp(child->valuestring, "bool")) {
-            dp_desc->prop_tp = PROP_BOOL;
-        } else if (!strcmp(child->valuestring, "value")) {
-            dp_desc->prop_tp = PROP_VALUE;
-            char *str[] = {"max", "min", "scale"};
-            int i;
-            for (i = 0; i < CNTSOF(str); i++) {
-                child = cJSON_GetObjectItem(item, str[i]);
-                if (NULL == child && (i != CNTSOF(str) - 1)) {
-                    PR_ERR("get property null");
-                    op_ret = OPRT_CJSON_GET_ERR;
-                    goto __exit;
-                } else if (NULL == child && (i == CNTSOF(str) - 1)) {
-                    prop->prop_int.scale = 0;
-                } else {
-                    switch (i) {
-                    case 0:
-                        prop->prop_int.max = child->valueint;
-                        break;
-                    case 1:
-                        prop->prop_int.min = child->valueint;
-                        break;
-                    case 2:
-                        prop->prop_int.scale = child->valueint;
-                        break;
-                    }
-                }
+        p->node = grown;
+        p->cap = cap;
+    }
+
+    if (T_OBJ == node->desc.type) {
+        if (!(p->seen & DP_PARSE_PROP) || !(p->seen & DP_PARSE_PROP_TP)) {
+            PR_ERR("dp %d get property null", node->desc.id);
+            return OPRT_CJSON_GET_ERR;
+        }
+        if (p->seen & DP_PARSE_PROP_ERR) {
+            return OPRT_SVC_DEVOS_SCMA_INVALID;
+        }
+        switch (node->desc.prop_tp) {
+        case PROP_VALUE:
+            if (!(p->seen & DP_PARSE_MAX) || !(p->seen & DP_PARSE_MIN)) {
+                PR_ERR("dp %d get max/min null", node->desc.id);
+                return OPRT_CJSON_GET_ERR;
             }
-        } else if (!strcmp(child->valuestring, "string")) {
-            dp_desc->prop_tp = PROP_STR;
-            child = cJSON_GetObjectItem(item, "maxlen");
-            if (NULL == child) {
-                PR_ERR("get maxlen null");
-                op_ret = OPRT_CJSON_GET_ERR;
-                goto __exit;
+            prop->prop_int.max = p->max;
+            prop->prop_int.min = p->min;
+            prop->prop_int.scale = p->scale;
+            break;
+
+        case PROP_STR:
+            if (!(p->seen & DP_PARSE_MAXLEN)) {
+                PR_ERR("dp %d get maxlen null", node->desc.id);
+                return OPRT_CJSON_GET_ERR;
             }
-            prop->prop_str.max_len = child->valueint;
-            prop->prop_str.value = NULL;
-            prop->prop_str.cur_len = 0;
-            op_ret = tal_mutex_create_init(&prop->prop_str.dp_str_mutex);
-            if (OPRT_OK != op_ret) {
-                PR_ERR("mutex init fail:%d", op_ret);
-                op_ret = OPRT_CR_MUTEX_ERR;
-                goto __exit;
+            prop->prop_str.max_len = p->maxlen;
+            if (OPRT_OK != tal_mutex_create_init(&prop->prop_str.dp_str_mutex)) {
+                PR_ERR("mutex init fail");
+                return OPRT_CR_MUTEX_ERR;
             }
-        } else if (!strcmp(child->valuestring, "enum")) {
-            dp_desc->prop_tp = PROP_ENUM;
-            child = cJSON_GetObjectItem(item, "range");
-            if (NULL == child) {
-                PR_ERR("get range null");
-                op_ret = OPRT_CJSON_GET_ERR;
-                goto __exit;
+            break;
+
+        case PROP_ENUM:
+            if (0 == p->range_cnt) {
+                PR_ERR("dp %d get range null", node->desc.id);
+                return OPRT_CJSON_GET_ERR;
             }
-            int i, num;
-            num = cJSON_GetArraySize(child);
-            if (num == 0) {
-                PR_ERR("get array size null");
-                op_ret = OPRT_CJSON_GET_ERR;
-                goto __exit;
+            prop->prop_enum.pp_enum = p->range;
+            prop->prop_enum.cnt = p->range_cnt;
+            p->range = NULL;
+            p->range_cnt = 0;
+            break;
+
+        case PROP_BITMAP:
+            if (!(p->seen & DP_PARSE_MAXLEN)) {
+                PR_ERR("dp %d get maxlen null", node->desc.id);
+                return OPRT_CJSON_GET_ERR;
             }
-            prop->prop_enum.pp_enum = tal_malloc(num * sizeof(char *));
-            if (NULL == prop->prop_enum.pp_enum) {
-                PR_ERR("malloc fail");
-                op_ret = OPRT_MALLOC_FAILED;
-                goto __exit;
+            prop->prop_bitmap.max_len = p->maxlen;
+            break;
+
+        default:
+            break;
+        }
+    } else {
+        node->desc.prop_tp = PROP_BOOL;
+    }
+    dp_parse_range_free(p);
+
+    p->node[p->num++] = *node;
+    memset(node, 0, sizeof(*node));
+
+    return OPRT_OK;
+}
+
+static int dp_parse_int(const char *tok)
+{
+    return (int)strtol(tok, NULL, 10);
+}
+
+static OPERATE_RET dp_parse_node_field(dp_schema_parser_t *p, bool is_str)
+{
+    dp_desc_t *desc = &p->cur.desc;
+    const char *v = is_str ? p->tok : "";
+
+    if (!strcmp(p->key, "id")) {
+        desc->id = dp_parse_int(p->tok);
+        p->seen |= DP_PARSE_ID;
+    } else if (!strcmp(p->key, "mode")) {
+        if (!strcmp(v, "rw")) {
+            desc->mode = M_RW;
+        } else if (!strcmp(v, "ro")) {
+            desc->mode = M_RO;
+        } else {
+            desc->mode = M_WR;
+        }
+        p->seen |= DP_PARSE_MODE;
+    } else if (!strcmp(p->key, "passive")) {
+        // passive processing is disabled first. The default value is false
+        p->preprocess = TRUE;
+    } else if (!strcmp(p->key, "trigger")) {
+        desc->trig = strcmp(v, "pulse") ? TRIG_DIRECT : TRIG_PULSE;
+    } else if (!strcmp(p->key, "route")) {
+        int route = is_str ? 0 : dp_parse_int(p->tok);
+        desc->route_t = (2 == route) ? ROUTE_FORCE_BT : (1 == route) ? ROUTE_BLE_FIRST : ROUTE_DEFAULT;
+    } else if (!strcmp(p->key, "stat")) {
+        desc->stat = strcmp(v, "total") ? DST_INC : DST_TOTAL;
+    } else if (!strcmp(p->key, "type")) {
+        if (!strcmp(v, "obj")) {
+            desc->type = T_OBJ;
+        } else if (!strcmp(v, "raw")) {
+            desc->type = T_RAW;
+        } else {
+            desc->type = T_FILE;
+        }
+    }
+
+    return OPRT_OK;
+}
+
+static OPERATE_RET dp_parse_prop_field(dp_schema_parser_t *p, bool is_str)
+{
+    if (!strcmp(p->key, "type")) {
+        static const char *types[] = {"bool", "value", "string", "enum", "bitmap"};
+        int i;
+        for (i = 0; i < CNTSOF(types); i++) {
+            if (is_str && !strcmp(p->tok, types[i])) {
+                break;
             }
-            prop->prop_enum.cnt = num;
-            for (i = 0; i < num; i++) {
-                cJSON *c_child = cJSON_GetArrayItem(child, i);
-                if (NULL == c_child) {
-                    PR_ERR("get array null");
-                    op_ret = OPRT_CJSON_GET_ERR;
-                    goto __exit;
-                }
-                prop->prop_enum.pp_enum[i] = mm_strdup(c_child->valuestring);
-                if (NULL == prop->prop_enum.pp_enum[i]) {
-                    PR_ERR("malloc fail");
-                    op_ret = OPRT_MALLOC_FAILED;
-                    goto __exit;
-                }
+        }
+        p->cur.desc.prop_tp = i; // same order as PROP_BOOL..PROP_BITMAP
+        p->seen |= DP_PARSE_PROP_TP;
+        if (i >= CNTSOF(types)) {
+            p->seen |= DP_PARSE_PROP_ERR;
+        }
+    } else if (!strcmp(p->key, "max")) {
+        p->max = dp_parse_int(p->tok);
+        p->seen |= DP_PARSE_MAX;
+    } else if (!strcmp(p->key, "min")) {
+        p->min = dp_parse_int(p->tok);
+        p->seen |= DP_PARSE_MIN;
+    } else if (!strcmp(p->key, "scale")) {
+        p->scale = dp_parse_int(p->tok);
+    } else if (!strcmp(p->key, "maxlen")) {
+        p->maxlen = dp_parse_int(p->tok);
+        p->seen |= DP_PARSE_MAXLEN;
+    }
+
+    return OPRT_OK;
+}
+
+static OPERATE_RET dp_parse_range_item(dp_schema_parser_t *p, bool is_str)
+{
+    if (!is_str) {
+        PR_ERR("enum item not string");
+        return OPRT_SVC_DEVOS_SCMA_INVALID;
+    }
+    char **grown = tal_realloc(p->range, (p->range_cnt + 1) * sizeof(char *));
+    if (NULL == grown) {
+        return OPRT_MALLOC_FAILED;
+    }
+    p->range = grown;
+    p->range[p->range_cnt] = mm_strdup(p->tok);
+    if (NULL == p->range[p->range_cnt]) {
+        return OPRT_MALLOC_FAILED;
+    }
+    p->range_cnt++;
+
+    return OPRT_OK;
+}
+
+static OPERATE_RET dp_parse_scalar(dp_schema_parser_t *p, bool is_str)
+{
+    p->tok[p->toklen] = 0;
+    if (p->is_key) {
+        if (p->toklen > DP_SCHEMA_KEY_MAX) {
+            p->key[0] = 0; // no key of interest is that long
+        } else {
+            memcpy(p->key, p->tok, p->toklen + 1);
+        }
+        return OPRT_OK;
+    }
+    if (0 == p->depth) {
+        return OPRT_CJSON_PARSE_ERR;
+    }
+
+    switch (p->ctx[p->depth - 1]) {
+    case CTX_NODE:
+        return dp_parse_node_field(p, is_str);
+    case CTX_PROP:
+        return dp_parse_prop_field(p, is_str);
+    case CTX_RANGE:
+        return dp_parse_range_item(p, is_str);
+    case CTX_TOP:
+        return OPRT_SVC_DEVOS_SCMA_INVALID;
+    default:
+        return OPRT_OK;
+    }
+}
+
+static OPERATE_RET dp_parse_open(dp_schema_parser_t *p, bool is_obj)
+{
+    uint8_t ctx = CTX_SKIP;
+
+    if (p->depth >= DP_SCHEMA_DEPTH_MAX || (p->depth && (p->obj_mask & (1 << (p->depth - 1))) && p->expect_key)) {
+        return OPRT_CJSON_PARSE_ERR;
+    }
+    if (0 == p->depth) {
+        ctx = is_obj ? CTX_NODE : CTX_TOP;
+    } else {
+        switch (p->ctx[p->depth - 1]) {
+        case CTX_TOP:
+            if (!is_obj) {
+                return OPRT_SVC_DEVOS_SCMA_INVALID;
             }
-        } else if (!strcmp(child->valuestring, "bitmap")) {
-            dp_desc->prop_tp = PROP_BITMAP;
-            child = cJSON_GetObjectItem(item, "maxlen");
-            if (NULL == child) {
-                PR_ERR("get maxlen null");
-                op_ret = OPRT_CJSON_GET_ERR;
-                goto __exit;
+            ctx = CTX_NODE;
+            break;
+        case CTX_NODE:
+            if (is_obj && !strcmp(p->key, "property")) {
+                ctx = CTX_PROP;
+                p->seen |= DP_PARSE_PROP;
+            }
+            break;
+        case CTX_PROP:
+            if (!is_obj && !strcmp(p->key, "range")) {
+                ctx = CTX_RANGE;
             }
+            break;
+        case CTX_RANGE:
+            return OPRT_SVC_DEVOS_SCMA_INVALID;
+        default:
+            break;
+        }
+    }
+    if (CTX_NODE == ctx) {
+        dp_parse_node_begin(p);
+    }
+    p->ctx[p->depth] = ctx;
+    if (is_obj) {
+        p->obj_mask |= (1 << p->depth);
+    } else {
+        p->obj_mask &= ~(1 << p->depth);
+    }
+    p->depth++;
+    p->expect_key = is_obj;
+
+    return OPRT_OK;
+}
+
+static OPERATE_RET dp_parse_close(dp_schema_parser_t *p, bool is_obj)
+{
+    if (0 == p->depth || is_obj != !!(p->obj_mask & (1 << (p->depth - 1)))) {
+        return OPRT_CJSON_PARSE_ERR;
+    }
+    p->depth--;
+    p->expect_key = FALSE;
+    if (CTX_NODE == p->ctx[p->depth]) {
+        OPERATE_RET op_ret = dp_parse_node_end(p);
+        if (OPRT_OK != op_ret) {
+            return op_ret;
+        }
+    }
+    if (0 == p->depth) {
+        p->done = TRUE;
+    }
+
+    return OPRT_OK;
+}
+
+static OPERATE_RET dp_parse_tok_put(dp_schema_parser_t *p, char c)
+{
+    if (p->toklen >= DP_SCHEMA_TOKEN_MAX) {
+        PR_ERR("schema token too long");
+        return OPRT_SVC_DEVOS_SCMA_INVALID;
+    }
+    p->tok[p->toklen++] = c;
+
+    return OPRT_OK;
+}
+
+static OPERATE_RET dp_parse_char(dp_schema_parser_t *p, char c)
+{
+    switch (p->lex) {
+    case LEX_STR:
+        if ('\\' == c) {
+            p->lex = LEX_STR_ESC;
+            return OPRT_OK;
+        }
+        if ('"' == c) {
+            p->lex = LEX_VALUE;
+            return dp_parse_scalar(p, TRUE);
+        }
+        return dp_parse_tok_put(p, c);
+
+    case LEX_STR_ESC:
+        p->lex = LEX_STR;
+        switch (c) {
+        case 'b':
+            return dp_parse_tok_put(p, '\b');
+        case 'f':
+            return dp_parse_tok_put(p, '\f');
+        case 'n':
+            return dp_parse_tok_put(p, '\n');
+        case 'r':
+            return dp_parse_tok_put(p, '\r');
+        case 't':
+            return dp_parse_tok_put(p, '\t');
+        case 'u':
+            p->lex = LEX_STR_U;
+            p->u_left = 4;
+            p->u_code = 0;
+            return OPRT_OK;
+        default:
+            return dp_parse_tok_put(p, c);
+        }
 
-            prop->prop_bitmap.max_len = child->valueint;
+    case LEX_STR_U: {
+        OPERATE_RET op_ret = OPRT_OK;
+        uint8_t h;
+        if (c >= '0' && c <= '9') {
+            h = c - '0';
+        } else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+            h = (c | 0x20) - 'a' + 10;
         } else {
-            op_ret = OPRT_SVC_DEVOS_SCMA_INVALID;
-            goto __exit;
+            return OPRT_CJSON_PARSE_ERR;
         }
+        p->u_code = (p->u_code << 4) | h;
+        if (--p->u_left) {
+            return OPRT_OK;
+        }
+        p->lex = LEX_STR;
+        // utf-8 of the code unit, surrogate pairs are kept as two units
+        char utf8[3];
+        uint8_t n = 0, k;
+        if (p->u_code < 0x80) {
+            utf8[n++] = (char)p->u_code;
+        } else if (p->u_code < 0x800) {
+            utf8[n++] = (char)(0xC0 | (p->u_code >> 6));
+            utf8[n++] = (char)(0x80 | (p->u_code & 0x3F));
+        } else {
+            utf8[n++] = (char)(0xE0 | (p->u_code >> 12));
+            utf8[n++] = (char)(0x80 | ((p->u_code >> 6) & 0x3F));
+            utf8[n++] = (char)(0x80 | (p->u_code & 0x3F));
+        }
+        for (k = 0; k < n && OPRT_OK == op_ret; k++) {
+            op_ret = dp_parse_tok_put(p, utf8[k]);
+        }
+        return op_ret;
+    }
 
-        cJSON_Delete(cjson);
-        cjson = NULL;
+    case LEX_LIT: {
+        if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || '-' == c || '+' == c ||
+            '.' == c) {
+            return dp_parse_tok_put(p, c);
+        }
+        p->lex = LEX_VALUE;
+        OPERATE_RET op_ret = dp_parse_scalar(p, FALSE);
+        if (OPRT_OK != op_ret) {
+            return op_ret;
+        }
+        break; // the delimiter is handled below
     }
 
-    tal_free(pBuf);
+    default:
+        break;
+    }
+
+    switch (c) {
+    case ' ':
+    case '\t':
+    case '\r':
+    case '\n':
+        return OPRT_OK;
+    case '{':
+    case '[':
+        return dp_parse_open(p, '{' == c);
+    case '}':
+    case ']':
+        return dp_parse_close(p, '}' == c);
+    case ',':
+        p->expect_key = p->depth && (p->obj_mask & (1 << (p->depth - 1)));
+        return OPRT_OK;
+    case ':':
+        p->expect_key = FALSE;
+        return OPRT_OK;
+    case '"':
+        p->lex = LEX_STR;
+        p->toklen = 0;
+        p->is_key = p->expect_key;
+        return OPRT_OK;
+    default:
+        if (p->expect_key) {
+            return OPRT_CJSON_PARSE_ERR;
+        }
+        p->lex = LEX_LIT;
+        p->toklen = 0;
+        p->is_key = FALSE;
+        return dp_parse_tok_put(p, c);
+    }
+}
+
+int dp_schema_parser_create(dp_schema_parser_t **parser)
+{
+    if (NULL == parser) {
+        return OPRT_INVALID_PARM;
+    }
+    *parser = tal_malloc(sizeof(dp_schema_parser_t));
+    if (NULL == *parser) {
+        return OPRT_MALLOC_FAILED;
+    }
+    memset(*parser, 0, sizeof(dp_schema_parser_t));
 
     return OPRT_OK;
+}
+
+int dp_schema_parser_feed(dp_schema_parser_t *parser, const char *data, size_t len)
+{
+    size_t i;
 
-__exit:
-    if (pBuf) {
-        tal_free(pBuf);
+    if (NULL == parser || (NULL == data && len)) {
+        return OPRT_INVALID_PARM;
+    }
+    for (i = 0; i < len && OPRT_OK == parser->err; i++) {
+        if (parser->done && LEX_VALUE == parser->lex) {
+            break; // trailing data after the schema
+        }
+        parser->err = dp_parse_char(parser, data[i]);
     }
 
-    if (cjson) {
-        cJSON_Delete(cjson);
+    return parser->err;
+}
+
+void dp_schema_parser_free(dp_schema_parser_t *parser)
+{
+    int i;
+
+    if (NULL == parser) {
+        return;
+    }
+    dp_parse_range_free(parser);
+    for (i = 0; i < parser->num; i++) {
+        dp_node_release(&parser->node[i]);
     }
+    tal_free(parser->node);
+    tal_free(parser);
+}
 
-    return op_ret;
+int dp_schema_parser_finish(dp_schema_parser_t *parser, char *devid, dp_schema_t **dp_schema_out)
+{
+    OPERATE_RET op_ret = OPRT_OK;
+    dp_schema_t *dp_schema = NULL;
+
+    if (NULL == parser || NULL == devid) {
+        dp_schema_parser_free(parser);
+        return OPRT_INVALID_PARM;
+    }
+    // a number as the last token has no delimiter yet
+    if (OPRT_OK == parser->err && LEX_LIT == parser->lex) {
+        dp_schema_parser_feed(parser, " ", 1);
+    }
+    op_ret = parser->err;
+    if (OPRT_OK == op_ret && (!parser->done || 0 == parser->num)) {
+        PR_ERR("dp num parse err:%d", parser->num);
+        op_ret = parser->done ? OPRT_SVC_DEVOS_DEV_DP_CNT_INVALID : OPRT_CJSON_PARSE_ERR;
+    }
+    if (OPRT_OK == op_ret) {
+        dp_schema = dp_schema_alloc(parser->num);
+        if (NULL == dp_schema) {
+            op_ret = OPRT_MALLOC_FAILED;
+        }
+    }
+    if (OPRT_OK != op_ret) {
+        dp_schema_parser_free(parser);
+        return op_ret;
+    }
+
+    memcpy(dp_schema->node, parser->node, parser->num * sizeof(dp_node_t));
+    dp_schema_install(dp_schema, devid, parser->preprocess, dp_schema_out);
+    parser->num = 0; // the nodes belong to the schema now
+    dp_schema_parser_free(parser);
+    PR_DEBUG("create dp_schema Success ");
+
+    return OPRT_OK;
 }
 
 /**
@@ -1523,65 +2019,267 @@ __exit:
 int dp_schema_create(char *devid, char *schema_json, dp_schema_t **dp_schema_out)
 {
     OPERATE_RET op_ret = OPRT_OK;
-    dp_node_pos_t *nodepos = NULL;
-    int nodenum;
+    dp_schema_parser_t *parser = NULL;
 
-    nodepos = tal_malloc(sizeof(dp_node_pos_t) * 255);
-    if (NULL == nodepos) {
-        PR_ERR("malloc fail");
-        return OPRT_MALLOC_FAILED;
+    if (NULL == devid || NULL == schema_json) {
+        return OPRT_INVALID_PARM;
     }
     PR_DEBUG("devid %s, schema_json %s", devid, schema_json);
 
-    nodenum = dp_node_pos_decode(schema_json, nodepos, 255);
-    if (0 == nodenum || nodenum >= 255) {
-        PR_ERR("dp num parse err:%d", nodenum);
-        tal_free(nodepos);
-        return OPRT_SVC_DEVOS_DEV_DP_CNT_INVALID;
+    op_ret = dp_schema_parser_create(&parser);
+    if (OPRT_OK != op_ret) {
+        return op_ret;
     }
-    dp_schema_t *dp_schema = (dp_schema_t *)tal_malloc(sizeof(dp_schema_t) + nodenum * sizeof(dp_node_t));
-    if (NULL == dp_schema) {
-        tal_free(nodepos);
-        PR_ERR("malloc fail:%d", nodenum);
-        return OPRT_MALLOC_FAILED;
+    dp_schema_parser_feed(parser, schema_json, strlen(schema_json));
+
+    return dp_schema_parser_finish(parser, devid, dp_schema_out);
+}
+
+/*
+ * Binary schema, all numbers big endian:
+ *   'S' version num preprocess
+ *   per node: id mode passive type prop_tp trig stat route, then for obj dps
+ *     value:  max(4) min(4) scale(2)
+ *     string: maxlen(4)
+ *     enum:   cnt(1), per item len(1) and the bytes
+ *     bitmap: maxlen(4)
+ */
+#define DP_SCHEMA_BIN_MAGIC   'S'
+#define DP_SCHEMA_BIN_VERSION 1
+
+typedef struct {
+    uint8_t *buf; // NULL to only count
+    const uint8_t *rbuf;
+    size_t size;
+    size_t pos;
+} dp_bin_cur_t;
+
+static void dp_bin_put(dp_bin_cur_t *c, uint32_t v, uint8_t n)
+{
+    while (n--) {
+        if (c->buf) {
+            c->buf[c->pos] = (uint8_t)(v >> (8 * n));
+        }
+        c->pos++;
     }
-    memset(dp_schema, 0, sizeof(dp_schema_t) + nodenum * sizeof(dp_node_t));
-    op_ret = tal_mutex_create_init(&(dp_schema->mutex));
-    if (OPRT_OK != op_ret) {
-        PR_ERR("mutex create fail:%d", op_ret);
-        goto __exit;
+}
+
+static bool dp_bin_get(dp_bin_cur_t *c, uint32_t *v, uint8_t n)
+{
+    if (c->size - c->pos < n) {
+        return FALSE;
     }
-    dp_schema->num = nodenum;
-    // dp schema parse
-    SCHEMA_OTHER_ATTR_S other_attr;
-    memset(&other_attr, 0, sizeof(other_attr));
-    tal_mutex_lock(dp_schema->mutex);
-    op_ret = dp_node_parse(schema_json, nodepos, nodenum, dp_schema->node, &other_attr);
-    tal_mutex_unlock(dp_schema->mutex);
-    if (OPRT_OK != op_ret) {
-        PR_ERR("dp_node_parse fail:%d", op_ret);
-        goto __exit;
+    *v = 0;
+    while (n--) {
+        *v = (*v << 8) | c->rbuf[c->pos++];
     }
-    dp_schema->actv.preprocess = other_attr.preprocess;
-    dp_schema->actv.attach_dp_if = TRUE;
-    strncpy(dp_schema->devid, devid, DEV_ID_LEN);
-    if (dp_schema_out) {
-        *dp_schema_out = dp_schema;
+
+    return TRUE;
+}
+
+static OPERATE_RET dp_schema_bin_write(dp_schema_t *schema, dp_bin_cur_t *c)
+{
+    int i, j;
+
+    dp_bin_put(c, DP_SCHEMA_BIN_MAGIC, 1);
+    dp_bin_put(c, DP_SCHEMA_BIN_VERSION, 1);
+    dp_bin_put(c, schema->num, 1);
+    dp_bin_put(c, schema->actv.preprocess, 1);
+    for (i = 0; i < schema->num; i++) {
+        dp_desc_t *desc = &schema->node[i].desc;
+        dp_prop_vaule_t *prop = &schema->node[i].prop;
+
+        dp_bin_put(c, desc->id, 1);
+        dp_bin_put(c, desc->mode, 1);
+        dp_bin_put(c, desc->passive, 1);
+        dp_bin_put(c, desc->type, 1);
+        dp_bin_put(c, desc->prop_tp, 1);
+        dp_bin_put(c, desc->trig, 1);
+        dp_bin_put(c, desc->stat, 1);
+        dp_bin_put(c, desc->route_t, 1);
+        if (T_OBJ != desc->type) {
+            continue;
+        }
+        switch (desc->prop_tp) {
+        case PROP_VALUE:
+            dp_bin_put(c, (uint32_t)prop->prop_int.max, 4);
+            dp_bin_put(c, (uint32_t)prop->prop_int.min, 4);
+            dp_bin_put(c, prop->prop_int.scale, 2);
+            break;
+
+        case PROP_STR:
+            dp_bin_put(c, (uint32_t)prop->prop_str.max_len, 4);
+            break;
+
+        case PROP_ENUM:
+            if (prop->prop_enum.cnt > 0xFF) {
+                return OPRT_NOT_SUPPORTED;
+            }
+            dp_bin_put(c, prop->prop_enum.cnt, 1);
+            for (j = 0; j < prop->prop_enum.cnt; j++) {
+                size_t len = strlen(prop->prop_enum.pp_enum[j]);
+                if (len > 0xFF) {
+                    return OPRT_NOT_SUPPORTED;
+                }
+                dp_bin_put(c, len, 1);
+                if (c->buf) {
+                    memcpy(c->buf + c->pos, prop->prop_enum.pp_enum[j], len);
+                }
+                c->pos += len;
+            }
+            break;
+
+        case PROP_BITMAP:
+            dp_bin_put(c, prop->prop_bitmap.max_len, 4);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return OPRT_OK;
+}
+
+int dp_schema_bin_dump(dp_schema_t *schema, uint8_t **out, size_t *outlen)
+{
+    OPERATE_RET op_ret = OPRT_OK;
+    dp_bin_cur_t c = {0};
+
+    if (NULL == schema || NULL == out || NULL == outlen) {
+        return OPRT_INVALID_PARM;
+    }
+
+    op_ret = dp_schema_bin_write(schema, &c);
+    if (OPRT_OK != op_ret) {
+        return op_ret;
     }
-    if (s_dsmgr.schema_num < DP_SCHEMA_NUM_MAX) {
-        s_dsmgr.schema_list[s_dsmgr.schema_num] = dp_schema;
-        s_dsmgr.schema_num++;
+    c.buf = tal_malloc(c.pos);
+    if (NULL == c.buf) {
+        return OPRT_MALLOC_FAILED;
     }
-    PR_DEBUG("create dp_schema Success ");
-    tal_free(nodepos);
+    c.size = c.pos;
+    c.pos = 0;
+    dp_schema_bin_write(schema, &c);
+
+    *out = c.buf;
+    *outlen = c.size;
 
     return OPRT_OK;
+}
 
-__exit:
-    tal_mutex_release(dp_schema->mutex);
-    tal_free(dp_schema);
-    tal_free(nodepos);
-    return op_ret;
+static OPERATE_RET dp_schema_bin_read(dp_bin_cur_t *c, dp_schema_t *dp_schema)
+{
+    int i, j;
+    uint32_t v, a, b;
+
+    for (i = 0; i < dp_schema->num; i++) {
+        dp_desc_t *desc = &dp_schema->node[i].desc;
+        dp_prop_vaule_t *prop = &dp_schema->node[i].prop;
+
+        if (c->size - c->pos < 8) {
+            return OPRT_SVC_DEVOS_SCMA_INVALID;
+        }
+        desc->id = c->rbuf[c->pos++];
+        desc->mode = c->rbuf[c->pos++];
+        desc->passive = c->rbuf[c->pos++];
+        desc->type = c->rbuf[c->pos++];
+        desc->prop_tp = c->rbuf[c->pos++];
+        desc->trig = c->rbuf[c->pos++];
+        desc->stat = c->rbuf[c->pos++];
+        desc->route_t = c->rbuf[c->pos++];
+        if (T_OBJ != desc->type) {
+            continue;
+        }
+        switch (desc->prop_tp) {
+        case PROP_BOOL:
+            break;
+
+        case PROP_VALUE:
+            if (!dp_bin_get(c, &a, 4) || !dp_bin_get(c, &b, 4) || !dp_bin_get(c, &v, 2)) {
+                return OPRT_SVC_DEVOS_SCMA_INVALID;
+            }
+            prop->prop_int.max = (int32_t)a;
+            prop->prop_int.min = (int32_t)b;
+            prop->prop_int.scale = v;
+            break;
+
+        case PROP_STR:
+            if (!dp_bin_get(c, &v, 4)) {
+                return OPRT_SVC_DEVOS_SCMA_INVALID;
+            }
+            prop->prop_str.max_len = v;
+            if (OPRT_OK != tal_mutex_create_init(&prop->prop_str.dp_str_mutex)) {
+                return OPRT_CR_MUTEX_ERR;
+            }
+            break;
+
+        case PROP_ENUM:
+            if (!dp_bin_get(c, &v, 1) || 0 == v) {
+                return OPRT_SVC_DEVOS_SCMA_INVALID;
+            }
+            prop->prop_enum.pp_enum = tal_malloc(v * sizeof(char *));
+            if (NULL == prop->prop_enum.pp_enum) {
+                return OPRT_MALLOC_FAILED;
+            }
+            memset(prop->prop_enum.pp_enum, 0, v * sizeof(char *));
+            prop->prop_enum.cnt = v;
+            for (j = 0; j < prop->prop_enum.cnt; j++) {
+                if (!dp_bin_get(c, &v, 1) || c->size - c->pos < v) {
+                    return OPRT_SVC_DEVOS_SCMA_INVALID;
+                }
+                prop->prop_enum.pp_enum[j] = tal_malloc(v + 1);
+                if (NULL == prop->prop_enum.pp_enum[j]) {
+                    return OPRT_MALLOC_FAILED;
+                }
+                memcpy(prop->prop_enum.pp_enum[j], c->rbuf + c->pos, v);
+                prop->prop_enum.pp_enum[j][v] = 0;
+                c->pos += v;
+            }
+            break;
+
+        case PROP_BITMAP:
+            if (!dp_bin_get(c, &v, 4)) {
+                return OPRT_SVC_DEVOS_SCMA_INVALID;
+            }
+            prop->prop_bitmap.max_len = v;
+            break;
+
+        default:
+            return OPRT_SVC_DEVOS_SCMA_INVALID;
+        }
+    }
+
+    return c->pos == c->size ? OPRT_OK : OPRT_SVC_DEVOS_SCMA_INVALID;
+}
+
+int dp_schema_create_from_bin(char *devid, const uint8_t *bin, size_t len, dp_schema_t **dp_schema_out)
+{
+    OPERATE_RET op_ret = OPRT_OK;
+    dp_schema_t *dp_schema = NULL;
+    dp_bin_cur_t c = {0};
+
+    if (NULL == devid || NULL == bin || len < 4 || DP_SCHEMA_BIN_MAGIC != bin[0] ||
+        DP_SCHEMA_BIN_VERSION != bin[1] || 0 == bin[2] || 0xFF == bin[2]) {
+        return OPRT_SVC_DEVOS_SCMA_INVALID;
+    }
+
+    dp_schema = dp_schema_alloc(bin[2]);
+    if (NULL == dp_schema) {
+        return OPRT_MALLOC_FAILED;
+    }
+    c.rbuf = bin;
+    c.size = len;
+    c.pos = 4;
+    op_ret = dp_schema_bin_read(&c, dp_schema);
+    if (OPRT_OK != op_ret) {
+        PR_ERR("schema bin invalid:%d", op_ret);
+        dp_schema_free(dp_schema);
+        return op_ret;
+    }
+    dp_schema_install(dp_schema, devid, bin[3] ? TRUE : FALSE, dp_schema_out);
+
+    return OPRT_OK;
 }
 
 /**
@@ -1606,8 +2304,7 @@ int dp_schema_delete(char *devid)
         }
 
         if (0 == strcmp(devid, dsmgr->schema_list[i]->devid)) {
-            tal_mutex_release(dsmgr->schema_list[i]->mutex);
-            tal_free(dsmgr->schema_list[i]);
+            dp_schema_free(dsmgr->schema_list[i]);
             dsmgr->schema_list[i] = NULL;
             dsmgr->schema_num--;
             return OPRT_OK;
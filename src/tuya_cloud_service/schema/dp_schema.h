@@ -329,8 +329,12 @@ typedef struct {
     dp_prop_actv_t actv;
     /** exclusive access to dp */
     MUTEX_HANDLE mutex;
+    /** hash of devid, see dp_schema_find */
+    uint32_t devid_hash;
     /** count of dp */
     uint8_t num;
+    /** node index + 1 of each dp id, 0 for unknown ids */
+    uint8_t node_idx[256];
     /** dp info */
     dp_node_t node[0];
 } dp_schema_t;
@@ -348,6 +352,7 @@ typedef struct {
 #define DP_REPT_NO_FILTER_FLAG  (1 << 0)
 #define DP_DUMP_STAT_LOCAL_FLAG (1 << 1)
 #define DP_APPEND_HEADER_FLAG   (1 << 2)
+#define DP_REPT_FLUSH_FLAG      (1 << 3) // send the staged dps at once
 
 typedef struct {
     char *devid;
@@ -378,8 +383,26 @@ typedef struct {
     uint8_t dpid[0];
 } dp_rept_valid_t;
 
+/**
+ * @brief Streaming JSON writer into a caller buffer.
+ *
+ * Writes past size are dropped but still counted in len, so a writer with a
+ * NULL buffer measures the output and a second pass fills an exact buffer.
+ */
+typedef struct {
+    char *buf;
+    uint32_t size;
+    uint32_t len;
+    bool first;
+} dp_json_writer_t;
+
 typedef void (*dp_recv_cb_t)(dp_type_t type, void *dp_data, void *user_data);
 
+/**
+ * @brief Streaming schema parser, see dp_schema_parser_feed.
+ */
+typedef struct dp_schema_parser dp_schema_parser_t;
+
 /**
  * @brief Finds a DP node in the given schema based on the ID.
  *
@@ -404,6 +427,18 @@ dp_node_t *dp_node_find(dp_schema_t *schema, int id);
  */
 dp_node_t *dp_node_find_by_devid(char *devid, int id);
 
+/**
+ * @brief Tells whether every reported value of a DP counts on its own.
+ *
+ * Record DPs have their own time stamp, a direct trigger or statistics, a
+ * newer value must not replace an older one that is not sent yet.
+ *
+ * @param schema The DP schema of the device.
+ * @param dp The reported DP.
+ * @return true for record DPs.
+ */
+bool dp_rept_is_record(dp_schema_t *schema, dp_obj_t *dp);
+
 /**
  * @brief Finds the data point schema for a given device ID.
  *
@@ -512,6 +547,72 @@ int dp_rept_json_append(dp_schema_t *schema, char *data, char *time, char *type,
  * @return Returns 0 on success, or a negative error code on failure.
  */
 int dp_schema_create(char *devid, char *schema_json, dp_schema_t **dp_schema_out);
+
+/**
+ * @brief Creates a parser that builds a schema from JSON fed in chunks.
+ *
+ * Besides the parsed nodes the parser holds only the current token, so the
+ * schema JSON does not need to be resident as a whole. String tokens,
+ * enum items included, are limited to DP_SCHEMA_TOKEN_MAX bytes.
+ *
+ * @param parser Receives the parser.
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+int dp_schema_parser_create(dp_schema_parser_t **parser);
+
+/**
+ * @brief Feeds the next chunk of the schema JSON.
+ *
+ * @param parser The parser.
+ * @param data The chunk, it may split tokens anywhere.
+ * @param len The length of the chunk.
+ * @return OPRT_OK on success, or the first parse error, which every later call
+ * returns as well.
+ */
+int dp_schema_parser_feed(dp_schema_parser_t *parser, const char *data, size_t len);
+
+/**
+ * @brief Ends the input, creates the schema and frees the parser.
+ *
+ * @param parser The parser, freed in any case.
+ * @param devid The device ID for which the schema is being created.
+ * @param dp_schema_out Receives the created schema, may be NULL.
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+int dp_schema_parser_finish(dp_schema_parser_t *parser, char *devid, dp_schema_t **dp_schema_out);
+
+/**
+ * @brief Frees a parser without creating a schema.
+ *
+ * @param parser The parser.
+ */
+void dp_schema_parser_free(dp_schema_parser_t *parser);
+
+/**
+ * @brief Creates a data point schema from its binary form.
+ *
+ * The binary form is made by dp_schema_bin_dump() and skips the JSON parsing
+ * of dp_schema_create(), firmware that cannot read it falls back to the JSON.
+ *
+ * @param devid The device ID for which the schema is being created.
+ * @param bin The binary schema.
+ * @param len The length of bin.
+ * @param dp_schema_out Receives the created schema, may be NULL.
+ * @return OPRT_OK on success, OPRT_SVC_DEVOS_SCMA_INVALID for a binary form of
+ * another version or a damaged one, or another error code on failure.
+ */
+int dp_schema_create_from_bin(char *devid, const uint8_t *bin, size_t len, dp_schema_t **dp_schema_out);
+
+/**
+ * @brief Dumps a schema in the binary form read by dp_schema_create_from_bin().
+ *
+ * @param schema The schema.
+ * @param out Receives the binary form, to be freed with tal_free().
+ * @param outlen Receives the length of the binary form.
+ * @return OPRT_OK on success, OPRT_NOT_SUPPORTED when an enum does not fit the
+ * binary form, or another error code on failure.
+ */
+int dp_schema_bin_dump(dp_schema_t *schema, uint8_t **out, size_t *outlen);
 /**
  * @brief Deletes the data point schema for a specific device.
  *
@@ -559,6 +660,48 @@ char *dp_obj_dump_all_json(char *devid, int flags);
  */
 int dp_obj_dump_stat_local_json(char *devid, dp_rept_valid_t **outdpvalid, char **outjson, int flags);
 
+/**
+ * @brief Starts a JSON object in a writer.
+ *
+ * @param w The writer.
+ * @param buf The output buffer, NULL to only measure.
+ * @param size The size of buf including the terminator.
+ */
+void dp_json_begin(dp_json_writer_t *w, char *buf, uint32_t size);
+
+/**
+ * @brief Writes the key of a DP, "<id>":, with the separator it needs.
+ */
+void dp_json_key(dp_json_writer_t *w, uint8_t id);
+
+/**
+ * @brief Writes a raw JSON fragment, such as a number or a literal.
+ */
+void dp_json_raw(dp_json_writer_t *w, const char *s, uint32_t n);
+
+/**
+ * @brief Writes a quoted and escaped JSON string.
+ */
+void dp_json_str(dp_json_writer_t *w, const char *s);
+
+/**
+ * @brief Writes a DP as "<id>":<value>.
+ *
+ * @param w The writer.
+ * @param dp The DP, its type selects the encoding.
+ * @param dpnode The schema node of the DP, gives the strings of enums.
+ */
+void dp_json_dp(dp_json_writer_t *w, const dp_obj_t *dp, const dp_node_t *dpnode);
+
+/**
+ * @brief Closes the object and terminates the string.
+ *
+ * @param w The writer.
+ * @return The length of the output without the terminator. The output is
+ * complete only when it is below the buffer size.
+ */
+uint32_t dp_json_end(dp_json_writer_t *w);
+
 #ifdef __cplusplus
 }
 #endif
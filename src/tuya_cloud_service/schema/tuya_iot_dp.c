@@ -20,10 +20,12 @@
 
 #include "dp_schema.h"
 #include "tuya_iot_dp.h"
+#include "tuya_iot_dp_offline.h"
 #include "tal_log.h"
 #include "tuya_lan.h"
 #include "tal_api.h"
 #include "mix_method.h"
+#include "tuya_config_defaults.h"
 
 #ifdef ENABLE_BLUETOOTH
 #include "ble_mgr.h"
@@ -198,22 +200,33 @@ int tuya_iot_dp_parse(tuya_iot_client_t *client, dp_cmd_type_t cmd_tp, cJSON *cm
     return tal_workq_schedule(WORKQ_HIGHTPRI, tuya_iot_dp_parse_on_worq, msg);
 }
 
-/**
- * @brief Reports device object data to the Tuya IoT cloud service.
- *
- * This function is used to report the device object data to the Tuya IoT cloud
- * service.
- *
- * @param client The Tuya IoT client instance.
- * @param devid The device ID.
- * @param dps An array of device object data.
- * @param dpscnt The number of device object data elements in the array.
- * @param flags Additional flags for the report.
- *
- * @return The result of the operation. Returns 0 on success, or a negative
- * error code on failure.
- */
-int tuya_iot_dp_obj_report(tuya_iot_client_t *client, const char *devid, dp_obj_t *dps, uint16_t dpscnt, int flags)
+static void dp_offline_push_valid(tuya_iot_client_t *client, const char *devid, dp_rept_in_t *dpin,
+                                  dp_rept_valid_t *dpvalid)
+{
+    uint16_t num = 0;
+    dp_obj_t *dps = tal_malloc(sizeof(dp_obj_t) * dpvalid->num);
+    if (NULL == dps) {
+        return;
+    }
+
+    for (int i = 0; i < dpvalid->num; i++) {
+        for (int j = 0; j < dpin->dpscnt; j++) {
+            if (dpvalid->dpid[i] == dpin->dps[j].id) {
+                dps[num++] = dpin->dps[j];
+                break;
+            }
+        }
+    }
+
+    int ret = tuya_iot_dp_offline_push(client, devid, dps, num);
+    if (OPRT_OK != ret && OPRT_NOT_SUPPORTED != ret) {
+        PR_ERR("dp offline push failed %d", ret);
+    }
+    tal_free(dps);
+}
+
+static int dp_obj_report_direct(tuya_iot_client_t *client, const char *devid, dp_obj_t *dps, uint16_t dpscnt,
+                                int flags)
 {
     int ret = OPRT_OK;
 
@@ -264,7 +277,7 @@ int tuya_iot_dp_obj_report(tuya_iot_client_t *client, const char *devid, dp_obj_
         ble_dpin->flags = flags;
         ble_dpin->rept_type = T_OBJ_REPT;
         ble_dpin->dpscnt = dpvalid->num;
-        ble_dpin->dps = (dp_obj_t *)(ble_dpin + sizeof(dp_rept_in_t));
+        ble_dpin->dps = (dp_obj_t *)(ble_dpin + 1);
         //! copy vaild dpid
         int i, j;
         for (i = 0; i < dpvalid->num; i++) {
@@ -306,8 +319,14 @@ int tuya_iot_dp_obj_report(tuya_iot_client_t *client, const char *devid, dp_obj_
     } else if (tuya_iot_is_connected()) {
         PR_DEBUG("mqtt channel report");
         ret = tuya_iot_dp_report_json_with_notify(client, dpout.dpsjson, NULL, dp_sync_cb, dpvalid, 5000);
+        if (OPRT_OK != ret) {
+            dp_offline_push_valid(client, devid, &dpin, dpvalid);
+            tal_free(dpvalid);
+        }
     } else {
         PR_ERR("no channel for connect");
+        dp_offline_push_valid(client, devid, &dpin, dpvalid);
+        tal_free(dpvalid);
     }
 
     if (dpout.dpsjson) {
@@ -320,6 +339,470 @@ int tuya_iot_dp_obj_report(tuya_iot_client_t *client, const char *devid, dp_obj_
     return ret;
 }
 
+/**
+ * @brief Report coalescing.
+ *
+ * Reported dps are staged per schema for a window and go out together in one
+ * message. A newer value of a staged dp replaces the older one, except for
+ * record dps (direct trigger, statistics or own time stamp) where every value
+ * counts: a second value of one of them sends the staged ones first.
+ */
+typedef struct {
+    dp_obj_t dp;
+    SYS_TIME_T hold; // throttled until, 0 for none
+} dp_stage_t;
+
+typedef struct dp_batch_s {
+    struct dp_batch_s *next;
+    dp_schema_t *schema;
+    int flags;
+    SYS_TIME_T deadline; // end of the window, 0 for none open
+    uint16_t num;
+    uint16_t max;
+    dp_stage_t dps[0];
+} dp_batch_t;
+
+typedef struct dp_msg_s {
+    struct dp_msg_s *next;
+    dp_schema_t *schema;
+    int flags;
+    uint16_t num;
+    dp_obj_t dps[0];
+} dp_msg_t;
+
+typedef struct {
+    uint8_t id;
+    dp_rept_policy_t policy;
+    SYS_TIME_T last; // last sent
+} dp_policy_node_t;
+
+static struct {
+    MUTEX_HANDLE mutex;
+    DELAYED_WORK_HANDLE work;
+    tuya_iot_client_t *client;
+    uint32_t window_ms;
+    dp_batch_t *batch;
+    uint8_t policy_num;
+    dp_policy_node_t policy[DP_REPORT_POLICY_MAX];
+} s_dp_agg = {.window_ms = DP_REPORT_MERGE_WINDOW_MS};
+
+static void dp_agg_flush_process(void *data);
+
+static int dp_agg_init(void)
+{
+    int ret = OPRT_OK;
+
+    if (NULL == s_dp_agg.mutex) {
+        ret = tal_mutex_create_init(&s_dp_agg.mutex);
+        if (OPRT_OK != ret) {
+            return ret;
+        }
+    }
+    if (NULL == s_dp_agg.work) {
+        ret = tal_workq_init_delayed(WORKQ_HIGHTPRI, dp_agg_flush_process, NULL, &s_dp_agg.work);
+    }
+
+    return ret;
+}
+
+static dp_policy_node_t *dp_agg_policy_find(uint8_t id)
+{
+    for (int i = 0; i < s_dp_agg.policy_num; i++) {
+        if (s_dp_agg.policy[i].id == id) {
+            return &s_dp_agg.policy[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void dp_agg_value_free(dp_obj_t *dp)
+{
+    if (PROP_STR == dp->type && dp->value.dp_str) {
+        tal_free(dp->value.dp_str);
+        dp->value.dp_str = NULL;
+    }
+}
+
+static int dp_agg_value_copy(dp_obj_t *dst, dp_obj_t *src)
+{
+    *dst = *src;
+    if (PROP_STR == src->type && src->value.dp_str) {
+        dst->value.dp_str = mm_strdup(src->value.dp_str);
+        if (NULL == dst->value.dp_str) {
+            return OPRT_MALLOC_FAILED;
+        }
+    }
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Moves the staged dps of a batch into a message at the tail of
+ * *tail, the throttled ones stay unless force is set.
+ */
+static void dp_agg_take(dp_batch_t *batch, bool force, SYS_TIME_T now, dp_msg_t ***tail)
+{
+    dp_msg_t *msg = NULL;
+    uint16_t i, keep = 0;
+
+    batch->deadline = 0;
+    if (0 == batch->num) {
+        return;
+    }
+
+    msg = tal_malloc(sizeof(dp_msg_t) + sizeof(dp_obj_t) * batch->num);
+    if (NULL == msg) {
+        PR_ERR("dp merge msg malloc failed");
+        return;
+    }
+    msg->next = NULL;
+    msg->schema = batch->schema;
+    msg->flags = batch->flags;
+    msg->num = 0;
+
+    for (i = 0; i < batch->num; i++) {
+        dp_stage_t *stage = &batch->dps[i];
+        if (!force && stage->hold > now) {
+            batch->dps[keep++] = *stage;
+            continue;
+        }
+
+        dp_policy_node_t *policy = dp_agg_policy_find(stage->dp.id);
+        if (policy) {
+            policy->last = now;
+        }
+        msg->dps[msg->num++] = stage->dp;
+    }
+    batch->num = keep;
+
+    if (0 == msg->num) {
+        tal_free(msg);
+        return;
+    }
+    **tail = msg;
+    *tail = &msg->next;
+}
+
+static void dp_agg_batch_release(dp_batch_t *batch)
+{
+    dp_batch_t **pp = &s_dp_agg.batch;
+
+    while (*pp && *pp != batch) {
+        pp = &(*pp)->next;
+    }
+    if (*pp) {
+        *pp = batch->next;
+    }
+    tal_free(batch);
+}
+
+static void dp_agg_rearm(SYS_TIME_T now)
+{
+    SYS_TIME_T next = 0;
+
+    for (dp_batch_t *batch = s_dp_agg.batch; batch; batch = batch->next) {
+        for (uint16_t i = 0; i < batch->num; i++) {
+            SYS_TIME_T due = batch->dps[i].hold;
+            if (batch->deadline > due) {
+                due = batch->deadline;
+            }
+            if (0 == next || due < next) {
+                next = due;
+            }
+        }
+    }
+
+    if (next) {
+        tal_workq_start_delayed(s_dp_agg.work, next > now ? next - now : 1, LOOP_ONCE);
+    }
+}
+
+static void dp_agg_send(dp_msg_t *msg)
+{
+    while (msg) {
+        dp_msg_t *next = msg->next;
+
+        PR_DEBUG("dp merge report: devid %s, dpscnt %d", msg->schema->devid, msg->num);
+        int ret = dp_obj_report_direct(s_dp_agg.client, msg->schema->devid, msg->dps, msg->num, msg->flags);
+        if (OPRT_OK != ret) {
+            PR_ERR("dp merge report failed %d", ret);
+        }
+        for (uint16_t i = 0; i < msg->num; i++) {
+            dp_agg_value_free(&msg->dps[i]);
+        }
+        tal_free(msg);
+        msg = next;
+    }
+}
+
+static void dp_agg_flush_process(void *data)
+{
+    dp_msg_t *msg = NULL, **tail = &msg;
+    SYS_TIME_T now = tal_system_get_millisecond();
+
+    tal_mutex_lock(s_dp_agg.mutex);
+    dp_batch_t *batch = s_dp_agg.batch;
+    while (batch) {
+        dp_batch_t *next = batch->next;
+        if (batch->deadline <= now) {
+            dp_agg_take(batch, false, now, &tail);
+        }
+        if (0 == batch->num) {
+            dp_agg_batch_release(batch);
+        }
+        batch = next;
+    }
+    dp_agg_rearm(now);
+    tal_mutex_unlock(s_dp_agg.mutex);
+
+    dp_agg_send(msg);
+}
+
+static bool dp_agg_is_enabled(dp_obj_t *dps, uint16_t dpscnt)
+{
+    if (s_dp_agg.window_ms || s_dp_agg.batch) {
+        return true;
+    }
+    for (uint16_t i = 0; i < dpscnt; i++) {
+        if (dp_agg_policy_find(dps[i].id)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static int dp_agg_stage(dp_schema_t *schema, dp_obj_t *dps, uint16_t dpscnt, int flags)
+{
+    int ret = OPRT_OK;
+    bool flush = (flags & DP_REPT_FLUSH_FLAG) ? true : false;
+    dp_msg_t *msg = NULL, **tail = &msg;
+    SYS_TIME_T now = tal_system_get_millisecond();
+
+    flags &= ~DP_REPT_FLUSH_FLAG;
+
+    tal_mutex_lock(s_dp_agg.mutex);
+
+    dp_batch_t *batch = s_dp_agg.batch;
+    while (batch && batch->schema != schema) {
+        batch = batch->next;
+    }
+    if (NULL == batch) {
+        uint16_t max = schema->num ? schema->num : MAX_DP_NUM;
+        batch = tal_malloc(sizeof(dp_batch_t) + sizeof(dp_stage_t) * max);
+        if (NULL == batch) {
+            tal_mutex_unlock(s_dp_agg.mutex);
+            return OPRT_MALLOC_FAILED;
+        }
+        memset(batch, 0, sizeof(dp_batch_t));
+        batch->schema = schema;
+        batch->flags = flags;
+        batch->max = max;
+        batch->next = s_dp_agg.batch;
+        s_dp_agg.batch = batch;
+    }
+
+    //! flags apply to a whole message
+    if (batch->num && batch->flags != flags) {
+        dp_agg_take(batch, true, now, &tail);
+    }
+    batch->flags = flags;
+
+    for (uint16_t i = 0; i < dpscnt; i++) {
+        dp_obj_t *dp = &dps[i];
+        dp_policy_node_t *policy = dp_agg_policy_find(dp->id);
+        bool record = dp_rept_is_record(schema, dp);
+        uint16_t j;
+
+        if (policy && DP_REPT_CRITICAL == policy->policy.mode) {
+            flush = true;
+        }
+
+        for (j = 0; j < batch->num; j++) {
+            if (batch->dps[j].dp.id == dp->id) {
+                break;
+            }
+        }
+        if (j < batch->num && record) {
+            dp_agg_take(batch, false, now, &tail);
+            j = batch->num;
+        }
+        if (j == batch->num && batch->num == batch->max) {
+            dp_agg_take(batch, true, now, &tail);
+            j = 0;
+        }
+
+        dp_stage_t stage;
+        memset(&stage, 0, sizeof(stage));
+        ret = dp_agg_value_copy(&stage.dp, dp);
+        if (OPRT_OK != ret) {
+            break;
+        }
+
+        if (j < batch->num) {
+            //! last write wins, the throttle keeps running
+            stage.hold = batch->dps[j].hold;
+            dp_agg_value_free(&batch->dps[j].dp);
+            batch->dps[j] = stage;
+            continue;
+        }
+
+        if (!record && policy && policy->policy.min_interval_ms && policy->last &&
+            policy->last + policy->policy.min_interval_ms > now) {
+            stage.hold = policy->last + policy->policy.min_interval_ms;
+        }
+        batch->dps[batch->num++] = stage;
+        if (0 == batch->deadline) {
+            batch->deadline = now + s_dp_agg.window_ms;
+        }
+    }
+
+    if (flush || batch->deadline <= now) {
+        dp_agg_take(batch, false, now, &tail);
+    }
+    if (0 == batch->num) {
+        dp_agg_batch_release(batch);
+    }
+    dp_agg_rearm(now);
+
+    tal_mutex_unlock(s_dp_agg.mutex);
+
+    dp_agg_send(msg);
+
+    return ret;
+}
+
+/**
+ * @brief Reports device object data to the Tuya IoT cloud service.
+ *
+ * This function is used to report the device object data to the Tuya IoT cloud
+ * service. While a merge window is set or a policy is set for one of the dps,
+ * the dps are staged and sent later together with others, see
+ * tuya_iot_dp_report_window_set() and tuya_iot_dp_report_policy_set().
+ *
+ * @param client The Tuya IoT client instance.
+ * @param devid The device ID.
+ * @param dps An array of device object data.
+ * @param dpscnt The number of device object data elements in the array.
+ * @param flags Additional flags for the report, DP_REPT_FLUSH_FLAG sends the
+ * staged dps at once.
+ *
+ * @return The result of the operation. Returns 0 on success, or a negative
+ * error code on failure.
+ */
+int tuya_iot_dp_obj_report(tuya_iot_client_t *client, const char *devid, dp_obj_t *dps, uint16_t dpscnt, int flags)
+{
+    if (!client->is_activated) {
+        PR_DEBUG("client no active");
+        return OPRT_COM_ERROR;
+    }
+    if (NULL == dps || 0 == dpscnt) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (!dp_agg_is_enabled(dps, dpscnt)) {
+        return dp_obj_report_direct(client, devid, dps, dpscnt, flags & ~DP_REPT_FLUSH_FLAG);
+    }
+
+    dp_schema_t *schema = dp_schema_find(devid);
+    if (NULL == schema) {
+        return OPRT_INVALID_PARM;
+    }
+
+    int ret = dp_agg_init();
+    if (OPRT_OK != ret) {
+        return ret;
+    }
+    s_dp_agg.client = client;
+
+    return dp_agg_stage(schema, dps, dpscnt, flags);
+}
+
+/**
+ * @brief Sets the window in which reported dps are merged.
+ *
+ * @param window_ms The window in milliseconds, 0 sends every report at once.
+ *
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+int tuya_iot_dp_report_window_set(uint32_t window_ms)
+{
+    int ret = dp_agg_init();
+    if (OPRT_OK != ret) {
+        return ret;
+    }
+
+    tal_mutex_lock(s_dp_agg.mutex);
+    s_dp_agg.window_ms = window_ms;
+    tal_mutex_unlock(s_dp_agg.mutex);
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Sets the report policy of a dp.
+ *
+ * @param id The dp id.
+ * @param policy The policy, NULL to remove it.
+ *
+ * @return OPRT_OK on success, OPRT_EXCEED_UPPER_LIMIT when
+ * DP_REPORT_POLICY_MAX dps have a policy, or another error code on failure.
+ */
+int tuya_iot_dp_report_policy_set(uint8_t id, const dp_rept_policy_t *policy)
+{
+    int ret = dp_agg_init();
+    if (OPRT_OK != ret) {
+        return ret;
+    }
+
+    tal_mutex_lock(s_dp_agg.mutex);
+    dp_policy_node_t *node = dp_agg_policy_find(id);
+    if (NULL == policy) {
+        if (node) {
+            *node = s_dp_agg.policy[--s_dp_agg.policy_num];
+        }
+    } else if (node) {
+        node->policy = *policy;
+    } else if (s_dp_agg.policy_num < DP_REPORT_POLICY_MAX) {
+        node = &s_dp_agg.policy[s_dp_agg.policy_num++];
+        memset(node, 0, sizeof(dp_policy_node_t));
+        node->id = id;
+        node->policy = *policy;
+    } else {
+        ret = OPRT_EXCEED_UPPER_LIMIT;
+    }
+    tal_mutex_unlock(s_dp_agg.mutex);
+
+    return ret;
+}
+
+/**
+ * @brief Sends the staged dps of all devices, the throttled ones included.
+ *
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+int tuya_iot_dp_report_flush(void)
+{
+    dp_msg_t *msg = NULL, **tail = &msg;
+    SYS_TIME_T now = tal_system_get_millisecond();
+
+    if (NULL == s_dp_agg.mutex) {
+        return OPRT_OK;
+    }
+
+    tal_mutex_lock(s_dp_agg.mutex);
+    while (s_dp_agg.batch) {
+        dp_agg_take(s_dp_agg.batch, true, now, &tail);
+        dp_agg_batch_release(s_dp_agg.batch);
+    }
+    tal_mutex_unlock(s_dp_agg.mutex);
+
+    dp_agg_send(msg);
+
+    return OPRT_OK;
+}
+
 /**
  * @brief Dumps the object representation of the Tuya IoT data point (DP) for a
  * specific device.
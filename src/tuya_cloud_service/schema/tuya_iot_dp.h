@@ -23,6 +23,24 @@ extern "C" {
 
 #include "tuya_iot.h"
 
+/**
+ * @brief Definition of dp report mode
+ */
+typedef uint8_t dp_rept_mode_t;
+#define DP_REPT_MERGE    0 // staged for the merge window
+#define DP_REPT_CRITICAL 1 // sends the staged dps at once
+
+/**
+ * @brief Definition of dp report policy
+ */
+typedef struct {
+    /** see dp_rept_mode_t */
+    dp_rept_mode_t mode;
+    /** sent at most once per interval, the latest value wins, 0 for no limit.
+     * Not applied to record dps, whose every value is sent */
+    uint32_t min_interval_ms;
+} dp_rept_policy_t;
+
 /**
  * @brief
  *
@@ -76,6 +94,30 @@ int tuya_iot_dp_raw_report(tuya_iot_client_t *client, const char *devid, dp_raw_
  */
 char *tuya_iot_dp_obj_dump(tuya_iot_client_t *client, char *devid, int flags);
 
+/**
+ * @brief Sets the window in which reported object dps are merged.
+ *
+ * @param window_ms window in milliseconds, 0 sends every report at once
+ * @return int
+ */
+int tuya_iot_dp_report_window_set(uint32_t window_ms);
+
+/**
+ * @brief Sets the report policy of a dp, for all devices.
+ *
+ * @param id dp id
+ * @param policy see dp_rept_policy_t, NULL to remove
+ * @return int
+ */
+int tuya_iot_dp_report_policy_set(uint8_t id, const dp_rept_policy_t *policy);
+
+/**
+ * @brief Sends the staged object dps of all devices.
+ *
+ * @return int
+ */
+int tuya_iot_dp_report_flush(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,517 @@
+/**
+ * @file tuya_iot_dp_offline.c
+ * @brief Offline queue of object DP reports, see tuya_iot_dp_offline.h.
+ *
+ * The queue is kept in RAM and written to KV as one value, every entry is
+ * id, type, time stamp and value, a string value with its length in front.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#include "tuya_config_defaults.h"
+#include "tuya_iot_dp_offline.h"
+#include "tal_api.h"
+#include "mix_method.h"
+
+#if DP_OFFLINE_QUEUE_MAX > 0
+
+#define DP_OFFLINE_KEY     "dp_offline"
+#define DP_OFFLINE_VERSION 1
+
+// id, type, time stamp
+#define DP_OFFLINE_ENTRY_HEAD (1 + 1 + 4)
+
+static struct {
+    MUTEX_HANDLE mutex;
+    DELAYED_WORK_HANDLE replay_work;
+    DELAYED_WORK_HANDLE save_work;
+    tuya_iot_client_t *client;
+    bool loaded;
+    uint16_t num;
+    dp_obj_t dps[DP_OFFLINE_QUEUE_MAX];
+    //! replayed, waiting for the ack
+    uint16_t sending_num;
+    bool sending;
+    dp_obj_t sending_dps[DP_OFFLINE_REPLAY_BATCH];
+} s_dpq;
+
+static void dpq_replay_process(void *data);
+static void dpq_save_process(void *data);
+
+static void dpq_value_free(dp_obj_t *dp)
+{
+    if (PROP_STR == dp->type && dp->value.dp_str) {
+        tal_free(dp->value.dp_str);
+        dp->value.dp_str = NULL;
+    }
+}
+
+static uint32_t dpq_value_get(dp_obj_t *dp)
+{
+    switch (dp->type) {
+    case PROP_BOOL:
+        return dp->value.dp_bool ? 1 : 0;
+    case PROP_VALUE:
+        return (uint32_t)dp->value.dp_value;
+    case PROP_ENUM:
+        return dp->value.dp_enum;
+    case PROP_BITMAP:
+        return dp->value.dp_bitmap;
+    default:
+        return 0;
+    }
+}
+
+static void dpq_value_set(dp_obj_t *dp, uint32_t value)
+{
+    switch (dp->type) {
+    case PROP_BOOL:
+        dp->value.dp_bool = value ? true : false;
+        break;
+    case PROP_VALUE:
+        dp->value.dp_value = (int)value;
+        break;
+    case PROP_ENUM:
+        dp->value.dp_enum = value;
+        break;
+    case PROP_BITMAP:
+        dp->value.dp_bitmap = value;
+        break;
+    default:
+        break;
+    }
+}
+
+static void dpq_remove(uint16_t index)
+{
+    dpq_value_free(&s_dpq.dps[index]);
+    memmove(&s_dpq.dps[index], &s_dpq.dps[index + 1], sizeof(dp_obj_t) * (s_dpq.num - index - 1));
+    s_dpq.num--;
+}
+
+/**
+ * Appends an entry that is owned by the queue from now on, the dedup rules
+ * apply against the entries queued already.
+ */
+static void dpq_append(dp_schema_t *schema, dp_obj_t *dp)
+{
+    if (NULL == schema || !dp_rept_is_record(schema, dp)) {
+        for (uint16_t i = 0; i < s_dpq.num; i++) {
+            if (s_dpq.dps[i].id == dp->id) {
+                dpq_remove(i);
+                break;
+            }
+        }
+    }
+    if (s_dpq.num == DP_OFFLINE_QUEUE_MAX) {
+        PR_WARN("dp offline queue full, drop dp %d", s_dpq.dps[0].id);
+        dpq_remove(0);
+    }
+    s_dpq.dps[s_dpq.num++] = *dp;
+}
+
+static void dpq_load(void)
+{
+    uint8_t *buf = NULL;
+    size_t len = 0;
+
+    s_dpq.loaded = true;
+    if (OPRT_OK != tal_kv_get(DP_OFFLINE_KEY, &buf, &len)) {
+        return;
+    }
+
+    size_t offset = 2;
+    if (len < offset || DP_OFFLINE_VERSION != buf[0]) {
+        PR_WARN("dp offline queue invalid");
+        goto __EXIT;
+    }
+
+    for (uint8_t i = 0; i < buf[1] && s_dpq.num < DP_OFFLINE_QUEUE_MAX; i++) {
+        dp_obj_t dp;
+        uint32_t time_stamp = 0, value = 0;
+
+        if (offset + DP_OFFLINE_ENTRY_HEAD > len) {
+            break;
+        }
+        memset(&dp, 0, sizeof(dp));
+        dp.id = buf[offset];
+        dp.type = buf[offset + 1];
+        memcpy(&time_stamp, buf + offset + 2, 4);
+        dp.time_stamp = time_stamp;
+        offset += DP_OFFLINE_ENTRY_HEAD;
+
+        if (PROP_STR == dp.type) {
+            if (offset + 1 > len || offset + 1 + buf[offset] > len) {
+                break;
+            }
+            dp.value.dp_str = tal_malloc(buf[offset] + 1);
+            if (NULL == dp.value.dp_str) {
+                break;
+            }
+            memcpy(dp.value.dp_str, buf + offset + 1, buf[offset]);
+            dp.value.dp_str[buf[offset]] = '\0';
+            offset += 1 + buf[offset];
+        } else {
+            if (offset + 4 > len) {
+                break;
+            }
+            memcpy(&value, buf + offset, 4);
+            dpq_value_set(&dp, value);
+            offset += 4;
+        }
+        s_dpq.dps[s_dpq.num++] = dp;
+    }
+    PR_DEBUG("dp offline queue loaded %d", s_dpq.num);
+
+__EXIT:
+    tal_kv_free(buf);
+}
+
+static int dpq_init(void)
+{
+    int rt = OPRT_OK;
+
+    if (NULL == s_dpq.mutex) {
+        TUYA_CALL_ERR_RETURN(tal_mutex_create_init(&s_dpq.mutex));
+    }
+    if (NULL == s_dpq.replay_work) {
+        TUYA_CALL_ERR_RETURN(tal_workq_init_delayed(WORKQ_HIGHTPRI, dpq_replay_process, NULL, &s_dpq.replay_work));
+    }
+    if (NULL == s_dpq.save_work) {
+        TUYA_CALL_ERR_RETURN(tal_workq_init_delayed(WORKQ_HIGHTPRI, dpq_save_process, NULL, &s_dpq.save_work));
+    }
+
+    tal_mutex_lock(s_dpq.mutex);
+    if (!s_dpq.loaded) {
+        dpq_load();
+    }
+    tal_mutex_unlock(s_dpq.mutex);
+
+    return rt;
+}
+
+static size_t dpq_entry_size(dp_obj_t *dp)
+{
+    if (PROP_STR == dp->type) {
+        return DP_OFFLINE_ENTRY_HEAD + 1 + (dp->value.dp_str ? strlen(dp->value.dp_str) : 0);
+    }
+
+    return DP_OFFLINE_ENTRY_HEAD + 4;
+}
+
+static size_t dpq_entry_write(uint8_t *buf, dp_obj_t *dp)
+{
+    uint32_t time_stamp = dp->time_stamp;
+    size_t offset = DP_OFFLINE_ENTRY_HEAD;
+
+    buf[0] = dp->id;
+    buf[1] = dp->type;
+    memcpy(buf + 2, &time_stamp, 4);
+    if (PROP_STR == dp->type) {
+        uint8_t len = dp->value.dp_str ? strlen(dp->value.dp_str) : 0;
+        buf[offset++] = len;
+        memcpy(buf + offset, dp->value.dp_str, len);
+        offset += len;
+    } else {
+        uint32_t value = dpq_value_get(dp);
+        memcpy(buf + offset, &value, 4);
+        offset += 4;
+    }
+
+    return offset;
+}
+
+static void dpq_save_process(void *data)
+{
+    uint8_t *buf = NULL;
+    size_t len = 2;
+    uint16_t i, num;
+
+    tal_mutex_lock(s_dpq.mutex);
+    //! the ones waiting for the ack are kept as well
+    num = s_dpq.sending_num + s_dpq.num;
+    if (0 == num) {
+        tal_mutex_unlock(s_dpq.mutex);
+        tal_kv_del(DP_OFFLINE_KEY);
+        return;
+    }
+
+    for (i = 0; i < s_dpq.sending_num; i++) {
+        len += dpq_entry_size(&s_dpq.sending_dps[i]);
+    }
+    for (i = 0; i < s_dpq.num; i++) {
+        len += dpq_entry_size(&s_dpq.dps[i]);
+    }
+    buf = tal_malloc(len);
+    if (NULL == buf) {
+        tal_mutex_unlock(s_dpq.mutex);
+        tal_workq_start_delayed(s_dpq.save_work, DP_OFFLINE_SAVE_DELAY_MS, LOOP_ONCE);
+        return;
+    }
+
+    size_t offset = 0;
+    buf[offset++] = DP_OFFLINE_VERSION;
+    buf[offset++] = (uint8_t)num;
+    for (i = 0; i < s_dpq.sending_num; i++) {
+        offset += dpq_entry_write(buf + offset, &s_dpq.sending_dps[i]);
+    }
+    for (i = 0; i < s_dpq.num; i++) {
+        offset += dpq_entry_write(buf + offset, &s_dpq.dps[i]);
+    }
+    tal_mutex_unlock(s_dpq.mutex);
+
+    int ret = tal_kv_set(DP_OFFLINE_KEY, buf, offset);
+    if (OPRT_OK != ret) {
+        PR_ERR("dp offline queue save failed %d", ret);
+    }
+    tal_free(buf);
+}
+
+static void dpq_replay_cb(int result, void *user_data)
+{
+    uint16_t i;
+
+    tal_mutex_lock(s_dpq.mutex);
+    if (OPRT_OK == result) {
+        for (i = 0; i < s_dpq.sending_num; i++) {
+            dpq_value_free(&s_dpq.sending_dps[i]);
+        }
+    } else {
+        //! back to the head, unless newer values have come meanwhile
+        dp_schema_t *schema = s_dpq.client ? dp_schema_find(s_dpq.client->activate.devid) : NULL;
+        dp_obj_t *tail = tal_malloc(sizeof(dp_obj_t) * (s_dpq.num ? s_dpq.num : 1));
+        if (tail) {
+            uint16_t tail_num = s_dpq.num;
+            memcpy(tail, s_dpq.dps, sizeof(dp_obj_t) * tail_num);
+            s_dpq.num = 0;
+            for (i = 0; i < s_dpq.sending_num; i++) {
+                s_dpq.dps[s_dpq.num++] = s_dpq.sending_dps[i];
+            }
+            for (i = 0; i < tail_num; i++) {
+                dpq_append(schema, &tail[i]);
+            }
+            tal_free(tail);
+        } else {
+            for (i = 0; i < s_dpq.sending_num; i++) {
+                dpq_value_free(&s_dpq.sending_dps[i]);
+            }
+        }
+        PR_WARN("dp offline replay failed %d", result);
+    }
+    s_dpq.sending_num = 0;
+    s_dpq.sending = false;
+    uint16_t left = s_dpq.num;
+    tal_mutex_unlock(s_dpq.mutex);
+
+    if (OPRT_OK == result) {
+        tal_workq_start_delayed(s_dpq.save_work, DP_OFFLINE_SAVE_DELAY_MS, LOOP_ONCE);
+    }
+    if (left && tuya_iot_is_connected()) {
+        tal_workq_start_delayed(s_dpq.replay_work, DP_OFFLINE_REPLAY_INTERVAL_MS, LOOP_ONCE);
+    }
+}
+
+static char *dpq_json_output(dp_schema_t *schema, dp_obj_t *dps, uint16_t dpscnt)
+{
+    char key[4];
+    char *out = NULL;
+
+    cJSON *root = cJSON_CreateObject();
+    if (NULL == root) {
+        return NULL;
+    }
+
+    for (uint16_t i = 0; i < dpscnt; i++) {
+        dp_obj_t *dp = &dps[i];
+        dp_node_t *dpnode = dp_node_find(schema, dp->id);
+        if (NULL == dpnode || dp->type != dpnode->desc.prop_tp) {
+            PR_WARN("dp offline %d dropped", dp->id);
+            continue;
+        }
+
+        snprintf(key, sizeof(key), "%d", dp->id);
+        switch (dp->type) {
+        case PROP_BOOL:
+            cJSON_AddBoolToObject(root, key, dp->value.dp_bool);
+            break;
+        case PROP_VALUE:
+            cJSON_AddNumberToObject(root, key, dp->value.dp_value);
+            break;
+        case PROP_BITMAP:
+            cJSON_AddNumberToObject(root, key, dp->value.dp_bitmap);
+            break;
+        case PROP_STR:
+            cJSON_AddStringToObject(root, key, dp->value.dp_str ? dp->value.dp_str : "");
+            break;
+        case PROP_ENUM:
+            if (dp->value.dp_enum < dpnode->prop.prop_enum.cnt) {
+                cJSON_AddStringToObject(root, key, dpnode->prop.prop_enum.pp_enum[dp->value.dp_enum]);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (cJSON_GetArraySize(root)) {
+        out = cJSON_PrintUnformatted(root);
+    }
+    cJSON_Delete(root);
+
+    return out;
+}
+
+static void dpq_replay_process(void *data)
+{
+    tuya_iot_client_t *client = s_dpq.client;
+    uint16_t i, j;
+
+    if (NULL == client || !tuya_iot_is_connected()) {
+        return;
+    }
+
+    dp_schema_t *schema = dp_schema_find(client->activate.devid);
+    if (NULL == schema) {
+        return;
+    }
+
+    tal_mutex_lock(s_dpq.mutex);
+    if (s_dpq.sending || 0 == s_dpq.num) {
+        tal_mutex_unlock(s_dpq.mutex);
+        return;
+    }
+
+    //! one message carries one time stamp and every id once
+    TIME_T time_stamp = s_dpq.dps[0].time_stamp;
+    for (i = 0; i < s_dpq.num && s_dpq.sending_num < DP_OFFLINE_REPLAY_BATCH; i++) {
+        if (s_dpq.dps[i].time_stamp != time_stamp) {
+            break;
+        }
+        for (j = 0; j < s_dpq.sending_num; j++) {
+            if (s_dpq.sending_dps[j].id == s_dpq.dps[i].id) {
+                break;
+            }
+        }
+        if (j < s_dpq.sending_num) {
+            break;
+        }
+        s_dpq.sending_dps[s_dpq.sending_num++] = s_dpq.dps[i];
+    }
+    memmove(&s_dpq.dps[0], &s_dpq.dps[i], sizeof(dp_obj_t) * (s_dpq.num - i));
+    s_dpq.num -= i;
+    s_dpq.sending = true;
+
+    char *dpsjson = dpq_json_output(schema, s_dpq.sending_dps, s_dpq.sending_num);
+    tal_mutex_unlock(s_dpq.mutex);
+
+    if (NULL == dpsjson) {
+        //! nothing left that the schema knows
+        dpq_replay_cb(OPRT_OK, NULL);
+        return;
+    }
+
+    char timestr[16];
+    snprintf(timestr, sizeof(timestr), "%u", (unsigned int)time_stamp);
+    PR_DEBUG("dp offline replay %s t %s", dpsjson, timestr);
+    int ret = tuya_iot_dp_report_json_with_notify(client, dpsjson, timestr, dpq_replay_cb, NULL, 5000);
+    tal_free(dpsjson);
+    if (OPRT_OK != ret) {
+        dpq_replay_cb(ret, NULL);
+    }
+}
+
+int tuya_iot_dp_offline_push(tuya_iot_client_t *client, const char *devid, dp_obj_t *dps, uint16_t dpscnt)
+{
+    int rt = OPRT_OK;
+
+    if (NULL == client || NULL == devid || NULL == dps) {
+        return OPRT_INVALID_PARM;
+    }
+    if (strcmp(devid, client->activate.devid)) {
+        return OPRT_NOT_SUPPORTED;
+    }
+
+    TUYA_CALL_ERR_RETURN(dpq_init());
+
+    dp_schema_t *schema = dp_schema_find(devid);
+    TIME_T now = tal_time_get_posix();
+
+    tal_mutex_lock(s_dpq.mutex);
+    s_dpq.client = client;
+    for (uint16_t i = 0; i < dpscnt; i++) {
+        dp_obj_t dp = dps[i];
+
+        if (PROP_STR == dp.type) {
+            if (dp.value.dp_str && strlen(dp.value.dp_str) > DP_OFFLINE_STR_MAX) {
+                PR_WARN("dp offline %d too long", dp.id);
+                continue;
+            }
+            dp.value.dp_str = mm_strdup(dp.value.dp_str ? dp.value.dp_str : "");
+            if (NULL == dp.value.dp_str) {
+                rt = OPRT_MALLOC_FAILED;
+                break;
+            }
+        }
+        if (0 == dp.time_stamp) {
+            dp.time_stamp = now;
+        }
+        dpq_append(schema, &dp);
+    }
+    tal_mutex_unlock(s_dpq.mutex);
+
+    tal_workq_start_delayed(s_dpq.save_work, DP_OFFLINE_SAVE_DELAY_MS, LOOP_ONCE);
+
+    return rt;
+}
+
+int tuya_iot_dp_offline_replay_start(tuya_iot_client_t *client)
+{
+    int rt = OPRT_OK;
+
+    TUYA_CALL_ERR_RETURN(dpq_init());
+
+    tal_mutex_lock(s_dpq.mutex);
+    s_dpq.client = client;
+    uint16_t num = s_dpq.num;
+    tal_mutex_unlock(s_dpq.mutex);
+
+    if (num) {
+        PR_DEBUG("dp offline replay %d", num);
+        rt = tal_workq_start_delayed(s_dpq.replay_work, DP_OFFLINE_REPLAY_INTERVAL_MS, LOOP_ONCE);
+    }
+
+    return rt;
+}
+
+int tuya_iot_dp_offline_clear(void)
+{
+    if (s_dpq.mutex) {
+        tal_mutex_lock(s_dpq.mutex);
+        while (s_dpq.num) {
+            dpq_remove(s_dpq.num - 1);
+        }
+        tal_mutex_unlock(s_dpq.mutex);
+    }
+
+    return tal_kv_del(DP_OFFLINE_KEY);
+}
+
+#else
+
+int tuya_iot_dp_offline_push(tuya_iot_client_t *client, const char *devid, dp_obj_t *dps, uint16_t dpscnt)
+{
+    return OPRT_NOT_SUPPORTED;
+}
+
+int tuya_iot_dp_offline_replay_start(tuya_iot_client_t *client)
+{
+    return OPRT_OK;
+}
+
+int tuya_iot_dp_offline_clear(void)
+{
+    return OPRT_OK;
+}
+
+#endif
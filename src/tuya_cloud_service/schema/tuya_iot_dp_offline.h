@@ -0,0 +1,60 @@
+/**
+ * @file tuya_iot_dp_offline.h
+ * @brief Offline queue of object DP reports.
+ *
+ * Object DPs of the device that find no channel to the cloud are queued with
+ * the time they were reported and kept in KV, so they survive a reboot.
+ * A newer value of a DP replaces the queued one unless it is a record DP
+ * (see dp_rept_is_record()), whose every value is kept. When the queue is
+ * full the oldest entry is dropped.
+ *
+ * After MQTT connects, the queue is replayed in messages of at most
+ * DP_OFFLINE_REPLAY_BATCH DPs of one time stamp, one message every
+ * DP_OFFLINE_REPLAY_INTERVAL_MS. An entry leaves the queue when the cloud has
+ * acked its message.
+ *
+ * @copyright Copyright (c) 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+
+#ifndef __TUYA_IOT_DP_OFFLINE_H__
+#define __TUYA_IOT_DP_OFFLINE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "tuya_iot.h"
+#include "dp_schema.h"
+
+/**
+ * @brief Queues object DPs that could not be sent.
+ *
+ * @param client The Tuya IoT client instance.
+ * @param devid The device ID, only the device itself is queued.
+ * @param dps The DPs, string values are copied.
+ * @param dpscnt The number of DPs.
+ * @return OPRT_OK on success, OPRT_NOT_SUPPORTED for other devices or when
+ * the queue is disabled, or another error code on failure.
+ */
+int tuya_iot_dp_offline_push(tuya_iot_client_t *client, const char *devid, dp_obj_t *dps, uint16_t dpscnt);
+
+/**
+ * @brief Starts replaying the queue, called when MQTT has connected.
+ *
+ * @param client The Tuya IoT client instance.
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+int tuya_iot_dp_offline_replay_start(tuya_iot_client_t *client);
+
+/**
+ * @brief Drops the queue and its KV copy.
+ *
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+int tuya_iot_dp_offline_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -38,6 +38,8 @@
 #include "mbedtls/ctr_drbg.h"
 #include "mbedtls/hkdf.h"
 #include "mbedtls/aes.h"
+#include "crc32i.h"
+#include "tal_boot_mark.h"
 
 #define TLS_URL_LEN (128 + 16)
 
@@ -56,9 +58,109 @@ typedef struct {
 
 #define TLS_HANDSHAKE_TIMEOUT (18) // s
 
+// number of client sessions kept for resumption, 0 to disable
+#ifndef TLS_SESSION_CACHE_NUM
+#define TLS_SESSION_CACHE_NUM 2
+#endif
+
+// 1 to keep the cached sessions in KV, so they are resumed after a reboot
+#ifndef TLS_SESSION_CACHE_PERSIST
+#define TLS_SESSION_CACHE_PERSIST 0
+#endif
+
+// blocks of at least this size, like the record buffers, are allocated in
+// PSRAM when the board has it, 0 to keep all of them in SRAM
+#ifndef TUYA_TLS_PSRAM_MIN_SIZE
+#define TUYA_TLS_PSRAM_MIN_SIZE 0
+#endif
+
+// size of a heap of its own for mbedtls, allocated once by tuya_tls_init, so
+// handshakes do not fragment the system heap. It is in PSRAM when the board
+// has it, blocks that do not fit are taken from the system heap. 0 to use the
+// system heap only
+#ifndef TUYA_TLS_MEM_POOL_SIZE
+#define TUYA_TLS_MEM_POOL_SIZE 0
+#endif
+
+// 1 to count the memory of mbedtls and the peak of every handshake per
+// tuya_tls_mode_t, see tuya_tls_mem_stat_get()
+#ifndef TUYA_TLS_MEM_STAT
+#define TUYA_TLS_MEM_STAT 0
+#endif
+
+#if defined(ENABLE_EXT_RAM) && (ENABLE_EXT_RAM == 1) && (TUYA_TLS_PSRAM_MIN_SIZE > 0)
+#define TLS_MEM_PSRAM 1
+#else
+#define TLS_MEM_PSRAM 0
+#endif
+
+#define TLS_MEM_POOL  (TUYA_TLS_MEM_POOL_SIZE > 0)
+#define TLS_MEM_TRACK (TLS_MEM_POOL || TUYA_TLS_MEM_STAT)
+#define TLS_MEM_WRAP  (TLS_MEM_PSRAM || TLS_MEM_TRACK)
+#define TLS_MEM_HEAD  8 // size and heap of a heap block, keeps the blocks 8 byte aligned
+
+// handshakes running at the same time whose peak is recorded
+#define TLS_MEM_HS_NUM 4
+
+#if TLS_MEM_POOL
+typedef struct tls_pool_blk {
+    size_t size; // of the whole block with this header
+    struct tls_pool_blk *next;
+} tls_pool_blk_t;
+
+#define TLS_POOL_ALIGN(n) (((n) + 7) & ~(size_t)7)
+#define TLS_POOL_HEAD     TLS_POOL_ALIGN(sizeof(tls_pool_blk_t))
+#define TLS_POOL_MIN      16 // smaller rests are not split off
+#endif
+
+#if (TLS_SESSION_CACHE_NUM > 0)
+typedef struct {
+    uint8_t valid;
+    uint8_t psk;
+    uint16_t port;
+    char hostname[TLS_URL_LEN];
+    mbedtls_ssl_session session;
+#if TLS_SESSION_CACHE_PERSIST
+    uint32_t kv_crc; // CRC32 of the session in KV, it is written only when it changes
+#endif
+} tuya_tls_session_cache_t;
+
+#if TLS_SESSION_CACHE_PERSIST
+#define TLS_SESSION_KV_FMT     "tls_s_%08x"
+#define TLS_SESSION_KV_VERSION 1
+#endif
+#endif
+
 static tuya_tls_pre_conn_cb s_pre_conn_cb = NULL;
 static mbedtls_entropy_context ty_entropy;
 static mbedtls_ctr_drbg_context ty_ctr_drbg;
+#if (TLS_SESSION_CACHE_NUM > 0)
+static tuya_tls_session_cache_t s_session_cache[TLS_SESSION_CACHE_NUM];
+static uint8_t s_session_next = 0;
+static MUTEX_HANDLE s_session_mutex = NULL;
+#endif
+#if TLS_MEM_TRACK
+static struct {
+    MUTEX_HANDLE mutex;
+#if TLS_MEM_POOL
+    uint8_t *pool;
+    size_t pool_size;
+    tls_pool_blk_t *free_list; // in address order, so neighbours are merged
+    uint32_t pool_free;
+    uint32_t pool_free_min;
+    uint32_t pool_fallback;
+#endif
+#if TUYA_TLS_MEM_STAT
+    uint32_t cur;
+    uint32_t peak;
+    uint32_t blocks;
+    bool hs_used[TLS_MEM_HS_NUM];
+    uint32_t hs_base[TLS_MEM_HS_NUM];
+    uint32_t hs_peak[TLS_MEM_HS_NUM];
+    tuya_tls_mem_mode_stat_t mode[TUYA_TLS_MODE_MAX];
+#endif
+} s_tls_mem;
+#endif
 
 /* -------------------------------------------------------------------------- */
 /*                                  TLS Mutex                                 */
@@ -127,18 +229,282 @@ static int __tuya_tls_mutex_unlock(mbedtls_threading_mutex_t *mutex)
 /* -------------------------------------------------------------------------- */
 /*                                   Calloc                                   */
 /* -------------------------------------------------------------------------- */
-static __attribute__((unused)) void *__tuya_tls_calloc(size_t nmemb, size_t size)
+#if TLS_MEM_POOL
+static void __tls_pool_init(void)
+{
+    size_t size = TUYA_TLS_MEM_POOL_SIZE & ~(size_t)7;
+
+#if defined(ENABLE_EXT_RAM) && (ENABLE_EXT_RAM == 1)
+    s_tls_mem.pool = tal_psram_malloc(size);
+#else
+    s_tls_mem.pool = tal_malloc(size);
+#endif
+    if (NULL == s_tls_mem.pool) {
+        PR_WARN("tls mem pool %d alloc fail, use the heap", size);
+        return;
+    }
+    s_tls_mem.pool_size = size;
+    s_tls_mem.free_list = (tls_pool_blk_t *)s_tls_mem.pool;
+    s_tls_mem.free_list->size = size;
+    s_tls_mem.free_list->next = NULL;
+    s_tls_mem.pool_free = size;
+    s_tls_mem.pool_free_min = size;
+}
+
+static bool __tls_pool_own(void *ptr)
+{
+    return (uint8_t *)ptr >= s_tls_mem.pool && (uint8_t *)ptr < s_tls_mem.pool + s_tls_mem.pool_size;
+}
+
+//! first fit, to be called with s_tls_mem.mutex held
+static tls_pool_blk_t *__tls_pool_alloc(size_t size)
+{
+    size_t need = TLS_POOL_HEAD + TLS_POOL_ALIGN(size);
+    tls_pool_blk_t **link = &s_tls_mem.free_list;
+
+    for (; *link; link = &(*link)->next) {
+        tls_pool_blk_t *blk = *link;
+        if (blk->size < need) {
+            continue;
+        }
+        if (blk->size - need >= TLS_POOL_HEAD + TLS_POOL_MIN) {
+            tls_pool_blk_t *rest = (tls_pool_blk_t *)((uint8_t *)blk + need);
+            rest->size = blk->size - need;
+            rest->next = blk->next;
+            *link = rest;
+            blk->size = need;
+        } else {
+            *link = blk->next;
+        }
+        s_tls_mem.pool_free -= blk->size;
+        if (s_tls_mem.pool_free < s_tls_mem.pool_free_min) {
+            s_tls_mem.pool_free_min = s_tls_mem.pool_free;
+        }
+        return blk;
+    }
+
+    return NULL;
+}
+
+//! to be called with s_tls_mem.mutex held
+static void __tls_pool_free(tls_pool_blk_t *blk)
+{
+    tls_pool_blk_t *prev = NULL;
+    tls_pool_blk_t *next = s_tls_mem.free_list;
+
+    s_tls_mem.pool_free += blk->size;
+    while (next && next < blk) {
+        prev = next;
+        next = next->next;
+    }
+
+    if (next && (uint8_t *)blk + blk->size == (uint8_t *)next) {
+        blk->size += next->size;
+        blk->next = next->next;
+    } else {
+        blk->next = next;
+    }
+    if (NULL == prev) {
+        s_tls_mem.free_list = blk;
+    } else if ((uint8_t *)prev + prev->size == (uint8_t *)blk) {
+        prev->size += blk->size;
+        prev->next = blk->next;
+    } else {
+        prev->next = blk;
+    }
+}
+#endif
+
+#if TUYA_TLS_MEM_STAT
+//! to be called with s_tls_mem.mutex held, size includes the block header
+static void __tls_mem_account(uint32_t size, bool alloc)
+{
+    if (!alloc) {
+        s_tls_mem.cur -= size;
+        s_tls_mem.blocks--;
+        return;
+    }
+
+    s_tls_mem.cur += size;
+    s_tls_mem.blocks++;
+    if (s_tls_mem.cur > s_tls_mem.peak) {
+        s_tls_mem.peak = s_tls_mem.cur;
+    }
+    for (int i = 0; i < TLS_MEM_HS_NUM; i++) {
+        if (s_tls_mem.hs_used[i] && s_tls_mem.cur > s_tls_mem.hs_peak[i]) {
+            s_tls_mem.hs_peak[i] = s_tls_mem.cur;
+        }
+    }
+}
+#endif
+
+/**
+ * @brief the handshake from now on is recorded, the memory of other handshakes
+ * running at the same time is part of its peak
+ *
+ * @return the slot for __tls_mem_hs_end, -1 if it is not recorded
+ */
+static int __tls_mem_hs_begin(void)
+{
+    int slot = -1;
+
+#if TUYA_TLS_MEM_STAT
+    tal_mutex_lock(s_tls_mem.mutex);
+    for (int i = 0; i < TLS_MEM_HS_NUM; i++) {
+        if (!s_tls_mem.hs_used[i]) {
+            s_tls_mem.hs_used[i] = true;
+            s_tls_mem.hs_base[i] = s_tls_mem.cur;
+            s_tls_mem.hs_peak[i] = s_tls_mem.cur;
+            slot = i;
+            break;
+        }
+    }
+    tal_mutex_unlock(s_tls_mem.mutex);
+#endif
+
+    return slot;
+}
+
+static void __tls_mem_hs_end(int slot, tuya_tls_mode_t mode, bool connected)
+{
+#if TUYA_TLS_MEM_STAT
+    uint32_t peak = 0, kept = 0;
+
+    if (slot < 0) {
+        return;
+    }
+
+    tal_mutex_lock(s_tls_mem.mutex);
+    peak = s_tls_mem.hs_peak[slot] - s_tls_mem.hs_base[slot];
+    kept = (s_tls_mem.cur > s_tls_mem.hs_base[slot]) ? s_tls_mem.cur - s_tls_mem.hs_base[slot] : 0;
+    s_tls_mem.hs_used[slot] = false;
+    if ((uint32_t)mode < TUYA_TLS_MODE_MAX) {
+        tuya_tls_mem_mode_stat_t *stat = &s_tls_mem.mode[mode];
+        stat->handshakes++;
+        stat->peak_last = peak;
+        if (peak > stat->peak_max) {
+            stat->peak_max = peak;
+        }
+        if (connected) {
+            stat->kept_last = kept;
+        }
+    }
+    tal_mutex_unlock(s_tls_mem.mutex);
+
+    PR_DEBUG("tls mem mode:%d handshake peak:%u kept:%u", mode, peak, kept);
+#endif
+}
+
+#if TLS_MEM_WRAP
+/**
+ * @brief blocks come from the pool of mbedtls when there is one, else from the
+ * heap. Large heap blocks like the record buffers are placed in PSRAM, every
+ * heap block starts with a header telling its size and the heap it came from
+ */
+static void *__tuya_tls_calloc(size_t nmemb, size_t size)
 {
     size_t mem_size = nmemb * size;
-    void *ptr = tal_malloc(mem_size);
-    if (ptr != NULL) {
+    uint8_t *ptr = NULL;
+
+    if (size && mem_size / size != nmemb) {
+        return NULL;
+    }
+#if TLS_MEM_POOL
+    tal_mutex_lock(s_tls_mem.mutex);
+    tls_pool_blk_t *blk = __tls_pool_alloc(mem_size);
+    if (blk) {
+#if TUYA_TLS_MEM_STAT
+        __tls_mem_account(blk->size, true);
+#endif
+    } else if (s_tls_mem.pool) {
+        s_tls_mem.pool_fallback++;
+    }
+    tal_mutex_unlock(s_tls_mem.mutex);
+    if (blk) {
+        ptr = (uint8_t *)blk + TLS_POOL_HEAD;
         memset(ptr, 0, mem_size);
-    } else {
-        PR_ERR("------- alloc failed,size:%d", size);
+        return ptr;
+    }
+#endif
+#if TLS_MEM_PSRAM
+    if (mem_size >= TUYA_TLS_PSRAM_MIN_SIZE) {
+        ptr = tal_psram_calloc(1, TLS_MEM_HEAD + mem_size);
+        if (ptr) {
+            ptr[4] = 1;
+        }
+    }
+#endif
+    if (NULL == ptr) {
+        ptr = tal_calloc(1, TLS_MEM_HEAD + mem_size);
+        if (NULL == ptr) {
+            PR_ERR("------- alloc failed,size:%d", mem_size);
+            return NULL;
+        }
     }
-    return ptr;
+    *(uint32_t *)ptr = TLS_MEM_HEAD + mem_size;
+#if TUYA_TLS_MEM_STAT
+    tal_mutex_lock(s_tls_mem.mutex);
+    __tls_mem_account(TLS_MEM_HEAD + mem_size, true);
+    tal_mutex_unlock(s_tls_mem.mutex);
+#endif
+    return ptr + TLS_MEM_HEAD;
 }
 
+static void __tuya_tls_free(void *ptr)
+{
+    if (NULL == ptr) {
+        return;
+    }
+
+#if TLS_MEM_POOL
+    if (__tls_pool_own(ptr)) {
+        tls_pool_blk_t *blk = (tls_pool_blk_t *)((uint8_t *)ptr - TLS_POOL_HEAD);
+        tal_mutex_lock(s_tls_mem.mutex);
+#if TUYA_TLS_MEM_STAT
+        __tls_mem_account(blk->size, false);
+#endif
+        __tls_pool_free(blk);
+        tal_mutex_unlock(s_tls_mem.mutex);
+        return;
+    }
+#endif
+
+    uint8_t *head = (uint8_t *)ptr - TLS_MEM_HEAD;
+#if TUYA_TLS_MEM_STAT
+    tal_mutex_lock(s_tls_mem.mutex);
+    __tls_mem_account(*(uint32_t *)head, false);
+    tal_mutex_unlock(s_tls_mem.mutex);
+#endif
+#if TLS_MEM_PSRAM
+    if (head[4]) {
+        tal_psram_free(head);
+        return;
+    }
+#endif
+    tal_free(head);
+}
+#endif
+
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+static unsigned char __tuya_tls_mfl_code(size_t content_len)
+{
+    if (0 == content_len) {
+        content_len = (MBEDTLS_SSL_MAX_CONTENT_LEN >= 4096) ? 4096 : 1024;
+    } else if (content_len > MBEDTLS_SSL_MAX_CONTENT_LEN) {
+        content_len = MBEDTLS_SSL_MAX_CONTENT_LEN;
+    }
+
+    if (content_len <= 512) {
+        return MBEDTLS_SSL_MAX_FRAG_LEN_512;
+    } else if (content_len <= 1024) {
+        return MBEDTLS_SSL_MAX_FRAG_LEN_1024;
+    } else if (content_len <= 2048) {
+        return MBEDTLS_SSL_MAX_FRAG_LEN_2048;
+    }
+    return MBEDTLS_SSL_MAX_FRAG_LEN_4096;
+}
+#endif
+
 #if defined(ENABLE_MBEDTLS_DEBUG) && (ENABLE_MBEDTLS_DEBUG == 1)
 static void __tuya_tls_export_keys(void *p_expkey, mbedtls_ssl_key_export_type type, const unsigned char *secret,
                                    size_t secret_len, const unsigned char client_random[32],
@@ -409,7 +775,24 @@ OPERATE_RET tuya_tls_init(void)
     mbedtls_threading_set_alt(__tuya_tls_mutex_init, __tuya_tls_mutex_free, __tuya_tls_mutex_lock,
                               __tuya_tls_mutex_unlock);
 
+#if TLS_MEM_TRACK
+    if (NULL == s_tls_mem.mutex) {
+        op_ret = tal_mutex_create_init(&s_tls_mem.mutex);
+        if (op_ret != OPRT_OK) {
+            PR_ERR("tls mem mutex create Fail. %d", op_ret);
+            return op_ret;
+        }
+#if TLS_MEM_POOL
+        __tls_pool_init();
+#endif
+    }
+#endif
+
+#if TLS_MEM_WRAP
+    op_ret = mbedtls_platform_set_calloc_free(__tuya_tls_calloc, __tuya_tls_free);
+#else
     op_ret = mbedtls_platform_set_calloc_free(tal_calloc, tal_free);
+#endif
     if (op_ret != 0) {
         PR_ERR("mbedtls_platform_set_calloc_free Fail. %x", op_ret);
         return op_ret;
@@ -425,6 +808,16 @@ OPERATE_RET tuya_tls_init(void)
     }
     mbedtls_ctr_drbg_set_prediction_resistance(&ty_ctr_drbg, MBEDTLS_CTR_DRBG_PR_OFF);
 
+#if (TLS_SESSION_CACHE_NUM > 0)
+    if (NULL == s_session_mutex) {
+        op_ret = tal_mutex_create_init(&s_session_mutex);
+        if (op_ret != OPRT_OK) {
+            PR_ERR("session mutex create Fail. %d", op_ret);
+            goto exit;
+        }
+    }
+#endif
+
     PR_NOTICE("tuya_tls_init ok!");
 
     return OPRT_OK;
@@ -435,6 +828,185 @@ exit:
     return op_ret;
 }
 
+#if (TLS_SESSION_CACHE_NUM > 0)
+static tuya_tls_session_cache_t *__tuya_tls_session_find(tuya_mbedtls_context_t *tls_context)
+{
+    uint8_t psk = (tls_context->config.psk_key_size > 0 && tls_context->config.psk_id_size > 0);
+
+    for (uint32_t i = 0; i < TLS_SESSION_CACHE_NUM; i++) {
+        tuya_tls_session_cache_t *entry = &s_session_cache[i];
+        if (entry->valid && entry->psk == psk && entry->port == tls_context->config.port &&
+            strcmp(entry->hostname, tls_context->config.hostname) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+#if TLS_SESSION_CACHE_PERSIST
+/**
+ * @brief KV key of a session, the value is a version byte, the host name with
+ * its NUL and the session as written by mbedtls_ssl_session_save()
+ */
+static void __tuya_tls_session_kv_key(tuya_mbedtls_context_t *tls_context, char key[TAL_LV_KEY_LEN])
+{
+    char id[TLS_URL_LEN + 16];
+    uint8_t psk = (tls_context->config.psk_key_size > 0 && tls_context->config.psk_id_size > 0);
+
+    snprintf(id, sizeof(id), "%s:%d:%d", tls_context->config.hostname, tls_context->config.port, psk);
+    snprintf(key, TAL_LV_KEY_LEN, TLS_SESSION_KV_FMT, hash_crc32i_total((uint8_t *)id, strlen(id)));
+}
+
+static tuya_tls_session_cache_t *__tuya_tls_session_kv_load(tuya_mbedtls_context_t *tls_context)
+{
+    char key[TAL_LV_KEY_LEN];
+    uint8_t *buf = NULL;
+    size_t len = 0;
+    size_t host_len = strlen(tls_context->config.hostname) + 1;
+    tuya_tls_session_cache_t *entry = NULL;
+
+    __tuya_tls_session_kv_key(tls_context, key);
+    if (OPRT_OK != tal_kv_get(key, &buf, &len)) {
+        return NULL;
+    }
+    if (len <= 1 + host_len || TLS_SESSION_KV_VERSION != buf[0] ||
+        memcmp(buf + 1, tls_context->config.hostname, host_len)) {
+        goto __exit;
+    }
+
+    entry = &s_session_cache[s_session_next];
+    if (entry->valid) {
+        mbedtls_ssl_session_free(&entry->session);
+    }
+    mbedtls_ssl_session_init(&entry->session);
+    if (mbedtls_ssl_session_load(&entry->session, buf + 1 + host_len, len - 1 - host_len) != 0) {
+        mbedtls_ssl_session_free(&entry->session);
+        entry->valid = FALSE;
+        entry = NULL;
+        tal_kv_del(key);
+        goto __exit;
+    }
+    s_session_next = (s_session_next + 1) % TLS_SESSION_CACHE_NUM;
+    entry->valid = TRUE;
+    entry->psk = (tls_context->config.psk_key_size > 0 && tls_context->config.psk_id_size > 0);
+    entry->port = tls_context->config.port;
+    strcpy(entry->hostname, tls_context->config.hostname);
+    entry->kv_crc = hash_crc32i_total(buf, len);
+
+__exit:
+    tal_kv_free(buf);
+    return entry;
+}
+
+static void __tuya_tls_session_kv_save(tuya_mbedtls_context_t *tls_context, tuya_tls_session_cache_t *entry)
+{
+    char key[TAL_LV_KEY_LEN];
+    size_t session_len = 0;
+    size_t host_len = strlen(entry->hostname) + 1;
+
+    if (mbedtls_ssl_session_save(&entry->session, NULL, 0, &session_len) != MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL) {
+        return;
+    }
+
+    size_t len = 1 + host_len + session_len;
+    uint8_t *buf = tal_malloc(len);
+    if (NULL == buf) {
+        return;
+    }
+    buf[0] = TLS_SESSION_KV_VERSION;
+    memcpy(buf + 1, entry->hostname, host_len);
+    if (mbedtls_ssl_session_save(&entry->session, buf + 1 + host_len, session_len, &session_len) == 0) {
+        uint32_t crc = hash_crc32i_total(buf, len);
+        if (crc != entry->kv_crc) {
+            __tuya_tls_session_kv_key(tls_context, key);
+            if (OPRT_OK == tal_kv_set(key, buf, len)) {
+                entry->kv_crc = crc;
+            }
+        }
+    }
+    tal_free(buf);
+}
+#endif
+
+/**
+ * @brief offer the cached session of this host, the server decides whether to resume it
+ */
+static void __tuya_tls_session_load(tuya_mbedtls_context_t *tls_context)
+{
+    if (NULL == tls_context->config.hostname || NULL == s_session_mutex) {
+        return;
+    }
+
+    tal_mutex_lock(s_session_mutex);
+    tuya_tls_session_cache_t *entry = __tuya_tls_session_find(tls_context);
+#if TLS_SESSION_CACHE_PERSIST
+    if (NULL == entry) {
+        entry = __tuya_tls_session_kv_load(tls_context);
+    }
+#endif
+    if (entry && mbedtls_ssl_set_session(&tls_context->ssl_ctx, &entry->session) == 0) {
+        PR_DEBUG("tls offer cached session for %s", entry->hostname);
+    }
+    tal_mutex_unlock(s_session_mutex);
+}
+
+static void __tuya_tls_session_save(tuya_mbedtls_context_t *tls_context)
+{
+    if (NULL == tls_context->config.hostname || NULL == s_session_mutex ||
+        strlen(tls_context->config.hostname) >= TLS_URL_LEN) {
+        return;
+    }
+
+    tal_mutex_lock(s_session_mutex);
+    tuya_tls_session_cache_t *entry = __tuya_tls_session_find(tls_context);
+    if (NULL == entry) {
+        entry = &s_session_cache[s_session_next];
+        s_session_next = (s_session_next + 1) % TLS_SESSION_CACHE_NUM;
+    }
+    if (entry->valid) {
+        mbedtls_ssl_session_free(&entry->session);
+    }
+#if TLS_SESSION_CACHE_PERSIST
+    else {
+        entry->kv_crc = 0;
+    }
+#endif
+    mbedtls_ssl_session_init(&entry->session);
+    entry->valid = (mbedtls_ssl_get_session(&tls_context->ssl_ctx, &entry->session) == 0);
+    if (entry->valid) {
+        entry->psk = (tls_context->config.psk_key_size > 0 && tls_context->config.psk_id_size > 0);
+        entry->port = tls_context->config.port;
+        strcpy(entry->hostname, tls_context->config.hostname);
+#if TLS_SESSION_CACHE_PERSIST
+        __tuya_tls_session_kv_save(tls_context, entry);
+#endif
+    } else {
+        mbedtls_ssl_session_free(&entry->session);
+    }
+    tal_mutex_unlock(s_session_mutex);
+}
+
+static void __tuya_tls_session_drop(tuya_mbedtls_context_t *tls_context)
+{
+    if (NULL == tls_context->config.hostname || NULL == s_session_mutex) {
+        return;
+    }
+
+    tal_mutex_lock(s_session_mutex);
+    tuya_tls_session_cache_t *entry = __tuya_tls_session_find(tls_context);
+    if (entry) {
+        mbedtls_ssl_session_free(&entry->session);
+        entry->valid = FALSE;
+#if TLS_SESSION_CACHE_PERSIST
+        char key[TAL_LV_KEY_LEN];
+        __tuya_tls_session_kv_key(tls_context, key);
+        tal_kv_del(key);
+#endif
+    }
+    tal_mutex_unlock(s_session_mutex);
+}
+#endif
+
 /**
  * @brief register cb invoked before tls handshake
  *
@@ -568,6 +1140,8 @@ OPERATE_RET tuya_tls_connect(tuya_tls_hander p_tls_handler, char *hostname, int
 #endif
     PR_DEBUG("TUYA_TLS Begin Connect %s:%d", (hostname ? hostname : ""), port_num);
 
+    int mem_slot = __tls_mem_hs_begin();
+
     mbedtls_ssl_context *p_ssl_ctx = &(tls_context->ssl_ctx);
     mbedtls_ssl_config *p_conf_ctx = &(tls_context->conf_ctx);
 
@@ -590,11 +1164,12 @@ OPERATE_RET tuya_tls_connect(tuya_tls_hander p_tls_handler, char *hostname, int
     }
 
 #if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
-#if (MBEDTLS_SSL_MAX_CONTENT_LEN >= 4096)
-    mbedtls_ssl_conf_max_frag_len(p_conf_ctx, MBEDTLS_SSL_MAX_FRAG_LEN_4096);
-#else
-    mbedtls_ssl_conf_max_frag_len(p_conf_ctx, MBEDTLS_SSL_MAX_FRAG_LEN_1024);
-#endif
+    /* with MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH the record buffers shrink to it after the handshake */
+    size_t content_len = tls_context->config.in_content_len;
+    if (tls_context->config.out_content_len > content_len) {
+        content_len = tls_context->config.out_content_len;
+    }
+    mbedtls_ssl_conf_max_frag_len(p_conf_ctx, __tuya_tls_mfl_code(content_len));
 #endif
     if (s_pre_conn_cb) {
         PR_DEBUG("s_pre_conn_cb  %08x", s_pre_conn_cb);
@@ -610,6 +1185,7 @@ OPERATE_RET tuya_tls_connect(tuya_tls_hander p_tls_handler, char *hostname, int
         if (op_ret != 0) {
             PR_ERR("mbedtls_cert_parse_process Fail. 0x%x %d", -op_ret, op_ret);
             mbedtls_cert_pkey_free(p_tls_handler);
+            __tls_mem_hs_end(mem_slot, tls_context->config.mode, false);
             return op_ret;
         }
         if (hostname) {
@@ -617,6 +1193,7 @@ OPERATE_RET tuya_tls_connect(tuya_tls_hander p_tls_handler, char *hostname, int
             if (op_ret != 0) {
                 PR_ERR("mbedtls_ssl_set_hostname Fail. 0x%x", -op_ret);
                 mbedtls_cert_pkey_free(p_tls_handler);
+                __tls_mem_hs_end(mem_slot, tls_context->config.mode, false);
                 return op_ret;
             }
         }
@@ -639,8 +1216,13 @@ OPERATE_RET tuya_tls_connect(tuya_tls_hander p_tls_handler, char *hostname, int
     mbedtls_ssl_set_bio(p_ssl_ctx, tls_context, __tuya_tls_socket_send_cb, __tuya_tls_socket_recv_cb, NULL);
     PR_DEBUG("socket fd is set. set to inner send/recv to handshake");
 
+#if (TLS_SESSION_CACHE_NUM > 0)
+    __tuya_tls_session_load(tls_context);
+#endif
+
     TIME_T cur_time = tal_time_get_posix();
 
+    tal_boot_mark("tls handshake");
     while ((op_ret = mbedtls_ssl_handshake(p_ssl_ctx)) != 0) {
         if (op_ret == MBEDTLS_ERR_X509_CERT_VERIFY_FAILED) {
             PR_NOTICE("tls handshake :%d .require new certs.", op_ret);
@@ -679,6 +1261,10 @@ OPERATE_RET tuya_tls_connect(tuya_tls_hander p_tls_handler, char *hostname, int
     }
 
     PR_DEBUG("handshake finish for %s. set send/recv to user set", (hostname ? hostname : ""));
+    tal_boot_mark("tls connected");
+#if (TLS_SESSION_CACHE_NUM > 0)
+    __tuya_tls_session_save(tls_context);
+#endif
     if (tls_context->config.f_send && tls_context->config.f_recv) {
         mbedtls_ssl_set_bio(p_ssl_ctx, tls_context->config.user_data, tls_context->config.f_send,
                             tls_context->config.f_recv, NULL);
@@ -686,11 +1272,16 @@ OPERATE_RET tuya_tls_connect(tuya_tls_hander p_tls_handler, char *hostname, int
 
     PR_DEBUG("TUYA_TLS Success Connect %s:%d Suit:%s", (hostname ? hostname : ""), port_num,
              mbedtls_ssl_get_ciphersuite(p_ssl_ctx));
+    __tls_mem_hs_end(mem_slot, tls_context->config.mode, true);
 
     return OPRT_OK;
 
 tuya_tls_connect_EXIT:
+    __tls_mem_hs_end(mem_slot, tls_context->config.mode, false);
 
+#if (TLS_SESSION_CACHE_NUM > 0)
+    __tuya_tls_session_drop(tls_context);
+#endif
     PR_ERR("TUYA_TLS faild Connect %s:%d", (hostname ? hostname : ""), port_num);
 
     return op_ret;
@@ -824,6 +1415,41 @@ OPERATE_RET tuya_tls_disconnect(tuya_tls_hander tls_handler)
     return OPRT_OK;
 }
 
+/**
+ * @brief Gets the memory statistics of mbedtls, they are kept when
+ * TUYA_TLS_MEM_STAT is 1.
+ *
+ * @param[out] stat the statistics
+ *
+ * @return OPRT_OK on success, OPRT_NOT_SUPPORTED when they are not kept.
+ */
+OPERATE_RET tuya_tls_mem_stat_get(tuya_tls_mem_stat_t *stat)
+{
+#if TUYA_TLS_MEM_STAT
+    if (NULL == stat) {
+        return OPRT_INVALID_PARM;
+    }
+
+    memset(stat, 0, sizeof(tuya_tls_mem_stat_t));
+    tal_mutex_lock(s_tls_mem.mutex);
+    stat->cur = s_tls_mem.cur;
+    stat->peak = s_tls_mem.peak;
+    stat->blocks = s_tls_mem.blocks;
+#if TLS_MEM_POOL
+    stat->pool_size = s_tls_mem.pool_size;
+    stat->pool_free = s_tls_mem.pool_free;
+    stat->pool_free_min = s_tls_mem.pool_free_min;
+    stat->pool_fallback = s_tls_mem.pool_fallback;
+#endif
+    memcpy(stat->mode, s_tls_mem.mode, sizeof(stat->mode));
+    tal_mutex_unlock(s_tls_mem.mutex);
+
+    return OPRT_OK;
+#else
+    return OPRT_NOT_SUPPORTED;
+#endif
+}
+
 /**
  * Retrieves the callback function for Tuya TLS events.
  *
@@ -19,6 +19,8 @@
 #include "tuya_transporter.h"
 #include "tcp_transporter.h"
 #include "tal_network.h"
+#include "tal_net_dns.h"
+#include "tal_boot_mark.h"
 
 typedef struct tcp_transporter_inter_t {
     struct tuya_transporter_inter_t base;
@@ -55,11 +57,13 @@ OPERATE_RET tuya_tcp_transporter_connect(tuya_transporter_t t, const char *host,
 
     /*resolve ip addr of host*/
     TUYA_IP_ADDR_T hostaddr;
+    tal_boot_mark("dns request");
     op_ret = tal_net_gethostbyname(host, &hostaddr);
     if (op_ret != OPRT_OK) {
         PR_ERR("DNS parser host %s failed %d", host, op_ret);
         return OPRT_MID_TRANSPORT_DNS_PARSED_FAILED;
     }
+    tal_boot_mark("dns resolved");
 
     tcp_transporter->socket_fd = tal_net_socket_create(PROTOCOL_TCP);
     if (tcp_transporter->socket_fd < 0) {
@@ -120,9 +124,12 @@ OPERATE_RET tuya_tcp_transporter_connect(tuya_transporter_t t, const char *host,
     }
 
     if (tal_net_connect(tcp_transporter->socket_fd, hostaddr, port) < 0) {
+        //! the host may have moved, resolve it again next time
+        tal_net_dns_cache_expire(host);
         op_ret = OPRT_MID_TRANSPORT_TCP_CONNECD_FAILED;
         goto err_out;
     }
+    tal_boot_mark("tcp connected");
 
     return OPRT_OK;
 err_out:
@@ -338,6 +345,40 @@ OPERATE_RET tuya_tcp_transporter_write(tuya_transporter_t t, uint8_t *buf, int l
     return ret;
 }
 
+/**
+ * @brief Writes data gathered from several buffers to the TCP transporter
+ * with one send.
+ *
+ * @param t The TCP transporter.
+ * @param iov The buffers, written in order.
+ * @param iovcnt The number of buffers.
+ * @param timeout_ms The timeout value in milliseconds.
+ * @return The result of the operation.
+ */
+OPERATE_RET tuya_tcp_transporter_writev(tuya_transporter_t t, const TAL_NET_IOVEC_T *iov, int iovcnt, int timeout_ms)
+{
+    int ret = OPRT_COM_ERROR;
+    tuya_tcp_transporter_t tcp_transporter = (tuya_tcp_transporter_t)t;
+    if (tcp_transporter->socket_fd < 0) {
+        PR_ERR("socket fd:%d", tcp_transporter->socket_fd);
+        return OPRT_INVALID_PARM;
+    }
+
+    if (timeout_ms > 0 && tuya_tcp_transporter_poll_write(t, timeout_ms) <= 0) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    ret = tal_net_sendv(tcp_transporter->socket_fd, iov, iovcnt);
+    if (ret < 0) {
+        if ((tal_net_get_errno() == UNW_EINTR) || (tal_net_get_errno() == UNW_EAGAIN)) {
+            tal_system_sleep(30);
+            ret = tal_net_sendv(tcp_transporter->socket_fd, iov, iovcnt);
+        }
+    }
+
+    return ret;
+}
+
 /**
  * @brief Destroys a TCP transporter.
  *
@@ -351,6 +392,7 @@ OPERATE_RET tuya_tcp_transporter_write(tuya_transporter_t t, uint8_t *buf, int l
 OPERATE_RET tuya_tcp_transporter_destroy(tuya_transporter_t transporter)
 {
     if (transporter) {
+        tuya_transporter_deinit(transporter);
         tal_free(transporter);
     }
     return OPRT_OK;
@@ -379,6 +421,7 @@ tuya_transporter_t tuya_tcp_transporter_create(void)
     tuya_transporter_set_func((tuya_transporter_t)&t->base, tuya_tcp_transporter_connect, tuya_tcp_transporter_close,
                               tuya_tcp_transporter_read, tuya_tcp_transporter_write, tuya_tcp_transporter_poll_read,
                               tuya_tcp_transporter_poll_write, tuya_tcp_transporter_destroy, tuya_tcp_transporter_ctrl);
+    t->base.f_writev = tuya_tcp_transporter_writev;
 
     return &t->base;
 }
@@ -26,6 +26,7 @@
 #include "tls_transporter.h"
 #include "tal_network.h"
 #include "tal_memory.h"
+#include "tal_system.h"
 #include "tuya_tls.h"
 
 typedef struct tls_transporter_inter_t {
@@ -92,7 +93,9 @@ OPERATE_RET tuya_tls_transporter_connect(tuya_transporter_t t, const char *host,
         tuya_tls_transporter_ctrl((tuya_transporter_t)tls_transporter, TUYA_TRANSPORTER_SET_TLS_CONFIG, config);
     }
 
+    SYS_TIME_T start = tal_system_get_millisecond();
     op_ret = tuya_tls_connect(tls_transporter->tls_handler, (char *)host, port, tls_transporter->socket_fd, timeout_ms);
+    t->stat.handshake_ms = (uint32_t)(tal_system_get_millisecond() - start);
     if (OPRT_OK != op_ret) {
         PR_ERR("tls transporter connect err:%d", op_ret);
         tuya_tls_transporter_close(t);
@@ -273,9 +276,14 @@ tuya_transporter_t tuya_tls_transporter_create(void)
     t->tcp_transporter = tuya_tcp_transporter_create();
     t->tls_handler = tuya_tls_connect_create();
     if (t->tls_handler == NULL) {
-        tuya_tcp_transporter_destroy(t->tcp_transporter);
+        tuya_transporter_destroy(t->tcp_transporter);
+        tuya_transporter_deinit(&t->base);
+        tal_free(t);
         return NULL;
     }
+#if TUYA_TRANSPORTER_TLS_READ_BUF_SIZE > 0
+    tuya_transporter_set_read_buffer(t->tcp_transporter, TUYA_TRANSPORTER_TLS_READ_BUF_SIZE);
+#endif
 
     /* Default config */
     tuya_tls_transporter_ctrl((tuya_transporter_t)&t->base, TUYA_TRANSPORTER_SET_TLS_CONFIG,
@@ -303,8 +311,9 @@ OPERATE_RET tuya_tls_transporter_destroy(tuya_transporter_t transporter)
     tuya_tls_connect_destroy(t->tls_handler);
     t->tls_handler = NULL;
 
-    tuya_tcp_transporter_destroy(t->tcp_transporter);
+    tuya_transporter_destroy(t->tcp_transporter);
     if (t) {
+        tuya_transporter_deinit(transporter);
         tal_free(t);
     }
 
@@ -20,6 +20,8 @@
  *
  */
 
+#include <stdio.h>
+
 #include "tuya_cloud_types.h"
 #include "tal_api.h"
 #include "tuya_transporter.h"
@@ -27,6 +29,7 @@
 #include "tcp_transporter.h"
 #include "websocket_transporter.h"
 #include "mix_method.h"
+#include "tal_cli.h"
 
 #define MAX_TRANSPORTER_NUM (2)
 
@@ -35,6 +38,81 @@ struct tuya_transport_array_handle {
     uint8_t index;
 };
 
+#if TUYA_TRANSPORTER_STAT_NUM > 0
+//! the transporters listed by trans_stat
+static struct {
+    MUTEX_HANDLE mutex;
+    tuya_transporter_t list[TUYA_TRANSPORTER_STAT_NUM];
+} s_trans_stat;
+#endif
+
+static void __transporter_stat_io(tuya_transporter_t t, BOOL_T is_read, int ret, SYS_TIME_T start)
+{
+    tuya_transporter_stat_t *stat = &t->stat;
+    uint32_t ms = (uint32_t)(tal_system_get_millisecond() - start);
+
+    if (is_read) {
+        stat->read_cnt++;
+        stat->read_ms += ms;
+        if (ret > 0) {
+            stat->bytes_in += ret;
+        } else if (OPRT_TIMEOUT == ret || OPRT_RESOURCE_NOT_READY == ret) {
+            stat->read_timeout++;
+        } else if (ret < 0) {
+            stat->read_err++;
+            stat->last_err = ret;
+        }
+    } else {
+        stat->write_cnt++;
+        stat->write_ms += ms;
+        if (ret > 0) {
+            stat->bytes_out += ret;
+        } else if (ret < 0) {
+            stat->write_err++;
+            stat->last_err = ret;
+        }
+    }
+}
+
+static void __transporter_stat_reset(tuya_transporter_t t)
+{
+    uint16_t port = t->stat.port;
+    char host[TUYA_TRANSPORTER_STAT_HOST_LEN];
+
+    memcpy(host, t->stat.host, sizeof(host));
+    memset(&t->stat, 0, sizeof(tuya_transporter_stat_t));
+    memcpy(t->stat.host, host, sizeof(host));
+    t->stat.port = port;
+}
+
+static int __transporter_f_read(tuya_transporter_t t, uint8_t *buf, int len, int timeout_ms)
+{
+    SYS_TIME_T start = tal_system_get_millisecond();
+    int ret = t->f_read(t, buf, len, timeout_ms);
+
+    __transporter_stat_io(t, TRUE, ret, start);
+    return ret;
+}
+
+//! moves buffered data to the front and reads once behind it
+static int __transporter_rbuf_fill(tuya_transporter_t t, int timeout_ms)
+{
+    int ret = 0;
+
+    if (t->rbuf_off) {
+        memmove(t->rbuf, t->rbuf + t->rbuf_off, t->rbuf_len - t->rbuf_off);
+        t->rbuf_len -= t->rbuf_off;
+        t->rbuf_off = 0;
+    }
+
+    ret = __transporter_f_read(t, t->rbuf + t->rbuf_len, t->rbuf_size - t->rbuf_len, timeout_ms);
+    if (ret > 0) {
+        t->rbuf_len += ret;
+    }
+
+    return ret;
+}
+
 tuya_transport_array_handle_t tuya_transport_array_create()
 {
     tuya_transport_array_handle_t p_transport_array =
@@ -161,6 +239,10 @@ tuya_transporter_t tuya_transporter_create(TUYA_TRANSPORT_TYPE_E transport_type,
  */
 OPERATE_RET tuya_transporter_destroy(tuya_transporter_t t)
 {
+    if (t && t->rbuf) {
+        tal_free(t->rbuf);
+        t->rbuf = NULL;
+    }
     if (t && t->f_destroy) {
         t->f_destroy(t);
     }
@@ -183,12 +265,132 @@ OPERATE_RET tuya_transporter_destroy(tuya_transporter_t t)
  */
 OPERATE_RET tuya_transporter_read(tuya_transporter_t transporter, uint8_t *buf, int len, int timeout_ms)
 {
+    int ret = 0;
 
-    if (transporter && transporter->f_read) {
-        return transporter->f_read(transporter, buf, len, timeout_ms);
+    if (NULL == transporter || NULL == transporter->f_read) {
+        return OPRT_INVALID_PARM;
+    }
+    if (NULL == transporter->rbuf) {
+        return __transporter_f_read(transporter, buf, len, timeout_ms);
     }
 
-    return OPRT_INVALID_PARM;
+    if (transporter->rbuf_off == transporter->rbuf_len) {
+        if (len >= transporter->rbuf_size) {
+            return __transporter_f_read(transporter, buf, len, timeout_ms);
+        }
+        ret = __transporter_rbuf_fill(transporter, timeout_ms);
+        if (ret <= 0) {
+            return ret;
+        }
+    }
+
+    ret = transporter->rbuf_len - transporter->rbuf_off;
+    if (ret > len) {
+        ret = len;
+    }
+    memcpy(buf, transporter->rbuf + transporter->rbuf_off, ret);
+    tuya_transporter_consume(transporter, ret);
+
+    return ret;
+}
+
+/**
+ * @brief Gives a transporter a read buffer.
+ *
+ * tuya_transporter_read() then reads up to size bytes from the transporter at
+ * once and serves small reads from the buffer, reads of at least size bytes
+ * that find it empty go to the transporter directly.
+ * tuya_transporter_poll_read() reports buffered data as readable.
+ *
+ * @param t The transporter.
+ * @param size The buffer size, 0 removes the buffer.
+ *
+ * @return OPRT_OK on success, OPRT_COM_ERROR when data is buffered, or another
+ * error code on failure.
+ */
+OPERATE_RET tuya_transporter_set_read_buffer(tuya_transporter_t t, uint16_t size)
+{
+    uint8_t *rbuf = NULL;
+
+    if (NULL == t) {
+        return OPRT_INVALID_PARM;
+    }
+    if (t->rbuf_off != t->rbuf_len) {
+        return OPRT_COM_ERROR;
+    }
+
+    if (size) {
+        rbuf = tal_malloc(size);
+        if (NULL == rbuf) {
+            return OPRT_MALLOC_FAILED;
+        }
+    }
+    if (t->rbuf) {
+        tal_free(t->rbuf);
+    }
+    t->rbuf = rbuf;
+    t->rbuf_size = size;
+    t->rbuf_off = 0;
+    t->rbuf_len = 0;
+
+    return OPRT_OK;
+}
+
+/**
+ * @brief Returns buffered data without consuming it.
+ *
+ * Reads from the transporter once when fewer than len bytes are buffered.
+ *
+ * @param t The transporter, with a read buffer.
+ * @param data Set to the buffered data.
+ * @param len The bytes wanted, at most the buffer size.
+ * @param timeout_ms The timeout value in milliseconds for the read.
+ *
+ * @return The number of bytes at data, up to len, or the error of the read
+ * when nothing is buffered.
+ */
+OPERATE_RET tuya_transporter_peek(tuya_transporter_t t, uint8_t **data, int len, int timeout_ms)
+{
+    int ret = 0;
+
+    if (NULL == t || NULL == t->rbuf || NULL == t->f_read || NULL == data || len <= 0 || len > t->rbuf_size) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (t->rbuf_len - t->rbuf_off < len) {
+        ret = __transporter_rbuf_fill(t, timeout_ms);
+        if (ret <= 0 && t->rbuf_off == t->rbuf_len) {
+            return ret;
+        }
+    }
+
+    ret = t->rbuf_len - t->rbuf_off;
+    *data = t->rbuf + t->rbuf_off;
+
+    return (ret > len) ? len : ret;
+}
+
+/**
+ * @brief Drops buffered data returned by tuya_transporter_peek().
+ *
+ * @param t The transporter, with a read buffer.
+ * @param len The bytes to drop.
+ *
+ * @return OPRT_OK on success, OPRT_INVALID_PARM when fewer bytes are buffered.
+ */
+OPERATE_RET tuya_transporter_consume(tuya_transporter_t t, int len)
+{
+    if (NULL == t || len < 0 || len > t->rbuf_len - t->rbuf_off) {
+        return OPRT_INVALID_PARM;
+    }
+
+    t->rbuf_off += len;
+    if (t->rbuf_off == t->rbuf_len) {
+        t->rbuf_off = 0;
+        t->rbuf_len = 0;
+    }
+
+    return OPRT_OK;
 }
 
 /**
@@ -210,11 +412,82 @@ OPERATE_RET tuya_transporter_read(tuya_transporter_t transporter, uint8_t *buf,
 OPERATE_RET tuya_transporter_write(tuya_transporter_t t, uint8_t *buf, int len, int timeout_ms)
 {
     if (t && t->f_write) {
-        return t->f_write(t, buf, len, timeout_ms);
+        SYS_TIME_T start = tal_system_get_millisecond();
+        int ret = t->f_write(t, buf, len, timeout_ms);
+        __transporter_stat_io(t, FALSE, ret, start);
+        return ret;
     }
     return OPRT_INVALID_PARM;
 }
 
+static OPERATE_RET __transporter_writev(tuya_transporter_t t, const TAL_NET_IOVEC_T *iov, int iovcnt, int timeout_ms)
+{
+    uint8_t stack_buf[TAL_NET_IOV_STACK_BUF];
+    uint8_t *buf = stack_buf;
+    int len = 0, off = 0, i;
+    OPERATE_RET ret = OPRT_OK;
+
+    if (t->f_writev) {
+        return t->f_writev(t, iov, iovcnt, timeout_ms);
+    }
+
+    if (NULL == t->f_write) {
+        return OPRT_INVALID_PARM;
+    }
+
+    if (1 == iovcnt) {
+        return t->f_write(t, iov[0].iov_base, iov[0].iov_len, timeout_ms);
+    }
+
+    for (i = 0; i < iovcnt; i++) {
+        len += iov[i].iov_len;
+    }
+    if (len > (int)SIZEOF(stack_buf)) {
+        buf = tal_malloc(len);
+        if (NULL == buf) {
+            return OPRT_MALLOC_FAILED;
+        }
+    }
+    for (i = 0; i < iovcnt; i++) {
+        memcpy(buf + off, iov[i].iov_base, iov[i].iov_len);
+        off += iov[i].iov_len;
+    }
+
+    ret = t->f_write(t, buf, len, timeout_ms);
+
+    if (buf != stack_buf) {
+        tal_free(buf);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Writes data gathered from several buffers to the Tuya transporter.
+ *
+ * @param t The Tuya transporter to write data to.
+ * @param iov The buffers, written in order.
+ * @param iovcnt The number of buffers, up to TAL_NET_IOV_MAX.
+ * @param timeout_ms The timeout value in milliseconds for the write operation.
+ *
+ * @return The number of bytes written on success, or a negative error code on
+ * failure.
+ */
+OPERATE_RET tuya_transporter_writev(tuya_transporter_t t, const TAL_NET_IOVEC_T *iov, int iovcnt, int timeout_ms)
+{
+    if (NULL == t || NULL == iov || iovcnt <= 0 || iovcnt > TAL_NET_IOV_MAX) {
+        return OPRT_INVALID_PARM;
+    }
+
+    SYS_TIME_T start = tal_system_get_millisecond();
+    OPERATE_RET ret = __transporter_writev(t, iov, iovcnt, timeout_ms);
+    if (OPRT_INVALID_PARM != ret && OPRT_MALLOC_FAILED != ret) {
+        __transporter_stat_io(t, FALSE, ret, start);
+    }
+
+    return ret;
+}
+
 /**
  * @brief Reads data from the transport layer using polling.
  *
@@ -230,6 +503,9 @@ OPERATE_RET tuya_transporter_write(tuya_transporter_t t, uint8_t *buf, int len,
  */
 OPERATE_RET tuya_transporter_poll_read(tuya_transporter_t t, int timeout_ms)
 {
+    if (t && t->rbuf_off != t->rbuf_len) {
+        return 1;
+    }
     if (t && t->f_poll_read) {
         return t->f_poll_read(t, timeout_ms);
     }
@@ -276,10 +552,26 @@ OPERATE_RET tuya_transporter_poll_write(tuya_transporter_t t, int timeout_ms)
  */
 OPERATE_RET tuya_transporter_connect(tuya_transporter_t t, const char *host, int port, int timeout_ms)
 {
-    if (t && t->f_connect) {
-        return t->f_connect(t, host, port, timeout_ms);
+    OPERATE_RET rt = OPRT_OK;
+
+    if (NULL == t || NULL == t->f_connect) {
+        return OPRT_INVALID_PARM;
     }
-    return OPRT_INVALID_PARM;
+
+    SYS_TIME_T start = tal_system_get_millisecond();
+    t->stat.handshake_ms = 0;
+    rt = t->f_connect(t, host, port, timeout_ms);
+
+    snprintf(t->stat.host, sizeof(t->stat.host), "%s", host ? host : "");
+    t->stat.port = port;
+    t->stat.connect_cnt++;
+    t->stat.connect_ms = (uint32_t)(tal_system_get_millisecond() - start);
+    if (OPRT_OK != rt) {
+        t->stat.connect_fail++;
+        t->stat.last_err = rt;
+    }
+
+    return rt;
 }
 
 /**
@@ -295,6 +587,11 @@ OPERATE_RET tuya_transporter_connect(tuya_transporter_t t, const char *host, int
  */
 OPERATE_RET tuya_transporter_close(tuya_transporter_t t)
 {
+    //! buffered data belongs to the closed connection
+    if (t) {
+        t->rbuf_off = 0;
+        t->rbuf_len = 0;
+    }
     if (t && t->f_close) {
         return t->f_close(t);
     }
@@ -315,6 +612,17 @@ OPERATE_RET tuya_transporter_close(tuya_transporter_t t)
  */
 OPERATE_RET tuya_transporter_ctrl(tuya_transporter_t t, uint32_t cmd, void *args)
 {
+    if (t && TUYA_TRANSPORTER_GET_STAT == cmd) {
+        if (NULL == args) {
+            return OPRT_INVALID_PARM;
+        }
+        memcpy(args, &t->stat, sizeof(tuya_transporter_stat_t));
+        return OPRT_OK;
+    }
+    if (t && TUYA_TRANSPORTER_RESET_STAT == cmd) {
+        __transporter_stat_reset(t);
+        return OPRT_OK;
+    }
     if (t && t->f_ctrl) {
         return t->f_ctrl(t, cmd, args);
     }
@@ -355,5 +663,122 @@ tuya_transporter_set_func(tuya_transporter_t t, transporter_connect_fn connect,
     t->f_destroy = destroy;
     t->f_ctrl = ctrl;
 
+#if TUYA_TRANSPORTER_STAT_NUM > 0
+    if (NULL == s_trans_stat.mutex && OPRT_OK != tal_mutex_create_init(&s_trans_stat.mutex)) {
+        return OPRT_OK;
+    }
+    tal_mutex_lock(s_trans_stat.mutex);
+    for (int i = 0; i < TUYA_TRANSPORTER_STAT_NUM; i++) {
+        if (NULL == s_trans_stat.list[i]) {
+            s_trans_stat.list[i] = t;
+            break;
+        }
+    }
+    tal_mutex_unlock(s_trans_stat.mutex);
+#endif
+
     return OPRT_OK;
 }
+
+/**
+ * @brief Undoes tuya_transporter_set_func(), called by the destroy function of
+ * a transporter before it frees the transporter.
+ *
+ * @param t The transporter.
+ */
+void tuya_transporter_deinit(tuya_transporter_t t)
+{
+#if TUYA_TRANSPORTER_STAT_NUM > 0
+    if (NULL == t || NULL == s_trans_stat.mutex) {
+        return;
+    }
+    tal_mutex_lock(s_trans_stat.mutex);
+    for (int i = 0; i < TUYA_TRANSPORTER_STAT_NUM; i++) {
+        if (t == s_trans_stat.list[i]) {
+            s_trans_stat.list[i] = NULL;
+        }
+    }
+    tal_mutex_unlock(s_trans_stat.mutex);
+#endif
+}
+
+#if TUYA_TRANSPORTER_STAT_NUM > 0
+static const char *__transporter_name(tuya_transporter_t t)
+{
+    if (tuya_tcp_transporter_destroy == t->f_destroy) {
+        return "tcp";
+    } else if (tuya_tls_transporter_destroy == t->f_destroy) {
+        return "tls";
+    }
+#if defined(ENABLE_WEBSOCKET) && (ENABLE_WEBSOCKET == 1)
+    else if (tuya_websocket_transporter_destroy == t->f_destroy) {
+        return "ws";
+    }
+#endif
+    return "?";
+}
+
+static void __cli_trans_stat(int argc, char *argv[])
+{
+    char line[224];
+    BOOL_T reset = (argc > 1 && 0 == strcmp(argv[1], "reset"));
+
+    if (NULL == s_trans_stat.mutex) {
+        return;
+    }
+
+    tal_mutex_lock(s_trans_stat.mutex);
+    for (int i = 0; i < TUYA_TRANSPORTER_STAT_NUM; i++) {
+        tuya_transporter_t t = s_trans_stat.list[i];
+        if (NULL == t) {
+            continue;
+        }
+        if (reset) {
+            __transporter_stat_reset(t);
+            continue;
+        }
+        tuya_transporter_stat_t *st = &t->stat;
+        snprintf(line, sizeof(line),
+                 "%s %s:%u conn %u fail %u %ums hs %ums | in %uB %u reads %ums timeout %u err %u | "
+                 "out %uB %u writes %ums err %u | last err %d",
+                 __transporter_name(t), st->host, st->port, st->connect_cnt, st->connect_fail, st->connect_ms,
+                 st->handshake_ms, st->bytes_in, st->read_cnt, st->read_ms, st->read_timeout, st->read_err,
+                 st->bytes_out, st->write_cnt, st->write_ms, st->write_err, st->last_err);
+        tal_cli_echo(line);
+    }
+    tal_mutex_unlock(s_trans_stat.mutex);
+}
+
+static const cli_cmd_t s_trans_cli_cmd[] = {
+    {
+        .name = "trans_stat",
+        .help = "trans_stat [reset], show transporter counters",
+        .func = __cli_trans_stat,
+    },
+};
+
+static const cli_cmd_t s_trans_perf_cmd[] = {
+    {
+        .name = "net",
+        .help = "net [reset], transporter counters",
+        .func = __cli_trans_stat,
+    },
+};
+#endif
+
+/**
+ * @brief Registers the trans_stat CLI command, which prints the counters of
+ * the transporters, "trans_stat reset" clears them. They are also shown by
+ * "perf net".
+ *
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tuya_transporter_cli_init(void)
+{
+#if TUYA_TRANSPORTER_STAT_NUM > 0
+    tal_cli_perf_register(s_trans_perf_cmd, CNTSOF(s_trans_perf_cmd));
+    return tal_cli_cmd_register(s_trans_cli_cmd, CNTSOF(s_trans_cli_cmd));
+#else
+    return OPRT_NOT_SUPPORTED;
+#endif
+}
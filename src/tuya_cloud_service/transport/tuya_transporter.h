@@ -28,6 +28,7 @@ extern "C" {
 #endif
 
 #include "tuya_cloud_types.h"
+#include "tal_network.h"
 
 /*tuya transporter command definitions*/
 #define TUYA_TRANSPORTER_SET_TLS_CERT         0x0001
@@ -36,6 +37,50 @@ extern "C" {
 #define TUYA_TRANSPORTER_SET_WEBSOCKET_CONFIG 0x0004
 #define TUYA_TRANSPORTER_SET_TLS_CONFIG       0x0005
 #define TUYA_TRANSPORTER_GET_TLS_CONFIG       0x0006
+#define TUYA_TRANSPORTER_GET_STAT             0x0007 // args: tuya_transporter_stat_t *
+#define TUYA_TRANSPORTER_RESET_STAT           0x0008
+
+/**
+ * @brief Read buffer of the TCP transporter under a TLS transporter, so the
+ * record header and the start of the record come with one socket read.
+ * 0 disables it.
+ */
+#ifndef TUYA_TRANSPORTER_TLS_READ_BUF_SIZE
+#define TUYA_TRANSPORTER_TLS_READ_BUF_SIZE 1024
+#endif
+
+/**
+ * @brief Number of transporters listed by the trans_stat CLI command, see
+ * tuya_transporter_cli_init(). The counters are kept regardless.
+ */
+#ifndef TUYA_TRANSPORTER_STAT_NUM
+#define TUYA_TRANSPORTER_STAT_NUM 8
+#endif
+
+#define TUYA_TRANSPORTER_STAT_HOST_LEN 32
+
+/**
+ * @brief Counters of one transporter, kept by tuya_transporter_connect(),
+ * _read(), _write() and _writev(). Byte counts wrap at 4 GB.
+ */
+typedef struct {
+    char host[TUYA_TRANSPORTER_STAT_HOST_LEN]; // peer of the last connect, truncated
+    uint16_t port;
+    uint32_t connect_cnt;
+    uint32_t connect_fail;
+    uint32_t connect_ms;   // duration of the last connect
+    uint32_t handshake_ms; // part of it spent in the TLS handshake, TLS only
+    uint32_t bytes_in;
+    uint32_t bytes_out;
+    uint32_t read_cnt;
+    uint32_t write_cnt;
+    uint32_t read_ms; // time spent in reads and writes
+    uint32_t write_ms;
+    uint32_t read_timeout; // reads that found no data in time
+    uint32_t read_err;
+    uint32_t write_err;
+    OPERATE_RET last_err;
+} tuya_transporter_stat_t;
 
 struct socket_config_t {
     uint8_t isBlock;
@@ -74,6 +119,9 @@ typedef OPERATE_RET (*transporter_read_fn)(tuya_transporter_t transporter, uint8
 
 typedef OPERATE_RET (*transporter_write_fn)(tuya_transporter_t transporter, uint8_t *buf, int len, int timeout_ms);
 
+typedef OPERATE_RET (*transporter_writev_fn)(tuya_transporter_t transporter, const TAL_NET_IOVEC_T *iov, int iovcnt,
+                                             int timeout_ms);
+
 typedef OPERATE_RET (*transporter_poll_read_fn)(tuya_transporter_t transporter, int timeout_ms);
 
 typedef OPERATE_RET (*transporter_poll_write_fn)(tuya_transporter_t transporter, int timeout_ms);
@@ -92,6 +140,13 @@ struct tuya_transporter_inter_t {
     transporter_close_fn f_close;
     transporter_destroy_fn f_destroy;
     transporter_ctrl f_ctrl;
+    transporter_writev_fn f_writev; // optional, set after tuya_transporter_set_func()
+    //! optional, see tuya_transporter_set_read_buffer()
+    uint8_t *rbuf;
+    uint16_t rbuf_size;
+    uint16_t rbuf_off;
+    uint16_t rbuf_len;
+    tuya_transporter_stat_t stat;
 };
 
 /**
@@ -233,6 +288,24 @@ OPERATE_RET tuya_transporter_read(tuya_transporter_t transporter, uint8_t *buf,
  */
 OPERATE_RET tuya_transporter_write(tuya_transporter_t transporter, uint8_t *buf, int len, int timeout_ms);
 
+/**
+ * @brief Writes data gathered from several buffers to the specified
+ * transporter.
+ *
+ * The buffers are written as if they were joined, for example a frame header
+ * and its payload. A transporter without f_writev gets them joined in one
+ * buffer and written by f_write.
+ *
+ * @param transporter The transporter to write data to.
+ * @param iov The buffers, written in order.
+ * @param iovcnt The number of buffers, up to TAL_NET_IOV_MAX.
+ * @param timeout_ms The timeout value in milliseconds for the write operation.
+ * @return The number of bytes written on success, or a negative error code on
+ * failure.
+ */
+OPERATE_RET tuya_transporter_writev(tuya_transporter_t transporter, const TAL_NET_IOVEC_T *iov, int iovcnt,
+                                    int timeout_ms);
+
 /**
  * @brief Reads data from the transporter using polling mechanism.
  *
@@ -250,6 +323,47 @@ OPERATE_RET tuya_transporter_write(tuya_transporter_t transporter, uint8_t *buf,
  */
 OPERATE_RET tuya_transporter_poll_read(tuya_transporter_t transporter, int timeout_ms);
 
+/**
+ * @brief Gives a transporter a read buffer.
+ *
+ * tuya_transporter_read() then reads up to size bytes from the transporter at
+ * once and serves small reads from the buffer, reads of at least size bytes
+ * that find it empty go to the transporter directly.
+ * tuya_transporter_poll_read() reports buffered data as readable.
+ *
+ * @param transporter The transporter.
+ * @param size The buffer size, 0 removes the buffer.
+ *
+ * @return OPRT_OK on success, OPRT_COM_ERROR when data is buffered, or another
+ * error code on failure.
+ */
+OPERATE_RET tuya_transporter_set_read_buffer(tuya_transporter_t transporter, uint16_t size);
+
+/**
+ * @brief Returns buffered data without consuming it.
+ *
+ * Reads from the transporter once when fewer than len bytes are buffered.
+ *
+ * @param transporter The transporter, with a read buffer.
+ * @param data Set to the buffered data.
+ * @param len The bytes wanted, at most the buffer size.
+ * @param timeout_ms The timeout value in milliseconds for the read.
+ *
+ * @return The number of bytes at data, up to len, or the error of the read
+ * when nothing is buffered.
+ */
+OPERATE_RET tuya_transporter_peek(tuya_transporter_t transporter, uint8_t **data, int len, int timeout_ms);
+
+/**
+ * @brief Drops buffered data returned by tuya_transporter_peek().
+ *
+ * @param transporter The transporter, with a read buffer.
+ * @param len The bytes to drop.
+ *
+ * @return OPRT_OK on success, OPRT_INVALID_PARM when fewer bytes are buffered.
+ */
+OPERATE_RET tuya_transporter_consume(tuya_transporter_t transporter, int len);
+
 /**
  * @brief Closes the specified transporter.
  *
@@ -300,6 +414,23 @@ OPERATE_RET tuya_transporter_set_func(tuya_transporter_t transporter, transporte
                                       transporter_poll_read_fn poll_read, transporter_poll_read_fn poll_write,
                                       transporter_destroy_fn destroy, transporter_ctrl ctrl);
 
+/**
+ * @brief Undoes tuya_transporter_set_func(), called by the destroy function of
+ * a transporter before it frees the transporter.
+ *
+ * @param transporter The transporter.
+ */
+void tuya_transporter_deinit(tuya_transporter_t transporter);
+
+/**
+ * @brief Registers the trans_stat CLI command, which prints the counters of
+ * the transporters, "trans_stat reset" clears them. They are also shown by
+ * "perf net".
+ *
+ * @return OPRT_OK on success, or an error code on failure.
+ */
+OPERATE_RET tuya_transporter_cli_init(void);
+
 /**
  * @brief Set the transporter interface
  *
@@ -298,6 +298,7 @@ OPERATE_RET tuya_websocket_transporter_destroy(tuya_transporter_t transporter)
         wst->scheme = NULL;
     }
     if (transporter) {
+        tuya_transporter_deinit(transporter);
         Free(transporter);
     }
     return OPRT_OK;
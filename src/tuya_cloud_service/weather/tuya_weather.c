@@ -22,6 +22,7 @@
 #include "tuya_iot.h"
 
 #include "atop_base.h"
+#include "atop_cache.h"
 #include "cJSON.h"
 
 /***********************************************************
@@ -32,6 +33,22 @@
 #define WEATHER_API              "thing.weather.get"
 #define API_VERSION              "1.0"
 
+/**
+ * @brief How long results are taken from the atop cache, in seconds, for the
+ * current conditions, for forecasts and for the city.
+ */
+#ifndef WEATHER_CACHE_CURRENT_TTL_S
+#define WEATHER_CACHE_CURRENT_TTL_S  (10 * 60)
+#endif
+
+#ifndef WEATHER_CACHE_FORECAST_TTL_S
+#define WEATHER_CACHE_FORECAST_TTL_S (60 * 60)
+#endif
+
+#ifndef WEATHER_CACHE_CITY_TTL_S
+#define WEATHER_CACHE_CITY_TTL_S     (24 * 60 * 60)
+#endif
+
 /**
  * @brief Retrieves weather data from the Tuya cloud platform.
  *
@@ -40,7 +57,7 @@
  * synchronization, and constructs the appropriate API request with timestamp
  * and authentication data.
  *
- * @param code The weather data codes to request from the cloud platform.
+ * @param arg The weather data codes to request from the cloud platform.
  * @param response Pointer to store the response from the cloud platform.
  *
  * @return The operation result status. Possible values are:
@@ -49,9 +66,10 @@
  *         - OPRT_MALLOC_FAILED: Memory allocation failed.
  *         - Other error codes: Operation failed.
  */
-static OPERATE_RET tuya_weather_get(const char* code, atop_base_response_t *response)
+static int tuya_weather_fetch(void *arg, atop_base_response_t *response)
 {
     OPERATE_RET rt = OPRT_OK;
+    const char *code = (const char *)arg;
     TIME_T timestamp = 0;
     char *post_data = NULL;
     int post_data_len = 0;
@@ -110,6 +128,23 @@ static OPERATE_RET tuya_weather_get(const char* code, atop_base_response_t *resp
     return rt;
 }
 
+/**
+ * @brief Retrieves weather data from the atop cache or the Tuya cloud platform.
+ *
+ * The weather codes name the cached result, a result younger than ttl_s is
+ * returned without a request.
+ *
+ * @param code The weather data codes to request from the cloud platform.
+ * @param ttl_s How long a cached result is used, in seconds.
+ * @param response Pointer to store the response from the cloud platform.
+ *
+ * @return The operation result status, see tuya_weather_fetch().
+ */
+static OPERATE_RET tuya_weather_get(const char *code, uint32_t ttl_s, atop_base_response_t *response)
+{
+    return atop_cache_request(code, ttl_s, tuya_weather_fetch, (void *)code, response);
+}
+
 /**
  * @brief Retrieves current weather conditions from the Tuya cloud platform.
  *
@@ -139,7 +174,7 @@ int tuya_weather_get_current_conditions(WEATHER_CURRENT_CONDITIONS_T *current_co
 
     memset(&response, 0, sizeof(atop_base_response_t));
 
-    rt = tuya_weather_get(request_code, &response);
+    rt = tuya_weather_get(request_code, WEATHER_CACHE_CURRENT_TTL_S, &response);
     if (OPRT_OK != rt || !response.success) {
         PR_ERR("tuya_weather_get current conditions error:%d", rt);
         return OPRT_COM_ERROR;
@@ -220,7 +255,7 @@ int tuya_weather_get_today_high_low_temp(int *high_temp, int *low_temp)
 
     memset(&response, 0, sizeof(atop_base_response_t));
 
-    rt = tuya_weather_get(request_code, &response);
+    rt = tuya_weather_get(request_code, WEATHER_CACHE_FORECAST_TTL_S, &response);
     if (OPRT_OK != rt || !response.success) {
         PR_ERR("tuya_weather_get today high low temp error:%d", rt);
         return OPRT_COM_ERROR;
@@ -280,7 +315,7 @@ int tuya_weather_get_current_wind(char *wind_dir, char *wind_speed)
 
     memset(&response, 0, sizeof(atop_base_response_t));
 
-    rt = tuya_weather_get(request_code, &response);
+    rt = tuya_weather_get(request_code, WEATHER_CACHE_CURRENT_TTL_S, &response);
     if (OPRT_OK != rt || !response.success) {
         PR_ERR("tuya_weather_get today high low temp error:%d", rt);
         return OPRT_COM_ERROR;
@@ -341,7 +376,7 @@ int tuya_weather_get_current_wind_cn(char *wind_dir, char *wind_speed, int *wind
 
     memset(&response, 0, sizeof(atop_base_response_t));
 
-    rt = tuya_weather_get(request_code, &response);
+    rt = tuya_weather_get(request_code, WEATHER_CACHE_CURRENT_TTL_S, &response);
     if (OPRT_OK != rt || !response.success) {
         PR_ERR("tuya_weather_get today high low temp error:%d", rt);
         return OPRT_COM_ERROR;
@@ -406,7 +441,7 @@ int tuya_weather_get_current_sunrise_sunset_gmt(char *sunrise, char *sunset)
 
     memset(&response, 0, sizeof(atop_base_response_t));
 
-    rt = tuya_weather_get(request_code, &response);
+    rt = tuya_weather_get(request_code, WEATHER_CACHE_FORECAST_TTL_S, &response);
     if (OPRT_OK != rt || !response.success) {
         PR_ERR("tuya_weather_get today high low temp error:%d", rt);
         return OPRT_COM_ERROR;
@@ -466,7 +501,7 @@ int tuya_weather_get_current_sunrise_sunset_local(char *sunrise, char *sunset)
 
     memset(&response, 0, sizeof(atop_base_response_t));
 
-    rt = tuya_weather_get(request_code, &response);
+    rt = tuya_weather_get(request_code, WEATHER_CACHE_FORECAST_TTL_S, &response);
     if (OPRT_OK != rt || !response.success) {
         PR_ERR("tuya_weather_get today high low temp error:%d", rt);
         return OPRT_COM_ERROR;
@@ -525,7 +560,7 @@ int tuya_weather_get_current_aqi(WEATHER_CURRENT_AQI_T *current_aqi)
 
     memset(&response, 0, sizeof(atop_base_response_t));
 
-    rt = tuya_weather_get(request_code, &response);
+    rt = tuya_weather_get(request_code, WEATHER_CACHE_CURRENT_TTL_S, &response);
     if (OPRT_OK != rt || !response.success) {
         PR_ERR("tuya_weather_get today high low temp error:%d", rt);
         return OPRT_COM_ERROR;
@@ -615,7 +650,7 @@ int tuya_weather_get_current_aqi_cn(WEATHER_CURRENT_AQI_T *current_aqi)
 
     memset(&response, 0, sizeof(atop_base_response_t));
 
-    rt = tuya_weather_get(request_code, &response);
+    rt = tuya_weather_get(request_code, WEATHER_CACHE_CURRENT_TTL_S, &response);
     if (OPRT_OK != rt || !response.success) {
         PR_ERR("tuya_weather_get today high low temp error:%d", rt);
         return OPRT_COM_ERROR;
@@ -716,7 +751,7 @@ int tuya_weather_get_forecast_conditions(int number, WEATHER_FORECAST_CONDITIONS
 
     memset(&response, 0, sizeof(atop_base_response_t));
 
-    rt = tuya_weather_get(request_code, &response);
+    rt = tuya_weather_get(request_code, WEATHER_CACHE_FORECAST_TTL_S, &response);
     if (OPRT_OK != rt || !response.success) {
         PR_ERR("tuya_weather_get today high low temp error:%d", rt);
         return OPRT_COM_ERROR;
@@ -814,7 +849,7 @@ int tuya_weather_get_forecast_conditions_cn(int number, int *weather, int *humi,
 
     memset(&response, 0, sizeof(atop_base_response_t));
 
-    rt = tuya_weather_get(request_code, &response);
+    rt = tuya_weather_get(request_code, WEATHER_CACHE_FORECAST_TTL_S, &response);
     if (OPRT_OK != rt || !response.success) {
         PR_ERR("tuya_weather_get today high low temp error:%d", rt);
         return OPRT_COM_ERROR;
@@ -894,7 +929,7 @@ int tuya_weather_get_forecast_wind(int number, char **wind_dir, char **wind_spee
 
     memset(&response, 0, sizeof(atop_base_response_t));
 
-    rt = tuya_weather_get(request_code, &response);
+    rt = tuya_weather_get(request_code, WEATHER_CACHE_FORECAST_TTL_S, &response);
     if (OPRT_OK != rt || !response.success) {
         PR_ERR("tuya_weather_get today high low temp error:%d", rt);
         return OPRT_COM_ERROR;
@@ -985,7 +1020,7 @@ int tuya_weather_get_forecast_high_low_temp(int number, int *high_temp, int *low
 
     memset(&response, 0, sizeof(atop_base_response_t));
 
-    rt = tuya_weather_get(request_code, &response);
+    rt = tuya_weather_get(request_code, WEATHER_CACHE_FORECAST_TTL_S, &response);
     if (OPRT_OK != rt || !response.success) {
         PR_ERR("tuya_weather_get today high low temp error:%d", rt);
         return OPRT_COM_ERROR;
@@ -1052,7 +1087,7 @@ int tuya_weather_get_city(char *province, char *city, char *area)
 
     memset(&response, 0, sizeof(atop_base_response_t));
 
-    rt = tuya_weather_get(request_code, &response);
+    rt = tuya_weather_get(request_code, WEATHER_CACHE_CITY_TTL_S, &response);
     if (OPRT_OK != rt || !response.success) {
         PR_ERR("tuya_weather_get today high low temp error:%d", rt);
         return OPRT_COM_ERROR;
@@ -121,6 +121,13 @@ typedef enum {
     tuya_p2p_rtc_frame_type_video_i
 } tuya_p2p_rtc_frame_type_e;
 
+// kcp settings of a channel: nodelay, update interval, fast resend, congestion control
+typedef enum tuya_p2p_rtc_kcp_profile {
+    TUYA_P2P_KCP_PROFILE_DEFAULT,     // 0, 10ms, 20, off
+    TUYA_P2P_KCP_PROFILE_LOW_LATENCY, // 1, 10ms, 2, off: small messages like signaling
+    TUYA_P2P_KCP_PROFILE_BULK,        // 0, 20ms, 0, on: downloads sharing the link with live media
+} tuya_p2p_rtc_kcp_profile_e;
+
 typedef enum tuya_p2p_rtc_connection_type {
     tuya_p2p_rtc_connection_type_p2p,
     tuya_p2p_rtc_connection_type_webrtc
@@ -291,6 +298,7 @@ typedef struct tuya_p2p_rtc_options {
     uint32_t max_pre_session_number;    // Allow simultaneous initiation or reception of several pre-connections
     uint32_t send_buf_size[TUYA_P2P_CHANNEL_NUMBER_MAX]; // Send buffer size for each channel, in bytes
     uint32_t recv_buf_size[TUYA_P2P_CHANNEL_NUMBER_MAX]; // Receive buffer size for each channel, in bytes
+    uint8_t kcp_profile[TUYA_P2P_CHANNEL_NUMBER_MAX];    // tuya_p2p_rtc_kcp_profile_e of each channel
     uint32_t video_bitrate_kbps; // Device side fills video bitrate, client side does not need to set
     uint32_t preconnect_enable;  // Whether to enable pre-connection, 1: enable, 0: disable
     uint32_t fragement_len;      // Data sending interface fragmentation length
@@ -422,6 +430,42 @@ void tuya_p2p_rtc_notify_exit();
 // return value: undefined
 int32_t tuya_p2p_rtc_check_buffer(int32_t handle, uint32_t channel_id, uint32_t *write_size, uint32_t *read_size,
                                   uint32_t *send_free_size);
+
+// kcp send state and counters of a channel since it was created, e.g. for bandwidth estimation by the sender
+typedef struct tuya_p2p_rtc_channel_stats {
+    uint32_t srtt_ms;           // Smoothed round trip time
+    uint32_t rto_ms;            // Retransmission timeout
+    uint32_t wait_send;         // Segments queued or in flight, not yet acknowledged
+    uint32_t xmit;              // Segments retransmitted on timeout
+    uint64_t write_bytes;       // Bytes written by the application
+    uint64_t read_bytes;        // Bytes read by the application
+    uint64_t socket_send_bytes; // Bytes sent on the socket, with kcp headers and retransmissions
+    uint64_t socket_recv_bytes; // Bytes received on the socket
+    uint32_t send_failed;       // Fragments not sent for a failed segment allocation or encryption
+    uint32_t recv_dropped;      // Packets dropped for a bad digest or decryption
+    uint32_t encrypt_count;     // Fragments encrypted
+    uint64_t encrypt_us;        // Time spent encrypting them
+} tuya_p2p_rtc_channel_stats_t;
+
+// Get the kcp send state of a channel
+// return value: 0 on success, TUYA_P2P_ERROR_INVALID_SESSION_HANDLE without a connection
+int32_t tuya_p2p_rtc_get_channel_stats(int32_t handle, uint32_t channel_id, tuya_p2p_rtc_channel_stats_t *stats);
+
+#define TUYA_P2P_CANDIDATE_TYPE_LEN 8
+#define TUYA_P2P_ADDRESS_LEN        56
+
+// ICE candidate pair of a connection
+typedef struct tuya_p2p_rtc_session_stats {
+    char local_type[TUYA_P2P_CANDIDATE_TYPE_LEN];  // host, srflx, prflx or relay, empty before negotiation
+    char remote_type[TUYA_P2P_CANDIDATE_TYPE_LEN]; // host, srflx, prflx or relay
+    char local_addr[TUYA_P2P_ADDRESS_LEN];         // ip:port
+    char remote_addr[TUYA_P2P_ADDRESS_LEN];        // ip:port
+    uint64_t connected_ms;                         // Time since the negotiation succeeded
+} tuya_p2p_rtc_session_stats_t;
+
+// Get the candidate pair of a connection
+// return value: 0 on success, TUYA_P2P_ERROR_INVALID_SESSION_HANDLE without a connection
+int32_t tuya_p2p_rtc_get_session_stats(int32_t handle, tuya_p2p_rtc_session_stats_t *stats);
 // Notify p2p sdk that a device just came online
 // Mainly used for low-power devices
 int32_t tuya_p2p_rtc_set_remote_online(char *remote_id);
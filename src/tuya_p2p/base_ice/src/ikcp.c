@@ -173,12 +173,22 @@ void ikcp_allocator(void *(*new_malloc)(size_t), void (*new_free)(void *))
 // allocate a new kcp segment
 static IKCPSEG *ikcp_segment_new(ikcpcb *kcp, int size)
 {
+    if (sizeof(IKCPSEG) + size <= kcp->seg_size && !iqueue_is_empty(&kcp->seg_free)) {
+        IKCPSEG *seg = iqueue_entry(kcp->seg_free.next, IKCPSEG, node);
+        iqueue_del(&seg->node);
+        return seg;
+    }
     return (IKCPSEG *)ikcp_malloc(sizeof(IKCPSEG) + size);
 }
 
 // delete a segment
 static void ikcp_segment_delete(ikcpcb *kcp, IKCPSEG *seg)
 {
+    char *p = (char *)seg;
+    if (kcp->seg_pool && p >= kcp->seg_pool && p < kcp->seg_pool + kcp->seg_size * kcp->seg_count) {
+        iqueue_add(&seg->node, &kcp->seg_free);
+        return;
+    }
     ikcp_free(seg);
 }
 
@@ -294,6 +304,11 @@ ikcpcb *ikcp_create(IUINT32 conv, void *user)
     kcp->dead_link = IKCP_DEADLINK;
     kcp->output = NULL;
     kcp->writelog = NULL;
+    kcp->process_pkt = NULL;
+    kcp->seg_pool = NULL;
+    iqueue_init(&kcp->seg_free);
+    kcp->seg_size = 0;
+    kcp->seg_count = 0;
 
     return kcp;
 }
@@ -332,6 +347,9 @@ void ikcp_release(ikcpcb *kcp)
         if (kcp->acklist) {
             ikcp_free(kcp->acklist);
         }
+        if (kcp->seg_pool) {
+            ikcp_free(kcp->seg_pool);
+        }
 
         kcp->nrcv_buf = 0;
         kcp->nsnd_buf = 0;
@@ -340,6 +358,7 @@ void ikcp_release(ikcpcb *kcp)
         kcp->ackcount = 0;
         kcp->buffer = NULL;
         kcp->acklist = NULL;
+        kcp->seg_pool = NULL;
         ikcp_free(kcp);
     }
 }
@@ -587,6 +606,32 @@ int ikcp_send(ikcpcb *kcp, const char *buffer, int len)
     return 0;
 }
 
+IKCPSEG *ikcp_send_seg_alloc(ikcpcb *kcp, int len)
+{
+    IKCPSEG *seg;
+    if (len < 0 || len > (int)kcp->mss)
+        return NULL;
+    seg = ikcp_segment_new(kcp, len);
+    if (seg == NULL)
+        return NULL;
+    seg->len = len;
+    return seg;
+}
+
+int ikcp_send_seg(ikcpcb *kcp, IKCPSEG *seg)
+{
+    seg->frg = 0;
+    iqueue_init(&seg->node);
+    iqueue_add_tail(&seg->node, &kcp->snd_queue);
+    kcp->nsnd_que++;
+    return 0;
+}
+
+void ikcp_send_seg_free(ikcpcb *kcp, IKCPSEG *seg)
+{
+    ikcp_segment_delete(kcp, seg);
+}
+
 //---------------------------------------------------------------------
 // parse ack
 //---------------------------------------------------------------------
@@ -898,10 +943,7 @@ int ikcp_input(ikcpcb *kcp, const char *data, long size)
                     seg->len = len;
                     seg->prepend = 0;
 
-                    if (len > 0) {
-                        memcpy(seg->data, data, len);
-                    }
-
+                    // ikcp_parse_data writes the data to seg, decoded by process_pkt if set
                     ikcp_parse_data(kcp, seg, data, len);
                 }
             }
@@ -1288,6 +1330,25 @@ int ikcp_setmtu(ikcpcb *kcp, int mtu)
     return 0;
 }
 
+int ikcp_segpool(ikcpcb *kcp, int count)
+{
+    IUINT32 i;
+    if (kcp->seg_pool != NULL || count <= 0)
+        return -1;
+    kcp->seg_size = (sizeof(IKCPSEG) + kcp->mtu + 7) & ~7;
+    kcp->seg_pool = (char *)ikcp_malloc(kcp->seg_size * count);
+    if (kcp->seg_pool == NULL) {
+        kcp->seg_size = 0;
+        return -2;
+    }
+    kcp->seg_count = count;
+    for (i = 0; i < kcp->seg_count; i++) {
+        IKCPSEG *seg = (IKCPSEG *)(kcp->seg_pool + kcp->seg_size * i);
+        iqueue_add_tail(&seg->node, &kcp->seg_free);
+    }
+    return 0;
+}
+
 int ikcp_interval(ikcpcb *kcp, int interval)
 {
     if (interval > 5000)
@@ -303,6 +303,9 @@ struct IKCPCB {
     int (*output)(const char *buf, int len, struct IKCPCB *kcp, void *user);
     void (*writelog)(const char *log, struct IKCPCB *kcp, void *user);
     int (*process_pkt)(void *user, int length, const char *input, char *output);
+    char *seg_pool;              // segments of seg_size bytes, see ikcp_segpool
+    struct IQUEUEHEAD seg_free;  // idle segments of seg_pool
+    IUINT32 seg_size, seg_count;
 };
 
 typedef struct IKCPCB ikcpcb;
@@ -399,6 +402,22 @@ IUINT32 ikcp_getsn(const void *ptr);
 
 void ikcp_setprocesspkt(ikcpcb *kcp, int (*process_pkt)(void *user, int length, const char *input, char *output));
 
+// keep 'count' segments of mtu bytes allocated for the life of kcp, call it
+// once after ikcp_setmtu. segments are taken from the pool first and the
+// allocator is used when it is empty
+int ikcp_segpool(ikcpcb *kcp, int count);
+
+// get a segment for a message of 'len' bytes (at most mss), the caller writes
+// the message to seg->data and queues it with ikcp_send_seg, so it is not
+// copied as ikcp_send does
+struct IKCPSEG *ikcp_send_seg_alloc(ikcpcb *kcp, int len);
+
+// queue a segment from ikcp_send_seg_alloc, kcp owns it afterwards
+int ikcp_send_seg(ikcpcb *kcp, struct IKCPSEG *seg);
+
+// drop a segment from ikcp_send_seg_alloc that was not queued
+void ikcp_send_seg_free(ikcpcb *kcp, struct IKCPSEG *seg);
+
 #ifdef __cplusplus
 }
 #endif
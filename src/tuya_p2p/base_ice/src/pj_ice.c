@@ -21,6 +21,10 @@ typedef struct pj_ice_session {
 
 bool g_bInited = false;
 #define KA_INTERVAL 300
+// Nomination starts this long after every component has a valid pair, pjnath waits 4 STUN RTOs by default
+#ifndef PJ_ICE_SESSION_NOMINATED_CHECK_DELAY_MS
+#define PJ_ICE_SESSION_NOMINATED_CHECK_DELAY_MS (2 * PJ_ICE_TA_VAL)
+#endif
 #define THIS_FILE   "pj_ice.c"
 #define INDENT      "    "
 
@@ -350,6 +354,7 @@ bool pj_ice_session_create(pj_ice_session_cfg_t *pCfg, pj_ice_session_t **ppIceS
     pj_ice_strans_cfg *pIceCfg = &pIceSession->iceCfg;
     pIceCfg->opt.aggressive = PJ_FALSE;
     pIceCfg->opt.trickle = PJ_ICE_SESS_TRICKLE_FULL;
+    pIceCfg->opt.nominated_check_delay = PJ_ICE_SESSION_NOMINATED_CHECK_DELAY_MS;
     ICE_WORKER_THREAD_PARAM *pIceThreadParam = malloc(sizeof(ICE_WORKER_THREAD_PARAM));
     pIceThreadParam->pIceSession = pIceSession;
     pIceThreadParam->pCfg = pIceCfg;
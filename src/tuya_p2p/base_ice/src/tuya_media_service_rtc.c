@@ -28,6 +28,7 @@
 #include "pj_sync_condition.h"
 #include <pjmedia/sdp.h>
 #include "tal_log.h"
+#include "tal_symmetry.h"
 
 #define IKCP_PACKET_HEADER_SIZE       24
 #define TUYA_P2P_SEND_BUFFER_SIZE_MAX (800 * 1024)
@@ -39,6 +40,16 @@
 #define SRTP_MASTER_SALT_LENGTH       14
 #define SRTP_MASTER_LENGTH            (SRTP_MASTER_KEY_LENGTH + SRTP_MASTER_SALT_LENGTH)
 #define ENCRYPT_MD5_LEN               16
+#define RTC_SEND_FRAGMENT_LEN         1200
+// kcp segments kept per channel, fewer when the send window is smaller
+#ifndef RTC_KCP_SEG_POOL_MAX
+#define RTC_KCP_SEG_POOL_MAX 32
+#endif
+// Peers whose last connected remote candidate is remembered, its pair is checked first next time
+#ifndef RTC_PEER_CACHE_NUM
+#define RTC_PEER_CACHE_NUM 4
+#endif
+#define RTC_PEER_CACHE_PRIO ((126u << 24) | (65535u << 8) | 255u) // Above any candidate pjnath gathers
 
 // CMD is transmitted using kcp's channel number field, and kcp uses little endian
 #define RTC_CHANNEL_CMD   (0x010000F3)
@@ -112,6 +123,10 @@ typedef struct rtc_channel {
     int64_t first_read_time_ms;
     int64_t first_read_try_time_ms;
     int64_t first_data_time_ms;
+    uint32_t send_failed;
+    uint32_t recv_dropped;
+    uint32_t encrypt_count;
+    uint64_t encrypt_us;
 
     void *aes_ctx_enc;
     void *aes_ctx_dec;
@@ -244,8 +259,16 @@ typedef struct tuya_p2p_rtc_session {
     pj_ice_session_t *pIce;
     pthread_t tid;
     bool bQuitKCPThread;
+
+    tuya_p2p_rtc_session_stats_t pair; // Set when the negotiation succeeds
+    uint64_t connected_time_ms;
 } tuya_p2p_rtc_session_t;
 
+typedef struct rtc_peer_cache {
+    char remote_id[64]; // Empty for a free slot
+    pj_sockaddr addr;   // Remote candidate of the last nominated pair
+} rtc_peer_cache_t;
+
 tuya_p2p_rtc_options_t g_options;
 static uint32_t g_uP2PSkill = TUYA_P2P_SDK_SKILL_BASIC /*TUYA_P2P_SDK_SKILL_NUMBER*/;
 tuya_p2p_rtc_session_t *g_pRtcSession = NULL;
@@ -260,6 +283,10 @@ static const unsigned char KCP_CMD_WINS = 84; // cmd: window size (tell)
 
 sync_cond_t g_syncCond;
 
+static rtc_peer_cache_t g_peer_cache[RTC_PEER_CACHE_NUM];
+static uint32_t g_peer_cache_next = 0;
+static pthread_mutex_t g_peer_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
 #define KA_INTERVAL 300
 #define THIS_FILE   "tuya_media_service_rtc2.c"
 
@@ -773,6 +800,43 @@ finish:
     return 0;
 }
 
+static void rtc_peer_cache_set(const char *remote_id, const pj_sockaddr *addr)
+{
+    rtc_peer_cache_t *entry = NULL;
+    uint32_t i;
+
+    pthread_mutex_lock(&g_peer_cache_lock);
+    for (i = 0; i < RTC_PEER_CACHE_NUM; i++) {
+        if (strcmp(g_peer_cache[i].remote_id, remote_id) == 0) {
+            entry = &g_peer_cache[i];
+            break;
+        }
+    }
+    if (entry == NULL) {
+        entry = &g_peer_cache[g_peer_cache_next];
+        g_peer_cache_next = (g_peer_cache_next + 1) % RTC_PEER_CACHE_NUM;
+        snprintf(entry->remote_id, sizeof(entry->remote_id), "%s", remote_id);
+    }
+    pj_sockaddr_cp(&entry->addr, addr);
+    pthread_mutex_unlock(&g_peer_cache_lock);
+}
+
+static bool rtc_peer_cache_match(const char *remote_id, const pj_sockaddr *addr)
+{
+    bool match = false;
+    uint32_t i;
+
+    pthread_mutex_lock(&g_peer_cache_lock);
+    for (i = 0; i < RTC_PEER_CACHE_NUM; i++) {
+        if (g_peer_cache[i].remote_id[0] != '\0' && strcmp(g_peer_cache[i].remote_id, remote_id) == 0) {
+            match = (pj_sockaddr_cmp(&g_peer_cache[i].addr, addr) == 0);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_peer_cache_lock);
+    return match;
+}
+
 int ctx_session_add_remote_candidate(tuya_p2p_rtc_session_t *rtc, rtc_sdp_t *remote_sdp, char *candidate)
 {
     pj_ice_session_t *pIceSession = rtc->pIce;
@@ -790,6 +854,10 @@ int ctx_session_add_remote_candidate(tuya_p2p_rtc_session_t *rtc, rtc_sdp_t *rem
         0 /*|| cand.type == PJ_ICE_CAND_TYPE_HOST || cand.type == PJ_ICE_CAND_TYPE_RELAYED*/) {
         return -1;
     }
+    if (rtc_peer_cache_match(rtc->cfg.remote_id, &cand.addr)) {
+        tuya_p2p_log_info("remote candidate %s connected last time, check it first\n", candidate);
+        cand.prio = RTC_PEER_CACHE_PRIO;
+    }
     pj_str_t pjstrUFrag = pj_str(remote_sdp->ufrag);
     pj_str_t pjstrPasswd = pj_str(remote_sdp->password);
     pj_ice_session_add_remote_candidate(pIceSession, &pjstrUFrag, &pjstrPasswd, 1, &cand, false);
@@ -1119,6 +1187,17 @@ void ice_on_ice_complete(pj_ice_strans *ice_st, pj_ice_strans_op op, pj_status_t
             const pj_ice_sess_check *pIceSessCheck = pj_ice_strans_get_valid_pair(ice_st, comp_id);
             pj_sockaddr_print(&pIceSessCheck->lcand->addr, szLCandAddr, sizeof(szLCandAddr), 3);
             pj_sockaddr_print(&pIceSessCheck->rcand->addr, szRCandAddr, sizeof(szRCandAddr), 3);
+            tuya_p2p_rtc_session_stats_t *pair = &pRtcSession->pair;
+            snprintf(pair->local_type, sizeof(pair->local_type), "%s",
+                     pj_ice_get_cand_type_name(pIceSessCheck->lcand->type));
+            snprintf(pair->remote_type, sizeof(pair->remote_type), "%s",
+                     pj_ice_get_cand_type_name(pIceSessCheck->rcand->type));
+            snprintf(pair->local_addr, sizeof(pair->local_addr), "%s", szLCandAddr);
+            snprintf(pair->remote_addr, sizeof(pair->remote_addr), "%s", szRCandAddr);
+            pRtcSession->connected_time_ms = tuya_p2p_misc_get_timestamp_ms();
+            rtc_peer_cache_set(pRtcSession->cfg.remote_id, &pIceSessCheck->rcand->addr);
+            tuya_p2p_log_info("ice pair %s %s -> %s %s\n", pair->local_type, szLCandAddr, pair->remote_type,
+                              szRCandAddr);
 
             rtc_init_mbedtls_md_and_aes(pRtcSession);
             sync_cond_notify(&g_syncCond);
@@ -1224,6 +1303,7 @@ void rtc_process_kcp_data(tuya_p2p_rtc_session_t *rtc, const tuya_uv_buf_t *pkt)
 
         if (memcmp(digest, pkt->base + pkt->len - digest_len, digest_len)) {
             tuya_p2p_log_debug("invalid md code\n");
+            chan->recv_dropped++;
             return;
         }
     }
@@ -1411,8 +1491,11 @@ void ctx_session_channel_set_send_time(struct rtc_channel *chan)
 int ctx_session_channel_process_data(struct rtc_channel *chan, char *data, int len)
 {
     ctx_session_channel_set_data_time(chan);
+    //! the lock is shared with the senders for the kcp queues and its segment pool
+    pthread_mutex_lock(&chan->rtc->channel_lock);
     if (ikcp_input(chan->kcp, (const char *)data, len /*, tuya_p2p_misc_get_timestamp_ms()*/) > 0) {
     }
+    pthread_mutex_unlock(&chan->rtc->channel_lock);
     return 0;
 }
 
@@ -1434,6 +1517,7 @@ int ctx_session_channel_process_pkt(void *user, int length, const char *input, c
         // Subtract GCM signature length
         if (rtc->cfg.security_level == TUYA_P2P_SECURITY_LEVEL_4) {
             if (msg_size <= 16) {
+                chan->recv_dropped++;
                 return -1;
             }
             msg_size -= 16;
@@ -1448,10 +1532,28 @@ int ctx_session_channel_process_pkt(void *user, int length, const char *input, c
             }
         }
     }
+    if (ret <= 0) {
+        chan->recv_dropped++;
+    }
 
     return ret;
 }
 
+static void ctx_session_channel_set_kcp_profile(rtc_channel_t *chan, uint32_t profile)
+{
+    switch (profile) {
+    case TUYA_P2P_KCP_PROFILE_LOW_LATENCY:
+        ikcp_nodelay(chan->kcp, 1, 10, 2, 1);
+        break;
+    case TUYA_P2P_KCP_PROFILE_BULK:
+        ikcp_nodelay(chan->kcp, 0, 20, 0, 0);
+        break;
+    default:
+        ikcp_nodelay(chan->kcp, 0, 10, 20, 1);
+        break;
+    }
+}
+
 int tuya_p2p_rtc_channels_init(tuya_p2p_rtc_session_t *rtc)
 {
     uint32_t i = 0;
@@ -1468,14 +1570,17 @@ int tuya_p2p_rtc_channels_init(tuya_p2p_rtc_session_t *rtc)
         uint32_t channel_id;
         uint32_t send_buf_size;
         uint32_t recv_buf_size;
+        uint32_t kcp_profile;
         if (i == rtc->cfg.channel_number) {
             channel_id = RTC_CHANNEL_CMD;
             send_buf_size = 100 * 1024;
             recv_buf_size = 100 * 1024;
+            kcp_profile = TUYA_P2P_KCP_PROFILE_LOW_LATENCY;
         } else {
             channel_id = i;
             send_buf_size = g_options.send_buf_size[i];
             recv_buf_size = g_options.recv_buf_size[i];
+            kcp_profile = g_options.kcp_profile[i];
             // if (rtc->cfg.is_pre) {
             //     channel_id |= (rtc->active_handle << 16) & 0xFFFF0000;
             // }
@@ -1494,8 +1599,12 @@ int tuya_p2p_rtc_channels_init(tuya_p2p_rtc_session_t *rtc)
         ikcp_setoutput(chan->kcp, on_kcp_output);
         ikcp_wndsize(chan->kcp, send_buf_size / 1600  /*TUYA_MBUF_HUGE_SIZE*/,
                      recv_buf_size / 1600 /*TUYA_MBUF_HUGE_SIZE*/);
-        ikcp_nodelay(chan->kcp, 0, 10, 20, 1);
+        ctx_session_channel_set_kcp_profile(chan, kcp_profile);
         ikcp_setmtu(chan->kcp, 1400);
+        uint32_t seg_count = chan->kcp->snd_wnd < RTC_KCP_SEG_POOL_MAX ? chan->kcp->snd_wnd : RTC_KCP_SEG_POOL_MAX;
+        if (ikcp_segpool(chan->kcp, seg_count) != 0) {
+            tuya_p2p_log_warn("channel %d kcp segment pool failed\n", i);
+        }
         ikcp_setprocesspkt(chan->kcp, ctx_session_channel_process_pkt);
         // ikcp_setwritelog(chan->kcp, ctx_session_kcp_writelog);
         // ikcp_setlogmask(chan->kcp, IKCP_LOG_RTT | IKCP_LOG_INPUT | IKCP_LOG_OUTPUT);
@@ -1549,8 +1658,10 @@ void *rtc_worker_thread(void *arg)
         for (int i = 0; i < 3; ++i)                        //(rtc->cfg.channel_number + 1)
         {
             rtc_channel_t *channel = &rtc->channels[i];
+            pthread_mutex_lock(&rtc->channel_lock);
             ikcp_update(channel->kcp,
                         tuya_p2p_misc_get_timestamp_ms()); // Drive KCP state update and execute KCP send operation
+            pthread_mutex_unlock(&rtc->channel_lock);
         }
     }
     return NULL;
@@ -1608,19 +1719,30 @@ int32_t tuya_p2p_rtc_dosend_data(tuya_p2p_rtc_session_t *rtc, uint32_t channel_i
         //     continue;
         // }
 
-        int fragement_len = 1200;
-        int current = (remain > fragement_len) ? (fragement_len) : remain;
-        char decrypted[1500];
+        int current = (remain > RTC_SEND_FRAGMENT_LEN) ? (RTC_SEND_FRAGMENT_LEN) : remain;
         char *encrypted;
+        char *decrypted;
         int iv_size = sizeof(rtc->iv);
         int keylen = 16;
         int sign_size = 0;
         unsigned char padding_size = keylen;
-        int reserve_len_forkcp = sizeof(struct IKCPSEG) + IKCP_PACKET_HEADER_SIZE;
-        /* 60 bytes prepared for signature */
-        int reserve_len = sizeof(struct IKCPSEG) + IKCP_PACKET_HEADER_SIZE + sizeof(rtc->iv) + 60;
         int buflen;
 
+        // GCM encryption automatically generates 16-byte signature
+        if (rtc->cfg.security_level == TUYA_P2P_SECURITY_LEVEL_4) {
+            sign_size = 16;
+        }
+        //! the fragment is padded and encrypted behind the iv right in the kcp segment
+        struct IKCPSEG *seg = ikcp_send_seg_alloc(chan->kcp, iv_size + current + keylen - (current % keylen) + sign_size);
+        if (NULL == seg) {
+            chan->send_failed++;
+            pthread_mutex_unlock(&rtc->channel_lock);
+            tuya_p2p_log_error("channel %d kcp segment alloc failed\n", channel_id);
+            rc = -1;
+            break;
+        }
+        encrypted = seg->data;
+        decrypted = encrypted + iv_size;
         buflen = current;
         memcpy(decrypted, buf + already, buflen);
 
@@ -1638,31 +1760,28 @@ int32_t tuya_p2p_rtc_dosend_data(tuya_p2p_rtc_session_t *rtc, uint32_t channel_i
         // } else {
         //     encrypted = TUYA_MBUF_MTOD(mbuf_encrypted);
         // }
-        encrypted = (char *)malloc(buflen + reserve_len);
         char tmp_iv[16];
         tuya_p2p_misc_rand_hex(tmp_iv, sizeof(rtc->iv));
         memcpy(encrypted, tmp_iv, iv_size);
 
+        uint64_t encrypt_begin = tuya_uv_hrtime2();
         int ret = rtc_crypt_encrypt_aes_128_cbc(rtc, chan->aes_ctx_enc, buflen, (unsigned char *)tmp_iv,
-                                                (const unsigned char *)decrypted, (unsigned char *)encrypted + iv_size);
-
-        // GCM encryption automatically generates 16-byte signature
-        if (rtc->cfg.security_level == TUYA_P2P_SECURITY_LEVEL_4) {
-            sign_size = 16;
-        }
+                                                (const unsigned char *)decrypted, (unsigned char *)decrypted);
+        chan->encrypt_us += (tuya_uv_hrtime2() - encrypt_begin) / 1000;
+        chan->encrypt_count++;
 
         if (ret == 0) {
             // ikcp_send_mbuf(chan->kcp, mbuf_encrypted, buflen + iv_size + sign_size);
-            ikcp_send(chan->kcp, encrypted, buflen + iv_size + sign_size);
+            ikcp_send_seg(chan->kcp, seg);
             remain -= current;
             already += current;
             chan->write_bytes += current;
-            free(encrypted);
         } else {
+            ikcp_send_seg_free(chan->kcp, seg);
+            chan->send_failed++;
             pthread_mutex_unlock(&rtc->channel_lock);
             tuya_p2p_log_error("aes encrypt failed, ret = %d\n", ret);
             // tuya_mbuf_free(mbuf_encrypted);
-            free(encrypted);
             rc = -1;
             break;
         }
@@ -1878,6 +1997,57 @@ int32_t tuya_p2p_rtc_check_buffer(int32_t handle, uint32_t channel_id, uint32_t
     return ret;
 }
 
+int32_t tuya_p2p_rtc_get_channel_stats(int32_t handle, uint32_t channel_id, tuya_p2p_rtc_channel_stats_t *stats)
+{
+    int ret = 0;
+    if (stats == NULL) {
+        return TUYA_P2P_ERROR_INVALID_PARAMETER;
+    }
+    tal_mutex_lock(g_p2p_session_mutex);
+    if (g_pRtcSession == NULL) {
+        tal_mutex_unlock(g_p2p_session_mutex);
+        return TUYA_P2P_ERROR_INVALID_SESSION_HANDLE;
+    }
+    tuya_p2p_rtc_session_t *rtc = g_pRtcSession;
+    pthread_mutex_lock(&rtc->channel_lock);
+    if (rtc->channels != NULL && channel_id < rtc->cfg.channel_number) {
+        rtc_channel_t *chan = &rtc->channels[channel_id];
+        stats->srtt_ms = chan->kcp->rx_srtt;
+        stats->rto_ms = chan->kcp->rx_rto;
+        stats->wait_send = ikcp_waitsnd(chan->kcp);
+        stats->xmit = chan->kcp->xmit;
+        stats->write_bytes = chan->write_bytes;
+        stats->read_bytes = chan->read_bytes;
+        stats->socket_send_bytes = chan->socket_send_bytes;
+        stats->socket_recv_bytes = chan->socket_recv_bytes;
+        stats->send_failed = chan->send_failed;
+        stats->recv_dropped = chan->recv_dropped;
+        stats->encrypt_count = chan->encrypt_count;
+        stats->encrypt_us = chan->encrypt_us;
+    } else {
+        ret = TUYA_P2P_ERROR_INVALID_SESSION_HANDLE;
+    }
+    pthread_mutex_unlock(&rtc->channel_lock);
+    tal_mutex_unlock(g_p2p_session_mutex);
+    return ret;
+}
+
+int32_t tuya_p2p_rtc_get_session_stats(int32_t handle, tuya_p2p_rtc_session_stats_t *stats)
+{
+    if (stats == NULL) {
+        return TUYA_P2P_ERROR_INVALID_PARAMETER;
+    }
+    tal_mutex_lock(g_p2p_session_mutex);
+    if (g_pRtcSession == NULL || g_pRtcSession->connected_time_ms == 0) {
+        tal_mutex_unlock(g_p2p_session_mutex);
+        return TUYA_P2P_ERROR_INVALID_SESSION_HANDLE;
+    }
+    memcpy(stats, &g_pRtcSession->pair, sizeof(*stats));
+    stats->connected_ms = tuya_p2p_misc_get_timestamp_ms() - g_pRtcSession->connected_time_ms;
+    tal_mutex_unlock(g_p2p_session_mutex);
+    return 0;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 
 int rtc_init_mbedtls_md_and_aes(tuya_p2p_rtc_session_t *rtc)
@@ -1912,25 +2082,20 @@ int rtc_channel_aes_init(rtc_channel_t *chan)
 {
     tuya_p2p_rtc_session_t *rtc = chan->rtc;
     if (chan->aes_ctx_enc == NULL || chan->aes_ctx_dec == NULL) {
-        chan->aes_ctx_enc = (mbedtls_aes_context *)malloc(sizeof(mbedtls_aes_context));
-        chan->aes_ctx_dec = (mbedtls_aes_context *)malloc(sizeof(mbedtls_aes_context));
-        if (chan->aes_ctx_enc == NULL || chan->aes_ctx_dec == NULL) {
+        //! tal_aes runs on the AES engine of the platform when it has one (ENABLE_PLATFORM_AES)
+        if (tal_aes_create_init(&chan->aes_ctx_enc) != OPRT_OK || tal_aes_create_init(&chan->aes_ctx_dec) != OPRT_OK) {
             tuya_p2p_log_error("aes_ctx_enc or aes_ctx_dec is null\n");
             return -1;
         }
-        memset(chan->aes_ctx_enc, 0, sizeof(mbedtls_aes_context));
-        memset(chan->aes_ctx_dec, 0, sizeof(mbedtls_aes_context));
-        mbedtls_aes_init(chan->aes_ctx_enc);
-        mbedtls_aes_init(chan->aes_ctx_dec);
         int ret;
-        ret = mbedtls_aes_setkey_enc(chan->aes_ctx_enc, rtc->aes_key, sizeof(rtc->aes_key) * 8);
+        ret = tal_aes_setkey_enc(chan->aes_ctx_enc, rtc->aes_key, sizeof(rtc->aes_key) * 8);
         if (ret != 0) {
-            tuya_p2p_log_error("mbedtls_aes_setkey_enc failed\n");
+            tuya_p2p_log_error("tal_aes_setkey_enc failed\n");
             return -1;
         }
-        ret = mbedtls_aes_setkey_dec(chan->aes_ctx_dec, rtc->aes_key, sizeof(rtc->aes_key) * 8);
+        ret = tal_aes_setkey_dec(chan->aes_ctx_dec, rtc->aes_key, sizeof(rtc->aes_key) * 8);
         if (ret != 0) {
-            tuya_p2p_log_error("mbedtls_aes_setkey_dec failed\n");
+            tuya_p2p_log_error("tal_aes_setkey_dec failed\n");
             return -1;
         }
     }
@@ -1942,7 +2107,7 @@ int rtc_crypt_encrypt_aes_128_cbc(struct tuya_p2p_rtc_session *rtc, void *ctx, s
 {
     int ret = -1;
     if (ctx != NULL) {
-        ret = mbedtls_aes_crypt_cbc(ctx, MBEDTLS_AES_ENCRYPT, length, iv, input, output);
+        ret = tal_aes_crypt_cbc(ctx, SYMMETRY_ENCRYPT, length, iv, (uint8_t *)input, output);
     } else {
         tuya_p2p_log_error("aes_ctx_enc is null\n");
     }
@@ -1954,7 +2119,7 @@ int rtc_crypt_decrypt_aes_128_cbc(struct tuya_p2p_rtc_session *rtc, void *ctx, s
 {
     int ret = -1;
     if (ctx != NULL) {
-        ret = mbedtls_aes_crypt_cbc(ctx, MBEDTLS_AES_DECRYPT, length, iv, input, output);
+        ret = tal_aes_crypt_cbc(ctx, SYMMETRY_DECRYPT, length, iv, (uint8_t *)input, output);
     } else {
         tuya_p2p_log_error("aes_ctx_dec is null\n");
     }
@@ -1964,13 +2129,11 @@ int rtc_crypt_decrypt_aes_128_cbc(struct tuya_p2p_rtc_session *rtc, void *ctx, s
 int rtc_channel_aes_uninit(struct rtc_channel *chan)
 {
     if (chan->aes_ctx_enc != NULL) {
-        mbedtls_aes_free(chan->aes_ctx_enc);
-        free(chan->aes_ctx_enc);
+        tal_aes_free(chan->aes_ctx_enc);
         chan->aes_ctx_enc = NULL;
     }
     if (chan->aes_ctx_dec != NULL) {
-        mbedtls_aes_free(chan->aes_ctx_dec);
-        free(chan->aes_ctx_dec);
+        tal_aes_free(chan->aes_ctx_dec);
         chan->aes_ctx_dec = NULL;
     }
     return 0;
@@ -28,6 +28,7 @@ enum { AI_LOOPBACK = 1, AI_LINKLOCAL = 2, AI_DISABLE = 3, AI_NORMAL = 4 };
 #define TUYA_MAX(x, y) ((x) > (y) ? (x) : (y))
 #endif
 
+uint64_t tuya_uv_hrtime2(void);
 uint64_t tuya_p2p_misc_get_timestamp_ms();
 int32_t tuya_p2p_misc_check_timeout(uint64_t tbegin, uint32_t timeout);
 void tuya_p2p_misc_rand_string(char *buf, uint32_t size);
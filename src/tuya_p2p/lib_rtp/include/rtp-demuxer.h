@@ -8,6 +8,8 @@ extern "C" {
 #endif
 
 struct rtp_demuxer_t;
+struct rtp_queue_jitter_t;
+struct rtp_queue_stats_t;
 
 /// @param[in] param rtp_demuxer_create input param
 /// @param[in] packet rtp payload data
@@ -32,12 +34,20 @@ int rtp_demuxer_input(struct rtp_demuxer_t *rtp, const void *data, int bytes);
 /// @return >0-rtcp report length, 0-don't need send rtcp
 int rtp_demuxer_rtcp(struct rtp_demuxer_t *rtp, void *buf, int len);
 
+/// @param[in] jitter adaptive reorder jitter, see rtp_queue_set_jitter, NULL-fixed jitter of rtp_demuxer_create
+/// @param[in] nack 1-append generic NACK for missing packets to rtp_demuxer_rtcp, call it often to recover in time
+/// @return 0-ok, <0-error
+int rtp_demuxer_set_jitter(struct rtp_demuxer_t *rtp, const struct rtp_queue_jitter_t *jitter, int nack);
+
 /// @param[out] lost read lost packets by jitter
 /// @param[out] late received after read
 /// @param[out] misorder reorder packets
 /// @param[out] duplicate exist in unread queue
 void rtp_demuxer_stats(struct rtp_demuxer_t *rtp, int *lost, int *late, int *misorder, int *duplicate);
 
+/// @param[out] stats reorder queue stats, with jitter, concealment and NACK counters
+void rtp_demuxer_queue_stats(struct rtp_demuxer_t *rtp, struct rtp_queue_stats_t *stats);
+
 #if defined(__cplusplus)
 }
 #endif
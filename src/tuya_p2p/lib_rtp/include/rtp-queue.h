@@ -2,6 +2,7 @@
 #define _rtp_queue_h_
 
 #include "rtp-packet.h"
+#include "rtcp-header.h"
 
 #if defined(__cplusplus)
 extern "C" {
@@ -25,10 +26,35 @@ struct rtp_queue_stats_t {
     int late;    // two late
     int bad;     // bad seq
 
-    int lost; // read discard by threshold
+    int lost;      // read discard by threshold
+    int concealed; // gaps skipped by read, to be concealed by the decoder
+
+    int nack;      // packets requested by rtp_queue_nack
+    int recovered; // requested packets received in time
+
+    int jitter; // interarrival jitter(ms), with rtp_queue_set_jitter
+    int delay;  // current threshold(ms)
 };
 void rtp_queue_stats(rtp_queue_t *queue, struct rtp_queue_stats_t *stats);
 
+struct rtp_queue_jitter_t {
+    int min_delay; // ms, lower bound of the threshold
+    int max_delay; // ms, upper bound of the threshold, 0-threshold of rtp_queue_create
+    int factor;    // threshold = factor * interarrival jitter, e.g. 4
+};
+
+/// adapt the threshold to the measured interarrival jitter: a missing packet is waited for
+/// as long as the threshold, a packet arriving after that is late and discarded
+/// @param[in] jitter NULL-fixed threshold of rtp_queue_create
+/// @return 0-ok, <0-error
+int rtp_queue_set_jitter(rtp_queue_t *queue, const struct rtp_queue_jitter_t *jitter);
+
+/// generic NACK items for the packets missing in the queue, each packet is requested once
+/// @param[out] nack NACK items, PID and BLP(RFC4585 6.2.1)
+/// @param[in] count nack array size
+/// @return NACK item count
+int rtp_queue_nack(rtp_queue_t *queue, rtcp_nack_t *nack, int count);
+
 #if defined(__cplusplus)
 }
 #endif
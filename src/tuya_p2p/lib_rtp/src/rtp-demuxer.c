@@ -23,6 +23,9 @@ struct rtp_demuxer_t {
     void *payload;
     void *rtp;
 
+    int nack;       // send generic NACK with rtp_demuxer_rtcp
+    uint32_t media; // ssrc of the received packets
+
     rtp_demuxer_onpacket onpkt;
     void *param;
 };
@@ -183,6 +186,7 @@ int rtp_demuxer_input(struct rtp_demuxer_t *rtp, const void *data, int bytes)
         pkt = rtp_demuxer_alloc(rtp, data, bytes);
         if (!pkt)
             return -ENOMEM;
+        rtp->media = pkt->rtp.ssrc;
 
         r = rtp_queue_write(rtp->queue, pkt);
         if (r <= 0) // 0-discard packet(duplicate/too late)
@@ -229,9 +233,27 @@ int rtp_demuxer_rtcp(struct rtp_demuxer_t *rtp, void *buf, int len)
         rtp->clock = clock;
     }
 
+    if (rtp->nack && r >= 0 && len - r >= 12 + 4) {
+        rtcp_nack_t nack[16];
+        rtcp_rtpfb_t rtpfb;
+
+        memset(&rtpfb, 0, sizeof(rtpfb));
+        rtpfb.media = rtp->media;
+        rtpfb.u.nack.nack = nack;
+        rtpfb.u.nack.count = rtp_queue_nack(rtp->queue, nack, MIN((len - r - 12) / 4, 16));
+        if (rtpfb.u.nack.count > 0)
+            r += rtp_rtcp_rtpfb(rtp->rtp, (uint8_t *)buf + r, len - r, RTCP_RTPFB_NACK, &rtpfb);
+    }
+
     return r;
 }
 
+int rtp_demuxer_set_jitter(struct rtp_demuxer_t *rtp, const struct rtp_queue_jitter_t *jitter, int nack)
+{
+    rtp->nack = nack;
+    return rtp_queue_set_jitter(rtp->queue, jitter);
+}
+
 void rtp_demuxer_stats(struct rtp_demuxer_t *rtp, int *lost, int *late, int *misorder, int *duplicate)
 {
     struct rtp_queue_stats_t stats;
@@ -245,3 +267,8 @@ void rtp_demuxer_stats(struct rtp_demuxer_t *rtp, int *lost, int *late, int *mis
     if (duplicate)
         *duplicate = stats.duplicate;
 }
+
+void rtp_demuxer_queue_stats(struct rtp_demuxer_t *rtp, struct rtp_queue_stats_t *stats)
+{
+    rtp_queue_stats(rtp->queue, stats);
+}
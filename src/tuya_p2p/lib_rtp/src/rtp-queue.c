@@ -16,6 +16,8 @@
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 
+uint64_t rtpclock(void); // rtp-time.c, us
+
 struct rtp_item_t {
     struct rtp_packet_t *pkt;
     //	uint64_t clock;
@@ -38,6 +40,15 @@ struct rtp_queue_t {
 
     int threshold;
     int frequency;
+
+    int adaptive;
+    struct rtp_queue_jitter_t jitter;
+    uint32_t jitter16; // RFC3550 A.8 interarrival jitter * 16, in timestamp units
+    int64_t transit;
+    int transit_valid;
+
+    int nack_valid;
+    uint16_t nack_seq; // last requested sequence
     void (*free)(void *, struct rtp_packet_t *);
     void *param;
 
@@ -62,9 +73,33 @@ struct rtp_queue_t *rtp_queue_create(int threshold, int frequency, void (*freepk
     q->frequency = frequency;
     q->free = freepkt;
     q->param = param;
+    q->stats.delay = threshold;
     return q;
 }
 
+int rtp_queue_set_jitter(struct rtp_queue_t *q, const struct rtp_queue_jitter_t *jitter)
+{
+    int max_delay;
+
+    max_delay = q->adaptive ? q->jitter.max_delay : q->threshold;
+    if (!jitter) {
+        q->threshold = max_delay;
+        q->stats.delay = q->threshold;
+        q->adaptive = 0;
+        return 0;
+    }
+
+    if (q->frequency <= 0 || jitter->min_delay < 0 || jitter->factor <= 0)
+        return -EINVAL;
+
+    memcpy(&q->jitter, jitter, sizeof(q->jitter));
+    if (q->jitter.max_delay <= 0)
+        q->jitter.max_delay = max_delay;
+    q->jitter.max_delay = MAX(q->jitter.max_delay, q->jitter.min_delay);
+    q->adaptive = 1;
+    return 0;
+}
+
 int rtp_queue_destroy(struct rtp_queue_t *q)
 {
     rtp_queue_reset(q);
@@ -107,6 +142,31 @@ static void rtp_queue_reset(struct rtp_queue_t *q)
     q->pos = 0;
     q->size = 0;
     q->probation = RTP_SEQUENTIAL;
+    q->transit_valid = 0;
+    q->nack_valid = 0;
+}
+
+static void rtp_queue_jitter_update(struct rtp_queue_t *q, struct rtp_packet_t *pkt)
+{
+    int64_t transit, d;
+    int delay;
+
+    // RFC3550 A.8 Estimating the Interarrival Jitter
+    transit = (int64_t)(rtpclock() / 1000 * (uint64_t)q->frequency / 1000) - (int64_t)pkt->rtp.timestamp;
+    if (q->transit_valid) {
+        d = (int32_t)(transit - q->transit);
+        d = d < 0 ? -d : d;
+        q->jitter16 += (uint32_t)d - ((q->jitter16 + 8) >> 4);
+    }
+    q->transit = transit;
+    q->transit_valid = 1;
+
+    q->stats.jitter = (int)((uint64_t)(q->jitter16 >> 4) * 1000 / (uint64_t)q->frequency);
+    delay = q->jitter.factor * q->stats.jitter;
+    delay = MAX(delay, q->jitter.min_delay);
+    delay = MIN(delay, q->jitter.max_delay);
+    q->threshold = delay;
+    q->stats.delay = delay;
 }
 
 static int rtp_queue_find(struct rtp_queue_t *q, uint16_t seq)
@@ -185,6 +245,9 @@ int rtp_queue_write(struct rtp_queue_t *q, struct rtp_packet_t *pkt)
     uint16_t delta;
 
     q->stats.total++;
+    if (q->adaptive)
+        rtp_queue_jitter_update(q, pkt);
+
     if (q->probation) {
         if (q->size > 0 && (uint16_t)pkt->rtp.seq == q->last_seq + 1) {
             if (0 == --q->probation)
@@ -219,6 +282,9 @@ int rtp_queue_write(struct rtp_queue_t *q, struct rtp_packet_t *pkt)
             }
 
             ++q->stats.reorder;
+            if (q->nack_valid && (int16_t)(q->nack_seq - pkt->rtp.seq) >= 0 &&
+                (int16_t)(q->nack_seq - q->first_seq) >= 0)
+                ++q->stats.recovered;
             rtp_queue_reset_bad_items(q);
             return rtp_queue_insert(q, idx, pkt);
         } else if ((uint16_t)(q->first_seq - pkt->rtp.seq) < RTP_MISORDER) {
@@ -281,6 +347,7 @@ struct rtp_packet_t *rtp_queue_read(struct rtp_queue_t *q)
             return NULL;
 
         q->stats.lost += pkt->rtp.seq - q->first_seq;
+        q->stats.concealed++;
         q->first_seq = (uint16_t)(pkt->rtp.seq + 1);
         q->size--;
         q->pos = (q->pos + 1) % q->capacity;
@@ -293,6 +360,45 @@ void rtp_queue_stats(struct rtp_queue_t *q, struct rtp_queue_stats_t *stats)
     memcpy(stats, &q->stats, sizeof(*stats));
 }
 
+int rtp_queue_nack(struct rtp_queue_t *q, rtcp_nack_t *nack, int count)
+{
+    int i, n;
+    uint16_t seq, next;
+
+    if (q->size < 1 || q->probation || count < 1)
+        return 0;
+
+    if (q->nack_valid && (int16_t)(q->nack_seq - q->first_seq) < 0)
+        q->nack_valid = 0; // all requested packets were read or skipped
+
+    n = 0;
+    next = q->first_seq;
+    for (i = 0; i < q->size; i++) {
+        seq = (uint16_t)q->items[(q->pos + i) % q->capacity].pkt->rtp.seq;
+        for (; next != seq; next++) {
+            if (q->nack_valid && (int16_t)(next - q->nack_seq) <= 0)
+                continue; // requested already
+
+            if (n > 0 && (uint16_t)(next - nack[n - 1].pid) <= 16) {
+                nack[n - 1].blp |= (uint16_t)(1 << ((uint16_t)(next - nack[n - 1].pid) - 1));
+            } else if (n < count) {
+                nack[n].pid = next;
+                nack[n].blp = 0;
+                n++;
+            } else {
+                return n;
+            }
+
+            q->stats.nack++;
+            q->nack_seq = next;
+            q->nack_valid = 1;
+        }
+        next = seq + 1;
+    }
+
+    return n;
+}
+
 #if defined(_DEBUG) || defined(DEBUG)
 #include <stdio.h>
 static void rtp_queue_dump(struct rtp_queue_t *q)
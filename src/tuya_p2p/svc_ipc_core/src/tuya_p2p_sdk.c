@@ -196,6 +196,9 @@ OPERATE_RET __p2p_v3_login_init(INT_T preconnect, INT_T max_client, INT_T bitrat
     strOpt.recv_buf_size[TUYA_TRANS_CHANNEL] = 1024;
     strOpt.send_buf_size[TUYA_TRANS_CHANNEL5] = P2P_WR_BF_MAX_SIZE + P2P_SEND_REDUNDANCE_LEN;
     strOpt.recv_buf_size[TUYA_TRANS_CHANNEL5] = 1024 * 1024; // do not use
+    strOpt.kcp_profile[TUYA_CMD_CHANNEL] = TUYA_P2P_KCP_PROFILE_LOW_LATENCY;
+    strOpt.kcp_profile[TUYA_TRANS_CHANNEL] = TUYA_P2P_KCP_PROFILE_BULK;
+    strOpt.kcp_profile[TUYA_TRANS_CHANNEL5] = TUYA_P2P_KCP_PROFILE_BULK;
     mqttP2pRet = tuya_p2p_rtc_init(&strOpt);
     if (0 != mqttP2pRet) {
         PR_ERR("mqtt p2p init failed");
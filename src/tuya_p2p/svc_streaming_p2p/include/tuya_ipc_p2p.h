@@ -41,6 +41,10 @@ typedef struct tagMediaFrame {
 
 typedef INT_T (*tuya_p2p_rtc_disconnect_cb_t)();
 typedef INT_T (*tuya_p2p_rtc_get_frame_cb_t)(MEDIA_FRAME *pMediaFrame);
+// Bitrate the link to the viewer is estimated to carry, for the encoder of the stream
+typedef INT_T (*tuya_p2p_rtc_video_bitrate_cb_t)(IPC_STREAM_TYPE stream, UINT_T bitrate_kbps);
+// The stream sent to the viewer changed, its next frame given should be an I frame
+typedef INT_T (*tuya_p2p_rtc_key_frame_req_cb_t)(IPC_STREAM_TYPE stream);
 
 /**
  * @enum TRANS_DEFAULT_QUALITY_E
@@ -66,6 +70,32 @@ typedef struct {
     tuya_p2p_rtc_get_frame_cb_t on_get_audio_frame_callback;
 } TUYA_IPC_P2P_VAR_T;
 
+typedef struct {
+    UINT_T frames;      // Frames packetized and sent
+    UINT_T buffer_full; // Frames dropped for a full send buffer
+    UINT_T send_failed; // RTP packets the channel did not take
+} TUYA_IPC_P2P_STREAM_STATS_T;
+
+// Statistics of the connected session, counters are kept since the connection
+typedef struct {
+    CHAR_T local_type[8];  // ICE candidate type: host, srflx, prflx or relay
+    CHAR_T remote_type[8];
+    CHAR_T local_addr[56]; // ip:port
+    CHAR_T remote_addr[56];
+    UINT_T connected_s;
+    UINT_T rtt_ms;         // Smoothed rtt of the video channel
+    UINT_T target_kbps;    // Bandwidth estimate of the video channel
+    UINT_T video_kbps;     // Video sent in the last estimate interval
+    UINT_T loss;           // Video segments retransmitted in the last estimate interval, in percent
+    UINT_T send_kbps;      // Socket bitrates of all channels, averaged since the connection
+    UINT_T recv_kbps;
+    UINT_T xmit;           // KCP retransmissions of all channels
+    UINT_T recv_dropped;   // Packets dropped for a bad digest or decryption
+    UINT_T encrypt_us;     // Average encryption time of a fragment
+    TUYA_IPC_P2P_STREAM_STATS_T video;
+    TUYA_IPC_P2P_STREAM_STATS_T audio;
+} TUYA_IPC_P2P_STATS_T;
+
 //////////////////////////////external interface////////////////////////////////////////////
 OPERATE_RET p2p_init(IN CONST TUYA_IPC_P2P_VAR_T *p_var);
 OPERATE_RET p2p_rtc_listen_start();
@@ -77,6 +107,12 @@ OPERATE_RET tuya_p2p_rtc_register_get_video_frame_cb(tuya_p2p_rtc_get_frame_cb_t
 OPERATE_RET tuya_p2p_rtc_register_get_audio_frame_cb(tuya_p2p_rtc_get_frame_cb_t pCallback);
 INT_T OnGetVideoFrameCallback(MEDIA_FRAME *pMediaFrame);
 INT_T OnGetAudioFrameCallback(MEDIA_FRAME *pMediaFrame);
+OPERATE_RET tuya_p2p_rtc_register_video_bitrate_cb(tuya_p2p_rtc_video_bitrate_cb_t pCallback);
+OPERATE_RET tuya_p2p_rtc_register_key_frame_req_cb(tuya_p2p_rtc_key_frame_req_cb_t pCallback);
+// Video stream the frames of the video frame callback should come from
+IPC_STREAM_TYPE tuya_p2p_rtc_get_video_stream(VOID);
+// Statistics of the connected session, OPRT_RESOURCE_NOT_READY without one. Also dumped by the p2p_stat cli command
+OPERATE_RET tuya_ipc_p2p_get_stats(TUYA_IPC_P2P_STATS_T *stats);
 
 // OPERATE_RET tuya_ipc_tranfser_init(IN CONST TUYA_IPC_P2P_VAR_T *p_var);
 // OPERATE_RET tuya_ipc_tranfser_quit(VOID);
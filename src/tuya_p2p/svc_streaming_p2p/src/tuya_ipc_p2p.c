@@ -10,6 +10,7 @@
 #include "tal_system.h"
 #include "tal_memory.h"
 #include "tal_thread.h"
+#include "tal_cli.h"
 #include "tuya_ipc_p2p.h"
 #include "tuya_ipc_p2p_error.h"
 #include "tuya_ipc_p2p_inner.h"
@@ -33,6 +34,29 @@
 #define P2P_RECV_TIMEOUT            (30)
 
 #define P2P_CHECK_USER_TIMES (10000) // 10s
+
+// Sender side bandwidth estimate of the video channel
+#ifndef P2P_BWE_INTERVAL_MS
+#define P2P_BWE_INTERVAL_MS (1000)
+#endif
+#ifndef P2P_BWE_START_KBPS
+#define P2P_BWE_START_KBPS (1500)
+#endif
+#ifndef P2P_BWE_MIN_KBPS
+#define P2P_BWE_MIN_KBPS (200)
+#endif
+#ifndef P2P_BWE_MAX_KBPS
+#define P2P_BWE_MAX_KBPS TUYA_P2P_VIDEO_BITRATE_MAX
+#endif
+// Rtt above the lowest one seen that means the link is queuing
+#ifndef P2P_BWE_DELAY_MS
+#define P2P_BWE_DELAY_MS (100)
+#endif
+// Below it the sub stream is sent for high clarity, back above 5/4 of it
+#ifndef P2P_BWE_SUB_STREAM_KBPS
+#define P2P_BWE_SUB_STREAM_KBPS TUYA_P2P_VIDEO_BITRATE_MIN
+#endif
+#define P2P_BWE_SEGMENT_LEN (1200) // Fragment length of tuya_p2p_rtc_send_data
 // Password synchronization structure
 typedef struct P2P_CMD_PASSWD_ {
     int mark;        // Custom identification mark
@@ -81,6 +105,26 @@ typedef struct {
     CHAR_T ext_head_buff[P2P_EXT_HEAD_MAX_LEN]; // According to extended video header protocol head+ext(8)+rtp_len
 } RTP_PACK_NAL_ARG_T;
 
+// RTP packetizer of a stream, kept for the session
+typedef struct {
+    void *encoder;
+    INT_T payload; // Payload type the encoder was created for
+    RTP_PACK_NAL_ARG_T nal_arg;
+} P2P_RTP_STREAM_T;
+
+typedef struct {
+    UINT_T target_kbps;   // Estimated bitrate the link carries
+    UINT_T reported_kbps; // Last bitrate given to the bitrate callback
+    UINT_T min_rtt;       // Lowest smoothed rtt seen, the delay without queuing
+    UINT_T sent_kbps;     // Bitrate sent in the last interval
+    UINT_T loss;          // Retransmitted percent of the segments sent in the last interval
+    UINT_T xmit;          // Retransmissions at the last sample
+    UINT_T dropped;       // Frames dropped for a full send buffer since the last sample
+    UINT64_T write_bytes; // Bytes written at the last sample
+    SYS_TIME_T sample_ms; // Time of the last sample, 0 before the first
+    BOOL_T sub_stream;    // Sub stream sent instead of the main stream for bandwidth
+} P2P_BWE_T;
+
 typedef enum {
     P2P_IDLE = 0,
     P2P_VIDEO = 0x1, // Start live stream request
@@ -111,6 +155,8 @@ typedef struct {
     CHAR_T *p_audio_rtp_buff; // Audio RTP data buffer, reference size MTU+100
     USHORT_T video_seq_num;   // Video RTP packet sequence number
     USHORT_T audio_seq_num;   // Audio RTP packet sequence number
+    P2P_RTP_STREAM_T video_rtp;
+    P2P_RTP_STREAM_T audio_rtp;
     BOOL_T key_frame;
     UINT64_T v_pts;                                  // Video PTS
     UINT64_T v_timestamp;                            // Video absolute time (ms)
@@ -119,12 +165,16 @@ typedef struct {
     INT_T video_req_id;                              // Video request ID, used for preview, playback and other services
     INT_T audio_req_id;                              // Audio request ID
     TRANSFER_VIDEO_CLARITY_TYPE_INNER_E cur_clarity; // Current video clarity type
+    P2P_BWE_T bwe;
+    TUYA_IPC_P2P_STREAM_STATS_T stream_stats[TUYA_ADATA_CHANNEL + 1]; // By channel, for the p2p_stat cli command
     P2P_DATA_PARSE_T proto_parse;
     TRANS_IPC_AV_INFO_T av_Info; // TODO currently video parameters must be consistent
 
     tuya_p2p_rtc_disconnect_cb_t on_disconnect_callback;
     tuya_p2p_rtc_get_frame_cb_t on_get_video_frame_callback;
     tuya_p2p_rtc_get_frame_cb_t on_get_audio_frame_callback;
+    tuya_p2p_rtc_video_bitrate_cb_t on_video_bitrate_callback;
+    tuya_p2p_rtc_key_frame_req_cb_t on_key_frame_req_callback;
     THREAD_HANDLE cmd_recv_proc_thread;   // Command receive thread handle
     THREAD_HANDLE video_send_proc_thread; // Video send thread handle
     // TAL_VENC_FRAME_T tal_video_frame;
@@ -151,6 +201,7 @@ INT_T __p2p_session_all_stop(P2P_SESSION_T *pSession);
 INT_T __p2p_session_release_va(P2P_SESSION_T *pSession);
 VOID __p2p_thread_exit(THREAD_HANDLE thread);
 VOID __p2p_rtc_close(INT_T rtc_session, INT_T reason, P2P_SESSION_T* p2p_session);
+STATIC VOID __p2p_rtp_stream_release(P2P_RTP_STREAM_T *stream);
 
 void *rtp_alloc(void *param, int bytes);
 void rtp_free(void *param, void *packet);
@@ -416,10 +467,106 @@ IPC_STREAM_TYPE p2p_get_chn_idx(TRANSFER_VIDEO_CLARITY_TYPE_INNER_E cur_clarity)
         chn = eIpcStreamVideoMain;
         break;
     }
+    if (eIpcStreamVideoMain == chn && NULL != sg_p2p_session && sg_p2p_session->bwe.sub_stream) {
+        chn = eIpcStreamVideoSub;
+    }
 
     return chn;
 }
 
+IPC_STREAM_TYPE tuya_p2p_rtc_get_video_stream(VOID)
+{
+    if (NULL == sg_p2p_session) {
+        return eIpcStreamVideoMain;
+    }
+    return p2p_get_chn_idx(sg_p2p_session->cur_clarity);
+}
+
+/***********************************************************
+ *  Function: __p2p_bwe_update
+ *  Note:Estimate the bitrate of the video channel from its kcp state once per P2P_BWE_INTERVAL_MS, GCC style:
+ *       retransmissions above 10% cut it by half the loss, rtt queuing above the lowest rtt or frames dropped
+ *       for a full buffer cap it at 85% of the sent rate, otherwise it grows 8% while the rate is used.
+ *       The estimate is given to the bitrate callback and picks the sub stream when the main one does not fit.
+ *  Input: pSession session
+ *  Output: none
+ *  Return:
+ ***********************************************************/
+STATIC VOID __p2p_bwe_update(P2P_SESSION_T *pSession)
+{
+    P2P_BWE_T *bwe = &pSession->bwe;
+    tuya_p2p_rtc_channel_stats_t stats;
+    SYS_TIME_T now = tal_system_get_millisecond();
+
+    if (bwe->sample_ms && now - bwe->sample_ms < P2P_BWE_INTERVAL_MS) {
+        return;
+    }
+    if (0 != tuya_p2p_rtc_get_channel_stats(pSession->session, TUYA_VDATA_CHANNEL, &stats)) {
+        return;
+    }
+    if (0 == bwe->sample_ms) {
+        bwe->target_kbps = P2P_BWE_START_KBPS;
+        bwe->xmit = stats.xmit;
+        bwe->write_bytes = stats.write_bytes;
+        bwe->sample_ms = now;
+        return;
+    }
+
+    UINT64_T sent = stats.write_bytes - bwe->write_bytes;
+    UINT_T sent_kbps = (UINT_T)(sent * 8 / (now - bwe->sample_ms));
+    UINT_T loss = (stats.xmit - bwe->xmit) * 100 / (UINT_T)(sent / P2P_BWE_SEGMENT_LEN + 1);
+    loss = (loss > 100) ? 100 : loss;
+    if (stats.srtt_ms && (0 == bwe->min_rtt || stats.srtt_ms < bwe->min_rtt)) {
+        bwe->min_rtt = stats.srtt_ms;
+    }
+    BOOL_T overuse = (stats.srtt_ms > bwe->min_rtt + P2P_BWE_DELAY_MS) || bwe->dropped;
+
+    if (loss > 10) {
+        bwe->target_kbps = bwe->target_kbps * (100 - loss / 2) / 100;
+    } else if (overuse) {
+        if (bwe->target_kbps > sent_kbps * 85 / 100) {
+            bwe->target_kbps = sent_kbps * 85 / 100;
+        }
+    } else if (loss < 2 && sent_kbps * 2 >= bwe->target_kbps) {
+        bwe->target_kbps = bwe->target_kbps * 108 / 100;
+    }
+    if (bwe->target_kbps < P2P_BWE_MIN_KBPS) {
+        bwe->target_kbps = P2P_BWE_MIN_KBPS;
+    } else if (bwe->target_kbps > P2P_BWE_MAX_KBPS) {
+        bwe->target_kbps = P2P_BWE_MAX_KBPS;
+    }
+    bwe->sent_kbps = sent_kbps;
+    bwe->loss = loss;
+    bwe->xmit = stats.xmit;
+    bwe->dropped = 0;
+    bwe->write_bytes = stats.write_bytes;
+    bwe->sample_ms = now;
+
+    BOOL_T sub_stream = bwe->sub_stream;
+    if (!sub_stream && bwe->target_kbps < P2P_BWE_SUB_STREAM_KBPS) {
+        sub_stream = TRUE;
+    } else if (sub_stream && bwe->target_kbps > P2P_BWE_SUB_STREAM_KBPS * 5 / 4) {
+        sub_stream = FALSE;
+    }
+    IPC_STREAM_TYPE stream = p2p_get_chn_idx(pSession->cur_clarity);
+    if (sub_stream != bwe->sub_stream) {
+        bwe->sub_stream = sub_stream;
+        IPC_STREAM_TYPE next = p2p_get_chn_idx(pSession->cur_clarity);
+        PR_DEBUG("bwe %u kbps rtt %u/%u loss %u%%, stream %d -> %d", bwe->target_kbps, stats.srtt_ms, bwe->min_rtt,
+                 loss, stream, next);
+        if (next != stream && pSession->on_key_frame_req_callback) {
+            pSession->on_key_frame_req_callback(next);
+        }
+        stream = next;
+        bwe->reported_kbps = 0;
+    }
+    if (pSession->on_video_bitrate_callback &&
+        (bwe->target_kbps > bwe->reported_kbps * 11 / 10 || bwe->target_kbps < bwe->reported_kbps * 9 / 10)) {
+        bwe->reported_kbps = bwe->target_kbps;
+        pSession->on_video_bitrate_callback(stream, bwe->target_kbps);
+    }
+}
+
 TRANSFER_VIDEO_CLARITY_TYPE p2p_clarity_trans(TRANSFER_VIDEO_CLARITY_TYPE_INNER_E type)
 {
     if (TY_VIDEO_CLARITY_INNER_STANDARD == type) {
@@ -463,6 +610,7 @@ INT_T p2p_release_video_send_resource(P2P_SESSION_T *pSession)
         return OPRT_OK;
     }
 
+    __p2p_rtp_stream_release(&pSession->video_rtp);
     Free(pSession->p_video_rtp_buff);
     pSession->p_video_rtp_buff = NULL;
 
@@ -503,6 +651,7 @@ INT_T p2p_release_audio_send_resource(P2P_SESSION_T *pSession)
         return OPRT_OK;
     }
 
+    __p2p_rtp_stream_release(&pSession->audio_rtp);
     Free(pSession->p_audio_rtp_buff);
     pSession->p_audio_rtp_buff = NULL;
 
@@ -525,6 +674,7 @@ OPERATE_RET p2p_send_rtp_data(INT_T client, INT_T channel, CHAR_T *buff, INT_T l
     ret = tuya_p2p_rtc_send_data(sg_p2p_session->session, channel, buff, length, -1);
     if (ret != length) {
         PR_ERR("Write data failed [%d][%d]", ret, length);
+        sg_p2p_session->stream_stats[channel].send_failed++;
     }
     return OPRT_OK;
 }
@@ -605,11 +755,68 @@ STATIC OPERATE_RET __p2p_check_free_buffer_size(INT_T client, INT_T channel, INT
                    sendFreeSize, len, sg_p2p_session->session, channel);
         }
         retry_sum++;
+        sg_p2p_session->stream_stats[channel].buffer_full++;
+        if (TUYA_VDATA_CHANNEL == channel) {
+            sg_p2p_session->bwe.dropped++;
+        }
         ret = OPRT_RESOURCE_NOT_READY;
     }
     return ret;
 }
 
+STATIC VOID __p2p_rtp_stream_release(P2P_RTP_STREAM_T *stream)
+{
+    if (stream->encoder) {
+        rtp_payload_encode_destroy(stream->encoder);
+        stream->encoder = NULL;
+    }
+}
+
+/***********************************************************
+ *  Function: __p2p_pack_rtp_and_send
+ *  Note:Packetize a frame with the encoder of its stream and send the packets, the encoder is created on the
+ *       first frame and again when the payload type changes. Packets are built behind the extension header
+ *       in p_rtp_buff and sent from there.
+ *  Input: stream rtp stream, p_rtp_buff packet buffer of the stream, pSeq rtp sequence number of the stream
+ *  Output: pSeq next sequence number
+ *  Return:
+ ***********************************************************/
+STATIC OPERATE_RET __p2p_pack_rtp_and_send(P2P_RTP_STREAM_T *stream, INT_T client, INT_T channel, CHAR_T *p_rtp_buff,
+                                           INT_T payload, CHAR_T *codec_name, UINT_T ssrc, USHORT_T *pSeq,
+                                           UINT_T timestamp, CHAR_T *pData, INT_T len)
+{
+    OPERATE_RET ret = OPRT_OK;
+
+    stream->nal_arg.client = client;
+    stream->nal_arg.channel = channel;
+    stream->nal_arg.p_rtp_buff = p_rtp_buff;
+    if (stream->encoder && stream->payload != payload) {
+        __p2p_rtp_stream_release(stream);
+    }
+    if (NULL == stream->encoder) {
+        struct rtp_payload_t rtp_packer;
+        rtp_packer.alloc = rtp_alloc;
+        rtp_packer.free = rtp_free;
+        rtp_packer.packet = rtp_pack_packet_handler;
+        stream->encoder = rtp_payload_encode_create(payload, codec_name, *pSeq, ssrc, &rtp_packer, &stream->nal_arg);
+        if (NULL == stream->encoder) {
+            PR_ERR("rtp_payload_encode_create %s failed", codec_name);
+            return OPRT_MALLOC_FAILED;
+        }
+        stream->payload = payload;
+    }
+
+    ret = rtp_payload_encode_input(stream->encoder, pData, len, timestamp);
+    if (OPRT_OK != ret) {
+        PR_ERR("rtp_payload_encode_input %s error:%d", codec_name, ret);
+    } else {
+        sg_p2p_session->stream_stats[channel].frames++;
+    }
+    rtp_payload_encode_getinfo(stream->encoder, pSeq, &timestamp);
+
+    return ret;
+}
+
 /***********************************************************
  *  Function: __p2p_pack_h265_rtp_and_send
  *  Note:IPC stream data assembly RTP and send
@@ -634,28 +841,12 @@ STATIC OPERATE_RET __p2p_pack_h265_rtp_and_send(INT_T client, CHAR_T *pData, INT
         return OPRT_INVALID_PARM;
     }
 
-    RTP_PACK_NAL_ARG_T rtp_pack_nal_arg;
-    rtp_pack_nal_arg.client = client;
-    rtp_pack_nal_arg.channel = TUYA_VDATA_CHANNEL;
-    rtp_pack_nal_arg.p_rtp_buff = sg_p2p_session->p_video_rtp_buff;
-    memset(rtp_pack_nal_arg.ext_head_buff, 0, P2P_EXT_HEAD_MAX_LEN);
-    __p2p_ext_protocol_pack(client, 0, rtp_pack_nal_arg.ext_head_buff, &rtp_pack_nal_arg.fix_len);
-
-    void *pRtpDelegate = NULL;
-    struct rtp_payload_t rtp_packer;
-    rtp_packer.alloc = rtp_alloc;
-    rtp_packer.free = rtp_free;
-    rtp_packer.packet = rtp_pack_packet_handler;
-    uint16_t seq = sg_p2p_session->video_seq_num;
-    uint32_t ssrc = 10;
-    uint32_t timestamp = (UINT_T)sg_p2p_session->v_pts;
-    pRtpDelegate = rtp_payload_encode_create(/*H265_PAY_LOAD*/ 95, "H265", seq, ssrc, &rtp_packer, &rtp_pack_nal_arg);
-    ret = rtp_payload_encode_input(pRtpDelegate, pData, len, timestamp);
-    if (OPRT_OK != ret) {
-        PR_ERR("rtp_payload_encode_input h264 error:%d", ret);
-    }
-    rtp_payload_encode_getinfo(pRtpDelegate, &sg_p2p_session->video_seq_num, &timestamp);
-    rtp_payload_encode_destroy(pRtpDelegate);
+    memset(sg_p2p_session->video_rtp.nal_arg.ext_head_buff, 0, P2P_EXT_HEAD_MAX_LEN);
+    __p2p_ext_protocol_pack(client, 0, sg_p2p_session->video_rtp.nal_arg.ext_head_buff,
+                            &sg_p2p_session->video_rtp.nal_arg.fix_len);
+    ret = __p2p_pack_rtp_and_send(&sg_p2p_session->video_rtp, client, TUYA_VDATA_CHANNEL,
+                                  sg_p2p_session->p_video_rtp_buff, /*H265_PAY_LOAD*/ 95, "H265", 10,
+                                  &sg_p2p_session->video_seq_num, (UINT_T)sg_p2p_session->v_pts, pData, len);
 
     return ret;
 }
@@ -691,28 +882,12 @@ STATIC OPERATE_RET __p2p_pack_h264_rtp_and_send(INT_T client, CHAR_T *pData, INT
         return OPRT_INVALID_PARM;
     }
 
-    RTP_PACK_NAL_ARG_T rtp_pack_nal_arg;
-    rtp_pack_nal_arg.client = client;
-    rtp_pack_nal_arg.channel = TUYA_VDATA_CHANNEL;
-    rtp_pack_nal_arg.p_rtp_buff = sg_p2p_session->p_video_rtp_buff;
-    memset(rtp_pack_nal_arg.ext_head_buff, 0, P2P_EXT_HEAD_MAX_LEN);
-    __p2p_ext_protocol_pack(client, 0, rtp_pack_nal_arg.ext_head_buff, &rtp_pack_nal_arg.fix_len);
-
-    void *pRtpDelegate = NULL;
-    struct rtp_payload_t rtp_packer;
-    rtp_packer.alloc = rtp_alloc;
-    rtp_packer.free = rtp_free;
-    rtp_packer.packet = rtp_pack_packet_handler;
-    uint16_t seq = sg_p2p_session->video_seq_num;
-    uint32_t ssrc = 10;
-    uint32_t timestamp = (UINT_T)sg_p2p_session->v_pts;
-    pRtpDelegate = rtp_payload_encode_create(/*H264_PAY_LOAD*/ 96, "H264", seq, ssrc, &rtp_packer, &rtp_pack_nal_arg);
-    ret = rtp_payload_encode_input(pRtpDelegate, pData, len, timestamp);
-    if (OPRT_OK != ret) {
-        PR_ERR("rtp_payload_encode_input h264 error:%d", ret);
-    }
-    rtp_payload_encode_getinfo(pRtpDelegate, &sg_p2p_session->video_seq_num, &timestamp);
-    rtp_payload_encode_destroy(pRtpDelegate);
+    memset(sg_p2p_session->video_rtp.nal_arg.ext_head_buff, 0, P2P_EXT_HEAD_MAX_LEN);
+    __p2p_ext_protocol_pack(client, 0, sg_p2p_session->video_rtp.nal_arg.ext_head_buff,
+                            &sg_p2p_session->video_rtp.nal_arg.fix_len);
+    ret = __p2p_pack_rtp_and_send(&sg_p2p_session->video_rtp, client, TUYA_VDATA_CHANNEL,
+                                  sg_p2p_session->p_video_rtp_buff, /*H264_PAY_LOAD*/ 96, "H264", 10,
+                                  &sg_p2p_session->video_seq_num, (UINT_T)sg_p2p_session->v_pts, pData, len);
 
     return ret;
 }
@@ -818,21 +993,6 @@ STATIC OPERATE_RET __p2p_pack_g711_rtp_and_send(INT_T client, CHAR_T *pData, INT
         return OPRT_INVALID_PARM;
     }
 
-    RTP_PACK_NAL_ARG_T rtp_pack_nal_arg;
-    rtp_pack_nal_arg.client = client;
-    rtp_pack_nal_arg.channel = TUYA_ADATA_CHANNEL;
-    rtp_pack_nal_arg.p_rtp_buff = sg_p2p_session->p_audio_rtp_buff;
-    memset(rtp_pack_nal_arg.ext_head_buff, 0, P2P_EXT_HEAD_MAX_LEN);
-    __p2p_ext_protocol_pack(client, 1, rtp_pack_nal_arg.ext_head_buff, &rtp_pack_nal_arg.fix_len);
-
-    void *pRtpDelegate = NULL;
-    struct rtp_payload_t rtp_packer;
-    rtp_packer.alloc = rtp_alloc;
-    rtp_packer.free = rtp_free;
-    rtp_packer.packet = rtp_pack_packet_handler;
-    uint16_t seq = sg_p2p_session->audio_seq_num;
-    uint32_t ssrc = 11;
-    uint32_t timestamp = (UINT_T)sg_p2p_session->a_pts;
     int payload = 0;
     char *codec_name = NULL;
     if (TY_AV_CODEC_AUDIO_G711U == mode) {
@@ -845,13 +1005,12 @@ STATIC OPERATE_RET __p2p_pack_g711_rtp_and_send(INT_T client, CHAR_T *pData, INT
         codec_name = "PCM";
         payload = 99 /*RTP_PCM_PAYLOAD*/;
     }
-    pRtpDelegate = rtp_payload_encode_create(payload, codec_name, seq, ssrc, &rtp_packer, &rtp_pack_nal_arg);
-    ret = rtp_payload_encode_input(pRtpDelegate, pData, len, timestamp);
-    if (OPRT_OK != ret) {
-        PR_ERR("rtp_payload_encode_input h264 error:%d", ret);
-    }
-    rtp_payload_encode_getinfo(pRtpDelegate, &sg_p2p_session->audio_seq_num, &timestamp);
-    rtp_payload_encode_destroy(pRtpDelegate);
+    memset(sg_p2p_session->audio_rtp.nal_arg.ext_head_buff, 0, P2P_EXT_HEAD_MAX_LEN);
+    __p2p_ext_protocol_pack(client, 1, sg_p2p_session->audio_rtp.nal_arg.ext_head_buff,
+                            &sg_p2p_session->audio_rtp.nal_arg.fix_len);
+    ret = __p2p_pack_rtp_and_send(&sg_p2p_session->audio_rtp, client, TUYA_ADATA_CHANNEL,
+                                  sg_p2p_session->p_audio_rtp_buff, payload, codec_name, 11,
+                                  &sg_p2p_session->audio_seq_num, (UINT_T)sg_p2p_session->a_pts, pData, len);
 
     return ret;
 }
@@ -886,6 +1045,104 @@ OPERATE_RET tuya_p2p_rtc_register_get_audio_frame_cb(tuya_p2p_rtc_get_frame_cb_t
     return OPRT_OK;
 }
 
+OPERATE_RET tuya_p2p_rtc_register_video_bitrate_cb(tuya_p2p_rtc_video_bitrate_cb_t pCallback)
+{
+    sg_p2p_session->on_video_bitrate_callback = pCallback;
+    return OPRT_OK;
+}
+
+OPERATE_RET tuya_p2p_rtc_register_key_frame_req_cb(tuya_p2p_rtc_key_frame_req_cb_t pCallback)
+{
+    sg_p2p_session->on_key_frame_req_callback = pCallback;
+    return OPRT_OK;
+}
+
+OPERATE_RET tuya_ipc_p2p_get_stats(TUYA_IPC_P2P_STATS_T *stats)
+{
+    tuya_p2p_rtc_session_stats_t pair;
+    tuya_p2p_rtc_channel_stats_t chan;
+    UINT64_T send_bytes = 0;
+    UINT64_T recv_bytes = 0;
+    UINT64_T encrypt_us = 0;
+    UINT_T encrypt_count = 0;
+    INT_T i;
+
+    if (NULL == stats) {
+        return OPRT_INVALID_PARM;
+    }
+    if (NULL == sg_p2p_session || P2P_SESSION_RUNNING != sg_p2p_session->status ||
+        0 != tuya_p2p_rtc_get_session_stats(sg_p2p_session->session, &pair)) {
+        return OPRT_RESOURCE_NOT_READY;
+    }
+
+    memset(stats, 0, sizeof(TUYA_IPC_P2P_STATS_T));
+    snprintf(stats->local_type, sizeof(stats->local_type), "%s", pair.local_type);
+    snprintf(stats->remote_type, sizeof(stats->remote_type), "%s", pair.remote_type);
+    snprintf(stats->local_addr, sizeof(stats->local_addr), "%s", pair.local_addr);
+    snprintf(stats->remote_addr, sizeof(stats->remote_addr), "%s", pair.remote_addr);
+    stats->connected_s = (UINT_T)(pair.connected_ms / 1000);
+    for (i = TUYA_CMD_CHANNEL; i <= TUYA_ADATA_CHANNEL; i++) {
+        if (0 != tuya_p2p_rtc_get_channel_stats(sg_p2p_session->session, i, &chan)) {
+            continue;
+        }
+        if (TUYA_VDATA_CHANNEL == i) {
+            stats->rtt_ms = chan.srtt_ms;
+        }
+        stats->xmit += chan.xmit;
+        stats->recv_dropped += chan.recv_dropped;
+        send_bytes += chan.socket_send_bytes;
+        recv_bytes += chan.socket_recv_bytes;
+        encrypt_us += chan.encrypt_us;
+        encrypt_count += chan.encrypt_count;
+    }
+    if (pair.connected_ms) {
+        stats->send_kbps = (UINT_T)(send_bytes * 8 / pair.connected_ms);
+        stats->recv_kbps = (UINT_T)(recv_bytes * 8 / pair.connected_ms);
+    }
+    if (encrypt_count) {
+        stats->encrypt_us = (UINT_T)(encrypt_us / encrypt_count);
+    }
+    stats->target_kbps = sg_p2p_session->bwe.target_kbps;
+    stats->video_kbps = sg_p2p_session->bwe.sent_kbps;
+    stats->loss = sg_p2p_session->bwe.loss;
+    stats->video = sg_p2p_session->stream_stats[TUYA_VDATA_CHANNEL];
+    stats->audio = sg_p2p_session->stream_stats[TUYA_ADATA_CHANNEL];
+
+    return OPRT_OK;
+}
+
+STATIC void __p2p_cli_stat(int argc, char *argv[])
+{
+    TUYA_IPC_P2P_STATS_T stats;
+    CHAR_T line[160];
+
+    if (OPRT_OK != tuya_ipc_p2p_get_stats(&stats)) {
+        tal_cli_echo("p2p not connected");
+        return;
+    }
+    snprintf(line, SIZEOF(line), "pair %s %s -> %s %s, up %u s", stats.local_type, stats.local_addr,
+             stats.remote_type, stats.remote_addr, stats.connected_s);
+    tal_cli_echo(line);
+    snprintf(line, SIZEOF(line), "rtt %u ms, bwe %u kbps, video %u kbps loss %u%%, socket send %u recv %u kbps",
+             stats.rtt_ms, stats.target_kbps, stats.video_kbps, stats.loss, stats.send_kbps, stats.recv_kbps);
+    tal_cli_echo(line);
+    snprintf(line, SIZEOF(line), "kcp xmit %u, recv dropped %u, encrypt %u us/fragment", stats.xmit,
+             stats.recv_dropped, stats.encrypt_us);
+    tal_cli_echo(line);
+    snprintf(line, SIZEOF(line), "video frames %u buffer_full %u send_failed %u, audio frames %u buffer_full %u "
+             "send_failed %u", stats.video.frames, stats.video.buffer_full, stats.video.send_failed,
+             stats.audio.frames, stats.audio.buffer_full, stats.audio.send_failed);
+    tal_cli_echo(line);
+}
+
+STATIC CONST cli_cmd_t sc_p2p_cli_cmd[] = {
+    {
+        .name = "p2p_stat",
+        .help = "p2p_stat, show the candidate pair, bitrates, loss and drop counters of the p2p session",
+        .func = __p2p_cli_stat,
+    },
+};
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 /***********************************************************
@@ -903,6 +1160,7 @@ STATIC INT_T __p2p_session_trans_video_start(P2P_SESSION_T *pSession)
     }
     // Wait for previous data transmission to end
     PR_DEBUG("session[%d]video video_start wait_concurr_idle", pSession->session);
+    memset(&pSession->bwe, 0, sizeof(pSession->bwe));
     pSession->cmd |= P2P_VIDEO;
     PR_DEBUG("session[%d] video start success", pSession->session);
     return OPRT_OK;
@@ -1394,6 +1652,7 @@ STATIC void __p2p_media_send_proc(PVOID_T pArg)
                 tal_system_sleep(10);
                 continue;
             }
+            __p2p_bwe_update(pSession);
             MEDIA_FRAME *pMediaFrame = &sg_p2p_session->media_frame;
             op_ret = sg_p2p_session->on_get_video_frame_callback(pMediaFrame); // OnGetVideoFrameCallback(pMediaFrame)
             if (op_ret == OPRT_OK) {
@@ -1480,6 +1739,8 @@ INT_T __p2p_session_release_va(P2P_SESSION_T *pSession)
     // All functions closed
     PR_DEBUG("release va session[%d]", pSession->session);
     tal_mutex_lock(pSession->cmutex);
+    __p2p_rtp_stream_release(&pSession->video_rtp);
+    __p2p_rtp_stream_release(&pSession->audio_rtp);
     if (pSession->p_video_rtp_buff) {
         Free(pSession->p_video_rtp_buff);
         pSession->p_video_rtp_buff = NULL;
@@ -1497,6 +1758,8 @@ INT_T __p2p_session_release_va(P2P_SESSION_T *pSession)
     pSession->video_seq_num = 0;
     pSession->audio_seq_num = 0;
     pSession->key_frame = false;
+    memset(&pSession->bwe, 0, sizeof(pSession->bwe));
+    memset(pSession->stream_stats, 0, sizeof(pSession->stream_stats));
     pSession->v_pts = 0;
     pSession->v_timestamp = 0;
     pSession->a_pts = 0;
@@ -1582,6 +1845,7 @@ OPERATE_RET p2p_init(IN CONST TUYA_IPC_P2P_VAR_T *p_var)
     sg_p2p_session->on_disconnect_callback = p_var->on_disconnect_callback;
     sg_p2p_session->on_get_video_frame_callback = p_var->on_get_video_frame_callback;
     sg_p2p_session->on_get_audio_frame_callback = p_var->on_get_audio_frame_callback;
+    tal_cli_cmd_register(sc_p2p_cli_cmd, CNTSOF(sc_p2p_cli_cmd));
 
     return OPRT_OK;
 
@@ -1693,31 +1957,31 @@ OPERATE_RET tuya_imm_p2p_album_play_send_finish(IN CONST CHAR_T *dev_id, IN CONS
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The packetizer builds one packet at a time, so each stream has a single packet buffer. A packet is built
+// P2P_EXT_HEAD_MAX_LEN into it, the extension header is put right in front of it.
 void *rtp_alloc(void *param, int bytes)
 {
-    int nBufferSize = bytes;
-    unsigned char *pBuffer = (unsigned char *)malloc(nBufferSize);
-    memset(pBuffer, 0, nBufferSize);
-    return pBuffer;
+    RTP_PACK_NAL_ARG_T *nal_arg = (RTP_PACK_NAL_ARG_T *)param;
+    if (bytes > P2P_RTP_PACK_LEN - P2P_EXT_HEAD_MAX_LEN) {
+        PR_ERR("rtp packet too big %d", bytes);
+        return NULL;
+    }
+    return nal_arg->p_rtp_buff + P2P_EXT_HEAD_MAX_LEN;
 }
 
 void rtp_free(void *param, void *packet)
 {
-    free(packet);
-    packet = NULL;
     return;
 }
 
 int rtp_pack_packet_handler(void *param, const void *packet, int bytes, uint32_t timestamp, int flags)
 {
-    //return 0;
-    CHAR_T *buf = (CHAR_T *)packet;
     INT_T len = bytes;
     RTP_PACK_NAL_ARG_T *nal_arg = (RTP_PACK_NAL_ARG_T *)param;
-    memcpy(nal_arg->p_rtp_buff, nal_arg->ext_head_buff, nal_arg->fix_len);
-    *(INT_T *)&nal_arg->p_rtp_buff[nal_arg->fix_len - 4] = len;
-    memcpy(nal_arg->p_rtp_buff + nal_arg->fix_len, buf, len);
-    return p2p_send_rtp_data(nal_arg->client, nal_arg->channel, nal_arg->p_rtp_buff, len + nal_arg->fix_len);
+    CHAR_T *buf = (CHAR_T *)packet - nal_arg->fix_len;
+    memcpy(buf, nal_arg->ext_head_buff, nal_arg->fix_len);
+    *(INT_T *)&buf[nal_arg->fix_len - 4] = len;
+    return p2p_send_rtp_data(nal_arg->client, nal_arg->channel, buf, len + nal_arg->fix_len);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
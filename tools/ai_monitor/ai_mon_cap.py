@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+List and replay an AI monitor capture file.
+
+"ai_capture start <path>" on the cli, or tuya_ai_monitor_capture_start(),
+records every frame the monitor sends to its clients. The file is a
+16-byte header ("TYAIMCAP", version, record header size) followed by one
+record per frame, all little endian:
+
+    uint64 ts_ms, uint32 len, uint8 direction, uint8 type, uint16 id
+    len bytes of the frame, as it went out on the monitor socket
+
+"list" prints the records. "replay" listens like the device does and sends
+the frames to the first client that connects, with the captured pacing, so
+a monitor client can be tested without a device.
+
+usage:
+    python3 tools/ai_monitor/ai_mon_cap.py list cap.bin
+    python3 tools/ai_monitor/ai_mon_cap.py replay cap.bin --port 5055 --speed 2
+"""
+
+import argparse
+import socket
+import struct
+import sys
+import time
+
+FILE_MAGIC = b"TYAIMCAP"
+FILE_HEAD = struct.Struct("<8sHHI")
+REC_HEAD = struct.Struct("<QIBBH")
+DIRECTIONS = {0: "up", 1: "down", 2: "ack"}
+TYPES = {30: "video", 31: "audio", 32: "image", 33: "file", 34: "text", 35: "event", 60: "log"}
+
+
+def read(path):
+    with open(path, "rb") as f:
+        head = f.read(FILE_HEAD.size)
+        if len(head) < FILE_HEAD.size:
+            raise ValueError("file too short")
+        magic, version, rec_len, _ = FILE_HEAD.unpack(head)
+        if magic != FILE_MAGIC:
+            raise ValueError("not an AI monitor capture")
+        if rec_len < REC_HEAD.size:
+            raise ValueError("record header of %d bytes, version %d" % (rec_len, version))
+
+        records = []
+        while True:
+            rec = f.read(rec_len)
+            if len(rec) < rec_len:
+                break
+            ts_ms, length, direction, ptype, chan = REC_HEAD.unpack(rec[:REC_HEAD.size])
+            frame = f.read(length)
+            if len(frame) < length:
+                print("last record cut off", file=sys.stderr)
+                break
+            records.append({"ts": ts_ms, "dir": direction, "type": ptype, "id": chan, "frame": frame})
+        return records
+
+
+def cmd_list(args):
+    records = read(args.capture)
+    base = records[0]["ts"] if records else 0
+    for r in records:
+        if args.type is not None and r["type"] != args.type:
+            continue
+        print("%10.3f %-4s %-6s id %-5d %6d bytes" % ((r["ts"] - base) / 1000.0, DIRECTIONS.get(r["dir"], r["dir"]),
+                                                    TYPES.get(r["type"], r["type"]), r["id"], len(r["frame"])))
+    total = sum(len(r["frame"]) for r in records)
+    span = (records[-1]["ts"] - base) / 1000.0 if records else 0
+    print("%d records, %d bytes, %.1f s" % (len(records), total, span), file=sys.stderr)
+    return 0
+
+
+def cmd_replay(args):
+    records = [r for r in read(args.capture) if args.type is None or r["type"] == args.type]
+    if not records:
+        print("no records to replay", file=sys.stderr)
+        return 2
+
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind(("0.0.0.0", args.port))
+    server.listen(1)
+    print("waiting for a monitor client on port %d" % args.port, file=sys.stderr)
+    conn, addr = server.accept()
+    print("replaying %d records to %s:%d" % (len(records), addr[0], addr[1]), file=sys.stderr)
+
+    start = time.monotonic()
+    base = records[0]["ts"]
+    with conn:
+        for r in records:
+            due = (r["ts"] - base) / 1000.0 / args.speed
+            delay = due - (time.monotonic() - start)
+            if delay > 0:
+                time.sleep(delay)
+            conn.sendall(r["frame"])
+    server.close()
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="list or replay an AI monitor capture file")
+    sub = parser.add_subparsers(dest="cmd", required=True)
+
+    p = sub.add_parser("list", help="print the records")
+    p.add_argument("capture")
+    p.add_argument("--type", type=int, help="only this packet type")
+    p.set_defaults(func=cmd_list)
+
+    p = sub.add_parser("replay", help="serve the frames to a monitor client")
+    p.add_argument("capture")
+    p.add_argument("--port", type=int, default=5055, help="listen port, the device uses 5055")
+    p.add_argument("--speed", type=float, default=1.0, help="replay speed factor")
+    p.add_argument("--type", type=int, help="only this packet type")
+    p.set_defaults(func=cmd_replay)
+
+    args = parser.parse_args()
+    try:
+        return args.func(args)
+    except ValueError as e:
+        print("%s: %s" % (args.capture, e), file=sys.stderr)
+        return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main())
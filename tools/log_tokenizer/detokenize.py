@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Turn tokenized log records back into text.
+
+Firmware built with ENABLE_LOG_TOKENIZED writes each log as
+"$" + base64(level, token, arguments). The token is the address of the
+"file:line\\x1fformat" entry the log site put into the .tal_log_fmt section,
+so the ELF of the same build is needed to decode it. Other lines are passed
+through unchanged.
+
+usage:
+    tos.py monitor | python3 tools/log_tokenizer/detokenize.py <app.elf>
+    python3 tools/log_tokenizer/detokenize.py <app.elf> uart.log
+"""
+
+import argparse
+import base64
+import binascii
+import re
+import struct
+import sys
+import time
+
+SECTION = ".tal_log_fmt"
+SEP = "\x1f"
+LEVEL_STR = ["E", "W", "N", "I", "D", "T"]
+
+FMT_RE = re.compile(
+    r"%(?P<flags>[-+ #0]*)(?P<width>\*|\d+)?(?:\.(?P<prec>\*|\d+))?"
+    r"(?P<len>hh|h|ll|l|j|z|t|L)?(?P<conv>[diouxXcspfFeEgGaA%])")
+
+
+class Cut(Exception):
+    pass
+
+
+def load_tokens(elf_path):
+    with open(elf_path, "rb") as f:
+        elf = f.read()
+
+    if elf[:4] != b"\x7fELF":
+        raise ValueError("%s is not an ELF file" % elf_path)
+    is_64 = elf[4] == 2
+    end = "<" if elf[5] == 1 else ">"
+
+    if is_64:
+        shoff, = struct.unpack_from(end + "Q", elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(end + "HHH", elf, 0x3A)
+        sh_fmt = end + "IIQQQQIIQQ"
+    else:
+        shoff, = struct.unpack_from(end + "I", elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(end + "HHH", elf, 0x2E)
+        sh_fmt = end + "IIIIIIIIII"
+
+    sections = [struct.unpack_from(sh_fmt, elf, shoff + i * shentsize) for i in range(shnum)]
+    # name, type, flags, addr, offset, size
+    strtab = sections[shstrndx]
+    names = elf[strtab[4]:strtab[4] + strtab[5]]
+
+    tokens = {}
+    for sh in sections:
+        name = names[sh[0]:names.index(b"\0", sh[0])].decode()
+        if name != SECTION:
+            continue
+        data = elf[sh[4]:sh[4] + sh[5]]
+        pos = 0
+        while pos < len(data):
+            nul = data.find(b"\0", pos)
+            if nul < 0:
+                nul = len(data)
+            if nul > pos:
+                tokens[sh[3] + pos] = data[pos:nul].decode("utf-8", "replace")
+            pos = nul + 1
+    return tokens
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def varint(self):
+        value, shift = 0, 0
+        while True:
+            if self.pos >= len(self.data):
+                raise Cut()
+            b = self.data[self.pos]
+            self.pos += 1
+            value |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                break
+        return (value >> 1) ^ -(value & 1)
+
+    def float(self):
+        if self.pos + 4 > len(self.data):
+            raise Cut()
+        value, = struct.unpack_from("<f", self.data, self.pos)
+        self.pos += 4
+        return value
+
+    def string(self):
+        if self.pos >= len(self.data):
+            raise Cut()
+        n = self.data[self.pos]
+        self.pos += 1
+        s = self.data[self.pos:self.pos + (n & 0x7F)].decode("utf-8", "replace")
+        self.pos += n & 0x7F
+        return s + ("..." if n & 0x80 else "")
+
+
+def render(fmt, reader):
+    out, last = [], 0
+    for m in FMT_RE.finditer(fmt):
+        out.append(fmt[last:m.start()])
+        last = m.end()
+        conv = m.group("conv")
+        if conv == "%":
+            out.append("%")
+            continue
+        try:
+            width = m.group("width") or ""
+            prec = m.group("prec")
+            if width == "*":
+                width = str(reader.varint())
+            if prec == "*":
+                prec = str(reader.varint())
+            spec = "%" + m.group("flags") + width + ("." + prec if prec is not None else "")
+            if conv == "s":
+                out.append((spec + "s") % reader.string())
+            elif conv in "fFeEgGaA":
+                out.append((spec + ("f" if conv in "aA" else conv)) % reader.float())
+            else:
+                value = reader.varint()
+                bits = 64 if m.group("len") in ("ll", "j") else 32
+                if conv in "ouxXp":
+                    value &= (1 << bits) - 1
+                if conv == "p":
+                    out.append("0x%x" % value)
+                elif conv == "c":
+                    out.append((spec + "c") % chr(value & 0xFF))
+                else:
+                    out.append((spec + ("d" if conv in "iu" else conv)) % value)
+        except Cut:
+            out.append("<cut>")
+            break
+    out.append(fmt[last:])
+    return "".join(out)
+
+
+def decode_line(line, tokens):
+    text = line.rstrip("\r\n")
+    if not text.startswith("$"):
+        return line
+    try:
+        rec = base64.b64decode(text[1:], validate=True)
+    except (binascii.Error, ValueError):
+        return line
+    if len(rec) < 5:
+        return line
+
+    level = LEVEL_STR[rec[0]] if rec[0] < len(LEVEL_STR) else "?"
+    token, = struct.unpack_from("<I", rec, 1)
+    entry = tokens.get(token)
+    if entry is None:
+        return "[%s %s][unknown token 0x%08x] %s\n" % (time.strftime("%m-%d %H:%M:%S"), level, token, text)
+
+    where, _, fmt = entry.partition(SEP)
+    where = re.sub(r".*[/\\]", "", where)
+    return "[%s ty %s][%s] %s\n" % (time.strftime("%m-%d %H:%M:%S"), level, where, render(fmt, Reader(rec[5:])))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="decode tokenized TuyaOpen logs")
+    parser.add_argument("elf", help="ELF of the running firmware")
+    parser.add_argument("log", nargs="?", help="log file, stdin when omitted")
+    args = parser.parse_args()
+
+    tokens = load_tokens(args.elf)
+    if not tokens:
+        sys.stderr.write("no %s section in %s, was it built with ENABLE_LOG_TOKENIZED?\n" % (SECTION, args.elf))
+
+    src = open(args.log, "r", errors="replace") if args.log else sys.stdin
+    try:
+        for line in src:
+            sys.stdout.write(decode_line(line, tokens))
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if args.log:
+            src.close()
+
+
+if __name__ == "__main__":
+    main()
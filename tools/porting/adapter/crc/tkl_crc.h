@@ -0,0 +1,52 @@
+/**
+ * @file tkl_crc.h
+ * @brief Common process - adapter the crc engine api
+ * @version 0.1
+ * @date 2026-10-14
+ *
+ * @copyright Copyright 2021-2025 Tuya Inc. All Rights Reserved.
+ *
+ */
+#ifndef __TKL_CRC_H__
+#define __TKL_CRC_H__
+
+#include "tuya_cloud_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief update a CRC-32/IEEE (reflected, polynomial 0xEDB88320) with data
+ *
+ * @param[in] crc: the current CRC register, without the final xor
+ * @param[in] data: data to add
+ * @param[in] len: length of data
+ *
+ * @note This API is used by hash_crc32i_update() when ENABLE_PLATFORM_CRC32 is
+ * set. Neither the initial value nor the final xor is applied, data may have
+ * any alignment.
+ *
+ * @return the updated CRC register
+ */
+uint32_t tkl_crc32_update(uint32_t crc, const void *data, uint32_t len);
+
+/**
+ * @brief update a CRC-16/MODBUS (reflected, polynomial 0xA001) with data
+ *
+ * @param[in] crc: the current CRC register
+ * @param[in] data: data to add
+ * @param[in] len: length of data
+ *
+ * @note This API is used by crc_16_update() when ENABLE_PLATFORM_CRC16 is set.
+ * The initial value is not applied, data may have any alignment.
+ *
+ * @return the updated CRC register
+ */
+uint16_t tkl_crc16_update(uint16_t crc, const void *data, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -18,8 +18,16 @@ extern "C" {
 
 typedef enum {
     RGB_OUTPUT_FINISH = 0,
+    RGB_BOUNCE_HALF_EMPTY, // a half of bounce_buf was scanned out and can be refilled, halves go in turn
 } TUYA_RGB_EVENT_E;
 
+/*
+ * With cfg->bounce_buf set, the controller scans the frame out of that ring
+ * from its start at every frame, the base address only names the frame the
+ * ring is refilled from. A platform without it fails tkl_rgb_init with
+ * OPRT_NOT_SUPPORTED.
+ */
+
 
 typedef void (*TUYA_RGB_ISR_CB)(TUYA_RGB_EVENT_E event);
 
@@ -1334,9 +1334,20 @@ typedef enum {
     TUYA_UART_FLUSH_CMD,
     TUYA_UART_RECONFIG_CMD,
     TUYA_UART_USER_CMD,
+    TUYA_UART_RX_DMA_CMD,    ///< arg TUYA_UART_DMA_CFG_T *, receive by dma, the rx irq fires per block
+    TUYA_UART_TX_DMA_CMD,    ///< arg NULL, tkl_uart_write sends whole blocks by dma
     TUYA_UART_MAX_CMD = 1000
 } TUYA_UART_IOCTL_CMD_E;
 
+/**
+ * @brief uart dma receive configure, see TUYA_UART_RX_DMA_CMD
+ *
+ */
+typedef struct {
+    uint16_t rx_timeout_ms;  ///< rx irq after the line idles this long with data received, 0 for one character time
+    uint16_t block_size;     ///< rx irq at the latest after this many bytes, 0 for the platform default
+} TUYA_UART_DMA_CFG_T;
+
 typedef struct {
     uint32_t interval_ms;
 } TUYA_WDOG_BASE_CFG_T;
@@ -1399,6 +1410,8 @@ typedef struct {
 	uint16_t                 vsync_front_porch;  /**< rang 0~0xFF (0~255), should refer rgb device spec*/
 	uint8_t                  hsync_pulse_width;  /**< rang 0~0x3F (0~7), should refer rgbdevice spec*/
 	uint8_t                  vsync_pulse_width;  /**< rang 0~0x3F (0~7), should refer rgb device spec*/
+    uint8_t                 *bounce_buf;         /**< sram line ring scanned out instead of the frame, NULL scans out the frame */
+    uint16_t                 bounce_lines;       /**< lines in bounce_buf, even, RGB_BOUNCE_HALF_EMPTY fires per half */
 } TUYA_RGB_BASE_CFG_T;
 
 typedef struct {
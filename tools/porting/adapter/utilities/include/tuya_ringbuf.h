@@ -102,6 +102,39 @@ uint32_t tuya_ring_buff_discard(TUYA_RINGBUFF_T ringbuff, uint32_t len);
  */
 uint32_t tuya_ring_buff_peek(TUYA_RINGBUFF_T ringbuff, void *data, uint32_t len);
 
+/**
+ * @brief ringbuff contiguous unread data get
+ * the data stays in the ringbuff until tuya_ring_buff_discard()
+ *
+ * @param[in]   ringbuff: ringbuff handle
+ * @param[out]  data:     point to the oldest unread byte
+ *
+ * @return  length readable at data, the rest of the unread data follows from
+ *          the start of the buff once it is discarded
+ */
+uint32_t tuya_ring_buff_read_span(TUYA_RINGBUFF_T ringbuff, uint8_t **data);
+
+/**
+ * @brief ringbuff contiguous free area get
+ * the caller fills it in place, e.g. from a driver, then commits the length
+ *
+ * @param[in]   ringbuff: ringbuff handle
+ * @param[out]  data:     point to the free area
+ *
+ * @return  length writable at data
+ */
+uint32_t tuya_ring_buff_write_span(TUYA_RINGBUFF_T ringbuff, uint8_t **data);
+
+/**
+ * @brief ringbuff in place write commit
+ *
+ * @param[in]   ringbuff: ringbuff handle
+ * @param[in]   len:      bytes written to the area of tuya_ring_buff_write_span()
+ *
+ * @return  length committed
+ */
+uint32_t tuya_ring_buff_write_commit(TUYA_RINGBUFF_T ringbuff, uint32_t len);
+
 /**
  * @brief ringbuff data write
  *
@@ -257,3 +257,57 @@ uint32_t tuya_ring_buff_peek(TUYA_RINGBUFF_T ringbuff, void *data, uint32_t len)
 
     return tmp_len + len;
 }
+
+uint32_t tuya_ring_buff_read_span(TUYA_RINGBUFF_T ringbuff, uint8_t **data)
+{
+    uint32_t in, out;
+    __RINGBUFF_T *rbuff = (__RINGBUFF_T *)ringbuff;
+
+    if (rbuff == NULL || data == NULL) {
+        return 0;
+    }
+
+    in = rbuff->in;
+    out = rbuff->out;
+    *data = &rbuff->buff[out];
+
+    return (in >= out) ? (in - out) : (rbuff->len - out);
+}
+
+uint32_t tuya_ring_buff_write_span(TUYA_RINGBUFF_T ringbuff, uint8_t **data)
+{
+    uint32_t in, out;
+    __RINGBUFF_T *rbuff = (__RINGBUFF_T *)ringbuff;
+
+    if (rbuff == NULL || data == NULL) {
+        return 0;
+    }
+
+    in = rbuff->in;
+    out = rbuff->out;
+    *data = &rbuff->buff[in];
+
+    // one byte stays free so a full buff is told from an empty one
+    if (out > in) {
+        return out - in - 1;
+    }
+    return (out == 0) ? (rbuff->len - in - 1) : (rbuff->len - in);
+}
+
+uint32_t tuya_ring_buff_write_commit(TUYA_RINGBUFF_T ringbuff, uint32_t len)
+{
+    uint8_t *data;
+    __RINGBUFF_T *rbuff = (__RINGBUFF_T *)ringbuff;
+
+    len = GET_MIN(len, tuya_ring_buff_write_span(ringbuff, &data));
+    if (len == 0) {
+        return 0;
+    }
+
+    rbuff->in += len;
+    if (rbuff->in >= rbuff->len) {
+        rbuff->in = 0;
+    }
+
+    return len;
+}
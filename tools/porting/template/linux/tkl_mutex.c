@@ -15,6 +15,7 @@
 #include "tuya_error_code.h"
 #include <pthread.h>
 #include <errno.h>
+#include <unistd.h>
 
 typedef pthread_mutex_t TKL_THRD_MUTEX;
 typedef struct {
@@ -55,6 +56,14 @@ OPERATE_RET tkl_mutex_create_init(TKL_MUTEX_HANDLE *pMutexHandle)
         return OPRT_OS_ADAPTER_MUTEX_CREAT_FAILED;
     }
 
+#if defined(_POSIX_THREAD_PRIO_INHERIT) && (_POSIX_THREAD_PRIO_INHERIT > 0)
+    // a low priority holder runs at the priority of its highest waiter
+    ret = pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+    if (0 != ret) {
+        return OPRT_OS_ADAPTER_MUTEX_CREAT_FAILED;
+    }
+#endif
+
     ret = pthread_mutex_init(&(mutex_manage->mutex), &attr);
     if (0 != ret) {
         return OPRT_OS_ADAPTER_MUTEX_CREAT_FAILED;
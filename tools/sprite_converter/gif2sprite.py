@@ -0,0 +1,385 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Convert a GIF into a sprite for lv_port_anim.
+
+The sprite holds every frame already decoded to RGB565, or RGB565A8 when a
+frame has transparent pixels, as RLE runs with unchanged pixels skipped
+against the previous frame (see lv_port_anim.h). The device unpacks it
+straight into the frame buffer instead of running the LZW decoder and the
+palette lookup for each frame, and without the decode cache memory.
+
+Frames are composed the way LVGL's gifdec does, so a sprite shows the same
+pixels as lv_gif would.
+
+usage:
+    python3 tools/sprite_converter/gif2sprite.py happy.gif -o happy.c
+    python3 tools/sprite_converter/gif2sprite.py happy.gif --name happy --bin happy.bin
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+SPRITE_MAGIC = 0x5053564C
+CF_RGB565 = 0x12
+CF_RGB565A8 = 0x14
+
+OP_COPY = 0x00
+OP_FILL = 0x40
+OP_SKIP = 0x80
+RUN_MAX = 64 + 0xFFFF
+DELAY_MIN = 10
+
+
+class GifError(Exception):
+    pass
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def read(self, n):
+        if self.pos + n > len(self.data):
+            raise GifError("unexpected end of file")
+        chunk = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return chunk
+
+    def byte(self):
+        return self.read(1)[0]
+
+    def num(self):
+        return struct.unpack("<H", self.read(2))[0]
+
+    def sub_blocks(self):
+        out = bytearray()
+        while True:
+            size = self.byte()
+            if size == 0:
+                return bytes(out)
+            out += self.read(size)
+
+
+def lzw_decode(min_size, data, count):
+    clear = 1 << min_size
+    stop = clear + 1
+    out = bytearray()
+    table = [bytes([i]) for i in range(clear)] + [b"", b""]
+    size = min_size + 1
+    prev = None
+    bits = 0
+    nbits = 0
+    pos = 0
+
+    while len(out) < count:
+        while nbits < size:
+            if pos >= len(data):
+                return out
+            bits |= data[pos] << nbits
+            nbits += 8
+            pos += 1
+        code = bits & ((1 << size) - 1)
+        bits >>= size
+        nbits -= size
+
+        if code == clear:
+            table = table[:clear + 2]
+            size = min_size + 1
+            prev = None
+            continue
+        if code == stop:
+            break
+
+        if code < len(table):
+            entry = table[code]
+            if prev is not None and len(table) < 4096:
+                table.append(prev + entry[:1])
+        elif prev is not None:
+            entry = prev + prev[:1]
+            if len(table) < 4096:
+                table.append(entry)
+        else:
+            raise GifError("bad LZW code")
+        out += entry
+        prev = entry
+        if len(table) == (1 << size) and size < 12:
+            size += 1
+
+    return out[:count]
+
+
+def interlaced_rows(height):
+    rows = []
+    for start, step in ((0, 8), (4, 8), (2, 4), (1, 2)):
+        rows += range(start, height, step)
+    return rows
+
+
+def decode_gif(data):
+    """Returns width, height, play count and a list of (BGRA canvas, delay)."""
+    r = Reader(data)
+    if r.read(3) != b"GIF":
+        raise GifError("invalid signature")
+    if r.read(3) != b"89a":
+        raise GifError("only GIF89a is supported, as in gifdec")
+    width, height = r.num(), r.num()
+    fdsz = r.byte()
+    if not fdsz & 0x80:
+        raise GifError("no global color table")
+    bgindex = r.byte()
+    r.byte()
+    # gifdec keeps 256 entries, indexes past the table read zeros
+    gct = r.read(3 * (1 << ((fdsz & 7) + 1))).ljust(768, b"\0")
+
+    npix = width * height
+    bg = gct[bgindex * 3:bgindex * 3 + 3]
+    canvas = bytearray(bytes((bg[2], bg[1], bg[0], 0xFF)) * npix)
+    frame = bytearray([bgindex]) * npix
+    gce = {"disposal": 0, "transparency": 0, "tindex": 0, "delay": 0}
+    palette = gct
+    rect = None
+    loop_count = -1
+    frames = []
+
+    def render(target):
+        fx, fy, fw, fh = rect
+        tindex = gce["tindex"] if gce["transparency"] else 0x100
+        for j in range(fh):
+            base = (fy + j) * width + fx
+            for k in range(fw):
+                index = frame[base + k]
+                if index != tindex:
+                    o = (base + k) * 4
+                    target[o:o + 4] = bytes((palette[index * 3 + 2], palette[index * 3 + 1],
+                                             palette[index * 3], 0xFF))
+
+    def dispose():
+        if rect is None:
+            return
+        if gce["disposal"] == 2:
+            fx, fy, fw, fh = rect
+            c = palette[bgindex * 3:bgindex * 3 + 3]
+            px = bytes((c[2], c[1], c[0], 0x00 if gce["transparency"] else 0xFF))
+            for j in range(fh):
+                o = ((fy + j) * width + fx) * 4
+                canvas[o:o + fw * 4] = px * fw
+        elif gce["disposal"] != 3:
+            render(canvas)
+
+    while True:
+        sep = r.byte()
+        if sep == 0x3B:
+            break
+        if sep == 0x21:
+            label = r.byte()
+            if label == 0xF9:
+                r.byte()
+                rdit = r.byte()
+                gce = {"disposal": (rdit >> 2) & 3, "transparency": rdit & 1,
+                       "delay": r.num(), "tindex": r.byte()}
+                r.byte()
+            elif label == 0xFF:
+                r.byte()
+                app = r.read(11)
+                body = r.sub_blocks()
+                if app[:8] == b"NETSCAPE" and len(body) >= 3 and loop_count < 0:
+                    n = struct.unpack_from("<H", body, 1)[0]
+                    loop_count = 0 if n == 0 else n + 1
+            else:
+                if label == 0x01:
+                    r.read(13)
+                r.sub_blocks()
+            continue
+        if sep != 0x2C:
+            raise GifError("bad block 0x%02X" % sep)
+
+        # gifdec disposes of the previous frame when it reads the next one
+        dispose()
+        fx, fy, fw, fh = r.num(), r.num(), r.num(), r.num()
+        fisrz = r.byte()
+        palette = r.read(3 * (1 << ((fisrz & 7) + 1))).ljust(768, b"\0") if fisrz & 0x80 else gct
+        min_size = r.byte()
+        pixels = lzw_decode(min_size, r.sub_blocks(), fw * fh)
+        pixels += bytes(fw * fh - len(pixels))
+        rows = interlaced_rows(fh) if fisrz & 0x40 else range(fh)
+        for y, row in enumerate(rows):
+            o = (fy + row) * width + fx
+            frame[o:o + fw] = pixels[y * fw:(y + 1) * fw]
+        rect = (fx, fy, fw, fh)
+
+        render(canvas)
+        frames.append((bytes(canvas), max(gce["delay"] * 10, DELAY_MIN)))
+
+    if not frames:
+        raise GifError("no frame")
+    play_cnt = 1 if loop_count < 0 else min(loop_count, 0xFFFF)
+    return width, height, play_cnt, frames
+
+
+def to_native(canvas):
+    """BGRA canvas to the RGB565 color plane (as u16 list) and the alpha plane."""
+    color = []
+    alpha = bytearray()
+    for i in range(0, len(canvas), 4):
+        b, g, r, a = canvas[i:i + 4]
+        color.append(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3))
+        alpha.append(a)
+    return color, alpha
+
+
+def put_op(out, op, n):
+    if n <= 63:
+        out.append(op | (n - 1))
+    else:
+        out += bytes((op | 0x3F, (n - 64) & 0xFF, (n - 64) >> 8))
+
+
+def encode_plane(cur, prev, unit):
+    """Same runs as __sprite_encode() in lv_port_anim.c."""
+    out = bytearray()
+    cnt = len(cur)
+    pack = (lambda v: struct.pack("<H", v)) if unit == 2 else (lambda v: bytes((v,)))
+
+    def run_starts(i):
+        if prev is not None and i + 1 < cnt and cur[i] == prev[i] and cur[i + 1] == prev[i + 1]:
+            return True
+        return i + 2 < cnt and cur[i] == cur[i + 1] == cur[i + 2]
+
+    i = 0
+    while i < cnt:
+        n = 0
+        if prev is not None:
+            while i + n < cnt and n < RUN_MAX and cur[i + n] == prev[i + n]:
+                n += 1
+        if n >= 2:
+            put_op(out, OP_SKIP, n)
+            i += n
+            continue
+
+        n = 1
+        while i + n < cnt and n < RUN_MAX and cur[i + n] == cur[i]:
+            n += 1
+        if n >= 3:
+            put_op(out, OP_FILL, n)
+            out += pack(cur[i])
+            i += n
+            continue
+
+        start = i
+        i += 1
+        while i < cnt and i - start < RUN_MAX and not run_starts(i):
+            i += 1
+        put_op(out, OP_COPY, i - start)
+        for v in cur[start:i]:
+            out += pack(v)
+
+    return bytes(out)
+
+
+def build_sprite(width, height, play_cnt, frames):
+    planes = [to_native(canvas) for canvas, _ in frames]
+    opaque = all(a == 0xFF for _, alpha in planes for a in alpha)
+    cf = CF_RGB565 if opaque else CF_RGB565A8
+
+    streams = []
+    prev = None
+    for color, alpha in planes:
+        data = encode_plane(color, prev[0] if prev else None, 2)
+        if not opaque:
+            data += encode_plane(alpha, prev[1] if prev else None, 1)
+        streams.append(data)
+        prev = (color, alpha)
+
+    out = bytearray(struct.pack("<IHHBBHHH", SPRITE_MAGIC, width, height, cf, 0, len(frames), play_cnt, 0))
+    pos = len(out) + 8 * len(frames)
+    for data, (_, delay) in zip(streams, frames):
+        out += struct.pack("<IHH", pos, delay, 0)
+        pos += len(data)
+    for data in streams:
+        out += data
+    return bytes(out), cf
+
+
+def write_c(path, name, sprite, width, height):
+    attr = "LV_ATTRIBUTE_IMG_" + name.upper()
+    lines = [
+        "#ifdef __has_include",
+        "    #if __has_include(\"lvgl.h\")",
+        "        #ifndef LV_LVGL_H_INCLUDE_SIMPLE",
+        "            #define LV_LVGL_H_INCLUDE_SIMPLE",
+        "        #endif",
+        "    #endif",
+        "#endif",
+        "",
+        "#if defined(LV_LVGL_H_INCLUDE_SIMPLE)",
+        "    #include \"lvgl.h\"",
+        "#else",
+        "    #include \"lvgl/lvgl.h\"",
+        "#endif",
+        "",
+        "/* lv_port_anim sprite, made by tools/sprite_converter/gif2sprite.py */",
+        "",
+        "#ifndef LV_ATTRIBUTE_MEM_ALIGN",
+        "#define LV_ATTRIBUTE_MEM_ALIGN",
+        "#endif",
+        "",
+        "#ifndef %s" % attr,
+        "#define %s" % attr,
+        "#endif",
+        "",
+        "const LV_ATTRIBUTE_MEM_ALIGN LV_ATTRIBUTE_LARGE_CONST %s uint8_t %s_map[] = {" % (attr, name),
+    ]
+    for i in range(0, len(sprite), 16):
+        lines.append("    " + " ".join("0x%02x," % b for b in sprite[i:i + 16]))
+    lines += [
+        "};",
+        "",
+        "const lv_image_dsc_t %s = {" % name,
+        "    .header.magic = LV_IMAGE_HEADER_MAGIC,",
+        "    .header.cf = LV_COLOR_FORMAT_RAW,",
+        "    .header.w = %d," % width,
+        "    .header.h = %d," % height,
+        "    .data_size = %d," % len(sprite),
+        "    .data = %s_map," % name,
+        "};",
+        "",
+    ]
+    with open(path, "w") as f:
+        f.write("\n".join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a GIF into an lv_port_anim sprite")
+    parser.add_argument("gif", help="input GIF file")
+    parser.add_argument("-o", "--output", help="C file to write, <name>.c by default")
+    parser.add_argument("--name", help="C symbol of the lv_image_dsc_t, the file name by default")
+    parser.add_argument("--bin", help="also write the raw sprite, e.g. for a file system")
+    args = parser.parse_args()
+
+    name = args.name or re.sub(r"\W", "_", os.path.splitext(os.path.basename(args.gif))[0])
+    with open(args.gif, "rb") as f:
+        gif = f.read()
+
+    try:
+        width, height, play_cnt, frames = decode_gif(gif)
+    except GifError as e:
+        sys.exit("%s: %s" % (args.gif, e))
+    sprite, cf = build_sprite(width, height, play_cnt, frames)
+
+    write_c(args.output or name + ".c", name, sprite, width, height)
+    if args.bin:
+        with open(args.bin, "wb") as f:
+            f.write(sprite)
+
+    print("%s: %dx%d %s, %d frames, %d bytes (GIF %d bytes, %d decoded)" % (
+        name, width, height, "RGB565" if cf == CF_RGB565 else "RGB565A8", len(frames), len(sprite),
+        len(gif), len(frames) * width * height * (2 if cf == CF_RGB565 else 3)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Turn a tal_trace dump into Chrome trace JSON.
+
+"perf trace dump" on the cli prints the ring as TRACE lines, "perf trace send
+<ip> <port>" writes the same lines to a TCP listener. This script takes them
+from a log, other lines are skipped, and writes a file for chrome://tracing or
+ui.perfetto.dev: one track per thread with its callbacks, spans and waits,
+interrupts on their own track, marks and queue posts as instants.
+
+Timer and work callbacks, and thread functions, are recorded as addresses.
+With the symbol list of the same build they get their function names:
+    arm-none-eabi-nm -n app.elf > app.syms
+
+usage:
+    nc -l 5056 > trace.txt        # then "perf trace send <pc ip> 5056"
+    python3 tools/trace/trace2chrome.py trace.txt -o trace.json
+    python3 tools/trace/trace2chrome.py uart.log --syms app.syms -o trace.json
+"""
+
+import argparse
+import bisect
+import json
+import sys
+
+# types whose obj is a function address
+FUNC_TYPES = ("timer", "work", "thread")
+# types without a duration
+INSTANT_TYPES = ("thread", "qpost", "mark")
+WAIT_NAMES = {
+    "mutex": "wait mutex",
+    "sem": "wait sem",
+    "qfetch": "wait queue",
+    "sleep": "sleep",
+    "qpost": "queue post",
+    "thread": "thread start",
+    "hold": "hold mutex",
+}
+ISR_TID = 0
+
+
+def parse_int(text):
+    # %p prints hex, with or without 0x depending on the libc
+    text = text.strip()
+    if text in ("(nil)", "0", ""):
+        return 0
+    return int(text, 16)
+
+
+class Symbols:
+    def __init__(self, path):
+        self.addr = []
+        self.name = []
+        if not path:
+            return
+        with open(path, "r", encoding="utf-8", errors="ignore") as f:
+            for line in f:
+                fields = line.split()
+                if len(fields) < 3 or fields[1] not in "tTwW":
+                    continue
+                self.addr.append(int(fields[0], 16))
+                self.name.append(fields[2])
+        order = sorted(range(len(self.addr)), key=lambda i: self.addr[i])
+        self.addr = [self.addr[i] for i in order]
+        self.name = [self.name[i] for i in order]
+
+    def lookup(self, addr):
+        # thumb code addresses have bit 0 set
+        pos = bisect.bisect_right(self.addr, addr & ~1) - 1
+        if pos < 0:
+            return "0x%x" % addr
+        return self.name[pos]
+
+
+def read(lines):
+    records, threads, info = [], {}, {}
+    for line in lines:
+        pos = line.find("TRACE")
+        if pos < 0:
+            continue
+        fields = line[pos:].strip().split(",")
+        if fields[0] == "TRACE" and len(fields) >= 6:
+            records.append({
+                "type": fields[1],
+                "start": int(fields[2]),
+                "cost": int(fields[3]),
+                "thread": parse_int(fields[4]),
+                "obj": parse_int(fields[5]),
+                "name": ",".join(fields[6:]) if len(fields) > 6 else None,
+            })
+        elif fields[0] == "TRACE_THREAD" and len(fields) >= 3:
+            threads[parse_int(fields[1])] = ",".join(fields[2:])
+        elif fields[0] == "TRACE_END" and len(fields) >= 3:
+            info["overwritten"] = int(fields[2])
+    return records, threads, info
+
+
+def convert(records, threads, syms):
+    events = []
+    tids = {}
+
+    def tid_of(thread):
+        if thread not in tids:
+            tids[thread] = len(tids) + 1
+        return tids[thread]
+
+    base = min((r["start"] for r in records), default=0)
+    for r in records:
+        kind = r["type"]
+        if r["name"]:
+            name = r["name"]
+        elif kind in FUNC_TYPES:
+            name = syms.lookup(r["obj"])
+            if kind == "thread":
+                name = "thread start " + name
+        else:
+            name = WAIT_NAMES.get(kind, kind)
+        ev = {
+            "name": name,
+            "cat": kind,
+            "pid": 1,
+            "tid": ISR_TID if kind == "isr" else tid_of(r["thread"]),
+            "ts": r["start"] - base,
+        }
+        if kind in ("mutex", "sem", "qfetch", "qpost", "hold"):
+            ev["args"] = {"handle": "0x%x" % r["obj"]}
+        if kind in INSTANT_TYPES:
+            ev["ph"] = "i"
+            ev["s"] = "t"
+        else:
+            ev["ph"] = "X"
+            ev["dur"] = r["cost"]
+        events.append(ev)
+
+    meta = [{"name": "process_name", "ph": "M", "pid": 1, "args": {"name": "device"}}]
+    meta.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": ISR_TID, "args": {"name": "interrupts"}})
+    for thread, tid in tids.items():
+        name = threads.get(thread, "thread 0x%x" % thread)
+        meta.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": tid, "args": {"name": name}})
+
+    # waits under their callbacks need the longer event first at the same ts
+    events.sort(key=lambda e: (e["ts"], -e.get("dur", 0)))
+    return meta + events
+
+
+def main():
+    parser = argparse.ArgumentParser(description="convert a tal_trace dump to Chrome trace JSON")
+    parser.add_argument("log", nargs="?", help="dump or log with TRACE lines, stdin when not given")
+    parser.add_argument("-o", "--output", help="JSON file, stdout when not given")
+    parser.add_argument("--syms", help="nm -n output of the firmware, names the callbacks")
+    args = parser.parse_args()
+
+    if args.log:
+        with open(args.log, "r", encoding="utf-8", errors="ignore") as f:
+            records, threads, info = read(f)
+    else:
+        records, threads, info = read(sys.stdin)
+    if not records:
+        print("no TRACE lines in the log", file=sys.stderr)
+        return 2
+
+    trace = {"traceEvents": convert(records, threads, Symbols(args.syms)), "displayTimeUnit": "ms"}
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+
+    print("%d records, %d threads, %d overwritten before the dump" %
+          (len(records), len(threads), info.get("overwritten", 0)), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Compare the BENCH lines of a benchmark log with a baseline.
+
+The benchmark examples (examples/system/proto_bench, crypto_bench,
+os_kv_bench, container_bench) print each result as "BENCH,<group>,<metric>,<value>". A baseline
+is such a log reduced to its BENCH lines, written by --update from a run on the
+same machine or board, e.g. the CI runner with the LINUX platform. Times
+(*_per_call, *_us, *_ms, ns_*) regress when they grow, throughputs (*kbps) when
+they drop, by more than the tolerance. Other metrics are reported when they
+change and env lines tell when the runs are not comparable.
+
+usage:
+    ./proto_bench | python3 tools/ut/bench_compare.py baseline.csv
+    python3 tools/ut/bench_compare.py baseline.csv bench.log --tolerance 10
+    python3 tools/ut/bench_compare.py baseline.csv bench.log --update
+
+Exits with 1 when a metric regressed, 2 when the log has no BENCH lines.
+"""
+
+import argparse
+import sys
+
+LINE_PREFIX = "BENCH,"
+
+
+def parse(lines):
+    """Last value of every (group, metric), in the order of the log."""
+    result = {}
+    for line in lines:
+        pos = line.find(LINE_PREFIX)
+        if pos < 0:
+            continue
+        fields = line[pos + len(LINE_PREFIX):].strip().split(",", 2)
+        if len(fields) != 3:
+            continue
+        result[(fields[0], fields[1])] = fields[2]
+    return result
+
+
+def direction(metric):
+    """1 when larger is better, -1 when smaller is better, 0 for no judgement."""
+    if metric.endswith("kbps"):
+        return 1
+    if metric.endswith(("_per_call", "_us", "_ms")) or metric.startswith("ns_"):
+        return -1
+    return 0
+
+
+def number(text):
+    try:
+        return float(text)
+    except ValueError:
+        return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description="compare benchmark results with a baseline")
+    parser.add_argument("baseline", help="baseline file, BENCH lines")
+    parser.add_argument("log", nargs="?", help="benchmark log, stdin when not given")
+    parser.add_argument("-t", "--tolerance", type=float, default=15.0, help="allowed change in percent")
+    parser.add_argument("--update", action="store_true", help="write the log as the new baseline")
+    args = parser.parse_args()
+
+    if args.log:
+        with open(args.log, "r", encoding="utf-8", errors="ignore") as f:
+            current = parse(f)
+    else:
+        current = parse(sys.stdin)
+    if not current:
+        print("no BENCH lines in the log")
+        return 2
+
+    if args.update:
+        with open(args.baseline, "w", encoding="utf-8") as f:
+            for (group, metric), value in current.items():
+                f.write("%s%s,%s,%s\n" % (LINE_PREFIX, group, metric, value))
+        print("%s: %d results" % (args.baseline, len(current)))
+        return 0
+
+    with open(args.baseline, "r", encoding="utf-8") as f:
+        base = parse(f)
+
+    regressed = 0
+    for (group, metric), old in base.items():
+        new = current.get((group, metric))
+        if new is None:
+            print("MISSING   %s,%s" % (group, metric))
+            continue
+        if group == "env":
+            if new != old:
+                print("ENV       %s: %s -> %s, the runs may not be comparable" % (metric, old, new))
+            continue
+        sign = direction(metric)
+        old_num, new_num = number(old), number(new)
+        if sign == 0 or old_num is None or new_num is None:
+            if new != old and sign == 0 and not metric.startswith("spread"):
+                print("CHANGED   %s,%s: %s -> %s" % (group, metric, old, new))
+            continue
+        if old_num == 0:
+            continue
+        change = (new_num - old_num) * 100.0 / old_num
+        if change * sign < -args.tolerance:
+            regressed += 1
+            print("REGRESSED %s,%s: %s -> %s (%+.1f%%)" % (group, metric, old, new, change))
+        elif change * sign > args.tolerance:
+            print("IMPROVED  %s,%s: %s -> %s (%+.1f%%)" % (group, metric, old, new, change))
+
+    for key in current:
+        if key not in base:
+            print("NEW       %s,%s: %s" % (key[0], key[1], current[key]))
+
+    print("%d results, %d regressed beyond %.1f%%" % (len(base), regressed, args.tolerance))
+    return 1 if regressed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())